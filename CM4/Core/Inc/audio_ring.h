@@ -0,0 +1,118 @@
+/**
+  ******************************************************************************
+  * @file    audio_ring.h
+  * @brief   Block queue between the SAI DMA interrupts and the storage side
+  *          of the audio streaming engine. Target independent: the sink and
+  *          source are reached through function pointers, so the queue and
+  *          the batching can be run on a host against a RAM disk and a
+  *          simulated sample clock.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __AUDIO_RING_H
+#define __AUDIO_RING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#ifndef AUDIO_RING_SILENCE
+#define AUDIO_RING_SILENCE      0x00U   /* Fill byte of a playback block nobody supplied */
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Writes NumBytes to storage, returns the number of bytes written
+  *         (FS_Write() semantics).
+  */
+typedef uint32_t (*AUDIO_WriteFunc)(void *pContext, const uint8_t *pData, uint32_t NumBytes);
+
+/**
+  * @brief  Reads up to NumBytes from storage, returns the number of bytes
+  *         read (FS_Read() semantics).
+  */
+typedef uint32_t (*AUDIO_ReadFunc)(void *pContext, uint8_t *pData, uint32_t NumBytes);
+
+/**
+  * @brief  Destination of captured blocks.
+  */
+typedef struct
+{
+  AUDIO_WriteFunc  pfWrite;
+  void            *pContext;
+} AUDIO_SinkTypeDef;
+
+/**
+  * @brief  Origin of playback blocks.
+  */
+typedef struct
+{
+  AUDIO_ReadFunc   pfRead;
+  void            *pContext;
+} AUDIO_SourceTypeDef;
+
+/**
+  * @brief  Queue of fixed size blocks in one contiguous array. One producer,
+  *         one consumer; indices run free, NumBlocks is a power of 2.
+  */
+typedef struct
+{
+  uint8_t           *pMem;        /*!< NumBlocks * BlockSize bytes   */
+  uint32_t           BlockSize;   /*!< Bytes per block               */
+  uint32_t           NumBlocks;
+  volatile uint32_t  WrIdx;       /*!< Next block the producer fills */
+  volatile uint32_t  RdIdx;       /*!< Next block the consumer takes */
+} AUDIO_QueueTypeDef;
+
+/**
+  * @brief  Counters of one direction.
+  */
+typedef struct
+{
+  uint32_t Blocks;          /*!< Blocks moved by the interrupt side           */
+  uint32_t Overruns;        /*!< Captured blocks dropped on a full queue       */
+  uint32_t Underruns;       /*!< Playback blocks replaced by silence           */
+  uint32_t Transfers;       /*!< Calls to the sink or source                   */
+  uint32_t Bytes;           /*!< Bytes through the sink or source              */
+  uint32_t ShortTransfers;  /*!< Calls that moved fewer bytes than asked       */
+  uint32_t MaxTransfer;     /*!< Largest single transfer in bytes              */
+  uint32_t MaxCount;        /*!< Highest fill level of the queue in blocks     */
+  uint32_t HwErrors;        /*!< SAI or DMA errors, kept by the caller         */
+} AUDIO_StatTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+int      AUDIO_QUEUE_Init(AUDIO_QueueTypeDef *pQueue, uint8_t *pMem, uint32_t BlockSize, uint32_t NumBlocks);
+uint32_t AUDIO_QUEUE_GetCount(const AUDIO_QueueTypeDef *pQueue);
+uint32_t AUDIO_QUEUE_GetFree(const AUDIO_QueueTypeDef *pQueue, uint8_t **ppBlock);
+void     AUDIO_QUEUE_Commit(AUDIO_QueueTypeDef *pQueue, uint32_t NumBlocks);
+uint32_t AUDIO_QUEUE_GetFilled(const AUDIO_QueueTypeDef *pQueue, uint8_t **ppBlock);
+void     AUDIO_QUEUE_Release(AUDIO_QueueTypeDef *pQueue, uint32_t NumBlocks);
+
+int      AUDIO_QUEUE_PutBlock(AUDIO_QueueTypeDef *pQueue, const uint8_t *pSrc, AUDIO_StatTypeDef *pStat);
+int      AUDIO_QUEUE_GetBlock(AUDIO_QueueTypeDef *pQueue, uint8_t *pDest, AUDIO_StatTypeDef *pStat);
+
+uint32_t AUDIO_QUEUE_Drain(AUDIO_QueueTypeDef *pQueue, const AUDIO_SinkTypeDef *pSink,
+                           uint32_t MinBlocks, AUDIO_StatTypeDef *pStat);
+uint32_t AUDIO_QUEUE_Fill(AUDIO_QueueTypeDef *pQueue, const AUDIO_SourceTypeDef *pSource,
+                          uint32_t MinBlocks, AUDIO_StatTypeDef *pStat, int *pEnd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AUDIO_RING_H */
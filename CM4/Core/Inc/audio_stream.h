@@ -0,0 +1,82 @@
+/**
+  ******************************************************************************
+  * @file    audio_stream.h
+  * @brief   SAI2 audio streaming engine of the Cortex-M4: circular DMA double
+  *          buffering between SAI2 and storage, full duplex.
+  *
+  *          Library only for now: main() calls AUDIO_STREAM_Init() and
+  *          AUDIO_STREAM_Poll() but does not start the stream. Captured
+  *          audio needs a sink and played audio a source, and the only
+  *          ones provided are the emFile adapters (audio_stream_file.c),
+  *          which stay compiled out because emFile is not part of the
+  *          Cortex-M4 image.
+  *          Starting without either would only clock silence out of SAI2.
+  *          An application that links a file system, or brings its own
+  *          AUDIO_SinkTypeDef/AUDIO_SourceTypeDef, calls AUDIO_STREAM_Start().
+  *          The queue, its batching and the emFile adapters are covered by
+  *          Tests/CM4/AUDIO_RingTest.c.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __AUDIO_STREAM_H
+#define __AUDIO_STREAM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "audio_ring.h"
+
+/* Exported constants --------------------------------------------------------*/
+#ifndef AUDIO_STREAM_BLOCK_SIZE
+#define AUDIO_STREAM_BLOCK_SIZE     4096U   /* Bytes per DMA half and queue block, multiple of 512 */
+#endif
+#ifndef AUDIO_STREAM_QUEUE_BLOCKS
+#define AUDIO_STREAM_QUEUE_BLOCKS   8U      /* Blocks per direction, power of 2 */
+#endif
+#ifndef AUDIO_STREAM_BATCH_BLOCKS
+#define AUDIO_STREAM_BATCH_BLOCKS   4U      /* Blocks per storage request */
+#endif
+#if (AUDIO_STREAM_BATCH_BLOCKS >= AUDIO_STREAM_QUEUE_BLOCKS)
+#error "AUDIO_STREAM_BATCH_BLOCKS must leave room in the queue for the request in progress"
+#endif
+#ifndef AUDIO_STREAM_IRQ_PRIORITY
+#define AUDIO_STREAM_IRQ_PRIORITY   4U      /* Shared by the SAI and both DMA streams: single producer */
+#endif
+#ifndef AUDIO_STREAM_USE_EMFILE
+#define AUDIO_STREAM_USE_EMFILE     0       /* Set to 1 when emFile is linked in */
+#endif
+
+/* Exported functions prototypes ---------------------------------------------*/
+int      AUDIO_STREAM_Init(void);
+int      AUDIO_STREAM_Start(const AUDIO_SinkTypeDef *pSink, const AUDIO_SourceTypeDef *pSource);
+int      AUDIO_STREAM_Stop(void);
+void     AUDIO_STREAM_Poll(void);
+void     AUDIO_STREAM_GetStat(AUDIO_StatTypeDef *pCapture, AUDIO_StatTypeDef *pPlayback);
+
+#if AUDIO_STREAM_USE_EMFILE
+void    *AUDIO_STREAM_FileCreate(const char *sName, uint32_t NumBytes);
+void    *AUDIO_STREAM_FileOpen(const char *sName);
+void     AUDIO_STREAM_FileClose(void *pFile);
+uint32_t AUDIO_STREAM_FileWrite(void *pContext, const uint8_t *pData, uint32_t NumBytes);
+uint32_t AUDIO_STREAM_FileRead(void *pContext, uint8_t *pData, uint32_t NumBytes);
+#endif /* AUDIO_STREAM_USE_EMFILE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AUDIO_STREAM_H */
@@ -0,0 +1,158 @@
+/**
+  ******************************************************************************
+  * @file    can_ring.h
+  * @brief   CAN frame ring, per-ID software filter and batched draining of
+  *          FDCAN Rx FIFO elements. Target independent, the message RAM is
+  *          only accessed through a pointer, so it can be built and exercised
+  *          on a host against a simulated message RAM.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __CAN_RING_H
+#define __CAN_RING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+/* Frame flags */
+#define CAN_FRAME_XTD           0x01U   /*!< 29 bit identifier          */
+#define CAN_FRAME_RTR           0x02U   /*!< Remote frame               */
+#define CAN_FRAME_ESI           0x04U   /*!< Sender is error passive    */
+
+/* Filter actions */
+#define CAN_FILTER_DROP         0x00U   /*!< Discard frames of this ID  */
+#define CAN_FILTER_ACCEPT       0x01U   /*!< Lowest tag of an accepted ID, tags go up to 0xFF */
+
+/* Layout of an Rx FIFO element in the message RAM (classic CAN) */
+#define CAN_ELEM_R0_ESI         0x80000000U
+#define CAN_ELEM_R0_XTD         0x40000000U
+#define CAN_ELEM_R0_RTR         0x20000000U
+#define CAN_ELEM_R0_ID_MSK      0x1FFFFFFFU
+#define CAN_ELEM_R0_STDID_POS   18U
+#define CAN_ELEM_R1_DLC_POS     16U
+#define CAN_ELEM_R1_DLC_MSK     0x000F0000U
+#define CAN_ELEM_R1_RXTS_MSK    0x0000FFFFU
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  A received frame.
+  */
+typedef struct
+{
+  uint32_t Time;      /*!< Reception time in CPU cycles               */
+  uint32_t Id;        /*!< 11 or 29 bit identifier                    */
+  uint8_t  Bus;       /*!< Bus index                                  */
+  uint8_t  Flags;     /*!< CAN_FRAME_xxx                              */
+  uint8_t  Dlc;       /*!< Data length code                           */
+  uint8_t  Tag;       /*!< Tag of the software filter entry           */
+  uint8_t  aData[8];
+} CAN_FrameTypeDef;
+
+/**
+  * @brief  Frame ring. One producer (the FDCAN interrupts, which must share
+  *         one priority), one consumer.
+  */
+typedef struct
+{
+  CAN_FrameTypeDef  *pFrames;
+  uint32_t           NumFrames;   /*!< Power of 2              */
+  volatile uint32_t  WrIdx;
+  volatile uint32_t  RdIdx;
+} CAN_RingTypeDef;
+
+/**
+  * @brief  Entry of the software filter.
+  */
+typedef struct
+{
+  uint32_t Key;       /*!< Id | CAN_FILTER_KEY_XTD, CAN_FILTER_KEY_EMPTY if unused */
+  uint8_t  Action;    /*!< CAN_FILTER_DROP or a tag                   */
+} CAN_FilterEntryTypeDef;
+
+/**
+  * @brief  Software filter: open addressing hash table of identifiers.
+  */
+typedef struct
+{
+  CAN_FilterEntryTypeDef *pEntries;
+  uint32_t                NumEntries;     /*!< Power of 2                    */
+  uint32_t                Shift;          /*!< 32 - log2(NumEntries)         */
+  uint32_t                NumUsed;
+  uint8_t                 DefaultAction;  /*!< Action for unlisted IDs       */
+} CAN_FilterTypeDef;
+
+/**
+  * @brief  One Rx FIFO in the message RAM.
+  */
+typedef struct
+{
+  const volatile uint32_t *pElements;     /*!< First element                */
+  uint32_t                 ElementWords;  /*!< Size of one element in words */
+  uint32_t                 NumElements;   /*!< FIFO size                    */
+} CAN_FifoTypeDef;
+
+/**
+  * @brief  Relation between the FDCAN timestamp counter and the CPU cycle
+  *         counter at the time of a drain.
+  */
+typedef struct
+{
+  uint32_t Now;             /*!< CPU cycle counter                      */
+  uint32_t NowTs;           /*!< FDCAN timestamp counter (16 bit)       */
+  uint32_t CyclesPerTsQ16;  /*!< CPU cycles per timestamp tick, 16.16   */
+} CAN_TimeRefTypeDef;
+
+/**
+  * @brief  Per bus counters.
+  */
+typedef struct
+{
+  uint32_t NumReceived;     /*!< Elements read from the message RAM     */
+  uint32_t NumAccepted;     /*!< Frames stored in the ring              */
+  uint32_t NumFiltered;     /*!< Frames dropped by the software filter  */
+  uint32_t NumDropped;      /*!< Frames lost because the ring was full  */
+  uint32_t NumOverruns;     /*!< Message lost events of the Rx FIFOs    */
+  uint32_t NumBatches;      /*!< Drains                                 */
+  uint32_t MaxBatch;        /*!< Most elements taken in one drain       */
+} CAN_StatTypeDef;
+
+/* Exported macro ------------------------------------------------------------*/
+#define CAN_FILTER_KEY_XTD      0x80000000U
+#define CAN_FILTER_KEY_EMPTY    0xFFFFFFFFU
+#define CAN_FILTER_KEY(Id, Xtd) (((uint32_t)(Id) & CAN_ELEM_R0_ID_MSK) | ((Xtd) ? CAN_FILTER_KEY_XTD : 0U))
+
+/* Exported functions prototypes ---------------------------------------------*/
+int      CAN_RING_Init(CAN_RingTypeDef *pRing, CAN_FrameTypeDef *pFrames, uint32_t NumFrames);
+uint32_t CAN_RING_Get(CAN_RingTypeDef *pRing, CAN_FrameTypeDef *pDest, uint32_t MaxFrames);
+uint32_t CAN_RING_GetCount(const CAN_RingTypeDef *pRing);
+
+int      CAN_FILTER_Init(CAN_FilterTypeDef *pFilter, CAN_FilterEntryTypeDef *pEntries, uint32_t NumEntries, uint8_t DefaultAction);
+int      CAN_FILTER_Set(CAN_FilterTypeDef *pFilter, uint32_t Id, int Xtd, uint8_t Action);
+uint8_t  CAN_FILTER_Lookup(const CAN_FilterTypeDef *pFilter, uint32_t Key);
+
+uint32_t CAN_RING_DrainFifo(CAN_RingTypeDef *pRing, const CAN_FilterTypeDef *pFilter,
+                            const CAN_FifoTypeDef *pFifo, uint32_t GetIndex, uint32_t FillLevel,
+                            const CAN_TimeRefTypeDef *pTime, uint8_t Bus, CAN_StatTypeDef *pStat);
+uint32_t CAN_RING_GetCyclesPerTsQ16(uint32_t CpuClock, uint32_t CanClock, uint32_t BitClocks, uint32_t *pPrescaler);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CAN_RING_H */
@@ -0,0 +1,69 @@
+/**
+  ******************************************************************************
+  * @file    can_rx.h
+  * @brief   FDCAN1/FDCAN2 receive pipeline of the Cortex-M4: watermark driven
+  *          batch draining of the Rx FIFOs into a time stamped frame ring.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __CAN_RX_H
+#define __CAN_RX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "can_ring.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define CAN_RX_NUM_BUS          2U      /* FDCAN1, FDCAN2 */
+#define CAN_RX_FIFO0            0U      /* Bulk traffic, drained in batches     */
+#define CAN_RX_FIFO1            1U      /* Priority traffic, drained per frame  */
+
+#ifndef CAN_RX_RING_SIZE
+#define CAN_RX_RING_SIZE        256U    /* Frames, power of 2 */
+#endif
+#ifndef CAN_RX_FILTER_SIZE
+#define CAN_RX_FILTER_SIZE      256U    /* Software filter slots, power of 2 */
+#endif
+#ifndef CAN_RX_FIFO0_WATERMARK
+#define CAN_RX_FIFO0_WATERMARK  16U     /* Elements per FIFO0 interrupt */
+#endif
+#ifndef CAN_RX_FLUSH_MS
+#define CAN_RX_FLUSH_MS         1U      /* Upper bound on the latency below the watermark */
+#endif
+#ifndef CAN_RX_TS_PRESCALER
+#define CAN_RX_TS_PRESCALER     8U      /* Bit times per timestamp tick, 1..16, lowered for slow bit rates */
+#endif
+#ifndef CAN_RX_IRQ_PRIORITY
+#define CAN_RX_IRQ_PRIORITY     5U      /* Shared by both instances: single producer */
+#endif
+
+/* Exported functions prototypes ---------------------------------------------*/
+int      CAN_RX_Init(void);
+int      CAN_RX_AddHwFilter(uint32_t Bus, uint32_t Id, uint32_t Mask, int Xtd, uint32_t Fifo);
+int      CAN_RX_AddIdFilter(uint32_t Id, int Xtd, uint8_t Action);
+void     CAN_RX_SetDefaultAction(uint8_t Action);
+int      CAN_RX_Start(void);
+void     CAN_RX_Poll(void);
+uint32_t CAN_RX_Read(CAN_FrameTypeDef *pFrames, uint32_t MaxFrames);
+void     CAN_RX_GetStat(uint32_t Bus, CAN_StatTypeDef *pStat);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CAN_RX_H */
@@ -0,0 +1,65 @@
+/**
+  ******************************************************************************
+  * @file    eth_dma.h
+  * @brief   Ethernet DMA engine of the Cortex-M4: zero-copy receive with
+  *          coalesced interrupts and polling, scatter-gather transmit.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __ETH_DMA_H
+#define __ETH_DMA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "eth_ring.h"
+
+/* Exported constants --------------------------------------------------------*/
+#ifndef ETH_DMA_BUF_SIZE
+#define ETH_DMA_BUF_SIZE          1536U   /* Pool buffer stride, >= heth.Init.RxBuffLen, 32 byte multiple */
+#endif
+#ifndef ETH_DMA_POOL_BUFS
+#define ETH_DMA_POOL_BUFS         40U     /* RX ring + packets held by the application + TX */
+#endif
+#ifndef ETH_DMA_RX_IOC_INTERVAL
+#define ETH_DMA_RX_IOC_INTERVAL   8U      /* Interrupt at least every n packets under load */
+#endif
+#ifndef ETH_DMA_RX_WATCHDOG_US
+#define ETH_DMA_RX_WATCHDOG_US    50U     /* Interrupt at most this late for the other packets */
+#endif
+#ifndef ETH_DMA_POLL_BUDGET
+#define ETH_DMA_POLL_BUDGET       16U     /* Packets per ETH_DMA_Receive() call in the main loop */
+#endif
+#ifndef ETH_DMA_IRQ_PRIORITY
+#define ETH_DMA_IRQ_PRIORITY      6U
+#endif
+
+/* Exported functions prototypes ---------------------------------------------*/
+int      ETH_DMA_Init(void);
+int      ETH_DMA_Start(void);
+uint32_t ETH_DMA_Receive(ETH_PacketTypeDef *pPkts, uint32_t Budget);
+int      ETH_DMA_RxScheduled(void);
+int      ETH_DMA_Transmit(const ETH_PacketTypeDef *pPkt);
+uint8_t *ETH_DMA_AllocBuffer(void);
+void     ETH_DMA_FreePacket(ETH_PacketTypeDef *pPkt);
+void     ETH_DMA_GetStat(ETH_StatTypeDef *pStat);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ETH_DMA_H */
@@ -0,0 +1,138 @@
+/**
+  ******************************************************************************
+  * @file    eth_ring.h
+  * @brief   Packet buffer pool and Ethernet DMA descriptor rings. Target
+  *          independent: the descriptors are only accessed as words through
+  *          a pointer, so the rings can be driven on a host by a model of the
+  *          DMA that takes and returns descriptors.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __ETH_RING_H
+#define __ETH_RING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#ifndef ETH_RING_MAX_SEGS
+#define ETH_RING_MAX_SEGS       4U      /* Buffers per packet */
+#endif
+
+/* Descriptor word 3, read format (RX and TX) */
+#define ETH_RING_DESC3_OWN      0x80000000U
+#define ETH_RING_RDES3_IOC      0x40000000U
+#define ETH_RING_RDES3_BUF1V    0x01000000U
+#define ETH_RING_TDES3_FD       0x20000000U
+#define ETH_RING_TDES3_LD       0x10000000U
+#define ETH_RING_TDES3_CIC_MSK  0x00030000U
+#define ETH_RING_TDES3_FL_MSK   0x00007FFFU
+#define ETH_RING_TDES2_IOC      0x80000000U
+#define ETH_RING_TDES2_B1L_MSK  0x00003FFFU
+
+/* Descriptor word 3, RX write-back format */
+#define ETH_RING_RDES3_CTXT     0x40000000U
+#define ETH_RING_RDES3_FD       0x20000000U
+#define ETH_RING_RDES3_LD       0x10000000U
+#define ETH_RING_RDES3_ES       0x00008000U
+#define ETH_RING_RDES3_PL_MSK   0x00007FFFU
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Fixed size buffers handed between the DMA and the application
+  *         without copying. Not interrupt safe: use from one context.
+  */
+typedef struct
+{
+  uint8_t   *pBase;       /*!< First buffer                            */
+  uint32_t   BufSize;     /*!< Buffer stride in bytes                  */
+  uint32_t   NumBufs;
+  uint8_t  **ppFree;      /*!< Stack of free buffers, NumBufs entries  */
+  uint32_t   NumFree;
+  uint32_t   MinFree;     /*!< Low water mark of NumFree               */
+} ETH_PoolTypeDef;
+
+/**
+  * @brief  A packet as a list of buffers.
+  */
+typedef struct
+{
+  uint8_t  *apSeg[ETH_RING_MAX_SEGS];
+  uint16_t  aSegLen[ETH_RING_MAX_SEGS];
+  uint16_t  Length;       /*!< Sum of aSegLen                          */
+  uint8_t   NumSegs;
+} ETH_PacketTypeDef;
+
+/**
+  * @brief  Descriptor ring. Indices run free, NumDesc is a power of 2.
+  */
+typedef struct
+{
+  volatile uint32_t *pDesc;        /*!< First descriptor                         */
+  uint32_t           DescWords;    /*!< Descriptor stride in words               */
+  uint32_t           NumDesc;
+  uint8_t          **apBuf;        /*!< Buffer of each descriptor, NumDesc entries */
+  uint32_t           BufLen;       /*!< RX: DMA buffer size                       */
+  uint32_t           IocInterval;  /*!< Interrupt on completion every n descriptors, rest left to the watchdog */
+  uint32_t           Head;         /*!< Next descriptor the CPU takes back        */
+  uint32_t           Tail;         /*!< Next descriptor the CPU hands to the DMA  */
+} ETH_RingTypeDef;
+
+/**
+  * @brief  Counters.
+  */
+typedef struct
+{
+  uint32_t RxPackets;
+  uint32_t RxBytes;
+  uint32_t RxErrors;       /*!< Packets dropped for an error summary or too many buffers */
+  uint32_t RxNoBuffer;     /*!< Refills cut short by an empty pool        */
+  uint32_t RxBatches;      /*!< Polls that returned packets               */
+  uint32_t RxMaxBatch;
+  uint32_t TxPackets;
+  uint32_t TxBytes;
+  uint32_t TxRingFull;     /*!< Submits refused for lack of descriptors   */
+  uint32_t TxCompleted;    /*!< Descriptors taken back from the DMA       */
+  uint32_t RxInterrupts;   /*!< Receive interrupts, kept by the caller    */
+  uint32_t RxBufUnavail;   /*!< DMA found no RX descriptor, kept by the caller */
+} ETH_StatTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+int      ETH_POOL_Init(ETH_PoolTypeDef *pPool, uint8_t *pMem, uint32_t BufSize, uint32_t NumBufs, uint8_t **ppFree);
+uint8_t *ETH_POOL_Alloc(ETH_PoolTypeDef *pPool);
+void     ETH_POOL_Free(ETH_PoolTypeDef *pPool, uint8_t *pBuf);
+int      ETH_POOL_Owns(const ETH_PoolTypeDef *pPool, const uint8_t *pBuf);
+void     ETH_POOL_FreePacket(ETH_PoolTypeDef *pPool, ETH_PacketTypeDef *pPkt);
+
+int      ETH_RING_Init(ETH_RingTypeDef *pRing, volatile uint32_t *pDesc, uint32_t DescWords, uint32_t NumDesc,
+                       uint8_t **apBuf, uint32_t BufLen, uint32_t IocInterval);
+uint32_t ETH_RING_RxRefill(ETH_RingTypeDef *pRing, ETH_PoolTypeDef *pPool, ETH_StatTypeDef *pStat);
+uint32_t ETH_RING_RxHarvest(ETH_RingTypeDef *pRing, ETH_PoolTypeDef *pPool, ETH_PacketTypeDef *pPkts,
+                            uint32_t MaxPkts, ETH_StatTypeDef *pStat);
+int      ETH_RING_RxPending(const ETH_RingTypeDef *pRing);
+int      ETH_RING_TxSubmit(ETH_RingTypeDef *pRing, const ETH_PacketTypeDef *pPkt, uint32_t Desc3Flags,
+                           ETH_StatTypeDef *pStat);
+uint32_t ETH_RING_TxReclaim(ETH_RingTypeDef *pRing, ETH_PoolTypeDef *pPool, ETH_StatTypeDef *pStat);
+volatile uint32_t *ETH_RING_GetDesc(const ETH_RingTypeDef *pRing, uint32_t Idx);
+uint32_t ETH_RING_TxFree(const ETH_RingTypeDef *pRing);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ETH_RING_H */
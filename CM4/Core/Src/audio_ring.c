@@ -0,0 +1,292 @@
+/**
+  ******************************************************************************
+  * @file    audio_ring.c
+  * @brief   Block queue between the SAI DMA interrupts and the storage side
+  *          of the audio streaming engine.
+  *
+  *          The interrupt side moves exactly one block per DMA half transfer
+  *          and never waits: a capture block that finds the queue full is
+  *          dropped and counted as an overrun, a playback half that finds
+  *          it empty is sent as silence and counted as an underrun.
+  *
+  *          The storage side works in batches. It waits until MinBlocks
+  *          are ready and then hands the longest contiguous run of blocks
+  *          to the sink or source in a single call, so the file system sees
+  *          few large, block aligned requests instead of one per half
+  *          transfer.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "audio_ring.h"
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Initializes an empty queue.
+  * @param  pQueue: Queue.
+  * @param  pMem: Block storage, NumBlocks * BlockSize bytes.
+  * @param  BlockSize: Bytes per block.
+  * @param  NumBlocks: Number of blocks, must be a power of 2.
+  * @retval 0 on success, -1 if a parameter is not valid.
+  */
+int AUDIO_QUEUE_Init(AUDIO_QueueTypeDef *pQueue, uint8_t *pMem, uint32_t BlockSize, uint32_t NumBlocks)
+{
+  if ((pMem == NULL) || (BlockSize == 0U) || (NumBlocks == 0U) || ((NumBlocks & (NumBlocks - 1U)) != 0U))
+  {
+    return -1;
+  }
+  pQueue->pMem      = pMem;
+  pQueue->BlockSize = BlockSize;
+  pQueue->NumBlocks = NumBlocks;
+  pQueue->WrIdx     = 0;
+  pQueue->RdIdx     = 0;
+  return 0;
+}
+
+/**
+  * @brief  Returns the number of blocks waiting in the queue.
+  * @param  pQueue: Queue.
+  * @retval Number of blocks.
+  */
+uint32_t AUDIO_QUEUE_GetCount(const AUDIO_QueueTypeDef *pQueue)
+{
+  return __atomic_load_n(&pQueue->WrIdx, __ATOMIC_ACQUIRE) - __atomic_load_n(&pQueue->RdIdx, __ATOMIC_ACQUIRE);
+}
+
+/**
+  * @brief  Returns the free blocks that follow the write position without
+  *         wrapping around. Producer only.
+  * @param  pQueue: Queue.
+  * @param  ppBlock: Receives the first free block.
+  * @retval Number of contiguous free blocks, 0 if the queue is full.
+  */
+uint32_t AUDIO_QUEUE_GetFree(const AUDIO_QueueTypeDef *pQueue, uint8_t **ppBlock)
+{
+  uint32_t WrIdx;
+  uint32_t Pos;
+  uint32_t NumFree;
+
+  WrIdx   = pQueue->WrIdx;
+  NumFree = pQueue->NumBlocks - (WrIdx - __atomic_load_n(&pQueue->RdIdx, __ATOMIC_ACQUIRE));
+  Pos     = WrIdx & (pQueue->NumBlocks - 1U);
+  if (NumFree > (pQueue->NumBlocks - Pos))
+  {
+    NumFree = pQueue->NumBlocks - Pos;
+  }
+  *ppBlock = &pQueue->pMem[Pos * pQueue->BlockSize];
+  return NumFree;
+}
+
+/**
+  * @brief  Publishes blocks filled after AUDIO_QUEUE_GetFree(). Producer only.
+  * @param  pQueue: Queue.
+  * @param  NumBlocks: Number of blocks.
+  * @retval None
+  */
+void AUDIO_QUEUE_Commit(AUDIO_QueueTypeDef *pQueue, uint32_t NumBlocks)
+{
+  __atomic_store_n(&pQueue->WrIdx, pQueue->WrIdx + NumBlocks, __ATOMIC_RELEASE);
+}
+
+/**
+  * @brief  Returns the filled blocks that follow the read position without
+  *         wrapping around. Consumer only.
+  * @param  pQueue: Queue.
+  * @param  ppBlock: Receives the oldest block.
+  * @retval Number of contiguous filled blocks, 0 if the queue is empty.
+  */
+uint32_t AUDIO_QUEUE_GetFilled(const AUDIO_QueueTypeDef *pQueue, uint8_t **ppBlock)
+{
+  uint32_t RdIdx;
+  uint32_t Pos;
+  uint32_t NumFilled;
+
+  RdIdx     = pQueue->RdIdx;
+  NumFilled = __atomic_load_n(&pQueue->WrIdx, __ATOMIC_ACQUIRE) - RdIdx;
+  Pos       = RdIdx & (pQueue->NumBlocks - 1U);
+  if (NumFilled > (pQueue->NumBlocks - Pos))
+  {
+    NumFilled = pQueue->NumBlocks - Pos;
+  }
+  *ppBlock = &pQueue->pMem[Pos * pQueue->BlockSize];
+  return NumFilled;
+}
+
+/**
+  * @brief  Gives back blocks consumed after AUDIO_QUEUE_GetFilled().
+  *         Consumer only.
+  * @param  pQueue: Queue.
+  * @param  NumBlocks: Number of blocks.
+  * @retval None
+  */
+void AUDIO_QUEUE_Release(AUDIO_QueueTypeDef *pQueue, uint32_t NumBlocks)
+{
+  __atomic_store_n(&pQueue->RdIdx, pQueue->RdIdx + NumBlocks, __ATOMIC_RELEASE);
+}
+
+/**
+  * @brief  Copies one captured block into the queue. Called from the DMA
+  *         half and full transfer interrupts.
+  * @param  pQueue: Queue.
+  * @param  pSrc: Half of the DMA buffer just written by the DMA.
+  * @param  pStat: Counters.
+  * @retval 0 on success, -1 if the block was dropped.
+  */
+int AUDIO_QUEUE_PutBlock(AUDIO_QueueTypeDef *pQueue, const uint8_t *pSrc, AUDIO_StatTypeDef *pStat)
+{
+  uint8_t  *pBlock;
+  uint32_t  Count;
+
+  if (AUDIO_QUEUE_GetFree(pQueue, &pBlock) == 0U)
+  {
+    pStat->Overruns++;
+    return -1;
+  }
+  memcpy(pBlock, pSrc, pQueue->BlockSize);
+  AUDIO_QUEUE_Commit(pQueue, 1U);
+  pStat->Blocks++;
+  Count = pQueue->WrIdx - __atomic_load_n(&pQueue->RdIdx, __ATOMIC_ACQUIRE);
+  if (Count > pStat->MaxCount)
+  {
+    pStat->MaxCount = Count;
+  }
+  return 0;
+}
+
+/**
+  * @brief  Copies the oldest playback block out of the queue, or silence if
+  *         there is none. Called from the DMA half and full transfer
+  *         interrupts.
+  * @param  pQueue: Queue.
+  * @param  pDest: Half of the DMA buffer just read by the DMA.
+  * @param  pStat: Counters.
+  * @retval 0 on success, -1 if silence was inserted.
+  */
+int AUDIO_QUEUE_GetBlock(AUDIO_QueueTypeDef *pQueue, uint8_t *pDest, AUDIO_StatTypeDef *pStat)
+{
+  uint8_t *pBlock;
+
+  if (AUDIO_QUEUE_GetFilled(pQueue, &pBlock) == 0U)
+  {
+    memset(pDest, AUDIO_RING_SILENCE, pQueue->BlockSize);
+    pStat->Underruns++;
+    return -1;
+  }
+  memcpy(pDest, pBlock, pQueue->BlockSize);
+  AUDIO_QUEUE_Release(pQueue, 1U);
+  pStat->Blocks++;
+  return 0;
+}
+
+/**
+  * @brief  Writes captured blocks to the sink in batches. Consumer side.
+  * @param  pQueue: Queue.
+  * @param  pSink: Sink.
+  * @param  MinBlocks: Smallest batch worth a write; 1 flushes everything.
+  * @param  pStat: Counters.
+  * @retval Number of blocks written.
+  */
+uint32_t AUDIO_QUEUE_Drain(AUDIO_QueueTypeDef *pQueue, const AUDIO_SinkTypeDef *pSink,
+                           uint32_t MinBlocks, AUDIO_StatTypeDef *pStat)
+{
+  uint8_t  *pBlock;
+  uint32_t  Total;
+  uint32_t  NumBlocks;
+  uint32_t  NumBytes;
+  uint32_t  Done;
+
+  Total = 0;
+  while (AUDIO_QUEUE_GetCount(pQueue) >= MinBlocks)
+  {
+    /* A run that ends at the top of the array is written even if it is
+       shorter than a batch, the next run starts at the bottom */
+    NumBlocks = AUDIO_QUEUE_GetFilled(pQueue, &pBlock);
+    if (NumBlocks == 0U)
+    {
+      break;
+    }
+    NumBytes = NumBlocks * pQueue->BlockSize;
+    Done     = pSink->pfWrite(pSink->pContext, pBlock, NumBytes);
+    pStat->Transfers++;
+    pStat->Bytes += Done;
+    if (NumBytes > pStat->MaxTransfer)
+    {
+      pStat->MaxTransfer = NumBytes;
+    }
+    if (Done < NumBytes)
+    {
+      /* Keep the blocks the sink did not take, retry on the next call */
+      pStat->ShortTransfers++;
+      NumBlocks = Done / pQueue->BlockSize;
+      AUDIO_QUEUE_Release(pQueue, NumBlocks);
+      Total += NumBlocks;
+      break;
+    }
+    AUDIO_QUEUE_Release(pQueue, NumBlocks);
+    Total += NumBlocks;
+  }
+  return Total;
+}
+
+/**
+  * @brief  Reads playback blocks from the source in batches. Producer side.
+  * @param  pQueue: Queue.
+  * @param  pSource: Source.
+  * @param  MinBlocks: Smallest batch worth a read; 1 fills every free block.
+  * @param  pStat: Counters.
+  * @param  pEnd: Set to 1 when the source returned fewer bytes than asked,
+  *         the partial block is padded with silence.
+  * @retval Number of blocks queued.
+  */
+uint32_t AUDIO_QUEUE_Fill(AUDIO_QueueTypeDef *pQueue, const AUDIO_SourceTypeDef *pSource,
+                          uint32_t MinBlocks, AUDIO_StatTypeDef *pStat, int *pEnd)
+{
+  uint8_t  *pBlock;
+  uint32_t  Total;
+  uint32_t  NumBlocks;
+  uint32_t  NumBytes;
+  uint32_t  Done;
+
+  Total = 0;
+  while ((pQueue->NumBlocks - AUDIO_QUEUE_GetCount(pQueue)) >= MinBlocks)
+  {
+    NumBlocks = AUDIO_QUEUE_GetFree(pQueue, &pBlock);
+    if (NumBlocks == 0U)
+    {
+      break;
+    }
+    NumBytes = NumBlocks * pQueue->BlockSize;
+    Done     = pSource->pfRead(pSource->pContext, pBlock, NumBytes);
+    pStat->Transfers++;
+    pStat->Bytes += Done;
+    if (NumBytes > pStat->MaxTransfer)
+    {
+      pStat->MaxTransfer = NumBytes;
+    }
+    if (Done < NumBytes)
+    {
+      pStat->ShortTransfers++;
+      NumBlocks = (Done + pQueue->BlockSize - 1U) / pQueue->BlockSize;
+      memset(&pBlock[Done], AUDIO_RING_SILENCE, (NumBlocks * pQueue->BlockSize) - Done);
+      AUDIO_QUEUE_Commit(pQueue, NumBlocks);
+      Total += NumBlocks;
+      *pEnd = 1;
+      break;
+    }
+    AUDIO_QUEUE_Commit(pQueue, NumBlocks);
+    Total += NumBlocks;
+  }
+  return Total;
+}
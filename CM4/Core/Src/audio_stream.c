@@ -0,0 +1,375 @@
+/**
+  ******************************************************************************
+  * @file    audio_stream.c
+  * @brief   SAI2 audio streaming engine of the Cortex-M4.
+  *
+  *          Block A (master, transmit) plays back, block B (synchronous
+  *          slave, receive) captures. Each block runs a circular DMA over a
+  *          buffer of two halves of AUDIO_STREAM_BLOCK_SIZE bytes; the half
+  *          and full transfer interrupts move the half the DMA just left
+  *          between the buffer and a block queue (audio_ring.c), so the
+  *          storage side has a whole half period to react and the queue
+  *          depth on top of that.
+  *
+  *          AUDIO_STREAM_Poll() runs in the main loop. It writes captured
+  *          blocks to the sink once AUDIO_STREAM_BATCH_BLOCKS are queued and
+  *          reads playback blocks from the source once as many are free, in
+  *          one request per contiguous run of blocks. With block sizes that
+  *          are a multiple of the sector size and a file preallocated by
+  *          AUDIO_STREAM_FileCreate() (audio_stream_file.c), every FS_Write()
+  *          covers whole sectors of already allocated clusters.
+  *
+  *          Block A provides the bit clock and frame sync for block B, so
+  *          it always runs while the stream is started and sends silence
+  *          when there is no source.
+  *
+  *          The DMA buffers live in SRAM4 (.sai_dma, see linker script),
+  *          which DMA1 can reach. The queues are only touched by the CPU and
+  *          take their memory from the SDRAM (mem_map.c). The Cortex-M4 has
+  *          no data cache.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "main.h"
+#include "audio_stream.h"
+#include "mem_map.h"
+
+/* Private define ------------------------------------------------------------*/
+#define AUDIO_STREAM_DMA_ITEMS  ((2U * AUDIO_STREAM_BLOCK_SIZE) / sizeof(uint8_t))  /* SAI data size is 8 bits */
+
+/* Private variables ---------------------------------------------------------*/
+extern SAI_HandleTypeDef hsai_BlockA2;
+extern SAI_HandleTypeDef hsai_BlockB2;
+
+DMA_HandleTypeDef hdma_sai2_a;
+DMA_HandleTypeDef hdma_sai2_b;
+
+static uint8_t AUDIO_STREAM_aTxDma[2U * AUDIO_STREAM_BLOCK_SIZE] __attribute__((section(".sai_dma"), aligned(32)));
+static uint8_t AUDIO_STREAM_aRxDma[2U * AUDIO_STREAM_BLOCK_SIZE] __attribute__((section(".sai_dma"), aligned(32)));
+static uint8_t *AUDIO_STREAM_pCaptureMem;
+static uint8_t *AUDIO_STREAM_pPlaybackMem;
+
+static AUDIO_QueueTypeDef  AUDIO_STREAM_Capture;
+static AUDIO_QueueTypeDef  AUDIO_STREAM_Playback;
+static AUDIO_StatTypeDef   AUDIO_STREAM_CaptureStat;
+static AUDIO_StatTypeDef   AUDIO_STREAM_PlaybackStat;
+static AUDIO_SinkTypeDef   AUDIO_STREAM_Sink;
+static AUDIO_SourceTypeDef AUDIO_STREAM_Source;
+static volatile int        AUDIO_STREAM_SourceEnd;
+static uint8_t             AUDIO_STREAM_HasSink;
+static uint8_t             AUDIO_STREAM_HasSource;
+static uint8_t             AUDIO_STREAM_Started;
+static uint8_t             AUDIO_STREAM_IsInit;
+
+/* Private function prototypes -----------------------------------------------*/
+static int  AUDIO_STREAM_InitDma(DMA_HandleTypeDef *hdma, DMA_Stream_TypeDef *Instance,
+                                 uint32_t Request, uint32_t Direction);
+static void AUDIO_STREAM_TxHalf(uint8_t *pHalf);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Sets up one circular byte DMA stream.
+  * @param  hdma: DMA handle.
+  * @param  Instance: DMA stream.
+  * @param  Request: DMAMUX request.
+  * @param  Direction: DMA_MEMORY_TO_PERIPH or DMA_PERIPH_TO_MEMORY.
+  * @retval 0 on success, -1 on error.
+  */
+static int AUDIO_STREAM_InitDma(DMA_HandleTypeDef *hdma, DMA_Stream_TypeDef *Instance,
+                                uint32_t Request, uint32_t Direction)
+{
+  hdma->Instance                 = Instance;
+  hdma->Init.Request             = Request;
+  hdma->Init.Direction           = Direction;
+  hdma->Init.PeriphInc           = DMA_PINC_DISABLE;
+  hdma->Init.MemInc              = DMA_MINC_ENABLE;
+  hdma->Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+  hdma->Init.MemDataAlignment    = DMA_MDATAALIGN_BYTE;
+  hdma->Init.Mode                = DMA_CIRCULAR;
+  hdma->Init.Priority            = DMA_PRIORITY_HIGH;
+  hdma->Init.FIFOMode            = DMA_FIFOMODE_DISABLE;
+  return (HAL_DMA_Init(hdma) == HAL_OK) ? 0 : -1;
+}
+
+/**
+  * @brief  Refills the half of the transmit buffer the DMA just left.
+  * @param  pHalf: Half of AUDIO_STREAM_aTxDma.
+  * @retval None
+  */
+static void AUDIO_STREAM_TxHalf(uint8_t *pHalf)
+{
+  if (AUDIO_STREAM_HasSource == 0U)
+  {
+    return;                             /* Clock only, the buffer holds silence */
+  }
+  if ((AUDIO_STREAM_SourceEnd != 0) && (AUDIO_QUEUE_GetCount(&AUDIO_STREAM_Playback) == 0U))
+  {
+    memset(pHalf, AUDIO_RING_SILENCE, AUDIO_STREAM_BLOCK_SIZE);
+    return;                             /* Played out, not an underrun */
+  }
+  (void)AUDIO_QUEUE_GetBlock(&AUDIO_STREAM_Playback, pHalf, &AUDIO_STREAM_PlaybackStat);
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Allocates the queues and sets up the DMA streams and links them
+  *         to SAI2. Call after MX_SAI2_Init() and MEM_MAP_Init().
+  * @retval 0 on success, -1 on error.
+  */
+int AUDIO_STREAM_Init(void)
+{
+  if (AUDIO_STREAM_pCaptureMem == NULL)
+  {
+    AUDIO_STREAM_pCaptureMem  = (uint8_t *)MEM_MAP_Alloc(AUDIO_STREAM_QUEUE_BLOCKS * AUDIO_STREAM_BLOCK_SIZE, 0,
+                                                         0, MEM_ARENA_ATTR_EXTERNAL);
+    AUDIO_STREAM_pPlaybackMem = (uint8_t *)MEM_MAP_Alloc(AUDIO_STREAM_QUEUE_BLOCKS * AUDIO_STREAM_BLOCK_SIZE, 0,
+                                                         0, MEM_ARENA_ATTR_EXTERNAL);
+  }
+  if ((AUDIO_STREAM_pCaptureMem == NULL) || (AUDIO_STREAM_pPlaybackMem == NULL))
+  {
+    return -1;
+  }
+  __HAL_RCC_DMA1_CLK_ENABLE();
+  if ((AUDIO_STREAM_InitDma(&hdma_sai2_a, DMA1_Stream0, DMA_REQUEST_SAI2_A, DMA_MEMORY_TO_PERIPH) != 0) ||
+      (AUDIO_STREAM_InitDma(&hdma_sai2_b, DMA1_Stream1, DMA_REQUEST_SAI2_B, DMA_PERIPH_TO_MEMORY) != 0))
+  {
+    return -1;
+  }
+  __HAL_LINKDMA(&hsai_BlockA2, hdmatx, hdma_sai2_a);
+  __HAL_LINKDMA(&hsai_BlockB2, hdmarx, hdma_sai2_b);
+
+  HAL_NVIC_SetPriority(DMA1_Stream0_IRQn, AUDIO_STREAM_IRQ_PRIORITY, 0);
+  HAL_NVIC_SetPriority(DMA1_Stream1_IRQn, AUDIO_STREAM_IRQ_PRIORITY, 0);
+  HAL_NVIC_SetPriority(SAI2_IRQn, AUDIO_STREAM_IRQ_PRIORITY, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream0_IRQn);
+  HAL_NVIC_EnableIRQ(DMA1_Stream1_IRQn);
+  HAL_NVIC_EnableIRQ(SAI2_IRQn);
+  AUDIO_STREAM_IsInit = 1;
+  return 0;
+}
+
+/**
+  * @brief  Starts streaming. Fails if AUDIO_STREAM_Init() did not succeed.
+  * @param  pSink: Destination of captured audio, NULL to not capture.
+  * @param  pSource: Origin of played audio, NULL to send silence.
+  * @retval 0 on success, -1 on error.
+  */
+int AUDIO_STREAM_Start(const AUDIO_SinkTypeDef *pSink, const AUDIO_SourceTypeDef *pSource)
+{
+  int End;
+
+  if ((AUDIO_STREAM_IsInit == 0U) || (AUDIO_STREAM_Started != 0U))
+  {
+    return -1;
+  }
+  if ((AUDIO_QUEUE_Init(&AUDIO_STREAM_Capture, AUDIO_STREAM_pCaptureMem,
+                        AUDIO_STREAM_BLOCK_SIZE, AUDIO_STREAM_QUEUE_BLOCKS) != 0) ||
+      (AUDIO_QUEUE_Init(&AUDIO_STREAM_Playback, AUDIO_STREAM_pPlaybackMem,
+                        AUDIO_STREAM_BLOCK_SIZE, AUDIO_STREAM_QUEUE_BLOCKS) != 0))
+  {
+    return -1;
+  }
+  memset(&AUDIO_STREAM_CaptureStat, 0, sizeof(AUDIO_STREAM_CaptureStat));
+  memset(&AUDIO_STREAM_PlaybackStat, 0, sizeof(AUDIO_STREAM_PlaybackStat));
+  memset(AUDIO_STREAM_aTxDma, AUDIO_RING_SILENCE, sizeof(AUDIO_STREAM_aTxDma));
+  AUDIO_STREAM_HasSink   = (pSink != NULL) ? 1U : 0U;
+  AUDIO_STREAM_HasSource = (pSource != NULL) ? 1U : 0U;
+  AUDIO_STREAM_SourceEnd = 0;
+
+  if (pSource != NULL)
+  {
+    /* Queue as much as fits before the first half is due */
+    AUDIO_STREAM_Source = *pSource;
+    End = 0;
+    (void)AUDIO_QUEUE_Fill(&AUDIO_STREAM_Playback, &AUDIO_STREAM_Source, 1U, &AUDIO_STREAM_PlaybackStat, &End);
+    AUDIO_STREAM_SourceEnd = End;
+    AUDIO_STREAM_TxHalf(&AUDIO_STREAM_aTxDma[0]);
+    AUDIO_STREAM_TxHalf(&AUDIO_STREAM_aTxDma[AUDIO_STREAM_BLOCK_SIZE]);
+  }
+
+  /* The synchronous slave must be enabled before the master clocks it */
+  if (pSink != NULL)
+  {
+    AUDIO_STREAM_Sink = *pSink;
+    if (HAL_SAI_Receive_DMA(&hsai_BlockB2, AUDIO_STREAM_aRxDma, AUDIO_STREAM_DMA_ITEMS) != HAL_OK)
+    {
+      return -1;
+    }
+  }
+  if (HAL_SAI_Transmit_DMA(&hsai_BlockA2, AUDIO_STREAM_aTxDma, AUDIO_STREAM_DMA_ITEMS) != HAL_OK)
+  {
+    if (pSink != NULL)
+    {
+      (void)HAL_SAI_DMAStop(&hsai_BlockB2);
+    }
+    return -1;
+  }
+  AUDIO_STREAM_Started = 1;
+  return 0;
+}
+
+/**
+  * @brief  Stops streaming and writes the captured blocks still queued.
+  * @retval 0 on success, -1 on error.
+  */
+int AUDIO_STREAM_Stop(void)
+{
+  int r;
+
+  if (AUDIO_STREAM_Started == 0U)
+  {
+    return -1;
+  }
+  r = 0;
+  if ((AUDIO_STREAM_HasSink != 0U) && (HAL_SAI_DMAStop(&hsai_BlockB2) != HAL_OK))
+  {
+    r = -1;
+  }
+  if (HAL_SAI_DMAStop(&hsai_BlockA2) != HAL_OK)
+  {
+    r = -1;
+  }
+  AUDIO_STREAM_Started = 0;
+  if (AUDIO_STREAM_HasSink != 0U)
+  {
+    (void)AUDIO_QUEUE_Drain(&AUDIO_STREAM_Capture, &AUDIO_STREAM_Sink, 1U, &AUDIO_STREAM_CaptureStat);
+    if (AUDIO_QUEUE_GetCount(&AUDIO_STREAM_Capture) != 0U)
+    {
+      r = -1;
+    }
+  }
+  return r;
+}
+
+/**
+  * @brief  Moves batches between the queues and storage. Call from the main
+  *         loop at least once per AUDIO_STREAM_BLOCK_SIZE worth of samples.
+  * @retval None
+  */
+void AUDIO_STREAM_Poll(void)
+{
+  int End;
+
+  if (AUDIO_STREAM_Started == 0U)
+  {
+    return;
+  }
+  if (AUDIO_STREAM_HasSink != 0U)
+  {
+    (void)AUDIO_QUEUE_Drain(&AUDIO_STREAM_Capture, &AUDIO_STREAM_Sink,
+                            AUDIO_STREAM_BATCH_BLOCKS, &AUDIO_STREAM_CaptureStat);
+  }
+  if ((AUDIO_STREAM_HasSource != 0U) && (AUDIO_STREAM_SourceEnd == 0))
+  {
+    End = 0;
+    (void)AUDIO_QUEUE_Fill(&AUDIO_STREAM_Playback, &AUDIO_STREAM_Source,
+                           AUDIO_STREAM_BATCH_BLOCKS, &AUDIO_STREAM_PlaybackStat, &End);
+    AUDIO_STREAM_SourceEnd = End;
+  }
+}
+
+/**
+  * @brief  Copies the counters.
+  * @param  pCapture: Capture counters, can be NULL.
+  * @param  pPlayback: Playback counters, can be NULL.
+  * @retval None
+  */
+void AUDIO_STREAM_GetStat(AUDIO_StatTypeDef *pCapture, AUDIO_StatTypeDef *pPlayback)
+{
+  if (pCapture != NULL)
+  {
+    *pCapture = AUDIO_STREAM_CaptureStat;
+  }
+  if (pPlayback != NULL)
+  {
+    *pPlayback = AUDIO_STREAM_PlaybackStat;
+  }
+}
+
+/**
+  * @brief  Rx half transfer: the first half of the capture buffer is ready.
+  * @param  hsai: SAI handle.
+  * @retval None
+  */
+void HAL_SAI_RxHalfCpltCallback(SAI_HandleTypeDef *hsai)
+{
+  if (hsai == &hsai_BlockB2)
+  {
+    (void)AUDIO_QUEUE_PutBlock(&AUDIO_STREAM_Capture, &AUDIO_STREAM_aRxDma[0], &AUDIO_STREAM_CaptureStat);
+  }
+}
+
+/**
+  * @brief  Rx transfer complete: the second half of the capture buffer is ready.
+  * @param  hsai: SAI handle.
+  * @retval None
+  */
+void HAL_SAI_RxCpltCallback(SAI_HandleTypeDef *hsai)
+{
+  if (hsai == &hsai_BlockB2)
+  {
+    (void)AUDIO_QUEUE_PutBlock(&AUDIO_STREAM_Capture, &AUDIO_STREAM_aRxDma[AUDIO_STREAM_BLOCK_SIZE],
+                               &AUDIO_STREAM_CaptureStat);
+  }
+}
+
+/**
+  * @brief  Tx half transfer: the first half of the playback buffer is free.
+  * @param  hsai: SAI handle.
+  * @retval None
+  */
+void HAL_SAI_TxHalfCpltCallback(SAI_HandleTypeDef *hsai)
+{
+  if (hsai == &hsai_BlockA2)
+  {
+    AUDIO_STREAM_TxHalf(&AUDIO_STREAM_aTxDma[0]);
+  }
+}
+
+/**
+  * @brief  Tx transfer complete: the second half of the playback buffer is free.
+  * @param  hsai: SAI handle.
+  * @retval None
+  */
+void HAL_SAI_TxCpltCallback(SAI_HandleTypeDef *hsai)
+{
+  if (hsai == &hsai_BlockA2)
+  {
+    AUDIO_STREAM_TxHalf(&AUDIO_STREAM_aTxDma[AUDIO_STREAM_BLOCK_SIZE]);
+  }
+}
+
+/**
+  * @brief  SAI or DMA error (FIFO overrun/underrun, frame sync, transfer).
+  * @param  hsai: SAI handle.
+  * @retval None
+  */
+void HAL_SAI_ErrorCallback(SAI_HandleTypeDef *hsai)
+{
+  if (hsai == &hsai_BlockB2)
+  {
+    AUDIO_STREAM_CaptureStat.HwErrors++;
+  }
+  else if (hsai == &hsai_BlockA2)
+  {
+    AUDIO_STREAM_PlaybackStat.HwErrors++;
+  }
+  else
+  {
+    /* Not a stream block */
+  }
+}
@@ -0,0 +1,94 @@
+/**
+  ******************************************************************************
+  * @file    audio_stream_file.c
+  * @brief   emFile sink and source of the audio streaming engine
+  *          (audio_stream.c). A capture file is allocated up front and cut
+  *          at the last byte written when it is closed.
+  *
+  *          Kept apart from audio_stream.c, which needs the HAL, so that the
+  *          adapters are built and tested against the emFile host library
+  *          (Tests/CM4/AUDIO_RingTest.c). Compiled out unless
+  *          AUDIO_STREAM_USE_EMFILE is set.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "audio_stream.h"
+
+#if AUDIO_STREAM_USE_EMFILE
+#include "FS.h"
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Creates a capture file and allocates NumBytes for it up front, so
+  *         that writing does not have to allocate clusters.
+  * @param  sName: File name.
+  * @param  NumBytes: Size to allocate.
+  * @retval File handle for AUDIO_STREAM_FileWrite(), NULL on error.
+  */
+void *AUDIO_STREAM_FileCreate(const char *sName, uint32_t NumBytes)
+{
+  FS_FILE *pFile;
+
+  pFile = FS_FOpen(sName, "wb");
+  if (pFile == NULL)
+  {
+    return NULL;
+  }
+  if ((FS_SetFileSize(pFile, NumBytes) != 0) || (FS_FSeek(pFile, 0, FS_SEEK_SET) != 0))
+  {
+    (void)FS_FClose(pFile);
+    return NULL;
+  }
+  return pFile;
+}
+
+/**
+  * @brief  Opens a playback file.
+  * @param  sName: File name.
+  * @retval File handle for AUDIO_STREAM_FileRead(), NULL on error.
+  */
+void *AUDIO_STREAM_FileOpen(const char *sName)
+{
+  return FS_FOpen(sName, "rb");
+}
+
+/**
+  * @brief  Closes a file. A capture file is cut at the last byte written.
+  * @param  pFile: File handle.
+  * @retval None
+  */
+void AUDIO_STREAM_FileClose(void *pFile)
+{
+  (void)FS_SetEndOfFile((FS_FILE *)pFile);
+  (void)FS_FClose((FS_FILE *)pFile);
+}
+
+/**
+  * @brief  Sink function for a file from AUDIO_STREAM_FileCreate().
+  */
+uint32_t AUDIO_STREAM_FileWrite(void *pContext, const uint8_t *pData, uint32_t NumBytes)
+{
+  return FS_Write((FS_FILE *)pContext, pData, NumBytes);
+}
+
+/**
+  * @brief  Source function for a file from AUDIO_STREAM_FileOpen().
+  */
+uint32_t AUDIO_STREAM_FileRead(void *pContext, uint8_t *pData, uint32_t NumBytes)
+{
+  return FS_Read((FS_FILE *)pContext, pData, NumBytes);
+}
+
+#endif /* AUDIO_STREAM_USE_EMFILE */
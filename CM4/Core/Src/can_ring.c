@@ -0,0 +1,318 @@
+/**
+  ******************************************************************************
+  * @file    can_ring.c
+  * @brief   CAN frame ring, per-ID software filter and batched draining of
+  *          FDCAN Rx FIFO elements.
+  *
+  *          A drain takes every element the FIFO holds in one pass: each
+  *          element is decoded, time stamped, looked up in the filter and
+  *          copied into the ring, and the write index is published once per
+  *          batch. The caller acknowledges the whole batch with a single
+  *          write of the last index, so the FIFO is freed in one step.
+  *          Frames that find the ring full are still taken from the FIFO
+  *          and counted, which keeps the hardware from overrunning while the
+  *          consumer catches up.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "can_ring.h"
+
+/* Private define ------------------------------------------------------------*/
+#define CAN_FILTER_HASH_MUL     0x9E3779B1U  /* Fibonacci hashing */
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t CAN_FILTER_Hash(const CAN_FilterTypeDef *pFilter, uint32_t Key);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Returns the home slot of a key.
+  * @param  pFilter: Filter.
+  * @param  Key: See CAN_FILTER_KEY().
+  * @retval Slot index.
+  */
+static uint32_t CAN_FILTER_Hash(const CAN_FilterTypeDef *pFilter, uint32_t Key)
+{
+  return (Key * CAN_FILTER_HASH_MUL) >> pFilter->Shift;
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Initializes an empty ring.
+  * @param  pRing: Ring.
+  * @param  pFrames: Frame array.
+  * @param  NumFrames: Number of frames, must be a power of 2.
+  * @retval 0 on success, -1 if NumFrames is not a power of 2.
+  */
+int CAN_RING_Init(CAN_RingTypeDef *pRing, CAN_FrameTypeDef *pFrames, uint32_t NumFrames)
+{
+  if ((NumFrames == 0U) || ((NumFrames & (NumFrames - 1U)) != 0U))
+  {
+    return -1;
+  }
+  pRing->pFrames   = pFrames;
+  pRing->NumFrames = NumFrames;
+  pRing->WrIdx     = 0;
+  pRing->RdIdx     = 0;
+  return 0;
+}
+
+/**
+  * @brief  Removes frames in order of reception. Consumer only.
+  * @param  pRing: Ring.
+  * @param  pDest: Destination array.
+  * @param  MaxFrames: Capacity of pDest.
+  * @retval Number of frames copied.
+  */
+uint32_t CAN_RING_Get(CAN_RingTypeDef *pRing, CAN_FrameTypeDef *pDest, uint32_t MaxFrames)
+{
+  uint32_t RdIdx;
+  uint32_t Avail;
+  uint32_t n;
+
+  RdIdx = pRing->RdIdx;
+  Avail = __atomic_load_n(&pRing->WrIdx, __ATOMIC_ACQUIRE) - RdIdx;
+  if (Avail > MaxFrames)
+  {
+    Avail = MaxFrames;
+  }
+  for (n = 0; n < Avail; n++)
+  {
+    pDest[n] = pRing->pFrames[(RdIdx + n) & (pRing->NumFrames - 1U)];
+  }
+  __atomic_store_n(&pRing->RdIdx, RdIdx + Avail, __ATOMIC_RELEASE);
+  return Avail;
+}
+
+/**
+  * @brief  Returns the number of frames waiting in the ring.
+  * @param  pRing: Ring.
+  * @retval Number of frames.
+  */
+uint32_t CAN_RING_GetCount(const CAN_RingTypeDef *pRing)
+{
+  return __atomic_load_n(&pRing->WrIdx, __ATOMIC_ACQUIRE) - __atomic_load_n(&pRing->RdIdx, __ATOMIC_ACQUIRE);
+}
+
+/**
+  * @brief  Initializes an empty filter.
+  * @param  pFilter: Filter.
+  * @param  pEntries: Entry array.
+  * @param  NumEntries: Number of entries, a power of 2 of at least 4.
+  * @param  DefaultAction: Action for identifiers that are not in the table.
+  * @retval 0 on success, -1 if NumEntries is not valid.
+  */
+int CAN_FILTER_Init(CAN_FilterTypeDef *pFilter, CAN_FilterEntryTypeDef *pEntries, uint32_t NumEntries, uint8_t DefaultAction)
+{
+  uint32_t i;
+
+  if ((NumEntries < 4U) || ((NumEntries & (NumEntries - 1U)) != 0U))
+  {
+    return -1;
+  }
+  for (i = 0; i < NumEntries; i++)
+  {
+    pEntries[i].Key    = CAN_FILTER_KEY_EMPTY;
+    pEntries[i].Action = CAN_FILTER_DROP;
+  }
+  pFilter->Shift = 32U;
+  for (i = NumEntries; i > 1U; i >>= 1)
+  {
+    pFilter->Shift--;
+  }
+  pFilter->pEntries      = pEntries;
+  pFilter->NumEntries    = NumEntries;
+  pFilter->NumUsed       = 0;
+  pFilter->DefaultAction = DefaultAction;
+  return 0;
+}
+
+/**
+  * @brief  Adds an identifier to the filter or changes its action. Must not
+  *         run concurrently with a drain that uses the same filter.
+  * @param  pFilter: Filter.
+  * @param  Id: 11 or 29 bit identifier.
+  * @param  Xtd: Nonzero for a 29 bit identifier.
+  * @param  Action: CAN_FILTER_DROP or a tag of CAN_FILTER_ACCEPT or above.
+  * @retval 0 on success, -1 if the table is 3/4 full.
+  */
+int CAN_FILTER_Set(CAN_FilterTypeDef *pFilter, uint32_t Id, int Xtd, uint8_t Action)
+{
+  uint32_t Key;
+  uint32_t Idx;
+
+  Key = CAN_FILTER_KEY(Id, Xtd);
+  Idx = CAN_FILTER_Hash(pFilter, Key);
+  for (;;)
+  {
+    if (pFilter->pEntries[Idx].Key == Key)
+    {
+      pFilter->pEntries[Idx].Action = Action;
+      return 0;
+    }
+    if (pFilter->pEntries[Idx].Key == CAN_FILTER_KEY_EMPTY)
+    {
+      break;
+    }
+    Idx = (Idx + 1U) & (pFilter->NumEntries - 1U);
+  }
+  /* Keep free slots so that a lookup of an unknown ID ends quickly */
+  if (pFilter->NumUsed >= ((pFilter->NumEntries / 4U) * 3U))
+  {
+    return -1;
+  }
+  pFilter->pEntries[Idx].Action = Action;
+  pFilter->pEntries[Idx].Key    = Key;
+  pFilter->NumUsed++;
+  return 0;
+}
+
+/**
+  * @brief  Returns the action for an identifier.
+  * @param  pFilter: Filter.
+  * @param  Key: See CAN_FILTER_KEY().
+  * @retval Action.
+  */
+uint8_t CAN_FILTER_Lookup(const CAN_FilterTypeDef *pFilter, uint32_t Key)
+{
+  uint32_t Idx;
+
+  Idx = CAN_FILTER_Hash(pFilter, Key);
+  for (;;)
+  {
+    if (pFilter->pEntries[Idx].Key == Key)
+    {
+      return pFilter->pEntries[Idx].Action;
+    }
+    if (pFilter->pEntries[Idx].Key == CAN_FILTER_KEY_EMPTY)
+    {
+      return pFilter->DefaultAction;
+    }
+    Idx = (Idx + 1U) & (pFilter->NumEntries - 1U);
+  }
+}
+
+/**
+  * @brief  Takes all elements of an Rx FIFO into the ring. Producer only.
+  * @param  pRing: Ring.
+  * @param  pFilter: Software filter.
+  * @param  pFifo: FIFO in the message RAM.
+  * @param  GetIndex: Get index of the FIFO.
+  * @param  FillLevel: Fill level of the FIFO.
+  * @param  pTime: Time reference taken right before the drain.
+  * @param  Bus: Bus index stored in the frames.
+  * @param  pStat: Counters of the bus.
+  * @retval Number of elements taken. The caller acknowledges
+  *         (GetIndex + n - 1) mod NumElements if n is not 0.
+  */
+uint32_t CAN_RING_DrainFifo(CAN_RingTypeDef *pRing, const CAN_FilterTypeDef *pFilter,
+                            const CAN_FifoTypeDef *pFifo, uint32_t GetIndex, uint32_t FillLevel,
+                            const CAN_TimeRefTypeDef *pTime, uint8_t Bus, CAN_StatTypeDef *pStat)
+{
+  const volatile uint32_t *pElem;
+  CAN_FrameTypeDef        *pFrame;
+  uint32_t                 WrIdx;
+  uint32_t                 RdIdx;
+  uint32_t                 R0;
+  uint32_t                 R1;
+  uint32_t                 Key;
+  uint32_t                 Age;
+  uint32_t                 n;
+  uint8_t                  Action;
+
+  WrIdx = pRing->WrIdx;
+  RdIdx = __atomic_load_n(&pRing->RdIdx, __ATOMIC_ACQUIRE);
+  for (n = 0; n < FillLevel; n++)
+  {
+    pElem = pFifo->pElements + (GetIndex * pFifo->ElementWords);
+    R0    = pElem[0];
+    Key   = ((R0 & CAN_ELEM_R0_XTD) != 0U) ? ((R0 & CAN_ELEM_R0_ID_MSK) | CAN_FILTER_KEY_XTD)
+                                           : ((R0 & CAN_ELEM_R0_ID_MSK) >> CAN_ELEM_R0_STDID_POS);
+    Action = CAN_FILTER_Lookup(pFilter, Key);
+    if (Action == CAN_FILTER_DROP)
+    {
+      pStat->NumFiltered++;
+    }
+    else if ((WrIdx - RdIdx) >= pRing->NumFrames)
+    {
+      pStat->NumDropped++;
+    }
+    else
+    {
+      R1     = pElem[1];
+      Age    = (pTime->NowTs - (R1 & CAN_ELEM_R1_RXTS_MSK)) & CAN_ELEM_R1_RXTS_MSK;
+      pFrame = &pRing->pFrames[WrIdx & (pRing->NumFrames - 1U)];
+      pFrame->Time  = pTime->Now - (uint32_t)(((uint64_t)Age * pTime->CyclesPerTsQ16) >> 16);
+      pFrame->Id    = Key & CAN_ELEM_R0_ID_MSK;
+      pFrame->Bus   = Bus;
+      pFrame->Flags = (uint8_t)((((R0 & CAN_ELEM_R0_XTD) != 0U) ? CAN_FRAME_XTD : 0U) |
+                                (((R0 & CAN_ELEM_R0_RTR) != 0U) ? CAN_FRAME_RTR : 0U) |
+                                (((R0 & CAN_ELEM_R0_ESI) != 0U) ? CAN_FRAME_ESI : 0U));
+      pFrame->Dlc   = (uint8_t)((R1 & CAN_ELEM_R1_DLC_MSK) >> CAN_ELEM_R1_DLC_POS);
+      pFrame->Tag   = Action;
+      ((uint32_t *)(void *)pFrame->aData)[0] = pElem[2];
+      ((uint32_t *)(void *)pFrame->aData)[1] = pElem[3];
+      WrIdx++;
+      pStat->NumAccepted++;
+    }
+    GetIndex++;
+    if (GetIndex == pFifo->NumElements)
+    {
+      GetIndex = 0;
+    }
+  }
+  __atomic_store_n(&pRing->WrIdx, WrIdx, __ATOMIC_RELEASE);
+
+  pStat->NumReceived += n;
+  pStat->NumBatches++;
+  if (n > pStat->MaxBatch)
+  {
+    pStat->MaxBatch = n;
+  }
+  return n;
+}
+
+/**
+  * @brief  Returns the CPU cycles per FDCAN timestamp tick for the largest
+  *         timestamp prescaler that keeps the factor below 65536 cycles.
+  *         Slow bit rates need a smaller prescaler than fast ones.
+  * @param  CpuClock: CPU clock in Hz.
+  * @param  CanClock: FDCAN kernel clock in Hz.
+  * @param  BitClocks: Kernel clocks per nominal bit time.
+  * @param  pPrescaler: In: largest allowed prescaler (bit times per tick,
+  *         1..16). Out: prescaler the factor is for.
+  * @retval Cycles per tick in 16.16 format, 0 if no prescaler fits.
+  */
+uint32_t CAN_RING_GetCyclesPerTsQ16(uint32_t CpuClock, uint32_t CanClock, uint32_t BitClocks, uint32_t *pPrescaler)
+{
+  uint64_t Cycles;
+  uint32_t Prescaler;
+
+  if (CanClock == 0U)
+  {
+    return 0;
+  }
+  for (Prescaler = *pPrescaler; Prescaler > 0U; Prescaler--)
+  {
+    Cycles = (uint64_t)CpuClock * BitClocks * Prescaler;
+    if ((Cycles / CanClock) < 0x10000U)
+    {
+      *pPrescaler = Prescaler;
+      /* Cycles < 2^16 * CanClock, so the shift cannot overflow */
+      return (uint32_t)((Cycles << 16) / CanClock);
+    }
+  }
+  return 0;
+}
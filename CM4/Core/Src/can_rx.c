@@ -0,0 +1,387 @@
+/**
+  ******************************************************************************
+  * @file    can_rx.c
+  * @brief   FDCAN1/FDCAN2 receive pipeline of the Cortex-M4.
+  *
+  *          Bulk traffic lands in Rx FIFO0, which interrupts only when its
+  *          fill level reaches CAN_RX_FIFO0_WATERMARK; the interrupt then
+  *          takes every waiting element in one pass and frees them with a
+  *          single acknowledge. Identifiers routed to Rx FIFO1 by a hardware
+  *          filter interrupt on every frame. CAN_RX_Poll() flushes whatever
+  *          sits below the watermark at least every CAN_RX_FLUSH_MS.
+  *
+  *          Frames are time stamped in DWT cycles: the FDCAN timestamp
+  *          counter latched in each element is converted relative to a
+  *          reading of both counters taken at the start of the drain.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "can_rx.h"
+
+/* Private variables ---------------------------------------------------------*/
+extern FDCAN_HandleTypeDef hfdcan1;
+extern FDCAN_HandleTypeDef hfdcan2;
+
+static FDCAN_HandleTypeDef * const CAN_RX_aHandle[CAN_RX_NUM_BUS] = { &hfdcan1, &hfdcan2 };
+
+static CAN_FrameTypeDef       CAN_RX_aFrames[CAN_RX_RING_SIZE];
+static CAN_FilterEntryTypeDef CAN_RX_aFilterEntries[CAN_RX_FILTER_SIZE];
+static CAN_RingTypeDef        CAN_RX_Ring;
+static CAN_FilterTypeDef      CAN_RX_Filter;
+static CAN_StatTypeDef        CAN_RX_aStat[CAN_RX_NUM_BUS];
+static uint32_t               CAN_RX_aCyclesPerTsQ16[CAN_RX_NUM_BUS];
+static uint32_t               CAN_RX_aNumStdFilters[CAN_RX_NUM_BUS];
+static uint32_t               CAN_RX_aNumExtFilters[CAN_RX_NUM_BUS];
+static uint32_t               CAN_RX_LastFlush;
+static uint8_t                CAN_RX_Started;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t CAN_RX_GetBus(const FDCAN_HandleTypeDef *hfdcan);
+static void     CAN_RX_Drain(uint32_t Bus, uint32_t Fifo);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Returns the bus index of a handle.
+  * @param  hfdcan: FDCAN handle.
+  * @retval Bus index.
+  */
+static uint32_t CAN_RX_GetBus(const FDCAN_HandleTypeDef *hfdcan)
+{
+  return (hfdcan == &hfdcan1) ? 0U : 1U;
+}
+
+/**
+  * @brief  Takes all elements of one Rx FIFO into the ring and acknowledges
+  *         them at once. Runs with the FDCAN interrupts masked.
+  * @param  Bus: Bus index.
+  * @param  Fifo: CAN_RX_FIFO0 or CAN_RX_FIFO1.
+  * @retval None
+  */
+static void CAN_RX_Drain(uint32_t Bus, uint32_t Fifo)
+{
+  FDCAN_HandleTypeDef *hfdcan;
+  CAN_FifoTypeDef      Desc;
+  CAN_TimeRefTypeDef   Time;
+  uint32_t             Status;
+  uint32_t             FillLevel;
+  uint32_t             GetIndex;
+  uint32_t             n;
+
+  hfdcan = CAN_RX_aHandle[Bus];
+  if (Fifo == CAN_RX_FIFO0)
+  {
+    Status            = hfdcan->Instance->RXF0S;
+    FillLevel         = Status & FDCAN_RXF0S_F0FL;
+    GetIndex          = (Status & FDCAN_RXF0S_F0GI) >> FDCAN_RXF0S_F0GI_Pos;
+    Desc.pElements    = (const volatile uint32_t *)hfdcan->msgRam.RxFIFO0SA;
+    Desc.ElementWords = hfdcan->Init.RxFifo0ElmtSize;
+    Desc.NumElements  = hfdcan->Init.RxFifo0ElmtsNbr;
+  }
+  else
+  {
+    Status            = hfdcan->Instance->RXF1S;
+    FillLevel         = Status & FDCAN_RXF1S_F1FL;
+    GetIndex          = (Status & FDCAN_RXF1S_F1GI) >> FDCAN_RXF1S_F1GI_Pos;
+    Desc.pElements    = (const volatile uint32_t *)hfdcan->msgRam.RxFIFO1SA;
+    Desc.ElementWords = hfdcan->Init.RxFifo1ElmtSize;
+    Desc.NumElements  = hfdcan->Init.RxFifo1ElmtsNbr;
+  }
+  if (FillLevel == 0U)
+  {
+    return;
+  }
+
+  Time.Now            = DWT->CYCCNT;
+  Time.NowTs          = hfdcan->Instance->TSCV & FDCAN_TSCV_TSC;
+  Time.CyclesPerTsQ16 = CAN_RX_aCyclesPerTsQ16[Bus];
+
+  n = CAN_RING_DrainFifo(&CAN_RX_Ring, &CAN_RX_Filter, &Desc, GetIndex, FillLevel,
+                         &Time, (uint8_t)Bus, &CAN_RX_aStat[Bus]);
+
+  /* Acknowledging the last element frees all elements up to it */
+  GetIndex = (GetIndex + n - 1U) % Desc.NumElements;
+  if (Fifo == CAN_RX_FIFO0)
+  {
+    hfdcan->Instance->RXF0A = GetIndex;
+  }
+  else
+  {
+    hfdcan->Instance->RXF1A = GetIndex;
+  }
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Sets up the ring, the software filter, the time base and the
+  *         FIFO watermarks. Call after MX_FDCANx_Init() and before any
+  *         CAN_RX_AddHwFilter().
+  * @retval 0 on success, -1 on error.
+  */
+int CAN_RX_Init(void)
+{
+  FDCAN_HandleTypeDef *hfdcan;
+  uint32_t             FdcanClock;
+  uint32_t             BitClocks;
+  uint32_t             Prescaler;
+  uint32_t             Bus;
+
+  if ((CAN_RING_Init(&CAN_RX_Ring, CAN_RX_aFrames, CAN_RX_RING_SIZE) != 0) ||
+      (CAN_FILTER_Init(&CAN_RX_Filter, CAN_RX_aFilterEntries, CAN_RX_FILTER_SIZE, CAN_FILTER_ACCEPT) != 0))
+  {
+    return -1;
+  }
+
+  /* DWT cycle counter is the time base of the frames */
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+
+  FdcanClock = HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_FDCAN);
+  if (FdcanClock == 0U)
+  {
+    return -1;
+  }
+
+  for (Bus = 0; Bus < CAN_RX_NUM_BUS; Bus++)
+  {
+    hfdcan = CAN_RX_aHandle[Bus];
+    /* One timestamp tick is Prescaler nominal bit times, at most CAN_RX_TS_PRESCALER */
+    BitClocks = hfdcan->Init.NominalPrescaler *
+                (1U + hfdcan->Init.NominalTimeSeg1 + hfdcan->Init.NominalTimeSeg2);
+    Prescaler = CAN_RX_TS_PRESCALER;
+    CAN_RX_aCyclesPerTsQ16[Bus] = CAN_RING_GetCyclesPerTsQ16(SystemCoreClock, FdcanClock, BitClocks, &Prescaler);
+    if ((CAN_RX_aCyclesPerTsQ16[Bus] == 0U) ||
+        (HAL_FDCAN_ConfigTimestampCounter(hfdcan, (Prescaler - 1U) << FDCAN_TSCC_TCP_Pos) != HAL_OK) ||
+        (HAL_FDCAN_EnableTimestampCounter(hfdcan, FDCAN_TIMESTAMP_INTERNAL) != HAL_OK) ||
+        (HAL_FDCAN_ConfigFifoWatermark(hfdcan, FDCAN_CFG_RX_FIFO0, CAN_RX_FIFO0_WATERMARK) != HAL_OK))
+    {
+      return -1;
+    }
+    CAN_RX_aNumStdFilters[Bus] = 0;
+    CAN_RX_aNumExtFilters[Bus] = 0;
+  }
+  return 0;
+}
+
+/**
+  * @brief  Adds a hardware acceptance filter. Once a bus has a filter for an
+  *         identifier type, non-matching frames of that type are rejected by
+  *         the hardware. Call between CAN_RX_Init() and CAN_RX_Start().
+  * @param  Bus: Bus index.
+  * @param  Id: Filter identifier.
+  * @param  Mask: Identifier bits that must match.
+  * @param  Xtd: Nonzero for 29 bit identifiers.
+  * @param  Fifo: CAN_RX_FIFO0 for bulk traffic, CAN_RX_FIFO1 for traffic
+  *         that must not wait for the watermark.
+  * @retval 0 on success, -1 if the bus has no filter element left.
+  */
+int CAN_RX_AddHwFilter(uint32_t Bus, uint32_t Id, uint32_t Mask, int Xtd, uint32_t Fifo)
+{
+  FDCAN_FilterTypeDef sFilterConfig = {0};
+  FDCAN_HandleTypeDef *hfdcan;
+  uint32_t            *pNumFilters;
+
+  if ((Bus >= CAN_RX_NUM_BUS) || (CAN_RX_Started != 0U))
+  {
+    return -1;
+  }
+  hfdcan      = CAN_RX_aHandle[Bus];
+  pNumFilters = Xtd ? &CAN_RX_aNumExtFilters[Bus] : &CAN_RX_aNumStdFilters[Bus];
+  if (*pNumFilters >= (Xtd ? hfdcan->Init.ExtFiltersNbr : hfdcan->Init.StdFiltersNbr))
+  {
+    return -1;
+  }
+
+  sFilterConfig.IdType       = Xtd ? FDCAN_EXTENDED_ID : FDCAN_STANDARD_ID;
+  sFilterConfig.FilterIndex  = *pNumFilters;
+  sFilterConfig.FilterType   = FDCAN_FILTER_MASK;
+  sFilterConfig.FilterConfig = (Fifo == CAN_RX_FIFO1) ? FDCAN_FILTER_TO_RXFIFO1 : FDCAN_FILTER_TO_RXFIFO0;
+  sFilterConfig.FilterID1    = Id;
+  sFilterConfig.FilterID2    = Mask;
+  if (HAL_FDCAN_ConfigFilter(hfdcan, &sFilterConfig) != HAL_OK)
+  {
+    return -1;
+  }
+  (*pNumFilters)++;
+  return 0;
+}
+
+/**
+  * @brief  Sets the software filter action of one identifier. Frames whose
+  *         action is CAN_FILTER_DROP are taken from the FIFO but not stored,
+  *         other actions are stored in CAN_FrameTypeDef.Tag.
+  * @param  Id: 11 or 29 bit identifier.
+  * @param  Xtd: Nonzero for a 29 bit identifier.
+  * @param  Action: CAN_FILTER_DROP or a tag.
+  * @retval 0 on success, -1 if the table is full.
+  */
+int CAN_RX_AddIdFilter(uint32_t Id, int Xtd, uint8_t Action)
+{
+  uint32_t primask;
+  int      r;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  r = CAN_FILTER_Set(&CAN_RX_Filter, Id, Xtd, Action);
+  __set_PRIMASK(primask);
+  return r;
+}
+
+/**
+  * @brief  Sets the software filter action of identifiers without an entry.
+  * @param  Action: CAN_FILTER_DROP or a tag, CAN_FILTER_ACCEPT after init.
+  * @retval None
+  */
+void CAN_RX_SetDefaultAction(uint8_t Action)
+{
+  CAN_RX_Filter.DefaultAction = Action;
+}
+
+/**
+  * @brief  Enables the receive interrupts and starts both instances.
+  * @retval 0 on success, -1 on error.
+  */
+int CAN_RX_Start(void)
+{
+  FDCAN_HandleTypeDef *hfdcan;
+  uint32_t             Bus;
+
+  for (Bus = 0; Bus < CAN_RX_NUM_BUS; Bus++)
+  {
+    hfdcan = CAN_RX_aHandle[Bus];
+    if ((HAL_FDCAN_ConfigGlobalFilter(hfdcan,
+                                      (CAN_RX_aNumStdFilters[Bus] == 0U) ? FDCAN_ACCEPT_IN_RX_FIFO0 : FDCAN_REJECT,
+                                      (CAN_RX_aNumExtFilters[Bus] == 0U) ? FDCAN_ACCEPT_IN_RX_FIFO0 : FDCAN_REJECT,
+                                      FDCAN_FILTER_REMOTE, FDCAN_FILTER_REMOTE) != HAL_OK) ||
+        (HAL_FDCAN_ActivateNotification(hfdcan,
+                                        FDCAN_IT_RX_FIFO0_WATERMARK | FDCAN_IT_RX_FIFO0_MESSAGE_LOST |
+                                        FDCAN_IT_RX_FIFO1_NEW_MESSAGE | FDCAN_IT_RX_FIFO1_MESSAGE_LOST,
+                                        0) != HAL_OK))
+    {
+      return -1;
+    }
+  }
+
+  /* Same priority on both lines: the drains never preempt each other */
+  HAL_NVIC_SetPriority(FDCAN1_IT0_IRQn, CAN_RX_IRQ_PRIORITY, 0);
+  HAL_NVIC_SetPriority(FDCAN2_IT0_IRQn, CAN_RX_IRQ_PRIORITY, 0);
+  HAL_NVIC_EnableIRQ(FDCAN1_IT0_IRQn);
+  HAL_NVIC_EnableIRQ(FDCAN2_IT0_IRQn);
+
+  CAN_RX_LastFlush = HAL_GetTick();
+  CAN_RX_Started   = 1U;
+  for (Bus = 0; Bus < CAN_RX_NUM_BUS; Bus++)
+  {
+    if (HAL_FDCAN_Start(CAN_RX_aHandle[Bus]) != HAL_OK)
+    {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/**
+  * @brief  Flushes frames waiting below the FIFO0 watermark. Call from the
+  *         main loop.
+  * @retval None
+  */
+void CAN_RX_Poll(void)
+{
+  uint32_t primask;
+  uint32_t Bus;
+
+  if ((CAN_RX_Started == 0U) || ((HAL_GetTick() - CAN_RX_LastFlush) < CAN_RX_FLUSH_MS))
+  {
+    return;
+  }
+  CAN_RX_LastFlush = HAL_GetTick();
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  for (Bus = 0; Bus < CAN_RX_NUM_BUS; Bus++)
+  {
+    CAN_RX_Drain(Bus, CAN_RX_FIFO0);
+  }
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  Removes received frames in order of reception. Single consumer.
+  * @param  pFrames: Destination array.
+  * @param  MaxFrames: Capacity of pFrames.
+  * @retval Number of frames copied.
+  */
+uint32_t CAN_RX_Read(CAN_FrameTypeDef *pFrames, uint32_t MaxFrames)
+{
+  return CAN_RING_Get(&CAN_RX_Ring, pFrames, MaxFrames);
+}
+
+/**
+  * @brief  Returns the counters of one bus.
+  * @param  Bus: Bus index.
+  * @param  pStat: Receives the counters.
+  * @retval None
+  */
+void CAN_RX_GetStat(uint32_t Bus, CAN_StatTypeDef *pStat)
+{
+  uint32_t primask;
+
+  if (Bus >= CAN_RX_NUM_BUS)
+  {
+    return;
+  }
+  primask = __get_PRIMASK();
+  __disable_irq();
+  *pStat = CAN_RX_aStat[Bus];
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  Rx FIFO0 watermark or message lost.
+  * @param  hfdcan: FDCAN handle.
+  * @param  RxFifo0ITs: Signaled interrupts.
+  * @retval None
+  */
+void HAL_FDCAN_RxFifo0Callback(FDCAN_HandleTypeDef *hfdcan, uint32_t RxFifo0ITs)
+{
+  uint32_t Bus;
+
+  Bus = CAN_RX_GetBus(hfdcan);
+  if ((RxFifo0ITs & FDCAN_IT_RX_FIFO0_MESSAGE_LOST) != 0U)
+  {
+    CAN_RX_aStat[Bus].NumOverruns++;
+  }
+  CAN_RX_Drain(Bus, CAN_RX_FIFO0);
+}
+
+/**
+  * @brief  Rx FIFO1 new message or message lost.
+  * @param  hfdcan: FDCAN handle.
+  * @param  RxFifo1ITs: Signaled interrupts.
+  * @retval None
+  */
+void HAL_FDCAN_RxFifo1Callback(FDCAN_HandleTypeDef *hfdcan, uint32_t RxFifo1ITs)
+{
+  uint32_t Bus;
+
+  Bus = CAN_RX_GetBus(hfdcan);
+  if ((RxFifo1ITs & FDCAN_IT_RX_FIFO1_MESSAGE_LOST) != 0U)
+  {
+    CAN_RX_aStat[Bus].NumOverruns++;
+  }
+  CAN_RX_Drain(Bus, CAN_RX_FIFO1);
+}
+
@@ -0,0 +1,299 @@
+/**
+  ******************************************************************************
+  * @file    eth_dma.c
+  * @brief   Ethernet DMA engine of the Cortex-M4.
+  *
+  *          Replaces the HAL receive path (HAL_ETH_Start_IT/HAL_ETH_ReadData)
+  *          with eth_ring.c on the descriptor tables set up by MX_ETH_Init().
+  *          HAL_ETH_Init() still configures the MAC, MTL and DMA, and
+  *          HAL_ETH_IRQHandler() still dispatches the interrupts.
+  *
+  *          Receive: only every ETH_DMA_RX_IOC_INTERVAL-th descriptor asks
+  *          for an interrupt; the receive watchdog raises it for the others
+  *          after ETH_DMA_RX_WATCHDOG_US. The interrupt masks itself and
+  *          marks the ring scheduled. ETH_DMA_Receive() then takes packets
+  *          up to its budget per call, and unmasks the interrupt only once a
+  *          call finds the ring empty, so under load reception costs no
+  *          interrupts at all.
+  *
+  *          Transmit needs no interrupt: finished descriptors are taken back
+  *          by ETH_DMA_Receive() and when the TX ring runs short.
+  *
+  *          Descriptors and buffers live in D2 SRAM (.eth_dma, see linker
+  *          script). The Cortex-M4 has no data cache; the cache maintenance
+  *          below only generates code on a core that has one.
+  *
+  *          All functions except the interrupt callbacks belong to one
+  *          context (the main loop).
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "eth_dma.h"
+
+/* Private define ------------------------------------------------------------*/
+#define ETH_DMA_DESC_WORDS      (sizeof(ETH_DMADescTypeDef) / sizeof(uint32_t))
+#define ETH_DMA_RIWT_CLOCKS     256U    /* Receive watchdog unit in bus clocks */
+
+/* Private macro -------------------------------------------------------------*/
+#if defined(__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
+#define ETH_DMA_CACHE_CLEAN(p, len)       SCB_CleanDCache_by_Addr((uint32_t *)(void *)(p), (int32_t)(len))
+#define ETH_DMA_CACHE_INVALIDATE(p, len)  SCB_InvalidateDCache_by_Addr((void *)(p), (int32_t)(len))
+#else
+#define ETH_DMA_CACHE_CLEAN(p, len)
+#define ETH_DMA_CACHE_INVALIDATE(p, len)
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+extern ETH_HandleTypeDef  heth;
+extern ETH_DMADescTypeDef DMARxDscrTab[ETH_RX_DESC_CNT];
+extern ETH_DMADescTypeDef DMATxDscrTab[ETH_TX_DESC_CNT];
+
+static uint8_t ETH_DMA_aPool[ETH_DMA_POOL_BUFS][ETH_DMA_BUF_SIZE] __attribute__((section(".eth_pool"), aligned(32)));
+static uint8_t        *ETH_DMA_apFree[ETH_DMA_POOL_BUFS];
+static uint8_t        *ETH_DMA_apRxBuf[ETH_RX_DESC_CNT];
+static uint8_t        *ETH_DMA_apTxBuf[ETH_TX_DESC_CNT];
+static ETH_PoolTypeDef ETH_DMA_Pool;
+static ETH_RingTypeDef ETH_DMA_RxRing;
+static ETH_RingTypeDef ETH_DMA_TxRing;
+static ETH_StatTypeDef ETH_DMA_Stat;
+static volatile uint8_t ETH_DMA_RxSched;
+
+/* Private function prototypes -----------------------------------------------*/
+static void ETH_DMA_Refill(void);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Refills the RX ring and moves the DMA tail pointer.
+  * @retval None
+  */
+static void ETH_DMA_Refill(void)
+{
+  if (ETH_RING_RxRefill(&ETH_DMA_RxRing, &ETH_DMA_Pool, &ETH_DMA_Stat) != 0U)
+  {
+    __DSB();
+    WRITE_REG(heth.Instance->DMACRDTPR,
+              (uint32_t)ETH_RING_GetDesc(&ETH_DMA_RxRing, ETH_DMA_RxRing.Tail - 1U));
+  }
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Sets up the pool and takes over the descriptor tables. Call after
+  *         MX_ETH_Init().
+  * @retval 0 on success, -1 on error.
+  */
+int ETH_DMA_Init(void)
+{
+  if ((heth.Init.RxBuffLen > ETH_DMA_BUF_SIZE) ||
+      (ETH_POOL_Init(&ETH_DMA_Pool, &ETH_DMA_aPool[0][0], ETH_DMA_BUF_SIZE, ETH_DMA_POOL_BUFS, ETH_DMA_apFree) != 0) ||
+      (ETH_RING_Init(&ETH_DMA_RxRing, &DMARxDscrTab[0].DESC0, ETH_DMA_DESC_WORDS, ETH_RX_DESC_CNT,
+                     ETH_DMA_apRxBuf, heth.Init.RxBuffLen, ETH_DMA_RX_IOC_INTERVAL) != 0) ||
+      (ETH_RING_Init(&ETH_DMA_TxRing, &DMATxDscrTab[0].DESC0, ETH_DMA_DESC_WORDS, ETH_TX_DESC_CNT,
+                     ETH_DMA_apTxBuf, 0, 0) != 0))
+  {
+    return -1;
+  }
+  return 0;
+}
+
+/**
+  * @brief  Fills the RX ring and starts the DMA and the MAC. Same sequence as
+  *         HAL_ETH_Start_IT(), with this engine's descriptors and interrupts.
+  * @retval 0 on success, -1 on error.
+  */
+int ETH_DMA_Start(void)
+{
+  uint32_t Riwt;
+
+  if (heth.gState != HAL_ETH_STATE_READY)
+  {
+    return -1;
+  }
+
+  WRITE_REG(heth.Instance->DMACTDTPR, (uint32_t)ETH_RING_GetDesc(&ETH_DMA_TxRing, 0));
+  ETH_DMA_Refill();
+
+  Riwt = (uint32_t)(((uint64_t)HAL_RCC_GetHCLKFreq() * ETH_DMA_RX_WATCHDOG_US) / (1000000U * ETH_DMA_RIWT_CLOCKS));
+  if (Riwt > ETH_DMACRIWTR_RWT)
+  {
+    Riwt = ETH_DMACRIWTR_RWT;
+  }
+  WRITE_REG(heth.Instance->DMACRIWTR, (Riwt == 0U) ? 1U : Riwt);
+
+  SET_BIT(heth.Instance->DMACTCR, ETH_DMACTCR_ST);
+  SET_BIT(heth.Instance->DMACRCR, ETH_DMACRCR_SR);
+  heth.Instance->DMACSR |= (ETH_DMACSR_TPS | ETH_DMACSR_RPS);
+  SET_BIT(heth.Instance->MTLTQOMR, ETH_MTLTQOMR_FTQ);
+  SET_BIT(heth.Instance->MACCR, ETH_MACCR_TE);
+  SET_BIT(heth.Instance->MACCR, ETH_MACCR_RE);
+
+  ETH_DMA_RxSched = 0;
+  __HAL_ETH_DMA_ENABLE_IT(&heth, (ETH_DMACIER_NIE | ETH_DMACIER_RIE | ETH_DMACIER_FBEE |
+                                  ETH_DMACIER_AIE | ETH_DMACIER_RBUE));
+  heth.gState = HAL_ETH_STATE_STARTED;
+
+  HAL_NVIC_SetPriority(ETH_IRQn, ETH_DMA_IRQ_PRIORITY, 0);
+  HAL_NVIC_EnableIRQ(ETH_IRQn);
+  return 0;
+}
+
+/**
+  * @brief  Takes received packets, refills the RX ring and takes back sent
+  *         descriptors. Call from the main loop; the buffers of the returned
+  *         packets belong to the caller until ETH_DMA_FreePacket().
+  * @param  pPkts: Destination.
+  * @param  Budget: Capacity of pPkts.
+  * @retval Number of packets. Less than Budget means the ring was emptied
+  *         and the receive interrupt is armed again.
+  */
+uint32_t ETH_DMA_Receive(ETH_PacketTypeDef *pPkts, uint32_t Budget)
+{
+  uint32_t n;
+  uint32_t i;
+  uint32_t s;
+
+  ETH_RING_TxReclaim(&ETH_DMA_TxRing, &ETH_DMA_Pool, &ETH_DMA_Stat);
+
+  n = ETH_RING_RxHarvest(&ETH_DMA_RxRing, &ETH_DMA_Pool, pPkts, Budget, &ETH_DMA_Stat);
+  for (i = 0; i < n; i++)
+  {
+    for (s = 0; s < pPkts[i].NumSegs; s++)
+    {
+      ETH_DMA_CACHE_INVALIDATE(pPkts[i].apSeg[s], pPkts[i].aSegLen[s]);
+    }
+  }
+  ETH_DMA_Refill();
+
+  if (n != 0U)
+  {
+    ETH_DMA_Stat.RxBatches++;
+    if (n > ETH_DMA_Stat.RxMaxBatch)
+    {
+      ETH_DMA_Stat.RxMaxBatch = n;
+    }
+  }
+
+  if ((n < Budget) && (ETH_DMA_RxSched != 0U))
+  {
+    /* Ring empty: arm the interrupt, then look again for a packet that
+       arrived in between */
+    ETH_DMA_RxSched = 0;
+    __HAL_ETH_DMA_CLEAR_IT(&heth, ETH_DMACSR_RI | ETH_DMACSR_NIS);
+    __HAL_ETH_DMA_ENABLE_IT(&heth, ETH_DMACIER_RIE);
+    if (ETH_RING_RxPending(&ETH_DMA_RxRing) != 0)
+    {
+      __HAL_ETH_DMA_DISABLE_IT(&heth, ETH_DMACIER_RIE);
+      ETH_DMA_RxSched = 1;
+    }
+  }
+  return n;
+}
+
+/**
+  * @brief  Tells whether received packets wait for ETH_DMA_Receive(). The
+  *         main loop may sleep while this returns 0.
+  * @retval 1 if scheduled, 0 otherwise.
+  */
+int ETH_DMA_RxScheduled(void)
+{
+  return (ETH_DMA_RxSched != 0U) ? 1 : 0;
+}
+
+/**
+  * @brief  Queues a packet for transmission without copying it.
+  * @param  pPkt: Packet. Pool buffers return to the pool once sent; other
+  *         buffers must stay valid until then and must be reachable by the
+  *         Ethernet DMA.
+  * @retval 0 on success, -1 if the TX ring is full.
+  */
+int ETH_DMA_Transmit(const ETH_PacketTypeDef *pPkt)
+{
+  uint32_t s;
+
+  if (ETH_RING_TxFree(&ETH_DMA_TxRing) < pPkt->NumSegs)
+  {
+    ETH_RING_TxReclaim(&ETH_DMA_TxRing, &ETH_DMA_Pool, &ETH_DMA_Stat);
+  }
+  for (s = 0; s < pPkt->NumSegs; s++)
+  {
+    ETH_DMA_CACHE_CLEAN(pPkt->apSeg[s], pPkt->aSegLen[s]);
+  }
+  if (ETH_RING_TxSubmit(&ETH_DMA_TxRing, pPkt, ETH_DMATXNDESCRF_CIC_IPHDR_PAYLOAD_INSERT_PHDR_CALC,
+                        &ETH_DMA_Stat) != 0)
+  {
+    return -1;
+  }
+  __DSB();
+  WRITE_REG(heth.Instance->DMACTDTPR, (uint32_t)ETH_RING_GetDesc(&ETH_DMA_TxRing, ETH_DMA_TxRing.Tail));
+  return 0;
+}
+
+/**
+  * @brief  Takes a buffer for a packet to transmit.
+  * @retval Buffer of ETH_DMA_BUF_SIZE bytes, NULL if none is free.
+  */
+uint8_t *ETH_DMA_AllocBuffer(void)
+{
+  return ETH_POOL_Alloc(&ETH_DMA_Pool);
+}
+
+/**
+  * @brief  Returns the buffers of a received packet.
+  * @param  pPkt: Packet from ETH_DMA_Receive().
+  * @retval None
+  */
+void ETH_DMA_FreePacket(ETH_PacketTypeDef *pPkt)
+{
+  ETH_POOL_FreePacket(&ETH_DMA_Pool, pPkt);
+}
+
+/**
+  * @brief  Returns the counters.
+  * @param  pStat: Receives the counters.
+  * @retval None
+  */
+void ETH_DMA_GetStat(ETH_StatTypeDef *pStat)
+{
+  *pStat = ETH_DMA_Stat;
+}
+
+/**
+  * @brief  Receive interrupt: hand the ring to ETH_DMA_Receive().
+  * @param  heth: ETH handle.
+  * @retval None
+  */
+void HAL_ETH_RxCpltCallback(ETH_HandleTypeDef *heth)
+{
+  __HAL_ETH_DMA_DISABLE_IT(heth, ETH_DMACIER_RIE);
+  ETH_DMA_RxSched = 1;
+  ETH_DMA_Stat.RxInterrupts++;
+}
+
+/**
+  * @brief  DMA error interrupt. A receive buffer unavailable stop resumes by
+  *         itself with the next tail pointer write of the refill.
+  * @param  heth: ETH handle.
+  * @retval None
+  */
+void HAL_ETH_ErrorCallback(ETH_HandleTypeDef *heth)
+{
+  if ((heth->DMAErrorCode & ETH_DMACSR_RBU) != 0U)
+  {
+    ETH_DMA_Stat.RxBufUnavail++;
+    ETH_DMA_RxSched = 1;
+  }
+}
@@ -0,0 +1,429 @@
+/**
+  ******************************************************************************
+  * @file    eth_ring.c
+  * @brief   Packet buffer pool and Ethernet DMA descriptor rings.
+  *
+  *          Buffers move between the pool, the descriptors and the
+  *          application by pointer only. A received packet is returned as
+  *          the list of buffers the DMA wrote; its descriptors are refilled
+  *          from the pool, and the application gives the buffers back with
+  *          ETH_POOL_FreePacket() when done. A transmitted packet takes one
+  *          descriptor per buffer; pool buffers are freed when the DMA hands
+  *          their descriptors back, other memory stays with the caller.
+  *
+  *          Descriptor layout follows the STM32H7 Ethernet DMA (normal
+  *          descriptors, buffer 1 only, ring mode). Word 3 is written last,
+  *          after a barrier, since it carries the OWN bit.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include "eth_ring.h"
+
+/* Private macro -------------------------------------------------------------*/
+#define ETH_RING_ADDR(p)        ((uint32_t)(uintptr_t)(p))
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Initializes a pool with all buffers free.
+  * @param  pPool: Pool.
+  * @param  pMem: NumBufs * BufSize bytes.
+  * @param  BufSize: Buffer stride, a multiple of the DMA burst alignment.
+  * @param  NumBufs: Number of buffers.
+  * @param  ppFree: Free stack, NumBufs entries.
+  * @retval 0 on success, -1 on invalid parameters.
+  */
+int ETH_POOL_Init(ETH_PoolTypeDef *pPool, uint8_t *pMem, uint32_t BufSize, uint32_t NumBufs, uint8_t **ppFree)
+{
+  uint32_t i;
+
+  if ((pMem == NULL) || (BufSize == 0U) || (NumBufs == 0U))
+  {
+    return -1;
+  }
+  pPool->pBase   = pMem;
+  pPool->BufSize = BufSize;
+  pPool->NumBufs = NumBufs;
+  pPool->ppFree  = ppFree;
+  for (i = 0; i < NumBufs; i++)
+  {
+    ppFree[i] = pMem + ((NumBufs - 1U - i) * BufSize);
+  }
+  pPool->NumFree = NumBufs;
+  pPool->MinFree = NumBufs;
+  return 0;
+}
+
+/**
+  * @brief  Takes a buffer from the pool.
+  * @param  pPool: Pool.
+  * @retval Buffer, NULL if the pool is empty.
+  */
+uint8_t *ETH_POOL_Alloc(ETH_PoolTypeDef *pPool)
+{
+  if (pPool->NumFree == 0U)
+  {
+    return NULL;
+  }
+  pPool->NumFree--;
+  if (pPool->NumFree < pPool->MinFree)
+  {
+    pPool->MinFree = pPool->NumFree;
+  }
+  return pPool->ppFree[pPool->NumFree];
+}
+
+/**
+  * @brief  Returns a buffer to the pool.
+  * @param  pPool: Pool.
+  * @param  pBuf: Buffer taken with ETH_POOL_Alloc().
+  * @retval None
+  */
+void ETH_POOL_Free(ETH_PoolTypeDef *pPool, uint8_t *pBuf)
+{
+  if (pPool->NumFree < pPool->NumBufs)
+  {
+    pPool->ppFree[pPool->NumFree++] = pBuf;
+  }
+}
+
+/**
+  * @brief  Tells whether a buffer belongs to the pool.
+  * @param  pPool: Pool.
+  * @param  pBuf: Any address.
+  * @retval 1 if pBuf lies in the pool memory, 0 otherwise.
+  */
+int ETH_POOL_Owns(const ETH_PoolTypeDef *pPool, const uint8_t *pBuf)
+{
+  return ((pBuf >= pPool->pBase) && (pBuf < (pPool->pBase + (pPool->NumBufs * pPool->BufSize)))) ? 1 : 0;
+}
+
+/**
+  * @brief  Returns all buffers of a received packet to the pool.
+  * @param  pPool: Pool.
+  * @param  pPkt: Packet, NumSegs is 0 afterwards.
+  * @retval None
+  */
+void ETH_POOL_FreePacket(ETH_PoolTypeDef *pPool, ETH_PacketTypeDef *pPkt)
+{
+  uint32_t i;
+
+  for (i = 0; i < pPkt->NumSegs; i++)
+  {
+    ETH_POOL_Free(pPool, pPkt->apSeg[i]);
+  }
+  pPkt->NumSegs = 0;
+}
+
+/**
+  * @brief  Initializes an empty ring. All descriptors are cleared, so none is
+  *         owned by the DMA.
+  * @param  pRing: Ring.
+  * @param  pDesc: First descriptor.
+  * @param  DescWords: Descriptor stride in words, at least 4.
+  * @param  NumDesc: Number of descriptors, a power of 2.
+  * @param  apBuf: Buffer shadow, NumDesc entries.
+  * @param  BufLen: RX: buffer size programmed in the DMA. TX: unused.
+  * @param  IocInterval: Request an interrupt every IocInterval descriptors,
+  *         0 for never.
+  * @retval 0 on success, -1 on invalid parameters.
+  */
+int ETH_RING_Init(ETH_RingTypeDef *pRing, volatile uint32_t *pDesc, uint32_t DescWords, uint32_t NumDesc,
+                  uint8_t **apBuf, uint32_t BufLen, uint32_t IocInterval)
+{
+  uint32_t i;
+
+  if ((DescWords < 4U) || (NumDesc == 0U) || ((NumDesc & (NumDesc - 1U)) != 0U))
+  {
+    return -1;
+  }
+  pRing->pDesc       = pDesc;
+  pRing->DescWords   = DescWords;
+  pRing->NumDesc     = NumDesc;
+  pRing->apBuf       = apBuf;
+  pRing->BufLen      = BufLen;
+  pRing->IocInterval = IocInterval;
+  pRing->Head        = 0;
+  pRing->Tail        = 0;
+  for (i = 0; i < NumDesc; i++)
+  {
+    pDesc[(i * DescWords) + 3U] = 0;
+    pDesc[(i * DescWords) + 0U] = 0;
+    pDesc[(i * DescWords) + 1U] = 0;
+    pDesc[(i * DescWords) + 2U] = 0;
+    apBuf[i] = NULL;
+  }
+  return 0;
+}
+
+/**
+  * @brief  Returns a descriptor, for tail pointer writes.
+  * @param  pRing: Ring.
+  * @param  Idx: Free running index.
+  * @retval First word of the descriptor.
+  */
+volatile uint32_t *ETH_RING_GetDesc(const ETH_RingTypeDef *pRing, uint32_t Idx)
+{
+  return pRing->pDesc + ((Idx & (pRing->NumDesc - 1U)) * pRing->DescWords);
+}
+
+/**
+  * @brief  Hands every free RX descriptor to the DMA with a pool buffer.
+  * @param  pRing: RX ring.
+  * @param  pPool: Pool.
+  * @param  pStat: Counters.
+  * @retval Number of descriptors refilled. If not 0, the caller moves the
+  *         DMA tail pointer to ETH_RING_GetDesc(pRing, pRing->Tail - 1).
+  */
+uint32_t ETH_RING_RxRefill(ETH_RingTypeDef *pRing, ETH_PoolTypeDef *pPool, ETH_StatTypeDef *pStat)
+{
+  volatile uint32_t *pDesc;
+  uint8_t           *pBuf;
+  uint32_t           Desc3;
+  uint32_t           n;
+
+  n = 0;
+  while ((pRing->Tail - pRing->Head) < pRing->NumDesc)
+  {
+    pBuf = ETH_POOL_Alloc(pPool);
+    if (pBuf == NULL)
+    {
+      pStat->RxNoBuffer++;
+      break;
+    }
+    pDesc = ETH_RING_GetDesc(pRing, pRing->Tail);
+    pRing->apBuf[pRing->Tail & (pRing->NumDesc - 1U)] = pBuf;
+    pDesc[0] = ETH_RING_ADDR(pBuf);
+    pDesc[1] = 0;
+    pDesc[2] = 0;
+    Desc3 = ETH_RING_DESC3_OWN | ETH_RING_RDES3_BUF1V;
+    if ((pRing->IocInterval != 0U) && (((pRing->Tail + 1U) % pRing->IocInterval) == 0U))
+    {
+      Desc3 |= ETH_RING_RDES3_IOC;
+    }
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    pDesc[3] = Desc3;
+    pRing->Tail++;
+    n++;
+  }
+  return n;
+}
+
+/**
+  * @brief  Tells whether the DMA has returned a descriptor to the CPU.
+  * @param  pRing: RX ring.
+  * @retval 1 if ETH_RING_RxHarvest() has work, 0 otherwise.
+  */
+int ETH_RING_RxPending(const ETH_RingTypeDef *pRing)
+{
+  if (pRing->Head == pRing->Tail)
+  {
+    return 0;
+  }
+  return ((ETH_RING_GetDesc(pRing, pRing->Head)[3] & ETH_RING_DESC3_OWN) == 0U) ? 1 : 0;
+}
+
+/**
+  * @brief  Takes complete packets from the RX ring. The buffers pass to the
+  *         caller; the descriptors stay empty until ETH_RING_RxRefill().
+  *         A packet whose last descriptor is still owned by the DMA is left
+  *         for the next call.
+  * @param  pRing: RX ring.
+  * @param  pPool: Pool, receives the buffers of dropped packets.
+  * @param  pPkts: Destination.
+  * @param  MaxPkts: Capacity of pPkts, the poll budget.
+  * @param  pStat: Counters.
+  * @retval Number of packets returned.
+  */
+uint32_t ETH_RING_RxHarvest(ETH_RingTypeDef *pRing, ETH_PoolTypeDef *pPool, ETH_PacketTypeDef *pPkts,
+                            uint32_t MaxPkts, ETH_StatTypeDef *pStat)
+{
+  ETH_PacketTypeDef *pPkt;
+  uint32_t           Desc3;
+  uint32_t           NumSegs;
+  uint32_t           Length;
+  uint32_t           Idx;
+  uint32_t           i;
+  uint32_t           n;
+
+  n = 0;
+  while ((n < MaxPkts) && (pRing->Head != pRing->Tail))
+  {
+    /* Find the last descriptor of the packet at Head */
+    NumSegs = 0;
+    do
+    {
+      if ((pRing->Head + NumSegs) == pRing->Tail)
+      {
+        return n;
+      }
+      Desc3 = ETH_RING_GetDesc(pRing, pRing->Head + NumSegs)[3];
+      if ((Desc3 & ETH_RING_DESC3_OWN) != 0U)
+      {
+        break;
+      }
+      NumSegs++;
+    } while ((Desc3 & ETH_RING_RDES3_LD) == 0U);
+    if ((Desc3 & ETH_RING_DESC3_OWN) != 0U)
+    {
+      break;
+    }
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+    pPkt   = &pPkts[n];
+    Length = Desc3 & ETH_RING_RDES3_PL_MSK;
+    /* The length must end in the last buffer, or the segment lengths wrap */
+    if (((Desc3 & ETH_RING_RDES3_ES) != 0U) || (NumSegs > ETH_RING_MAX_SEGS) ||
+        (Length > (NumSegs * pRing->BufLen)) || (Length <= ((NumSegs - 1U) * pRing->BufLen)))
+    {
+      for (i = 0; i < NumSegs; i++)
+      {
+        Idx = (pRing->Head + i) & (pRing->NumDesc - 1U);
+        ETH_POOL_Free(pPool, pRing->apBuf[Idx]);
+        pRing->apBuf[Idx] = NULL;
+      }
+      pStat->RxErrors++;
+    }
+    else
+    {
+      for (i = 0; i < NumSegs; i++)
+      {
+        Idx = (pRing->Head + i) & (pRing->NumDesc - 1U);
+        pPkt->apSeg[i]   = pRing->apBuf[Idx];
+        pPkt->aSegLen[i] = (uint16_t)(((i + 1U) < NumSegs) ? pRing->BufLen : (Length - (i * pRing->BufLen)));
+        pRing->apBuf[Idx] = NULL;
+      }
+      pPkt->NumSegs = (uint8_t)NumSegs;
+      pPkt->Length  = (uint16_t)Length;
+      pStat->RxPackets++;
+      pStat->RxBytes += Length;
+      n++;
+    }
+    pRing->Head += NumSegs;
+  }
+  return n;
+}
+
+/**
+  * @brief  Returns the number of descriptors a TX submit may use. One
+  *         descriptor always stays unused: the DMA stops where the tail
+  *         pointer points, so on a completely full ring the tail pointer
+  *         would equal the DMA's current descriptor and the DMA would see
+  *         nothing to send.
+  * @param  pRing: TX ring.
+  * @retval Number of free descriptors.
+  */
+uint32_t ETH_RING_TxFree(const ETH_RingTypeDef *pRing)
+{
+  return pRing->NumDesc - 1U - (pRing->Tail - pRing->Head);
+}
+
+/**
+  * @brief  Queues a packet on the TX ring, one descriptor per buffer. The
+  *         first descriptor is given to the DMA last.
+  * @param  pRing: TX ring.
+  * @param  pPkt: Packet. The buffers must stay valid until reclaimed.
+  * @param  Desc3Flags: Checksum insertion control (ETH_RING_TDES3_CIC_MSK).
+  * @param  pStat: Counters.
+  * @retval 0 on success, -1 if the ring has too few free descriptors. On
+  *         success the caller moves the DMA tail pointer to
+  *         ETH_RING_GetDesc(pRing, pRing->Tail).
+  */
+int ETH_RING_TxSubmit(ETH_RingTypeDef *pRing, const ETH_PacketTypeDef *pPkt, uint32_t Desc3Flags,
+                      ETH_StatTypeDef *pStat)
+{
+  volatile uint32_t *pDesc;
+  volatile uint32_t *pFirst;
+  uint32_t           Desc2;
+  uint32_t           Desc3;
+  uint32_t           Idx;
+  uint32_t           i;
+
+  if ((pPkt->NumSegs == 0U) || (pPkt->NumSegs > ETH_RING_TxFree(pRing)))
+  {
+    pStat->TxRingFull++;
+    return -1;
+  }
+
+  pFirst = ETH_RING_GetDesc(pRing, pRing->Tail);
+  for (i = 0; i < pPkt->NumSegs; i++)
+  {
+    Idx   = pRing->Tail + i;
+    pDesc = ETH_RING_GetDesc(pRing, Idx);
+    pRing->apBuf[Idx & (pRing->NumDesc - 1U)] = pPkt->apSeg[i];
+
+    Desc2 = pPkt->aSegLen[i] & ETH_RING_TDES2_B1L_MSK;
+    Desc3 = (Desc3Flags & ETH_RING_TDES3_CIC_MSK) | (pPkt->Length & ETH_RING_TDES3_FL_MSK);
+    if (i == 0U)
+    {
+      Desc3 |= ETH_RING_TDES3_FD;
+    }
+    else
+    {
+      Desc3 |= ETH_RING_DESC3_OWN;
+    }
+    if ((i + 1U) == pPkt->NumSegs)
+    {
+      Desc3 |= ETH_RING_TDES3_LD;
+      if ((pRing->IocInterval != 0U) && (((Idx + 1U) % pRing->IocInterval) == 0U))
+      {
+        Desc2 |= ETH_RING_TDES2_IOC;
+      }
+    }
+    pDesc[0] = ETH_RING_ADDR(pPkt->apSeg[i]);
+    pDesc[1] = 0;
+    pDesc[2] = Desc2;
+    pDesc[3] = Desc3;
+  }
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  pFirst[3] |= ETH_RING_DESC3_OWN;
+
+  pRing->Tail += pPkt->NumSegs;
+  pStat->TxPackets++;
+  pStat->TxBytes += pPkt->Length;
+  return 0;
+}
+
+/**
+  * @brief  Takes back the TX descriptors the DMA has finished with and frees
+  *         their pool buffers.
+  * @param  pRing: TX ring.
+  * @param  pPool: Pool.
+  * @param  pStat: Counters.
+  * @retval Number of descriptors taken back.
+  */
+uint32_t ETH_RING_TxReclaim(ETH_RingTypeDef *pRing, ETH_PoolTypeDef *pPool, ETH_StatTypeDef *pStat)
+{
+  uint8_t  *pBuf;
+  uint32_t  Idx;
+  uint32_t  n;
+
+  n = 0;
+  while ((pRing->Head != pRing->Tail) &&
+         ((ETH_RING_GetDesc(pRing, pRing->Head)[3] & ETH_RING_DESC3_OWN) == 0U))
+  {
+    Idx  = pRing->Head & (pRing->NumDesc - 1U);
+    pBuf = pRing->apBuf[Idx];
+    if ((pBuf != NULL) && (ETH_POOL_Owns(pPool, pBuf) != 0))
+    {
+      ETH_POOL_Free(pPool, pBuf);
+    }
+    pRing->apBuf[Idx] = NULL;
+    pRing->Head++;
+    n++;
+  }
+  pStat->TxCompleted += n;
+  return n;
+}
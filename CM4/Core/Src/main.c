@@ -22,7 +22,11 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
-
+#include "ipc.h"
+#include "can_rx.h"
+#include "eth_dma.h"
+#include "mem_map.h"
+#include "audio_stream.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -46,15 +50,15 @@
 
 /* Private variables ---------------------------------------------------------*/
 #if defined ( __ICCARM__ ) /*!< IAR Compiler */
-#pragma location=0x30000000
+#pragma location=0x30038000
 ETH_DMADescTypeDef  DMARxDscrTab[ETH_RX_DESC_CNT]; /* Ethernet Rx DMA Descriptors */
-#pragma location=0x30000080
+#pragma location=0x30038300
 ETH_DMADescTypeDef  DMATxDscrTab[ETH_TX_DESC_CNT]; /* Ethernet Tx DMA Descriptors */
 
 #elif defined ( __CC_ARM )  /* MDK ARM Compiler */
 
-__attribute__((at(0x30000000))) ETH_DMADescTypeDef  DMARxDscrTab[ETH_RX_DESC_CNT]; /* Ethernet Rx DMA Descriptors */
-__attribute__((at(0x30000080))) ETH_DMADescTypeDef  DMATxDscrTab[ETH_TX_DESC_CNT]; /* Ethernet Tx DMA Descriptors */
+__attribute__((at(0x30038000))) ETH_DMADescTypeDef  DMARxDscrTab[ETH_RX_DESC_CNT]; /* Ethernet Rx DMA Descriptors */
+__attribute__((at(0x30038300))) ETH_DMADescTypeDef  DMATxDscrTab[ETH_TX_DESC_CNT]; /* Ethernet Tx DMA Descriptors */
 
 #elif defined ( __GNUC__ ) /* GNU Compiler */
 
@@ -81,6 +85,7 @@ MMC_HandleTypeDef hmmc1;
 SDRAM_HandleTypeDef hsdram1;
 
 /* USER CODE BEGIN PV */
+static ETH_PacketTypeDef aEthPkts[ETH_DMA_POLL_BUDGET];
 
 /* USER CODE END PV */
 
@@ -111,6 +116,8 @@ int main(void)
 {
 
   /* USER CODE BEGIN 1 */
+  uint32_t NumPkts;
+  uint32_t i;
 
   /* USER CODE END 1 */
 
@@ -153,6 +160,22 @@ int main(void)
   MX_SAI2_Init();
   MX_SDMMC1_MMC_Init();
   /* USER CODE BEGIN 2 */
+  IPC_Init();
+  /* Without SDRAM only "sram" is used: CAN and Ethernet do not need it, the
+     audio stream gets its queues elsewhere or fails below */
+  (void)MEM_MAP_Init();
+  if ((CAN_RX_Init() != 0) || (CAN_RX_Start() != 0))
+  {
+    Error_Handler();
+  }
+  if ((ETH_DMA_Init() != 0) || (ETH_DMA_Start() != 0))
+  {
+    Error_Handler();
+  }
+  /* Set up only: there is no sink or source on this core yet, see audio_stream.h.
+     Without memory for its queues the stream stays down and
+     AUDIO_STREAM_Start() fails, the rest of the core runs on */
+  (void)AUDIO_STREAM_Init();
 
   /* USER CODE END 2 */
 
@@ -163,6 +186,14 @@ int main(void)
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
+    CAN_RX_Poll();
+    /* No capture consumer yet: received buffers go straight back */
+    NumPkts = ETH_DMA_Receive(aEthPkts, ETH_DMA_POLL_BUDGET);
+    for (i = 0; i < NumPkts; i++)
+    {
+      ETH_DMA_FreePacket(&aEthPkts[i]);
+    }
+    AUDIO_STREAM_Poll();
   }
   /* USER CODE END 3 */
 }
@@ -246,17 +277,17 @@ static void MX_FDCAN1_Init(void)
   hfdcan1.Init.DataTimeSeg1 = 1;
   hfdcan1.Init.DataTimeSeg2 = 1;
   hfdcan1.Init.MessageRAMOffset = 0;
-  hfdcan1.Init.StdFiltersNbr = 0;
-  hfdcan1.Init.ExtFiltersNbr = 0;
-  hfdcan1.Init.RxFifo0ElmtsNbr = 0;
+  hfdcan1.Init.StdFiltersNbr = 32;
+  hfdcan1.Init.ExtFiltersNbr = 16;
+  hfdcan1.Init.RxFifo0ElmtsNbr = 64;
   hfdcan1.Init.RxFifo0ElmtSize = FDCAN_DATA_BYTES_8;
-  hfdcan1.Init.RxFifo1ElmtsNbr = 0;
+  hfdcan1.Init.RxFifo1ElmtsNbr = 32;
   hfdcan1.Init.RxFifo1ElmtSize = FDCAN_DATA_BYTES_8;
   hfdcan1.Init.RxBuffersNbr = 0;
   hfdcan1.Init.RxBufferSize = FDCAN_DATA_BYTES_8;
   hfdcan1.Init.TxEventsNbr = 0;
   hfdcan1.Init.TxBuffersNbr = 0;
-  hfdcan1.Init.TxFifoQueueElmtsNbr = 0;
+  hfdcan1.Init.TxFifoQueueElmtsNbr = 8;
   hfdcan1.Init.TxFifoQueueMode = FDCAN_TX_FIFO_OPERATION;
   hfdcan1.Init.TxElmtSize = FDCAN_DATA_BYTES_8;
   if (HAL_FDCAN_Init(&hfdcan1) != HAL_OK)
@@ -298,18 +329,18 @@ static void MX_FDCAN2_Init(void)
   hfdcan2.Init.DataSyncJumpWidth = 1;
   hfdcan2.Init.DataTimeSeg1 = 1;
   hfdcan2.Init.DataTimeSeg2 = 1;
-  hfdcan2.Init.MessageRAMOffset = 0;
-  hfdcan2.Init.StdFiltersNbr = 0;
-  hfdcan2.Init.ExtFiltersNbr = 0;
-  hfdcan2.Init.RxFifo0ElmtsNbr = 0;
+  hfdcan2.Init.MessageRAMOffset = 480;
+  hfdcan2.Init.StdFiltersNbr = 32;
+  hfdcan2.Init.ExtFiltersNbr = 16;
+  hfdcan2.Init.RxFifo0ElmtsNbr = 64;
   hfdcan2.Init.RxFifo0ElmtSize = FDCAN_DATA_BYTES_8;
-  hfdcan2.Init.RxFifo1ElmtsNbr = 0;
+  hfdcan2.Init.RxFifo1ElmtsNbr = 32;
   hfdcan2.Init.RxFifo1ElmtSize = FDCAN_DATA_BYTES_8;
   hfdcan2.Init.RxBuffersNbr = 0;
   hfdcan2.Init.RxBufferSize = FDCAN_DATA_BYTES_8;
   hfdcan2.Init.TxEventsNbr = 0;
   hfdcan2.Init.TxBuffersNbr = 0;
-  hfdcan2.Init.TxFifoQueueElmtsNbr = 0;
+  hfdcan2.Init.TxFifoQueueElmtsNbr = 8;
   hfdcan2.Init.TxFifoQueueMode = FDCAN_TX_FIFO_OPERATION;
   hfdcan2.Init.TxElmtSize = FDCAN_DATA_BYTES_8;
   if (HAL_FDCAN_Init(&hfdcan2) != HAL_OK)
@@ -472,15 +503,15 @@ static void MX_SAI2_Init(void)
   hsai_BlockA2.Init.PdmInit.Activation = DISABLE;
   hsai_BlockA2.Init.PdmInit.MicPairsNbr = 1;
   hsai_BlockA2.Init.PdmInit.ClockEnable = SAI_PDM_CLOCK1_ENABLE;
-  hsai_BlockA2.FrameInit.FrameLength = 8;
+  hsai_BlockA2.FrameInit.FrameLength = 64;
   hsai_BlockA2.FrameInit.ActiveFrameLength = 1;
   hsai_BlockA2.FrameInit.FSDefinition = SAI_FS_STARTFRAME;
   hsai_BlockA2.FrameInit.FSPolarity = SAI_FS_ACTIVE_LOW;
   hsai_BlockA2.FrameInit.FSOffset = SAI_FS_FIRSTBIT;
   hsai_BlockA2.SlotInit.FirstBitOffset = 0;
   hsai_BlockA2.SlotInit.SlotSize = SAI_SLOTSIZE_DATASIZE;
-  hsai_BlockA2.SlotInit.SlotNumber = 1;
-  hsai_BlockA2.SlotInit.SlotActive = 0x00000000;
+  hsai_BlockA2.SlotInit.SlotNumber = 8;
+  hsai_BlockA2.SlotInit.SlotActive = 0x000000FF;
   if (HAL_SAI_Init(&hsai_BlockA2) != HAL_OK)
   {
     Error_Handler();
@@ -501,15 +532,15 @@ static void MX_SAI2_Init(void)
   hsai_BlockB2.Init.PdmInit.Activation = DISABLE;
   hsai_BlockB2.Init.PdmInit.MicPairsNbr = 1;
   hsai_BlockB2.Init.PdmInit.ClockEnable = SAI_PDM_CLOCK1_ENABLE;
-  hsai_BlockB2.FrameInit.FrameLength = 8;
+  hsai_BlockB2.FrameInit.FrameLength = 64;
   hsai_BlockB2.FrameInit.ActiveFrameLength = 1;
   hsai_BlockB2.FrameInit.FSDefinition = SAI_FS_STARTFRAME;
   hsai_BlockB2.FrameInit.FSPolarity = SAI_FS_ACTIVE_LOW;
   hsai_BlockB2.FrameInit.FSOffset = SAI_FS_FIRSTBIT;
   hsai_BlockB2.SlotInit.FirstBitOffset = 0;
   hsai_BlockB2.SlotInit.SlotSize = SAI_SLOTSIZE_DATASIZE;
-  hsai_BlockB2.SlotInit.SlotNumber = 1;
-  hsai_BlockB2.SlotInit.SlotActive = 0x00000000;
+  hsai_BlockB2.SlotInit.SlotNumber = 8;
+  hsai_BlockB2.SlotInit.SlotActive = 0x000000FF;
   if (HAL_SAI_Init(&hsai_BlockB2) != HAL_OK)
   {
     Error_Handler();
@@ -576,7 +607,7 @@ void MX_FMC_Init(void)
   hsdram1.Init.InternalBankNumber = FMC_SDRAM_INTERN_BANKS_NUM_4;
   hsdram1.Init.CASLatency = FMC_SDRAM_CAS_LATENCY_1;
   hsdram1.Init.WriteProtection = FMC_SDRAM_WRITE_PROTECTION_DISABLE;
-  hsdram1.Init.SDClockPeriod = FMC_SDRAM_CLOCK_DISABLE;
+  hsdram1.Init.SDClockPeriod = FMC_SDRAM_CLOCK_PERIOD_2;
   hsdram1.Init.ReadBurst = FMC_SDRAM_RBURST_DISABLE;
   hsdram1.Init.ReadPipeDelay = FMC_SDRAM_RPIPE_DELAY_0;
   /* SdramTiming */
@@ -66,7 +66,7 @@
 #define configUSE_TICK_HOOK                      0
 #define configCPU_CLOCK_HZ                       ( SystemCoreClock )
 #define configTICK_RATE_HZ                       ((TickType_t)1000)
-#define configMAX_PRIORITIES                     ( 56 )
+#define configMAX_PRIORITIES                     ( 28 )
 #define configMINIMAL_STACK_SIZE                 ((uint16_t)128)
 #define configTOTAL_HEAP_SIZE                    ((size_t)15360)
 #define configMAX_TASK_NAME_LEN                  ( 16 )
@@ -76,7 +76,7 @@
 #define configQUEUE_REGISTRY_SIZE                8
 #define configUSE_RECURSIVE_MUTEXES              1
 #define configUSE_COUNTING_SEMAPHORES            1
-#define configUSE_PORT_OPTIMISED_TASK_SELECTION  0
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION  1
 /* USER CODE BEGIN MESSAGE_BUFFER_LENGTH_TYPE */
 /* Defaults to size_t for backward compatibility, but can be changed
    if lengths will always be less than the number of bytes in a size_t. */
@@ -167,6 +167,51 @@ standard names. */
 
 /* USER CODE BEGIN Defines */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
+
+/* Run-time task profiler (prof.c): DWT cycle counter as run time counter,
+   scheduler hooks for CPU share and wake-to-run latency. */
+#ifndef PROF_ENABLE
+#define PROF_ENABLE 1
+#endif
+#if PROF_ENABLE
+#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+  void     PROF_Init(void);
+  uint32_t PROF_GetTime(void);
+  void     PROF_TaskSwitchedIn(void *pTCB);
+  void     PROF_TaskSwitchedOut(void *pTCB);
+  void     PROF_TaskReady(void *pTCB);
+#endif
+#define configGENERATE_RUN_TIME_STATS                1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()     PROF_Init()
+#define portGET_RUN_TIME_COUNTER_VALUE()             PROF_GetTime()
+#define traceTASK_SWITCHED_IN()                      PROF_TaskSwitchedIn((void *)pxCurrentTCB)
+#define traceTASK_SWITCHED_OUT()                     PROF_TaskSwitchedOut((void *)pxCurrentTCB)
+#define traceMOVED_TASK_TO_READY_STATE(pxTCB)        PROF_TaskReady((void *)(pxTCB))
+#endif
+
+/* Tickless idle, vPortSuppressTicksAndSleep() is implemented in lp_idle.c on
+   LPTIM1. */
+#define configUSE_TICKLESS_IDLE                      1
+
+/* Reduced priority map. The CMSIS-RTOS2 wrapper (cmsis_os2.c) converts
+   osPriority_t with the macros below instead of 1:1, so 28 FreeRTOS
+   priorities suffice and the port selects the next task with a CLZ on the
+   ready bitmap (configUSE_PORT_OPTIMISED_TASK_SELECTION, at most 32).
+     FreeRTOS     osPriority_t
+     0            Idle task
+     1            osPriorityIdle
+     2            Timer service task (configTIMER_TASK_PRIORITY)
+     3 .. 26      osPriorityLow .. osPriorityRealtime: 4 levels per class,
+                  +3 .. +7 of a class share one priority
+     27           osPriorityISR
+   Tests/CM7/SCHED_SelectBench.c checks the map and compares the cost of a
+   task switch with the 56 priorities of the 1:1 map. */
+#define configOS2_PRIO_TO_NATIVE(Prio)          (((Prio) < 8U) ? (((Prio) != 0U) ? 1U : 0U) :                    \
+                                                 ((Prio) >= 56U) ? 27U :                                          \
+                                                 (3U + (((Prio) >> 3) - 1U) * 4U + ((((Prio) & 7U) < 3U) ? ((Prio) & 7U) : 3U)))
+#define configOS2_PRIO_FROM_NATIVE(Prio)        (((Prio) < 3U) ? (Prio) :                                          \
+                                                 ((Prio) >= 27U) ? 56U :                                          \
+                                                 (((((Prio) - 3U) / 4U) + 1U) * 8U + (((Prio) - 3U) % 4U)))
 /* USER CODE END Defines */
 
 #endif /* FREERTOS_CONFIG_H */
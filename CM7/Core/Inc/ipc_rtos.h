@@ -0,0 +1,40 @@
+/**
+  ******************************************************************************
+  * @file    ipc_rtos.h
+  * @brief   FreeRTOS binding of the inter-core messaging (Cortex-M7 side).
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __IPC_RTOS_H
+#define __IPC_RTOS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+#include "ipc.h"
+
+/* Exported functions prototypes ---------------------------------------------*/
+void            IPC_RTOS_Init(void);
+IPC_MsgTypeDef *IPC_RTOS_Receive(TickType_t Timeout);
+void            IPC_RTOS_Release(void);
+int             IPC_RTOS_Send(const IPC_MsgTypeDef *pMsg, TickType_t Timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IPC_RTOS_H */
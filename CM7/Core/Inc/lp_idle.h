@@ -0,0 +1,68 @@
+/**
+  ******************************************************************************
+  * @file    lp_idle.h
+  * @brief   Tickless idle for the Cortex-M7 FreeRTOS port, timed by LPTIM1.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __LP_IDLE_H
+#define __LP_IDLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#ifndef LP_IDLE_LSE_STATE
+#define LP_IDLE_LSE_STATE       RCC_LSE_BYPASS  /* LSE external clock source, see .ioc */
+#endif
+#ifndef LP_IDLE_IRQ_PRIORITY
+#define LP_IDLE_IRQ_PRIORITY    15U     /* Handler does not call the kernel */
+#endif
+#define LP_IDLE_COUNTER_MAX     0xFFFFU /* LPTIM counter is 16 bit */
+#define LP_IDLE_GUARD_COUNTS    8U      /* Margin for CMP synchronisation and wake up */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Idle residency counters.
+  */
+typedef struct
+{
+  uint32_t NumSleeps;        /*!< Sleeps with the tick suppressed          */
+  uint32_t NumAborts;        /*!< Sleeps abandoned before the WFI          */
+  uint32_t NumTimerWakeups;  /*!< Sleeps ended by the LPTIM compare match  */
+  uint32_t NumLateTicks;     /*!< Ticks lost because a wake up came late   */
+  uint64_t TicksSuppressed;  /*!< RTOS ticks stepped over while asleep     */
+  uint64_t SleepTimeUs;      /*!< Time spent asleep, by the LPTIM counter  */
+  uint32_t WakeLatencyMaxUs; /*!< Longest delay from the compare match to
+                                  the wake up, resolution one LPTIM count  */
+  uint32_t WakeLatencyAvgUs; /*!< Average of this delay over the timer
+                                  wakeups                                  */
+} LP_IDLE_StatTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+int      LP_IDLE_Init(void);
+uint32_t LP_IDLE_GetClock(void);
+void     LP_IDLE_GetStat(LP_IDLE_StatTypeDef *pStat);
+void     LP_IDLE_ResetStat(void);
+void     LP_IDLE_IRQHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LP_IDLE_H */
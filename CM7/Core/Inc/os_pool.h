@@ -0,0 +1,157 @@
+/**
+  ******************************************************************************
+  * @file    os_pool.h
+  * @brief   Fixed-size pools for statically allocated FreeRTOS objects.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __OS_POOL_H
+#define __OS_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "event_groups.h"
+#include "cmsis_os2.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Number of objects per pool. */
+#ifndef OS_POOL_NUM_TASKS
+#define OS_POOL_NUM_TASKS          8U
+#endif
+#ifndef OS_POOL_NUM_STACKS_SMALL
+#define OS_POOL_NUM_STACKS_SMALL   4U
+#endif
+#ifndef OS_POOL_NUM_STACKS_MEDIUM
+#define OS_POOL_NUM_STACKS_MEDIUM  4U
+#endif
+#ifndef OS_POOL_NUM_STACKS_LARGE
+#define OS_POOL_NUM_STACKS_LARGE   2U
+#endif
+
+/* Objects of emUSB-Host (USBH_OS_freeRTOS.c): one recursive mutex per
+   USBH_MUTEX_COUNT (checked there), event groups for the USBH task, the
+   ISR task and the enumeration, plus up to 4 per attached class device
+   (CDC and HID use one per endpoint, MSD and FT232 one). */
+#ifndef OS_POOL_USBH_MAX_DEVICES
+#define OS_POOL_USBH_MAX_DEVICES   4U      /* Class devices attached at the same time */
+#endif
+#define OS_POOL_USBH_NUM_MUTEXES   10U
+#define OS_POOL_USBH_NUM_EVENTS    (3U + 4U * OS_POOL_USBH_MAX_DEVICES)
+
+/* Objects of the application on top of the USB host stack. */
+#ifndef OS_POOL_APP_NUM_MUTEXES
+#define OS_POOL_APP_NUM_MUTEXES    6U      /* Mutexes and semaphores */
+#endif
+#ifndef OS_POOL_APP_NUM_EVENT_GROUPS
+#define OS_POOL_APP_NUM_EVENT_GROUPS 4U
+#endif
+
+#ifndef OS_POOL_NUM_MUTEXES
+#define OS_POOL_NUM_MUTEXES        (OS_POOL_USBH_NUM_MUTEXES + OS_POOL_APP_NUM_MUTEXES)
+#endif
+#ifndef OS_POOL_NUM_EVENT_GROUPS
+#define OS_POOL_NUM_EVENT_GROUPS   (OS_POOL_USBH_NUM_EVENTS + OS_POOL_APP_NUM_EVENT_GROUPS)
+#endif
+#ifndef OS_POOL_NUM_QUEUES
+#define OS_POOL_NUM_QUEUES         4U
+#endif
+
+/* Stack size classes in bytes. A request uses the smallest class it fits in. */
+#ifndef OS_POOL_STACK_SMALL_SIZE
+#define OS_POOL_STACK_SMALL_SIZE   1024U
+#endif
+#ifndef OS_POOL_STACK_MEDIUM_SIZE
+#define OS_POOL_STACK_MEDIUM_SIZE  2048U
+#endif
+#ifndef OS_POOL_STACK_LARGE_SIZE
+#define OS_POOL_STACK_LARGE_SIZE   4096U
+#endif
+
+/* Storage per queue in bytes (item size * queue length). Larger queues
+   are created on the FreeRTOS heap. */
+#ifndef OS_POOL_QUEUE_STORAGE_SIZE
+#define OS_POOL_QUEUE_STORAGE_SIZE 256U
+#endif
+
+/* Linker sections of the pools. Control blocks are accessed on every
+   scheduler operation and default to DTCM (.bss); stacks default to the
+   AXI SRAM. Define as empty to use .bss. */
+#ifndef OS_POOL_CB_SECTION
+#define OS_POOL_CB_SECTION
+#endif
+#ifndef OS_POOL_STACK_SECTION
+#define OS_POOL_STACK_SECTION      __attribute__((section(".axi_sram")))
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Pool identifiers.
+  */
+typedef enum
+{
+  OS_POOL_TCB = 0,
+  OS_POOL_STACK_SMALL,
+  OS_POOL_STACK_MEDIUM,
+  OS_POOL_STACK_LARGE,
+  OS_POOL_MUTEX,
+  OS_POOL_EVENT_GROUP,
+  OS_POOL_QUEUE,
+  OS_POOL_QUEUE_STORAGE,
+  OS_POOL_COUNT
+} OS_POOL_IdTypeDef;
+
+/**
+  * @brief  Usage statistics of one pool.
+  */
+typedef struct
+{
+  uint32_t ItemSize;   /*!< Size of one object in bytes        */
+  uint16_t NumItems;   /*!< Number of objects in the pool      */
+  uint16_t NumUsed;    /*!< Objects currently allocated        */
+  uint16_t MaxUsed;    /*!< High-water mark of NumUsed         */
+  uint16_t NumFailed;  /*!< Allocations failed on an empty pool */
+  uint16_t NumHeap;    /*!< Objects created on the FreeRTOS heap instead */
+} OS_POOL_StatTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void               OS_POOL_Init(void);
+void              *OS_POOL_Alloc(OS_POOL_IdTypeDef Id);
+int                OS_POOL_Free(void *p);
+StackType_t       *OS_POOL_AllocStack(uint32_t NumBytes, uint32_t *pNumBytes);
+void               OS_POOL_GetStat(OS_POOL_IdTypeDef Id, OS_POOL_StatTypeDef *pStat);
+/* FreeRTOS helpers, fall back to the heap if the pool is empty */
+EventGroupHandle_t OS_POOL_EventGroupCreate(void);
+void               OS_POOL_EventGroupDelete(EventGroupHandle_t hEvent);
+SemaphoreHandle_t  OS_POOL_RecursiveMutexCreate(void);
+void               OS_POOL_SemaphoreDelete(SemaphoreHandle_t hSem);
+/* CMSIS-RTOS2 helpers, same parameters as the osXxxNew() functions */
+osThreadId_t       OS_POOL_ThreadNew(osThreadFunc_t func, void *argument, const osThreadAttr_t *attr);
+void               OS_POOL_ThreadFree(osThreadId_t thread_id);
+osMutexId_t        OS_POOL_MutexNew(const osMutexAttr_t *attr);
+osStatus_t         OS_POOL_MutexDelete(osMutexId_t mutex_id);
+osEventFlagsId_t   OS_POOL_EventFlagsNew(const osEventFlagsAttr_t *attr);
+osStatus_t         OS_POOL_EventFlagsDelete(osEventFlagsId_t ef_id);
+osMessageQueueId_t OS_POOL_MessageQueueNew(uint32_t msg_count, uint32_t msg_size, const osMessageQueueAttr_t *attr);
+osStatus_t         OS_POOL_MessageQueueDelete(osMessageQueueId_t mq_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __OS_POOL_H */
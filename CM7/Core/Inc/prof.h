@@ -0,0 +1,108 @@
+/**
+  ******************************************************************************
+  * @file    prof.h
+  * @brief   Run-time task profiler and scheduling latency tracer (Cortex-M7).
+  *
+  *          Export format of PROF_Export(), all values little endian:
+  *            Header   : U32 Magic "PRF1", U32 CPU clock in Hz,
+  *                       U32 NumTasks, U32 NumIrqs, U32 NumDropped
+  *            NumTasks : U32 Slot, char Name[16], U64 Cycles, U32 NumRuns,
+  *                       U32 aLatency[PROF_NUM_LAT_BUCKETS]
+  *            NumIrqs  : U32 Id (IRQ number + 16), U32 Count, U64 Cycles
+  *            Events   : blocks of U32 Count followed by Count events
+  *                       (U32 Seq, U32 Time, U32 Data, see prof_ring.h),
+  *                       terminated by a block with Count 0
+  *          Latency bucket n counts wake-to-run times of [2^n, 2^(n+1)) us,
+  *          bucket 0 also counts times below 1 us.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __PROF_H
+#define __PROF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "prof_ring.h"
+
+/* Exported constants --------------------------------------------------------*/
+#ifndef PROF_ENABLE
+#define PROF_ENABLE             1
+#endif
+
+#define PROF_MAGIC              0x31465250U  /* "PRF1" */
+
+#ifndef PROF_MAX_TASKS
+#define PROF_MAX_TASKS          16U     /* Slot 0 collects tasks beyond this number */
+#endif
+#ifndef PROF_NUM_LAT_BUCKETS
+#define PROF_NUM_LAT_BUCKETS    16U
+#endif
+#ifndef PROF_MAX_IRQ_ID
+#define PROF_MAX_IRQ_ID         (16U + 150U)   /* Exceptions + device interrupts */
+#endif
+#ifndef PROF_NUM_EVENTS
+#define PROF_NUM_EVENTS         1024U   /* Power of 2 */
+#endif
+#define PROF_TASK_NAME_LEN      16U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Statistics of one task slot.
+  */
+typedef struct
+{
+  char     acName[PROF_TASK_NAME_LEN];
+  uint64_t Cycles;                          /*!< CPU cycles spent running   */
+  uint32_t NumRuns;                         /*!< Number of switches in      */
+  uint32_t aLatency[PROF_NUM_LAT_BUCKETS];  /*!< Wake-to-run histogram      */
+} PROF_TaskStatTypeDef;
+
+/**
+  * @brief  Write function used by PROF_Export().
+  */
+typedef void (PROF_WriteFunc)(void *pContext, const void *pData, uint32_t NumBytes);
+
+/* Exported macro ------------------------------------------------------------*/
+#if PROF_ENABLE
+  #define PROF_IRQ_ENTER(IRQn)  PROF_IrqEnter((int32_t)(IRQn))
+  #define PROF_IRQ_EXIT(IRQn)   PROF_IrqExit((int32_t)(IRQn))
+#else
+  #define PROF_IRQ_ENTER(IRQn)
+  #define PROF_IRQ_EXIT(IRQn)
+#endif
+
+/* Exported functions prototypes ---------------------------------------------*/
+void     PROF_Init(void);
+uint32_t PROF_GetTime(void);
+/* Hooks, see FreeRTOSConfig.h */
+void     PROF_TaskSwitchedIn(void *pTCB);
+void     PROF_TaskSwitchedOut(void *pTCB);
+void     PROF_TaskReady(void *pTCB);
+void     PROF_IrqEnter(int32_t IRQn);
+void     PROF_IrqExit(int32_t IRQn);
+void     PROF_UserEvent(uint32_t Id, uint32_t Arg);
+/* Evaluation */
+int      PROF_GetTaskStat(unsigned Slot, PROF_TaskStatTypeDef *pStat);
+void     PROF_Export(PROF_WriteFunc *pfWrite, void *pContext);
+void     PROF_Reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PROF_H */
@@ -0,0 +1,79 @@
+/**
+  ******************************************************************************
+  * @file    prof_ring.h
+  * @brief   Event encoding and lock-free event ring of the task profiler.
+  *          Target independent, can be built and exercised on a host.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __PROF_RING_H
+#define __PROF_RING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+/* Event types */
+#define PROF_EVT_TASK_IN      1U   /*!< Id: task slot, Arg: wake-to-run latency in us (0 if preempted) */
+#define PROF_EVT_TASK_OUT     2U   /*!< Id: task slot                                                  */
+#define PROF_EVT_TASK_READY   3U   /*!< Id: task slot                                                  */
+#define PROF_EVT_IRQ_ENTER    4U   /*!< Id: IRQ number + 16 (exceptions are 0..15)                     */
+#define PROF_EVT_IRQ_EXIT     5U   /*!< Id: IRQ number + 16, Arg: duration in us                       */
+#define PROF_EVT_USER         8U   /*!< Application defined                                            */
+
+/* Exported macro ------------------------------------------------------------*/
+/* Data word of an event: Type[31:28] Id[27:16] Arg[15:0] */
+#define PROF_ENCODE(Type, Id, Arg)  ((((uint32_t)(Type) & 0xFU) << 28) | (((uint32_t)(Id) & 0xFFFU) << 16) | ((uint32_t)(Arg) & 0xFFFFU))
+#define PROF_DECODE_TYPE(Data)      (((Data) >> 28) & 0xFU)
+#define PROF_DECODE_ID(Data)        (((Data) >> 16) & 0xFFFU)
+#define PROF_DECODE_ARG(Data)       ((Data) & 0xFFFFU)
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  One event as stored in the ring and exported.
+  */
+typedef struct
+{
+  volatile uint32_t Seq;   /*!< Write index + 1 once the event is complete */
+  uint32_t          Time;  /*!< Cycle counter                              */
+  uint32_t          Data;  /*!< See PROF_ENCODE()                          */
+} PROF_EventTypeDef;
+
+/**
+  * @brief  Event ring. Any number of producers (tasks, scheduler hooks and
+  *         nested interrupts), one consumer.
+  */
+typedef struct
+{
+  PROF_EventTypeDef *pEvents;     /*!< Event array                      */
+  uint32_t           NumEvents;   /*!< Size of the array, power of 2    */
+  volatile uint32_t  WrIdx;       /*!< Next index to reserve            */
+  volatile uint32_t  RdIdx;       /*!< Next index to read               */
+  volatile uint32_t  NumDropped;  /*!< Events lost because ring was full */
+} PROF_RingTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+int      PROF_RING_Init(PROF_RingTypeDef *pRing, PROF_EventTypeDef *pEvents, uint32_t NumEvents);
+int      PROF_RING_Put(PROF_RingTypeDef *pRing, uint32_t Time, uint32_t Data);
+uint32_t PROF_RING_Get(PROF_RingTypeDef *pRing, PROF_EventTypeDef *pDest, uint32_t MaxEvents);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PROF_RING_H */
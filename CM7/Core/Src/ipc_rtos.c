@@ -0,0 +1,137 @@
+/**
+  ******************************************************************************
+  * @file    ipc_rtos.c
+  * @brief   FreeRTOS binding of the inter-core messaging (Cortex-M7 side).
+  *
+  *          Messages from the Cortex-M4 are consumed by one task, which
+  *          blocks in IPC_RTOS_Receive() on a binary semaphore given by the
+  *          doorbell interrupt. Any number of tasks may send; IPC_RTOS_Send()
+  *          serializes them with a mutex because the ring has a single
+  *          producer.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "ipc_rtos.h"
+
+/* Private variables ---------------------------------------------------------*/
+static StaticSemaphore_t IPC_RxSemBuffer;
+static StaticSemaphore_t IPC_TxMutexBuffer;
+static SemaphoreHandle_t IPC_RxSem;
+static SemaphoreHandle_t IPC_TxMutex;
+
+/* Private function prototypes -----------------------------------------------*/
+static void IPC_RTOS_RxCallback(void);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Doorbell from the Cortex-M4, registered with IPC_RegisterRxCallback().
+  * @retval None
+  */
+static void IPC_RTOS_RxCallback(void)
+{
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+  xSemaphoreGiveFromISR(IPC_RxSem, &xHigherPriorityTaskWoken);
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Creates the synchronization objects. Must be called before the
+  *         scheduler is started; IPC_Init() must have been called before.
+  * @retval None
+  */
+void IPC_RTOS_Init(void)
+{
+  IPC_RxSem   = xSemaphoreCreateBinaryStatic(&IPC_RxSemBuffer);
+  IPC_TxMutex = xSemaphoreCreateMutexStatic(&IPC_TxMutexBuffer);
+  IPC_RegisterRxCallback(IPC_RTOS_RxCallback);
+}
+
+/**
+  * @brief  Waits for the next message from the Cortex-M4.
+  *         The message stays in the ring (zero-copy) until IPC_RTOS_Release().
+  * @param  Timeout: Maximum time to wait in ticks, portMAX_DELAY for ever.
+  * @retval Pointer to the descriptor, NULL on timeout.
+  */
+IPC_MsgTypeDef *IPC_RTOS_Receive(TickType_t Timeout)
+{
+  IPC_MsgTypeDef *pMsg;
+
+  for (;;)
+  {
+    pMsg = IPC_Peek();
+    if (pMsg != NULL)
+    {
+      return pMsg;
+    }
+    if (IPC_PrepareWait() == 0)
+    {
+      continue;
+    }
+    if (xSemaphoreTake(IPC_RxSem, Timeout) != pdTRUE)
+    {
+      IPC_CancelWait();
+      return IPC_Peek();
+    }
+  }
+}
+
+/**
+  * @brief  Removes the message returned by IPC_RTOS_Receive().
+  * @retval None
+  */
+void IPC_RTOS_Release(void)
+{
+  IPC_Release();
+}
+
+/**
+  * @brief  Sends a message to the Cortex-M4. Only the descriptor is copied,
+  *         the buffer at pMsg->pData is handed over.
+  * @param  pMsg: Message to send.
+  * @param  Timeout: Maximum time to wait for a free descriptor in ticks.
+  * @retval 0 on success, -1 if the ring stayed full.
+  */
+int IPC_RTOS_Send(const IPC_MsgTypeDef *pMsg, TickType_t Timeout)
+{
+  IPC_MsgTypeDef *pSlot;
+  TickType_t      t0;
+
+  t0 = xTaskGetTickCount();
+  xSemaphoreTake(IPC_TxMutex, portMAX_DELAY);
+  for (;;)
+  {
+    pSlot = IPC_Alloc();
+    if (pSlot != NULL)
+    {
+      *pSlot = *pMsg;
+      IPC_Send();
+      xSemaphoreGive(IPC_TxMutex);
+      return 0;
+    }
+    if ((xTaskGetTickCount() - t0) >= Timeout)
+    {
+      xSemaphoreGive(IPC_TxMutex);
+      return -1;
+    }
+    /* The Cortex-M4 does not signal freed descriptors, poll once per tick */
+    vTaskDelay(1);
+  }
+}
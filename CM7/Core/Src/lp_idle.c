@@ -0,0 +1,367 @@
+/**
+  ******************************************************************************
+  * @file    lp_idle.c
+  * @brief   Tickless idle for the Cortex-M7 FreeRTOS port, timed by LPTIM1.
+  *
+  *          LPTIM1 runs free on the 32.768 kHz LSE (LSI if the LSE does not
+  *          start) and is the time base while the tick is suppressed. When
+  *          the idle task asks to sleep, the SysTick is stopped, the compare
+  *          register is set to the expected wake time and the core waits in
+  *          WFI. After the wake up the elapsed LPTIM counts give the number
+  *          of whole ticks to step and the position inside the current tick.
+  *          The SysTick is restarted with the rest of that tick period, so
+  *          the tick grid keeps its phase and the truncation of each sleep
+  *          does not add up to a drift of the RTOS time.
+  *          The conversions use ticks in units of 1/65536 LPTIM count, as a
+  *          tick (32.768 counts at 1 kHz) is not a whole number of counts.
+  *          The start of a sleep is read at a random point inside a count,
+  *          on average half a count after the count began, while a wake up
+  *          by the compare match comes right at the start of a count. Such
+  *          a sleep is therefore measured half a count too long on average,
+  *          which is subtracted; otherwise the RTOS time would run ahead by
+  *          15 us per sleep ended by the timer on the LSE.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "lp_idle.h"
+
+/* Private define ------------------------------------------------------------*/
+#define LP_IDLE_MIN_CYCLES      16U     /* Shortest SysTick period on restart */
+#define LP_IDLE_HALF_COUNT_Q16  0x8000U /* Half an LPTIM count, 16.16 */
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t             LP_IDLE_IsInit;
+static uint32_t            LP_IDLE_Clock;            /* LPTIM counts per second */
+static uint32_t            LP_IDLE_CyclesPerTick;    /* SysTick cycles per RTOS tick */
+static uint32_t            LP_IDLE_CountsPerTickQ16; /* LPTIM counts per RTOS tick, 16.16 */
+static uint32_t            LP_IDLE_MaxIdleTicks;     /* Longest sleep the counter can time */
+static uint64_t            LP_IDLE_SleepCountsQ16;   /* Time asleep, 16.16 */
+static uint64_t            LP_IDLE_LatencyCounts;    /* Sum of the wake latencies */
+static uint32_t            LP_IDLE_LatencyMaxCounts;
+static LP_IDLE_StatTypeDef LP_IDLE_Stat;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t LP_IDLE_ReadCounter(void);
+static void     LP_IDLE_SetCompare(uint32_t Value);
+static void     LP_IDLE_RestartTick(uint32_t Cycles);
+static uint64_t LP_IDLE_CountsToUs(uint64_t CountsQ16);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Reads the LPTIM counter. The counter runs on an asynchronous clock,
+  *         so it is read until two consecutive reads agree.
+  * @retval Counter value.
+  */
+static uint32_t LP_IDLE_ReadCounter(void)
+{
+  uint32_t Cnt;
+
+  do
+  {
+    Cnt = LPTIM1->CNT;
+  } while (Cnt != LPTIM1->CNT);
+  return Cnt & LP_IDLE_COUNTER_MAX;
+}
+
+/**
+  * @brief  Writes the compare register and waits until it is taken over
+  *         into the LPTIM clock domain.
+  * @param  Value: Counter value of the next wake up.
+  * @retval None
+  */
+static void LP_IDLE_SetCompare(uint32_t Value)
+{
+  LPTIM1->ICR = LPTIM_ICR_CMPOKCF;
+  LPTIM1->CMP = Value & LP_IDLE_COUNTER_MAX;
+  while ((LPTIM1->ISR & LPTIM_ISR_CMPOK) == 0U)
+  {
+  }
+  /* The old compare value may have matched since interrupts were disabled.
+     The pending interrupt would end the WFI at once. */
+  LPTIM1->ICR = LPTIM_ICR_CMPMCF;
+  __DSB();
+  NVIC_ClearPendingIRQ(LPTIM1_IRQn);
+}
+
+/**
+  * @brief  Restarts the SysTick so that its first period is Cycles long and
+  *         all following periods are one tick long.
+  * @param  Cycles: Length of the first period in CPU cycles.
+  * @retval None
+  */
+static void LP_IDLE_RestartTick(uint32_t Cycles)
+{
+  if (Cycles < LP_IDLE_MIN_CYCLES)
+  {
+    Cycles = LP_IDLE_MIN_CYCLES;
+  }
+  if (Cycles > LP_IDLE_CyclesPerTick)
+  {
+    Cycles = LP_IDLE_CyclesPerTick;
+  }
+  SysTick->LOAD  = Cycles - 1U;
+  SysTick->VAL   = 0U;
+  SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+  SysTick->LOAD  = LP_IDLE_CyclesPerTick - 1U;
+}
+
+/**
+  * @brief  Converts LPTIM counts to microseconds.
+  * @param  CountsQ16: Counts, 16.16.
+  * @retval Microseconds.
+  */
+static uint64_t LP_IDLE_CountsToUs(uint64_t CountsQ16)
+{
+  return ((((CountsQ16 >> 16) * 1000000U) + (((CountsQ16 & 0xFFFFU) * 1000000U) >> 16)) / LP_IDLE_Clock);
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Starts the LSE (or the LSI as fallback) and lets LPTIM1 run free
+  *         on it. Must be called before the scheduler is started.
+  * @retval 0 on success, -1 if no low speed clock could be started.
+  */
+int LP_IDLE_Init(void)
+{
+  RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+  uint32_t           ClkSource;
+
+  RCC_OscInitStruct.PLL.PLLState = RCC_PLL_NONE;
+  if (__HAL_RCC_GET_FLAG(RCC_FLAG_LSERDY) != 0U)
+  {
+    ClkSource     = RCC_LPTIM1CLKSOURCE_LSE;
+    LP_IDLE_Clock = LSE_VALUE;
+  }
+  else
+  {
+    RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_LSE;
+    RCC_OscInitStruct.LSEState       = LP_IDLE_LSE_STATE;
+    if (HAL_RCC_OscConfig(&RCC_OscInitStruct) == HAL_OK)
+    {
+      ClkSource     = RCC_LPTIM1CLKSOURCE_LSE;
+      LP_IDLE_Clock = LSE_VALUE;
+    }
+    else
+    {
+      RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_LSI;
+      RCC_OscInitStruct.LSIState       = RCC_LSI_ON;
+      if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
+      {
+        return -1;
+      }
+      ClkSource     = RCC_LPTIM1CLKSOURCE_LSI;
+      LP_IDLE_Clock = LSI_VALUE;
+    }
+  }
+
+  __HAL_RCC_LPTIM1_CONFIG(ClkSource);
+  __HAL_RCC_LPTIM1_CLK_ENABLE();
+  __HAL_RCC_LPTIM1_FORCE_RESET();
+  __HAL_RCC_LPTIM1_RELEASE_RESET();
+
+  /* Kernel clock, no prescaler, software start. IER is only writable while
+     the timer is disabled, ARR and CMP only while it is enabled. */
+  LPTIM1->CFGR = 0U;
+  LPTIM1->IER  = LPTIM_IER_CMPMIE;
+  LPTIM1->CR   = LPTIM_CR_ENABLE;
+  LPTIM1->ICR  = LPTIM_ICR_ARROKCF;
+  LPTIM1->ARR  = LP_IDLE_COUNTER_MAX;
+  while ((LPTIM1->ISR & LPTIM_ISR_ARROK) == 0U)
+  {
+  }
+  LPTIM1->CR  |= LPTIM_CR_CNTSTRT;
+
+  HAL_NVIC_SetPriority(LPTIM1_IRQn, LP_IDLE_IRQ_PRIORITY, 0);
+  HAL_NVIC_EnableIRQ(LPTIM1_IRQn);
+
+  LP_IDLE_CyclesPerTick    = configCPU_CLOCK_HZ / configTICK_RATE_HZ;
+  LP_IDLE_CountsPerTickQ16 = (uint32_t)(((uint64_t)LP_IDLE_Clock << 16) / configTICK_RATE_HZ);
+  LP_IDLE_MaxIdleTicks     = (uint32_t)(((uint64_t)(LP_IDLE_COUNTER_MAX - LP_IDLE_GUARD_COUNTS) << 16) / LP_IDLE_CountsPerTickQ16);
+  LP_IDLE_IsInit           = 1U;
+  return 0;
+}
+
+/**
+  * @brief  Returns the LPTIM clock in Hz, 0 before LP_IDLE_Init().
+  * @retval Clock frequency.
+  */
+uint32_t LP_IDLE_GetClock(void)
+{
+  return LP_IDLE_Clock;
+}
+
+/**
+  * @brief  Returns the idle residency counters.
+  * @param  pStat: Receives the counters.
+  * @retval None
+  */
+void LP_IDLE_GetStat(LP_IDLE_StatTypeDef *pStat)
+{
+  taskENTER_CRITICAL();
+  *pStat = LP_IDLE_Stat;
+  if (LP_IDLE_Clock != 0U)
+  {
+    pStat->SleepTimeUs      = LP_IDLE_CountsToUs(LP_IDLE_SleepCountsQ16);
+    pStat->WakeLatencyMaxUs = (uint32_t)LP_IDLE_CountsToUs((uint64_t)LP_IDLE_LatencyMaxCounts << 16);
+    if (LP_IDLE_Stat.NumTimerWakeups != 0U)
+    {
+      pStat->WakeLatencyAvgUs = (uint32_t)LP_IDLE_CountsToUs((LP_IDLE_LatencyCounts << 16) / LP_IDLE_Stat.NumTimerWakeups);
+    }
+  }
+  taskEXIT_CRITICAL();
+}
+
+/**
+  * @brief  Clears the idle residency counters.
+  * @retval None
+  */
+void LP_IDLE_ResetStat(void)
+{
+  taskENTER_CRITICAL();
+  LP_IDLE_Stat.NumSleeps        = 0;
+  LP_IDLE_Stat.NumAborts        = 0;
+  LP_IDLE_Stat.NumTimerWakeups  = 0;
+  LP_IDLE_Stat.NumLateTicks     = 0;
+  LP_IDLE_Stat.TicksSuppressed  = 0;
+  LP_IDLE_Stat.SleepTimeUs      = 0;
+  LP_IDLE_Stat.WakeLatencyMaxUs = 0;
+  LP_IDLE_Stat.WakeLatencyAvgUs = 0;
+  LP_IDLE_SleepCountsQ16        = 0;
+  LP_IDLE_LatencyCounts         = 0;
+  LP_IDLE_LatencyMaxCounts      = 0;
+  taskEXIT_CRITICAL();
+}
+
+/**
+  * @brief  LPTIM1 interrupt. Only serves to wake the core.
+  * @retval None
+  */
+void LP_IDLE_IRQHandler(void)
+{
+  if ((LPTIM1->ISR & LPTIM_ISR_CMPM) != 0U)
+  {
+    LPTIM1->ICR = LPTIM_ICR_CMPMCF;
+  }
+}
+
+/**
+  * @brief  Replaces the SysTick based implementation of the port, called by
+  *         the idle task with the scheduler suspended.
+  * @param  xExpectedIdleTime: Ticks until the next task is due.
+  * @retval None
+  */
+void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime)
+{
+  uint32_t Start;
+  uint32_t Planned;
+  uint32_t Elapsed;
+  uint32_t Latency;
+  uint32_t RemainCycles;
+  uint32_t RemainQ16;
+  uint32_t PhaseQ16;
+  uint32_t CompleteTicks;
+  uint32_t Cycles;
+  uint64_t ElapsedQ16;
+  int      TimerWakeup;
+
+  if (LP_IDLE_IsInit == 0U)
+  {
+    return;
+  }
+  if (xExpectedIdleTime > LP_IDLE_MaxIdleTicks)
+  {
+    xExpectedIdleTime = LP_IDLE_MaxIdleTicks;
+  }
+
+  __disable_irq();
+  __DSB();
+  __ISB();
+
+  /* A task may have been readied or a tick may be pending since the idle
+     task decided to sleep. */
+  if ((eTaskConfirmSleepModeStatus() == eAbortSleep) || ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0U))
+  {
+    LP_IDLE_Stat.NumAborts++;
+    __enable_irq();
+    return;
+  }
+
+  /* Stop the tick. The rest of the running tick period is slept as well. */
+  SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+  Start        = LP_IDLE_ReadCounter();
+  RemainCycles = SysTick->VAL;
+  RemainQ16    = (uint32_t)((((uint64_t)RemainCycles * LP_IDLE_Clock) << 16) / configCPU_CLOCK_HZ);
+  Planned      = (uint32_t)((RemainQ16 + (uint64_t)(xExpectedIdleTime - 1U) * LP_IDLE_CountsPerTickQ16) >> 16);
+  LP_IDLE_SetCompare(Start + Planned);
+
+  __DSB();
+  __WFI();
+  __ISB();
+
+  Elapsed     = (LP_IDLE_ReadCounter() - Start) & LP_IDLE_COUNTER_MAX;
+  TimerWakeup = ((LPTIM1->ISR & LPTIM_ISR_CMPM) != 0U);
+  ElapsedQ16  = (uint64_t)Elapsed << 16;
+  if (TimerWakeup != 0)
+  {
+    /* Woken at the start of a count, but the start was read inside one */
+    if (ElapsedQ16 >= LP_IDLE_HALF_COUNT_Q16)
+    {
+      ElapsedQ16 -= LP_IDLE_HALF_COUNT_Q16;
+    }
+    Latency = (Elapsed - Planned) & LP_IDLE_COUNTER_MAX;
+    LP_IDLE_LatencyCounts += Latency;
+    if (Latency > LP_IDLE_LatencyMaxCounts)
+    {
+      LP_IDLE_LatencyMaxCounts = Latency;
+    }
+  }
+  LP_IDLE_SleepCountsQ16 += ElapsedQ16;
+
+  if (ElapsedQ16 < RemainQ16)
+  {
+    /* Woken inside the tick period that was running when the tick stopped */
+    CompleteTicks = 0;
+    Cycles        = RemainCycles - (uint32_t)(((ElapsedQ16 * configCPU_CLOCK_HZ) >> 16) / LP_IDLE_Clock);
+  }
+  else
+  {
+    ElapsedQ16   -= RemainQ16;
+    CompleteTicks = 1U + (uint32_t)(ElapsedQ16 / LP_IDLE_CountsPerTickQ16);
+    PhaseQ16      = (uint32_t)(ElapsedQ16 % LP_IDLE_CountsPerTickQ16);
+    Cycles        = (uint32_t)((((uint64_t)(LP_IDLE_CountsPerTickQ16 - PhaseQ16) * configCPU_CLOCK_HZ) >> 16) / LP_IDLE_Clock);
+    if (CompleteTicks >= xExpectedIdleTime)
+    {
+      /* The wake up time is reached. The kernel must not be stepped onto the
+         unblock time itself, the last tick is delivered by the SysTick
+         interrupt so the waiting task is readied by the tick handler. */
+      LP_IDLE_Stat.NumLateTicks += CompleteTicks - xExpectedIdleTime;
+      CompleteTicks              = xExpectedIdleTime - 1U;
+      SCB->ICSR                  = SCB_ICSR_PENDSTSET_Msk;
+    }
+  }
+
+  LP_IDLE_RestartTick(Cycles);
+  vTaskStepTick(CompleteTicks);
+
+  LP_IDLE_Stat.NumSleeps++;
+  LP_IDLE_Stat.NumTimerWakeups += (uint32_t)TimerWakeup;
+  LP_IDLE_Stat.TicksSuppressed += CompleteTicks;
+
+  __enable_irq();
+}
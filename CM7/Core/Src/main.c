@@ -24,6 +24,10 @@
 /* Private includes -----------    -----------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "usbh.h"
+#include "ipc_rtos.h"
+#include "os_pool.h"
+#include "lp_idle.h"
+#include "mem_map.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -128,6 +132,8 @@ int main(void)
 HSEM notification */
 /*HW semaphore Clock enable*/
 __HAL_RCC_HSEM_CLK_ENABLE();
+/* Set up the inter-core rings before the CM4 can use them */
+IPC_Init();
 /*Take HSEM */
 HAL_HSEM_FastTake(HSEM_ID_0);
 /*Release HSEM in order to notify the CPU2(CM4)*/
@@ -149,7 +155,13 @@ Error_Handler();
   MX_GPIO_Init();
   MX_USART3_UART_Init();
   /* USER CODE BEGIN 2 */
-
+  OS_POOL_Init();
+  /* Without SDRAM (the CM4 did not bring it up in time) only "sram" is used */
+  (void)MEM_MAP_Init();
+  if (LP_IDLE_Init() != 0)
+  {
+    Error_Handler();
+  }
   /* USER CODE END 2 */
 
   /* Init scheduler */
@@ -161,6 +173,7 @@ Error_Handler();
 
   /* USER CODE BEGIN RTOS_SEMAPHORES */
   /* add semaphores, ... */
+  IPC_RTOS_Init();
   /* USER CODE END RTOS_SEMAPHORES */
 
   /* USER CODE BEGIN RTOS_TIMERS */
@@ -173,7 +186,7 @@ Error_Handler();
 
   /* Create the thread(s) */
   /* creation of defaultTask */
-  defaultTaskHandle = osThreadNew(StartDefaultTask, NULL, &defaultTask_attributes);
+  defaultTaskHandle = OS_POOL_ThreadNew(StartDefaultTask, NULL, &defaultTask_attributes);
 
   /* USER CODE BEGIN RTOS_THREADS */
   /* add threads, ... */
@@ -355,8 +368,8 @@ void StartDefaultTask(void *argument)
   // TODO: this is for ST USB HostMX_USB_HOST_Init();
   /* USER CODE BEGIN 5 */
   USBH_Init();
-  USBHTaskHandle = osThreadNew((osThreadFunc_t)USBH_Task, NULL, &USBHTask_attributes);
-  USBHIsrTaskHandle = osThreadNew((osThreadFunc_t)USBH_ISRTask, NULL, &USBHIsrTask_attributes);
+  USBHTaskHandle = OS_POOL_ThreadNew((osThreadFunc_t)USBH_Task, NULL, &USBHTask_attributes);
+  USBHIsrTaskHandle = OS_POOL_ThreadNew((osThreadFunc_t)USBH_ISRTask, NULL, &USBHIsrTask_attributes);
 
   for (;;)
   {
@@ -0,0 +1,599 @@
+/**
+  ******************************************************************************
+  * @file    os_pool.c
+  * @brief   Fixed-size pools for statically allocated FreeRTOS objects.
+  *
+  *          Every pool is an array of equally sized objects with a free list
+  *          threaded through the unused objects, so allocation and release are
+  *          O(1) and run in a short critical section instead of the first-fit
+  *          search of heap_4 under a suspended scheduler. The objects are
+  *          passed to the xxxCreateStatic() functions of FreeRTOS; because a
+  *          static create returns the buffer as handle, a handle can be given
+  *          back with OS_POOL_Free() after the object has been deleted.
+  *
+  *          The create helpers below fall back to the FreeRTOS heap when a
+  *          pool is empty, so an undersized pool costs determinism but not
+  *          function; NumHeap of the pool statistics counts these objects.
+  *          Objects from the heap are released by the FreeRTOS delete
+  *          function itself.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "event_groups.h"
+#include "os_pool.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct OS_POOL_ITEM_s
+{
+  struct OS_POOL_ITEM_s *pNext;
+} OS_POOL_ItemTypeDef;
+
+typedef struct
+{
+  uint8_t             *pBase;
+  OS_POOL_ItemTypeDef *pFree;
+  OS_POOL_StatTypeDef  Stat;
+} OS_POOL_TypeDef;
+
+/* Private define ------------------------------------------------------------*/
+#define OS_POOL_STACK_WORDS(NumBytes)   ((NumBytes) / sizeof(StackType_t))
+
+/* Private variables ---------------------------------------------------------*/
+static StaticTask_t       OS_POOL_aTCB[OS_POOL_NUM_TASKS] OS_POOL_CB_SECTION;
+static StaticSemaphore_t  OS_POOL_aMutex[OS_POOL_NUM_MUTEXES] OS_POOL_CB_SECTION;
+static StaticEventGroup_t OS_POOL_aEventGroup[OS_POOL_NUM_EVENT_GROUPS] OS_POOL_CB_SECTION;
+static StaticQueue_t      OS_POOL_aQueue[OS_POOL_NUM_QUEUES] OS_POOL_CB_SECTION;
+static uint8_t            OS_POOL_aQueueStorage[OS_POOL_NUM_QUEUES][OS_POOL_QUEUE_STORAGE_SIZE] __attribute__((aligned(8))) OS_POOL_CB_SECTION;
+static StackType_t        OS_POOL_aStackSmall[OS_POOL_NUM_STACKS_SMALL][OS_POOL_STACK_WORDS(OS_POOL_STACK_SMALL_SIZE)] __attribute__((aligned(8))) OS_POOL_STACK_SECTION;
+static StackType_t        OS_POOL_aStackMedium[OS_POOL_NUM_STACKS_MEDIUM][OS_POOL_STACK_WORDS(OS_POOL_STACK_MEDIUM_SIZE)] __attribute__((aligned(8))) OS_POOL_STACK_SECTION;
+static StackType_t        OS_POOL_aStackLarge[OS_POOL_NUM_STACKS_LARGE][OS_POOL_STACK_WORDS(OS_POOL_STACK_LARGE_SIZE)] __attribute__((aligned(8))) OS_POOL_STACK_SECTION;
+
+/* Stack assigned to each TCB by OS_POOL_ThreadNew() */
+static StackType_t       *OS_POOL_apTaskStack[OS_POOL_NUM_TASKS];
+/* Storage assigned to each queue by OS_POOL_MessageQueueNew() */
+static uint8_t           *OS_POOL_apQueueStorage[OS_POOL_NUM_QUEUES];
+
+static OS_POOL_TypeDef    OS_POOL_aPool[OS_POOL_COUNT];
+
+/* Private function prototypes -----------------------------------------------*/
+static void OS_POOL_Setup(OS_POOL_IdTypeDef Id, void *pBase, uint32_t ItemSize, uint32_t NumItems);
+static OS_POOL_TypeDef *OS_POOL_Find(const void *p);
+static void OS_POOL_CountHeap(OS_POOL_IdTypeDef Id);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Links all objects of a pool into its free list.
+  * @param  Id: Pool to set up.
+  * @param  pBase: Object array.
+  * @param  ItemSize: Size of one object in bytes.
+  * @param  NumItems: Number of objects.
+  * @retval None
+  */
+static void OS_POOL_Setup(OS_POOL_IdTypeDef Id, void *pBase, uint32_t ItemSize, uint32_t NumItems)
+{
+  OS_POOL_TypeDef     *pPool;
+  OS_POOL_ItemTypeDef *pItem;
+  uint32_t             i;
+
+  pPool = &OS_POOL_aPool[Id];
+  memset(pPool, 0, sizeof(*pPool));
+  pPool->pBase         = (uint8_t *)pBase;
+  pPool->Stat.ItemSize = ItemSize;
+  pPool->Stat.NumItems = (uint16_t)NumItems;
+  pPool->pFree         = NULL;
+  for (i = NumItems; i > 0U; i--)
+  {
+    pItem        = (OS_POOL_ItemTypeDef *)(pPool->pBase + (i - 1U) * ItemSize);
+    pItem->pNext = pPool->pFree;
+    pPool->pFree = pItem;
+  }
+}
+
+/**
+  * @brief  Returns the pool an object belongs to.
+  * @param  p: Object.
+  * @retval Pool, NULL if p is not a pool object.
+  */
+static OS_POOL_TypeDef *OS_POOL_Find(const void *p)
+{
+  OS_POOL_TypeDef *pPool;
+  const uint8_t   *pEnd;
+  unsigned         i;
+
+  for (i = 0; i < (unsigned)OS_POOL_COUNT; i++)
+  {
+    pPool = &OS_POOL_aPool[i];
+    pEnd  = pPool->pBase + pPool->Stat.ItemSize * pPool->Stat.NumItems;
+    if (((const uint8_t *)p >= pPool->pBase) && ((const uint8_t *)p < pEnd))
+    {
+      return pPool;
+    }
+  }
+  return NULL;
+}
+
+/**
+  * @brief  Counts an object created on the heap because the pool was empty.
+  * @param  Id: Pool.
+  * @retval None
+  */
+static void OS_POOL_CountHeap(OS_POOL_IdTypeDef Id)
+{
+  taskENTER_CRITICAL();
+  OS_POOL_aPool[Id].Stat.NumHeap++;
+  taskEXIT_CRITICAL();
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Initializes all pools. Must be called before any object is created
+  *         from a pool, i.e. before osKernelInitialize().
+  * @retval None
+  */
+void OS_POOL_Init(void)
+{
+  OS_POOL_Setup(OS_POOL_TCB,           OS_POOL_aTCB,          sizeof(OS_POOL_aTCB[0]),          OS_POOL_NUM_TASKS);
+  OS_POOL_Setup(OS_POOL_STACK_SMALL,   OS_POOL_aStackSmall,   sizeof(OS_POOL_aStackSmall[0]),   OS_POOL_NUM_STACKS_SMALL);
+  OS_POOL_Setup(OS_POOL_STACK_MEDIUM,  OS_POOL_aStackMedium,  sizeof(OS_POOL_aStackMedium[0]),  OS_POOL_NUM_STACKS_MEDIUM);
+  OS_POOL_Setup(OS_POOL_STACK_LARGE,   OS_POOL_aStackLarge,   sizeof(OS_POOL_aStackLarge[0]),   OS_POOL_NUM_STACKS_LARGE);
+  OS_POOL_Setup(OS_POOL_MUTEX,         OS_POOL_aMutex,        sizeof(OS_POOL_aMutex[0]),        OS_POOL_NUM_MUTEXES);
+  OS_POOL_Setup(OS_POOL_EVENT_GROUP,   OS_POOL_aEventGroup,   sizeof(OS_POOL_aEventGroup[0]),   OS_POOL_NUM_EVENT_GROUPS);
+  OS_POOL_Setup(OS_POOL_QUEUE,         OS_POOL_aQueue,        sizeof(OS_POOL_aQueue[0]),        OS_POOL_NUM_QUEUES);
+  OS_POOL_Setup(OS_POOL_QUEUE_STORAGE, OS_POOL_aQueueStorage, sizeof(OS_POOL_aQueueStorage[0]), OS_POOL_NUM_QUEUES);
+  memset(OS_POOL_apTaskStack, 0, sizeof(OS_POOL_apTaskStack));
+  memset(OS_POOL_apQueueStorage, 0, sizeof(OS_POOL_apQueueStorage));
+}
+
+/**
+  * @brief  Allocates an object from a pool.
+  * @param  Id: Pool to allocate from.
+  * @retval Pointer to the uninitialized object, NULL if the pool is empty.
+  */
+void *OS_POOL_Alloc(OS_POOL_IdTypeDef Id)
+{
+  OS_POOL_TypeDef     *pPool;
+  OS_POOL_ItemTypeDef *pItem;
+
+  pPool = &OS_POOL_aPool[Id];
+  taskENTER_CRITICAL();
+  pItem = pPool->pFree;
+  if (pItem != NULL)
+  {
+    pPool->pFree = pItem->pNext;
+    pPool->Stat.NumUsed++;
+    if (pPool->Stat.NumUsed > pPool->Stat.MaxUsed)
+    {
+      pPool->Stat.MaxUsed = pPool->Stat.NumUsed;
+    }
+  }
+  else
+  {
+    pPool->Stat.NumFailed++;
+  }
+  taskEXIT_CRITICAL();
+  return pItem;
+}
+
+/**
+  * @brief  Returns an object to its pool. The FreeRTOS object using it must
+  *         have been deleted before.
+  * @param  p: Object (or the handle returned by a static create function).
+  * @retval 0 on success, -1 if p does not belong to a pool.
+  */
+int OS_POOL_Free(void *p)
+{
+  OS_POOL_TypeDef     *pPool;
+  OS_POOL_ItemTypeDef *pItem;
+
+  pPool = OS_POOL_Find(p);
+  if (pPool == NULL)
+  {
+    return -1;
+  }
+  pItem = (OS_POOL_ItemTypeDef *)p;
+  taskENTER_CRITICAL();
+  pItem->pNext = pPool->pFree;
+  pPool->pFree = pItem;
+  pPool->Stat.NumUsed--;
+  taskEXIT_CRITICAL();
+  return 0;
+}
+
+/**
+  * @brief  Allocates a stack from the smallest size class that fits.
+  *         If that class is exhausted, the next larger one is tried.
+  * @param  NumBytes: Required stack size in bytes.
+  * @param  pNumBytes: [OUT] Size of the allocated stack in bytes.
+  * @retval Pointer to the stack, NULL if no stack is available.
+  */
+StackType_t *OS_POOL_AllocStack(uint32_t NumBytes, uint32_t *pNumBytes)
+{
+  OS_POOL_IdTypeDef Id;
+  StackType_t      *pStack;
+
+  if (NumBytes <= OS_POOL_STACK_SMALL_SIZE)
+  {
+    Id = OS_POOL_STACK_SMALL;
+  }
+  else if (NumBytes <= OS_POOL_STACK_MEDIUM_SIZE)
+  {
+    Id = OS_POOL_STACK_MEDIUM;
+  }
+  else if (NumBytes <= OS_POOL_STACK_LARGE_SIZE)
+  {
+    Id = OS_POOL_STACK_LARGE;
+  }
+  else
+  {
+    return NULL;
+  }
+  for (; Id <= OS_POOL_STACK_LARGE; Id++)
+  {
+    pStack = (StackType_t *)OS_POOL_Alloc(Id);
+    if (pStack != NULL)
+    {
+      *pNumBytes = OS_POOL_aPool[Id].Stat.ItemSize;
+      return pStack;
+    }
+  }
+  return NULL;
+}
+
+/**
+  * @brief  Retrieves the usage statistics of a pool.
+  * @param  Id: Pool.
+  * @param  pStat: [OUT] Statistics.
+  * @retval None
+  */
+void OS_POOL_GetStat(OS_POOL_IdTypeDef Id, OS_POOL_StatTypeDef *pStat)
+{
+  taskENTER_CRITICAL();
+  *pStat = OS_POOL_aPool[Id].Stat;
+  taskEXIT_CRITICAL();
+}
+
+/**
+  * @brief  Creates a CMSIS-RTOS2 thread with control block and stack taken
+  *         from the pools. Same parameters as osThreadNew(); cb_mem,
+  *         cb_size and stack_mem of attr are ignored. If a pool is
+  *         exhausted, the thread is created on the heap.
+  * @param  func: Thread function.
+  * @param  argument: Argument passed to func.
+  * @param  attr: Thread attributes, stack_size is required.
+  * @retval Thread ID, NULL on error.
+  */
+osThreadId_t OS_POOL_ThreadNew(osThreadFunc_t func, void *argument, const osThreadAttr_t *attr)
+{
+  osThreadAttr_t Attr;
+  osThreadId_t   Id;
+  StaticTask_t  *pTCB;
+  StackType_t   *pStack;
+  uint32_t       NumBytes;
+
+  if ((attr == NULL) || (attr->stack_size == 0U))
+  {
+    return NULL;
+  }
+  Attr = *attr;
+  pTCB = (StaticTask_t *)OS_POOL_Alloc(OS_POOL_TCB);
+  pStack = NULL;
+  if (pTCB != NULL)
+  {
+    pStack = OS_POOL_AllocStack(attr->stack_size, &NumBytes);
+  }
+  if (pStack == NULL)
+  {
+    if (pTCB != NULL)
+    {
+      (void)OS_POOL_Free(pTCB);
+    }
+    Attr.cb_mem    = NULL;
+    Attr.cb_size   = 0U;
+    Attr.stack_mem = NULL;
+    OS_POOL_CountHeap(OS_POOL_TCB);
+    return osThreadNew(func, argument, &Attr);
+  }
+  OS_POOL_apTaskStack[pTCB - OS_POOL_aTCB] = pStack;
+  Attr.cb_mem     = pTCB;
+  Attr.cb_size    = sizeof(StaticTask_t);
+  Attr.stack_mem  = pStack;
+  Attr.stack_size = NumBytes;
+  Id = osThreadNew(func, argument, &Attr);
+  if (Id == NULL)
+  {
+    (void)OS_POOL_Free(pStack);
+    (void)OS_POOL_Free(pTCB);
+  }
+  return Id;
+}
+
+/**
+  * @brief  Returns control block and stack of a thread created by
+  *         OS_POOL_ThreadNew(). The thread must have been terminated by
+  *         another thread; a thread deleting itself still runs on its stack.
+  *         Threads created on the heap are ignored, FreeRTOS freed them.
+  * @param  thread_id: Thread ID.
+  * @retval None
+  */
+void OS_POOL_ThreadFree(osThreadId_t thread_id)
+{
+  StaticTask_t *pTCB;
+  StackType_t  *pStack;
+
+  pTCB = (StaticTask_t *)thread_id;
+  if ((pTCB < &OS_POOL_aTCB[0]) || (pTCB >= &OS_POOL_aTCB[OS_POOL_NUM_TASKS]))
+  {
+    return;
+  }
+  pStack = OS_POOL_apTaskStack[pTCB - OS_POOL_aTCB];
+  OS_POOL_apTaskStack[pTCB - OS_POOL_aTCB] = NULL;
+  if (pStack != NULL)
+  {
+    (void)OS_POOL_Free(pStack);
+  }
+  (void)OS_POOL_Free(pTCB);
+}
+
+/**
+  * @brief  Creates an event group in the event group pool.
+  * @retval Handle, NULL if neither pool nor heap have memory.
+  */
+EventGroupHandle_t OS_POOL_EventGroupCreate(void)
+{
+  StaticEventGroup_t *pBuffer;
+
+  pBuffer = (StaticEventGroup_t *)OS_POOL_Alloc(OS_POOL_EVENT_GROUP);
+  if (pBuffer == NULL)
+  {
+    OS_POOL_CountHeap(OS_POOL_EVENT_GROUP);
+    return xEventGroupCreate();
+  }
+  return xEventGroupCreateStatic(pBuffer);
+}
+
+/**
+  * @brief  Deletes an event group created by OS_POOL_EventGroupCreate().
+  * @param  hEvent: Event group.
+  * @retval None
+  */
+void OS_POOL_EventGroupDelete(EventGroupHandle_t hEvent)
+{
+  vEventGroupDelete(hEvent);
+  (void)OS_POOL_Free(hEvent);
+}
+
+/**
+  * @brief  Creates a recursive mutex in the mutex pool.
+  * @retval Handle, NULL if neither pool nor heap have memory.
+  */
+SemaphoreHandle_t OS_POOL_RecursiveMutexCreate(void)
+{
+  StaticSemaphore_t *pBuffer;
+
+  pBuffer = (StaticSemaphore_t *)OS_POOL_Alloc(OS_POOL_MUTEX);
+  if (pBuffer == NULL)
+  {
+    OS_POOL_CountHeap(OS_POOL_MUTEX);
+    return xSemaphoreCreateRecursiveMutex();
+  }
+  return xSemaphoreCreateRecursiveMutexStatic(pBuffer);
+}
+
+/**
+  * @brief  Deletes a mutex or semaphore created by OS_POOL_RecursiveMutexCreate().
+  * @param  hSem: Mutex or semaphore.
+  * @retval None
+  */
+void OS_POOL_SemaphoreDelete(SemaphoreHandle_t hSem)
+{
+  vSemaphoreDelete(hSem);
+  (void)OS_POOL_Free(hSem);
+}
+
+/**
+  * @brief  osMutexNew() with the control block taken from the mutex pool.
+  *         A cb_mem given by the caller is used as is.
+  * @param  attr: Mutex attributes, may be NULL.
+  * @retval Mutex ID, NULL on error.
+  */
+osMutexId_t OS_POOL_MutexNew(const osMutexAttr_t *attr)
+{
+  osMutexAttr_t Attr;
+  osMutexId_t   Id;
+  void         *pCB;
+
+  if ((attr != NULL) && (attr->cb_mem != NULL))
+  {
+    return osMutexNew(attr);
+  }
+  memset(&Attr, 0, sizeof(Attr));
+  if (attr != NULL)
+  {
+    Attr = *attr;
+  }
+  pCB = OS_POOL_Alloc(OS_POOL_MUTEX);
+  if (pCB == NULL)
+  {
+    OS_POOL_CountHeap(OS_POOL_MUTEX);
+    return osMutexNew(&Attr);
+  }
+  Attr.cb_mem  = pCB;
+  Attr.cb_size = sizeof(StaticSemaphore_t);
+  Id = osMutexNew(&Attr);
+  if (Id == NULL)
+  {
+    (void)OS_POOL_Free(pCB);
+  }
+  return Id;
+}
+
+/**
+  * @brief  Deletes a mutex created by OS_POOL_MutexNew().
+  * @param  mutex_id: Mutex ID.
+  * @retval Status of osMutexDelete().
+  */
+osStatus_t OS_POOL_MutexDelete(osMutexId_t mutex_id)
+{
+  osStatus_t Status;
+
+  Status = osMutexDelete(mutex_id);
+  if (Status == osOK)
+  {
+    /* Bit 0 of the ID marks a recursive mutex (cmsis_os2.c) */
+    (void)OS_POOL_Free((void *)((uint32_t)mutex_id & ~1U));
+  }
+  return Status;
+}
+
+/**
+  * @brief  osEventFlagsNew() with the control block taken from the event
+  *         group pool. A cb_mem given by the caller is used as is.
+  * @param  attr: Event flags attributes, may be NULL.
+  * @retval Event flags ID, NULL on error.
+  */
+osEventFlagsId_t OS_POOL_EventFlagsNew(const osEventFlagsAttr_t *attr)
+{
+  osEventFlagsAttr_t Attr;
+  osEventFlagsId_t   Id;
+  void              *pCB;
+
+  if ((attr != NULL) && (attr->cb_mem != NULL))
+  {
+    return osEventFlagsNew(attr);
+  }
+  memset(&Attr, 0, sizeof(Attr));
+  if (attr != NULL)
+  {
+    Attr = *attr;
+  }
+  pCB = OS_POOL_Alloc(OS_POOL_EVENT_GROUP);
+  if (pCB == NULL)
+  {
+    OS_POOL_CountHeap(OS_POOL_EVENT_GROUP);
+    return osEventFlagsNew(&Attr);
+  }
+  Attr.cb_mem  = pCB;
+  Attr.cb_size = sizeof(StaticEventGroup_t);
+  Id = osEventFlagsNew(&Attr);
+  if (Id == NULL)
+  {
+    (void)OS_POOL_Free(pCB);
+  }
+  return Id;
+}
+
+/**
+  * @brief  Deletes event flags created by OS_POOL_EventFlagsNew().
+  * @param  ef_id: Event flags ID.
+  * @retval Status of osEventFlagsDelete().
+  */
+osStatus_t OS_POOL_EventFlagsDelete(osEventFlagsId_t ef_id)
+{
+  osStatus_t Status;
+
+  Status = osEventFlagsDelete(ef_id);
+  if (Status == osOK)
+  {
+    (void)OS_POOL_Free(ef_id);
+  }
+  return Status;
+}
+
+/**
+  * @brief  osMessageQueueNew() with control block and storage taken from
+  *         the queue pools. Queues needing more than
+  *         OS_POOL_QUEUE_STORAGE_SIZE bytes are created on the heap.
+  *         Memory given by the caller is used as is.
+  * @param  msg_count: Maximum number of messages.
+  * @param  msg_size: Size of a message in bytes.
+  * @param  attr: Queue attributes, may be NULL.
+  * @retval Queue ID, NULL on error.
+  */
+osMessageQueueId_t OS_POOL_MessageQueueNew(uint32_t msg_count, uint32_t msg_size, const osMessageQueueAttr_t *attr)
+{
+  osMessageQueueAttr_t Attr;
+  osMessageQueueId_t   Id;
+  StaticQueue_t       *pCB;
+  uint8_t             *pStorage;
+
+  if ((attr != NULL) && ((attr->cb_mem != NULL) || (attr->mq_mem != NULL)))
+  {
+    return osMessageQueueNew(msg_count, msg_size, attr);
+  }
+  memset(&Attr, 0, sizeof(Attr));
+  if (attr != NULL)
+  {
+    Attr = *attr;
+  }
+  pCB      = NULL;
+  pStorage = NULL;
+  if ((uint64_t)msg_count * msg_size <= OS_POOL_QUEUE_STORAGE_SIZE)
+  {
+    pCB = (StaticQueue_t *)OS_POOL_Alloc(OS_POOL_QUEUE);
+    if (pCB != NULL)
+    {
+      pStorage = (uint8_t *)OS_POOL_Alloc(OS_POOL_QUEUE_STORAGE);
+      if (pStorage == NULL)
+      {
+        (void)OS_POOL_Free(pCB);
+        pCB = NULL;
+      }
+    }
+  }
+  if (pCB == NULL)
+  {
+    OS_POOL_CountHeap(OS_POOL_QUEUE);
+    return osMessageQueueNew(msg_count, msg_size, &Attr);
+  }
+  Attr.cb_mem  = pCB;
+  Attr.cb_size = sizeof(StaticQueue_t);
+  Attr.mq_mem  = pStorage;
+  Attr.mq_size = OS_POOL_QUEUE_STORAGE_SIZE;
+  Id = osMessageQueueNew(msg_count, msg_size, &Attr);
+  if (Id == NULL)
+  {
+    (void)OS_POOL_Free(pStorage);
+    (void)OS_POOL_Free(pCB);
+    return NULL;
+  }
+  OS_POOL_apQueueStorage[pCB - OS_POOL_aQueue] = pStorage;
+  return Id;
+}
+
+/**
+  * @brief  Deletes a queue created by OS_POOL_MessageQueueNew().
+  * @param  mq_id: Queue ID.
+  * @retval Status of osMessageQueueDelete().
+  */
+osStatus_t OS_POOL_MessageQueueDelete(osMessageQueueId_t mq_id)
+{
+  StaticQueue_t *pCB;
+  osStatus_t     Status;
+
+  Status = osMessageQueueDelete(mq_id);
+  pCB = (StaticQueue_t *)mq_id;
+  if ((Status == osOK) && (pCB >= &OS_POOL_aQueue[0]) && (pCB < &OS_POOL_aQueue[OS_POOL_NUM_QUEUES]))
+  {
+    (void)OS_POOL_Free(OS_POOL_apQueueStorage[pCB - OS_POOL_aQueue]);
+    OS_POOL_apQueueStorage[pCB - OS_POOL_aQueue] = NULL;
+    (void)OS_POOL_Free(pCB);
+  }
+  return Status;
+}
@@ -0,0 +1,389 @@
+/**
+  ******************************************************************************
+  * @file    prof.c
+  * @brief   Run-time task profiler and scheduling latency tracer (Cortex-M7).
+  *
+  *          Time base is the DWT cycle counter. The FreeRTOS trace hooks
+  *          (FreeRTOSConfig.h) call PROF_TaskSwitchedIn/Out() and
+  *          PROF_TaskReady(); interrupt handlers are instrumented with
+  *          PROF_IRQ_ENTER()/PROF_IRQ_EXIT(). Per-task CPU time, a histogram of
+  *          the wake-to-run latency per task and the time per IRQ are summed
+  *          up; every event is also stored in a lock-free ring which is
+  *          drained by PROF_Export().
+  *
+  *          Each task gets a slot on its first appearance. The slot number is
+  *          stored as FreeRTOS task number (vTaskSetTaskNumber()), so finding
+  *          the slot of a task is O(1). The scheduler hooks run with the
+  *          kernel interrupt mask set and therefore never preempt each other.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "stm32h7xx.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "prof.h"
+
+#if PROF_ENABLE
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  uint32_t Count;
+  uint32_t StartTime;
+  uint64_t Cycles;
+} PROF_IrqTypeDef;
+
+/* Private define ------------------------------------------------------------*/
+#define PROF_EXPORT_CHUNK   32U
+
+/* Private variables ---------------------------------------------------------*/
+static PROF_TaskStatTypeDef PROF_aTask[PROF_MAX_TASKS];
+static uint32_t             PROF_aReadyTime[PROF_MAX_TASKS];
+static uint8_t              PROF_aReadyPending[PROF_MAX_TASKS];
+static unsigned             PROF_NumSlots = 1;      /* Slot 0 is "other" */
+static uint32_t             PROF_SwitchInTime;
+static PROF_IrqTypeDef      PROF_aIrq[PROF_MAX_IRQ_ID];
+static PROF_EventTypeDef    PROF_aEvent[PROF_NUM_EVENTS];
+static PROF_RingTypeDef     PROF_Ring;
+static uint8_t              PROF_IsInited;
+
+/* Private function prototypes -----------------------------------------------*/
+static unsigned PROF_GetSlot(void *pTCB);
+static uint32_t PROF_CyclesToUs(uint32_t Cycles);
+static void     PROF_Record(uint32_t Time, uint32_t Type, uint32_t Id, uint32_t Arg);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Returns the slot of a task, assigns one on its first appearance.
+  * @param  pTCB: Task control block.
+  * @retval Slot index.
+  */
+static unsigned PROF_GetSlot(void *pTCB)
+{
+  unsigned Slot;
+
+  Slot = (unsigned)uxTaskGetTaskNumber((TaskHandle_t)pTCB);
+  if ((Slot != 0U) && (Slot < PROF_MAX_TASKS))
+  {
+    return Slot;
+  }
+  if (PROF_NumSlots >= PROF_MAX_TASKS)
+  {
+    return 0;
+  }
+  Slot = PROF_NumSlots++;
+  strncpy(PROF_aTask[Slot].acName, pcTaskGetName((TaskHandle_t)pTCB), PROF_TASK_NAME_LEN - 1U);
+  vTaskSetTaskNumber((TaskHandle_t)pTCB, (UBaseType_t)Slot);
+  return Slot;
+}
+
+/**
+  * @brief  Converts CPU cycles to microseconds, saturated to 16 bits.
+  * @param  Cycles: Number of cycles.
+  * @retval Microseconds.
+  */
+static uint32_t PROF_CyclesToUs(uint32_t Cycles)
+{
+  uint32_t CyclesPerUs;
+  uint32_t Us;
+
+  CyclesPerUs = SystemCoreClock / 1000000U;
+  if (CyclesPerUs == 0U)
+  {
+    CyclesPerUs = 1U;
+  }
+  Us = Cycles / CyclesPerUs;
+  return (Us > 0xFFFFU) ? 0xFFFFU : Us;
+}
+
+/**
+  * @brief  Stores an event in the ring.
+  * @retval None
+  */
+static void PROF_Record(uint32_t Time, uint32_t Type, uint32_t Id, uint32_t Arg)
+{
+  if (PROF_IsInited != 0U)
+  {
+    (void)PROF_RING_Put(&PROF_Ring, Time, PROF_ENCODE(Type, Id, Arg));
+  }
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Starts the DWT cycle counter and sets up the event ring.
+  *         Called by portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() when the
+  *         scheduler starts; calling it again has no effect.
+  * @retval None
+  */
+void PROF_Init(void)
+{
+  if (PROF_IsInited != 0U)
+  {
+    return;
+  }
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->LAR = 0xC5ACCE55U;                           /* Unlock DWT on Cortex-M7 */
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  (void)PROF_RING_Init(&PROF_Ring, PROF_aEvent, PROF_NUM_EVENTS);
+  strncpy(PROF_aTask[0].acName, "(other)", PROF_TASK_NAME_LEN - 1U);
+  PROF_IsInited = 1;
+}
+
+/**
+  * @brief  Returns the time stamp used by the profiler (CPU cycles).
+  *         Also used as FreeRTOS run time counter.
+  * @retval Cycle counter.
+  */
+uint32_t PROF_GetTime(void)
+{
+  return DWT->CYCCNT;
+}
+
+/**
+  * @brief  traceTASK_SWITCHED_IN hook.
+  * @param  pTCB: Task that starts running.
+  * @retval None
+  */
+void PROF_TaskSwitchedIn(void *pTCB)
+{
+  PROF_TaskStatTypeDef *pStat;
+  uint32_t              Now;
+  uint32_t              Latency;
+  unsigned              Slot;
+  unsigned              Bucket;
+
+  Now   = DWT->CYCCNT;
+  Slot  = PROF_GetSlot(pTCB);
+  pStat = &PROF_aTask[Slot];
+  pStat->NumRuns++;
+  Latency = 0;
+  if (PROF_aReadyPending[Slot] != 0U)
+  {
+    PROF_aReadyPending[Slot] = 0;
+    Latency = PROF_CyclesToUs(Now - PROF_aReadyTime[Slot]);
+    Bucket  = (Latency == 0U) ? 0U : (31U - (unsigned)__builtin_clz(Latency));
+    if (Bucket >= PROF_NUM_LAT_BUCKETS)
+    {
+      Bucket = PROF_NUM_LAT_BUCKETS - 1U;
+    }
+    pStat->aLatency[Bucket]++;
+  }
+  PROF_SwitchInTime = Now;
+  PROF_Record(Now, PROF_EVT_TASK_IN, Slot, Latency);
+}
+
+/**
+  * @brief  traceTASK_SWITCHED_OUT hook. The first task is started without
+  *         traceTASK_SWITCHED_IN, its time is counted from PROF_Init().
+  * @param  pTCB: Task that stops running.
+  * @retval None
+  */
+void PROF_TaskSwitchedOut(void *pTCB)
+{
+  uint32_t Now;
+  unsigned Slot;
+
+  Now  = DWT->CYCCNT;
+  Slot = PROF_GetSlot(pTCB);
+  PROF_aTask[Slot].Cycles += (uint32_t)(Now - PROF_SwitchInTime);
+  PROF_Record(Now, PROF_EVT_TASK_OUT, Slot, 0);
+}
+
+/**
+  * @brief  traceMOVED_TASK_TO_READY_STATE hook. Starts the latency
+  *         measurement unless the task is already waiting to run.
+  * @param  pTCB: Task that became ready.
+  * @retval None
+  */
+void PROF_TaskReady(void *pTCB)
+{
+  uint32_t Now;
+  unsigned Slot;
+
+  Now  = DWT->CYCCNT;
+  Slot = PROF_GetSlot(pTCB);
+  if (PROF_aReadyPending[Slot] == 0U)
+  {
+    PROF_aReadyPending[Slot] = 1;
+    PROF_aReadyTime[Slot]    = Now;
+  }
+  PROF_Record(Now, PROF_EVT_TASK_READY, Slot, 0);
+}
+
+/**
+  * @brief  Called at the start of an instrumented interrupt handler.
+  * @param  IRQn: Interrupt number.
+  * @retval None
+  */
+void PROF_IrqEnter(int32_t IRQn)
+{
+  uint32_t Now;
+  uint32_t Id;
+
+  Now = DWT->CYCCNT;
+  Id  = (uint32_t)(IRQn + 16);
+  if (Id < PROF_MAX_IRQ_ID)
+  {
+    PROF_aIrq[Id].StartTime = Now;
+  }
+  PROF_Record(Now, PROF_EVT_IRQ_ENTER, Id, 0);
+}
+
+/**
+  * @brief  Called at the end of an instrumented interrupt handler.
+  *         Time spent in nested interrupts is included.
+  * @param  IRQn: Interrupt number.
+  * @retval None
+  */
+void PROF_IrqExit(int32_t IRQn)
+{
+  uint32_t Now;
+  uint32_t Id;
+  uint32_t Cycles;
+
+  Now    = DWT->CYCCNT;
+  Id     = (uint32_t)(IRQn + 16);
+  Cycles = 0;
+  if (Id < PROF_MAX_IRQ_ID)
+  {
+    Cycles = Now - PROF_aIrq[Id].StartTime;
+    PROF_aIrq[Id].Count++;
+    PROF_aIrq[Id].Cycles += Cycles;
+  }
+  PROF_Record(Now, PROF_EVT_IRQ_EXIT, Id, PROF_CyclesToUs(Cycles));
+}
+
+/**
+  * @brief  Records an application defined event.
+  * @param  Id: 12-bit identifier.
+  * @param  Arg: 16-bit argument.
+  * @retval None
+  */
+void PROF_UserEvent(uint32_t Id, uint32_t Arg)
+{
+  PROF_Record(DWT->CYCCNT, PROF_EVT_USER, Id, Arg);
+}
+
+/**
+  * @brief  Retrieves the statistics of a task slot.
+  * @param  Slot: Slot index, 0 is the collection of tasks without own slot.
+  * @param  pStat: [OUT] Statistics.
+  * @retval 0 on success, -1 if the slot is unused.
+  */
+int PROF_GetTaskStat(unsigned Slot, PROF_TaskStatTypeDef *pStat)
+{
+  if (Slot >= PROF_NumSlots)
+  {
+    return -1;
+  }
+  taskENTER_CRITICAL();
+  *pStat = PROF_aTask[Slot];
+  taskEXIT_CRITICAL();
+  return 0;
+}
+
+/**
+  * @brief  Writes statistics and all pending events in the format described
+  *         in prof.h. Must be called from a task; the events are removed.
+  * @param  pfWrite: Output function, e.g. writing to a UART or a file.
+  * @param  pContext: Passed to pfWrite.
+  * @retval None
+  */
+void PROF_Export(PROF_WriteFunc *pfWrite, void *pContext)
+{
+  PROF_TaskStatTypeDef Task;
+  PROF_IrqTypeDef      Irq;
+  PROF_EventTypeDef    aEvent[PROF_EXPORT_CHUNK];
+  uint32_t             aHeader[5];
+  uint32_t             NumIrqs;
+  uint32_t             NumEvents;
+  uint32_t             i;
+
+  NumIrqs = 0;
+  for (i = 0; i < PROF_MAX_IRQ_ID; i++)
+  {
+    if (PROF_aIrq[i].Count != 0U)
+    {
+      NumIrqs++;
+    }
+  }
+  aHeader[0] = PROF_MAGIC;
+  aHeader[1] = SystemCoreClock;
+  aHeader[2] = PROF_NumSlots;
+  aHeader[3] = NumIrqs;
+  aHeader[4] = PROF_Ring.NumDropped;
+  pfWrite(pContext, aHeader, sizeof(aHeader));
+  for (i = 0; i < aHeader[2]; i++)
+  {
+    taskENTER_CRITICAL();
+    Task = PROF_aTask[i];
+    taskEXIT_CRITICAL();
+    pfWrite(pContext, &i, sizeof(i));
+    pfWrite(pContext, Task.acName, sizeof(Task.acName));
+    pfWrite(pContext, &Task.Cycles, sizeof(Task.Cycles));
+    pfWrite(pContext, &Task.NumRuns, sizeof(Task.NumRuns));
+    pfWrite(pContext, Task.aLatency, sizeof(Task.aLatency));
+  }
+  for (i = 0; (i < PROF_MAX_IRQ_ID) && (NumIrqs != 0U); i++)
+  {
+    taskENTER_CRITICAL();
+    Irq = PROF_aIrq[i];
+    taskEXIT_CRITICAL();
+    if (Irq.Count != 0U)
+    {
+      pfWrite(pContext, &i, sizeof(i));
+      pfWrite(pContext, &Irq.Count, sizeof(Irq.Count));
+      pfWrite(pContext, &Irq.Cycles, sizeof(Irq.Cycles));
+      NumIrqs--;
+    }
+  }
+  do
+  {
+    NumEvents = PROF_RING_Get(&PROF_Ring, aEvent, PROF_EXPORT_CHUNK);
+    pfWrite(pContext, &NumEvents, sizeof(NumEvents));
+    if (NumEvents != 0U)
+    {
+      pfWrite(pContext, aEvent, NumEvents * sizeof(aEvent[0]));
+    }
+  } while (NumEvents != 0U);
+}
+
+/**
+  * @brief  Clears all statistics and the drop counter. Task slots and
+  *         pending events are kept.
+  * @retval None
+  */
+void PROF_Reset(void)
+{
+  unsigned i;
+
+  taskENTER_CRITICAL();
+  for (i = 0; i < PROF_MAX_TASKS; i++)
+  {
+    PROF_aTask[i].Cycles  = 0;
+    PROF_aTask[i].NumRuns = 0;
+    memset(PROF_aTask[i].aLatency, 0, sizeof(PROF_aTask[i].aLatency));
+    PROF_aReadyPending[i] = 0;
+  }
+  memset(PROF_aIrq, 0, sizeof(PROF_aIrq));
+  PROF_Ring.NumDropped = 0;
+  PROF_SwitchInTime = DWT->CYCCNT;
+  taskEXIT_CRITICAL();
+}
+
+#endif /* PROF_ENABLE */
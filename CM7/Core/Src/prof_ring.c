@@ -0,0 +1,113 @@
+/**
+  ******************************************************************************
+  * @file    prof_ring.c
+  * @brief   Lock-free event ring of the task profiler.
+  *
+  *          Producers reserve an index with a compare-and-swap on WrIdx (LDREX/
+  *          STREX on Cortex-M), which also checks for a full ring, so an
+  *          interrupt can record an event while it preempts another producer.
+  *          The event is completed by writing Seq last. The consumer only
+  *          reads events whose Seq matches, so an event that is reserved but
+  *          not yet written by a preempted producer stops the read there.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "prof_ring.h"
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Initializes an empty ring.
+  * @param  pRing: Ring.
+  * @param  pEvents: Event array.
+  * @param  NumEvents: Number of events, must be a power of 2.
+  * @retval 0 on success, -1 if NumEvents is not a power of 2.
+  */
+int PROF_RING_Init(PROF_RingTypeDef *pRing, PROF_EventTypeDef *pEvents, uint32_t NumEvents)
+{
+  uint32_t i;
+
+  if ((NumEvents == 0U) || ((NumEvents & (NumEvents - 1U)) != 0U))
+  {
+    return -1;
+  }
+  for (i = 0; i < NumEvents; i++)
+  {
+    pEvents[i].Seq = 0;
+  }
+  pRing->pEvents    = pEvents;
+  pRing->NumEvents  = NumEvents;
+  pRing->WrIdx      = 0;
+  pRing->RdIdx      = 0;
+  pRing->NumDropped = 0;
+  return 0;
+}
+
+/**
+  * @brief  Stores an event. May be called from any context.
+  * @param  pRing: Ring.
+  * @param  Time: Time stamp.
+  * @param  Data: Encoded event, see PROF_ENCODE().
+  * @retval 0 on success, -1 if the ring is full (the event is counted as dropped).
+  */
+int PROF_RING_Put(PROF_RingTypeDef *pRing, uint32_t Time, uint32_t Data)
+{
+  PROF_EventTypeDef *pEvent;
+  uint32_t           Idx;
+
+  Idx = __atomic_load_n(&pRing->WrIdx, __ATOMIC_RELAXED);
+  do
+  {
+    if ((Idx - __atomic_load_n(&pRing->RdIdx, __ATOMIC_ACQUIRE)) >= pRing->NumEvents)
+    {
+      __atomic_fetch_add(&pRing->NumDropped, 1U, __ATOMIC_RELAXED);
+      return -1;
+    }
+  } while (!__atomic_compare_exchange_n(&pRing->WrIdx, &Idx, Idx + 1U, 1, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+  pEvent       = &pRing->pEvents[Idx & (pRing->NumEvents - 1U)];
+  pEvent->Time = Time;
+  pEvent->Data = Data;
+  __atomic_store_n(&pEvent->Seq, Idx + 1U, __ATOMIC_RELEASE);
+  return 0;
+}
+
+/**
+  * @brief  Removes completed events in order. Single consumer only.
+  * @param  pRing: Ring.
+  * @param  pDest: Destination array.
+  * @param  MaxEvents: Capacity of pDest.
+  * @retval Number of events copied.
+  */
+uint32_t PROF_RING_Get(PROF_RingTypeDef *pRing, PROF_EventTypeDef *pDest, uint32_t MaxEvents)
+{
+  PROF_EventTypeDef *pEvent;
+  uint32_t           Idx;
+  uint32_t           n;
+
+  Idx = pRing->RdIdx;
+  for (n = 0; n < MaxEvents; n++)
+  {
+    pEvent = &pRing->pEvents[Idx & (pRing->NumEvents - 1U)];
+    if (__atomic_load_n(&pEvent->Seq, __ATOMIC_ACQUIRE) != Idx + 1U)
+    {
+      break;
+    }
+    pDest[n].Seq  = Idx;
+    pDest[n].Time = pEvent->Time;
+    pDest[n].Data = pEvent->Data;
+    Idx++;
+    __atomic_store_n(&pRing->RdIdx, Idx, __ATOMIC_RELEASE);
+  }
+  return n;
+}
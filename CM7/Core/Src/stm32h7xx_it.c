@@ -22,6 +22,9 @@
 #include "stm32h7xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "prof.h"
+#include "lp_idle.h"
+#include "ipc.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -166,11 +169,11 @@ void DebugMon_Handler(void)
 void TIM6_DAC_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM6_DAC_IRQn 0 */
-
+  PROF_IRQ_ENTER(TIM6_DAC_IRQn);
   /* USER CODE END TIM6_DAC_IRQn 0 */
   HAL_TIM_IRQHandler(&htim6);
   /* USER CODE BEGIN TIM6_DAC_IRQn 1 */
-
+  PROF_IRQ_EXIT(TIM6_DAC_IRQn);
   /* USER CODE END TIM6_DAC_IRQn 1 */
 }
 
@@ -180,14 +183,54 @@ void TIM6_DAC_IRQHandler(void)
 void OTG_FS_IRQHandler(void)
 {
   /* USER CODE BEGIN OTG_FS_IRQn 0 */
-
+  PROF_IRQ_ENTER(OTG_FS_IRQn);
   /* USER CODE END OTG_FS_IRQn 0 */
   HAL_HCD_IRQHandler(&hhcd_USB_OTG_FS);
   /* USER CODE BEGIN OTG_FS_IRQn 1 */
-
+  PROF_IRQ_EXIT(OTG_FS_IRQn);
   /* USER CODE END OTG_FS_IRQn 1 */
 }
 
+/**
+  * @brief This function handles HSEM1 global interrupt.
+  */
+void HSEM1_IRQHandler(void)
+{
+  /* USER CODE BEGIN HSEM1_IRQn 0 */
+  PROF_IRQ_ENTER(HSEM1_IRQn);
+  /* USER CODE END HSEM1_IRQn 0 */
+  HAL_HSEM_IRQHandler();
+  /* USER CODE BEGIN HSEM1_IRQn 1 */
+  PROF_IRQ_EXIT(HSEM1_IRQn);
+  /* USER CODE END HSEM1_IRQn 1 */
+}
+
+/**
+  * @brief This function handles LPTIM1 global interrupt.
+  */
+void LPTIM1_IRQHandler(void)
+{
+  /* USER CODE BEGIN LPTIM1_IRQn 0 */
+  PROF_IRQ_ENTER(LPTIM1_IRQn);
+  /* USER CODE END LPTIM1_IRQn 0 */
+  LP_IDLE_IRQHandler();
+  /* USER CODE BEGIN LPTIM1_IRQn 1 */
+  PROF_IRQ_EXIT(LPTIM1_IRQn);
+  /* USER CODE END LPTIM1_IRQn 1 */
+}
+
 /* USER CODE BEGIN 1 */
 
+/**
+  * @brief  HSEM free callback, called by HAL_HSEM_IRQHandler().
+  *         The semaphores are dispatched to the modules that registered
+  *         them with IPC_HSEM_RegisterCallback().
+  * @param  SemMask: Mask of the freed semaphores.
+  * @retval None
+  */
+void HAL_HSEM_FreeCallback(uint32_t SemMask)
+{
+  IPC_HSEM_FreeHandler(SemMask);
+}
+
 /* USER CODE END 1 */
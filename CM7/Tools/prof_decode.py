@@ -0,0 +1,303 @@
+#!/usr/bin/env python3
+"""Decoder of the task profiler export (CM7/Core/Src/prof.c).
+
+Reads the binary stream written by PROF_Export(), see prof.h for the
+format, and prints:
+  - per task: CPU share, number of runs and the wake-to-run latency
+    histogram with its median and 99th percentile
+  - per interrupt: count, total and average time
+  - a summary of the recorded events, optionally every event (--events)
+
+--check also verifies the export against itself and exits with 1 on
+any error: the event sequence numbers are contiguous, and if no event
+was dropped, the per-task cycles, run counts and latency histograms
+and the interrupt counts recomputed from the events match the
+statistics.
+
+Usage: prof_decode.py [--events] [--check] EXPORT_FILE
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = 0x31465250  # "PRF1"
+TASK_NAME_LEN = 16
+NUM_LAT_BUCKETS = 16
+
+EVT_TASK_IN = 1
+EVT_TASK_OUT = 2
+EVT_TASK_READY = 3
+EVT_IRQ_ENTER = 4
+EVT_IRQ_EXIT = 5
+EVT_USER = 8
+
+EVENT_NAMES = {
+    EVT_TASK_IN: "TASK_IN",
+    EVT_TASK_OUT: "TASK_OUT",
+    EVT_TASK_READY: "TASK_READY",
+    EVT_IRQ_ENTER: "IRQ_ENTER",
+    EVT_IRQ_EXIT: "IRQ_EXIT",
+    EVT_USER: "USER",
+}
+
+# Interrupts instrumented in CM7/Core/Src/stm32h7xx_it.c (IRQ number + 16).
+IRQ_NAMES = {
+    54 + 16: "TIM6_DAC",
+    101 + 16: "OTG_FS",
+    125 + 16: "HSEM1",
+}
+
+
+class ExportError(Exception):
+    pass
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.off = 0
+
+    def take(self, fmt):
+        size = struct.calcsize(fmt)
+        if self.off + size > len(self.data):
+            raise ExportError("export truncated at offset %u" % self.off)
+        values = struct.unpack_from(fmt, self.data, self.off)
+        self.off += size
+        return values
+
+
+def parse(data):
+    """Returns a dict with header, tasks, irqs and events of an export."""
+    rd = Reader(data)
+    magic, clock, num_tasks, num_irqs, num_dropped = rd.take("<5I")
+    if magic != MAGIC:
+        raise ExportError("bad magic 0x%08x" % magic)
+    if clock == 0:
+        raise ExportError("CPU clock is 0")
+    tasks = []
+    for _ in range(num_tasks):
+        slot, name, cycles, runs = rd.take("<I%dsQI" % TASK_NAME_LEN)
+        latency = list(rd.take("<%dI" % NUM_LAT_BUCKETS))
+        tasks.append({
+            "slot": slot,
+            "name": name.split(b"\0", 1)[0].decode("ascii", "replace"),
+            "cycles": cycles,
+            "runs": runs,
+            "latency": latency,
+        })
+    irqs = []
+    for _ in range(num_irqs):
+        irq_id, count, cycles = rd.take("<IIQ")
+        irqs.append({"id": irq_id, "count": count, "cycles": cycles})
+    events = []
+    while True:
+        (count,) = rd.take("<I")
+        if count == 0:
+            break
+        for _ in range(count):
+            seq, time, data_word = rd.take("<III")
+            events.append({
+                "seq": seq,
+                "time": time,
+                "type": (data_word >> 28) & 0xF,
+                "id": (data_word >> 16) & 0xFFF,
+                "arg": data_word & 0xFFFF,
+            })
+    if rd.off != len(data):
+        raise ExportError("%u bytes after the end of the export" % (len(data) - rd.off))
+    return {
+        "clock": clock,
+        "dropped": num_dropped,
+        "tasks": tasks,
+        "irqs": irqs,
+        "events": events,
+    }
+
+
+def bucket_range(bucket):
+    lo = 0 if bucket == 0 else 1 << bucket
+    hi = 1 << (bucket + 1)
+    return lo, hi
+
+
+def percentile(latency, fraction):
+    """Returns the upper bound in us of the bucket holding the percentile."""
+    total = sum(latency)
+    if total == 0:
+        return None
+    limit = fraction * total
+    acc = 0
+    for bucket, n in enumerate(latency):
+        acc += n
+        if acc >= limit:
+            return bucket_range(bucket)[1]
+    return bucket_range(len(latency) - 1)[1]
+
+
+def irq_name(irq_id):
+    return IRQ_NAMES.get(irq_id, "IRQ%d" % (irq_id - 16))
+
+
+def print_report(exp, show_events):
+    clock = exp["clock"]
+    cycles_per_us = max(clock // 1000000, 1)
+    total = sum(t["cycles"] for t in exp["tasks"])
+    print("CPU clock %u Hz, %u tasks, %u interrupts, %u events, %u dropped"
+          % (clock, len(exp["tasks"]), len(exp["irqs"]), len(exp["events"]), exp["dropped"]))
+    print()
+    print("Slot  Task              CPU %        Time ms      Runs   Lat. p50   Lat. p99")
+    for t in exp["tasks"]:
+        share = 100.0 * t["cycles"] / total if total else 0.0
+        p50 = percentile(t["latency"], 0.5)
+        p99 = percentile(t["latency"], 0.99)
+        print("%4u  %-16s %6.2f %14.3f %9u  %9s  %9s"
+              % (t["slot"], t["name"], share, t["cycles"] * 1000.0 / clock, t["runs"],
+                 "-" if p50 is None else "<%u us" % p50,
+                 "-" if p99 is None else "<%u us" % p99))
+    for t in exp["tasks"]:
+        if sum(t["latency"]) == 0:
+            continue
+        print()
+        print("Wake-to-run latency of %s:" % t["name"])
+        peak = max(t["latency"])
+        for bucket, n in enumerate(t["latency"]):
+            if n == 0:
+                continue
+            lo, hi = bucket_range(bucket)
+            print("  %6u..%-6u us %9u %s" % (lo, hi, n, "#" * max(1, 40 * n // peak)))
+    if exp["irqs"]:
+        print()
+        print("IRQ   Name         Count       Total us    Avg. us   CPU %")
+        for q in exp["irqs"]:
+            us = q["cycles"] / cycles_per_us
+            share = 100.0 * q["cycles"] / total if total else 0.0
+            print("%4d  %-10s %8u %14.1f %10.2f %7.3f"
+                  % (q["id"] - 16, irq_name(q["id"]), q["count"], us, us / q["count"], share))
+    if exp["events"]:
+        counts = {}
+        for e in exp["events"]:
+            counts[e["type"]] = counts.get(e["type"], 0) + 1
+        span = (exp["events"][-1]["time"] - exp["events"][0]["time"]) & 0xFFFFFFFF
+        print()
+        print("Events over %.3f ms: %s" % (span * 1000.0 / clock, ", ".join(
+            "%s %u" % (EVENT_NAMES.get(k, "TYPE%u" % k), v) for k, v in sorted(counts.items()))))
+    if show_events:
+        names = {t["slot"]: t["name"] for t in exp["tasks"]}
+        t0 = exp["events"][0]["time"] if exp["events"] else 0
+        for e in exp["events"]:
+            if e["type"] in (EVT_TASK_IN, EVT_TASK_OUT, EVT_TASK_READY):
+                who = names.get(e["id"], "slot %u" % e["id"])
+            elif e["type"] in (EVT_IRQ_ENTER, EVT_IRQ_EXIT):
+                who = irq_name(e["id"])
+            else:
+                who = "id %u" % e["id"]
+            print("%10u %12.3f us  %-10s %-16s %u"
+                  % (e["seq"], ((e["time"] - t0) & 0xFFFFFFFF) / cycles_per_us,
+                     EVENT_NAMES.get(e["type"], "TYPE%u" % e["type"]), who, e["arg"]))
+
+
+def check(exp):
+    """Returns a list of inconsistencies of the export."""
+    errors = []
+    events = exp["events"]
+    cycles_per_us = max(exp["clock"] // 1000000, 1)
+    for prev, cur in zip(events, events[1:]):
+        if (prev["seq"] + 1) & 0xFFFFFFFF != cur["seq"]:
+            errors.append("sequence gap after event %u" % prev["seq"])
+            break
+    slots = [t["slot"] for t in exp["tasks"]]
+    if slots != list(range(len(slots))):
+        errors.append("task slots are not 0..%u" % (len(slots) - 1))
+    if exp["dropped"] != 0:
+        return errors
+    # Replay the events. The task running when the statistics were reset
+    # has no TASK_IN, its first run is only known to be at least as long
+    # as seen here. The same holds for slot 0, which several tasks share.
+    num = len(exp["tasks"])
+    cycles = [0] * num
+    runs = [0] * num
+    latency = [[0] * NUM_LAT_BUCKETS for _ in range(num)]
+    ready = [False] * num
+    partial = [False] * num
+    irq_count = {}
+    cur = None
+    start = 0
+    for e in events:
+        slot = e["id"]
+        if e["type"] == EVT_TASK_IN:
+            if slot >= num:
+                errors.append("TASK_IN of unknown slot %u" % slot)
+                continue
+            runs[slot] += 1
+            if ready[slot]:
+                ready[slot] = False
+                latency[slot][min(e["arg"].bit_length() - 1 if e["arg"] else 0, NUM_LAT_BUCKETS - 1)] += 1
+            elif e["arg"] != 0:
+                errors.append("event %u: latency without TASK_READY" % e["seq"])
+            cur, start = slot, e["time"]
+        elif e["type"] == EVT_TASK_OUT:
+            if slot >= num:
+                errors.append("TASK_OUT of unknown slot %u" % slot)
+                continue
+            if cur is None:
+                partial[slot] = True
+            elif cur != slot:
+                errors.append("event %u: TASK_OUT of slot %u while slot %u runs" % (e["seq"], slot, cur))
+            else:
+                cycles[slot] += (e["time"] - start) & 0xFFFFFFFF
+            cur = None
+        elif e["type"] == EVT_TASK_READY:
+            if slot < num:
+                ready[slot] = True
+        elif e["type"] == EVT_IRQ_EXIT:
+            irq_count[slot] = irq_count.get(slot, 0) + 1
+    for t in exp["tasks"]:
+        s = t["slot"]
+        if s == 0 or partial[s]:
+            if cycles[s] > t["cycles"]:
+                errors.append("slot %u: %u cycles in events, %u in statistics" % (s, cycles[s], t["cycles"]))
+        elif cycles[s] != t["cycles"]:
+            errors.append("slot %u: %u cycles in events, %u in statistics" % (s, cycles[s], t["cycles"]))
+        if runs[s] != t["runs"]:
+            errors.append("slot %u: %u runs in events, %u in statistics" % (s, runs[s], t["runs"]))
+        if s != 0 and latency[s] != t["latency"]:
+            errors.append("slot %u: latency histogram differs from events" % s)
+    for q in exp["irqs"]:
+        if irq_count.get(q["id"], 0) != q["count"]:
+            errors.append("%s: %u exits in events, count %u"
+                          % (irq_name(q["id"]), irq_count.get(q["id"], 0), q["count"]))
+        # Each IRQ_EXIT carries the truncated duration in us.
+        us = sum(e["arg"] for e in events if e["type"] == EVT_IRQ_EXIT and e["id"] == q["id"])
+        exact = q["cycles"] / cycles_per_us
+        if not us <= exact < us + q["count"] + 1:
+            errors.append("%s: %u us in events, %.1f us in statistics" % (irq_name(q["id"]), us, exact))
+    return errors
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decodes the export of the CM7 task profiler.")
+    parser.add_argument("file", help="export written by PROF_Export()")
+    parser.add_argument("--events", action="store_true", help="print every event")
+    parser.add_argument("--check", action="store_true", help="verify the export, exit with 1 on errors")
+    args = parser.parse_args()
+    with open(args.file, "rb") as f:
+        data = f.read()
+    try:
+        exp = parse(data)
+    except ExportError as e:
+        print("%s: %s" % (args.file, e), file=sys.stderr)
+        return 1
+    print_report(exp, args.events)
+    if args.check:
+        errors = check(exp)
+        print()
+        for e in errors:
+            print("check failed: %s" % e)
+        print("check: %u events, %u errors" % (len(exp["events"]), len(errors)))
+        return 1 if errors else 0
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -32,7 +32,10 @@
 
 /* USER CODE BEGIN PV */
 /* Private variables ---------------------------------------------------------*/
-
+#if (USBH_USE_OS == 1)
+/* Released on every URB state change, indexed by host id (HOST_HS, HOST_FS) */
+static osSemaphoreId_t URBEvent[2];
+#endif
 /* USER CODE END PV */
 
 HCD_HandleTypeDef hhcd_USB_OTG_FS;
@@ -175,6 +178,8 @@ void HAL_HCD_HC_NotifyURBChange_Callback(HCD_HandleTypeDef *hhcd, uint8_t chnum,
   /* To be used with OS to sync URB state with the global state machine */
 #if (USBH_USE_OS == 1)
   USBH_LL_NotifyURBChange(hhcd->pData);
+  /* Wake a class driver waiting in USBH_LL_WaitURBEvent() */
+  (void)osSemaphoreRelease(URBEvent[((USBH_HandleTypeDef *)hhcd->pData)->id]);
 #endif
 }
 /**
@@ -227,6 +232,12 @@ USBH_StatusTypeDef USBH_LL_Init(USBH_HandleTypeDef *phost)
 
   USBH_LL_SetTimer(phost, HAL_HCD_GetCurrentFrame(&hhcd_USB_OTG_FS));
   }
+#if (USBH_USE_OS == 1)
+  if (URBEvent[phost->id] == NULL)
+  {
+    URBEvent[phost->id] = osSemaphoreNew(1U, 0U, NULL);
+  }
+#endif
   return USBH_OK;
 }
 
@@ -443,6 +454,23 @@ USBH_URBStateTypeDef USBH_LL_GetURBState(USBH_HandleTypeDef *phost, uint8_t pipe
   return (USBH_URBStateTypeDef)HAL_HCD_HC_GetURBState (phost->pData, pipe);
 }
 
+#if (USBH_USE_OS == 1)
+/**
+  * @brief  Wait for an URB state change.
+  * @param  phost: Host handle
+  * @param  timeout: Maximum time to wait in ms
+  * @retval USBH status: USBH_OK if an URB changed state, USBH_BUSY on timeout
+  */
+USBH_StatusTypeDef USBH_LL_WaitURBEvent(USBH_HandleTypeDef *phost, uint32_t timeout)
+{
+  if (osSemaphoreAcquire(URBEvent[phost->id], timeout) == osOK)
+  {
+    return USBH_OK;
+  }
+  return USBH_BUSY;
+}
+#endif
+
 /**
   * @brief  Drive VBUS.
   * @param  phost: Host handle
@@ -720,6 +720,8 @@ USBH_STATUS USBH_GetDescriptorEx                    (USBH_INTERFACE_HANDLE hInte
 USBH_STATUS USBH_GetStringDescriptor                (USBH_INTERFACE_HANDLE hInterface, U8 StringIndex, U16 LangID, U8 * pBuffer, unsigned * pNumBytes);
 USBH_STATUS USBH_GetStringDescriptorASCII           (USBH_INTERFACE_HANDLE hInterface, U8 StringIndex, char * pBuffer, unsigned BufferSize);
 USBH_STATUS USBH_GetSpeed                           (USBH_INTERFACE_HANDLE hInterface, USBH_SPEED * pSpeed);
+USBH_STATUS USBH_GetEnumTime                        (USBH_INTERFACE_HANDLE hInterface, U32 * pEnumTime, U8 * pFromCache);
+void        USBH_ClearEnumDescCache                 (void);
 USBH_STATUS USBH_GetFrameNumber                     (USBH_INTERFACE_HANDLE hInterface, U32 * pFrameNumber);
 USBH_STATUS USBH_GetInterfaceIdByHandle             (USBH_INTERFACE_HANDLE hInterface, USBH_INTERFACE_ID * pInterfaceId);
 unsigned    USBH_GetNumAlternateSettings            (USBH_INTERFACE_HANDLE hInterface);
@@ -730,6 +732,25 @@ const USBH_DEVICE_DESCRIPTOR * USBH_GetDeviceDescriptorPtr(USBH_INTERFACE_HANDLE
 U32         USBH_MEM_GetFree                        (int Idx);
 U32         USBH_MEM_GetUsed                        (int Idx);
 U32         USBH_MEM_GetMaxUsed                     (int Idx);
+
+/*********************************************************************
+*
+*       USBH_INST_POOL_STAT
+*
+*  Description
+*    Statistics of the per-instance buffer pools of the class drivers.
+*/
+typedef struct {
+  U32 NumPools;               // Number of pools currently reserved.
+  U32 NumBytesReserved;       // Number of bytes currently reserved by all pools.
+  U32 PeakUsed;               // Highest number of bytes ever used in a single pool.
+  U32 PeakUsedPercent;        // Highest usage of a single pool relative to its size in percent.
+  U32 NumFallbacks;           // Number of buffers that did not fit into the pool and were taken from the heap.
+  U32 NumFailed;              // Number of buffer allocations that failed.
+} USBH_INST_POOL_STAT;
+
+void        USBH_ConfigInstPool                     (U32 NumBytesExtra, int AllowFallback);
+void        USBH_GetInstPoolStat                    (USBH_INST_POOL_STAT * pStat);
 #ifdef __clang_analyzer__
   void      USBH_MEM_Panic                          (void) __attribute__((analyzer_noreturn));
 #else
@@ -1179,6 +1200,9 @@ typedef struct {
   U16          Length;                // [OUT] Length of the data packet received (IN EPs only).
   const void * pData;                 // [OUT] Pointer to the data packet received (IN EPs only).
   USBH_STATUS  Status;                // [OUT] Status of the transaction.
+  U16          FrameNumber;           // [OUT] (Micro)frame number in which the transaction was completed.
+  U16          NumMissedFrames;       // [OUT] Number of frames since the previous transaction in which no packet was transferred,
+                                      //       because the application did not provide or acknowledge buffers in time.
 } USBH_ISO_REQUEST;
 
 /*********************************************************************
@@ -1272,11 +1296,31 @@ void USBH_OS_SignalISREx     (U32 DevIndex);
 //
 // Locking
 //
-#define USBH_MUTEX_COUNT     4      // Total number of mutexes
+#define USBH_MUTEX_COUNT     10     // Total number of mutexes
 
 void USBH_OS_Lock            (unsigned Idx);
 void USBH_OS_Unlock          (unsigned Idx);
 
+/*********************************************************************
+*
+*       USBH_OS_LOCK_STAT
+*
+*  Description
+*    Contention statistics of one stack mutex.
+*    Only maintained by OS layers which support it.
+*    Wait times are given in CPU cycles, so that waits far below
+*    one OS tick are visible.
+*/
+typedef struct {
+  U32 NumLocks;        // Number of calls to USBH_OS_Lock().
+  U32 NumContended;    // Number of calls which found the mutex owned by another task.
+  U32 WaitCyclesMax;   // Longest time a task waited for the mutex in CPU cycles.
+  U64 WaitCyclesTotal; // Accumulated wait time in CPU cycles.
+} USBH_OS_LOCK_STAT;
+
+int  USBH_OS_GetLockStat     (unsigned Idx, USBH_OS_LOCK_STAT * pStat);
+void USBH_OS_ResetLockStat   (void);
+
 void USBH_X_DisableInterrupt (void); // Function necessary for CMSIS RTX/Keil RTX, should be implemented in the USBH_Config_*.c file.
                                      // Should disable the interrupt for the used USB controller.
 void USBH_X_EnableInterrupt  (void); // Function necessary for CMSIS RTX/Keil RTX, should be implemented in the USBH_Config_*.c file.
@@ -1352,6 +1396,29 @@ void USBH_Log                (const char * s);
 void USBH_Warn               (const char * s);
 void USBH_Logf               (U32 Type, const char * sFormat, ...);
 void USBH_Warnf              (U32 Type, const char * sFormat, ...);
+
+/*********************************************************************
+*
+*       USBH_LOG_BIN_STAT
+*
+*  Description
+*    Statistics of the binary log transport (USBH_LOG_BINARY == 1).
+*/
+typedef struct {
+  U32 NumRecords;             // Number of messages stored into the ring buffer.
+  U32 NumDroppedOverflow;     // Number of messages dropped because the ring buffer was full.
+  U32 NumDroppedRateLimit;    // Number of messages dropped by the per category rate limit (sum of all categories).
+  U32 NumCyclesTotal;         // Cycles spent in USBH_LogBin() for the stored messages, modulo 2^32. Divided by NumRecords: cycles per message.
+  U32 NumCyclesMax;           // Maximum cycles spent in USBH_LogBin() for one stored message.
+                              // Both 0 if USBH_LOG_BIN_GET_CYCLES() is not defined.
+} USBH_LOG_BIN_STAT;
+
+void     USBH_LogBin            (int Warn, unsigned ArgInfo, U32 Type, const char * sFormat, ...);
+unsigned USBH_LogBinProcess     (unsigned MaxRecords);
+unsigned USBH_LogBinRead        (U32 * pBuffer, unsigned NumWords);
+void     USBH_LogBinGetStat     (USBH_LOG_BIN_STAT * pStat);
+void     USBH_ConfigMsgRateLimit(unsigned Category, unsigned MaxMsgPerSec);
+
 void USBH_Puts               (const char * s);
 #ifdef __clang_analyzer__
   void USBH_Panic            (const char * sError) __attribute__((analyzer_noreturn));
@@ -121,6 +121,50 @@ Purpose : This file contains the default values for USB-Host
   #define USBH_LOG_BUFFER_SIZE     200
 #endif
 
+/*********************************************************************
+*
+*       USBH_LOG_BINARY
+*
+*  Description
+*    If set to 1, USBH_LOG() and USBH_WARN() of the stack do not format messages at the call site.
+*    Instead the format string pointer, the category and the raw 32-bit arguments are stored into
+*    a ring buffer of USBH_LOG_BIN_BUFFER_SIZE bytes. Messages are rendered later by calling
+*    USBH_LogBinProcess() from a low priority task, or exported with USBH_LogBinRead() to be
+*    rendered by a host tool.
+*    Requires a compiler supporting variadic macros. Arguments are stored as 32-bit values,
+*    %s and %p arguments therefore require a target with 32-bit pointers.
+*/
+#ifndef   USBH_LOG_BINARY
+  #define USBH_LOG_BINARY          0
+#endif
+
+/*********************************************************************
+*
+*       USBH_LOG_BIN_BUFFER_SIZE
+*
+*  Description
+*    Size of the binary log ring buffer in bytes. Must be a power of 2.
+*/
+#ifndef   USBH_LOG_BIN_BUFFER_SIZE
+  #define USBH_LOG_BIN_BUFFER_SIZE 4096
+#endif
+
+/*********************************************************************
+*
+*       USBH_LOG_BIN_GET_CYCLES
+*
+*  Description
+*    Returns a free running 32-bit cycle counter. If defined, USBH_LogBin() measures the
+*    cycles it takes to store a message, see USBH_LogBinGetStat().
+*    On Cortex-M3/M4/M7/M33 the DWT cycle counter is used. The application must enable it
+*    (DEMCR.TRCENA and DWT_CTRL.CYCCNTENA), otherwise the measured cycles are 0.
+*/
+#ifndef     USBH_LOG_BIN_GET_CYCLES
+  #if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__)
+    #define USBH_LOG_BIN_GET_CYCLES()  (*(volatile U32 *)0xE0001004u)     // DWT_CYCCNT
+  #endif
+#endif
+
 /*********************************************************************
 *
 *       Trace/SystemView related configuration defaults.
@@ -259,6 +303,21 @@ Purpose : This file contains the default values for USB-Host
   #define USBH_REO_FREE_MEM_LIST        0
 #endif
 
+/*********************************************************************
+*
+*       USBH_INST_POOL_ALIGNMENT
+*
+*  Description
+*    The class drivers BULK, CDC, FT232, HID and MSD reserve the transfer buffers
+*    of a device in one block when the device is started (see USBH_ConfigInstPool()).
+*    Each buffer inside this block is aligned to USBH_INST_POOL_ALIGNMENT bytes.
+*    Should be set to the data cache line size to avoid that the host controller
+*    driver needs to use an internal bounce buffer. Must be a power of 2.
+*/
+#ifndef   USBH_INST_POOL_ALIGNMENT
+  #define USBH_INST_POOL_ALIGNMENT      32u
+#endif
+
 /*********************************************************************
 *
 *       USBH_USE_APP_MEM_PANIC
@@ -362,6 +421,23 @@ Purpose : This file contains the default values for USB-Host
   #define USBH_DELAY_BETWEEN_ENUMERATIONS   0
 #endif
 
+/*********************************************************************
+*
+*       USBH_ENUM_DESC_CACHE_SIZE
+*
+*  Description
+*    Number of devices for which the configuration descriptors are cached.
+*    Devices are identified by their device descriptor (VID, PID, bcdDevice, ...)
+*    and serial number. When a known device is re-enumerated, the configuration
+*    descriptors are taken from the cache instead of being read from the device.
+*    Devices without serial number are not cached.
+*    If enabled (> 0), the language ID and serial number are read before the configuration
+*    descriptors during enumeration. 0 disables the cache.
+*/
+#ifndef USBH_ENUM_DESC_CACHE_SIZE
+  #define USBH_ENUM_DESC_CACHE_SIZE         0
+#endif
+
 /*********************************************************************
 *
 *       USBH_DEFAULT_SETUP_TIMEOUT
@@ -671,6 +747,31 @@ Purpose : This file contains the default values for USB-Host
   #define USBH_FT232_EP0_TIMEOUT           1000
 #endif
 
+/*********************************************************************
+*
+*       USBH_FT232_RX_NUM_PACKETS
+*
+*  Description
+*    Number of packets received by one IN transfer of the FT232
+*    receive engine. The engine uses two transfer buffers of this size.
+*/
+#ifndef   USBH_FT232_RX_NUM_PACKETS
+  #define USBH_FT232_RX_NUM_PACKETS        4u
+#endif
+
+/*********************************************************************
+*
+*       USBH_FT232_RX_BUFFER_SIZE
+*
+*  Description
+*    Size of the receive queue of a FT232 device in bytes. The size
+*    is increased at run-time if it can not hold the payload of two
+*    IN transfers.
+*/
+#ifndef   USBH_FT232_RX_BUFFER_SIZE
+  #define USBH_FT232_RX_BUFFER_SIZE        4096u
+#endif
+
 /*********************************************************************
 *
 *       USBH_CP210X_EP0_TIMEOUT
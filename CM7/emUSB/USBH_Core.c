@@ -70,6 +70,20 @@ Purpose     : USB host implementation
 #define VERSION2STRING_HELPER(x) #x  //lint !e9024 hash in macro N:999
 #define VERSION2STRING(x) VERSION2STRING_HELPER(x)
 
+//
+// Timing wheel used for the management of the software timers.
+// Each level consists of TIMER_WHEEL_NUM_SLOTS lists of active timers.
+// A slot of level 0 covers 1 ms, a slot of level 1 covers TIMER_WHEEL_NUM_SLOTS ms, etc.
+// With 3 levels timers expiring within 32768 ms are stored in the slot of their expiration time.
+// Timers expiring later are stored in the last slot of the highest level
+// and are sorted again when this slot is processed.
+//
+#define TIMER_WHEEL_SLOT_BITS       5u
+#define TIMER_WHEEL_NUM_SLOTS       (1uL << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_SLOT_MASK       (TIMER_WHEEL_NUM_SLOTS - 1u)
+#define TIMER_WHEEL_NUM_LEVELS      3u
+#define TIMER_WHEEL_INDEX_NONE      0xFFu   // Timer is not stored in the timing wheel.
+
 /*********************************************************************
 *
 *       Local data types
@@ -83,9 +97,11 @@ Purpose     : USB host implementation
 *
 **********************************************************************
 */
-static USBH_DLIST _TimerList;
+static USBH_DLIST _aTimerWheel[TIMER_WHEEL_NUM_LEVELS * TIMER_WHEEL_NUM_SLOTS];   // Lists of active timers.
+static U32        _aTimerWheelMask[TIMER_WHEEL_NUM_LEVELS];                       // One bit per slot. Set if the list of the slot is not empty.
+static U32        _TimerWheelTick;                                                // Index of the next tick (ms) to be processed.
+static USBH_TIME  _TimerWheelTime;                                                // Time of the next tick to be processed.
 static USBH_TIME  _NextTimeout;
-static I8         _TimerListModified;
 
 /*********************************************************************
 *
@@ -111,35 +127,306 @@ SEGGER_CACHE_CONFIG USBH_CacheConfig;
 
 /*********************************************************************
 *
-*       _UpdateTimeout
+*       _GetLowestBit
 *
 *  Function description
-*    Compute timeout of next expiring timer.
-*    System lock is active, so we can simply iterate over the timers in the list.
+*    Returns the index of the least significant bit set to 1.
+*    Value must not be 0.
 */
-static void _UpdateTimeout(void) {
+static unsigned _GetLowestBit(U32 Value) {
+  unsigned r;
+
+  r = 0;
+  if ((Value & 0xFFFFu) == 0u) {
+    r     += 16u;
+    Value >>= 16;
+  }
+  if ((Value & 0xFFu) == 0u) {
+    r     += 8u;
+    Value >>= 8;
+  }
+  if ((Value & 0xFu) == 0u) {
+    r     += 4u;
+    Value >>= 4;
+  }
+  if ((Value & 0x3u) == 0u) {
+    r     += 2u;
+    Value >>= 2;
+  }
+  if ((Value & 0x1u) == 0u) {
+    r     += 1u;
+  }
+  return r;
+}
+
+/*********************************************************************
+*
+*       _InsertTimer
+*
+*  Function description
+*    Adds an active timer to the slot of the timing wheel
+*    that corresponds to its expiration tick.
+*    Timer mutex must be locked.
+*/
+static void _InsertTimer(USBH_TIMER * pTimer) {
+  U32      Tick;
+  U32      TickExp;
+  U32      Diff;
+  unsigned Level;
+  unsigned Shift;
+  unsigned Slot;
+  unsigned Index;
+
+  Tick    = _TimerWheelTick;
+  TickExp = pTimer->ExpirationTick;
+  if ((I32)(TickExp - Tick) < 0) {
+    TickExp = Tick;                                 // Timer already expired. Process it with the next tick.
+  }
+  Slot  = 0;
+  Shift = 0;
+  for (Level = 0; Level < TIMER_WHEEL_NUM_LEVELS; Level++) {
+    Shift = Level * TIMER_WHEEL_SLOT_BITS;
+    Diff  = ((TickExp >> Shift) - (Tick >> Shift)) & (0xFFFFFFFFuL >> Shift);
+    if (Diff < TIMER_WHEEL_NUM_SLOTS) {
+      Slot = (unsigned)(TickExp >> Shift) & TIMER_WHEEL_SLOT_MASK;
+      break;
+    }
+  }
+  if (Level == TIMER_WHEEL_NUM_LEVELS) {
+    //
+    // Expiration time out of range. Store the timer in the slot that is processed last.
+    //
+    Level = TIMER_WHEEL_NUM_LEVELS - 1u;
+    Slot  = (unsigned)((Tick >> Shift) + TIMER_WHEEL_SLOT_MASK) & TIMER_WHEEL_SLOT_MASK;
+  }
+  Index = (Level << TIMER_WHEEL_SLOT_BITS) + Slot;
+  USBH_DLIST_InsertTail(&_aTimerWheel[Index], &pTimer->List);
+  _aTimerWheelMask[Level] |= 1uL << Slot;
+  pTimer->WheelIndex       = (U8)Index;
+}
+
+/*********************************************************************
+*
+*       _RemoveTimer
+*
+*  Function description
+*    Removes a timer from the timing wheel.
+*    Does nothing if the timer is not stored in the timing wheel.
+*    Timer mutex must be locked.
+*/
+static void _RemoveTimer(USBH_TIMER * pTimer) {
+  unsigned Index;
+
+  Index = pTimer->WheelIndex;
+  USBH_DLIST_RemoveEntry(&pTimer->List);
+  if (Index != TIMER_WHEEL_INDEX_NONE) {
+    if (USBH_DLIST_IsEmpty(&_aTimerWheel[Index]) != 0) {
+      _aTimerWheelMask[Index >> TIMER_WHEEL_SLOT_BITS] &= ~(1uL << (Index & TIMER_WHEEL_SLOT_MASK));
+    }
+    pTimer->WheelIndex = TIMER_WHEEL_INDEX_NONE;
+  }
+}
+
+/*********************************************************************
+*
+*       _TakeSlot
+*
+*  Function description
+*    Moves all the timers of a slot to the specified list.
+*    Timer mutex must be locked.
+*/
+static void _TakeSlot(unsigned Index, USBH_DLIST * pList) {
   USBH_DLIST * pEntry;
   USBH_TIMER * pTimer;
-  USBH_TIME    NextExpire;
-  //
-  // Compute next time out relative to current time.
-  // max. timeout for USBH_OS_WaitNetEvent() is 0x7FFFFF
-  //
-  NextExpire = USBH_TIME_CALC_EXPIRATION(0x7FFFFF);
-  pEntry = &_TimerList;
-  for(;;) {
+
+  USBH_DLIST_MoveList(&_aTimerWheel[Index], pList);
+  USBH_DLIST_Init(&_aTimerWheel[Index]);
+  _aTimerWheelMask[Index >> TIMER_WHEEL_SLOT_BITS] &= ~(1uL << (Index & TIMER_WHEEL_SLOT_MASK));
+  pEntry = pList;
+  for (;;) {
     pEntry = USBH_DLIST_GetNext(pEntry);
-    if (pEntry == &_TimerList) {
+    if (pEntry == pList) {
       break;
     }
     pTimer = GET_TIMER_FROM_ENTRY(pEntry);
-    if (pTimer->IsActive != 0) {
-      if (USBH_TimeDiff(pTimer->TimeOfExpiration, NextExpire) < 0) {
-        NextExpire = pTimer->TimeOfExpiration;
+    pTimer->WheelIndex = TIMER_WHEEL_INDEX_NONE;
+  }
+}
+
+/*********************************************************************
+*
+*       _CascadeSlot
+*
+*  Function description
+*    Distributes the timers stored in the current slot of a
+*    higher level to the slots of the lower levels.
+*    Timer mutex must be locked.
+*/
+static void _CascadeSlot(unsigned Level) {
+  USBH_DLIST   List;
+  USBH_DLIST * pEntry;
+  unsigned     Slot;
+
+  Slot = (unsigned)(_TimerWheelTick >> (Level * TIMER_WHEEL_SLOT_BITS)) & TIMER_WHEEL_SLOT_MASK;
+  _TakeSlot((Level << TIMER_WHEEL_SLOT_BITS) + Slot, &List);
+  while (USBH_DLIST_IsEmpty(&List) == 0) {
+    USBH_DLIST_RemoveHead(&List, &pEntry);
+    _InsertTimer(GET_TIMER_FROM_ENTRY(pEntry));
+  }
+}
+
+/*********************************************************************
+*
+*       _CalcTicksToNextEvent
+*
+*  Function description
+*    Computes the number of ticks until the next slot
+*    of the timing wheel has to be processed.
+*    Timer mutex must be locked.
+*
+*  Return value
+*    0 - No timer is active.
+*    1 - OK, *pNumTicks is valid.
+*/
+static int _CalcTicksToNextEvent(U32 * pNumTicks) {
+  U32      Tick;
+  U32      Mask;
+  U32      NumTicks;
+  U32      NumTicksMin;
+  U32      TickEvent;
+  unsigned Level;
+  unsigned Shift;
+  unsigned Pos;
+  unsigned Dist;
+  int      r;
+
+  r           = 0;
+  NumTicksMin = 0xFFFFFFFFuL;
+  Tick        = _TimerWheelTick;
+  for (Level = 0; Level < TIMER_WHEEL_NUM_LEVELS; Level++) {
+    Mask = _aTimerWheelMask[Level];
+    if (Mask != 0u) {
+      //
+      // Find the first non-empty slot starting from the current position.
+      //
+      Shift = Level * TIMER_WHEEL_SLOT_BITS;
+      Pos   = (unsigned)(Tick >> Shift) & TIMER_WHEEL_SLOT_MASK;
+      if (Pos != 0u) {
+        Mask = (Mask >> Pos) | (Mask << (TIMER_WHEEL_NUM_SLOTS - Pos));
+      }
+      Dist = _GetLowestBit(Mask);
+      if (Level == 0u) {
+        NumTicks = Dist;
+      } else {
+        if ((Dist == 0u) && ((Tick & ((1uL << Shift) - 1u)) != 0u)) {
+          //
+          // The current slot is due only if the wheel stopped at the beginning of its period
+          // without processing it, otherwise it is processed one revolution later.
+          //
+          Dist = TIMER_WHEEL_NUM_SLOTS;
+        }
+        TickEvent = ((Tick >> Shift) + Dist) << Shift;     // Slots of the higher levels are processed at the beginning of their period.
+        NumTicks  = TickEvent - Tick;
       }
+      if (NumTicks < NumTicksMin) {
+        NumTicksMin = NumTicks;
+      }
+      r = 1;
     }
   }
-  _NextTimeout = NextExpire;
+  *pNumTicks = NumTicksMin;
+  return r;
+}
+
+/*********************************************************************
+*
+*       _ProcessTimers
+*
+*  Function description
+*    Advances the timing wheel to the current time and calls the
+*    handlers of all expired timers. Timer mutex must be locked.
+*    It is temporarily unlocked while the handlers are called.
+*
+*  Additional information
+*    Ticks without any timer are skipped so that the processing
+*    time depends only on the number of expired timers and not on
+*    the time elapsed since the last call.
+*/
+static void _ProcessTimers(void) {
+  I32          Elapsed;
+  U32          NumTicks;
+  unsigned     Level;
+  unsigned     Shift;
+  USBH_DLIST   ExpiredList;
+  USBH_DLIST * pEntry;
+  USBH_TIMER * pTimer;
+
+  for (;;) {
+    Elapsed = USBH_TimeDiff(USBH_OS_GetTime32(), _TimerWheelTime);
+    if (Elapsed < 0) {
+      break;                                        // All ticks up to the current time have been processed.
+    }
+    if ((_CalcTicksToNextEvent(&NumTicks) == 0) || (NumTicks > (U32)Elapsed)) {
+      //
+      // No slot to be processed up to the current time. The tick of the current time
+      // is left open so that a timer started now with a timeout of 0 is not delayed.
+      //
+      NumTicks         = (U32)Elapsed;
+      _TimerWheelTick += NumTicks;
+      _TimerWheelTime  = USBH_TimeAdd(_TimerWheelTime, NumTicks);
+      break;
+    }
+    _TimerWheelTick += NumTicks;
+    _TimerWheelTime  = USBH_TimeAdd(_TimerWheelTime, NumTicks);
+    //
+    // At the beginning of the period of a higher level slot
+    // move its timers to the lower levels, highest level first.
+    //
+    for (Level = TIMER_WHEEL_NUM_LEVELS - 1u; Level > 0u; Level--) {
+      Shift = Level * TIMER_WHEEL_SLOT_BITS;
+      if ((_TimerWheelTick & ((1uL << Shift) - 1u)) == 0u) {
+        _CascadeSlot(Level);
+      }
+    }
+    //
+    // Take the expired timers. The wheel is advanced before the handlers
+    // are called so that a timer restarted by a handler is stored in the
+    // slot of a future tick.
+    //
+    _TakeSlot((unsigned)_TimerWheelTick & TIMER_WHEEL_SLOT_MASK, &ExpiredList);
+    _TimerWheelTick++;
+    _TimerWheelTime = USBH_TimeAdd(_TimerWheelTime, 1);
+    while (USBH_DLIST_IsEmpty(&ExpiredList) == 0) {
+      USBH_DLIST_RemoveHead(&ExpiredList, &pEntry);
+      pTimer = GET_TIMER_FROM_ENTRY(pEntry);
+      pTimer->IsActive = 0;
+      USBH_OS_Unlock(USBH_MUTEX_TIMER);
+      USBH_LOG((USBH_MCAT_TIMER_EX, "Execute timer %p", pTimer));
+      pTimer->pfHandler(pTimer->pContext);
+      USBH_OS_Lock(USBH_MUTEX_TIMER);
+    }
+  }
+}
+
+/*********************************************************************
+*
+*       _UpdateTimeout
+*
+*  Function description
+*    Compute timeout of next expiring timer.
+*    Timer mutex must be locked.
+*/
+static void _UpdateTimeout(void) {
+  U32 NumTicks;
+
+  if (_CalcTicksToNextEvent(&NumTicks) != 0) {
+    _NextTimeout = USBH_TimeAdd(_TimerWheelTime, NumTicks);
+  } else {
+    //
+    // max. timeout for USBH_OS_WaitNetEvent() is 0x7FFFFF
+    //
+    _NextTimeout = USBH_TIME_CALC_EXPIRATION(0x7FFFFF);
+  }
 }
 
 /*********************************************************************
@@ -162,14 +449,9 @@ void USBH_InitTimer(USBH_TIMER * pTimer, USBH_TIMER_FUNC * pfHandler, void * pCo
   pTimer->pfHandler = pfHandler;
   pTimer->pContext = pContext;
   pTimer->IsActive = 0;
+  pTimer->WheelIndex = TIMER_WHEEL_INDEX_NONE;
+  USBH_DLIST_Init(&pTimer->List);
   USBH_IFDBG(pTimer->Magic = USBH_TIMER_MAGIC);
-  //
-  // Add timer to linked list.
-  //
-  USBH_OS_Lock(USBH_MUTEX_TIMER);
-  USBH_DLIST_InsertEntry(&_TimerList, &pTimer->List);
-  _TimerListModified = 1;
-  USBH_OS_Unlock(USBH_MUTEX_TIMER);
 }
 
 /*********************************************************************
@@ -190,9 +472,8 @@ void USBH_ReleaseTimer(USBH_TIMER * pTimer) {
   //
   // Unlink
   //
-  USBH_DLIST_RemoveEntry(&pTimer->List);
+  _RemoveTimer(pTimer);
   USBH_IFDBG(pTimer->Magic = 0);
-  _TimerListModified = 1;
   USBH_OS_Unlock(USBH_MUTEX_TIMER);
 }
 
@@ -208,13 +489,26 @@ void USBH_ReleaseTimer(USBH_TIMER * pTimer) {
 *    ms     : Time-out in milliseconds.
 */
 void USBH_StartTimer(USBH_TIMER * pTimer, U32 ms) {
+  I32 Delay;
+
   USBH_LOG((USBH_MCAT_TIMER_EX, "Starting timer %p with timeout = %u ms", pTimer, ms));
   USBH_ASSERT((I32)ms >= 0);
   USBH_OS_Lock(USBH_MUTEX_TIMER);
   USBH_ASSERT_MAGIC(pTimer, USBH_TIMER);
+  _RemoveTimer(pTimer);
   pTimer->IsActive         = 1;
   pTimer->TimeOfExpiration = USBH_TIME_CALC_EXPIRATION(ms);
   //
+  // Convert the expiration time into a tick of the timing wheel.
+  // The timing wheel may lag behind the current time if the timer task is sleeping.
+  //
+  Delay = USBH_TimeDiff(pTimer->TimeOfExpiration, _TimerWheelTime);
+  if (Delay < 0) {
+    Delay = 0;
+  }
+  pTimer->ExpirationTick = _TimerWheelTick + (U32)Delay;
+  _InsertTimer(pTimer);
+  //
   // Check if this affects the expiration time of the next timer
   //
   if (USBH_Global.TimerTaskIsRunning != 0) {
@@ -238,7 +532,10 @@ void USBH_StartTimer(USBH_TIMER * pTimer, U32 ms) {
 */
 void USBH_CancelTimer(USBH_TIMER * pTimer) {
   USBH_ASSERT_MAGIC(pTimer, USBH_TIMER);
+  USBH_OS_Lock(USBH_MUTEX_TIMER);
   pTimer->IsActive = 0;
+  _RemoveTimer(pTimer);
+  USBH_OS_Unlock(USBH_MUTEX_TIMER);
 }
 
 /*********************************************************************
@@ -312,8 +609,9 @@ void USBH_FreeTimer(USBH_TIMER_HANDLE hTimer) {
 *    The functions only returns, if the USBH stack is shut down (if USBH_Exit() was called).
 *
 *  Additional information
-*    The function iterates over the list of active timers
-*    and invokes the registered callback functions in case the timer expired.
+*    The active timers are stored in a hierarchical timing wheel.
+*    The function processes the slots of the wheel up to the current time
+*    and invokes the registered callback functions of the expired timers.
 *
 *    When USBH_Exit() is used in the application this function should
 *    not be directly started as a task, as it returns when USBH_Exit()
@@ -321,8 +619,6 @@ void USBH_FreeTimer(USBH_TIMER_HANDLE hTimer) {
 *    see USBH_IsRunning() for a sample.
 */
 void USBH_Task(void) {
-  USBH_DLIST *pEntry;
-  USBH_TIMER *pTimer;
   I32         tDiff;
 
   USBH_LOG((USBH_MCAT_INIT, "USBH_Task started"));
@@ -336,31 +632,7 @@ void USBH_Task(void) {
     //
     USBH_OS_Lock(USBH_MUTEX_TIMER);
     if (USBH_TIME_IS_EXPIRED(_NextTimeout)) {
-      pEntry = &_TimerList;
-      for(;;) {
-        pEntry = USBH_DLIST_GetNext(pEntry);
-        if (pEntry == &_TimerList) {
-          break;
-        }
-        pTimer = GET_TIMER_FROM_ENTRY(pEntry);
-        if (pTimer->IsActive != 0) {
-          if (USBH_TIME_IS_EXPIRED(pTimer->TimeOfExpiration)) {
-            pTimer->IsActive = 0;
-            _TimerListModified = 0;
-            USBH_OS_Unlock(USBH_MUTEX_TIMER);
-            USBH_LOG((USBH_MCAT_TIMER_EX, "Execute timer %p", pTimer));
-            pTimer->pfHandler(pTimer->pContext);
-            USBH_OS_Lock(USBH_MUTEX_TIMER);
-            if (_TimerListModified != 0) {
-              //
-              // Linked list of timers was modified, the pEntry may not be valid any more.
-              // So restart and process the list from the beginning.
-              //
-              pEntry = &_TimerList;
-            }
-          }
-        }
-      }
+      _ProcessTimers();
       _UpdateTimeout();
     }
     USBH_OS_Unlock(USBH_MUTEX_TIMER);
@@ -466,8 +738,13 @@ void USBH_Init(void) {
   USBH_MEMSET(&USBH_Global, 0, sizeof(USBH_Global));
   USBH_Global.sCopyright = "SEGGER emUSBH V" VERSION2STRING(USBH_VERSION);
   _NextTimeout = (USBH_TIME)0;
-  USBH_DLIST_Init(&_TimerList);
+  for (i = 0; i < SEGGER_COUNTOF(_aTimerWheel); i++) {
+    USBH_DLIST_Init(&_aTimerWheel[i]);
+  }
+  USBH_MEMSET(_aTimerWheelMask, 0, sizeof(_aTimerWheelMask));
   USBH_OS_Init();
+  _TimerWheelTick = 0;
+  _TimerWheelTime = USBH_OS_GetTime32();
   USBH_LOG((USBH_MCAT_INIT, "emUSB-Host Init started. Version %u.%u.%u", USBH_VERSION / 10000, (USBH_VERSION / 100) % 100, USBH_VERSION % 100));
 #if USBH_DEBUG
   if (sizeof(USBH_Global.pExtHubApi) > sizeof(PTR_ADDR)) {
@@ -554,6 +831,7 @@ void USBH_Exit(void) {
   USBH_ASSERT(0 != USBH_DLIST_IsEmpty(&USBH_Global.NotificationList));
   USBH_ASSERT(0 != USBH_DLIST_IsEmpty(&USBH_Global.DelayedPnPNotificationList));
   USBH_UnregisterAllEnumErrorNotifications();
+  USBH_ClearEnumDescCache();
   USBH_ReleaseTimer(&USBH_Global.DelayedPnPNotifyTimer);
   //
   // Add a small delay before disabling the handling tasks.
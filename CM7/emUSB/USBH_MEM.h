@@ -131,6 +131,20 @@ typedef struct {
   USBH_MEM_FREE_BLCK * apFreeList[MAX_BLOCK_SIZE_INDEX + 1u];
 } USBH_MEM_POOL;
 
+//
+// Per-instance buffer pool of a class driver. Reserved once when the device is started,
+// buffers are carved from it without using the global allocator.
+// The pool is empty again as soon as all its buffers are given back, in any order.
+//
+typedef struct {
+  U8            * pBase;
+  U32             Size;
+  U32             Used;
+  U32             PeakUsed;
+  U32             LastOff;          // Offset of the most recent allocation, which can be given back.
+  U32             NumBuffers;       // Number of buffers currently allocated from the pool.
+} USBH_INST_POOL;
+
 /*********************************************************************
 *
 *       API functions / Function prototypes
@@ -161,6 +175,12 @@ void  * USBH_TryAllocTransferMemory         (U32    NumBytes, unsigned Alignment
 void    USBH_MEM_ReoFree                    (int    Idx);
 void    USBH_MEM_ScheduleReo                (void);
 
+int     USBH_INST_POOL_Create               (USBH_INST_POOL * pPool, U32 NumBytes);
+void  * USBH_INST_POOL_Alloc                (USBH_INST_POOL * pPool, U32 NumBytes);
+void    USBH_INST_POOL_Free                 (USBH_INST_POOL * pPool, void * p);
+void    USBH_INST_POOL_Destroy              (USBH_INST_POOL * pPool);
+#define USBH_INST_POOL_BLOCK_SIZE(NumBytes) (((U32)(NumBytes) + USBH_INST_POOL_ALIGNMENT - 1u) & ~(U32)(USBH_INST_POOL_ALIGNMENT - 1u))
+
 #if defined(__cplusplus)
 }                             // Make sure we have C-declarations in C++ programs.
 #endif
@@ -37,12 +37,26 @@
 #include "USBH.h"
 #include "USBH_Util.h"
 #include "USBH_MEM.h"
+#include "stm32h7xx.h"
 #include "FreeRTOS.h"
 #include "task.h"
 #include "semphr.h"
 #include "event_groups.h"
+#include "os_pool.h"
 #include "USBH_Int.h"
 
+/*********************************************************************
+ *
+ *       Defines, configurable
+ *
+ **********************************************************************
+ */
+// The mutexes and event groups come from the object pools of os_pool.c,
+// which are sized for the stack
+#if OS_POOL_USBH_NUM_MUTEXES != USBH_MUTEX_COUNT
+  #error "OS_POOL_USBH_NUM_MUTEXES must match USBH_MUTEX_COUNT"
+#endif
+
 /*********************************************************************
  *
  *       Type definitions
@@ -64,6 +78,7 @@ struct _USBH_OS_EVENT_OBJ
  **********************************************************************
  */
 static SemaphoreHandle_t _aMutex[USBH_MUTEX_COUNT];
+static USBH_OS_LOCK_STAT _aLockStat[USBH_MUTEX_COUNT];
 static EventGroupHandle_t _EventNet;
 static EventGroupHandle_t _EventISR;
 static volatile U32 _IsrMask;
@@ -112,15 +127,23 @@ void USBH_OS_Init(void)
 	unsigned i;
 
 	// Create event groups for network and ISR events
-	_EventNet = xEventGroupCreate();
-	_EventISR = xEventGroupCreate();
+	_EventNet = OS_POOL_EventGroupCreate();
+	_EventISR = OS_POOL_EventGroupCreate();
 	USBH_ASSERT(_EventNet != NULL);
 	USBH_ASSERT(_EventISR != NULL);
 
+	// Cycle counter for the lock statistics, also used by the profiler (prof.c)
+	if ((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) == 0u)
+	{
+		CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+		DWT->LAR = 0xC5ACCE55u;                         // Unlock DWT on Cortex-M7
+		DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	}
+
 	// Create recursive mutexes
 	for (i = 0; i < SEGGER_COUNTOF(_aMutex); i++)
 	{
-		_aMutex[i] = xSemaphoreCreateRecursiveMutex();
+		_aMutex[i] = OS_POOL_RecursiveMutexCreate();
 		USBH_ASSERT(_aMutex[i] != NULL);
 	}
 
@@ -133,18 +156,63 @@ void USBH_OS_Init(void)
  *
  *  Function description
  *    Locks a mutex object, guarding sections of the stack code.
- *    Mutexes are recursive.
+ *    Mutexes are recursive. FreeRTOS mutexes use priority inheritance,
+ *    so a high priority task blocked here boosts the owner.
+ *
+ *  Additional information
+ *    The mutex is first tried without blocking. Only if it is owned by
+ *    another task the contention is counted and the wait time measured
+ *    with the DWT cycle counter (enabled by USBH_OS_Init()).
+ *    The statistics are updated while the mutex is held.
+ *
+ *    In debug builds (USBH_DEBUG > 1) the mutex hierarchy documented in
+ *    USBH_Int.h is checked: A task which holds a mutex must not lock a
+ *    mutex with higher index. A violation is a deadlock waiting for the
+ *    right timing and stops the stack with USBH_PANIC().
  */
 void USBH_OS_Lock(unsigned Idx)
 {
+	USBH_OS_LOCK_STAT * pStat;
+	U32                 t0;
+	U32                 WaitCycles;
+#if USBH_DEBUG > 1
+	TaskHandle_t        pMe;
+	unsigned            i;
+#endif
+
 #if USBH_SUPPORT_WARN
   if (Idx >= USBH_MUTEX_COUNT) {
     USBH_PANIC("OS: bad mutex index");
   }
-  // FreeRTOS doesn't provide a direct way to check mutex hierarchy like embOS,
-  // so this check is omitted or could be implemented with custom logic.
 #endif
-	xSemaphoreTakeRecursive(_aMutex[Idx], portMAX_DELAY);
+#if USBH_DEBUG > 1
+	//
+	// Check mutex hierarchy.
+	//
+	pMe = xTaskGetCurrentTaskHandle();
+	for (i = 0; (i < Idx) && (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED); i++)
+	{
+		if (xSemaphoreGetMutexHolder(_aMutex[i]) == pMe)
+		{
+			USBH_WARN((USBH_MCAT_ASSERT, "OS: Mutex hierarchy violated: %u locked while holding %u", Idx, i));
+			USBH_PANIC("OS: Mutex hierarchy violated");
+		}
+	}
+#endif
+	pStat = &_aLockStat[Idx];
+	if (xSemaphoreTakeRecursive(_aMutex[Idx], 0) != pdTRUE)
+	{
+		t0 = DWT->CYCCNT;
+		xSemaphoreTakeRecursive(_aMutex[Idx], portMAX_DELAY);
+		WaitCycles = DWT->CYCCNT - t0;
+		pStat->NumContended++;
+		pStat->WaitCyclesTotal += WaitCycles;
+		if (WaitCycles > pStat->WaitCyclesMax)
+		{
+			pStat->WaitCyclesMax = WaitCycles;
+		}
+	}
+	pStat->NumLocks++;
 }
 
 /*********************************************************************
@@ -159,6 +227,49 @@ void USBH_OS_Unlock(unsigned Idx)
 	xSemaphoreGiveRecursive(_aMutex[Idx]);
 }
 
+/*********************************************************************
+ *
+ *       USBH_OS_GetLockStat
+ *
+ *  Function description
+ *    Retrieves contention statistics of a stack mutex.
+ *    Used to check whether the split of the stack mutexes is sufficient
+ *    for the tasks of the application.
+ *
+ *  Parameters
+ *    Idx:     Index of the mutex (0 .. USBH_MUTEX_COUNT-1), see USBH_MUTEX_* in USBH_Int.h.
+ *    pStat:   [OUT] Statistics.
+ *
+ *  Return value
+ *    == 0:    Success.
+ *    != 0:    Invalid index.
+ */
+int USBH_OS_GetLockStat(unsigned Idx, USBH_OS_LOCK_STAT * pStat)
+{
+	if (Idx >= USBH_MUTEX_COUNT)
+	{
+		return 1;
+	}
+	USBH_OS_DisableInterrupt();
+	*pStat = _aLockStat[Idx];
+	USBH_OS_EnableInterrupt();
+	return 0;
+}
+
+/*********************************************************************
+ *
+ *       USBH_OS_ResetLockStat
+ *
+ *  Function description
+ *    Clears the contention statistics of all stack mutexes.
+ */
+void USBH_OS_ResetLockStat(void)
+{
+	USBH_OS_DisableInterrupt();
+	USBH_MEMSET(_aLockStat, 0, sizeof(_aLockStat));
+	USBH_OS_EnableInterrupt();
+}
+
 /*********************************************************************
  *
  *       USBH_OS_GetTime32
@@ -256,7 +367,7 @@ USBH_OS_EVENT_OBJ* USBH_OS_AllocEvent(void)
 	if (p)
 	{
 		USBH_DLIST_Init(&p->ListEntry);
-		p->EventTask = xEventGroupCreate();
+		p->EventTask = OS_POOL_EventGroupCreate();
 		if (p->EventTask == NULL)
 		{
 			USBH_FREE(p);
@@ -277,7 +388,7 @@ USBH_OS_EVENT_OBJ* USBH_OS_AllocEvent(void)
 void USBH_OS_FreeEvent(USBH_OS_EVENT_OBJ *pEvent)
 {
 	USBH_DLIST_RemoveEntry(&pEvent->ListEntry);
-	vEventGroupDelete(pEvent->EventTask);
+	OS_POOL_EventGroupDelete(pEvent->EventTask);
 	USBH_FREE(pEvent);
 }
 
@@ -352,16 +463,16 @@ void USBH_OS_DeInit(void)
 	{
 		USBH_OS_EVENT_OBJ *pEvent;
 		pEvent = GET_EVENT_OBJ_FROM_ENTRY(pEntry);
-		vEventGroupDelete(pEvent->EventTask);
+		OS_POOL_EventGroupDelete(pEvent->EventTask);
 		pEntry = USBH_DLIST_GetNext(pEntry);
 		USBH_DLIST_RemoveEntry(&pEvent->ListEntry);
 		USBH_FREE(pEvent);
 	}
-	vEventGroupDelete(_EventNet);
-	vEventGroupDelete(_EventISR);
+	OS_POOL_EventGroupDelete(_EventNet);
+	OS_POOL_EventGroupDelete(_EventISR);
 	for (i = 0; i < SEGGER_COUNTOF(_aMutex); i++)
 	{
-		vSemaphoreDelete(_aMutex[i]);
+		OS_POOL_SemaphoreDelete(_aMutex[i]);
 	}
 }
 
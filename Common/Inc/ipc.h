@@ -0,0 +1,128 @@
+/**
+  ******************************************************************************
+  * @file    ipc.h
+  * @brief   Inter-core messaging between Cortex-M4 and Cortex-M7.
+  *          One ring per direction in SRAM4 (D3 domain, visible to both cores
+  *          at the same address). The doorbell of each direction is a
+  *          hardware semaphore whose release raises the HSEM interrupt on the
+  *          receiving core.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __IPC_H
+#define __IPC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "ipc_ring.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* HSEM_ID_0 is used by the boot handshake in main.c */
+#define IPC_HSEM_ID_CM4_TO_CM7   (1U)   /*!< Doorbell CM4 -> CM7 */
+#define IPC_HSEM_ID_CM7_TO_CM4   (2U)   /*!< Doorbell CM7 -> CM4 */
+
+#ifndef IPC_NUM_SLOTS
+#define IPC_NUM_SLOTS            64U    /*!< Descriptors per direction, power of 2 */
+#endif
+
+#ifndef IPC_IRQ_PRIORITY
+#define IPC_IRQ_PRIORITY         5U     /*!< Must not be above configMAX_SYSCALL_INTERRUPT_PRIORITY on CM7 */
+#endif
+
+#ifndef IPC_HSEM_MAX_CALLBACKS
+#define IPC_HSEM_MAX_CALLBACKS   4U     /*!< Entries of the HSEM free callback table */
+#endif
+
+#define IPC_SHARED_MAGIC         0x49504331U   /* "IPC1" */
+
+/* Ready flags, see IPC_SetReady() */
+#define IPC_READY_SDRAM          0x0001U  /*!< FMC SDRAM initialized by the CM4 */
+
+/* Message types */
+#define IPC_MSG_BUFFER_RELEASE   0x0001U  /*!< pData is handed back to the producer of the original message */
+#define IPC_MSG_ETH_RX           0x0010U  /*!< Received Ethernet frame                                      */
+#define IPC_MSG_CAN_RX           0x0020U  /*!< Received FDCAN frame(s)                                      */
+#define IPC_MSG_AUDIO_RX         0x0030U  /*!< Captured audio block                                         */
+#define IPC_MSG_MMC_DATA         0x0040U  /*!< eMMC data block                                              */
+#define IPC_MSG_USER             0x1000U  /*!< First application defined type                              */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Layout of the shared region. Both cores link this structure to
+  *         the start of the .ipc_shared section, so it has the same address
+  *         on both sides. It is initialized by the CM7 before the CM4 is
+  *         released from the boot handshake.
+  */
+typedef struct
+{
+  uint32_t        Magic;
+  uint32_t        ReadyFlags;   /*!< IPC_READY_xxx, set once by the owning core */
+  IPC_RingTypeDef RingCM4ToCM7;
+  IPC_RingTypeDef RingCM7ToCM4;
+  IPC_MsgTypeDef  aSlotsCM4ToCM7[IPC_NUM_SLOTS];
+  IPC_MsgTypeDef  aSlotsCM7ToCM4[IPC_NUM_SLOTS];
+} IPC_SharedTypeDef;
+
+/**
+  * @brief  Statistics of one direction, see IPC_GetStat().
+  */
+typedef struct
+{
+  uint32_t NumMsgs;       /*!< Messages published             */
+  uint32_t NumBytes;      /*!< Payload bytes published        */
+  uint32_t NumFull;       /*!< Reservations on a full ring    */
+  uint32_t NumDoorbells;  /*!< Doorbells raised               */
+  uint32_t NumPending;    /*!< Messages not yet consumed      */
+} IPC_StatTypeDef;
+
+/**
+  * @brief  Called in interrupt context when the other core rang the doorbell.
+  */
+typedef void (*IPC_RxCallbackTypeDef)(void);
+
+/**
+  * @brief  Called in interrupt context with the freed semaphores it was
+  *         registered for, see IPC_HSEM_RegisterCallback().
+  */
+typedef void (*IPC_HSEM_CallbackTypeDef)(uint32_t SemMask);
+
+/* Exported functions prototypes ---------------------------------------------*/
+void            IPC_Init(void);
+void            IPC_RegisterRxCallback(IPC_RxCallbackTypeDef pCallback);
+/* Sending to the other core (single producer per core) */
+IPC_MsgTypeDef *IPC_Alloc(void);
+void            IPC_Send(void);
+/* Receiving from the other core (single consumer per core) */
+IPC_MsgTypeDef *IPC_Peek(void);
+void            IPC_Release(void);
+int             IPC_PrepareWait(void);
+void            IPC_CancelWait(void);
+/* Start-up synchronization */
+void            IPC_SetReady(uint32_t Flags);
+int             IPC_WaitReady(uint32_t Flags, uint32_t Timeout);
+/* Diagnostics */
+void            IPC_GetStat(IPC_StatTypeDef *pTx, IPC_StatTypeDef *pRx);
+/* Dispatch of the HSEM free interrupt, HAL_HSEM_FreeCallback() of the
+   application calls IPC_HSEM_FreeHandler() */
+int             IPC_HSEM_RegisterCallback(uint32_t SemMask, IPC_HSEM_CallbackTypeDef pCallback);
+void            IPC_HSEM_FreeHandler(uint32_t SemMask);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IPC_H */
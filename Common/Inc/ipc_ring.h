@@ -0,0 +1,101 @@
+/**
+  ******************************************************************************
+  * @file    ipc_ring.h
+  * @brief   Lock-free single-producer/single-consumer descriptor ring.
+  *          The ring only uses plain loads/stores and compiler/CPU fences,
+  *          so it works between the two cores of the STM32H745 as well as
+  *          between two threads of a host program.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __IPC_RING_H
+#define __IPC_RING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+/* Cache line size of the Cortex-M7. Descriptors and the producer/consumer
+   indices are placed on separate lines of this size to avoid false sharing. */
+#ifndef IPC_RING_CACHE_LINE
+#define IPC_RING_CACHE_LINE   32U
+#endif
+
+/* Full memory barrier (DMB on Cortex-M). */
+#ifndef IPC_RING_MB
+#define IPC_RING_MB()         __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Message descriptor, exactly one cache line.
+  *         The payload is not copied: pData refers to a buffer in memory
+  *         both cores can access. The buffer belongs to the consumer until
+  *         it is handed back (see IPC_MSG_BUFFER_RELEASE in ipc.h).
+  */
+typedef struct
+{
+  uint16_t Type;        /*!< Message type, application defined             */
+  uint16_t Flags;       /*!< Message flags, application defined            */
+  uint32_t Len;         /*!< Number of valid bytes at pData                */
+  void     *pData;      /*!< Payload buffer, may be NULL                   */
+  uint32_t aParam[4];   /*!< Small inline parameters (e.g. CAN ID, slot)   */
+} __attribute__((aligned(IPC_RING_CACHE_LINE))) IPC_MsgTypeDef;
+
+/**
+  * @brief  Ring control block. Producer and consumer owned fields are on
+  *         separate cache lines; NumSlots and pSlots are read-only after
+  *         IPC_RING_Init().
+  */
+typedef struct
+{
+  /* Written by the producer only */
+  volatile uint32_t Head;          /*!< Published write index                    */
+  uint32_t HeadPending;            /*!< Reserved, not yet published write index  */
+  volatile uint32_t NumMsgs;       /*!< Statistics: messages published           */
+  volatile uint32_t NumBytes;      /*!< Statistics: payload bytes published      */
+  volatile uint32_t NumFull;       /*!< Statistics: reservations on a full ring  */
+  volatile uint32_t NumDoorbells;  /*!< Statistics: commits that need a doorbell */
+  uint8_t aPad0[IPC_RING_CACHE_LINE - 6U * sizeof(uint32_t)];
+  /* Written by the consumer only (WaitFlag is also cleared by the producer) */
+  volatile uint32_t Tail;          /*!< Read index                               */
+  volatile uint32_t WaitFlag;      /*!< Consumer sleeps and wants a doorbell     */
+  uint8_t aPad1[IPC_RING_CACHE_LINE - 2U * sizeof(uint32_t)];
+  /* Read-only after initialization */
+  uint32_t NumSlots;               /*!< Number of descriptors, power of 2        */
+  IPC_MsgTypeDef *pSlots;          /*!< Descriptor array                         */
+} __attribute__((aligned(IPC_RING_CACHE_LINE))) IPC_RingTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+int             IPC_RING_Init(IPC_RingTypeDef *pRing, IPC_MsgTypeDef *pSlots, uint32_t NumSlots);
+/* Producer side */
+IPC_MsgTypeDef *IPC_RING_Reserve(IPC_RingTypeDef *pRing);
+int             IPC_RING_Commit(IPC_RingTypeDef *pRing);
+/* Consumer side */
+IPC_MsgTypeDef *IPC_RING_Peek(IPC_RingTypeDef *pRing);
+void            IPC_RING_Release(IPC_RingTypeDef *pRing);
+int             IPC_RING_PrepareWait(IPC_RingTypeDef *pRing);
+void            IPC_RING_CancelWait(IPC_RingTypeDef *pRing);
+/* Either side */
+uint32_t        IPC_RING_GetCount(const IPC_RingTypeDef *pRing);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IPC_RING_H */
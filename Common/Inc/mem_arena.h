@@ -0,0 +1,110 @@
+/**
+  ******************************************************************************
+  * @file    mem_arena.h
+  * @brief   Region-aware arena allocator. Target independent: regions are
+  *          plain memory ranges registered at run time, so the allocator can
+  *          be built and exercised on a host.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MEM_ARENA_H
+#define __MEM_ARENA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#ifndef MEM_ARENA_MAX_REGIONS
+#define MEM_ARENA_MAX_REGIONS       4U
+#endif
+#ifndef MEM_ARENA_MIN_CLASS_SHIFT
+#define MEM_ARENA_MIN_CLASS_SHIFT   5U      /* Smallest size class: 32 bytes */
+#endif
+#ifndef MEM_ARENA_NUM_CLASSES
+#define MEM_ARENA_NUM_CLASSES       12U     /* Largest size class: 64 KB */
+#endif
+
+/* Region attributes */
+#define MEM_ARENA_ATTR_CACHEABLE    0x01U   /*!< Accessed through the data cache                          */
+#define MEM_ARENA_ATTR_DMA          0x02U   /*!< Reachable by the DMA masters without cache maintenance    */
+#define MEM_ARENA_ATTR_FAST         0x04U   /*!< On-chip SRAM                                             */
+#define MEM_ARENA_ATTR_EXTERNAL     0x08U   /*!< External memory (SDRAM): large, higher latency            */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Counters of one region.
+  */
+typedef struct
+{
+  uint32_t Size;        /*!< Bytes in the region                                  */
+  uint32_t Used;        /*!< Bytes taken from the region, including padding       */
+  uint32_t PadBytes;    /*!< Bytes lost to alignment                              */
+  uint32_t NumAllocs;   /*!< Successful allocations of both kinds                 */
+  uint32_t NumFailed;   /*!< Requests for this region that did not fit            */
+  uint32_t BlockBytes;  /*!< Bytes of size class blocks handed out                */
+  uint32_t FreeBytes;   /*!< Bytes of size class blocks waiting on the free lists */
+} MEM_ARENA_StatTypeDef;
+
+/**
+  * @brief  One region: a bump allocator over [pBase, pBase + Size) and one
+  *         free list per size class. Size class blocks are carved from the
+  *         bump allocator and never given back to it.
+  */
+typedef struct
+{
+  const char            *sName;
+  uint8_t               *pBase;
+  uint32_t               Attr;        /*!< MEM_ARENA_ATTR_xxx                        */
+  uint32_t               Align;       /*!< Minimum alignment and size granule        */
+  void                  *apFree[MEM_ARENA_NUM_CLASSES];
+  MEM_ARENA_StatTypeDef  Stat;
+} MEM_RegionTypeDef;
+
+/**
+  * @brief  Set of regions. Not locked: the caller serializes access.
+  */
+typedef struct
+{
+  MEM_RegionTypeDef aRegion[MEM_ARENA_MAX_REGIONS];
+  uint32_t          NumRegions;
+  uint32_t          NumFailed;       /*!< Requests no region could serve */
+} MEM_ArenaTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void      MEM_ARENA_Init(MEM_ArenaTypeDef *pArena);
+int       MEM_ARENA_AddRegion(MEM_ArenaTypeDef *pArena, const char *sName, void *pMem, uint32_t NumBytes,
+                              uint32_t Attr, uint32_t Align);
+int       MEM_ARENA_FindRegion(const MEM_ArenaTypeDef *pArena, const char *sName);
+
+void     *MEM_ARENA_Alloc(MEM_ArenaTypeDef *pArena, uint32_t NumBytes, uint32_t Align,
+                          uint32_t Require, uint32_t Prefer);
+void     *MEM_ARENA_AllocFrom(MEM_ArenaTypeDef *pArena, int Region, uint32_t NumBytes, uint32_t Align);
+
+void     *MEM_ARENA_AllocBlock(MEM_ArenaTypeDef *pArena, uint32_t NumBytes, uint32_t Require, uint32_t Prefer);
+void     *MEM_ARENA_AllocBlockFrom(MEM_ArenaTypeDef *pArena, int Region, uint32_t NumBytes);
+int       MEM_ARENA_FreeBlock(MEM_ArenaTypeDef *pArena, void *p, uint32_t NumBytes);
+
+int       MEM_ARENA_GetRegion(const MEM_ArenaTypeDef *pArena, const void *p);
+uint32_t  MEM_ARENA_GetAttr(const MEM_ArenaTypeDef *pArena, const void *p);
+void      MEM_ARENA_GetStat(const MEM_ArenaTypeDef *pArena, int Region, MEM_ARENA_StatTypeDef *pStat);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MEM_ARENA_H */
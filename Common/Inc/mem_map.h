@@ -0,0 +1,93 @@
+/**
+  ******************************************************************************
+  * @file    mem_map.h
+  * @brief   Memory regions of both cores on top of mem_arena.c: on-chip
+  *          SRAM and the FMC SDRAM, which the Cortex-M4 initializes and both
+  *          cores share in fixed slices.
+  *
+  *          SDRAM layout (FMC bank 2):
+  *            MEM_MAP_SDRAM_BASE                  Cortex-M4 slice
+  *            + MEM_MAP_SDRAM_CM4_SIZE            Cortex-M7 non-cacheable slice (DMA)
+  *            + MEM_MAP_SDRAM_DMA_SIZE            Cortex-M7 cacheable slice, rest of the device
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MEM_MAP_H
+#define __MEM_MAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "mem_arena.h"
+
+/* Exported constants --------------------------------------------------------*/
+#ifndef MEM_MAP_SDRAM_BASE
+#define MEM_MAP_SDRAM_BASE          0xD0000000U   /* FMC SDRAM bank 2 */
+#endif
+#ifndef MEM_MAP_SDRAM_SIZE
+#define MEM_MAP_SDRAM_SIZE          0x00800000U   /* 4 banks x 4096 rows x 256 columns x 16 bit, power of 2 */
+#endif
+#ifndef MEM_MAP_SDRAM_CM4_SIZE
+#define MEM_MAP_SDRAM_CM4_SIZE      0x00200000U   /* Power of 2 */
+#endif
+#ifndef MEM_MAP_SDRAM_DMA_SIZE
+#define MEM_MAP_SDRAM_DMA_SIZE      0x00200000U   /* Power of 2, not above MEM_MAP_SDRAM_CM4_SIZE (MPU alignment) */
+#endif
+#ifndef MEM_MAP_SRAM_SIZE
+#if defined(CORE_CM7)
+#define MEM_MAP_SRAM_SIZE           0x8000U       /* Arena in the AXI SRAM */
+#else
+#define MEM_MAP_SRAM_SIZE           0x4000U       /* Arena in the Cortex-M4 SRAM (.bss) */
+#endif
+#endif
+#ifndef MEM_MAP_SDRAM_TIMEOUT_MS
+#define MEM_MAP_SDRAM_TIMEOUT_MS    500U          /* Cortex-M7 wait for the Cortex-M4 to bring up the SDRAM */
+#endif
+#ifndef MEM_MAP_USE_EMFILE
+#define MEM_MAP_USE_EMFILE          0             /* Set to 1 when emFile is linked in */
+#endif
+#ifndef MEM_MAP_USE_EMUSB
+#define MEM_MAP_USE_EMUSB           0             /* Set to 1 when emUSB-Host is linked in */
+#endif
+
+/* Region names */
+#define MEM_MAP_REGION_SRAM         "sram"
+#define MEM_MAP_REGION_SDRAM        "sdram"       /* Cacheable on the Cortex-M7 */
+#define MEM_MAP_REGION_SDRAM_DMA    "sdram_dma"   /* Cortex-M7 only */
+
+/* Exported functions prototypes ---------------------------------------------*/
+int       MEM_MAP_Init(void);
+void     *MEM_MAP_Alloc(uint32_t NumBytes, uint32_t Align, uint32_t Require, uint32_t Prefer);
+void     *MEM_MAP_AllocFrom(const char *sRegion, uint32_t NumBytes, uint32_t Align);
+void     *MEM_MAP_AllocBlock(uint32_t NumBytes, uint32_t Require, uint32_t Prefer);
+void      MEM_MAP_FreeBlock(void *p, uint32_t NumBytes);
+uint32_t  MEM_MAP_GetAttr(const void *p);
+int       MEM_MAP_GetStat(const char *sRegion, MEM_ARENA_StatTypeDef *pStat);
+
+#if MEM_MAP_USE_EMFILE
+int       MEM_MAP_AssignFsMemory(uint32_t NumBytes);
+int       MEM_MAP_AssignFsCache(const char *sVolumeName, uint32_t NumBytes);
+#endif /* MEM_MAP_USE_EMFILE */
+#if MEM_MAP_USE_EMUSB
+int       MEM_MAP_AssignUsbhMemory(uint32_t NumBytes, uint32_t NumTransferBytes);
+#endif /* MEM_MAP_USE_EMUSB */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MEM_MAP_H */
@@ -0,0 +1,353 @@
+/**
+  ******************************************************************************
+  * @file    ipc.c
+  * @brief   Inter-core messaging between Cortex-M4 and Cortex-M7.
+  *
+  *          Each core produces into one ring and consumes from the other.
+  *          The rings are lock-free (see ipc_ring.c); the hardware semaphores
+  *          are only used as doorbells. A doorbell is raised by taking and
+  *          releasing the semaphore of the direction, which raises HSEM1_IRQn
+  *          on the Cortex-M7 or HSEM2_IRQn on the Cortex-M4. Doorbells are only
+  *          raised when the receiving side announced that it waits, so a burst
+  *          of messages costs at most one interrupt.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "ipc.h"
+
+/* Private define ------------------------------------------------------------*/
+#if defined(CORE_CM7)
+  #define IPC_TX_RING        (&IPC_Shared.RingCM7ToCM4)
+  #define IPC_RX_RING        (&IPC_Shared.RingCM4ToCM7)
+  #define IPC_TX_HSEM_ID     IPC_HSEM_ID_CM7_TO_CM4
+  #define IPC_RX_HSEM_ID     IPC_HSEM_ID_CM4_TO_CM7
+  #define IPC_IRQn           HSEM1_IRQn
+#else
+  #define IPC_TX_RING        (&IPC_Shared.RingCM4ToCM7)
+  #define IPC_RX_RING        (&IPC_Shared.RingCM7ToCM4)
+  #define IPC_TX_HSEM_ID     IPC_HSEM_ID_CM4_TO_CM7
+  #define IPC_RX_HSEM_ID     IPC_HSEM_ID_CM7_TO_CM4
+  #define IPC_IRQn           HSEM2_IRQn
+#endif
+
+#ifndef IPC_MPU_REGION
+#define IPC_MPU_REGION       MPU_REGION_NUMBER1
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  volatile uint32_t                 SemMask;
+  volatile IPC_HSEM_CallbackTypeDef pCallback;
+} IPC_HSEM_EntryTypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+/* Placed at the start of SRAM4 by the linker scripts of both cores (NOLOAD,
+   so the startup code of neither core clears it). */
+IPC_SharedTypeDef IPC_Shared __attribute__((section(".ipc_shared")));
+
+static IPC_HSEM_EntryTypeDef          IPC_aHsemCallbacks[IPC_HSEM_MAX_CALLBACKS];
+static volatile IPC_RxCallbackTypeDef IPC_pRxCallback;
+
+/* Private function prototypes -----------------------------------------------*/
+static void IPC_RingDoorbell(void);
+static void IPC_FillStat(const IPC_RingTypeDef *pRing, IPC_StatTypeDef *pStat);
+static void IPC_DoorbellCallback(uint32_t SemMask);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Raises the doorbell interrupt on the other core.
+  * @retval None
+  */
+static void IPC_RingDoorbell(void)
+{
+  if (HAL_HSEM_FastTake(IPC_TX_HSEM_ID) == HAL_OK)
+  {
+    HAL_HSEM_Release(IPC_TX_HSEM_ID, 0);
+  }
+}
+
+/**
+  * @brief  Copies the statistics of a ring.
+  * @param  pRing: Ring control block.
+  * @param  pStat: Destination.
+  * @retval None
+  */
+static void IPC_FillStat(const IPC_RingTypeDef *pRing, IPC_StatTypeDef *pStat)
+{
+  pStat->NumMsgs      = pRing->NumMsgs;
+  pStat->NumBytes     = pRing->NumBytes;
+  pStat->NumFull      = pRing->NumFull;
+  pStat->NumDoorbells = pRing->NumDoorbells;
+  pStat->NumPending   = IPC_RING_GetCount(pRing);
+}
+
+/**
+  * @brief  HSEM free callback of the receive doorbell.
+  *         The HAL disables the notification of a freed semaphore, so it is
+  *         re-activated for the next doorbell.
+  * @param  SemMask: Mask of the freed doorbell semaphore.
+  * @retval None
+  */
+static void IPC_DoorbellCallback(uint32_t SemMask)
+{
+  IPC_RxCallbackTypeDef pCallback;
+
+  HAL_HSEM_ActivateNotification(SemMask);
+  pCallback = IPC_pRxCallback;
+  if (pCallback != NULL)
+  {
+    pCallback();
+  }
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Initializes the inter-core messaging of the calling core.
+  *         The Cortex-M7 sets up the shared region and must call this before
+  *         it releases the Cortex-M4 (Boot_Mode_Sequence_2). The Cortex-M4
+  *         calls it after it has been released.
+  * @retval None
+  */
+void IPC_Init(void)
+{
+#if defined(CORE_CM7)
+  MPU_Region_InitTypeDef MPU_InitStruct = {0};
+
+  /* The rings are shared with a core without cache: map SRAM4 shareable and
+     non-cacheable, so no cache maintenance is necessary on the Cortex-M7. */
+  HAL_MPU_Disable();
+  MPU_InitStruct.Enable = MPU_REGION_ENABLE;
+  MPU_InitStruct.Number = IPC_MPU_REGION;
+  MPU_InitStruct.BaseAddress = D3_SRAM_BASE;
+  MPU_InitStruct.Size = MPU_REGION_SIZE_64KB;
+  MPU_InitStruct.SubRegionDisable = 0x0;
+  MPU_InitStruct.TypeExtField = MPU_TEX_LEVEL1;
+  MPU_InitStruct.AccessPermission = MPU_REGION_FULL_ACCESS;
+  MPU_InitStruct.DisableExec = MPU_INSTRUCTION_ACCESS_DISABLE;
+  MPU_InitStruct.IsShareable = MPU_ACCESS_SHAREABLE;
+  MPU_InitStruct.IsCacheable = MPU_ACCESS_NOT_CACHEABLE;
+  MPU_InitStruct.IsBufferable = MPU_ACCESS_NOT_BUFFERABLE;
+  HAL_MPU_ConfigRegion(&MPU_InitStruct);
+  HAL_MPU_Enable(MPU_PRIVILEGED_DEFAULT);
+
+  IPC_Shared.Magic = 0;
+  IPC_Shared.ReadyFlags = 0;
+  (void)IPC_RING_Init(&IPC_Shared.RingCM4ToCM7, IPC_Shared.aSlotsCM4ToCM7, IPC_NUM_SLOTS);
+  (void)IPC_RING_Init(&IPC_Shared.RingCM7ToCM4, IPC_Shared.aSlotsCM7ToCM4, IPC_NUM_SLOTS);
+  IPC_RING_MB();
+  IPC_Shared.Magic = IPC_SHARED_MAGIC;
+  IPC_RING_MB();
+#else
+  while (IPC_Shared.Magic != IPC_SHARED_MAGIC)
+  {
+  }
+  IPC_RING_MB();
+#endif
+  __HAL_RCC_HSEM_CLK_ENABLE();
+  (void)IPC_HSEM_RegisterCallback(__HAL_HSEM_SEMID_TO_MASK(IPC_RX_HSEM_ID), IPC_DoorbellCallback);
+  HAL_HSEM_ActivateNotification(__HAL_HSEM_SEMID_TO_MASK(IPC_RX_HSEM_ID));
+  HAL_NVIC_SetPriority(IPC_IRQn, IPC_IRQ_PRIORITY, 0);
+  HAL_NVIC_EnableIRQ(IPC_IRQn);
+}
+
+/**
+  * @brief  Reserves a descriptor for a message to the other core.
+  *         Several descriptors may be reserved and are sent together by
+  *         IPC_Send().
+  * @retval Pointer to the descriptor, NULL if the ring is full.
+  */
+IPC_MsgTypeDef *IPC_Alloc(void)
+{
+  return IPC_RING_Reserve(IPC_TX_RING);
+}
+
+/**
+  * @brief  Publishes all descriptors reserved by IPC_Alloc() and raises the
+  *         doorbell if the other core waits for messages.
+  * @retval None
+  */
+void IPC_Send(void)
+{
+  if (IPC_RING_Commit(IPC_TX_RING) != 0)
+  {
+    IPC_RingDoorbell();
+  }
+}
+
+/**
+  * @brief  Returns the oldest message from the other core.
+  * @retval Pointer to the descriptor, NULL if there is none.
+  */
+IPC_MsgTypeDef *IPC_Peek(void)
+{
+  return IPC_RING_Peek(IPC_RX_RING);
+}
+
+/**
+  * @brief  Removes the message returned by IPC_Peek().
+  * @retval None
+  */
+void IPC_Release(void)
+{
+  IPC_RING_Release(IPC_RX_RING);
+}
+
+/**
+  * @brief  Requests a doorbell for the next message from the other core.
+  * @retval 1 if the caller may wait for the callback registered
+  *         with IPC_RegisterRxCallback(), 0 if messages are
+  *         already available.
+  */
+int IPC_PrepareWait(void)
+{
+  return IPC_RING_PrepareWait(IPC_RX_RING);
+}
+
+/**
+  * @brief  Withdraws a request made by IPC_PrepareWait().
+  * @retval None
+  */
+void IPC_CancelWait(void)
+{
+  IPC_RING_CancelWait(IPC_RX_RING);
+}
+
+/**
+  * @brief  Tells the other core that a shared resource is ready.
+  * @param  Flags: IPC_READY_xxx.
+  * @retval None
+  */
+void IPC_SetReady(uint32_t Flags)
+{
+  IPC_RING_MB();
+  (void)__atomic_fetch_or(&IPC_Shared.ReadyFlags, Flags, __ATOMIC_SEQ_CST);
+}
+
+/**
+  * @brief  Waits until the other core has set ready flags.
+  * @param  Flags: IPC_READY_xxx, all of them are waited for.
+  * @param  Timeout: Timeout in ms (HAL tick).
+  * @retval 0 when all flags are set, -1 on timeout.
+  */
+int IPC_WaitReady(uint32_t Flags, uint32_t Timeout)
+{
+  uint32_t TickStart;
+
+  TickStart = HAL_GetTick();
+  while ((__atomic_load_n(&IPC_Shared.ReadyFlags, __ATOMIC_ACQUIRE) & Flags) != Flags)
+  {
+    if ((HAL_GetTick() - TickStart) > Timeout)
+    {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/**
+  * @brief  Retrieves the statistics of both directions.
+  *         The rate of doorbells per message shows how well sending is batched.
+  * @param  pTx: Statistics of messages sent by this core, may be NULL.
+  * @param  pRx: Statistics of messages sent to this core, may be NULL.
+  * @retval None
+  */
+void IPC_GetStat(IPC_StatTypeDef *pTx, IPC_StatTypeDef *pRx)
+{
+  if (pTx != NULL)
+  {
+    IPC_FillStat(IPC_TX_RING, pTx);
+  }
+  if (pRx != NULL)
+  {
+    IPC_FillStat(IPC_RX_RING, pRx);
+  }
+}
+
+/**
+  * @brief  Registers the function called when the other core rang the
+  *         doorbell, e.g. to wake the receiving task.
+  * @param  pCallback: Function called in interrupt context, NULL to remove.
+  * @retval None
+  */
+void IPC_RegisterRxCallback(IPC_RxCallbackTypeDef pCallback)
+{
+  IPC_pRxCallback = pCallback;
+}
+
+/**
+  * @brief  Registers a function for the HSEM free interrupt of this core.
+  *         The hardware semaphores are shared by all modules of a core, but
+  *         the HAL has a single HAL_HSEM_FreeCallback(); the application
+  *         implements it by calling IPC_HSEM_FreeHandler(), which dispatches
+  *         to the registered functions.
+  * @param  SemMask: Semaphores the function handles, __HAL_HSEM_SEMID_TO_MASK().
+  *         A function registered again gets the new mask.
+  * @param  pCallback: Function called in interrupt context.
+  * @retval 0 on success, -1 if the table is full.
+  */
+int IPC_HSEM_RegisterCallback(uint32_t SemMask, IPC_HSEM_CallbackTypeDef pCallback)
+{
+  IPC_HSEM_EntryTypeDef *pEntry;
+  uint32_t i;
+
+  pEntry = NULL;
+  for (i = 0; i < IPC_HSEM_MAX_CALLBACKS; i++)
+  {
+    if (IPC_aHsemCallbacks[i].pCallback == pCallback)
+    {
+      pEntry = &IPC_aHsemCallbacks[i];
+      break;
+    }
+    if ((pEntry == NULL) && (IPC_aHsemCallbacks[i].pCallback == NULL))
+    {
+      pEntry = &IPC_aHsemCallbacks[i];
+    }
+  }
+  if (pEntry == NULL)
+  {
+    return -1;
+  }
+  /* The interrupt may already be active: the mask is set last */
+  pEntry->SemMask = 0;
+  IPC_RING_MB();
+  pEntry->pCallback = pCallback;
+  IPC_RING_MB();
+  pEntry->SemMask = SemMask;
+  return 0;
+}
+
+/**
+  * @brief  Dispatches the HSEM free interrupt to the registered functions.
+  *         Called by HAL_HSEM_FreeCallback() of the application.
+  * @param  SemMask: Mask of the freed semaphores.
+  * @retval None
+  */
+void IPC_HSEM_FreeHandler(uint32_t SemMask)
+{
+  uint32_t Mask;
+  uint32_t i;
+
+  for (i = 0; i < IPC_HSEM_MAX_CALLBACKS; i++)
+  {
+    Mask = IPC_aHsemCallbacks[i].SemMask & SemMask;
+    if (Mask != 0U)
+    {
+      IPC_aHsemCallbacks[i].pCallback(Mask);
+    }
+  }
+}
@@ -0,0 +1,191 @@
+/**
+  ******************************************************************************
+  * @file    ipc_ring.c
+  * @brief   Lock-free single-producer/single-consumer descriptor ring.
+  *
+  *          Head and Tail are free running 32-bit counters; the slot index is
+  *          the counter modulo NumSlots. The producer fills slots reserved
+  *          with IPC_RING_Reserve() and publishes all of them at once with
+  *          IPC_RING_Commit(), so several messages cost a single barrier and
+  *          at most one doorbell.
+  *
+  *          Doorbell protocol: a consumer that found the ring empty calls
+  *          IPC_RING_PrepareWait() before it goes to sleep. This sets WaitFlag
+  *          and re-checks the ring. The producer checks WaitFlag after
+  *          publishing Head. Both sides use a full barrier between their store
+  *          and their load, so either the consumer sees the new Head or the
+  *          producer sees WaitFlag - a wakeup is never lost, and no doorbell is
+  *          raised while the consumer is busy.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include "ipc_ring.h"
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Initializes an empty ring. Must be called before the other side
+  *         accesses the ring.
+  * @param  pRing: Ring control block.
+  * @param  pSlots: Descriptor array, NumSlots entries.
+  * @param  NumSlots: Number of descriptors, must be a power of 2.
+  * @retval 0 on success, -1 if NumSlots is not a power of 2.
+  */
+int IPC_RING_Init(IPC_RingTypeDef *pRing, IPC_MsgTypeDef *pSlots, uint32_t NumSlots)
+{
+  if ((NumSlots == 0U) || ((NumSlots & (NumSlots - 1U)) != 0U))
+  {
+    return -1;
+  }
+  pRing->Head         = 0;
+  pRing->HeadPending  = 0;
+  pRing->NumMsgs      = 0;
+  pRing->NumBytes     = 0;
+  pRing->NumFull      = 0;
+  pRing->NumDoorbells = 0;
+  pRing->Tail         = 0;
+  pRing->WaitFlag     = 0;
+  pRing->NumSlots     = NumSlots;
+  pRing->pSlots       = pSlots;
+  IPC_RING_MB();
+  return 0;
+}
+
+/**
+  * @brief  Reserves the next free descriptor. The descriptor is not visible
+  *         to the consumer until IPC_RING_Commit() is called.
+  * @param  pRing: Ring control block.
+  * @retval Pointer to the descriptor to fill, NULL if the ring is full.
+  */
+IPC_MsgTypeDef *IPC_RING_Reserve(IPC_RingTypeDef *pRing)
+{
+  uint32_t HeadPending;
+
+  HeadPending = pRing->HeadPending;
+  if ((HeadPending - pRing->Tail) >= pRing->NumSlots)
+  {
+    pRing->NumFull++;
+    return NULL;
+  }
+  pRing->HeadPending = HeadPending + 1U;
+  return &pRing->pSlots[HeadPending & (pRing->NumSlots - 1U)];
+}
+
+/**
+  * @brief  Publishes all descriptors reserved since the last commit.
+  * @param  pRing: Ring control block.
+  * @retval 1 if the consumer is waiting and the caller has to raise the
+  *         doorbell, 0 otherwise.
+  */
+int IPC_RING_Commit(IPC_RingTypeDef *pRing)
+{
+  uint32_t Head;
+  uint32_t HeadPending;
+  uint32_t NumBytes;
+
+  Head        = pRing->Head;
+  HeadPending = pRing->HeadPending;
+  if (Head == HeadPending)
+  {
+    return 0;
+  }
+  NumBytes = 0;
+  while (Head != HeadPending)
+  {
+    NumBytes += pRing->pSlots[Head & (pRing->NumSlots - 1U)].Len;
+    Head++;
+    pRing->NumMsgs++;
+  }
+  pRing->NumBytes += NumBytes;
+  IPC_RING_MB();                    /* Descriptors before Head */
+  pRing->Head = HeadPending;
+  IPC_RING_MB();                    /* Head before WaitFlag */
+  if (pRing->WaitFlag != 0U)
+  {
+    pRing->WaitFlag = 0;
+    pRing->NumDoorbells++;
+    return 1;
+  }
+  return 0;
+}
+
+/**
+  * @brief  Returns the oldest published descriptor without removing it.
+  * @param  pRing: Ring control block.
+  * @retval Pointer to the descriptor, NULL if the ring is empty.
+  */
+IPC_MsgTypeDef *IPC_RING_Peek(IPC_RingTypeDef *pRing)
+{
+  uint32_t Tail;
+
+  Tail = pRing->Tail;
+  if (Tail == pRing->Head)
+  {
+    return NULL;
+  }
+  IPC_RING_MB();                    /* Head before descriptor contents */
+  return &pRing->pSlots[Tail & (pRing->NumSlots - 1U)];
+}
+
+/**
+  * @brief  Removes the descriptor returned by IPC_RING_Peek().
+  *         The descriptor must not be accessed afterwards.
+  * @param  pRing: Ring control block.
+  * @retval None
+  */
+void IPC_RING_Release(IPC_RingTypeDef *pRing)
+{
+  IPC_RING_MB();                    /* Descriptor reads before Tail */
+  pRing->Tail = pRing->Tail + 1U;
+}
+
+/**
+  * @brief  Announces that the consumer is going to sleep until the doorbell.
+  * @param  pRing: Ring control block.
+  * @retval 1 if the ring is still empty and the consumer may sleep,
+  *         0 if messages arrived meanwhile (WaitFlag is withdrawn).
+  */
+int IPC_RING_PrepareWait(IPC_RingTypeDef *pRing)
+{
+  pRing->WaitFlag = 1;
+  IPC_RING_MB();                    /* WaitFlag before Head */
+  if (pRing->Tail != pRing->Head)
+  {
+    pRing->WaitFlag = 0;
+    return 0;
+  }
+  return 1;
+}
+
+/**
+  * @brief  Withdraws a wait request, e.g. after a wait timeout.
+  *         A doorbell raised meanwhile is harmless.
+  * @param  pRing: Ring control block.
+  * @retval None
+  */
+void IPC_RING_CancelWait(IPC_RingTypeDef *pRing)
+{
+  pRing->WaitFlag = 0;
+}
+
+/**
+  * @brief  Returns the number of published, not yet released descriptors.
+  * @param  pRing: Ring control block.
+  * @retval Number of descriptors.
+  */
+uint32_t IPC_RING_GetCount(const IPC_RingTypeDef *pRing)
+{
+  return pRing->Head - pRing->Tail;
+}
@@ -0,0 +1,454 @@
+/**
+  ******************************************************************************
+  * @file    mem_arena.c
+  * @brief   Region-aware arena allocator.
+  *
+  *          Memory is described as a small set of named regions (on-chip
+  *          SRAM, SDRAM, a non-cacheable SDRAM window for DMA, ...), each
+  *          with attributes and a minimum alignment. Two allocators work on
+  *          every region:
+  *
+  *          - The bump allocator hands out memory that is never given back:
+  *            caches, pools and buffers set up once at start-up. Its cost is
+  *            an add and a compare; its only waste is alignment padding.
+  *          - The size class allocator serves memory that comes and goes.
+  *            Requests are rounded up to a power of 2 between
+  *            2^MEM_ARENA_MIN_CLASS_SHIFT and the largest class; blocks are
+  *            carved from the bump allocator on first use and recycled
+  *            through one free list per class, so allocation and release
+  *            are O(1) and a region cannot fragment into unusable holes.
+  *            The caller passes the size to MEM_ARENA_FreeBlock(), so blocks
+  *            carry no header and keep the alignment of the region.
+  *
+  *          Requests either name a region or describe it: Require lists the
+  *          attributes the memory must have, Prefer the ones it should have.
+  *          Regions are tried in the order they were added, first those
+  *          that have all preferred attributes, then the others.
+  *
+  *          Sizes are rounded up to the alignment of the region, so with a
+  *          cache line sized alignment no two allocations share a line.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <string.h>
+#include "mem_arena.h"
+
+/* Private define ------------------------------------------------------------*/
+#define MEM_ARENA_CLASS_SIZE(Class)   (1UL << (MEM_ARENA_MIN_CLASS_SHIFT + (Class)))
+
+/* Private function prototypes -----------------------------------------------*/
+static int   MEM_ARENA_GetClass(uint32_t NumBytes);
+static void *MEM_ARENA_Bump(MEM_RegionTypeDef *pRegion, uint32_t NumBytes, uint32_t Align);
+static void *MEM_ARENA_TakeBlock(MEM_RegionTypeDef *pRegion, int Class);
+static int   MEM_ARENA_IsCandidate(const MEM_RegionTypeDef *pRegion, uint32_t Require, uint32_t Prefer, int Pass);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Returns the size class of a request.
+  * @param  NumBytes: Requested size.
+  * @retval Class index, -1 if NumBytes is 0 or above the largest class.
+  */
+static int MEM_ARENA_GetClass(uint32_t NumBytes)
+{
+  int Class;
+
+  if ((NumBytes == 0U) || (NumBytes > MEM_ARENA_CLASS_SIZE(MEM_ARENA_NUM_CLASSES - 1U)))
+  {
+    return -1;
+  }
+  Class = 0;
+  while (MEM_ARENA_CLASS_SIZE(Class) < NumBytes)
+  {
+    Class++;
+  }
+  return Class;
+}
+
+/**
+  * @brief  Takes memory from the bump allocator of a region.
+  * @param  pRegion: Region.
+  * @param  NumBytes: Size, rounded up to the alignment of the region.
+  * @param  Align: Alignment, a power of 2; 0 for the alignment of the region.
+  * @retval Memory, NULL if it does not fit.
+  */
+static void *MEM_ARENA_Bump(MEM_RegionTypeDef *pRegion, uint32_t NumBytes, uint32_t Align)
+{
+  uintptr_t Addr;
+  uint32_t  Pad;
+  uint32_t  Size;
+  uint32_t  Avail;
+  uint8_t  *p;
+
+  if (Align < pRegion->Align)
+  {
+    Align = pRegion->Align;
+  }
+  if ((NumBytes == 0U) || ((Align & (Align - 1U)) != 0U))
+  {
+    return NULL;
+  }
+  Size = (NumBytes + pRegion->Align - 1U) & ~(pRegion->Align - 1U);
+  if (Size < NumBytes)
+  {
+    return NULL;                        /* Wrapped around */
+  }
+  Addr  = (uintptr_t)(pRegion->pBase + pRegion->Stat.Used);
+  Pad   = (uint32_t)((Align - (Addr & (Align - 1U))) & (Align - 1U));
+  Avail = pRegion->Stat.Size - pRegion->Stat.Used;
+  if ((Pad > Avail) || (Size > (Avail - Pad)))
+  {
+    return NULL;
+  }
+  p = pRegion->pBase + pRegion->Stat.Used + Pad;
+  pRegion->Stat.Used     += Pad + Size;
+  pRegion->Stat.PadBytes += Pad;
+  return p;
+}
+
+/**
+  * @brief  Takes a block of a size class, from its free list if possible.
+  * @param  pRegion: Region.
+  * @param  Class: Size class.
+  * @retval Block, NULL if the free list is empty and the region is full.
+  */
+static void *MEM_ARENA_TakeBlock(MEM_RegionTypeDef *pRegion, int Class)
+{
+  uint32_t  Size;
+  void     *p;
+
+  Size = MEM_ARENA_CLASS_SIZE(Class);
+  p    = pRegion->apFree[Class];
+  if (p != NULL)
+  {
+    pRegion->apFree[Class]  = *(void **)p;
+    pRegion->Stat.FreeBytes -= Size;
+  }
+  else
+  {
+    p = MEM_ARENA_Bump(pRegion, Size, 0);
+    if (p == NULL)
+    {
+      return NULL;
+    }
+  }
+  pRegion->Stat.BlockBytes += Size;
+  pRegion->Stat.NumAllocs++;
+  return p;
+}
+
+/**
+  * @brief  Checks whether a region takes part in a search pass.
+  * @param  pRegion: Region.
+  * @param  Require: Attributes the region must have.
+  * @param  Prefer: Attributes the region should have.
+  * @param  Pass: 0 for regions with all preferred attributes, 1 for the rest.
+  * @retval 1 if the region is a candidate, 0 otherwise.
+  */
+static int MEM_ARENA_IsCandidate(const MEM_RegionTypeDef *pRegion, uint32_t Require, uint32_t Prefer, int Pass)
+{
+  int IsPreferred;
+
+  if ((pRegion->Attr & Require) != Require)
+  {
+    return 0;
+  }
+  IsPreferred = ((pRegion->Attr & Prefer) == Prefer) ? 1 : 0;
+  return (IsPreferred == ((Pass == 0) ? 1 : 0)) ? 1 : 0;
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Initializes an arena without regions.
+  * @param  pArena: Arena.
+  * @retval None
+  */
+void MEM_ARENA_Init(MEM_ArenaTypeDef *pArena)
+{
+  memset(pArena, 0, sizeof(*pArena));
+}
+
+/**
+  * @brief  Adds a region. Regions must not overlap.
+  * @param  pArena: Arena.
+  * @param  sName: Name, kept by reference.
+  * @param  pMem: Start of the region.
+  * @param  NumBytes: Size of the region.
+  * @param  Attr: MEM_ARENA_ATTR_xxx.
+  * @param  Align: Minimum alignment and size granule, a power of 2. Raised
+  *         to the size of a pointer; use the cache line size for regions
+  *         shared with DMA.
+  * @retval Region index, -1 on error.
+  */
+int MEM_ARENA_AddRegion(MEM_ArenaTypeDef *pArena, const char *sName, void *pMem, uint32_t NumBytes,
+                        uint32_t Attr, uint32_t Align)
+{
+  MEM_RegionTypeDef *pRegion;
+
+  if ((pArena->NumRegions >= MEM_ARENA_MAX_REGIONS) || (pMem == NULL) || (NumBytes == 0U) ||
+      ((Align & (Align - 1U)) != 0U))
+  {
+    return -1;
+  }
+  if (Align < sizeof(void *))
+  {
+    Align = sizeof(void *);
+  }
+  pRegion = &pArena->aRegion[pArena->NumRegions];
+  memset(pRegion, 0, sizeof(*pRegion));
+  pRegion->sName     = sName;
+  pRegion->pBase     = (uint8_t *)pMem;
+  pRegion->Attr      = Attr;
+  pRegion->Align     = Align;
+  pRegion->Stat.Size = NumBytes;
+  return (int)pArena->NumRegions++;
+}
+
+/**
+  * @brief  Looks up a region by name.
+  * @param  pArena: Arena.
+  * @param  sName: Name.
+  * @retval Region index, -1 if there is no such region.
+  */
+int MEM_ARENA_FindRegion(const MEM_ArenaTypeDef *pArena, const char *sName)
+{
+  uint32_t i;
+
+  for (i = 0; i < pArena->NumRegions; i++)
+  {
+    if (strcmp(pArena->aRegion[i].sName, sName) == 0)
+    {
+      return (int)i;
+    }
+  }
+  return -1;
+}
+
+/**
+  * @brief  Allocates permanent memory from the first region that matches.
+  * @param  pArena: Arena.
+  * @param  NumBytes: Size.
+  * @param  Align: Alignment, a power of 2; 0 for the alignment of the region.
+  * @param  Require: Attributes the memory must have.
+  * @param  Prefer: Attributes the memory should have.
+  * @retval Memory, NULL if no region can serve the request.
+  */
+void *MEM_ARENA_Alloc(MEM_ArenaTypeDef *pArena, uint32_t NumBytes, uint32_t Align,
+                      uint32_t Require, uint32_t Prefer)
+{
+  MEM_RegionTypeDef *pRegion;
+  void              *p;
+  uint32_t           i;
+  int                Pass;
+
+  for (Pass = 0; Pass < 2; Pass++)
+  {
+    for (i = 0; i < pArena->NumRegions; i++)
+    {
+      pRegion = &pArena->aRegion[i];
+      if (MEM_ARENA_IsCandidate(pRegion, Require, Prefer, Pass) != 0)
+      {
+        p = MEM_ARENA_Bump(pRegion, NumBytes, Align);
+        if (p != NULL)
+        {
+          pRegion->Stat.NumAllocs++;
+          return p;
+        }
+      }
+    }
+  }
+  pArena->NumFailed++;
+  return NULL;
+}
+
+/**
+  * @brief  Allocates permanent memory from a given region.
+  * @param  pArena: Arena.
+  * @param  Region: Region index.
+  * @param  NumBytes: Size.
+  * @param  Align: Alignment, a power of 2; 0 for the alignment of the region.
+  * @retval Memory, NULL if it does not fit.
+  */
+void *MEM_ARENA_AllocFrom(MEM_ArenaTypeDef *pArena, int Region, uint32_t NumBytes, uint32_t Align)
+{
+  MEM_RegionTypeDef *pRegion;
+  void              *p;
+
+  if ((Region < 0) || ((uint32_t)Region >= pArena->NumRegions))
+  {
+    pArena->NumFailed++;
+    return NULL;
+  }
+  pRegion = &pArena->aRegion[Region];
+  p = MEM_ARENA_Bump(pRegion, NumBytes, Align);
+  if (p == NULL)
+  {
+    pRegion->Stat.NumFailed++;
+    return NULL;
+  }
+  pRegion->Stat.NumAllocs++;
+  return p;
+}
+
+/**
+  * @brief  Allocates a size class block from the first region that matches.
+  * @param  pArena: Arena.
+  * @param  NumBytes: Size, at most the largest size class.
+  * @param  Require: Attributes the memory must have.
+  * @param  Prefer: Attributes the memory should have.
+  * @retval Block, NULL if no region can serve the request.
+  */
+void *MEM_ARENA_AllocBlock(MEM_ArenaTypeDef *pArena, uint32_t NumBytes, uint32_t Require, uint32_t Prefer)
+{
+  MEM_RegionTypeDef *pRegion;
+  void              *p;
+  uint32_t           i;
+  int                Class;
+  int                Pass;
+
+  Class = MEM_ARENA_GetClass(NumBytes);
+  if (Class >= 0)
+  {
+    for (Pass = 0; Pass < 2; Pass++)
+    {
+      for (i = 0; i < pArena->NumRegions; i++)
+      {
+        pRegion = &pArena->aRegion[i];
+        if (MEM_ARENA_IsCandidate(pRegion, Require, Prefer, Pass) != 0)
+        {
+          p = MEM_ARENA_TakeBlock(pRegion, Class);
+          if (p != NULL)
+          {
+            return p;
+          }
+        }
+      }
+    }
+  }
+  pArena->NumFailed++;
+  return NULL;
+}
+
+/**
+  * @brief  Allocates a size class block from a given region.
+  * @param  pArena: Arena.
+  * @param  Region: Region index.
+  * @param  NumBytes: Size, at most the largest size class.
+  * @retval Block, NULL if it does not fit.
+  */
+void *MEM_ARENA_AllocBlockFrom(MEM_ArenaTypeDef *pArena, int Region, uint32_t NumBytes)
+{
+  MEM_RegionTypeDef *pRegion;
+  void              *p;
+  int                Class;
+
+  Class = MEM_ARENA_GetClass(NumBytes);
+  if ((Class < 0) || (Region < 0) || ((uint32_t)Region >= pArena->NumRegions))
+  {
+    pArena->NumFailed++;
+    return NULL;
+  }
+  pRegion = &pArena->aRegion[Region];
+  p = MEM_ARENA_TakeBlock(pRegion, Class);
+  if (p == NULL)
+  {
+    pRegion->Stat.NumFailed++;
+  }
+  return p;
+}
+
+/**
+  * @brief  Returns a size class block to its free list.
+  * @param  pArena: Arena.
+  * @param  p: Block from MEM_ARENA_AllocBlock() or MEM_ARENA_AllocBlockFrom().
+  * @param  NumBytes: Size passed when the block was allocated.
+  * @retval 0 on success, -1 if p is not in a region or NumBytes is not valid.
+  */
+int MEM_ARENA_FreeBlock(MEM_ArenaTypeDef *pArena, void *p, uint32_t NumBytes)
+{
+  MEM_RegionTypeDef *pRegion;
+  uint32_t           Size;
+  int                Region;
+  int                Class;
+
+  Region = MEM_ARENA_GetRegion(pArena, p);
+  Class  = MEM_ARENA_GetClass(NumBytes);
+  if ((Region < 0) || (Class < 0))
+  {
+    return -1;
+  }
+  pRegion = &pArena->aRegion[Region];
+  Size    = MEM_ARENA_CLASS_SIZE(Class);
+  *(void **)p = pRegion->apFree[Class];
+  pRegion->apFree[Class]    = p;
+  pRegion->Stat.BlockBytes -= Size;
+  pRegion->Stat.FreeBytes  += Size;
+  return 0;
+}
+
+/**
+  * @brief  Returns the region memory belongs to.
+  * @param  pArena: Arena.
+  * @param  p: Address.
+  * @retval Region index, -1 if p is in no region.
+  */
+int MEM_ARENA_GetRegion(const MEM_ArenaTypeDef *pArena, const void *p)
+{
+  const MEM_RegionTypeDef *pRegion;
+  uint32_t                 i;
+
+  for (i = 0; i < pArena->NumRegions; i++)
+  {
+    pRegion = &pArena->aRegion[i];
+    if (((const uint8_t *)p >= pRegion->pBase) && ((const uint8_t *)p < (pRegion->pBase + pRegion->Stat.Size)))
+    {
+      return (int)i;
+    }
+  }
+  return -1;
+}
+
+/**
+  * @brief  Returns the attributes of the region memory belongs to, e.g. to
+  *         decide whether a DMA buffer needs cache maintenance.
+  * @param  pArena: Arena.
+  * @param  p: Address.
+  * @retval MEM_ARENA_ATTR_xxx, 0 if p is in no region.
+  */
+uint32_t MEM_ARENA_GetAttr(const MEM_ArenaTypeDef *pArena, const void *p)
+{
+  int Region;
+
+  Region = MEM_ARENA_GetRegion(pArena, p);
+  return (Region < 0) ? 0U : pArena->aRegion[Region].Attr;
+}
+
+/**
+  * @brief  Copies the counters of a region.
+  * @param  pArena: Arena.
+  * @param  Region: Region index.
+  * @param  pStat: [OUT] Counters, all 0 if Region is not valid.
+  * @retval None
+  */
+void MEM_ARENA_GetStat(const MEM_ArenaTypeDef *pArena, int Region, MEM_ARENA_StatTypeDef *pStat)
+{
+  if ((Region < 0) || ((uint32_t)Region >= pArena->NumRegions))
+  {
+    memset(pStat, 0, sizeof(*pStat));
+    return;
+  }
+  *pStat = pArena->aRegion[Region].Stat;
+}
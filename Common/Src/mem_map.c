@@ -0,0 +1,412 @@
+/**
+  ******************************************************************************
+  * @file    mem_map.c
+  * @brief   Memory regions of both cores on top of mem_arena.c.
+  *
+  *          Each core has its own arena:
+  *
+  *          Cortex-M4  "sram"       .bss                      FAST
+  *                     "sdram"      SDRAM CM4 slice           EXTERNAL | DMA
+  *          Cortex-M7  "sram"       AXI SRAM (.axi_sram)      FAST | CACHEABLE
+  *                     "sdram"      SDRAM CM7 cacheable slice EXTERNAL | CACHEABLE
+  *                     "sdram_dma"  SDRAM CM7 DMA slice       EXTERNAL | DMA
+  *
+  *          The Cortex-M4 owns the FMC. MEM_MAP_Init() on the Cortex-M4 runs
+  *          the SDRAM power-up sequence after MX_FMC_Init() and sets
+  *          IPC_READY_SDRAM; MEM_MAP_Init() on the Cortex-M7 waits for it
+  *          before it adds the SDRAM regions. On both cores the SDRAM is
+  *          mapped as normal memory by the MPU (the default map treats
+  *          0xD0000000 as device memory, where unaligned accesses fault).
+  *
+  *          The arena functions are called with interrupts disabled, so
+  *          tasks and interrupts of one core may allocate concurrently.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "ipc.h"
+#include "mem_map.h"
+#if MEM_MAP_USE_EMFILE
+#include "FS.h"
+#endif /* MEM_MAP_USE_EMFILE */
+#if MEM_MAP_USE_EMUSB
+#include "USBH.h"
+#endif /* MEM_MAP_USE_EMUSB */
+
+/* Private define ------------------------------------------------------------*/
+#ifndef MEM_MAP_MPU_REGION_SDRAM
+#define MEM_MAP_MPU_REGION_SDRAM      MPU_REGION_NUMBER2
+#endif
+#ifndef MEM_MAP_MPU_REGION_SDRAM_DMA
+#define MEM_MAP_MPU_REGION_SDRAM_DMA  MPU_REGION_NUMBER3   /* Must be above MEM_MAP_MPU_REGION_SDRAM */
+#endif
+
+#define MEM_MAP_DMA_ALIGN             32U   /* Cache line of the Cortex-M7 */
+
+#if defined(CORE_CM7)
+  #define MEM_MAP_SRAM_ATTR           (MEM_ARENA_ATTR_FAST | MEM_ARENA_ATTR_CACHEABLE)
+  #define MEM_MAP_SRAM_SECTION        __attribute__((section(".axi_sram"), aligned(32)))
+#else
+  #define MEM_MAP_SRAM_ATTR           (MEM_ARENA_ATTR_FAST)
+  #define MEM_MAP_SRAM_SECTION        __attribute__((aligned(32)))
+
+  /* SDRAM mode register */
+  #define MEM_MAP_SDRAM_MODEREG_BURST_LENGTH_1      0x0000U
+  #define MEM_MAP_SDRAM_MODEREG_BURST_SEQUENTIAL    0x0000U
+  #define MEM_MAP_SDRAM_MODEREG_CAS_LATENCY_1       0x0010U   /* Same as hsdram1.Init.CASLatency */
+  #define MEM_MAP_SDRAM_MODEREG_MODE_STANDARD       0x0000U
+  #define MEM_MAP_SDRAM_MODEREG_WRITEBURST_SINGLE   0x0200U
+
+  #define MEM_MAP_SDRAM_CMD_TIMEOUT   0xFFFFU
+  #define MEM_MAP_SDRAM_REFRESH_COUNT 480U    /* 64 ms / 4096 rows = 15.6 us at SDCLK 32 MHz (FMC 64 MHz / 2), minus 20 */
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+#if !defined(CORE_CM7)
+extern SDRAM_HandleTypeDef hsdram1;
+#endif
+
+static uint8_t          MEM_MAP_aSram[MEM_MAP_SRAM_SIZE] MEM_MAP_SRAM_SECTION;
+static MEM_ArenaTypeDef MEM_MAP_Arena;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t MEM_MAP_Lock(void);
+static void     MEM_MAP_Unlock(uint32_t PriMask);
+static void     MEM_MAP_ConfigMpu(uint32_t Number, uint32_t BaseAddress, uint32_t NumBytes, uint8_t IsCacheable);
+#if !defined(CORE_CM7)
+static int      MEM_MAP_SdramCommand(uint32_t CommandMode, uint32_t AutoRefreshNumber, uint32_t ModeRegister);
+static int      MEM_MAP_InitSdram(void);
+#endif
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Enters the critical section of the arena.
+  * @retval Previous PRIMASK.
+  */
+static uint32_t MEM_MAP_Lock(void)
+{
+  uint32_t PriMask;
+
+  PriMask = __get_PRIMASK();
+  __disable_irq();
+  return PriMask;
+}
+
+/**
+  * @brief  Leaves the critical section of the arena.
+  * @param  PriMask: Value returned by MEM_MAP_Lock().
+  * @retval None
+  */
+static void MEM_MAP_Unlock(uint32_t PriMask)
+{
+  __set_PRIMASK(PriMask);
+}
+
+/**
+  * @brief  Maps SDRAM as normal memory.
+  * @param  Number: MPU region.
+  * @param  BaseAddress: Start, aligned to NumBytes.
+  * @param  NumBytes: Size, power of 2.
+  * @param  IsCacheable: Write-back cacheable if not 0, non-cacheable otherwise.
+  * @retval None
+  */
+static void MEM_MAP_ConfigMpu(uint32_t Number, uint32_t BaseAddress, uint32_t NumBytes, uint8_t IsCacheable)
+{
+  MPU_Region_InitTypeDef MPU_InitStruct = {0};
+
+  MPU_InitStruct.Enable = MPU_REGION_ENABLE;
+  MPU_InitStruct.Number = (uint8_t)Number;
+  MPU_InitStruct.BaseAddress = BaseAddress;
+  MPU_InitStruct.Size = (uint8_t)(30U - __CLZ(NumBytes));   /* log2(NumBytes) - 1 */
+  MPU_InitStruct.SubRegionDisable = 0x0;
+  MPU_InitStruct.TypeExtField = MPU_TEX_LEVEL1;
+  MPU_InitStruct.AccessPermission = MPU_REGION_FULL_ACCESS;
+  MPU_InitStruct.DisableExec = MPU_INSTRUCTION_ACCESS_DISABLE;
+  MPU_InitStruct.IsShareable = MPU_ACCESS_NOT_SHAREABLE;
+  MPU_InitStruct.IsCacheable = (IsCacheable != 0U) ? MPU_ACCESS_CACHEABLE : MPU_ACCESS_NOT_CACHEABLE;
+  MPU_InitStruct.IsBufferable = (IsCacheable != 0U) ? MPU_ACCESS_BUFFERABLE : MPU_ACCESS_NOT_BUFFERABLE;
+  HAL_MPU_ConfigRegion(&MPU_InitStruct);
+}
+
+#if !defined(CORE_CM7)
+
+/**
+  * @brief  Sends one command to the SDRAM of bank 2.
+  * @param  CommandMode: FMC_SDRAM_CMD_xxx.
+  * @param  AutoRefreshNumber: Number of auto-refresh cycles.
+  * @param  ModeRegister: Mode register value for FMC_SDRAM_CMD_LOAD_MODE.
+  * @retval 0 on success, -1 on error.
+  */
+static int MEM_MAP_SdramCommand(uint32_t CommandMode, uint32_t AutoRefreshNumber, uint32_t ModeRegister)
+{
+  FMC_SDRAM_CommandTypeDef Command = {0};
+
+  Command.CommandMode = CommandMode;
+  Command.CommandTarget = FMC_SDRAM_CMD_TARGET_BANK2;
+  Command.AutoRefreshNumber = AutoRefreshNumber;
+  Command.ModeRegisterDefinition = ModeRegister;
+  return (HAL_SDRAM_SendCommand(&hsdram1, &Command, MEM_MAP_SDRAM_CMD_TIMEOUT) == HAL_OK) ? 0 : -1;
+}
+
+/**
+  * @brief  Runs the JEDEC power-up sequence of the SDRAM. MX_FMC_Init() only
+  *         sets up the controller.
+  * @retval 0 on success, -1 on error.
+  */
+static int MEM_MAP_InitSdram(void)
+{
+  if (MEM_MAP_SdramCommand(FMC_SDRAM_CMD_CLK_ENABLE, 1U, 0U) != 0)
+  {
+    return -1;
+  }
+  HAL_Delay(1);                         /* At least 100 us with the clock running */
+  if ((MEM_MAP_SdramCommand(FMC_SDRAM_CMD_PALL, 1U, 0U) != 0) ||
+      (MEM_MAP_SdramCommand(FMC_SDRAM_CMD_AUTOREFRESH_MODE, 8U, 0U) != 0) ||
+      (MEM_MAP_SdramCommand(FMC_SDRAM_CMD_LOAD_MODE, 1U,
+                            MEM_MAP_SDRAM_MODEREG_BURST_LENGTH_1 | MEM_MAP_SDRAM_MODEREG_BURST_SEQUENTIAL |
+                            MEM_MAP_SDRAM_MODEREG_CAS_LATENCY_1 | MEM_MAP_SDRAM_MODEREG_MODE_STANDARD |
+                            MEM_MAP_SDRAM_MODEREG_WRITEBURST_SINGLE) != 0))
+  {
+    return -1;
+  }
+  return (HAL_SDRAM_ProgramRefreshRate(&hsdram1, MEM_MAP_SDRAM_REFRESH_COUNT) == HAL_OK) ? 0 : -1;
+}
+
+#endif /* !CORE_CM7 */
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Sets up the regions of the calling core. The Cortex-M4 calls it
+  *         after MX_FMC_Init() and IPC_Init(), the Cortex-M7 after it has
+  *         released the Cortex-M4.
+  * @retval 0 on success, -1 if the SDRAM is not available (the SRAM region
+  *         is usable anyway).
+  */
+int MEM_MAP_Init(void)
+{
+  int r;
+
+  MEM_ARENA_Init(&MEM_MAP_Arena);
+  (void)MEM_ARENA_AddRegion(&MEM_MAP_Arena, MEM_MAP_REGION_SRAM, MEM_MAP_aSram, sizeof(MEM_MAP_aSram),
+                            MEM_MAP_SRAM_ATTR, 8U);
+#if defined(CORE_CM7)
+  r = IPC_WaitReady(IPC_READY_SDRAM, MEM_MAP_SDRAM_TIMEOUT_MS);
+  if (r == 0)
+  {
+    HAL_MPU_Disable();
+    MEM_MAP_ConfigMpu(MEM_MAP_MPU_REGION_SDRAM, MEM_MAP_SDRAM_BASE, MEM_MAP_SDRAM_SIZE, 1U);
+    MEM_MAP_ConfigMpu(MEM_MAP_MPU_REGION_SDRAM_DMA, MEM_MAP_SDRAM_BASE + MEM_MAP_SDRAM_CM4_SIZE,
+                      MEM_MAP_SDRAM_DMA_SIZE, 0U);
+    HAL_MPU_Enable(MPU_PRIVILEGED_DEFAULT);
+    (void)MEM_ARENA_AddRegion(&MEM_MAP_Arena, MEM_MAP_REGION_SDRAM,
+                              (void *)(MEM_MAP_SDRAM_BASE + MEM_MAP_SDRAM_CM4_SIZE + MEM_MAP_SDRAM_DMA_SIZE),
+                              MEM_MAP_SDRAM_SIZE - MEM_MAP_SDRAM_CM4_SIZE - MEM_MAP_SDRAM_DMA_SIZE,
+                              MEM_ARENA_ATTR_EXTERNAL | MEM_ARENA_ATTR_CACHEABLE, MEM_MAP_DMA_ALIGN);
+    (void)MEM_ARENA_AddRegion(&MEM_MAP_Arena, MEM_MAP_REGION_SDRAM_DMA,
+                              (void *)(MEM_MAP_SDRAM_BASE + MEM_MAP_SDRAM_CM4_SIZE), MEM_MAP_SDRAM_DMA_SIZE,
+                              MEM_ARENA_ATTR_EXTERNAL | MEM_ARENA_ATTR_DMA, MEM_MAP_DMA_ALIGN);
+  }
+#else
+  r = MEM_MAP_InitSdram();
+  if (r == 0)
+  {
+    HAL_MPU_Disable();
+    MEM_MAP_ConfigMpu(MEM_MAP_MPU_REGION_SDRAM, MEM_MAP_SDRAM_BASE, MEM_MAP_SDRAM_SIZE, 0U);
+    HAL_MPU_Enable(MPU_PRIVILEGED_DEFAULT);
+    (void)MEM_ARENA_AddRegion(&MEM_MAP_Arena, MEM_MAP_REGION_SDRAM, (void *)MEM_MAP_SDRAM_BASE,
+                              MEM_MAP_SDRAM_CM4_SIZE, MEM_ARENA_ATTR_EXTERNAL | MEM_ARENA_ATTR_DMA,
+                              MEM_MAP_DMA_ALIGN);
+    IPC_SetReady(IPC_READY_SDRAM);
+  }
+#endif
+  return r;
+}
+
+/**
+  * @brief  Allocates permanent memory, see MEM_ARENA_Alloc().
+  * @param  NumBytes: Size.
+  * @param  Align: Alignment, a power of 2; 0 for the alignment of the region.
+  * @param  Require: MEM_ARENA_ATTR_xxx the memory must have.
+  * @param  Prefer: MEM_ARENA_ATTR_xxx the memory should have.
+  * @retval Memory, NULL if no region can serve the request.
+  */
+void *MEM_MAP_Alloc(uint32_t NumBytes, uint32_t Align, uint32_t Require, uint32_t Prefer)
+{
+  uint32_t  PriMask;
+  void     *p;
+
+  PriMask = MEM_MAP_Lock();
+  p = MEM_ARENA_Alloc(&MEM_MAP_Arena, NumBytes, Align, Require, Prefer);
+  MEM_MAP_Unlock(PriMask);
+  return p;
+}
+
+/**
+  * @brief  Allocates permanent memory from a named region.
+  * @param  sRegion: MEM_MAP_REGION_xxx.
+  * @param  NumBytes: Size.
+  * @param  Align: Alignment, a power of 2; 0 for the alignment of the region.
+  * @retval Memory, NULL if there is no such region or it is full.
+  */
+void *MEM_MAP_AllocFrom(const char *sRegion, uint32_t NumBytes, uint32_t Align)
+{
+  uint32_t  PriMask;
+  void     *p;
+
+  PriMask = MEM_MAP_Lock();
+  p = MEM_ARENA_AllocFrom(&MEM_MAP_Arena, MEM_ARENA_FindRegion(&MEM_MAP_Arena, sRegion), NumBytes, Align);
+  MEM_MAP_Unlock(PriMask);
+  return p;
+}
+
+/**
+  * @brief  Allocates a size class block, see MEM_ARENA_AllocBlock().
+  * @param  NumBytes: Size.
+  * @param  Require: MEM_ARENA_ATTR_xxx the memory must have.
+  * @param  Prefer: MEM_ARENA_ATTR_xxx the memory should have.
+  * @retval Block, NULL if no region can serve the request.
+  */
+void *MEM_MAP_AllocBlock(uint32_t NumBytes, uint32_t Require, uint32_t Prefer)
+{
+  uint32_t  PriMask;
+  void     *p;
+
+  PriMask = MEM_MAP_Lock();
+  p = MEM_ARENA_AllocBlock(&MEM_MAP_Arena, NumBytes, Require, Prefer);
+  MEM_MAP_Unlock(PriMask);
+  return p;
+}
+
+/**
+  * @brief  Frees a block from MEM_MAP_AllocBlock().
+  * @param  p: Block.
+  * @param  NumBytes: Size passed when the block was allocated.
+  * @retval None
+  */
+void MEM_MAP_FreeBlock(void *p, uint32_t NumBytes)
+{
+  uint32_t PriMask;
+
+  PriMask = MEM_MAP_Lock();
+  (void)MEM_ARENA_FreeBlock(&MEM_MAP_Arena, p, NumBytes);
+  MEM_MAP_Unlock(PriMask);
+}
+
+/**
+  * @brief  Returns the attributes of the region memory belongs to.
+  * @param  p: Address.
+  * @retval MEM_ARENA_ATTR_xxx, 0 if p is in no region.
+  */
+uint32_t MEM_MAP_GetAttr(const void *p)
+{
+  return MEM_ARENA_GetAttr(&MEM_MAP_Arena, p);
+}
+
+/**
+  * @brief  Copies the counters of a named region.
+  * @param  sRegion: MEM_MAP_REGION_xxx.
+  * @param  pStat: [OUT] Counters.
+  * @retval 0 on success, -1 if there is no such region.
+  */
+int MEM_MAP_GetStat(const char *sRegion, MEM_ARENA_StatTypeDef *pStat)
+{
+  uint32_t PriMask;
+  int      Region;
+
+  PriMask = MEM_MAP_Lock();
+  Region = MEM_ARENA_FindRegion(&MEM_MAP_Arena, sRegion);
+  MEM_ARENA_GetStat(&MEM_MAP_Arena, Region, pStat);
+  MEM_MAP_Unlock(PriMask);
+  return (Region < 0) ? -1 : 0;
+}
+
+#if MEM_MAP_USE_EMFILE
+
+/**
+  * @brief  Gives emFile its working memory, preferably in on-chip SRAM.
+  *         Call from FS_X_AddDevices() instead of FS_AssignMemory() with a
+  *         static array.
+  * @param  NumBytes: Size.
+  * @retval 0 on success, -1 on error.
+  */
+int MEM_MAP_AssignFsMemory(uint32_t NumBytes)
+{
+  void *p;
+
+  p = MEM_MAP_Alloc(NumBytes, 0, 0, MEM_ARENA_ATTR_FAST);
+  if (p == NULL)
+  {
+    return -1;
+  }
+  FS_AssignMemory((U32 *)p, NumBytes);
+  return 0;
+}
+
+/**
+  * @brief  Assigns a read/write sector cache in SDRAM to a volume.
+  * @param  sVolumeName: Volume, e.g. "mmc:0:".
+  * @param  NumBytes: Cache size, FS_SIZEOF_CACHE_RW() for a number of sectors.
+  * @retval 0 on success, -1 on error.
+  */
+int MEM_MAP_AssignFsCache(const char *sVolumeName, uint32_t NumBytes)
+{
+  void *p;
+
+  p = MEM_MAP_Alloc(NumBytes, 0, 0, MEM_ARENA_ATTR_EXTERNAL | MEM_ARENA_ATTR_CACHEABLE);
+  if (p == NULL)
+  {
+    return -1;
+  }
+  return (FS_AssignCache(sVolumeName, p, (I32)NumBytes, FS_CACHE_RW) != 0U) ? 0 : -1;
+}
+
+#endif /* MEM_MAP_USE_EMFILE */
+
+#if MEM_MAP_USE_EMUSB
+
+/**
+  * @brief  Gives emUSB-Host its memory pools. Call from USBH_X_Config().
+  *         Transfer buffers must be reachable by the USB DMA without cache
+  *         maintenance.
+  * @param  NumBytes: Size of the general pool, preferably on-chip.
+  * @param  NumTransferBytes: Size of the transfer pool, 0 to take transfer
+  *         buffers from the general pool.
+  * @retval 0 on success, -1 on error.
+  */
+int MEM_MAP_AssignUsbhMemory(uint32_t NumBytes, uint32_t NumTransferBytes)
+{
+  void *pMem;
+  void *pTransfer;
+
+  pMem      = MEM_MAP_Alloc(NumBytes, 0, 0, MEM_ARENA_ATTR_FAST);
+  pTransfer = NULL;
+  if (NumTransferBytes != 0U)
+  {
+    pTransfer = MEM_MAP_Alloc(NumTransferBytes, 0, MEM_ARENA_ATTR_DMA, MEM_ARENA_ATTR_EXTERNAL);
+  }
+  if ((pMem == NULL) || ((NumTransferBytes != 0U) && (pTransfer == NULL)))
+  {
+    return -1;
+  }
+  USBH_AssignMemory(pMem, NumBytes);
+  if (pTransfer != NULL)
+  {
+    USBH_AssignTransferMemory(pTransfer, NumTransferBytes);
+  }
+  return 0;
+}
+
+#endif /* MEM_MAP_USE_EMUSB */
@@ -161,6 +161,17 @@ BOT_HandleTypeDef;
 
 #define BOT_PAGE_LENGTH              512U
 
+/* Largest part of the data stage submitted as one URB. The HCD receives an
+   IN URB packet by packet, so it may span many packets (multiple of the
+   endpoint size). An OUT URB is written to the Tx FIFO at once without DMA
+   and has to fit into the free FIFO space. */
+#ifndef USBH_MSC_BOT_MAX_IN_XFER
+#define USBH_MSC_BOT_MAX_IN_XFER     4096U
+#endif
+#ifndef USBH_MSC_BOT_MAX_OUT_XFER
+#define USBH_MSC_BOT_MAX_OUT_XFER    512U
+#endif
+
 
 #define BOT_CBW_CB_LENGTH            16U
 
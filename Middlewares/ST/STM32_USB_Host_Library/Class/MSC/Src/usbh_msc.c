@@ -72,6 +72,9 @@ EndBSPDependencies */
 /** @defgroup USBH_MSC_CORE_Private_Defines
   * @{
   */
+#ifndef USBH_MSC_URB_WAIT_TIMEOUT
+#define USBH_MSC_URB_WAIT_TIMEOUT   5U    /* Longest sleep between two polls of a transfer, in ms */
+#endif
 /**
   * @}
   */
@@ -100,6 +103,7 @@ static USBH_StatusTypeDef USBH_MSC_Process(USBH_HandleTypeDef *phost);
 static USBH_StatusTypeDef USBH_MSC_ClassRequest(USBH_HandleTypeDef *phost);
 static USBH_StatusTypeDef USBH_MSC_SOFProcess(USBH_HandleTypeDef *phost);
 static USBH_StatusTypeDef USBH_MSC_RdWrProcess(USBH_HandleTypeDef *phost, uint8_t lun);
+static USBH_StatusTypeDef USBH_MSC_RdWrWait(USBH_HandleTypeDef *phost, uint8_t lun, uint32_t timeout);
 
 USBH_ClassTypeDef  USBH_msc =
 {
@@ -663,6 +667,53 @@ static USBH_StatusTypeDef USBH_MSC_RdWrProcess(USBH_HandleTypeDef *phost, uint8_
   return error;
 }
 
+/**
+  * @brief  USBH_MSC_RdWrWait
+  *         The function runs the I/O state machine until the transfer ends.
+  *         With an OS the caller sleeps until an URB changes state instead of
+  *         polling, and a stage that can start right away (CBW, data, CSW) is
+  *         started without sleeping.
+  * @param  phost: Host handle
+  * @param  lun: logical Unit Number
+  * @param  timeout: transfer timeout in ms
+  * @retval USBH Status
+  */
+static USBH_StatusTypeDef USBH_MSC_RdWrWait(USBH_HandleTypeDef *phost, uint8_t lun, uint32_t timeout)
+{
+  uint32_t start = phost->Timer;
+#if (USBH_USE_OS == 1U)
+  MSC_HandleTypeDef *MSC_Handle = (MSC_HandleTypeDef *) phost->pActiveClass->pData;
+  BOT_StateTypeDef bot_state;
+#endif /* (USBH_USE_OS == 1U) */
+
+  for (;;)
+  {
+#if (USBH_USE_OS == 1U)
+    bot_state = MSC_Handle->hbot.state;
+#endif /* (USBH_USE_OS == 1U) */
+
+    if (USBH_MSC_RdWrProcess(phost, lun) != USBH_BUSY)
+    {
+      break;
+    }
+
+    if (((phost->Timer - start) > timeout) || (phost->device.PortEnabled == 0U))
+    {
+      return USBH_FAIL;
+    }
+
+#if (USBH_USE_OS == 1U)
+    /* Still waiting for the same URB */
+    if (MSC_Handle->hbot.state == bot_state)
+    {
+      (void)USBH_LL_WaitURBEvent(phost, USBH_MSC_URB_WAIT_TIMEOUT);
+    }
+#endif /* (USBH_USE_OS == 1U) */
+  }
+
+  return USBH_OK;
+}
+
 /**
   * @brief  USBH_MSC_IsReady
   *         The function check if the MSC function is ready
@@ -772,7 +823,6 @@ USBH_StatusTypeDef USBH_MSC_Read(USBH_HandleTypeDef *phost,
                                  uint8_t *pbuf,
                                  uint32_t length)
 {
-  uint32_t timeout;
   MSC_HandleTypeDef *MSC_Handle = (MSC_HandleTypeDef *) phost->pActiveClass->pData;
 
   /* Store the current lun */
@@ -789,17 +839,7 @@ USBH_StatusTypeDef USBH_MSC_Read(USBH_HandleTypeDef *phost,
 
   (void)USBH_MSC_SCSI_Read(phost, lun, address, pbuf, length);
 
-  timeout = phost->Timer;
-
-  while (USBH_MSC_RdWrProcess(phost, lun) == USBH_BUSY)
-  {
-    if (((phost->Timer - timeout) > (10000U * length)) || (phost->device.PortEnabled == 0U))
-    {
-      return USBH_FAIL;
-    }
-  }
-
-  return USBH_OK;
+  return USBH_MSC_RdWrWait(phost, lun, 10000U * length);
 }
 
 /**
@@ -818,7 +858,6 @@ USBH_StatusTypeDef USBH_MSC_Write(USBH_HandleTypeDef *phost,
                                   uint8_t *pbuf,
                                   uint32_t length)
 {
-  uint32_t timeout;
   MSC_HandleTypeDef *MSC_Handle = (MSC_HandleTypeDef *) phost->pActiveClass->pData;
 
   /* Store the current lun */
@@ -835,16 +874,7 @@ USBH_StatusTypeDef USBH_MSC_Write(USBH_HandleTypeDef *phost,
 
   (void)USBH_MSC_SCSI_Write(phost, lun, address, pbuf, length);
 
-  timeout = phost->Timer;
-  while (USBH_MSC_RdWrProcess(phost, lun) == USBH_BUSY)
-  {
-    if (((phost->Timer - timeout) > (10000U * length)) || (phost->device.PortEnabled == 0U))
-    {
-      return USBH_FAIL;
-    }
-  }
-
-  return USBH_OK;
+  return USBH_MSC_RdWrWait(phost, lun, 10000U * length);
 }
 
 /**
@@ -81,6 +81,8 @@ EndBSPDependencies */
   */
 static USBH_StatusTypeDef USBH_MSC_BOT_Abort(USBH_HandleTypeDef *phost, uint8_t lun, uint8_t dir);
 static BOT_CSWStatusTypeDef USBH_MSC_DecodeCSW(USBH_HandleTypeDef *phost);
+static uint32_t USBH_MSC_BOT_InXferLen(MSC_HandleTypeDef *MSC_Handle);
+static uint32_t USBH_MSC_BOT_OutXferLen(MSC_HandleTypeDef *MSC_Handle);
 /**
   * @}
   */
@@ -176,6 +178,8 @@ USBH_StatusTypeDef USBH_MSC_BOT_Process(USBH_HandleTypeDef *phost, uint8_t lun)
   USBH_URBStateTypeDef URB_Status = USBH_URB_IDLE;
   MSC_HandleTypeDef *MSC_Handle = (MSC_HandleTypeDef *) phost->pActiveClass->pData;
   uint8_t toggle = 0U;
+  uint32_t xfer_len;
+  uint32_t xfer_count;
 
   switch (MSC_Handle->hbot.state)
   {
@@ -241,9 +245,9 @@ USBH_StatusTypeDef USBH_MSC_BOT_Process(USBH_HandleTypeDef *phost, uint8_t lun)
 
     case BOT_DATA_IN:
 
-      /* Send first packet */
+      /* Receive first part */
       (void)USBH_BulkReceiveData(phost, MSC_Handle->hbot.pbuf,
-                                 MSC_Handle->InEpSize, MSC_Handle->InPipe);
+                                 (uint16_t)USBH_MSC_BOT_InXferLen(MSC_Handle), MSC_Handle->InPipe);
 
 #if defined (USBH_IN_NAK_PROCESS) && (USBH_IN_NAK_PROCESS == 1U)
       phost->NakTimer = phost->Timer;
@@ -259,11 +263,14 @@ USBH_StatusTypeDef USBH_MSC_BOT_Process(USBH_HandleTypeDef *phost, uint8_t lun)
 
       if (URB_Status == USBH_URB_DONE)
       {
-        /* Adjust Data pointer and data length */
-        if (MSC_Handle->hbot.cbw.field.DataTransferLength > MSC_Handle->InEpSize)
+        /* Adjust Data pointer and data length, a short packet ends the data stage */
+        xfer_len = USBH_MSC_BOT_InXferLen(MSC_Handle);
+        xfer_count = USBH_LL_GetLastXferSize(phost, MSC_Handle->InPipe);
+
+        if ((MSC_Handle->hbot.cbw.field.DataTransferLength > xfer_count) && (xfer_count >= xfer_len))
         {
-          MSC_Handle->hbot.pbuf += MSC_Handle->InEpSize;
-          MSC_Handle->hbot.cbw.field.DataTransferLength -= MSC_Handle->InEpSize;
+          MSC_Handle->hbot.pbuf += xfer_count;
+          MSC_Handle->hbot.cbw.field.DataTransferLength -= xfer_count;
         }
         else
         {
@@ -273,9 +280,9 @@ USBH_StatusTypeDef USBH_MSC_BOT_Process(USBH_HandleTypeDef *phost, uint8_t lun)
         /* More Data To be Received */
         if (MSC_Handle->hbot.cbw.field.DataTransferLength > 0U)
         {
-          /* Send next packet */
+          /* Receive next part */
           (void)USBH_BulkReceiveData(phost, MSC_Handle->hbot.pbuf,
-                                     MSC_Handle->InEpSize, MSC_Handle->InPipe);
+                                     (uint16_t)USBH_MSC_BOT_InXferLen(MSC_Handle), MSC_Handle->InPipe);
 
 #if defined (USBH_IN_NAK_PROCESS) && (USBH_IN_NAK_PROCESS == 1U)
            phost->NakTimer = phost->Timer;
@@ -331,7 +338,7 @@ USBH_StatusTypeDef USBH_MSC_BOT_Process(USBH_HandleTypeDef *phost, uint8_t lun)
     case BOT_DATA_OUT:
 
       (void)USBH_BulkSendData(phost, MSC_Handle->hbot.pbuf,
-                              MSC_Handle->OutEpSize, MSC_Handle->OutPipe, 1U);
+                              (uint16_t)USBH_MSC_BOT_OutXferLen(MSC_Handle), MSC_Handle->OutPipe, 1U);
 
       MSC_Handle->hbot.state  = BOT_DATA_OUT_WAIT;
       break;
@@ -342,10 +349,12 @@ USBH_StatusTypeDef USBH_MSC_BOT_Process(USBH_HandleTypeDef *phost, uint8_t lun)
       if (URB_Status == USBH_URB_DONE)
       {
         /* Adjust Data pointer and data length */
-        if (MSC_Handle->hbot.cbw.field.DataTransferLength > MSC_Handle->OutEpSize)
+        xfer_len = USBH_MSC_BOT_OutXferLen(MSC_Handle);
+
+        if (MSC_Handle->hbot.cbw.field.DataTransferLength > xfer_len)
         {
-          MSC_Handle->hbot.pbuf += MSC_Handle->OutEpSize;
-          MSC_Handle->hbot.cbw.field.DataTransferLength -= MSC_Handle->OutEpSize;
+          MSC_Handle->hbot.pbuf += xfer_len;
+          MSC_Handle->hbot.cbw.field.DataTransferLength -= xfer_len;
         }
         else
         {
@@ -356,7 +365,7 @@ USBH_StatusTypeDef USBH_MSC_BOT_Process(USBH_HandleTypeDef *phost, uint8_t lun)
         if (MSC_Handle->hbot.cbw.field.DataTransferLength > 0U)
         {
           (void)USBH_BulkSendData(phost, MSC_Handle->hbot.pbuf,
-                                  MSC_Handle->OutEpSize, MSC_Handle->OutPipe, 1U);
+                                  (uint16_t)USBH_MSC_BOT_OutXferLen(MSC_Handle), MSC_Handle->OutPipe, 1U);
         }
         else
         {
@@ -515,6 +524,43 @@ USBH_StatusTypeDef USBH_MSC_BOT_Process(USBH_HandleTypeDef *phost, uint8_t lun)
   return status;
 }
 
+/**
+  * @brief  USBH_MSC_BOT_InXferLen
+  *         The function returns the length of the next IN data URB.
+  * @param  MSC_Handle: MSC handle
+  * @retval Length in bytes, whole packets
+  */
+static uint32_t USBH_MSC_BOT_InXferLen(MSC_HandleTypeDef *MSC_Handle)
+{
+  uint32_t len = MSC_Handle->hbot.cbw.field.DataTransferLength;
+
+  if (len > USBH_MSC_BOT_MAX_IN_XFER)
+  {
+    len = USBH_MSC_BOT_MAX_IN_XFER;
+  }
+
+  /* IN transfer size is a multiple of the max packet size */
+  return ((len + MSC_Handle->InEpSize - 1U) / MSC_Handle->InEpSize) * MSC_Handle->InEpSize;
+}
+
+/**
+  * @brief  USBH_MSC_BOT_OutXferLen
+  *         The function returns the length of the next OUT data URB.
+  * @param  MSC_Handle: MSC handle
+  * @retval Length in bytes
+  */
+static uint32_t USBH_MSC_BOT_OutXferLen(MSC_HandleTypeDef *MSC_Handle)
+{
+  uint32_t len = MSC_Handle->hbot.cbw.field.DataTransferLength;
+
+  if (len > USBH_MSC_BOT_MAX_OUT_XFER)
+  {
+    len = USBH_MSC_BOT_MAX_OUT_XFER;
+  }
+
+  return len;
+}
+
 /**
   * @brief  USBH_MSC_BOT_Abort
   *         The function handle the BOT Abort process.
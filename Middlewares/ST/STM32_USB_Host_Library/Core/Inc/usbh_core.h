@@ -138,6 +138,7 @@ USBH_URBStateTypeDef USBH_LL_GetURBState(USBH_HandleTypeDef *phost, uint8_t pipe
 
 #if (USBH_USE_OS == 1U)
 USBH_StatusTypeDef USBH_LL_NotifyURBChange(USBH_HandleTypeDef *phost);
+USBH_StatusTypeDef USBH_LL_WaitURBEvent(USBH_HandleTypeDef *phost, uint32_t timeout);
 void USBH_OS_PutMessage(USBH_HandleTypeDef *phost, USBH_OSEventTypeDef message, uint32_t timeout, uint32_t priority);
 #endif /*(USBH_USE_OS == 1U) */
 
@@ -491,14 +491,14 @@ osThreadId_t osThreadNew (osThreadFunc_t func, void *argument, const osThreadAtt
 
     if (mem == 1) {
       #if (configSUPPORT_STATIC_ALLOCATION == 1)
-        hTask = xTaskCreateStatic ((TaskFunction_t)func, name, stack, argument, prio, (StackType_t  *)attr->stack_mem,
+        hTask = xTaskCreateStatic ((TaskFunction_t)func, name, stack, argument, (UBaseType_t)configOS2_PRIO_TO_NATIVE(prio), (StackType_t  *)attr->stack_mem,
                                                                                       (StaticTask_t *)attr->cb_mem);
       #endif
     }
     else {
       if (mem == 0) {
         #if (configSUPPORT_DYNAMIC_ALLOCATION == 1)
-          if (xTaskCreate ((TaskFunction_t)func, name, (uint16_t)stack, argument, prio, &hTask) != pdPASS) {
+          if (xTaskCreate ((TaskFunction_t)func, name, (uint16_t)stack, argument, (UBaseType_t)configOS2_PRIO_TO_NATIVE(prio), &hTask) != pdPASS) {
             hTask = NULL;
           }
         #endif
@@ -577,7 +577,7 @@ osStatus_t osThreadSetPriority (osThreadId_t thread_id, osPriority_t priority) {
   }
   else {
     stat = osOK;
-    vTaskPrioritySet (hTask, (UBaseType_t)priority);
+    vTaskPrioritySet (hTask, (UBaseType_t)configOS2_PRIO_TO_NATIVE((UBaseType_t)priority));
   }
 
   return (stat);
@@ -590,7 +590,7 @@ osPriority_t osThreadGetPriority (osThreadId_t thread_id) {
   if (IS_IRQ() || (hTask == NULL)) {
     prio = osPriorityError;
   } else {
-    prio = (osPriority_t)((int32_t)uxTaskPriorityGet (hTask));
+    prio = (osPriority_t)((int32_t)configOS2_PRIO_FROM_NATIVE(uxTaskPriorityGet (hTask)));
   }
 
   return (prio);
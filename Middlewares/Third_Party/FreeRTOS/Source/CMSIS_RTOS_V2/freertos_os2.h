@@ -290,6 +290,19 @@
   #error "Definition configUSE_16_BIT_TICKS must be zero to implement CMSIS-RTOS2 API."
 #endif
 
+#if defined(configOS2_PRIO_TO_NATIVE) && defined(configOS2_PRIO_FROM_NATIVE)
+  /*
+    osPriority_t is converted with configOS2_PRIO_TO_NATIVE() and
+    configOS2_PRIO_FROM_NATIVE(), which must map osPriorityISR below
+    configMAX_PRIORITIES. Then the port optimised task selection may be used.
+  */
+  #if (configOS2_PRIO_TO_NATIVE(56) >= configMAX_PRIORITIES)
+    #error "configOS2_PRIO_TO_NATIVE(osPriorityISR) must be below configMAX_PRIORITIES."
+  #endif
+#else
+  #define configOS2_PRIO_TO_NATIVE(Prio)    (Prio)
+  #define configOS2_PRIO_FROM_NATIVE(Prio)  (Prio)
+
 #if (configMAX_PRIORITIES != 56)
   /*
     CMSIS-RTOS2 defines 56 different priorities (see osPriority_t) and portable CMSIS-RTOS2
@@ -306,5 +319,6 @@
   */
   #error "Definition configUSE_PORT_OPTIMISED_TASK_SELECTION must be zero to implement Thread Management API."
 #endif
+#endif /* configOS2_PRIO_TO_NATIVE */
 
 #endif /* FREERTOS_OS2_H_ */
@@ -50,6 +50,12 @@ Purpose : Config file. Modify to reflect your configuration
   #endif
 #endif
 
+//
+// Cache configuration descriptors of up to 8 devices, so devices behind
+// the external hub re-enumerate without reading their descriptors again.
+//
+#define USBH_ENUM_DESC_CACHE_SIZE   8
+
 
 
 #endif // Avoid multiple inclusion
@@ -198,6 +198,39 @@ void USBH_OS_Unlock(unsigned Idx) {
   OS_MUTEX_Unlock(&_aMutex[Idx]);
 }
 
+/*********************************************************************
+*
+*       USBH_OS_GetLockStat
+*
+*  Function description
+*    Retrieves contention statistics of a stack mutex.
+*    Not maintained by this OS layer.
+*
+*  Parameters
+*    Idx:     Index of the mutex (0 .. USBH_MUTEX_COUNT-1).
+*    pStat:   [OUT] Statistics, cleared.
+*
+*  Return value
+*    == 0:    Success.
+*    != 0:    Statistics not supported.
+*/
+int USBH_OS_GetLockStat(unsigned Idx, USBH_OS_LOCK_STAT * pStat) {
+  USBH_USE_PARA(Idx);
+  USBH_MEMSET(pStat, 0, sizeof(*pStat));
+  return 1;
+}
+
+/*********************************************************************
+*
+*       USBH_OS_ResetLockStat
+*
+*  Function description
+*    Clears the contention statistics of all stack mutexes.
+*    Not maintained by this OS layer.
+*/
+void USBH_OS_ResetLockStat(void) {
+}
+
 /*********************************************************************
 *
 *       USBH_OS_GetTime32
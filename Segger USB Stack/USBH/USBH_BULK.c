@@ -85,6 +85,9 @@ typedef struct {
   U8                        * pInBuffer;
   USBH_BUFFER                 RingBuffer;
   struct _USBH_BULK_INST    * pInst;
+#if USBH_SUPPORT_ISO_TRANSFER
+  USBH_BULK_ISO_STAT          IsoStat;
+#endif
 } BULK_EP_DATA;
 
 typedef struct _USBH_BULK_INST {
@@ -100,6 +103,7 @@ typedef struct _USBH_BULK_INST {
   USBH_BULK_HANDLE            Handle;
   I32                         RefCnt;
   BULK_EP_DATA                Control;
+  USBH_INST_POOL              Pool;                 // Receive buffers of all IN endpoints.
 } USBH_BULK_INST;
 
 typedef struct {
@@ -433,34 +437,49 @@ static void _DecRefCnt(USBH_BULK_INST * pInst
 
 /*********************************************************************
 *
-*       _RemovalTimer
+*       _FreeEndpoints
+*
+*  Function description
+*    Frees the endpoint array and the buffer pool of the instance.
 */
-static void _RemovalTimer(void * pContext) {
-  USBH_BULK_INST * pInst;
+static void _FreeEndpoints(USBH_BULK_INST * pInst) {
   unsigned         i;
   BULK_EP_DATA   * pEP;
 
-  pInst = USBH_CTX2PTR(USBH_BULK_INST, pContext);
-  if (pInst->IsOpened != 0 || pInst->RefCnt != 0) {
-    USBH_StartTimer(&pInst->RemovalTimer, USBH_BULK_REMOVAL_TIMEOUT);
-    return;
-  }
   pEP = pInst->pEndpoints;
   for (i = 0; i < pInst->NumEPs; i++) {
     if (pEP->pEvent != NULL) {
       USBH_OS_FreeEvent(pEP->pEvent);
     }
     if (pEP->RingBuffer.pData != NULL) {
-      USBH_FREE(pEP->RingBuffer.pData);
+      USBH_INST_POOL_Free(&pInst->Pool, pEP->RingBuffer.pData);
     }
     if (pEP->pInBuffer != NULL) {
-      USBH_FREE(pEP->pInBuffer);
+      USBH_INST_POOL_Free(&pInst->Pool, pEP->pInBuffer);
     }
     pEP++;
   }
+  pInst->NumEPs = 0;
   if (pInst->pEndpoints != NULL) {
     USBH_FREE(pInst->pEndpoints);
+    pInst->pEndpoints = NULL;
+  }
+  USBH_INST_POOL_Destroy(&pInst->Pool);
+}
+
+/*********************************************************************
+*
+*       _RemovalTimer
+*/
+static void _RemovalTimer(void * pContext) {
+  USBH_BULK_INST * pInst;
+
+  pInst = USBH_CTX2PTR(USBH_BULK_INST, pContext);
+  if (pInst->IsOpened != 0 || pInst->RefCnt != 0) {
+    USBH_StartTimer(&pInst->RemovalTimer, USBH_BULK_REMOVAL_TIMEOUT);
+    return;
   }
+  _FreeEndpoints(pInst);
   if (pInst->Control.pEvent != NULL) {
     USBH_OS_FreeEvent(pInst->Control.pEvent);
   }
@@ -759,6 +778,7 @@ static void _OnAsyncCompletion(USBH_URB * pUrb) {
 *  Function description
 *    Return array with info's about all endpoints.
 *    The memory is allocated by this function.
+*    Reserves the buffer pool for the receive buffers of all IN endpoints.
 */
 static int _GetEndpointInfo(USBH_BULK_INST * pInst) {
   USBH_EP_MASK        EPMask;
@@ -768,6 +788,7 @@ static int _GetEndpointInfo(USBH_BULK_INST * pInst) {
   unsigned            CurrentAltInt;
   unsigned            NumEPs;
   U16                 MaxPacketSize;
+  U32                 PoolSize;
 
   //
   // Find all endpoints.
@@ -808,6 +829,21 @@ static int _GetEndpointInfo(USBH_BULK_INST * pInst) {
       }
     }
   }
+  //
+  // Each non-isochronous IN endpoint needs a receive buffer and a ring buffer of MaxPacketSize.
+  //
+  PoolSize = 0;
+  pEP      = pInst->pEndpoints;
+  for (NumEPs = pInst->NumEPs; NumEPs > 0u; NumEPs--) {
+    if ((pEP->EPAddr & 0x80u) != 0u && pEP->EPType != USB_EP_TYPE_ISO) {
+      PoolSize += 2u * USBH_INST_POOL_BLOCK_SIZE(pEP->MaxPacketSize);
+    }
+    pEP++;
+  }
+  if (USBH_INST_POOL_Create(&pInst->Pool, PoolSize) != 0) {
+    _FreeEndpoints(pInst);
+    return 1;
+  }
   return 0;
 }
 
@@ -848,6 +884,15 @@ static void _OnIsoCompletion(USBH_URB * pUrb) {
     // A single ISO transfer was finished, return data and transfer status
     //
     pIsoRequest = &pUrb->Request.IsoRequest;
+    pEPData->IsoStat.NumPackets++;
+    pEPData->IsoStat.NumMissedFrames += pIsoRequest->NumMissedFrames;
+    pEPData->IsoStat.LastFrameNumber  = pIsoRequest->FrameNumber;
+    if (pIsoRequest->Status != USBH_STATUS_SUCCESS) {
+      pEPData->IsoStat.NumErrors++;
+    }
+    if (pIsoRequest->NumMissedFrames != 0u) {
+      USBH_LOG((USBH_MCAT_BULK, "ISO EP 0x%x: %u frames missed", pEPData->EPAddr, pIsoRequest->NumMissedFrames));
+    }
     pRWContext->Status = pIsoRequest->Status;
     pRWContext->NumBytesTransferred = pIsoRequest->Length;
     pRWContext->pUserBuffer = (void *)pIsoRequest->pData;     //lint !e9005  D:105[a]
@@ -1326,7 +1371,7 @@ USBH_STATUS USBH_BULK_Read(USBH_BULK_HANDLE hDevice, U8 EPAddr, U8 * pData, U32
     goto ReadEnd;
   }
   if (pEPData->RingBuffer.pData == NULL) {
-    pBuf = (U8 *)USBH_TRY_MALLOC(pEPData->MaxPacketSize);
+    pBuf = (U8 *)USBH_INST_POOL_Alloc(&pInst->Pool, pEPData->MaxPacketSize);
     if (pBuf == NULL) {
       USBH_WARN((USBH_MCAT_BULK, "Buffer allocation failed."));
       Status = USBH_STATUS_MEMORY;
@@ -1335,7 +1380,7 @@ USBH_STATUS USBH_BULK_Read(USBH_BULK_HANDLE hDevice, U8 EPAddr, U8 * pData, U32
     USBH_BUFFER_Init(&pEPData->RingBuffer, pBuf, pEPData->MaxPacketSize);
   }
   if (pEPData->pInBuffer == NULL) {
-    pEPData->pInBuffer = (U8 *)USBH_TRY_MALLOC(pEPData->MaxPacketSize);
+    pEPData->pInBuffer = (U8 *)USBH_INST_POOL_Alloc(&pInst->Pool, pEPData->MaxPacketSize);
     if (pEPData->pInBuffer == NULL) {
       USBH_WARN((USBH_MCAT_BULK, "Buffer allocation failed."));
       Status = USBH_STATUS_MEMORY;
@@ -1792,6 +1837,7 @@ USBH_STATUS USBH_BULK_ReadAsync(USBH_BULK_HANDLE hDevice, U8 EPAddr, void * pBuf
   if (Function == USBH_FUNCTION_ISO_REQUEST) {
     pUrb->Request.IsoRequest.Endpoint     = pEPData->EPAddr;
     pUrb->Header.pfOnCompletion           = _OnIsoCompletion;
+    USBH_MEMSET(&pEPData->IsoStat, 0, sizeof(pEPData->IsoStat));
   } else
 #endif
   {
@@ -1899,6 +1945,7 @@ USBH_STATUS USBH_BULK_WriteAsync(USBH_BULK_HANDLE hDevice, U8 EPAddr, void * pBu
   if (Function == USBH_FUNCTION_ISO_REQUEST) {
     pUrb->Request.IsoRequest.Endpoint     = pEPData->EPAddr;
     pUrb->Header.pfOnCompletion           = _OnIsoCompletion;
+    USBH_MEMSET(&pEPData->IsoStat, 0, sizeof(pEPData->IsoStat));
   } else
 #endif
   {
@@ -1986,6 +2033,57 @@ USBH_STATUS USBH_BULK_IsoDataCtrl(USBH_BULK_HANDLE hDevice, U8 EPAddr, USBH_ISO_
   return USBH_IsoDataCtrl(&pEPData->Urb, pIsoData);
 }
 
+/*********************************************************************
+*
+*       USBH_BULK_GetIsoStat
+*
+*  Function description
+*    Returns statistics of an isochronous endpoint.
+*
+*  Parameters
+*    hDevice       : Handle to an open device returned by USBH_BULK_Open().
+*    EPAddr        : Endpoint address.
+*    pStat         : [OUT] Pointer to a structure that receives the statistics.
+*
+*  Return value
+*    USBH_STATUS_SUCCESS on success or error code on failure.
+*
+*  Additional information
+*    The statistics are reset by USBH_BULK_ReadAsync() and USBH_BULK_WriteAsync().
+*    Missed frames indicate that the application did not acknowledge (IN) or
+*    provide (OUT) packets via USBH_BULK_IsoDataCtrl() fast enough, so the
+*    host controller ran out of packet buffers.
+*/
+USBH_STATUS USBH_BULK_GetIsoStat(USBH_BULK_HANDLE hDevice, U8 EPAddr, USBH_BULK_ISO_STAT * pStat) {
+#if USBH_SUPPORT_ISO_TRANSFER
+  USBH_BULK_INST  * pInst;
+  BULK_EP_DATA    * pEPData;
+  USBH_FUNCTION     Function;
+  USBH_STATUS       Status;
+
+  pInst = _h2p(hDevice);
+  if (pInst == NULL) {
+    return USBH_STATUS_INVALID_HANDLE;
+  }
+  Status = _GetEPData(pInst, EPAddr, &pEPData, &Function);
+  if (Status != USBH_STATUS_SUCCESS) {
+    return Status;
+  }
+  if (pEPData->EPType != USB_EP_TYPE_ISO) {
+    return USBH_STATUS_ENDPOINT_INVALID;
+  }
+  USBH_OS_Lock(USBH_MUTEX_BULK);
+  *pStat = pEPData->IsoStat;
+  USBH_OS_Unlock(USBH_MUTEX_BULK);
+  return USBH_STATUS_SUCCESS;
+#else
+  USBH_USE_PARA(hDevice);
+  USBH_USE_PARA(EPAddr);
+  USBH_USE_PARA(pStat);
+  return USBH_STATUS_ISO_DISABLED;
+#endif
+}
+
 /*********************************************************************
 *
 *       USBH_BULK_GetSerialNumber
@@ -2141,10 +2239,7 @@ USBH_STATUS USBH_BULK_SetAlternateInterface(USBH_BULK_HANDLE hDevice, U8 AltInte
           Status = _SubmitUrbAndWait(pInst, pEPData, USBH_BULK_EP0_TIMEOUT);
           DEC_REF_CNT(pInst);
           if (Status == USBH_STATUS_SUCCESS) {
-            pInst->NumEPs = 0;
-            if (pInst->pEndpoints != NULL) {
-              USBH_FREE(pInst->pEndpoints);
-            }
+            _FreeEndpoints(pInst);
             (void)_GetEndpointInfo(pInst);
           }
         }
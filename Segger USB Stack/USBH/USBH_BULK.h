@@ -73,6 +73,21 @@ typedef struct {
   U16       MaxPacketSize;        // Maximum packet size for the endpoint.
 } USBH_BULK_EP_INFO;
 
+/*********************************************************************
+*
+*       USBH_BULK_ISO_STAT
+*
+*  Description
+*    Statistics of an isochronous endpoint since the last call to
+*    USBH_BULK_ReadAsync() or USBH_BULK_WriteAsync().
+*/
+typedef struct {
+  U32       NumPackets;           // Number of packets transferred.
+  U32       NumErrors;            // Number of packets with an error status.
+  U32       NumMissedFrames;      // Number of (micro)frames in which no packet was transferred.
+  U16       LastFrameNumber;      // Frame number of the last packet.
+} USBH_BULK_ISO_STAT;
+
 /*********************************************************************
 *
 *       USBH_BULK_DEVICE_INFO
@@ -164,6 +179,7 @@ USBH_STATUS       USBH_BULK_Cancel                  (USBH_BULK_HANDLE hDevice, U
 USBH_STATUS       USBH_BULK_SetupRequest            (USBH_BULK_HANDLE hDevice, U8 RequestType, U8 Request, U16 wValue, U16 wIndex, void * pData, U32 * pNumBytesData, U32 Timeout);
 USBH_STATUS       USBH_BULK_SetAlternateInterface   (USBH_BULK_HANDLE hDevice, U8 AltInterfaceSetting);
 USBH_STATUS       USBH_BULK_IsoDataCtrl             (USBH_BULK_HANDLE hDevice, U8 EPAddr, USBH_ISO_DATA_CTRL *pIsoData);
+USBH_STATUS       USBH_BULK_GetIsoStat              (USBH_BULK_HANDLE hDevice, U8 EPAddr, USBH_BULK_ISO_STAT * pStat);
 
 #if defined(__cplusplus)
   }
@@ -64,6 +64,10 @@ Purpose     : API of the USB host stack
 
 #define USBH_CDC_SERIAL_STATE_SIZE                     0x0Au // Size of CDC serial state is always ten bytes long
 
+#ifndef   USBH_CDC_STREAM_BUFFER_ALIGNMENT
+  #define USBH_CDC_STREAM_BUFFER_ALIGNMENT             32u   // Alignment of the stream buffer, should be a multiple of the cache line size.
+#endif
+
 #if USBH_REF_TRACE
   #define DEC_REF_CNT(pInst)        _DecRefCnt(pInst, __func__, __LINE__)
   #define INC_REF_CNT(pInst)        _IncRefCnt(pInst, __func__, __LINE__)
@@ -101,6 +105,26 @@ typedef struct {
   USBH_INTERFACE_HANDLE hInterface;
 } CDC_EP_DATA;
 
+typedef struct {
+  U8                             * pBuffer;          // Stream buffer, divided into NumSegments segments of SegmentSize bytes.
+  U32                            * paNumBytes;       // Number of bytes received into each segment.
+  U32                              NumSegments;
+  U32                              SegmentSize;
+  U32                              RdSeg;            // Index of the segment data is read from.
+  U32                              RdOff;            // Read offset in RdSeg.
+  U32                              NumSegsFull;      // Number of segments containing unread data, starting at RdSeg.
+  U32                              NumBytesIn;       // Number of unread bytes in all segments.
+  U32                              HighWatermark;
+  U32                              LowWatermark;
+  USBH_CDC_STREAM_CALLBACK       * pfOnEvent;
+  void                           * pUserContext;
+  USBH_CDC_STREAM_STAT             Stat;
+  U8                               IsActive;
+  U8                               UrbPending;       // IN transfer into the segment following the last full one is queued.
+  U8                               AboveHigh;        // High watermark reached, low watermark not yet.
+  U8                               IsFull;           // Overrun has been reported, cleared when a segment is freed.
+} CDC_STREAM;
+
 typedef struct _USBH_CDC_INST {
   struct _USBH_CDC_INST          * pNext;
   USBH_CDC_STATE                   RunningState;
@@ -136,6 +160,8 @@ typedef struct _USBH_CDC_INST {
   void                           * pOnSerialStateUContext;
   unsigned                         EnableDataAltSet;
   unsigned                         DisableDataAltSet;
+  CDC_STREAM                       Stream;
+  USBH_INST_POOL                   Pool;             // Bulk IN, ring and interrupt IN buffers.
 } USBH_CDC_INST;
 
 typedef struct {
@@ -158,6 +184,7 @@ typedef struct {
 **********************************************************************
 */
 static void _SubmitIntTransfer(USBH_CDC_INST * pInst, U8 * pBuffer, U32 NumBytes);
+static void _StreamSubmit(USBH_CDC_INST * pInst);
 
 /*********************************************************************
 *
@@ -396,17 +423,26 @@ static void _RemoveDevInstance(USBH_CDC_INST * pInst) {
   //  Free all associated EP buffers
   //
   if (pInst->pBulkInBuffer != NULL) {
-    USBH_FREE(pInst->pBulkInBuffer);
+    USBH_INST_POOL_Free(&pInst->Pool, pInst->pBulkInBuffer);
     pInst->pBulkInBuffer = (U8 *)NULL;
   }
   if (pInst->pIntInBuffer != NULL) {
-    USBH_FREE(pInst->pIntInBuffer);
+    USBH_INST_POOL_Free(&pInst->Pool, pInst->pIntInBuffer);
     pInst->pIntInBuffer = (U8 *)NULL;
   }
   if (pInst->RxRingBuffer.pData != NULL) {
-    USBH_FREE(pInst->RxRingBuffer.pData);
+    USBH_INST_POOL_Free(&pInst->Pool, pInst->RxRingBuffer.pData);
     pInst->RxRingBuffer.pData = (U8 *)NULL;
   }
+  USBH_INST_POOL_Destroy(&pInst->Pool);
+  if (pInst->Stream.pBuffer != NULL) {
+    USBH_FREE(pInst->Stream.pBuffer);
+    pInst->Stream.pBuffer = (U8 *)NULL;
+  }
+  if (pInst->Stream.paNumBytes != NULL) {
+    USBH_FREE(pInst->Stream.paNumBytes);
+    pInst->Stream.paNumBytes = (U32 *)NULL;
+  }
   //
   // Remove instance from list
   //
@@ -1041,6 +1077,48 @@ static void _GetValidAlternateSetting(const USBH_CDC_INST * pInst, unsigned * pE
   *pDisableDataAltSet = DisableAltSet;
 }
 
+/*********************************************************************
+*
+*       _ReserveBufferPool
+*
+*  Function description
+*    Reserves the buffer pool of the instance. It holds the bulk IN buffer,
+*    the receive ring buffer and the interrupt IN buffer.
+*
+*  Parameters
+*    pInst  : Pointer to the CDC device instance.
+*
+*  Return value
+*    USBH_STATUS_SUCCESS on success or error code on failure.
+*/
+static USBH_STATUS _ReserveBufferPool(USBH_CDC_INST * pInst) {
+  USBH_EP_MASK EPMask;
+  unsigned int Length;
+  U8           aEpDesc[USB_ENDPOINT_DESCRIPTOR_LENGTH];
+  U32          NumBytes;
+
+  NumBytes = 0;
+  USBH_MEMSET(&EPMask,  0, sizeof(USBH_EP_MASK));
+  EPMask.Mask      = USBH_EP_MASK_TYPE | USBH_EP_MASK_DIRECTION;
+  EPMask.Direction = USB_IN_DIRECTION;
+  EPMask.Type      = USB_EP_TYPE_BULK;
+  Length           = sizeof(aEpDesc);
+  if (USBH_GetEndpointDescriptor(pInst->hDATAInterface, pInst->EnableDataAltSet, &EPMask, aEpDesc, &Length) == USBH_STATUS_SUCCESS) {
+    NumBytes += 2u * USBH_INST_POOL_BLOCK_SIZE(USBH_LoadU16LE(&aEpDesc[USB_EP_DESC_PACKET_SIZE_OFS]));
+  }
+  if ((pInst->Flags & USBH_CDC_IGNORE_INT_EP) == 0u) {
+    EPMask.Type = USB_EP_TYPE_INT;
+    Length      = sizeof(aEpDesc);
+    if (USBH_GetEndpointDescriptor(pInst->hControlInterface, 0, &EPMask, aEpDesc, &Length) == USBH_STATUS_SUCCESS) {
+      NumBytes += USBH_INST_POOL_BLOCK_SIZE(USBH_LoadU16LE(&aEpDesc[USB_EP_DESC_PACKET_SIZE_OFS]));
+    }
+  }
+  if (USBH_INST_POOL_Create(&pInst->Pool, NumBytes) != 0) {
+    return USBH_STATUS_MEMORY;
+  }
+  return USBH_STATUS_SUCCESS;
+}
+
 /*********************************************************************
 *
 *       _StartDevice
@@ -1111,6 +1189,11 @@ static USBH_STATUS _StartDevice(USBH_CDC_INST * pInst) {
     USBH_LOG((USBH_MCAT_CDC, "Address   MaxPacketSize"));
     USBH_LOG((USBH_MCAT_CDC, "0x%02X      %5d      ", pInst->BulkOut.EPAddr, pInst->BulkOut.MaxPacketSize));
   }
+  Status = _ReserveBufferPool(pInst);
+  if (Status != USBH_STATUS_SUCCESS) {
+    USBH_WARN((USBH_MCAT_CDC, "_StartDevice: Could not reserve buffer pool"));
+    goto Err;
+  }
   //
   // Now try to get the BULK EP IN descriptor
   //
@@ -1127,13 +1210,13 @@ static USBH_STATUS _StartDevice(USBH_CDC_INST * pInst) {
     pInst->BulkIn.EPAddr        = aEpDesc[USB_EP_DESC_ADDRESS_OFS];
     pInst->BulkIn.MaxPacketSize = aEpDesc[USB_EP_DESC_PACKET_SIZE_OFS] + ((U16)aEpDesc[USB_EP_DESC_PACKET_SIZE_OFS + 1u] << 8);
     pInst->BulkIn.pEvent        = USBH_OS_AllocEvent();
-    pInst->pBulkInBuffer        = (U8 *)USBH_TRY_MALLOC(pInst->BulkIn.MaxPacketSize);
+    pInst->pBulkInBuffer        = (U8 *)USBH_INST_POOL_Alloc(&pInst->Pool, pInst->BulkIn.MaxPacketSize);
     if (pInst->pBulkInBuffer == NULL) {
       USBH_WARN((USBH_MCAT_CDC, "Buffer allocation failed."));
       Status = USBH_STATUS_MEMORY;
       goto Err;
     }
-    pInst->RxRingBuffer.pData   = (U8 *)USBH_TRY_MALLOC(pInst->BulkIn.MaxPacketSize);
+    pInst->RxRingBuffer.pData   = (U8 *)USBH_INST_POOL_Alloc(&pInst->Pool, pInst->BulkIn.MaxPacketSize);
     if (pInst->RxRingBuffer.pData == NULL) {
       USBH_WARN((USBH_MCAT_CDC, "Buffer allocation failed."));
       Status = USBH_STATUS_MEMORY;
@@ -1187,7 +1270,7 @@ static USBH_STATUS _StartDevice(USBH_CDC_INST * pInst) {
         Status = USBH_STATUS_RESOURCES;
         goto Err;
       }
-      pInst->pIntInBuffer = (U8 *)USBH_TRY_MALLOC(pInst->IntIn.MaxPacketSize);
+      pInst->pIntInBuffer = (U8 *)USBH_INST_POOL_Alloc(&pInst->Pool, pInst->IntIn.MaxPacketSize);
       if (pInst->pIntInBuffer == NULL) {
         USBH_WARN((USBH_MCAT_CDC, "Buffer allocation failed."));
         Status = USBH_STATUS_MEMORY;
@@ -1315,7 +1398,16 @@ static void _DATA_OnDeviceNotification(void * pContext, USBH_PNP_EVENT Event, US
           }
           pHook = pHook->pNext;
         }
-        _StopDevice(pInst);
+        if (pInst->RunningState == StateError) {
+          //
+          // _OnIntInCompletion() already released the reference of the running device
+          // (e.g. the interrupt endpoint failed while the device was unplugged).
+          // Release the reference of the data interface, otherwise the instance is never freed.
+          //
+          (void)DEC_REF_CNT(pInst);
+        } else {
+          _StopDevice(pInst);
+        }
         return; // Stop processing the list as pInst may have been freed.
       }
       pInst = pInst->pNext;
@@ -1492,6 +1584,198 @@ static void _OnAsyncCompletion(USBH_URB * pUrb) {
   pfOnComplete(pRWContext);
 }
 
+/*********************************************************************
+*
+*       _StreamNotify
+*
+*  Function description
+*    Calls the user callback for a streaming event.
+*    CDC mutex must not be locked.
+*/
+static void _StreamNotify(const USBH_CDC_INST * pInst, unsigned Event, U32 NumBytesIn) {
+  USBH_CDC_STREAM_CALLBACK * pfOnEvent;
+
+  pfOnEvent = pInst->Stream.pfOnEvent;
+  if (pfOnEvent != NULL) {
+    pfOnEvent(pInst->Handle, Event, NumBytesIn, pInst->Stream.pUserContext);
+  }
+}
+
+/*********************************************************************
+*
+*       _OnStreamCompletion
+*
+*  Function description
+*    Is called when an IN transfer of the streaming mode is completed.
+*    Marks the segment as full and queues the next IN transfer right away,
+*    so that the device is polled without a gap as long as a free segment exists.
+*/
+static void _OnStreamCompletion(USBH_URB * pUrb) USBH_CALLBACK_USE {
+  USBH_CDC_INST * pInst;
+  CDC_STREAM    * pStream;
+  USBH_STATUS     Status;
+  U32             NumBytes;
+  U32             NumBytesIn;
+  U32             Seg;
+  int             ReportHigh;
+  int             IsActive;
+
+  pInst      = USBH_CTX2PTR(USBH_CDC_INST, pUrb->Header.pContext);
+  pStream    = &pInst->Stream;
+  Status     = pUrb->Header.Status;
+  NumBytes   = pUrb->Request.BulkIntRequest.Length;
+  ReportHigh = 0;
+  USBH_OS_Lock(USBH_MUTEX_CDC);
+  pStream->UrbPending = 0;
+  IsActive            = (int)pStream->IsActive;
+  if (Status == USBH_STATUS_SUCCESS) {
+    pStream->Stat.NumTransfers++;
+    if (NumBytes != 0u) {
+      Seg = (pStream->RdSeg + pStream->NumSegsFull) % pStream->NumSegments;
+      pStream->paNumBytes[Seg] = NumBytes;
+      pStream->NumSegsFull++;
+      pStream->NumBytesIn            += NumBytes;
+      pStream->Stat.NumBytesReceived += NumBytes;
+      if (pStream->NumBytesIn > pStream->Stat.MaxNumBytesIn) {
+        pStream->Stat.MaxNumBytesIn = pStream->NumBytesIn;
+      }
+      if ((pStream->HighWatermark != 0u) && (pStream->AboveHigh == 0u) && (pStream->NumBytesIn >= pStream->HighWatermark)) {
+        pStream->AboveHigh = 1;
+        ReportHigh         = 1;
+      }
+    }
+  } else {
+    pStream->Stat.NumErrors++;
+    pStream->IsActive = 0;
+  }
+  NumBytesIn = pStream->NumBytesIn;
+  if (IsActive == 0) {
+    USBH_OS_SetEvent(pInst->BulkIn.pEvent);       // USBH_CDC_StreamStop() waits for the transfer to terminate.
+  }
+  USBH_OS_Unlock(USBH_MUTEX_CDC);
+  if (IsActive != 0) {
+    if (Status == USBH_STATUS_SUCCESS) {
+      _StreamSubmit(pInst);
+      if (ReportHigh != 0) {
+        _StreamNotify(pInst, USBH_CDC_STREAM_EVENT_HIGH_WATERMARK, NumBytesIn);
+      }
+    } else {
+      USBH_WARN((USBH_MCAT_CDC, "Streaming IN transfer failed, Status = %s", USBH_GetStatusStr(Status)));
+      _StreamNotify(pInst, USBH_CDC_STREAM_EVENT_ERROR, NumBytesIn);
+    }
+  }
+  (void)DEC_REF_CNT(pInst);
+}
+
+/*********************************************************************
+*
+*       _StreamSubmit
+*
+*  Function description
+*    Queues an IN transfer into the next free segment of the stream buffer.
+*    Does nothing if a transfer is already queued. If no free segment
+*    is available an overrun is reported once until a segment is freed.
+*/
+static void _StreamSubmit(USBH_CDC_INST * pInst) {
+  CDC_STREAM  * pStream;
+  USBH_URB    * pUrb;
+  USBH_STATUS   Status;
+  U32           Seg;
+  U32           NumBytesIn;
+  int           DoSubmit;
+  int           ReportOverrun;
+
+  pStream       = &pInst->Stream;
+  pUrb          = &pInst->BulkIn.Urb;
+  DoSubmit      = 0;
+  ReportOverrun = 0;
+  USBH_OS_Lock(USBH_MUTEX_CDC);
+  if ((pStream->IsActive != 0u) && (pStream->UrbPending == 0u) && (pInst->RunningState == StateRunning)) {
+    if (pStream->NumSegsFull < pStream->NumSegments) {
+      Seg = (pStream->RdSeg + pStream->NumSegsFull) % pStream->NumSegments;
+      USBH_MEMSET(pUrb, 0, sizeof(USBH_URB));
+      pUrb->Header.Function                 = USBH_FUNCTION_BULK_REQUEST;
+      pUrb->Header.pfOnCompletion           = _OnStreamCompletion;
+      pUrb->Header.pContext                 = pInst;
+      pUrb->Request.BulkIntRequest.Endpoint = pInst->BulkIn.EPAddr;
+      pUrb->Request.BulkIntRequest.pBuffer  = pStream->pBuffer + Seg * pStream->SegmentSize;
+      pUrb->Request.BulkIntRequest.Length   = pStream->SegmentSize;
+      pStream->UrbPending = 1;
+      DoSubmit            = 1;
+    } else if (pStream->IsFull == 0u) {
+      pStream->IsFull = 1;
+      pStream->Stat.NumOverruns++;
+      ReportOverrun   = 1;
+    } else {
+      // Overrun already reported.
+    }
+  }
+  NumBytesIn = pStream->NumBytesIn;
+  USBH_OS_Unlock(USBH_MUTEX_CDC);
+  if (DoSubmit != 0) {
+    Status = INC_REF_CNT(pInst);
+    if (Status == USBH_STATUS_SUCCESS) {
+      Status = USBH_SubmitUrb(pInst->hDATAInterface, pUrb);
+      if (Status != USBH_STATUS_PENDING) {
+        (void)DEC_REF_CNT(pInst);
+      }
+    }
+    if (Status != USBH_STATUS_PENDING) {
+      USBH_WARN((USBH_MCAT_CDC, "_StreamSubmit: USBH_SubmitUrb st: %s", USBH_GetStatusStr(Status)));
+      USBH_OS_Lock(USBH_MUTEX_CDC);
+      pStream->UrbPending = 0;
+      pStream->IsActive   = 0;
+      pStream->Stat.NumErrors++;
+      USBH_OS_Unlock(USBH_MUTEX_CDC);
+      _StreamNotify(pInst, USBH_CDC_STREAM_EVENT_ERROR, NumBytesIn);
+    }
+  }
+  if (ReportOverrun != 0) {
+    _StreamNotify(pInst, USBH_CDC_STREAM_EVENT_OVERRUN, NumBytesIn);
+  }
+}
+
+/*********************************************************************
+*
+*       _StreamStop
+*
+*  Function description
+*    Stops the streaming mode, waits for the queued IN transfer
+*    to terminate and frees the stream buffer.
+*/
+static void _StreamStop(USBH_CDC_INST * pInst) {
+  CDC_STREAM * pStream;
+  int          UrbPending;
+
+  pStream = &pInst->Stream;
+  if (pStream->pBuffer == NULL) {
+    return;                                         // Streaming not started.
+  }
+  USBH_OS_Lock(USBH_MUTEX_CDC);
+  pStream->IsActive = 0;
+  UrbPending        = (int)pStream->UrbPending;
+  USBH_OS_ResetEvent(pInst->BulkIn.pEvent);
+  USBH_OS_Unlock(USBH_MUTEX_CDC);
+  if (UrbPending != 0) {
+    if (_AbortEP(&pInst->BulkIn) == USBH_STATUS_SUCCESS) {
+      USBH_OS_WaitEvent(pInst->BulkIn.pEvent);
+    } else {
+      //
+      // Abort not possible (device removed), the transfer is terminated by the driver.
+      //
+      (void)USBH_OS_WaitEventTimed(pInst->BulkIn.pEvent, USBH_CDC_DEFAULT_TIMEOUT);
+    }
+  }
+  if (pStream->UrbPending != 0u) {
+    USBH_WARN((USBH_MCAT_CDC, "_StreamStop: IN transfer did not terminate, stream buffer is not freed"));
+    return;
+  }
+  USBH_FREE(pStream->pBuffer);
+  USBH_FREE(pStream->paNumBytes);
+  USBH_MEMSET(pStream, 0, sizeof(CDC_STREAM));
+  pInst->BulkIn.InUse = FALSE;
+}
+
 /*********************************************************************
 *
 *       Public code
@@ -1681,6 +1965,7 @@ USBH_STATUS USBH_CDC_Close(USBH_CDC_HANDLE hDevice) {
       //
       // Last handle closed, reset settings.
       //
+      _StreamStop(pInst);
       pInst->ReadTimeOut           = USBH_CDC_Global.DefaultReadTimeOut;
       pInst->WriteTimeOut          = USBH_CDC_Global.DefaultWriteTimeOut;
       pInst->AllowShortRead        = 0;
@@ -3406,4 +3691,270 @@ USBH_STATUS USBH_CDC_GetMaxTransferSize(USBH_CDC_HANDLE hDevice, U32 * pMaxOutTr
   return Status;
 }
 
+/*********************************************************************
+*
+*       USBH_CDC_StreamStart
+*
+*  Function description
+*    Starts the streaming mode. In streaming mode the bulk IN endpoint of the
+*    device is read continuously into a stream buffer in the background,
+*    independent of the application reading the data.
+*
+*  Parameters
+*    hDevice    : Handle to an open device returned by USBH_CDC_Open().
+*    pConfig    : Pointer to the streaming configuration.
+*
+*  Return value
+*    USBH_STATUS_SUCCESS on success or error code on failure.
+*
+*  Additional information
+*    The stream buffer consists of pConfig->NumSegments segments.
+*    Each IN transfer receives directly into a free segment. As soon as a
+*    transfer is completed the next one is queued by the completion routine,
+*    so no IN token is missed while the application processes data.
+*    When all segments contain unread data no transfer is queued and
+*    the device is NAKed until a segment is freed via USBH_CDC_StreamCommit().
+*    This is counted as an overrun.
+*
+*    Received data is accessed without copying through USBH_CDC_StreamPeek()
+*    and USBH_CDC_StreamCommit(). USBH_CDC_Read() and USBH_CDC_ReadAsync()
+*    return USBH_STATUS_BUSY while the streaming mode is active.
+*/
+USBH_STATUS USBH_CDC_StreamStart(USBH_CDC_HANDLE hDevice, const USBH_CDC_STREAM_CONFIG * pConfig) {
+  USBH_CDC_INST  * pInst;
+  CDC_STREAM     * pStream;
+  CDC_EP_DATA    * pEPData;
+  U32              SegmentSize;
+
+  USBH_ASSERT_PTR(pConfig);
+  pInst = _h2p(hDevice);
+  if (pInst == NULL) {
+    return USBH_STATUS_INVALID_HANDLE;
+  }
+  if (pInst->IsOpened == 0) {
+    return USBH_STATUS_NOT_OPENED;
+  }
+  pEPData     = &pInst->BulkIn;
+  SegmentSize = pConfig->SegmentSize;
+  if ((pConfig->NumSegments < 2u) || (SegmentSize == 0u) || ((SegmentSize % pEPData->MaxPacketSize) != 0u)) {
+    USBH_WARN((USBH_MCAT_CDC, "USBH_CDC_StreamStart: Invalid segment configuration (%u x %u)", pConfig->NumSegments, SegmentSize));
+    return USBH_STATUS_INVALID_PARAM;
+  }
+  if (SegmentSize > pInst->MaxInTransferSize) {
+    USBH_WARN((USBH_MCAT_CDC, "USBH_CDC_StreamStart: SegmentSize (%u) too large, max possible is %u", SegmentSize, pInst->MaxInTransferSize));
+    return USBH_STATUS_XFER_SIZE;
+  }
+  if (pEPData->InUse != FALSE) {
+    return USBH_STATUS_BUSY;
+  }
+  pEPData->InUse = TRUE;
+  pStream = &pInst->Stream;
+  USBH_MEMSET(pStream, 0, sizeof(CDC_STREAM));
+  pStream->pBuffer    = (U8 *)USBH_TRY_MALLOC_XFERMEM(pConfig->NumSegments * SegmentSize, USBH_CDC_STREAM_BUFFER_ALIGNMENT);
+  pStream->paNumBytes = (U32 *)USBH_TRY_MALLOC(pConfig->NumSegments * sizeof(U32));
+  if ((pStream->pBuffer == NULL) || (pStream->paNumBytes == NULL)) {
+    USBH_WARN((USBH_MCAT_CDC, "USBH_CDC_StreamStart: Buffer allocation failed."));
+    if (pStream->pBuffer != NULL) {
+      USBH_FREE(pStream->pBuffer);
+    }
+    if (pStream->paNumBytes != NULL) {
+      USBH_FREE(pStream->paNumBytes);
+    }
+    USBH_MEMSET(pStream, 0, sizeof(CDC_STREAM));
+    pEPData->InUse = FALSE;
+    return USBH_STATUS_MEMORY;
+  }
+  pStream->NumSegments   = pConfig->NumSegments;
+  pStream->SegmentSize   = SegmentSize;
+  pStream->HighWatermark = pConfig->HighWatermark;
+  pStream->LowWatermark  = pConfig->LowWatermark;
+  pStream->pfOnEvent     = pConfig->pfOnEvent;
+  pStream->pUserContext  = pConfig->pUserContext;
+  pStream->IsActive      = 1;
+  _StreamSubmit(pInst);
+  if (pStream->IsActive == 0u) {
+    _StreamStop(pInst);
+    return USBH_STATUS_ERROR;
+  }
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       USBH_CDC_StreamStop
+*
+*  Function description
+*    Stops the streaming mode and frees the stream buffer.
+*
+*  Parameters
+*    hDevice    : Handle to an open device returned by USBH_CDC_Open().
+*
+*  Return value
+*    USBH_STATUS_SUCCESS on success or error code on failure.
+*
+*  Additional information
+*    Data in the stream buffer that has not been read is discarded.
+*    Must not be called from the stream callback.
+*    The streaming mode is also stopped when the last handle
+*    to the device is closed.
+*/
+USBH_STATUS USBH_CDC_StreamStop(USBH_CDC_HANDLE hDevice) {
+  USBH_CDC_INST * pInst;
+
+  pInst = _h2p(hDevice);
+  if (pInst == NULL) {
+    return USBH_STATUS_INVALID_HANDLE;
+  }
+  if (pInst->IsOpened == 0) {
+    return USBH_STATUS_NOT_OPENED;
+  }
+  _StreamStop(pInst);
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       USBH_CDC_StreamPeek
+*
+*  Function description
+*    Returns a pointer to the oldest unread data in the stream buffer.
+*
+*  Parameters
+*    hDevice    : Handle to an open device returned by USBH_CDC_Open().
+*    ppData     : [OUT] Pointer to the unread data.
+*    pNumBytes  : [OUT] Number of contiguous bytes available at *ppData.
+*
+*  Return value
+*    USBH_STATUS_SUCCESS on success or error code on failure.
+*
+*  Additional information
+*    The data remains in the stream buffer until it is released via
+*    USBH_CDC_StreamCommit(). The number of bytes returned is limited to
+*    the data of one segment, further data is returned by the next call
+*    after the data has been committed.
+*    If the device was removed data that already has been received can still be read.
+*/
+USBH_STATUS USBH_CDC_StreamPeek(USBH_CDC_HANDLE hDevice, U8 ** ppData, U32 * pNumBytes) {
+  USBH_CDC_INST * pInst;
+  CDC_STREAM    * pStream;
+
+  USBH_ASSERT_PTR(ppData);
+  USBH_ASSERT_PTR(pNumBytes);
+  *ppData    = NULL;
+  *pNumBytes = 0;
+  pInst = _h2p(hDevice);
+  if (pInst == NULL) {
+    return USBH_STATUS_INVALID_HANDLE;
+  }
+  pStream = &pInst->Stream;
+  if (pStream->pBuffer == NULL) {
+    return USBH_STATUS_ERROR;                       // Streaming mode not started.
+  }
+  USBH_OS_Lock(USBH_MUTEX_CDC);
+  if (pStream->NumSegsFull != 0u) {
+    *ppData    = pStream->pBuffer + pStream->RdSeg * pStream->SegmentSize + pStream->RdOff;
+    *pNumBytes = pStream->paNumBytes[pStream->RdSeg] - pStream->RdOff;
+  }
+  USBH_OS_Unlock(USBH_MUTEX_CDC);
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       USBH_CDC_StreamCommit
+*
+*  Function description
+*    Releases data returned by USBH_CDC_StreamPeek().
+*
+*  Parameters
+*    hDevice    : Handle to an open device returned by USBH_CDC_Open().
+*    NumBytes   : Number of bytes to release. Must not exceed the
+*                 number of bytes returned by USBH_CDC_StreamPeek().
+*
+*  Return value
+*    USBH_STATUS_SUCCESS on success or error code on failure.
+*
+*  Additional information
+*    When a segment is completely released it is reused for receiving.
+*    If the stream buffer was full the next IN transfer is queued.
+*/
+USBH_STATUS USBH_CDC_StreamCommit(USBH_CDC_HANDLE hDevice, U32 NumBytes) {
+  USBH_CDC_INST * pInst;
+  CDC_STREAM    * pStream;
+  USBH_STATUS     Status;
+  U32             NumBytesIn;
+  int             SegFreed;
+  int             ReportLow;
+
+  pInst = _h2p(hDevice);
+  if (pInst == NULL) {
+    return USBH_STATUS_INVALID_HANDLE;
+  }
+  pStream = &pInst->Stream;
+  if (pStream->pBuffer == NULL) {
+    return USBH_STATUS_ERROR;                       // Streaming mode not started.
+  }
+  Status    = USBH_STATUS_SUCCESS;
+  SegFreed  = 0;
+  ReportLow = 0;
+  USBH_OS_Lock(USBH_MUTEX_CDC);
+  if ((pStream->NumSegsFull == 0u) || (NumBytes > pStream->paNumBytes[pStream->RdSeg] - pStream->RdOff)) {
+    Status = USBH_STATUS_INVALID_PARAM;
+  } else {
+    pStream->RdOff      += NumBytes;
+    pStream->NumBytesIn -= NumBytes;
+    if (pStream->RdOff == pStream->paNumBytes[pStream->RdSeg]) {
+      pStream->RdOff = 0;
+      pStream->RdSeg = (pStream->RdSeg + 1u) % pStream->NumSegments;
+      pStream->NumSegsFull--;
+      pStream->IsFull = 0;
+      SegFreed        = 1;
+    }
+    if ((pStream->AboveHigh != 0u) && (pStream->NumBytesIn <= pStream->LowWatermark)) {
+      pStream->AboveHigh = 0;
+      ReportLow          = 1;
+    }
+  }
+  NumBytesIn = pStream->NumBytesIn;
+  USBH_OS_Unlock(USBH_MUTEX_CDC);
+  if (SegFreed != 0) {
+    _StreamSubmit(pInst);
+  }
+  if (ReportLow != 0) {
+    _StreamNotify(pInst, USBH_CDC_STREAM_EVENT_LOW_WATERMARK, NumBytesIn);
+  }
+  return Status;
+}
+
+/*********************************************************************
+*
+*       USBH_CDC_StreamGetStat
+*
+*  Function description
+*    Returns the statistic counters of the streaming mode.
+*
+*  Parameters
+*    hDevice    : Handle to an open device returned by USBH_CDC_Open().
+*    pStat      : [OUT] Statistic counters.
+*
+*  Return value
+*    USBH_STATUS_SUCCESS on success or error code on failure.
+*
+*  Additional information
+*    The counters are reset when the streaming mode is started.
+*/
+USBH_STATUS USBH_CDC_StreamGetStat(USBH_CDC_HANDLE hDevice, USBH_CDC_STREAM_STAT * pStat) {
+  USBH_CDC_INST * pInst;
+
+  USBH_ASSERT_PTR(pStat);
+  pInst = _h2p(hDevice);
+  if (pInst == NULL) {
+    return USBH_STATUS_INVALID_HANDLE;
+  }
+  USBH_OS_Lock(USBH_MUTEX_CDC);
+  *pStat = pInst->Stream.Stat;
+  USBH_OS_Unlock(USBH_MUTEX_CDC);
+  return USBH_STATUS_SUCCESS;
+}
+
 /*************************** End of file ****************************/
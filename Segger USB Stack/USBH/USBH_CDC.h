@@ -262,6 +262,71 @@ typedef void USBH_CDC_SERIAL_STATE_CALLBACK(USBH_CDC_HANDLE hDevice, USBH_CDC_SE
 */
 typedef void USBH_CDC_INT_STATE_CALLBACK(USBH_CDC_HANDLE hDevice, const U8 * pData, U32 Numbytes, void * pUserContext);
 
+/*********************************************************************
+*
+*       Streaming events
+*
+*  Description
+*    Events reported to the USBH_CDC_STREAM_CALLBACK function.
+*/
+#define USBH_CDC_STREAM_EVENT_HIGH_WATERMARK   0u   // Number of bytes in the stream buffer reached the high watermark.
+#define USBH_CDC_STREAM_EVENT_LOW_WATERMARK    1u   // Number of bytes in the stream buffer dropped to the low watermark.
+#define USBH_CDC_STREAM_EVENT_OVERRUN          2u   // Stream buffer is full, no IN transfer can be queued.
+#define USBH_CDC_STREAM_EVENT_ERROR            3u   // IN transfer failed, streaming has been halted.
+
+/*********************************************************************
+*
+*       USBH_CDC_STREAM_CALLBACK
+*
+*  Description
+*    Function called on streaming events.
+*    Used by the function USBH_CDC_StreamStart().
+*
+*  Parameters
+*    hDevice      : Handle to an open device returned by USBH_CDC_Open().
+*    Event        : One of the USBH_CDC_STREAM_EVENT_... values.
+*    NumBytesIn   : Number of bytes stored in the stream buffer.
+*    pUserContext : Pointer to the user-provided user context.
+*
+*  Additional information
+*    The function is called from the context of the USBH task.
+*    It must not block and must not call USBH_CDC_StreamStop().
+*/
+typedef void USBH_CDC_STREAM_CALLBACK(USBH_CDC_HANDLE hDevice, unsigned Event, U32 NumBytesIn, void * pUserContext);
+
+/*********************************************************************
+*
+*       USBH_CDC_STREAM_CONFIG
+*
+*  Description
+*    Configuration of the streaming mode.
+*    Used by the function USBH_CDC_StreamStart().
+*/
+typedef struct {
+  U32                        NumSegments;       // Number of segments of the stream buffer. Must be at least 2.
+  U32                        SegmentSize;       // Size of one segment in bytes. Must be a multiple of MaxPacketSize of the bulk IN endpoint and must not exceed the max. IN transfer size.
+  U32                        HighWatermark;     // USBH_CDC_STREAM_EVENT_HIGH_WATERMARK is reported when this number of bytes is stored. 0 disables the watermark events.
+  U32                        LowWatermark;      // USBH_CDC_STREAM_EVENT_LOW_WATERMARK is reported when the number of bytes drops to this value after the high watermark was reached.
+  USBH_CDC_STREAM_CALLBACK * pfOnEvent;         // Optional callback for streaming events. Can be NULL.
+  void                     * pUserContext;      // Pointer to a user context passed to pfOnEvent.
+} USBH_CDC_STREAM_CONFIG;
+
+/*********************************************************************
+*
+*       USBH_CDC_STREAM_STAT
+*
+*  Description
+*    Statistic counters of the streaming mode.
+*    Used by the function USBH_CDC_StreamGetStat().
+*/
+typedef struct {
+  U32 NumBytesReceived;       // Total number of bytes received.
+  U32 NumTransfers;           // Number of completed IN transfers.
+  U32 NumOverruns;            // Number of times the stream buffer was full and no IN transfer could be queued.
+  U32 NumErrors;              // Number of failed IN transfers.
+  U32 MaxNumBytesIn;          // Max. number of bytes stored in the stream buffer.
+} USBH_CDC_STREAM_STAT;
+
 U8                USBH_CDC_Init                     (void);
 void              USBH_CDC_Exit                     (void);
 void              USBH_CDC_RegisterNotification     (USBH_NOTIFICATION_FUNC * pfNotification, void * pContext);
@@ -312,6 +377,12 @@ USBH_STATUS       USBH_CDC_GetCSDesc                (USBH_CDC_HANDLE hDevice, U8
 USBH_STATUS       USBH_CDC_GetStringDesc            (USBH_CDC_HANDLE hDevice, U8 StringIndex, U8 * pBuffer, U32 * pNumBytesData);
 USBH_STATUS       USBH_CDC_SetDataCommunication     (USBH_CDC_HANDLE hDevice, unsigned OnOff);
 USBH_STATUS       USBH_CDC_SuspendResume            (USBH_CDC_HANDLE hDevice, U8 State);
+
+USBH_STATUS       USBH_CDC_StreamStart              (USBH_CDC_HANDLE hDevice, const USBH_CDC_STREAM_CONFIG * pConfig);
+USBH_STATUS       USBH_CDC_StreamStop               (USBH_CDC_HANDLE hDevice);
+USBH_STATUS       USBH_CDC_StreamPeek               (USBH_CDC_HANDLE hDevice, U8 ** ppData, U32 * pNumBytes);
+USBH_STATUS       USBH_CDC_StreamCommit             (USBH_CDC_HANDLE hDevice, U32 NumBytes);
+USBH_STATUS       USBH_CDC_StreamGetStat            (USBH_CDC_HANDLE hDevice, USBH_CDC_STREAM_STAT * pStat);
 #if defined(__cplusplus)
   }
 #endif
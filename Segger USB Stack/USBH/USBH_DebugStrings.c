@@ -93,6 +93,7 @@ const char * USBH_EnumState2Str(DEV_ENUM_STATE x) {
     USBH_ENUM_TO_STR(DEV_ENUM_GET_CONFIG_DESC):
     USBH_ENUM_TO_STR(DEV_ENUM_GET_LANG_ID):
     USBH_ENUM_TO_STR(DEV_ENUM_GET_SERIAL_DESC):
+    USBH_ENUM_TO_STR(DEV_ENUM_CHECK_CACHED_DESC):
     USBH_ENUM_TO_STR(DEV_ENUM_PREP_SET_CONFIG):
     USBH_ENUM_TO_STR(DEV_ENUM_SET_CONFIGURATION):
     USBH_ENUM_TO_STR(DEV_ENUM_INIT_HUB):
@@ -61,6 +61,35 @@ Purpose     : Handling of USB device objects and enumeration.
 //
 #define DEFAULT_TRANSFERBUFFER_SIZE     64u
 
+/*********************************************************************
+*
+*       Types
+*
+**********************************************************************
+*/
+#if USBH_ENUM_DESC_CACHE_SIZE > 0
+//
+// Descriptors of a known device. pData holds the serial number
+// followed by all configuration descriptors of the device.
+//
+typedef struct {
+  USBH_DEVICE_DESCRIPTOR  DeviceDescriptor;
+  U8                    * pData;
+  U32                     DataSize;
+  U16                     SerialNumberSize;
+  U32                     LastUse;            // Sequence number for least recently used replacement.
+} ENUM_DESC_CACHE_ENTRY;
+
+/*********************************************************************
+*
+*       Static data
+*
+**********************************************************************
+*/
+static ENUM_DESC_CACHE_ENTRY  _aDescCache[USBH_ENUM_DESC_CACHE_SIZE];
+static U32                    _DescCacheSeq;
+#endif
+
 /*********************************************************************
 *
 *       _ConvDeviceDesc
@@ -194,6 +223,208 @@ static USBH_STATUS _InitDefaultEndpoint(USB_DEVICE * pUsbDevice) {
   return USBH_STATUS_SUCCESS;
 }
 
+/*********************************************************************
+*
+*       _EnumGetConfigDescPart
+*
+*  Function description
+*    Requests the first 9 bytes of the configuration descriptor
+*    with index pEnumDev->ConfigurationIndex.
+*
+*  Return value
+*    USBH_STATUS_PENDING on success, other values indicate an error.
+*/
+static USBH_STATUS _EnumGetConfigDescPart(USB_DEVICE * pEnumDev) {
+  USBH_EnumPrepareGetDescReq(&pEnumDev->EnumUrb, USB_CONFIGURATION_DESCRIPTOR_TYPE, pEnumDev->ConfigurationIndex, 0, USB_CONFIGURATION_DESCRIPTOR_LENGTH, pEnumDev->pCtrlTransferBuffer);
+  pEnumDev->EnumState = DEV_ENUM_GET_CONFIG_DESC_PART;
+  return USBH_URB_SubStateSubmitRequest(&pEnumDev->SubState, &pEnumDev->EnumUrb, USBH_DEFAULT_SETUP_TIMEOUT, pEnumDev);
+}
+
+/*********************************************************************
+*
+*       _EnumGetLangId
+*
+*  Function description
+*    Requests the string descriptor 0 containing the language IDs.
+*
+*  Return value
+*    USBH_STATUS_PENDING on success, other values indicate an error.
+*/
+static USBH_STATUS _EnumGetLangId(USB_DEVICE * pEnumDev) {
+  if (USBH_CheckCtrlTransferBuffer(pEnumDev, 256) != 0) {
+    return USBH_STATUS_MEMORY;
+  }
+  USBH_EnumPrepareGetDescReq(&pEnumDev->EnumUrb, USB_STRING_DESCRIPTOR_TYPE, 0, 0, 255, pEnumDev->pCtrlTransferBuffer);
+  pEnumDev->EnumState = DEV_ENUM_GET_LANG_ID;
+  return USBH_URB_SubStateSubmitRequest(&pEnumDev->SubState, &pEnumDev->EnumUrb, USBH_DEFAULT_SETUP_TIMEOUT, pEnumDev);
+}
+
+#if USBH_ENUM_DESC_CACHE_SIZE > 0
+/*********************************************************************
+*
+*       _DescCacheFind
+*
+*  Function description
+*    Searches the descriptor cache for a device with identical
+*    device descriptor and serial number.
+*
+*  Return value
+*    Pointer to the cache entry or NULL if the device is unknown.
+*/
+static ENUM_DESC_CACHE_ENTRY * _DescCacheFind(const USB_DEVICE * pDev) {
+  ENUM_DESC_CACHE_ENTRY * pEntry;
+  unsigned                i;
+
+  if (pDev->SerialNumberSize == 0u) {
+    return NULL;
+  }
+  pEntry = _aDescCache;
+  for (i = 0; i < SEGGER_COUNTOF(_aDescCache); i++) {
+    if (pEntry->pData != NULL &&
+        pEntry->SerialNumberSize == pDev->SerialNumberSize &&
+        USBH_MEMCMP(&pEntry->DeviceDescriptor, &pDev->DeviceDescriptor, sizeof(USBH_DEVICE_DESCRIPTOR)) == 0 &&
+        USBH_MEMCMP(pEntry->pData, pDev->pSerialNumber, pDev->SerialNumberSize) == 0) {
+      return pEntry;
+    }
+    pEntry++;
+  }
+  return NULL;
+}
+
+/*********************************************************************
+*
+*       _DescCacheLoad
+*
+*  Function description
+*    Copies the configuration descriptors of a cache entry into the device object.
+*
+*  Parameters
+*    pDev:          Pointer to the device object.
+*    pEntry:        Pointer to the cache entry.
+*    pConfigHeader: First USB_CONFIGURATION_DESCRIPTOR_LENGTH bytes of the
+*                   first configuration descriptor, as read from the device.
+*
+*  Return value
+*    USBH_STATUS_SUCCESS on success.
+*    USBH_STATUS_INVALID_DESCRIPTOR if the cached descriptors do not match the device.
+*    Other values indicate an error.
+*/
+static USBH_STATUS _DescCacheLoad(USB_DEVICE * pDev, ENUM_DESC_CACHE_ENTRY * pEntry, const U8 * pConfigHeader) {
+  const U8  * p;
+  U32         Offset;
+  unsigned    DescLen;
+  unsigned    i;
+  U8        * pDesc;
+  USBH_STATUS Status;
+
+  Offset = pEntry->SerialNumberSize;
+  Status = USBH_STATUS_SUCCESS;
+  for (i = 0; i < pDev->NumConfigurations || i == 0u; i++) {
+    if (Offset + USB_CONFIGURATION_DESCRIPTOR_LENGTH > pEntry->DataSize) {
+      Status = USBH_STATUS_INVALID_DESCRIPTOR;
+      break;
+    }
+    p       = pEntry->pData + Offset;
+    DescLen = USBH_LoadU16LE(p + 2);
+    if (DescLen < USB_CONFIGURATION_DESCRIPTOR_LENGTH || Offset + DescLen > pEntry->DataSize) {
+      Status = USBH_STATUS_INVALID_DESCRIPTOR;
+      break;
+    }
+    if (i == 0u && USBH_MEMCMP(p, pConfigHeader, USB_CONFIGURATION_DESCRIPTOR_LENGTH) != 0) {
+      //
+      // Same device descriptor and serial number, but the configuration changed.
+      //
+      USBH_LOG((USBH_MCAT_DEVICE_ENUM, "Cached descriptors of device %04x:%04x outdated", pDev->DeviceDescriptor.idVendor, pDev->DeviceDescriptor.idProduct));
+      Status = USBH_STATUS_INVALID_DESCRIPTOR;
+      break;
+    }
+    pDesc = (U8 *)USBH_TRY_MALLOC(DescLen);
+    if (pDesc == NULL) {
+      Status = USBH_STATUS_MEMORY;
+      break;
+    }
+    USBH_MEMCPY(pDesc, p, DescLen);
+    pDev->ppConfigDesc[i] = pDesc;
+    pDev->paConfigSize[i] = (U16)DescLen;
+    Offset += DescLen;
+  }
+  if (Status != USBH_STATUS_SUCCESS) {
+    //
+    // Undo partial load, the descriptors are read from the device instead.
+    //
+    while (i-- > 0u) {
+      USBH_FREE(pDev->ppConfigDesc[i]);
+      pDev->ppConfigDesc[i] = NULL;
+    }
+    return Status;
+  }
+  pEntry->LastUse     = ++_DescCacheSeq;
+  pDev->DescFromCache = 1;
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       _DescCacheStore
+*
+*  Function description
+*    Stores the serial number and configuration descriptors of a device
+*    into the descriptor cache. Replaces the least recently used entry if the cache is full.
+*/
+static void _DescCacheStore(const USB_DEVICE * pDev) {
+  ENUM_DESC_CACHE_ENTRY * pEntry;
+  ENUM_DESC_CACHE_ENTRY * p;
+  U32                     DataSize;
+  U32                     Offset;
+  unsigned                NumConfigs;
+  unsigned                i;
+  U8                    * pData;
+
+  if (pDev->SerialNumberSize == 0u) {
+    return;
+  }
+  NumConfigs = SEGGER_MAX(pDev->NumConfigurations, 1u);
+  DataSize   = pDev->SerialNumberSize;
+  for (i = 0; i < NumConfigs; i++) {
+    DataSize += pDev->paConfigSize[i];
+  }
+  pEntry = _DescCacheFind(pDev);
+  if (pEntry == NULL) {
+    pEntry = _aDescCache;
+    p      = _aDescCache;
+    for (i = 0; i < SEGGER_COUNTOF(_aDescCache); i++) {
+      if (p->pData == NULL) {
+        pEntry = p;
+        break;
+      }
+      if (p->LastUse < pEntry->LastUse) {
+        pEntry = p;
+      }
+      p++;
+    }
+  }
+  pData = (U8 *)USBH_TRY_MALLOC(DataSize);
+  if (pData == NULL) {
+    return;
+  }
+  USBH_MEMCPY(pData, pDev->pSerialNumber, pDev->SerialNumberSize);
+  Offset = pDev->SerialNumberSize;
+  for (i = 0; i < NumConfigs; i++) {
+    USBH_MEMCPY(pData + Offset, pDev->ppConfigDesc[i], pDev->paConfigSize[i]);
+    Offset += pDev->paConfigSize[i];
+  }
+  if (pEntry->pData != NULL) {
+    USBH_FREE(pEntry->pData);
+  }
+  pEntry->DeviceDescriptor = pDev->DeviceDescriptor;
+  pEntry->pData            = pData;
+  pEntry->DataSize         = DataSize;
+  pEntry->SerialNumberSize = (U16)pDev->SerialNumberSize;
+  pEntry->LastUse          = ++_DescCacheSeq;
+  USBH_LOG((USBH_MCAT_DEVICE_ENUM, "Descriptors of device %04x:%04x cached (%u bytes)", pDev->DeviceDescriptor.idVendor, pDev->DeviceDescriptor.idProduct, DataSize));
+}
+#endif
+
 /*********************************************************************
 *
 *       _ProcessEnum
@@ -300,17 +531,56 @@ static void _ProcessEnum(void *pContext) {
       pEnumDev->ppConfigDesc = &pEnumDev->pConfigDesc;
       pEnumDev->paConfigSize = &pEnumDev->ConfigSize;
     }
+#if USBH_ENUM_DESC_CACHE_SIZE > 0
+    //
+    // Read language ID and serial number first to identify the device,
+    // configuration descriptors of known devices are taken from the cache.
+    //
+    Status = _EnumGetLangId(pEnumDev);
+#else
     //
     // Prepare an URB to read first 9 bytes from configuration descriptor
     //
-    USBH_EnumPrepareGetDescReq(&pEnumDev->EnumUrb, USB_CONFIGURATION_DESCRIPTOR_TYPE, pEnumDev->ConfigurationIndex, 0, USB_CONFIGURATION_DESCRIPTOR_LENGTH, pEnumDev->pCtrlTransferBuffer);
-    pEnumDev->EnumState = DEV_ENUM_GET_CONFIG_DESC_PART;
-    Status = USBH_URB_SubStateSubmitRequest(&pEnumDev->SubState, pUrb, USBH_DEFAULT_SETUP_TIMEOUT, pEnumDev);
+    Status = _EnumGetConfigDescPart(pEnumDev);
+#endif
     if (Status != USBH_STATUS_PENDING) {
       USBH_WARN((USBH_MCAT_DEVICE, "_ProcessEnum: DEV_ENUM_GET_DEVICE_DESC USBH_URB_SubStateSubmitRequest failed %s", USBH_GetStatusStr(Status)));
       goto StopPort;
     }
     break;
+#if USBH_ENUM_DESC_CACHE_SIZE > 0
+  case DEV_ENUM_CHECK_CACHED_DESC:
+    //
+    // Known device: Take the configuration descriptors from the cache
+    // if the header of the first configuration descriptor is unchanged.
+    //
+    if (pUrb->Header.Status == USBH_STATUS_SUCCESS && pUrb->Request.ControlRequest.Length == USB_CONFIGURATION_DESCRIPTOR_LENGTH) {
+      ENUM_DESC_CACHE_ENTRY * pEntry;
+
+      Status = USBH_STATUS_INVALID_DESCRIPTOR;
+      USBH_OS_Lock(USBH_MUTEX_DEVICE);
+      pEntry = _DescCacheFind(pEnumDev);
+      if (pEntry != NULL) {
+        Status = _DescCacheLoad(pEnumDev, pEntry, pEnumDev->pCtrlTransferBuffer);
+      }
+      USBH_OS_Unlock(USBH_MUTEX_DEVICE);
+      if (Status == USBH_STATUS_MEMORY) {
+        goto StopPort;
+      }
+      if (Status == USBH_STATUS_SUCCESS) {
+        USBH_LOG((USBH_MCAT_DEVICE_ENUM, "_ProcessEnum: Configuration descriptors taken from cache"));
+        pEnumDev->EnumState = DEV_ENUM_PREP_SET_CONFIG;
+        USBH_URB_SubStateWait(&pEnumDev->SubState, 1, NULL);
+        break;
+      }
+    }
+    //
+    // Cached descriptors outdated: Continue reading them from the device.
+    // The cache entry is replaced once all descriptors are read.
+    //
+#endif
+    //lint -fallthrough
+    //lint -e{9090} D:102[b]
   case DEV_ENUM_GET_CONFIG_DESC_PART:
     //
     // Check header of configuration descriptor
@@ -372,30 +642,35 @@ static void _ProcessEnum(void *pContext) {
       // Read next configuration.
       //
       pEnumDev->ConfigurationIndex++;
-      USBH_EnumPrepareGetDescReq(&pEnumDev->EnumUrb, USB_CONFIGURATION_DESCRIPTOR_TYPE, pEnumDev->ConfigurationIndex, 0, USB_CONFIGURATION_DESCRIPTOR_LENGTH, pEnumDev->pCtrlTransferBuffer);
-      pEnumDev->EnumState = DEV_ENUM_GET_CONFIG_DESC_PART;
-      Status = USBH_URB_SubStateSubmitRequest(&pEnumDev->SubState, pUrb, USBH_DEFAULT_SETUP_TIMEOUT, pEnumDev);
+      Status = _EnumGetConfigDescPart(pEnumDev);
       if (Status != USBH_STATUS_PENDING) {
         USBH_WARN((USBH_MCAT_DEVICE, "_ProcessEnum: DEV_ENUM_GET_DEVICE_DESC USBH_URB_SubStateSubmitRequest failed %s", USBH_GetStatusStr(Status)));
         goto StopPort;
       }
       break;
     }
+#if USBH_ENUM_DESC_CACHE_SIZE > 0
+    //
+    // Strings have already been read, continue with 'set configuration'.
+    //
+    USBH_OS_Lock(USBH_MUTEX_DEVICE);
+    _DescCacheStore(pEnumDev);
+    USBH_OS_Unlock(USBH_MUTEX_DEVICE);
+    pEnumDev->ConfigurationIndex = 0;
+    pEnumDev->EnumState = DEV_ENUM_PREP_SET_CONFIG;
+    USBH_URB_SubStateWait(&pEnumDev->SubState, 1, NULL);
+    break;
+#else
     //
     // Prepare an URB for the language ID
     //
-    if (USBH_CheckCtrlTransferBuffer(pEnumDev, 256) != 0) {
-      Status = USBH_STATUS_MEMORY;
-      goto StopPort;
-    }
-    USBH_EnumPrepareGetDescReq(&pEnumDev->EnumUrb, USB_STRING_DESCRIPTOR_TYPE, 0, 0, 255, pEnumDev->pCtrlTransferBuffer);
-    pEnumDev->EnumState = DEV_ENUM_GET_LANG_ID;
-    Status = USBH_URB_SubStateSubmitRequest(&pEnumDev->SubState, pUrb, USBH_DEFAULT_SETUP_TIMEOUT, pEnumDev);
+    Status = _EnumGetLangId(pEnumDev);
     if (Status != USBH_STATUS_PENDING) {
       USBH_WARN((USBH_MCAT_DEVICE, "_ProcessEnum: DEV_ENUM_GET_CONFIG_DESC_PART USBH_URB_SubStateSubmitRequest failed %s", USBH_GetStatusStr(Status)));
       goto StopPort;
     }
     break;
+#endif
   case DEV_ENUM_GET_LANG_ID:
     //
     // Check language ID response
@@ -412,8 +687,16 @@ static void _ProcessEnum(void *pContext) {
       //
       // Device don't has a serial number: Skip reading of serial number.
       //
+#if USBH_ENUM_DESC_CACHE_SIZE > 0
+      Status = _EnumGetConfigDescPart(pEnumDev);
+      if (Status != USBH_STATUS_PENDING) {
+        USBH_WARN((USBH_MCAT_DEVICE, "_ProcessEnum: DEV_ENUM_GET_LANG_ID USBH_URB_SubStateSubmitRequest failed %s", USBH_GetStatusStr(Status)));
+        goto StopPort;
+      }
+#else
       pEnumDev->EnumState = DEV_ENUM_PREP_SET_CONFIG;
       USBH_URB_SubStateWait(&pEnumDev->SubState, 1, NULL);
+#endif
       break;
     }
     //
@@ -446,6 +729,29 @@ static void _ProcessEnum(void *pContext) {
         USBH_MEMCPY(pEnumDev->pSerialNumber, pEnumDev->pCtrlTransferBuffer + 2, pEnumDev->SerialNumberSize);
       }
     }
+#if USBH_ENUM_DESC_CACHE_SIZE > 0
+    {
+      ENUM_DESC_CACHE_ENTRY * pEntry;
+
+      USBH_OS_Lock(USBH_MUTEX_DEVICE);
+      pEntry = _DescCacheFind(pEnumDev);
+      USBH_OS_Unlock(USBH_MUTEX_DEVICE);
+      //
+      // Read the header of the first configuration descriptor in any case.
+      // For a known device it is compared with the cached descriptors,
+      // so a device that changed its configuration without changing
+      // its device descriptor is not configured with stale descriptors.
+      //
+      USBH_EnumPrepareGetDescReq(&pEnumDev->EnumUrb, USB_CONFIGURATION_DESCRIPTOR_TYPE, pEnumDev->ConfigurationIndex, 0, USB_CONFIGURATION_DESCRIPTOR_LENGTH, pEnumDev->pCtrlTransferBuffer);
+      pEnumDev->EnumState = (pEntry != NULL) ? DEV_ENUM_CHECK_CACHED_DESC : DEV_ENUM_GET_CONFIG_DESC_PART;
+      Status = USBH_URB_SubStateSubmitRequest(&pEnumDev->SubState, pUrb, USBH_DEFAULT_SETUP_TIMEOUT, pEnumDev);
+      if (Status != USBH_STATUS_PENDING) {
+        USBH_WARN((USBH_MCAT_DEVICE, "_ProcessEnum: DEV_ENUM_GET_SERIAL_DESC USBH_URB_SubStateSubmitRequest failed %s", USBH_GetStatusStr(Status)));
+        goto StopPort;
+      }
+      break;
+    }
+#endif
     //lint -fallthrough
     //lint -e{9090} D:102[b]
   case DEV_ENUM_PREP_SET_CONFIG:
@@ -548,7 +854,9 @@ FinishEnum:
   USBH_HC_DEC_REF(pEnumDev->pHostController);     // Reset ref from USBH_StartEnumeration()
   pEnumDev->pParentPort->DeviceEnumActive = 0;
   USBH_ReleaseActiveEnumeration(pEnumDev->pHostController);
-  USBH_LOG((USBH_MCAT_DEVICE, "_ProcessEnum: Enumeration successful"));
+  pEnumDev->EnumTime = (U32)USBH_TimeDiff(USBH_OS_GetTime32(), pEnumDev->EnumStartTime);
+  USBH_LOG((USBH_MCAT_DEVICE, "_ProcessEnum: Enumeration successful, device %u ready after %u ms%s", pEnumDev->DeviceId, pEnumDev->EnumTime,
+                              (const char *)(pEnumDev->DescFromCache != 0u ? " (cached descriptors)" : "")));
   return;
 RestartPort:
   USBH_ReleaseActiveEnumeration(pEnumDev->pHostController);
@@ -677,6 +985,7 @@ USB_DEVICE * USBH_CreateNewUsbDevice(USBH_HOST_CONTROLLER * pHostController) {
   pDev->pHostController = pHostController;
   USBH_DLIST_Init(&pDev->UsbInterfaceList);
   pDev->DeviceId = ++USBH_Global.NextDeviceId;
+  pDev->EnumStartTime = USBH_OS_GetTime32();     // Hub ports overwrite this with the time the connection was detected.
   pDev->RefCount = 1;               // Initial refcount
   // The sub state machine increments the reference count of the device before submitting the request
   USBH_URB_SubStateInit(&pDev->SubState, pHostController, &pDev->DefaultEp.hEP, _ProcessEnum, pDev);
@@ -1607,6 +1916,73 @@ USBH_STATUS USBH_GetSpeed(USBH_INTERFACE_HANDLE hInterface, USBH_SPEED * pSpeed)
   return USBH_STATUS_SUCCESS;
 }
 
+/*********************************************************************
+*
+*       USBH_GetEnumTime
+*
+*  Function description
+*    Returns the time the enumeration of the device took.
+*
+*  Parameters
+*    hInterface:        Valid handle to an interface, returned by USBH_OpenInterface().
+*    pEnumTime:         Pointer to a variable that receives the time in milliseconds
+*                       from detection of the connection until the device was ready.
+*    pFromCache:        Pointer to a variable that receives 1, if the configuration descriptors were taken
+*                       from the descriptor cache, else 0. May be NULL.
+*
+*  Return value
+*    USBH_STATUS_SUCCESS on success. Other values indicate an error.
+*
+*  Additional information
+*    For devices connected to an external hub, the time includes debouncing,
+*    port reset and all retries. For devices connected to the root hub, the time
+*    starts after the port reset.
+*/
+USBH_STATUS USBH_GetEnumTime(USBH_INTERFACE_HANDLE hInterface, U32 * pEnumTime, U8 * pFromCache) {
+  USB_INTERFACE * pUsbInterface;
+  USB_DEVICE    * pDev;
+
+  pUsbInterface = hInterface;
+  USBH_ASSERT_MAGIC(pUsbInterface, USB_INTERFACE);
+  pDev          = pUsbInterface->pDevice;
+  if (pDev->State < DEV_STATE_WORKING) {
+    return USBH_STATUS_DEVICE_REMOVED;
+  }
+  *pEnumTime = pDev->EnumTime;
+  if (pFromCache != NULL) {
+    *pFromCache = pDev->DescFromCache;
+  }
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       USBH_ClearEnumDescCache
+*
+*  Function description
+*    Removes all devices from the enumeration descriptor cache.
+*    The cache is protected by the device mutex, the function may be called from any task.
+*
+*  Additional information
+*    Should be called if the descriptors of a device may have changed without a
+*    change of the device descriptor or serial number (e.g. during device firmware development).
+*    Is called by USBH_Exit(). Has no effect if USBH_ENUM_DESC_CACHE_SIZE is 0.
+*/
+void USBH_ClearEnumDescCache(void) {
+#if USBH_ENUM_DESC_CACHE_SIZE > 0
+  unsigned i;
+
+  USBH_OS_Lock(USBH_MUTEX_DEVICE);
+  for (i = 0; i < SEGGER_COUNTOF(_aDescCache); i++) {
+    if (_aDescCache[i].pData != NULL) {
+      USBH_FREE(_aDescCache[i].pData);
+    }
+  }
+  USBH_MEMSET(_aDescCache, 0, sizeof(_aDescCache));
+  USBH_OS_Unlock(USBH_MUTEX_DEVICE);
+#endif
+}
+
 /*********************************************************************
 *
 *       USBH_GetFrameNumber
@@ -1703,13 +2079,21 @@ void USBH_DecRef(USB_DEVICE * pDevice
 #else
   RefCount = _DecRef(pDevice);
 #endif
-  if (RefCount == 0 && pDevice->ListEntry.pNext == NULL) {
-    //
-    // Device does not belong to any host controller
-    // (This may happen, if a device was not enumerated successfully).
-    // So the device can be deleted immediately.
-    //
-    USBH_DeleteDevice(pDevice);
+  if (RefCount == 0) {
+    if (pDevice->ListEntry.pNext == NULL) {
+      //
+      // Device does not belong to any host controller
+      // (This may happen, if a device was not enumerated successfully).
+      // So the device can be deleted immediately.
+      //
+      USBH_DeleteDevice(pDevice);
+    } else if (pDevice->State == DEV_STATE_REMOVED) {
+      //
+      // Wake USBH_Task() to remove the device from the list,
+      // it may otherwise sleep until the next timer expires.
+      //
+      USBH_OS_SignalNetEvent();
+    }
   }
 }
 
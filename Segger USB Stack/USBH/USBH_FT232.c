@@ -63,6 +63,7 @@ Purpose     : API of the USB host stack
 #define USBH_FT232_REMOVAL_TIMEOUT      100
 
 #define FT232_HEADER_SIZE                2u
+#define FT232_LINE_ERROR_MASK         0x1Eu // OE, PE, FE and BI bits of the line status
 #define FT232_IFACE_ID                   0u // TODO: this does not work with composite devices.
 
 #define FT232_REQUEST_RESET           0x00u // Reset the communication port
@@ -101,7 +102,17 @@ typedef struct _USBH_FT232_INST {
   USBH_TIMER                    RemovalTimer;
   U16                           BulkInMaxPacketSize;
   U8                            BulkOutEPAddr;
-  U8                          * pInBuffer;
+  U8                          * apRxBuffer[2];        // Transfer buffers of the receive engine, used alternately.
+  USBH_INST_POOL                Pool;                 // Transfer buffers and receive ring buffer.
+  U32                           RxTransferSize;
+  U32                           RxMaxPayload;         // Max. number of data bytes in one IN transfer.
+  USBH_BULK_RW_CONTEXT          RxContext;
+  USBH_OS_EVENT_OBJ           * pRxEvent;             // Signaled when data is added to the receive queue or the engine stops.
+  USBH_STATUS                   RxStatus;             // Error that stopped the receive engine.
+  USBH_FT232_RX_STATUS          RxInfo;
+  U8                            RxBufIdx;             // Index of the buffer used by the next IN transfer.
+  U8                            RxRunning;
+  U8                            RxPending;
   USBH_FT232_HANDLE             Handle;
   U32                           ReadTimeOut;
   U32                           WriteTimeOut;
@@ -222,7 +233,7 @@ static void _RemovalTimer(void * pContext) {
   USBH_FT232_INST * pCurrent;
 
   pInst = USBH_CTX2PTR(USBH_FT232_INST, pContext);
-  if (pInst->Removed == 0 || pInst->IsOpened != 0) {
+  if (pInst->Removed == 0 || pInst->IsOpened != 0 || pInst->RxPending != 0u) {
     USBH_StartTimer(&pInst->RemovalTimer, USBH_FT232_REMOVAL_TIMEOUT);
     return;
   }
@@ -247,11 +258,15 @@ static void _RemovalTimer(void * pContext) {
   //
   // Free the memory that is used by the instance
   //
-  if (pInst->pInBuffer != NULL) {
-    USBH_FREE(pInst->pInBuffer);
+  if (pInst->apRxBuffer[0] != NULL) {
+    USBH_INST_POOL_Free(&pInst->Pool, pInst->apRxBuffer[0]);
   }
   if (pInst->RxRingBuffer.pData != NULL) {
-    USBH_FREE(pInst->RxRingBuffer.pData);
+    USBH_INST_POOL_Free(&pInst->Pool, pInst->RxRingBuffer.pData);
+  }
+  USBH_INST_POOL_Destroy(&pInst->Pool);
+  if (pInst->pRxEvent != NULL) {
+    USBH_OS_FreeEvent(pInst->pRxEvent);
   }
   USBH_FREE(pInst);
   USBH_FT232_Global.NumDevices--;
@@ -324,14 +339,37 @@ static USBH_FT232_INST * _CreateDevInstance(USBH_BULK_HANDLE hDevice, const USBH
 */
 static USBH_STATUS _StartDevice(USBH_FT232_INST * pInst) {
   USBH_STATUS  Status;
+  U32          MaxTransferSize;
+  U32          TransferSize;
+  U32          RingSize;
 
-  pInst->pInBuffer = (U8 *)USBH_TRY_MALLOC(pInst->BulkInMaxPacketSize);
-  if (pInst->pInBuffer == NULL) {
+  //
+  // Every packet sent by the device starts with 2 status bytes.
+  //
+  TransferSize = (U32)pInst->BulkInMaxPacketSize * USBH_FT232_RX_NUM_PACKETS;
+  if (USBH_BULK_GetMaxTransferSize(pInst->hBulkDevice, pInst->BulkInEPAddr, &MaxTransferSize) == USBH_STATUS_SUCCESS) {
+    if (TransferSize > MaxTransferSize) {
+      TransferSize = MaxTransferSize - (MaxTransferSize % pInst->BulkInMaxPacketSize);
+    }
+  }
+  if (TransferSize < pInst->BulkInMaxPacketSize) {
+    TransferSize = pInst->BulkInMaxPacketSize;
+  }
+  pInst->RxTransferSize = TransferSize;
+  pInst->RxMaxPayload   = TransferSize - (TransferSize / pInst->BulkInMaxPacketSize) * FT232_HEADER_SIZE;
+  RingSize              = USBH_MAX(USBH_FT232_RX_BUFFER_SIZE, 2u * pInst->RxMaxPayload);
+  pInst->apRxBuffer[0] = NULL;
+  if (USBH_INST_POOL_Create(&pInst->Pool, USBH_INST_POOL_BLOCK_SIZE(2u * TransferSize) + USBH_INST_POOL_BLOCK_SIZE(RingSize)) == 0) {
+    pInst->apRxBuffer[0] = (U8 *)USBH_INST_POOL_Alloc(&pInst->Pool, 2u * TransferSize);
+  }
+  if (pInst->apRxBuffer[0] == NULL) {
     USBH_WARN((USBH_MCAT_FT232, "Buffer allocation failed."));
     Status = USBH_STATUS_RESOURCES;
   } else {
-    pInst->RxRingBuffer.pData   = (U8 *)USBH_TRY_MALLOC(pInst->BulkInMaxPacketSize);
-    if (pInst->RxRingBuffer.pData == NULL) {
+    pInst->apRxBuffer[1]      = pInst->apRxBuffer[0] + TransferSize;
+    pInst->RxRingBuffer.pData = (U8 *)USBH_INST_POOL_Alloc(&pInst->Pool, RingSize);
+    pInst->pRxEvent           = USBH_OS_AllocEvent();
+    if (pInst->RxRingBuffer.pData == NULL || pInst->pRxEvent == NULL) {
       USBH_WARN((USBH_MTYPE_FT232, "Buffer allocation failed."));
       Status = USBH_STATUS_RESOURCES;
     } else {
@@ -340,12 +378,175 @@ static USBH_STATUS _StartDevice(USBH_FT232_INST * pInst) {
       USBH_LOG((USBH_MCAT_FT232, "0x%02X      %5d      ", pInst->BulkInEPAddr, pInst->BulkInMaxPacketSize));
       pInst->ReadTimeOut  = USBH_FT232_Global.DefaultReadTimeOut;
       pInst->WriteTimeOut = USBH_FT232_Global.DefaultWriteTimeOut;
-      pInst->RxRingBuffer.Size    = pInst->BulkInMaxPacketSize;
+      pInst->RxRingBuffer.Size    = RingSize;
+      pInst->RxStatus             = USBH_STATUS_SUCCESS;
     }
   }
   return Status;
 }
 
+/*********************************************************************
+*
+*       _RxStripHeaders
+*
+*  Function description
+*    Removes the status bytes from the packets received by an IN transfer,
+*    stores the data in the receive queue and updates the modem status.
+*    FT232 mutex must be locked.
+*
+*  Parameters
+*    pInst    : Pointer to the FT232 device instance.
+*    pBuffer  : Data received.
+*    NumBytes : Number of bytes received.
+*
+*  Additional information
+*    A short packet terminates the transfer, so all packets except
+*    the last one have the size BulkInMaxPacketSize.
+*/
+static void _RxStripHeaders(USBH_FT232_INST * pInst, const U8 * pBuffer, U32 NumBytes) {
+  U32 NumBytesPacket;
+  U32 NumBytesData;
+
+  NumBytesData = 0;
+  while (NumBytes >= FT232_HEADER_SIZE) {
+    NumBytesPacket = USBH_MIN(NumBytes, (U32)pInst->BulkInMaxPacketSize);
+    pInst->RxInfo.ModemStatus = (U16)pBuffer[0] | ((U16)pBuffer[1] << 8);
+    pInst->RxInfo.LineErrors |= pBuffer[1] & FT232_LINE_ERROR_MASK;
+    if (NumBytesPacket > FT232_HEADER_SIZE) {
+      USBH_BUFFER_Write(&pInst->RxRingBuffer, &pBuffer[FT232_HEADER_SIZE], NumBytesPacket - FT232_HEADER_SIZE);
+      NumBytesData += NumBytesPacket - FT232_HEADER_SIZE;
+    }
+    pBuffer  += NumBytesPacket;
+    NumBytes -= NumBytesPacket;
+  }
+  if (NumBytesData == 0u) {
+    pInst->RxInfo.NumStatusOnly++;
+  }
+  pInst->RxInfo.NumBytesReceived += NumBytesData;
+}
+
+/*********************************************************************
+*
+*       _RxReserve
+*
+*  Function description
+*    Checks whether the next IN transfer of the receive engine can be
+*    queued and marks it as pending. FT232 mutex must be locked.
+*
+*  Parameters
+*    pInst          : Pointer to the FT232 device instance.
+*    NumBytesInUse  : Number of bytes of the receive queue that are already
+*                     reserved for data not yet stored.
+*
+*  Return value
+*    != NULL : Buffer the IN transfer has to use.
+*    == NULL : No transfer to queue.
+*/
+static U8 * _RxReserve(USBH_FT232_INST * pInst, U32 NumBytesInUse) {
+  U8  * pBuffer;
+  U32   NumBytesFree;
+
+  pBuffer = NULL;
+  if (pInst->RxRunning != 0u && pInst->RxPending == 0u && pInst->Removed == 0) {
+    NumBytesFree = pInst->RxRingBuffer.Size - pInst->RxRingBuffer.NumBytesIn;
+    if (NumBytesFree >= NumBytesInUse + pInst->RxMaxPayload) {
+      pBuffer          = pInst->apRxBuffer[pInst->RxBufIdx];
+      pInst->RxBufIdx ^= 1u;
+      pInst->RxPending = 1;
+    } else {
+      pInst->RxInfo.NumThrottled++;              // Device is NAKed until the application reads data.
+    }
+  }
+  return pBuffer;
+}
+
+static void _OnRxCompletion(USBH_BULK_RW_CONTEXT * pRWContext);
+
+/*********************************************************************
+*
+*       _RxSubmit
+*
+*  Function description
+*    Queues an IN transfer reserved by _RxReserve().
+*    FT232 mutex must not be locked.
+*/
+static void _RxSubmit(USBH_FT232_INST * pInst, U8 * pBuffer) {
+  USBH_STATUS Status;
+
+  pInst->RxContext.pUserContext = pInst;
+  Status = USBH_BULK_ReadAsync(pInst->hBulkDevice, pInst->BulkInEPAddr, pBuffer, pInst->RxTransferSize, _OnRxCompletion, &pInst->RxContext);
+  if (Status != USBH_STATUS_PENDING) {
+    USBH_WARN((USBH_MCAT_FT232, "_RxSubmit: USBH_BULK_ReadAsync failed, Status = %s", USBH_GetStatusStr(Status)));
+    USBH_OS_Lock(USBH_MUTEX_FT232);
+    pInst->RxPending = 0;
+    pInst->RxRunning = 0;
+    pInst->RxStatus  = Status;
+    USBH_OS_SetEvent(pInst->pRxEvent);
+    USBH_OS_Unlock(USBH_MUTEX_FT232);
+  }
+}
+
+/*********************************************************************
+*
+*       _OnRxCompletion
+*
+*  Function description
+*    Completion routine of the IN transfers of the receive engine.
+*
+*  Additional information
+*    The next transfer is queued into the other buffer before the
+*    received data is processed, so the device is polled again
+*    while the status bytes are stripped.
+*/
+static void _OnRxCompletion(USBH_BULK_RW_CONTEXT * pRWContext) {
+  USBH_FT232_INST * pInst;
+  USBH_STATUS       Status;
+  const U8        * pData;
+  U32               NumBytes;
+  U32               NumBytesPayload;
+  U8              * pNext;
+
+  pInst    = USBH_CTX2PTR(USBH_FT232_INST, pRWContext->pUserContext);
+  Status   = pRWContext->Status;
+  pData    = (const U8 *)pRWContext->pUserBuffer;
+  NumBytes = pRWContext->NumBytesTransferred;
+  pNext    = NULL;
+  USBH_OS_Lock(USBH_MUTEX_FT232);
+  pInst->RxPending = 0;
+  if (Status == USBH_STATUS_SUCCESS) {
+    pInst->RxInfo.NumTransfers++;
+    NumBytesPayload = ((NumBytes + pInst->BulkInMaxPacketSize - 1u) / pInst->BulkInMaxPacketSize) * FT232_HEADER_SIZE;
+    NumBytesPayload = (NumBytes > NumBytesPayload) ? NumBytes - NumBytesPayload : 0u;
+    pNext = _RxReserve(pInst, NumBytesPayload);
+  } else if (Status == USBH_STATUS_CANCELED) {
+    pNext = _RxReserve(pInst, 0);                 // Canceled by USBH_FT232_Close(), restart if the device was opened again.
+  } else {
+    pInst->RxRunning = 0;
+    pInst->RxStatus  = Status;
+    USBH_OS_SetEvent(pInst->pRxEvent);
+  }
+  USBH_OS_Unlock(USBH_MUTEX_FT232);
+  if (pNext != NULL) {
+    _RxSubmit(pInst, pNext);
+  }
+  if (Status == USBH_STATUS_SUCCESS) {
+    USBH_OS_Lock(USBH_MUTEX_FT232);
+    _RxStripHeaders(pInst, pData, NumBytes);
+    if (pInst->RxRingBuffer.NumBytesIn != 0u) {
+      USBH_OS_SetEvent(pInst->pRxEvent);
+    }
+    pNext = _RxReserve(pInst, 0);                 // Queue a transfer if it was not possible above.
+    USBH_OS_Unlock(USBH_MUTEX_FT232);
+    if (pNext != NULL) {
+      _RxSubmit(pInst, pNext);
+    }
+  } else if (Status != USBH_STATUS_CANCELED) {
+    USBH_WARN((USBH_MCAT_FT232, "_OnRxCompletion: IN transfer failed, Status = %s", USBH_GetStatusStr(Status)));
+  } else {
+    // Transfer canceled.
+  }
+}
+
 /*********************************************************************
 *
 *       _OnDeviceNotification
@@ -580,6 +781,17 @@ USBH_STATUS USBH_FT232_Close(USBH_FT232_HANDLE hDevice) {
       return USBH_STATUS_NOT_OPENED;
     } else {
       pInst->IsOpened--;
+      if (pInst->IsOpened == 0) {
+        //
+        // Last handle closed, stop the receive engine.
+        //
+        USBH_OS_Lock(USBH_MUTEX_FT232);
+        pInst->RxRunning = 0;
+        USBH_OS_Unlock(USBH_MUTEX_FT232);
+        if (pInst->RxPending != 0u) {
+          (void)USBH_BULK_Cancel(pInst->hBulkDevice, pInst->BulkInEPAddr);
+        }
+      }
       return USBH_STATUS_SUCCESS;
     }
   }
@@ -645,6 +857,12 @@ USBH_STATUS USBH_FT232_Write(USBH_FT232_HANDLE hDevice, const U8 * pData, U32 Nu
 *    != USBH_STATUS_SUCCESS: An error occurred.
 *
 *  Additional information
+*    Data is received in the background by a receive engine which
+*    is started by the first call of USBH_FT232_Read() and runs until
+*    the last handle to the device is closed. The engine removes the
+*    status bytes from the received packets and stores the data in the
+*    receive queue, USBH_FT232_Read() waits until the engine signals new data.
+*
 *    USBH_FT232_Read() always returns the number of bytes read in
 *    pNumBytesRead. This function does not return until NumBytes bytes
 *    have been read into the buffer unless short read mode is enabled.
@@ -671,11 +889,15 @@ USBH_STATUS USBH_FT232_Write(USBH_FT232_HANDLE hDevice, const U8 * pData, U32 Nu
 USBH_STATUS USBH_FT232_Read(USBH_FT232_HANDLE hDevice, U8 * pData, U32 NumBytes, U32 * pNumBytesRead) {
   USBH_FT232_INST * pInst;
   USBH_STATUS       Status;
-  U32               NumBytesRead;
-  U32               NumBytes2Copy;
   U32               NumBytesTransfered;
+  U32               NumBytesTotal;
   USBH_TIME         ExpiredTime;
+  I32               TimeLeft;
+  U8              * pNext;
 
+  if (pNumBytesRead != NULL) {
+    *pNumBytesRead = 0;
+  }
   pInst = _h2p(hDevice);
   if (pInst == NULL) {
     Status = USBH_STATUS_INVALID_HANDLE;
@@ -686,65 +908,57 @@ USBH_STATUS USBH_FT232_Read(USBH_FT232_HANDLE hDevice, U8 * pData, U32 NumBytes,
     if (pInst->Removed != 0) {
       return USBH_STATUS_DEVICE_REMOVED;
     }
-    //
-    // Check internal buffer first.
-    //
-    NumBytesTransfered = USBH_BUFFER_Read(&pInst->RxRingBuffer, pData, NumBytes);
-    NumBytes          -= NumBytesTransfered;
-    pData             += NumBytesTransfered;
-    if (pNumBytesRead != NULL) {
-      *pNumBytesRead   = NumBytesTransfered;
-    }
-    if (NumBytes == 0u) {
+    NumBytesTotal = 0;
+    ExpiredTime   = USBH_TIME_CALC_EXPIRATION(pInst->ReadTimeOut);
+    for (;;) {
+      USBH_OS_Lock(USBH_MUTEX_FT232);
       //
-      // Read request satisfied from the internal buffer.
+      // Take data from the receive queue which is filled by the receive engine.
       //
-      Status = USBH_STATUS_SUCCESS;
-    } else {
-      ExpiredTime = USBH_TIME_CALC_EXPIRATION(pInst->ReadTimeOut);
-      do {
-        //
-        // Check for timeout.
-        //
-        if (pInst->ReadTimeOut != 0u  && USBH_TIME_IS_EXPIRED(ExpiredTime)) {
+      NumBytesTransfered = USBH_BUFFER_Read(&pInst->RxRingBuffer, pData, NumBytes);
+      NumBytes          -= NumBytesTransfered;
+      pData             += NumBytesTransfered;
+      NumBytesTotal     += NumBytesTransfered;
+      Status             = pInst->RxStatus;
+      pInst->RxStatus    = USBH_STATUS_SUCCESS;
+      if (Status == USBH_STATUS_SUCCESS) {
+        pInst->RxRunning = 1;                       // Start the engine with the first read, restart it after an error.
+      }
+      pNext = _RxReserve(pInst, 0);
+      //
+      // Event is reset while the queue is locked, so data stored afterwards always signals it.
+      //
+      USBH_OS_ResetEvent(pInst->pRxEvent);
+      USBH_OS_Unlock(USBH_MUTEX_FT232);
+      if (pNext != NULL) {
+        _RxSubmit(pInst, pNext);
+      }
+      if (Status != USBH_STATUS_SUCCESS || NumBytes == 0u) {
+        break;
+      }
+      if (pInst->AllowShortRead != 0u && NumBytesTotal != 0u) {
+        break;
+      }
+      if (pInst->Removed != 0) {
+        Status = USBH_STATUS_DEVICE_REMOVED;
+        break;
+      }
+      //
+      // Wait until the receive engine signals new data.
+      //
+      if (pInst->ReadTimeOut == 0u) {
+        USBH_OS_WaitEvent(pInst->pRxEvent);
+      } else {
+        TimeLeft = USBH_TimeDiff(ExpiredTime, USBH_OS_GetTime32());
+        if (TimeLeft <= 0) {
           Status = USBH_STATUS_TIMEOUT;
           break;
-        } else {
-          //
-          // Read a single packet from the device.
-          //
-          Status = USBH_BULK_Receive(pInst->hBulkDevice, pInst->BulkInEPAddr, pInst->pInBuffer, &NumBytesRead, USBH_FT232_DEFAULT_TIMEOUT);
-          if (Status == USBH_STATUS_SUCCESS) {
-            //
-            // In case we have more than 2 byte received, we have some application data
-            // First 2 byte are modem and line status bytes.
-            //
-            if (NumBytesRead != FT232_HEADER_SIZE) {
-              NumBytesRead -= FT232_HEADER_SIZE;
-              NumBytes2Copy = USBH_MIN(NumBytesRead, NumBytes);
-              USBH_MEMCPY(pData, &pInst->pInBuffer[FT232_HEADER_SIZE], NumBytes2Copy);
-              if (pNumBytesRead != NULL) {
-                *pNumBytesRead += NumBytes2Copy;
-              }
-              pData          += NumBytes2Copy;
-              NumBytes       -= NumBytes2Copy;
-              NumBytesRead   -= NumBytes2Copy;
-              if (NumBytesRead != 0u) {
-                USBH_BUFFER_Write(&pInst->RxRingBuffer, &pInst->pInBuffer[FT232_HEADER_SIZE + NumBytes2Copy], NumBytesRead);
-              }
-              if (pInst->AllowShortRead != 0u) {
-                break;
-              }
-            } else {
-              //
-              // Same as the FT232 PC driver, we would wait for approx. 15 ms before retrying.
-              // Otherwise we would achieve a high CPU load since the device always answers with the 2 status bytes.
-              //
-              USBH_OS_Delay(15);
-            }
-          }
         }
-      } while (NumBytes > 0u && Status == USBH_STATUS_SUCCESS);
+        (void)USBH_OS_WaitEventTimed(pInst->pRxEvent, (U32)TimeLeft);
+      }
+    }
+    if (pNumBytesRead != NULL) {
+      *pNumBytesRead = NumBytesTotal;
     }
   }
   if (Status != USBH_STATUS_SUCCESS && Status != USBH_STATUS_TIMEOUT) {
@@ -1485,6 +1699,12 @@ USBH_STATUS USBH_FT232_Purge(USBH_FT232_HANDLE hDevice, U32 Mask) {
     }
     Len = 0;
     Status = USBH_BULK_SetupRequest(pInst->hBulkDevice, USB_REQTYPE_VENDOR | USB_DEVICE_RECIPIENT, FT232_REQUEST_RESET, wValue, FT232_IFACE_ID, NULL, &Len, USBH_FT232_EP0_TIMEOUT);
+    if ((Mask & USBH_FT232_PURGE_RX) != 0u) {
+      USBH_OS_Lock(USBH_MUTEX_FT232);
+      pInst->RxRingBuffer.NumBytesIn = 0;
+      pInst->RxRingBuffer.RdPos      = 0;
+      USBH_OS_Unlock(USBH_MUTEX_FT232);
+    }
   }
   return Status;
 }
@@ -1525,6 +1745,46 @@ USBH_STATUS USBH_FT232_GetQueueStatus(USBH_FT232_HANDLE hDevice, U32 * pRxBytes)
   return Status;
 }
 
+/*********************************************************************
+*
+*       USBH_FT232_GetRxStatus
+*
+*  Function description
+*    Returns the status information collected by the receive engine.
+*
+*  Parameters
+*    hDevice   : Handle to the opened device.
+*    pRxStatus : [OUT] Pointer to a structure of type USBH_FT232_RX_STATUS
+*                which receives the status information.
+*
+*  Return value
+*    == USBH_STATUS_SUCCESS: Successful.
+*    != USBH_STATUS_SUCCESS: An error occurred.
+*
+*  Additional information
+*    Every packet sent by a FT232 device starts with the modem status and
+*    the line status. In contrast to USBH_FT232_GetModemStatus() this function
+*    does not send a request to the device, it returns the status of the
+*    last packet received. The line error bits are accumulated over all
+*    packets and cleared by this function.
+*/
+USBH_STATUS USBH_FT232_GetRxStatus(USBH_FT232_HANDLE hDevice, USBH_FT232_RX_STATUS * pRxStatus) {
+  USBH_FT232_INST * pInst;
+
+  pInst = _h2p(hDevice);
+  if (pInst == NULL) {
+    return USBH_STATUS_INVALID_HANDLE;
+  }
+  if (pInst->IsOpened == 0) {
+    return USBH_STATUS_NOT_OPENED;
+  }
+  USBH_OS_Lock(USBH_MUTEX_FT232);
+  *pRxStatus = pInst->RxInfo;
+  pInst->RxInfo.LineErrors = 0;
+  USBH_OS_Unlock(USBH_MUTEX_FT232);
+  return USBH_STATUS_SUCCESS;
+}
+
 /*********************************************************************
 *
 *       USBH_FT232_SetBreakOn
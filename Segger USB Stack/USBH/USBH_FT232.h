@@ -132,6 +132,22 @@ typedef struct {
   U16         MaxPacketSize;  // Maximum size of a single packet in bytes.
 } USBH_FT232_DEVICE_INFO;
 
+/*********************************************************************
+*
+*       USBH_FT232_RX_STATUS
+*
+*  Description
+*    Status information collected by the receive engine of a FT232 device.
+*/
+typedef struct {
+  U16         ModemStatus;      // Modem status (LSB) and line status (MSB) taken from the last packet received.
+  U8          LineErrors;       // Line status error bits (OE, PE, FE, BI) accumulated since the last call of USBH_FT232_GetRxStatus().
+  U32         NumBytesReceived; // Number of payload bytes received.
+  U32         NumTransfers;     // Number of completed IN transfers.
+  U32         NumStatusOnly;    // Number of IN transfers which contained the status bytes only.
+  U32         NumThrottled;     // Number of times the receive queue was too full to queue the next IN transfer.
+} USBH_FT232_RX_STATUS;
+
 typedef void USBH_FT232_USER_FUNC(void * pContext);
 
 U8                USBH_FT232_Init                     (void);
@@ -160,6 +176,7 @@ USBH_STATUS       USBH_FT232_GetModemStatus           (USBH_FT232_HANDLE hDevice
 USBH_STATUS       USBH_FT232_SetChars                 (USBH_FT232_HANDLE hDevice, U8 EventChar, U8 EventCharEnabled,  U8 ErrorChar, U8 ErrorCharEnabled);
 USBH_STATUS       USBH_FT232_Purge                    (USBH_FT232_HANDLE hDevice, U32 Mask);
 USBH_STATUS       USBH_FT232_GetQueueStatus           (USBH_FT232_HANDLE hDevice, U32 * pRxBytes);
+USBH_STATUS       USBH_FT232_GetRxStatus              (USBH_FT232_HANDLE hDevice, USBH_FT232_RX_STATUS * pRxStatus);
 
 USBH_INTERFACE_HANDLE USBH_FT232_GetInterfaceHandle   (USBH_FT232_HANDLE hDevice);
 
@@ -343,38 +343,45 @@ void USBH_CleanupDeviceList(void) {
   unsigned               NumHC;
   unsigned               i;
 
-  pDevice   = NULL;
-  NumHC = USBH_Global.HostControllerCount;
-  for (i = 0; i < NumHC; i++) {       // Search in all host controller
-    pHost = USBH_Global.aHostController[i];
-    USBH_ASSERT_MAGIC(pHost, USBH_HOST_CONTROLLER);
-    pDevEntry = USBH_DLIST_GetNext(&pHost->DeviceList);
-    while (pDevEntry != &pHost->DeviceList) { // Search in all devices
-      pUSBDev = GET_USB_DEVICE_FROM_ENTRY(pDevEntry);
-      USBH_ASSERT_MAGIC(pUSBDev, USB_DEVICE);
-      if (pUSBDev->State == DEV_STATE_REMOVED && pUSBDev->RefCount == 0) {
-        pDevice = pUSBDev;
+  //
+  // Several devices may be detached at once (e.g. all devices behind a removed hub).
+  // Deleting a device may release the last reference of its parent hub.
+  //
+  for (;;) {
+    pDevice   = NULL;
+    NumHC = USBH_Global.HostControllerCount;
+    for (i = 0; i < NumHC; i++) {       // Search in all host controller
+      pHost = USBH_Global.aHostController[i];
+      USBH_ASSERT_MAGIC(pHost, USBH_HOST_CONTROLLER);
+      pDevEntry = USBH_DLIST_GetNext(&pHost->DeviceList);
+      while (pDevEntry != &pHost->DeviceList) { // Search in all devices
+        pUSBDev = GET_USB_DEVICE_FROM_ENTRY(pDevEntry);
+        USBH_ASSERT_MAGIC(pUSBDev, USB_DEVICE);
+        if (pUSBDev->State == DEV_STATE_REMOVED && pUSBDev->RefCount == 0) {
+          pDevice = pUSBDev;
+        }
+        pDevEntry = USBH_DLIST_GetNext(pDevEntry);
       }
-      pDevEntry = USBH_DLIST_GetNext(pDevEntry);
     }
-  }
-  if (pDevice != NULL) {
+    if (pDevice == NULL) {
+      break;
+    }
     pHost = pDevice->pHostController;
     USBH_OS_Lock(USBH_MUTEX_DEVICE);
-    if (pHost->DeviceListLckCnt == 0u) {
-      //
-      // Remove device from linked list.
-      //
-      USBH_DLIST_RemoveEntry(&pDevice->ListEntry);
-      USBH_OS_Unlock(USBH_MUTEX_DEVICE);
-      //
-      // Delete device object.
-      //
-      USBH_DeleteDevice(pDevice);
-      USBH_HC_DEC_REF(pHost);
-    } else {
+    if (pHost->DeviceListLckCnt != 0u) {
       USBH_OS_Unlock(USBH_MUTEX_DEVICE);
+      break;
     }
+    //
+    // Remove device from linked list.
+    //
+    USBH_DLIST_RemoveEntry(&pDevice->ListEntry);
+    USBH_OS_Unlock(USBH_MUTEX_DEVICE);
+    //
+    // Delete device object.
+    //
+    USBH_DeleteDevice(pDevice);
+    USBH_HC_DEC_REF(pHost);
   }
 }
 
@@ -570,7 +577,7 @@ USBH_STATUS USBH_HCM_AllocContiguousMemory(U32 NumBytes, U32 Alignment, void **
     return USBH_STATUS_MEMORY;
   }
   if (!USBH_IS_ALIGNED(SEGGER_PTR2ADDR(pMemArea), Alignment)) {   // lint D:103[b]
-    USBH_WARN((USBH_MCAT_INIT, "ERROR _AllocContiguousMemory: Alignment error: virt. addr: 0x%lx!", pMemArea));
+    USBH_WARN((USBH_MCAT_INIT, "ERROR _AllocContiguousMemory: Alignment error: virt. addr: %p!", (void *)pMemArea));
     USBH_PANIC("Memory alignment");
   }
   PhyAddr = USBH_V2P(pMemArea);
@@ -578,7 +585,7 @@ USBH_STATUS USBH_HCM_AllocContiguousMemory(U32 NumBytes, U32 Alignment, void **
     USBH_PANIC("ERROR _AllocContiguousMemory: USBH_V2P: return NULL!");
   }
   if (!USBH_IS_ALIGNED(PhyAddr, Alignment)) { // Alignment error.
-    USBH_WARN((USBH_MCAT_INIT, "ERROR _AllocContiguousMemory: Alignment error: phys. addr: 0x%lx!", *pPhyAddr));
+    USBH_WARN((USBH_MCAT_INIT, "ERROR _AllocContiguousMemory: Alignment error: phys. addr: 0x%x!", (U32)PhyAddr));
     USBH_PANIC("Memory alignment");
   }
   *ppVirtAddr = pMemArea;
@@ -627,7 +634,7 @@ unsigned USBH_ClaimActivePortReset(USBH_HOST_CONTROLLER * pHost) {
     pHost->ActivePortReset = 1u;
 #endif
   }
-  USBH_LOG((USBH_MCAT_RHUB_SM, "ClaimPortReset %s: %x", (Ret == 0) ? "ok" : "fail", pHost->ActivePortReset));
+  USBH_LOG((USBH_MCAT_RHUB_SM, "ClaimPortReset %s: %x", (const char *)((Ret == 0) ? "ok" : "fail"), pHost->ActivePortReset));
   return Ret;
 }
 
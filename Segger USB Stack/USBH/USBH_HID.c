@@ -121,6 +121,13 @@ providing a function that is called by the base module every time, a new report
 #define USBH_HID_REPORT_TYPE_MASK         0xFCu
 #define USBH_HID_REPORT_LONG_ITEM         0xFEu
 
+//
+// Passes of the report descriptor compiler, see USBH_HID__CompileReportDesc().
+//
+#define HID_COMPILE_PASS_COUNT            0u          // Count all elements.
+#define HID_COMPILE_PASS_COUNT_IDS        1u          // Count the elements per report ID.
+#define HID_COMPILE_PASS_FILL             2u          // Store the elements, sorted by report ID.
+
 /*********************************************************************
 *
 *       Data structures
@@ -141,6 +148,13 @@ typedef struct {
   USBH_DLIST                  PluginList;
 } USBH_HID_GLOBAL;
 
+typedef struct {
+  HID_COMPILED_REPORT_DESC  * pDesc;
+  unsigned                    Pass;
+  unsigned                    NumFields;
+  unsigned                    MaxFields;
+} HID_COMPILE_CONTEXT;
+
 /*********************************************************************
 *
 *       Static const
@@ -188,6 +202,7 @@ static USBH_HID_REPORT_INFO *_FindReportInfo(USBH_HID_INST * pInst, unsigned ID)
     if (pInfo->ReportId == ID) {
       return pInfo;
     }
+    pInfo++;
   }
   return NULL;
 }
@@ -220,6 +235,80 @@ static void _SetReportInfo(USBH_HID_INST * pInst, const HID_FIELD_INFO * pField)
   }
 }
 
+/*********************************************************************
+*
+*       _CompileField()
+*
+*  Function description
+*    Called from report descriptor parser for each main item.
+*    Creates one compiled field for every element of the item.
+*    In the counting passes the elements are only counted, in total
+*    and per report ID. In the fill pass each field is stored at the
+*    end of the range of its report ID.
+*
+*  Parameters
+*    Flag        : Bit 0 = 0: Input item
+*                  Bit 0 = 1: Output item
+*                  Bit 1 = 0: Array item
+*                  Bit 1 = 1: Variable item
+*    pField      : Field info.
+*/
+static void _CompileField(unsigned Flag, const HID_FIELD_INFO *pField) {
+  HID_COMPILE_CONTEXT      * pCtx;
+  HID_COMPILED_REPORT_DESC * pDesc;
+  HID_REPORT_FIELD_RANGE   * pRange;
+  HID_REPORT_FIELD         * pRptField;
+  unsigned                   NumElements;
+  unsigned                   BitPos;
+  unsigned                   i;
+  U32                        Usage;
+
+  pCtx  = USBH_CTX2PTR(HID_COMPILE_CONTEXT, pField->pContext);
+  pDesc = pCtx->pDesc;
+  if (pField->RptSize == 0u || pField->RptSize > 32u) {
+    return;
+  }
+  NumElements = SEGGER_MIN(pField->RptCount, HID_REPORT_FIELD_MAX_ELEMENTS);
+  BitPos      = (Flag & 1u) != 0u ? pField->OutRptLen : pField->InRptLen;
+  for (i = 0; i < NumElements; i++) {
+    if (BitPos + pField->RptSize > 0xFFFFu) {
+      break;
+    }
+    if (pCtx->Pass != HID_COMPILE_PASS_COUNT && pCtx->NumFields >= pCtx->MaxFields) {
+      break;
+    }
+    if (pCtx->Pass == HID_COMPILE_PASS_COUNT_IDS) {
+      pDesc->aReportIdx[pField->ReportId]++;
+    } else if (pCtx->Pass == HID_COMPILE_PASS_FILL) {
+      //
+      // Variable items get one usage per element, the last usage applies to all remaining elements.
+      // Array items carry the first usage of the item, the element value selects the actual usage.
+      //
+      Usage = 0;
+      if (pField->UsageMax != 0u) {
+        Usage = pField->UsageMin;
+        if ((Flag & 2u) != 0u) {
+          Usage = SEGGER_MIN(pField->UsageMin + i, pField->UsageMax);
+        }
+      } else if (pField->NumUsages != 0u) {
+        Usage = pField->Usage[0];
+        if ((Flag & 2u) != 0u) {
+          Usage = pField->Usage[SEGGER_MIN(i, pField->NumUsages - 1u)];     //lint !e661 !e662  N:100
+        }
+      }
+      pRange    = &pDesc->paRange[pDesc->aReportIdx[pField->ReportId] - 1u];
+      pRptField = &pDesc->paField[pRange->FirstField + pRange->NumFields];
+      pRange->NumFields++;
+      USBH_HID__InitReportField(pRptField, BitPos, pField->RptSize, pField->Signed);
+      pRptField->Usage     = Usage;
+      pRptField->ReportId  = pField->ReportId;
+      pRptField->Flags    |= (U8)(Flag & (HID_REPORT_FIELD_OUTPUT | HID_REPORT_FIELD_VARIABLE));
+    }
+    pCtx->NumFields++;
+    BitPos += pField->RptSize;
+  }
+}
+
 /*********************************************************************
 *
 *       _CheckSigned()
@@ -329,20 +418,25 @@ static void _RemoveDevInstance(USBH_HID_INST * pInst) {
     //  Free all associated EP buffers
     //
     if (pInst->pInBuffer != NULL) {
-      USBH_FREE(pInst->pInBuffer);
+      USBH_INST_POOL_Free(&pInst->Pool, pInst->pInBuffer);
       pInst->pInBuffer = (U8 *)NULL;
     }
     if (pInst->pOutBuffer != NULL) {
-      USBH_FREE(pInst->pOutBuffer);
+      USBH_INST_POOL_Free(&pInst->Pool, pInst->pOutBuffer);
       pInst->pOutBuffer = (U8 *)NULL;
     }
     //
     //  Free the report descriptor
     //
     if (pInst->pReportBufferDesc != NULL) {
-      USBH_FREE(pInst->pReportBufferDesc);
+      USBH_INST_POOL_Free(&pInst->Pool, pInst->pReportBufferDesc);
       pInst->pReportBufferDesc = NULL;
     }
+    USBH_INST_POOL_Destroy(&pInst->Pool);
+    if (pInst->pCompiledDesc != NULL) {
+      USBH_FREE(pInst->pCompiledDesc);
+      pInst->pCompiledDesc = NULL;
+    }
     //
     // Remove instance from list
     //
@@ -1206,22 +1300,34 @@ static USBH_STATUS _StartDevice(USBH_HID_INST * pInst) {
     USBH_WARN((USBH_MCAT_HID, "USBH_GetDescriptor: failed (%s)!", USBH_GetStatusStr(Status)));
     goto Err;
   }
-  pInst->pReportBufferDesc =  (U8 *)USBH_TRY_MALLOC_ZEROED(pInst->ReportDescriptorSize);
+  //
+  // Reserve all buffers of the instance at once.
+  //
+  if (USBH_INST_POOL_Create(&pInst->Pool, USBH_INST_POOL_BLOCK_SIZE(pInst->ReportDescriptorSize) +
+                                          USBH_INST_POOL_BLOCK_SIZE(pInst->IntIn.MaxPacketSize)  +
+                                          USBH_INST_POOL_BLOCK_SIZE(pInst->IntOut.MaxPacketSize)) != 0) {
+    Status = USBH_STATUS_MEMORY;
+    goto Err;
+  }
+  pInst->pReportBufferDesc =  (U8 *)USBH_INST_POOL_Alloc(&pInst->Pool, pInst->ReportDescriptorSize);
   if (pInst->pReportBufferDesc == NULL) {
     Status = USBH_STATUS_MEMORY;
     goto Err;
   }
-  pInst->pInBuffer         =  (U8 *)USBH_TRY_MALLOC_ZEROED(pInst->IntIn.MaxPacketSize);
+  USBH_MEMSET(pInst->pReportBufferDesc, 0, pInst->ReportDescriptorSize);
+  pInst->pInBuffer         =  (U8 *)USBH_INST_POOL_Alloc(&pInst->Pool, pInst->IntIn.MaxPacketSize);
   if (pInst->pInBuffer == NULL) {
     Status = USBH_STATUS_MEMORY;
     goto Err;
   }
+  USBH_MEMSET(pInst->pInBuffer, 0, pInst->IntIn.MaxPacketSize);
   if (pInst->IntOut.MaxPacketSize != 0u) {
-    pInst->pOutBuffer      =  (U8 *)USBH_TRY_MALLOC_ZEROED(pInst->IntOut.MaxPacketSize);
+    pInst->pOutBuffer      =  (U8 *)USBH_INST_POOL_Alloc(&pInst->Pool, pInst->IntOut.MaxPacketSize);
     if (pInst->pOutBuffer == NULL) {
       Status = USBH_STATUS_MEMORY;
       goto Err;
     }
+    USBH_MEMSET(pInst->pOutBuffer, 0, pInst->IntOut.MaxPacketSize);
   }
   //
   // Get the report descriptor.
@@ -1475,6 +1581,244 @@ I32 USBH_HID__GetBitsSigned(const U8 * pData, unsigned FirstBit, unsigned NumBit
   return (I32)Data;
 }
 
+/*********************************************************************
+*
+*       USBH_HID__InitReportField
+*
+*  Function description
+*    Initializes a compiled field for the fast extractor USBH_HID__ExtractField().
+*
+*  Parameters
+*    pField      : Pointer to the field to be initialized.
+*    BitPos      : Position of the field in the report (excluding report ID).
+*    NumBits     : Size of the field in bits, 1..32.
+*    Signed      : != 0: Value is sign extended on extraction.
+*/
+void USBH_HID__InitReportField(HID_REPORT_FIELD * pField, unsigned BitPos, unsigned NumBits, unsigned Signed) {
+  USBH_MEMSET(pField, 0, sizeof(*pField));
+  if (NumBits == 0u || NumBits > 32u) {
+    NumBits = 0;
+  }
+  pField->BitPos   = (U16)BitPos;
+  pField->ByteOff  = (U16)(BitPos >> 3);
+  pField->Shift    = (U8)(BitPos & 7u);
+  pField->NumBits  = (U8)NumBits;
+  pField->NumBytes = NumBits != 0u ? (U8)((pField->Shift + NumBits + 7u) >> 3) : 0u;   // 0: Extraction returns 0 without accessing the report.
+  pField->Mask     = NumBits < 32u ? (1uL << NumBits) - 1u : 0xFFFFFFFFuL;
+  if (Signed != 0u && NumBits != 0u) {
+    pField->SignBit = 1uL << (NumBits - 1u);
+    pField->Flags   = HID_REPORT_FIELD_SIGNED;
+  }
+}
+
+/*********************************************************************
+*
+*       USBH_HID__ExtractField
+*
+*  Function description
+*    Extracts the value of a compiled field from a report.
+*
+*  Parameters
+*    pData       : Pointer to the report data (excluding report ID).
+*    pField      : Pointer to the compiled field.
+*
+*  Return value
+*    Value of the field. Signed fields are sign extended to 32 bits
+*    and can be cast to I32 by the caller.
+*
+*  Additional information
+*    Only the bytes covered by the field are accessed, so the caller only has
+*    to make sure that the report is at least (BitPos + NumBits + 7) / 8 bytes long.
+*/
+U32 USBH_HID__ExtractField(const U8 * pData, const HID_REPORT_FIELD * pField) {
+  U32 Value;
+
+  pData += pField->ByteOff;
+  switch (pField->NumBytes) {
+  case 1:
+    Value = pData[0];
+    break;
+  case 2:
+    Value = (U32)pData[0] | ((U32)pData[1] << 8);
+    break;
+  case 3:
+    Value = (U32)pData[0] | ((U32)pData[1] << 8) | ((U32)pData[2] << 16);
+    break;
+  case 4:
+    Value = USBH_LoadU32LE(pData);
+    break;
+  case 5:
+    //
+    // Unaligned field crossing 5 bytes, Shift is != 0 here.
+    //
+    Value  = USBH_LoadU32LE(pData) >> pField->Shift;
+    Value |= (U32)pData[4] << (32u - pField->Shift);
+    Value &= pField->Mask;
+    return (Value ^ pField->SignBit) - pField->SignBit;
+  default:
+    return 0;
+  }
+  Value = (Value >> pField->Shift) & pField->Mask;
+  return (Value ^ pField->SignBit) - pField->SignBit;
+}
+
+/*********************************************************************
+*
+*       USBH_HID__CompileReportDesc
+*
+*  Function description
+*    Compiles the report descriptor into a flat table of fields.
+*
+*  Parameters
+*    pInst       : Pointer to the HID instance.
+*
+*  Return value
+*    == USBH_STATUS_SUCCESS : Descriptor compiled (or was already compiled).
+*    != USBH_STATUS_SUCCESS : Error.
+*
+*  Additional information
+*    The descriptor is walked three times (count, count per report ID, fill),
+*    the resulting table is sorted by report ID and indexed by the report ID,
+*    so that plugins can locate all fields of a received report without
+*    walking the descriptor again.
+*    The table is freed together with the HID instance.
+*/
+USBH_STATUS USBH_HID__CompileReportDesc(USBH_HID_INST * pInst) {
+  HID_COMPILE_CONTEXT        Ctx;
+  HID_COMPILED_REPORT_DESC * pDesc;
+  unsigned                   NumRanges;
+  unsigned                   NumFields;
+  unsigned                   Id;
+
+  if (pInst->pCompiledDesc != NULL) {
+    return USBH_STATUS_SUCCESS;
+  }
+  if (pInst->pReportBufferDesc == NULL) {
+    return USBH_STATUS_ERROR;
+  }
+  //
+  // Pass 1: Count elements.
+  //
+  USBH_MEMSET(&Ctx, 0, sizeof(Ctx));
+  Ctx.Pass = HID_COMPILE_PASS_COUNT;
+  USBH_HID__ParseReportDesc(pInst, _CompileField, &Ctx);
+  if (Ctx.NumFields > 0xFFFFu) {
+    Ctx.NumFields = 0xFFFFu;
+  }
+  //
+  // Every report ID requires at most one range entry,
+  // the number of fields is an upper limit for the number of ranges.
+  //
+  pDesc = (HID_COMPILED_REPORT_DESC *)USBH_TRY_MALLOC_ZEROED(sizeof(HID_COMPILED_REPORT_DESC) +
+                                                              Ctx.NumFields * (sizeof(HID_REPORT_FIELD) + sizeof(HID_REPORT_FIELD_RANGE)));
+  if (pDesc == NULL) {
+    USBH_WARN((USBH_MCAT_HID, "USBH_HID__CompileReportDesc: No memory"));
+    return USBH_STATUS_MEMORY;
+  }
+  pDesc->paField  = (HID_REPORT_FIELD *)(pDesc + 1);
+  pDesc->paRange  = (HID_REPORT_FIELD_RANGE *)(pDesc->paField + Ctx.NumFields);
+  Ctx.pDesc       = pDesc;
+  Ctx.MaxFields   = Ctx.NumFields;
+  //
+  // Pass 2: Count elements per report ID in aReportIdx[].
+  //
+  Ctx.Pass        = HID_COMPILE_PASS_COUNT_IDS;
+  Ctx.NumFields   = 0;
+  USBH_HID__ParseReportDesc(pInst, _CompileField, &Ctx);
+  //
+  // Assign a range to every report ID in ascending order and build the direct index.
+  // The range is empty until it is filled in pass 3.
+  //
+  NumRanges = 0;
+  NumFields = 0;
+  for (Id = 0; Id < SEGGER_COUNTOF(pDesc->aReportIdx); Id++) {
+    if (pDesc->aReportIdx[Id] != 0u) {
+      pDesc->paRange[NumRanges].FirstField = (U16)NumFields;
+      NumFields += pDesc->aReportIdx[Id];
+      NumRanges++;
+      pDesc->aReportIdx[Id] = (U16)NumRanges;                // Up to 256 with fields in front of the first report ID item.
+    }
+  }
+  //
+  // Pass 3: Store every field at the end of its range. This sorts the table
+  // by report ID in linear time and keeps the descriptor order within a report,
+  // even if the descriptor interleaves the items of different reports.
+  //
+  Ctx.Pass        = HID_COMPILE_PASS_FILL;
+  Ctx.NumFields   = 0;
+  USBH_HID__ParseReportDesc(pInst, _CompileField, &Ctx);
+  pDesc->NumFields     = (U16)Ctx.NumFields;
+  pDesc->NumRanges     = (U16)NumRanges;
+  pInst->pCompiledDesc = pDesc;
+  USBH_LOG((USBH_MCAT_HID_RDESC, "Compiled report descriptor: %u fields, %u report IDs", pDesc->NumFields, NumRanges));
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       USBH_HID__GetReportFields
+*
+*  Function description
+*    Returns all compiled fields of a report.
+*
+*  Parameters
+*    pInst       : Pointer to the HID instance.
+*    ReportId    : Report ID (0 if the device does not use report IDs).
+*    pNumFields  : [OUT] Number of fields in the returned array.
+*
+*  Return value
+*    Pointer to the first field of the report or NULL, if the report has no fields
+*    or the descriptor was not compiled.
+*/
+const HID_REPORT_FIELD * USBH_HID__GetReportFields(const USBH_HID_INST * pInst, unsigned ReportId, unsigned * pNumFields) {
+  const HID_COMPILED_REPORT_DESC * pDesc;
+  const HID_REPORT_FIELD_RANGE   * pRange;
+  unsigned                         Idx;
+
+  *pNumFields = 0;
+  pDesc = pInst->pCompiledDesc;
+  if (pDesc == NULL || ReportId > 0xFFu) {
+    return NULL;
+  }
+  Idx = pDesc->aReportIdx[ReportId];
+  if (Idx == 0u) {
+    return NULL;
+  }
+  pRange      = &pDesc->paRange[Idx - 1u];
+  *pNumFields = pRange->NumFields;
+  return &pDesc->paField[pRange->FirstField];
+}
+
+/*********************************************************************
+*
+*       USBH_HID__FindReportField
+*
+*  Function description
+*    Locates a compiled field by report ID, usage and bit position.
+*
+*  Parameters
+*    pInst       : Pointer to the HID instance.
+*    ReportId    : Report ID (0 if the device does not use report IDs).
+*    Usage       : Usage page (high 16 bits) and usage ID.
+*    BitPos      : Bit position of the field in the report.
+*
+*  Return value
+*    Pointer to the field or NULL if not found.
+*/
+const HID_REPORT_FIELD * USBH_HID__FindReportField(const USBH_HID_INST * pInst, unsigned ReportId, U32 Usage, unsigned BitPos) {
+  const HID_REPORT_FIELD * pField;
+  unsigned                 NumFields;
+
+  pField = USBH_HID__GetReportFields(pInst, ReportId, &NumFields);
+  while (NumFields-- > 0u) {
+    if (pField->Usage == Usage && pField->BitPos == BitPos && (pField->Flags & HID_REPORT_FIELD_OUTPUT) == 0u) {
+      return pField;
+    }
+    pField++;
+  }
+  return NULL;
+}
+
 /*********************************************************************
 *
 *       USBH_HID__ParseReportDesc()
@@ -173,6 +173,15 @@ Purpose     : Internal header file of the HID module
 #define HID_MOUSE_MAGIC            FOUR_CHAR_ULONG('H','I','D','M')
 #define HID_FT260_MAGIC            FOUR_CHAR_ULONG('H','I','D','F')
 
+//
+// Flags of a compiled report field (HID_REPORT_FIELD::Flags).
+//
+#define HID_REPORT_FIELD_OUTPUT       (1u << 0)    // Field is part of an output report, else of an input report.
+#define HID_REPORT_FIELD_VARIABLE     (1u << 1)    // Variable item, else array item.
+#define HID_REPORT_FIELD_SIGNED       (1u << 2)    // Value is sign extended on extraction.
+
+#define HID_REPORT_FIELD_MAX_ELEMENTS 256u         // Max. number of elements compiled per main item.
+
 /*********************************************************************
 *
 *       Types
@@ -190,6 +199,44 @@ typedef enum {
   StateRunning      // Working state.
 } USBH_HID_STATE;
 
+//
+// One element of a report, compiled from the report descriptor.
+// All values required to extract the element are precomputed,
+// so that extraction is a single load, shift, mask and sign extension.
+//
+typedef struct {
+  U32                   Usage;             // Usage page (high 16 bits) and usage ID. For array items the first usage of the item.
+  U32                   Mask;              // Mask applied after shifting, (1 << NumBits) - 1.
+  U32                   SignBit;           // Highest bit of the value for signed fields, 0 for unsigned fields.
+  U16                   BitPos;            // Bit position in the report, excluding the report ID byte.
+  U16                   ByteOff;           // BitPos / 8.
+  U8                    Shift;             // BitPos % 8.
+  U8                    NumBits;           // Size of the element in bits (1..32).
+  U8                    NumBytes;          // Number of bytes touched by the element (1..5).
+  U8                    ReportId;
+  U8                    Flags;             // HID_REPORT_FIELD_...
+} HID_REPORT_FIELD;
+
+//
+// Range of compiled fields belonging to one report ID.
+//
+typedef struct {
+  U16                   FirstField;
+  U16                   NumFields;
+} HID_REPORT_FIELD_RANGE;
+
+//
+// Compiled report descriptor. Allocated as one block:
+// header, NumRanges range entries, NumFields field entries.
+//
+typedef struct {
+  U16                      NumFields;
+  U16                      NumRanges;
+  HID_REPORT_FIELD       * paField;        // Sorted by report ID, in descriptor order within a report.
+  HID_REPORT_FIELD_RANGE * paRange;
+  U16                      aReportIdx[256];  // Direct index: report ID -> index + 1 into paRange, 0 = no fields.
+} HID_COMPILED_REPORT_DESC;
+
 typedef struct {
   U8                    EPAddr;
   I8                    InUse;
@@ -219,8 +266,10 @@ struct _USBH_HID_INST {
   int                           ReadErrorCount;
   U32                           RefCnt;
   U8                          * pReportBufferDesc;
+  HID_COMPILED_REPORT_DESC    * pCompiledDesc;
   U8                          * pInBuffer;
   U8                          * pOutBuffer;
+  USBH_INST_POOL                Pool;               // Report descriptor, interrupt IN and OUT buffers.
   U16                           ReportDescriptorSize;
   U16                           IntErrCnt;
   USBH_TIME                     LastIntErr;
@@ -348,6 +397,11 @@ I32         USBH_HID__GetBitsSigned(const U8 * pData, unsigned FirstBit, unsigne
 USBH_STATUS USBH_HID__SubmitOutBuffer(USBH_HID_INST * pInst, const U8 * pBuffer, U32 NumBytes, USBH_HID_USER_FUNC * pfUser, USBH_HID_RW_CONTEXT * pRWContext, unsigned Flags);
 USBH_STATUS USBH_HID__SubmitOut(USBH_HID_INST * pInst, const U8 * pBuffer, U32 NumBytes);
 void        USBH_HID__ParseReportDesc(USBH_HID_INST * pInst, _CHECK_REPORT_DESC_FUNC *pCheckFunc, void *pContext);
+USBH_STATUS USBH_HID__CompileReportDesc(USBH_HID_INST * pInst);
+void        USBH_HID__InitReportField(HID_REPORT_FIELD * pField, unsigned BitPos, unsigned NumBits, unsigned Signed);
+U32         USBH_HID__ExtractField(const U8 * pData, const HID_REPORT_FIELD * pField);
+const HID_REPORT_FIELD * USBH_HID__GetReportFields(const USBH_HID_INST * pInst, unsigned ReportId, unsigned * pNumFields);
+const HID_REPORT_FIELD * USBH_HID__FindReportField(const USBH_HID_INST * pInst, unsigned ReportId, U32 Usage, unsigned BitPos);
 USBH_STATUS USBH_HID__GetReportCtrl(USBH_HID_INST * pInst, U8 ReportID, unsigned Flags, U8 * pBuffer, U32 Length, U32 * pNumBytesRead);
 
 void USBH_HID_RegisterPlugin(USBH_HID_DETECTION_HOOK *pHook);
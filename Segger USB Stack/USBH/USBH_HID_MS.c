@@ -78,6 +78,10 @@ typedef struct {
   USBH_HID_INST             * pInst;
   USBH_HID_HANDLER_HOOK       HandlerHook;
   HID_MOUSE_INFO              MouseInfo;
+  HID_REPORT_FIELD            ButtonsField;        // Compiled from MouseInfo after parsing the report descriptor.
+  HID_REPORT_FIELD            xField;
+  HID_REPORT_FIELD            yField;
+  HID_REPORT_FIELD            WheelField;
 } USBH_HID_MS_INST;
 
 //
@@ -160,10 +164,10 @@ static int _ParseMouseData(void *pContext, const U8 *pReport, unsigned ReportLen
       ReportLen--;
     }
     if (ReportLen >= pMouseInfo->ReportSize) {
-      MouseData.ButtonState = USBH_HID__GetBits      (pReport, pMouseInfo->ButtonsBitPosStart, pMouseInfo->ButtonsNumBits);
-      MouseData.xChange     = USBH_HID__GetBitsSigned(pReport, pMouseInfo->xBitPosStart,       pMouseInfo->xNumBits);
-      MouseData.yChange     = USBH_HID__GetBitsSigned(pReport, pMouseInfo->yBitPosStart,       pMouseInfo->yNumBits);
-      MouseData.WheelChange = USBH_HID__GetBitsSigned(pReport, pMouseInfo->WheelBitPosStart,   pMouseInfo->WheelNumBits);
+      MouseData.ButtonState =      USBH_HID__ExtractField(pReport, &pInst->ButtonsField);
+      MouseData.xChange     = (I32)USBH_HID__ExtractField(pReport, &pInst->xField);
+      MouseData.yChange     = (I32)USBH_HID__ExtractField(pReport, &pInst->yField);
+      MouseData.WheelChange = (I32)USBH_HID__ExtractField(pReport, &pInst->WheelField);
       MouseData.InterfaceID = pBaseInst->InterfaceID;
       USBH_HID_MS_Global.pfOnMouseStateChange(&MouseData);
     }
@@ -337,6 +341,10 @@ static void _DetectMS(USBH_HID_INST * p) {
     }
     USBH_MEMSET(&pInst->MouseInfo, 0, sizeof(pInst->MouseInfo));
     USBH_HID__ParseReportDesc(p, _FindMouseInfo, pInst);
+    USBH_HID__InitReportField(&pInst->ButtonsField, pInst->MouseInfo.ButtonsBitPosStart, SEGGER_MIN(pInst->MouseInfo.ButtonsNumBits, 32u), 0);
+    USBH_HID__InitReportField(&pInst->xField,       pInst->MouseInfo.xBitPosStart,       pInst->MouseInfo.xNumBits,     1);
+    USBH_HID__InitReportField(&pInst->yField,       pInst->MouseInfo.yBitPosStart,       pInst->MouseInfo.yNumBits,     1);
+    USBH_HID__InitReportField(&pInst->WheelField,   pInst->MouseInfo.WheelBitPosStart,   pInst->MouseInfo.WheelNumBits, 1);
     USBH_LOG((USBH_MCAT_HID_RDESC, "Parsed mouse info, Report ID = %x, Size = %u", pInst->MouseInfo.ReportId, pInst->MouseInfo.ReportSize));
     USBH_LOG((USBH_MCAT_HID_RDESC, "  Button off=%u, bits=%u", pInst->MouseInfo.ButtonsBitPosStart, pInst->MouseInfo.ButtonsNumBits));
     USBH_LOG((USBH_MCAT_HID_RDESC, "  X      off=%u, bits=%u", pInst->MouseInfo.xBitPosStart, pInst->MouseInfo.xNumBits));
@@ -64,6 +64,7 @@ typedef struct {
 #endif
   USBH_HID_INST             * pInst;
   U16                         NumGenericInfos;
+  const HID_REPORT_FIELD   ** papField;            // Compiled field for each entry of GenericInfo, NULL if not bound.
   USBH_HID_HANDLER_HOOK       HandlerHook;
   USBH_HID_GENERIC_DATA       GenericInfo[1];
 } USBH_HID_TP_INST;
@@ -120,6 +121,9 @@ static int _ParseGenericData(void *pContext, const U8 *pReport, unsigned ReportL
   int                    Found = 0;
   U8                     ReportID = 0;
   USBH_HID_GENERIC_DATA *pInfo;
+  const HID_REPORT_FIELD *pField;
+  const HID_REPORT_FIELD *pFirst;
+  unsigned               NumFields;
 
   if (Handled != 0) {
     return 0;
@@ -131,10 +135,23 @@ static int _ParseGenericData(void *pContext, const U8 *pReport, unsigned ReportL
     ReportID = *pReport++;
     ReportLen--;
   }
-  pInfo = pInst->GenericInfo;
+  //
+  // Fields bound to the compiled descriptor: The direct index delivers
+  // the fields of this report, so the report ID needs not to be compared per usage.
+  //
+  pFirst = USBH_HID__GetReportFields(pBaseInst, ReportID, &NumFields);
+  pInfo  = pInst->GenericInfo;
   for (i = 0; i < pInst->NumGenericInfos; i++) {
     pInfo->Valid = 0;
-    if (pInfo->Usage != 0u &&
+    pField = pInst->papField[i];
+    if (pField != NULL) {
+      if (pField >= pFirst && pField < pFirst + NumFields &&
+          (unsigned)pField->BitPos + pField->NumBits <= 8u * ReportLen) {
+        pInfo->Value.u32 = USBH_HID__ExtractField(pReport, pField);
+        pInfo->Valid = 1;
+        Found        = 1;
+      }
+    } else if (pInfo->Usage != 0u &&
         (ReportID == 0u || ReportID == pInfo->ReportID) &&
         (unsigned)pInfo->BitPosStart + pInfo->NumBits <= 8u * ReportLen) {
       //
@@ -284,27 +301,41 @@ static void _DetectTP(USBH_HID_INST * p) {
   unsigned               i;
   USBH_HID_GENERIC_DATA *pInfo;
   int                    Found;
+  U32                    Size;
 
   USBH_ASSERT(USBH_HID_TP_Global.NumGenericUsages > 0);
-  pInst = (USBH_HID_TP_INST *)USBH_TRY_MALLOC_ZEROED(sizeof(USBH_HID_TP_INST) +
-                                                     (USBH_HID_TP_Global.NumGenericUsages - 1uL) * sizeof(USBH_HID_GENERIC_DATA));
+  //
+  // Instance, GenericInfo[] and papField[] are allocated as one block.
+  //
+  Size  = sizeof(USBH_HID_TP_INST) + (USBH_HID_TP_Global.NumGenericUsages - 1uL) * sizeof(USBH_HID_GENERIC_DATA);
+  Size  = (Size + sizeof(void *) - 1u) & ~(sizeof(void *) - 1u);
+  pInst = (USBH_HID_TP_INST *)USBH_TRY_MALLOC_ZEROED(Size + USBH_HID_TP_Global.NumGenericUsages * sizeof(HID_REPORT_FIELD *));
   if (pInst == NULL) {
     USBH_WARN((USBH_MCAT_HID, "HID_TP: _DetectTP: No memory"));
     return;
   }
   USBH_IFDBG(pInst->Magic = HID_GENERIC_MAGIC);
   pInst->pInst = p;
+  pInst->papField = (const HID_REPORT_FIELD **)(void *)((U8 *)pInst + Size);     //lint !e9087  N:102
   pInst->HandlerHook.pContext = pInst;
   pInst->HandlerHook.pHandler = _ParseGenericData;
   pInst->HandlerHook.pRemove  = _RemoveInst;
   USBH_IFDBG(pInst->HandlerHook.Magic = HID_HANDLER_MAGIC);
   pInst->NumGenericInfos = USBH_HID_TP_Global.NumGenericUsages;
   USBH_HID__ParseReportDesc(p, _FindGenericInfo, pInst);
+  //
+  // Bind usages to the compiled report descriptor for fast extraction.
+  // If compiling fails, values are extracted using the field info from the parser.
+  //
+  (void)USBH_HID__CompileReportDesc(p);
   pInfo = pInst->GenericInfo;
   Found = 0;
   for (i = 0; i < pInst->NumGenericInfos; i++) {
     if (pInfo->Usage != 0u) {
       Found = 1;
+      if (pInfo->Usage != USBH_HID_USAGE_DEVICE_TYPE) {
+        pInst->papField[i] = USBH_HID__FindReportField(p, pInfo->ReportID, pInfo->Usage, pInfo->BitPosStart);
+      }
     }
     pInfo++;
   }
@@ -1070,27 +1070,33 @@ static USBH_STATUS _DWC2_AddUrbIso(USBH_DWC2_EP_INFO * pEP, USBH_URB * pUrb) {
   EP_VALID(pEP);
   USBH_LOG((USBH_MCAT_DRIVER_URB, "_DWC2_AddUrbIso: EP: 0x%x!", pEP->EndpointAddress));
   pEP->Channel = DWC2_INVALID_CHANNEL;
-  USBH_OS_Lock(USBH_MUTEX_DRIVER);
+  USBH_OS_DisableInterrupt();
   if (pEP->pPendingUrb == NULL) {
     pEP->pPendingUrb = pUrb;
     Status = USBH_STATUS_SUCCESS;
   } else {
     Status = USBH_STATUS_BUSY;
   }
-  USBH_OS_Unlock(USBH_MUTEX_DRIVER);
+  USBH_OS_EnableInterrupt();
   if (Status != USBH_STATUS_SUCCESS) {
     return Status;
   }
   pInst = pEP->pInst;
   USBH_DWC2_IS_DEV_VALID(pInst);
   if (pEP->pBuffer == NULL) {
+    //
+    // Allocate the packet ring. Each packet buffer starts on a cache line,
+    // so the buffers can be cleaned / invalidated independently.
+    //
 #if defined(USBH_DWC2_CACHE_LINE_SIZE) && USBH_DWC2_USE_DMA != 0
     PacketSize = ((U32)pEP->MaxPacketSize + USBH_DWC2_CACHE_LINE_SIZE - 1uL) & ~(USBH_DWC2_CACHE_LINE_SIZE - 1uL);
-    pEP->pBuffer = (U8 *)USBH_TRY_MALLOC_XFERMEM(2u * PacketSize, USBH_DWC2_CACHE_LINE_SIZE);
-    USBH_CacheConfig.pfInvalidate(pEP->pBuffer, PacketSize);
+    pEP->pBuffer = (U8 *)USBH_TRY_MALLOC_XFERMEM(USBH_DWC2_ISO_NUM_BUFFERS * PacketSize, USBH_DWC2_CACHE_LINE_SIZE);
+    if (pEP->pBuffer != NULL) {
+      USBH_CacheConfig.pfInvalidate(pEP->pBuffer, USBH_DWC2_ISO_NUM_BUFFERS * PacketSize);
+    }
 #else
     PacketSize = (pEP->MaxPacketSize + 3uL) & ~3uL;
-    pEP->pBuffer = (U8 *)USBH_TRY_MALLOC_XFERMEM(2u * PacketSize, 4);
+    pEP->pBuffer = (U8 *)USBH_TRY_MALLOC_XFERMEM(USBH_DWC2_ISO_NUM_BUFFERS * PacketSize, 4);
 #endif
     if (pEP->pBuffer == NULL) {
       USBH_WARN((USBH_MCAT_DRIVER_URB, "_DWC2_AddUrbIso: No resources for buffer!"));
@@ -1103,14 +1109,18 @@ static USBH_STATUS _DWC2_AddUrbIso(USBH_DWC2_EP_INFO * pEP, USBH_URB * pUrb) {
     pEP->pPendingUrb = NULL;
     return USBH_STATUS_NO_CHANNEL;
   }
-  pUrb->Request.IsoRequest.NBuffers = 2;
+  pUrb->Request.IsoRequest.NBuffers = USBH_DWC2_ISO_NUM_BUFFERS;
   pEP->BuffBusy                     = 0;
+  pEP->IsoAppPos                    = 0;
+  pEP->IsoHwPos                     = 0;
+  pEP->IsoFrameValid                = 0;
   pChannelInfo->EndpointAddress     = pEP->EndpointAddress;
   if ((pEP->EndpointAddress & 0x80u) != 0u) {
-    pEP->BuffReadyList[0] = 1;
-    pEP->BuffReadyList[1] = 2;
-    pEP->BuffWaitList[0]  = 0;
-    pEP->BuffWaitList[1]  = 0;
+    //
+    // All buffers are queued for reception.
+    //
+    pEP->IsoNumReady = USBH_DWC2_ISO_NUM_BUFFERS;
+    pEP->IsoNumWait  = 0;
     _DWC2_CHANNEL_Open(pInst, pChannelInfo);
 #if USBH_DWC2_SUPPORT_SPLIT_TRANSACTIONS
     if (pChannelInfo->UseSplitTransactions != 0) {
@@ -1122,11 +1132,12 @@ static USBH_STATUS _DWC2_AddUrbIso(USBH_DWC2_EP_INFO * pEP, USBH_URB * pUrb) {
 #endif
     _DWC2_StartISO(pInst, pEP, pChannelInfo);
   } else {
-    pEP->BuffReadyList[0] = 0;
-    pEP->BuffReadyList[1] = 0;
-    pEP->BuffWaitList[0]  = 1;
-    pEP->BuffWaitList[1]  = 2;
-    pEP->FirstTimeData    = 1;
+    //
+    // All buffers must be filled by the application.
+    //
+    pEP->IsoNumReady   = 0;
+    pEP->IsoNumWait    = USBH_DWC2_ISO_NUM_BUFFERS;
+    pEP->FirstTimeData = 1;
   }
   return USBH_STATUS_PENDING;
 }
@@ -1303,7 +1314,7 @@ static void _ProcessInterrupt(USBH_HC_HANDLE hHostController) {
 static USBH_DWC2_INST * _DWC2_CreateController(PTR_ADDR BaseAddress) {
   USBH_DWC2_INST * pHostControllerDev;
 
-  USBH_LOG((USBH_MCAT_DRIVER, "_DWC2_CreateController: BaseAddress: 0x%lx ", BaseAddress));
+  USBH_LOG((USBH_MCAT_DRIVER, "_DWC2_CreateController: BaseAddress: 0x%x ", (U32)BaseAddress));
   USBH_ASSERT(BaseAddress != 0);
   pHostControllerDev = (USBH_DWC2_INST *)USBH_MALLOC_ZEROED(sizeof(USBH_DWC2_INST));
   USBH_IFDBG(pHostControllerDev->Magic = USBH_DWC2_INST_MAGIC);
@@ -1330,7 +1341,11 @@ static USBH_DWC2_CHANNEL_INFO * _DWC2_CHANNEL_Allocate(USBH_DWC2_INST * pInst, U
     pChannelInfo = &pInst->aChannelInfo[1];
   }
   pHwChannel   = &pInst->pHWReg->aHChannel[Channel];
-  USBH_OS_Lock(USBH_MUTEX_DRIVER);
+  //
+  // The search is bounded by the number of channels and does not call out,
+  // so a short critical section is used instead of the driver mutex.
+  //
+  USBH_OS_DisableInterrupt();
   for (; Channel < DWC2_NUM_CHANNELS; Channel++) {
     if (pChannelInfo->InUse == FALSE && (pHwChannel->HCCHAR & HCCHAR_CHENA) == 0u) {
       pChannelInfo->InUse   = TRUE;
@@ -1340,13 +1355,13 @@ static USBH_DWC2_CHANNEL_INFO * _DWC2_CHANNEL_Allocate(USBH_DWC2_INST * pInst, U
       pHwChannel->HCINT = CHANNEL_MASK;
       pInst->UsedChannelMask |= (1uL << Channel);
       pEP->Channel = Channel;
-      USBH_OS_Unlock(USBH_MUTEX_DRIVER);
+      USBH_OS_EnableInterrupt();
       return pChannelInfo;
     }
     pChannelInfo++;
     pHwChannel++;
   }
-  USBH_OS_Unlock(USBH_MUTEX_DRIVER);
+  USBH_OS_EnableInterrupt();
   USBH_WARN((USBH_MCAT_DRIVER_EP, "_DWC2_CHANNEL_Allocate: No free channels!"));
   return NULL;
 }
@@ -1360,6 +1375,14 @@ static void _DWC2_CHANNEL_DeAllocate(USBH_DWC2_INST * pInst, USBH_DWC2_CHANNEL_I
   pChannel->NumBytes2Transfer    = 0;
   pChannel->NumBytesTransferred  = 0;
   pChannel->ToBePushed           = 0;
+  if (pChannel->TimerInUse != FALSE) {
+    USBH_ReleaseTimer(&pChannel->IntervalTimer);
+    pChannel->TimerInUse = FALSE;
+  }
+  //
+  // Channel masks are shared with _DWC2_CHANNEL_Allocate().
+  //
+  USBH_OS_DisableInterrupt();
   pInst->UsedChannelMask        &= ~(1uL << pChannel->Channel);
 #if USBH_DWC2_USE_DMA == 0
   pInst->ReStartChannelMask &= pInst->UsedChannelMask;
@@ -1367,11 +1390,8 @@ static void _DWC2_CHANNEL_DeAllocate(USBH_DWC2_INST * pInst, USBH_DWC2_CHANNEL_I
 #if USBH_DWC2_SUPPORT_SPLIT_TRANSACTIONS
   pInst->StartChannelMask &= pInst->UsedChannelMask;
 #endif
-  if (pChannel->TimerInUse != FALSE) {
-    USBH_ReleaseTimer(&pChannel->IntervalTimer);
-    pChannel->TimerInUse = FALSE;
-  }
   pChannel->InUse        = FALSE;
+  USBH_OS_EnableInterrupt();
 }
 
 /*********************************************************************
@@ -1446,20 +1466,15 @@ static void _DWC2_EnableInterrupts(USBH_DWC2_INST * pInst) {
 #if USBH_SUPPORT_ISO_TRANSFER
 static void _DWC2_StartISO(USBH_DWC2_INST * pInst, USBH_DWC2_EP_INFO * pEP, USBH_DWC2_CHANNEL_INFO * pChannelInfo) {
   //
-  // Get next buffer from ready list
+  // Get next buffer from the ready part of the ring.
   //
-  pEP->BuffBusy                     = pEP->BuffReadyList[0];
-  pEP->BuffReadyList[0]             = pEP->BuffReadyList[1];
-  pEP->BuffReadyList[1]             = 0;
+  pEP->BuffBusy                     = 1;
+  pEP->IsoNumReady--;
   pChannelInfo->NumBytesPushed      = 0;
   pChannelInfo->NumBytesTransferred = 0;
-  pChannelInfo->pBuffer             = pEP->pBuffer;
-  if (pEP->BuffBusy == 2) {
-    pChannelInfo->pBuffer += pEP->BuffSize;
-  }
+  pChannelInfo->pBuffer             = pEP->pBuffer + pEP->IsoHwPos * pEP->BuffSize;
   if ((pEP->EndpointAddress & 0x80u) == 0u) {
-    pChannelInfo->NumBytesTotal     = pEP->BuffReadySize[0];
-    pEP->BuffReadySize[0]           = pEP->BuffReadySize[1];
+    pChannelInfo->NumBytesTotal     = pEP->aIsoPacket[pEP->IsoHwPos].Length;
   }
   pChannelInfo->Status = USBH_STATUS_SUCCESS;
   _DWC2_CHANNEL_StartTransfer(pInst, pChannelInfo);
@@ -1476,7 +1491,7 @@ static void _DWC2_StartISO(USBH_DWC2_INST * pInst, USBH_DWC2_EP_INFO * pEP, USBH
 #if USBH_SUPPORT_ISO_TRANSFER
 static USBH_STATUS _IsoDataCtrl(USBH_HC_EP_HANDLE hEndPoint, USBH_ISO_DATA_CTRL *pIsoData) {
   USBH_DWC2_EP_INFO    * pEPInfo;
-  I8                     BuffNo;
+  unsigned               BuffNo;
   USBH_STATUS            Status;
   U8                   * pBuffer;
   U32                    Length;
@@ -1499,30 +1514,20 @@ static USBH_STATUS _IsoDataCtrl(USBH_HC_EP_HANDLE hEndPoint, USBH_ISO_DATA_CTRL
       goto Done;
     }
   }
-  BuffNo = pEPInfo->BuffWaitList[0];
-  if (BuffNo == 0 || pEPInfo->BuffReadyList[1] != 0) {
+  if (pEPInfo->IsoNumWait == 0u) {
     Status = USBH_STATUS_BUSY;
     goto Done;
   }
   //
-  // Remove buffer from wait list
-  //
-  pEPInfo->BuffWaitList[0] = pEPInfo->BuffWaitList[1];
-  pEPInfo->BuffWaitList[1] = 0;
+  // Move the oldest buffer of the application to the end of the ready queue.
+  // As the ring has no gaps, this is the same ring position.
   //
-  // Append buffer to ready list
-  //
-  if (pEPInfo->BuffReadyList[0] == 0) {
-    pEPInfo->BuffReadyList[0] = BuffNo;
-    pEPInfo->BuffReadySize[0] = Length;
-  } else {
-    pEPInfo->BuffReadyList[1] = BuffNo;
-    pEPInfo->BuffReadySize[1] = Length;
-  }
-  pBuffer = pEPInfo->pBuffer;
-  if (BuffNo == 2) {
-    pBuffer += pEPInfo->BuffSize;
-  }
+  BuffNo = pEPInfo->IsoAppPos;
+  pEPInfo->IsoAppPos = (U8)((BuffNo + 1u) % USBH_DWC2_ISO_NUM_BUFFERS);
+  pEPInfo->IsoNumWait--;
+  pEPInfo->IsoNumReady++;
+  pEPInfo->aIsoPacket[BuffNo].Length = (U16)Length;
+  pBuffer = pEPInfo->pBuffer + BuffNo * pEPInfo->BuffSize;
   pIsoData->pBuffer = pBuffer;
   Status = USBH_STATUS_SUCCESS;
   if (IsInDir == 0u) {
@@ -1546,7 +1551,7 @@ static USBH_STATUS _IsoDataCtrl(USBH_HC_EP_HANDLE hEndPoint, USBH_ISO_DATA_CTRL
 #endif
       goto Done;
     }
-    if (pEPInfo->BuffWaitList[0] != 0) {
+    if (pEPInfo->IsoNumWait != 0u) {
       Status = USBH_STATUS_NEED_MORE_DATA;
     }
   }
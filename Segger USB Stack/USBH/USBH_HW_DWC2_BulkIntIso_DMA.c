@@ -174,14 +174,14 @@ static USBH_STATUS _DWC2_AddUrb2EPx(USBH_DWC2_EP_INFO * pEP, USBH_URB * pUrb) {
   EP_VALID(pEP);
   USBH_LOG((USBH_MCAT_DRIVER_URB, "_DWC2_AddUrb2EPx: pEPInfo: 0x%x!", pEP->EndpointAddress));
   pEP->Channel = DWC2_INVALID_CHANNEL;
-  USBH_OS_Lock(USBH_MUTEX_DRIVER);
+  USBH_OS_DisableInterrupt();
   if (pEP->pPendingUrb == NULL) {
     pEP->pPendingUrb = pUrb;
     Status = USBH_STATUS_SUCCESS;
   } else {
     Status = USBH_STATUS_BUSY;
   }
-  USBH_OS_Unlock(USBH_MUTEX_DRIVER);
+  USBH_OS_EnableInterrupt();
   if (Status != USBH_STATUS_SUCCESS) {
     return Status;
   }
@@ -333,6 +333,10 @@ static void _DWC2_HandleEPIso(USBH_DWC2_INST * pInst, USBH_DWC2_CHANNEL_INFO * p
   USBH_DWC2_EP_INFO      * pEPInfo;
   USBH_URB               * pUrb;
   U8                     * pData;
+  USBH_DWC2_ISO_PACKET   * pPacket;
+  U16                      FrameNumber;
+  U16                      FramePeriod;
+  U16                      NumMissed;
 
   pHwChannel   = pChannelInfo->pHWChannel;
   IntStatus    = pHwChannel->HCINT;
@@ -365,20 +369,37 @@ static void _DWC2_HandleEPIso(USBH_DWC2_INST * pInst, USBH_DWC2_CHANNEL_INFO * p
   if (Status != USBH_STATUS_SUCCESS) {
     goto End;
   }
-  USBH_OS_Lock(USBH_MUTEX_DRIVER);
-  if (pEPInfo->BuffWaitList[0] == 0) {
-    pEPInfo->BuffWaitList[0] = pEPInfo->BuffBusy;
-  } else {
-    pEPInfo->BuffWaitList[1] = pEPInfo->BuffBusy;
-  }
-  pUrb->Header.Status             = USBH_STATUS_SUCCESS;
-  pUrb->Request.IsoRequest.Status = Status;
-  pUrb->Request.IsoRequest.Length = pChannelInfo->NumBytesTransferred;
-  pData                           = pEPInfo->pBuffer;
-  if (pEPInfo->BuffBusy == 2) {
-    pData += pEPInfo->BuffSize;
+  //
+  // Detect (micro)frames without a transfer. Each transfer takes one frame (1 ms),
+  // the frame counter of a high-speed host counts micro frames.
+  //
+  FrameNumber = (U16)(pInst->pHWReg->HFNUM & 0x3FFFu);
+  FramePeriod = (pEPInfo->Speed == USBH_HIGH_SPEED) ? 8u : 1u;
+  NumMissed   = 0;
+  if (pEPInfo->IsoFrameValid != 0) {
+    NumMissed = (U16)(((FrameNumber - pEPInfo->IsoLastFrame) & 0x3FFFu) / FramePeriod);
+    if (NumMissed != 0u) {
+      NumMissed--;
+    }
   }
-  pUrb->Request.IsoRequest.pData  = pData;
+  pEPInfo->IsoLastFrame  = FrameNumber;
+  pEPInfo->IsoFrameValid = 1;
+  USBH_OS_Lock(USBH_MUTEX_DRIVER);
+  //
+  // Move the completed buffer to the application part of the ring.
+  //
+  pPacket              = &pEPInfo->aIsoPacket[pEPInfo->IsoHwPos];
+  pPacket->Length      = (U16)pChannelInfo->NumBytesTransferred;
+  pPacket->FrameNumber = FrameNumber;
+  pData                = pEPInfo->pBuffer + pEPInfo->IsoHwPos * pEPInfo->BuffSize;
+  pEPInfo->IsoHwPos    = (U8)((pEPInfo->IsoHwPos + 1u) % USBH_DWC2_ISO_NUM_BUFFERS);
+  pEPInfo->IsoNumWait++;
+  pUrb->Header.Status                      = USBH_STATUS_SUCCESS;
+  pUrb->Request.IsoRequest.Status          = Status;
+  pUrb->Request.IsoRequest.Length          = pPacket->Length;
+  pUrb->Request.IsoRequest.pData           = pData;
+  pUrb->Request.IsoRequest.FrameNumber     = FrameNumber;
+  pUrb->Request.IsoRequest.NumMissedFrames = NumMissed;
 #ifdef USBH_DWC2_CACHE_LINE_SIZE
   if ((pEPInfo->EndpointAddress & 0x80u) != 0u) {
     USBH_CacheConfig.pfInvalidate(pData, pChannelInfo->NumBytesTransferred);
@@ -388,7 +409,10 @@ static void _DWC2_HandleEPIso(USBH_DWC2_INST * pInst, USBH_DWC2_CHANNEL_INFO * p
   if (pEPInfo->Aborted != 0u) {
     Status = USBH_STATUS_CANCELED;
   } else {
-    if (pEPInfo->BuffReadyList[0] != 0) {
+    //
+    // Re-arm the channel for the next frame without waiting for the application.
+    //
+    if (pEPInfo->IsoNumReady != 0u) {
       _DWC2_StartISO(pInst, pEPInfo, pChannelInfo);
     }
   }
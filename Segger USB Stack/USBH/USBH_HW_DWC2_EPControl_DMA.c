@@ -947,14 +947,14 @@ static USBH_STATUS _DWC2_AddUrb2EP0(USBH_DWC2_EP_INFO * pEPInfo, USBH_URB * pUrb
   pUrbRequest         = &pUrb->Request.ControlRequest;
   pUrbRequest->Length = 0;
   pEPInfo->Channel = DWC2_INVALID_CHANNEL;
-  USBH_OS_Lock(USBH_MUTEX_DRIVER);
+  USBH_OS_DisableInterrupt();
   if (pEPInfo->pPendingUrb == NULL) {
     pEPInfo->pPendingUrb = pUrb;
     Status = USBH_STATUS_SUCCESS;
   } else {
     Status = USBH_STATUS_BUSY;
   }
-  USBH_OS_Unlock(USBH_MUTEX_DRIVER);
+  USBH_OS_EnableInterrupt();
   if (Status == USBH_STATUS_SUCCESS) {
     pInst = pEPInfo->pInst;
     USBH_DWC2_IS_DEV_VALID(pInst);
@@ -55,6 +55,10 @@ Purpose     : Header for the Synopsys DWC2 FullSpeed emUSB Host driver
 #ifndef   USBH_DWC2_NUM_RETRIES
   #define USBH_DWC2_NUM_RETRIES               3u // Number of retires of failed transmissions.
 #endif
+#ifndef   USBH_DWC2_ISO_NUM_BUFFERS
+  #define USBH_DWC2_ISO_NUM_BUFFERS           4u // Number of packet buffers of an ISO EP (2..127). The application may fall
+                                                 // behind by USBH_DWC2_ISO_NUM_BUFFERS - 1 frames without losing packets.
+#endif
 
 #define DWC2_INVALID_CHANNEL              0xFFu
 #define USBH_DWC2_HCCHANNEL_MAX_CHANNELS  24
@@ -283,6 +287,11 @@ typedef struct {
   USBH_TIMER                   IntervalTimer;
 } USBH_DWC2_CHANNEL_INFO;
 
+typedef struct {
+  U16                          Length;               // OUT: Number of bytes to send, IN: Number of bytes received.
+  U16                          FrameNumber;          // (Micro)frame number when the transfer was completed.
+} USBH_DWC2_ISO_PACKET;
+
 typedef struct { // The global driver object. The object is cleared in the function USBH_HostInit!
   USBH_DWC2_HWREGS                * pHWReg;                // Register base address
   volatile U32                    * pFifoRegBase;
@@ -330,15 +339,21 @@ typedef struct _USBH_DWC2_EP_INFO {
   I8                                UseReadBuff;
   USBH_BOOL                         ReleaseInProgress;
   //
-  // Used for ISO EPs
+  // Used for ISO EPs. The packet buffers form a ring:
+  // IsoNumWait buffers starting at IsoAppPos are processed by the application (IN: Must be acked, OUT: Must be filled),
+  // followed by the buffer at IsoHwPos used for data transfer (if BuffBusy) and IsoNumReady buffers queued for the hardware.
   //
-  U16                               BuffReadySize[2];
-  I8                                BuffReadyList[2];
-  I8                                BuffWaitList[2];      // Queue of buffers to be processed by the application:
-                                                          // IN: Must be acked, OUT: Must be filled.
-  I8                                BuffBusy;             // Indicates which buffer is currently used for data transfer:
-                                                          // 1: First buffer, 2: Second buffer, 0: None (Idle)
+#if USBH_SUPPORT_ISO_TRANSFER
+  USBH_DWC2_ISO_PACKET              aIsoPacket[USBH_DWC2_ISO_NUM_BUFFERS];
+#endif
+  U8                                IsoAppPos;
+  U8                                IsoHwPos;
+  U8                                IsoNumWait;
+  U8                                IsoNumReady;
+  I8                                BuffBusy;             // 1: Buffer at IsoHwPos is used for data transfer, 0: Idle
   I8                                FirstTimeData;
+  I8                                IsoFrameValid;        // IsoLastFrame is valid.
+  U16                               IsoLastFrame;         // Frame number of the last completed ISO transfer.
 #if USBH_DWC2_USE_DMA == 0
   U32                               aSetup[2];      // Control EP only (U32 for alignment)
 #endif
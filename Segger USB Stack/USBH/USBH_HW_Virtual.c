@@ -0,0 +1,1333 @@
+/*********************************************************************
+*                   (c) SEGGER Microcontroller GmbH                  *
+*                        The Embedded Experts                        *
+**********************************************************************
+*                                                                    *
+*       (c) 2003 - 2022     SEGGER Microcontroller GmbH              *
+*                                                                    *
+*       www.segger.com     Support: www.segger.com/ticket            *
+*                                                                    *
+**********************************************************************
+*                                                                    *
+*       emUSB-Host * USB Host stack for embedded applications        *
+*                                                                    *
+*       Please note: Knowledge of this file may under no             *
+*       circumstances be used to write a similar product.            *
+*       Thank you for your fairness !                                *
+*                                                                    *
+**********************************************************************
+*                                                                    *
+*       emUSB-Host version: V2.36.1                                  *
+*                                                                    *
+**********************************************************************
+----------------------------------------------------------------------
+Licensing information
+Licensor:                 SEGGER Microcontroller Systems LLC
+Licensed to:              React Health, Inc., 203 Avenue A NW, Suite 300, Winter Haven FL 33881, USA
+Licensed SEGGER software: emUSB-Host
+License number:           USBH-00304
+License model:            SSL [Single Developer Single Platform Source Code License]
+Licensed product:         -
+Licensed platform:        STM32F4, IAR
+Licensed number of seats: 1
+----------------------------------------------------------------------
+Support and Update Agreement (SUA)
+SUA period:               2022-05-19 - 2022-11-19
+Contact to extend SUA:    sales@segger.com
+----------------------------------------------------------------------
+File        : USBH_HW_Virtual.c
+Purpose     : Virtual host controller driving simulated devices
+-------------------------- END-OF-HEADER -----------------------------
+*/
+
+/*********************************************************************
+*
+*       #include Section
+*
+**********************************************************************
+*/
+#include "USBH_Int.h"
+#include "USBH_HW_Virtual.h"
+
+/*********************************************************************
+*
+*       Defines, configurable
+*
+**********************************************************************
+*/
+#ifndef   USBH_VHC_MAX_PORTS
+  #define USBH_VHC_MAX_PORTS                4u
+#endif
+
+#ifndef   USBH_VHC_MAX_USB_ADDRESS
+  #define USBH_VHC_MAX_USB_ADDRESS          127u
+#endif
+
+#ifndef   USBH_VHC_MAX_TRANSFER_SIZE
+  #define USBH_VHC_MAX_TRANSFER_SIZE        0x10000u
+#endif
+
+/*********************************************************************
+*
+*       Defines, fixed
+*
+**********************************************************************
+*/
+#define USBH_VHC_INST_MAGIC                 FOUR_CHAR_ULONG('V','H','C','I')
+#define USBH_VHC_EP_INFO_MAGIC              FOUR_CHAR_ULONG('V','H','E','P')
+#define USBH_VHC_IS_DEV_VALID(pInst)        USBH_ASSERT(USBH_IS_PTR_VALID(pInst, USBH_VHC_INST))
+#define EP_VALID(pEP)                       USBH_ASSERT_MAGIC(pEP, USBH_VHC_EP_INFO)
+
+#define VHC_HALT_BIT(EPAddr)                (1uL << (((EPAddr) & 0x0Fu) + ((((EPAddr) & USB_IN_DIRECTION) != 0u) ? 16u : 0u)))
+
+/*********************************************************************
+*
+*       Types
+*
+**********************************************************************
+*/
+typedef struct _USBH_VHC_INST USBH_VHC_INST;
+
+typedef struct _USBH_VHC_EP_INFO {
+#if USBH_DEBUG > 1
+  U32                               Magic;
+#endif
+  struct _USBH_VHC_EP_INFO        * pNext;
+  USBH_VHC_INST                   * pInst;
+  U8                                EndpointType;
+  U8                                DeviceAddress;
+  U8                                EndpointAddress;
+  U16                               MaxPacketSize;
+  U16                               IntervalTime;       // In micro frames.
+  USBH_URB                        * pPendingUrb;
+  U32                               NumBytesDone;       // OUT transfers accepted partially by the device.
+  USBH_TIME                         DueTime;
+  USBH_STATUS                       InjectedStatus;
+  U8                                Aborted;
+  U8                                ServiceCnt;
+  U8                                ReleaseInProgress;
+  USBH_TIMER                        RemovalTimer;
+  USBH_RELEASE_EP_COMPLETION_FUNC * pfOnReleaseCompletion;
+  void                            * pReleaseContext;
+} USBH_VHC_EP_INFO;
+
+typedef struct {
+  USBH_VHC_DEVICE                 * pDev;
+  U8                                PowerOn;
+  U8                                Suspended;
+} USBH_VHC_PORT;
+
+struct _USBH_VHC_INST {
+#if USBH_DEBUG > 1
+  U32                               Magic;
+#endif
+  USBH_HOST_CONTROLLER            * pHostController;
+  U32                               HCIndex;
+  USBH_ROOT_HUB_NOTIFICATION_FUNC * pfUbdRootHubNotification;
+  void                            * pRootHubNotificationContext;
+  unsigned                          NumPorts;
+  USBH_VHC_PORT                     aPort[USBH_VHC_MAX_PORTS];
+  USBH_VHC_DEVICE                 * pDevList;
+  USBH_VHC_EP_INFO                * pEPList;
+  USBH_TIMER                        ServiceTimer;
+  U32                               PortNotifyMask;
+  volatile U8                       IsrPending;
+  U8                                ServiceCnt;
+  USBH_HOST_STATE                   State;
+  U32                               MaxTransferSize;
+  U32                               Latency;
+  USBH_VHC_ERROR_INJECTION          ErrorInjection;
+  U32                               ErrorInjectionCnt;
+  USBH_VHC_STAT                     Stat;
+};
+
+/*********************************************************************
+*
+*       Static data
+*
+**********************************************************************
+*/
+static USBH_VHC_INST * _pInst;
+
+/*********************************************************************
+*
+*       Static code
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _Kick
+*
+*  Function description
+*    Triggers a run of _ProcessInterrupt() in the context of USBH_ISRTask().
+*/
+static void _Kick(USBH_VHC_INST * pInst) {
+  pInst->IsrPending = 1;
+  USBH_ServiceISR(pInst->HCIndex);
+}
+
+/*********************************************************************
+*
+*       _FindDevice
+*
+*  Function description
+*    Returns the enabled device which responds to the given USB address.
+*/
+static USBH_VHC_DEVICE * _FindDevice(const USBH_VHC_INST * pInst, U8 Address) {
+  USBH_VHC_DEVICE * pDev;
+
+  for (pDev = pInst->pDevList; pDev != NULL; pDev = pDev->pNext) {
+    if (pDev->IsEnabled != 0u && pDev->Address == Address) {
+      break;
+    }
+  }
+  return pDev;
+}
+
+/*********************************************************************
+*
+*       _GetStringDesc
+*
+*  Function description
+*    Builds a string descriptor from the ASCII strings of a device.
+*
+*  Return value
+*    Length of the descriptor, 0 if the string does not exist.
+*/
+static U32 _GetStringDesc(const USBH_VHC_DEVICE * pDev, unsigned Index, U8 * pData, U32 NumBytes) {
+  const char * s;
+  U8           aDesc[2u + 2u * 63u];
+  unsigned     i;
+  U32          Len;
+
+  if (Index == 0u) {
+    aDesc[0] = 4;
+    aDesc[1] = USB_STRING_DESCRIPTOR_TYPE;
+    USBH_StoreU16LE(&aDesc[2], USB_LANGUAGE_ID);
+    Len = 4;
+  } else {
+    if (Index > pDev->NumStrings || pDev->papString == NULL) {
+      return 0;
+    }
+    s = pDev->papString[Index - 1u];
+    i = 0;
+    while (s[i] != '\0' && i < 63u) {
+      aDesc[2u + 2u * i]      = (U8)s[i];
+      aDesc[2u + 2u * i + 1u] = 0;
+      i++;
+    }
+    Len     = 2u + 2u * i;
+    aDesc[0] = (U8)Len;
+    aDesc[1] = USB_STRING_DESCRIPTOR_TYPE;
+  }
+  Len = USBH_MIN(Len, NumBytes);
+  USBH_MEMCPY(pData, aDesc, Len);
+  return Len;
+}
+
+/*********************************************************************
+*
+*       _HandleSetup
+*
+*  Function description
+*    Executes a control request on a simulated device. Standard requests are
+*    handled here, everything else is passed to the device model.
+*/
+static USBH_STATUS _HandleSetup(USBH_VHC_DEVICE * pDev, const USBH_SETUP_PACKET * pSetup, U8 * pData, U32 * pNumBytes) {
+  const U8 * pDesc;
+  U32        Len;
+  U8         Type;
+
+  *pNumBytes = 0;
+  if ((pSetup->Type & USB_REQTYPE_MASK) != USB_REQTYPE_STANDARD) {
+    if (pDev->pAPI->pfOnSetup == NULL) {
+      return USBH_STATUS_STALL;
+    }
+    return pDev->pAPI->pfOnSetup(pDev, pSetup, pData, pNumBytes);
+  }
+  switch (pSetup->Request) {
+  case USB_REQ_GET_DESCRIPTOR:
+    Type = (U8)(pSetup->Value >> 8);
+    if (Type == USB_DEVICE_DESCRIPTOR_TYPE) {
+      pDesc = pDev->pDeviceDesc;
+      Len   = pDesc[0];
+    } else if (Type == USB_CONFIGURATION_DESCRIPTOR_TYPE) {
+      pDesc = pDev->pConfigDesc;
+      Len   = USBH_LoadU16LE(&pDesc[2]);
+    } else if (Type == USB_STRING_DESCRIPTOR_TYPE) {
+      Len = _GetStringDesc(pDev, pSetup->Value & 0xFFu, pData, pSetup->Length);
+      if (Len == 0u) {
+        return USBH_STATUS_STALL;
+      }
+      *pNumBytes = Len;
+      return USBH_STATUS_SUCCESS;
+    } else if ((pSetup->Type & USB_TO_HOST) != 0u && pDev->pAPI->pfOnSetup != NULL) {
+      return pDev->pAPI->pfOnSetup(pDev, pSetup, pData, pNumBytes);
+    } else {
+      return USBH_STATUS_STALL;
+    }
+    Len = USBH_MIN(Len, (U32)pSetup->Length);
+    USBH_MEMCPY(pData, pDesc, Len);
+    *pNumBytes = Len;
+    break;
+  case USB_REQ_SET_ADDRESS:
+    pDev->Address = (U8)pSetup->Value;
+    break;
+  case USB_REQ_SET_CONFIGURATION:
+    pDev->Configuration = (U8)pSetup->Value;
+    pDev->HaltMask      = 0;
+    break;
+  case USB_REQ_GET_CONFIGURATION:
+    if (pSetup->Length != 0u) {
+      pData[0]   = pDev->Configuration;
+      *pNumBytes = 1;
+    }
+    break;
+  case USB_REQ_GET_STATUS:
+    if (pSetup->Length >= 2u) {
+      pData[0] = 0;
+      pData[1] = 0;
+      if ((pSetup->Type & 0x1Fu) == USB_ENDPOINT_RECIPIENT && (pDev->HaltMask & VHC_HALT_BIT(pSetup->Index)) != 0u) {
+        pData[0] = USB_STATUS_ENDPOINT_HALT;
+      }
+      *pNumBytes = 2;
+    }
+    break;
+  case USB_REQ_CLEAR_FEATURE:
+    if ((pSetup->Type & 0x1Fu) == USB_ENDPOINT_RECIPIENT && pSetup->Value == USB_FEATURE_STALL) {
+      pDev->HaltMask &= ~VHC_HALT_BIT(pSetup->Index);
+    }
+    break;
+  case USB_REQ_SET_FEATURE:
+    if ((pSetup->Type & 0x1Fu) == USB_ENDPOINT_RECIPIENT && pSetup->Value == USB_FEATURE_STALL) {
+      pDev->HaltMask |= VHC_HALT_BIT(pSetup->Index);
+    }
+    break;
+  case USB_REQ_SET_INTERFACE:
+    break;
+  case USB_REQ_GET_INTERFACE:
+    if (pSetup->Length != 0u) {
+      pData[0]   = 0;
+      *pNumBytes = 1;
+    }
+    break;
+  default:
+    return USBH_STATUS_STALL;
+  }
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       _CheckInjectError
+*
+*  Function description
+*    Decides whether a newly submitted transfer shall fail.
+*/
+static USBH_STATUS _CheckInjectError(USBH_VHC_INST * pInst, const USBH_VHC_EP_INFO * pEP) {
+  const USBH_VHC_ERROR_INJECTION * pErr;
+
+  pErr = &pInst->ErrorInjection;
+  if (pErr->Period == 0u) {
+    return USBH_STATUS_SUCCESS;
+  }
+  if (pErr->DeviceAddress != USBH_VHC_ANY_ADDRESS && pErr->DeviceAddress != pEP->DeviceAddress) {
+    return USBH_STATUS_SUCCESS;
+  }
+  if (pErr->EndpointAddress != USBH_VHC_ANY_ADDRESS && pErr->EndpointAddress != pEP->EndpointAddress) {
+    return USBH_STATUS_SUCCESS;
+  }
+  if (++pInst->ErrorInjectionCnt < pErr->Period) {
+    return USBH_STATUS_SUCCESS;
+  }
+  pInst->ErrorInjectionCnt = 0;
+  return pErr->Status;
+}
+
+/*********************************************************************
+*
+*       _RetryDelay
+*
+*  Function description
+*    Returns the time in ms after which a NAKed transfer is retried.
+*/
+static U32 _RetryDelay(const USBH_VHC_EP_INFO * pEP) {
+  U32 t;
+
+  t = 1;
+  if (pEP->EndpointType == USB_EP_TYPE_INT) {
+    t = USBH_MAX((U32)pEP->IntervalTime >> 3, 1u);
+  }
+  return t;
+}
+
+/*********************************************************************
+*
+*       _CompleteUrb
+*
+*  Function description
+*    Marks the endpoint as idle and calls the completion routine of the URB.
+*    pPendingUrb must be reset before the callback is called because the
+*    callback may submit another URB on that endpoint.
+*/
+static void _CompleteUrb(USBH_VHC_EP_INFO * pEP, USBH_STATUS Status) {
+  USBH_URB * pUrb;
+
+  USBH_OS_DisableInterrupt();
+  pUrb             = pEP->pPendingUrb;
+  pEP->pPendingUrb = NULL;
+  pEP->Aborted     = 0;
+  USBH_OS_EnableInterrupt();
+  if (pUrb != NULL) {
+    if (Status != USBH_STATUS_SUCCESS) {
+      pEP->pInst->Stat.NumErrors++;
+    }
+    pEP->pInst->Stat.NumTransfers++;
+    pUrb->Header.Status = Status;
+    USBH_ASSERT(pUrb->Header.pfOnInternalCompletion);
+    pUrb->Header.pfOnInternalCompletion(pUrb);                // Call the completion routine
+  }
+}
+
+/*********************************************************************
+*
+*       _ExecuteTransfer
+*
+*  Function description
+*    Passes the pending URB of an endpoint to the addressed device.
+*
+*  Return value
+*    == USBH_STATUS_PENDING : Device NAKed, retry later.
+*    != USBH_STATUS_PENDING : Final status of the URB.
+*/
+static USBH_STATUS _ExecuteTransfer(USBH_VHC_INST * pInst, USBH_VHC_EP_INFO * pEP, USBH_URB * pUrb) {
+  USBH_VHC_DEVICE       * pDev;
+  USBH_CONTROL_REQUEST  * pCtrl;
+  USBH_BULK_INT_REQUEST * pBulk;
+  USBH_STATUS             Status;
+  U32                     NumBytes;
+
+  if (pEP->InjectedStatus != USBH_STATUS_SUCCESS) {
+    pInst->Stat.NumErrorsInjected++;
+    USBH_LOG((USBH_MCAT_DRIVER_URB, "VHC: Injected error %s on dev %u EP 0x%x", USBH_GetStatusStr(pEP->InjectedStatus), pEP->DeviceAddress, pEP->EndpointAddress));
+    return pEP->InjectedStatus;
+  }
+  pDev = _FindDevice(pInst, pEP->DeviceAddress);
+  if (pDev == NULL) {
+    return USBH_STATUS_NOTRESPONDING;
+  }
+  if (pUrb->Header.Function == USBH_FUNCTION_CONTROL_REQUEST) {
+    pCtrl    = &pUrb->Request.ControlRequest;
+    NumBytes = 0;
+    Status   = _HandleSetup(pDev, &pCtrl->Setup, USBH_U8PTR(pCtrl->pBuffer), &NumBytes);
+    if (Status == USBH_STATUS_SUCCESS) {
+      if ((pCtrl->Setup.Type & USB_TO_HOST) != 0u) {
+        NumBytes = USBH_MIN(NumBytes, (U32)pCtrl->Setup.Length);
+        pInst->Stat.NumBytesIn  += NumBytes;
+      } else {
+        NumBytes = pCtrl->Setup.Length;
+        pInst->Stat.NumBytesOut += NumBytes;
+      }
+      pCtrl->Length = NumBytes;
+    }
+    return Status;
+  }
+  if ((pDev->HaltMask & VHC_HALT_BIT(pEP->EndpointAddress)) != 0u) {
+    return USBH_STATUS_STALL;
+  }
+  pBulk = &pUrb->Request.BulkIntRequest;
+  if ((pEP->EndpointAddress & USB_IN_DIRECTION) != 0u) {
+    NumBytes = pBulk->Length;
+    Status   = pDev->pAPI->pfOnData(pDev, pEP->EndpointAddress, USBH_U8PTR(pBulk->pBuffer), &NumBytes);
+    if (Status == USBH_STATUS_SUCCESS) {
+      pBulk->Length = NumBytes;
+      pInst->Stat.NumBytesIn += NumBytes;
+    }
+  } else {
+    NumBytes = pBulk->Length - pEP->NumBytesDone;
+    Status   = pDev->pAPI->pfOnData(pDev, pEP->EndpointAddress, USBH_U8PTR(pBulk->pBuffer) + pEP->NumBytesDone, &NumBytes);
+    if (Status == USBH_STATUS_SUCCESS || Status == USBH_STATUS_PENDING) {
+      pEP->NumBytesDone      += NumBytes;
+      pInst->Stat.NumBytesOut += NumBytes;
+      Status = (pEP->NumBytesDone < pBulk->Length) ? USBH_STATUS_PENDING : USBH_STATUS_SUCCESS;
+    }
+  }
+  if (Status == USBH_STATUS_STALL) {
+    pDev->HaltMask |= VHC_HALT_BIT(pEP->EndpointAddress);
+  }
+  return Status;
+}
+
+/*********************************************************************
+*
+*       _GetNextDueEP
+*
+*  Function description
+*    Returns an endpoint with a pending URB which is due and has not
+*    yet been serviced in the current run. The endpoint list is only
+*    walked with interrupts disabled, so endpoints may be released
+*    while transfers are processed.
+*/
+static USBH_VHC_EP_INFO * _GetNextDueEP(USBH_VHC_INST * pInst, int * pMorePending) {
+  USBH_VHC_EP_INFO * pEP;
+
+  USBH_OS_DisableInterrupt();
+  for (pEP = pInst->pEPList; pEP != NULL; pEP = pEP->pNext) {
+    if (pEP->pPendingUrb == NULL || pEP->Aborted != 0u || pEP->ServiceCnt == pInst->ServiceCnt) {
+      continue;
+    }
+    if (USBH_TimeDiff(USBH_OS_GetTime32(), pEP->DueTime) < 0) {
+      *pMorePending = 1;
+      continue;
+    }
+    pEP->ServiceCnt = pInst->ServiceCnt;
+    break;
+  }
+  USBH_OS_EnableInterrupt();
+  return pEP;
+}
+
+/*********************************************************************
+*
+*       _ProcessInterrupt
+*
+*  Function description
+*    Is called in the context of USBH_ISRTask(). Executes all transfers
+*    which are due and reports root hub port changes.
+*/
+static void _ProcessInterrupt(USBH_HC_HANDLE hHostController) {
+  USBH_VHC_INST    * pInst;
+  USBH_VHC_EP_INFO * pEP;
+  USBH_URB         * pUrb;
+  USBH_STATUS        Status;
+  U32                PortMask;
+  int                MorePending;
+
+  pInst = USBH_HDL2PTR(USBH_VHC_INST, hHostController);
+  USBH_VHC_IS_DEV_VALID(pInst);
+  pInst->IsrPending = 0;
+  USBH_OS_DisableInterrupt();
+  PortMask              = pInst->PortNotifyMask;
+  pInst->PortNotifyMask = 0;
+  USBH_OS_EnableInterrupt();
+  if (PortMask != 0u) {
+    pInst->pfUbdRootHubNotification(pInst->pRootHubNotificationContext, PortMask);
+  }
+  if (pInst->State != USBH_HOST_RUNNING) {
+    return;
+  }
+  MorePending = 0;
+  pInst->ServiceCnt++;
+  for (;;) {
+    pEP = _GetNextDueEP(pInst, &MorePending);
+    if (pEP == NULL) {
+      break;
+    }
+    pUrb   = pEP->pPendingUrb;
+    Status = _ExecuteTransfer(pInst, pEP, pUrb);
+    if (Status == USBH_STATUS_PENDING) {
+      pInst->Stat.NumNAKs++;
+      pEP->DueTime = USBH_TIME_CALC_EXPIRATION(_RetryDelay(pEP));
+      MorePending  = 1;
+    } else {
+      _CompleteUrb(pEP, Status);
+    }
+  }
+  if (MorePending != 0) {
+    USBH_StartTimer(&pInst->ServiceTimer, 1);
+  }
+}
+
+/*********************************************************************
+*
+*       _OnServiceTimer
+*
+*  Function description
+*    Completes aborted URBs (which must be done from the timer context)
+*    and triggers the processing of delayed or NAKed transfers.
+*/
+static void _OnServiceTimer(void * pContext) {
+  USBH_VHC_INST    * pInst;
+  USBH_VHC_EP_INFO * pEP;
+
+  pInst = USBH_CTX2PTR(USBH_VHC_INST, pContext);
+  USBH_VHC_IS_DEV_VALID(pInst);
+  for (;;) {
+    USBH_OS_DisableInterrupt();
+    for (pEP = pInst->pEPList; pEP != NULL; pEP = pEP->pNext) {
+      if (pEP->pPendingUrb != NULL && pEP->Aborted != 0u) {
+        break;
+      }
+    }
+    USBH_OS_EnableInterrupt();
+    if (pEP == NULL) {
+      break;
+    }
+    _CompleteUrb(pEP, USBH_STATUS_CANCELED);
+  }
+  _Kick(pInst);
+}
+
+/*********************************************************************
+*
+*       _HostInit
+*
+*  Function description
+*    Is called in the context of USBH_AddHostController.
+*    Leaves the host in the state USBH_HOST_RESET.
+*/
+static USBH_STATUS _HostInit(USBH_HC_HANDLE hHostController, USBH_ROOT_HUB_NOTIFICATION_FUNC * pfUbdRootHubNotification, void * pRootHubNotificationContext) {
+  USBH_VHC_INST * pInst;
+
+  USBH_LOG((USBH_MCAT_DRIVER, "VHC: _HostInit!"));
+  pInst = USBH_HDL2PTR(USBH_VHC_INST, hHostController);
+  USBH_VHC_IS_DEV_VALID(pInst);
+  pInst->pfUbdRootHubNotification    = pfUbdRootHubNotification;
+  pInst->pRootHubNotificationContext = pRootHubNotificationContext;
+  pInst->MaxTransferSize             = USBH_VHC_MAX_TRANSFER_SIZE;
+  pInst->State                       = USBH_HOST_RESET;
+  USBH_InitTimer(&pInst->ServiceTimer, _OnServiceTimer, pInst);
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       _HostExit
+*
+*  Function description
+*    Is the last call on this interface. It is called after all URBs are returned,
+*    all endpoints are released and no further reference to the host controller exists.
+*/
+static USBH_STATUS _HostExit(USBH_HC_HANDLE hHostController) {
+  USBH_VHC_INST * pInst;
+
+  USBH_LOG((USBH_MCAT_DRIVER, "VHC: _HostExit!"));
+  pInst = USBH_HDL2PTR(USBH_VHC_INST, hHostController);
+  USBH_VHC_IS_DEV_VALID(pInst);
+  USBH_ASSERT(pInst->pEPList == NULL);
+  USBH_ReleaseTimer(&pInst->ServiceTimer);
+  _pInst = NULL;
+  USBH_FREE(pInst);
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       _SetHcState
+*
+*  Function description
+*    Set the state of the HC
+*/
+static USBH_STATUS _SetHcState(USBH_HC_HANDLE hHostController, USBH_HOST_STATE HostState) {
+  USBH_VHC_INST * pInst;
+
+  USBH_LOG((USBH_MCAT_DRIVER, "VHC: _SetHcState: HostState:%d!", HostState));
+  pInst = USBH_HDL2PTR(USBH_VHC_INST, hHostController);
+  USBH_VHC_IS_DEV_VALID(pInst);
+  pInst->State = HostState;
+  if (HostState == USBH_HOST_RUNNING) {
+    _Kick(pInst);
+  }
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       _GetFrameNumber
+*
+*  Function description
+*    Returns the frame number as a 14 bit value. The virtual bus uses
+*    the system time, one frame per ms.
+*/
+static U32 _GetFrameNumber(USBH_HC_HANDLE hHostController) {
+  USBH_USE_PARA(hHostController);
+  return (U32)USBH_OS_GetTime32() & 0x3FFFu;
+}
+
+/*********************************************************************
+*
+*       _AddEndpoint
+*
+*  Function description
+*    Returns an endpoint handle for the added endpoint.
+*    Isochronous endpoints are not supported by the virtual host controller.
+*/
+static USBH_HC_EP_HANDLE _AddEndpoint(USBH_HC_HANDLE hHostController, U8 EndpointType, U8 DeviceAddress, U8 EndpointAddress, U16 MaxPacketSize, U16 IntervalTime, USBH_SPEED Speed) {
+  USBH_VHC_INST    * pInst;
+  USBH_VHC_EP_INFO * pEP;
+
+  USBH_USE_PARA(Speed);
+  pInst = USBH_HDL2PTR(USBH_VHC_INST, hHostController);
+  USBH_VHC_IS_DEV_VALID(pInst);
+  if (EndpointType == USB_EP_TYPE_ISO) {
+    USBH_WARN((USBH_MCAT_DRIVER_EP, "VHC: _AddEndpoint: ISO endpoints are not supported"));
+    return NULL;
+  }
+  pEP = (USBH_VHC_EP_INFO *)USBH_TRY_MALLOC_ZEROED(sizeof(USBH_VHC_EP_INFO));
+  if (pEP == NULL) {
+    USBH_WARN((USBH_MCAT_DRIVER_EP, "VHC: _AddEndpoint: No memory"));
+    return NULL;
+  }
+  USBH_IFDBG(pEP->Magic = USBH_VHC_EP_INFO_MAGIC);
+  pEP->pInst           = pInst;
+  pEP->EndpointType    = EndpointType;
+  pEP->DeviceAddress   = DeviceAddress;
+  pEP->EndpointAddress = EndpointAddress;
+  pEP->MaxPacketSize   = MaxPacketSize;
+  pEP->IntervalTime    = IntervalTime;
+  USBH_LOG((USBH_MCAT_DRIVER_EP, "VHC: _AddEndpoint: Dev %u EP 0x%x type %u", DeviceAddress, EndpointAddress, EndpointType));
+  USBH_OS_DisableInterrupt();
+  pEP->pNext     = pInst->pEPList;
+  pInst->pEPList = pEP;
+  USBH_OS_EnableInterrupt();
+  return pEP;
+}
+
+/*********************************************************************
+*
+*       _OnRemoveEPTimer
+*
+*  Function description
+*    Called if an endpoint has been released.
+*/
+static void _OnRemoveEPTimer(void * pContext) {
+  USBH_VHC_EP_INFO                * pEP;
+  USBH_VHC_EP_INFO               ** ppEP;
+  USBH_RELEASE_EP_COMPLETION_FUNC * pfCompletion;
+  void                            * pCompContext;
+
+  pEP = USBH_CTX2PTR(USBH_VHC_EP_INFO, pContext);
+  EP_VALID(pEP);
+  USBH_ReleaseTimer(&pEP->RemovalTimer);
+  USBH_OS_DisableInterrupt();
+  for (ppEP = &pEP->pInst->pEPList; *ppEP != NULL; ppEP = &(*ppEP)->pNext) {
+    if (*ppEP == pEP) {
+      *ppEP = pEP->pNext;
+      break;
+    }
+  }
+  USBH_OS_EnableInterrupt();
+  pfCompletion = pEP->pfOnReleaseCompletion;
+  pCompContext = pEP->pReleaseContext;
+  USBH_FREE(pEP);
+  if (pfCompletion != NULL) {
+    pfCompletion(pCompContext);
+  }
+}
+
+/*********************************************************************
+*
+*       _ReleaseEndpoint
+*
+*  Function description
+*    Releases that endpoint. This function returns immediately.
+*    If the Completion function is called the endpoint is removed.
+*/
+static void _ReleaseEndpoint(USBH_HC_EP_HANDLE hEndPoint, USBH_RELEASE_EP_COMPLETION_FUNC * pfReleaseEpCompletion, void * pContext) {
+  USBH_VHC_EP_INFO * pEP;
+
+  if (NULL == hEndPoint) {
+    USBH_WARN((USBH_MCAT_DRIVER_EP, "VHC: _ReleaseEndpoint: invalid hEndPoint!"));
+    return;
+  }
+  pEP = USBH_HDL2PTR(USBH_VHC_EP_INFO, hEndPoint);
+  EP_VALID(pEP);
+  USBH_ASSERT(pEP->pPendingUrb == NULL);
+  pEP->pReleaseContext       = pContext;
+  pEP->pfOnReleaseCompletion = pfReleaseEpCompletion;
+  if (pEP->ReleaseInProgress != 0u) {
+    USBH_WARN((USBH_MCAT_DRIVER_EP, "VHC: _ReleaseEndpoint: Endpoint already released, return!"));
+    return;
+  }
+  pEP->ReleaseInProgress = 1;
+  USBH_InitTimer(&pEP->RemovalTimer, _OnRemoveEPTimer, pEP);
+  USBH_StartTimer(&pEP->RemovalTimer, USBH_EP_STOP_DELAY_TIME);
+}
+
+/*********************************************************************
+*
+*       _AbortEndpoint
+*
+*  Function description
+*    Complete all pending requests. The URB is completed from the
+*    service timer with USBH_STATUS_CANCELED.
+*/
+static USBH_STATUS _AbortEndpoint(USBH_HC_EP_HANDLE hEndPoint) {
+  USBH_VHC_EP_INFO * pEP;
+
+  pEP = USBH_HDL2PTR(USBH_VHC_EP_INFO, hEndPoint);
+  EP_VALID(pEP);
+  USBH_LOG((USBH_MCAT_DRIVER_URB, "VHC: _AbortEndpoint!"));
+  USBH_OS_DisableInterrupt();
+  if (pEP->pPendingUrb != NULL) {
+    pEP->Aborted = 1;
+  }
+  USBH_OS_EnableInterrupt();
+  USBH_StartTimer(&pEP->pInst->ServiceTimer, 1);
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       _ResetEndpoint
+*
+*  Function description
+*    Resets the data toggle. There is no data toggle on the virtual bus.
+*/
+static USBH_STATUS _ResetEndpoint(USBH_HC_EP_HANDLE hEndPoint) {
+  USBH_VHC_EP_INFO * pEP;
+
+  pEP = USBH_HDL2PTR(USBH_VHC_EP_INFO, hEndPoint);
+  EP_VALID(pEP);
+  if (pEP->pPendingUrb != NULL) {
+    USBH_WARN((USBH_MCAT_DRIVER_EP, "VHC: _ResetEndpoint: Pending URBs!"));
+  }
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       _SubmitRequest
+*
+*  Function description
+*    Submit a request to the HC. If USBH_STATUS_PENDING is returned
+*    the request is in the queue and the completion routine is
+*    called later.
+*/
+static USBH_STATUS _SubmitRequest(USBH_HC_EP_HANDLE hEndPoint, USBH_URB * pUrb) {
+  USBH_VHC_EP_INFO * pEP;
+  USBH_VHC_INST    * pInst;
+
+  USBH_ASSERT(hEndPoint != NULL);
+  pEP = USBH_HDL2PTR(USBH_VHC_EP_INFO, hEndPoint);
+  EP_VALID(pEP);
+  pInst = pEP->pInst;
+  switch (pUrb->Header.Function) {
+  case USBH_FUNCTION_CONTROL_REQUEST:
+    break;
+  case USBH_FUNCTION_BULK_REQUEST:
+  case USBH_FUNCTION_INT_REQUEST:
+    if (pUrb->Request.BulkIntRequest.Length > pInst->MaxTransferSize) {
+      return USBH_STATUS_XFER_SIZE;
+    }
+    break;
+  default:
+    USBH_WARN((USBH_MCAT_DRIVER_URB, "VHC: _SubmitRequest: invalid USBH_URB function type!"));
+    return USBH_STATUS_ERROR;
+  }
+  if (pInst->State != USBH_HOST_RUNNING) {
+    return USBH_STATUS_HC_STOPPED;
+  }
+  USBH_OS_DisableInterrupt();
+  if (pEP->pPendingUrb != NULL) {
+    USBH_OS_EnableInterrupt();
+    return USBH_STATUS_BUSY;
+  }
+  pUrb->Header.Status = USBH_STATUS_PENDING;
+  pEP->NumBytesDone   = 0;
+  pEP->InjectedStatus = _CheckInjectError(pInst, pEP);
+  pEP->DueTime        = USBH_TIME_CALC_EXPIRATION(pInst->Latency);
+  pEP->pPendingUrb    = pUrb;
+  USBH_OS_EnableInterrupt();
+  if (pInst->Latency == 0u) {
+    _Kick(pInst);
+  } else {
+    USBH_StartTimer(&pInst->ServiceTimer, pInst->Latency);
+  }
+  return USBH_STATUS_PENDING;
+}
+
+/*********************************************************************
+*
+*       _CheckIsr
+*
+*  Function description
+*    Called from USBH_ServiceISR(). Returns 1 if there is work for
+*    _ProcessInterrupt().
+*/
+static int _CheckIsr(USBH_HC_HANDLE hHostController) {
+  USBH_VHC_INST * pInst;
+
+  pInst = USBH_HDL2PTR(USBH_VHC_INST, hHostController);
+  USBH_VHC_IS_DEV_VALID(pInst);
+  return (pInst->IsrPending != 0u) ? 1 : 0;
+}
+
+/*********************************************************************
+*
+*       _Ioctl
+*
+*  Function description
+*    IO control function.
+*/
+static USBH_STATUS _Ioctl(USBH_HC_HANDLE hHostController, unsigned Func, USBH_IOCTL_PARA *pParam) {
+  USBH_VHC_INST * pInst;
+  USBH_STATUS     Ret;
+
+  pInst = USBH_HDL2PTR(USBH_VHC_INST, hHostController);
+  USBH_VHC_IS_DEV_VALID(pInst);
+  switch (Func) {
+  case USBH_IOCTL_FUNC_GET_MAX_TRANSFER_SIZE:
+    pParam->u.MaxTransferSize.Size = pInst->MaxTransferSize;
+    Ret = USBH_STATUS_SUCCESS;
+    break;
+  case USBH_IOCTL_FUNC_CONF_MAX_XFER_BUFF_SIZE:
+    if (pParam->u.MaxTransferSize.Size == 0u || pParam->u.MaxTransferSize.Size > USBH_VHC_MAX_TRANSFER_SIZE) {
+      Ret = USBH_STATUS_INVALID_PARAM;
+      break;
+    }
+    pInst->MaxTransferSize = pParam->u.MaxTransferSize.Size;
+    Ret = USBH_STATUS_SUCCESS;
+    break;
+  case USBH_IOCTL_FUNC_GET_CAPABILITIES:
+    pParam->u.Caps.MaxSpeed         = USBH_HIGH_SPEED;
+    pParam->u.Caps.NeedConfigureEPs = 0;
+    Ret = USBH_STATUS_SUCCESS;
+    break;
+  default:
+    Ret = USBH_STATUS_INVALID_PARAM;
+    break;
+  }
+  return Ret;
+}
+
+/*********************************************************************
+*
+*       _ROOTHUB_GetPortCount
+*/
+static unsigned int _ROOTHUB_GetPortCount(USBH_HC_HANDLE hHostController) {
+  USBH_VHC_INST * pInst;
+
+  pInst = USBH_HDL2PTR(USBH_VHC_INST, hHostController);
+  USBH_VHC_IS_DEV_VALID(pInst);
+  return pInst->NumPorts;
+}
+
+/*********************************************************************
+*
+*       _ROOTHUB_GetHubStatus
+*/
+static U32 _ROOTHUB_GetHubStatus(USBH_HC_HANDLE hHostController) {
+  USBH_USE_PARA(hHostController);
+  return 0;
+}
+
+/*********************************************************************
+*
+*       _ROOTHUB_GetPortStatus
+*
+*  Function description
+*    One based index of the port / return the port status as
+*    defined in the USB specification 11.24.2.7
+*/
+static U32 _ROOTHUB_GetPortStatus(USBH_HC_HANDLE hHostController, U8 Port) {
+  USBH_VHC_INST         * pInst;
+  const USBH_VHC_PORT   * pPort;
+  U32                     PortStatus;
+
+  pInst = USBH_HDL2PTR(USBH_VHC_INST, hHostController);
+  USBH_VHC_IS_DEV_VALID(pInst);
+  if (Port == 0u || Port > pInst->NumPorts) {
+    return 0;
+  }
+  pPort      = &pInst->aPort[Port - 1u];
+  PortStatus = 0;
+  if (pPort->PowerOn != 0u) {
+    PortStatus |= PORT_STATUS_POWER;
+    if (pPort->pDev != NULL) {
+      PortStatus |= PORT_STATUS_CONNECT;
+      if (pPort->pDev->IsEnabled != 0u) {
+        PortStatus |= PORT_STATUS_ENABLED;
+      }
+      if (pPort->pDev->Speed == USBH_LOW_SPEED) {
+        PortStatus |= PORT_STATUS_LOW_SPEED;
+      } else if (pPort->pDev->Speed == USBH_HIGH_SPEED) {
+        PortStatus |= PORT_STATUS_HIGH_SPEED;
+      } else {
+        // Full speed
+      }
+    }
+    if (pPort->Suspended != 0u) {
+      PortStatus |= PORT_STATUS_SUSPEND;
+    }
+  }
+  return PortStatus;
+}
+
+/*********************************************************************
+*
+*       _ROOTHUB_SetPortPower
+*/
+static void _ROOTHUB_SetPortPower(USBH_HC_HANDLE hHostController, U8 Port, U8 PowerOn) {
+  USBH_VHC_INST * pInst;
+
+  pInst = USBH_HDL2PTR(USBH_VHC_INST, hHostController);
+  USBH_VHC_IS_DEV_VALID(pInst);
+  if (Port != 0u && Port <= pInst->NumPorts) {
+    pInst->aPort[Port - 1u].PowerOn = PowerOn;
+    if (PowerOn == 0u && pInst->aPort[Port - 1u].pDev != NULL) {
+      pInst->aPort[Port - 1u].pDev->IsEnabled = 0;
+    }
+  }
+}
+
+/*********************************************************************
+*
+*       _ROOTHUB_ResetPort
+*
+*  Function description
+*    Resets the device on the port. The reset completes immediately,
+*    the root hub is notified as the DWC2 driver does after reset.
+*/
+static void _ROOTHUB_ResetPort(USBH_HC_HANDLE hHostController, U8 Port) {
+  USBH_VHC_INST * pInst;
+
+  pInst = USBH_HDL2PTR(USBH_VHC_INST, hHostController);
+  USBH_VHC_IS_DEV_VALID(pInst);
+  if (Port == 0u || Port > pInst->NumPorts) {
+    return;
+  }
+  if (pInst->aPort[Port - 1u].pDev != NULL) {
+    USBH_VHC__ResetDevice(pInst->aPort[Port - 1u].pDev);
+  }
+  pInst->aPort[Port - 1u].Suspended = 0;
+  pInst->pfUbdRootHubNotification(pInst->pRootHubNotificationContext, 1uL << Port);
+}
+
+/*********************************************************************
+*
+*       _ROOTHUB_DisablePort
+*/
+static void _ROOTHUB_DisablePort(USBH_HC_HANDLE hHostController, U8 Port) {
+  USBH_VHC_INST * pInst;
+
+  pInst = USBH_HDL2PTR(USBH_VHC_INST, hHostController);
+  USBH_VHC_IS_DEV_VALID(pInst);
+  if (Port != 0u && Port <= pInst->NumPorts && pInst->aPort[Port - 1u].pDev != NULL) {
+    pInst->aPort[Port - 1u].pDev->IsEnabled = 0;
+  }
+}
+
+/*********************************************************************
+*
+*       _ROOTHUB_SetPortSuspend
+*/
+static void _ROOTHUB_SetPortSuspend(USBH_HC_HANDLE hHostController, U8 Port, USBH_PORT_POWER_STATE State) {
+  USBH_VHC_INST * pInst;
+
+  pInst = USBH_HDL2PTR(USBH_VHC_INST, hHostController);
+  USBH_VHC_IS_DEV_VALID(pInst);
+  if (Port != 0u && Port <= pInst->NumPorts) {
+    pInst->aPort[Port - 1u].Suspended = (State == USBH_PORT_POWER_SUSPEND) ? 1u : 0u;
+  }
+}
+
+/*********************************************************************
+*
+*       _VHC_Driver
+*/
+static const USBH_HOST_DRIVER _VHC_Driver = {
+  _HostInit,
+  _HostExit,
+  _SetHcState,
+  _GetFrameNumber,
+  _AddEndpoint,
+  _ReleaseEndpoint,
+  _AbortEndpoint,
+  _ResetEndpoint,
+  _SubmitRequest,
+  _ROOTHUB_GetPortCount,
+  _ROOTHUB_GetHubStatus,
+  _ROOTHUB_GetPortStatus,
+  _ROOTHUB_SetPortPower,
+  _ROOTHUB_ResetPort,
+  _ROOTHUB_DisablePort,
+  _ROOTHUB_SetPortSuspend,
+  _CheckIsr,
+  _ProcessInterrupt,
+  _Ioctl,
+  NULL
+};
+
+/*********************************************************************
+*
+*       Public code, internal
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       USBH_VHC__AttachDevice
+*
+*  Function description
+*    Makes a simulated device visible on the virtual bus.
+*    The device does not respond before its port has been reset.
+*/
+void USBH_VHC__AttachDevice(USBH_VHC_DEVICE * pDev) {
+  USBH_VHC_INST * pInst;
+
+  pInst = _pInst;
+  USBH_ASSERT_PTR(pInst);
+  pDev->IsEnabled     = 0;
+  pDev->Address       = 0;
+  pDev->Configuration = 0;
+  pDev->HaltMask      = 0;
+  USBH_OS_DisableInterrupt();
+  pDev->pNext     = pInst->pDevList;
+  pInst->pDevList = pDev;
+  USBH_OS_EnableInterrupt();
+}
+
+/*********************************************************************
+*
+*       USBH_VHC__DetachDevice
+*
+*  Function description
+*    Removes a simulated device from the virtual bus. Pending transfers
+*    to the device fail with USBH_STATUS_NOTRESPONDING.
+*/
+void USBH_VHC__DetachDevice(USBH_VHC_DEVICE * pDev) {
+  USBH_VHC_INST    * pInst;
+  USBH_VHC_DEVICE ** ppDev;
+
+  pInst = _pInst;
+  USBH_ASSERT_PTR(pInst);
+  USBH_OS_DisableInterrupt();
+  for (ppDev = &pInst->pDevList; *ppDev != NULL; ppDev = &(*ppDev)->pNext) {
+    if (*ppDev == pDev) {
+      *ppDev = pDev->pNext;
+      break;
+    }
+  }
+  pDev->pNext     = NULL;
+  pDev->IsEnabled = 0;
+  USBH_OS_EnableInterrupt();
+  if (pDev->pAPI->pfOnDetach != NULL) {
+    pDev->pAPI->pfOnDetach(pDev);
+  }
+}
+
+/*********************************************************************
+*
+*       USBH_VHC__ResetDevice
+*
+*  Function description
+*    Performs a bus reset of a simulated device: The device responds to
+*    address 0 afterwards. Any other device still at address 0 is disabled.
+*/
+void USBH_VHC__ResetDevice(USBH_VHC_DEVICE * pDev) {
+  USBH_VHC_INST   * pInst;
+  USBH_VHC_DEVICE * p;
+
+  pInst = _pInst;
+  USBH_ASSERT_PTR(pInst);
+  USBH_OS_DisableInterrupt();
+  for (p = pInst->pDevList; p != NULL; p = p->pNext) {
+    if (p != pDev && p->Address == 0u) {
+      p->IsEnabled = 0;
+    }
+  }
+  pDev->Address       = 0;
+  pDev->Configuration = 0;
+  pDev->HaltMask      = 0;
+  pDev->IsEnabled     = 1;
+  USBH_OS_EnableInterrupt();
+  if (pDev->pAPI->pfOnReset != NULL) {
+    pDev->pAPI->pfOnReset(pDev);
+  }
+}
+
+/*********************************************************************
+*
+*       Public code
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       USBH_VHC_Add
+*
+*  Function description
+*    Adds the virtual host controller to the stack. Instead of hardware
+*    the controller drives simulated devices, which allows the class
+*    drivers to be exercised, measured and regression tested on any
+*    platform, including a Linux or Windows host build.
+*
+*  Parameters
+*    NumPorts : Number of root hub ports (1..USBH_VHC_MAX_PORTS).
+*
+*  Return value
+*    Index of the host controller.
+*
+*  Additional information
+*    Only one virtual host controller can be added. Transfers are executed
+*    in the context of USBH_ISRTask(), so the ISR task must be running
+*    as with any hardware driver.
+*/
+U32 USBH_VHC_Add(unsigned NumPorts) {
+  USBH_VHC_INST * pInst;
+  U32             HCIndex;
+
+  USBH_LOG((USBH_MCAT_DRIVER, "USBH_VHC_Add!"));
+  if (_pInst != NULL) {
+    USBH_PANIC("USBH_VHC_Add: Virtual host controller already added");
+    return _pInst->HCIndex;
+  }
+  if (NumPorts == 0u || NumPorts > USBH_VHC_MAX_PORTS) {
+    NumPorts = USBH_VHC_MAX_PORTS;
+  }
+  pInst = (USBH_VHC_INST *)USBH_MALLOC_ZEROED(sizeof(USBH_VHC_INST));
+  USBH_IFDBG(pInst->Magic = USBH_VHC_INST_MAGIC);
+  pInst->NumPorts = NumPorts;
+  _pInst          = pInst;
+  pInst->pHostController = USBH_AddHostController(&_VHC_Driver, pInst, USBH_VHC_MAX_USB_ADDRESS, &HCIndex);
+  pInst->HCIndex         = HCIndex;
+  return HCIndex;
+}
+
+/*********************************************************************
+*
+*       USBH_VHC_Connect
+*
+*  Function description
+*    Connects a simulated device to a root hub port.
+*
+*  Parameters
+*    Port : One based index of the root hub port.
+*    pDev : Simulated device, e.g. created with USBH_VHC_CreateMSD().
+*
+*  Return value
+*    == USBH_STATUS_SUCCESS : Device connected, enumeration is started by the stack.
+*    != USBH_STATUS_SUCCESS : Invalid port or port already in use.
+*/
+USBH_STATUS USBH_VHC_Connect(unsigned Port, USBH_VHC_DEVICE * pDev) {
+  USBH_VHC_INST * pInst;
+
+  pInst = _pInst;
+  if (pInst == NULL || pDev == NULL || Port == 0u || Port > pInst->NumPorts) {
+    return USBH_STATUS_INVALID_PARAM;
+  }
+  if (pInst->aPort[Port - 1u].pDev != NULL) {
+    return USBH_STATUS_BUSY;
+  }
+  USBH_VHC__AttachDevice(pDev);
+  USBH_OS_DisableInterrupt();
+  pInst->aPort[Port - 1u].pDev = pDev;
+  pInst->PortNotifyMask       |= 1uL << Port;
+  USBH_OS_EnableInterrupt();
+  _Kick(pInst);
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       USBH_VHC_Disconnect
+*
+*  Function description
+*    Disconnects the simulated device from a root hub port.
+*    The device object is not deleted.
+*
+*  Parameters
+*    Port : One based index of the root hub port.
+*/
+USBH_STATUS USBH_VHC_Disconnect(unsigned Port) {
+  USBH_VHC_INST   * pInst;
+  USBH_VHC_DEVICE * pDev;
+
+  pInst = _pInst;
+  if (pInst == NULL || Port == 0u || Port > pInst->NumPorts) {
+    return USBH_STATUS_INVALID_PARAM;
+  }
+  USBH_OS_DisableInterrupt();
+  pDev = pInst->aPort[Port - 1u].pDev;
+  pInst->aPort[Port - 1u].pDev = NULL;
+  pInst->PortNotifyMask       |= 1uL << Port;
+  USBH_OS_EnableInterrupt();
+  if (pDev == NULL) {
+    return USBH_STATUS_NOT_FOUND;
+  }
+  USBH_VHC__DetachDevice(pDev);
+  _Kick(pInst);
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       USBH_VHC_SetLatency
+*
+*  Function description
+*    Sets the time between submission and execution of each transfer.
+*
+*  Parameters
+*    Latency : Latency in ms. 0 executes transfers as soon as the
+*              ISR task runs.
+*/
+void USBH_VHC_SetLatency(U32 Latency) {
+  if (_pInst != NULL) {
+    _pInst->Latency = Latency;
+  }
+}
+
+/*********************************************************************
+*
+*       USBH_VHC_SetErrorInjection
+*
+*  Function description
+*    Configures deterministic error injection.
+*
+*  Parameters
+*    pConfig : Error injection configuration. NULL disables error injection.
+*/
+void USBH_VHC_SetErrorInjection(const USBH_VHC_ERROR_INJECTION * pConfig) {
+  if (_pInst != NULL) {
+    USBH_OS_DisableInterrupt();
+    if (pConfig != NULL) {
+      _pInst->ErrorInjection = *pConfig;
+    } else {
+      _pInst->ErrorInjection.Period = 0;
+    }
+    _pInst->ErrorInjectionCnt = 0;
+    USBH_OS_EnableInterrupt();
+  }
+}
+
+/*********************************************************************
+*
+*       USBH_VHC_GetStat
+*
+*  Function description
+*    Returns the transfer statistics of the virtual host controller.
+*
+*  Parameters
+*    pStat : [OUT] Statistics.
+*/
+void USBH_VHC_GetStat(USBH_VHC_STAT * pStat) {
+  if (_pInst != NULL) {
+    USBH_OS_DisableInterrupt();
+    *pStat = _pInst->Stat;
+    USBH_OS_EnableInterrupt();
+  } else {
+    USBH_MEMSET(pStat, 0, sizeof(*pStat));
+  }
+}
+
+/*********************************************************************
+*
+*       USBH_VHC_ResetStat
+*
+*  Function description
+*    Clears the transfer statistics of the virtual host controller.
+*/
+void USBH_VHC_ResetStat(void) {
+  if (_pInst != NULL) {
+    USBH_OS_DisableInterrupt();
+    USBH_MEMSET(&_pInst->Stat, 0, sizeof(_pInst->Stat));
+    USBH_OS_EnableInterrupt();
+  }
+}
+
+/*************************** End of file ****************************/
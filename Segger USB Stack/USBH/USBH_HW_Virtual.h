@@ -0,0 +1,237 @@
+/*********************************************************************
+*                   (c) SEGGER Microcontroller GmbH                  *
+*                        The Embedded Experts                        *
+**********************************************************************
+*                                                                    *
+*       (c) 2003 - 2022     SEGGER Microcontroller GmbH              *
+*                                                                    *
+*       www.segger.com     Support: www.segger.com/ticket            *
+*                                                                    *
+**********************************************************************
+*                                                                    *
+*       emUSB-Host * USB Host stack for embedded applications        *
+*                                                                    *
+*       Please note: Knowledge of this file may under no             *
+*       circumstances be used to write a similar product.            *
+*       Thank you for your fairness !                                *
+*                                                                    *
+**********************************************************************
+*                                                                    *
+*       emUSB-Host version: V2.36.1                                  *
+*                                                                    *
+**********************************************************************
+----------------------------------------------------------------------
+Licensing information
+Licensor:                 SEGGER Microcontroller Systems LLC
+Licensed to:              React Health, Inc., 203 Avenue A NW, Suite 300, Winter Haven FL 33881, USA
+Licensed SEGGER software: emUSB-Host
+License number:           USBH-00304
+License model:            SSL [Single Developer Single Platform Source Code License]
+Licensed product:         -
+Licensed platform:        STM32F4, IAR
+Licensed number of seats: 1
+----------------------------------------------------------------------
+Support and Update Agreement (SUA)
+SUA period:               2022-05-19 - 2022-11-19
+Contact to extend SUA:    sales@segger.com
+----------------------------------------------------------------------
+File        : USBH_HW_Virtual.h
+Purpose     : Header for the virtual host controller and simulated devices
+-------------------------- END-OF-HEADER -----------------------------
+*/
+
+#ifndef USBH_HW_VIRTUAL_H_
+#define USBH_HW_VIRTUAL_H_
+
+#include "SEGGER.h"
+#include "USBH.h"
+
+#if defined(__cplusplus)
+  extern "C" {                 // Make sure we have C-declarations in C++ programs
+#endif
+
+/*********************************************************************
+*
+*       Defines
+*
+**********************************************************************
+*/
+#define USBH_VHC_ANY_ADDRESS      0xFFu     // Error injection applies to all devices / endpoints.
+
+/*********************************************************************
+*
+*       Types
+*
+**********************************************************************
+*/
+typedef struct _USBH_VHC_DEVICE USBH_VHC_DEVICE;
+
+/*********************************************************************
+*
+*       USBH_VHC_ON_SETUP_FUNC
+*
+*  Description
+*    Handles a class or vendor specific control request of a simulated device.
+*    Standard requests are answered by the virtual host controller itself.
+*
+*  Parameters
+*    pDev      : Simulated device.
+*    pSetup    : Setup packet.
+*    pData     : Data stage buffer (Setup.Length bytes).
+*    pNumBytes : [OUT] Number of bytes returned in the data stage (IN requests only).
+*
+*  Return value
+*    USBH_STATUS_SUCCESS or USBH_STATUS_STALL.
+*/
+typedef USBH_STATUS USBH_VHC_ON_SETUP_FUNC(USBH_VHC_DEVICE * pDev, const USBH_SETUP_PACKET * pSetup, U8 * pData, U32 * pNumBytes);
+
+/*********************************************************************
+*
+*       USBH_VHC_ON_DATA_FUNC
+*
+*  Description
+*    Handles a bulk or interrupt transfer of a simulated device.
+*
+*  Parameters
+*    pDev            : Simulated device.
+*    EndpointAddress : Endpoint address with direction bit.
+*    pData           : Transfer buffer.
+*    pNumBytes       : * [IN]  Size of the buffer / number of bytes to be sent to the device.
+*                      * [OUT] Number of bytes returned (IN) or accepted (OUT) by the device.
+*
+*  Return value
+*    == USBH_STATUS_SUCCESS : Transfer done.
+*    == USBH_STATUS_PENDING : Device NAKs, the transfer is retried later.
+*                             For OUT endpoints *pNumBytes may contain a partial amount.
+*    Any other value        : Transfer fails with this status (USBH_STATUS_STALL halts the endpoint).
+*/
+typedef USBH_STATUS USBH_VHC_ON_DATA_FUNC (USBH_VHC_DEVICE * pDev, U8 EndpointAddress, U8 * pData, U32 * pNumBytes);
+
+typedef void        USBH_VHC_ON_EVENT_FUNC(USBH_VHC_DEVICE * pDev);
+
+/*********************************************************************
+*
+*       USBH_VHC_DEVICE_API
+*
+*  Description
+*    Callbacks implementing the behavior of a simulated device.
+*/
+typedef struct {
+  USBH_VHC_ON_SETUP_FUNC * pfOnSetup;         // Class and vendor requests. NULL: Such requests are stalled.
+  USBH_VHC_ON_DATA_FUNC  * pfOnData;          // Bulk and interrupt transfers.
+  USBH_VHC_ON_EVENT_FUNC * pfOnReset;         // Bus reset. May be NULL.
+  USBH_VHC_ON_EVENT_FUNC * pfOnDetach;        // Device is removed from the bus. May be NULL.
+} USBH_VHC_DEVICE_API;
+
+/*********************************************************************
+*
+*       USBH_VHC_DEVICE
+*
+*  Description
+*    Simulated device attached to the virtual host controller.
+*    The first group of members is set up by the device model,
+*    the remaining members are managed by the virtual host controller.
+*/
+struct _USBH_VHC_DEVICE {
+  const USBH_VHC_DEVICE_API * pAPI;
+  const U8                  * pDeviceDesc;      // Device descriptor (18 bytes).
+  const U8                  * pConfigDesc;      // Complete configuration descriptor, wTotalLength must be valid.
+  const char * const        * papString;        // ASCII strings for string descriptor index 1..NumStrings.
+  U8                          NumStrings;
+  USBH_SPEED                  Speed;
+  void                      * pContext;         // Free for use by the device model.
+  //
+  // Internal, managed by the virtual host controller.
+  //
+  USBH_VHC_DEVICE           * pNext;
+  U32                         HaltMask;         // Bit n: OUT endpoint n halted, bit 16+n: IN endpoint n halted.
+  U8                          Address;
+  U8                          Configuration;
+  U8                          IsEnabled;
+};
+
+/*********************************************************************
+*
+*       USBH_VHC_ERROR_INJECTION
+*
+*  Description
+*    Error injection configuration of the virtual host controller.
+*    Every Period-th transfer matching DeviceAddress / EndpointAddress
+*    fails with Status. The device model never sees a failed transfer.
+*/
+typedef struct {
+  U32         Period;                           // 0: Error injection disabled.
+  USBH_STATUS Status;                           // Status reported for the failing transfer, e.g. USBH_STATUS_CRC or USBH_STATUS_STALL.
+  U8          DeviceAddress;                    // USB address or USBH_VHC_ANY_ADDRESS.
+  U8          EndpointAddress;                  // Endpoint address with direction bit or USBH_VHC_ANY_ADDRESS.
+} USBH_VHC_ERROR_INJECTION;
+
+/*********************************************************************
+*
+*       USBH_VHC_STAT
+*
+*  Description
+*    Transfer statistics of the virtual host controller.
+*/
+typedef struct {
+  U32 NumTransfers;                             // Number of completed control, bulk and interrupt transfers.
+  U32 NumBytesIn;                               // Number of bytes transferred from devices to the host.
+  U32 NumBytesOut;                              // Number of bytes transferred from the host to devices.
+  U32 NumNAKs;                                  // Number of times a device NAKed a transfer.
+  U32 NumErrors;                                // Number of transfers completed with an error (including injected errors).
+  U32 NumErrorsInjected;                        // Number of injected errors.
+} USBH_VHC_STAT;
+
+/*********************************************************************
+*
+*       USBH_VHC_MSD_STORAGE
+*
+*  Description
+*    Storage backing a simulated mass storage device, e.g. a disk image
+*    file when the stack is run on a host PC.
+*/
+typedef struct {
+  int  (*pfRead) (void * pContext, U32 SectorIndex,       void * pData, U32 NumSectors);  // Returns 0 on success.
+  int  (*pfWrite)(void * pContext, U32 SectorIndex, const void * pData, U32 NumSectors);  // Returns 0 on success. NULL: Medium is write protected.
+  void * pContext;
+  U32    NumSectors;
+  U32    BytesPerSector;
+} USBH_VHC_MSD_STORAGE;
+
+/*********************************************************************
+*
+*       API functions
+*
+**********************************************************************
+*/
+U32               USBH_VHC_Add              (unsigned NumPorts);
+USBH_STATUS       USBH_VHC_Connect          (unsigned Port, USBH_VHC_DEVICE * pDev);
+USBH_STATUS       USBH_VHC_Disconnect       (unsigned Port);
+void              USBH_VHC_SetLatency       (U32 Latency);
+void              USBH_VHC_SetErrorInjection(const USBH_VHC_ERROR_INJECTION * pConfig);
+void              USBH_VHC_GetStat          (USBH_VHC_STAT * pStat);
+void              USBH_VHC_ResetStat        (void);
+//
+// Simulated devices.
+//
+USBH_VHC_DEVICE * USBH_VHC_CreateCDCLoopback(void);
+USBH_VHC_DEVICE * USBH_VHC_CreateFT232      (void);
+USBH_VHC_DEVICE * USBH_VHC_CreateMSD        (const USBH_VHC_MSD_STORAGE * pStorage);
+USBH_VHC_DEVICE * USBH_VHC_CreateHub        (unsigned NumPorts);
+USBH_STATUS       USBH_VHC_HUB_Connect      (USBH_VHC_DEVICE * pHub, unsigned Port, USBH_VHC_DEVICE * pDev);
+USBH_STATUS       USBH_VHC_HUB_Disconnect   (USBH_VHC_DEVICE * pHub, unsigned Port);
+void              USBH_VHC_DeleteDevice     (USBH_VHC_DEVICE * pDev);
+//
+// Used by the device models.
+//
+void              USBH_VHC__AttachDevice    (USBH_VHC_DEVICE * pDev);
+void              USBH_VHC__DetachDevice    (USBH_VHC_DEVICE * pDev);
+void              USBH_VHC__ResetDevice     (USBH_VHC_DEVICE * pDev);
+
+#if defined(__cplusplus)
+  }
+#endif
+
+#endif // USBH_HW_VIRTUAL_H_
+
+/*************************** End of file ****************************/
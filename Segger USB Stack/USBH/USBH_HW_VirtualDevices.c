@@ -0,0 +1,1125 @@
+/*********************************************************************
+*                   (c) SEGGER Microcontroller GmbH                  *
+*                        The Embedded Experts                        *
+**********************************************************************
+*                                                                    *
+*       (c) 2003 - 2022     SEGGER Microcontroller GmbH              *
+*                                                                    *
+*       www.segger.com     Support: www.segger.com/ticket            *
+*                                                                    *
+**********************************************************************
+*                                                                    *
+*       emUSB-Host * USB Host stack for embedded applications        *
+*                                                                    *
+*       Please note: Knowledge of this file may under no             *
+*       circumstances be used to write a similar product.            *
+*       Thank you for your fairness !                                *
+*                                                                    *
+**********************************************************************
+*                                                                    *
+*       emUSB-Host version: V2.36.1                                  *
+*                                                                    *
+**********************************************************************
+----------------------------------------------------------------------
+Licensing information
+Licensor:                 SEGGER Microcontroller Systems LLC
+Licensed to:              React Health, Inc., 203 Avenue A NW, Suite 300, Winter Haven FL 33881, USA
+Licensed SEGGER software: emUSB-Host
+License number:           USBH-00304
+License model:            SSL [Single Developer Single Platform Source Code License]
+Licensed product:         -
+Licensed platform:        STM32F4, IAR
+Licensed number of seats: 1
+----------------------------------------------------------------------
+Support and Update Agreement (SUA)
+SUA period:               2022-05-19 - 2022-11-19
+Contact to extend SUA:    sales@segger.com
+----------------------------------------------------------------------
+File        : USBH_HW_VirtualDevices.c
+Purpose     : Simulated devices for the virtual host controller
+-------------------------- END-OF-HEADER -----------------------------
+*/
+
+/*********************************************************************
+*
+*       #include Section
+*
+**********************************************************************
+*/
+#include "USBH_Int.h"
+#include "USBH_HW_Virtual.h"
+
+/*********************************************************************
+*
+*       Defines, configurable
+*
+**********************************************************************
+*/
+#ifndef   USBH_VHC_LOOPBACK_BUFFER_SIZE
+  #define USBH_VHC_LOOPBACK_BUFFER_SIZE     4096u     // Size of the loopback buffer of the CDC and FT232 models.
+#endif
+
+#ifndef   USBH_VHC_HUB_MAX_PORTS
+  #define USBH_VHC_HUB_MAX_PORTS            7u        // Status change bitmap fits into one byte.
+#endif
+
+/*********************************************************************
+*
+*       Defines, fixed
+*
+**********************************************************************
+*/
+#define VHC_VID_SEGGER                      0x8765u
+
+//
+// CDC class requests
+//
+#define CDC_SET_LINE_CODING                 0x20u
+#define CDC_GET_LINE_CODING                 0x21u
+#define CDC_SET_CONTROL_LINE_STATE          0x22u
+#define CDC_SEND_BREAK                      0x23u
+
+//
+// FT232
+//
+#define FT232_PACKET_SIZE                   64u
+#define FT232_HEADER_SIZE                   2u
+#define FT232_REQUEST_GETMODEMSTAT          0x05u
+#define FT232_REQUEST_GETLATENCYTIMER       0x0Au
+
+//
+// Mass storage, Bulk-Only transport and SCSI
+//
+#define MSD_BULK_EP_SIZE                    512u
+#define MSD_CBW_SIGNATURE                   0x43425355u
+#define MSD_CSW_SIGNATURE                   0x53425355u
+#define MSD_CBW_LENGTH                      31u
+#define MSD_CSW_LENGTH                      13u
+#define MSD_REQ_GET_MAX_LUN                 0xFEu
+#define MSD_REQ_RESET                       0xFFu
+
+#define SCSI_TEST_UNIT_READY                0x00u
+#define SCSI_REQUEST_SENSE                  0x03u
+#define SCSI_INQUIRY                        0x12u
+#define SCSI_MODE_SENSE_6                   0x1Au
+#define SCSI_START_STOP_UNIT                0x1Bu
+#define SCSI_PREVENT_ALLOW_REMOVAL          0x1Eu
+#define SCSI_READ_CAPACITY_10               0x25u
+#define SCSI_READ_10                        0x28u
+#define SCSI_WRITE_10                       0x2Au
+#define SCSI_VERIFY_10                      0x2Fu
+#define SCSI_SYNCHRONIZE_CACHE_10           0x35u
+
+#define SCSI_SENSE_NONE                     0x00u
+#define SCSI_SENSE_MEDIUM_ERROR             0x03u
+#define SCSI_SENSE_ILLEGAL_REQUEST          0x05u
+#define SCSI_SENSE_DATA_PROTECT             0x07u
+
+#define SCSI_ASC_INVALID_COMMAND            0x20u
+#define SCSI_ASC_LBA_OUT_OF_RANGE           0x21u
+#define SCSI_ASC_WRITE_PROTECTED            0x27u
+#define SCSI_ASC_UNRECOVERED_READ_ERROR     0x11u
+#define SCSI_ASC_WRITE_FAULT                0x03u
+
+#define MSD_STATE_CBW                       0u
+#define MSD_STATE_DATA_IN                   1u
+#define MSD_STATE_DATA_OUT                  2u
+#define MSD_STATE_CSW                       3u
+
+#define MSD_CSW_PASSED                      0u
+#define MSD_CSW_FAILED                      1u
+#define MSD_CSW_PHASE_ERROR                 2u
+
+//
+// Hub, wPortStatus and wPortChange as defined in the USB specification 11.24.2.7
+//
+#define HUB_PORT_STATUS_SPEED_MASK          (PORT_STATUS_LOW_SPEED | PORT_STATUS_HIGH_SPEED)
+#define HUB_CHANGE_BIT(Selector)            (1u << ((Selector) - HDC_SELECTOR_C_PORT_CONNECTION))
+
+/*********************************************************************
+*
+*       Types
+*
+**********************************************************************
+*/
+typedef struct {
+  USBH_VHC_DEVICE Dev;                          // Must be the first member.
+  USBH_BUFFER     Loopback;
+  U8              aLineCoding[7];
+  U8              aBuffer[USBH_VHC_LOOPBACK_BUFFER_SIZE];
+} VHC_SERIAL;
+
+typedef struct {
+  USBH_VHC_DEVICE      Dev;                     // Must be the first member.
+  USBH_VHC_MSD_STORAGE Storage;
+  U8                   State;
+  U8                   CswStatus;
+  U8                   SenseKey;
+  U8                   Asc;
+  U32                  Tag;
+  U32                  DataTransferLength;
+  U32                  NumBytesDone;            // Data stage progress.
+  U32                  Lba;                     // READ(10) / WRITE(10): Next sector.
+  U32                  NumSectorsLeft;
+  U8                   Cmd;
+  U8                   ResponseLen;
+  U8                   aResponse[36];           // Responses of non-transfer commands.
+} VHC_MSD;
+
+typedef struct {
+  USBH_VHC_DEVICE   * pDev;
+  U16                 Status;
+  U16                 Change;
+} VHC_HUB_PORT;
+
+typedef struct {
+  USBH_VHC_DEVICE     Dev;                      // Must be the first member.
+  unsigned            NumPorts;
+  VHC_HUB_PORT        aPort[USBH_VHC_HUB_MAX_PORTS];
+} VHC_HUB;
+
+/*********************************************************************
+*
+*       Static const data
+*
+**********************************************************************
+*/
+static const char * const _apStringSEGGER[] = {
+  "SEGGER",
+  "Virtual device",
+  "000000000001"
+};
+
+static const char * const _apStringFTDI[] = {
+  "FTDI",
+  "FT232R USB UART",
+  "VHC00001"
+};
+
+//
+// CDC ACM loopback, full speed.
+//
+static const U8 _abCDCDeviceDesc[18] = {
+  18, USB_DEVICE_DESCRIPTOR_TYPE, 0x00, 0x02, 0x00, 0x00, 0x00, 64,
+  (U8)VHC_VID_SEGGER, (U8)(VHC_VID_SEGGER >> 8), 0x30, 0x00, 0x00, 0x01, 1, 2, 3, 1
+};
+
+static const U8 _abCDCConfigDesc[67] = {
+  9, USB_CONFIGURATION_DESCRIPTOR_TYPE, 67, 0, 2, 1, 0, 0x80, 50,
+  9, USB_INTERFACE_DESCRIPTOR_TYPE, 0, 0, 1, USB_DEVICE_CLASS_COMMUNICATIONS, 0x02, 0x01, 0,
+  5, USB_CS_INTERFACE_DESCRIPTOR_TYPE, 0x00, 0x10, 0x01,                        // Header
+  5, USB_CS_INTERFACE_DESCRIPTOR_TYPE, 0x01, 0x00, 0x01,                        // Call management
+  4, USB_CS_INTERFACE_DESCRIPTOR_TYPE, 0x02, 0x02,                              // ACM
+  5, USB_CS_INTERFACE_DESCRIPTOR_TYPE, 0x06, 0x00, 0x01,                        // Union
+  7, USB_ENDPOINT_DESCRIPTOR_TYPE, 0x83, USB_EP_TYPE_INT, 8, 0, 16,
+  9, USB_INTERFACE_DESCRIPTOR_TYPE, 1, 0, 2, USB_DEVICE_CLASS_DATA, 0x00, 0x00, 0,
+  7, USB_ENDPOINT_DESCRIPTOR_TYPE, 0x81, USB_EP_TYPE_BULK, 64, 0, 0,
+  7, USB_ENDPOINT_DESCRIPTOR_TYPE, 0x02, USB_EP_TYPE_BULK, 64, 0, 0
+};
+
+//
+// FT232R, full speed.
+//
+static const U8 _abFT232DeviceDesc[18] = {
+  18, USB_DEVICE_DESCRIPTOR_TYPE, 0x00, 0x02, 0x00, 0x00, 0x00, 8,
+  0x03, 0x04, 0x01, 0x60, 0x00, 0x06, 1, 2, 3, 1
+};
+
+static const U8 _abFT232ConfigDesc[32] = {
+  9, USB_CONFIGURATION_DESCRIPTOR_TYPE, 32, 0, 1, 1, 0, 0xA0, 45,
+  9, USB_INTERFACE_DESCRIPTOR_TYPE, 0, 0, 2, USB_DEVICE_CLASS_VENDOR_SPECIFIC, 0xFF, 0xFF, 2,
+  7, USB_ENDPOINT_DESCRIPTOR_TYPE, 0x81, USB_EP_TYPE_BULK, FT232_PACKET_SIZE, 0, 0,
+  7, USB_ENDPOINT_DESCRIPTOR_TYPE, 0x02, USB_EP_TYPE_BULK, FT232_PACKET_SIZE, 0, 0
+};
+
+//
+// Mass storage, Bulk-Only transport, SCSI transparent command set, high speed.
+//
+static const U8 _abMSDDeviceDesc[18] = {
+  18, USB_DEVICE_DESCRIPTOR_TYPE, 0x00, 0x02, 0x00, 0x00, 0x00, 64,
+  (U8)VHC_VID_SEGGER, (U8)(VHC_VID_SEGGER >> 8), 0x00, 0x10, 0x00, 0x01, 1, 2, 3, 1
+};
+
+static const U8 _abMSDConfigDesc[32] = {
+  9, USB_CONFIGURATION_DESCRIPTOR_TYPE, 32, 0, 1, 1, 0, 0x80, 50,
+  9, USB_INTERFACE_DESCRIPTOR_TYPE, 0, 0, 2, USB_DEVICE_CLASS_STORAGE, 0x06, 0x50, 0,
+  7, USB_ENDPOINT_DESCRIPTOR_TYPE, 0x81, USB_EP_TYPE_BULK, (U8)MSD_BULK_EP_SIZE, (U8)(MSD_BULK_EP_SIZE >> 8), 0,
+  7, USB_ENDPOINT_DESCRIPTOR_TYPE, 0x02, USB_EP_TYPE_BULK, (U8)MSD_BULK_EP_SIZE, (U8)(MSD_BULK_EP_SIZE >> 8), 0
+};
+
+//
+// Hub, full speed. Keeping the hub at full speed avoids split transactions
+// on the virtual bus for full speed devices behind it.
+//
+static const U8 _abHubDeviceDesc[18] = {
+  18, USB_DEVICE_DESCRIPTOR_TYPE, 0x00, 0x02, USB_DEVICE_CLASS_HUB, 0x00, 0x00, 64,
+  (U8)VHC_VID_SEGGER, (U8)(VHC_VID_SEGGER >> 8), 0x00, 0x20, 0x00, 0x01, 1, 2, 3, 1
+};
+
+static const U8 _abHubConfigDesc[25] = {
+  9, USB_CONFIGURATION_DESCRIPTOR_TYPE, 25, 0, 1, 1, 0, 0xE0, 0,
+  9, USB_INTERFACE_DESCRIPTOR_TYPE, 0, 0, 1, USB_DEVICE_CLASS_HUB, 0x00, 0x00, 0,
+  7, USB_ENDPOINT_DESCRIPTOR_TYPE, 0x81, USB_EP_TYPE_INT, 1, 0, 16
+};
+
+/*********************************************************************
+*
+*       Static code, serial (CDC loopback and FT232)
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _SERIAL_Write
+*
+*  Function description
+*    Stores OUT data in the loopback buffer. NAKs if the buffer is full.
+*/
+static USBH_STATUS _SERIAL_Write(VHC_SERIAL * pSerial, const U8 * pData, U32 * pNumBytes) {
+  U32 NumBytesFree;
+
+  NumBytesFree = pSerial->Loopback.Size - pSerial->Loopback.NumBytesIn;
+  *pNumBytes   = USBH_MIN(*pNumBytes, NumBytesFree);
+  if (*pNumBytes == 0u) {
+    return USBH_STATUS_PENDING;
+  }
+  USBH_BUFFER_Write(&pSerial->Loopback, pData, *pNumBytes);
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       _CDC_OnSetup
+*/
+static USBH_STATUS _CDC_OnSetup(USBH_VHC_DEVICE * pDev, const USBH_SETUP_PACKET * pSetup, U8 * pData, U32 * pNumBytes) {
+  VHC_SERIAL * pSerial;
+
+  pSerial = USBH_CTX2PTR(VHC_SERIAL, pDev);
+  switch (pSetup->Request) {
+  case CDC_SET_LINE_CODING:
+    if (pSetup->Length >= sizeof(pSerial->aLineCoding)) {
+      USBH_MEMCPY(pSerial->aLineCoding, pData, sizeof(pSerial->aLineCoding));
+    }
+    break;
+  case CDC_GET_LINE_CODING:
+    *pNumBytes = USBH_MIN((U32)pSetup->Length, sizeof(pSerial->aLineCoding));
+    USBH_MEMCPY(pData, pSerial->aLineCoding, *pNumBytes);
+    break;
+  case CDC_SET_CONTROL_LINE_STATE:
+  case CDC_SEND_BREAK:
+    break;
+  default:
+    return USBH_STATUS_STALL;
+  }
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       _CDC_OnData
+*
+*  Function description
+*    Everything sent to the bulk OUT endpoint is returned on the bulk IN endpoint.
+*    The notification endpoint never has data.
+*/
+static USBH_STATUS _CDC_OnData(USBH_VHC_DEVICE * pDev, U8 EndpointAddress, U8 * pData, U32 * pNumBytes) {
+  VHC_SERIAL * pSerial;
+
+  pSerial = USBH_CTX2PTR(VHC_SERIAL, pDev);
+  switch (EndpointAddress) {
+  case 0x02:
+    return _SERIAL_Write(pSerial, pData, pNumBytes);
+  case 0x81:
+    if (pSerial->Loopback.NumBytesIn == 0u) {
+      return USBH_STATUS_PENDING;
+    }
+    *pNumBytes = USBH_BUFFER_Read(&pSerial->Loopback, pData, *pNumBytes);
+    return USBH_STATUS_SUCCESS;
+  default:
+    return USBH_STATUS_PENDING;
+  }
+}
+
+/*********************************************************************
+*
+*       _SERIAL_OnReset
+*/
+static void _SERIAL_OnReset(USBH_VHC_DEVICE * pDev) {
+  VHC_SERIAL * pSerial;
+
+  pSerial = USBH_CTX2PTR(VHC_SERIAL, pDev);
+  USBH_BUFFER_Init(&pSerial->Loopback, pSerial->aBuffer, sizeof(pSerial->aBuffer));
+}
+
+/*********************************************************************
+*
+*       _FT232_OnSetup
+*
+*  Function description
+*    All vendor requests (baud rate, flow control, ...) are accepted.
+*/
+static USBH_STATUS _FT232_OnSetup(USBH_VHC_DEVICE * pDev, const USBH_SETUP_PACKET * pSetup, U8 * pData, U32 * pNumBytes) {
+  USBH_USE_PARA(pDev);
+  if ((pSetup->Type & USB_TO_HOST) == 0u) {
+    return USBH_STATUS_SUCCESS;
+  }
+  *pNumBytes = pSetup->Length;
+  USBH_MEMSET(pData, 0, *pNumBytes);
+  if (pSetup->Request == FT232_REQUEST_GETMODEMSTAT && *pNumBytes >= 2u) {
+    pData[0] = 0x01;
+    pData[1] = 0x60;
+  } else if (pSetup->Request == FT232_REQUEST_GETLATENCYTIMER && *pNumBytes >= 1u) {
+    pData[0] = 16;
+  } else {
+    // Return zeros.
+  }
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       _FT232_OnData
+*
+*  Function description
+*    Loopback with the FTDI packet format: Each IN packet starts with
+*    two modem / line status bytes. Unlike the real chip the model does
+*    not send status-only packets, it NAKs while no data is available.
+*/
+static USBH_STATUS _FT232_OnData(USBH_VHC_DEVICE * pDev, U8 EndpointAddress, U8 * pData, U32 * pNumBytes) {
+  VHC_SERIAL * pSerial;
+  U32          NumBytesAvail;
+  U32          NumBytesReq;
+  unsigned     NumBytesPayload;
+
+  pSerial = USBH_CTX2PTR(VHC_SERIAL, pDev);
+  if (EndpointAddress != 0x81u) {
+    return _SERIAL_Write(pSerial, pData, pNumBytes);
+  }
+  if (pSerial->Loopback.NumBytesIn == 0u) {
+    return USBH_STATUS_PENDING;
+  }
+  NumBytesAvail = *pNumBytes;
+  NumBytesReq   = 0;
+  while (NumBytesAvail >= FT232_HEADER_SIZE) {
+    pData[NumBytesReq]      = 0x01;
+    pData[NumBytesReq + 1u] = 0x60;
+    NumBytesPayload = USBH_MIN(NumBytesAvail, FT232_PACKET_SIZE) - FT232_HEADER_SIZE;
+    NumBytesPayload = USBH_BUFFER_Read(&pSerial->Loopback, &pData[NumBytesReq + FT232_HEADER_SIZE], NumBytesPayload);
+    NumBytesReq    += FT232_HEADER_SIZE + NumBytesPayload;
+    NumBytesAvail  -= FT232_HEADER_SIZE + NumBytesPayload;
+    if (NumBytesPayload < FT232_PACKET_SIZE - FT232_HEADER_SIZE) {
+      break;                                                  // Short packet ends the transfer.
+    }
+  }
+  *pNumBytes = NumBytesReq;
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       Static code, mass storage
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _MSD_SetSense
+*/
+static void _MSD_SetSense(VHC_MSD * pMSD, U8 SenseKey, U8 Asc) {
+  pMSD->SenseKey  = SenseKey;
+  pMSD->Asc       = Asc;
+  pMSD->CswStatus = (SenseKey == SCSI_SENSE_NONE) ? MSD_CSW_PASSED : MSD_CSW_FAILED;
+}
+
+/*********************************************************************
+*
+*       _MSD_OnCBW
+*
+*  Function description
+*    Decodes a command block wrapper and prepares the data stage.
+*/
+static USBH_STATUS _MSD_OnCBW(VHC_MSD * pMSD, const U8 * pCBW, U32 NumBytes) {
+  const U8 * pCB;
+  U8       * p;
+  U32        NumSectors;
+
+  if (NumBytes != MSD_CBW_LENGTH || USBH_LoadU32LE(pCBW) != MSD_CBW_SIGNATURE) {
+    return USBH_STATUS_STALL;
+  }
+  pMSD->Tag                = USBH_LoadU32LE(&pCBW[4]);
+  pMSD->DataTransferLength = USBH_LoadU32LE(&pCBW[8]);
+  pMSD->NumBytesDone       = 0;
+  pMSD->ResponseLen        = 0;
+  pMSD->NumSectorsLeft     = 0;
+  pCB                      = &pCBW[15];
+  pMSD->Cmd                = pCB[0];
+  p                        = pMSD->aResponse;
+  USBH_MEMSET(p, 0, sizeof(pMSD->aResponse));
+  _MSD_SetSense(pMSD, SCSI_SENSE_NONE, 0);
+  switch (pMSD->Cmd) {
+  case SCSI_TEST_UNIT_READY:
+  case SCSI_START_STOP_UNIT:
+  case SCSI_PREVENT_ALLOW_REMOVAL:
+  case SCSI_VERIFY_10:
+  case SCSI_SYNCHRONIZE_CACHE_10:
+    break;
+  case SCSI_REQUEST_SENSE:
+    p[0]  = 0x70;
+    p[2]  = pMSD->SenseKey;
+    p[7]  = 10;
+    p[12] = pMSD->Asc;
+    pMSD->ResponseLen = 18;
+    _MSD_SetSense(pMSD, SCSI_SENSE_NONE, 0);
+    break;
+  case SCSI_INQUIRY:
+    p[1] = 0x80;                                              // Removable medium
+    p[2] = 0x02;
+    p[3] = 0x02;
+    p[4] = 31;
+    USBH_MEMCPY(&p[8],  "SEGGER  ", 8);
+    USBH_MEMCPY(&p[16], "Virtual disk    ", 16);
+    USBH_MEMCPY(&p[32], "1.00", 4);
+    pMSD->ResponseLen = 36;
+    break;
+  case SCSI_MODE_SENSE_6:
+    p[0] = 3;
+    p[2] = (pMSD->Storage.pfWrite == NULL) ? 0x80u : 0x00u;   // Write protect flag
+    pMSD->ResponseLen = 4;
+    break;
+  case SCSI_READ_CAPACITY_10:
+    USBH_StoreU32BE(&p[0], pMSD->Storage.NumSectors - 1u);
+    USBH_StoreU32BE(&p[4], pMSD->Storage.BytesPerSector);
+    pMSD->ResponseLen = 8;
+    break;
+  case SCSI_READ_10:
+  case SCSI_WRITE_10:
+    pMSD->Lba  = USBH_LoadU32BE(&pCB[2]);
+    NumSectors = USBH_LoadU16BE(&pCB[7]);
+    if (pMSD->Lba >= pMSD->Storage.NumSectors || NumSectors > pMSD->Storage.NumSectors - pMSD->Lba) {
+      _MSD_SetSense(pMSD, SCSI_SENSE_ILLEGAL_REQUEST, SCSI_ASC_LBA_OUT_OF_RANGE);
+    } else if (pMSD->Cmd == SCSI_WRITE_10 && pMSD->Storage.pfWrite == NULL) {
+      _MSD_SetSense(pMSD, SCSI_SENSE_DATA_PROTECT, SCSI_ASC_WRITE_PROTECTED);
+    } else if (NumSectors * pMSD->Storage.BytesPerSector != pMSD->DataTransferLength) {
+      pMSD->CswStatus = MSD_CSW_PHASE_ERROR;
+    } else {
+      pMSD->NumSectorsLeft = NumSectors;
+    }
+    break;
+  default:
+    _MSD_SetSense(pMSD, SCSI_SENSE_ILLEGAL_REQUEST, SCSI_ASC_INVALID_COMMAND);
+    break;
+  }
+  if (pMSD->DataTransferLength == 0u) {
+    pMSD->State = MSD_STATE_CSW;
+  } else if ((pCBW[12] & USB_IN_DIRECTION) != 0u) {
+    pMSD->State = MSD_STATE_DATA_IN;
+  } else {
+    pMSD->State = MSD_STATE_DATA_OUT;
+  }
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       _MSD_DataIn
+*
+*  Function description
+*    Data stage device to host. A short transfer ends the data stage,
+*    the host continues with the CSW.
+*/
+static USBH_STATUS _MSD_DataIn(VHC_MSD * pMSD, U8 * pData, U32 * pNumBytes) {
+  U32 NumBytes;
+  U32 NumSectors;
+  U32 BytesPerSector;
+
+  NumBytes = USBH_MIN(*pNumBytes, pMSD->DataTransferLength - pMSD->NumBytesDone);
+  if (pMSD->Cmd == SCSI_READ_10) {
+    BytesPerSector = pMSD->Storage.BytesPerSector;
+    NumSectors     = USBH_MIN(NumBytes / BytesPerSector, pMSD->NumSectorsLeft);
+    if (NumSectors == 0u && pMSD->NumSectorsLeft != 0u) {
+      pMSD->CswStatus = MSD_CSW_PHASE_ERROR;                  // Transfer is not a multiple of the sector size.
+    }
+    if (NumSectors != 0u && pMSD->Storage.pfRead(pMSD->Storage.pContext, pMSD->Lba, pData, NumSectors) != 0) {
+      _MSD_SetSense(pMSD, SCSI_SENSE_MEDIUM_ERROR, SCSI_ASC_UNRECOVERED_READ_ERROR);
+      pMSD->NumSectorsLeft = 0;
+      NumSectors           = 0;
+    }
+    pMSD->Lba            += NumSectors;
+    pMSD->NumSectorsLeft -= NumSectors;
+    NumBytes              = NumSectors * BytesPerSector;
+  } else {
+    NumBytes = (pMSD->NumBytesDone < pMSD->ResponseLen) ? USBH_MIN(NumBytes, pMSD->ResponseLen - pMSD->NumBytesDone) : 0u;
+    USBH_MEMCPY(pData, &pMSD->aResponse[pMSD->NumBytesDone], NumBytes);
+  }
+  pMSD->NumBytesDone += NumBytes;
+  if (NumBytes < *pNumBytes || pMSD->NumBytesDone == pMSD->DataTransferLength) {
+    pMSD->State = MSD_STATE_CSW;
+  }
+  *pNumBytes = NumBytes;
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       _MSD_DataOut
+*
+*  Function description
+*    Data stage host to device. Data of failed commands is discarded.
+*/
+static USBH_STATUS _MSD_DataOut(VHC_MSD * pMSD, const U8 * pData, U32 * pNumBytes) {
+  U32 NumBytes;
+  U32 NumSectors;
+
+  NumBytes = USBH_MIN(*pNumBytes, pMSD->DataTransferLength - pMSD->NumBytesDone);
+  if (pMSD->Cmd == SCSI_WRITE_10 && pMSD->NumSectorsLeft != 0u) {
+    NumSectors = USBH_MIN(NumBytes / pMSD->Storage.BytesPerSector, pMSD->NumSectorsLeft);
+    if (pMSD->Storage.pfWrite(pMSD->Storage.pContext, pMSD->Lba, pData, NumSectors) != 0) {
+      _MSD_SetSense(pMSD, SCSI_SENSE_MEDIUM_ERROR, SCSI_ASC_WRITE_FAULT);
+      pMSD->NumSectorsLeft = 0;
+    } else {
+      pMSD->Lba            += NumSectors;
+      pMSD->NumSectorsLeft -= NumSectors;
+      NumBytes              = NumSectors * pMSD->Storage.BytesPerSector;
+    }
+  }
+  pMSD->NumBytesDone += NumBytes;
+  if (pMSD->NumBytesDone == pMSD->DataTransferLength) {
+    pMSD->State = MSD_STATE_CSW;
+  }
+  *pNumBytes = NumBytes;
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       _MSD_OnData
+*
+*  Function description
+*    Bulk-Only transport state machine.
+*/
+static USBH_STATUS _MSD_OnData(USBH_VHC_DEVICE * pDev, U8 EndpointAddress, U8 * pData, U32 * pNumBytes) {
+  VHC_MSD * pMSD;
+
+  pMSD = USBH_CTX2PTR(VHC_MSD, pDev);
+  if ((EndpointAddress & USB_IN_DIRECTION) == 0u) {
+    if (pMSD->State == MSD_STATE_CBW) {
+      return _MSD_OnCBW(pMSD, pData, *pNumBytes);
+    }
+    if (pMSD->State == MSD_STATE_DATA_OUT) {
+      return _MSD_DataOut(pMSD, pData, pNumBytes);
+    }
+    return USBH_STATUS_STALL;
+  }
+  switch (pMSD->State) {
+  case MSD_STATE_DATA_IN:
+    return _MSD_DataIn(pMSD, pData, pNumBytes);
+  case MSD_STATE_CSW:
+    if (*pNumBytes < MSD_CSW_LENGTH) {
+      return USBH_STATUS_STALL;
+    }
+    USBH_StoreU32LE(&pData[0], MSD_CSW_SIGNATURE);
+    USBH_StoreU32LE(&pData[4], pMSD->Tag);
+    USBH_StoreU32LE(&pData[8], pMSD->DataTransferLength - pMSD->NumBytesDone);
+    pData[12]   = pMSD->CswStatus;
+    *pNumBytes  = MSD_CSW_LENGTH;
+    pMSD->State = MSD_STATE_CBW;
+    return USBH_STATUS_SUCCESS;
+  default:
+    return USBH_STATUS_PENDING;                               // Waiting for a CBW
+  }
+}
+
+/*********************************************************************
+*
+*       _MSD_OnSetup
+*/
+static USBH_STATUS _MSD_OnSetup(USBH_VHC_DEVICE * pDev, const USBH_SETUP_PACKET * pSetup, U8 * pData, U32 * pNumBytes) {
+  VHC_MSD * pMSD;
+
+  pMSD = USBH_CTX2PTR(VHC_MSD, pDev);
+  switch (pSetup->Request) {
+  case MSD_REQ_GET_MAX_LUN:
+    if (pSetup->Length != 0u) {
+      pData[0]   = 0;
+      *pNumBytes = 1;
+    }
+    break;
+  case MSD_REQ_RESET:
+    pMSD->State = MSD_STATE_CBW;
+    break;
+  default:
+    return USBH_STATUS_STALL;
+  }
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       _MSD_OnReset
+*/
+static void _MSD_OnReset(USBH_VHC_DEVICE * pDev) {
+  VHC_MSD * pMSD;
+
+  pMSD = USBH_CTX2PTR(VHC_MSD, pDev);
+  pMSD->State = MSD_STATE_CBW;
+  _MSD_SetSense(pMSD, SCSI_SENSE_NONE, 0);
+}
+
+/*********************************************************************
+*
+*       Static code, hub
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _HUB_SetPortFeature
+*/
+static USBH_STATUS _HUB_SetPortFeature(VHC_HUB_PORT * pPort, unsigned Selector) {
+  switch (Selector) {
+  case HDC_SELECTOR_PORT_POWER:
+    if ((pPort->Status & PORT_STATUS_POWER) == 0u) {
+      pPort->Status |= PORT_STATUS_POWER;
+      if (pPort->pDev != NULL) {
+        pPort->Status |= PORT_STATUS_CONNECT;
+        pPort->Change |= HUB_CHANGE_BIT(HDC_SELECTOR_C_PORT_CONNECTION);
+      }
+    }
+    break;
+  case HDC_SELECTOR_PORT_RESET:
+    if (pPort->pDev != NULL) {
+      USBH_VHC__ResetDevice(pPort->pDev);
+      pPort->Status &= ~(PORT_STATUS_SUSPEND | HUB_PORT_STATUS_SPEED_MASK);
+      pPort->Status |= PORT_STATUS_ENABLED;
+      if (pPort->pDev->Speed == USBH_LOW_SPEED) {
+        pPort->Status |= PORT_STATUS_LOW_SPEED;         // High speed devices run at full speed behind the full speed hub.
+      }
+    }
+    pPort->Change |= HUB_CHANGE_BIT(HDC_SELECTOR_C_PORT_RESET);
+    break;
+  case HDC_SELECTOR_PORT_SUSPEND:
+    pPort->Status |= PORT_STATUS_SUSPEND;
+    break;
+  default:
+    break;
+  }
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       _HUB_ClearPortFeature
+*/
+static USBH_STATUS _HUB_ClearPortFeature(VHC_HUB_PORT * pPort, unsigned Selector) {
+  switch (Selector) {
+  case HDC_SELECTOR_PORT_ENABLE:
+  case HDC_SELECTOR_PORT_POWER:
+    if (Selector == HDC_SELECTOR_PORT_POWER) {
+      pPort->Status = 0;
+    }
+    pPort->Status &= ~PORT_STATUS_ENABLED;
+    if (pPort->pDev != NULL) {
+      pPort->pDev->IsEnabled = 0;
+    }
+    break;
+  case HDC_SELECTOR_PORT_SUSPEND:
+    pPort->Status &= ~PORT_STATUS_SUSPEND;
+    break;
+  case HDC_SELECTOR_C_PORT_CONNECTION:
+  case HDC_SELECTOR_C_PORT_ENABLE:
+  case HDC_SELECTOR_C_PORT_SUSPEND:
+  case HDC_SELECTOR_C_PORT_OVER_CURRENT:
+  case HDC_SELECTOR_C_PORT_RESET:
+    pPort->Change &= ~HUB_CHANGE_BIT(Selector);
+    break;
+  default:
+    break;
+  }
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       _HUB_OnSetup
+*
+*  Function description
+*    Hub class requests as defined in the USB specification 11.24.2.
+*/
+static USBH_STATUS _HUB_OnSetup(USBH_VHC_DEVICE * pDev, const USBH_SETUP_PACKET * pSetup, U8 * pData, U32 * pNumBytes) {
+  VHC_HUB      * pHub;
+  VHC_HUB_PORT * pPort;
+  U8             aDesc[9];
+  unsigned       Port;
+
+  pHub  = USBH_CTX2PTR(VHC_HUB, pDev);
+  Port  = pSetup->Index & 0xFFu;
+  pPort = NULL;
+  if ((pSetup->Type & 0x1Fu) == USB_OTHER_RECIPIENT) {
+    if (Port == 0u || Port > pHub->NumPorts) {
+      return USBH_STATUS_STALL;
+    }
+    pPort = &pHub->aPort[Port - 1u];
+  }
+  switch (pSetup->Request) {
+  case HDC_REQTYPE_GET_DESCRIPTOR:
+    if ((pSetup->Value >> 8) != USB_HUB_DESCRIPTOR_TYPE) {
+      return USBH_STATUS_STALL;
+    }
+    aDesc[0] = sizeof(aDesc);
+    aDesc[1] = USB_HUB_DESCRIPTOR_TYPE;
+    aDesc[2] = (U8)pHub->NumPorts;
+    aDesc[3] = HDC_DESC_SINGLE_POWER_SWITCH_VALUE | HDC_DESC_OVERCURRENT_SELECTIVE_VAL;
+    aDesc[4] = 0;
+    aDesc[5] = 1;                                             // Power on to power good: 2 ms
+    aDesc[6] = 0;
+    aDesc[7] = 0;                                             // All devices removable
+    aDesc[8] = 0xFF;
+    *pNumBytes = USBH_MIN((U32)pSetup->Length, sizeof(aDesc));
+    USBH_MEMCPY(pData, aDesc, *pNumBytes);
+    break;
+  case HDC_REQTYPE_GET_STATUS:
+    if (pSetup->Length < HCD_GET_STATUS_LENGTH) {
+      return USBH_STATUS_STALL;
+    }
+    USBH_MEMSET(pData, 0, HCD_GET_STATUS_LENGTH);
+    if (pPort != NULL) {
+      USBH_StoreU16LE(&pData[0], pPort->Status);
+      USBH_StoreU16LE(&pData[2], pPort->Change);
+    }
+    *pNumBytes = HCD_GET_STATUS_LENGTH;
+    break;
+  case HDC_REQTYPE_SET_FEATRUE:
+    if (pPort != NULL) {
+      return _HUB_SetPortFeature(pPort, pSetup->Value);
+    }
+    break;
+  case HDC_REQTYPE_CLEAR_FEATRUE:
+    if (pPort != NULL) {
+      return _HUB_ClearPortFeature(pPort, pSetup->Value);
+    }
+    break;
+  case HDC_REQTYPE_CLEAR_TT_BUFFER:
+  case HDC_REQTYPE_RESET_TT:
+    break;
+  default:
+    return USBH_STATUS_STALL;
+  }
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       _HUB_OnData
+*
+*  Function description
+*    Status change endpoint: Bit n is set if port n has a change.
+*    NAKs while there is no change.
+*/
+static USBH_STATUS _HUB_OnData(USBH_VHC_DEVICE * pDev, U8 EndpointAddress, U8 * pData, U32 * pNumBytes) {
+  VHC_HUB  * pHub;
+  unsigned   i;
+  U8         Mask;
+
+  USBH_USE_PARA(EndpointAddress);
+  pHub = USBH_CTX2PTR(VHC_HUB, pDev);
+  Mask = 0;
+  USBH_OS_DisableInterrupt();
+  for (i = 0; i < pHub->NumPorts; i++) {
+    if (pHub->aPort[i].Change != 0u) {
+      Mask |= (U8)(1u << (i + 1u));
+    }
+  }
+  USBH_OS_EnableInterrupt();
+  if (Mask == 0u || *pNumBytes == 0u) {
+    return USBH_STATUS_PENDING;
+  }
+  pData[0]   = Mask;
+  *pNumBytes = 1;
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       _HUB_OnReset
+*
+*  Function description
+*    A reset of the hub powers off all its ports.
+*/
+static void _HUB_OnReset(USBH_VHC_DEVICE * pDev) {
+  VHC_HUB  * pHub;
+  unsigned   i;
+
+  pHub = USBH_CTX2PTR(VHC_HUB, pDev);
+  for (i = 0; i < pHub->NumPorts; i++) {
+    pHub->aPort[i].Status = 0;
+    pHub->aPort[i].Change = 0;
+    if (pHub->aPort[i].pDev != NULL) {
+      pHub->aPort[i].pDev->IsEnabled = 0;
+    }
+  }
+}
+
+/*********************************************************************
+*
+*       _HUB_OnDetach
+*
+*  Function description
+*    Devices behind a removed hub disappear from the bus as well.
+*    They remain connected to the hub object.
+*/
+static void _HUB_OnDetach(USBH_VHC_DEVICE * pDev) {
+  VHC_HUB  * pHub;
+  unsigned   i;
+
+  pHub = USBH_CTX2PTR(VHC_HUB, pDev);
+  for (i = 0; i < pHub->NumPorts; i++) {
+    pHub->aPort[i].Status = 0;
+    pHub->aPort[i].Change = 0;
+    if (pHub->aPort[i].pDev != NULL) {
+      USBH_VHC__DetachDevice(pHub->aPort[i].pDev);
+    }
+  }
+}
+
+/*********************************************************************
+*
+*       Static const data, device APIs
+*
+**********************************************************************
+*/
+static const USBH_VHC_DEVICE_API _CDC_API   = { _CDC_OnSetup,   _CDC_OnData,   _SERIAL_OnReset, NULL          };
+static const USBH_VHC_DEVICE_API _FT232_API = { _FT232_OnSetup, _FT232_OnData, _SERIAL_OnReset, NULL          };
+static const USBH_VHC_DEVICE_API _MSD_API   = { _MSD_OnSetup,   _MSD_OnData,   _MSD_OnReset,    NULL          };
+static const USBH_VHC_DEVICE_API _HUB_API   = { _HUB_OnSetup,   _HUB_OnData,   _HUB_OnReset,    _HUB_OnDetach };
+
+/*********************************************************************
+*
+*       _IsHub
+*/
+static int _IsHub(const USBH_VHC_DEVICE * pDev) {
+  return (pDev != NULL && pDev->pAPI == &_HUB_API) ? 1 : 0;
+}
+
+/*********************************************************************
+*
+*       _CreateSerial
+*/
+static USBH_VHC_DEVICE * _CreateSerial(const USBH_VHC_DEVICE_API * pAPI, const U8 * pDeviceDesc, const U8 * pConfigDesc, const char * const * papString) {
+  VHC_SERIAL * pSerial;
+
+  pSerial = (VHC_SERIAL *)USBH_TRY_MALLOC_ZEROED(sizeof(VHC_SERIAL));
+  if (pSerial == NULL) {
+    return NULL;
+  }
+  pSerial->Dev.pAPI        = pAPI;
+  pSerial->Dev.pDeviceDesc = pDeviceDesc;
+  pSerial->Dev.pConfigDesc = pConfigDesc;
+  pSerial->Dev.papString   = papString;
+  pSerial->Dev.NumStrings  = 3;
+  pSerial->Dev.Speed       = USBH_FULL_SPEED;
+  USBH_StoreU32LE(pSerial->aLineCoding, 115200);
+  pSerial->aLineCoding[6]  = 8;
+  USBH_BUFFER_Init(&pSerial->Loopback, pSerial->aBuffer, sizeof(pSerial->aBuffer));
+  return &pSerial->Dev;
+}
+
+/*********************************************************************
+*
+*       Public code
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       USBH_VHC_CreateCDCLoopback
+*
+*  Function description
+*    Creates a simulated CDC ACM device which returns all data
+*    written to it.
+*
+*  Return value
+*    Simulated device, NULL if no memory is available.
+*/
+USBH_VHC_DEVICE * USBH_VHC_CreateCDCLoopback(void) {
+  return _CreateSerial(&_CDC_API, _abCDCDeviceDesc, _abCDCConfigDesc, _apStringSEGGER);
+}
+
+/*********************************************************************
+*
+*       USBH_VHC_CreateFT232
+*
+*  Function description
+*    Creates a simulated FTDI FT232R in loopback mode.
+*
+*  Return value
+*    Simulated device, NULL if no memory is available.
+*/
+USBH_VHC_DEVICE * USBH_VHC_CreateFT232(void) {
+  return _CreateSerial(&_FT232_API, _abFT232DeviceDesc, _abFT232ConfigDesc, _apStringFTDI);
+}
+
+/*********************************************************************
+*
+*       USBH_VHC_CreateMSD
+*
+*  Function description
+*    Creates a simulated mass storage device (Bulk-Only transport,
+*    SCSI transparent command set) with a single LUN.
+*
+*  Parameters
+*    pStorage : Storage backing the medium. The structure is copied.
+*
+*  Return value
+*    Simulated device, NULL if no memory is available or the storage is invalid.
+*
+*  Additional information
+*    On a host PC build the read and write callbacks typically access a
+*    disk image file. pStorage->BytesPerSector must be a divisor of the
+*    maximum transfer size of the virtual host controller.
+*/
+USBH_VHC_DEVICE * USBH_VHC_CreateMSD(const USBH_VHC_MSD_STORAGE * pStorage) {
+  VHC_MSD * pMSD;
+
+  if (pStorage == NULL || pStorage->pfRead == NULL || pStorage->NumSectors == 0u || pStorage->BytesPerSector == 0u) {
+    return NULL;
+  }
+  pMSD = (VHC_MSD *)USBH_TRY_MALLOC_ZEROED(sizeof(VHC_MSD));
+  if (pMSD == NULL) {
+    return NULL;
+  }
+  pMSD->Dev.pAPI        = &_MSD_API;
+  pMSD->Dev.pDeviceDesc = _abMSDDeviceDesc;
+  pMSD->Dev.pConfigDesc = _abMSDConfigDesc;
+  pMSD->Dev.papString   = _apStringSEGGER;
+  pMSD->Dev.NumStrings  = 3;
+  pMSD->Dev.Speed       = USBH_HIGH_SPEED;
+  pMSD->Storage         = *pStorage;
+  return &pMSD->Dev;
+}
+
+/*********************************************************************
+*
+*       USBH_VHC_CreateHub
+*
+*  Function description
+*    Creates a simulated full speed hub.
+*
+*  Parameters
+*    NumPorts : Number of downstream ports (1..USBH_VHC_HUB_MAX_PORTS).
+*
+*  Return value
+*    Simulated device, NULL if no memory is available.
+*/
+USBH_VHC_DEVICE * USBH_VHC_CreateHub(unsigned NumPorts) {
+  VHC_HUB * pHub;
+
+  if (NumPorts == 0u || NumPorts > USBH_VHC_HUB_MAX_PORTS) {
+    NumPorts = USBH_VHC_HUB_MAX_PORTS;
+  }
+  pHub = (VHC_HUB *)USBH_TRY_MALLOC_ZEROED(sizeof(VHC_HUB));
+  if (pHub == NULL) {
+    return NULL;
+  }
+  pHub->Dev.pAPI        = &_HUB_API;
+  pHub->Dev.pDeviceDesc = _abHubDeviceDesc;
+  pHub->Dev.pConfigDesc = _abHubConfigDesc;
+  pHub->Dev.papString   = _apStringSEGGER;
+  pHub->Dev.NumStrings  = 3;
+  pHub->Dev.Speed       = USBH_FULL_SPEED;
+  pHub->NumPorts        = NumPorts;
+  return &pHub->Dev;
+}
+
+/*********************************************************************
+*
+*       USBH_VHC_HUB_Connect
+*
+*  Function description
+*    Connects a simulated device to a downstream port of a simulated hub.
+*
+*  Parameters
+*    pHub : Hub created with USBH_VHC_CreateHub().
+*    Port : One based index of the hub port.
+*    pDev : Simulated device.
+*/
+USBH_STATUS USBH_VHC_HUB_Connect(USBH_VHC_DEVICE * pHub, unsigned Port, USBH_VHC_DEVICE * pDev) {
+  VHC_HUB      * pInst;
+  VHC_HUB_PORT * pPort;
+
+  if (_IsHub(pHub) == 0 || pDev == NULL) {
+    return USBH_STATUS_INVALID_PARAM;
+  }
+  pInst = USBH_CTX2PTR(VHC_HUB, pHub);
+  if (Port == 0u || Port > pInst->NumPorts) {
+    return USBH_STATUS_INVALID_PARAM;
+  }
+  pPort = &pInst->aPort[Port - 1u];
+  if (pPort->pDev != NULL) {
+    return USBH_STATUS_BUSY;
+  }
+  USBH_VHC__AttachDevice(pDev);
+  USBH_OS_DisableInterrupt();
+  pPort->pDev = pDev;
+  if ((pPort->Status & PORT_STATUS_POWER) != 0u) {
+    pPort->Status |= PORT_STATUS_CONNECT;
+    pPort->Change |= HUB_CHANGE_BIT(HDC_SELECTOR_C_PORT_CONNECTION);
+  }
+  USBH_OS_EnableInterrupt();
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       USBH_VHC_HUB_Disconnect
+*
+*  Function description
+*    Disconnects the device from a downstream port of a simulated hub.
+*    The device object is not deleted.
+*/
+USBH_STATUS USBH_VHC_HUB_Disconnect(USBH_VHC_DEVICE * pHub, unsigned Port) {
+  VHC_HUB         * pInst;
+  VHC_HUB_PORT    * pPort;
+  USBH_VHC_DEVICE * pDev;
+
+  if (_IsHub(pHub) == 0) {
+    return USBH_STATUS_INVALID_PARAM;
+  }
+  pInst = USBH_CTX2PTR(VHC_HUB, pHub);
+  if (Port == 0u || Port > pInst->NumPorts) {
+    return USBH_STATUS_INVALID_PARAM;
+  }
+  pPort = &pInst->aPort[Port - 1u];
+  USBH_OS_DisableInterrupt();
+  pDev        = pPort->pDev;
+  pPort->pDev = NULL;
+  if ((pPort->Status & PORT_STATUS_CONNECT) != 0u) {
+    pPort->Status &= ~(PORT_STATUS_CONNECT | PORT_STATUS_ENABLED | PORT_STATUS_SUSPEND | HUB_PORT_STATUS_SPEED_MASK);
+    pPort->Change |= HUB_CHANGE_BIT(HDC_SELECTOR_C_PORT_CONNECTION);
+  }
+  USBH_OS_EnableInterrupt();
+  if (pDev == NULL) {
+    return USBH_STATUS_NOT_FOUND;
+  }
+  USBH_VHC__DetachDevice(pDev);
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       USBH_VHC_DeleteDevice
+*
+*  Function description
+*    Frees a simulated device created by one of the USBH_VHC_Create...()
+*    functions. The device must be disconnected.
+*/
+void USBH_VHC_DeleteDevice(USBH_VHC_DEVICE * pDev) {
+  if (pDev != NULL) {
+    USBH_FREE(pDev);
+  }
+}
+
+/*************************** End of file ****************************/
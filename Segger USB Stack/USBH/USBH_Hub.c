@@ -474,6 +474,9 @@ static USBH_STATUS _HubStartPeriodicStatusTransfer(USBH_HUB * pHub) {
 static void _PortResetSetIdle(USBH_HUB * pHub) {
   pHub->PortResetEnumState = USBH_HUB_PORTRESET_IDLE;
   pHub->pEnumDevice        = NULL;
+  if (pHub->pEnumPort != NULL) {
+    pHub->pEnumPort->DebounceState = USBH_PORT_DEBOUNCE_NONE;     // A retry has to debounce again.
+  }
   pHub->pEnumPort          = NULL;
   // Allow starting an port reset on another port
   USBH_ReleaseActivePortReset(pHub->pHubDevice->pHostController);
@@ -545,11 +548,22 @@ static void _ProcessPortReset(USBH_HUB * pHub, USBH_HUB_PORT * pPort) {
                               USBH_HubPortResetState2Str(pHub->PortResetEnumState)));
   switch(pHub->PortResetEnumState) {
   case USBH_HUB_PORTRESET_START:
+    if (pPort->DebounceState == USBH_PORT_DEBOUNCE_DONE) {
+      //
+      // Power good time has already elapsed in _ProcessPorts(), reset the port immediately.
+      //
+      pHub->PortResetEnumState = USBH_HUB_PORTRESET_WAIT_RESTART;
+      break;
+    }
     pPort->ToDo |= USBH_PORT_DO_DELAY;
     pPort->DelayUntil = USBH_TIME_CALC_EXPIRATION(USBH_Global.Config.DefaultPowerGoodTime);
     pHub->PortResetEnumState = USBH_HUB_PORTRESET_WAIT_RESTART;
     break;
   case USBH_HUB_PORTRESET_RESTART:
+    if (pPort->DebounceState == USBH_PORT_DEBOUNCE_DONE) {
+      pHub->PortResetEnumState = USBH_HUB_PORTRESET_WAIT_RESTART;
+      break;
+    }
     pPort->ToDo |= USBH_PORT_DO_DELAY;
     pPort->DelayUntil = USBH_TIME_CALC_EXPIRATION(USBH_Global.Config.DefaultPowerGoodTime + USBH_DELAY_FOR_REENUM);
     pHub->PortResetEnumState = USBH_HUB_PORTRESET_WAIT_RESTART;
@@ -586,6 +600,7 @@ static void _ProcessPortReset(USBH_HUB * pHub, USBH_HUB_PORT * pPort) {
     pHub->pEnumDevice         = pEnumDevice;
     pEnumDevice->DeviceSpeed  = pPort->PortSpeed;
     pEnumDevice->pParentPort  = pPort;
+    pEnumDevice->EnumStartTime = pPort->ConnectTime;
     if (USBH_CheckCtrlTransferBuffer(pEnumDevice, USBH_DEFAULT_STATE_EP0_SIZE) != 0) {
       USBH_WARN((USBH_MCAT_HUB, "_ProcessPortReset: No memory"));
       _PortResetFail(pHub, USBH_STATUS_MEMORY, FALSE);
@@ -704,6 +719,8 @@ static void _ProcessPorts(void * p) {
   USBH_BOOL         Restart;
   U32               Mask;
   unsigned          Feature;
+  I32               Diff;
+  U32               Delay;
 #if USBH_SUPPORT_HUB_CLEAR_TT_BUFFER
   unsigned          j;
 #endif
@@ -746,8 +763,6 @@ static void _ProcessPorts(void * p) {
       USBH_LOG((USBH_MCAT_HUB_SM, "_ProcessPorts: Port %u ToDo: %s", pPort->HubPortNumber, USBH_PortToDo2Str(ToDo)));
     }
     if ((ToDo & USBH_PORT_DO_DELAY) != 0u) {
-      I32 Diff;
-
       Diff = USBH_TimeDiff(pPort->DelayUntil, CurrentTime);
       if (Diff > 0) {
         //
@@ -812,6 +827,9 @@ static void _ProcessPorts(void * p) {
     for (Mask = PORT_C_STATUS_CONNECT; Mask <= PORT_C_STATUS_RESET; Mask <<= 1) {     // Check all five port change bits
       if ((pPort->PortStatus & Mask) != 0u) {
         pPort->PortStatus &= ~Mask;
+        if (Mask == PORT_C_STATUS_CONNECT && pPort != pHub->pEnumPort) {
+          pPort->DebounceState = USBH_PORT_DEBOUNCE_NONE;         // Connection bounced, restart debouncing.
+        }
         _HubPrepareClrFeatureReq(pUrb, pHubDevice, Feature, pPort->HubPortNumber);
         pHub->PendingAction = USBH_HUB_ACT_CLR_CHANGE;
         pPort->ToDo |= USBH_PORT_DO_UPDATE_STATUS;        // Make sure we don't miss any state change of the port
@@ -852,10 +870,38 @@ static void _ProcessPorts(void * p) {
         USBH_MarkParentAndChildDevicesAsRemoved(pPort->pDevice);
       }
       if (pPort->RetryCounter <= USBH_RESET_RETRY_COUNTER) {
-        pEnumPort = pPort;
+        //
+        // Wait for power good (and the re-enumeration delay on retries) on every port
+        // with a new connection in parallel. Only the port reset itself is serialized.
+        //
+        if (pPort->DebounceState == USBH_PORT_DEBOUNCE_NONE) {
+          Delay = USBH_Global.Config.DefaultPowerGoodTime;
+          if (pPort->RetryCounter != 0u) {
+            Delay += USBH_DELAY_FOR_REENUM;
+          } else {
+            pPort->ConnectTime = CurrentTime;
+          }
+          pPort->DebounceUntil = USBH_TimeAdd(CurrentTime, Delay);
+          pPort->DebounceState = USBH_PORT_DEBOUNCE_WAIT;
+          USBH_LOG((USBH_MCAT_HUB, "_ProcessPorts: Port %u connected, debounce %u ms", pPort->HubPortNumber, Delay));
+        }
+        if (pPort->DebounceState == USBH_PORT_DEBOUNCE_WAIT) {
+          Diff = USBH_TimeDiff(pPort->DebounceUntil, CurrentTime);
+          if (Diff > 0) {
+            if (Restart == FALSE || (U32)Diff < SleepTime) {
+              Restart   = TRUE;
+              SleepTime = (U32)Diff;
+            }
+          } else {
+            pPort->DebounceState = USBH_PORT_DEBOUNCE_DONE;
+          }
+        }
+        if (pPort->DebounceState == USBH_PORT_DEBOUNCE_DONE) {
+          pEnumPort = pPort;
 #if USBH_SUPPORT_HUB_CLEAR_TT_BUFFER
-        USBH_MEMSET(pPort->ClearTTQueue, 0, sizeof(pPort->ClearTTQueue));
+          USBH_MEMSET(pPort->ClearTTQueue, 0, sizeof(pPort->ClearTTQueue));
 #endif
+        }
       }
     }
     //
@@ -866,7 +912,8 @@ static void _ProcessPorts(void * p) {
         USBH_LOG((USBH_MCAT_HUB, "_ProcessPorts: port not connected, delete dev., Port:%d Status: 0x%X = %s", pPort->HubPortNumber, pPort->PortStatus, USBH_PortStatus2Str(pPort->PortStatus)));
         USBH_MarkParentAndChildDevicesAsRemoved(pPort->pDevice);
       }
-      pPort->RetryCounter = 0;
+      pPort->RetryCounter  = 0;
+      pPort->DebounceState = USBH_PORT_DEBOUNCE_NONE;
       if ((pPort->PortStatus & PORT_STATUS_ENABLED) != 0u) {
         _HubPrepareClrFeatureReq(pUrb, pHubDevice, HDC_SELECTOR_PORT_ENABLE, pPort->HubPortNumber);
         pHub->PendingAction = USBH_HUB_ACT_DISABLE;
@@ -123,8 +123,80 @@ typedef     unsigned char  USBH_BOOL;
 *
 **********************************************************************
 */
+#if USBH_SUPPORT_LOG != 0 || USBH_SUPPORT_WARN != 0
+  #if USBH_LOG_BINARY
+    //
+    // Binary logging: The number of arguments and which of them are pointers
+    // are determined at compile time, formatting is deferred to USBH_LogBinProcess().
+    // ArgInfo of USBH_LogBin(): Bits 7..0: Number of arguments, bit 8 + n: argument n is a pointer.
+    //
+    #define USBH_LOG_NARGS(...)    USBH_LOG_NARGS_(__VA_ARGS__, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+    #define USBH_LOG_NARGS_(a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, N, ...)  N
+    #define USBH_LOG_BIN_LOG(...)  (USBH_LOG_BIN_CHECK(__VA_ARGS__), USBH_LogBin(0, USBH_LOG_BIN_ARGINFO(__VA_ARGS__), __VA_ARGS__))
+    #define USBH_LOG_BIN_WARN(...) (USBH_LOG_BIN_CHECK(__VA_ARGS__), USBH_LogBin(1, USBH_LOG_BIN_ARGINFO(__VA_ARGS__), __VA_ARGS__))
+    #define USBH_LOG_BIN_ARGINFO(...)                  ((USBH_LOG_NARGS(__VA_ARGS__) - 2u) | \
+                                                        (USBH_LOG_BIN_CAT(USBH_LOG_BIN_PTRS_, USBH_LOG_NARGS(__VA_ARGS__))(__VA_ARGS__) << 8))
+    #define USBH_LOG_BIN_PTRS_2(Type, sFormat)         0u
+    #define USBH_LOG_BIN_PTRS_3(Type, sFormat, a)      USBH_LOG_BIN_IS_PTR(a)
+    #define USBH_LOG_BIN_PTRS_4(Type, sFormat, a, ...)  (USBH_LOG_BIN_IS_PTR(a) | (USBH_LOG_BIN_PTRS_3(Type, sFormat, __VA_ARGS__) << 1))
+    #define USBH_LOG_BIN_PTRS_5(Type, sFormat, a, ...)  (USBH_LOG_BIN_IS_PTR(a) | (USBH_LOG_BIN_PTRS_4(Type, sFormat, __VA_ARGS__) << 1))
+    #define USBH_LOG_BIN_PTRS_6(Type, sFormat, a, ...)  (USBH_LOG_BIN_IS_PTR(a) | (USBH_LOG_BIN_PTRS_5(Type, sFormat, __VA_ARGS__) << 1))
+    #define USBH_LOG_BIN_PTRS_7(Type, sFormat, a, ...)  (USBH_LOG_BIN_IS_PTR(a) | (USBH_LOG_BIN_PTRS_6(Type, sFormat, __VA_ARGS__) << 1))
+    #define USBH_LOG_BIN_PTRS_8(Type, sFormat, a, ...)  (USBH_LOG_BIN_IS_PTR(a) | (USBH_LOG_BIN_PTRS_7(Type, sFormat, __VA_ARGS__) << 1))
+    #define USBH_LOG_BIN_PTRS_9(Type, sFormat, a, ...)  (USBH_LOG_BIN_IS_PTR(a) | (USBH_LOG_BIN_PTRS_8(Type, sFormat, __VA_ARGS__) << 1))
+    #define USBH_LOG_BIN_PTRS_10(Type, sFormat, a, ...) (USBH_LOG_BIN_IS_PTR(a) | (USBH_LOG_BIN_PTRS_9(Type, sFormat, __VA_ARGS__) << 1))
+    #define USBH_LOG_BIN_PTRS_11(Type, sFormat, a, ...) (USBH_LOG_BIN_IS_PTR(a) | (USBH_LOG_BIN_PTRS_10(Type, sFormat, __VA_ARGS__) << 1))
+    #define USBH_LOG_BIN_PTRS_12(Type, sFormat, a, ...) (USBH_LOG_BIN_IS_PTR(a) | (USBH_LOG_BIN_PTRS_11(Type, sFormat, __VA_ARGS__) << 1))
+    #define USBH_LOG_BIN_PTRS_13(...)                  0u
+    #define USBH_LOG_BIN_PTRS_14(...)                  0u
+    //
+    // Only the addresses of the format string and of %s arguments are stored,
+    // the strings are read when the message is rendered. This is checked at compile time:
+    // The format must be a string literal. With GCC and clang, an argument of type 'char *'
+    // is rejected unless it is a string literal: it is a buffer that may change or go out
+    // of scope before the message is rendered. Pointers to constant strings must be
+    // 'const char *'. Pointers are stored with all their bits, other arguments must not
+    // have more than 32 bits. At most 10 arguments are supported. Without GCC or clang
+    // pointers can not be told from integers, they are stored as 32-bit words and
+    // binary logging requires 32-bit pointers.
+    //
+    #define USBH_LOG_BIN_CAT(a, b)                     USBH_LOG_BIN_CAT_(a, b)
+    #define USBH_LOG_BIN_CAT_(a, b)                    a##b
+    #define USBH_LOG_BIN_CHECK(...)                    USBH_LOG_BIN_CAT(USBH_LOG_BIN_CHECK_, USBH_LOG_NARGS(__VA_ARGS__))(__VA_ARGS__)
+    #define USBH_LOG_BIN_CHECK_2(Type, sFormat)        (void)sizeof("" sFormat "")
+    #define USBH_LOG_BIN_CHECK_3(Type, sFormat, a)     USBH_LOG_BIN_CHECK_2(Type, sFormat), USBH_LOG_BIN_CHECK_ARG(a)
+    #define USBH_LOG_BIN_CHECK_4(Type, sFormat, a, ...)  USBH_LOG_BIN_CHECK_3(Type, sFormat, __VA_ARGS__), USBH_LOG_BIN_CHECK_ARG(a)
+    #define USBH_LOG_BIN_CHECK_5(Type, sFormat, a, ...)  USBH_LOG_BIN_CHECK_4(Type, sFormat, __VA_ARGS__), USBH_LOG_BIN_CHECK_ARG(a)
+    #define USBH_LOG_BIN_CHECK_6(Type, sFormat, a, ...)  USBH_LOG_BIN_CHECK_5(Type, sFormat, __VA_ARGS__), USBH_LOG_BIN_CHECK_ARG(a)
+    #define USBH_LOG_BIN_CHECK_7(Type, sFormat, a, ...)  USBH_LOG_BIN_CHECK_6(Type, sFormat, __VA_ARGS__), USBH_LOG_BIN_CHECK_ARG(a)
+    #define USBH_LOG_BIN_CHECK_8(Type, sFormat, a, ...)  USBH_LOG_BIN_CHECK_7(Type, sFormat, __VA_ARGS__), USBH_LOG_BIN_CHECK_ARG(a)
+    #define USBH_LOG_BIN_CHECK_9(Type, sFormat, a, ...)  USBH_LOG_BIN_CHECK_8(Type, sFormat, __VA_ARGS__), USBH_LOG_BIN_CHECK_ARG(a)
+    #define USBH_LOG_BIN_CHECK_10(Type, sFormat, a, ...) USBH_LOG_BIN_CHECK_9(Type, sFormat, __VA_ARGS__), USBH_LOG_BIN_CHECK_ARG(a)
+    #define USBH_LOG_BIN_CHECK_11(Type, sFormat, a, ...) USBH_LOG_BIN_CHECK_10(Type, sFormat, __VA_ARGS__), USBH_LOG_BIN_CHECK_ARG(a)
+    #define USBH_LOG_BIN_CHECK_12(Type, sFormat, a, ...) USBH_LOG_BIN_CHECK_11(Type, sFormat, __VA_ARGS__), USBH_LOG_BIN_CHECK_ARG(a)
+    #define USBH_LOG_BIN_CHECK_13(...)                 USBH_LOG_BIN_ASSERT(0, "USBH_LOG: Too many arguments for binary logging")
+    #define USBH_LOG_BIN_CHECK_14(...)                 USBH_LOG_BIN_ASSERT(0, "USBH_LOG: Too many arguments for binary logging")
+    #if defined(__GNUC__) || defined(__clang__)
+      #define USBH_LOG_BIN_ASSERT(Cond, sMsg)          (void)sizeof(struct { _Static_assert(Cond, sMsg); int Dummy; })
+      #define USBH_LOG_BIN_IS_PTR(a)                   ((unsigned)(__builtin_classify_type(a) == 5))   // pointer_type_class, arrays decay
+      #define USBH_LOG_BIN_CHECK_ARG(a)                USBH_LOG_BIN_ASSERT(_Generic((a), char *: __builtin_constant_p(a), default: 1), \
+                                                         "USBH_LOG: Argument of type 'char *', %s arguments must be string literals or 'const char *'"), \
+                                                       USBH_LOG_BIN_ASSERT(USBH_LOG_BIN_IS_PTR(a) != 0u || sizeof(0 ? (a) : (a)) <= 4u, \
+                                                         "USBH_LOG: Argument with more than 32 bits")
+    #else
+      #define USBH_LOG_BIN_ASSERT(Cond, sMsg)          (void)sizeof(char[(Cond) ? 1 : -1])
+      #define USBH_LOG_BIN_IS_PTR(a)                   0u
+      #define USBH_LOG_BIN_CHECK_ARG(a)                USBH_LOG_BIN_ASSERT(sizeof(0 ? (a) : (a)) <= 4u, "")   // A string literal can not be told from a buffer without compiler support.
+    #endif
+  #endif
+#endif
+
 #if USBH_SUPPORT_LOG
-  #define USBH_LOG(p) USBH_Logf p
+  #if USBH_LOG_BINARY
+    #define USBH_LOG(p) USBH_LOG_BIN_LOG p
+  #else
+    #define USBH_LOG(p) USBH_Logf p
+  #endif
 #else
   #ifdef _lint
     #define USBH_LOG(p)  /*lint -save -e9036 N:102 */do {} while(0) /*lint -restore*/
@@ -134,7 +206,11 @@ typedef     unsigned char  USBH_BOOL;
 #endif
 
 #if USBH_SUPPORT_WARN
-  #define USBH_WARN(p) USBH_Warnf p
+  #if USBH_LOG_BINARY
+    #define USBH_WARN(p) USBH_LOG_BIN_WARN p
+  #else
+    #define USBH_WARN(p) USBH_Warnf p
+  #endif
 #else
   #ifdef _lint
     #define USBH_WARN(p)  /*lint -save -e9036 N:102 */do {} while(0) /*lint -restore*/
@@ -224,22 +300,30 @@ typedef     unsigned char  USBH_BOOL;
 //
 // To avoid deadlocks the mutex hierarchy must be observed:
 // While a task has a lock on a mutex, it must not try to lock another mutex with higher index.
+// Locking the same mutex again is allowed, mutexes are recursive.
+// E.g. a task holding USBH_MUTEX_DEVICE may lock USBH_MUTEX_MEM, but a task holding
+// USBH_MUTEX_MEM must not lock USBH_MUTEX_DEVICE or any class mutex.
+// The OS layers check this rule in debug builds (USBH_DEBUG > 1).
+//
+// Core subsystems and the frequently used class drivers have separate mutexes,
+// so that e.g. a CDC and a HID task do not serialize each other.
+// The timer and memory regions are leaf regions; the device regions may allocate memory.
 //
-#define USBH_MUTEX_TIMER     0      // Timer management
-#define USBH_MUTEX_DEVICE    0      // Device management (DevList, RefCnt)
 #define USBH_MUTEX_MEM       0      // Memory allocation
-#define USBH_MUTEX_CDC       1      // CDC class usage
-#define USBH_MUTEX_BULK      1      // BULK class usage
-#define USBH_MUTEX_HID       1      // HID class usage
-#define USBH_MUTEX_FT232     1      // FT232 class usage
-#define USBH_MUTEX_MTP       1      // MTP class usage
-#define USBH_MUTEX_PRINTER   1      // Printer class usage
-#define USBH_MUTEX_RNDIS     1      // RNDIS class usage
-#define USBH_MUTEX_AUDIO     1      // AUDIO class usage
-#define USBH_MUTEX_VIDEO     1      // VIDEO class usage
-#define USBH_MUTEX_DRIVER    2      // Driver mutex
-#define USBH_MUTEX_MSD       3      // MSD class usage
-#define USBH_MUTEX_NET       3      // NET class usage
+#define USBH_MUTEX_TIMER     1      // Timer management
+#define USBH_MUTEX_DEVICE    2      // Device management (DevList, RefCnt)
+#define USBH_MUTEX_CDC       3      // CDC class usage
+#define USBH_MUTEX_BULK      4      // BULK class usage
+#define USBH_MUTEX_HID       5      // HID class usage
+#define USBH_MUTEX_FT232     6      // FT232 class usage
+#define USBH_MUTEX_MTP       7      // MTP class usage
+#define USBH_MUTEX_PRINTER   7      // Printer class usage
+#define USBH_MUTEX_RNDIS     7      // RNDIS class usage
+#define USBH_MUTEX_AUDIO     7      // AUDIO class usage
+#define USBH_MUTEX_VIDEO     7      // VIDEO class usage
+#define USBH_MUTEX_DRIVER    8      // Driver mutex
+#define USBH_MUTEX_MSD       9      // MSD class usage
+#define USBH_MUTEX_NET       9      // NET class usage
 
 /*********************************************************************
 *
@@ -656,7 +740,9 @@ typedef struct {
   USBH_TIMER_FUNC    * pfHandler;
   void               * pContext;
   USBH_TIME            TimeOfExpiration;
+  U32                  ExpirationTick;    // Expiration time in ticks of the timing wheel.
   I8                   IsActive;
+  U8                   WheelIndex;        // Index of the timing wheel slot the timer is stored in.
 } USBH_TIMER;
 
 typedef USBH_TIMER * USBH_TIMER_HANDLE;                                                           // Handle to a OS timer object
@@ -792,6 +878,15 @@ void            USBH_ROOTHUB_ServicePorts     (ROOT_HUB * pRootHub);
 #define USBH_PORT_DO_SUSPEND          (1u << 6)
 #define USBH_PORT_DO_RESUME           (1u << 7)
 
+//
+// Debounce state of a hub port with a new connection.
+// Debouncing is done per port before the port competes for the port reset,
+// so the waits of multiple ports overlap.
+//
+#define USBH_PORT_DEBOUNCE_NONE         0u
+#define USBH_PORT_DEBOUNCE_WAIT         1u
+#define USBH_PORT_DEBOUNCE_DONE         2u
+
 struct _USBH_HUB_PORT {
 #if USBH_DEBUG > 1
   U32                  Magic;
@@ -806,6 +901,9 @@ struct _USBH_HUB_PORT {
   U8                   HubPortNumber;      // The one based index of the hub port
   USB_DEVICE         * pDevice;            // Device connected to this port, for tree operation
   unsigned int         RetryCounter;       // Counts the number of retries
+  U8                   DebounceState;      // USBH_PORT_DEBOUNCE_... (external hubs only)
+  USBH_TIME            DebounceUntil;      // End of debounce / power good wait of a new connection.
+  USBH_TIME            ConnectTime;        // Time the connection was detected, base for the time to ready of the device.
 #if USBH_SUPPORT_HUB_CLEAR_TT_BUFFER
   U16                  ClearTTQueue[4];    // Queued 'Clear TT Buffer' commands
 #endif
@@ -959,6 +1057,7 @@ typedef enum {
   DEV_ENUM_GET_CONFIG_DESC,      // Get the complete configuration descriptor
   DEV_ENUM_GET_LANG_ID,          // Get the language ID's
   DEV_ENUM_GET_SERIAL_DESC,      // Get the serial number
+  DEV_ENUM_CHECK_CACHED_DESC,    // Compare the configuration descriptor header with the cached descriptors
   DEV_ENUM_PREP_SET_CONFIG,      // Prepare 'Set configuration'
   DEV_ENUM_SET_CONFIGURATION,    // Set the configuration
   DEV_ENUM_CONFIGURE_EPS,        // Configure EPs (some drivers only)
@@ -1012,6 +1111,9 @@ struct _USB_DEVICE {
   URB_SUB_STATE                SubState;
   USBH_URB                     EnumUrb;                 // Embedded URB
   USBH_DEVICE_ID               DeviceId;                // Device ID for this device
+  USBH_TIME                    EnumStartTime;           // Time the connection of the device was detected.
+  U32                          EnumTime;                // Time from connection to end of enumeration in ms.
+  U8                           DescFromCache;           // Configuration descriptors were taken from the descriptor cache.
 };
 
 /*********************************************************************
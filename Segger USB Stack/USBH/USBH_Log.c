@@ -50,6 +50,64 @@ Purpose     : USB host stack log routines
 #include "USBH_Int.h"
 #include "USBH_Util.h"
 
+/*********************************************************************
+*
+*       Defines, fixed
+*
+**********************************************************************
+*/
+#if USBH_LOG_BINARY
+//
+// Record layout in the ring buffer (32-bit words):
+//   [0] Header: Bits 31..24: Number of words of the record (including header)
+//               Bit  23:     Warning
+//               Bits 22..16: Message category
+//               Bits 15..0:  LOG_BIN_MAGIC
+//   [1] Timestamp (USBH_OS_GetTime32())
+//   [2] Pointer mask: Bit n set if argument n is a pointer
+//   [3] Address of the format string, low word first if addresses have 64 bits (host builds)
+//   [..] Arguments: A pointer takes as many words as the format string address, low word first,
+//        any other argument one word
+// A header word of 0 marks a record that is not yet committed by the writer.
+//
+#define LOG_BIN_MAX_ARGS      10u
+#define LOG_BIN_NUM_WORDS     (USBH_LOG_BIN_BUFFER_SIZE / 4u)
+#define LOG_BIN_MASK          (LOG_BIN_NUM_WORDS - 1u)
+#define LOG_BIN_MAGIC         0x4C42u
+#define LOG_BIN_FMT_WORDS     (sizeof(PTR_ADDR) / 4u)
+#define LOG_BIN_HEADER_WORDS  (3u + LOG_BIN_FMT_WORDS)
+#define LOG_BIN_MAX_WORDS     (LOG_BIN_HEADER_WORDS + LOG_BIN_MAX_ARGS * LOG_BIN_FMT_WORDS)
+
+#if !defined(__GNUC__) && !defined(__clang__)
+  //
+  // Without compiler support pointer arguments can not be told from integers at compile time,
+  // they are stored as 32-bit words. See USBH_LOG_BIN_IS_PTR().
+  //
+  typedef char LOG_BIN_CHECK_PTR_SIZE[(sizeof(void *) == 4u) ? 1 : -1];
+#endif
+
+#if (LOG_BIN_NUM_WORDS & LOG_BIN_MASK) != 0
+  #error "USBH_LOG_BIN_BUFFER_SIZE must be a power of 2"
+#endif
+
+//
+// Lock-free reservation of ring buffer space. Writers may run in any task or interrupt.
+// Without compiler support for atomics, reservation falls back to a short critical section.
+//
+#if defined(__GNUC__) || defined(__clang__)
+  #define LOG_BIN_LOAD(p)               __atomic_load_n((p), __ATOMIC_ACQUIRE)
+  #define LOG_BIN_STORE(p, v)           __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+  #define LOG_BIN_CAS(p, pExpected, v)  __atomic_compare_exchange_n((p), (pExpected), (v), 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)
+  #define LOG_BIN_INC(p)                (void)__atomic_fetch_add((p), 1u, __ATOMIC_RELAXED)
+  #define LOG_BIN_ADD(p, v)             (void)__atomic_fetch_add((p), (v), __ATOMIC_RELAXED)
+#else
+  #define LOG_BIN_LOAD(p)               (*(volatile U32 *)(p))
+  #define LOG_BIN_STORE(p, v)           (*(volatile U32 *)(p) = (v))
+  #define LOG_BIN_INC(p)                USBH_OS_DisableInterrupt(); (*(p))++; USBH_OS_EnableInterrupt()
+  #define LOG_BIN_ADD(p, v)             USBH_OS_DisableInterrupt(); (*(p)) += (v); USBH_OS_EnableInterrupt()
+#endif
+#endif
+
 /*********************************************************************
 *
 *       Static const
@@ -141,6 +199,29 @@ static U32 _MsgFilter[2][(USBH_MCAT_MAX + 31u) / 32u] = {
   { 0xFFFFFFFFu, 0xFFFFFFFFu }                                        // Default warning messages (all)
 };
 
+#if USBH_LOG_BINARY
+typedef struct {
+  U32 WindowStart;            // Start of the current one second window.
+  U16 Count;                  // Messages in the current window.
+  U16 MaxPerSec;              // 0 = unlimited.
+  U32 NumDropped;
+} LOG_BIN_RATE;
+
+static struct {
+  U32          aBuffer[LOG_BIN_NUM_WORDS];
+  U32          WrPos;                      // Free running word counters.
+  U32          RdPos;
+  U32          NumRecords;
+  U32          NumDroppedOverflow;
+  U32          NumDroppedReported;         // Drops already reported by USBH_LogBinProcess().
+#ifdef USBH_LOG_BIN_GET_CYCLES
+  U32          NumCyclesTotal;             // Cycles spent in USBH_LogBin() for stored messages.
+  U32          NumCyclesMax;
+#endif
+  LOG_BIN_RATE aRate[USBH_MCAT_MAX];
+} _LogBin;
+#endif
+
 /*********************************************************************
 *
 *       Static code
@@ -185,6 +266,213 @@ static void _LogV(int Warn, U32 Type, const char *sFormat, va_list ParamList) {
   }
 }
 
+#if USBH_LOG_BINARY
+/*********************************************************************
+*
+*       _LogBinReserve
+*
+*  Function description
+*    Reserves space for a record in the binary log ring buffer.
+*
+*  Return value
+*    == 0: Space reserved, *pPos contains the position of the record.
+*    != 0: Buffer full.
+*/
+static int _LogBinReserve(U32 NumWords, U32 * pPos) {
+  U32 WrPos;
+  U32 RdPos;
+
+#if defined(__GNUC__) || defined(__clang__)
+  WrPos = LOG_BIN_LOAD(&_LogBin.WrPos);
+  do {
+    RdPos = LOG_BIN_LOAD(&_LogBin.RdPos);
+    if (WrPos - RdPos + NumWords > LOG_BIN_NUM_WORDS) {
+      return 1;
+    }
+  } while (LOG_BIN_CAS(&_LogBin.WrPos, &WrPos, WrPos + NumWords) == 0);
+#else
+  USBH_OS_DisableInterrupt();
+  WrPos = _LogBin.WrPos;
+  RdPos = _LogBin.RdPos;
+  if (WrPos - RdPos + NumWords > LOG_BIN_NUM_WORDS) {
+    USBH_OS_EnableInterrupt();
+    return 1;
+  }
+  _LogBin.WrPos = WrPos + NumWords;
+  USBH_OS_EnableInterrupt();
+#endif
+  *pPos = WrPos;
+  return 0;
+}
+
+/*********************************************************************
+*
+*       _LogBinTake
+*
+*  Function description
+*    Removes the oldest committed record from the ring buffer.
+*    Must only be called by a single reader at a time.
+*
+*  Parameters
+*    pRecord : [OUT] Receives the record, must hold LOG_BIN_MAX_WORDS words.
+*
+*  Return value
+*    Number of words of the record, 0 if no committed record is available.
+*/
+static unsigned _LogBinTake(U32 * pRecord) {
+  U32      RdPos;
+  U32      Header;
+  unsigned NumWords;
+  unsigned i;
+
+  RdPos = _LogBin.RdPos;
+  if (RdPos == LOG_BIN_LOAD(&_LogBin.WrPos)) {
+    return 0;
+  }
+  Header = LOG_BIN_LOAD(&_LogBin.aBuffer[RdPos & LOG_BIN_MASK]);
+  if (Header == 0u) {
+    return 0;                 // Record reserved, but not yet committed by the writer.
+  }
+  NumWords = Header >> 24;
+  for (i = 0; i < NumWords; i++) {
+    pRecord[i] = _LogBin.aBuffer[(RdPos + i) & LOG_BIN_MASK];
+    _LogBin.aBuffer[(RdPos + i) & LOG_BIN_MASK] = 0;     // Writers rely on a zero header word in free space.
+  }
+  LOG_BIN_STORE(&_LogBin.RdPos, RdPos + NumWords);
+  return NumWords;
+}
+
+/*********************************************************************
+*
+*       _LogBinGetAddr
+*
+*  Function description
+*    Returns an address stored in LOG_BIN_FMT_WORDS words, low word first.
+*/
+static PTR_ADDR _LogBinGetAddr(const U32 * pWords) {
+  PTR_ADDR Addr;
+  unsigned i;
+
+  Addr = 0;
+  for (i = LOG_BIN_FMT_WORDS; i > 0u; i--) {
+    Addr = ((Addr << 16) << 16) | pWords[i - 1u];
+  }
+  return Addr;
+}
+
+/*********************************************************************
+*
+*       _LogBinIsFlag
+*
+*  Function description
+*    Checks if a character of a conversion specification comes before the conversion.
+*/
+static int _LogBinIsFlag(char c) {
+  if (c >= '0' && c <= '9') {
+    return 1;
+  }
+  return (c == '-' || c == '+' || c == ' ' || c == '#' || c == '.' || c == 'l' || c == 'h') ? 1 : 0;
+}
+
+/*********************************************************************
+*
+*       _LogBinFormat
+*
+*  Function description
+*    Renders the message of a record. Each conversion is formatted by
+*    SEGGER_snprintf() on its own, with its argument passed with the type
+*    it was logged with.
+*
+*  Parameters
+*    pBuffer    : [OUT] Message, always terminated.
+*    BufferSize : Size of pBuffer in bytes.
+*    sFormat    : Format string of the record.
+*    pArgs      : Argument words of the record.
+*    NumWords   : Number of argument words.
+*    PtrMask    : Bit n set if argument n is a pointer.
+*
+*  Additional information
+*    Missing arguments are rendered as 0. A width or precision of '*' is not
+*    supported with binary logging, such a conversion is copied as it is.
+*/
+static void _LogBinFormat(char * pBuffer, unsigned BufferSize, const char * sFormat, const U32 * pArgs, unsigned NumWords, U32 PtrMask) {
+  char           acSpec[16];
+  const char   * sArg;
+  U32            v;
+  unsigned       Pos;
+  unsigned       SpecLen;
+  unsigned       ArgIdx;
+  unsigned       WordIdx;
+  int            IsPtr;
+  char           c;
+
+  Pos     = 0;
+  ArgIdx  = 0;
+  WordIdx = 0;
+  while (*sFormat != '\0' && Pos + 1u < BufferSize) {
+    c = *sFormat++;
+    if (c != '%') {
+      pBuffer[Pos++] = c;
+      continue;
+    }
+    //
+    // Copy the conversion specification: flags, width, precision, qualifiers and conversion.
+    //
+    acSpec[0] = '%';
+    SpecLen   = 1;
+    do {
+      c = *sFormat;
+      if (c == '\0' || c == '*' || SpecLen >= sizeof(acSpec) - 1u) {
+        break;
+      }
+      acSpec[SpecLen++] = c;
+      sFormat++;
+    } while (_LogBinIsFlag(c) != 0);
+    acSpec[SpecLen] = '\0';
+    if (c == '%') {
+      pBuffer[Pos++] = '%';
+      continue;
+    }
+    if (_LogBinIsFlag(c) != 0 || c == '\0' || c == '*') {
+      (void)SEGGER_snprintf(&pBuffer[Pos], (int)(BufferSize - Pos), "%s", acSpec);
+      Pos += USBH_STRLEN(&pBuffer[Pos]);
+      continue;
+    }
+    //
+    // Take the argument.
+    //
+    IsPtr = (ArgIdx < 32u && (PtrMask & (1uL << ArgIdx)) != 0u) ? 1 : 0;
+    ArgIdx++;
+    sArg  = NULL;
+    v     = 0;
+    if (IsPtr != 0 && WordIdx + LOG_BIN_FMT_WORDS <= NumWords) {
+      sArg     = SEGGER_ADDR2PTR(const char, _LogBinGetAddr(&pArgs[WordIdx]));
+      v        = (U32)SEGGER_PTR2ADDR(sArg);
+      WordIdx += LOG_BIN_FMT_WORDS;
+    } else if (IsPtr == 0 && WordIdx < NumWords) {
+      v = pArgs[WordIdx++];
+      if (LOG_BIN_FMT_WORDS == 1u) {
+        sArg = SEGGER_ADDR2PTR(const char, v);          // Pointers are not tagged without compiler support.
+      }
+    } else {
+      //
+      // Argument missing.
+      //
+    }
+    if (c == 's' || c == 'p') {
+      if (sArg == NULL && c == 's') {
+        sArg = (IsPtr != 0 || LOG_BIN_FMT_WORDS == 1u) ? "(null)" : "(?)";     // "(?)": Logged as a number.
+      }
+      (void)SEGGER_snprintf(&pBuffer[Pos], (int)(BufferSize - Pos), acSpec, sArg);
+    } else {
+      (void)SEGGER_snprintf(&pBuffer[Pos], (int)(BufferSize - Pos), acSpec, v);
+    }
+    Pos += USBH_STRLEN(&pBuffer[Pos]);
+  }
+  pBuffer[Pos] = '\0';
+}
+#endif
+
 /*********************************************************************
 *
 *       _MapMsgFilter
@@ -413,6 +701,310 @@ void USBH_Logf(U32 Type, const char * sFormat, ...) {
   va_end(ParamList);
 }
 
+/*********************************************************************
+*
+*       USBH_LogBin
+*
+*  Function description
+*    Stores a log or warning message into the binary log ring buffer
+*    without formatting it. Used by USBH_LOG() / USBH_WARN() if USBH_LOG_BINARY == 1.
+*
+*  Parameters
+*    Warn     : 0: Log message, 1: Warning message.
+*    ArgInfo  : Bits 7..0: Number of arguments following sFormat, bit 8 + n: argument n
+*               is a pointer (both determined at compile time).
+*    Type     : Message category.
+*    sFormat  : Message string with optional format specifiers. Must be a constant string,
+*               it is referenced when the message is rendered.
+*
+*  Additional information
+*    Pointer arguments are read and stored as pointers, with all their bits, all other
+*    arguments as 32-bit values. Arguments for %s must point to constant strings.
+*    The function does not lock, it may be called from any task or interrupt.
+*    If the buffer is full or the rate limit of the category is exceeded, the message
+*    is dropped and counted.
+*/
+void USBH_LogBin(int Warn, unsigned ArgInfo, U32 Type, const char * sFormat, ...) {
+#if USBH_LOG_BINARY
+  //lint --e{530,586) dealing with 'va_start' and 'ParamList'  N:102
+  va_list        ParamList;
+  LOG_BIN_RATE * pRate;
+  U32          * pBuffer;
+  PTR_ADDR       Addr;
+  U32            Pos;
+  U32            Now;
+  U32            NumWords;
+  U32            PtrMask;
+  unsigned       NumArgs;
+  unsigned       i;
+  unsigned       j;
+#ifdef USBH_LOG_BIN_GET_CYCLES
+  U32            Cycles;
+
+  Cycles = USBH_LOG_BIN_GET_CYCLES();
+#endif
+  if (Type >= USBH_MCAT_MAX || (_MsgFilter[Warn][Type / 32u] & (1uL << (Type % 32u))) == 0u) {
+    return;
+  }
+  Now   = USBH_OS_GetTime32();
+  pRate = &_LogBin.aRate[Type];
+  if (pRate->MaxPerSec != 0u) {
+    //
+    // Rate limit is approximate if the same category is logged concurrently.
+    //
+    if ((U32)(Now - pRate->WindowStart) >= 1000u) {
+      pRate->WindowStart = Now;
+      pRate->Count       = 0;
+    }
+    if (pRate->Count >= pRate->MaxPerSec) {
+      LOG_BIN_INC(&pRate->NumDropped);
+      return;
+    }
+    pRate->Count++;
+  }
+  NumArgs = ArgInfo & 0xFFu;
+  if (NumArgs > LOG_BIN_MAX_ARGS) {
+    NumArgs = LOG_BIN_MAX_ARGS;
+  }
+  PtrMask  = (ArgInfo >> 8) & ((1uL << NumArgs) - 1u);
+  NumWords = LOG_BIN_HEADER_WORDS + NumArgs;
+  if (LOG_BIN_FMT_WORDS > 1u) {
+    for (i = 0; i < NumArgs; i++) {
+      if ((PtrMask & (1uL << i)) != 0u) {
+        NumWords += LOG_BIN_FMT_WORDS - 1u;
+      }
+    }
+  }
+  if (_LogBinReserve(NumWords, &Pos) != 0) {
+    LOG_BIN_INC(&_LogBin.NumDroppedOverflow);
+    return;
+  }
+  pBuffer = _LogBin.aBuffer;
+  Addr    = SEGGER_PTR2ADDR(sFormat);
+  pBuffer[(Pos + 1u) & LOG_BIN_MASK] = Now;
+  pBuffer[(Pos + 2u) & LOG_BIN_MASK] = PtrMask;
+  for (i = 0; i < LOG_BIN_FMT_WORDS; i++) {
+    pBuffer[(Pos + 3u + i) & LOG_BIN_MASK] = (U32)Addr;
+    Addr = (Addr >> 16) >> 16;
+  }
+  va_start(ParamList, sFormat);
+  Pos += LOG_BIN_HEADER_WORDS;
+  for (i = 0; i < NumArgs; i++) {
+    if ((PtrMask & (1uL << i)) != 0u) {
+      Addr = SEGGER_PTR2ADDR(va_arg(ParamList, const void *));
+      for (j = 0; j < LOG_BIN_FMT_WORDS; j++) {
+        pBuffer[Pos++ & LOG_BIN_MASK] = (U32)Addr;
+        Addr = (Addr >> 16) >> 16;
+      }
+    } else {
+      pBuffer[Pos++ & LOG_BIN_MASK] = va_arg(ParamList, U32);
+    }
+  }
+  va_end(ParamList);
+  Pos -= NumWords;
+  //
+  // Commit: Header is written last.
+  //
+  LOG_BIN_STORE(&pBuffer[Pos & LOG_BIN_MASK], (NumWords << 24) | ((U32)Warn << 23) | (Type << 16) | LOG_BIN_MAGIC);
+  LOG_BIN_INC(&_LogBin.NumRecords);
+#ifdef USBH_LOG_BIN_GET_CYCLES
+  Cycles = USBH_LOG_BIN_GET_CYCLES() - Cycles;
+  LOG_BIN_ADD(&_LogBin.NumCyclesTotal, Cycles);
+  if (Cycles > _LogBin.NumCyclesMax) {
+    _LogBin.NumCyclesMax = Cycles;                    // Not atomic, a concurrent maximum may be lost.
+  }
+#endif
+#else
+  USBH_USE_PARA(Warn);
+  USBH_USE_PARA(ArgInfo);
+  USBH_USE_PARA(Type);
+  USBH_USE_PARA(sFormat);
+#endif
+}
+
+/*********************************************************************
+*
+*       USBH_LogBinProcess
+*
+*  Function description
+*    Renders messages stored in the binary log ring buffer and outputs
+*    them via USBH_Log() / USBH_Warn().
+*
+*  Parameters
+*    MaxRecords : Maximum number of messages to render, 0 for all pending messages.
+*
+*  Return value
+*    Number of messages rendered.
+*
+*  Additional information
+*    Should be called periodically from a low priority task.
+*    Must not be called concurrently with USBH_LogBinRead().
+*    Dropped messages are reported as a warning.
+*/
+unsigned USBH_LogBinProcess(unsigned MaxRecords) {
+#if USBH_LOG_BINARY
+  const struct MCAT_STRINGS_t *pStrings;
+  U32      aRecord[LOG_BIN_MAX_WORDS];
+  PTR_ADDR Addr;
+  U32      NumDropped;
+  U32      Type;
+  unsigned NumWords;
+  unsigned NumRendered;
+  unsigned Len;
+  unsigned i;
+  char     ac[USBH_LOG_BUFFER_SIZE];
+
+  NumRendered = 0;
+  for (;;) {
+    if (MaxRecords != 0u && NumRendered >= MaxRecords) {
+      break;
+    }
+    NumWords = _LogBinTake(aRecord);
+    if (NumWords == 0u) {
+      break;
+    }
+    Type     = (aRecord[0] >> 16) & 0x7Fu;
+    pStrings = _aMCat2String;
+    while (Type < pStrings->From || Type > pStrings->To) {
+      pStrings++;
+    }
+    Len = USBH_STRLEN(pStrings->Text);
+    USBH_MEMCPY(ac, pStrings->Text, Len);
+    ac[Len] = ':';
+    ac[Len + 1u] = ' ';
+    Addr = _LogBinGetAddr(&aRecord[3]);
+    _LogBinFormat(&ac[Len + 2u], sizeof(ac) - Len - 2u, SEGGER_ADDR2PTR(const char, Addr),
+                  &aRecord[LOG_BIN_HEADER_WORDS], NumWords - LOG_BIN_HEADER_WORDS, aRecord[2]);
+    if ((aRecord[0] & (1uL << 23)) != 0u) {
+      USBH_Warn(ac);
+    } else {
+      USBH_Log(ac);
+    }
+    NumRendered++;
+  }
+  NumDropped = _LogBin.NumDroppedOverflow;
+  for (i = 0; i < SEGGER_COUNTOF(_LogBin.aRate); i++) {
+    NumDropped += _LogBin.aRate[i].NumDropped;
+  }
+  if (NumDropped != _LogBin.NumDroppedReported) {
+    (void)SEGGER_snprintf(ac, (int)sizeof(ac), "LOG: %u messages dropped", NumDropped - _LogBin.NumDroppedReported);
+    _LogBin.NumDroppedReported = NumDropped;
+    USBH_Warn(ac);
+  }
+  return NumRendered;
+#else
+  USBH_USE_PARA(MaxRecords);
+  return 0;
+#endif
+}
+
+/*********************************************************************
+*
+*       USBH_LogBinRead
+*
+*  Function description
+*    Removes raw records from the binary log ring buffer, e.g. to send them
+*    to a host tool that renders the messages.
+*
+*  Parameters
+*    pBuffer  : Pointer to a buffer that receives the records.
+*    NumWords : Size of the buffer in 32-bit words.
+*
+*  Return value
+*    Number of words stored into pBuffer. Only complete records are returned.
+*
+*  Additional information
+*    Record layout: Header word (bits 31..24: number of words including header,
+*    bit 23: warning, bits 22..16: category, bits 15..0: 0x4C42), timestamp in ms,
+*    pointer mask (bit n set: argument n is a pointer), address of the format string
+*    (to be resolved from the ELF file by the host; two words, low word first, where
+*    addresses have 64 bits), followed by the arguments: pointers in as many words as
+*    the format string address, all others in one 32-bit word.
+*    Must not be called concurrently with USBH_LogBinProcess().
+*/
+unsigned USBH_LogBinRead(U32 * pBuffer, unsigned NumWords) {
+#if USBH_LOG_BINARY
+  U32      Header;
+  unsigned NumWordsRead;
+  unsigned NumWordsRecord;
+
+  NumWordsRead = 0;
+  for (;;) {
+    if (_LogBin.RdPos == LOG_BIN_LOAD(&_LogBin.WrPos)) {
+      break;
+    }
+    Header = LOG_BIN_LOAD(&_LogBin.aBuffer[_LogBin.RdPos & LOG_BIN_MASK]);
+    NumWordsRecord = Header >> 24;
+    if (Header == 0u || NumWordsRead + NumWordsRecord > NumWords) {
+      break;
+    }
+    (void)_LogBinTake(pBuffer + NumWordsRead);
+    NumWordsRead += NumWordsRecord;
+  }
+  return NumWordsRead;
+#else
+  USBH_USE_PARA(pBuffer);
+  USBH_USE_PARA(NumWords);
+  return 0;
+#endif
+}
+
+/*********************************************************************
+*
+*       USBH_LogBinGetStat
+*
+*  Function description
+*    Returns statistics of the binary log transport.
+*
+*  Parameters
+*    pStat : [OUT] Pointer to a structure that receives the statistics.
+*/
+void USBH_LogBinGetStat(USBH_LOG_BIN_STAT * pStat) {
+  USBH_MEMSET(pStat, 0, sizeof(*pStat));
+#if USBH_LOG_BINARY
+  {
+    unsigned i;
+
+    pStat->NumRecords         = _LogBin.NumRecords;
+    pStat->NumDroppedOverflow = _LogBin.NumDroppedOverflow;
+#ifdef USBH_LOG_BIN_GET_CYCLES
+    pStat->NumCyclesTotal     = _LogBin.NumCyclesTotal;
+    pStat->NumCyclesMax       = _LogBin.NumCyclesMax;
+#endif
+    for (i = 0; i < SEGGER_COUNTOF(_LogBin.aRate); i++) {
+      pStat->NumDroppedRateLimit += _LogBin.aRate[i].NumDropped;
+    }
+  }
+#endif
+}
+
+/*********************************************************************
+*
+*       USBH_ConfigMsgRateLimit
+*
+*  Function description
+*    Limits the number of binary log messages per second for a message category.
+*
+*  Parameters
+*    Category     : Message category (USBH_MCAT_...).
+*    MaxMsgPerSec : Maximum number of messages per second, 0 = unlimited.
+*
+*  Additional information
+*    Only effective with USBH_LOG_BINARY == 1. Messages exceeding the limit are
+*    dropped and counted, see USBH_LogBinGetStat().
+*/
+void USBH_ConfigMsgRateLimit(unsigned Category, unsigned MaxMsgPerSec) {
+#if USBH_LOG_BINARY
+  if (Category < USBH_MCAT_MAX) {
+    _LogBin.aRate[Category].MaxPerSec = (U16)SEGGER_MIN(MaxMsgPerSec, 0xFFFFu);
+    _LogBin.aRate[Category].Count     = 0;
+  }
+#else
+  USBH_USE_PARA(Category);
+  USBH_USE_PARA(MaxMsgPerSec);
+#endif
+}
+
 /*********************************************************************
 *
 *       USBH_Logf_Application
@@ -69,6 +69,12 @@ Purpose     : USB host, memory management
 */
 static USBH_MEM_POOL _aMemPool[2];
 
+static struct {
+  U32                 NumBytesExtra;
+  I8                  NoFallback;
+  USBH_INST_POOL_STAT Stat;
+} _InstPool;
+
 /*********************************************************************
 *
 *       Static code
@@ -875,4 +881,215 @@ void USBH_MEM_ScheduleReo(void) {
 #endif
 }
 
+/*********************************************************************
+*
+*       USBH_INST_POOL_Create
+*
+*  Function description
+*    Reserves the buffer pool of a class driver instance.
+*
+*  Parameters
+*    pPool    : Pointer to the pool, must be zeroed.
+*    NumBytes : Number of bytes needed by the instance. Each buffer must be accounted
+*               with USBH_INST_POOL_BLOCK_SIZE(). The extra number of bytes configured by
+*               USBH_ConfigInstPool() is added.
+*
+*  Return value
+*    == 0: Success.
+*    != 0: Out of memory.
+*
+*  Additional information
+*    Called once when the device is started. All buffers of the instance are
+*    taken from this pool by USBH_INST_POOL_Alloc(), so transfers never need the
+*    global allocator and do not fragment the heap.
+*/
+int USBH_INST_POOL_Create(USBH_INST_POOL * pPool, U32 NumBytes) {
+  NumBytes += USBH_INST_POOL_BLOCK_SIZE(_InstPool.NumBytesExtra);
+  if (NumBytes == 0u) {
+    return 0;
+  }
+  pPool->pBase = (U8 *)USBH_MEM_POOL_Alloc(&_aMemPool[0], NumBytes, USBH_INST_POOL_ALIGNMENT);
+  if (pPool->pBase == NULL) {
+    USBH_WARN((USBH_MCAT_MEM, "USBH_INST_POOL_Create: Could not reserve %u bytes", NumBytes));
+    return 1;
+  }
+  pPool->Size       = NumBytes;
+  pPool->Used       = 0;
+  pPool->PeakUsed   = 0;
+  pPool->LastOff    = 0;
+  pPool->NumBuffers = 0;
+  USBH_OS_Lock(USBH_MUTEX_MEM);
+  _InstPool.Stat.NumPools++;
+  _InstPool.Stat.NumBytesReserved += NumBytes;
+  USBH_OS_Unlock(USBH_MUTEX_MEM);
+  return 0;
+}
+
+/*********************************************************************
+*
+*       USBH_INST_POOL_Alloc
+*
+*  Function description
+*    Allocates a buffer from the pool of a class driver instance.
+*
+*  Parameters
+*    pPool    : Pointer to the pool.
+*    NumBytes : Size of the buffer.
+*
+*  Return value
+*    Pointer to the buffer, aligned to USBH_INST_POOL_ALIGNMENT, or NULL.
+*
+*  Additional information
+*    If the pool is exhausted, the buffer is allocated from the heap unless
+*    this was disabled by USBH_ConfigInstPool().
+*    Must be serialized by the caller for the same pool.
+*/
+void * USBH_INST_POOL_Alloc(USBH_INST_POOL * pPool, U32 NumBytes) {
+  void * p;
+  U32    NumBytesBlock;
+
+  NumBytesBlock = USBH_INST_POOL_BLOCK_SIZE(NumBytes);
+  if (pPool->pBase != NULL && pPool->Size - pPool->Used >= NumBytesBlock) {
+    p              = pPool->pBase + pPool->Used;
+    pPool->LastOff = pPool->Used;
+    pPool->Used   += NumBytesBlock;
+    pPool->NumBuffers++;
+    if (pPool->Used > pPool->PeakUsed) {
+      pPool->PeakUsed = pPool->Used;
+      USBH_OS_Lock(USBH_MUTEX_MEM);
+      if (pPool->PeakUsed > _InstPool.Stat.PeakUsed) {
+        _InstPool.Stat.PeakUsed = pPool->PeakUsed;
+      }
+      if (pPool->PeakUsed * 100u / pPool->Size > _InstPool.Stat.PeakUsedPercent) {
+        _InstPool.Stat.PeakUsedPercent = pPool->PeakUsed * 100u / pPool->Size;
+      }
+      USBH_OS_Unlock(USBH_MUTEX_MEM);
+    }
+    return p;
+  }
+  p = NULL;
+  if (_InstPool.NoFallback == 0) {
+    p = USBH_MEM_POOL_Alloc(&_aMemPool[0], NumBytesBlock, USBH_INST_POOL_ALIGNMENT);
+  }
+  USBH_OS_Lock(USBH_MUTEX_MEM);
+  if (p != NULL) {
+    _InstPool.Stat.NumFallbacks++;
+  } else {
+    _InstPool.Stat.NumFailed++;
+  }
+  USBH_OS_Unlock(USBH_MUTEX_MEM);
+  USBH_WARN((USBH_MCAT_MEM, "USBH_INST_POOL_Alloc: Pool exhausted (%u of %u bytes used, %u requested)", pPool->Used, pPool->Size, NumBytes));
+  return p;
+}
+
+/*********************************************************************
+*
+*       USBH_INST_POOL_Free
+*
+*  Function description
+*    Gives back a buffer allocated by USBH_INST_POOL_Alloc().
+*
+*  Parameters
+*    pPool    : Pointer to the pool.
+*    p        : Pointer to the buffer.
+*
+*  Additional information
+*    Buffers can be given back in any order. The space of the most recently
+*    allocated buffer is reused immediately, the complete pool is reused as soon
+*    as all its buffers are given back. So a class driver that releases and
+*    re-allocates all buffers of an instance (e.g. on a change of the alternate
+*    setting) does not lose pool space, whatever the order of the calls.
+*    Buffers taken from the heap are freed immediately.
+*/
+void USBH_INST_POOL_Free(USBH_INST_POOL * pPool, void * p) {
+  U8 * pMem;
+
+  pMem = (U8 *)p;                                                                               //lint !e9079  D:100[d]
+  if (pPool->pBase != NULL && SEGGER_PTR2ADDR(pMem) >= SEGGER_PTR2ADDR(pPool->pBase) &&        // lint D:103[c]
+                              SEGGER_PTR2ADDR(pMem) < SEGGER_PTR2ADDR(pPool->pBase + pPool->Size)) {   // lint D:103[c]
+    USBH_ASSERT(pPool->NumBuffers != 0u);
+    pPool->NumBuffers--;
+    if (pPool->NumBuffers == 0u) {
+      pPool->Used    = 0;
+      pPool->LastOff = 0;
+    } else {
+      if (pMem == pPool->pBase + pPool->LastOff) {
+        pPool->Used = pPool->LastOff;
+      }
+    }
+    return;
+  }
+  USBH_FREE(p);
+}
+
+/*********************************************************************
+*
+*       USBH_INST_POOL_Destroy
+*
+*  Function description
+*    Releases the buffer pool of a class driver instance.
+*
+*  Parameters
+*    pPool    : Pointer to the pool.
+*
+*  Additional information
+*    Called by the class drivers when the device is removed.
+*    All buffers allocated from the pool become invalid. The pool structure
+*    is reset, so it can be created again when the next device is started.
+*/
+void USBH_INST_POOL_Destroy(USBH_INST_POOL * pPool) {
+  if (pPool->pBase == NULL) {
+    return;
+  }
+  USBH_OS_Lock(USBH_MUTEX_MEM);
+  _InstPool.Stat.NumPools--;
+  _InstPool.Stat.NumBytesReserved -= pPool->Size;
+  USBH_OS_Unlock(USBH_MUTEX_MEM);
+  USBH_MEM_POOL_Free(&_aMemPool[0], pPool->pBase);
+  USBH_MEMSET(pPool, 0, sizeof(*pPool));
+}
+
+/*********************************************************************
+*
+*       USBH_ConfigInstPool
+*
+*  Function description
+*    Configures the buffer pools that the class drivers BULK, CDC, FT232, HID and MSD
+*    reserve for each device when it is started.
+*
+*  Parameters
+*    NumBytesExtra : Number of bytes reserved in addition to the buffers required by the
+*                    class driver for the endpoints of the device. Default is 0.
+*    AllowFallback : 1: Buffers that do not fit into the pool are allocated from the heap (default).
+*                    0: Allocation fails with USBH_STATUS_MEMORY if the pool is exhausted.
+*
+*  Additional information
+*    The pool covers the transfer buffers of all endpoints of a device, each class driver
+*    transfers data with a single URB per endpoint, so no heap allocations are performed
+*    after the device was started. Extra bytes are normally not required, they provide
+*    headroom for buffers that are allocated after the device was started.
+*    Peak usage can be checked with USBH_GetInstPoolStat().
+*    Should be called before USBH_Init(), must not be called while devices are connected.
+*/
+void USBH_ConfigInstPool(U32 NumBytesExtra, int AllowFallback) {
+  _InstPool.NumBytesExtra = NumBytesExtra;
+  _InstPool.NoFallback    = AllowFallback != 0 ? 0 : 1;
+}
+
+/*********************************************************************
+*
+*       USBH_GetInstPoolStat
+*
+*  Function description
+*    Returns statistics of the per-device buffer pools of the class drivers.
+*
+*  Parameters
+*    pStat : [OUT] Pointer to a structure that receives the statistics.
+*/
+void USBH_GetInstPoolStat(USBH_INST_POOL_STAT * pStat) {
+  USBH_OS_Lock(USBH_MUTEX_MEM);
+  *pStat = _InstPool.Stat;
+  USBH_OS_Unlock(USBH_MUTEX_MEM);
+}
+
 /*************************** End of file ****************************/
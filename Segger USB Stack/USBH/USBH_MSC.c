@@ -199,8 +199,9 @@ static void _DeleteDevice(USBH_MSD_INST * pInst) {
     USBH_OS_FreeEvent(pInst->pUrbEvent);
   }
   if (NULL != pInst->pTempBuf) {
-    USBH_FREE(pInst->pTempBuf);
+    USBH_INST_POOL_Free(&pInst->Pool, pInst->pTempBuf);
   }
+  USBH_INST_POOL_Destroy(&pInst->Pool);
   USBH_ReleaseTimer(&pInst->AbortTimer);
   //
   // Free all associated units.
@@ -1032,7 +1033,9 @@ static int _AddDevice(USBH_INTERFACE_ID InterfaceID) {
     goto Fail;
   }
   pInst->BulkOutEp = Desc[USB_EP_DESC_ADDRESS_OFS];
-  pInst->pTempBuf = (U8 *)USBH_TRY_MALLOC(pInst->BulkMaxPktSize);
+  if (USBH_INST_POOL_Create(&pInst->Pool, USBH_INST_POOL_BLOCK_SIZE(pInst->BulkMaxPktSize)) == 0) {
+    pInst->pTempBuf = (U8 *)USBH_INST_POOL_Alloc(&pInst->Pool, pInst->BulkMaxPktSize);
+  }
   if (NULL == pInst->pTempBuf) {
     USBH_WARN((USBH_MCAT_MSC, "_AddDevice: Could not allocate transfer buffer"));
     goto Fail;
@@ -174,6 +174,7 @@ typedef struct _USBH_MSD_INST {
   USBH_INTERFACE_HANDLE           hInterface;                      // UBD driver interface
   USBH_OS_EVENT_OBJ             * pUrbEvent;                       // Event for synchronous URB requests
   U8                            * pTempBuf;
+  USBH_INST_POOL                  Pool;                            // Holds pTempBuf.
   U16                             BulkMaxPktSize;
   U8                              BulkInEp;
   U8                              BulkOutEp;
@@ -397,8 +397,9 @@ static void _DeleteDevice(USBH_MSD_INST * pInst) {
   //
   _FreeLuns(pInst);
   if (NULL != pInst->pTempBuf) {
-    USBH_FREE(pInst->pTempBuf);
+    USBH_INST_POOL_Free(&pInst->Pool, pInst->pTempBuf);
   }
+  USBH_INST_POOL_Destroy(&pInst->Pool);
   USBH_FREE(pInst);
 }
 
@@ -1655,7 +1656,9 @@ static USBH_STATUS _InitDevice(USBH_MSD_INST * pInst, USBH_INTERFACE_ID interfac
   pInst->IsReady               = FALSE;
   pInst->InterfaceID           = interfaceID;
   pInst->RefCnt                = 1; // Initial reference
-  pInst->pTempBuf = (U8 *)USBH_TRY_MALLOC(pInst->BulkMaxPktSize);
+  if (USBH_INST_POOL_Create(&pInst->Pool, USBH_INST_POOL_BLOCK_SIZE(pInst->BulkMaxPktSize)) == 0) {
+    pInst->pTempBuf = (U8 *)USBH_INST_POOL_Alloc(&pInst->Pool, pInst->BulkMaxPktSize);
+  }
   if (NULL == pInst->pTempBuf) {
     Status = USBH_STATUS_MEMORY;
     USBH_WARN((USBH_MCAT_MSC, "_InitDevice: Could not allocate EP0 transfer pBuf!"));
@@ -423,6 +423,7 @@ typedef struct _USBH_MSD_INST {
   USBH_BOOL                       IsReady;
   U32                             MaxOutTransferSize;
   U32                             MaxInTransferSize;
+  USBH_INST_POOL                  Pool;                            // Holds pTempBuf.
 } USBH_MSD_INST;
 
 typedef struct {
@@ -260,7 +260,7 @@ static USBH_MSD_CACHE_API _ReadAheadCacheAPI = {
 *    for eight sectors (4096 bytes) from the emUSB-Host memory pool.
 */
 void USBH_MSD_UseAheadCache(int OnOff) {
-  USBH_LOG((USBH_MCAT_MSC, "MSD: USBH_MSD_UseAheadCache: cache %s", (OnOff) ? "on" : "off"));
+  USBH_LOG((USBH_MCAT_MSC, "MSD: USBH_MSD_UseAheadCache: cache %s", (const char *)((OnOff) ? "on" : "off")));
   if (OnOff != 0) {
     USBH_MSD_Global.pCacheAPI = &_ReadAheadCacheAPI;
   } else {
@@ -371,6 +371,9 @@ USBH_STATUS USBH__RemoveNotification(const USBH_NOTIFICATION_HOOK * pHook, USBH_
   USBH_NOTIFICATION_HOOK *  pPrev;
 
   p = *ppFirst;
+  if (p == NULL) {
+    return USBH_STATUS_INVALID_PARAM;
+  }
   if (p == pHook) {
     if (pHook->Handle != NULL) {
       USBH_UnregisterPnPNotification(pHook->Handle);
@@ -837,7 +837,11 @@ void USBH_LogHexDump(U32 Type, U32 Len, const void *pvData) {
       *p = '\0';
       USBH_USE_PARA(Type);
       USBH_USE_PARA(Addr);
+#if USBH_SUPPORT_LOG && USBH_LOG_BINARY
+      USBH_Logf(Type, "%03x0  %s", Addr, Buff);         // Buff is on the stack, binary logging would keep only its address.
+#else
       USBH_LOG((Type, "%03x0  %s", Addr, Buff));
+#endif
       p = Buff;
       Cnt = 16;
       Addr++;
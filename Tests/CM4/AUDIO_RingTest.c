@@ -0,0 +1,1125 @@
+/**
+  ******************************************************************************
+  * @file    AUDIO_RingTest.c
+  * @brief   Host test of the audio block queue (audio_ring.c) against a RAM
+  *          disk.
+  *
+  *          1. Queue: parameter checks, contiguous runs across the top of
+  *             the array and the wrap of the indices, overruns of
+  *             AUDIO_QUEUE_PutBlock() on a full queue and silence from
+  *             AUDIO_QUEUE_GetBlock() on an empty one.
+  *          2. Batches: AUDIO_QUEUE_Drain() and AUDIO_QUEUE_Fill() with a
+  *             batch not reached, a run split at the top of the array, a
+  *             sink that runs full and a source that ends in the middle of
+  *             a block.
+  *          3. Stream: the SAI2 half transfer interrupts of audio_stream.c
+  *             on a virtual sample clock, with AUDIO_STREAM_Poll() in the
+  *             main loop and a RAM disk as sink and source. Every read and
+  *             write costs time on a model of the eMMC behind emFile, and
+  *             the interrupts that fall into a storage call are taken in
+  *             the middle of it. Every block on the disk and every half
+  *             sent to the SAI is compared with what was captured or
+  *             stored, once at the configured rate and once overloaded.
+  *          4. Maximum sustainable rate: the highest sample clock in bytes
+  *             per second that runs without an overrun or underrun, for
+  *             capture, playback and both, per batch size and storage
+  *             model.
+  *          5. emFile adapters (audio_stream_file.c) on the emFile RAM disk:
+  *             the capture file is allocated up front, the batches of the
+  *             queue reach the disk as one write of whole sectors each
+  *             without a cluster being allocated, closing the file cuts it
+  *             at the last block written and frees the rest, and the
+  *             blocks read back for playback match the captured ones.
+  *             Files that do not exist or do not fit are refused.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FS.h"
+#include "audio_ring.h"
+#include "audio_stream.h"
+#include "test_check.h"
+
+/* Private define ------------------------------------------------------------*/
+#define TEST_BS                 AUDIO_STREAM_BLOCK_SIZE
+#define TEST_NB                 AUDIO_STREAM_QUEUE_BLOCKS
+#define TEST_STREAM_RATE        (192000U * 8U)   /* 192 kHz, 8 slots of 8 bits, see MX_SAI2_Init() */
+
+#define TEST_SMALL_BS           64U              /* Parts 1 and 2 */
+#define TEST_SMALL_NB           8U
+#define TEST_PATTERN_BLOCKS     61U              /* Prime, repeats out of step with the queue */
+
+#define TEST_RUN_BLOCKS         2048U            /* Clock periods per run */
+#define TEST_DISK_BLOCKS        (TEST_RUN_BLOCKS + 16U)
+#define TEST_ISR_NS             10000U           /* Copy of a block from or to the SDRAM */
+#define TEST_POLL_NS            2000U            /* Main loop around the storage calls */
+#define TEST_MIN_RATE           64000.0
+#define TEST_MAX_RATE           64000000.0
+
+#define TEST_FS_SECTOR_SIZE     512U
+#define TEST_FS_NUM_SECTORS     16384U           /* 8 MB RAM disk */
+#define TEST_FS_ALLOC_SIZE      (32U * 1024U)    /* Memory of emFile */
+#define TEST_FS_FILE_BLOCKS     64U              /* Allocated by AUDIO_STREAM_FileCreate() */
+#define TEST_FS_CAPTURE_BLOCKS  42U              /* Captured, not a multiple of the batch */
+
+#define TEST_MODE_CAPTURE       1U
+#define TEST_MODE_PLAYBACK      2U
+#define TEST_MODE_DUPLEX        (TEST_MODE_CAPTURE | TEST_MODE_PLAYBACK)
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+  * @brief  Time a storage medium takes per request.
+  */
+typedef struct
+{
+  const char *sName;
+  uint32_t    WrCall_ns;    /* File system and command overhead of a write */
+  uint32_t    WrRate;       /* Bytes per second                            */
+  uint32_t    RdCall_ns;
+  uint32_t    RdRate;
+  uint32_t    StallEvery;   /* Every n-th write waits for the card, 0: never */
+  uint32_t    Stall_ns;
+} TEST_MediumTypeDef;
+
+/**
+  * @brief  File on the RAM disk.
+  */
+typedef struct
+{
+  uint8_t  *pMem;
+  uint32_t  Size;           /* Bytes a read can return before the end  */
+  uint32_t  Limit;          /* Bytes a write can store before the disk is full */
+  uint32_t  Pos;
+} TEST_FileTypeDef;
+
+/**
+  * @brief  State of a stream run.
+  */
+typedef struct
+{
+  AUDIO_QueueTypeDef        Capture;
+  AUDIO_QueueTypeDef        Playback;
+  AUDIO_StatTypeDef         CaptureStat;
+  AUDIO_StatTypeDef         PlaybackStat;
+  AUDIO_SinkTypeDef         Sink;
+  AUDIO_SourceTypeDef       Source;
+  TEST_FileTypeDef          Disk;       /* Capture file */
+  TEST_FileTypeDef          File;       /* Playback file */
+  const TEST_MediumTypeDef *pMedium;
+  uint8_t                  *pDropped;   /* Per clock period: capture block was dropped */
+  double                    Rate;
+  uint64_t                  Now_ns;
+  uint64_t                  Start_ns;   /* The SAI starts clocking */
+  uint64_t                  Next_ns;
+  uint64_t                  Busy_ns;    /* Time spent in storage calls */
+  uint32_t                  NumPeriods;
+  uint32_t                  MaxPeriods;
+  uint32_t                  NumWrites;
+  uint32_t                  PlaySeq;    /* Next block of the file due at the SAI */
+  uint32_t                  NumSilent;  /* Halves sent as silence after an underrun */
+  uint32_t                  NumPlayedOut;
+  int                       SourceEnd;
+  uint8_t                   HasSink;
+  uint8_t                   HasSource;
+  uint8_t                   IsClocked;
+} TEST_SimTypeDef;
+
+/**
+  * @brief  Outcome of a stream run.
+  */
+typedef struct
+{
+  uint32_t Lost;            /* Overruns and underruns */
+  uint32_t MaxCount;
+  double   Busy;            /* Share of the time in storage calls */
+} TEST_ResultTypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static const TEST_MediumTypeDef TEST_aMedium[] =
+{
+  { "eMMC, steady",                       400000U, 18000000U, 150000U, 40000000U,  0U,       0U },
+  { "eMMC, 6 ms busy every 32nd write",   400000U, 18000000U, 150000U, 40000000U, 32U, 6000000U },
+};
+
+static uint32_t        TEST_Rand = 0x2468ACE1U;
+static uint8_t         TEST_aPattern[TEST_PATTERN_BLOCKS * TEST_BS];
+static uint32_t        TEST_aFsMem[TEST_FS_ALLOC_SIZE / 4U];
+static uint8_t        *TEST_pFsDisk;
+static FS_DEVICE_TYPE  TEST_FsDevice;       /* RAM disk driver that counts the writes */
+static uint32_t        TEST_FsNumWrites;
+static uint32_t        TEST_FsNumSectors;
+static uint32_t        TEST_FsMaxSectors;
+static uint8_t         TEST_aScratch[TEST_BS];
+static uint8_t         TEST_aTxDma[2U * TEST_BS];
+static uint8_t         TEST_aRxDma[2U * TEST_BS];
+static uint8_t         TEST_aCaptureMem[TEST_NB * TEST_BS];
+static uint8_t         TEST_aPlaybackMem[TEST_NB * TEST_BS];
+static TEST_SimTypeDef TEST_Sim;
+
+/* Private function prototypes -----------------------------------------------*/
+static void TEST_Advance(uint64_t Ns);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Returns the next number of a xorshift generator.
+  * @param  pState: Generator state, not 0.
+  * @retval Pseudo random number.
+  */
+static uint32_t TEST_GetRandFrom(uint32_t *pState)
+{
+  uint32_t x;
+
+  x = *pState;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *pState = x;
+  return x;
+}
+
+/**
+  * @brief  Returns the next number of the test generator.
+  * @retval Pseudo random number.
+  */
+static uint32_t TEST_GetRand(void)
+{
+  return TEST_GetRandFrom(&TEST_Rand);
+}
+
+/**
+  * @brief  Builds block Seq of the capture and playback data: a slice of
+  *         the pattern with the sequence number in its first 4 bytes.
+  * @param  pDest: Block.
+  * @param  Seq: Sequence number.
+  * @param  BlockSize: Bytes per block.
+  * @retval None
+  */
+static void TEST_MakeBlock(uint8_t *pDest, uint32_t Seq, uint32_t BlockSize)
+{
+  memcpy(pDest, &TEST_aPattern[(Seq % TEST_PATTERN_BLOCKS) * BlockSize], BlockSize);
+  pDest[0] = (uint8_t)Seq;
+  pDest[1] = (uint8_t)(Seq >> 8);
+  pDest[2] = (uint8_t)(Seq >> 16);
+  pDest[3] = (uint8_t)(Seq >> 24);
+}
+
+/**
+  * @brief  Checks that a block holds block Seq.
+  * @param  pBlock: Block.
+  * @param  Seq: Sequence number.
+  * @param  BlockSize: Bytes per block.
+  * @retval 1 if it does, 0 otherwise.
+  */
+static int TEST_IsBlock(const uint8_t *pBlock, uint32_t Seq, uint32_t BlockSize)
+{
+  TEST_MakeBlock(TEST_aScratch, Seq, BlockSize);
+  return (memcmp(pBlock, TEST_aScratch, BlockSize) == 0) ? 1 : 0;
+}
+
+/**
+  * @brief  Checks that a range holds silence.
+  * @param  p: First byte.
+  * @param  NumBytes: Number of bytes.
+  * @retval 1 if it does, 0 otherwise.
+  */
+static int TEST_IsSilence(const uint8_t *p, uint32_t NumBytes)
+{
+  uint32_t i;
+
+  for (i = 0; i < NumBytes; i++)
+  {
+    if (p[i] != AUDIO_RING_SILENCE)
+    {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+  * @brief  Sink of the RAM disk, FS_Write() semantics: stores what fits
+  *         and takes the time of the medium while the sample clock runs.
+  * @param  pContext: TEST_FileTypeDef.
+  * @param  pData: Data.
+  * @param  NumBytes: Number of bytes.
+  * @retval Number of bytes stored.
+  */
+static uint32_t TEST_Write(void *pContext, const uint8_t *pData, uint32_t NumBytes)
+{
+  TEST_FileTypeDef         *pFile;
+  const TEST_MediumTypeDef *pMedium;
+  uint64_t                  t;
+
+  pFile = (TEST_FileTypeDef *)pContext;
+  if (NumBytes > (pFile->Limit - pFile->Pos))
+  {
+    NumBytes = pFile->Limit - pFile->Pos;
+  }
+  memcpy(&pFile->pMem[pFile->Pos], pData, NumBytes);
+  pFile->Pos += NumBytes;
+  if (TEST_Sim.IsClocked != 0U)
+  {
+    pMedium = TEST_Sim.pMedium;
+    t = pMedium->WrCall_ns + (((uint64_t)NumBytes * 1000000000U) / pMedium->WrRate);
+    if ((pMedium->StallEvery != 0U) && ((TEST_Sim.NumWrites % pMedium->StallEvery) == (pMedium->StallEvery - 1U)))
+    {
+      t += pMedium->Stall_ns;
+    }
+    TEST_Sim.NumWrites++;
+    TEST_Sim.Busy_ns += t;
+    TEST_Advance(t);
+  }
+  return NumBytes;
+}
+
+/**
+  * @brief  Source of the RAM disk, FS_Read() semantics.
+  * @param  pContext: TEST_FileTypeDef.
+  * @param  pData: Destination.
+  * @param  NumBytes: Number of bytes.
+  * @retval Number of bytes read, fewer at the end of the file.
+  */
+static uint32_t TEST_Read(void *pContext, uint8_t *pData, uint32_t NumBytes)
+{
+  TEST_FileTypeDef         *pFile;
+  const TEST_MediumTypeDef *pMedium;
+  uint64_t                  t;
+
+  pFile = (TEST_FileTypeDef *)pContext;
+  if (NumBytes > (pFile->Size - pFile->Pos))
+  {
+    NumBytes = pFile->Size - pFile->Pos;
+  }
+  memcpy(pData, &pFile->pMem[pFile->Pos], NumBytes);
+  pFile->Pos += NumBytes;
+  if (TEST_Sim.IsClocked != 0U)
+  {
+    pMedium = TEST_Sim.pMedium;
+    t = pMedium->RdCall_ns + (((uint64_t)NumBytes * 1000000000U) / pMedium->RdRate);
+    TEST_Sim.Busy_ns += t;
+    TEST_Advance(t);
+  }
+  return NumBytes;
+}
+
+/**
+  * @brief  Builds a file of whole blocks followed by a partial one.
+  * @param  pFile: File, pMem large enough.
+  * @param  NumBytes: Size.
+  * @param  BlockSize: Bytes per block.
+  * @retval None
+  */
+static void TEST_MakeFile(TEST_FileTypeDef *pFile, uint32_t NumBytes, uint32_t BlockSize)
+{
+  uint32_t Seq;
+
+  for (Seq = 0; (Seq * BlockSize) < NumBytes; Seq++)
+  {
+    TEST_MakeBlock(&pFile->pMem[Seq * BlockSize], Seq, BlockSize);
+  }
+  pFile->Size  = NumBytes;
+  pFile->Limit = NumBytes;
+  pFile->Pos   = 0;
+}
+
+/**
+  * @brief  Queue: indices, runs, overrun and underrun.
+  * @retval None
+  */
+static void TEST_Queue(void)
+{
+  static uint8_t     aMem[TEST_SMALL_NB * TEST_SMALL_BS];
+  uint8_t            aBlock[TEST_SMALL_BS];
+  AUDIO_QueueTypeDef Queue;
+  AUDIO_StatTypeDef  Stat;
+  uint8_t           *pBlock;
+  uint32_t           i;
+
+  TEST_CHECK(AUDIO_QUEUE_Init(&Queue, NULL, TEST_SMALL_BS, TEST_SMALL_NB) == -1);
+  TEST_CHECK(AUDIO_QUEUE_Init(&Queue, aMem, 0, TEST_SMALL_NB) == -1);
+  TEST_CHECK(AUDIO_QUEUE_Init(&Queue, aMem, TEST_SMALL_BS, 0) == -1);
+  TEST_CHECK(AUDIO_QUEUE_Init(&Queue, aMem, TEST_SMALL_BS, 6) == -1);
+  TEST_CHECK_EQ(AUDIO_QUEUE_Init(&Queue, aMem, TEST_SMALL_BS, TEST_SMALL_NB), 0);
+  TEST_CHECK_EQ(AUDIO_QUEUE_GetCount(&Queue), 0U);
+  TEST_CHECK_EQ(AUDIO_QUEUE_GetFree(&Queue, &pBlock), TEST_SMALL_NB);
+  TEST_CHECK(pBlock == aMem);
+  TEST_CHECK_EQ(AUDIO_QUEUE_GetFilled(&Queue, &pBlock), 0U);
+
+  /* Two blocks below the wrap of the indices and the top of the array */
+  Queue.WrIdx = 0xFFFFFFFEU;
+  Queue.RdIdx = 0xFFFFFFFEU;
+  memset(&Stat, 0, sizeof(Stat));
+  TEST_CHECK_EQ(AUDIO_QUEUE_GetFree(&Queue, &pBlock), 2U);
+  TEST_CHECK(pBlock == &aMem[6U * TEST_SMALL_BS]);
+  for (i = 0; i < 3U; i++)
+  {
+    TEST_MakeBlock(aBlock, i, TEST_SMALL_BS);
+    TEST_CHECK_EQ(AUDIO_QUEUE_PutBlock(&Queue, aBlock, &Stat), 0);
+  }
+  TEST_CHECK_EQ(Queue.WrIdx, 1U);
+  TEST_CHECK_EQ(AUDIO_QUEUE_GetCount(&Queue), 3U);
+  TEST_CHECK_EQ(AUDIO_QUEUE_GetFilled(&Queue, &pBlock), 2U);
+  TEST_CHECK(pBlock == &aMem[6U * TEST_SMALL_BS]);
+  TEST_CHECK_EQ(AUDIO_QUEUE_GetFree(&Queue, &pBlock), 5U);
+  TEST_CHECK(pBlock == &aMem[1U * TEST_SMALL_BS]);
+
+  /* Fill up, the ninth block is dropped */
+  for (i = 3; i < 9U; i++)
+  {
+    TEST_MakeBlock(aBlock, i, TEST_SMALL_BS);
+    TEST_CHECK_EQ(AUDIO_QUEUE_PutBlock(&Queue, aBlock, &Stat), (i < 8U) ? 0 : -1);
+  }
+  TEST_CHECK_EQ(AUDIO_QUEUE_GetCount(&Queue), TEST_SMALL_NB);
+  TEST_CHECK_EQ(AUDIO_QUEUE_GetFree(&Queue, &pBlock), 0U);
+  TEST_CHECK_EQ(Stat.Blocks, 8U);
+  TEST_CHECK_EQ(Stat.Overruns, 1U);
+  TEST_CHECK_EQ(Stat.MaxCount, TEST_SMALL_NB);
+
+  /* Empty it in order, then silence */
+  memset(&Stat, 0, sizeof(Stat));
+  for (i = 0; i < 8U; i++)
+  {
+    memset(aBlock, 0x5A, sizeof(aBlock));
+    TEST_CHECK_EQ(AUDIO_QUEUE_GetBlock(&Queue, aBlock, &Stat), 0);
+    TEST_CHECK(TEST_IsBlock(aBlock, i, TEST_SMALL_BS));
+  }
+  memset(aBlock, 0x5A, sizeof(aBlock));
+  TEST_CHECK(AUDIO_QUEUE_GetBlock(&Queue, aBlock, &Stat) == -1);
+  TEST_CHECK(TEST_IsSilence(aBlock, TEST_SMALL_BS));
+  TEST_CHECK_EQ(Stat.Blocks, 8U);
+  TEST_CHECK_EQ(Stat.Underruns, 1U);
+  TEST_CHECK_EQ(Queue.RdIdx, 6U);
+  TEST_CHECK_EQ(AUDIO_QUEUE_GetCount(&Queue), 0U);
+}
+
+/**
+  * @brief  Batches: AUDIO_QUEUE_Drain() and AUDIO_QUEUE_Fill().
+  * @retval None
+  */
+static void TEST_Batch(void)
+{
+  static uint8_t      aMem[TEST_SMALL_NB * TEST_SMALL_BS];
+  static uint8_t      aDisk[16U * TEST_SMALL_BS];
+  uint8_t             aBlock[TEST_SMALL_BS];
+  AUDIO_QueueTypeDef  Queue;
+  AUDIO_StatTypeDef   Stat;
+  AUDIO_SinkTypeDef   Sink;
+  AUDIO_SourceTypeDef Source;
+  TEST_FileTypeDef    File;
+  uint8_t            *pBlock;
+  uint32_t            Seq;
+  uint32_t            i;
+  int                 End;
+
+  TEST_Sim.IsClocked = 0;
+  File.pMem  = aDisk;
+  File.Size  = 0;
+  File.Limit = sizeof(aDisk);
+  File.Pos   = 0;
+  Sink.pfWrite  = TEST_Write;
+  Sink.pContext = &File;
+  Source.pfRead   = TEST_Read;
+  Source.pContext = &File;
+
+  (void)AUDIO_QUEUE_Init(&Queue, aMem, TEST_SMALL_BS, TEST_SMALL_NB);
+  Queue.WrIdx = 6U;
+  Queue.RdIdx = 6U;
+  memset(&Stat, 0, sizeof(Stat));
+  Seq = 0;
+
+  /* Batch not reached */
+  for (i = 0; i < 3U; i++)
+  {
+    TEST_MakeBlock(aBlock, Seq++, TEST_SMALL_BS);
+    (void)AUDIO_QUEUE_PutBlock(&Queue, aBlock, &Stat);
+  }
+  TEST_CHECK_EQ(AUDIO_QUEUE_Drain(&Queue, &Sink, 4U, &Stat), 0U);
+  TEST_CHECK_EQ(Stat.Transfers, 0U);
+
+  /* Six blocks across the top of the array: two writes */
+  for (i = 0; i < 3U; i++)
+  {
+    TEST_MakeBlock(aBlock, Seq++, TEST_SMALL_BS);
+    (void)AUDIO_QUEUE_PutBlock(&Queue, aBlock, &Stat);
+  }
+  TEST_CHECK_EQ(AUDIO_QUEUE_Drain(&Queue, &Sink, 4U, &Stat), 6U);
+  TEST_CHECK_EQ(Stat.Transfers, 2U);
+  TEST_CHECK_EQ(Stat.Bytes, 6U * TEST_SMALL_BS);
+  TEST_CHECK_EQ(Stat.MaxTransfer, 4U * TEST_SMALL_BS);
+  TEST_CHECK_EQ(Stat.ShortTransfers, 0U);
+  TEST_CHECK_EQ(File.Pos, 6U * TEST_SMALL_BS);
+  for (i = 0; i < 6U; i++)
+  {
+    TEST_CHECK(TEST_IsBlock(&aDisk[i * TEST_SMALL_BS], i, TEST_SMALL_BS));
+  }
+  TEST_CHECK_EQ(AUDIO_QUEUE_Drain(&Queue, &Sink, 1U, &Stat), 0U);
+  TEST_CHECK_EQ(Stat.Transfers, 2U);
+
+  /* The disk fills up in the middle of the third of four blocks */
+  File.Limit = File.Pos + (5U * TEST_SMALL_BS / 2U);
+  for (i = 0; i < 4U; i++)
+  {
+    TEST_MakeBlock(aBlock, Seq++, TEST_SMALL_BS);
+    (void)AUDIO_QUEUE_PutBlock(&Queue, aBlock, &Stat);
+  }
+  TEST_CHECK_EQ(AUDIO_QUEUE_Drain(&Queue, &Sink, 4U, &Stat), 2U);
+  TEST_CHECK_EQ(Stat.Transfers, 3U);
+  TEST_CHECK_EQ(Stat.ShortTransfers, 1U);
+  TEST_CHECK_EQ(Stat.Bytes, (6U * TEST_SMALL_BS) + (5U * TEST_SMALL_BS / 2U));
+  TEST_CHECK_EQ(AUDIO_QUEUE_GetCount(&Queue), 2U);
+  TEST_CHECK(TEST_IsBlock(&aDisk[7U * TEST_SMALL_BS], 7U, TEST_SMALL_BS));
+
+  /* A full disk takes nothing, the blocks stay queued */
+  TEST_CHECK_EQ(AUDIO_QUEUE_Drain(&Queue, &Sink, 1U, &Stat), 0U);
+  TEST_CHECK_EQ(Stat.Transfers, 4U);
+  TEST_CHECK_EQ(Stat.ShortTransfers, 2U);
+  TEST_CHECK_EQ(AUDIO_QUEUE_GetCount(&Queue), 2U);
+  TEST_CHECK_EQ(AUDIO_QUEUE_GetFilled(&Queue, &pBlock), 2U);
+  TEST_CHECK(TEST_IsBlock(pBlock, 8U, TEST_SMALL_BS));
+
+  /* Playback of a file of 5.5 blocks into an empty queue at index 6 */
+  (void)AUDIO_QUEUE_Init(&Queue, aMem, TEST_SMALL_BS, TEST_SMALL_NB);
+  Queue.WrIdx = 6U;
+  Queue.RdIdx = 6U;
+  memset(&Stat, 0, sizeof(Stat));
+  TEST_MakeFile(&File, (11U * TEST_SMALL_BS) / 2U, TEST_SMALL_BS);
+  End = 0;
+  TEST_CHECK_EQ(AUDIO_QUEUE_Fill(&Queue, &Source, 4U, &Stat, &End), 6U);
+  TEST_CHECK_EQ(End, 1);
+  TEST_CHECK_EQ(Stat.Transfers, 2U);
+  TEST_CHECK_EQ(Stat.ShortTransfers, 1U);
+  TEST_CHECK_EQ(Stat.Bytes, File.Size);
+  TEST_CHECK_EQ(Stat.MaxTransfer, 6U * TEST_SMALL_BS);
+  TEST_CHECK_EQ(AUDIO_QUEUE_GetCount(&Queue), 6U);
+  for (i = 0; i < 6U; i++)
+  {
+    TEST_CHECK_EQ(AUDIO_QUEUE_GetBlock(&Queue, aBlock, &Stat), 0);
+    if (i < 5U)
+    {
+      TEST_CHECK(TEST_IsBlock(aBlock, i, TEST_SMALL_BS));
+    }
+    else
+    {
+      TEST_CHECK(memcmp(aBlock, &aDisk[i * TEST_SMALL_BS], TEST_SMALL_BS / 2U) == 0);
+      TEST_CHECK(TEST_IsSilence(&aBlock[TEST_SMALL_BS / 2U], TEST_SMALL_BS / 2U));
+    }
+  }
+
+  /* Batch not reached: six queued, two free */
+  TEST_MakeFile(&File, 16U * TEST_SMALL_BS, TEST_SMALL_BS);
+  TEST_CHECK_EQ(AUDIO_QUEUE_Fill(&Queue, &Source, 1U, &Stat, &End), 8U);
+  TEST_CHECK_EQ(Stat.Transfers, 4U);
+  for (i = 0; i < 2U; i++)
+  {
+    TEST_CHECK_EQ(AUDIO_QUEUE_GetBlock(&Queue, aBlock, &Stat), 0);
+    TEST_CHECK(TEST_IsBlock(aBlock, i, TEST_SMALL_BS));
+  }
+  End = 0;
+  TEST_CHECK_EQ(AUDIO_QUEUE_Fill(&Queue, &Source, 4U, &Stat, &End), 0U);
+  TEST_CHECK_EQ(Stat.Transfers, 4U);
+  TEST_CHECK_EQ(AUDIO_QUEUE_Fill(&Queue, &Source, 2U, &Stat, &End), 2U);
+  TEST_CHECK_EQ(Stat.Transfers, 5U);
+  TEST_CHECK_EQ(End, 0);
+  TEST_CHECK_EQ(Stat.ShortTransfers, 1U);
+  TEST_CHECK_EQ(Stat.Underruns, 0U);
+}
+
+/**
+  * @brief  Refills the transmit half the DMA just left, as
+  *         AUDIO_STREAM_TxHalf(), and checks what goes out.
+  * @param  pHalf: Half of the transmit buffer.
+  * @retval None
+  */
+static void TEST_TxHalf(uint8_t *pHalf)
+{
+  TEST_SimTypeDef *pSim;
+  uint32_t         Pos;
+  uint32_t         NumBytes;
+
+  pSim = &TEST_Sim;
+  if (pSim->HasSource == 0U)
+  {
+    return;
+  }
+  if ((pSim->SourceEnd != 0) && (AUDIO_QUEUE_GetCount(&pSim->Playback) == 0U))
+  {
+    memset(pHalf, AUDIO_RING_SILENCE, TEST_BS);
+    pSim->NumPlayedOut++;
+    return;
+  }
+  if (AUDIO_QUEUE_GetBlock(&pSim->Playback, pHalf, &pSim->PlaybackStat) != 0)
+  {
+    TEST_CHECK(TEST_IsSilence(pHalf, TEST_BS));
+    pSim->NumSilent++;
+    return;
+  }
+
+  /* Blocks come out in file order, a late block is played late, not lost */
+  Pos      = pSim->PlaySeq * TEST_BS;
+  NumBytes = pSim->File.Size - Pos;
+  if (NumBytes >= TEST_BS)
+  {
+    TEST_CHECK(memcmp(pHalf, &pSim->File.pMem[Pos], TEST_BS) == 0);
+  }
+  else
+  {
+    TEST_CHECK(Pos < pSim->File.Size);
+    TEST_CHECK(memcmp(pHalf, &pSim->File.pMem[Pos], NumBytes) == 0);
+    TEST_CHECK(TEST_IsSilence(&pHalf[NumBytes], TEST_BS - NumBytes));
+  }
+  pSim->PlaySeq++;
+}
+
+/**
+  * @brief  End of a clock period: block B has filled one half of the
+  *         receive buffer and block A has sent one half of the transmit
+  *         buffer.
+  * @retval None
+  */
+static void TEST_Interrupt(void)
+{
+  TEST_SimTypeDef *pSim;
+  uint32_t         Half;
+
+  pSim = &TEST_Sim;
+  Half = (pSim->NumPeriods & 1U) * TEST_BS;
+  if (pSim->HasSink != 0U)
+  {
+    TEST_MakeBlock(&TEST_aRxDma[Half], pSim->NumPeriods, TEST_BS);
+    if (AUDIO_QUEUE_PutBlock(&pSim->Capture, &TEST_aRxDma[Half], &pSim->CaptureStat) != 0)
+    {
+      pSim->pDropped[pSim->NumPeriods] = 1U;
+    }
+  }
+  TEST_TxHalf(&TEST_aTxDma[Half]);
+  pSim->NumPeriods++;
+  pSim->Next_ns = pSim->Start_ns + (uint64_t)(((double)(pSim->NumPeriods + 1U) * TEST_BS * 1e9) / pSim->Rate);
+}
+
+/**
+  * @brief  Lets virtual time pass for the main loop and takes the
+  *         interrupts that fall into it; each one delays the main loop.
+  * @param  Ns: Time the main loop needs.
+  * @retval None
+  */
+static void TEST_Advance(uint64_t Ns)
+{
+  TEST_SimTypeDef *pSim;
+  uint64_t         End;
+
+  pSim = &TEST_Sim;
+  End  = pSim->Now_ns + Ns;
+  while ((pSim->NumPeriods < pSim->MaxPeriods) && (pSim->Next_ns <= End))
+  {
+    if (pSim->Next_ns > pSim->Now_ns)
+    {
+      pSim->Now_ns = pSim->Next_ns;
+    }
+    TEST_Interrupt();
+    End += TEST_ISR_NS;
+  }
+  pSim->Now_ns = End;
+}
+
+/**
+  * @brief  Streams TEST_RUN_BLOCKS clock periods through the queues as
+  *         AUDIO_STREAM_Start(), AUDIO_STREAM_Poll() and AUDIO_STREAM_Stop()
+  *         do, then checks the capture file.
+  * @param  pMedium: Storage model.
+  * @param  Rate: Sample clock in bytes per second and direction.
+  * @param  Batch: Blocks per storage request.
+  * @param  Mode: TEST_MODE_CAPTURE, TEST_MODE_PLAYBACK or both.
+  * @param  FileSize: Size of the playback file.
+  * @param  StopOnLoss: Give up at the first overrun or underrun.
+  * @param  pResult: Outcome.
+  * @retval None
+  */
+static void TEST_Run(const TEST_MediumTypeDef *pMedium, double Rate, uint32_t Batch, uint32_t Mode,
+                     uint32_t FileSize, int StopOnLoss, TEST_ResultTypeDef *pResult)
+{
+  TEST_SimTypeDef *pSim;
+  uint32_t         Done;
+  uint32_t         Seq;
+  uint32_t         Pos;
+  int              End;
+
+  pSim = &TEST_Sim;
+  pSim->pMedium      = pMedium;
+  pSim->Rate         = Rate;
+  pSim->Now_ns       = 0;
+  pSim->Busy_ns      = 0;
+  pSim->NumPeriods   = 0;
+  pSim->MaxPeriods   = 0;              /* No clock before the SAI is enabled */
+  pSim->NumWrites    = 0;
+  pSim->PlaySeq      = 0;
+  pSim->NumSilent    = 0;
+  pSim->NumPlayedOut = 0;
+  pSim->SourceEnd    = 0;
+  pSim->HasSink      = ((Mode & TEST_MODE_CAPTURE) != 0U) ? 1U : 0U;
+  pSim->HasSource    = ((Mode & TEST_MODE_PLAYBACK) != 0U) ? 1U : 0U;
+  pSim->IsClocked    = 1;
+  (void)AUDIO_QUEUE_Init(&pSim->Capture, TEST_aCaptureMem, TEST_BS, TEST_NB);
+  (void)AUDIO_QUEUE_Init(&pSim->Playback, TEST_aPlaybackMem, TEST_BS, TEST_NB);
+  memset(&pSim->CaptureStat, 0, sizeof(pSim->CaptureStat));
+  memset(&pSim->PlaybackStat, 0, sizeof(pSim->PlaybackStat));
+  memset(pSim->pDropped, 0, TEST_RUN_BLOCKS);
+  memset(TEST_aTxDma, AUDIO_RING_SILENCE, sizeof(TEST_aTxDma));
+  pSim->Disk.Pos   = 0;
+  pSim->Disk.Limit = TEST_DISK_BLOCKS * TEST_BS;
+  pSim->File.Pos   = 0;
+  pSim->File.Size  = FileSize;
+
+  /* AUDIO_STREAM_Start(): queue what fits and both halves before the clock runs */
+  if (pSim->HasSource != 0U)
+  {
+    End = 0;
+    (void)AUDIO_QUEUE_Fill(&pSim->Playback, &pSim->Source, 1U, &pSim->PlaybackStat, &End);
+    pSim->SourceEnd = End;
+    TEST_TxHalf(&TEST_aTxDma[0]);
+    TEST_TxHalf(&TEST_aTxDma[TEST_BS]);
+  }
+  pSim->MaxPeriods = TEST_RUN_BLOCKS;
+  pSim->Start_ns   = pSim->Now_ns;
+  pSim->Next_ns    = pSim->Start_ns + (uint64_t)((TEST_BS * 1e9) / Rate);
+
+  /* AUDIO_STREAM_Poll() in the main loop, which sleeps when it has nothing to do */
+  while (pSim->NumPeriods < pSim->MaxPeriods)
+  {
+    Done = 0;
+    if (pSim->HasSink != 0U)
+    {
+      Done += AUDIO_QUEUE_Drain(&pSim->Capture, &pSim->Sink, Batch, &pSim->CaptureStat);
+    }
+    if ((pSim->HasSource != 0U) && (pSim->SourceEnd == 0))
+    {
+      End = 0;
+      Done += AUDIO_QUEUE_Fill(&pSim->Playback, &pSim->Source, Batch, &pSim->PlaybackStat, &End);
+      pSim->SourceEnd = End;
+    }
+    if ((StopOnLoss != 0) && ((pSim->CaptureStat.Overruns + pSim->PlaybackStat.Underruns) != 0U))
+    {
+      break;
+    }
+    TEST_Advance((Done != 0U) ? TEST_POLL_NS : (pSim->Next_ns - pSim->Now_ns));
+  }
+
+  /* AUDIO_STREAM_Stop(): the clock stops, the rest of the capture is written */
+  pSim->IsClocked = 0;
+  if (pSim->HasSink != 0U)
+  {
+    (void)AUDIO_QUEUE_Drain(&pSim->Capture, &pSim->Sink, 1U, &pSim->CaptureStat);
+    TEST_CHECK_EQ(AUDIO_QUEUE_GetCount(&pSim->Capture), 0U);
+    TEST_CHECK_EQ(pSim->CaptureStat.Blocks + pSim->CaptureStat.Overruns, pSim->NumPeriods);
+    TEST_CHECK_EQ(pSim->Disk.Pos, pSim->CaptureStat.Blocks * TEST_BS);
+    TEST_CHECK_EQ(pSim->CaptureStat.ShortTransfers, 0U);
+    TEST_CHECK(pSim->CaptureStat.MaxCount <= TEST_NB);
+
+    /* Every period is on the disk in order, unless its block was dropped */
+    Pos = 0;
+    for (Seq = 0; Seq < pSim->NumPeriods; Seq++)
+    {
+      if (pSim->pDropped[Seq] == 0U)
+      {
+        TEST_CHECK(TEST_IsBlock(&pSim->Disk.pMem[Pos], Seq, TEST_BS));
+        Pos += TEST_BS;
+      }
+    }
+    TEST_CHECK_EQ(Pos, pSim->Disk.Pos);
+  }
+  if (pSim->HasSource != 0U)
+  {
+    TEST_CHECK_EQ(pSim->NumSilent, pSim->PlaybackStat.Underruns);
+    TEST_CHECK_EQ(pSim->PlaySeq, pSim->PlaybackStat.Blocks);
+    TEST_CHECK_EQ(pSim->PlaybackStat.Bytes, pSim->File.Pos);
+  }
+  pResult->Lost     = pSim->CaptureStat.Overruns + pSim->PlaybackStat.Underruns;
+  pResult->MaxCount = (pSim->CaptureStat.MaxCount > pSim->PlaybackStat.MaxCount) ?
+                      pSim->CaptureStat.MaxCount : pSim->PlaybackStat.MaxCount;
+  pResult->Busy     = (double)pSim->Busy_ns / (double)pSim->Now_ns;
+}
+
+/**
+  * @brief  Stream at the configured rate and overloaded.
+  * @retval None
+  */
+static void TEST_Stream(void)
+{
+  TEST_SimTypeDef   *pSim;
+  TEST_ResultTypeDef Res;
+  uint32_t           FileSize;
+  uint32_t           NumBlocks;
+
+  pSim = &TEST_Sim;
+
+  /* Configured rate and batch on the slow medium; the file ends in the
+     middle of a block before the clock stops */
+  FileSize  = ((TEST_RUN_BLOCKS - 300U) * TEST_BS) + 1000U;
+  NumBlocks = (FileSize + TEST_BS - 1U) / TEST_BS;
+  TEST_Run(&TEST_aMedium[1], TEST_STREAM_RATE, AUDIO_STREAM_BATCH_BLOCKS, TEST_MODE_DUPLEX, FileSize, 0, &Res);
+  TEST_CHECK_EQ(Res.Lost, 0U);
+  TEST_CHECK_EQ(pSim->NumPeriods, TEST_RUN_BLOCKS);
+  TEST_CHECK_EQ(pSim->CaptureStat.Blocks, TEST_RUN_BLOCKS);
+  TEST_CHECK_EQ(pSim->PlaySeq, NumBlocks);
+  TEST_CHECK_EQ(pSim->File.Pos, FileSize);
+  TEST_CHECK_EQ(pSim->SourceEnd, 1);
+  TEST_CHECK_EQ(pSim->PlaybackStat.ShortTransfers, 1U);
+  TEST_CHECK_EQ(pSim->NumPlayedOut + NumBlocks, TEST_RUN_BLOCKS + 2U);
+  TEST_CHECK_EQ(pSim->CaptureStat.MaxTransfer, AUDIO_STREAM_BATCH_BLOCKS * TEST_BS);
+  printf("%s, %u B/s, batch of %u: storage busy %.0f %%, %u writes and %u reads, "
+         "at most %u of %u blocks queued\n",
+         TEST_aMedium[1].sName, TEST_STREAM_RATE, AUDIO_STREAM_BATCH_BLOCKS, 100.0 * Res.Busy,
+         pSim->CaptureStat.Transfers, pSim->PlaybackStat.Transfers, Res.MaxCount, TEST_NB);
+
+  /* Four times the rate the slow medium can take: capture blocks are
+     dropped, playback halves are silent, nothing else is lost */
+  TEST_Run(&TEST_aMedium[1], 4.0 * 8000000.0, AUDIO_STREAM_BATCH_BLOCKS, TEST_MODE_DUPLEX,
+           TEST_DISK_BLOCKS * TEST_BS, 0, &Res);
+  TEST_CHECK(pSim->CaptureStat.Overruns != 0U);
+  TEST_CHECK(pSim->PlaybackStat.Underruns != 0U);
+  TEST_CHECK_EQ(pSim->CaptureStat.MaxCount, TEST_NB);
+  TEST_CHECK_EQ(pSim->PlaybackStat.Blocks + pSim->PlaybackStat.Underruns, TEST_RUN_BLOCKS + 2U);
+  printf("Overloaded at 32 MB/s: %u of %u capture blocks dropped, %u playback halves silent\n",
+         pSim->CaptureStat.Overruns, TEST_RUN_BLOCKS, pSim->PlaybackStat.Underruns);
+}
+
+/**
+  * @brief  Searches the highest rate that streams without loss.
+  * @param  pMedium: Storage model.
+  * @param  Batch: Blocks per storage request.
+  * @param  Mode: Directions.
+  * @retval Rate in bytes per second, 0 if even TEST_MIN_RATE loses data.
+  */
+static double TEST_GetMaxRate(const TEST_MediumTypeDef *pMedium, uint32_t Batch, uint32_t Mode)
+{
+  TEST_ResultTypeDef Res;
+  double             Lo;
+  double             Hi;
+  double             Mid;
+
+  Lo = TEST_MIN_RATE;
+  Hi = TEST_MAX_RATE;
+  TEST_Run(pMedium, Lo, Batch, Mode, TEST_DISK_BLOCKS * TEST_BS, 1, &Res);
+  if (Res.Lost != 0U)
+  {
+    return 0.0;
+  }
+  while (Hi > (Lo * 1.005))
+  {
+    Mid = (Lo + Hi) / 2.0;
+    TEST_Run(pMedium, Mid, Batch, Mode, TEST_DISK_BLOCKS * TEST_BS, 1, &Res);
+    if (Res.Lost == 0U)
+    {
+      Lo = Mid;
+    }
+    else
+    {
+      Hi = Mid;
+    }
+  }
+  return Lo;
+}
+
+/**
+  * @brief  Maximum sustainable rate per medium, batch size and direction.
+  * @retval None
+  */
+static void TEST_MaxRate(void)
+{
+  static const uint32_t aBatch[] = { 1U, 2U, 4U, 8U };
+  double                aRate[sizeof(aBatch) / sizeof(aBatch[0])][3];
+  uint32_t              m;
+  uint32_t              b;
+  uint32_t              Mode;
+
+  for (m = 0; m < (sizeof(TEST_aMedium) / sizeof(TEST_aMedium[0])); m++)
+  {
+    printf("Maximum sustainable rate, %s, blocks of %u B, %u per queue:\n",
+           TEST_aMedium[m].sName, TEST_BS, TEST_NB);
+    for (b = 0; b < (sizeof(aBatch) / sizeof(aBatch[0])); b++)
+    {
+      for (Mode = TEST_MODE_CAPTURE; Mode <= TEST_MODE_DUPLEX; Mode++)
+      {
+        aRate[b][Mode - 1U] = TEST_GetMaxRate(&TEST_aMedium[m], aBatch[b], Mode);
+      }
+      printf("  batch of %u: capture %6.2f MB/s, playback %6.2f MB/s, both %6.2f MB/s each\n", aBatch[b],
+             aRate[b][0] / 1e6, aRate[b][1] / 1e6, aRate[b][2] / 1e6);
+      if (aBatch[b] == AUDIO_STREAM_BATCH_BLOCKS)
+      {
+        /* The configured stream fits with room to spare */
+        TEST_CHECK(aRate[b][2] >= (1.2 * TEST_STREAM_RATE));
+      }
+    }
+    if (TEST_aMedium[m].StallEvery == 0U)
+    {
+      /* Without stalls the cost per request decides: larger batches win */
+      TEST_CHECK(aRate[1][2] > aRate[0][2]);
+      TEST_CHECK(aRate[2][2] > aRate[1][2]);
+    }
+  }
+}
+
+/**
+  * @brief  Write function of the RAM disk driver, counts the requests.
+  */
+static int TEST_FsWrite(U8 Unit, U32 SectorIndex, const void *pBuffer, U32 NumSectors, U8 RepeatSame)
+{
+  TEST_FsNumWrites++;
+  TEST_FsNumSectors += NumSectors;
+  if (NumSectors > TEST_FsMaxSectors)
+  {
+    TEST_FsMaxSectors = NumSectors;
+  }
+  return FS_RAMDISK_Driver.pfWrite(Unit, SectorIndex, pBuffer, NumSectors, RepeatSame);
+}
+
+/**
+  * @brief  Part 5: emFile adapters on the emFile RAM disk.
+  */
+static void TEST_File(void)
+{
+  static uint8_t      aMem[TEST_NB * TEST_BS];
+  uint8_t             aBlock[TEST_BS];
+  FS_FORMAT_INFO      FormatInfo;
+  FS_DISK_INFO        DiskInfo;
+  AUDIO_QueueTypeDef  Queue;
+  AUDIO_StatTypeDef   Stat;
+  AUDIO_SinkTypeDef   Sink;
+  AUDIO_SourceTypeDef Source;
+  FS_FILE            *pCheck;
+  void               *pFile;
+  uint32_t            ClusterSize;
+  uint32_t            FreeEmpty;
+  uint32_t            FreeAlloc;
+  uint32_t            Seq;
+  uint32_t            NumBytes;
+  int                 End;
+
+  TEST_pFsDisk = (uint8_t *)calloc(TEST_FS_NUM_SECTORS, TEST_FS_SECTOR_SIZE);
+  TEST_CHECK(TEST_pFsDisk != NULL);
+  if (TEST_pFsDisk == NULL)
+  {
+    return;
+  }
+  FS_Init();
+  memset(&FormatInfo, 0, sizeof(FormatInfo));
+  FormatInfo.SectorsPerCluster = 8U;                    /* A block is one cluster */
+  TEST_CHECK_EQ(FS_Format("", &FormatInfo), 0);
+  TEST_CHECK_EQ(FS_GetVolumeInfo("", &DiskInfo), 0);
+  ClusterSize = (uint32_t)DiskInfo.BytesPerSector * DiskInfo.SectorsPerCluster;
+  TEST_CHECK_EQ(ClusterSize, TEST_BS);
+  FreeEmpty = FS_GetVolumeFreeSpace("");
+
+  /* Capture file, allocated up front */
+  pFile = AUDIO_STREAM_FileCreate("capture.raw", TEST_FS_FILE_BLOCKS * TEST_BS);
+  TEST_CHECK(pFile != NULL);
+  if (pFile == NULL)
+  {
+    FS_Unmount("");
+    free(TEST_pFsDisk);
+    return;
+  }
+  TEST_CHECK_EQ(FS_GetFileSize((FS_FILE *)pFile), TEST_FS_FILE_BLOCKS * TEST_BS);
+  FreeAlloc = FS_GetVolumeFreeSpace("");
+  TEST_CHECK_EQ(FreeEmpty - FreeAlloc, TEST_FS_FILE_BLOCKS * TEST_BS);
+
+  /* Capture: the queue is drained in batches as in AUDIO_STREAM_Poll() */
+  memset(&Stat, 0, sizeof(Stat));
+  (void)AUDIO_QUEUE_Init(&Queue, aMem, TEST_BS, TEST_NB);
+  Sink.pfWrite  = AUDIO_STREAM_FileWrite;
+  Sink.pContext = pFile;
+  TEST_FsNumWrites  = 0;
+  TEST_FsNumSectors = 0;
+  TEST_FsMaxSectors = 0;
+  for (Seq = 0; Seq < TEST_FS_CAPTURE_BLOCKS; Seq++)
+  {
+    TEST_MakeBlock(aBlock, Seq, TEST_BS);
+    TEST_CHECK_EQ(AUDIO_QUEUE_PutBlock(&Queue, aBlock, &Stat), 0);
+    (void)AUDIO_QUEUE_Drain(&Queue, &Sink, AUDIO_STREAM_BATCH_BLOCKS, &Stat);
+  }
+  (void)AUDIO_QUEUE_Drain(&Queue, &Sink, 1U, &Stat);   /* Rest at the end of the capture */
+  TEST_CHECK_EQ(Stat.Overruns, 0U);
+  TEST_CHECK_EQ(Stat.ShortTransfers, 0U);
+  TEST_CHECK_EQ(Stat.Bytes, TEST_FS_CAPTURE_BLOCKS * TEST_BS);
+  /* One request of whole sectors per batch, no cluster allocated on the way */
+  TEST_CHECK_EQ(TEST_FsNumSectors, TEST_FS_CAPTURE_BLOCKS * (TEST_BS / TEST_FS_SECTOR_SIZE));
+  TEST_CHECK_EQ(TEST_FsNumWrites, Stat.Transfers);
+  TEST_CHECK_EQ(FS_GetVolumeFreeSpace(""), FreeAlloc);
+  printf("emFile capture: %u blocks in %lu writes of up to %lu sectors, %lu sectors in total\n",
+         (unsigned)TEST_FS_CAPTURE_BLOCKS, (unsigned long)TEST_FsNumWrites,
+         (unsigned long)TEST_FsMaxSectors, (unsigned long)TEST_FsNumSectors);
+  TEST_CHECK_EQ(TEST_FsMaxSectors, AUDIO_STREAM_BATCH_BLOCKS * (TEST_BS / TEST_FS_SECTOR_SIZE));
+
+  /* Closing cuts the file at the last block and frees the rest */
+  AUDIO_STREAM_FileClose(pFile);
+  TEST_CHECK_EQ(FreeEmpty - FS_GetVolumeFreeSpace(""), TEST_FS_CAPTURE_BLOCKS * TEST_BS);
+  pCheck = FS_FOpen("capture.raw", "rb");
+  TEST_CHECK(pCheck != NULL);
+  if (pCheck != NULL)
+  {
+    TEST_CHECK_EQ(FS_GetFileSize(pCheck), TEST_FS_CAPTURE_BLOCKS * TEST_BS);
+    (void)FS_FClose(pCheck);
+  }
+
+  /* Playback of the captured file */
+  pFile = AUDIO_STREAM_FileOpen("capture.raw");
+  TEST_CHECK(pFile != NULL);
+  if (pFile != NULL)
+  {
+    memset(&Stat, 0, sizeof(Stat));
+    (void)AUDIO_QUEUE_Init(&Queue, aMem, TEST_BS, TEST_NB);
+    Source.pfRead   = AUDIO_STREAM_FileRead;
+    Source.pContext = pFile;
+    Seq = 0;
+    End = 0;
+    while ((End == 0) || (AUDIO_QUEUE_GetCount(&Queue) != 0U))
+    {
+      if (End == 0)
+      {
+        (void)AUDIO_QUEUE_Fill(&Queue, &Source, AUDIO_STREAM_BATCH_BLOCKS, &Stat, &End);
+      }
+      if (AUDIO_QUEUE_GetBlock(&Queue, aBlock, &Stat) == 0)
+      {
+        TEST_CHECK(TEST_IsBlock(aBlock, Seq, TEST_BS) != 0);
+        Seq++;
+      }
+      TEST_CHECK(Seq <= TEST_FS_CAPTURE_BLOCKS);
+      if (Seq > TEST_FS_CAPTURE_BLOCKS)
+      {
+        break;
+      }
+    }
+    TEST_CHECK_EQ(Seq, TEST_FS_CAPTURE_BLOCKS);
+    TEST_CHECK_EQ(Stat.Bytes, TEST_FS_CAPTURE_BLOCKS * TEST_BS);
+    AUDIO_STREAM_FileClose(pFile);                      /* Read only: nothing to cut */
+  }
+
+  /* Refused */
+  TEST_CHECK(AUDIO_STREAM_FileOpen("missing.raw") == NULL);
+  NumBytes = FS_GetVolumeFreeSpace("") + TEST_BS;
+  TEST_CHECK(AUDIO_STREAM_FileCreate("big.raw", NumBytes) == NULL);
+  FS_Unmount("");
+  free(TEST_pFsDisk);
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  emFile configuration: the RAM disk behind TEST_FsWrite().
+  */
+void FS_X_AddDevices(void)
+{
+  FS_AssignMemory(TEST_aFsMem, sizeof(TEST_aFsMem));
+  TEST_FsDevice         = FS_RAMDISK_Driver;
+  TEST_FsDevice.pfWrite = TEST_FsWrite;
+  FS_AddDevice(&TEST_FsDevice);
+  FS_RAMDISK_Configure(0, TEST_pFsDisk, TEST_FS_SECTOR_SIZE, TEST_FS_NUM_SECTORS);
+}
+
+/**
+  * @brief  emFile configuration: time stamp of the files.
+  */
+U32 FS_X_GetTimeDate(void)
+{
+  return 0x00210000U;                                   /* 1 Jan 1980 */
+}
+
+/**
+  * @brief  emFile configuration: fatal error.
+  */
+void FS_X_Panic(int ErrorCode)
+{
+  printf("FS_X_Panic: %d\n", ErrorCode);
+  exit(1);
+}
+
+/**
+  * @brief  emFile OS layer, single task.
+  */
+void FS_X_OS_Lock(unsigned LockIndex)
+{
+  (void)LockIndex;
+}
+
+void FS_X_OS_Unlock(unsigned LockIndex)
+{
+  (void)LockIndex;
+}
+
+void FS_X_OS_Init(unsigned NumLocks)
+{
+  (void)NumLocks;
+}
+
+void FS_X_OS_DeInit(void)
+{
+}
+
+U32 FS_X_OS_GetTime(void)
+{
+  return 0;
+}
+
+int FS_X_OS_Wait(int TimeOut)
+{
+  (void)TimeOut;
+  return 0;
+}
+
+void FS_X_OS_Signal(void)
+{
+}
+
+void FS_X_OS_Delay(int ms)
+{
+  (void)ms;
+}
+
+/**
+  * @brief  Runs the test.
+  */
+int main(void)
+{
+  uint32_t i;
+
+  for (i = 0; i < sizeof(TEST_aPattern); i++)
+  {
+    TEST_aPattern[i] = (uint8_t)TEST_GetRand();
+  }
+  TEST_Sim.Disk.pMem     = (uint8_t *)malloc(TEST_DISK_BLOCKS * TEST_BS);
+  TEST_Sim.File.pMem     = (uint8_t *)malloc(TEST_DISK_BLOCKS * TEST_BS);
+  TEST_Sim.pDropped      = (uint8_t *)malloc(TEST_RUN_BLOCKS);
+  TEST_Sim.Sink.pfWrite    = TEST_Write;
+  TEST_Sim.Sink.pContext   = &TEST_Sim.Disk;
+  TEST_Sim.Source.pfRead   = TEST_Read;
+  TEST_Sim.Source.pContext = &TEST_Sim.File;
+  if ((TEST_Sim.Disk.pMem == NULL) || (TEST_Sim.File.pMem == NULL) || (TEST_Sim.pDropped == NULL))
+  {
+    printf("Out of memory\n");
+    return 1;
+  }
+  TEST_MakeFile(&TEST_Sim.File, TEST_DISK_BLOCKS * TEST_BS, TEST_BS);
+
+  TEST_Queue();
+  TEST_Batch();
+  TEST_Stream();
+  TEST_MaxRate();
+  TEST_File();
+  free(TEST_Sim.Disk.pMem);
+  free(TEST_Sim.File.pMem);
+  free(TEST_Sim.pDropped);
+  return TEST_Report("AUDIO_RingTest");
+}
@@ -0,0 +1,1027 @@
+/**
+  ******************************************************************************
+  * @file    CAN_RingTest.c
+  * @brief   Host test of the CAN receive ring (can_ring.c).
+  *
+  *          1. Ring and filter: parameter checks, the software filter filled
+  *             up to its load limit and compared with a list of the keys.
+  *          2. Time base: conversion factors for bit rates from 10 kbit/s to
+  *             1 Mbit/s, prescaler reduction and the conversion of the
+  *             oldest timestamp across the wrap of both counters.
+  *          3. Receive pipeline: two buses with the message RAM layout of
+  *             can_rx.c (Rx FIFO0 of 64 elements with a watermark of 16,
+  *             Rx FIFO1 of 32) receive 2 s of bursty traffic on a virtual
+  *             1 Mbit/s clock. The drains and acknowledges mirror
+  *             CAN_RX_Drain(), interrupts are masked for up to 15 ms at
+  *             times so that the FIFOs overrun, and the consumer stalls so
+  *             that the ring runs full. Every frame read from the ring is
+  *             compared with the frame that was sent, its time stamp with
+  *             the start of frame. Run once with the consumer on the virtual
+  *             clock, where the fate of every frame is known, and once with
+  *             the consumer in a separate thread.
+  *          4. Drain cost per frame with a full FIFO taken in one batch and
+  *             element by element.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "can_ring.h"
+#include "test_check.h"
+
+/* Private define ------------------------------------------------------------*/
+#define TEST_CPU_CLOCK          240000000U   /* Cortex-M4 */
+#define TEST_CAN_CLOCK          80000000U
+#define TEST_BIT_CLOCKS         80U          /* 1 Mbit/s */
+#define TEST_TS_PRESCALER       8U
+#define TEST_CYCLES_PER_BIT     (TEST_CPU_CLOCK / (TEST_CAN_CLOCK / TEST_BIT_CLOCKS))
+#define TEST_CYCLES_PER_TICK    (TEST_CYCLES_PER_BIT * TEST_TS_PRESCALER)
+
+#define TEST_NUM_BUS            2U
+#define TEST_MSG_RAM_WORDS      480U
+#define TEST_ELEM_WORDS         4U           /* Header and 8 data bytes */
+#define TEST_FIFO0_OFF          64U          /* After 32 standard and 16 extended filters */
+#define TEST_FIFO0_SIZE         64U
+#define TEST_FIFO1_OFF          (TEST_FIFO0_OFF + (TEST_FIFO0_SIZE * TEST_ELEM_WORDS))
+#define TEST_FIFO1_SIZE         32U
+#define TEST_WATERMARK          16U
+#define TEST_FLUSH_BITS         1000U        /* CAN_RX_FLUSH_MS */
+
+#define TEST_RING_SIZE          256U
+#define TEST_RING_START         0xFFFFFF00U  /* Indices wrap during the run */
+#define TEST_FILTER_SIZE        256U
+#define TEST_NUM_IDS            400U
+#define TEST_NUM_LISTED         180U
+#define TEST_DURATION_BITS      2000000U
+#define TEST_MAX_FRAMES         (TEST_NUM_BUS * (TEST_DURATION_BITS / 40U))
+#define TEST_T0                 (0xFFFFFFFFU - (TEST_CPU_CLOCK / 2U))  /* DWT wraps after 0.5 s */
+#define TEST_DATA_XOR           0xA5C3E1F0U
+
+#define TEST_FATE_NONE          0U
+#define TEST_FATE_LOST          1U   /* Rx FIFO was full          */
+#define TEST_FATE_FILTERED      2U   /* Software filter           */
+#define TEST_FATE_ACCEPTED      3U   /* Stored in the ring        */
+#define TEST_FATE_DROPPED       4U   /* Ring was full             */
+#define TEST_FATE_PASSED        5U   /* Accepted or dropped       */
+
+#define TEST_BENCH_LOOPS        20000U
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+  * @brief  Identifier of the simulated traffic.
+  */
+typedef struct
+{
+  uint32_t Id;
+  uint8_t  Xtd;
+  uint8_t  Fifo;      /*!< Rx FIFO the hardware filter routes it to */
+  uint8_t  Action;    /*!< Software filter action                   */
+} TEST_IdTypeDef;
+
+/**
+  * @brief  A frame sent on a simulated bus.
+  */
+typedef struct
+{
+  uint32_t Time;      /*!< CPU cycle of the start of frame */
+  uint32_t Id;
+  uint8_t  Flags;
+  uint8_t  Dlc;
+  uint8_t  Bus;
+  uint8_t  Fifo;
+  uint8_t  Action;
+  uint8_t  Fate;      /*!< TEST_FATE_xxx */
+} TEST_RecTypeDef;
+
+/**
+  * @brief  Rx FIFO of the FDCAN model.
+  */
+typedef struct
+{
+  uint32_t *pElements;
+  uint32_t  NumElements;
+  uint32_t  Watermark;    /*!< Interrupt at this fill level */
+  uint32_t  PutIdx;
+  uint32_t  GetIdx;
+  uint32_t  FillLevel;
+  uint32_t  NumLost;
+  uint8_t   IrqPending;
+} TEST_HwFifoTypeDef;
+
+/**
+  * @brief  Simulated bus with its FDCAN instance.
+  */
+typedef struct
+{
+  uint32_t           aMsgRam[TEST_MSG_RAM_WORDS];
+  TEST_HwFifoTypeDef aFifo[2];
+  CAN_StatTypeDef    Stat;
+  uint32_t           Sof;           /*!< Start of the frame on the wire */
+  uint32_t           Eof;           /*!< Its end, when it is stored     */
+  uint32_t           IdIdx;
+  uint8_t            Dlc;
+  uint8_t            Flags;
+  uint32_t           NumSent;
+} TEST_BusTypeDef;
+
+/**
+  * @brief  Receive pipeline of both buses.
+  */
+typedef struct
+{
+  TEST_BusTypeDef        aBus[TEST_NUM_BUS];
+  CAN_RingTypeDef        Ring;
+  CAN_FilterTypeDef      Filter;
+  CAN_FrameTypeDef       aFrames[TEST_RING_SIZE];
+  CAN_FilterEntryTypeDef aEntries[TEST_FILTER_SIZE];
+  TEST_RecTypeDef        aRec[TEST_MAX_FRAMES];
+  uint8_t                abReceived[TEST_MAX_FRAMES];
+  uint32_t               NumRec;
+  uint32_t               T;             /*!< Bit time */
+  int                    IsThreaded;
+  uint64_t               DrainTime_ns;
+  uint32_t               NumDrainErrors;
+} TEST_SimTypeDef;
+
+/**
+  * @brief  Consumer of the ring.
+  */
+typedef struct
+{
+  TEST_SimTypeDef *pSim;
+  uint32_t         aNextSeq[TEST_NUM_BUS][2];
+  uint32_t         NumRead;
+  uint32_t         NumBad;
+  int32_t          MaxTimeErr;
+  uint32_t         Rand;
+  int              Stop;
+} TEST_ConsumerTypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t        TEST_Rand = 0x2468ACE1U;
+static TEST_IdTypeDef  TEST_aId[TEST_NUM_IDS];
+static TEST_SimTypeDef TEST_Sim;
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Returns the monotonic host time in nanoseconds.
+  */
+static uint64_t TEST_GetTime_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+/**
+  * @brief  Xorshift pseudo random generator.
+  */
+static uint32_t TEST_GetRandFrom(uint32_t *pState)
+{
+  uint32_t x;
+
+  x = *pState;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *pState = x;
+  return x;
+}
+
+static uint32_t TEST_GetRand(void)
+{
+  return TEST_GetRandFrom(&TEST_Rand);
+}
+
+/**
+  * @brief  Returns a random filter key, standard or extended.
+  */
+static uint32_t TEST_GetRandKey(void)
+{
+  if ((TEST_GetRand() & 1U) != 0U)
+  {
+    return TEST_GetRand() & 0x7FFU;
+  }
+  return (TEST_GetRand() & CAN_ELEM_R0_ID_MSK) | CAN_FILTER_KEY_XTD;
+}
+
+/**
+  * @brief  Returns the position of a key in a list, Num if it is not in it.
+  */
+static uint32_t TEST_FindKey(const uint32_t *pKeys, uint32_t Num, uint32_t Key)
+{
+  uint32_t i;
+
+  for (i = 0; i < Num; i++)
+  {
+    if (pKeys[i] == Key)
+    {
+      break;
+    }
+  }
+  return i;
+}
+
+/**
+  * @brief  Checks the parameter checks of the ring and the filter, fills
+  *         filters of several sizes up to the load limit and compares every
+  *         lookup with the list of keys set.
+  */
+static void TEST_Filter(void)
+{
+  static const uint32_t  aSize[] = { 4U, 16U, 256U, 1024U };
+  static CAN_FilterEntryTypeDef aEntries[1024];
+  static CAN_FrameTypeDef       aFrames[4];
+  static uint32_t        aKey[1024];
+  static uint8_t         aAction[1024];
+  CAN_FilterTypeDef      Filter;
+  CAN_RingTypeDef        Ring;
+  uint32_t               Cap;
+  uint32_t               NumKeys;
+  uint32_t               Key;
+  uint32_t               s;
+  uint32_t               i;
+
+  TEST_CHECK_EQ(CAN_RING_Init(&Ring, aFrames, 0), -1);
+  TEST_CHECK_EQ(CAN_RING_Init(&Ring, aFrames, 3), -1);
+  TEST_CHECK_EQ(CAN_RING_Init(&Ring, aFrames, 4), 0);
+  TEST_CHECK_EQ(CAN_RING_GetCount(&Ring), 0);
+  TEST_CHECK_EQ(CAN_RING_Get(&Ring, aFrames, 4), 0);
+  TEST_CHECK_EQ(CAN_FILTER_Init(&Filter, aEntries, 0, CAN_FILTER_ACCEPT), -1);
+  TEST_CHECK_EQ(CAN_FILTER_Init(&Filter, aEntries, 2, CAN_FILTER_ACCEPT), -1);
+  TEST_CHECK_EQ(CAN_FILTER_Init(&Filter, aEntries, 12, CAN_FILTER_ACCEPT), -1);
+
+  for (s = 0; s < (sizeof(aSize) / sizeof(aSize[0])); s++)
+  {
+    TEST_CHECK_EQ(CAN_FILTER_Init(&Filter, aEntries, aSize[s], 0x5A), 0);
+    Cap = (aSize[s] / 4U) * 3U;
+
+    /* Same number as standard and extended identifier, bits above 29 ignored */
+    TEST_CHECK_EQ(CAN_FILTER_Set(&Filter, 0x123U, 0, 7), 0);
+    TEST_CHECK_EQ(CAN_FILTER_Set(&Filter, 0xE0000123U, 1, 9), 0);
+    aKey[0]    = CAN_FILTER_KEY(0x123U, 0);
+    aAction[0] = 7;
+    aKey[1]    = CAN_FILTER_KEY(0x123U, 1);
+    aAction[1] = 9;
+    NumKeys    = 2;
+    TEST_CHECK_EQ(CAN_FILTER_Lookup(&Filter, aKey[0]), 7);
+    TEST_CHECK_EQ(CAN_FILTER_Lookup(&Filter, aKey[1]), 9);
+
+    for (;;)
+    {
+      do
+      {
+        Key = TEST_GetRandKey();
+      } while (TEST_FindKey(aKey, NumKeys, Key) != NumKeys);
+      if (CAN_FILTER_Set(&Filter, Key & CAN_ELEM_R0_ID_MSK, (Key & CAN_FILTER_KEY_XTD) != 0U,
+                         (uint8_t)(Key >> 3)) != 0)
+      {
+        break;
+      }
+      aKey[NumKeys]    = Key;
+      aAction[NumKeys] = (uint8_t)(Key >> 3);
+      NumKeys++;
+    }
+    TEST_CHECK_EQ(NumKeys, Cap);
+    TEST_CHECK_EQ(Filter.NumUsed, Cap);
+
+    /* A full table still takes new actions for its keys */
+    for (i = 0; i < NumKeys; i++)
+    {
+      aAction[i] = (uint8_t)TEST_GetRand();
+      TEST_CHECK_EQ(CAN_FILTER_Set(&Filter, aKey[i] & CAN_ELEM_R0_ID_MSK, (aKey[i] & CAN_FILTER_KEY_XTD) != 0U,
+                                   aAction[i]), 0);
+    }
+    TEST_CHECK_EQ(Filter.NumUsed, Cap);
+    for (i = 0; i < NumKeys; i++)
+    {
+      TEST_CHECK_EQ(CAN_FILTER_Lookup(&Filter, aKey[i]), aAction[i]);
+    }
+    for (i = 0; i < 1000U; i++)
+    {
+      Key = TEST_GetRandKey();
+      if (TEST_FindKey(aKey, NumKeys, Key) == NumKeys)
+      {
+        TEST_CHECK_EQ(CAN_FILTER_Lookup(&Filter, Key), 0x5A);
+      }
+    }
+  }
+}
+
+/**
+  * @brief  Drains a single element with the oldest possible timestamp, both
+  *         counters having wrapped since, and returns the cycles it is
+  *         dated back.
+  */
+static uint32_t TEST_ConvertOldest(uint32_t CyclesPerTsQ16)
+{
+  static uint32_t    aElem[TEST_ELEM_WORDS];
+  CAN_FrameTypeDef   Frame;
+  CAN_RingTypeDef    Ring;
+  CAN_FilterTypeDef  Filter;
+  CAN_FilterEntryTypeDef aEntries[4];
+  CAN_FifoTypeDef    Fifo;
+  CAN_TimeRefTypeDef Time;
+  CAN_StatTypeDef    Stat;
+
+  memset(&Stat, 0, sizeof(Stat));
+  (void)CAN_RING_Init(&Ring, &Frame, 1);
+  (void)CAN_FILTER_Init(&Filter, aEntries, 4, CAN_FILTER_ACCEPT);
+  aElem[0]            = 0x100U << CAN_ELEM_R0_STDID_POS;
+  aElem[1]            = 1U;                   /* Timestamp 1, counter now at 0 */
+  Fifo.pElements      = aElem;
+  Fifo.ElementWords   = TEST_ELEM_WORDS;
+  Fifo.NumElements    = 1;
+  Time.Now            = 100U;                 /* Cycle counter wrapped, too */
+  Time.NowTs          = 0U;
+  Time.CyclesPerTsQ16 = CyclesPerTsQ16;
+  TEST_CHECK_EQ(CAN_RING_DrainFifo(&Ring, &Filter, &Fifo, 0, 1, &Time, 0, &Stat), 1);
+  TEST_CHECK_EQ(CAN_RING_Get(&Ring, &Frame, 1), 1);
+  return Time.Now - Frame.Time;
+}
+
+/**
+  * @brief  Checks the conversion factors and the prescaler reduction for
+  *         combinations of CPU clock, kernel clock, bit rate and prescaler.
+  */
+static void TEST_TimeBase(void)
+{
+  static const uint32_t aCpuClock[] = { 64000000U, 200000000U, 240000000U };
+  static const uint32_t aCanClock[] = { 20000000U, 40000000U, 80000000U };
+  static const uint32_t aBitRate[]  = { 10000U, 20000U, 50000U, 125000U, 250000U, 500000U, 1000000U };
+  unsigned __int128     Exact;
+  uint32_t              BitClocks;
+  uint32_t              Prescaler;
+  uint32_t              MaxPrescaler;
+  uint32_t              Q16;
+  uint32_t              NumReduced;
+  uint32_t              Cycles;
+  double                Expected;
+  unsigned              c;
+  unsigned              k;
+  unsigned              b;
+
+  NumReduced = 0;
+  for (c = 0; c < (sizeof(aCpuClock) / sizeof(aCpuClock[0])); c++)
+  {
+    for (k = 0; k < (sizeof(aCanClock) / sizeof(aCanClock[0])); k++)
+    {
+      for (b = 0; b < (sizeof(aBitRate) / sizeof(aBitRate[0])); b++)
+      {
+        BitClocks = aCanClock[k] / aBitRate[b];
+        for (MaxPrescaler = 1; MaxPrescaler <= 16U; MaxPrescaler++)
+        {
+          Prescaler = MaxPrescaler;
+          Q16 = CAN_RING_GetCyclesPerTsQ16(aCpuClock[c], aCanClock[k], BitClocks, &Prescaler);
+          TEST_CHECK((Prescaler >= 1U) && (Prescaler <= MaxPrescaler));
+          Exact = (((unsigned __int128)aCpuClock[c] * BitClocks * Prescaler) << 16) / aCanClock[k];
+          TEST_CHECK(Exact < ((unsigned __int128)1 << 32));
+          TEST_CHECK_EQ(Q16, (uint32_t)Exact);
+          if (Prescaler < MaxPrescaler)
+          {
+            /* The next larger prescaler must really overflow */
+            Exact = (((unsigned __int128)aCpuClock[c] * BitClocks * (Prescaler + 1U)) << 16) / aCanClock[k];
+            TEST_CHECK(Exact >= ((unsigned __int128)1 << 32));
+            NumReduced++;
+          }
+          /* The oldest timestamp is dated back to within 2 cycles */
+          Cycles   = TEST_ConvertOldest(Q16);
+          Expected = 65535.0 * aCpuClock[c] * BitClocks * Prescaler / aCanClock[k];
+          TEST_CHECK(((double)Cycles <= Expected) && ((double)Cycles > (Expected - 2.0)));
+        }
+      }
+    }
+  }
+  TEST_CHECK(NumReduced > 0U);
+  Prescaler = 16;
+  TEST_CHECK_EQ(CAN_RING_GetCyclesPerTsQ16(TEST_CPU_CLOCK, 0, TEST_BIT_CLOCKS, &Prescaler), 0);
+}
+
+/**
+  * @brief  Builds the identifiers of the traffic and the software filter.
+  * @param  pSim: Pipeline.
+  * @param  DefaultAction: Action of identifiers without filter entry.
+  */
+static void TEST_SetupIds(TEST_SimTypeDef *pSim, uint8_t DefaultAction)
+{
+  uint32_t aKey[TEST_NUM_IDS];
+  uint32_t Key;
+  uint32_t i;
+
+  TEST_CHECK_EQ(CAN_FILTER_Init(&pSim->Filter, pSim->aEntries, TEST_FILTER_SIZE, DefaultAction), 0);
+  for (i = 0; i < TEST_NUM_IDS; i++)
+  {
+    if (i < 2U)
+    {
+      Key = CAN_FILTER_KEY(0x123U, i);
+    }
+    else
+    {
+      do
+      {
+        Key = TEST_GetRandKey();
+      } while (TEST_FindKey(aKey, i, Key) != i);
+    }
+    aKey[i]           = Key;
+    TEST_aId[i].Id    = Key & CAN_ELEM_R0_ID_MSK;
+    TEST_aId[i].Xtd   = (Key & CAN_FILTER_KEY_XTD) != 0U;
+    TEST_aId[i].Fifo  = ((TEST_GetRand() % 10U) == 0U) ? 1U : 0U;
+    TEST_aId[i].Action = DefaultAction;
+    if (i < TEST_NUM_LISTED)
+    {
+      TEST_aId[i].Action = ((TEST_GetRand() & 3U) == 0U) ? CAN_FILTER_DROP : (uint8_t)(1U + (TEST_GetRand() % 255U));
+      TEST_CHECK_EQ(CAN_FILTER_Set(&pSim->Filter, TEST_aId[i].Id, TEST_aId[i].Xtd, TEST_aId[i].Action), 0);
+    }
+  }
+}
+
+/**
+  * @brief  Starts the next frame of a bus: back to back in bursts, with
+  *         random gaps otherwise.
+  */
+static void TEST_NextFrame(TEST_BusTypeDef *pBus, uint32_t Idle)
+{
+  uint32_t Bits;
+
+  pBus->IdIdx = TEST_GetRand() % TEST_NUM_IDS;
+  pBus->Dlc   = (uint8_t)(TEST_GetRand() % 9U);
+  pBus->Flags = 0;
+  if (TEST_aId[pBus->IdIdx].Xtd != 0U)
+  {
+    pBus->Flags |= CAN_FRAME_XTD;
+  }
+  if ((TEST_GetRand() % 32U) == 0U)
+  {
+    pBus->Flags |= CAN_FRAME_RTR;
+  }
+  if ((TEST_GetRand() % 64U) == 0U)
+  {
+    pBus->Flags |= CAN_FRAME_ESI;
+  }
+  /* Frame with stuff bits, intermission */
+  Bits = (TEST_aId[pBus->IdIdx].Xtd != 0U) ? 67U : 47U;
+  if ((pBus->Flags & CAN_FRAME_RTR) == 0U)
+  {
+    Bits += 8U * pBus->Dlc;
+  }
+  Bits += Bits / 10U;
+  pBus->Sof = Idle + 3U;
+  if ((TEST_GetRand() & 3U) == 0U)
+  {
+    pBus->Sof += TEST_GetRand() % 200U;
+  }
+  pBus->Eof = pBus->Sof + Bits;
+}
+
+/**
+  * @brief  Stores the frame that ends now in its Rx FIFO, as the FDCAN does.
+  *         The data words always carry the sequence number of the frame.
+  */
+static void TEST_Receive(TEST_SimTypeDef *pSim, uint32_t Bus)
+{
+  TEST_BusTypeDef    *pBus;
+  TEST_HwFifoTypeDef *pFifo;
+  TEST_RecTypeDef    *pRec;
+  const TEST_IdTypeDef *pId;
+  uint32_t           *pElem;
+  uint32_t            Seq;
+
+  pBus = &pSim->aBus[Bus];
+  pId  = &TEST_aId[pBus->IdIdx];
+  Seq  = pSim->NumRec++;
+  pRec = &pSim->aRec[Seq];
+  pRec->Time   = TEST_T0 + (pBus->Sof * TEST_CYCLES_PER_BIT);
+  pRec->Id     = pId->Id;
+  pRec->Flags  = pBus->Flags;
+  pRec->Dlc    = pBus->Dlc;
+  pRec->Bus    = (uint8_t)Bus;
+  pRec->Fifo   = pId->Fifo;
+  pRec->Action = pId->Action;
+  pRec->Fate   = TEST_FATE_NONE;
+  pBus->NumSent++;
+
+  pFifo = &pBus->aFifo[pId->Fifo];
+  if (pFifo->FillLevel == pFifo->NumElements)
+  {
+    pFifo->NumLost++;
+    pFifo->IrqPending = 1;
+    pRec->Fate = TEST_FATE_LOST;
+  }
+  else
+  {
+    pElem    = pFifo->pElements + (pFifo->PutIdx * TEST_ELEM_WORDS);
+    pElem[0] = (pId->Xtd != 0U) ? (pId->Id | CAN_ELEM_R0_XTD) : (pId->Id << CAN_ELEM_R0_STDID_POS);
+    if ((pBus->Flags & CAN_FRAME_RTR) != 0U)
+    {
+      pElem[0] |= CAN_ELEM_R0_RTR;
+    }
+    if ((pBus->Flags & CAN_FRAME_ESI) != 0U)
+    {
+      pElem[0] |= CAN_ELEM_R0_ESI;
+    }
+    /* Filter index and ANMF bits set to check that they are masked */
+    pElem[1] = (TEST_GetRand() & 0xFF000000U) | ((uint32_t)pBus->Dlc << CAN_ELEM_R1_DLC_POS) |
+               ((pBus->Sof / TEST_TS_PRESCALER) & CAN_ELEM_R1_RXTS_MSK);
+    pElem[2] = Seq;
+    pElem[3] = Seq ^ TEST_DATA_XOR;
+    pFifo->PutIdx = (pFifo->PutIdx + 1U) % pFifo->NumElements;
+    pFifo->FillLevel++;
+    if (pFifo->FillLevel == pFifo->Watermark)
+    {
+      pFifo->IrqPending = 1;
+    }
+  }
+  TEST_NextFrame(pBus, pBus->Eof);
+}
+
+/**
+  * @brief  Takes all elements of one Rx FIFO into the ring and acknowledges
+  *         them like CAN_RX_Drain(). Checks the counters of the drain
+  *         against the elements taken and the free space of the ring.
+  */
+static void TEST_Drain(TEST_SimTypeDef *pSim, uint32_t Bus, uint32_t Fifo)
+{
+  TEST_BusTypeDef    *pBus;
+  TEST_HwFifoTypeDef *pHw;
+  TEST_RecTypeDef    *pRec;
+  CAN_FifoTypeDef     Desc;
+  CAN_TimeRefTypeDef  Time;
+  CAN_StatTypeDef     Before;
+  uint32_t            aSeq[TEST_FIFO0_SIZE];
+  uint32_t            NumPassed;
+  uint32_t            NumAccepted;
+  uint32_t            NumFree;
+  uint32_t            Ack;
+  uint32_t            Fill;
+  uint32_t            n;
+  uint32_t            i;
+  uint64_t            t;
+
+  pBus = &pSim->aBus[Bus];
+  pHw  = &pBus->aFifo[Fifo];
+  Fill = pHw->FillLevel;
+  if (Fill == 0U)
+  {
+    return;
+  }
+  NumPassed = 0;
+  for (i = 0; i < Fill; i++)
+  {
+    aSeq[i] = pHw->pElements[((pHw->GetIdx + i) % pHw->NumElements) * TEST_ELEM_WORDS + 2U];
+    if (pSim->aRec[aSeq[i]].Action != CAN_FILTER_DROP)
+    {
+      NumPassed++;
+    }
+  }
+  Desc.pElements      = pHw->pElements;
+  Desc.ElementWords   = TEST_ELEM_WORDS;
+  Desc.NumElements    = pHw->NumElements;
+  Time.Now            = TEST_T0 + (pSim->T * TEST_CYCLES_PER_BIT) + (TEST_GetRand() % TEST_CYCLES_PER_BIT);
+  Time.NowTs          = (pSim->T / TEST_TS_PRESCALER) & CAN_ELEM_R1_RXTS_MSK;
+  Time.CyclesPerTsQ16 = TEST_CYCLES_PER_TICK << 16;
+  Before              = pBus->Stat;
+  /* The consumer only makes room, so this is a lower bound */
+  NumFree = TEST_RING_SIZE - CAN_RING_GetCount(&pSim->Ring);
+
+  t = TEST_GetTime_ns();
+  n = CAN_RING_DrainFifo(&pSim->Ring, &pSim->Filter, &Desc, pHw->GetIdx, Fill, &Time, (uint8_t)Bus, &pBus->Stat);
+  pSim->DrainTime_ns += TEST_GetTime_ns() - t;
+
+  /* Acknowledging the last element frees all elements up to it */
+  Ack = (pHw->GetIdx + n - 1U) % pHw->NumElements;
+  if ((n != Fill) || (((Ack + pHw->NumElements - pHw->GetIdx) % pHw->NumElements) >= Fill))
+  {
+    pSim->NumDrainErrors++;
+  }
+  pHw->FillLevel -= ((Ack + pHw->NumElements - pHw->GetIdx) % pHw->NumElements) + 1U;
+  pHw->GetIdx     = (Ack + 1U) % pHw->NumElements;
+  if (pHw->FillLevel != 0U)
+  {
+    pSim->NumDrainErrors++;
+  }
+
+  NumAccepted = pBus->Stat.NumAccepted - Before.NumAccepted;
+  if (((pBus->Stat.NumReceived - Before.NumReceived) != n) ||
+      ((pBus->Stat.NumFiltered - Before.NumFiltered) != (n - NumPassed)) ||
+      ((NumAccepted + (pBus->Stat.NumDropped - Before.NumDropped)) != NumPassed) ||
+      (NumAccepted < ((NumFree < NumPassed) ? NumFree : NumPassed)) ||
+      ((pSim->IsThreaded == 0) && (NumAccepted != ((NumFree < NumPassed) ? NumFree : NumPassed))) ||
+      ((pBus->Stat.NumBatches - Before.NumBatches) != 1U))
+  {
+    pSim->NumDrainErrors++;
+  }
+
+  /* The first frames that pass the filter fill the free space */
+  for (i = 0; i < n; i++)
+  {
+    pRec = &pSim->aRec[aSeq[i]];
+    if (pRec->Action == CAN_FILTER_DROP)
+    {
+      pRec->Fate = TEST_FATE_FILTERED;
+    }
+    else if (pSim->IsThreaded != 0)
+    {
+      pRec->Fate = TEST_FATE_PASSED;
+    }
+    else
+    {
+      pRec->Fate = (NumAccepted != 0U) ? TEST_FATE_ACCEPTED : TEST_FATE_DROPPED;
+      if (NumAccepted != 0U)
+      {
+        NumAccepted--;
+      }
+    }
+  }
+}
+
+/**
+  * @brief  Compares a frame read from the ring with the frame sent.
+  */
+static void TEST_CheckFrame(TEST_ConsumerTypeDef *pCons, const CAN_FrameTypeDef *pFrame)
+{
+  TEST_SimTypeDef       *pSim;
+  const TEST_RecTypeDef *pRec;
+  uint32_t               Seq;
+  uint32_t               Check;
+  int32_t                Err;
+
+  pSim = pCons->pSim;
+  memcpy(&Seq, &pFrame->aData[0], sizeof(Seq));
+  memcpy(&Check, &pFrame->aData[4], sizeof(Check));
+  if ((Seq >= TEST_MAX_FRAMES) || (Check != (Seq ^ TEST_DATA_XOR)) || (pFrame->Bus >= TEST_NUM_BUS))
+  {
+    if (pCons->NumBad++ == 0U)
+    {
+      printf("Frame %lu: corrupted data\n", (unsigned long)pCons->NumRead);
+    }
+    return;
+  }
+  pRec = &pSim->aRec[Seq];
+  /* Dated back from the drain to within one timestamp tick of the start of frame */
+  Err = (int32_t)(pFrame->Time - pRec->Time);
+  if ((pFrame->Id != pRec->Id) || (pFrame->Flags != pRec->Flags) || (pFrame->Dlc != pRec->Dlc) ||
+      (pFrame->Bus != pRec->Bus) || (pFrame->Tag != pRec->Action) ||
+      (Err <= -(int32_t)TEST_CYCLES_PER_TICK) || (Err >= (int32_t)(TEST_CYCLES_PER_TICK + TEST_CYCLES_PER_BIT)) ||
+      (Seq < pCons->aNextSeq[pRec->Bus][pRec->Fifo]) || (pSim->abReceived[Seq] != 0U) ||
+      ((pSim->IsThreaded == 0) && (pRec->Fate != TEST_FATE_ACCEPTED)))
+  {
+    if (pCons->NumBad++ == 0U)
+    {
+      printf("Frame %lu (sequence %lu): Id %lx/%lx, Flags %u/%u, Dlc %u/%u, Bus %u/%u, Tag %u/%u, "
+             "time error %ld, fate %u\n",
+             (unsigned long)pCons->NumRead, (unsigned long)Seq, (unsigned long)pFrame->Id, (unsigned long)pRec->Id,
+             pFrame->Flags, pRec->Flags, pFrame->Dlc, pRec->Dlc, pFrame->Bus, pRec->Bus,
+             pFrame->Tag, pRec->Action, (long)Err, pRec->Fate);
+    }
+  }
+  if (Err < 0)
+  {
+    Err = -Err;
+  }
+  if (Err > pCons->MaxTimeErr)
+  {
+    pCons->MaxTimeErr = Err;
+  }
+  pCons->aNextSeq[pRec->Bus][pRec->Fifo] = Seq + 1U;
+  pSim->abReceived[Seq] = 1;
+  pCons->NumRead++;
+}
+
+/**
+  * @brief  Reads up to MaxFrames from the ring and checks them.
+  * @retval Number of frames read.
+  */
+static uint32_t TEST_Consume(TEST_ConsumerTypeDef *pCons, uint32_t MaxFrames)
+{
+  CAN_FrameTypeDef aFrame[32];
+  uint32_t         NumTotal;
+  uint32_t         n;
+  uint32_t         i;
+
+  NumTotal = 0;
+  while (NumTotal < MaxFrames)
+  {
+    n = MaxFrames - NumTotal;
+    n = CAN_RING_Get(&pCons->pSim->Ring, aFrame, (n < 32U) ? n : 32U);
+    if (n == 0U)
+    {
+      break;
+    }
+    for (i = 0; i < n; i++)
+    {
+      TEST_CheckFrame(pCons, &aFrame[i]);
+    }
+    NumTotal += n;
+  }
+  return NumTotal;
+}
+
+/**
+  * @brief  Consumer thread: reads random amounts and stalls at times.
+  */
+static void *TEST_ConsumerThread(void *p)
+{
+  TEST_ConsumerTypeDef *pCons;
+  struct timespec       ts;
+
+  pCons = (TEST_ConsumerTypeDef *)p;
+  while (__atomic_load_n(&pCons->Stop, __ATOMIC_ACQUIRE) == 0)
+  {
+    (void)TEST_Consume(pCons, 1U + (TEST_GetRandFrom(&pCons->Rand) % 64U));
+    if ((TEST_GetRandFrom(&pCons->Rand) % 256U) == 0U)
+    {
+      ts.tv_sec  = 0;
+      ts.tv_nsec = 200000;
+      nanosleep(&ts, NULL);
+    }
+  }
+  (void)TEST_Consume(pCons, 0xFFFFFFFFU);
+  return NULL;
+}
+
+/**
+  * @brief  Runs both buses for TEST_DURATION_BITS and checks every frame.
+  * @param  IsThreaded: Zero to consume on the virtual clock, nonzero to
+  *         consume in a separate thread.
+  * @param  DefaultAction: Action of identifiers without filter entry.
+  */
+static void TEST_Pipeline(int IsThreaded, uint8_t DefaultAction)
+{
+  TEST_SimTypeDef      *pSim;
+  TEST_BusTypeDef      *pBus;
+  TEST_ConsumerTypeDef  Cons;
+  pthread_t             Thread;
+  uint32_t              aNumFiltered[TEST_NUM_BUS];
+  uint32_t              aNumLost[TEST_NUM_BUS];
+  uint32_t              NextPoll;
+  uint32_t              NextConsume;
+  uint32_t              NextMask;
+  uint32_t              MaskEnd;
+  uint32_t              NumAccepted;
+  uint32_t              NumDropped;
+  uint32_t              NumReceived;
+  uint32_t              NumBatches;
+  uint32_t              MaxBatch;
+  uint32_t              NumFates[TEST_FATE_PASSED + 1U];
+  uint32_t              Bus;
+  uint32_t              Fifo;
+  uint32_t              i;
+
+  pSim = &TEST_Sim;
+  memset(pSim, 0, sizeof(*pSim));
+  pSim->IsThreaded = IsThreaded;
+  TEST_CHECK_EQ(CAN_RING_Init(&pSim->Ring, pSim->aFrames, TEST_RING_SIZE), 0);
+  pSim->Ring.WrIdx = TEST_RING_START;
+  pSim->Ring.RdIdx = TEST_RING_START;
+  TEST_SetupIds(pSim, DefaultAction);
+  for (Bus = 0; Bus < TEST_NUM_BUS; Bus++)
+  {
+    pBus = &pSim->aBus[Bus];
+    pBus->aFifo[0].pElements   = &pBus->aMsgRam[TEST_FIFO0_OFF];
+    pBus->aFifo[0].NumElements = TEST_FIFO0_SIZE;
+    pBus->aFifo[0].Watermark   = TEST_WATERMARK;
+    pBus->aFifo[1].pElements   = &pBus->aMsgRam[TEST_FIFO1_OFF];
+    pBus->aFifo[1].NumElements = TEST_FIFO1_SIZE;
+    pBus->aFifo[1].Watermark   = 1;
+    TEST_NextFrame(pBus, Bus * 17U);
+  }
+  memset(&Cons, 0, sizeof(Cons));
+  Cons.pSim = pSim;
+  Cons.Rand = 0x9E3779B9U;
+  if (IsThreaded != 0)
+  {
+    TEST_CHECK_EQ(pthread_create(&Thread, NULL, TEST_ConsumerThread, &Cons), 0);
+  }
+
+  NextPoll    = TEST_FLUSH_BITS;
+  NextConsume = 0;
+  NextMask    = 20000U;
+  MaskEnd     = 0;
+  for (pSim->T = 0; pSim->T < TEST_DURATION_BITS; pSim->T++)
+  {
+    for (Bus = 0; Bus < TEST_NUM_BUS; Bus++)
+    {
+      if (pSim->aBus[Bus].Eof == pSim->T)
+      {
+        TEST_Receive(pSim, Bus);
+      }
+    }
+    /* Interrupts masked by other code from time to time */
+    if (pSim->T == NextMask)
+    {
+      MaskEnd  = pSim->T + (TEST_GetRand() % 15000U);
+      NextMask = MaskEnd + 20000U + (TEST_GetRand() % 60000U);
+    }
+    if (pSim->T >= MaskEnd)
+    {
+      for (Bus = 0; Bus < TEST_NUM_BUS; Bus++)
+      {
+        for (Fifo = 0; Fifo < 2U; Fifo++)
+        {
+          if (pSim->aBus[Bus].aFifo[Fifo].IrqPending != 0U)
+          {
+            pSim->aBus[Bus].aFifo[Fifo].IrqPending = 0;
+            TEST_Drain(pSim, Bus, Fifo);
+          }
+        }
+      }
+      if (pSim->T >= NextPoll)
+      {
+        NextPoll = pSim->T + TEST_FLUSH_BITS;
+        for (Bus = 0; Bus < TEST_NUM_BUS; Bus++)
+        {
+          TEST_Drain(pSim, Bus, 0);
+        }
+      }
+    }
+    /* Consumer on the virtual clock: regular reads with occasional stalls */
+    if ((IsThreaded == 0) && (pSim->T >= NextConsume))
+    {
+      (void)TEST_Consume(&Cons, 1U + (TEST_GetRand() % 64U));
+      NextConsume = pSim->T + 100U + (TEST_GetRand() % 400U);
+      if ((TEST_GetRand() % 128U) == 0U)
+      {
+        NextConsume += 20000U;
+      }
+    }
+  }
+  for (Bus = 0; Bus < TEST_NUM_BUS; Bus++)
+  {
+    TEST_Drain(pSim, Bus, 0);
+    TEST_Drain(pSim, Bus, 1);
+  }
+  if (IsThreaded != 0)
+  {
+    __atomic_store_n(&Cons.Stop, 1, __ATOMIC_RELEASE);
+    TEST_CHECK_EQ(pthread_join(Thread, NULL), 0);
+  }
+  else
+  {
+    (void)TEST_Consume(&Cons, 0xFFFFFFFFU);
+  }
+
+  /* Every frame sent is lost in a FIFO, filtered, dropped or read */
+  memset(NumFates, 0, sizeof(NumFates));
+  memset(aNumFiltered, 0, sizeof(aNumFiltered));
+  for (i = 0; i < pSim->NumRec; i++)
+  {
+    NumFates[pSim->aRec[i].Fate]++;
+    if ((pSim->aRec[i].Fate != TEST_FATE_LOST) && (pSim->aRec[i].Action == CAN_FILTER_DROP))
+    {
+      aNumFiltered[pSim->aRec[i].Bus]++;
+    }
+  }
+  TEST_CHECK_EQ(NumFates[TEST_FATE_NONE], 0);
+  NumAccepted = 0;
+  NumDropped  = 0;
+  NumReceived = 0;
+  NumBatches  = 0;
+  MaxBatch    = 0;
+  for (Bus = 0; Bus < TEST_NUM_BUS; Bus++)
+  {
+    pBus = &pSim->aBus[Bus];
+    aNumLost[Bus] = pBus->aFifo[0].NumLost + pBus->aFifo[1].NumLost;
+    TEST_CHECK_EQ(pBus->Stat.NumReceived, pBus->NumSent - aNumLost[Bus]);
+    TEST_CHECK_EQ(pBus->Stat.NumAccepted + pBus->Stat.NumFiltered + pBus->Stat.NumDropped, pBus->Stat.NumReceived);
+    TEST_CHECK_EQ(pBus->Stat.NumFiltered, aNumFiltered[Bus]);
+    TEST_CHECK(pBus->Stat.MaxBatch <= TEST_FIFO0_SIZE);
+    TEST_CHECK(aNumLost[Bus] > 0U);
+    NumAccepted += pBus->Stat.NumAccepted;
+    NumDropped  += pBus->Stat.NumDropped;
+    NumReceived += pBus->Stat.NumReceived;
+    NumBatches  += pBus->Stat.NumBatches;
+    if (pBus->Stat.MaxBatch > MaxBatch)
+    {
+      MaxBatch = pBus->Stat.MaxBatch;
+    }
+  }
+  TEST_CHECK_EQ(NumFates[TEST_FATE_LOST], aNumLost[0] + aNumLost[1]);
+  TEST_CHECK_EQ(pSim->NumDrainErrors, 0);
+  TEST_CHECK_EQ(Cons.NumBad, 0);
+  TEST_CHECK_EQ(Cons.NumRead, NumAccepted);
+  TEST_CHECK_EQ(CAN_RING_GetCount(&pSim->Ring), 0);
+  TEST_CHECK(pSim->Ring.WrIdx < TEST_RING_START);
+  if (IsThreaded == 0)
+  {
+    /* Exactly the frames that found room were read */
+    TEST_CHECK_EQ(NumFates[TEST_FATE_ACCEPTED], NumAccepted);
+    TEST_CHECK_EQ(NumFates[TEST_FATE_DROPPED], NumDropped);
+    TEST_CHECK(NumDropped > 0U);
+    for (i = 0; i < pSim->NumRec; i++)
+    {
+      if ((pSim->aRec[i].Fate == TEST_FATE_ACCEPTED) != (pSim->abReceived[i] != 0U))
+      {
+        TEST_CHECK_EQ(i, pSim->NumRec);
+        break;
+      }
+    }
+  }
+  printf("%s consumer: %lu frames, %lu lost in the FIFOs, %lu filtered, %lu dropped, %lu read\n",
+         (IsThreaded != 0) ? "Threaded" : "Virtual", (unsigned long)pSim->NumRec,
+         (unsigned long)(aNumLost[0] + aNumLost[1]), (unsigned long)(NumFates[TEST_FATE_FILTERED]),
+         (unsigned long)NumDropped, (unsigned long)Cons.NumRead);
+  printf("  %lu drains, %.1f frames per drain, at most %lu, %.1f ns per frame, time stamps within %ld cycles\n",
+         (unsigned long)NumBatches, (double)NumReceived / (double)NumBatches, (unsigned long)MaxBatch,
+         (double)pSim->DrainTime_ns / (double)NumReceived, (long)Cons.MaxTimeErr);
+}
+
+/**
+  * @brief  Measures the drain cost per frame of a full FIFO0, taken in one
+  *         batch as on a watermark interrupt and one element per call as
+  *         with an interrupt per frame.
+  */
+static void TEST_Bench(void)
+{
+  static uint32_t        aElem[TEST_FIFO0_SIZE * TEST_ELEM_WORDS];
+  static CAN_FrameTypeDef aFrames[TEST_FIFO0_SIZE];
+  static CAN_FrameTypeDef aOut[TEST_FIFO0_SIZE];
+  CAN_FilterEntryTypeDef aEntries[TEST_FILTER_SIZE];
+  CAN_RingTypeDef        Ring;
+  CAN_FilterTypeDef      Filter;
+  CAN_FifoTypeDef        Fifo;
+  CAN_TimeRefTypeDef     Time;
+  CAN_StatTypeDef        Stat;
+  uint64_t               t;
+  uint64_t               aTime_ns[2];
+  uint32_t               Loop;
+  uint32_t               Mode;
+  uint32_t               i;
+
+  (void)CAN_RING_Init(&Ring, aFrames, TEST_FIFO0_SIZE);
+  (void)CAN_FILTER_Init(&Filter, aEntries, TEST_FILTER_SIZE, CAN_FILTER_DROP);
+  for (i = 0; i < TEST_FIFO0_SIZE; i++)
+  {
+    aElem[i * TEST_ELEM_WORDS]      = (0x100U + (i % 32U)) << CAN_ELEM_R0_STDID_POS;
+    aElem[i * TEST_ELEM_WORDS + 1U] = (8U << CAN_ELEM_R1_DLC_POS) | i;
+    aElem[i * TEST_ELEM_WORDS + 2U] = i;
+    aElem[i * TEST_ELEM_WORDS + 3U] = ~i;
+    if (i < 32U)
+    {
+      (void)CAN_FILTER_Set(&Filter, 0x100U + i, 0, (uint8_t)(1U + i));
+    }
+  }
+  Fifo.pElements      = aElem;
+  Fifo.ElementWords   = TEST_ELEM_WORDS;
+  Fifo.NumElements    = TEST_FIFO0_SIZE;
+  Time.Now            = 0;
+  Time.NowTs          = TEST_FIFO0_SIZE;
+  Time.CyclesPerTsQ16 = TEST_CYCLES_PER_TICK << 16;
+  memset(&Stat, 0, sizeof(Stat));
+  for (Mode = 0; Mode < 2U; Mode++)
+  {
+    t = TEST_GetTime_ns();
+    for (Loop = 0; Loop < TEST_BENCH_LOOPS; Loop++)
+    {
+      if (Mode == 0U)
+      {
+        (void)CAN_RING_DrainFifo(&Ring, &Filter, &Fifo, 0, TEST_FIFO0_SIZE, &Time, 0, &Stat);
+      }
+      else
+      {
+        for (i = 0; i < TEST_FIFO0_SIZE; i++)
+        {
+          (void)CAN_RING_DrainFifo(&Ring, &Filter, &Fifo, i, 1, &Time, 0, &Stat);
+        }
+      }
+      (void)CAN_RING_Get(&Ring, aOut, TEST_FIFO0_SIZE);
+    }
+    aTime_ns[Mode] = TEST_GetTime_ns() - t;
+  }
+  TEST_CHECK_EQ(Stat.NumAccepted, 2U * TEST_BENCH_LOOPS * TEST_FIFO0_SIZE);
+  TEST_CHECK_EQ(Stat.NumBatches, TEST_BENCH_LOOPS * (1U + TEST_FIFO0_SIZE));
+  TEST_CHECK_EQ(aOut[TEST_FIFO0_SIZE - 1U].Tag, 32U);
+  printf("Drain of %u elements: %.1f ns per frame in one batch, %.1f ns per frame one by one\n",
+         TEST_FIFO0_SIZE, (double)aTime_ns[0] / (TEST_BENCH_LOOPS * TEST_FIFO0_SIZE),
+         (double)aTime_ns[1] / (TEST_BENCH_LOOPS * TEST_FIFO0_SIZE));
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Runs the test.
+  */
+int main(void)
+{
+  TEST_Filter();
+  TEST_TimeBase();
+  TEST_Pipeline(0, CAN_FILTER_ACCEPT);
+  TEST_Pipeline(1, CAN_FILTER_DROP);
+  TEST_Bench();
+  return TEST_Report("CAN_RingTest");
+}
@@ -0,0 +1,1048 @@
+/**
+  ******************************************************************************
+  * @file    ETH_RingTest.c
+  * @brief   Host test of the Ethernet buffer pool and descriptor rings
+  *          (eth_ring.c).
+  *
+  *          1. Parameter checks, and RX descriptors written back by hand:
+  *             error summary, inconsistent packet lengths, packets of more
+  *             than ETH_RING_MAX_SEGS buffers, a packet still being
+  *             received and the poll budget.
+  *          2. A model of the STM32H7 Ethernet DMA runs in its own thread on
+  *             the descriptor words, as the DMA does: it receives frames of
+  *             64 bytes to 9 kB, some with errors, into the RX descriptors
+  *             it owns, stops when it finds none and resumes on a tail
+  *             pointer write; it sends the TX descriptors up to the tail
+  *             pointer and checks their layout and contents. The main
+  *             thread drives the rings like ETH_DMA_Receive() and
+  *             ETH_DMA_Transmit(), holds some packets, forwards others
+  *             without copying and sends packets from pool buffers and from
+  *             its own memory. Every packet is checked on both sides, and
+  *             no buffer may be lost or used twice.
+  *          3. Cost per packet of the RX and TX paths.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "eth_ring.h"
+#include "test_check.h"
+
+/* Private define ------------------------------------------------------------*/
+#define TEST_DESC_WORDS         6U        /* ETH_DMADescTypeDef */
+#define TEST_RX_DESC            32U       /* ETH_RX_DESC_CNT */
+#define TEST_TX_DESC            16U       /* ETH_TX_DESC_CNT */
+#define TEST_BUF_SIZE           1536U     /* ETH_DMA_BUF_SIZE */
+#define TEST_BUF_LEN            1524U     /* heth.Init.RxBuffLen */
+#define TEST_POOL_BUFS          40U       /* ETH_DMA_POOL_BUFS */
+#define TEST_IOC_INTERVAL       8U        /* ETH_DMA_RX_IOC_INTERVAL */
+#define TEST_BUDGET             16U       /* ETH_DMA_POLL_BUDGET */
+#define TEST_CALLER_BUFS        8U
+#define TEST_MAX_HELD           8U
+#define TEST_MTL_FRAMES         4U        /* Frames the receive FIFO holds */
+#define TEST_NUM_FRAMES         200000U
+#define TEST_TX_ID              0x80000000U
+#define TEST_MAX_TX             (4U * TEST_NUM_FRAMES)
+#define TEST_BENCH_LOOPS        200000U
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+  * @brief  Frame waiting in the receive FIFO of the MAC.
+  */
+typedef struct
+{
+  uint32_t Id;
+  uint32_t Length;
+  uint8_t  IsError;
+} TEST_FrameTypeDef;
+
+/**
+  * @brief  Ethernet DMA model.
+  */
+typedef struct
+{
+  /* Registers, written by the driver */
+  uint32_t          RxTailReg;
+  uint32_t          RxTailWrites;
+  uint32_t          TxTailReg;
+  /* RX */
+  TEST_FrameTypeDef aFifo[TEST_MTL_FRAMES];
+  uint32_t          FifoHead;
+  uint32_t          FifoCount;
+  uint32_t          Offset;           /*!< Bytes of the first frame written */
+  uint32_t          RxCur;
+  uint8_t           RxSuspended;
+  uint32_t          RxTailWritesAtSuspend;
+  uint32_t          NumGenerated;
+  uint32_t          NumMissed;
+  uint32_t          NumRxGood;
+  uint32_t          NumRxError;
+  uint32_t          NumRxOversize;
+  uint32_t          NumRxDesc;
+  uint32_t          NumIoc;
+  uint32_t          NumRbu;
+  /* TX */
+  uint32_t          TxCur;
+  uint32_t          TxFl;             /*!< Frame length of the packet being sent */
+  uint32_t          TxOffset;
+  uint32_t          TxId;
+  uint32_t          NumTx;
+  uint32_t          NumTxDesc;
+  /* Test */
+  uint32_t          NumErrors;
+  uint32_t          Rand;
+  int               RxDone;
+  int               Stop;
+} TEST_DmaTypeDef;
+
+/**
+  * @brief  Buffer of the caller for zero-copy transmission.
+  */
+typedef struct
+{
+  uint8_t  aData[TEST_BUF_SIZE];
+  uint32_t ReleaseIdx;    /*!< Free once the TX ring head reaches it */
+  uint8_t  IsBusy;
+} TEST_CallerBufTypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t               TEST_aPoolMem[TEST_POOL_BUFS * TEST_BUF_SIZE] __attribute__((aligned(32)));
+static uint8_t              *TEST_apFree[TEST_POOL_BUFS];
+static uint8_t              *TEST_apRxBuf[TEST_RX_DESC];
+static uint8_t              *TEST_apTxBuf[TEST_TX_DESC];
+static uint32_t              TEST_aRxDesc[TEST_RX_DESC * TEST_DESC_WORDS];
+static uint32_t              TEST_aTxDesc[TEST_TX_DESC * TEST_DESC_WORDS];
+static TEST_CallerBufTypeDef TEST_aCaller[TEST_CALLER_BUFS];
+static ETH_PoolTypeDef       TEST_Pool;
+static ETH_RingTypeDef       TEST_RxRing;
+static ETH_RingTypeDef       TEST_TxRing;
+static ETH_StatTypeDef       TEST_Stat;
+static TEST_DmaTypeDef       TEST_Dma;
+static uint32_t              TEST_aTxId[TEST_MAX_TX];   /* Id of each packet submitted, in order */
+static uint8_t               TEST_abHeld[TEST_POOL_BUFS];
+static uint32_t              TEST_Rand = 0x1F2E3D4CU;
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Returns the monotonic host time in nanoseconds.
+  */
+static uint64_t TEST_GetTime_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+/**
+  * @brief  Xorshift pseudo random generator.
+  */
+static uint32_t TEST_GetRandFrom(uint32_t *pState)
+{
+  uint32_t x;
+
+  x = *pState;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *pState = x;
+  return x;
+}
+
+static uint32_t TEST_GetRand(void)
+{
+  return TEST_GetRandFrom(&TEST_Rand);
+}
+
+/**
+  * @brief  Returns byte Pos of the packet with the given id. The first four
+  *         bytes are the id, so every packet describes its own contents.
+  */
+static uint8_t TEST_GetPatternByte(uint32_t Id, uint32_t Pos)
+{
+  if (Pos < 4U)
+  {
+    return (uint8_t)(Id >> (8U * Pos));
+  }
+  return (uint8_t)(((Id * 0x9E3779B1U) ^ (Pos * 0x85EBCA6BU)) >> 24);
+}
+
+static void TEST_FillPattern(uint8_t *pData, uint32_t Id, uint32_t Pos, uint32_t NumBytes)
+{
+  uint32_t i;
+
+  for (i = 0; i < NumBytes; i++)
+  {
+    pData[i] = TEST_GetPatternByte(Id, Pos + i);
+  }
+}
+
+static int TEST_CheckPattern(const uint8_t *pData, uint32_t Id, uint32_t Pos, uint32_t NumBytes)
+{
+  uint32_t i;
+
+  for (i = 0; i < NumBytes; i++)
+  {
+    if (pData[i] != TEST_GetPatternByte(Id, Pos + i))
+    {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/**
+  * @brief  Returns the index of a pool buffer, TEST_POOL_BUFS if pBuf is not
+  *         the start of one.
+  */
+static uint32_t TEST_GetPoolIdx(const uint8_t *pBuf)
+{
+  uintptr_t Off;
+
+  Off = (uintptr_t)pBuf - (uintptr_t)TEST_aPoolMem;
+  if ((pBuf < TEST_aPoolMem) || (Off >= sizeof(TEST_aPoolMem)) || ((Off % TEST_BUF_SIZE) != 0U))
+  {
+    return TEST_POOL_BUFS;
+  }
+  return (uint32_t)(Off / TEST_BUF_SIZE);
+}
+
+/**
+  * @brief  Translates a 32 bit bus address of the DMA into a host pointer.
+  * @retval Pointer, NULL if the address is in no DMA reachable memory.
+  */
+static uint8_t *TEST_Translate(uint32_t Addr, uint32_t NumBytes)
+{
+  uint32_t Off;
+
+  Off = Addr - (uint32_t)(uintptr_t)TEST_aPoolMem;
+  if ((Off < sizeof(TEST_aPoolMem)) && ((sizeof(TEST_aPoolMem) - Off) >= NumBytes))
+  {
+    return TEST_aPoolMem + Off;
+  }
+  Off = Addr - (uint32_t)(uintptr_t)TEST_aCaller;
+  if ((Off < sizeof(TEST_aCaller)) && ((sizeof(TEST_aCaller) - Off) >= NumBytes))
+  {
+    return (uint8_t *)TEST_aCaller + Off;
+  }
+  return NULL;
+}
+
+/**
+  * @brief  Records an error of the DMA model.
+  */
+static void TEST_DmaError(TEST_DmaTypeDef *pDma, const char *sWhat, uint32_t Idx)
+{
+  if (pDma->NumErrors++ < 10U)
+  {
+    printf("DMA: %s at descriptor %lu\n", sWhat, (unsigned long)Idx);
+  }
+}
+
+/**
+  * @brief  Receive side of the DMA model: a frame arrives now and then and
+  *         one descriptor is written per call.
+  */
+static void TEST_DmaRx(TEST_DmaTypeDef *pDma)
+{
+  TEST_FrameTypeDef *pFrame;
+  volatile uint32_t *pDesc;
+  uint8_t           *pBuf;
+  uint32_t           Desc3;
+  uint32_t           Pos;
+  uint32_t           NumBytes;
+  uint32_t           NumSegs;
+  uint32_t           r;
+
+  /* Frames arrive back to back while the FIFO has room, and in bursts that overflow it */
+  if (pDma->NumGenerated < TEST_NUM_FRAMES)
+  {
+    r = TEST_GetRandFrom(&pDma->Rand);
+    if ((pDma->FifoCount < 2U) || ((r % 64U) == 0U))
+    {
+      if (pDma->FifoCount == TEST_MTL_FRAMES)
+      {
+        pDma->NumMissed++;
+      }
+      else
+      {
+        pFrame = &pDma->aFifo[(pDma->FifoHead + pDma->FifoCount) % TEST_MTL_FRAMES];
+        pFrame->Id      = pDma->NumGenerated;
+        pFrame->IsError = ((r >> 8) % 32U) == 0U;
+        r = (r >> 16) % 100U;
+        if (r < 85U)
+        {
+          pFrame->Length = 64U + (TEST_GetRandFrom(&pDma->Rand) % (1518U - 64U + 1U));
+        }
+        else if (r < 98U)
+        {
+          pFrame->Length = 1519U + (TEST_GetRandFrom(&pDma->Rand) % (ETH_RING_MAX_SEGS * TEST_BUF_LEN - 1519U + 1U));
+        }
+        else
+        {
+          pFrame->Length = (ETH_RING_MAX_SEGS * TEST_BUF_LEN) + 1U + (TEST_GetRandFrom(&pDma->Rand) % 2000U);
+        }
+        pDma->FifoCount++;
+      }
+      pDma->NumGenerated++;
+    }
+  }
+  else if (pDma->FifoCount == 0U)
+  {
+    __atomic_store_n(&pDma->RxDone, 1, __ATOMIC_RELEASE);
+  }
+  if (pDma->FifoCount == 0U)
+  {
+    return;
+  }
+
+  /* Suspended after a buffer unavailable until the next tail pointer write */
+  if (pDma->RxSuspended != 0U)
+  {
+    if (__atomic_load_n(&pDma->RxTailWrites, __ATOMIC_ACQUIRE) == pDma->RxTailWritesAtSuspend)
+    {
+      return;
+    }
+    pDma->RxSuspended = 0;
+  }
+  pDesc = &TEST_aRxDesc[(pDma->RxCur % TEST_RX_DESC) * TEST_DESC_WORDS];
+  Desc3 = __atomic_load_n(&pDesc[3], __ATOMIC_ACQUIRE);
+  if ((Desc3 & ETH_RING_DESC3_OWN) == 0U)
+  {
+    pDma->RxTailWritesAtSuspend = __atomic_load_n(&pDma->RxTailWrites, __ATOMIC_ACQUIRE);
+    /* Look again: the descriptor may have been given before the write */
+    Desc3 = __atomic_load_n(&pDesc[3], __ATOMIC_ACQUIRE);
+    if ((Desc3 & ETH_RING_DESC3_OWN) == 0U)
+    {
+      pDma->RxSuspended = 1;
+      pDma->NumRbu++;
+      return;
+    }
+  }
+  if ((Desc3 & ETH_RING_RDES3_BUF1V) == 0U)
+  {
+    TEST_DmaError(pDma, "RX buffer 1 not valid", pDma->RxCur);
+  }
+  if (((Desc3 & ETH_RING_RDES3_IOC) != 0U) != ((((pDma->RxCur % TEST_RX_DESC) + 1U) % TEST_IOC_INTERVAL) == 0U))
+  {
+    TEST_DmaError(pDma, "RX interrupt on completion misplaced", pDma->RxCur);
+  }
+  if ((Desc3 & ETH_RING_RDES3_IOC) != 0U)
+  {
+    pDma->NumIoc++;
+  }
+
+  pFrame   = &pDma->aFifo[pDma->FifoHead];
+  Pos      = pDma->Offset;
+  NumBytes = pFrame->Length - Pos;
+  if (NumBytes > TEST_BUF_LEN)
+  {
+    NumBytes = TEST_BUF_LEN;
+  }
+  pBuf = TEST_Translate(pDesc[0], TEST_BUF_LEN);
+  if ((pBuf == NULL) || (TEST_GetPoolIdx(pBuf) == TEST_POOL_BUFS))
+  {
+    TEST_DmaError(pDma, "RX buffer outside the pool", pDma->RxCur);
+  }
+  else
+  {
+    TEST_FillPattern(pBuf, pFrame->Id, Pos, NumBytes);
+  }
+
+  /* Write back: status words, then OWN cleared. PL is only valid in the last descriptor */
+  pDesc[0] = TEST_GetRandFrom(&pDma->Rand);
+  pDesc[1] = TEST_GetRandFrom(&pDma->Rand);
+  pDesc[2] = TEST_GetRandFrom(&pDma->Rand);
+  Desc3    = (Pos == 0U) ? ETH_RING_RDES3_FD : 0U;
+  pDma->Offset += NumBytes;
+  if (pDma->Offset == pFrame->Length)
+  {
+    Desc3 |= ETH_RING_RDES3_LD | pFrame->Length;
+    if (pFrame->IsError != 0U)
+    {
+      Desc3 |= ETH_RING_RDES3_ES;
+      pDma->NumRxError++;
+    }
+    else
+    {
+      NumSegs = (pFrame->Length + TEST_BUF_LEN - 1U) / TEST_BUF_LEN;
+      if (NumSegs > ETH_RING_MAX_SEGS)
+      {
+        pDma->NumRxOversize++;
+      }
+      else
+      {
+        pDma->NumRxGood++;
+      }
+    }
+    pDma->Offset   = 0;
+    pDma->FifoHead = (pDma->FifoHead + 1U) % TEST_MTL_FRAMES;
+    pDma->FifoCount--;
+  }
+  else
+  {
+    Desc3 |= TEST_GetRandFrom(&pDma->Rand) & ETH_RING_RDES3_PL_MSK;
+  }
+  __atomic_store_n(&pDesc[3], Desc3, __ATOMIC_RELEASE);
+  pDma->RxCur++;
+  pDma->NumRxDesc++;
+}
+
+/**
+  * @brief  Transmit side of the DMA model: sends one descriptor per call if
+  *         the tail pointer is ahead, and checks the packet.
+  */
+static void TEST_DmaTx(TEST_DmaTypeDef *pDma)
+{
+  volatile uint32_t *pDesc;
+  const uint8_t     *pBuf;
+  uint32_t           Tail;
+  uint32_t           Desc2;
+  uint32_t           Desc3;
+  uint32_t           Len;
+
+  pDesc = &TEST_aTxDesc[(pDma->TxCur % TEST_TX_DESC) * TEST_DESC_WORDS];
+  Tail  = __atomic_load_n(&pDma->TxTailReg, __ATOMIC_ACQUIRE);
+  if (Tail == (uint32_t)(uintptr_t)pDesc)
+  {
+    return;
+  }
+  Desc3 = __atomic_load_n(&pDesc[3], __ATOMIC_ACQUIRE);
+  if ((Desc3 & ETH_RING_DESC3_OWN) == 0U)
+  {
+    TEST_DmaError(pDma, "TX tail pointer ahead of the owned descriptors", pDma->TxCur);
+    return;
+  }
+  Desc2 = pDesc[2];
+  Len   = Desc2 & ETH_RING_TDES2_B1L_MSK;
+  if ((Desc3 & ETH_RING_TDES3_FD) != 0U)
+  {
+    if (pDma->TxFl != 0U)
+    {
+      TEST_DmaError(pDma, "TX first descriptor inside a packet", pDma->TxCur);
+    }
+    pDma->TxFl     = Desc3 & ETH_RING_TDES3_FL_MSK;
+    pDma->TxOffset = 0;
+    if ((pDma->TxFl == 0U) || (Len < 4U) || ((Desc3 & ETH_RING_TDES3_CIC_MSK) != ETH_RING_TDES3_CIC_MSK))
+    {
+      TEST_DmaError(pDma, "TX first descriptor malformed", pDma->TxCur);
+    }
+  }
+  else if (pDma->TxFl == 0U)
+  {
+    TEST_DmaError(pDma, "TX packet without first descriptor", pDma->TxCur);
+  }
+  if ((Desc2 & ETH_RING_TDES2_IOC) != 0U)
+  {
+    TEST_DmaError(pDma, "TX interrupt requested", pDma->TxCur);
+  }
+  pBuf = TEST_Translate(pDesc[0], Len);
+  if ((pBuf == NULL) || ((pDma->TxOffset + Len) > pDma->TxFl))
+  {
+    TEST_DmaError(pDma, "TX buffer invalid", pDma->TxCur);
+  }
+  else
+  {
+    if (pDma->TxOffset == 0U)
+    {
+      memcpy(&pDma->TxId, pBuf, sizeof(pDma->TxId));
+    }
+    if (TEST_CheckPattern(pBuf, pDma->TxId, pDma->TxOffset, Len) != 0)
+    {
+      TEST_DmaError(pDma, "TX data corrupted", pDma->TxCur);
+    }
+    pDma->TxOffset += Len;
+  }
+  if ((Desc3 & ETH_RING_TDES3_LD) != 0U)
+  {
+    if ((pDma->TxOffset != pDma->TxFl) || (pDma->NumTx >= TEST_MAX_TX) || (TEST_aTxId[pDma->NumTx] != pDma->TxId))
+    {
+      TEST_DmaError(pDma, "TX packet length or order wrong", pDma->TxCur);
+    }
+    pDma->TxFl = 0;
+    pDma->NumTx++;
+  }
+  /* Write back */
+  __atomic_store_n(&pDesc[3], Desc3 & (ETH_RING_TDES3_FD | ETH_RING_TDES3_LD), __ATOMIC_RELEASE);
+  pDma->TxCur++;
+  pDma->NumTxDesc++;
+}
+
+/**
+  * @brief  DMA thread.
+  */
+static void *TEST_DmaThread(void *p)
+{
+  TEST_DmaTypeDef *pDma;
+  uint32_t         Loop;
+
+  pDma = (TEST_DmaTypeDef *)p;
+  Loop = 0;
+  while (__atomic_load_n(&pDma->Stop, __ATOMIC_ACQUIRE) == 0)
+  {
+    TEST_DmaRx(pDma);
+    TEST_DmaTx(pDma);
+    if ((++Loop % 256U) == 0U)
+    {
+      sched_yield();
+    }
+  }
+  return NULL;
+}
+
+/**
+  * @brief  Checks the parameters and RX descriptors written back by hand.
+  */
+static void TEST_Basic(void)
+{
+  ETH_PacketTypeDef aPkt[4];
+  volatile uint32_t *pDesc;
+  uint32_t          NumPosted;
+  uint32_t          i;
+
+  TEST_CHECK_EQ(ETH_POOL_Init(&TEST_Pool, NULL, TEST_BUF_SIZE, TEST_POOL_BUFS, TEST_apFree), -1);
+  TEST_CHECK_EQ(ETH_POOL_Init(&TEST_Pool, TEST_aPoolMem, 0, TEST_POOL_BUFS, TEST_apFree), -1);
+  TEST_CHECK_EQ(ETH_POOL_Init(&TEST_Pool, TEST_aPoolMem, TEST_BUF_SIZE, 0, TEST_apFree), -1);
+  TEST_CHECK_EQ(ETH_RING_Init(&TEST_RxRing, TEST_aRxDesc, 3, 8, TEST_apRxBuf, TEST_BUF_LEN, 0), -1);
+  TEST_CHECK_EQ(ETH_RING_Init(&TEST_RxRing, TEST_aRxDesc, TEST_DESC_WORDS, 12, TEST_apRxBuf, TEST_BUF_LEN, 0), -1);
+  TEST_CHECK_EQ(ETH_RING_Init(&TEST_RxRing, TEST_aRxDesc, TEST_DESC_WORDS, 0, TEST_apRxBuf, TEST_BUF_LEN, 0), -1);
+
+  /* Pool: LIFO, low water mark, ownership */
+  TEST_CHECK_EQ(ETH_POOL_Init(&TEST_Pool, TEST_aPoolMem, TEST_BUF_SIZE, TEST_POOL_BUFS, TEST_apFree), 0);
+  TEST_CHECK(ETH_POOL_Alloc(&TEST_Pool) == TEST_aPoolMem);
+  TEST_CHECK_EQ(TEST_Pool.MinFree, TEST_POOL_BUFS - 1U);
+  ETH_POOL_Free(&TEST_Pool, TEST_aPoolMem);
+  TEST_CHECK_EQ(ETH_POOL_Owns(&TEST_Pool, TEST_aPoolMem + sizeof(TEST_aPoolMem) - 1U), 1);
+  TEST_CHECK_EQ(ETH_POOL_Owns(&TEST_Pool, TEST_aPoolMem + sizeof(TEST_aPoolMem)), 0);
+  TEST_CHECK_EQ(ETH_POOL_Owns(&TEST_Pool, TEST_aCaller[0].aData), 0);
+
+  /* RX: 16 descriptors, every 4th with an interrupt */
+  TEST_CHECK_EQ(ETH_RING_Init(&TEST_RxRing, TEST_aRxDesc, TEST_DESC_WORDS, 16, TEST_apRxBuf, TEST_BUF_LEN, 4), 0);
+  memset(&TEST_Stat, 0, sizeof(TEST_Stat));
+  TEST_CHECK_EQ(ETH_RING_RxRefill(&TEST_RxRing, &TEST_Pool, &TEST_Stat), 16);
+  TEST_CHECK_EQ(ETH_RING_RxRefill(&TEST_RxRing, &TEST_Pool, &TEST_Stat), 0);
+  TEST_CHECK_EQ(TEST_Pool.NumFree, TEST_POOL_BUFS - 16U);
+  for (i = 0; i < 16U; i++)
+  {
+    pDesc = ETH_RING_GetDesc(&TEST_RxRing, i);
+    TEST_CHECK_EQ(pDesc[3], ETH_RING_DESC3_OWN | ETH_RING_RDES3_BUF1V | ((((i + 1U) % 4U) == 0U) ? ETH_RING_RDES3_IOC : 0U));
+    TEST_CHECK(TEST_Translate(pDesc[0], TEST_BUF_LEN) == TEST_apRxBuf[i]);
+  }
+  TEST_CHECK_EQ(ETH_RING_RxPending(&TEST_RxRing), 0);
+
+  /* Written back: error summary; PL 0; two buffers with PL fitting one;
+     PL beyond two buffers; five buffers; a good packet of two buffers; a
+     good one of one buffer; then a packet still being received */
+  ETH_RING_GetDesc(&TEST_RxRing, 0)[3]  = ETH_RING_RDES3_FD | ETH_RING_RDES3_LD | ETH_RING_RDES3_ES | 100U;
+  ETH_RING_GetDesc(&TEST_RxRing, 1)[3]  = ETH_RING_RDES3_FD | ETH_RING_RDES3_LD | 0U;
+  ETH_RING_GetDesc(&TEST_RxRing, 2)[3]  = ETH_RING_RDES3_FD;
+  ETH_RING_GetDesc(&TEST_RxRing, 3)[3]  = ETH_RING_RDES3_LD | 100U;
+  ETH_RING_GetDesc(&TEST_RxRing, 4)[3]  = ETH_RING_RDES3_FD;
+  ETH_RING_GetDesc(&TEST_RxRing, 5)[3]  = ETH_RING_RDES3_LD | ((2U * TEST_BUF_LEN) + 1U);
+  for (i = 6; i < 11U; i++)
+  {
+    ETH_RING_GetDesc(&TEST_RxRing, i)[3] = ((i == 6U) ? ETH_RING_RDES3_FD : 0U) |
+                                           ((i == 10U) ? (ETH_RING_RDES3_LD | (5U * TEST_BUF_LEN)) : 0U);
+  }
+  ETH_RING_GetDesc(&TEST_RxRing, 11)[3] = ETH_RING_RDES3_FD | 0x1234U;
+  ETH_RING_GetDesc(&TEST_RxRing, 12)[3] = ETH_RING_RDES3_LD | (TEST_BUF_LEN + 10U);
+  ETH_RING_GetDesc(&TEST_RxRing, 13)[3] = ETH_RING_RDES3_FD | ETH_RING_RDES3_LD | 60U;
+  ETH_RING_GetDesc(&TEST_RxRing, 14)[3] = ETH_RING_RDES3_FD;
+  TEST_CHECK_EQ(ETH_RING_RxPending(&TEST_RxRing), 1);
+
+  TEST_CHECK_EQ(ETH_RING_RxHarvest(&TEST_RxRing, &TEST_Pool, aPkt, 1, &TEST_Stat), 1);
+  TEST_CHECK_EQ(TEST_Stat.RxErrors, 5);
+  TEST_CHECK_EQ(aPkt[0].NumSegs, 2);
+  TEST_CHECK_EQ(aPkt[0].Length, TEST_BUF_LEN + 10U);
+  TEST_CHECK_EQ(aPkt[0].aSegLen[0], TEST_BUF_LEN);
+  TEST_CHECK_EQ(aPkt[0].aSegLen[1], 10);
+  TEST_CHECK(aPkt[0].apSeg[0] == TEST_Translate(ETH_RING_GetDesc(&TEST_RxRing, 11)[0], 1));
+  TEST_CHECK_EQ(TEST_RxRing.Head, 13);
+  TEST_CHECK_EQ(ETH_RING_RxHarvest(&TEST_RxRing, &TEST_Pool, &aPkt[1], 3, &TEST_Stat), 1);
+  TEST_CHECK_EQ(aPkt[1].Length, 60);
+  TEST_CHECK_EQ(aPkt[1].aSegLen[0], 60);
+  TEST_CHECK_EQ(TEST_RxRing.Head, 14);
+  TEST_CHECK_EQ(ETH_RING_RxHarvest(&TEST_RxRing, &TEST_Pool, &aPkt[2], 2, &TEST_Stat), 0);
+  TEST_CHECK_EQ(TEST_RxRing.Head, 14);
+  TEST_CHECK_EQ(TEST_Stat.RxPackets, 2);
+  TEST_CHECK_EQ(TEST_Stat.RxBytes, TEST_BUF_LEN + 10U + 60U);
+
+  /* Every buffer is in the pool, in a packet or still posted */
+  NumPosted = TEST_RxRing.Tail - TEST_RxRing.Head;
+  TEST_CHECK_EQ(TEST_Pool.NumFree + 3U + NumPosted, TEST_POOL_BUFS);
+  ETH_POOL_FreePacket(&TEST_Pool, &aPkt[0]);
+  ETH_POOL_FreePacket(&TEST_Pool, &aPkt[1]);
+  TEST_CHECK_EQ(aPkt[0].NumSegs, 0);
+  TEST_CHECK_EQ(ETH_RING_RxRefill(&TEST_RxRing, &TEST_Pool, &TEST_Stat), 14);
+  TEST_CHECK_EQ(TEST_Pool.NumFree + 16U, TEST_POOL_BUFS);
+
+  /* RX refill cut short by an empty pool */
+  TEST_CHECK_EQ(ETH_POOL_Init(&TEST_Pool, TEST_aPoolMem, TEST_BUF_SIZE, 4, TEST_apFree), 0);
+  TEST_CHECK_EQ(ETH_RING_Init(&TEST_RxRing, TEST_aRxDesc, TEST_DESC_WORDS, 8, TEST_apRxBuf, TEST_BUF_LEN, 0), 0);
+  TEST_CHECK_EQ(ETH_RING_RxRefill(&TEST_RxRing, &TEST_Pool, &TEST_Stat), 4);
+  TEST_CHECK_EQ(TEST_Stat.RxNoBuffer, 1);
+  TEST_CHECK_EQ(TEST_Pool.MinFree, 0);
+}
+
+/**
+  * @brief  Puts a packet on the TX ring and moves the tail pointer, as
+  *         ETH_DMA_Transmit() does.
+  * @retval 0 on success, -1 if the ring is full.
+  */
+static int TEST_Transmit(const ETH_PacketTypeDef *pPkt, uint32_t Id, uint32_t *pNumTx)
+{
+  if (ETH_RING_TxFree(&TEST_TxRing) < pPkt->NumSegs)
+  {
+    (void)ETH_RING_TxReclaim(&TEST_TxRing, &TEST_Pool, &TEST_Stat);
+  }
+  TEST_aTxId[*pNumTx] = Id;
+  if (ETH_RING_TxSubmit(&TEST_TxRing, pPkt, ETH_RING_TDES3_CIC_MSK, &TEST_Stat) != 0)
+  {
+    return -1;
+  }
+  (*pNumTx)++;
+  __atomic_store_n(&TEST_Dma.TxTailReg, (uint32_t)(uintptr_t)ETH_RING_GetDesc(&TEST_TxRing, TEST_TxRing.Tail),
+                   __ATOMIC_RELEASE);
+  return 0;
+}
+
+/**
+  * @brief  Builds a packet in pool buffers or in caller memory and sends it.
+  * @retval 0 if sent, -1 if there was no buffer or no descriptor.
+  */
+static int TEST_SendNew(uint32_t Id, uint32_t *pNumTx)
+{
+  ETH_PacketTypeDef      Pkt;
+  TEST_CallerBufTypeDef *apCaller[ETH_RING_MAX_SEGS];
+  uint8_t               *pBuf;
+  uint32_t               NumSegs;
+  uint32_t               Length;
+  uint32_t               c;
+  uint32_t               i;
+  int                    IsCaller;
+
+  memset(&Pkt, 0, sizeof(Pkt));
+  IsCaller = (TEST_GetRand() & 1U) != 0U;
+  NumSegs  = 1U + (TEST_GetRand() % ETH_RING_MAX_SEGS);
+  c        = 0;
+  Length   = 0;
+  for (i = 0; i < NumSegs; i++)
+  {
+    pBuf = NULL;
+    if (IsCaller != 0)
+    {
+      for (; c < TEST_CALLER_BUFS; c++)
+      {
+        if (TEST_aCaller[c].IsBusy == 0U)
+        {
+          apCaller[i] = &TEST_aCaller[c++];
+          pBuf        = apCaller[i]->aData;
+          break;
+        }
+      }
+    }
+    else
+    {
+      pBuf = ETH_POOL_Alloc(&TEST_Pool);
+    }
+    if (pBuf == NULL)
+    {
+      break;
+    }
+    /* The first buffer holds at least the header */
+    Pkt.apSeg[i]   = pBuf;
+    Pkt.aSegLen[i] = (uint16_t)((i == 0U) ? (14U + (TEST_GetRand() % 50U)) : (1U + (TEST_GetRand() % TEST_BUF_SIZE)));
+    TEST_FillPattern(pBuf, Id, Length, Pkt.aSegLen[i]);
+    Length += Pkt.aSegLen[i];
+    Pkt.NumSegs++;
+  }
+  Pkt.Length = (uint16_t)Length;
+  if ((Pkt.NumSegs == 0U) || (TEST_Transmit(&Pkt, Id, pNumTx) != 0))
+  {
+    for (i = 0; (IsCaller == 0) && (i < Pkt.NumSegs); i++)
+    {
+      ETH_POOL_Free(&TEST_Pool, Pkt.apSeg[i]);
+    }
+    return -1;
+  }
+  /* Caller memory stays busy until the DMA is done with the packet */
+  for (i = 0; (IsCaller != 0) && (i < Pkt.NumSegs); i++)
+  {
+    apCaller[i]->IsBusy     = 1;
+    apCaller[i]->ReleaseIdx = TEST_TxRing.Tail;
+  }
+  return 0;
+}
+
+/**
+  * @brief  Checks a received packet: in order, intact, laid out in full
+  *         buffers, in buffers nobody else holds.
+  * @retval 0 if good.
+  */
+static int TEST_CheckRxPacket(const ETH_PacketTypeDef *pPkt, uint32_t *pNextId)
+{
+  uint32_t Id;
+  uint32_t Pos;
+  uint32_t Idx;
+  uint32_t i;
+  int      r;
+
+  r = 0;
+  if ((pPkt->NumSegs == 0U) || (pPkt->NumSegs > ETH_RING_MAX_SEGS) || (pPkt->aSegLen[0] < 4U))
+  {
+    return -1;
+  }
+  memcpy(&Id, pPkt->apSeg[0], sizeof(Id));
+  if (Id < *pNextId)
+  {
+    r = -1;
+  }
+  *pNextId = Id + 1U;
+  Pos = 0;
+  for (i = 0; i < pPkt->NumSegs; i++)
+  {
+    Idx = TEST_GetPoolIdx(pPkt->apSeg[i]);
+    if ((Idx == TEST_POOL_BUFS) || (TEST_abHeld[Idx] != 0U) ||
+        (pPkt->aSegLen[i] != (((i + 1U) < pPkt->NumSegs) ? TEST_BUF_LEN : (pPkt->Length - Pos))) ||
+        (TEST_CheckPattern(pPkt->apSeg[i], Id, Pos, pPkt->aSegLen[i]) != 0))
+    {
+      r = -1;
+    }
+    else
+    {
+      TEST_abHeld[Idx] = 1;
+    }
+    Pos += pPkt->aSegLen[i];
+  }
+  if ((Pos != pPkt->Length) || (Pos <= ((pPkt->NumSegs - 1U) * TEST_BUF_LEN)))
+  {
+    r = -1;
+  }
+  return r;
+}
+
+/**
+  * @brief  Gives up the buffers of a received packet.
+  */
+static void TEST_Release(const ETH_PacketTypeDef *pPkt)
+{
+  uint32_t i;
+
+  for (i = 0; i < pPkt->NumSegs; i++)
+  {
+    TEST_abHeld[TEST_GetPoolIdx(pPkt->apSeg[i])] = 0;
+  }
+}
+
+/**
+  * @brief  Returns the pool buffers the TX ring still refers to.
+  */
+static uint32_t TEST_CountTxPoolBufs(void)
+{
+  uint32_t n;
+  uint32_t i;
+
+  n = 0;
+  for (i = TEST_TxRing.Head; i != TEST_TxRing.Tail; i++)
+  {
+    if (ETH_POOL_Owns(&TEST_Pool, TEST_apTxBuf[i % TEST_TX_DESC]) != 0)
+    {
+      n++;
+    }
+  }
+  return n;
+}
+
+/**
+  * @brief  Runs the rings against the DMA model thread.
+  */
+static void TEST_Traffic(void)
+{
+  ETH_PacketTypeDef aPkt[TEST_BUDGET];
+  ETH_PacketTypeDef aHeld[TEST_MAX_HELD];
+  pthread_t         Thread;
+  uint32_t          NumHeld;
+  uint32_t          NumHeldBufs;
+  uint32_t          NextId;
+  uint32_t          NumRx;
+  uint32_t          NumBad;
+  uint32_t          NumLeaks;
+  uint32_t          NumForwarded;
+  uint32_t          NumTx;
+  uint32_t          NumTxDesc;
+  uint32_t          NumPolls;
+  uint32_t          Id;
+  uint32_t          n;
+  uint32_t          s;
+  uint32_t          i;
+  uint32_t          j;
+  uint64_t          t;
+
+  memset(&TEST_Dma, 0, sizeof(TEST_Dma));
+  memset(&TEST_Stat, 0, sizeof(TEST_Stat));
+  memset(TEST_aCaller, 0, sizeof(TEST_aCaller));
+  memset(TEST_abHeld, 0, sizeof(TEST_abHeld));
+  TEST_Dma.Rand = 0xC0FFEE11U;
+  TEST_CHECK_EQ(ETH_POOL_Init(&TEST_Pool, TEST_aPoolMem, TEST_BUF_SIZE, TEST_POOL_BUFS, TEST_apFree), 0);
+  TEST_CHECK_EQ(ETH_RING_Init(&TEST_RxRing, TEST_aRxDesc, TEST_DESC_WORDS, TEST_RX_DESC, TEST_apRxBuf,
+                              TEST_BUF_LEN, TEST_IOC_INTERVAL), 0);
+  TEST_CHECK_EQ(ETH_RING_Init(&TEST_TxRing, TEST_aTxDesc, TEST_DESC_WORDS, TEST_TX_DESC, TEST_apTxBuf, 0, 0), 0);
+
+  /* ETH_DMA_Start() */
+  TEST_Dma.TxTailReg = (uint32_t)(uintptr_t)ETH_RING_GetDesc(&TEST_TxRing, 0);
+  TEST_CHECK_EQ(ETH_RING_RxRefill(&TEST_RxRing, &TEST_Pool, &TEST_Stat), TEST_RX_DESC);
+  TEST_Dma.RxTailReg = (uint32_t)(uintptr_t)ETH_RING_GetDesc(&TEST_RxRing, TEST_RxRing.Tail - 1U);
+  TEST_Dma.RxTailWrites = 1;
+  TEST_CHECK_EQ(pthread_create(&Thread, NULL, TEST_DmaThread, &TEST_Dma), 0);
+
+  NumHeld      = 0;
+  NumHeldBufs  = 0;
+  NextId       = 0;
+  NumRx        = 0;
+  NumBad       = 0;
+  NumLeaks     = 0;
+  NumForwarded = 0;
+  NumTx        = 0;
+  NumPolls     = 0;
+  t = TEST_GetTime_ns();
+  for (;;)
+  {
+    /* ETH_DMA_Receive() */
+    (void)ETH_RING_TxReclaim(&TEST_TxRing, &TEST_Pool, &TEST_Stat);
+    n = ETH_RING_RxHarvest(&TEST_RxRing, &TEST_Pool, aPkt, TEST_BUDGET, &TEST_Stat);
+    if (ETH_RING_RxRefill(&TEST_RxRing, &TEST_Pool, &TEST_Stat) != 0U)
+    {
+      __atomic_store_n(&TEST_Dma.RxTailReg,
+                       (uint32_t)(uintptr_t)ETH_RING_GetDesc(&TEST_RxRing, TEST_RxRing.Tail - 1U), __ATOMIC_RELAXED);
+      __atomic_fetch_add(&TEST_Dma.RxTailWrites, 1U, __ATOMIC_RELEASE);
+    }
+    NumPolls++;
+
+    /* Caller memory the DMA is done with */
+    for (i = 0; i < TEST_CALLER_BUFS; i++)
+    {
+      if ((TEST_aCaller[i].IsBusy != 0U) && ((int32_t)(TEST_TxRing.Head - TEST_aCaller[i].ReleaseIdx) >= 0))
+      {
+        TEST_aCaller[i].IsBusy     = 0;
+        TEST_aCaller[i].ReleaseIdx = 0;
+      }
+    }
+
+    /* Received packets are forwarded, held for a while or freed */
+    for (i = 0; i < n; i++)
+    {
+      NumRx++;
+      /* New packets at a quarter of the receive rate */
+      if (((TEST_GetRand() % 4U) == 0U) && (NumTx < (TEST_MAX_TX - 1U)))
+      {
+        (void)TEST_SendNew(TEST_TX_ID | NumTx, &NumTx);
+      }
+      if (TEST_CheckRxPacket(&aPkt[i], &NextId) != 0)
+      {
+        if (NumBad++ < 10U)
+        {
+          printf("Packet %lu: bad, %u buffers, %u bytes\n", (unsigned long)NumRx, aPkt[i].NumSegs, aPkt[i].Length);
+        }
+        continue;
+      }
+      j = TEST_GetRand() % 8U;
+      if ((j < 2U) && (NumTx < (TEST_MAX_TX - 1U)))
+      {
+        TEST_Release(&aPkt[i]);
+        memcpy(&Id, aPkt[i].apSeg[0], sizeof(Id));
+        if (TEST_Transmit(&aPkt[i], Id, &NumTx) == 0)
+        {
+          NumForwarded++;
+          continue;
+        }
+        ETH_POOL_FreePacket(&TEST_Pool, &aPkt[i]);
+      }
+      else if ((j < 4U) && (NumHeld < TEST_MAX_HELD))
+      {
+        aHeld[NumHeld++] = aPkt[i];
+        NumHeldBufs += aPkt[i].NumSegs;
+      }
+      else
+      {
+        TEST_Release(&aPkt[i]);
+        ETH_POOL_FreePacket(&TEST_Pool, &aPkt[i]);
+      }
+    }
+
+    /* Held packets must be untouched when they are given back */
+    if ((NumHeld != 0U) && ((TEST_GetRand() % 4U) == 0U))
+    {
+      j = TEST_GetRand() % NumHeld;
+      memcpy(&Id, aHeld[j].apSeg[0], sizeof(Id));
+      for (s = 0; s < aHeld[j].NumSegs; s++)
+      {
+        if (TEST_CheckPattern(aHeld[j].apSeg[s], Id, s * TEST_BUF_LEN, aHeld[j].aSegLen[s]) != 0)
+        {
+          NumBad++;
+        }
+      }
+      TEST_Release(&aHeld[j]);
+      NumHeldBufs -= aHeld[j].NumSegs;
+      ETH_POOL_FreePacket(&TEST_Pool, &aHeld[j]);
+      aHeld[j] = aHeld[--NumHeld];
+    }
+
+
+    /* No buffer lost or counted twice */
+    if ((TEST_Pool.NumFree + (TEST_RxRing.Tail - TEST_RxRing.Head) + NumHeldBufs + TEST_CountTxPoolBufs()) !=
+        TEST_POOL_BUFS)
+    {
+      NumLeaks++;
+    }
+
+    if ((__atomic_load_n(&TEST_Dma.RxDone, __ATOMIC_ACQUIRE) != 0) && (ETH_RING_RxPending(&TEST_RxRing) == 0) &&
+        (TEST_TxRing.Head == TEST_TxRing.Tail))
+    {
+      break;
+    }
+    /* Nothing received: the main loop would sleep until the next interrupt */
+    if (n == 0U)
+    {
+      sched_yield();
+    }
+  }
+  t = TEST_GetTime_ns() - t;
+  __atomic_store_n(&TEST_Dma.Stop, 1, __ATOMIC_RELEASE);
+  TEST_CHECK_EQ(pthread_join(Thread, NULL), 0);
+  for (i = 0; i < NumHeld; i++)
+  {
+    TEST_Release(&aHeld[i]);
+    ETH_POOL_FreePacket(&TEST_Pool, &aHeld[i]);
+  }
+  (void)ETH_RING_RxRefill(&TEST_RxRing, &TEST_Pool, &TEST_Stat);
+
+  /* Every frame is received, dropped for an error or missed by the MAC */
+  TEST_CHECK_EQ(TEST_Dma.NumErrors, 0);
+  TEST_CHECK_EQ(NumBad, 0);
+  TEST_CHECK_EQ(NumLeaks, 0);
+  TEST_CHECK_EQ(TEST_Dma.NumGenerated, TEST_NUM_FRAMES);
+  TEST_CHECK_EQ(TEST_Dma.NumRxGood + TEST_Dma.NumRxError + TEST_Dma.NumRxOversize + TEST_Dma.NumMissed,
+                TEST_NUM_FRAMES);
+  TEST_CHECK_EQ(NumRx, TEST_Dma.NumRxGood);
+  TEST_CHECK_EQ(TEST_Stat.RxPackets, TEST_Dma.NumRxGood);
+  TEST_CHECK_EQ(TEST_Stat.RxErrors, TEST_Dma.NumRxError + TEST_Dma.NumRxOversize);
+  TEST_CHECK(TEST_Dma.NumRxOversize > 0U);
+  TEST_CHECK_EQ(TEST_RxRing.Tail - TEST_RxRing.Head, TEST_RX_DESC);
+  TEST_CHECK_EQ(TEST_RxRing.Head, TEST_Dma.RxCur);
+  /* Every packet submitted is sent and every descriptor taken back */
+  NumTxDesc = TEST_Stat.TxCompleted;
+  TEST_CHECK_EQ(TEST_Dma.NumTx, NumTx);
+  TEST_CHECK_EQ(TEST_Stat.TxPackets, NumTx);
+  TEST_CHECK_EQ(TEST_Dma.NumTxDesc, NumTxDesc);
+  TEST_CHECK_EQ(TEST_TxRing.Tail, NumTxDesc);
+  TEST_CHECK_EQ(TEST_Pool.NumFree, TEST_POOL_BUFS - TEST_RX_DESC);
+  TEST_CHECK(NumForwarded > 0U);
+
+  printf("RX: %lu frames, %lu received, %lu with errors, %lu too long, %lu missed, %lu buffer unavailable stops\n",
+         (unsigned long)TEST_NUM_FRAMES, (unsigned long)NumRx, (unsigned long)TEST_Dma.NumRxError,
+         (unsigned long)TEST_Dma.NumRxOversize, (unsigned long)TEST_Dma.NumMissed, (unsigned long)TEST_Dma.NumRbu);
+  printf("    %lu descriptors, %lu with interrupt, %.2f packets per poll, %lu refills cut short, pool low water %lu\n",
+         (unsigned long)TEST_Dma.NumRxDesc, (unsigned long)TEST_Dma.NumIoc,
+         (double)NumRx / (double)NumPolls, (unsigned long)TEST_Stat.RxNoBuffer, (unsigned long)TEST_Pool.MinFree);
+  printf("TX: %lu packets (%lu forwarded), %lu descriptors, %lu refused for a full ring; %.1f ms\n",
+         (unsigned long)NumTx, (unsigned long)NumForwarded, (unsigned long)NumTxDesc,
+         (unsigned long)TEST_Stat.TxRingFull, (double)t / 1e6);
+}
+
+/**
+  * @brief  Measures the driver side cost per packet: RX harvest, free and
+  *         refill with the descriptors written back at once, and TX submit
+  *         and reclaim.
+  */
+static void TEST_Bench(void)
+{
+  ETH_PacketTypeDef aPkt[TEST_BUDGET];
+  ETH_PacketTypeDef Pkt;
+  uint32_t          Loop;
+  uint32_t          NumRx;
+  uint32_t          n;
+  uint32_t          i;
+  uint64_t          t;
+  uint64_t          RxTime_ns;
+  uint64_t          TxTime_ns;
+
+  memset(&TEST_Stat, 0, sizeof(TEST_Stat));
+  (void)ETH_POOL_Init(&TEST_Pool, TEST_aPoolMem, TEST_BUF_SIZE, TEST_POOL_BUFS, TEST_apFree);
+  (void)ETH_RING_Init(&TEST_RxRing, TEST_aRxDesc, TEST_DESC_WORDS, TEST_RX_DESC, TEST_apRxBuf, TEST_BUF_LEN,
+                      TEST_IOC_INTERVAL);
+  (void)ETH_RING_Init(&TEST_TxRing, TEST_aTxDesc, TEST_DESC_WORDS, TEST_TX_DESC, TEST_apTxBuf, 0, 0);
+  (void)ETH_RING_RxRefill(&TEST_RxRing, &TEST_Pool, &TEST_Stat);
+
+  NumRx = 0;
+  t = TEST_GetTime_ns();
+  for (Loop = 0; Loop < TEST_BENCH_LOOPS; Loop++)
+  {
+    for (i = TEST_RxRing.Head; i != TEST_RxRing.Tail; i++)
+    {
+      ETH_RING_GetDesc(&TEST_RxRing, i)[3] = ETH_RING_RDES3_FD | ETH_RING_RDES3_LD | 1514U;
+    }
+    n = ETH_RING_RxHarvest(&TEST_RxRing, &TEST_Pool, aPkt, TEST_BUDGET, &TEST_Stat);
+    for (i = 0; i < n; i++)
+    {
+      ETH_POOL_FreePacket(&TEST_Pool, &aPkt[i]);
+    }
+    (void)ETH_RING_RxRefill(&TEST_RxRing, &TEST_Pool, &TEST_Stat);
+    NumRx += n;
+  }
+  RxTime_ns = TEST_GetTime_ns() - t;
+  TEST_CHECK_EQ(NumRx, TEST_BENCH_LOOPS * TEST_BUDGET);
+  TEST_CHECK_EQ(TEST_Stat.RxPackets, NumRx);
+
+  memset(&Pkt, 0, sizeof(Pkt));
+  Pkt.apSeg[0]   = TEST_aCaller[0].aData;
+  Pkt.aSegLen[0] = 1514;
+  Pkt.Length     = 1514;
+  Pkt.NumSegs    = 1;
+  t = TEST_GetTime_ns();
+  for (Loop = 0; Loop < TEST_BENCH_LOOPS; Loop++)
+  {
+    while (ETH_RING_TxSubmit(&TEST_TxRing, &Pkt, 0, &TEST_Stat) == 0)
+    {
+    }
+    for (i = TEST_TxRing.Head; i != TEST_TxRing.Tail; i++)
+    {
+      ETH_RING_GetDesc(&TEST_TxRing, i)[3] &= ~ETH_RING_DESC3_OWN;
+    }
+    (void)ETH_RING_TxReclaim(&TEST_TxRing, &TEST_Pool, &TEST_Stat);
+  }
+  TxTime_ns = TEST_GetTime_ns() - t;
+  TEST_CHECK_EQ(TEST_Stat.TxPackets, TEST_BENCH_LOOPS * (TEST_TX_DESC - 1U));
+  TEST_CHECK_EQ(TEST_Stat.TxCompleted, TEST_Stat.TxPackets);
+
+  printf("Per packet: RX harvest, free and refill %.1f ns, TX submit and reclaim %.1f ns\n",
+         (double)RxTime_ns / (double)NumRx, (double)TxTime_ns / (double)TEST_Stat.TxPackets);
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Runs the test.
+  */
+int main(void)
+{
+  TEST_Basic();
+  TEST_Traffic();
+  TEST_Bench();
+  return TEST_Report("ETH_RingTest");
+}
@@ -0,0 +1,507 @@
+/**
+  ******************************************************************************
+  * @file    LP_IdleTest.c
+  * @brief   Host test of the tickless idle (lp_idle.c).
+  *
+  *          The test runs a virtual clock in units of 1 / (CPU clock x LPTIM
+  *          clock) seconds, so CPU cycles and LPTIM counts are both whole
+  *          numbers of units. LPTIM1 counts on it, the SysTick delivers
+  *          ticks on it, and the kernel tick count is a plain counter.
+  *
+  *          1. Initialization: LPTIM1 on the LSE, and on the LSI when the
+  *             LSE does not start; the longest sleep is capped to the 16-bit
+  *             counter.
+  *          2. Sleeps: random idle times, awake phases of random length,
+  *             wake ups by the compare match with a short latency, rarely a
+  *             late one, and by other interrupts before it; some sleeps are
+  *             aborted, and some start with a compare match pending from
+  *             the old compare value. After every sleep the next SysTick
+  *             interrupt is compared with the ideal tick grid: the error
+  *             must not drift, only vary by the counter resolution. The
+  *             kernel must never be stepped past the unblock time. The
+  *             statistics (sleeps, timer wakeups, late ticks, sleep time,
+  *             wake latency) are compared with the model.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "lp_idle.h"
+#include "test_check.h"
+
+/* Private function prototypes -----------------------------------------------*/
+void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime);
+
+/* Private define ------------------------------------------------------------*/
+#define TEST_CPU_CLOCK          400000000U
+#define TEST_NUM_SLEEPS         100000U
+#define TEST_MAX_IDLE_TICKS     3000U        /* Above the cap of the 16-bit counter */
+#define TEST_T0                 ((uint64_t)1 << 50)
+
+/* Private variables ---------------------------------------------------------*/
+DWT_Type       MOCK_DWT;
+CoreDebug_Type MOCK_CoreDebug;
+SCB_Type       MOCK_SCB;
+uint32_t       SystemCoreClock = TEST_CPU_CLOCK;
+uint32_t       MOCK_LseReady;
+uint32_t       MOCK_LptimClkSource;
+
+static uint32_t      TEST_Rand = 0x2468ACE1U;
+static uint32_t      TEST_LseStarts;
+static LPTIM_TypeDef TEST_Lptim;
+static uint32_t      TEST_NvicPending;
+static SysTick_Type  TEST_SysTick;
+static uint32_t      TEST_TickRunning;
+static uint64_t      TEST_T;                /* Virtual time */
+static uint64_t      TEST_NextTick;         /* Time of the next SysTick interrupt */
+static uint32_t      TEST_Clock;            /* LPTIM counts per second */
+static uint32_t      TEST_TickCount;        /* Kernel tick count */
+static uint32_t      TEST_UnblockTick;      /* Kernel must not be stepped past it */
+static uint32_t      TEST_NumStepErrors;
+static uint32_t      TEST_AbortRate;        /* 1 in n sleeps is aborted, 0 for none */
+static uint32_t      TEST_NumAborts;
+static uint32_t      TEST_WakeIsTimer;
+static uint32_t      TEST_NumPendingWakeups; /* WFI ended at once by a pending interrupt */
+static uint64_t      TEST_WakeLatency;      /* From the compare match to the wake up */
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Xorshift pseudo random generator.
+  */
+static uint32_t TEST_GetRandFrom(uint32_t *pState)
+{
+  uint32_t x;
+
+  x = *pState;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *pState = x;
+  return x;
+}
+
+static uint32_t TEST_GetRand(void)
+{
+  return TEST_GetRandFrom(&TEST_Rand);
+}
+
+static uint64_t TEST_GetRand64(uint64_t Range)
+{
+  return ((((uint64_t)TEST_GetRand()) << 32) | TEST_GetRand()) % Range;
+}
+
+/**
+  * @brief  Time units per CPU cycle and per LPTIM count.
+  */
+static uint64_t TEST_Cycle(void)
+{
+  return TEST_Clock;
+}
+
+static uint64_t TEST_Count(void)
+{
+  return TEST_CPU_CLOCK;
+}
+
+/**
+  * @brief  Advances the virtual time. A compare match on the way sets CMPM
+  *         and pends the LPTIM1 interrupt.
+  */
+static void TEST_Advance(uint64_t T)
+{
+  uint64_t c0;
+  uint64_t c1;
+  uint64_t d;
+
+  c0 = TEST_T / TEST_Count();
+  c1 = T / TEST_Count();
+  d  = (TEST_Lptim.CMP - c0) & LP_IDLE_COUNTER_MAX;
+  if (d == 0U)
+  {
+    d = LP_IDLE_COUNTER_MAX + 1U;
+  }
+  if (d <= (c1 - c0))
+  {
+    TEST_Lptim.ISR  |= LPTIM_ISR_CMPM;
+    TEST_NvicPending = 1;
+  }
+  TEST_T = T;
+}
+
+/**
+  * @brief  SysTick interrupt: one kernel tick.
+  */
+static void TEST_Tick(void)
+{
+  TEST_TickCount++;
+}
+
+/**
+  * @brief  Awake phase: runs for Duration with interrupts enabled.
+  */
+static void TEST_Run(uint64_t Duration)
+{
+  uint64_t End;
+
+  End = TEST_T + Duration;
+  while (TEST_NextTick <= End)
+  {
+    TEST_Advance(TEST_NextTick);
+    TEST_Tick();
+    TEST_NextTick += (uint64_t)(TEST_SysTick.LOAD + 1U) * TEST_Cycle();
+  }
+  TEST_Advance(End);
+  if (TEST_NvicPending != 0U)
+  {
+    TEST_NvicPending = 0;
+    LP_IDLE_IRQHandler();
+  }
+}
+
+/**
+  * @brief  Initializes the model and LPTIM1 with or without the LSE.
+  */
+static void TEST_Init(uint32_t LseStarts)
+{
+  memset(&TEST_Lptim, 0, sizeof(TEST_Lptim));
+  memset(&TEST_SysTick, 0, sizeof(TEST_SysTick));
+  TEST_NvicPending = 0;
+  TEST_T           = TEST_T0;
+  MOCK_LseReady    = 0;
+  TEST_LseStarts   = LseStarts;
+  TEST_CHECK_EQ(LP_IDLE_Init(), 0);
+  TEST_Clock = LP_IDLE_GetClock();
+  TEST_CHECK_EQ(TEST_Clock, (LseStarts != 0U) ? LSE_VALUE : LSI_VALUE);
+  TEST_CHECK_EQ(MOCK_LptimClkSource, (LseStarts != 0U) ? RCC_LPTIM1CLKSOURCE_LSE : RCC_LPTIM1CLKSOURCE_LSI);
+  TEST_CHECK_EQ(TEST_Lptim.ARR, LP_IDLE_COUNTER_MAX);
+  TEST_CHECK_EQ(TEST_Lptim.IER, LPTIM_IER_CMPMIE);
+  TEST_CHECK_EQ(TEST_Lptim.CR, LPTIM_CR_ENABLE | LPTIM_CR_CNTSTRT);
+  /* The SysTick runs as set up by the port, the tick grid starts at T0 */
+  TEST_SysTick.LOAD = (TEST_CPU_CLOCK / configTICK_RATE_HZ) - 1U;
+  TEST_SysTick.CTRL = SysTick_CTRL_ENABLE_Msk;
+  TEST_TickRunning  = 1;
+  TEST_TickCount    = 0;
+  TEST_NextTick     = TEST_T + ((uint64_t)TEST_SysTick.LOAD + 1U) * TEST_Cycle();
+  LP_IDLE_ResetStat();
+}
+
+/**
+  * @brief  Calls vPortSuppressTicksAndSleep() as the idle task does.
+  * @param  IdleTicks: Ticks until the next task is due.
+  * @retval Nonzero if the sleep took place.
+  */
+static int TEST_Sleep(uint32_t IdleTicks)
+{
+  uint32_t NumAborts;
+
+  TEST_SysTick.VAL = (uint32_t)((TEST_NextTick - TEST_T) / TEST_Cycle());
+  TEST_UnblockTick = TEST_TickCount + IdleTicks;
+  TEST_WakeIsTimer = 0;
+  TEST_WakeLatency = 0;
+  NumAborts = TEST_NumAborts;
+  vPortSuppressTicksAndSleep(IdleTicks);
+  if ((MOCK_SCB.ICSR & SCB_ICSR_PENDSTSET_Msk) != 0U)
+  {
+    MOCK_SCB.ICSR = 0;
+    TEST_Tick();
+  }
+  TEST_CHECK_EQ(TEST_TickRunning, 1);
+  TEST_CHECK(TEST_TickCount <= TEST_UnblockTick);
+  return (NumAborts == TEST_NumAborts);
+}
+
+/**
+  * @brief  Checks the initialization and the longest sleep.
+  */
+static void TEST_InitAndCap(uint32_t LseStarts)
+{
+  uint32_t Start;
+  uint32_t Counts;
+  uint32_t MaxCounts;
+
+  TEST_Init(LseStarts);
+  TEST_AbortRate = 0;
+  TEST_Run(TEST_Cycle() * 12345U);
+  Start = (uint32_t)((TEST_T / TEST_Count()) & LP_IDLE_COUNTER_MAX);
+  TEST_CHECK(TEST_Sleep(100000U) != 0);
+  Counts    = (TEST_Lptim.CMP - Start) & LP_IDLE_COUNTER_MAX;
+  MaxCounts = LP_IDLE_COUNTER_MAX - LP_IDLE_GUARD_COUNTS;
+  TEST_CHECK(Counts <= MaxCounts);
+  TEST_CHECK(Counts >= MaxCounts - ((TEST_Clock / configTICK_RATE_HZ) + 1U));
+}
+
+/**
+  * @brief  Runs TEST_NUM_SLEEPS sleeps and checks the tick grid and the
+  *         statistics against the model.
+  */
+static void TEST_Sleeps(uint32_t LseStarts)
+{
+  LP_IDLE_StatTypeDef Stat;
+  uint64_t            TickLen;
+  uint64_t            SleepTime;
+  uint64_t            MaxLatency;
+  uint64_t            T;
+  double              Err;
+  double              MaxErr;
+  double              SumErr;
+  uint32_t            NumSleeps;
+  uint32_t            NumTimerWakeups;
+  uint32_t            NumStale;
+  uint32_t            i;
+
+  TEST_Init(LseStarts);
+  TEST_AbortRate = 50;
+  TEST_NumAborts = 0;
+  TEST_NumPendingWakeups = 0;
+  TickLen        = (uint64_t)(TEST_CPU_CLOCK / configTICK_RATE_HZ) * TEST_Cycle();
+  SleepTime       = 0;
+  MaxLatency      = 0;
+  MaxErr          = 0;
+  SumErr          = 0;
+  Err             = 0;
+  NumSleeps       = 0;
+  NumTimerWakeups = 0;
+  NumStale        = 0;
+  for (i = 0; i < TEST_NUM_SLEEPS; i++)
+  {
+    /* Awake for a random part of a tick and up to two more ticks */
+    TEST_Run(TEST_GetRand64(3U * TickLen / TEST_Cycle()) * TEST_Cycle());
+    if ((TEST_GetRand() % 64U) == 0U)
+    {
+      /* The old compare value matched after interrupts were disabled */
+      TEST_Lptim.ISR  |= LPTIM_ISR_CMPM;
+      TEST_NvicPending = 1;
+      NumStale++;
+    }
+    T = TEST_T;
+    if (TEST_Sleep(2U + (TEST_GetRand() % TEST_MAX_IDLE_TICKS)) == 0)
+    {
+      if (TEST_NvicPending != 0U)
+      {
+        TEST_NvicPending = 0;
+        LP_IDLE_IRQHandler();
+      }
+      continue;
+    }
+    NumSleeps++;
+    NumTimerWakeups += TEST_WakeIsTimer;
+    SleepTime       += TEST_T - T;
+    if (TEST_WakeLatency > MaxLatency)
+    {
+      MaxLatency = TEST_WakeLatency;
+    }
+    /* Position of the next SysTick interrupt against the ideal grid, in LPTIM counts */
+    Stat.NumLateTicks = 0;
+    LP_IDLE_GetStat(&Stat);
+    Err = ((double)(int64_t)(TEST_NextTick - TEST_T0) -
+           (double)((uint64_t)TEST_TickCount + Stat.NumLateTicks + 1U) * (double)TickLen) / (double)TEST_Count();
+    SumErr += Err;
+    if (fabs(Err) > MaxErr)
+    {
+      MaxErr = fabs(Err);
+    }
+    if (TEST_NvicPending != 0U)
+    {
+      TEST_NvicPending = 0;
+      LP_IDLE_IRQHandler();
+    }
+  }
+  LP_IDLE_GetStat(&Stat);
+  TEST_CHECK_EQ(TEST_NumStepErrors, 0);
+  TEST_CHECK_EQ(Stat.NumSleeps, NumSleeps);
+  TEST_CHECK_EQ(Stat.NumAborts, TEST_NumAborts);
+  TEST_CHECK_EQ(Stat.NumTimerWakeups, NumTimerWakeups);
+  TEST_CHECK(Stat.NumLateTicks > 0U);
+  TEST_CHECK_EQ(TEST_NumPendingWakeups, 0);             /* Stale matches are cleared */
+  /* The grid error is the sum of the rounding of each sleep, zero on
+     average; a drift of half a count per sleep would reach thousands. */
+  TEST_CHECK(fabs(Err) < 4.0 * sqrt((double)NumSleeps));
+  TEST_CHECK(fabs(SumErr / NumSleeps) < 2.0 * sqrt((double)NumSleeps));
+  /* Sleep time and wake latency have the resolution of one count */
+  TEST_CHECK(fabs((double)Stat.SleepTimeUs - ((double)SleepTime * 1e6 / ((double)TEST_CPU_CLOCK * TEST_Clock))) <
+             4.0 * sqrt((double)NumSleeps) * 1e6 / TEST_Clock);
+  TEST_CHECK(fabs((double)Stat.WakeLatencyMaxUs - ((double)MaxLatency * 1e6 / ((double)TEST_CPU_CLOCK * TEST_Clock))) <=
+             1e6 / TEST_Clock + 1.0);
+  printf("LPTIM on the %s (%u Hz): %u sleeps, %u aborts, %u timer wakeups, %u late ticks, %u stale matches, "
+         "%llu ticks suppressed\n",
+         (LseStarts != 0U) ? "LSE" : "LSI", TEST_Clock, Stat.NumSleeps, Stat.NumAborts, Stat.NumTimerWakeups,
+         Stat.NumLateTicks, NumStale, (unsigned long long)Stat.TicksSuppressed);
+  printf("  Tick grid error: %.2f counts at the end, %.2f max, %.2f mean; sleep time %.3f s (model %.3f s), "
+         "wake latency %u us max, %u us avg (model max %.1f us)\n",
+         Err, MaxErr, SumErr / NumSleeps, (double)Stat.SleepTimeUs / 1e6,
+         (double)SleepTime / ((double)TEST_CPU_CLOCK * TEST_Clock), Stat.WakeLatencyMaxUs, Stat.WakeLatencyAvgUs,
+         (double)MaxLatency * 1e6 / ((double)TEST_CPU_CLOCK * TEST_Clock));
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  LPTIM1 registers. A CMP or ARR write cleared by the previous
+  *         access is acknowledged one access later, then the interrupt clear
+  *         register written by the previous access is applied and the
+  *         counter is updated from the virtual time.
+  */
+LPTIM_TypeDef *MOCK_LPTIM1(void)
+{
+  TEST_Lptim.ISR |= LPTIM_ISR_CMPOK | LPTIM_ISR_ARROK;
+  TEST_Lptim.ISR &= ~TEST_Lptim.ICR;
+  TEST_Lptim.ICR  = 0;
+  if ((TEST_Lptim.CR & LPTIM_CR_CNTSTRT) != 0U)
+  {
+    TEST_Lptim.CNT = (uint32_t)((TEST_T / TEST_Count()) & LP_IDLE_COUNTER_MAX);
+  }
+  return &TEST_Lptim;
+}
+
+/**
+  * @brief  SysTick registers. Detects that the previous access stopped or
+  *         started the counter; a start schedules the next interrupt after
+  *         the reload value at that moment.
+  */
+SysTick_Type *MOCK_SysTick(void)
+{
+  if ((TEST_TickRunning != 0U) && ((TEST_SysTick.CTRL & SysTick_CTRL_ENABLE_Msk) == 0U))
+  {
+    TEST_TickRunning = 0;
+  }
+  else if ((TEST_TickRunning == 0U) && ((TEST_SysTick.CTRL & SysTick_CTRL_ENABLE_Msk) != 0U))
+  {
+    TEST_TickRunning = 1;
+    TEST_NextTick    = TEST_T + ((uint64_t)TEST_SysTick.LOAD + 1U) * TEST_Cycle();
+  }
+  return &TEST_SysTick;
+}
+
+/**
+  * @brief  Waits for an interrupt: a pending one returns at once, otherwise
+  *         the core wakes at the compare match (with a short latency, rarely
+  *         a long one) or earlier by another interrupt.
+  */
+void MOCK_WFI(void)
+{
+  uint64_t c0;
+  uint64_t d;
+  uint64_t Match;
+  uint64_t Wake;
+  uint32_t r;
+
+  (void)MOCK_LPTIM1();
+  if (TEST_NvicPending != 0U)
+  {
+    TEST_NumPendingWakeups++;
+    return;
+  }
+  c0 = TEST_T / TEST_Count();
+  d  = (TEST_Lptim.CMP - c0) & LP_IDLE_COUNTER_MAX;
+  if (d == 0U)
+  {
+    d = LP_IDLE_COUNTER_MAX + 1U;
+  }
+  Match = (c0 + d) * TEST_Count();
+  r = TEST_GetRand() % 1000U;
+  if (r < 250U)
+  {
+    Wake = TEST_T + 1U + TEST_GetRand64(Match - TEST_T - 1U);
+  }
+  else
+  {
+    TEST_WakeLatency = TEST_GetRand64(TEST_Count() / 64U);    /* Below 0.5 us */
+    if ((r < 252U) && (d < (LP_IDLE_COUNTER_MAX / 2U)))
+    {
+      /* Late by up to three ticks, the counter must not wrap meanwhile */
+      TEST_WakeLatency += TEST_GetRand64(3U * (TEST_CPU_CLOCK / configTICK_RATE_HZ) * TEST_Cycle());
+    }
+    Wake = Match + TEST_WakeLatency;
+    TEST_WakeIsTimer = 1;
+  }
+  Wake = ((Wake + TEST_Cycle() - 1U) / TEST_Cycle()) * TEST_Cycle();   /* The core runs on whole cycles */
+  TEST_Advance(Wake);
+}
+
+/**
+  * @brief  Clears a pending interrupt.
+  */
+void NVIC_ClearPendingIRQ(IRQn_Type IRQn)
+{
+  if (IRQn == LPTIM1_IRQn)
+  {
+    TEST_NvicPending = 0;
+  }
+}
+
+/**
+  * @brief  Starts the LSE if the test allows it, the LSI always.
+  */
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef *pOscInit)
+{
+  if (pOscInit->OscillatorType == RCC_OSCILLATORTYPE_LSE)
+  {
+    MOCK_LseReady = TEST_LseStarts;
+    return (TEST_LseStarts != 0U) ? HAL_OK : HAL_ERROR;
+  }
+  return HAL_OK;
+}
+
+/**
+  * @brief  Kernel: a task may be readied just before the sleep.
+  */
+eSleepModeStatus eTaskConfirmSleepModeStatus(void)
+{
+  if ((TEST_AbortRate != 0U) && ((TEST_GetRand() % TEST_AbortRate) == 0U))
+  {
+    TEST_NumAborts++;
+    return eAbortSleep;
+  }
+  return eStandardSleep;
+}
+
+/**
+  * @brief  Kernel: steps the tick count, which must not pass the unblock time.
+  */
+void vTaskStepTick(TickType_t xTicksToJump)
+{
+  TEST_TickCount += xTicksToJump;
+  if (TEST_TickCount > TEST_UnblockTick)
+  {
+    TEST_NumStepErrors++;
+  }
+}
+
+/**
+  * @brief  Critical section of the kernel, not nested here.
+  */
+void MOCK_EnterCritical(void)
+{
+}
+
+void MOCK_ExitCritical(void)
+{
+}
+
+/**
+  * @brief  Runs the test.
+  */
+int main(void)
+{
+  TEST_InitAndCap(1);
+  TEST_InitAndCap(0);
+  TEST_Sleeps(1);
+  TEST_Sleeps(0);
+  return TEST_Report("LP_IdleTest");
+}
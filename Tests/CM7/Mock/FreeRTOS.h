@@ -0,0 +1,53 @@
+/**
+  ******************************************************************************
+  * @file    FreeRTOS.h
+  * @brief   Host replacement of the FreeRTOS kernel header for the profiler
+  *          and the tickless idle tests. Only the types, the configuration
+  *          and the critical section used by prof.c and lp_idle.c are
+  *          provided, the critical section is counted by the test.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported types ------------------------------------------------------------*/
+typedef unsigned long UBaseType_t;
+typedef uint32_t      TickType_t;
+
+/* Exported constants --------------------------------------------------------*/
+extern uint32_t SystemCoreClock;
+#define configCPU_CLOCK_HZ              ( SystemCoreClock )
+#define configTICK_RATE_HZ              ((TickType_t)1000)
+
+/* Exported functions prototypes ---------------------------------------------*/
+void MOCK_EnterCritical(void);
+void MOCK_ExitCritical(void);
+
+/* Exported macro ------------------------------------------------------------*/
+#define taskENTER_CRITICAL()            MOCK_EnterCritical()
+#define taskEXIT_CRITICAL()             MOCK_ExitCritical()
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_FREERTOS_H */
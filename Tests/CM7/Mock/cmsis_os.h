@@ -0,0 +1,66 @@
+/**
+  ******************************************************************************
+  * @file    cmsis_os.h
+  * @brief   Host replacement of the CMSIS-RTOS v2 header for the USB host
+  *          test. Only the types and the semaphore functions used by
+  *          usbh_conf.c are declared; the test implements the semaphore on
+  *          its virtual clock.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef CMSIS_OS_H_
+#define CMSIS_OS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define osCMSIS                         0x20001U
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  osOK            =  0,
+  osErrorTimeout  = -2,
+  osErrorResource = -3
+} osStatus_t;
+
+typedef enum
+{
+  osPriorityNormal = 24
+} osPriority_t;
+
+typedef void *osThreadId_t;
+typedef void *osMessageQueueId_t;
+typedef void *osSemaphoreId_t;
+
+typedef struct
+{
+  const char *name;
+} osSemaphoreAttr_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+osSemaphoreId_t osSemaphoreNew(uint32_t max_count, uint32_t initial_count, const osSemaphoreAttr_t *attr);
+osStatus_t      osSemaphoreAcquire(osSemaphoreId_t semaphore_id, uint32_t timeout);
+osStatus_t      osSemaphoreRelease(osSemaphoreId_t semaphore_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CMSIS_OS_H_ */
@@ -0,0 +1,90 @@
+/**
+  ******************************************************************************
+  * @file    main.h
+  * @brief   Host replacement of main.h for the tickless idle and the USB
+  *          host tests. Only the RCC and NVIC parts of the HAL used by
+  *          lp_idle.c and the USB pins of usbh_conf.c are provided. The LSE
+  *          start-up result is chosen by the test.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MAIN_H
+#define __MAIN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32h7xx.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  HAL_OK      = 0x00U,
+  HAL_ERROR   = 0x01U,
+  HAL_BUSY    = 0x02U,
+  HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+typedef struct
+{
+  uint32_t PLLState;
+} RCC_PLLInitTypeDef;
+
+typedef struct
+{
+  uint32_t           OscillatorType;
+  uint32_t           LSEState;
+  uint32_t           LSIState;
+  RCC_PLLInitTypeDef PLL;
+} RCC_OscInitTypeDef;
+
+/* Exported constants --------------------------------------------------------*/
+#define LSE_VALUE                       32768U
+#define LSI_VALUE                       32000U
+#define RCC_PLL_NONE                    0x00U
+#define RCC_OSCILLATORTYPE_LSE          0x04U
+#define RCC_OSCILLATORTYPE_LSI          0x08U
+#define RCC_LSE_BYPASS                  0x05U
+#define RCC_LSI_ON                      0x01U
+#define RCC_FLAG_LSERDY                 0x01U
+#define RCC_LPTIM1CLKSOURCE_LSE         0x04U
+#define RCC_LPTIM1CLKSOURCE_LSI         0x05U
+#define VBUS_FS2_Pin                    GPIO_PIN_9
+#define USB_OTG_FS2_P_Pin               GPIO_PIN_12
+#define USB_OTG_FS2_N_Pin               GPIO_PIN_11
+
+/* Exported variables --------------------------------------------------------*/
+extern uint32_t MOCK_LseReady;      /* LSE running, or starts in HAL_RCC_OscConfig() */
+extern uint32_t MOCK_LptimClkSource;
+
+/* Exported functions prototypes ---------------------------------------------*/
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef *pOscInit);
+
+/* Exported macro ------------------------------------------------------------*/
+#define __HAL_RCC_GET_FLAG(__FLAG__)         (((__FLAG__) == RCC_FLAG_LSERDY) ? MOCK_LseReady : 0U)
+#define __HAL_RCC_LPTIM1_CONFIG(__SRC__)     (MOCK_LptimClkSource = (__SRC__))
+#define __HAL_RCC_LPTIM1_CLK_ENABLE()        do { } while (0)
+#define __HAL_RCC_LPTIM1_FORCE_RESET()       do { } while (0)
+#define __HAL_RCC_LPTIM1_RELEASE_RESET()     do { } while (0)
+#define HAL_NVIC_SetPriority(__IRQ__, __PRE__, __SUB__)  ((void)(__IRQ__), (void)(__PRE__), (void)(__SUB__))
+#define HAL_NVIC_EnableIRQ(__IRQ__)          ((void)(__IRQ__))
+#define HAL_NVIC_DisableIRQ(__IRQ__)         ((void)(__IRQ__))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MAIN_H */
@@ -0,0 +1,134 @@
+/**
+  ******************************************************************************
+  * @file    stm32h7xx.h
+  * @brief   Host replacement of the CMSIS device header for the profiler,
+  *          the tickless idle and the USB host tests. The DWT and CoreDebug
+  *          registers are plain variables, the test advances DWT->CYCCNT as
+  *          its virtual cycle counter. LPTIM1 and SysTick are reached through
+  *          a function of the test, called on every register access, so the
+  *          test sees each write and keeps the counters in step with its
+  *          clock. USB_OTG_FS and GPIOA are only compared, never accessed.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32H7XX_H
+#define __STM32H7XX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  LPTIM1_IRQn = 93,
+  OTG_FS_IRQn = 101
+} IRQn_Type;
+
+typedef struct
+{
+  volatile uint32_t CTRL;
+  volatile uint32_t CYCCNT;
+  volatile uint32_t LAR;
+} DWT_Type;
+
+typedef struct
+{
+  volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+typedef struct
+{
+  volatile uint32_t ISR;
+  volatile uint32_t ICR;
+  volatile uint32_t IER;
+  volatile uint32_t CFGR;
+  volatile uint32_t CR;
+  volatile uint32_t CMP;
+  volatile uint32_t ARR;
+  volatile uint32_t CNT;
+} LPTIM_TypeDef;
+
+typedef struct
+{
+  volatile uint32_t CTRL;
+  volatile uint32_t LOAD;
+  volatile uint32_t VAL;
+} SysTick_Type;
+
+typedef struct
+{
+  volatile uint32_t ICSR;
+} SCB_Type;
+
+typedef struct
+{
+  volatile uint32_t GOTGCTL;
+} USB_OTG_GlobalTypeDef;
+
+typedef struct
+{
+  volatile uint32_t MODER;
+} GPIO_TypeDef;
+
+/* Exported constants --------------------------------------------------------*/
+#define DWT_CTRL_CYCCNTENA_Msk          (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk      (1UL << 24)
+#define SysTick_CTRL_ENABLE_Msk         (1UL << 0)
+#define SCB_ICSR_PENDSTSET_Msk          (1UL << 26)
+#define LPTIM_ISR_CMPM                  (1UL << 0)
+#define LPTIM_ISR_CMPOK                 (1UL << 3)
+#define LPTIM_ISR_ARROK                 (1UL << 4)
+#define LPTIM_ICR_CMPMCF                (1UL << 0)
+#define LPTIM_ICR_CMPOKCF               (1UL << 3)
+#define LPTIM_ICR_ARROKCF               (1UL << 4)
+#define LPTIM_IER_CMPMIE                (1UL << 0)
+#define LPTIM_CR_ENABLE                 (1UL << 0)
+#define LPTIM_CR_CNTSTRT                (1UL << 2)
+
+/* Exported variables --------------------------------------------------------*/
+extern DWT_Type       MOCK_DWT;
+extern CoreDebug_Type MOCK_CoreDebug;
+extern uint32_t       SystemCoreClock;
+extern SCB_Type       MOCK_SCB;
+
+/* Exported functions prototypes ---------------------------------------------*/
+LPTIM_TypeDef *MOCK_LPTIM1(void);
+SysTick_Type  *MOCK_SysTick(void);
+void           MOCK_WFI(void);
+void           NVIC_ClearPendingIRQ(IRQn_Type IRQn);
+
+/* Exported macro ------------------------------------------------------------*/
+#define __IO                            volatile
+#define USB_OTG_FS                      ((USB_OTG_GlobalTypeDef *)0x40080000UL)
+#define GPIOA                           ((GPIO_TypeDef *)0x58020000UL)
+#define DWT                             (&MOCK_DWT)
+#define CoreDebug                       (&MOCK_CoreDebug)
+#define LPTIM1                          (MOCK_LPTIM1())
+#define SysTick                         (MOCK_SysTick())
+#define SCB                             (&MOCK_SCB)
+#define __disable_irq()                 do { } while (0)
+#define __enable_irq()                  do { } while (0)
+#define __DSB()                         do { } while (0)
+#define __ISB()                         do { } while (0)
+#define __WFI()                         MOCK_WFI()
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32H7XX_H */
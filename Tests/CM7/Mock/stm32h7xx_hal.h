@@ -0,0 +1,156 @@
+/**
+  ******************************************************************************
+  * @file    stm32h7xx_hal.h
+  * @brief   Host replacement of the HAL header for the USB host test.
+  *          Only the HCD types and functions used by usbh_conf.c are
+  *          declared; the test implements them on its model of the OTG_FS
+  *          host channels and the mass storage device. The clock, GPIO and
+  *          power calls of the MSP do nothing.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef STM32H7xx_HAL_H
+#define STM32H7xx_HAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32h7xx.h"
+#include "main.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  DISABLE = 0U,
+  ENABLE  = !DISABLE
+} FunctionalState;
+
+typedef struct
+{
+  uint32_t Pin;
+  uint32_t Mode;
+  uint32_t Pull;
+  uint32_t Speed;
+  uint32_t Alternate;
+} GPIO_InitTypeDef;
+
+typedef struct
+{
+  uint64_t PeriphClockSelection;
+  uint32_t UsbClockSelection;
+} RCC_PeriphCLKInitTypeDef;
+
+typedef enum
+{
+  URB_IDLE = 0,
+  URB_DONE,
+  URB_NOTREADY,
+  URB_NYET,
+  URB_ERROR,
+  URB_STALL
+} HCD_URBStateTypeDef;
+
+typedef struct
+{
+  uint8_t             dev_addr;
+  uint8_t             ch_num;
+  uint8_t             ep_num;
+  uint8_t             ep_is_in;
+  uint8_t             speed;
+  uint8_t             ep_type;
+  uint16_t            max_packet;
+  uint8_t             toggle_in;
+  uint8_t             toggle_out;
+  uint8_t            *xfer_buff;
+  uint32_t            xfer_len;
+  uint32_t            xfer_count;
+  HCD_URBStateTypeDef urb_state;
+} HCD_HCTypeDef;
+
+typedef struct
+{
+  uint32_t Host_channels;
+  uint32_t speed;
+  uint32_t dma_enable;
+  uint32_t phy_itface;
+  uint32_t Sof_enable;
+} HCD_InitTypeDef;
+
+typedef struct
+{
+  USB_OTG_GlobalTypeDef *Instance;
+  HCD_InitTypeDef        Init;
+  HCD_HCTypeDef          hc[16];
+  void                  *pData;
+} HCD_HandleTypeDef;
+
+/* Exported constants --------------------------------------------------------*/
+#define GPIO_PIN_9                      0x0200U
+#define GPIO_PIN_11                     0x0800U
+#define GPIO_PIN_12                     0x1000U
+#define GPIO_MODE_AF_PP                 0x02U
+#define GPIO_NOPULL                     0x00U
+#define GPIO_SPEED_FREQ_LOW             0x00U
+#define GPIO_AF10_OTG1_FS               0x0AU
+#define RCC_PERIPHCLK_USB               0x00040000U
+#define RCC_USBCLKSOURCE_PLL            0x01U
+#define HCD_SPEED_FULL                  3U
+#define HCD_PHY_EMBEDDED                2U
+
+/* Exported macro ------------------------------------------------------------*/
+#define UNUSED(X)                       (void)(X)
+#define HAL_GPIO_Init(__PORT__, __INIT__)    ((void)(__PORT__), (void)(__INIT__))
+#define HAL_GPIO_DeInit(__PORT__, __PINS__)  ((void)(__PORT__), (void)(__PINS__))
+#define HAL_RCCEx_PeriphCLKConfig(__INIT__)  ((void)(__INIT__), HAL_OK)
+#define HAL_PWREx_EnableUSBVoltageDetector() do { } while (0)
+#define __HAL_RCC_GPIOA_CLK_ENABLE()         do { } while (0)
+#define __HAL_RCC_USB_OTG_FS_CLK_ENABLE()    do { } while (0)
+#define __HAL_RCC_USB_OTG_FS_CLK_DISABLE()   do { } while (0)
+
+/* Exported functions prototypes ---------------------------------------------*/
+void                HAL_Delay(uint32_t Delay);
+
+HAL_StatusTypeDef   HAL_HCD_Init(HCD_HandleTypeDef *hhcd);
+HAL_StatusTypeDef   HAL_HCD_DeInit(HCD_HandleTypeDef *hhcd);
+HAL_StatusTypeDef   HAL_HCD_Start(HCD_HandleTypeDef *hhcd);
+HAL_StatusTypeDef   HAL_HCD_Stop(HCD_HandleTypeDef *hhcd);
+HAL_StatusTypeDef   HAL_HCD_ResetPort(HCD_HandleTypeDef *hhcd);
+uint32_t            HAL_HCD_GetCurrentFrame(HCD_HandleTypeDef *hhcd);
+uint32_t            HAL_HCD_GetCurrentSpeed(HCD_HandleTypeDef *hhcd);
+HAL_StatusTypeDef   HAL_HCD_HC_Init(HCD_HandleTypeDef *hhcd, uint8_t ch_num, uint8_t epnum,
+                                    uint8_t dev_address, uint8_t speed, uint8_t ep_type, uint16_t mps);
+HAL_StatusTypeDef   HAL_HCD_HC_Halt(HCD_HandleTypeDef *hhcd, uint8_t ch_num);
+HAL_StatusTypeDef   HAL_HCD_HC_SubmitRequest(HCD_HandleTypeDef *hhcd, uint8_t ch_num, uint8_t direction,
+                                             uint8_t ep_type, uint8_t token, uint8_t *pbuff,
+                                             uint16_t length, uint8_t do_ping);
+HCD_URBStateTypeDef HAL_HCD_HC_GetURBState(HCD_HandleTypeDef *hhcd, uint8_t chnum);
+uint32_t            HAL_HCD_HC_GetXferCount(HCD_HandleTypeDef *hhcd, uint8_t chnum);
+
+void                HAL_HCD_MspInit(HCD_HandleTypeDef *hhcd);
+void                HAL_HCD_MspDeInit(HCD_HandleTypeDef *hhcd);
+void                HAL_HCD_SOF_Callback(HCD_HandleTypeDef *hhcd);
+void                HAL_HCD_Connect_Callback(HCD_HandleTypeDef *hhcd);
+void                HAL_HCD_Disconnect_Callback(HCD_HandleTypeDef *hhcd);
+void                HAL_HCD_PortEnabled_Callback(HCD_HandleTypeDef *hhcd);
+void                HAL_HCD_PortDisabled_Callback(HCD_HandleTypeDef *hhcd);
+void                HAL_HCD_HC_NotifyURBChange_Callback(HCD_HandleTypeDef *hhcd, uint8_t chnum,
+                                                        HCD_URBStateTypeDef urb_state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STM32H7xx_HAL_H */
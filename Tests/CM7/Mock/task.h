@@ -0,0 +1,51 @@
+/**
+  ******************************************************************************
+  * @file    task.h
+  * @brief   Host replacement of the FreeRTOS task API used by the profiler
+  *          and by the tickless idle. The task control blocks and the tick
+  *          count are simulated by the tests.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef INC_TASK_H
+#define INC_TASK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct tskTaskControlBlock *TaskHandle_t;
+
+typedef enum
+{
+  eAbortSleep = 0,
+  eStandardSleep
+} eSleepModeStatus;
+
+/* Exported functions prototypes ---------------------------------------------*/
+UBaseType_t uxTaskGetTaskNumber(TaskHandle_t xTask);
+void        vTaskSetTaskNumber(TaskHandle_t xTask, const UBaseType_t uxHandle);
+char       *pcTaskGetName(TaskHandle_t xTaskToQuery);
+eSleepModeStatus eTaskConfirmSleepModeStatus(void);
+void        vTaskStepTick(TickType_t xTicksToJump);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_TASK_H */
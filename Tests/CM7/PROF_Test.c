@@ -0,0 +1,703 @@
+/**
+  ******************************************************************************
+  * @file    PROF_Test.c
+  * @brief   Host test of the run-time task profiler (prof.c, prof_ring.c).
+  *
+  *          1. Event ring: initialization, full ring, in-order removal and
+  *             four producer threads racing one consumer thread. Every event
+  *             is either received in producer order or counted as dropped.
+  *          2. Profiler: a simulated scheduler switches 20 tasks (more than
+  *             PROF_MAX_TASKS) on a virtual DWT cycle counter that wraps
+  *             around, with wake-to-run latencies at the histogram bucket
+  *             boundaries and nested interrupts. Task cycles, run counts,
+  *             latency histograms, interrupt times and dropped events are
+  *             compared with a model of the scheduler.
+  *          3. Export: a short run without dropped events is exported with
+  *             PROF_Export() and written to the file given as argument, the
+  *             decoder (CM7/Tools/prof_decode.py --check) verifies it.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "stm32h7xx.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "prof.h"
+#include "test_check.h"
+
+/* Private typedef -----------------------------------------------------------*/
+struct tskTaskControlBlock
+{
+  char        acName[16];
+  UBaseType_t Number;
+};
+
+/**
+  * @brief  Expected statistics of a slot.
+  */
+typedef struct
+{
+  uint64_t Cycles;
+  uint32_t NumRuns;
+  uint32_t aLatency[PROF_NUM_LAT_BUCKETS];
+} TEST_SlotTypeDef;
+
+/**
+  * @brief  Simulated task.
+  */
+typedef struct
+{
+  struct tskTaskControlBlock Tcb;
+  unsigned                   Slot;          /*!< Expected slot, 0 until the first hook call */
+  uint8_t                    IsReady;
+  uint32_t                   ReadyTime;
+} TEST_TaskTypeDef;
+
+/**
+  * @brief  Producer thread of the ring test.
+  */
+typedef struct
+{
+  PROF_RingTypeDef *pRing;
+  uint32_t          Id;
+  uint32_t          NumPut;
+  uint32_t          NumFailed;
+} TEST_ProducerTypeDef;
+
+/* Private define ------------------------------------------------------------*/
+#define TEST_CPU_CLOCK          480000000U
+#define TEST_CYCLES_PER_US      (TEST_CPU_CLOCK / 1000000U)
+#define TEST_NUM_TASKS          20U
+#define TEST_NUM_SWITCHES       200000U
+#define TEST_NUM_SHORT_SWITCHES 100U     /* Fits into the ring without drops */
+#define TEST_TIME_START         (0xFFFFFFFFU - 2U * TEST_CPU_CLOCK)
+#define TEST_NUM_PRODUCERS      4U
+#define TEST_NUM_PER_PRODUCER   1000000U
+#define TEST_RING_SIZE          1024U
+#define TEST_MAX_EXPORT         (256U * 1024U)
+
+#define TEST_IRQN_TIM6          54       /* TIM6_DAC_IRQn */
+#define TEST_IRQN_OTG_FS        101      /* OTG_FS_IRQn   */
+#define TEST_IRQN_HSEM1         125      /* HSEM1_IRQn    */
+
+/* Private variables ---------------------------------------------------------*/
+DWT_Type       MOCK_DWT;
+CoreDebug_Type MOCK_CoreDebug;
+uint32_t       SystemCoreClock = TEST_CPU_CLOCK;
+
+static int              TEST_CriticalNesting;
+static uint32_t         TEST_NumCriticalErrors;
+static uint32_t         TEST_Rand = 0x13579BDFU;
+static TEST_TaskTypeDef TEST_aTask[TEST_NUM_TASKS];
+static TEST_SlotTypeDef TEST_aSlot[PROF_MAX_TASKS];
+static unsigned         TEST_NumSlots = 1;
+static uint32_t         TEST_NumEvents;
+static uint32_t         TEST_aIrqCount[PROF_MAX_IRQ_ID];
+static uint64_t         TEST_aIrqCycles[PROF_MAX_IRQ_ID];
+static uint8_t          TEST_abExport[TEST_MAX_EXPORT];
+static uint32_t         TEST_ExportLen;
+static uint32_t         TEST_NumExportErrors;
+static uint32_t         TEST_NumProducersDone;
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Returns the monotonic host time in nanoseconds.
+  */
+static uint64_t TEST_GetTime_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+}
+
+/**
+  * @brief  Returns a pseudo random number (24 bits).
+  */
+static uint32_t TEST_GetRand(void)
+{
+  TEST_Rand = TEST_Rand * 1103515245U + 12345U;
+  return TEST_Rand >> 8;
+}
+
+/**
+  * @brief  Expected slot of a task, assigned on its first appearance.
+  */
+static unsigned TEST_GetSlot(TEST_TaskTypeDef *pTask)
+{
+  if (pTask->Slot == 0U)
+  {
+    if (TEST_NumSlots < PROF_MAX_TASKS)
+    {
+      pTask->Slot = TEST_NumSlots++;
+    }
+    else
+    {
+      pTask->Slot = PROF_MAX_TASKS;  /* Shares slot 0 */
+    }
+  }
+  return (pTask->Slot == PROF_MAX_TASKS) ? 0U : pTask->Slot;
+}
+
+/**
+  * @brief  Advances the virtual cycle counter.
+  */
+static void TEST_Advance(uint32_t Cycles)
+{
+  MOCK_DWT.CYCCNT += Cycles;
+}
+
+/**
+  * @brief  Returns a wake-to-run delay in cycles, often at a bucket boundary.
+  */
+static uint32_t TEST_GetRandDelay(void)
+{
+  uint32_t Us;
+
+  switch (TEST_GetRand() % 5U)
+  {
+  case 0:
+    Us = 1U << (TEST_GetRand() % 17U);          /* Lower bound of a bucket */
+    return Us * TEST_CYCLES_PER_US;
+  case 1:
+    Us = 1U << (TEST_GetRand() % 17U);
+    return Us * TEST_CYCLES_PER_US - 1U;        /* Just below */
+  case 2:
+    return TEST_GetRand() % TEST_CYCLES_PER_US; /* Below 1 us */
+  case 3:
+    return TEST_GetRand() % (100000U * TEST_CYCLES_PER_US);
+  default:
+    return TEST_GetRand() % (2000U * TEST_CYCLES_PER_US);
+  }
+}
+
+/**
+  * @brief  Expected latency bucket.
+  */
+static unsigned TEST_GetBucket(uint32_t Cycles)
+{
+  uint32_t Us;
+  unsigned Bucket;
+
+  Us = Cycles / TEST_CYCLES_PER_US;
+  if (Us > 0xFFFFU)
+  {
+    Us = 0xFFFFU;
+  }
+  Bucket = 0;
+  while ((Us >> (Bucket + 1U)) != 0U)
+  {
+    Bucket++;
+  }
+  return (Bucket >= PROF_NUM_LAT_BUCKETS) ? (PROF_NUM_LAT_BUCKETS - 1U) : Bucket;
+}
+
+/**
+  * @brief  Runs an interrupt, sometimes preempted by a second one.
+  */
+static void TEST_RunIrq(void)
+{
+  int32_t  IRQn;
+  uint32_t Id;
+  uint32_t Start;
+  uint32_t NestedStart;
+  uint32_t Cycles;
+
+  IRQn  = ((TEST_GetRand() & 1U) != 0U) ? TEST_IRQN_OTG_FS : TEST_IRQN_HSEM1;
+  Id    = (uint32_t)(IRQn + 16);
+  Start = MOCK_DWT.CYCCNT;
+  PROF_IRQ_ENTER(IRQn);
+  TEST_Advance(TEST_GetRand() % 5000U);
+  if ((TEST_GetRand() % 4U) == 0U)
+  {
+    NestedStart = MOCK_DWT.CYCCNT;
+    PROF_IRQ_ENTER(TEST_IRQN_TIM6);
+    TEST_Advance(TEST_GetRand() % 2000U);
+    PROF_IRQ_EXIT(TEST_IRQN_TIM6);
+    Cycles = MOCK_DWT.CYCCNT - NestedStart;
+    TEST_aIrqCount[TEST_IRQN_TIM6 + 16]++;
+    TEST_aIrqCycles[TEST_IRQN_TIM6 + 16] += Cycles;
+    TEST_NumEvents += 2U;
+    TEST_Advance(TEST_GetRand() % 1000U);
+  }
+  PROF_IRQ_EXIT(IRQn);
+  Cycles = MOCK_DWT.CYCCNT - Start;
+  TEST_aIrqCount[Id]++;
+  TEST_aIrqCycles[Id] += Cycles;
+  TEST_NumEvents += 2U;
+}
+
+/**
+  * @brief  Makes a task ready, the latency measurement starts unless the
+  *         task is already waiting.
+  */
+static void TEST_MakeReady(TEST_TaskTypeDef *pTask)
+{
+  (void)TEST_GetSlot(pTask);
+  PROF_TaskReady(&pTask->Tcb);
+  TEST_NumEvents++;
+  if ((pTask->IsReady == 0U) && (pTask->Slot != PROF_MAX_TASKS))
+  {
+    pTask->IsReady   = 1;
+    pTask->ReadyTime = MOCK_DWT.CYCCNT;
+  }
+}
+
+/**
+  * @brief  Simulates a number of context switches, starting with pCur
+  *         running. Tasks sharing slot 0 share its ready state in the
+  *         profiler, the simulation only makes them run when preempted.
+  * @retval Task running at the end.
+  */
+static TEST_TaskTypeDef *TEST_Schedule(TEST_TaskTypeDef *pCur, uint32_t NumSwitches, uint32_t SwitchInTime)
+{
+  TEST_TaskTypeDef *pNext;
+  unsigned          Slot;
+  unsigned          i;
+  uint32_t          n;
+  uint32_t          Delay;
+
+  for (n = 0; n < NumSwitches; n++)
+  {
+    /* Run the current task, with interrupts and tasks becoming ready */
+    for (i = TEST_GetRand() % 4U; i > 0U; i--)
+    {
+      TEST_Advance(TEST_GetRand() % 20000U);
+      if ((TEST_GetRand() % 3U) == 0U)
+      {
+        TEST_RunIrq();
+      }
+      else
+      {
+        pNext = &TEST_aTask[TEST_GetRand() % TEST_NUM_TASKS];
+        if ((pNext != pCur) && (pNext->Slot != PROF_MAX_TASKS))
+        {
+          TEST_MakeReady(pNext);
+        }
+      }
+    }
+    /* Pick the next task: a ready one after its delay or a preemption */
+    pNext = &TEST_aTask[TEST_GetRand() % TEST_NUM_TASKS];
+    if (pNext == pCur)
+    {
+      pNext = &TEST_aTask[(unsigned)(pNext - TEST_aTask + 1) % TEST_NUM_TASKS];
+    }
+    if ((pNext->IsReady != 0U) && ((TEST_GetRand() & 1U) != 0U))
+    {
+      Delay = TEST_GetRandDelay();
+      if ((uint32_t)(MOCK_DWT.CYCCNT - pNext->ReadyTime) < Delay)
+      {
+        TEST_Advance(Delay - (uint32_t)(MOCK_DWT.CYCCNT - pNext->ReadyTime));
+      }
+    }
+    PROF_TaskSwitchedOut(&pCur->Tcb);
+    TEST_NumEvents++;
+    Slot = TEST_GetSlot(pCur);
+    TEST_aSlot[Slot].Cycles += (uint32_t)(MOCK_DWT.CYCCNT - SwitchInTime);
+    TEST_Advance(TEST_GetRand() % 200U);
+    PROF_TaskSwitchedIn(&pNext->Tcb);
+    TEST_NumEvents++;
+    Slot = TEST_GetSlot(pNext);
+    TEST_aSlot[Slot].NumRuns++;
+    if (pNext->IsReady != 0U)
+    {
+      pNext->IsReady = 0;
+      TEST_aSlot[Slot].aLatency[TEST_GetBucket(MOCK_DWT.CYCCNT - pNext->ReadyTime)]++;
+    }
+    SwitchInTime = MOCK_DWT.CYCCNT;
+    pCur         = pNext;
+  }
+  TEST_Advance(TEST_GetRand() % 20000U);
+  PROF_TaskSwitchedOut(&pCur->Tcb);                   /* Close the last run */
+  TEST_NumEvents++;
+  Slot = TEST_GetSlot(pCur);
+  TEST_aSlot[Slot].Cycles += (uint32_t)(MOCK_DWT.CYCCNT - SwitchInTime);
+  return pCur;
+}
+
+/**
+  * @brief  Compares the statistics of the profiler with the model.
+  */
+static void TEST_CheckStats(void)
+{
+  PROF_TaskStatTypeDef Stat;
+  unsigned             Slot;
+  unsigned             b;
+  uint32_t             NumDiff;
+
+  NumDiff = 0;
+  for (Slot = 0; Slot < PROF_MAX_TASKS; Slot++)
+  {
+    if (Slot >= TEST_NumSlots)
+    {
+      TEST_CHECK(PROF_GetTaskStat(Slot, &Stat) != 0);
+      continue;
+    }
+    TEST_CHECK_EQ(PROF_GetTaskStat(Slot, &Stat), 0);
+    if ((Stat.Cycles != TEST_aSlot[Slot].Cycles) || (Stat.NumRuns != TEST_aSlot[Slot].NumRuns))
+    {
+      printf("Slot %u (%s): %llu cycles, %lu runs, expected %llu, %lu\n", Slot, Stat.acName,
+             (unsigned long long)Stat.Cycles, (unsigned long)Stat.NumRuns,
+             (unsigned long long)TEST_aSlot[Slot].Cycles, (unsigned long)TEST_aSlot[Slot].NumRuns);
+      NumDiff++;
+    }
+    for (b = 0; b < PROF_NUM_LAT_BUCKETS; b++)
+    {
+      if ((Slot != 0U) && (Stat.aLatency[b] != TEST_aSlot[Slot].aLatency[b]))
+      {
+        printf("Slot %u (%s): latency bucket %u: %lu, expected %lu\n", Slot, Stat.acName, b,
+               (unsigned long)Stat.aLatency[b], (unsigned long)TEST_aSlot[Slot].aLatency[b]);
+        NumDiff++;
+      }
+    }
+  }
+  TEST_CHECK_EQ(NumDiff, 0U);
+}
+
+/**
+  * @brief  Write function of PROF_Export(), collects the export in memory.
+  */
+static void TEST_Write(void *pContext, const void *pData, uint32_t NumBytes)
+{
+  (void)pContext;
+  if (TEST_ExportLen + NumBytes > TEST_MAX_EXPORT)
+  {
+    TEST_NumExportErrors++;
+    return;
+  }
+  memcpy(&TEST_abExport[TEST_ExportLen], pData, NumBytes);
+  TEST_ExportLen += NumBytes;
+}
+
+/**
+  * @brief  Reads a little endian 32-bit value of the export.
+  */
+static uint32_t TEST_LoadU32(uint32_t Off)
+{
+  return (uint32_t)TEST_abExport[Off] | ((uint32_t)TEST_abExport[Off + 1U] << 8) |
+         ((uint32_t)TEST_abExport[Off + 2U] << 16) | ((uint32_t)TEST_abExport[Off + 3U] << 24);
+}
+
+/**
+  * @brief  Exports and checks the layout of the export.
+  * @retval Number of events in the export.
+  */
+static uint32_t TEST_Export(void)
+{
+  uint32_t NumTasks;
+  uint32_t NumIrqs;
+  uint32_t NumEvents;
+  uint32_t Count;
+  uint32_t Off;
+  uint32_t i;
+
+  TEST_ExportLen = 0;
+  PROF_Export(TEST_Write, NULL);
+  TEST_CHECK_EQ(TEST_NumExportErrors, 0U);
+  TEST_CHECK_EQ(TEST_CriticalNesting, 0);
+  TEST_CHECK_EQ(TEST_LoadU32(0), PROF_MAGIC);
+  TEST_CHECK_EQ(TEST_LoadU32(4), TEST_CPU_CLOCK);
+  NumTasks = TEST_LoadU32(8);
+  NumIrqs  = TEST_LoadU32(12);
+  TEST_CHECK_EQ(NumTasks, TEST_NumSlots);
+  Off = 20U + NumTasks * (4U + PROF_TASK_NAME_LEN + 8U + 4U + 4U * PROF_NUM_LAT_BUCKETS);
+  for (i = 0; i < NumIrqs; i++)
+  {
+    TEST_CHECK(TEST_LoadU32(Off) < PROF_MAX_IRQ_ID);
+    TEST_CHECK_EQ(TEST_LoadU32(Off + 4U), TEST_aIrqCount[TEST_LoadU32(Off)]);
+    TEST_CHECK(((uint64_t)TEST_LoadU32(Off + 8U) | ((uint64_t)TEST_LoadU32(Off + 12U) << 32)) == TEST_aIrqCycles[TEST_LoadU32(Off)]);
+    Off += 16U;
+  }
+  NumEvents = 0;
+  do
+  {
+    Count      = TEST_LoadU32(Off);
+    Off       += 4U + Count * (uint32_t)sizeof(PROF_EventTypeDef);
+    NumEvents += Count;
+  } while ((Count != 0U) && (Off < TEST_ExportLen));
+  TEST_CHECK_EQ(Count, 0U);
+  TEST_CHECK_EQ(Off, TEST_ExportLen);
+  return NumEvents;
+}
+
+/**
+  * @brief  Producer thread of the ring test.
+  */
+static void *TEST_Producer(void *p)
+{
+  TEST_ProducerTypeDef *pProd;
+  uint32_t              k;
+
+  pProd = (TEST_ProducerTypeDef *)p;
+  for (k = 0; k < TEST_NUM_PER_PRODUCER; k++)
+  {
+    if (PROF_RING_Put(pProd->pRing, k, PROF_ENCODE(PROF_EVT_USER, pProd->Id, k)) == 0)
+    {
+      pProd->NumPut++;
+    }
+    else
+    {
+      pProd->NumFailed++;
+    }
+  }
+  __atomic_fetch_add(&TEST_NumProducersDone, 1U, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+/**
+  * @brief  Event ring, single threaded.
+  */
+static void TEST_Ring(void)
+{
+  static PROF_EventTypeDef aEvent[16];
+  PROF_EventTypeDef        aOut[16];
+  PROF_RingTypeDef         Ring;
+  uint32_t                 n;
+  uint32_t                 i;
+  uint32_t                 Lap;
+
+  TEST_CHECK_EQ(PROF_RING_Init(&Ring, aEvent, 12), -1);
+  TEST_CHECK_EQ(PROF_RING_Init(&Ring, aEvent, 0), -1);
+  TEST_CHECK_EQ(PROF_RING_Init(&Ring, aEvent, 16), 0);
+  TEST_CHECK_EQ(PROF_RING_Get(&Ring, aOut, 16), 0U);
+  for (Lap = 0; Lap < 3U; Lap++)
+  {
+    for (i = 0; i < 16U; i++)
+    {
+      TEST_CHECK_EQ(PROF_RING_Put(&Ring, i, PROF_ENCODE(PROF_EVT_USER, Lap, i)), 0);
+    }
+    TEST_CHECK_EQ(PROF_RING_Put(&Ring, 99, 0), -1);
+    TEST_CHECK_EQ(Ring.NumDropped, Lap + 1U);
+    n = PROF_RING_Get(&Ring, aOut, 5);
+    TEST_CHECK_EQ(n, 5U);
+    n += PROF_RING_Get(&Ring, &aOut[5], 16);
+    TEST_CHECK_EQ(n, 16U);
+    for (i = 0; i < n; i++)
+    {
+      TEST_CHECK_EQ(aOut[i].Seq, Lap * 16U + i);
+      TEST_CHECK_EQ(aOut[i].Time, i);
+      TEST_CHECK_EQ(PROF_DECODE_TYPE(aOut[i].Data), PROF_EVT_USER);
+      TEST_CHECK_EQ(PROF_DECODE_ID(aOut[i].Data), Lap);
+      TEST_CHECK_EQ(PROF_DECODE_ARG(aOut[i].Data), i);
+    }
+  }
+  /* Encoding truncates each field to its width */
+  TEST_CHECK_EQ(PROF_DECODE_TYPE(PROF_ENCODE(0x1FU, 0x1FFFU, 0x1FFFFU)), 0xFU);
+  TEST_CHECK_EQ(PROF_DECODE_ID(PROF_ENCODE(0x1FU, 0x1FFFU, 0x1FFFFU)), 0xFFFU);
+  TEST_CHECK_EQ(PROF_DECODE_ARG(PROF_ENCODE(0x1FU, 0x1FFFU, 0x1FFFFU)), 0xFFFFU);
+  TEST_CHECK_EQ(PROF_DECODE_ID(PROF_ENCODE(PROF_EVT_TASK_IN, 3U, 0xFFFFU)), 3U);
+}
+
+/**
+  * @brief  Event ring, producer threads racing the consumer.
+  */
+static void TEST_RingThreads(void)
+{
+  static PROF_EventTypeDef aEvent[TEST_RING_SIZE];
+  static PROF_EventTypeDef aOut[64];
+  PROF_RingTypeDef         Ring;
+  TEST_ProducerTypeDef     aProd[TEST_NUM_PRODUCERS];
+  pthread_t                aThread[TEST_NUM_PRODUCERS];
+  uint32_t                 aNext[TEST_NUM_PRODUCERS];
+  uint32_t                 aNumRx[TEST_NUM_PRODUCERS];
+  uint32_t                 NextSeq;
+  uint32_t                 NumRx;
+  uint32_t                 NumOrderErrors;
+  uint32_t                 NumPut;
+  uint32_t                 NumFailed;
+  uint32_t                 Id;
+  uint32_t                 n;
+  uint32_t                 i;
+  int                      Done;
+  uint64_t                 t;
+
+  TEST_CHECK_EQ(PROF_RING_Init(&Ring, aEvent, TEST_RING_SIZE), 0);
+  memset(aProd, 0, sizeof(aProd));
+  memset(aNext, 0, sizeof(aNext));
+  memset(aNumRx, 0, sizeof(aNumRx));
+  t = TEST_GetTime_ns();
+  for (i = 0; i < TEST_NUM_PRODUCERS; i++)
+  {
+    aProd[i].pRing = &Ring;
+    aProd[i].Id    = i;
+    (void)pthread_create(&aThread[i], NULL, TEST_Producer, &aProd[i]);
+  }
+  NextSeq        = 0;
+  NumRx          = 0;
+  NumOrderErrors = 0;
+  do
+  {
+    /* Events completed before the last producer finished are all seen by the last pass */
+    Done = (__atomic_load_n(&TEST_NumProducersDone, __ATOMIC_ACQUIRE) == TEST_NUM_PRODUCERS) ? 1 : 0;
+    do
+    {
+      n = PROF_RING_Get(&Ring, aOut, 64);
+      for (i = 0; i < n; i++)
+      {
+        Id = PROF_DECODE_ID(aOut[i].Data);
+        if ((aOut[i].Seq != NextSeq) || (Id >= TEST_NUM_PRODUCERS) ||
+            (aOut[i].Time < aNext[Id]) || (PROF_DECODE_ARG(aOut[i].Data) != (aOut[i].Time & 0xFFFFU)))
+        {
+          NumOrderErrors++;
+        }
+        else
+        {
+          aNext[Id] = aOut[i].Time + 1U;
+          aNumRx[Id]++;
+        }
+        NextSeq++;
+      }
+      NumRx += n;
+    } while (n != 0U);
+  } while (Done == 0);
+  for (i = 0; i < TEST_NUM_PRODUCERS; i++)
+  {
+    (void)pthread_join(aThread[i], NULL);
+  }
+  t = TEST_GetTime_ns() - t;
+  NumPut    = 0;
+  NumFailed = 0;
+  for (i = 0; i < TEST_NUM_PRODUCERS; i++)
+  {
+    NumPut    += aProd[i].NumPut;
+    NumFailed += aProd[i].NumFailed;
+    TEST_CHECK_EQ(aNumRx[i], aProd[i].NumPut);
+  }
+  TEST_CHECK_EQ(NumOrderErrors, 0U);
+  TEST_CHECK_EQ(NumRx, NumPut);
+  TEST_CHECK_EQ(NumPut + NumFailed, TEST_NUM_PRODUCERS * TEST_NUM_PER_PRODUCER);
+  TEST_CHECK_EQ(Ring.NumDropped, NumFailed);
+  printf("Ring: %u producers, %lu events received, %lu dropped, %.1f M events/s\n",
+         (unsigned)TEST_NUM_PRODUCERS, (unsigned long)NumRx, (unsigned long)NumFailed,
+         (double)(NumPut + NumFailed) * 1e3 / (double)t);
+}
+
+/**
+  * @brief  Profiler against the scheduler model.
+  */
+static void TEST_Profiler(const char *sFile)
+{
+  TEST_TaskTypeDef *pCur;
+  uint32_t          NumEvents;
+  uint32_t          i;
+  FILE             *pFile;
+
+  for (i = 0; i < TEST_NUM_TASKS; i++)
+  {
+    (void)snprintf(TEST_aTask[i].Tcb.acName, sizeof(TEST_aTask[i].Tcb.acName), "Task%02lu", (unsigned long)i);
+  }
+  (void)strcpy(TEST_aTask[0].Tcb.acName, "USBH_Task");
+  (void)strcpy(TEST_aTask[1].Tcb.acName, "USBH_ISRTask");
+  (void)strcpy(TEST_aTask[2].Tcb.acName, "Tmr Svc");
+  (void)strcpy(TEST_aTask[3].Tcb.acName, "IDLE");
+  PROF_Init();
+  TEST_CHECK((MOCK_DWT.CTRL & DWT_CTRL_CYCCNTENA_Msk) != 0U);
+  TEST_CHECK((MOCK_CoreDebug.DEMCR & CoreDebug_DEMCR_TRCENA_Msk) != 0U);
+  /* The first task runs without traceTASK_SWITCHED_IN, its time counts from PROF_Init() */
+  MOCK_DWT.CYCCNT = TEST_TIME_START;
+  PROF_Reset();
+  pCur = TEST_Schedule(&TEST_aTask[3], TEST_NUM_SWITCHES, TEST_TIME_START);
+  TEST_CHECK(MOCK_DWT.CYCCNT < TEST_TIME_START);             /* The counter has wrapped around */
+  TEST_CHECK_EQ(TEST_NumSlots, PROF_MAX_TASKS);
+  TEST_CheckStats();
+  NumEvents = TEST_Export();
+  TEST_CHECK_EQ(NumEvents, PROF_NUM_EVENTS);                  /* Nothing drained, the ring is full */
+  TEST_CHECK_EQ(TEST_LoadU32(16), TEST_NumEvents - PROF_NUM_EVENTS);
+  TEST_CHECK_EQ(TEST_NumCriticalErrors, 0U);
+  printf("Profiler: %u switches, %lu events, %lu dropped, %.1f s virtual\n",
+         (unsigned)TEST_NUM_SWITCHES, (unsigned long)TEST_NumEvents, (unsigned long)TEST_LoadU32(16),
+         (double)(uint32_t)(MOCK_DWT.CYCCNT - TEST_TIME_START) / TEST_CPU_CLOCK);
+  /* Short run without dropped events for the decoder */
+  PROF_Reset();
+  memset(TEST_aSlot, 0, sizeof(TEST_aSlot));
+  memset(TEST_aIrqCount, 0, sizeof(TEST_aIrqCount));
+  memset(TEST_aIrqCycles, 0, sizeof(TEST_aIrqCycles));
+  for (i = 0; i < TEST_NUM_TASKS; i++)
+  {
+    TEST_aTask[i].IsReady = 0;
+  }
+  TEST_NumEvents = 0;
+  (void)TEST_Schedule(pCur, TEST_NUM_SHORT_SWITCHES, MOCK_DWT.CYCCNT);
+  TEST_CheckStats();
+  TEST_CHECK(TEST_NumEvents < PROF_NUM_EVENTS);
+  NumEvents = TEST_Export();
+  TEST_CHECK_EQ(NumEvents, TEST_NumEvents);
+  TEST_CHECK_EQ(TEST_LoadU32(16), 0U);
+  if (sFile != NULL)
+  {
+    pFile = fopen(sFile, "wb");
+    TEST_CHECK(pFile != NULL);
+    if (pFile != NULL)
+    {
+      TEST_CHECK_EQ(fwrite(TEST_abExport, 1, TEST_ExportLen, pFile), TEST_ExportLen);
+      (void)fclose(pFile);
+      printf("Export: %lu bytes written to %s\n", (unsigned long)TEST_ExportLen, sFile);
+    }
+  }
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Critical section of the FreeRTOS mock.
+  */
+void MOCK_EnterCritical(void)
+{
+  TEST_CriticalNesting++;
+}
+
+void MOCK_ExitCritical(void)
+{
+  if (TEST_CriticalNesting <= 0)
+  {
+    TEST_NumCriticalErrors++;
+    return;
+  }
+  TEST_CriticalNesting--;
+}
+
+/**
+  * @brief  Task API of the FreeRTOS mock.
+  */
+UBaseType_t uxTaskGetTaskNumber(TaskHandle_t xTask)
+{
+  return xTask->Number;
+}
+
+void vTaskSetTaskNumber(TaskHandle_t xTask, const UBaseType_t uxHandle)
+{
+  xTask->Number = uxHandle;
+}
+
+char *pcTaskGetName(TaskHandle_t xTaskToQuery)
+{
+  return xTaskToQuery->acName;
+}
+
+/**
+  * @brief  Runs the test.
+  * @param  argv[1]: Optional file the export of the short run is written to.
+  */
+int main(int argc, char **argv)
+{
+  TEST_Ring();
+  TEST_RingThreads();
+  TEST_Profiler((argc > 1) ? argv[1] : NULL);
+  return TEST_Report("PROF_Test");
+}
@@ -0,0 +1,373 @@
+/**
+  ******************************************************************************
+  * @file    SCHED_SelectBench.c
+  * @brief   Host test of the reduced priority map of the CM7 (FreeRTOSConfig.h)
+  *          and benchmark of the task selection it enables.
+  *
+  *          1. Map: every osPriority_t maps below configMAX_PRIORITIES, the
+  *             order of the priorities is kept, levels +0 .. +3 of a class
+  *             are distinct and convert back unchanged, the timer service
+  *             task lies between osPriorityIdle and osPriorityLow, and the
+  *             port optimised task selection is enabled.
+  *          2. Selection: a simulated scheduler runs the same sequence of
+  *             wakeups and blocking calls of a task set spread over all
+  *             priority classes three times:
+  *               - 1:1 map, 56 priorities, generic selection (tasks.c walks
+  *                 down from uxTopReadyPriority over empty ready lists),
+  *               - reduced map, 28 priorities, generic selection,
+  *               - reduced map, 28 priorities, CLZ on the ready bitmap
+  *                 (portGET_HIGHEST_PRIORITY of the ARM_CM4F port).
+  *             All three must select the same task after every event. The
+  *             empty ready lists visited per selection and the host time
+  *             per event (list update and selection) are reported.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "FreeRTOSConfig.h"
+#include "cmsis_os2.h"
+#include "test_check.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+  * @brief  Ready list of one priority, FIFO of task indices.
+  */
+typedef struct
+{
+  uint8_t aTask[16];
+  uint8_t Head;
+  uint8_t Count;
+} TEST_ListTypeDef;
+
+/**
+  * @brief  Simulated scheduler.
+  */
+typedef struct
+{
+  TEST_ListTypeDef aList[56];
+  uint8_t          aPrio[16];          /*!< FreeRTOS priority of each task */
+  uint8_t          aIsReady[16];
+  uint32_t         TopReadyPriority;   /*!< Index or bitmap (UseClz)      */
+  int              UseClz;
+  uint64_t         NumVisited;
+  uint32_t         MaxVisited;
+} TEST_SchedTypeDef;
+
+/* Private define ------------------------------------------------------------*/
+#define TEST_NUM_EVENTS         2000000U
+#define TEST_NUM_RUNS           5U
+#define TEST_IDLE_TASK          0U
+
+/* Private variables ---------------------------------------------------------*/
+uint32_t SystemCoreClock = 480000000U;
+
+static uint32_t          TEST_Rand = 0x2468ACE1U;
+static uint32_t         *TEST_pRand;
+static uint8_t          *TEST_pSelected;
+static TEST_SchedTypeDef TEST_Sched;
+
+/* Task set: idle task, timer service task, and application tasks spread over
+   the classes (osPriority_t, 0 = native priority given below). */
+static const int32_t TEST_aTaskPrio[] =
+{
+  0,                              /* Idle task, native 0 */
+  0,                              /* Timer service task, native configTIMER_TASK_PRIORITY */
+  osPriorityLow,
+  osPriorityBelowNormal,
+  osPriorityNormal,
+  osPriorityNormal1,
+  osPriorityAboveNormal,
+  osPriorityHigh,
+  osPriorityHigh2,
+  osPriorityRealtime,
+  osPriorityRealtime3,
+};
+#define TEST_NUM_TASKS  (sizeof(TEST_aTaskPrio) / sizeof(TEST_aTaskPrio[0]))
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Returns the monotonic host time in nanoseconds.
+  */
+static uint64_t TEST_GetTime_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+}
+
+/**
+  * @brief  Returns a pseudo random number (24 bits).
+  */
+static uint32_t TEST_GetRand(void)
+{
+  TEST_Rand = TEST_Rand * 1103515245U + 12345U;
+  return TEST_Rand >> 8;
+}
+
+/**
+  * @brief  Adds a task to its ready list (prvAddTaskToReadyList()).
+  */
+static inline void TEST_AddReady(TEST_SchedTypeDef *pSched, unsigned Task)
+{
+  TEST_ListTypeDef *pList;
+  unsigned          Prio;
+
+  Prio  = pSched->aPrio[Task];
+  pList = &pSched->aList[Prio];
+  pList->aTask[(pList->Head + pList->Count) & 15U] = (uint8_t)Task;
+  pList->Count++;
+  pSched->aIsReady[Task] = 1;
+  if (pSched->UseClz != 0)
+  {
+    pSched->TopReadyPriority |= 1UL << Prio;      /* portRECORD_READY_PRIORITY */
+  }
+  else if (Prio > pSched->TopReadyPriority)
+  {
+    pSched->TopReadyPriority = Prio;              /* taskRECORD_READY_PRIORITY */
+  }
+}
+
+/**
+  * @brief  Removes the running task (head of its list) from the ready list.
+  */
+static inline void TEST_Block(TEST_SchedTypeDef *pSched, unsigned Task)
+{
+  TEST_ListTypeDef *pList;
+  unsigned          Prio;
+
+  Prio  = pSched->aPrio[Task];
+  pList = &pSched->aList[Prio];
+  pList->Head = (pList->Head + 1U) & 15U;
+  pList->Count--;
+  pSched->aIsReady[Task] = 0;
+  if ((pSched->UseClz != 0) && (pList->Count == 0U))
+  {
+    pSched->TopReadyPriority &= ~(1UL << Prio);   /* portRESET_READY_PRIORITY */
+  }
+}
+
+/**
+  * @brief  taskSELECT_HIGHEST_PRIORITY_TASK(), returns the task to run.
+  */
+static inline unsigned TEST_Select(TEST_SchedTypeDef *pSched)
+{
+  unsigned Prio;
+  uint32_t NumVisited;
+
+  if (pSched->UseClz != 0)
+  {
+    Prio = 31U - (unsigned)__builtin_clz(pSched->TopReadyPriority);
+  }
+  else
+  {
+    Prio       = pSched->TopReadyPriority;
+    NumVisited = 0;
+    while (pSched->aList[Prio].Count == 0U)
+    {
+      Prio--;
+      NumVisited++;
+    }
+    pSched->TopReadyPriority = Prio;
+    pSched->NumVisited += NumVisited;
+    if (NumVisited > pSched->MaxVisited)
+    {
+      pSched->MaxVisited = NumVisited;
+    }
+  }
+  return pSched->aList[Prio].aTask[pSched->aList[Prio].Head];
+}
+
+/**
+  * @brief  Sets up the scheduler with all tasks ready.
+  * @param  UseMap: Convert with configOS2_PRIO_TO_NATIVE() instead of 1:1.
+  */
+static void TEST_InitSched(TEST_SchedTypeDef *pSched, int UseMap, int UseClz)
+{
+  unsigned Task;
+  int32_t  Prio;
+
+  memset(pSched, 0, sizeof(*pSched));
+  pSched->UseClz = UseClz;
+  for (Task = 0; Task < TEST_NUM_TASKS; Task++)
+  {
+    Prio = TEST_aTaskPrio[Task];
+    if (Task == 1U)
+    {
+      Prio = configTIMER_TASK_PRIORITY;
+    }
+    else if ((Prio != 0) && (UseMap != 0))
+    {
+      Prio = (int32_t)configOS2_PRIO_TO_NATIVE((uint32_t)Prio);
+    }
+    pSched->aPrio[Task] = (uint8_t)Prio;
+    TEST_AddReady(pSched, Task);
+  }
+}
+
+/**
+  * @brief  Runs the event sequence. An event either wakes a blocked task
+  *         (tick or interrupt) or blocks the running task; the idle task
+  *         never blocks. The task selected after each event is stored
+  *         (Record != 0) or compared with the stored one.
+  * @retval Mismatches.
+  */
+static uint32_t TEST_Run(TEST_SchedTypeDef *pSched, int Record)
+{
+  uint32_t i;
+  uint32_t NumMismatches;
+  uint32_t r;
+  unsigned Running;
+  unsigned Task;
+
+  NumMismatches = 0;
+  Running = TEST_Select(pSched);
+  for (i = 0; i < TEST_NUM_EVENTS; i++)
+  {
+    r    = TEST_pRand[i];
+    Task = 1U + (r >> 1) % (unsigned)(TEST_NUM_TASKS - 1U);
+    if (((r & 1U) != 0U) || (Running == TEST_IDLE_TASK))
+    {
+      if (pSched->aIsReady[Task] == 0U)
+      {
+        TEST_AddReady(pSched, Task);
+      }
+    }
+    else
+    {
+      TEST_Block(pSched, Running);
+    }
+    Running = TEST_Select(pSched);
+    if (Record != 0)
+    {
+      TEST_pSelected[i] = (uint8_t)Running;
+    }
+    else if (TEST_pSelected[i] != Running)
+    {
+      NumMismatches++;
+    }
+  }
+  return NumMismatches;
+}
+
+/**
+  * @brief  Checks the priority map.
+  */
+static void TEST_Map(void)
+{
+  uint32_t Prio;
+  uint32_t Native;
+  uint32_t Last;
+
+  TEST_CHECK_EQ(configUSE_PORT_OPTIMISED_TASK_SELECTION, 1);
+  TEST_CHECK(configMAX_PRIORITIES <= 32);
+  TEST_CHECK_EQ(configOS2_PRIO_TO_NATIVE(osPriorityNone), 0);
+  TEST_CHECK_EQ(configOS2_PRIO_TO_NATIVE(osPriorityIdle), 1);
+  TEST_CHECK(configOS2_PRIO_TO_NATIVE(osPriorityIdle) < configTIMER_TASK_PRIORITY);
+  TEST_CHECK(configTIMER_TASK_PRIORITY < configOS2_PRIO_TO_NATIVE(osPriorityLow));
+  TEST_CHECK_EQ(configOS2_PRIO_TO_NATIVE(osPriorityISR), configMAX_PRIORITIES - 1);
+  TEST_CHECK_EQ(configOS2_PRIO_FROM_NATIVE(configOS2_PRIO_TO_NATIVE(osPriorityISR)), osPriorityISR);
+  TEST_CHECK_EQ(configOS2_PRIO_FROM_NATIVE(configOS2_PRIO_TO_NATIVE(osPriorityIdle)), osPriorityIdle);
+  Last = configOS2_PRIO_TO_NATIVE(osPriorityIdle);
+  for (Prio = osPriorityLow; Prio <= osPriorityISR; Prio++)
+  {
+    Native = configOS2_PRIO_TO_NATIVE(Prio);
+    TEST_CHECK(Native < configMAX_PRIORITIES);
+    TEST_CHECK(Native >= Last);
+    if ((Prio & 7U) <= 3U)
+    {
+      TEST_CHECK(Native > Last);
+      TEST_CHECK_EQ(configOS2_PRIO_FROM_NATIVE(Native), Prio);
+    }
+    else
+    {
+      TEST_CHECK_EQ(Native, configOS2_PRIO_TO_NATIVE(Prio & ~7U) + 3U);
+    }
+    Last = Native;
+  }
+}
+
+/**
+  * @brief  Runs one configuration and reports it.
+  */
+static void TEST_Bench(const char *sName, int UseMap, int UseClz, int Record)
+{
+  uint64_t t0;
+  uint64_t tMin;
+  uint64_t t;
+  unsigned Run;
+  uint32_t NumMismatches;
+
+  tMin = UINT64_MAX;
+  NumMismatches = 0;
+  for (Run = 0; Run < TEST_NUM_RUNS; Run++)
+  {
+    TEST_InitSched(&TEST_Sched, UseMap, UseClz);
+    t0 = TEST_GetTime_ns();
+    NumMismatches += TEST_Run(&TEST_Sched, ((Record != 0) && (Run == 0U)) ? 1 : 0);
+    t = TEST_GetTime_ns() - t0;
+    if (t < tMin)
+    {
+      tMin = t;
+    }
+  }
+  TEST_CHECK_EQ(NumMismatches, 0);
+  if (UseClz != 0)
+  {
+    printf("%-46s: %5.1f ns per event, selection O(1)\n", sName, (double)tMin / TEST_NUM_EVENTS);
+  }
+  else
+  {
+    printf("%-46s: %5.1f ns per event, %5.2f empty lists visited per selection (max. %lu)\n",
+           sName, (double)tMin / TEST_NUM_EVENTS,
+           (double)TEST_Sched.NumVisited / TEST_NUM_EVENTS, (unsigned long)TEST_Sched.MaxVisited);
+  }
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+int main(void)
+{
+  uint32_t i;
+  uint64_t NumVisited1To1;
+  uint32_t MaxVisited1To1;
+
+  TEST_Map();
+  TEST_pRand     = (uint32_t *)malloc(TEST_NUM_EVENTS * sizeof(uint32_t));
+  TEST_pSelected = (uint8_t *)malloc(TEST_NUM_EVENTS);
+  TEST_CHECK((TEST_pRand != NULL) && (TEST_pSelected != NULL));
+  if ((TEST_pRand == NULL) || (TEST_pSelected == NULL))
+  {
+    return TEST_Report("SCHED_SelectBench");
+  }
+  for (i = 0; i < TEST_NUM_EVENTS; i++)
+  {
+    TEST_pRand[i] = TEST_GetRand();
+  }
+  TEST_Bench("1:1 map, 56 priorities, generic selection", 0, 0, 1);
+  NumVisited1To1 = TEST_Sched.NumVisited;
+  MaxVisited1To1 = TEST_Sched.MaxVisited;
+  TEST_Bench("Reduced map, 28 priorities, generic selection", 1, 0, 0);
+  TEST_CHECK(TEST_Sched.NumVisited < NumVisited1To1);
+  TEST_CHECK(TEST_Sched.MaxVisited < MaxVisited1To1);
+  TEST_CHECK(TEST_Sched.MaxVisited < configMAX_PRIORITIES);
+  TEST_Bench("Reduced map, 28 priorities, CLZ selection", 1, 1, 0);
+  free(TEST_pRand);
+  free(TEST_pSelected);
+  return TEST_Report("SCHED_SelectBench");
+}
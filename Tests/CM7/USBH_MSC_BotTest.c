@@ -0,0 +1,873 @@
+/**
+  ******************************************************************************
+  * @file    USBH_MSC_BotTest.c
+  * @brief   Host test of the ST USB Host MSC class (usbh_msc.c, usbh_msc_bot.c,
+  *          usbh_msc_scsi.c) on the low level driver of the CM7
+  *          (USB_HOST/Target/usbh_conf.c).
+  *
+  *          The HCD functions are a model of the OTG_FS host channels in
+  *          slave mode on a virtual clock: a full speed bus that moves one
+  *          64-byte packet in 52.7 us, an interrupt per packet, and the URB
+  *          state change notified from the interrupt after the last packet.
+  *          The channels talk to a Bulk-Only Transport device with a RAM
+  *          disk. The CMSIS-RTOS semaphore of usbh_conf.c runs on the same
+  *          clock; a blocking acquire costs a task wake up.
+  *
+  *          1. Initialization: the semaphore of USBH_LL_Init(), the MSC
+  *             interface and its pipes.
+  *          2. Transfers: random reads and writes, some OUT URBs NAKed by
+  *             the device, checked against a copy of the disk, once with
+  *             the transfer loop polling (the behaviour before the wait on
+  *             the URB event) and once sleeping on the URB event. Every
+  *             data IN URB is whole packets, every OUT URB fits the
+  *             non-periodic Tx FIFO, and the URBs per command match the data
+  *             stage size.
+  *          3. Short data stage: the device sends less data than asked for,
+  *             the short packet ends the data stage and the CSW follows.
+  *          4. Throughput: sequential reads and writes of 16 KB, reported
+  *             in KB/s with the CPU load of the task and the interrupts.
+  *
+  *          The test is built twice: with the URB sizes of usbh_msc_bot.h,
+  *          and with one packet per URB (USBH_MSC_BOT_MAX_IN_XFER and
+  *          USBH_MSC_BOT_MAX_OUT_XFER of 64), the data stages as they were
+  *          before. Both report the same table for the comparison.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "usbh_msc.h"
+#include "usbh_platform.h"
+#include "test_check.h"
+
+/* Private define ------------------------------------------------------------*/
+#define TEST_EP_SIZE            64U
+#define TEST_IN_EP              0x81U
+#define TEST_OUT_EP             0x01U
+#define TEST_SECTOR_SIZE        512U
+#define TEST_NUM_SECTORS        4096U
+#define TEST_MAX_SECTORS        32U           /* Per command */
+#define TEST_NUM_COMMANDS       400U
+#define TEST_BENCH_BYTES        (1024U * 1024U)
+#define TEST_NPTX_FIFO_SIZE     1024U         /* Non-periodic Tx FIFO of USB_HostInit(), bytes */
+
+#define TEST_PACKET_OVERHEAD    15U           /* Token, PIDs, CRC, handshake and gaps, bytes */
+#define TEST_ISR_NS             1500U         /* OTG interrupt per packet */
+#define TEST_STEP_NS            300U          /* One call of the state machine */
+#define TEST_SUBMIT_NS          500U          /* Start of a channel */
+#define TEST_WAKE_NS            4000U         /* Semaphore release to running task */
+#define TEST_TAKE_NS            200U          /* Semaphore acquire without blocking */
+
+#define TEST_CBW_SIGNATURE      0x43425355U
+#define TEST_CSW_SIGNATURE      0x53425355U
+#define TEST_OPCODE_READ10      0x28U
+#define TEST_OPCODE_WRITE10     0x2AU
+
+/* Private typedef -----------------------------------------------------------*/
+typedef enum
+{
+  TEST_DEV_CBW = 0,
+  TEST_DEV_DATA_IN,
+  TEST_DEV_DATA_OUT,
+  TEST_DEV_CSW
+} TEST_DevStateTypeDef;
+
+typedef struct
+{
+  TEST_DevStateTypeDef State;
+  uint32_t             Tag;
+  uint32_t             Offset;                /* Disk offset of the data stage */
+  uint32_t             NumBytes;              /* Left in the data stage */
+  uint32_t             Residue;
+  uint32_t             ShortBy;               /* Next read sends less data */
+  uint32_t             NakRate;               /* 1 in n data OUT URBs NAKed, 0 for none */
+  uint32_t             NumErrors;
+} TEST_DevTypeDef;
+
+typedef struct
+{
+  uint64_t            DoneNs;
+  uint32_t            Pending;
+  HCD_URBStateTypeDef Result;
+  uint32_t            Count;
+} TEST_ChanTypeDef;
+
+typedef struct
+{
+  uint32_t Count;
+  uint32_t MaxCount;
+} TEST_SemTypeDef;
+
+typedef struct
+{
+  double   KBytesPerSec;
+  double   CpuLoad;
+  double   UrbsPerCmd;
+  double   WakesPerCmd;
+} TEST_BenchTypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+extern HCD_HandleTypeDef hhcd_USB_OTG_FS;
+
+static uint32_t           TEST_Rand = 0x13579BDFU;
+static USBH_HandleTypeDef TEST_Host;
+static TEST_DevTypeDef    TEST_Dev;
+static TEST_ChanTypeDef   TEST_aChan[16];
+static TEST_SemTypeDef    TEST_aSem[2];
+static uint32_t           TEST_NumSems;
+static uint64_t           TEST_T;             /* Virtual time in ns */
+static uint64_t           TEST_BusFree;       /* End of the last packet on the bus */
+static uint64_t           TEST_Busy;          /* CPU time of the task and the interrupts */
+static uint32_t           TEST_PollMode;      /* Transfer loop does not sleep */
+static uint32_t           TEST_NumUrbs;
+static uint32_t           TEST_NumNaks;
+static uint32_t           TEST_NumWakes;
+static uint32_t           TEST_NumUrbErrors;  /* Data IN URB not whole packets, OUT URB above the FIFO */
+static uint32_t           TEST_NumErrorHandler;
+static uint8_t            TEST_aDisk[TEST_NUM_SECTORS * TEST_SECTOR_SIZE];
+static uint8_t            TEST_aRef[TEST_NUM_SECTORS * TEST_SECTOR_SIZE];
+static uint8_t            TEST_aBuf[TEST_MAX_SECTORS * TEST_SECTOR_SIZE + 256U];
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Xorshift pseudo random generator.
+  */
+static uint32_t TEST_GetRandFrom(uint32_t *pState)
+{
+  uint32_t x;
+
+  x = *pState;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *pState = x;
+  return x;
+}
+
+static uint32_t TEST_GetRand(void)
+{
+  return TEST_GetRandFrom(&TEST_Rand);
+}
+
+static void TEST_Fill(uint8_t *p, uint32_t NumBytes)
+{
+  while (NumBytes--)
+  {
+    *p++ = (uint8_t)TEST_GetRand();
+  }
+}
+
+static uint32_t TEST_LoadU32(const uint8_t *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void TEST_StoreU32(uint8_t *p, uint32_t v)
+{
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  p[2] = (uint8_t)(v >> 16);
+  p[3] = (uint8_t)(v >> 24);
+}
+
+/**
+  * @brief  Bus time of a transfer, in packets of the endpoint size. Each
+  *         packet also costs an interrupt.
+  */
+static uint64_t TEST_GetBusTime(uint32_t NumBytes)
+{
+  uint64_t t;
+
+  t = 0U;
+  do
+  {
+    uint32_t n = (NumBytes > TEST_EP_SIZE) ? TEST_EP_SIZE : NumBytes;
+
+    t         += ((uint64_t)(n + TEST_PACKET_OVERHEAD) * 2000U) / 3U;  /* 12 Mbit/s */
+    TEST_Busy += TEST_ISR_NS;
+    NumBytes  -= n;
+  } while (NumBytes != 0U);
+  return t;
+}
+
+/**
+  * @brief  Advances the virtual time. The channels that complete on the way
+  *         notify their URB state as the OTG interrupt does.
+  */
+static void TEST_Advance(uint64_t T)
+{
+  uint32_t i;
+  uint32_t iFirst;
+
+  for (;;)
+  {
+    iFirst = 16U;
+    for (i = 0U; i < 16U; i++)
+    {
+      if ((TEST_aChan[i].Pending != 0U) && (TEST_aChan[i].DoneNs <= T) &&
+          ((iFirst == 16U) || (TEST_aChan[i].DoneNs < TEST_aChan[iFirst].DoneNs)))
+      {
+        iFirst = i;
+      }
+    }
+    if (iFirst == 16U)
+    {
+      break;
+    }
+    if (TEST_aChan[iFirst].DoneNs > TEST_T)
+    {
+      TEST_T = TEST_aChan[iFirst].DoneNs;
+    }
+    TEST_aChan[iFirst].Pending = 0U;
+    hhcd_USB_OTG_FS.hc[iFirst].xfer_count = TEST_aChan[iFirst].Count;
+    hhcd_USB_OTG_FS.hc[iFirst].urb_state  = TEST_aChan[iFirst].Result;
+    HAL_HCD_HC_NotifyURBChange_Callback(&hhcd_USB_OTG_FS, (uint8_t)iFirst, TEST_aChan[iFirst].Result);
+  }
+  if (T > TEST_T)
+  {
+    TEST_T = T;
+  }
+  TEST_Host.Timer = (uint32_t)(TEST_T / 1000000U);   /* SOF every ms */
+}
+
+/**
+  * @brief  CPU time spent by the task.
+  */
+static void TEST_Run(uint32_t Ns)
+{
+  TEST_Busy += Ns;
+  TEST_Advance(TEST_T + Ns);
+}
+
+/**
+  * @brief  Earliest pending channel completion, 0 for none.
+  */
+static uint64_t TEST_GetNextDone(void)
+{
+  uint64_t t;
+  uint32_t i;
+
+  t = 0U;
+  for (i = 0U; i < 16U; i++)
+  {
+    if ((TEST_aChan[i].Pending != 0U) && ((t == 0U) || (TEST_aChan[i].DoneNs < t)))
+    {
+      t = TEST_aChan[i].DoneNs;
+    }
+  }
+  return t;
+}
+
+/**
+  * @brief  Device side of an OUT URB: CBW or data.
+  */
+static HCD_URBStateTypeDef TEST_DevOut(const uint8_t *pData, uint32_t NumBytes, uint32_t *pCount)
+{
+  uint32_t NumSectors;
+  uint32_t Lba;
+
+  *pCount = 0U;
+  switch (TEST_Dev.State)
+  {
+    case TEST_DEV_CBW:
+      if ((NumBytes != 31U) || (TEST_LoadU32(pData) != TEST_CBW_SIGNATURE))
+      {
+        TEST_Dev.NumErrors++;
+        return URB_STALL;
+      }
+      TEST_Dev.Tag      = TEST_LoadU32(pData + 4);
+      TEST_Dev.NumBytes = TEST_LoadU32(pData + 8);
+      TEST_Dev.Residue  = 0U;
+      Lba        = ((uint32_t)pData[17] << 24) | ((uint32_t)pData[18] << 16) | ((uint32_t)pData[19] << 8) | pData[20];
+      NumSectors = ((uint32_t)pData[22] << 8) | pData[23];
+      if ((Lba + NumSectors > TEST_NUM_SECTORS) || (TEST_Dev.NumBytes != NumSectors * TEST_SECTOR_SIZE))
+      {
+        TEST_Dev.NumErrors++;
+        return URB_STALL;
+      }
+      TEST_Dev.Offset = Lba * TEST_SECTOR_SIZE;
+      if ((pData[15] == TEST_OPCODE_READ10) && ((pData[12] & 0x80U) != 0U))
+      {
+        TEST_Dev.NumBytes -= TEST_Dev.ShortBy;
+        TEST_Dev.Residue   = TEST_Dev.ShortBy;
+        TEST_Dev.ShortBy   = 0U;
+        TEST_Dev.State     = TEST_DEV_DATA_IN;
+      }
+      else if ((pData[15] == TEST_OPCODE_WRITE10) && ((pData[12] & 0x80U) == 0U))
+      {
+        TEST_Dev.State = TEST_DEV_DATA_OUT;
+      }
+      else
+      {
+        TEST_Dev.NumErrors++;
+        return URB_STALL;
+      }
+      *pCount = NumBytes;
+      return URB_DONE;
+
+    case TEST_DEV_DATA_OUT:
+      if (NumBytes > TEST_Dev.NumBytes)
+      {
+        TEST_Dev.NumErrors++;
+        return URB_STALL;
+      }
+      if ((TEST_Dev.NakRate != 0U) && ((TEST_GetRand() % TEST_Dev.NakRate) == 0U))
+      {
+        TEST_NumNaks++;
+        return URB_NOTREADY;
+      }
+      memcpy(&TEST_aDisk[TEST_Dev.Offset], pData, NumBytes);
+      TEST_Dev.Offset   += NumBytes;
+      TEST_Dev.NumBytes -= NumBytes;
+      if (TEST_Dev.NumBytes == 0U)
+      {
+        TEST_Dev.State = TEST_DEV_CSW;
+      }
+      *pCount = NumBytes;
+      return URB_DONE;
+
+    default:
+      TEST_Dev.NumErrors++;
+      return URB_STALL;
+  }
+}
+
+/**
+  * @brief  Device side of an IN URB: data or CSW.
+  */
+static HCD_URBStateTypeDef TEST_DevIn(uint8_t *pData, uint32_t NumBytes, uint32_t *pCount)
+{
+  uint32_t n;
+
+  *pCount = 0U;
+  switch (TEST_Dev.State)
+  {
+    case TEST_DEV_DATA_IN:
+      n = (NumBytes < TEST_Dev.NumBytes) ? NumBytes : TEST_Dev.NumBytes;
+      memcpy(pData, &TEST_aDisk[TEST_Dev.Offset], n);
+      TEST_Dev.Offset   += n;
+      TEST_Dev.NumBytes -= n;
+      if (TEST_Dev.NumBytes == 0U)
+      {
+        TEST_Dev.State = TEST_DEV_CSW;
+      }
+      *pCount = n;
+      return URB_DONE;
+
+    case TEST_DEV_CSW:
+      if (NumBytes < 13U)
+      {
+        TEST_Dev.NumErrors++;
+        return URB_STALL;
+      }
+      TEST_StoreU32(pData, TEST_CSW_SIGNATURE);
+      TEST_StoreU32(pData + 4, TEST_Dev.Tag);
+      TEST_StoreU32(pData + 8, TEST_Dev.Residue);
+      pData[12]      = 0U;
+      TEST_Dev.State = TEST_DEV_CBW;
+      *pCount = 13U;
+      return URB_DONE;
+
+    default:
+      TEST_Dev.NumErrors++;
+      return URB_STALL;
+  }
+}
+
+/**
+  * @brief  Connects the host to the device and initializes the MSC class
+  *         on the interface of the device.
+  */
+static void TEST_Init(void)
+{
+  MSC_HandleTypeDef *MSC_Handle;
+
+  TEST_Host.id = HOST_FS;
+  TEST_CHECK_EQ(USBH_LL_Init(&TEST_Host), USBH_OK);
+  TEST_CHECK_EQ(TEST_NumSems, 1);
+  TEST_CHECK(hhcd_USB_OTG_FS.pData == &TEST_Host);
+  TEST_CHECK(TEST_Host.pData == &hhcd_USB_OTG_FS);
+
+  TEST_Host.device.address = USBH_DEVICE_ADDRESS;
+  TEST_Host.device.speed   = USBH_SPEED_FULL;
+  TEST_Host.device.CfgDesc.Itf_Desc[0].Ep_Desc[0].bEndpointAddress = TEST_IN_EP;
+  TEST_Host.device.CfgDesc.Itf_Desc[0].Ep_Desc[0].wMaxPacketSize   = TEST_EP_SIZE;
+  TEST_Host.device.CfgDesc.Itf_Desc[0].Ep_Desc[1].bEndpointAddress = TEST_OUT_EP;
+  TEST_Host.device.CfgDesc.Itf_Desc[0].Ep_Desc[1].wMaxPacketSize   = TEST_EP_SIZE;
+  TEST_Host.pActiveClass = &USBH_msc;
+  TEST_CHECK_EQ(USBH_msc.Init(&TEST_Host), USBH_OK);
+
+  MSC_Handle = (MSC_HandleTypeDef *)TEST_Host.pActiveClass->pData;
+  TEST_CHECK_EQ(MSC_Handle->InEpSize, TEST_EP_SIZE);
+  TEST_CHECK_EQ(MSC_Handle->OutEpSize, TEST_EP_SIZE);
+  TEST_CHECK(MSC_Handle->InPipe != MSC_Handle->OutPipe);
+  TEST_CHECK_EQ(hhcd_USB_OTG_FS.hc[MSC_Handle->InPipe].ep_is_in, 1);
+  TEST_CHECK_EQ(hhcd_USB_OTG_FS.hc[MSC_Handle->OutPipe].ep_is_in, 0);
+
+  /* Enumerated and LUN 0 ready */
+  TEST_Host.device.is_connected = 1U;
+  TEST_Host.device.PortEnabled  = 1U;
+  TEST_Host.gState              = HOST_CLASS;
+  MSC_Handle->state             = MSC_IDLE;
+  MSC_Handle->max_lun           = 1U;
+  MSC_Handle->unit[0].state     = MSC_IDLE;
+  MSC_Handle->unit[0].capacity.block_nbr  = TEST_NUM_SECTORS;
+  MSC_Handle->unit[0].capacity.block_size = TEST_SECTOR_SIZE;
+}
+
+/**
+  * @brief  URBs of a command without NAKs: CBW, data stage and CSW.
+  */
+static uint32_t TEST_GetNumUrbs(uint32_t NumBytes, uint32_t MaxXfer)
+{
+  return 2U + ((NumBytes + MaxXfer - 1U) / MaxXfer);
+}
+
+/**
+  * @brief  One read or write, checked against the reference copy of the disk.
+  */
+static void TEST_Transfer(int IsWrite, uint32_t Lba, uint32_t NumSectors)
+{
+  uint32_t NumBytes;
+  uint32_t NumUrbs;
+  uint32_t NumNaks;
+  USBH_StatusTypeDef Status;
+
+  NumBytes = NumSectors * TEST_SECTOR_SIZE;
+  NumUrbs  = TEST_NumUrbs;
+  NumNaks  = TEST_NumNaks;
+  if (IsWrite)
+  {
+    TEST_Fill(TEST_aBuf, NumBytes);
+    memcpy(&TEST_aRef[Lba * TEST_SECTOR_SIZE], TEST_aBuf, NumBytes);
+    Status = USBH_MSC_Write(&TEST_Host, 0U, Lba, TEST_aBuf, NumSectors);
+    TEST_CHECK_EQ(Status, USBH_OK);
+    TEST_CHECK_EQ(TEST_NumUrbs - NumUrbs - (TEST_NumNaks - NumNaks),
+                  TEST_GetNumUrbs(NumBytes, USBH_MSC_BOT_MAX_OUT_XFER));
+  }
+  else
+  {
+    memset(TEST_aBuf, 0xA5, sizeof(TEST_aBuf));
+    Status = USBH_MSC_Read(&TEST_Host, 0U, Lba, TEST_aBuf, NumSectors);
+    TEST_CHECK_EQ(Status, USBH_OK);
+    TEST_CHECK(memcmp(TEST_aBuf, &TEST_aRef[Lba * TEST_SECTOR_SIZE], NumBytes) == 0);
+    TEST_CHECK_EQ(TEST_aBuf[NumBytes], 0xA5);
+    TEST_CHECK_EQ(TEST_NumUrbs - NumUrbs, TEST_GetNumUrbs(NumBytes, USBH_MSC_BOT_MAX_IN_XFER));
+  }
+  TEST_CHECK_EQ(TEST_Dev.State, TEST_DEV_CBW);
+}
+
+/**
+  * @brief  Random reads and writes, some data OUT URBs NAKed.
+  */
+static void TEST_Transfers(void)
+{
+  uint32_t i;
+  uint32_t Lba;
+  uint32_t NumSectors;
+
+  TEST_Dev.NakRate = 8U;
+  for (i = 0U; i < TEST_NUM_COMMANDS; i++)
+  {
+    NumSectors = 1U + (TEST_GetRand() % TEST_MAX_SECTORS);
+    Lba        = TEST_GetRand() % (TEST_NUM_SECTORS - NumSectors + 1U);
+    TEST_Transfer((TEST_GetRand() & 1U) != 0U, Lba, NumSectors);
+  }
+  TEST_Dev.NakRate = 0U;
+  TEST_CHECK(memcmp(TEST_aDisk, TEST_aRef, sizeof(TEST_aDisk)) == 0);
+  TEST_CHECK(TEST_NumNaks != 0U);
+  TEST_CHECK_EQ(TEST_Dev.NumErrors, 0);
+  TEST_CHECK_EQ(TEST_NumUrbErrors, 0);
+}
+
+/**
+  * @brief  The device ends the data stage early. The host takes the short
+  *         packet as the end of the data and reads the CSW next.
+  */
+static void TEST_ShortRead(void)
+{
+  static const uint32_t aShortBy[] = { 13U, 100U, 700U, 4200U };
+  uint32_t NumBytes;
+  uint32_t i;
+
+  for (i = 0U; i < sizeof(aShortBy) / sizeof(aShortBy[0]); i++)
+  {
+    NumBytes = 16U * TEST_SECTOR_SIZE;
+    memset(TEST_aBuf, 0xA5, sizeof(TEST_aBuf));
+    TEST_Dev.ShortBy = aShortBy[i];
+    TEST_CHECK_EQ(USBH_MSC_Read(&TEST_Host, 0U, 64U, TEST_aBuf, 16U), USBH_OK);
+    NumBytes -= aShortBy[i];
+    TEST_CHECK(memcmp(TEST_aBuf, &TEST_aRef[64U * TEST_SECTOR_SIZE], NumBytes) == 0);
+    TEST_CHECK_EQ(TEST_aBuf[NumBytes], 0xA5);
+    TEST_CHECK_EQ(TEST_Dev.State, TEST_DEV_CBW);
+    TEST_Transfer(0, 64U, 16U);
+  }
+  TEST_CHECK_EQ(TEST_Dev.NumErrors, 0);
+}
+
+/**
+  * @brief  Sequential transfers of TEST_MAX_SECTORS sectors.
+  */
+static void TEST_Bench(int IsWrite, TEST_BenchTypeDef *pResult)
+{
+  uint64_t T0;
+  uint64_t Busy0;
+  uint32_t NumUrbs;
+  uint32_t NumWakes;
+  uint32_t NumCmds;
+  uint32_t Lba;
+  double   Elapsed;
+
+  T0       = TEST_T;
+  Busy0    = TEST_Busy;
+  NumUrbs  = TEST_NumUrbs;
+  NumWakes = TEST_NumWakes;
+  NumCmds  = TEST_BENCH_BYTES / (TEST_MAX_SECTORS * TEST_SECTOR_SIZE);
+  for (Lba = 0U; Lba < NumCmds * TEST_MAX_SECTORS; Lba += TEST_MAX_SECTORS)
+  {
+    TEST_Transfer(IsWrite, Lba, TEST_MAX_SECTORS);
+  }
+  Elapsed = (double)(TEST_T - T0);
+  pResult->KBytesPerSec = ((double)TEST_BENCH_BYTES / 1024.0) / (Elapsed * 1e-9);
+  pResult->CpuLoad      = TEST_PollMode ? 100.0 : 100.0 * (double)(TEST_Busy - Busy0) / Elapsed;
+  pResult->UrbsPerCmd   = (double)(TEST_NumUrbs - NumUrbs) / NumCmds;
+  pResult->WakesPerCmd  = (double)(TEST_NumWakes - NumWakes) / NumCmds;
+}
+
+/* Model of the HCD, the RTOS and the host core ------------------------------*/
+
+/**
+  * @brief  Starts a channel. The device answers at once, the URB state
+  *         changes when the packets have been moved on the bus.
+  */
+HAL_StatusTypeDef HAL_HCD_HC_SubmitRequest(HCD_HandleTypeDef *hhcd, uint8_t ch_num, uint8_t direction,
+                                           uint8_t ep_type, uint8_t token, uint8_t *pbuff,
+                                           uint16_t length, uint8_t do_ping)
+{
+  TEST_ChanTypeDef *pChan;
+  uint64_t          Start;
+
+  (void)ep_type;
+  (void)token;
+  (void)do_ping;
+  TEST_Run(TEST_SUBMIT_NS);
+  TEST_NumUrbs++;
+  pChan = &TEST_aChan[ch_num];
+  hhcd->hc[ch_num].urb_state  = URB_IDLE;
+  hhcd->hc[ch_num].xfer_count = 0U;
+  if (direction == 0U)
+  {
+    if (length > TEST_NPTX_FIFO_SIZE)
+    {
+      TEST_NumUrbErrors++;
+    }
+    pChan->Result = TEST_DevOut(pbuff, length, &pChan->Count);
+  }
+  else
+  {
+    if ((TEST_Dev.State == TEST_DEV_DATA_IN) && ((length % TEST_EP_SIZE) != 0U))
+    {
+      TEST_NumUrbErrors++;
+    }
+    pChan->Result = TEST_DevIn(pbuff, length, &pChan->Count);
+  }
+  Start = (TEST_BusFree > TEST_T) ? TEST_BusFree : TEST_T;
+  TEST_BusFree   = Start + TEST_GetBusTime(pChan->Count);
+  pChan->DoneNs  = TEST_BusFree + TEST_ISR_NS;
+  pChan->Pending = 1U;
+  return HAL_OK;
+}
+
+HCD_URBStateTypeDef HAL_HCD_HC_GetURBState(HCD_HandleTypeDef *hhcd, uint8_t chnum)
+{
+  TEST_Run(TEST_STEP_NS);
+  return hhcd->hc[chnum].urb_state;
+}
+
+uint32_t HAL_HCD_HC_GetXferCount(HCD_HandleTypeDef *hhcd, uint8_t chnum)
+{
+  return hhcd->hc[chnum].xfer_count;
+}
+
+HAL_StatusTypeDef HAL_HCD_HC_Init(HCD_HandleTypeDef *hhcd, uint8_t ch_num, uint8_t epnum,
+                                  uint8_t dev_address, uint8_t speed, uint8_t ep_type, uint16_t mps)
+{
+  hhcd->hc[ch_num].ep_is_in   = ((epnum & 0x80U) != 0U) ? 1U : 0U;
+  hhcd->hc[ch_num].ep_num     = epnum & 0x7FU;
+  hhcd->hc[ch_num].dev_addr   = dev_address;
+  hhcd->hc[ch_num].speed      = speed;
+  hhcd->hc[ch_num].ep_type    = ep_type;
+  hhcd->hc[ch_num].max_packet = mps;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_HCD_HC_Halt(HCD_HandleTypeDef *hhcd, uint8_t ch_num)
+{
+  (void)hhcd;
+  TEST_aChan[ch_num].Pending = 0U;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_HCD_Init(HCD_HandleTypeDef *hhcd)
+{
+  HAL_HCD_MspInit(hhcd);
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_HCD_DeInit(HCD_HandleTypeDef *hhcd)
+{
+  HAL_HCD_MspDeInit(hhcd);
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_HCD_Start(HCD_HandleTypeDef *hhcd)
+{
+  (void)hhcd;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_HCD_Stop(HCD_HandleTypeDef *hhcd)
+{
+  (void)hhcd;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_HCD_ResetPort(HCD_HandleTypeDef *hhcd)
+{
+  (void)hhcd;
+  return HAL_OK;
+}
+
+uint32_t HAL_HCD_GetCurrentFrame(HCD_HandleTypeDef *hhcd)
+{
+  (void)hhcd;
+  return (uint32_t)(TEST_T / 1000000U);
+}
+
+uint32_t HAL_HCD_GetCurrentSpeed(HCD_HandleTypeDef *hhcd)
+{
+  (void)hhcd;
+  return 1U;    /* Full speed */
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+  TEST_Advance(TEST_T + (uint64_t)Delay * 1000000U);
+}
+
+/**
+  * @brief  Binary semaphore on the virtual clock. A blocking acquire runs
+  *         the clock to the next URB state change. In polling mode it fails
+  *         at once, and the transfer loop spins as it did before.
+  */
+osSemaphoreId_t osSemaphoreNew(uint32_t max_count, uint32_t initial_count, const osSemaphoreAttr_t *attr)
+{
+  TEST_SemTypeDef *pSem;
+
+  (void)attr;
+  if (TEST_NumSems >= 2U)
+  {
+    return NULL;
+  }
+  pSem = &TEST_aSem[TEST_NumSems++];
+  pSem->MaxCount = max_count;
+  pSem->Count    = initial_count;
+  return pSem;
+}
+
+osStatus_t osSemaphoreRelease(osSemaphoreId_t semaphore_id)
+{
+  TEST_SemTypeDef *pSem = (TEST_SemTypeDef *)semaphore_id;
+
+  if (pSem->Count >= pSem->MaxCount)
+  {
+    return osErrorResource;
+  }
+  pSem->Count++;
+  return osOK;
+}
+
+osStatus_t osSemaphoreAcquire(osSemaphoreId_t semaphore_id, uint32_t timeout)
+{
+  TEST_SemTypeDef *pSem = (TEST_SemTypeDef *)semaphore_id;
+  uint64_t         Deadline;
+  uint64_t         t;
+
+  if (TEST_PollMode)
+  {
+    return osErrorResource;
+  }
+  if (pSem->Count != 0U)
+  {
+    pSem->Count--;
+    TEST_Run(TEST_TAKE_NS);
+    return osOK;
+  }
+  Deadline = TEST_T + (uint64_t)timeout * 1000000U;
+  for (;;)
+  {
+    t = TEST_GetNextDone();
+    if ((t == 0U) || (t > Deadline))
+    {
+      TEST_Advance(Deadline);
+      return osErrorTimeout;
+    }
+    TEST_Advance(t);
+    if (pSem->Count != 0U)
+    {
+      pSem->Count--;
+      TEST_NumWakes++;
+      TEST_Run(TEST_WAKE_NS);
+      return osOK;
+    }
+  }
+}
+
+void USBH_LL_IncTimer(USBH_HandleTypeDef *phost)
+{
+  phost->Timer++;
+}
+
+void USBH_LL_SetTimer(USBH_HandleTypeDef *phost, uint32_t time)
+{
+  phost->Timer = time;
+}
+
+USBH_StatusTypeDef USBH_LL_Connect(USBH_HandleTypeDef *phost)
+{
+  phost->device.is_connected = 1U;
+  return USBH_OK;
+}
+
+USBH_StatusTypeDef USBH_LL_Disconnect(USBH_HandleTypeDef *phost)
+{
+  phost->device.is_connected = 0U;
+  return USBH_OK;
+}
+
+void USBH_LL_PortEnabled(USBH_HandleTypeDef *phost)
+{
+  phost->device.PortEnabled = 1U;
+}
+
+void USBH_LL_PortDisabled(USBH_HandleTypeDef *phost)
+{
+  phost->device.PortEnabled = 0U;
+}
+
+USBH_StatusTypeDef USBH_LL_NotifyURBChange(USBH_HandleTypeDef *phost)
+{
+  (void)phost;
+  return USBH_OK;
+}
+
+void USBH_OS_PutMessage(USBH_HandleTypeDef *phost, USBH_OSEventTypeDef message, uint32_t timeout, uint32_t priority)
+{
+  (void)phost;
+  (void)message;
+  (void)timeout;
+  (void)priority;
+}
+
+uint8_t USBH_FindInterface(USBH_HandleTypeDef *phost, uint8_t Class, uint8_t SubClass, uint8_t Protocol)
+{
+  (void)phost;
+  return ((Class == USB_MSC_CLASS) && (SubClass == MSC_TRANSPARENT) && (Protocol == MSC_BOT)) ? 0U : 0xFFU;
+}
+
+USBH_StatusTypeDef USBH_SelectInterface(USBH_HandleTypeDef *phost, uint8_t interface)
+{
+  phost->device.current_interface = interface;
+  return USBH_OK;
+}
+
+USBH_StatusTypeDef USBH_ClrFeature(USBH_HandleTypeDef *phost, uint8_t ep_num)
+{
+  (void)phost;
+  (void)ep_num;
+  return USBH_OK;
+}
+
+USBH_StatusTypeDef USBH_CtlReq(USBH_HandleTypeDef *phost, uint8_t *buff, uint16_t length)
+{
+  (void)phost;
+  (void)buff;
+  (void)length;
+  return USBH_OK;
+}
+
+void MX_DriverVbusFS(uint8_t state)
+{
+  (void)state;
+}
+
+void Error_Handler(void)
+{
+  TEST_NumErrorHandler++;
+}
+
+/**
+  * @brief  Runs all parts, reports the throughput table.
+  */
+int main(void)
+{
+  static const char *aMode[] = { "event", "polled" };
+  TEST_BenchTypeDef aaBench[2][2];    /* [PollMode][IsWrite] */
+  uint32_t          BusKBytesPerSec;
+  int               PollMode;
+  int               IsWrite;
+
+  TEST_Fill(TEST_aDisk, sizeof(TEST_aDisk));
+  memcpy(TEST_aRef, TEST_aDisk, sizeof(TEST_aDisk));
+  TEST_Init();
+  for (PollMode = 1; PollMode >= 0; PollMode--)
+  {
+    TEST_PollMode = (uint32_t)PollMode;
+    TEST_Transfers();
+    TEST_ShortRead();
+    for (IsWrite = 0; IsWrite < 2; IsWrite++)
+    {
+      TEST_Bench(IsWrite, &aaBench[PollMode][IsWrite]);
+    }
+  }
+  TEST_CHECK_EQ(TEST_NumErrorHandler, 0);
+  TEST_CHECK_EQ(TEST_Dev.NumErrors, 0);
+  TEST_CHECK_EQ(TEST_NumUrbErrors, 0);
+
+  BusKBytesPerSec = (uint32_t)((1e9 * TEST_EP_SIZE) / ((TEST_EP_SIZE + TEST_PACKET_OVERHEAD) * 2000.0 / 3.0) / 1024.0);
+  printf("MSC BOT on full speed, IN URB up to %u bytes, OUT URB up to %u bytes, bus limit %u KB/s\n",
+         (unsigned)USBH_MSC_BOT_MAX_IN_XFER, (unsigned)USBH_MSC_BOT_MAX_OUT_XFER, (unsigned)BusKBytesPerSec);
+  for (IsWrite = 0; IsWrite < 2; IsWrite++)
+  {
+    for (PollMode = 1; PollMode >= 0; PollMode--)
+    {
+      printf("  %-5s %-6s: %7.1f KB/s, CPU %5.1f %%, %5.1f URBs and %5.1f wake ups per %u KB\n",
+             IsWrite ? "write" : "read", aMode[PollMode],
+             aaBench[PollMode][IsWrite].KBytesPerSec, aaBench[PollMode][IsWrite].CpuLoad,
+             aaBench[PollMode][IsWrite].UrbsPerCmd, aaBench[PollMode][IsWrite].WakesPerCmd,
+             (unsigned)(TEST_MAX_SECTORS * TEST_SECTOR_SIZE / 1024U));
+    }
+    /* Sleeping on the URB event costs a wake up per URB, not a spinning CPU */
+    TEST_CHECK(aaBench[0][IsWrite].CpuLoad < 50.0);
+    TEST_CHECK(aaBench[0][IsWrite].WakesPerCmd <= aaBench[0][IsWrite].UrbsPerCmd);
+#if (USBH_MSC_BOT_MAX_IN_XFER > 64U) && (USBH_MSC_BOT_MAX_OUT_XFER > 64U)
+    /* With multi-packet URBs the wake ups do not cost bus time */
+    TEST_CHECK(aaBench[0][IsWrite].KBytesPerSec > 0.97 * aaBench[1][IsWrite].KBytesPerSec);
+    TEST_CHECK(aaBench[0][IsWrite].KBytesPerSec > 0.9 * BusKBytesPerSec);
+    TEST_CHECK(aaBench[0][IsWrite].CpuLoad < 10.0);
+#endif
+  }
+  return TEST_Report("USBH_MSC_BotTest");
+}
@@ -0,0 +1,729 @@
+/**
+  ******************************************************************************
+  * @file    IPC_RingTest.c
+  * @brief   Host test of the inter-core messaging (ipc_ring.c, ipc.c).
+  *
+  *          1. Ring: parameter checks, reservation up to a full ring across
+  *             the wrap of the indices, commit statistics, and the doorbell
+  *             protocol step by step: a doorbell only for a waiting
+  *             consumer, none while it is busy, a withdrawn wait.
+  *          2. Threads: a producer and a consumer thread exchange messages
+  *             through a ring of 64 slots. The consumer blocks on a
+  *             semaphore after IPC_RING_PrepareWait(), the producer posts it
+  *             only when IPC_RING_Commit() asks for a doorbell, so a lost
+  *             wakeup hangs the test. Every message is checked in order.
+  *             Run with single messages and with batches of up to 32, the
+  *             doorbells per message show the effect of batching.
+  *          3. Cores: ipc.c is built for the Cortex-M7 against a model of
+  *             the hardware semaphores (status and notification per core,
+  *             interrupts as threads). A thread as Cortex-M4 sends messages
+  *             that the Cortex-M7 echoes back in batches, the doorbells go
+  *             through HAL_HSEM_FreeCallback() and IPC_HSEM_FreeHandler().
+  *             The table of HSEM callbacks and the ready flags are checked.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "main.h"
+#include "ipc.h"
+#include "test_check.h"
+
+/* Private define ------------------------------------------------------------*/
+#define TEST_NUM_SLOTS          64U
+#define TEST_INDEX_START        0xFFFFFFF8U  /* Indices wrap during the test */
+#define TEST_NUM_MSGS           1000000U
+#define TEST_NUM_BUFS           256U
+#define TEST_NUM_ECHOS          200000U
+
+#define TEST_CORE_CM7           0U
+#define TEST_CORE_CM4           1U
+#define TEST_HSEM_ID_OTHER      5U           /* Registered by another module */
+#define TEST_HSEM_ID_DUMMY      6U
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+  * @brief  Producer and consumer of the thread test.
+  */
+typedef struct
+{
+  IPC_RingTypeDef Ring;
+  sem_t           Doorbell;
+  uint32_t        MaxBatch;
+  uint32_t        Rand;
+  /* Producer */
+  uint32_t        NumCommits;
+  uint32_t        NumPosts;
+  uint32_t        NumBytes;
+  /* Consumer */
+  uint32_t        NumWaits;
+  uint32_t        NumEmptyWakeups;
+  uint32_t        NumErrors;
+} TEST_PairTypeDef;
+
+/**
+  * @brief  Model of the hardware semaphores. A release sets the status bit
+  *         of the semaphore for both cores, the interrupt of a core is
+  *         pending while a status bit is set whose notification is enabled.
+  *         As in HAL_HSEM_IRQHandler(), the interrupt disables the
+  *         notification and clears the status of the semaphores it reports.
+  */
+typedef struct
+{
+  pthread_mutex_t Lock;
+  pthread_cond_t  Cond;
+  uint32_t        Taken;
+  uint32_t        aIer[2];
+  uint32_t        aStatus[2];
+  uint32_t        aNumIrqs[2];
+  int             Stop;
+} TEST_HsemTypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static IPC_MsgTypeDef           TEST_aSlots[TEST_NUM_SLOTS];
+static uint8_t                  TEST_aBuf[TEST_NUM_BUFS][16];
+static TEST_HsemTypeDef         TEST_Hsem = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, { 0, 0 }, { 0, 0 }, { 0, 0 }, 0 };
+static _Thread_local uint32_t   TEST_Core;
+static sem_t                    TEST_Cm7Rx;
+static sem_t                    TEST_Cm4Rx;
+static volatile uint32_t        TEST_NumCm7RxCallbacks;
+static volatile uint32_t        TEST_NumCm4RxCallbacks;
+static uint32_t                 TEST_aCallbackMask[3];
+static uint32_t                 TEST_NumCm4Errors;
+static uint32_t                 TEST_NumCm7Errors;
+static uint32_t                 TEST_NumCm7Sends;
+
+extern IPC_SharedTypeDef IPC_Shared;
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Returns the monotonic host time in nanoseconds.
+  */
+static uint64_t TEST_GetTime_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+/**
+  * @brief  Xorshift pseudo random generator.
+  */
+static uint32_t TEST_GetRandFrom(uint32_t *pState)
+{
+  uint32_t x;
+
+  x = *pState;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *pState = x;
+  return x;
+}
+
+/**
+  * @brief  Fills a descriptor with the message of a sequence number.
+  */
+static void TEST_FillMsg(IPC_MsgTypeDef *pMsg, uint32_t Seq)
+{
+  pMsg->Type      = IPC_MSG_USER;
+  pMsg->Flags     = (uint16_t)Seq;
+  pMsg->Len       = Seq & 0xFFU;
+  pMsg->pData     = TEST_aBuf[Seq % TEST_NUM_BUFS];
+  pMsg->aParam[0] = Seq;
+  pMsg->aParam[3] = ~Seq;
+}
+
+/**
+  * @brief  Checks a descriptor against the message of a sequence number.
+  * @retval 0 if it matches, 1 otherwise.
+  */
+static uint32_t TEST_CheckMsg(const IPC_MsgTypeDef *pMsg, uint16_t Type, uint32_t Seq)
+{
+  if ((pMsg->Type != Type) || (pMsg->Flags != (uint16_t)Seq) || (pMsg->Len != (Seq & 0xFFU)) ||
+      (pMsg->pData != TEST_aBuf[Seq % TEST_NUM_BUFS]) || (pMsg->aParam[0] != Seq) || (pMsg->aParam[3] != ~Seq))
+  {
+    return 1;
+  }
+  return 0;
+}
+
+/**
+  * @brief  Single-threaded checks of the ring and its doorbell protocol.
+  */
+static void TEST_Ring(void)
+{
+  IPC_RingTypeDef Ring;
+  IPC_MsgTypeDef *pMsg;
+  uint32_t        NumBytes;
+  uint32_t        i;
+
+  TEST_CHECK(IPC_RING_Init(&Ring, TEST_aSlots, 0) == -1);
+  TEST_CHECK(IPC_RING_Init(&Ring, TEST_aSlots, 48) == -1);
+  TEST_CHECK_EQ(IPC_RING_Init(&Ring, TEST_aSlots, TEST_NUM_SLOTS), 0);
+  TEST_CHECK(IPC_RING_Peek(&Ring) == NULL);
+  TEST_CHECK_EQ(IPC_RING_Commit(&Ring), 0);
+  /* Fill the ring across the wrap of the indices */
+  Ring.Head        = TEST_INDEX_START;
+  Ring.HeadPending = TEST_INDEX_START;
+  Ring.Tail        = TEST_INDEX_START;
+  NumBytes = 0;
+  for (i = 0; i < TEST_NUM_SLOTS; i++)
+  {
+    pMsg = IPC_RING_Reserve(&Ring);
+    TEST_CHECK(pMsg == &TEST_aSlots[(TEST_INDEX_START + i) % TEST_NUM_SLOTS]);
+    TEST_FillMsg(pMsg, i);
+    NumBytes += pMsg->Len;
+  }
+  TEST_CHECK(IPC_RING_Reserve(&Ring) == NULL);
+  TEST_CHECK_EQ(Ring.NumFull, 1);
+  TEST_CHECK(IPC_RING_Peek(&Ring) == NULL);      /* Nothing published yet */
+  TEST_CHECK_EQ(IPC_RING_Commit(&Ring), 0);       /* Nobody waits */
+  TEST_CHECK_EQ(Ring.NumMsgs, TEST_NUM_SLOTS);
+  TEST_CHECK_EQ(Ring.NumBytes, NumBytes);
+  TEST_CHECK_EQ(Ring.NumDoorbells, 0);
+  TEST_CHECK_EQ(IPC_RING_GetCount(&Ring), TEST_NUM_SLOTS);
+  TEST_CHECK_EQ(IPC_RING_PrepareWait(&Ring), 0);  /* Messages are available */
+  TEST_CHECK_EQ(Ring.WaitFlag, 0);
+  for (i = 0; i < TEST_NUM_SLOTS; i++)
+  {
+    pMsg = IPC_RING_Peek(&Ring);
+    TEST_CHECK((pMsg != NULL) && (TEST_CheckMsg(pMsg, IPC_MSG_USER, i) == 0));
+    IPC_RING_Release(&Ring);
+  }
+  TEST_CHECK(IPC_RING_Peek(&Ring) == NULL);
+  TEST_CHECK_EQ(Ring.Tail, TEST_INDEX_START + TEST_NUM_SLOTS);
+  /* A waiting consumer gets one doorbell, the next commit none */
+  TEST_CHECK_EQ(IPC_RING_PrepareWait(&Ring), 1);
+  TEST_CHECK_EQ(Ring.WaitFlag, 1);
+  TEST_CHECK_EQ(IPC_RING_Commit(&Ring), 0);       /* Nothing reserved, the flag stays */
+  TEST_CHECK_EQ(Ring.WaitFlag, 1);
+  TEST_FillMsg(IPC_RING_Reserve(&Ring), 100);
+  TEST_FillMsg(IPC_RING_Reserve(&Ring), 101);
+  TEST_CHECK_EQ(IPC_RING_Commit(&Ring), 1);
+  TEST_CHECK_EQ(Ring.WaitFlag, 0);
+  TEST_FillMsg(IPC_RING_Reserve(&Ring), 102);
+  TEST_CHECK_EQ(IPC_RING_Commit(&Ring), 0);
+  TEST_CHECK_EQ(Ring.NumDoorbells, 1);
+  for (i = 100; i < 103U; i++)
+  {
+    pMsg = IPC_RING_Peek(&Ring);
+    TEST_CHECK((pMsg != NULL) && (TEST_CheckMsg(pMsg, IPC_MSG_USER, i) == 0));
+    IPC_RING_Release(&Ring);
+  }
+  /* A withdrawn wait does not get a doorbell */
+  TEST_CHECK_EQ(IPC_RING_PrepareWait(&Ring), 1);
+  IPC_RING_CancelWait(&Ring);
+  TEST_FillMsg(IPC_RING_Reserve(&Ring), 103);
+  TEST_CHECK_EQ(IPC_RING_Commit(&Ring), 0);
+  TEST_CHECK_EQ(Ring.NumDoorbells, 1);
+  TEST_CHECK_EQ(Ring.NumMsgs, TEST_NUM_SLOTS + 4U);
+}
+
+/**
+  * @brief  Producer thread: publishes random batches, posts the doorbell
+  *         semaphore when the commit asks for it.
+  */
+static void *TEST_ProducerThread(void *p)
+{
+  TEST_PairTypeDef *pPair;
+  IPC_MsgTypeDef   *pMsg;
+  uint32_t          Seq;
+  uint32_t          NumBatch;
+  uint32_t          i;
+
+  pPair = (TEST_PairTypeDef *)p;
+  Seq = 0;
+  while (Seq < TEST_NUM_MSGS)
+  {
+    NumBatch = 1U + (TEST_GetRandFrom(&pPair->Rand) % pPair->MaxBatch);
+    for (i = 0; (i < NumBatch) && (Seq < TEST_NUM_MSGS); i++)
+    {
+      pMsg = IPC_RING_Reserve(&pPair->Ring);
+      if (pMsg == NULL)
+      {
+        break;
+      }
+      TEST_FillMsg(pMsg, Seq);
+      pPair->NumBytes += pMsg->Len;
+      Seq++;
+    }
+    if (i != 0U)
+    {
+      pPair->NumCommits++;
+      if (IPC_RING_Commit(&pPair->Ring) != 0)
+      {
+        pPair->NumPosts++;
+        sem_post(&pPair->Doorbell);
+      }
+    }
+    if (i != NumBatch)
+    {
+      sched_yield();        /* Ring full */
+    }
+  }
+  return NULL;
+}
+
+/**
+  * @brief  Consumer thread: checks every message, sleeps on the doorbell
+  *         when the ring is empty.
+  */
+static void *TEST_ConsumerThread(void *p)
+{
+  TEST_PairTypeDef *pPair;
+  IPC_MsgTypeDef   *pMsg;
+  uint32_t          Seq;
+
+  pPair = (TEST_PairTypeDef *)p;
+  Seq = 0;
+  while (Seq < TEST_NUM_MSGS)
+  {
+    pMsg = IPC_RING_Peek(&pPair->Ring);
+    if (pMsg == NULL)
+    {
+      if (IPC_RING_PrepareWait(&pPair->Ring) != 0)
+      {
+        pPair->NumWaits++;
+        sem_wait(&pPair->Doorbell);
+        if (IPC_RING_Peek(&pPair->Ring) == NULL)
+        {
+          pPair->NumEmptyWakeups++;
+        }
+      }
+      continue;
+    }
+    pPair->NumErrors += TEST_CheckMsg(pMsg, IPC_MSG_USER, Seq);
+    IPC_RING_Release(&pPair->Ring);
+    Seq++;
+  }
+  return NULL;
+}
+
+/**
+  * @brief  Passes TEST_NUM_MSGS messages between two threads.
+  * @param  MaxBatch: Maximum number of messages per commit.
+  */
+static void TEST_Threads(uint32_t MaxBatch)
+{
+  static TEST_PairTypeDef Pair;
+  pthread_t               aThread[2];
+  uint64_t                t;
+  int                     NumPending;
+
+  memset(&Pair, 0, sizeof(Pair));
+  (void)IPC_RING_Init(&Pair.Ring, TEST_aSlots, TEST_NUM_SLOTS);
+  Pair.Ring.Head        = TEST_INDEX_START;
+  Pair.Ring.HeadPending = TEST_INDEX_START;
+  Pair.Ring.Tail        = TEST_INDEX_START;
+  Pair.MaxBatch         = MaxBatch;
+  Pair.Rand             = 0x13579BDFU + MaxBatch;
+  sem_init(&Pair.Doorbell, 0, 0);
+  t = TEST_GetTime_ns();
+  pthread_create(&aThread[0], NULL, TEST_ConsumerThread, &Pair);
+  pthread_create(&aThread[1], NULL, TEST_ProducerThread, &Pair);
+  pthread_join(aThread[1], NULL);
+  pthread_join(aThread[0], NULL);
+  t = TEST_GetTime_ns() - t;
+  TEST_CHECK_EQ(Pair.NumErrors, 0);
+  TEST_CHECK_EQ(Pair.Ring.NumMsgs, TEST_NUM_MSGS);
+  TEST_CHECK_EQ(Pair.Ring.NumBytes, Pair.NumBytes);
+  TEST_CHECK_EQ(IPC_RING_GetCount(&Pair.Ring), 0);
+  TEST_CHECK_EQ(Pair.Ring.NumDoorbells, Pair.NumPosts);
+  TEST_CHECK(Pair.NumPosts <= Pair.NumCommits);
+  /* A doorbell is only raised for a wait. The consumer may withdraw a wait
+     the producer has already seen, that doorbell is left or wakes it up
+     on an empty ring. */
+  sem_getvalue(&Pair.Doorbell, &NumPending);
+  TEST_CHECK(Pair.NumWaits <= Pair.NumPosts);
+  TEST_CHECK_EQ(Pair.NumPosts - Pair.NumWaits, (uint32_t)NumPending);
+  sem_destroy(&Pair.Doorbell);
+  printf("Batches of up to %2u: %.1f ns per message, %u commits, %u doorbells (%.3f per message), "
+         "%u full, %u empty wakeups\n",
+         MaxBatch, (double)t / TEST_NUM_MSGS, Pair.NumCommits, Pair.NumPosts,
+         (double)Pair.NumPosts / TEST_NUM_MSGS, Pair.Ring.NumFull, Pair.NumEmptyWakeups);
+}
+
+/**
+  * @brief  Takes a semaphore of the model in one step.
+  */
+HAL_StatusTypeDef HAL_HSEM_FastTake(uint32_t SemID)
+{
+  uint32_t Mask;
+
+  Mask = __HAL_HSEM_SEMID_TO_MASK(SemID);
+  if ((__atomic_fetch_or(&TEST_Hsem.Taken, Mask, __ATOMIC_SEQ_CST) & Mask) != 0U)
+  {
+    return HAL_ERROR;
+  }
+  return HAL_OK;
+}
+
+/**
+  * @brief  Releases a semaphore of the model, the status is set for both cores.
+  */
+void HAL_HSEM_Release(uint32_t SemID, uint32_t ProcessID)
+{
+  uint32_t Mask;
+
+  (void)ProcessID;
+  Mask = __HAL_HSEM_SEMID_TO_MASK(SemID);
+  pthread_mutex_lock(&TEST_Hsem.Lock);
+  __atomic_fetch_and(&TEST_Hsem.Taken, ~Mask, __ATOMIC_SEQ_CST);
+  TEST_Hsem.aStatus[TEST_CORE_CM7] |= Mask;
+  TEST_Hsem.aStatus[TEST_CORE_CM4] |= Mask;
+  pthread_cond_broadcast(&TEST_Hsem.Cond);
+  pthread_mutex_unlock(&TEST_Hsem.Lock);
+}
+
+/**
+  * @brief  Enables the notification of semaphores for the calling core.
+  */
+void HAL_HSEM_ActivateNotification(uint32_t SemMask)
+{
+  pthread_mutex_lock(&TEST_Hsem.Lock);
+  TEST_Hsem.aIer[TEST_Core] |= SemMask;
+  pthread_cond_broadcast(&TEST_Hsem.Cond);
+  pthread_mutex_unlock(&TEST_Hsem.Lock);
+}
+
+/**
+  * @brief  HAL tick in ms.
+  */
+uint32_t HAL_GetTick(void)
+{
+  return (uint32_t)(TEST_GetTime_ns() / 1000000U);
+}
+
+/**
+  * @brief  HSEM free callback of the Cortex-M7, as in stm32h7xx_it.c.
+  */
+void HAL_HSEM_FreeCallback(uint32_t SemMask)
+{
+  IPC_HSEM_FreeHandler(SemMask);
+}
+
+/**
+  * @brief  Doorbell of the Cortex-M4 side of the test.
+  */
+static void TEST_Cm4FreeCallback(uint32_t SemMask)
+{
+  HAL_HSEM_ActivateNotification(SemMask);
+  TEST_NumCm4RxCallbacks++;
+  sem_post(&TEST_Cm4Rx);
+}
+
+/**
+  * @brief  Interrupt of a core: waits for a pending notification and calls
+  *         the free callback of the core.
+  */
+static void *TEST_IrqThread(void *p)
+{
+  uint32_t Mask;
+
+  TEST_Core = (uint32_t)(uintptr_t)p;
+  for (;;)
+  {
+    pthread_mutex_lock(&TEST_Hsem.Lock);
+    while (((TEST_Hsem.aStatus[TEST_Core] & TEST_Hsem.aIer[TEST_Core]) == 0U) && (TEST_Hsem.Stop == 0))
+    {
+      pthread_cond_wait(&TEST_Hsem.Cond, &TEST_Hsem.Lock);
+    }
+    if (TEST_Hsem.Stop != 0)
+    {
+      pthread_mutex_unlock(&TEST_Hsem.Lock);
+      return NULL;
+    }
+    Mask = TEST_Hsem.aStatus[TEST_Core] & TEST_Hsem.aIer[TEST_Core];
+    TEST_Hsem.aIer[TEST_Core]    &= ~Mask;
+    TEST_Hsem.aStatus[TEST_Core] &= ~Mask;
+    TEST_Hsem.aNumIrqs[TEST_Core]++;
+    pthread_mutex_unlock(&TEST_Hsem.Lock);
+    if (TEST_Core == TEST_CORE_CM7)
+    {
+      HAL_HSEM_FreeCallback(Mask);
+    }
+    else
+    {
+      TEST_Cm4FreeCallback(Mask);
+    }
+  }
+}
+
+/**
+  * @brief  Receive callback of the Cortex-M7, registered with ipc.c.
+  */
+static void TEST_Cm7RxCallback(void)
+{
+  TEST_NumCm7RxCallbacks++;
+  sem_post(&TEST_Cm7Rx);
+}
+
+/**
+  * @brief  HSEM callbacks of other modules, record the masks they get.
+  */
+static void TEST_OtherCallback(uint32_t SemMask)
+{
+  __atomic_fetch_or(&TEST_aCallbackMask[0], SemMask, __ATOMIC_SEQ_CST);
+}
+
+static void TEST_DummyCallback1(uint32_t SemMask)
+{
+  TEST_aCallbackMask[1] |= SemMask;
+}
+
+static void TEST_DummyCallback2(uint32_t SemMask)
+{
+  TEST_aCallbackMask[2] |= SemMask;
+}
+
+static void TEST_DummyCallback3(uint32_t SemMask)
+{
+  (void)SemMask;
+}
+
+/**
+  * @brief  Cortex-M7 task: echoes every message back as a buffer release,
+  *         all messages found in the ring with a single IPC_Send().
+  */
+static void *TEST_Cm7Thread(void *p)
+{
+  IPC_MsgTypeDef *pMsg;
+  IPC_MsgTypeDef *pOut;
+  uint32_t        Seq;
+
+  (void)p;
+  TEST_Core = TEST_CORE_CM7;
+  Seq = 0;
+  while (Seq < TEST_NUM_ECHOS)
+  {
+    pMsg = IPC_Peek();
+    if (pMsg == NULL)
+    {
+      IPC_Send();
+      TEST_NumCm7Sends++;
+      if (IPC_PrepareWait() != 0)
+      {
+        sem_wait(&TEST_Cm7Rx);
+      }
+      continue;
+    }
+    TEST_NumCm7Errors += TEST_CheckMsg(pMsg, IPC_MSG_USER, Seq);
+    for (;;)
+    {
+      pOut = IPC_Alloc();
+      if (pOut != NULL)
+      {
+        break;
+      }
+      IPC_Send();
+      TEST_NumCm7Sends++;
+      sched_yield();
+    }
+    *pOut = *pMsg;
+    pOut->Type = IPC_MSG_BUFFER_RELEASE;
+    IPC_Release();
+    Seq++;
+  }
+  IPC_Send();
+  TEST_NumCm7Sends++;
+  return NULL;
+}
+
+/**
+  * @brief  Cortex-M4 sender: random batches, doorbell when asked for.
+  */
+static void *TEST_Cm4TxThread(void *p)
+{
+  IPC_RingTypeDef *pRing;
+  IPC_MsgTypeDef  *pMsg;
+  uint32_t         Rand;
+  uint32_t         Seq;
+  uint32_t         NumBatch;
+  uint32_t         i;
+
+  (void)p;
+  TEST_Core = TEST_CORE_CM4;
+  pRing = &IPC_Shared.RingCM4ToCM7;
+  Rand  = 0x2468ACE1U;
+  Seq   = 0;
+  while (Seq < TEST_NUM_ECHOS)
+  {
+    NumBatch = 1U + (TEST_GetRandFrom(&Rand) % 16U);
+    for (i = 0; (i < NumBatch) && (Seq < TEST_NUM_ECHOS); i++)
+    {
+      pMsg = IPC_RING_Reserve(pRing);
+      if (pMsg == NULL)
+      {
+        break;
+      }
+      TEST_FillMsg(pMsg, Seq);
+      Seq++;
+    }
+    if (IPC_RING_Commit(pRing) != 0)
+    {
+      if (HAL_HSEM_FastTake(IPC_HSEM_ID_CM4_TO_CM7) == HAL_OK)
+      {
+        HAL_HSEM_Release(IPC_HSEM_ID_CM4_TO_CM7, 0);
+      }
+    }
+    if (i != NumBatch)
+    {
+      sched_yield();
+    }
+  }
+  IPC_SetReady(IPC_READY_SDRAM);
+  return NULL;
+}
+
+/**
+  * @brief  Cortex-M4 receiver: checks the echoes in order.
+  */
+static void *TEST_Cm4RxThread(void *p)
+{
+  IPC_RingTypeDef *pRing;
+  IPC_MsgTypeDef  *pMsg;
+  uint32_t         Seq;
+
+  (void)p;
+  TEST_Core = TEST_CORE_CM4;
+  pRing = &IPC_Shared.RingCM7ToCM4;
+  Seq   = 0;
+  while (Seq < TEST_NUM_ECHOS)
+  {
+    pMsg = IPC_RING_Peek(pRing);
+    if (pMsg == NULL)
+    {
+      if (IPC_RING_PrepareWait(pRing) != 0)
+      {
+        sem_wait(&TEST_Cm4Rx);
+      }
+      continue;
+    }
+    TEST_NumCm4Errors += TEST_CheckMsg(pMsg, IPC_MSG_BUFFER_RELEASE, Seq);
+    IPC_RING_Release(pRing);
+    Seq++;
+  }
+  return NULL;
+}
+
+/**
+  * @brief  Runs ipc.c as the Cortex-M7 against the Cortex-M4 threads.
+  */
+static void TEST_Cores(void)
+{
+  IPC_StatTypeDef Tx;
+  IPC_StatTypeDef Rx;
+  pthread_t       aIrq[2];
+  pthread_t       aThread[3];
+  uint64_t        t;
+
+  TEST_Core = TEST_CORE_CM7;
+  sem_init(&TEST_Cm7Rx, 0, 0);
+  sem_init(&TEST_Cm4Rx, 0, 0);
+  memset(&IPC_Shared, 0xAA, sizeof(IPC_Shared));      /* NOLOAD, not cleared at startup */
+  IPC_Init();
+  TEST_CHECK_EQ(IPC_Shared.Magic, IPC_SHARED_MAGIC);
+  TEST_CHECK_EQ(IPC_Shared.ReadyFlags, 0);
+  TEST_CHECK_EQ(TEST_Hsem.aIer[TEST_CORE_CM7], __HAL_HSEM_SEMID_TO_MASK(IPC_HSEM_ID_CM4_TO_CM7));
+  TEST_CHECK(IPC_WaitReady(IPC_READY_SDRAM, 2) == -1);
+  /* Table of HSEM callbacks: one entry per function, full after four */
+  TEST_CHECK_EQ(IPC_HSEM_RegisterCallback(__HAL_HSEM_SEMID_TO_MASK(TEST_HSEM_ID_DUMMY), TEST_OtherCallback), 0);
+  TEST_CHECK_EQ(IPC_HSEM_RegisterCallback(__HAL_HSEM_SEMID_TO_MASK(TEST_HSEM_ID_DUMMY), TEST_DummyCallback1), 0);
+  TEST_CHECK_EQ(IPC_HSEM_RegisterCallback(__HAL_HSEM_SEMID_TO_MASK(TEST_HSEM_ID_DUMMY), TEST_DummyCallback2), 0);
+  TEST_CHECK(IPC_HSEM_RegisterCallback(__HAL_HSEM_SEMID_TO_MASK(TEST_HSEM_ID_DUMMY), TEST_DummyCallback3) == -1);
+  TEST_CHECK_EQ(IPC_HSEM_RegisterCallback(__HAL_HSEM_SEMID_TO_MASK(TEST_HSEM_ID_OTHER), TEST_OtherCallback), 0);
+  IPC_HSEM_FreeHandler(__HAL_HSEM_SEMID_TO_MASK(TEST_HSEM_ID_DUMMY) | __HAL_HSEM_SEMID_TO_MASK(7));
+  TEST_CHECK_EQ(TEST_aCallbackMask[0], 0);
+  TEST_CHECK_EQ(TEST_aCallbackMask[1], __HAL_HSEM_SEMID_TO_MASK(TEST_HSEM_ID_DUMMY));
+  TEST_CHECK_EQ(TEST_aCallbackMask[2], __HAL_HSEM_SEMID_TO_MASK(TEST_HSEM_ID_DUMMY));
+  TEST_CHECK_EQ(TEST_NumCm7RxCallbacks, 0);
+  memset(TEST_aCallbackMask, 0, sizeof(TEST_aCallbackMask));
+  /* A doorbell before a receive callback is registered is harmless */
+  IPC_HSEM_FreeHandler(__HAL_HSEM_SEMID_TO_MASK(IPC_HSEM_ID_CM4_TO_CM7));
+  IPC_RegisterRxCallback(TEST_Cm7RxCallback);
+  HAL_HSEM_ActivateNotification(__HAL_HSEM_SEMID_TO_MASK(TEST_HSEM_ID_OTHER));
+  TEST_Core = TEST_CORE_CM4;
+  HAL_HSEM_ActivateNotification(__HAL_HSEM_SEMID_TO_MASK(IPC_HSEM_ID_CM7_TO_CM4));
+  TEST_Core = TEST_CORE_CM7;
+  pthread_create(&aIrq[TEST_CORE_CM7], NULL, TEST_IrqThread, (void *)(uintptr_t)TEST_CORE_CM7);
+  pthread_create(&aIrq[TEST_CORE_CM4], NULL, TEST_IrqThread, (void *)(uintptr_t)TEST_CORE_CM4);
+  /* Another module's semaphore is dispatched to it only */
+  TEST_Core = TEST_CORE_CM4;
+  HAL_HSEM_Release(TEST_HSEM_ID_OTHER, 0);
+  TEST_Core = TEST_CORE_CM7;
+  while (__atomic_load_n(&TEST_aCallbackMask[0], __ATOMIC_SEQ_CST) == 0U)
+  {
+    sched_yield();
+  }
+  TEST_CHECK_EQ(TEST_aCallbackMask[0], __HAL_HSEM_SEMID_TO_MASK(TEST_HSEM_ID_OTHER));
+  TEST_CHECK_EQ(TEST_NumCm7RxCallbacks, 0);
+  /* Messages both ways */
+  t = TEST_GetTime_ns();
+  pthread_create(&aThread[0], NULL, TEST_Cm7Thread, NULL);
+  pthread_create(&aThread[1], NULL, TEST_Cm4RxThread, NULL);
+  pthread_create(&aThread[2], NULL, TEST_Cm4TxThread, NULL);
+  pthread_join(aThread[2], NULL);
+  pthread_join(aThread[1], NULL);
+  pthread_join(aThread[0], NULL);
+  t = TEST_GetTime_ns() - t;
+  TEST_CHECK_EQ(IPC_WaitReady(IPC_READY_SDRAM, 1000), 0);
+  pthread_mutex_lock(&TEST_Hsem.Lock);
+  TEST_Hsem.Stop = 1;
+  pthread_cond_broadcast(&TEST_Hsem.Cond);
+  pthread_mutex_unlock(&TEST_Hsem.Lock);
+  pthread_join(aIrq[TEST_CORE_CM7], NULL);
+  pthread_join(aIrq[TEST_CORE_CM4], NULL);
+  TEST_CHECK_EQ(TEST_NumCm7Errors, 0);
+  TEST_CHECK_EQ(TEST_NumCm4Errors, 0);
+  IPC_GetStat(&Tx, &Rx);
+  TEST_CHECK_EQ(Rx.NumMsgs, TEST_NUM_ECHOS);
+  TEST_CHECK_EQ(Tx.NumMsgs, TEST_NUM_ECHOS);
+  TEST_CHECK_EQ(Rx.NumPending, 0);
+  TEST_CHECK_EQ(Tx.NumPending, 0);
+  /* Every doorbell either interrupts or is merged with a pending one */
+  TEST_CHECK(TEST_NumCm7RxCallbacks <= Rx.NumDoorbells);
+  TEST_CHECK(TEST_NumCm4RxCallbacks <= Tx.NumDoorbells);
+  TEST_CHECK(TEST_NumCm7RxCallbacks > 0U);
+  TEST_CHECK(Tx.NumDoorbells <= TEST_NumCm7Sends);
+  TEST_CHECK_EQ(TEST_aCallbackMask[0], __HAL_HSEM_SEMID_TO_MASK(TEST_HSEM_ID_OTHER));
+  TEST_CHECK_EQ(TEST_Hsem.Taken, 0);
+  sem_destroy(&TEST_Cm7Rx);
+  sem_destroy(&TEST_Cm4Rx);
+  printf("Echo of %u messages: %.1f ns per message, doorbells per message CM4->CM7 %.3f, CM7->CM4 %.3f, "
+         "%u + %u interrupts\n",
+         TEST_NUM_ECHOS, (double)t / TEST_NUM_ECHOS,
+         (double)Rx.NumDoorbells / TEST_NUM_ECHOS, (double)Tx.NumDoorbells / TEST_NUM_ECHOS,
+         TEST_Hsem.aNumIrqs[TEST_CORE_CM7], TEST_Hsem.aNumIrqs[TEST_CORE_CM4]);
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Runs the test.
+  */
+int main(void)
+{
+  TEST_Ring();
+  TEST_Threads(1);
+  TEST_Threads(32);
+  TEST_Cores();
+  return TEST_Report("IPC_RingTest");
+}
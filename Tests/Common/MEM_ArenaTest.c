@@ -0,0 +1,663 @@
+/**
+  ******************************************************************************
+  * @file    MEM_ArenaTest.c
+  * @brief   Host test and benchmarks of the region-aware arena allocator
+  *          (mem_arena.c).
+  *
+  *          1. Regions: parameter checks, lookup by name and by address,
+  *             selection by required and preferred attributes with the
+  *             fall back to the next region when the first one is full.
+  *          2. Bump allocator: random sizes and alignments on regions with
+  *             aligned and unaligned base addresses, until each region is
+  *             full. Every allocation is checked for alignment, overlap and
+  *             bounds, and the counters for the exact bytes used and lost
+  *             to padding.
+  *          3. Size classes: rounding of the requests, reuse of freed
+  *             blocks, invalid frees and the block counters.
+  *          4. Fragmentation: a random workload of allocations and frees
+  *             with sizes from 16 bytes to 16 KB. The contents of every live
+  *             block are checked before it is freed, and the memory taken
+  *             from the region must equal the peak number of live blocks of
+  *             each class times its size: a block is only carved when its
+  *             free list is empty. Reports the internal fragmentation
+  *             (class size against requested size) and the region size the
+  *             workload needs.
+  *          5. Throughput: the same workload replayed with the size class
+  *             allocator and with the C library malloc()/free(), and bump
+  *             allocations, in ns per operation.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mem_arena.h"
+#include "test_check.h"
+
+/* Private define ------------------------------------------------------------*/
+#define TEST_SRAM_SIZE          0x4000U
+#define TEST_SDRAM_SIZE         0x10000U
+#define TEST_DMA_SIZE           0x8000U
+#define TEST_CACHE_LINE         32U
+
+#define TEST_BUMP_REGION_SIZE   0x20000U
+#define TEST_BUMP_MAX_ALLOCS    8192U
+
+#define TEST_FRAG_REGION_SIZE   0x01000000U   /* 16 MB, the workload needs less */
+#define TEST_FRAG_NUM_SLOTS     512U          /* Bound of the live set          */
+#define TEST_FRAG_NUM_OPS       400000U
+#define TEST_FRAG_MIN_SHIFT     4U            /* Sizes from 16 bytes ...        */
+#define TEST_FRAG_NUM_SHIFTS    10U           /* ... to 16 KB                   */
+
+#define TEST_BENCH_BUMP_ALLOCS  4096U
+#define TEST_BENCH_BUMP_LOOPS   200U
+
+#define TEST_NUM_CLASSES        MEM_ARENA_NUM_CLASSES
+#define TEST_CLASS_SIZE(Class)  (1UL << (MEM_ARENA_MIN_CLASS_SHIFT + (Class)))
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+  * @brief  One operation of the fragmentation workload: frees the block of
+  *         the slot if it is live, otherwise allocates NumBytes for it.
+  */
+typedef struct
+{
+  uint16_t Slot;
+  uint16_t NumBytes;
+} TEST_OpTypeDef;
+
+/**
+  * @brief  Live block of the fragmentation workload.
+  */
+typedef struct
+{
+  uint8_t  *p;
+  uint32_t  NumBytes;
+  uint32_t  Tag;
+} TEST_SlotTypeDef;
+
+/**
+  * @brief  Allocation of the bump allocator test.
+  */
+typedef struct
+{
+  uint8_t  *p;
+  uint32_t  NumBytes;
+} TEST_SpanTypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t          TEST_Rand = 0x13579BDFU;
+static uint64_t          TEST_aSram[TEST_SRAM_SIZE / 8U];
+static uint64_t          TEST_aSdram[TEST_SDRAM_SIZE / 8U];
+static uint64_t          TEST_aDma[TEST_DMA_SIZE / 8U];
+static uint64_t          TEST_aBump[(TEST_BUMP_REGION_SIZE / 8U) + 1U];
+static TEST_SpanTypeDef  TEST_aSpan[TEST_BUMP_MAX_ALLOCS];
+static uint64_t          TEST_aFrag[TEST_FRAG_REGION_SIZE / 8U];
+static TEST_OpTypeDef    TEST_aOp[TEST_FRAG_NUM_OPS];
+static TEST_SlotTypeDef  TEST_aSlot[TEST_FRAG_NUM_SLOTS];
+static void             *TEST_apBench[TEST_BENCH_BUMP_ALLOCS];
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Returns the monotonic host time in nanoseconds.
+  */
+static uint64_t TEST_GetTime_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+/**
+  * @brief  Xorshift pseudo random generator.
+  */
+static uint32_t TEST_GetRandFrom(uint32_t *pState)
+{
+  uint32_t x;
+
+  x = *pState;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *pState = x;
+  return x;
+}
+
+static uint32_t TEST_GetRand(void)
+{
+  return TEST_GetRandFrom(&TEST_Rand);
+}
+
+/**
+  * @brief  Returns the size class index of a request, as the allocator
+  *         computes it.
+  */
+static uint32_t TEST_GetClass(uint32_t NumBytes)
+{
+  uint32_t Class;
+
+  Class = 0;
+  while (TEST_CLASS_SIZE(Class) < NumBytes)
+  {
+    Class++;
+  }
+  return Class;
+}
+
+/**
+  * @brief  Registers the regions of the Cortex-M7 memory map: the AXI SRAM,
+  *         the cacheable SDRAM and its non-cacheable DMA window.
+  */
+static void TEST_AddRegions(MEM_ArenaTypeDef *pArena)
+{
+  MEM_ARENA_Init(pArena);
+  TEST_CHECK_EQ(MEM_ARENA_AddRegion(pArena, "sram", TEST_aSram, TEST_SRAM_SIZE,
+                                    MEM_ARENA_ATTR_FAST | MEM_ARENA_ATTR_CACHEABLE, 0), 0);
+  TEST_CHECK_EQ(MEM_ARENA_AddRegion(pArena, "sdram", TEST_aSdram, TEST_SDRAM_SIZE,
+                                    MEM_ARENA_ATTR_EXTERNAL | MEM_ARENA_ATTR_CACHEABLE, TEST_CACHE_LINE), 1);
+  TEST_CHECK_EQ(MEM_ARENA_AddRegion(pArena, "sdram_dma", TEST_aDma, TEST_DMA_SIZE,
+                                    MEM_ARENA_ATTR_EXTERNAL | MEM_ARENA_ATTR_DMA, TEST_CACHE_LINE), 2);
+}
+
+/**
+  * @brief  Checks the region parameters and the selection of a region.
+  */
+static void TEST_Regions(void)
+{
+  static uint8_t        aExtra[256];
+  MEM_ArenaTypeDef      Arena;
+  MEM_ARENA_StatTypeDef Stat;
+  uint8_t              *p;
+  uint8_t              *q;
+  uint32_t              i;
+
+  MEM_ARENA_Init(&Arena);
+  TEST_CHECK_EQ(MEM_ARENA_AddRegion(&Arena, "null", NULL, 256, 0, 0), -1);
+  TEST_CHECK_EQ(MEM_ARENA_AddRegion(&Arena, "empty", aExtra, 0, 0, 0), -1);
+  TEST_CHECK_EQ(MEM_ARENA_AddRegion(&Arena, "align", aExtra, sizeof(aExtra), 0, 24), -1);
+  TEST_CHECK_EQ(Arena.NumRegions, 0U);
+
+  TEST_AddRegions(&Arena);
+  TEST_CHECK_EQ(Arena.aRegion[0].Align, sizeof(void *));      /* Raised to a pointer */
+  TEST_CHECK_EQ(Arena.aRegion[1].Align, TEST_CACHE_LINE);
+  TEST_CHECK_EQ(MEM_ARENA_AddRegion(&Arena, "extra", aExtra, sizeof(aExtra), 0, 0), 3);
+  TEST_CHECK_EQ(MEM_ARENA_AddRegion(&Arena, "full", aExtra, sizeof(aExtra), 0, 0), -1);
+  TEST_CHECK_EQ(Arena.NumRegions, MEM_ARENA_MAX_REGIONS);
+
+  TEST_CHECK_EQ(MEM_ARENA_FindRegion(&Arena, "sram"), 0);
+  TEST_CHECK_EQ(MEM_ARENA_FindRegion(&Arena, "sdram_dma"), 2);
+  TEST_CHECK_EQ(MEM_ARENA_FindRegion(&Arena, "sdram_"), -1);
+  TEST_CHECK_EQ(MEM_ARENA_GetRegion(&Arena, (uint8_t *)TEST_aSdram + TEST_SDRAM_SIZE - 1U), 1);
+  TEST_CHECK_EQ(MEM_ARENA_GetRegion(&Arena, &i), -1);
+  TEST_CHECK_EQ(MEM_ARENA_GetAttr(&Arena, &i), 0U);
+
+  /* Selection: required attributes are a must, preferred ones an order */
+  TEST_AddRegions(&Arena);
+  p = MEM_ARENA_Alloc(&Arena, 100, 0, MEM_ARENA_ATTR_DMA, 0);
+  TEST_CHECK(p == (uint8_t *)TEST_aDma);
+  TEST_CHECK_EQ(MEM_ARENA_GetAttr(&Arena, p), MEM_ARENA_ATTR_EXTERNAL | MEM_ARENA_ATTR_DMA);
+  p = MEM_ARENA_Alloc(&Arena, 100, 0, 0, MEM_ARENA_ATTR_EXTERNAL);
+  TEST_CHECK_EQ(MEM_ARENA_GetRegion(&Arena, p), 1);
+  p = MEM_ARENA_Alloc(&Arena, 100, 0, MEM_ARENA_ATTR_CACHEABLE, MEM_ARENA_ATTR_FAST);
+  TEST_CHECK_EQ(MEM_ARENA_GetRegion(&Arena, p), 0);
+  p = MEM_ARENA_Alloc(&Arena, 100, 0, MEM_ARENA_ATTR_DMA, MEM_ARENA_ATTR_FAST);
+  TEST_CHECK_EQ(MEM_ARENA_GetRegion(&Arena, p), 2);           /* Preference not met, requirement is */
+  p = MEM_ARENA_Alloc(&Arena, 100, 0, MEM_ARENA_ATTR_DMA | MEM_ARENA_ATTR_FAST, 0);
+  TEST_CHECK(p == NULL);
+  TEST_CHECK_EQ(Arena.NumFailed, 1U);
+
+  /* The SRAM runs full, fast requests go on to the SDRAM */
+  p = MEM_ARENA_AllocFrom(&Arena, 0, TEST_SRAM_SIZE - 104U - 8U, 0);
+  TEST_CHECK(p != NULL);
+  p = MEM_ARENA_Alloc(&Arena, 8, 0, 0, MEM_ARENA_ATTR_FAST);
+  TEST_CHECK_EQ(MEM_ARENA_GetRegion(&Arena, p), 0);           /* The last 8 bytes */
+  q = MEM_ARENA_Alloc(&Arena, 1, 0, 0, MEM_ARENA_ATTR_FAST);
+  TEST_CHECK_EQ(MEM_ARENA_GetRegion(&Arena, q), 1);
+  TEST_CHECK_EQ((uintptr_t)q % TEST_CACHE_LINE, 0U);
+  MEM_ARENA_GetStat(&Arena, 0, &Stat);
+  TEST_CHECK_EQ(Stat.Used, TEST_SRAM_SIZE);
+  TEST_CHECK_EQ(Stat.NumAllocs, 3U);
+  TEST_CHECK(MEM_ARENA_AllocFrom(&Arena, 0, 1, 0) == NULL);
+  TEST_CHECK(MEM_ARENA_AllocFrom(&Arena, 3, 1, 0) == NULL);
+  TEST_CHECK(MEM_ARENA_AllocFrom(&Arena, -1, 1, 0) == NULL);
+  MEM_ARENA_GetStat(&Arena, 0, &Stat);
+  TEST_CHECK_EQ(Stat.NumFailed, 1U);
+  TEST_CHECK_EQ(Arena.NumFailed, 3U);
+  MEM_ARENA_GetStat(&Arena, 7, &Stat);
+  TEST_CHECK_EQ(Stat.Size, 0U);
+
+  /* Blocks follow the same order and fall back once the SRAM is full */
+  TEST_AddRegions(&Arena);
+  for (i = 0; i < (TEST_SRAM_SIZE / 1024U); i++)
+  {
+    p = MEM_ARENA_AllocBlock(&Arena, 1000, 0, MEM_ARENA_ATTR_FAST);
+    TEST_CHECK_EQ(MEM_ARENA_GetRegion(&Arena, p), 0);
+  }
+  p = MEM_ARENA_AllocBlock(&Arena, 1000, 0, MEM_ARENA_ATTR_FAST);
+  TEST_CHECK_EQ(MEM_ARENA_GetRegion(&Arena, p), 1);
+  p = MEM_ARENA_AllocBlock(&Arena, 1000, MEM_ARENA_ATTR_DMA, 0);
+  TEST_CHECK_EQ(MEM_ARENA_GetRegion(&Arena, p), 2);
+  TEST_CHECK(MEM_ARENA_AllocBlock(&Arena, 1000, MEM_ARENA_ATTR_FAST | MEM_ARENA_ATTR_DMA, 0) == NULL);
+  TEST_CHECK_EQ(Arena.NumFailed, 1U);
+}
+
+/**
+  * @brief  Fills a region with random bump allocations and checks each one.
+  * @param  pBase: Start of the region.
+  * @param  RegionAlign: Alignment of the region.
+  */
+static void TEST_BumpRegion(uint8_t *pBase, uint32_t RegionAlign)
+{
+  MEM_ArenaTypeDef      Arena;
+  MEM_ARENA_StatTypeDef Stat;
+  uint8_t              *p;
+  uint8_t              *pEnd;
+  uint32_t              NumBytes;
+  uint32_t              Align;
+  uint32_t              Granule;
+  uint32_t              Pad;
+  uint32_t              Used;
+  uint32_t              NumAllocs;
+  uint32_t              NumMisses;
+  uint32_t              i;
+
+  MEM_ARENA_Init(&Arena);
+  TEST_CHECK_EQ(MEM_ARENA_AddRegion(&Arena, "bump", pBase, TEST_BUMP_REGION_SIZE, 0, RegionAlign), 0);
+  Granule   = Arena.aRegion[0].Align;
+  pEnd      = pBase + TEST_BUMP_REGION_SIZE;
+  Used      = 0;
+  Pad       = 0;
+  NumAllocs = 0;
+  NumMisses = 0;
+  while ((NumAllocs < TEST_BUMP_MAX_ALLOCS) && (NumMisses < 64U))
+  {
+    NumBytes = 1U + (TEST_GetRand() % (1U << (TEST_GetRand() % 12U)));
+    Align    = ((TEST_GetRand() % 4U) == 0U) ? (1U << (TEST_GetRand() % 13U)) : 0U;
+    p = MEM_ARENA_Alloc(&Arena, NumBytes, Align, 0, 0);
+    if (p == NULL)
+    {
+      NumMisses++;
+      continue;
+    }
+    if (Align < Granule)
+    {
+      Align = Granule;
+    }
+    NumBytes = (NumBytes + Granule - 1U) & ~(Granule - 1U);
+    TEST_CHECK_EQ((uintptr_t)p % Align, 0U);
+    TEST_CHECK((p >= pBase) && ((p + NumBytes) <= pEnd));
+    if (NumAllocs != 0U)
+    {
+      TEST_CHECK(p >= (TEST_aSpan[NumAllocs - 1U].p + TEST_aSpan[NumAllocs - 1U].NumBytes));
+      Pad += (uint32_t)(p - (TEST_aSpan[NumAllocs - 1U].p + TEST_aSpan[NumAllocs - 1U].NumBytes));
+    }
+    else
+    {
+      Pad += (uint32_t)(p - pBase);
+    }
+    memset(p, (int)NumAllocs, NumBytes);
+    TEST_aSpan[NumAllocs].p        = p;
+    TEST_aSpan[NumAllocs].NumBytes = NumBytes;
+    Used = (uint32_t)((p + NumBytes) - pBase);
+    NumAllocs++;
+  }
+  MEM_ARENA_GetStat(&Arena, 0, &Stat);
+  TEST_CHECK_EQ(Stat.Used, Used);
+  TEST_CHECK_EQ(Stat.PadBytes, Pad);
+  TEST_CHECK_EQ(Stat.NumAllocs, NumAllocs);
+  TEST_CHECK_EQ(Arena.NumFailed, NumMisses);
+  for (i = 0; i < NumAllocs; i++)
+  {
+    TEST_CHECK_EQ(TEST_aSpan[i].p[0], (uint8_t)i);
+    TEST_CHECK_EQ(TEST_aSpan[i].p[TEST_aSpan[i].NumBytes - 1U], (uint8_t)i);
+  }
+
+  /* The rest of the region to the last byte, then nothing more */
+  NumBytes = TEST_BUMP_REGION_SIZE - Used;
+  if ((((uintptr_t)(pBase + Used) % Granule) == 0U) && ((NumBytes % Granule) == 0U) && (NumBytes != 0U))
+  {
+    TEST_CHECK(MEM_ARENA_Alloc(&Arena, NumBytes + 1U, 0, 0, 0) == NULL);
+    TEST_CHECK(MEM_ARENA_Alloc(&Arena, NumBytes, 0, 0, 0) == (pBase + Used));
+  }
+  TEST_CHECK(MEM_ARENA_Alloc(&Arena, 1, 0, 0, 0) == NULL);
+  TEST_CHECK(MEM_ARENA_Alloc(&Arena, 0xFFFFFFFFU, 0, 0, 0) == NULL);   /* Rounding wraps */
+
+  printf("Bump allocator, base %% 64 = %2u, region alignment %3u: %4lu allocations, "
+         "%.1f %% of the region lost to padding\n",
+         (unsigned)((uintptr_t)pBase % 64U), (unsigned)Granule, (unsigned long)NumAllocs,
+         (100.0 * Pad) / TEST_BUMP_REGION_SIZE);
+}
+
+/**
+  * @brief  Checks the bump allocator.
+  */
+static void TEST_Bump(void)
+{
+  MEM_ArenaTypeDef Arena;
+  uint8_t         *pBase;
+  uint8_t         *p;
+
+  pBase = (uint8_t *)TEST_aBump;
+  TEST_BumpRegion(pBase, 0);
+  TEST_BumpRegion(pBase + 3, 0);             /* Unaligned start, padded by the first allocation */
+  TEST_BumpRegion(pBase + 8, TEST_CACHE_LINE);
+  TEST_BumpRegion(pBase + 5, 256);
+
+  /* Parameter checks, on a region 8 bytes past a 4 KB boundary */
+  p = pBase + ((4096U - ((uintptr_t)pBase % 4096U)) % 4096U) + 8U;
+  MEM_ARENA_Init(&Arena);
+  (void)MEM_ARENA_AddRegion(&Arena, "bump", p, 1024, 0, 0);
+  TEST_CHECK(MEM_ARENA_Alloc(&Arena, 0, 0, 0, 0) == NULL);
+  TEST_CHECK(MEM_ARENA_Alloc(&Arena, 8, 48, 0, 0) == NULL);
+  TEST_CHECK(MEM_ARENA_AllocFrom(&Arena, 0, 8, 4096) == NULL);     /* Padding alone exceeds the region */
+  TEST_CHECK_EQ(Arena.aRegion[0].Stat.Used, 0U);
+}
+
+/**
+  * @brief  Checks the size class allocator.
+  */
+static void TEST_Blocks(void)
+{
+  MEM_ArenaTypeDef      Arena;
+  MEM_ARENA_StatTypeDef Stat;
+  uint8_t              *ap[4];
+  uint8_t              *p;
+  uint32_t              Used;
+  int                   Sdram;
+
+  TEST_AddRegions(&Arena);
+  Sdram = MEM_ARENA_FindRegion(&Arena, "sdram");
+
+  /* Rounding: each request takes its class size from the region */
+  ap[0] = MEM_ARENA_AllocBlockFrom(&Arena, Sdram, 1);
+  ap[1] = MEM_ARENA_AllocBlockFrom(&Arena, Sdram, 33);
+  ap[2] = MEM_ARENA_AllocBlockFrom(&Arena, Sdram, 1000);
+  ap[3] = MEM_ARENA_AllocBlockFrom(&Arena, Sdram, 1024);
+  TEST_CHECK_EQ(ap[1] - ap[0], 32U);
+  TEST_CHECK_EQ(ap[2] - ap[1], 64U);
+  TEST_CHECK_EQ(ap[3] - ap[2], 1024U);
+  MEM_ARENA_GetStat(&Arena, Sdram, &Stat);
+  TEST_CHECK_EQ(Stat.Used, 32U + 64U + 1024U + 1024U);
+  TEST_CHECK_EQ(Stat.BlockBytes, 32U + 64U + 1024U + 1024U);
+  TEST_CHECK_EQ(Stat.FreeBytes, 0U);
+  TEST_CHECK(MEM_ARENA_AllocBlockFrom(&Arena, Sdram, 0) == NULL);
+  TEST_CHECK(MEM_ARENA_AllocBlockFrom(&Arena, Sdram, TEST_CLASS_SIZE(TEST_NUM_CLASSES - 1U) + 1U) == NULL);
+  TEST_CHECK(MEM_ARENA_AllocBlockFrom(&Arena, 5, 32) == NULL);
+  TEST_CHECK_EQ(Arena.NumFailed, 3U);
+
+  /* Freed blocks are reused last in, first out, and only by their class */
+  TEST_CHECK_EQ(MEM_ARENA_FreeBlock(&Arena, ap[2], 1000), 0);
+  TEST_CHECK_EQ(MEM_ARENA_FreeBlock(&Arena, ap[3], 513), 0);
+  MEM_ARENA_GetStat(&Arena, Sdram, &Stat);
+  TEST_CHECK_EQ(Stat.BlockBytes, 32U + 64U);
+  TEST_CHECK_EQ(Stat.FreeBytes, 2048U);
+  Used = Stat.Used;
+  TEST_CHECK(MEM_ARENA_AllocBlockFrom(&Arena, Sdram, 600) == ap[3]);
+  TEST_CHECK(MEM_ARENA_AllocBlockFrom(&Arena, Sdram, 1024) == ap[2]);
+  p = MEM_ARENA_AllocBlockFrom(&Arena, Sdram, 512);
+  TEST_CHECK(p == ((uint8_t *)TEST_aSdram + Used));           /* Free list of 512 is empty */
+  MEM_ARENA_GetStat(&Arena, Sdram, &Stat);
+  TEST_CHECK_EQ(Stat.FreeBytes, 0U);
+  TEST_CHECK_EQ(Stat.Used, Used + 512U);
+
+  /* Invalid frees leave the lists alone */
+  TEST_CHECK_EQ(MEM_ARENA_FreeBlock(&Arena, &Used, 32), -1);
+  TEST_CHECK_EQ(MEM_ARENA_FreeBlock(&Arena, ap[0], 0), -1);
+  TEST_CHECK_EQ(MEM_ARENA_FreeBlock(&Arena, ap[0], TEST_CLASS_SIZE(TEST_NUM_CLASSES - 1U) + 1U), -1);
+  MEM_ARENA_GetStat(&Arena, Sdram, &Stat);
+  TEST_CHECK_EQ(Stat.FreeBytes, 0U);
+
+  /* The largest class fills the region, the blocks of a class stay with it */
+  TEST_AddRegions(&Arena);
+  p = MEM_ARENA_AllocBlockFrom(&Arena, Sdram, TEST_CLASS_SIZE(TEST_NUM_CLASSES - 1U));
+  TEST_CHECK(p == (uint8_t *)TEST_aSdram);
+  TEST_CHECK_EQ(MEM_ARENA_FreeBlock(&Arena, p, TEST_CLASS_SIZE(TEST_NUM_CLASSES - 1U)), 0);
+  TEST_CHECK(MEM_ARENA_AllocBlockFrom(&Arena, Sdram, 32) == NULL);
+  MEM_ARENA_GetStat(&Arena, Sdram, &Stat);
+  TEST_CHECK_EQ(Stat.NumFailed, 1U);
+  TEST_CHECK_EQ(Stat.NumAllocs, 1U);
+}
+
+/**
+  * @brief  Creates the operations of the fragmentation workload. The size
+  *         exponent is uniform, so small blocks are frequent and most of
+  *         the memory goes to the large ones.
+  */
+static void TEST_MakeWorkload(void)
+{
+  uint32_t Shift;
+  uint32_t i;
+
+  for (i = 0; i < TEST_FRAG_NUM_OPS; i++)
+  {
+    Shift = TEST_FRAG_MIN_SHIFT + (TEST_GetRand() % TEST_FRAG_NUM_SHIFTS);
+    TEST_aOp[i].Slot     = (uint16_t)(TEST_GetRand() % TEST_FRAG_NUM_SLOTS);
+    TEST_aOp[i].NumBytes = (uint16_t)((1U << Shift) + (TEST_GetRand() % (1U << Shift)));
+  }
+}
+
+/**
+  * @brief  Runs the fragmentation workload on the size class allocator and
+  *         checks the contents of every block and the memory taken from the
+  *         region.
+  */
+static void TEST_Fragmentation(void)
+{
+  MEM_ArenaTypeDef      Arena;
+  MEM_ARENA_StatTypeDef Stat;
+  TEST_SlotTypeDef     *pSlot;
+  uint32_t              aNumLive[TEST_NUM_CLASSES];
+  uint32_t              aPeak[TEST_NUM_CLASSES];
+  uint64_t              SumRequested;
+  uint64_t              SumClass;
+  uint32_t              LiveBytes;
+  uint32_t              PeakLiveBytes;
+  uint32_t              NumBad;
+  uint32_t              Expected;
+  uint32_t              Class;
+  uint32_t              i;
+  uint32_t              k;
+
+  MEM_ARENA_Init(&Arena);
+  (void)MEM_ARENA_AddRegion(&Arena, "frag", TEST_aFrag, TEST_FRAG_REGION_SIZE, MEM_ARENA_ATTR_EXTERNAL,
+                            TEST_CACHE_LINE);
+  memset(TEST_aSlot, 0, sizeof(TEST_aSlot));
+  memset(aNumLive, 0, sizeof(aNumLive));
+  memset(aPeak, 0, sizeof(aPeak));
+  SumRequested  = 0;
+  SumClass      = 0;
+  LiveBytes     = 0;
+  PeakLiveBytes = 0;
+  NumBad        = 0;
+  for (i = 0; i < TEST_FRAG_NUM_OPS; i++)
+  {
+    pSlot = &TEST_aSlot[TEST_aOp[i].Slot];
+    if (pSlot->p != NULL)
+    {
+      for (k = 0; k < pSlot->NumBytes; k += 4U)
+      {
+        if (*(uint32_t *)(pSlot->p + k) != (pSlot->Tag + k))
+        {
+          NumBad++;
+          break;
+        }
+      }
+      Class = TEST_GetClass(pSlot->NumBytes);
+      TEST_CHECK_EQ(MEM_ARENA_FreeBlock(&Arena, pSlot->p, pSlot->NumBytes), 0);
+      aNumLive[Class]--;
+      LiveBytes -= pSlot->NumBytes;
+      pSlot->p = NULL;
+      continue;
+    }
+    pSlot->NumBytes = (TEST_aOp[i].NumBytes + 3U) & ~3U;
+    pSlot->Tag      = i << 16;
+    pSlot->p        = MEM_ARENA_AllocBlockFrom(&Arena, 0, pSlot->NumBytes);
+    if (pSlot->p == NULL)
+    {
+      TEST_CHECK(pSlot->p != NULL);
+      break;
+    }
+    TEST_CHECK_EQ((uintptr_t)pSlot->p % TEST_CACHE_LINE, 0U);
+    for (k = 0; k < pSlot->NumBytes; k += 4U)
+    {
+      *(uint32_t *)(pSlot->p + k) = pSlot->Tag + k;
+    }
+    Class = TEST_GetClass(pSlot->NumBytes);
+    if (++aNumLive[Class] > aPeak[Class])
+    {
+      aPeak[Class] = aNumLive[Class];
+    }
+    LiveBytes += pSlot->NumBytes;
+    if (LiveBytes > PeakLiveBytes)
+    {
+      PeakLiveBytes = LiveBytes;
+    }
+    SumRequested += pSlot->NumBytes;
+    SumClass     += TEST_CLASS_SIZE(Class);
+  }
+  TEST_CHECK_EQ(NumBad, 0U);
+
+  /* A block is carved only when the free list of its class is empty */
+  Expected = 0;
+  for (Class = 0; Class < TEST_NUM_CLASSES; Class++)
+  {
+    Expected += aPeak[Class] * (uint32_t)TEST_CLASS_SIZE(Class);
+  }
+  MEM_ARENA_GetStat(&Arena, 0, &Stat);
+  TEST_CHECK_EQ(Stat.Used, Expected);
+  TEST_CHECK_EQ(Stat.PadBytes, 0U);
+  TEST_CHECK_EQ(Stat.BlockBytes + Stat.FreeBytes, Stat.Used);
+  LiveBytes = 0;
+  for (i = 0; i < TEST_FRAG_NUM_SLOTS; i++)
+  {
+    if (TEST_aSlot[i].p != NULL)
+    {
+      LiveBytes += (uint32_t)TEST_CLASS_SIZE(TEST_GetClass(TEST_aSlot[i].NumBytes));
+    }
+  }
+  TEST_CHECK_EQ(Stat.BlockBytes, LiveBytes);
+
+  printf("Fragmentation: %u ops, %u live blocks of 16 B..16 KB at most, peak %lu KB requested\n",
+         TEST_FRAG_NUM_OPS, TEST_FRAG_NUM_SLOTS, (unsigned long)(PeakLiveBytes / 1024U));
+  printf("  internal: class sizes are %.1f %% above the requested sizes\n",
+         (100.0 * (double)(SumClass - SumRequested)) / (double)SumRequested);
+  printf("  region:   %lu KB carved, %.2f x the peak live request, %lu KB on the free lists at the end\n",
+         (unsigned long)(Stat.Used / 1024U), (double)Stat.Used / (double)PeakLiveBytes,
+         (unsigned long)(Stat.FreeBytes / 1024U));
+}
+
+/**
+  * @brief  Replays the fragmentation workload with the size class allocator
+  *         and with malloc()/free(), and times bump allocations.
+  */
+static void TEST_Throughput(void)
+{
+  MEM_ArenaTypeDef  Arena;
+  TEST_SlotTypeDef *pSlot;
+  uint64_t          t;
+  uint64_t          aTime_ns[2];
+  uint32_t          NumOps;
+  uint32_t          Mode;
+  uint32_t          Loop;
+  uint32_t          i;
+
+  MEM_ARENA_Init(&Arena);
+  (void)MEM_ARENA_AddRegion(&Arena, "frag", TEST_aFrag, TEST_FRAG_REGION_SIZE, MEM_ARENA_ATTR_EXTERNAL,
+                            TEST_CACHE_LINE);
+  for (Mode = 0; Mode < 2U; Mode++)
+  {
+    memset(TEST_aSlot, 0, sizeof(TEST_aSlot));
+    NumOps = 0;
+    t = TEST_GetTime_ns();
+    for (Loop = 0; Loop < 4U; Loop++)
+    {
+      for (i = 0; i < TEST_FRAG_NUM_OPS; i++)
+      {
+        pSlot = &TEST_aSlot[TEST_aOp[i].Slot];
+        if (Mode == 0U)
+        {
+          if (pSlot->p != NULL)
+          {
+            (void)MEM_ARENA_FreeBlock(&Arena, pSlot->p, pSlot->NumBytes);
+            pSlot->p = NULL;
+          }
+          else
+          {
+            pSlot->NumBytes = TEST_aOp[i].NumBytes;
+            pSlot->p        = MEM_ARENA_AllocBlockFrom(&Arena, 0, pSlot->NumBytes);
+          }
+        }
+        else
+        {
+          if (pSlot->p != NULL)
+          {
+            free(pSlot->p);
+            pSlot->p = NULL;
+          }
+          else
+          {
+            pSlot->p = malloc(TEST_aOp[i].NumBytes);
+          }
+        }
+      }
+      NumOps += TEST_FRAG_NUM_OPS;
+    }
+    aTime_ns[Mode] = TEST_GetTime_ns() - t;
+    for (i = 0; i < TEST_FRAG_NUM_SLOTS; i++)
+    {
+      if (Mode == 1U)
+      {
+        free(TEST_aSlot[i].p);
+      }
+      TEST_aSlot[i].p = NULL;
+    }
+  }
+  printf("Throughput: %.1f ns per alloc/free with size classes, %.1f ns with malloc()/free()\n",
+         (double)aTime_ns[0] / NumOps, (double)aTime_ns[1] / NumOps);
+
+  t = TEST_GetTime_ns();
+  for (Loop = 0; Loop < TEST_BENCH_BUMP_LOOPS; Loop++)
+  {
+    MEM_ARENA_Init(&Arena);
+    (void)MEM_ARENA_AddRegion(&Arena, "bump", TEST_aFrag, TEST_FRAG_REGION_SIZE, 0, 0);
+    for (i = 0; i < TEST_BENCH_BUMP_ALLOCS; i++)
+    {
+      TEST_apBench[i] = MEM_ARENA_Alloc(&Arena, 24U + (i & 31U), (i & 7U) == 0U ? 64U : 0U, 0, 0);
+    }
+  }
+  aTime_ns[0] = TEST_GetTime_ns() - t;
+  TEST_CHECK(TEST_apBench[TEST_BENCH_BUMP_ALLOCS - 1U] != NULL);
+  printf("Throughput: %.1f ns per bump allocation\n",
+         (double)aTime_ns[0] / (TEST_BENCH_BUMP_LOOPS * TEST_BENCH_BUMP_ALLOCS));
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Runs the test.
+  */
+int main(void)
+{
+  TEST_Regions();
+  TEST_Bump();
+  TEST_Blocks();
+  TEST_MakeWorkload();
+  TEST_Fragmentation();
+  TEST_Throughput();
+  return TEST_Report("MEM_ArenaTest");
+}
@@ -0,0 +1,93 @@
+/**
+  ******************************************************************************
+  * @file    main.h
+  * @brief   Host replacement of main.h for the inter-core messaging test.
+  *          Only the HAL types, constants and functions used by ipc.c are
+  *          provided. The MPU and NVIC calls do nothing, the hardware
+  *          semaphores and the HAL tick are simulated by the test.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MAIN_H
+#define __MAIN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  HAL_OK    = 0x00U,
+  HAL_ERROR = 0x01U
+} HAL_StatusTypeDef;
+
+typedef enum
+{
+  HSEM1_IRQn = 125,
+  HSEM2_IRQn = 126
+} IRQn_Type;
+
+typedef struct
+{
+  uint8_t  Enable;
+  uint8_t  Number;
+  uint32_t BaseAddress;
+  uint8_t  Size;
+  uint8_t  SubRegionDisable;
+  uint8_t  TypeExtField;
+  uint8_t  AccessPermission;
+  uint8_t  DisableExec;
+  uint8_t  IsShareable;
+  uint8_t  IsCacheable;
+  uint8_t  IsBufferable;
+} MPU_Region_InitTypeDef;
+
+/* Exported constants --------------------------------------------------------*/
+#define D3_SRAM_BASE                    0x38000000UL
+#define MPU_REGION_ENABLE               0x01U
+#define MPU_REGION_NUMBER1              0x01U
+#define MPU_REGION_SIZE_64KB            0x0FU
+#define MPU_TEX_LEVEL1                  0x01U
+#define MPU_REGION_FULL_ACCESS          0x03U
+#define MPU_INSTRUCTION_ACCESS_DISABLE  0x01U
+#define MPU_ACCESS_SHAREABLE            0x01U
+#define MPU_ACCESS_NOT_CACHEABLE        0x00U
+#define MPU_ACCESS_NOT_BUFFERABLE       0x00U
+#define MPU_PRIVILEGED_DEFAULT          0x04U
+
+/* Exported macro ------------------------------------------------------------*/
+#define __HAL_HSEM_SEMID_TO_MASK(__SEMID__)  (1UL << (__SEMID__))
+#define __HAL_RCC_HSEM_CLK_ENABLE()          do { } while (0)
+#define HAL_MPU_Disable()                    do { } while (0)
+#define HAL_MPU_Enable(__CTRL__)             ((void)(__CTRL__))
+#define HAL_MPU_ConfigRegion(__INIT__)       ((void)(__INIT__))
+#define HAL_NVIC_SetPriority(__IRQ__, __PRE__, __SUB__)  ((void)(__IRQ__), (void)(__PRE__), (void)(__SUB__))
+#define HAL_NVIC_EnableIRQ(__IRQ__)          ((void)(__IRQ__))
+
+/* Exported functions prototypes ---------------------------------------------*/
+HAL_StatusTypeDef HAL_HSEM_FastTake(uint32_t SemID);
+void              HAL_HSEM_Release(uint32_t SemID, uint32_t ProcessID);
+void              HAL_HSEM_ActivateNotification(uint32_t SemMask);
+uint32_t          HAL_GetTick(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MAIN_H */
@@ -0,0 +1,78 @@
+/**
+  ******************************************************************************
+  * @file    test_check.h
+  * @brief   Minimal checking helpers shared by the host unit tests.
+  *          Each test is a single executable that returns the number of
+  *          failed checks, so ctest reports any failure.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __TEST_CHECK_H
+#define __TEST_CHECK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+
+/* Exported variables --------------------------------------------------------*/
+static int TEST_NumChecks;
+static int TEST_NumErrors;
+
+/* Exported macro ------------------------------------------------------------*/
+#define TEST_CHECK(Cond)                                                        \
+  do                                                                            \
+  {                                                                             \
+    TEST_NumChecks++;                                                           \
+    if (!(Cond))                                                                \
+    {                                                                           \
+      TEST_NumErrors++;                                                         \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #Cond);          \
+    }                                                                           \
+  } while (0)
+
+#define TEST_CHECK_EQ(Actual, Expected)                                         \
+  do                                                                            \
+  {                                                                             \
+    unsigned long TEST_a = (unsigned long)(Actual);                             \
+    unsigned long TEST_e = (unsigned long)(Expected);                           \
+    TEST_NumChecks++;                                                           \
+    if (TEST_a != TEST_e)                                                       \
+    {                                                                           \
+      TEST_NumErrors++;                                                         \
+      printf("%s:%d: %s is %lu, expected %lu\n", __FILE__, __LINE__,           \
+             #Actual, TEST_a, TEST_e);                                          \
+    }                                                                           \
+  } while (0)
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Prints the summary of a test executable.
+  * @param  sName: Name of the test.
+  * @retval Exit code of the test, 0 if all checks passed.
+  */
+static inline int TEST_Report(const char *sName)
+{
+  printf("%s: %d checks, %d failed\n", sName, TEST_NumChecks, TEST_NumErrors);
+  return (TEST_NumErrors != 0) ? 1 : 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TEST_CHECK_H */
@@ -0,0 +1,590 @@
+/*********************************************************************
+*                                                                    *
+*       emUSB-Host * USB Host stack for embedded applications        *
+*                                                                    *
+**********************************************************************
+----------------------------------------------------------------------
+File        : USBH_CDC_StreamTest.c
+Purpose     : Host test of the CDC streaming mode (USBH_CDC_Stream*)
+              against the CDC loopback model of the virtual host
+              controller:
+              * parameter checks of USBH_CDC_StreamStart(),
+              * data order across segments with USBH_CDC_StreamPeek()
+                and USBH_CDC_StreamCommit(),
+              * watermark and overrun events when the application
+                does not consume the data,
+              * halt on a failed IN transfer,
+              * throughput and receive latency compared to
+                USBH_CDC_Read() with 1 ms transfer latency.
+-------------------------- END-OF-HEADER -----------------------------
+*/
+
+/*********************************************************************
+*
+*       #include Section
+*
+**********************************************************************
+*/
+#include <stdio.h>
+#include <string.h>
+#include "USBH_Int.h"
+#include "USBH_CDC.h"
+#include "USBH_HW_Virtual.h"
+#include "USBH_OS_Sim.h"
+#include "test_check.h"
+
+/*********************************************************************
+*
+*       Defines, configurable
+*
+**********************************************************************
+*/
+#define POOL_SIZE               (512u * 1024u)
+#define NUM_SEGMENTS            4u
+#define SEGMENT_SIZE            512u
+#define HIGH_WATERMARK          1536u
+#define LOW_WATERMARK           512u
+#define TEST_BYTES              (32u * 1024u)
+#define CHUNK_SIZE              1024u
+#define MAX_EVENTS              32u
+#define NUM_MESSAGES            32u
+#define MESSAGE_SIZE            64u
+
+/*********************************************************************
+*
+*       Defines, fixed
+*
+**********************************************************************
+*/
+#define PORT_CDC                1u
+#define EP_BULK_IN              0x81u
+#define STREAM_BUFFER_SIZE      (NUM_SEGMENTS * SEGMENT_SIZE)
+
+/*********************************************************************
+*
+*       Types
+*
+**********************************************************************
+*/
+typedef struct {
+  unsigned Event;
+  U32      NumBytesIn;
+} STREAM_EVENT;
+
+/*********************************************************************
+*
+*       Static data
+*
+**********************************************************************
+*/
+static U32                    _aPool[POOL_SIZE / sizeof(U32)];
+static U8                     _aWrite[TEST_BYTES];
+static U8                     _aRead[TEST_BYTES];
+static USBH_NOTIFICATION_HOOK _Hook;
+static volatile int           _DevIndex = -1;
+static STREAM_EVENT           _aEvent[MAX_EVENTS];
+static unsigned               _NumEvents;
+
+/*********************************************************************
+*
+*       Static code
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _cbOnAddRemove
+*/
+static void _cbOnAddRemove(void * pContext, U8 DevIndex, USBH_DEVICE_EVENT Event) {
+  USBH_USE_PARA(pContext);
+  _DevIndex = (Event == USBH_DEVICE_EVENT_ADD) ? (int)DevIndex : -1;
+}
+
+/*********************************************************************
+*
+*       _cbOnStreamEvent
+*
+*  Function description
+*    Records the stream events. Called in the context of the USBH task.
+*/
+static void _cbOnStreamEvent(USBH_CDC_HANDLE hDevice, unsigned Event, U32 NumBytesIn, void * pUserContext) {
+  USBH_USE_PARA(hDevice);
+  TEST_CHECK(pUserContext == (void *)_aEvent);
+  if (_NumEvents < MAX_EVENTS) {
+    _aEvent[_NumEvents].Event      = Event;
+    _aEvent[_NumEvents].NumBytesIn = NumBytesIn;
+  }
+  _NumEvents++;
+}
+
+/*********************************************************************
+*
+*       _CountEvents
+*/
+static unsigned _CountEvents(unsigned Event) {
+  unsigned i;
+  unsigned n;
+
+  n = 0;
+  for (i = 0; i < _NumEvents && i < MAX_EVENTS; i++) {
+    if (_aEvent[i].Event == Event) {
+      n++;
+    }
+  }
+  return n;
+}
+
+/*********************************************************************
+*
+*       _IsAdded
+*/
+static int _IsAdded(void * pContext) {
+  USBH_USE_PARA(pContext);
+  return (_DevIndex >= 0) ? 1 : 0;
+}
+
+/*********************************************************************
+*
+*       _FillPattern
+*/
+static void _FillPattern(U8 * p, U32 NumBytes, U32 Seed) {
+  U32 i;
+
+  for (i = 0; i < NumBytes; i++) {
+    Seed = Seed * 1103515245u + 12345u;
+    p[i] = (U8)(Seed >> 16);
+  }
+}
+
+/*********************************************************************
+*
+*       _InitConfig
+*/
+static void _InitConfig(USBH_CDC_STREAM_CONFIG * pConfig) {
+  memset(pConfig, 0, sizeof(*pConfig));
+  pConfig->NumSegments   = NUM_SEGMENTS;
+  pConfig->SegmentSize   = SEGMENT_SIZE;
+  pConfig->HighWatermark = HIGH_WATERMARK;
+  pConfig->LowWatermark  = LOW_WATERMARK;
+  pConfig->pfOnEvent     = _cbOnStreamEvent;
+  pConfig->pUserContext  = (void *)_aEvent;
+  _NumEvents = 0;
+}
+
+/*********************************************************************
+*
+*       _Write
+*
+*  Function description
+*    Sends data to the loopback device.
+*/
+static void _Write(USBH_CDC_HANDLE hDevice, const U8 * pData, U32 NumBytes) {
+  U32 NumBytesWritten;
+
+  NumBytesWritten = 0;
+  TEST_CHECK_EQ(USBH_CDC_Write(hDevice, pData, NumBytes, &NumBytesWritten), USBH_STATUS_SUCCESS);
+  TEST_CHECK_EQ(NumBytesWritten, NumBytes);
+}
+
+/*********************************************************************
+*
+*       _Consume
+*
+*  Function description
+*    Copies NumBytes from the stream buffer via peek and commit.
+*    Waits for data that has not been received yet.
+*
+*  Return value
+*    Number of bytes consumed.
+*/
+static U32 _Consume(USBH_CDC_HANDLE hDevice, U8 * pDest, U32 NumBytes, U32 MaxBytesPerCommit) {
+  U8        * pData;
+  U32         NumBytesAvail;
+  U32         NumBytesDone;
+  USBH_TIME   tTimeout;
+
+  NumBytesDone = 0;
+  tTimeout     = SIM_GetTime() + 1000u;
+  while (NumBytesDone < NumBytes) {
+    TEST_CHECK_EQ(USBH_CDC_StreamPeek(hDevice, &pData, &NumBytesAvail), USBH_STATUS_SUCCESS);
+    if (NumBytesAvail == 0u) {
+      if (USBH_TimeDiff(SIM_GetTime(), tTimeout) >= 0) {
+        break;
+      }
+      USBH_OS_Delay(1);
+      continue;
+    }
+    TEST_CHECK(NumBytesAvail <= SEGMENT_SIZE);
+    NumBytesAvail = USBH_MIN(NumBytesAvail, NumBytes - NumBytesDone);
+    NumBytesAvail = USBH_MIN(NumBytesAvail, MaxBytesPerCommit);
+    memcpy(pDest + NumBytesDone, pData, NumBytesAvail);
+    TEST_CHECK_EQ(USBH_CDC_StreamCommit(hDevice, NumBytesAvail), USBH_STATUS_SUCCESS);
+    NumBytesDone += NumBytesAvail;
+  }
+  return NumBytesDone;
+}
+
+/*********************************************************************
+*
+*       _TestParameters
+*/
+static void _TestParameters(USBH_CDC_HANDLE hDevice) {
+  USBH_CDC_STREAM_CONFIG Config;
+  U8                   * pData;
+  U32                    NumBytes;
+  U32                    MaxOut;
+  U32                    MaxIn;
+  U8                     ab[64];
+
+  _InitConfig(&Config);
+  Config.NumSegments = 1;
+  TEST_CHECK_EQ(USBH_CDC_StreamStart(hDevice, &Config), USBH_STATUS_INVALID_PARAM);
+  _InitConfig(&Config);
+  Config.SegmentSize = 100;                                 // Not a multiple of MaxPacketSize.
+  TEST_CHECK_EQ(USBH_CDC_StreamStart(hDevice, &Config), USBH_STATUS_INVALID_PARAM);
+  TEST_CHECK_EQ(USBH_CDC_GetMaxTransferSize(hDevice, &MaxOut, &MaxIn), USBH_STATUS_SUCCESS);
+  _InitConfig(&Config);
+  Config.SegmentSize = (MaxIn / 64u + 1u) * 64u;
+  TEST_CHECK_EQ(USBH_CDC_StreamStart(hDevice, &Config), USBH_STATUS_XFER_SIZE);
+  //
+  // Peek and commit require the streaming mode.
+  //
+  TEST_CHECK_EQ(USBH_CDC_StreamPeek(hDevice, &pData, &NumBytes), USBH_STATUS_ERROR);
+  TEST_CHECK_EQ(USBH_CDC_StreamCommit(hDevice, 1), USBH_STATUS_ERROR);
+  //
+  // Read is refused while streaming, the mode cannot be started twice.
+  //
+  _InitConfig(&Config);
+  TEST_CHECK_EQ(USBH_CDC_StreamStart(hDevice, &Config), USBH_STATUS_SUCCESS);
+  TEST_CHECK_EQ(USBH_CDC_StreamStart(hDevice, &Config), USBH_STATUS_BUSY);
+  TEST_CHECK_EQ(USBH_CDC_Read(hDevice, ab, sizeof(ab), &NumBytes), USBH_STATUS_BUSY);
+  TEST_CHECK_EQ(USBH_CDC_StreamPeek(hDevice, &pData, &NumBytes), USBH_STATUS_SUCCESS);
+  TEST_CHECK_EQ(NumBytes, 0u);
+  TEST_CHECK_EQ(USBH_CDC_StreamCommit(hDevice, 1), USBH_STATUS_INVALID_PARAM);
+  TEST_CHECK_EQ(USBH_CDC_StreamStop(hDevice), USBH_STATUS_SUCCESS);
+  //
+  // After stopping, Read() works again.
+  //
+  _Write(hDevice, (const U8 *)"stream", 6);
+  NumBytes = 0;
+  TEST_CHECK_EQ(USBH_CDC_Read(hDevice, ab, 6, &NumBytes), USBH_STATUS_SUCCESS);
+  TEST_CHECK_EQ(NumBytes, 6u);
+  TEST_CHECK(memcmp(ab, "stream", 6) == 0);
+}
+
+/*********************************************************************
+*
+*       _TestDataOrder
+*
+*  Function description
+*    The application writes chunks which are larger than a segment and
+*    commits data in odd portions, so reads cross segment boundaries
+*    and the ring wraps many times.
+*/
+static void _TestDataOrder(USBH_CDC_HANDLE hDevice) {
+  USBH_CDC_STREAM_CONFIG Config;
+  USBH_CDC_STREAM_STAT   Stat;
+  U32                    Pos;
+  U32                    n;
+
+  _FillPattern(_aWrite, TEST_BYTES, 1);
+  memset(_aRead, 0, TEST_BYTES);
+  _InitConfig(&Config);
+  TEST_CHECK_EQ(USBH_CDC_StreamStart(hDevice, &Config), USBH_STATUS_SUCCESS);
+  n = 0;
+  for (Pos = 0; Pos < TEST_BYTES; Pos += CHUNK_SIZE) {
+    _Write(hDevice, &_aWrite[Pos], CHUNK_SIZE);
+    n += _Consume(hDevice, &_aRead[Pos], CHUNK_SIZE, 100);
+  }
+  TEST_CHECK_EQ(n, TEST_BYTES);
+  TEST_CHECK(memcmp(_aWrite, _aRead, TEST_BYTES) == 0);
+  TEST_CHECK_EQ(USBH_CDC_StreamGetStat(hDevice, &Stat), USBH_STATUS_SUCCESS);
+  TEST_CHECK_EQ(Stat.NumBytesReceived, TEST_BYTES);
+  TEST_CHECK_EQ(Stat.NumErrors, 0u);
+  TEST_CHECK(Stat.MaxNumBytesIn <= STREAM_BUFFER_SIZE);
+  TEST_CHECK(Stat.NumTransfers >= TEST_BYTES / SEGMENT_SIZE);
+  printf("Data order:   %u bytes in %u transfers, max. %u bytes buffered, %u overruns\n",
+         (unsigned)Stat.NumBytesReceived, (unsigned)Stat.NumTransfers, (unsigned)Stat.MaxNumBytesIn, (unsigned)Stat.NumOverruns);
+  TEST_CHECK_EQ(USBH_CDC_StreamStop(hDevice), USBH_STATUS_SUCCESS);
+}
+
+/*********************************************************************
+*
+*       _TestOverrun
+*
+*  Function description
+*    Twice the stream buffer size is sent while the application does
+*    not consume. The stream buffer fills up, the device is NAKed and
+*    nothing is lost once the application consumes the data.
+*/
+static void _TestOverrun(USBH_CDC_HANDLE hDevice) {
+  USBH_CDC_STREAM_CONFIG Config;
+  USBH_CDC_STREAM_STAT   Stat;
+  U32                    NumBytes;
+  unsigned               i;
+
+  NumBytes = 2u * STREAM_BUFFER_SIZE;
+  _FillPattern(_aWrite, NumBytes, 2);
+  memset(_aRead, 0, NumBytes);
+  _InitConfig(&Config);
+  TEST_CHECK_EQ(USBH_CDC_StreamStart(hDevice, &Config), USBH_STATUS_SUCCESS);
+  _Write(hDevice, _aWrite, NumBytes);
+  USBH_OS_Delay(50);
+  TEST_CHECK_EQ(USBH_CDC_StreamGetStat(hDevice, &Stat), USBH_STATUS_SUCCESS);
+  TEST_CHECK_EQ(Stat.NumBytesReceived, STREAM_BUFFER_SIZE);
+  TEST_CHECK_EQ(Stat.MaxNumBytesIn, STREAM_BUFFER_SIZE);
+  TEST_CHECK_EQ(Stat.NumOverruns, 1u);                      // Counted once per full period.
+  TEST_CHECK_EQ(_CountEvents(USBH_CDC_STREAM_EVENT_HIGH_WATERMARK), 1u);
+  TEST_CHECK_EQ(_CountEvents(USBH_CDC_STREAM_EVENT_OVERRUN), 1u);
+  TEST_CHECK_EQ(_CountEvents(USBH_CDC_STREAM_EVENT_LOW_WATERMARK), 0u);
+  for (i = 0; i < _NumEvents && i < MAX_EVENTS; i++) {
+    if (_aEvent[i].Event == USBH_CDC_STREAM_EVENT_HIGH_WATERMARK) {
+      TEST_CHECK(_aEvent[i].NumBytesIn >= HIGH_WATERMARK);
+    }
+  }
+  //
+  // Consume everything. Each freed segment is refilled from the data
+  // waiting in the device, so the buffer fills up again before it drains.
+  // Each low watermark event follows a high watermark event.
+  //
+  TEST_CHECK_EQ(_Consume(hDevice, _aRead, NumBytes, SEGMENT_SIZE), NumBytes);
+  TEST_CHECK(memcmp(_aWrite, _aRead, NumBytes) == 0);
+  TEST_CHECK(_CountEvents(USBH_CDC_STREAM_EVENT_LOW_WATERMARK) >= 1u);
+  TEST_CHECK_EQ(_CountEvents(USBH_CDC_STREAM_EVENT_LOW_WATERMARK), _CountEvents(USBH_CDC_STREAM_EVENT_HIGH_WATERMARK));
+  for (i = 0; i < _NumEvents && i < MAX_EVENTS; i++) {
+    if (_aEvent[i].Event == USBH_CDC_STREAM_EVENT_LOW_WATERMARK) {
+      TEST_CHECK(_aEvent[i].NumBytesIn <= LOW_WATERMARK);
+    }
+  }
+  TEST_CHECK_EQ(_CountEvents(USBH_CDC_STREAM_EVENT_ERROR), 0u);
+  TEST_CHECK_EQ(USBH_CDC_StreamGetStat(hDevice, &Stat), USBH_STATUS_SUCCESS);
+  TEST_CHECK_EQ(Stat.NumBytesReceived, NumBytes);
+  printf("Overrun:      %u overruns, %u events (high %u, low %u, overrun %u), no data lost\n",
+         (unsigned)Stat.NumOverruns, _NumEvents,
+         _CountEvents(USBH_CDC_STREAM_EVENT_HIGH_WATERMARK), _CountEvents(USBH_CDC_STREAM_EVENT_LOW_WATERMARK),
+         _CountEvents(USBH_CDC_STREAM_EVENT_OVERRUN));
+  TEST_CHECK_EQ(USBH_CDC_StreamStop(hDevice), USBH_STATUS_SUCCESS);
+}
+
+/*********************************************************************
+*
+*       _TestError
+*
+*  Function description
+*    A failed IN transfer halts the stream and is reported once.
+*    Data received before the error can still be read.
+*    The virtual host controller decides about an injected error when
+*    a transfer is submitted. The transfer queued before the error
+*    injection is enabled still receives the second chunk, the next one
+*    fails and the third chunk stays in the device.
+*/
+static void _TestError(USBH_CDC_HANDLE hDevice) {
+  USBH_CDC_STREAM_CONFIG   Config;
+  USBH_CDC_STREAM_STAT     Stat;
+  USBH_VHC_ERROR_INJECTION Err;
+  U8                     * pData;
+  U32                      NumBytes;
+
+  _FillPattern(_aWrite, 3u * SEGMENT_SIZE, 3);
+  _InitConfig(&Config);
+  TEST_CHECK_EQ(USBH_CDC_StreamStart(hDevice, &Config), USBH_STATUS_SUCCESS);
+  _Write(hDevice, _aWrite, SEGMENT_SIZE);
+  USBH_OS_Delay(10);
+  memset(&Err, 0, sizeof(Err));
+  Err.Period          = 1;
+  Err.Status          = USBH_STATUS_CRC;
+  Err.DeviceAddress   = USBH_VHC_ANY_ADDRESS;
+  Err.EndpointAddress = EP_BULK_IN;
+  USBH_VHC_SetErrorInjection(&Err);
+  _Write(hDevice, _aWrite + SEGMENT_SIZE, SEGMENT_SIZE);
+  USBH_OS_Delay(10);
+  USBH_VHC_SetErrorInjection(NULL);
+  TEST_CHECK_EQ(USBH_CDC_StreamGetStat(hDevice, &Stat), USBH_STATUS_SUCCESS);
+  TEST_CHECK_EQ(Stat.NumErrors, 1u);
+  TEST_CHECK_EQ(Stat.NumBytesReceived, 2u * SEGMENT_SIZE);
+  TEST_CHECK_EQ(_CountEvents(USBH_CDC_STREAM_EVENT_ERROR), 1u);
+  _Write(hDevice, _aWrite + 2u * SEGMENT_SIZE, SEGMENT_SIZE);
+  USBH_OS_Delay(10);
+  TEST_CHECK_EQ(USBH_CDC_StreamGetStat(hDevice, &Stat), USBH_STATUS_SUCCESS);
+  TEST_CHECK_EQ(Stat.NumBytesReceived, 2u * SEGMENT_SIZE);  // Halted, no further transfer.
+  TEST_CHECK_EQ(_Consume(hDevice, _aRead, 2u * SEGMENT_SIZE, SEGMENT_SIZE), 2u * SEGMENT_SIZE);
+  TEST_CHECK(memcmp(_aRead, _aWrite, 2u * SEGMENT_SIZE) == 0);
+  TEST_CHECK_EQ(USBH_CDC_StreamPeek(hDevice, &pData, &NumBytes), USBH_STATUS_SUCCESS);
+  TEST_CHECK_EQ(NumBytes, 0u);
+  TEST_CHECK_EQ(USBH_CDC_StreamGetStat(hDevice, &Stat), USBH_STATUS_SUCCESS);
+  TEST_CHECK_EQ(Stat.NumTransfers, 2u);                     // Commit does not restart a halted stream.
+  TEST_CHECK_EQ(USBH_CDC_StreamStop(hDevice), USBH_STATUS_SUCCESS);
+  NumBytes = 0;
+  TEST_CHECK_EQ(USBH_CDC_Read(hDevice, _aRead, SEGMENT_SIZE, &NumBytes), USBH_STATUS_SUCCESS);
+  TEST_CHECK_EQ(NumBytes, SEGMENT_SIZE);
+  TEST_CHECK(memcmp(_aRead, _aWrite + 2u * SEGMENT_SIZE, SEGMENT_SIZE) == 0);
+  printf("Error:        stream halted after %u bytes, %u error event\n", (unsigned)Stat.NumBytesReceived, _CountEvents(USBH_CDC_STREAM_EVENT_ERROR));
+}
+
+/*********************************************************************
+*
+*       _TestLatency
+*
+*  Function description
+*    Compares streaming with USBH_CDC_Read() at 1 ms transfer latency.
+*    Throughput: The application alternately writes a chunk and reads it back.
+*    Receive latency: Time from the end of a write of a short message until
+*    the message is available to the application. In streaming mode an
+*    IN transfer is already queued when the data arrives.
+*/
+static void _TestLatency(USBH_CDC_HANDLE hDevice) {
+  USBH_CDC_STREAM_CONFIG Config;
+  USBH_TIME              t0;
+  U32                    tRead;
+  U32                    tStream;
+  U32                    tLatRead;
+  U32                    tLatStream;
+  U32                    Pos;
+  U32                    NumBytes;
+  U32                    n;
+
+  _FillPattern(_aWrite, TEST_BYTES, 4);
+  USBH_VHC_SetLatency(1);
+  //
+  // USBH_CDC_Read()
+  //
+  memset(_aRead, 0, TEST_BYTES);
+  t0 = SIM_GetTime();
+  for (Pos = 0; Pos < TEST_BYTES; Pos += CHUNK_SIZE) {
+    _Write(hDevice, &_aWrite[Pos], CHUNK_SIZE);
+    for (n = 0; n < CHUNK_SIZE; n += NumBytes) {
+      NumBytes = 0;
+      if (USBH_CDC_Read(hDevice, &_aRead[Pos + n], CHUNK_SIZE - n, &NumBytes) != USBH_STATUS_SUCCESS && NumBytes == 0u) {
+        break;
+      }
+    }
+  }
+  tRead = (U32)(SIM_GetTime() - t0);
+  TEST_CHECK(memcmp(_aWrite, _aRead, TEST_BYTES) == 0);
+  tLatRead = 0;
+  for (Pos = 0; Pos < NUM_MESSAGES * MESSAGE_SIZE; Pos += MESSAGE_SIZE) {
+    _Write(hDevice, &_aWrite[Pos], MESSAGE_SIZE);
+    t0 = SIM_GetTime();
+    NumBytes = 0;
+    TEST_CHECK_EQ(USBH_CDC_Read(hDevice, &_aRead[Pos], MESSAGE_SIZE, &NumBytes), USBH_STATUS_SUCCESS);
+    TEST_CHECK_EQ(NumBytes, MESSAGE_SIZE);
+    tLatRead += (U32)(SIM_GetTime() - t0);
+  }
+  //
+  // Streaming
+  //
+  memset(_aRead, 0, TEST_BYTES);
+  _InitConfig(&Config);
+  Config.pfOnEvent = NULL;
+  TEST_CHECK_EQ(USBH_CDC_StreamStart(hDevice, &Config), USBH_STATUS_SUCCESS);
+  t0 = SIM_GetTime();
+  for (Pos = 0; Pos < TEST_BYTES; Pos += CHUNK_SIZE) {
+    _Write(hDevice, &_aWrite[Pos], CHUNK_SIZE);
+    TEST_CHECK_EQ(_Consume(hDevice, &_aRead[Pos], CHUNK_SIZE, SEGMENT_SIZE), CHUNK_SIZE);
+  }
+  tStream = (U32)(SIM_GetTime() - t0);
+  TEST_CHECK(memcmp(_aWrite, _aRead, TEST_BYTES) == 0);
+  USBH_OS_Delay(10);                                        // The next IN transfer is queued.
+  tLatStream = 0;
+  for (Pos = 0; Pos < NUM_MESSAGES * MESSAGE_SIZE; Pos += MESSAGE_SIZE) {
+    _Write(hDevice, &_aWrite[Pos], MESSAGE_SIZE);
+    t0 = SIM_GetTime();
+    TEST_CHECK_EQ(_Consume(hDevice, &_aRead[Pos], MESSAGE_SIZE, MESSAGE_SIZE), MESSAGE_SIZE);
+    tLatStream += (U32)(SIM_GetTime() - t0);
+    USBH_OS_Delay(2);                                       // Application processes the message.
+  }
+  TEST_CHECK(memcmp(_aWrite, _aRead, NUM_MESSAGES * MESSAGE_SIZE) == 0);
+  TEST_CHECK_EQ(USBH_CDC_StreamStop(hDevice), USBH_STATUS_SUCCESS);
+  TEST_CHECK(tStream <= tRead);
+  TEST_CHECK(tLatStream < tLatRead);
+  USBH_VHC_SetLatency(0);
+  printf("Throughput:   %u bytes with 1 ms latency, USBH_CDC_Read() %u ms, streaming %u ms\n",
+         (unsigned)TEST_BYTES, (unsigned)tRead, (unsigned)tStream);
+  printf("Latency:      %u messages of %u bytes, USBH_CDC_Read() %u ms, streaming %u ms in total\n",
+         (unsigned)NUM_MESSAGES, (unsigned)MESSAGE_SIZE, (unsigned)tLatRead, (unsigned)tLatStream);
+}
+
+/*********************************************************************
+*
+*       _TestRemoval
+*
+*  Function description
+*    The device is removed while streaming. Received data can still be
+*    read, closing the handle stops the stream and frees the buffer.
+*/
+static void _TestRemoval(USBH_CDC_HANDLE hDevice) {
+  USBH_CDC_STREAM_CONFIG Config;
+  U8                   * pData;
+  U32                    NumBytes;
+
+  _FillPattern(_aWrite, SEGMENT_SIZE, 5);
+  _InitConfig(&Config);
+  TEST_CHECK_EQ(USBH_CDC_StreamStart(hDevice, &Config), USBH_STATUS_SUCCESS);
+  _Write(hDevice, _aWrite, SEGMENT_SIZE);
+  USBH_OS_Delay(10);
+  TEST_CHECK_EQ(USBH_VHC_Disconnect(PORT_CDC), USBH_STATUS_SUCCESS);
+  USBH_OS_Delay(100);
+  TEST_CHECK(_DevIndex < 0);
+  TEST_CHECK_EQ(USBH_CDC_StreamPeek(hDevice, &pData, &NumBytes), USBH_STATUS_SUCCESS);
+  TEST_CHECK_EQ(NumBytes, SEGMENT_SIZE);
+  TEST_CHECK(pData != NULL && memcmp(pData, _aWrite, SEGMENT_SIZE) == 0);
+  TEST_CHECK_EQ(USBH_CDC_Close(hDevice), USBH_STATUS_SUCCESS);
+}
+
+/*********************************************************************
+*
+*       Public code
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       USBH_X_Config
+*/
+void USBH_X_Config(void) {
+  USBH_AssignMemory(_aPool, sizeof(_aPool));
+  (void)USBH_VHC_Add(1);
+}
+
+/*********************************************************************
+*
+*       main
+*/
+int main(void) {
+  USBH_VHC_DEVICE * pDev;
+  USBH_CDC_HANDLE   hDevice;
+  U32               NumBytesUsed;
+
+  SIM_Init();
+  SIM_StartStack();
+  (void)USBH_CDC_Init();
+  (void)USBH_CDC_AddNotification(&_Hook, _cbOnAddRemove, NULL);
+  pDev = USBH_VHC_CreateCDCLoopback();
+  TEST_CHECK(pDev != NULL);
+  TEST_CHECK_EQ(USBH_VHC_Connect(PORT_CDC, pDev), USBH_STATUS_SUCCESS);
+  TEST_CHECK_EQ(SIM_WaitFor(_IsAdded, NULL, 5000), 0);
+  if (_DevIndex >= 0) {
+    hDevice = USBH_CDC_Open((unsigned)_DevIndex);
+    TEST_CHECK(hDevice != USBH_CDC_INVALID_HANDLE);
+    if (hDevice != USBH_CDC_INVALID_HANDLE) {
+      (void)USBH_CDC_SetTimeouts(hDevice, 100, 100);
+      NumBytesUsed = USBH_MEM_GetUsed(0);
+      _TestParameters(hDevice);
+      _TestDataOrder(hDevice);
+      _TestOverrun(hDevice);
+      _TestError(hDevice);
+      _TestLatency(hDevice);
+      TEST_CHECK_EQ(USBH_MEM_GetUsed(0), NumBytesUsed);     // All stream buffers were freed.
+      _TestRemoval(hDevice);
+    }
+  }
+  USBH_VHC_DeleteDevice(pDev);
+  (void)USBH_CDC_RemoveNotification(&_Hook);
+  USBH_CDC_Exit();
+  SIM_StopStack();
+  return TEST_Report("USBH_CDC_StreamTest");
+}
+
+/*************************** End of file ****************************/
@@ -0,0 +1,495 @@
+/*********************************************************************
+*                                                                    *
+*       emUSB-Host * USB Host stack for embedded applications        *
+*                                                                    *
+**********************************************************************
+----------------------------------------------------------------------
+File        : USBH_DWC2_IsoTest.c
+Purpose     : Host test of the isochronous packet ring of the DWC2
+              driver (STM32H7 HS variant). The driver is compiled into
+              this file and runs against a register block in RAM, the
+              test plays the part of the controller: it completes the
+              armed channel and sets the frame counter (HFNUM).
+              * IN: the ring wraps, the channel is re-armed before the
+                application acknowledges, an application falling
+                behind by USBH_DWC2_ISO_NUM_BUFFERS packets stops the
+                channel without overwriting data,
+              * missed (micro)frames derived from HFNUM for high and
+                full speed, across the wrap of the frame counter,
+              * OUT: packets are sent in the order they were filled.
+-------------------------- END-OF-HEADER -----------------------------
+*/
+
+/*********************************************************************
+*
+*       #include Section
+*
+**********************************************************************
+*/
+#include <stdio.h>
+#include <string.h>
+#include "USBH_HW_STM32H7xxHS.c"
+#include "USBH_HW_Virtual.h"
+#include "USBH_OS_Sim.h"
+#include "test_check.h"
+
+/*********************************************************************
+*
+*       Defines, configurable
+*
+**********************************************************************
+*/
+#define POOL_SIZE               (64u * 1024u)
+#define MAX_PACKET_SIZE         192u
+#define NUM_CYCLES              3u          // Number of times the ring is wrapped.
+
+/*********************************************************************
+*
+*       Defines, fixed
+*
+**********************************************************************
+*/
+#define NUM_BUFFERS             USBH_DWC2_ISO_NUM_BUFFERS
+#define FRAME_MASK              0x3FFFu
+#define FTREM                   (0x1234uL << 16)    // Frame time remaining, upper half of HFNUM.
+#define EP_IN_HS                0x81u
+#define EP_IN_FS                0x82u
+#define EP_OUT_HS               0x03u
+
+/*********************************************************************
+*
+*       Types
+*
+**********************************************************************
+*/
+typedef struct {
+  unsigned      NumCalls;
+  USBH_STATUS   Status;
+  U16           Length;
+  const U8    * pData;
+  U16           FrameNumber;
+  U16           NumMissedFrames;
+} ISO_COMPLETION;
+
+typedef struct {
+  USBH_DWC2_EP_INFO * pEP;
+  USBH_URB            Urb;
+} ISO_EP;
+
+/*********************************************************************
+*
+*       Static data
+*
+**********************************************************************
+*/
+static U32              _aPool[POOL_SIZE / 4u];
+static USBH_DWC2_HWREGS _Regs;
+static USB_DEVICE       _Device;                    // Connected to the root port, no split transactions.
+static ISO_COMPLETION   _Completion;
+
+/*********************************************************************
+*
+*       Static code
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _CacheClean
+*/
+static void _CacheClean(void * p, unsigned long NumBytes) {
+  USBH_USE_PARA(p);
+  USBH_USE_PARA(NumBytes);
+}
+
+/*********************************************************************
+*
+*       _CacheInvalidate
+*/
+static void _CacheInvalidate(void * p, unsigned long NumBytes) {
+  USBH_USE_PARA(p);
+  USBH_USE_PARA(NumBytes);
+}
+
+/*********************************************************************
+*
+*       _cbOnIsoCompletion
+*/
+static void _cbOnIsoCompletion(USBH_URB * pUrb) {
+  _Completion.NumCalls++;
+  _Completion.Status = pUrb->Header.Status;
+  if (pUrb->Header.Status == USBH_STATUS_SUCCESS) {
+    _Completion.Length          = pUrb->Request.IsoRequest.Length;
+    _Completion.pData           = (const U8 *)pUrb->Request.IsoRequest.pData;
+    _Completion.FrameNumber     = pUrb->Request.IsoRequest.FrameNumber;
+    _Completion.NumMissedFrames = pUrb->Request.IsoRequest.NumMissedFrames;
+  }
+}
+
+/*********************************************************************
+*
+*       _FillPattern
+*/
+static void _FillPattern(U8 * p, unsigned NumBytes, unsigned Seed) {
+  unsigned i;
+
+  for (i = 0; i < NumBytes; i++) {
+    p[i] = (U8)(Seed * 31u + i);
+  }
+}
+
+/*********************************************************************
+*
+*       _IsPattern
+*/
+static int _IsPattern(const U8 * p, unsigned NumBytes, unsigned Seed) {
+  unsigned i;
+
+  for (i = 0; i < NumBytes; i++) {
+    if (p[i] != (U8)(Seed * 31u + i)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/*********************************************************************
+*
+*       _GetBuffer
+*
+*  Function description
+*    Returns the packet buffer at a position of the ring.
+*/
+static const U8 * _GetBuffer(const ISO_EP * pIso, unsigned Pos) {
+  return pIso->pEP->pBuffer + (Pos % NUM_BUFFERS) * pIso->pEP->BuffSize;
+}
+
+/*********************************************************************
+*
+*       _GetChannel
+*/
+static USBH_DWC2_HCCHANNEL * _GetChannel(const ISO_EP * pIso) {
+  return &_Regs.aHChannel[pIso->pEP->Channel];
+}
+
+/*********************************************************************
+*
+*       _IsArmed
+*
+*  Function description
+*    Checks whether the channel is enabled for a transfer to / from
+*    the given packet buffer.
+*/
+static int _IsArmed(const ISO_EP * pIso, const U8 * pBuffer) {
+  const USBH_DWC2_HCCHANNEL * pHwChannel;
+
+  pHwChannel = _GetChannel(pIso);
+  return (pHwChannel->HCCHAR & HCCHAR_CHENA) != 0u && pHwChannel->HCDMA == (U32)SEGGER_PTR2ADDR(pBuffer);
+}
+
+/*********************************************************************
+*
+*       _CompleteFrame
+*
+*  Function description
+*    Completes the transfer of the armed channel in the given (micro)frame,
+*    as the controller does. IN: NumBytes are received and written with
+*    the pattern Seed. OUT: the number of bytes sent is returned.
+*/
+static U32 _CompleteFrame(ISO_EP * pIso, U32 Frame, unsigned NumBytes, unsigned Seed) {
+  USBH_DWC2_CHANNEL_INFO * pChannelInfo;
+  USBH_DWC2_HCCHANNEL    * pHwChannel;
+  U32                      NumBytesRequested;
+
+  pChannelInfo      = &pIso->pEP->pInst->aChannelInfo[pIso->pEP->Channel];
+  pHwChannel        = _GetChannel(pIso);
+  NumBytesRequested = XFRSIZ_FROM_HCTSIZ(pHwChannel->HCTSIZ);
+  TEST_CHECK((pHwChannel->HCCHAR & HCCHAR_CHENA) != 0u);
+  TEST_CHECK_EQ(PCKCNT_FROM_HCTSIZ(pHwChannel->HCTSIZ), 1u);
+  if ((pIso->pEP->EndpointAddress & 0x80u) != 0u) {
+    TEST_CHECK_EQ(NumBytesRequested, MAX_PACKET_SIZE);
+    _FillPattern(pChannelInfo->pBuffer, NumBytes, Seed);
+    pHwChannel->HCTSIZ = (pHwChannel->HCTSIZ & ~0x7FFFFuL) | (NumBytesRequested - NumBytes);
+  }
+  pHwChannel->HCCHAR &= ~HCCHAR_CHENA;
+  pHwChannel->HCINT   = CHANNEL_CHH | CHANNEL_XFRC;
+  _Regs.HFNUM         = FTREM | (Frame & FRAME_MASK);
+  _DWC2_HandleEPIso(pIso->pEP->pInst, pChannelInfo);
+  return NumBytesRequested;
+}
+
+/*********************************************************************
+*
+*       _Ack
+*
+*  Function description
+*    Gives the oldest received packet back to the driver (IN) or fills
+*    the next packet (OUT).
+*/
+static USBH_STATUS _Ack(const ISO_EP * pIso, const U8 * pData, U32 NumBytes, const U8 ** ppBuffer) {
+  USBH_ISO_DATA_CTRL IsoData;
+  USBH_STATUS        Status;
+
+  memset(&IsoData, 0, sizeof(IsoData));
+  IsoData.pData  = pData;
+  IsoData.Length = NumBytes;
+  Status = _IsoDataCtrl(pIso->pEP, &IsoData);
+  if (ppBuffer != NULL) {
+    *ppBuffer = IsoData.pBuffer;
+  }
+  return Status;
+}
+
+/*********************************************************************
+*
+*       _StartEP
+*/
+static void _StartEP(USBH_DWC2_INST * pInst, ISO_EP * pIso, U8 EndpointAddress, USBH_SPEED Speed) {
+  memset(pIso, 0, sizeof(*pIso));
+  memset(&_Completion, 0, sizeof(_Completion));
+  pIso->pEP = (USBH_DWC2_EP_INFO *)_AddEndpoint(pInst, USB_EP_TYPE_ISO, 1, EndpointAddress, MAX_PACKET_SIZE, 8, Speed);
+  TEST_CHECK(pIso->pEP != NULL);
+  pIso->Urb.Header.Function                = USBH_FUNCTION_ISO_REQUEST;
+  pIso->Urb.Header.pfOnInternalCompletion  = _cbOnIsoCompletion;
+  pIso->Urb.Header.pDevice                 = &_Device;
+  pIso->Urb.Request.IsoRequest.Endpoint    = EndpointAddress;
+  TEST_CHECK_EQ(_SubmitRequest(pIso->pEP, &pIso->Urb), USBH_STATUS_PENDING);
+  TEST_CHECK_EQ(pIso->Urb.Request.IsoRequest.NBuffers, NUM_BUFFERS);
+  TEST_CHECK(pIso->pEP->BuffSize >= MAX_PACKET_SIZE);
+  TEST_CHECK_EQ(pIso->pEP->BuffSize % USBH_DWC2_CACHE_LINE_SIZE, 0u);
+}
+
+/*********************************************************************
+*
+*       _StopEP
+*
+*  Function description
+*    Aborts the URB, a running transfer is completed by the controller
+*    first. Then the endpoint is released.
+*/
+static void _StopEP(ISO_EP * pIso, U32 Frame) {
+  unsigned NumCalls;
+
+  NumCalls = _Completion.NumCalls;
+  TEST_CHECK_EQ(_AbortEndpoint(pIso->pEP), USBH_STATUS_SUCCESS);
+  if (pIso->pEP->BuffBusy != 0) {
+    TEST_CHECK_EQ(_Completion.NumCalls, NumCalls);
+    (void)_CompleteFrame(pIso, Frame, 0, 0);
+  }
+  TEST_CHECK_EQ(_Completion.NumCalls, NumCalls + 1u);
+  TEST_CHECK_EQ(_Completion.Status, USBH_STATUS_CANCELED);
+  TEST_CHECK(pIso->pEP->pPendingUrb == NULL);
+  _ReleaseEndpoint(pIso->pEP, NULL, NULL);
+  USBH_OS_Delay(10);                          // The endpoint is freed by a timer.
+}
+
+/*********************************************************************
+*
+*       _TestRingIn
+*
+*  Function description
+*    Receives packets on a high speed IN endpoint. The ring is wrapped
+*    with immediate acknowledges, then the application stops acknowledging.
+*/
+static void _TestRingIn(USBH_DWC2_INST * pInst) {
+  ISO_EP       Iso;
+  const U8   * pBuffer;
+  U32          Frame;
+  unsigned     NumBytes;
+  unsigned     i;
+
+  _StartEP(pInst, &Iso, EP_IN_HS, USBH_HIGH_SPEED);
+  Frame = 0x100;
+  //
+  // Every packet of the ring is used in turn, the channel is re-armed
+  // with the next buffer before the application sees the packet.
+  //
+  for (i = 0; i < NUM_CYCLES * NUM_BUFFERS; i++) {
+    TEST_CHECK(_IsArmed(&Iso, _GetBuffer(&Iso, i)));
+    NumBytes = 1u + (i * 37u) % MAX_PACKET_SIZE;
+    (void)_CompleteFrame(&Iso, Frame, NumBytes, i);
+    TEST_CHECK_EQ(_Completion.NumCalls, i + 1u);
+    TEST_CHECK_EQ(_Completion.Status, USBH_STATUS_SUCCESS);
+    TEST_CHECK_EQ(_Completion.Length, NumBytes);
+    TEST_CHECK(_Completion.pData == _GetBuffer(&Iso, i));
+    TEST_CHECK(_IsPattern(_Completion.pData, NumBytes, i));
+    TEST_CHECK_EQ(_Completion.FrameNumber, Frame);
+    TEST_CHECK_EQ(_Completion.NumMissedFrames, 0u);
+    TEST_CHECK(_IsArmed(&Iso, _GetBuffer(&Iso, i + 1u)));
+    TEST_CHECK_EQ(_Ack(&Iso, NULL, 0, &pBuffer), USBH_STATUS_SUCCESS);
+    TEST_CHECK(pBuffer == _Completion.pData);
+    Frame += 8u;
+  }
+  //
+  // The application falls behind. The driver keeps receiving into the free
+  // buffers and stops the channel when the ring is full.
+  //
+  for (i = 0; i < NUM_BUFFERS; i++) {
+    TEST_CHECK(_IsArmed(&Iso, _GetBuffer(&Iso, i)));
+    (void)_CompleteFrame(&Iso, Frame, MAX_PACKET_SIZE, 100u + i);
+    TEST_CHECK(_Completion.pData == _GetBuffer(&Iso, i));
+    Frame += 8u;
+  }
+  TEST_CHECK((_GetChannel(&Iso)->HCCHAR & HCCHAR_CHENA) == 0u);
+  TEST_CHECK_EQ(Iso.pEP->BuffBusy, 0);
+  //
+  // No packet was overwritten. The oldest is given back first and restarts the channel.
+  //
+  for (i = 0; i < NUM_BUFFERS; i++) {
+    TEST_CHECK(_IsPattern(_GetBuffer(&Iso, i), MAX_PACKET_SIZE, 100u + i));
+    TEST_CHECK_EQ(_Ack(&Iso, NULL, 0, &pBuffer), USBH_STATUS_SUCCESS);
+    TEST_CHECK(pBuffer == _GetBuffer(&Iso, i));
+    TEST_CHECK(_IsArmed(&Iso, _GetBuffer(&Iso, 0)));
+  }
+  TEST_CHECK_EQ(_Ack(&Iso, NULL, 0, NULL), USBH_STATUS_BUSY);
+  _StopEP(&Iso, Frame);
+}
+
+/*********************************************************************
+*
+*       _CheckMissedFrames
+*
+*  Function description
+*    Completes one packet in each (micro)frame of the list and checks the
+*    number of (micro)frames without a transfer reported with each packet.
+*/
+static void _CheckMissedFrames(USBH_DWC2_INST * pInst, U8 EndpointAddress, USBH_SPEED Speed, const U32 * paFrame, const U16 * paNumMissed, unsigned NumFrames) {
+  ISO_EP   Iso;
+  unsigned i;
+
+  _StartEP(pInst, &Iso, EndpointAddress, Speed);
+  for (i = 0; i < NumFrames; i++) {
+    (void)_CompleteFrame(&Iso, paFrame[i], 8, i);
+    TEST_CHECK_EQ(_Completion.FrameNumber, paFrame[i] & FRAME_MASK);
+    TEST_CHECK_EQ(_Completion.NumMissedFrames, paNumMissed[i]);
+    TEST_CHECK_EQ(_Ack(&Iso, NULL, 0, NULL), USBH_STATUS_SUCCESS);
+  }
+  _StopEP(&Iso, paFrame[NumFrames - 1u] + 8u);
+}
+
+/*********************************************************************
+*
+*       _TestMissedFrames
+*
+*  Function description
+*    A high speed host counts micro frames, a full speed host counts
+*    frames. Each transfer takes a frame. The frame counter wraps at 0x3FFF.
+*/
+static void _TestMissedFrames(USBH_DWC2_INST * pInst) {
+  static const U32 _aFrameHS[]     = { 0x0100, 0x0108, 0x0118, 0x0140, 0x0145, 0x3FF8, 0x0010, 0x0018 };
+  static const U16 _aNumMissedHS[] = { 0,      0,      1,      4,      0,      0x7D5,  2,      0      };
+  static const U32 _aFrameFS[]     = { 0x0200, 0x0201, 0x0204, 0x0205, 0x3FFE, 0x0001, 0x0002 };
+  static const U16 _aNumMissedFS[] = { 0,      0,      2,      0,      0x3DF8, 2,      0      };
+
+  _CheckMissedFrames(pInst, EP_IN_HS, USBH_HIGH_SPEED, _aFrameHS, _aNumMissedHS, SEGGER_COUNTOF(_aFrameHS));
+  _CheckMissedFrames(pInst, EP_IN_FS, USBH_FULL_SPEED, _aFrameFS, _aNumMissedFS, SEGGER_COUNTOF(_aFrameFS));
+}
+
+/*********************************************************************
+*
+*       _TestRingOut
+*
+*  Function description
+*    Sends packets on a high speed OUT endpoint. The application fills
+*    the ring, then refills each packet as soon as it was sent.
+*/
+static void _TestRingOut(USBH_DWC2_INST * pInst) {
+  ISO_EP       Iso;
+  U8           abData[MAX_PACKET_SIZE];
+  const U8   * pBuffer;
+  U32          Frame;
+  unsigned     NumFilled;
+  unsigned     NumSent;
+
+  _StartEP(pInst, &Iso, EP_OUT_HS, USBH_HIGH_SPEED);
+  TEST_CHECK((_GetChannel(&Iso)->HCCHAR & HCCHAR_CHENA) == 0u);
+  //
+  // The first packet only opens the channel, the transfer starts with the second one.
+  //
+  for (NumFilled = 0; NumFilled < NUM_BUFFERS; NumFilled++) {
+    _FillPattern(abData, 10u + NumFilled, NumFilled);
+    TEST_CHECK_EQ(_Ack(&Iso, abData, 10u + NumFilled, &pBuffer),
+                  (NumFilled == NUM_BUFFERS - 1u) ? USBH_STATUS_SUCCESS : USBH_STATUS_NEED_MORE_DATA);
+    TEST_CHECK(pBuffer == _GetBuffer(&Iso, NumFilled));
+    TEST_CHECK_EQ((_GetChannel(&Iso)->HCCHAR & HCCHAR_CHENA) != 0u, NumFilled != 0u);
+  }
+  TEST_CHECK_EQ(_Ack(&Iso, abData, 1, NULL), USBH_STATUS_BUSY);
+  TEST_CHECK_EQ(_Ack(&Iso, abData, MAX_PACKET_SIZE + 1u, NULL), USBH_STATUS_LENGTH);
+  //
+  // Each packet sent frees its buffer, which is refilled with the next packet.
+  //
+  Frame = 0x200;
+  for (NumSent = 0; NumSent < NUM_CYCLES * NUM_BUFFERS; NumSent++) {
+    TEST_CHECK(_IsArmed(&Iso, _GetBuffer(&Iso, NumSent)));
+    TEST_CHECK(_IsPattern(_GetBuffer(&Iso, NumSent), 10u + NumSent, NumSent));
+    TEST_CHECK_EQ(_CompleteFrame(&Iso, Frame, 0, 0), 10u + NumSent);
+    TEST_CHECK_EQ(_Completion.NumCalls, NumSent + 1u);
+    TEST_CHECK_EQ(_Completion.Length, 10u + NumSent);
+    TEST_CHECK(_Completion.pData == _GetBuffer(&Iso, NumSent));
+    TEST_CHECK_EQ(_Completion.NumMissedFrames, 0u);
+    _FillPattern(abData, 10u + NumFilled, NumFilled);
+    TEST_CHECK_EQ(_Ack(&Iso, abData, 10u + NumFilled, &pBuffer), USBH_STATUS_SUCCESS);
+    TEST_CHECK(pBuffer == _GetBuffer(&Iso, NumSent));
+    NumFilled++;
+    Frame += 8u;
+  }
+  _StopEP(&Iso, Frame);
+}
+
+/*********************************************************************
+*
+*       Public code
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       USBH_X_Config
+*/
+void USBH_X_Config(void) {
+  static const SEGGER_CACHE_CONFIG _CacheConfig = {
+    USBH_DWC2_CACHE_LINE_SIZE,
+    NULL,
+    _CacheClean,
+    _CacheInvalidate
+  };
+
+  USBH_AssignMemory(_aPool, sizeof(_aPool));
+  USBH_STM32H7_HS_SetCacheConfig(&_CacheConfig, sizeof(_CacheConfig));
+  //
+  // USBH_Exit() wakes the ISR task through the host controllers, so the stack needs one.
+  // The DWC2 controller under test is not added.
+  //
+  (void)USBH_VHC_Add(1);
+}
+
+/*********************************************************************
+*
+*       main
+*/
+int main(void) {
+  USBH_DWC2_INST * pInst;
+  U32              NumBytesUsed;
+
+  SIM_Init();
+  SIM_StartStack();
+  NumBytesUsed = USBH_MEM_GetUsed(0);
+  //
+  // The registers of the controller are not initialized, the test only drives the ISO code paths.
+  //
+  pInst = _DWC2_CreateController(SEGGER_PTR2ADDR(&_Regs));
+  _TestRingIn(pInst);
+  _TestMissedFrames(pInst);
+  _TestRingOut(pInst);
+  TEST_CHECK_EQ(pInst->UsedChannelMask, 0u);
+  USBH_ReleaseTimer(&pInst->ChannelCheckTimer);
+  USBH_FREE(pInst);
+  TEST_CHECK_EQ(USBH_MEM_GetUsed(0), NumBytesUsed);
+  printf("%u packet buffers per ISO endpoint, ring wrapped %u times\n", (unsigned)NUM_BUFFERS, NUM_CYCLES);
+  SIM_StopStack();
+  return TEST_Report("USBH_DWC2_IsoTest");
+}
+
+/*************************** End of file ****************************/
@@ -0,0 +1,523 @@
+/*********************************************************************
+*                                                                    *
+*       emUSB-Host * USB Host stack for embedded applications        *
+*                                                                    *
+**********************************************************************
+----------------------------------------------------------------------
+File        : USBH_EnumCacheTest.c
+Purpose     : Host test of the enumeration descriptor cache and of
+              the parallel port debouncing of external hubs on the
+              virtual host controller. Vendor specific test devices
+              with a serial number are enumerated:
+              * miss: an unknown device reads all descriptors,
+              * hit: the same device connected again takes its
+                configuration descriptor from the cache,
+              * miss: a device with another serial number,
+              * stale: same device descriptor and serial number, but
+                a changed configuration is detected and re-read,
+              * time to ready of one and of four devices connected
+                to a hub at the same time, read via USBH_GetEnumTime().
+-------------------------- END-OF-HEADER -----------------------------
+*/
+
+/*********************************************************************
+*
+*       #include Section
+*
+**********************************************************************
+*/
+#include <stdio.h>
+#include <string.h>
+#include "USBH_Int.h"
+#include "USBH_HW_Virtual.h"
+#include "USBH_OS_Sim.h"
+#include "test_check.h"
+
+/*********************************************************************
+*
+*       Defines, configurable
+*
+**********************************************************************
+*/
+#define POOL_SIZE               (512u * 1024u)
+#define NUM_DEVICES             4u
+#define MAX_INTERFACES          8u
+#define ENUM_TIMEOUT            10000u      // Virtual ms.
+#define TIME_TOLERANCE          20u         // Virtual ms.
+
+/*********************************************************************
+*
+*       Defines, fixed
+*
+**********************************************************************
+*/
+#define PORT_DEVICE             1u
+#define PORT_HUB                2u
+
+#define TEST_VID                0x8765u
+#define TEST_PID                0x00E0u
+#define POWER_GOOD_TIME         300u        // Default of USBH_Global.Config.DefaultPowerGoodTime.
+
+#define CONFIG1_SIZE            32u         // 1 interface with 2 bulk endpoints.
+#define CONFIG2_SIZE            55u         // 2 interfaces with 2 bulk endpoints each.
+
+/*********************************************************************
+*
+*       Types
+*
+**********************************************************************
+*/
+typedef struct {
+  USBH_VHC_DEVICE   Dev;
+  const char      * apString[3];
+  char              acSerial[8];
+} TEST_DEVICE;
+
+typedef struct {
+  USBH_INTERFACE_ID aInterfaceId[MAX_INTERFACES];
+  U32               NumAdded;
+  U32               NumRemoved;
+} PNP_LIST;
+
+typedef struct {
+  U32 NumTransfers;
+  U32 NumBytesIn;
+  U32 EnumTime;
+  U8  FromCache;
+  U8  NumInterfaces;
+} ENUM_RESULT;
+
+/*********************************************************************
+*
+*       Static const data
+*
+**********************************************************************
+*/
+static const U8 _abDeviceDesc[18] = {
+  18, USB_DEVICE_DESCRIPTOR_TYPE,
+  0x00, 0x02,                                 // bcdUSB
+  0x00, 0x00, 0x00,                           // Class, sub class, protocol
+  64,                                         // bMaxPacketSize0
+  (U8)TEST_VID, (U8)(TEST_VID >> 8),
+  (U8)TEST_PID, (U8)(TEST_PID >> 8),
+  0x00, 0x01,                                 // bcdDevice
+  1, 2, 3,                                    // iManufacturer, iProduct, iSerialNumber
+  1                                           // bNumConfigurations
+};
+
+static const U8 _abConfigDesc1[CONFIG1_SIZE] = {
+  9, USB_CONFIGURATION_DESCRIPTOR_TYPE, (U8)CONFIG1_SIZE, 0, 1, 1, 0, 0x80, 50,
+  9, USB_INTERFACE_DESCRIPTOR_TYPE, 0, 0, 2, 0xFF, 0, 0, 0,
+  7, USB_ENDPOINT_DESCRIPTOR_TYPE, 0x81, USB_EP_TYPE_BULK, 0x40, 0, 0,
+  7, USB_ENDPOINT_DESCRIPTOR_TYPE, 0x02, USB_EP_TYPE_BULK, 0x40, 0, 0
+};
+
+static const U8 _abConfigDesc2[CONFIG2_SIZE] = {
+  9, USB_CONFIGURATION_DESCRIPTOR_TYPE, (U8)CONFIG2_SIZE, 0, 2, 1, 0, 0x80, 50,
+  9, USB_INTERFACE_DESCRIPTOR_TYPE, 0, 0, 2, 0xFF, 0, 0, 0,
+  7, USB_ENDPOINT_DESCRIPTOR_TYPE, 0x81, USB_EP_TYPE_BULK, 0x40, 0, 0,
+  7, USB_ENDPOINT_DESCRIPTOR_TYPE, 0x02, USB_EP_TYPE_BULK, 0x40, 0, 0,
+  9, USB_INTERFACE_DESCRIPTOR_TYPE, 1, 0, 2, 0xFF, 0, 0, 0,
+  7, USB_ENDPOINT_DESCRIPTOR_TYPE, 0x83, USB_EP_TYPE_BULK, 0x40, 0, 0,
+  7, USB_ENDPOINT_DESCRIPTOR_TYPE, 0x04, USB_EP_TYPE_BULK, 0x40, 0, 0
+};
+
+/*********************************************************************
+*
+*       Static data
+*
+**********************************************************************
+*/
+static U32                      _aPool[POOL_SIZE / sizeof(U32)];
+static TEST_DEVICE              _aDevice[NUM_DEVICES];
+static PNP_LIST                 _PnP;
+
+/*********************************************************************
+*
+*       Static code
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _OnData
+*
+*  Function description
+*    Bulk endpoints of the test device. No data is ever transferred.
+*/
+static USBH_STATUS _OnData(USBH_VHC_DEVICE * pDev, U8 EndpointAddress, U8 * pData, U32 * pNumBytes) {
+  (void)pDev;
+  (void)EndpointAddress;
+  (void)pData;
+  (void)pNumBytes;
+  return USBH_STATUS_PENDING;
+}
+
+static const USBH_VHC_DEVICE_API _DeviceAPI = {
+  NULL,
+  _OnData,
+  NULL,
+  NULL
+};
+
+/*********************************************************************
+*
+*       _InitDevice
+*
+*  Function description
+*    Sets up a vendor specific test device with the given serial number.
+*/
+static USBH_VHC_DEVICE * _InitDevice(TEST_DEVICE * pTestDev, unsigned SerialNo, const U8 * pConfigDesc) {
+  memset(pTestDev, 0, sizeof(*pTestDev));
+  (void)snprintf(pTestDev->acSerial, sizeof(pTestDev->acSerial), "%06u", SerialNo);
+  pTestDev->apString[0]    = "SEGGER";
+  pTestDev->apString[1]    = "Enumeration test device";
+  pTestDev->apString[2]    = pTestDev->acSerial;
+  pTestDev->Dev.pAPI        = &_DeviceAPI;
+  pTestDev->Dev.pDeviceDesc = _abDeviceDesc;
+  pTestDev->Dev.pConfigDesc = pConfigDesc;
+  pTestDev->Dev.papString   = pTestDev->apString;
+  pTestDev->Dev.NumStrings  = 3;
+  pTestDev->Dev.Speed       = USBH_FULL_SPEED;
+  return &pTestDev->Dev;
+}
+
+/*********************************************************************
+*
+*       _cbOnPnP
+*/
+static void _cbOnPnP(void * pContext, USBH_PNP_EVENT Event, USBH_INTERFACE_ID InterfaceId) {
+  PNP_LIST * pList;
+
+  pList = (PNP_LIST *)pContext;
+  if (Event == USBH_ADD_DEVICE) {
+    if (pList->NumAdded < MAX_INTERFACES) {
+      pList->aInterfaceId[pList->NumAdded] = InterfaceId;
+    }
+    pList->NumAdded++;
+  } else {
+    pList->NumRemoved++;
+  }
+}
+
+/*********************************************************************
+*
+*       _IsNumAdded
+*/
+static int _IsNumAdded(void * pContext) {
+  return _PnP.NumAdded >= *(U32 *)pContext;
+}
+
+/*********************************************************************
+*
+*       _IsNumRemoved
+*/
+static int _IsNumRemoved(void * pContext) {
+  return _PnP.NumRemoved >= *(U32 *)pContext;
+}
+
+/*********************************************************************
+*
+*       _GetEnumTime
+*
+*  Function description
+*    Reads the time to ready of the device the interface belongs to.
+*
+*  Return value
+*    == 0: O.K.
+*    != 0: Error
+*/
+static int _GetEnumTime(USBH_INTERFACE_ID InterfaceId, U32 * pEnumTime, U8 * pFromCache) {
+  USBH_INTERFACE_HANDLE hInterface;
+  USBH_STATUS           Status;
+
+  Status = USBH_OpenInterface(InterfaceId, 0, &hInterface);
+  TEST_CHECK_EQ(Status, USBH_STATUS_SUCCESS);
+  if (Status != USBH_STATUS_SUCCESS) {
+    return 1;
+  }
+  Status = USBH_GetEnumTime(hInterface, pEnumTime, pFromCache);
+  TEST_CHECK_EQ(Status, USBH_STATUS_SUCCESS);
+  USBH_CloseInterface(hInterface);
+  return (Status == USBH_STATUS_SUCCESS) ? 0 : 1;
+}
+
+/*********************************************************************
+*
+*       _WaitRemoved
+*
+*  Function description
+*    Waits until all interfaces added so far are removed again.
+*/
+static void _WaitRemoved(void) {
+  U32 NumAdded;
+
+  NumAdded = _PnP.NumAdded;
+  TEST_CHECK_EQ(SIM_WaitFor(_IsNumRemoved, &NumAdded, ENUM_TIMEOUT), 0);
+  memset(&_PnP, 0, sizeof(_PnP));
+}
+
+/*********************************************************************
+*
+*       _Enumerate
+*
+*  Function description
+*    Connects a test device to a root hub port, waits until all of its
+*    interfaces are added and disconnects it again.
+*
+*  Return value
+*    == 0: O.K., *pResult is valid.
+*    != 0: Error
+*/
+static int _Enumerate(USBH_VHC_DEVICE * pDev, ENUM_RESULT * pResult) {
+  USBH_VHC_STAT Stat;
+  U32           NumInterfaces;
+  int           r;
+
+  memset(pResult, 0, sizeof(*pResult));
+  NumInterfaces = pDev->pConfigDesc[4];
+  USBH_VHC_ResetStat();
+  TEST_CHECK_EQ(USBH_VHC_Connect(PORT_DEVICE, pDev), USBH_STATUS_SUCCESS);
+  r = SIM_WaitFor(_IsNumAdded, &NumInterfaces, ENUM_TIMEOUT);
+  TEST_CHECK_EQ(r, 0);
+  if (r == 0) {
+    //
+    // Wait a bit to catch interfaces from stale descriptors.
+    //
+    USBH_OS_Delay(50);
+    USBH_VHC_GetStat(&Stat);
+    pResult->NumTransfers  = Stat.NumTransfers;
+    pResult->NumBytesIn    = Stat.NumBytesIn;
+    pResult->NumInterfaces = (U8)_PnP.NumAdded;
+    r = _GetEnumTime(_PnP.aInterfaceId[0], &pResult->EnumTime, &pResult->FromCache);
+  }
+  TEST_CHECK_EQ(USBH_VHC_Disconnect(PORT_DEVICE), USBH_STATUS_SUCCESS);
+  _WaitRemoved();
+  return r;
+}
+
+/*********************************************************************
+*
+*       _TestCache
+*
+*  Function description
+*    Descriptor cache hit, miss and stale device on a root hub port.
+*/
+static void _TestCache(void) {
+  USBH_VHC_DEVICE * pDev;
+  ENUM_RESULT       Miss;
+  ENUM_RESULT       Hit;
+  ENUM_RESULT       Other;
+  ENUM_RESULT       Stale;
+  ENUM_RESULT       Hit2;
+
+  USBH_ClearEnumDescCache();
+  USBH_VHC_SetLatency(1);
+  pDev = _InitDevice(&_aDevice[0], 1, _abConfigDesc1);
+  //
+  // Unknown device: All descriptors are read.
+  //
+  if (_Enumerate(pDev, &Miss) != 0) {
+    return;
+  }
+  TEST_CHECK_EQ(Miss.FromCache, 0);
+  TEST_CHECK_EQ(Miss.NumInterfaces, 1);
+  //
+  // Known device: The configuration descriptor is not read, only its header.
+  //
+  if (_Enumerate(pDev, &Hit) != 0) {
+    return;
+  }
+  TEST_CHECK_EQ(Hit.FromCache, 1);
+  TEST_CHECK_EQ(Hit.NumInterfaces, 1);
+  TEST_CHECK_EQ(Hit.NumTransfers + 1u, Miss.NumTransfers);
+  TEST_CHECK_EQ(Hit.NumBytesIn + CONFIG1_SIZE, Miss.NumBytesIn);
+  TEST_CHECK(Hit.EnumTime < Miss.EnumTime);
+  //
+  // Other serial number: Unknown device.
+  //
+  pDev = _InitDevice(&_aDevice[1], 2, _abConfigDesc1);
+  if (_Enumerate(pDev, &Other) != 0) {
+    return;
+  }
+  TEST_CHECK_EQ(Other.FromCache, 0);
+  TEST_CHECK_EQ(Other.NumTransfers, Miss.NumTransfers);
+  //
+  // Same device descriptor and serial number as the first device,
+  // but another configuration (e.g. after a firmware update).
+  // The cached descriptor must not be used and is replaced.
+  //
+  pDev = _InitDevice(&_aDevice[0], 1, _abConfigDesc2);
+  if (_Enumerate(pDev, &Stale) != 0) {
+    return;
+  }
+  TEST_CHECK_EQ(Stale.FromCache, 0);
+  TEST_CHECK_EQ(Stale.NumInterfaces, 2);
+  TEST_CHECK_EQ(Stale.NumBytesIn, Miss.NumBytesIn + CONFIG2_SIZE - CONFIG1_SIZE);
+  if (_Enumerate(pDev, &Hit2) != 0) {
+    return;
+  }
+  TEST_CHECK_EQ(Hit2.FromCache, 1);
+  TEST_CHECK_EQ(Hit2.NumInterfaces, 2);
+  //
+  // Flushed cache: Unknown device again.
+  //
+  USBH_ClearEnumDescCache();
+  if (_Enumerate(pDev, &Stale) != 0) {
+    return;
+  }
+  TEST_CHECK_EQ(Stale.FromCache, 0);
+  printf("Root hub, 1 ms latency:    miss %u ms / %u transfers, hit %u ms / %u transfers\n",
+         (unsigned)Miss.EnumTime, (unsigned)Miss.NumTransfers, (unsigned)Hit.EnumTime, (unsigned)Hit.NumTransfers);
+  USBH_VHC_SetLatency(0);
+}
+
+/*********************************************************************
+*
+*       _ConnectToHub
+*
+*  Function description
+*    Connects NumDevices test devices to the hub at the same time and
+*    returns the time to ready of the slowest one.
+*/
+static U32 _ConnectToHub(USBH_VHC_DEVICE * pHub, unsigned NumDevices, U8 * pFromCache) {
+  USBH_INTERFACE_ID InterfaceId;
+  U32               NumAdded;
+  U32               EnumTime;
+  U32               MaxTime;
+  U8                FromCache;
+  unsigned          i;
+
+  for (i = 0; i < NumDevices; i++) {
+    TEST_CHECK_EQ(USBH_VHC_HUB_Connect(pHub, i + 1u, &_aDevice[i].Dev), USBH_STATUS_SUCCESS);
+  }
+  NumAdded = NumDevices;
+  TEST_CHECK_EQ(SIM_WaitFor(_IsNumAdded, &NumAdded, ENUM_TIMEOUT), 0);
+  MaxTime     = 0;
+  *pFromCache = 1;
+  for (i = 0; i < NumDevices && i < _PnP.NumAdded; i++) {
+    InterfaceId = _PnP.aInterfaceId[i];
+    if (_GetEnumTime(InterfaceId, &EnumTime, &FromCache) == 0) {
+      printf("  Device %u behind hub:     ready after %u ms%s\n", i, (unsigned)EnumTime, FromCache != 0u ? " (cached)" : "");
+      MaxTime     = SEGGER_MAX(MaxTime, EnumTime);
+      *pFromCache = (U8)(*pFromCache & FromCache);
+    }
+  }
+  for (i = 0; i < NumDevices; i++) {
+    TEST_CHECK_EQ(USBH_VHC_HUB_Disconnect(pHub, i + 1u), USBH_STATUS_SUCCESS);
+  }
+  _WaitRemoved();
+  return MaxTime;
+}
+
+/*********************************************************************
+*
+*       _TestHub
+*
+*  Function description
+*    Time to ready of devices behind an external hub. The power good
+*    waits of ports connected at the same time overlap, only the
+*    port resets and enumerations run one after another.
+*/
+static void _TestHub(void) {
+  USBH_VHC_DEVICE * pHub;
+  U32               TimeOne;
+  U32               TimeOneCached;
+  U32               TimeAll;
+  U32               TimeAllCached;
+  U32               Limit;
+  U8                FromCache;
+  unsigned          i;
+
+  USBH_ClearEnumDescCache();
+  USBH_VHC_SetLatency(1);
+  for (i = 0; i < NUM_DEVICES; i++) {
+    (void)_InitDevice(&_aDevice[i], 100u + i, _abConfigDesc1);
+  }
+  pHub = USBH_VHC_CreateHub(NUM_DEVICES);
+  TEST_CHECK(pHub != NULL);
+  if (pHub == NULL) {
+    return;
+  }
+  TEST_CHECK_EQ(USBH_VHC_Connect(PORT_HUB, pHub), USBH_STATUS_SUCCESS);
+  USBH_OS_Delay(1000);                        // Hub enumerated.
+  TEST_CHECK_EQ(USBH_GetNumDevicesConnected(0), 1u);
+  //
+  // One device, unknown and known.
+  //
+  TimeOne = _ConnectToHub(pHub, 1, &FromCache);
+  TEST_CHECK_EQ(FromCache, 0);
+  TimeOneCached = _ConnectToHub(pHub, 1, &FromCache);
+  TEST_CHECK_EQ(FromCache, 1);
+  TEST_CHECK(TimeOneCached < TimeOne);
+  TEST_CHECK(TimeOne >= POWER_GOOD_TIME);
+  //
+  // All devices at the same time. Enumerated one after another,
+  // the last device would be ready after NUM_DEVICES * TimeOne.
+  // With the power good waits overlapping it is ready after one
+  // power good time plus NUM_DEVICES resets and enumerations.
+  //
+  TimeAll = _ConnectToHub(pHub, NUM_DEVICES, &FromCache);
+  Limit   = POWER_GOOD_TIME + NUM_DEVICES * (TimeOne - POWER_GOOD_TIME) + TIME_TOLERANCE;
+  TEST_CHECK(TimeAll <= Limit);
+  TEST_CHECK(TimeAll < NUM_DEVICES * TimeOne);
+  TimeAllCached = _ConnectToHub(pHub, NUM_DEVICES, &FromCache);
+  TEST_CHECK_EQ(FromCache, 1);
+  TEST_CHECK(TimeAllCached <= TimeAll);
+  printf("Hub, 1 ms latency:         1 device %u ms (cached %u ms), %u devices %u ms (cached %u ms, serial %u ms)\n",
+         (unsigned)TimeOne, (unsigned)TimeOneCached, NUM_DEVICES, (unsigned)TimeAll, (unsigned)TimeAllCached, (unsigned)(NUM_DEVICES * TimeOne));
+  TEST_CHECK_EQ(USBH_VHC_Disconnect(PORT_HUB), USBH_STATUS_SUCCESS);
+  USBH_OS_Delay(200);
+  TEST_CHECK_EQ(USBH_GetNumDevicesConnected(0), 0u);
+  USBH_VHC_DeleteDevice(pHub);
+  USBH_VHC_SetLatency(0);
+}
+
+/*********************************************************************
+*
+*       Public code
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       USBH_X_Config
+*/
+void USBH_X_Config(void) {
+  USBH_AssignMemory(_aPool, sizeof(_aPool));
+  USBH_ConfigSupportExternalHubs(1);
+  (void)USBH_VHC_Add(2);
+}
+
+/*********************************************************************
+*
+*       main
+*/
+int main(void) {
+  USBH_PNP_NOTIFICATION    PnP;
+  USBH_NOTIFICATION_HANDLE hPnP;
+  U32                      NumBytesUsed;
+
+  SIM_Init();
+  SIM_StartStack();
+  memset(&PnP, 0, sizeof(PnP));
+  PnP.pfPnpNotification       = _cbOnPnP;
+  PnP.pContext                = &_PnP;
+  PnP.InterfaceMask.Mask      = USBH_INFO_MASK_VID | USBH_INFO_MASK_PID;
+  PnP.InterfaceMask.VendorId  = TEST_VID;
+  PnP.InterfaceMask.ProductId = TEST_PID;
+  hPnP = USBH_RegisterPnPNotification(&PnP);
+  TEST_CHECK(hPnP != NULL);
+  NumBytesUsed = USBH_MEM_GetUsed(0);
+  _TestCache();
+  _TestHub();
+  USBH_ClearEnumDescCache();
+  TEST_CHECK_EQ(USBH_MEM_GetUsed(0), NumBytesUsed);
+  USBH_UnregisterPnPNotification(hPnP);
+  SIM_StopStack();
+  return TEST_Report("USBH_EnumCacheTest");
+}
+
+/*************************** End of file ****************************/
@@ -0,0 +1,867 @@
+/*********************************************************************
+*                                                                    *
+*       emUSB-Host * USB Host stack for embedded applications        *
+*                                                                    *
+**********************************************************************
+----------------------------------------------------------------------
+File        : USBH_FT232_RxTest.c
+Purpose     : Host test of the receive engine of the FT232 class driver.
+              The BULK class is replaced by a full-speed FT232 device
+              model that runs on a virtual millisecond clock. The model
+              receives a byte stream on its UART, stores it in a small
+              FIFO and sends packets with the two status bytes whenever
+              an IN transfer is queued: full packets as long as data is
+              available, a short packet when the latency timer expires.
+              Bytes that do not fit into the FIFO are dropped and reported
+              with the overrun bit of the line status. The clock advances
+              while the driver waits for an event, so the timing is
+              deterministic. The test checks the received data against
+              the stream and reports the throughput for several baud rates.
+-------------------------- END-OF-HEADER -----------------------------
+*/
+
+/*********************************************************************
+*
+*       #include Section
+*
+**********************************************************************
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "USBH_Int.h"
+#include "USBH_BULK.h"
+#include "USBH_FT232.h"
+#include "test_check.h"
+
+/*********************************************************************
+*
+*       Defines, configurable
+*
+**********************************************************************
+*/
+#define DEV_MAX_PACKET_SIZE     64u           // Full-speed device.
+#define DEV_FIFO_SIZE           256u          // FIFO of the device between UART and USB.
+#define DEV_LATENCY_MS          16u           // Default latency timer of the FT232.
+#define DEV_MODEM_STATUS        0x31u         // CTS, DSR and the reserved bit.
+#define DEV_LINE_STATUS         0x60u         // THRE and TEMT.
+#define BUS_PACKETS_PER_MS      19u           // Bulk packets of 64 bytes per frame on an otherwise idle bus.
+#define MAX_TRANSFER_SIZE       4096u
+#define RUN_TIME_MS             2000u
+#define READ_CHUNK_SIZE         4096u
+#define MAX_SIM_STEPS           1000000u
+
+/*********************************************************************
+*
+*       Defines, fixed
+*
+**********************************************************************
+*/
+#define FT232_HEADER_SIZE       2u
+#define FT232_PACKET_PAYLOAD    (DEV_MAX_PACKET_SIZE - FT232_HEADER_SIZE)
+#define FT232_LSR_OE            0x02u
+#define FT232_REQUEST_RESET     0x00u
+#define DEV_BULK_HANDLE         0x1234u
+#define EP_IN                   0x81u
+#define EP_OUT                  0x02u
+
+/*********************************************************************
+*
+*       Types
+*
+**********************************************************************
+*/
+struct _USBH_OS_EVENT_OBJ {
+  int IsSet;
+};
+
+typedef struct {
+  //
+  // UART side.
+  //
+  U32                          BytesPerSecond;
+  U32                          Acc;                   // Fractional bytes of the UART, in 1/1000 bytes.
+  U32                          NumGenerated;          // Index of the next byte of the stream.
+  U32                          NumDropped;
+  U8                           aFifo[DEV_FIFO_SIZE];
+  U32                          FifoRdPos;
+  U32                          FifoNumBytes;
+  U8                           LineStatus;
+  //
+  // USB side.
+  //
+  USBH_TIME                    LastPacketTime;
+  USBH_BULK_ON_COMPLETE_FUNC * pfOnComplete;
+  USBH_BULK_RW_CONTEXT       * pRWContext;
+  U8                         * pBuffer;
+  U32                          BufferSize;
+  U32                          NumBytesInTransfer;
+  U32                          NumBytesPayloadInTransfer;
+  U8                           IsPending;
+  U8                           CancelRequested;
+  USBH_STATUS                  InjectError;
+  U32                          NumReadAsync;
+  U32                          NumBusy;
+} DEVICE;
+
+/*********************************************************************
+*
+*       Static data
+*
+**********************************************************************
+*/
+static USBH_TIME                _Time;
+static DEVICE                   _Dev;
+static USBH_NOTIFICATION_FUNC * _pfOnAddRemove;
+static void                   * _pAddRemoveContext;
+static unsigned                 _aLockCnt[USBH_MUTEX_COUNT];
+static U32                      _NumLockErrors;
+static U32                      _NumWaits;
+static U32                      _AppIndex;              // Index of the next byte the application expects.
+static U32                      _NumMismatches;
+static U32                      _GapStart;              // Bytes purged from the device, skipped by the check.
+static U32                      _GapEnd;
+static U8                       _aReadBuffer[READ_CHUNK_SIZE];
+
+/*********************************************************************
+*
+*       Static code
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _GetStreamByte
+*
+*  Function description
+*    Returns the byte of the UART stream with the given index.
+*    The pattern repeats only every 64K bytes, so a lost or a
+*    duplicated packet is detected.
+*/
+static U8 _GetStreamByte(U32 Index) {
+  return (U8)(Index ^ (Index >> 8));
+}
+
+/*********************************************************************
+*
+*       _Complete
+*
+*  Function description
+*    Completes the pending IN transfer. The endpoint is free again
+*    when the completion routine is called, like in the BULK class.
+*/
+static void _Complete(USBH_STATUS Status) {
+  USBH_BULK_RW_CONTEXT * pRWContext;
+
+  pRWContext                      = _Dev.pRWContext;
+  pRWContext->Status              = Status;
+  pRWContext->NumBytesTransferred = _Dev.NumBytesInTransfer;
+  pRWContext->pUserBuffer         = _Dev.pBuffer;
+  pRWContext->UserBufferSize      = _Dev.BufferSize;
+  pRWContext->Terminated          = 1;
+  _Dev.IsPending                  = 0;
+  _Dev.CancelRequested            = 0;
+  _Dev.NumBytesInTransfer         = 0;
+  _Dev.NumBytesPayloadInTransfer  = 0;
+  _Dev.pfOnComplete(pRWContext);
+}
+
+/*********************************************************************
+*
+*       _SendPacket
+*
+*  Function description
+*    Adds one packet with the status bytes and up to NumBytes
+*    bytes of the FIFO to the pending IN transfer.
+*/
+static void _SendPacket(U32 NumBytes) {
+  U8 * p;
+
+  p    = _Dev.pBuffer + _Dev.NumBytesInTransfer;
+  p[0] = DEV_MODEM_STATUS;
+  p[1] = _Dev.LineStatus;
+  _Dev.LineStatus = DEV_LINE_STATUS;                      // Error bits are reported once.
+  p += FT232_HEADER_SIZE;
+  _Dev.NumBytesInTransfer        += FT232_HEADER_SIZE + NumBytes;
+  _Dev.NumBytesPayloadInTransfer += NumBytes;
+  _Dev.FifoNumBytes              -= NumBytes;
+  while (NumBytes-- != 0u) {
+    *p++ = _Dev.aFifo[_Dev.FifoRdPos];
+    _Dev.FifoRdPos = (_Dev.FifoRdPos + 1u) % DEV_FIFO_SIZE;
+  }
+  _Dev.LastPacketTime = _Time;
+}
+
+/*********************************************************************
+*
+*       _ReceiveUART
+*
+*  Function description
+*    Stores the bytes the UART receives during one packet slot
+*    in the FIFO of the device.
+*/
+static void _ReceiveUART(void) {
+  U32 NumBytes;
+  U32 WrPos;
+
+  _Dev.Acc += _Dev.BytesPerSecond;
+  NumBytes  = _Dev.Acc / (1000u * BUS_PACKETS_PER_MS);
+  _Dev.Acc %= 1000u * BUS_PACKETS_PER_MS;
+  while (NumBytes-- != 0u) {
+    if (_Dev.FifoNumBytes < DEV_FIFO_SIZE) {
+      WrPos = (_Dev.FifoRdPos + _Dev.FifoNumBytes) % DEV_FIFO_SIZE;
+      _Dev.aFifo[WrPos] = _GetStreamByte(_Dev.NumGenerated);
+      _Dev.FifoNumBytes++;
+    } else {
+      _Dev.NumDropped++;
+      _Dev.LineStatus |= FT232_LSR_OE;
+    }
+    _Dev.NumGenerated++;
+  }
+}
+
+/*********************************************************************
+*
+*       _ServeSlot
+*
+*  Function description
+*    Sends at most one packet to the pending IN transfer.
+*    The device NAKs while no transfer is queued.
+*/
+static void _ServeSlot(void) {
+  USBH_STATUS Status;
+
+  while (_Dev.IsPending != 0u) {
+    if (_Dev.CancelRequested != 0u) {
+      _Complete(USBH_STATUS_CANCELED);
+      continue;
+    }
+    if ((_Dev.InjectError != USBH_STATUS_SUCCESS) && (_Dev.NumBytesInTransfer == 0u)) {
+      Status           = _Dev.InjectError;
+      _Dev.InjectError = USBH_STATUS_SUCCESS;
+      _Complete(Status);
+      continue;
+    }
+    if (_Dev.FifoNumBytes >= FT232_PACKET_PAYLOAD) {
+      _SendPacket(FT232_PACKET_PAYLOAD);
+      if (_Dev.NumBytesInTransfer + DEV_MAX_PACKET_SIZE > _Dev.BufferSize) {
+        _Complete(USBH_STATUS_SUCCESS);
+      }
+    } else if (USBH_TimeDiff(_Time, _Dev.LastPacketTime) >= (I32)DEV_LATENCY_MS) {
+      _SendPacket(_Dev.FifoNumBytes);                   // Short packet, may contain the status bytes only.
+      _Complete(USBH_STATUS_SUCCESS);
+    } else {
+      // Nothing to send yet.
+    }
+    break;
+  }
+}
+
+/*********************************************************************
+*
+*       _SimStep
+*
+*  Function description
+*    Advances the virtual clock by one millisecond. The frame is
+*    divided into packet slots, in each slot the UART receives its
+*    share of the bytes and one packet can be sent.
+*/
+static void _SimStep(void) {
+  unsigned i;
+
+  _Time++;
+  for (i = 0; i < BUS_PACKETS_PER_MS; i++) {
+    _ReceiveUART();
+    _ServeSlot();
+  }
+}
+
+/*********************************************************************
+*
+*       _SetLineRate
+*/
+static void _SetLineRate(U32 Baudrate) {
+  _Dev.BytesPerSecond = Baudrate / 10u;                 // 8N1: 10 bits per byte.
+}
+
+/*********************************************************************
+*
+*       _CheckData
+*/
+static void _CheckData(const U8 * pData, U32 NumBytes) {
+  while (NumBytes-- != 0u) {
+    if (_AppIndex == _GapStart) {
+      _AppIndex = _GapEnd;
+    }
+    if (*pData++ != _GetStreamByte(_AppIndex)) {
+      _NumMismatches++;
+    }
+    _AppIndex++;
+  }
+}
+
+/*********************************************************************
+*
+*       _Resync
+*
+*  Function description
+*    Purges the device and the receive queue. Data already sent to a
+*    pending IN transfer is still received, then the stream continues
+*    with the next byte received by the UART.
+*/
+static void _Resync(USBH_FT232_HANDLE hDevice) {
+  USBH_STATUS Status;
+
+  _GapEnd   = _Dev.NumGenerated;
+  _GapStart = _GapEnd - _Dev.FifoNumBytes;
+  _AppIndex = _GapStart - _Dev.NumBytesPayloadInTransfer;
+  Status = USBH_FT232_Purge(hDevice, USBH_FT232_PURGE_RX | USBH_FT232_PURGE_TX);
+  TEST_CHECK_EQ(Status, USBH_STATUS_SUCCESS);
+}
+
+/*********************************************************************
+*
+*       _TestIdle
+*
+*  Function description
+*    Without data the device sends status packets only. A read times
+*    out and the modem status is taken from the packets.
+*/
+static void _TestIdle(USBH_FT232_HANDLE hDevice) {
+  USBH_FT232_RX_STATUS RxStatus;
+  USBH_STATUS          Status;
+  USBH_TIME            t0;
+  U32                  NumBytesRead;
+
+  _SetLineRate(0);
+  (void)USBH_FT232_SetTimeouts(hDevice, 100, 100);
+  t0     = _Time;
+  Status = USBH_FT232_Read(hDevice, _aReadBuffer, 16, &NumBytesRead);
+  TEST_CHECK_EQ(Status, USBH_STATUS_TIMEOUT);
+  TEST_CHECK_EQ(NumBytesRead, 0u);
+  TEST_CHECK(USBH_TimeDiff(_Time, t0) >= 100);
+  TEST_CHECK(USBH_TimeDiff(_Time, t0) <= 101);
+  Status = USBH_FT232_GetRxStatus(hDevice, &RxStatus);
+  TEST_CHECK_EQ(Status, USBH_STATUS_SUCCESS);
+  TEST_CHECK_EQ(RxStatus.ModemStatus, DEV_MODEM_STATUS | (DEV_LINE_STATUS << 8));
+  TEST_CHECK_EQ(RxStatus.LineErrors, 0u);
+  TEST_CHECK_EQ(RxStatus.NumBytesReceived, 0u);
+  TEST_CHECK(RxStatus.NumStatusOnly >= 100u / DEV_LATENCY_MS - 1u);
+  TEST_CHECK_EQ(RxStatus.NumStatusOnly, RxStatus.NumTransfers);
+  printf("Idle line: %lu status-only transfers in %lu ms, %lu waits of the reader\n",
+         (unsigned long)RxStatus.NumStatusOnly, (unsigned long)(U32)(_Time - t0), (unsigned long)_NumWaits);
+}
+
+/*********************************************************************
+*
+*       _TestThroughput
+*
+*  Function description
+*    Reads the stream for RUN_TIME_MS with a fast reader and checks
+*    that every byte arrives once and in order.
+*/
+static void _TestThroughput(USBH_FT232_HANDLE hDevice, U32 Baudrate) {
+  USBH_FT232_RX_STATUS RxStatus0;
+  USBH_FT232_RX_STATUS RxStatus;
+  USBH_STATUS          Status;
+  USBH_TIME            t0;
+  U32                  NumBytesRead;
+  U32                  NumBytesTotal;
+  U32                  NumDropped;
+  U32                  NumWaits;
+  U32                  NumReads;
+
+  _SetLineRate(Baudrate);
+  (void)USBH_FT232_SetTimeouts(hDevice, 50, 50);
+  (void)USBH_FT232_GetRxStatus(hDevice, &RxStatus0);      // Clear the line errors.
+  _Resync(hDevice);
+  NumDropped    = _Dev.NumDropped;
+  NumBytesTotal = 0;
+  NumReads      = 0;
+  NumWaits      = _NumWaits;
+  t0            = _Time;
+  while (USBH_TimeDiff(_Time, t0) < (I32)RUN_TIME_MS) {
+    Status = USBH_FT232_Read(hDevice, _aReadBuffer, sizeof(_aReadBuffer), &NumBytesRead);
+    TEST_CHECK((Status == USBH_STATUS_SUCCESS) || (Status == USBH_STATUS_TIMEOUT));
+    _CheckData(_aReadBuffer, NumBytesRead);
+    NumBytesTotal += NumBytesRead;
+    NumReads++;
+  }
+  (void)USBH_FT232_GetRxStatus(hDevice, &RxStatus);
+  TEST_CHECK_EQ(_NumMismatches, 0u);
+  TEST_CHECK_EQ(_Dev.NumDropped, NumDropped);
+  TEST_CHECK_EQ(RxStatus.LineErrors, 0u);
+  TEST_CHECK_EQ(_Dev.NumBusy, 0u);
+  //
+  // Everything except the data still on its way has been read.
+  //
+  TEST_CHECK(_AppIndex + _Dev.FifoNumBytes + _Dev.NumBytesPayloadInTransfer + DEV_FIFO_SIZE >= _Dev.NumGenerated);
+  printf("  %7lu baud: %7.1f kB/s of %7.1f kB/s line rate, %7lu bytes, %5lu transfers (%4lu status only), %5lu reads, %5lu waits\n",
+         (unsigned long)Baudrate,
+         (double)NumBytesTotal / (double)(U32)(_Time - t0),
+         (double)_Dev.BytesPerSecond / 1000.0,
+         (unsigned long)NumBytesTotal,
+         (unsigned long)(RxStatus.NumTransfers  - RxStatus0.NumTransfers),
+         (unsigned long)(RxStatus.NumStatusOnly - RxStatus0.NumStatusOnly),
+         (unsigned long)NumReads,
+         (unsigned long)(_NumWaits - NumWaits));
+}
+
+/*********************************************************************
+*
+*       _TestShortRead
+*/
+static void _TestShortRead(USBH_FT232_HANDLE hDevice) {
+  USBH_STATUS Status;
+  USBH_TIME   t0;
+  U32         NumBytesRead;
+
+  _SetLineRate(9600);
+  (void)USBH_FT232_SetTimeouts(hDevice, 1000, 1000);
+  (void)USBH_FT232_AllowShortRead(hDevice, 1);
+  _Resync(hDevice);
+  t0     = _Time;
+  Status = USBH_FT232_Read(hDevice, _aReadBuffer, sizeof(_aReadBuffer), &NumBytesRead);
+  TEST_CHECK_EQ(Status, USBH_STATUS_SUCCESS);
+  TEST_CHECK(NumBytesRead != 0u);
+  TEST_CHECK(NumBytesRead < sizeof(_aReadBuffer));
+  TEST_CHECK(USBH_TimeDiff(_Time, t0) <= (I32)(DEV_LATENCY_MS + 1u));   // Returns with the first short packet.
+  _CheckData(_aReadBuffer, NumBytesRead);
+  TEST_CHECK_EQ(_NumMismatches, 0u);
+  (void)USBH_FT232_AllowShortRead(hDevice, 0);
+}
+
+/*********************************************************************
+*
+*       _TestError
+*
+*  Function description
+*    A failed IN transfer stops the receive engine. The error is
+*    returned by the next read and the read after it restarts the
+*    engine without losing data.
+*/
+static void _TestError(USBH_FT232_HANDLE hDevice) {
+  USBH_STATUS Status;
+  U32         NumBytesRead;
+  U32         i;
+
+  _SetLineRate(115200);
+  (void)USBH_FT232_SetTimeouts(hDevice, 500, 500);
+  _Resync(hDevice);
+  _Dev.InjectError = USBH_STATUS_STALL;
+  Status = USBH_FT232_Read(hDevice, _aReadBuffer, 1000, &NumBytesRead);
+  if (Status == USBH_STATUS_SUCCESS) {
+    _CheckData(_aReadBuffer, NumBytesRead);               // Transfer with data completed before the error.
+    Status = USBH_FT232_Read(hDevice, _aReadBuffer, 1000, &NumBytesRead);
+  }
+  TEST_CHECK_EQ(Status, USBH_STATUS_STALL);
+  _CheckData(_aReadBuffer, NumBytesRead);
+  for (i = 0; i < 4u; i++) {
+    Status = USBH_FT232_Read(hDevice, _aReadBuffer, 1000, &NumBytesRead);
+    TEST_CHECK_EQ(Status, USBH_STATUS_SUCCESS);
+    TEST_CHECK_EQ(NumBytesRead, 1000u);
+    _CheckData(_aReadBuffer, NumBytesRead);
+  }
+  TEST_CHECK_EQ(_NumMismatches, 0u);
+}
+
+/*********************************************************************
+*
+*       _TestCloseReopen
+*
+*  Function description
+*    Closing the last handle cancels the pending transfer. The engine
+*    is started again by the first read after the device is reopened.
+*/
+static USBH_FT232_HANDLE _TestCloseReopen(USBH_FT232_HANDLE hDevice) {
+  USBH_STATUS Status;
+  U32         NumBytesRead;
+  U32         NumReadAsync;
+  unsigned    i;
+
+  _SetLineRate(115200);
+  TEST_CHECK_EQ(_Dev.IsPending, 1u);
+  Status = USBH_FT232_Close(hDevice);
+  TEST_CHECK_EQ(Status, USBH_STATUS_SUCCESS);
+  for (i = 0; i < 100u; i++) {
+    _SimStep();
+  }
+  TEST_CHECK_EQ(_Dev.IsPending, 0u);                      // Canceled and not restarted.
+  NumReadAsync = _Dev.NumReadAsync;
+  hDevice = USBH_FT232_Open(0);
+  TEST_CHECK(hDevice != USBH_FT232_INVALID_HANDLE);
+  (void)USBH_FT232_SetTimeouts(hDevice, 500, 500);
+  _Resync(hDevice);
+  Status = USBH_FT232_Read(hDevice, _aReadBuffer, 1000, &NumBytesRead);
+  TEST_CHECK_EQ(Status, USBH_STATUS_SUCCESS);
+  TEST_CHECK_EQ(NumBytesRead, 1000u);
+  TEST_CHECK(_Dev.NumReadAsync > NumReadAsync);
+  _CheckData(_aReadBuffer, NumBytesRead);
+  TEST_CHECK_EQ(_NumMismatches, 0u);
+  return hDevice;
+}
+
+/*********************************************************************
+*
+*       _TestSlowReader
+*
+*  Function description
+*    The application reads less than the device sends. The receive
+*    queue must never overflow: the engine stops queuing transfers,
+*    the device NAKs and finally drops bytes, which is reported
+*    as overrun. No byte may get lost on the host side.
+*/
+static void _TestSlowReader(USBH_FT232_HANDLE hDevice) {
+  USBH_FT232_RX_STATUS RxStatus;
+  USBH_STATUS          Status;
+  U32                  NumBytesRead;
+  U32                  NumBytesTotal;
+  U32                  NumBytesQueued;
+  U32                  Base;
+  U32                  NumDropped;
+  unsigned             i;
+
+  _SetLineRate(921600);
+  (void)USBH_FT232_SetTimeouts(hDevice, 100, 100);
+  (void)USBH_FT232_GetRxStatus(hDevice, &RxStatus);
+  _Resync(hDevice);
+  Base          = _AppIndex;                              // First byte to be read, may be in a pending transfer.
+  NumDropped    = _Dev.NumDropped;
+  NumBytesTotal = 0;
+  for (i = 0; i < 20u; i++) {
+    Status = USBH_FT232_Read(hDevice, _aReadBuffer, 512, &NumBytesRead);
+    TEST_CHECK_EQ(Status, USBH_STATUS_SUCCESS);
+    NumBytesTotal += NumBytesRead;
+    USBH_OS_Delay(50);
+    (void)USBH_FT232_GetQueueStatus(hDevice, &NumBytesQueued);
+    TEST_CHECK(NumBytesQueued <= USBH_FT232_RX_BUFFER_SIZE);
+  }
+  (void)USBH_FT232_GetRxStatus(hDevice, &RxStatus);
+  (void)USBH_FT232_GetQueueStatus(hDevice, &NumBytesQueued);
+  TEST_CHECK(RxStatus.NumThrottled != 0u);
+  TEST_CHECK((RxStatus.LineErrors & FT232_LSR_OE) != 0u);
+  TEST_CHECK(_Dev.NumDropped != NumDropped);
+  //
+  // Every byte received by the UART is read, queued, still in the device or dropped by the device.
+  //
+  TEST_CHECK_EQ(NumBytesTotal + NumBytesQueued + _Dev.FifoNumBytes + _Dev.NumBytesPayloadInTransfer + (_Dev.NumDropped - NumDropped),
+                _Dev.NumGenerated - Base - (_GapEnd - _GapStart));
+  printf("Slow reader: %lu bytes read, %lu queued, %lu dropped by the device, throttled %lu times\n",
+         (unsigned long)NumBytesTotal, (unsigned long)NumBytesQueued, (unsigned long)(_Dev.NumDropped - NumDropped),
+         (unsigned long)RxStatus.NumThrottled);
+}
+
+/*********************************************************************
+*
+*       Public code, BULK class replacement
+*
+**********************************************************************
+*/
+USBH_STATUS USBH_BULK_Init(const USBH_INTERFACE_MASK * pInterfaceMask) {
+  USBH_USE_PARA(pInterfaceMask);
+  return USBH_STATUS_SUCCESS;
+}
+
+void USBH_BULK_Exit(void) {
+}
+
+USBH_STATUS USBH_BULK_AddNotification(USBH_NOTIFICATION_HOOK * pHook, USBH_NOTIFICATION_FUNC * pfNotification, void * pContext, const USBH_INTERFACE_MASK * pInterfaceMask) {
+  USBH_USE_PARA(pHook);
+  USBH_USE_PARA(pInterfaceMask);
+  _pfOnAddRemove     = pfNotification;
+  _pAddRemoveContext = pContext;
+  return USBH_STATUS_SUCCESS;
+}
+
+USBH_STATUS USBH_BULK_RemoveNotification(const USBH_NOTIFICATION_HOOK * pHook) {
+  USBH_USE_PARA(pHook);
+  return USBH_STATUS_SUCCESS;
+}
+
+USBH_BULK_HANDLE USBH_BULK_Open(unsigned Index) {
+  USBH_USE_PARA(Index);
+  return DEV_BULK_HANDLE;
+}
+
+USBH_STATUS USBH_BULK_Close(USBH_BULK_HANDLE hDevice) {
+  USBH_USE_PARA(hDevice);
+  return USBH_STATUS_SUCCESS;
+}
+
+USBH_STATUS USBH_BULK_GetDeviceInfo(USBH_BULK_HANDLE hDevice, USBH_BULK_DEVICE_INFO * pDevInfo) {
+  USBH_USE_PARA(hDevice);
+  memset(pDevInfo, 0, sizeof(*pDevInfo));
+  pDevInfo->VendorId  = 0x0403;
+  pDevInfo->ProductId = 0x6001;
+  pDevInfo->Speed     = USBH_FULL_SPEED;
+  pDevInfo->NumEPs    = 2;
+  return USBH_STATUS_SUCCESS;
+}
+
+USBH_STATUS USBH_BULK_GetEndpointInfo(USBH_BULK_HANDLE hDevice, unsigned EPIndex, USBH_BULK_EP_INFO * pEPInfo) {
+  USBH_USE_PARA(hDevice);
+  pEPInfo->Addr          = (EPIndex == 0u) ? EP_IN : EP_OUT;
+  pEPInfo->Type          = USB_EP_TYPE_BULK;
+  pEPInfo->Direction     = (EPIndex == 0u) ? USB_IN_DIRECTION : USB_OUT_DIRECTION;
+  pEPInfo->MaxPacketSize = DEV_MAX_PACKET_SIZE;
+  return USBH_STATUS_SUCCESS;
+}
+
+USBH_INTERFACE_HANDLE USBH_BULK_GetInterfaceHandle(USBH_BULK_HANDLE hDevice) {
+  USBH_USE_PARA(hDevice);
+  return NULL;
+}
+
+USBH_STATUS USBH_BULK_GetMaxTransferSize(USBH_BULK_HANDLE hDevice, U8 EPAddr, U32 * pMaxTransferSize) {
+  USBH_USE_PARA(hDevice);
+  USBH_USE_PARA(EPAddr);
+  *pMaxTransferSize = MAX_TRANSFER_SIZE;
+  return USBH_STATUS_SUCCESS;
+}
+
+USBH_STATUS USBH_BULK_ReadAsync(USBH_BULK_HANDLE hDevice, U8 EPAddr, void * pBuffer, U32 BufferSize, USBH_BULK_ON_COMPLETE_FUNC * pfOnComplete, USBH_BULK_RW_CONTEXT * pRWContext) {
+  USBH_USE_PARA(hDevice);
+  if (EPAddr != EP_IN) {
+    return USBH_STATUS_INVALID_PARAM;
+  }
+  if (_Dev.IsPending != 0u) {
+    _Dev.NumBusy++;                                       // The BULK class allows one transfer per endpoint.
+    return USBH_STATUS_BUSY;
+  }
+  _Dev.pfOnComplete              = pfOnComplete;
+  _Dev.pRWContext                = pRWContext;
+  _Dev.pBuffer                   = (U8 *)pBuffer;
+  _Dev.BufferSize                = BufferSize;
+  _Dev.NumBytesInTransfer        = 0;
+  _Dev.NumBytesPayloadInTransfer = 0;
+  _Dev.IsPending                 = 1;
+  _Dev.NumReadAsync++;
+  return USBH_STATUS_PENDING;
+}
+
+USBH_STATUS USBH_BULK_Cancel(USBH_BULK_HANDLE hDevice, U8 EPAddr) {
+  USBH_USE_PARA(hDevice);
+  USBH_USE_PARA(EPAddr);
+  if (_Dev.IsPending != 0u) {
+    _Dev.CancelRequested = 1;                             // Completed with the next frame.
+  }
+  return USBH_STATUS_SUCCESS;
+}
+
+USBH_STATUS USBH_BULK_SetupRequest(USBH_BULK_HANDLE hDevice, U8 RequestType, U8 Request, U16 wValue, U16 wIndex, void * pData, U32 * pNumBytesData, U32 Timeout) {
+  USBH_USE_PARA(hDevice);
+  USBH_USE_PARA(RequestType);
+  USBH_USE_PARA(wIndex);
+  USBH_USE_PARA(pData);
+  USBH_USE_PARA(pNumBytesData);
+  USBH_USE_PARA(Timeout);
+  if ((Request == FT232_REQUEST_RESET) && ((wValue == 0u) || (wValue == USBH_FT232_PURGE_RX))) {
+    _Dev.NumDropped  += _Dev.FifoNumBytes;                // Purged bytes are accounted as dropped.
+    _Dev.FifoNumBytes = 0;
+    _Dev.LineStatus   = DEV_LINE_STATUS;
+  }
+  return USBH_STATUS_SUCCESS;
+}
+
+USBH_STATUS USBH_BULK_Write(USBH_BULK_HANDLE hDevice, U8 EPAddr, const U8 * pData, U32 NumBytes, U32 * pNumBytesWritten, U32 Timeout) {
+  USBH_USE_PARA(hDevice);
+  USBH_USE_PARA(EPAddr);
+  USBH_USE_PARA(pData);
+  USBH_USE_PARA(Timeout);
+  if (pNumBytesWritten != NULL) {
+    *pNumBytesWritten = NumBytes;
+  }
+  return USBH_STATUS_SUCCESS;
+}
+
+/*********************************************************************
+*
+*       Public code, stack environment
+*
+**********************************************************************
+*/
+void * USBH_TryMallocZeroed(U32 Size) {
+  return calloc(1, Size);
+}
+
+void USBH_Free(void * pMemBlock) {
+  free(pMemBlock);
+}
+
+USBH_STATUS USBH_GetInterfaceInfo(USBH_INTERFACE_ID InterfaceID, USBH_INTERFACE_INFO * pInterfaceInfo) {
+  USBH_USE_PARA(InterfaceID);
+  memset(pInterfaceInfo, 0, sizeof(*pInterfaceInfo));
+  return USBH_STATUS_SUCCESS;
+}
+
+USBH_STATUS USBH__AddNotification(USBH_NOTIFICATION_HOOK * pHook, USBH_NOTIFICATION_FUNC * pfNotification, void * pContext, USBH_NOTIFICATION_HOOK ** ppFirst, USBH_NOTIFICATION_HANDLE Handle) {
+  USBH_USE_PARA(Handle);
+  pHook->pfNotification = pfNotification;
+  pHook->pContext       = pContext;
+  pHook->pNext          = *ppFirst;
+  *ppFirst              = pHook;
+  return USBH_STATUS_SUCCESS;
+}
+
+USBH_STATUS USBH__RemoveNotification(const USBH_NOTIFICATION_HOOK * pHook, USBH_NOTIFICATION_HOOK ** ppFirst) {
+  USBH_USE_PARA(pHook);
+  *ppFirst = NULL;
+  return USBH_STATUS_SUCCESS;
+}
+
+int USBH_INST_POOL_Create(USBH_INST_POOL * pPool, U32 NumBytes) {
+  pPool->pBase = (U8 *)calloc(1, NumBytes);
+  pPool->Size  = NumBytes;
+  pPool->Used  = 0;
+  return (pPool->pBase == NULL) ? 1 : 0;
+}
+
+void * USBH_INST_POOL_Alloc(USBH_INST_POOL * pPool, U32 NumBytes) {
+  void * p;
+
+  NumBytes = USBH_INST_POOL_BLOCK_SIZE(NumBytes);
+  if (pPool->Size - pPool->Used < NumBytes) {
+    return NULL;
+  }
+  p            = pPool->pBase + pPool->Used;
+  pPool->Used += NumBytes;
+  return p;
+}
+
+void USBH_INST_POOL_Free(USBH_INST_POOL * pPool, void * p) {
+  USBH_USE_PARA(pPool);
+  USBH_USE_PARA(p);
+}
+
+void USBH_INST_POOL_Destroy(USBH_INST_POOL * pPool) {
+  free(pPool->pBase);
+  pPool->pBase = NULL;
+}
+
+void USBH_InitTimer(USBH_TIMER * pTimer, USBH_TIMER_FUNC * pfHandler, void * pContext) {
+  pTimer->pfHandler = pfHandler;
+  pTimer->pContext  = pContext;
+}
+
+void USBH_StartTimer(USBH_TIMER * pTimer, U32 ms) {
+  USBH_USE_PARA(pTimer);
+  USBH_USE_PARA(ms);
+}
+
+void USBH_ReleaseTimer(USBH_TIMER * pTimer) {
+  USBH_USE_PARA(pTimer);
+}
+
+/*********************************************************************
+*
+*       Public code, OS layer
+*
+*  Waiting advances the virtual clock, the device model runs
+*  in the context of the waiting task.
+*
+**********************************************************************
+*/
+USBH_TIME USBH_OS_GetTime32(void) {
+  return _Time;
+}
+
+void USBH_OS_Delay(unsigned ms) {
+  while (ms-- != 0u) {
+    _SimStep();
+  }
+}
+
+void USBH_OS_Lock(unsigned Idx) {
+  if (_aLockCnt[Idx] != 0u) {
+    _NumLockErrors++;
+  }
+  _aLockCnt[Idx]++;
+}
+
+void USBH_OS_Unlock(unsigned Idx) {
+  if (_aLockCnt[Idx] == 0u) {
+    _NumLockErrors++;
+    return;
+  }
+  _aLockCnt[Idx]--;
+}
+
+USBH_OS_EVENT_OBJ * USBH_OS_AllocEvent(void) {
+  return (USBH_OS_EVENT_OBJ *)calloc(1, sizeof(USBH_OS_EVENT_OBJ));
+}
+
+void USBH_OS_FreeEvent(USBH_OS_EVENT_OBJ * pEvent) {
+  free(pEvent);
+}
+
+void USBH_OS_SetEvent(USBH_OS_EVENT_OBJ * pEvent) {
+  pEvent->IsSet = 1;
+}
+
+void USBH_OS_ResetEvent(USBH_OS_EVENT_OBJ * pEvent) {
+  pEvent->IsSet = 0;
+}
+
+void USBH_OS_WaitEvent(USBH_OS_EVENT_OBJ * pEvent) {
+  U32 NumSteps;
+
+  if (_aLockCnt[USBH_MUTEX_FT232] != 0u) {
+    _NumLockErrors++;
+  }
+  _NumWaits++;
+  NumSteps = 0;
+  while ((pEvent->IsSet == 0) && (NumSteps++ < MAX_SIM_STEPS)) {
+    _SimStep();
+  }
+}
+
+int USBH_OS_WaitEventTimed(USBH_OS_EVENT_OBJ * pEvent, U32 milliSeconds) {
+  if (_aLockCnt[USBH_MUTEX_FT232] != 0u) {
+    _NumLockErrors++;
+  }
+  _NumWaits++;
+  while ((pEvent->IsSet == 0) && (milliSeconds-- != 0u)) {
+    _SimStep();
+  }
+  return (pEvent->IsSet != 0) ? USBH_OS_EVENT_SIGNALED : USBH_OS_EVENT_TIMEOUT;
+}
+
+/*********************************************************************
+*
+*       Public code, test
+*
+**********************************************************************
+*/
+int main(void) {
+  static const U32 _aBaudrate[] = { 9600, 115200, 921600, 3000000 };
+  USBH_FT232_HANDLE hDevice;
+  U8                r;
+  unsigned          i;
+
+  _Dev.LineStatus = DEV_LINE_STATUS;
+  r = USBH_FT232_Init();
+  TEST_CHECK_EQ(r, 1u);
+  TEST_CHECK(_pfOnAddRemove != NULL);
+  _pfOnAddRemove(_pAddRemoveContext, 0, USBH_DEVICE_EVENT_ADD);
+  hDevice = USBH_FT232_Open(0);
+  TEST_CHECK(hDevice != USBH_FT232_INVALID_HANDLE);
+  if (hDevice == USBH_FT232_INVALID_HANDLE) {
+    return TEST_Report("USBH_FT232_RxTest");
+  }
+  _TestIdle(hDevice);
+  printf("Fast reader, %u ms each:\n", RUN_TIME_MS);
+  for (i = 0; i < SEGGER_COUNTOF(_aBaudrate); i++) {
+    _TestThroughput(hDevice, _aBaudrate[i]);
+  }
+  _TestShortRead(hDevice);
+  _TestError(hDevice);
+  hDevice = _TestCloseReopen(hDevice);
+  _TestSlowReader(hDevice);
+  TEST_CHECK_EQ(_Dev.NumBusy, 0u);
+  TEST_CHECK_EQ(_NumLockErrors, 0u);
+  (void)USBH_FT232_Close(hDevice);
+  return TEST_Report("USBH_FT232_RxTest");
+}
+
+/*************************** End of file ****************************/
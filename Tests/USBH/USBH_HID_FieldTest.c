@@ -0,0 +1,984 @@
+/*********************************************************************
+*                                                                    *
+*       emUSB-Host * USB Host stack for embedded applications        *
+*                                                                    *
+**********************************************************************
+----------------------------------------------------------------------
+File        : USBH_HID_FieldTest.c
+Purpose     : Host fuzz test of the report descriptor compiler and
+              the field extractor of the HID class driver.
+              Report descriptors are generated at random, from a
+              grammar of plausible items, by mutating real descriptors
+              and from random bytes. Each descriptor is placed directly
+              in front of an inaccessible page, so that any read past
+              its end faults. The compiled table is checked against
+              the elements reported by the parser itself, every field
+              is extracted from a report that ends in front of an
+              inaccessible page and the value is compared with a bit
+              by bit reference. At the end the host time per field is
+              reported for the compiled extractor and for
+              USBH_HID__GetBits().
+-------------------------- END-OF-HEADER -----------------------------
+*/
+
+/*********************************************************************
+*
+*       #include Section
+*
+**********************************************************************
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "USBH_Int.h"
+#include "USBH_HID_Int.h"
+#include "test_check.h"
+
+/*********************************************************************
+*
+*       Defines, configurable
+*
+**********************************************************************
+*/
+#define NUM_DESCS               20000u
+#define MAX_DESC_SIZE           4096u
+#define MAX_ELEMENTS            0x10000u      // Upper limit of the elements reported by the parser, the compiler keeps at most 0xFFFF.
+#define MAX_EXTRACT_PER_DESC    64u           // Fields extracted per descriptor.
+#define MAX_REPORT_BYTES        8300u         // Field positions are limited to 16 bits.
+#define NUM_BENCH_REPORTS       200000u
+#define MAX_PRINT_ERRORS        10u
+
+/*********************************************************************
+*
+*       Defines, fixed
+*
+**********************************************************************
+*/
+//
+// Short item prefixes (tag and type) of the report descriptor.
+//
+#define ITEM_INPUT              0x80u
+#define ITEM_OUTPUT             0x90u
+#define ITEM_COLLECTION         0xA0u
+#define ITEM_FEATURE            0xB0u
+#define ITEM_END_COLLECTION     0xC0u
+#define ITEM_USAGE_PAGE         0x04u
+#define ITEM_LOGICAL_MIN        0x14u
+#define ITEM_LOGICAL_MAX        0x24u
+#define ITEM_REPORT_SIZE        0x74u
+#define ITEM_REPORT_ID          0x84u
+#define ITEM_REPORT_COUNT       0x94u
+#define ITEM_USAGE              0x08u
+#define ITEM_USAGE_MIN          0x18u
+#define ITEM_USAGE_MAX          0x28u
+#define ITEM_LONG               0xFEu
+
+/*********************************************************************
+*
+*       Types
+*
+**********************************************************************
+*/
+typedef struct {
+  U32 Usage;
+  U16 BitPos;
+  U8  NumBits;
+  U8  ReportId;
+  U8  Flags;
+} EXPECTED_FIELD;
+
+typedef struct {
+  EXPECTED_FIELD * paField;
+  U32              NumFields;
+} EXPECTED_DESC;
+
+typedef enum {
+  GenGrammar = 0,
+  GenMutate,
+  GenRandom,
+  GenNumKinds
+} GEN_KIND;
+
+/*********************************************************************
+*
+*       Static const data
+*
+**********************************************************************
+*/
+//
+// Boot mouse with wheel.
+//
+static const U8 _abMouse[] = {
+  0x05, 0x01, 0x09, 0x02, 0xA1, 0x01, 0x09, 0x01, 0xA1, 0x00,
+  0x05, 0x09, 0x19, 0x01, 0x29, 0x03, 0x15, 0x00, 0x25, 0x01,
+  0x95, 0x03, 0x75, 0x01, 0x81, 0x02, 0x95, 0x01, 0x75, 0x05,
+  0x81, 0x01, 0x05, 0x01, 0x09, 0x30, 0x09, 0x31, 0x09, 0x38,
+  0x15, 0x81, 0x25, 0x7F, 0x75, 0x08, 0x95, 0x03, 0x81, 0x06,
+  0xC0, 0xC0
+};
+
+//
+// Boot keyboard with LED output report.
+//
+static const U8 _abKeyboard[] = {
+  0x05, 0x01, 0x09, 0x06, 0xA1, 0x01, 0x05, 0x07, 0x19, 0xE0,
+  0x29, 0xE7, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x08,
+  0x81, 0x02, 0x95, 0x01, 0x75, 0x08, 0x81, 0x01, 0x95, 0x05,
+  0x75, 0x01, 0x05, 0x08, 0x19, 0x01, 0x29, 0x05, 0x91, 0x02,
+  0x95, 0x01, 0x75, 0x03, 0x91, 0x01, 0x95, 0x06, 0x75, 0x08,
+  0x15, 0x00, 0x25, 0x65, 0x05, 0x07, 0x19, 0x00, 0x29, 0x65,
+  0x81, 0x00, 0xC0
+};
+
+//
+// Gamepad with two report IDs: 12-bit axes, a hat switch, buttons,
+// a 32-bit counter at an odd bit position and a rumble output report.
+//
+static const U8 _abGamepad[] = {
+  0x05, 0x01, 0x09, 0x05, 0xA1, 0x01, 0x85, 0x01, 0x09, 0x30,
+  0x09, 0x31, 0x09, 0x32, 0x09, 0x35, 0x16, 0x01, 0xF8, 0x26,
+  0xFF, 0x07, 0x75, 0x0C, 0x95, 0x04, 0x81, 0x02, 0x09, 0x39,
+  0x15, 0x00, 0x25, 0x07, 0x75, 0x04, 0x95, 0x01, 0x81, 0x42,
+  0x05, 0x09, 0x19, 0x01, 0x29, 0x0D, 0x25, 0x01, 0x75, 0x01,
+  0x95, 0x0D, 0x81, 0x02, 0x75, 0x03, 0x95, 0x01, 0x81, 0x01,
+  0x85, 0x02, 0x06, 0x00, 0xFF, 0x09, 0x01, 0x75, 0x01, 0x95,
+  0x03, 0x81, 0x02, 0x09, 0x02, 0x27, 0xFF, 0xFF, 0xFF, 0x7F,
+  0x75, 0x20, 0x95, 0x01, 0x81, 0x02, 0x09, 0x03, 0x75, 0x05,
+  0x95, 0x01, 0x81, 0x02, 0x09, 0x04, 0x26, 0xFF, 0x00, 0x75,
+  0x08, 0x95, 0x02, 0x91, 0x02, 0xC0
+};
+
+static const U8 * const _apRealDesc[]   = { _abMouse, _abKeyboard, _abGamepad };
+static const unsigned   _aRealDescLen[] = { sizeof(_abMouse), sizeof(_abKeyboard), sizeof(_abGamepad) };
+
+/*********************************************************************
+*
+*       Static data
+*
+**********************************************************************
+*/
+static U32              _Rand = 0x2468ACE1u;
+static U8             * _pGuard;               // First byte of the inaccessible page.
+static U8               _abDesc[MAX_DESC_SIZE];
+static unsigned         _DescLen;
+static EXPECTED_FIELD * _paExpected;
+static EXPECTED_FIELD * _paSorted;
+static U8               _abReport[MAX_REPORT_BYTES + 8u];
+static U32              _NumUnexpected;        // Calls of stack functions the compiler must not use.
+static U32              _NumErrors;
+static U32              _NumFieldsTotal;
+static U32              _NumExtracted;
+static U32              _NumTruncated;         // Descriptors with more than 0xFFFF elements.
+static U32              _MaxFields;
+static U32              _aNumDescs[GenNumKinds];
+
+/*********************************************************************
+*
+*       Static code
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _GetTime_ns
+*/
+static U64 _GetTime_ns(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (U64)ts.tv_sec * 1000000000u + (U64)ts.tv_nsec;
+}
+
+/*********************************************************************
+*
+*       _GetRand
+*/
+static U32 _GetRand(void) {
+  _Rand = _Rand * 1103515245u + 12345u;
+  return _Rand >> 8;
+}
+
+/*********************************************************************
+*
+*       _Error
+*/
+static void _Error(const char * sText, unsigned Index, unsigned long v0, unsigned long v1) {
+  if (_NumErrors < MAX_PRINT_ERRORS) {
+    printf("Descriptor %u: %s (%lu, %lu)\n", Index, sText, v0, v1);
+  }
+  _NumErrors++;
+}
+
+/*********************************************************************
+*
+*       _AddItem
+*
+*  Function description
+*    Appends a short item. NumBytes is 0, 1, 2 or 4.
+*/
+static void _AddItem(unsigned Prefix, U32 Data, unsigned NumBytes) {
+  unsigned SizeCode;
+  unsigned i;
+
+  SizeCode = NumBytes == 4u ? 3u : NumBytes;
+  if (_DescLen + 1u + NumBytes > MAX_DESC_SIZE) {
+    return;
+  }
+  _abDesc[_DescLen++] = (U8)(Prefix | SizeCode);
+  for (i = 0; i < NumBytes; i++) {
+    _abDesc[_DescLen++] = (U8)(Data >> (8u * i));
+  }
+}
+
+/*********************************************************************
+*
+*       _GetDataSize
+*
+*  Function description
+*    Returns the smallest item data size for a value, sometimes a larger one.
+*/
+static unsigned _GetDataSize(U32 Data) {
+  if ((_GetRand() & 7u) == 0u) {
+    return 4u;
+  }
+  if (Data <= 0xFFu) {
+    return 1u;
+  }
+  if (Data <= 0xFFFFu) {
+    return 2u;
+  }
+  return 4u;
+}
+
+/*********************************************************************
+*
+*       _GetRandSize
+*
+*  Function description
+*    Returns a report size, mostly as used by real devices,
+*    sometimes out of the range the compiler supports.
+*/
+static U32 _GetRandSize(void) {
+  U32 r;
+
+  r = _GetRand() % 100u;
+  if (r < 30u) {
+    return 1u;
+  }
+  if (r < 55u) {
+    return 8u;
+  }
+  if (r < 70u) {
+    return 16u;
+  }
+  if (r < 95u) {
+    return 1u + _GetRand() % 32u;
+  }
+  if (r < 97u) {
+    return 0u;
+  }
+  return 33u + _GetRand() % 0x10000u;
+}
+
+/*********************************************************************
+*
+*       _GetRandCount
+*/
+static U32 _GetRandCount(void) {
+  U32 r;
+
+  r = _GetRand() % 100u;
+  if (r < 50u) {
+    return 1u;
+  }
+  if (r < 90u) {
+    return 1u + _GetRand() % 16u;
+  }
+  if (r < 97u) {
+    return _GetRand() % 512u;
+  }
+  return _GetRand() % 0x10000u;
+}
+
+/*********************************************************************
+*
+*       _GenGrammar
+*
+*  Function description
+*    Generates a descriptor from a random sequence of plausible items.
+*/
+static void _GenGrammar(void) {
+  unsigned NumItems;
+  unsigned i;
+  unsigned NumIds;
+  U32      Data;
+  U32      r;
+
+  _DescLen = 0;
+  NumItems = 1u + _GetRand() % ((_GetRand() & 15u) == 0u ? 2000u : 120u);
+  NumIds   = (_GetRand() & 1u) != 0u ? 1u + _GetRand() % 8u : 255u;
+  for (i = 0; i < NumItems; i++) {
+    r = _GetRand() % 100u;
+    if (r < 8u) {
+      Data = (_GetRand() & 3u) == 0u ? 0xFF00u + (_GetRand() & 0xFFu) : 1u + _GetRand() % 13u;
+      _AddItem(ITEM_USAGE_PAGE, Data, _GetDataSize(Data));
+    } else if (r < 22u) {
+      Data = _GetRand() & ((_GetRand() & 7u) == 0u ? 0xFFFFFFFFu : 0xFFu);
+      _AddItem(ITEM_USAGE, Data, _GetDataSize(Data));
+    } else if (r < 28u) {
+      Data = _GetRand() & 0xFFu;
+      _AddItem(ITEM_USAGE_MIN, Data, _GetDataSize(Data));
+      Data += _GetRand() & 0x3Fu;
+      _AddItem(ITEM_USAGE_MAX, Data, _GetDataSize(Data));
+    } else if (r < 34u) {
+      Data = (_GetRand() & 1u) != 0u ? 0u : (U32)-(I32)(_GetRand() % 2048u);
+      _AddItem(ITEM_LOGICAL_MIN, Data, 1u + (_GetRand() & 1u));
+      Data = _GetRand() % 4096u;
+      _AddItem(ITEM_LOGICAL_MAX, Data, _GetDataSize(Data));
+    } else if (r < 48u) {
+      Data = _GetRandSize();
+      _AddItem(ITEM_REPORT_SIZE, Data, _GetDataSize(Data));
+    } else if (r < 62u) {
+      Data = _GetRandCount();
+      _AddItem(ITEM_REPORT_COUNT, Data, _GetDataSize(Data));
+    } else if (r < 67u) {
+      Data = NumIds == 255u ? _GetRand() & 0xFFu : 1u + _GetRand() % NumIds;
+      _AddItem(ITEM_REPORT_ID, Data, (_GetRand() & 15u) == 0u ? 4u : 1u);
+    } else if (r < 84u) {
+      _AddItem(ITEM_INPUT, _GetRand() & ((_GetRand() & 3u) == 0u ? 0x1FFu : 0x06u), 1u);
+    } else if (r < 90u) {
+      _AddItem(ITEM_OUTPUT, _GetRand() & 0x07u, 1u);
+    } else if (r < 92u) {
+      _AddItem(ITEM_FEATURE, _GetRand() & 0x07u, 1u);
+    } else if (r < 95u) {
+      _AddItem(ITEM_COLLECTION, _GetRand() % 3u, 1u);
+    } else if (r < 97u) {
+      _AddItem(ITEM_END_COLLECTION, 0, 0);
+    } else if (r < 98u) {
+      //
+      // Long item, ignored by the parser.
+      //
+      Data = _GetRand() % 8u;
+      if (_DescLen + 3u + Data <= MAX_DESC_SIZE) {
+        _abDesc[_DescLen++] = (U8)ITEM_LONG;
+        _abDesc[_DescLen++] = (U8)Data;
+        _abDesc[_DescLen++] = (U8)_GetRand();
+        while (Data-- > 0u) {
+          _abDesc[_DescLen++] = (U8)_GetRand();
+        }
+      }
+    } else {
+      if (_DescLen < MAX_DESC_SIZE) {
+        _abDesc[_DescLen++] = (U8)_GetRand();
+      }
+    }
+  }
+  if ((_GetRand() & 3u) == 0u && _DescLen != 0u) {
+    _DescLen -= _GetRand() % SEGGER_MIN(_DescLen, 5u);   // Cut the last item.
+  }
+}
+
+/*********************************************************************
+*
+*       _GenMutate
+*
+*  Function description
+*    Generates a descriptor by mutating a real one.
+*/
+static void _GenMutate(void) {
+  unsigned Idx;
+  unsigned NumMutations;
+  unsigned Pos;
+
+  Idx      = _GetRand() % SEGGER_COUNTOF(_apRealDesc);
+  _DescLen = _aRealDescLen[Idx];
+  memcpy(_abDesc, _apRealDesc[Idx], _DescLen);
+  NumMutations = 1u + _GetRand() % 6u;
+  while (NumMutations-- > 0u) {
+    Pos = _GetRand() % _DescLen;
+    switch (_GetRand() % 4u) {
+    case 0:
+      _abDesc[Pos] ^= (U8)(1u << (_GetRand() & 7u));
+      break;
+    case 1:
+      _abDesc[Pos] = (U8)_GetRand();
+      break;
+    case 2:
+      _abDesc[Pos] = (_GetRand() & 1u) != 0u ? 0xFFu : 0x00u;
+      break;
+    default:
+      _DescLen = Pos + 1u;                                  // Truncate.
+      break;
+    }
+  }
+}
+
+/*********************************************************************
+*
+*       _GenRandom
+*/
+static void _GenRandom(void) {
+  unsigned i;
+
+  _DescLen = _GetRand() % 256u;
+  for (i = 0; i < _DescLen; i++) {
+    _abDesc[i] = (U8)_GetRand();
+  }
+}
+
+/*********************************************************************
+*
+*       _PlaceAtGuard
+*
+*  Function description
+*    Copies data so that it ends in front of the inaccessible page.
+*/
+static U8 * _PlaceAtGuard(const U8 * pData, unsigned NumBytes) {
+  U8 * p;
+
+  p = _pGuard - NumBytes;
+  memcpy(p, pData, NumBytes);
+  return p;
+}
+
+/*********************************************************************
+*
+*       _cbRecordField
+*
+*  Function description
+*    Parser callback of the reference model: Records the elements of a
+*    main item as specified for the compiled table.
+*/
+static void _cbRecordField(unsigned Flag, const HID_FIELD_INFO * pField) {
+  EXPECTED_DESC  * pDesc;
+  EXPECTED_FIELD * pExp;
+  U32              NumElements;
+  U32              BitPos;
+  U32              i;
+  U32              Usage;
+
+  pDesc = (EXPECTED_DESC *)pField->pContext;
+  if (pField->RptSize == 0u || pField->RptSize > 32u) {
+    return;                                                 // Not representable, skipped.
+  }
+  NumElements = SEGGER_MIN((U32)pField->RptCount, HID_REPORT_FIELD_MAX_ELEMENTS);
+  BitPos      = (Flag & 1u) != 0u ? pField->OutRptLen : pField->InRptLen;
+  for (i = 0; i < NumElements && BitPos + pField->RptSize <= 0xFFFFu; i++) {
+    if (pDesc->NumFields < MAX_ELEMENTS) {
+      Usage = 0;
+      if (pField->UsageMax != 0u) {
+        Usage = ((Flag & 2u) != 0u) ? SEGGER_MIN(pField->UsageMin + i, pField->UsageMax) : pField->UsageMin;
+      } else if (pField->NumUsages != 0u) {
+        Usage = ((Flag & 2u) != 0u) ? pField->Usage[SEGGER_MIN(i, pField->NumUsages - 1u)] : pField->Usage[0];
+      }
+      pExp = &pDesc->paField[pDesc->NumFields];
+      pExp->Usage    = Usage;
+      pExp->BitPos   = (U16)BitPos;
+      pExp->NumBits  = (U8)pField->RptSize;
+      pExp->ReportId = pField->ReportId;
+      pExp->Flags    = (U8)((Flag & (HID_REPORT_FIELD_OUTPUT | HID_REPORT_FIELD_VARIABLE)) |
+                            (pField->Signed != 0u ? HID_REPORT_FIELD_SIGNED : 0u));
+    }
+    pDesc->NumFields++;
+    BitPos += pField->RptSize;
+  }
+}
+
+/*********************************************************************
+*
+*       _RefExtract
+*
+*  Function description
+*    Bit by bit reference of the field extraction.
+*/
+static U32 _RefExtract(const U8 * pData, unsigned BitPos, unsigned NumBits, int Signed) {
+  U32      v;
+  unsigned i;
+  unsigned Bit;
+
+  v = 0;
+  for (i = 0; i < NumBits; i++) {
+    Bit = BitPos + i;
+    if ((pData[Bit >> 3] >> (Bit & 7u)) & 1u) {
+      v |= 1uL << i;
+    }
+  }
+  if (Signed != 0 && NumBits < 32u && (v & (1uL << (NumBits - 1u))) != 0u) {
+    v |= 0xFFFFFFFFuL << NumBits;
+  }
+  return v;
+}
+
+/*********************************************************************
+*
+*       _CheckExtract
+*
+*  Function description
+*    Extracts a field from a random report which ends with the last
+*    byte covered by the field, compares with the reference.
+*/
+static int _CheckExtract(const HID_REPORT_FIELD * pField) {
+  unsigned ReportLen;
+  unsigned i;
+  U8     * pReport;
+  U32      v;
+  U32      vRef;
+
+  ReportLen = pField->ByteOff + pField->NumBytes;
+  for (i = 0; i < ReportLen; i++) {
+    _abReport[i] = (U8)_GetRand();
+  }
+  pReport = _PlaceAtGuard(_abReport, ReportLen);
+  v       = USBH_HID__ExtractField(pReport, pField);
+  vRef    = _RefExtract(pReport, pField->BitPos, pField->NumBits, (pField->Flags & HID_REPORT_FIELD_SIGNED) != 0u);
+  _NumExtracted++;
+  if (v != vRef) {
+    if (_NumErrors < MAX_PRINT_ERRORS) {
+      printf("Extract BitPos %u NumBits %u Signed %u: 0x%08lx, expected 0x%08lx\n",
+             pField->BitPos, pField->NumBits, (pField->Flags & HID_REPORT_FIELD_SIGNED) != 0u,
+             (unsigned long)v, (unsigned long)vRef);
+    }
+    _NumErrors++;
+    return 1;
+  }
+  return 0;
+}
+
+/*********************************************************************
+*
+*       _CheckLayout
+*/
+static void _CheckLayout(unsigned Index, const HID_REPORT_FIELD * pField) {
+  if (pField->NumBits == 0u || pField->NumBits > 32u) {
+    _Error("NumBits", Index, pField->NumBits, 0);
+  }
+  if (pField->NumBytes != (pField->Shift + pField->NumBits + 7u) >> 3 || pField->NumBytes > 5u) {
+    _Error("NumBytes", Index, pField->NumBytes, pField->NumBits);
+  }
+  if (((U32)pField->ByteOff << 3) + pField->Shift != pField->BitPos) {
+    _Error("ByteOff/Shift", Index, pField->ByteOff, pField->Shift);
+  }
+  if (pField->NumBits < 32u && pField->Mask != (1uL << pField->NumBits) - 1u) {
+    _Error("Mask", Index, pField->Mask, pField->NumBits);
+  }
+}
+
+/*********************************************************************
+*
+*       _CheckDesc
+*
+*  Function description
+*    Compiles the current descriptor and checks the table against the
+*    reference model.
+*/
+static void _CheckDesc(unsigned Index) {
+  USBH_HID_INST                    Inst;
+  EXPECTED_DESC                    Exp;
+  const HID_COMPILED_REPORT_DESC * pDesc;
+  const HID_REPORT_FIELD         * pField;
+  const HID_REPORT_FIELD         * pFound;
+  USBH_STATUS                      Status;
+  unsigned                         NumFields;
+  unsigned                         NumTotal;
+  unsigned                         Id;
+  unsigned                         i;
+  unsigned                         j;
+  U32                              NumExpected;
+  U32                              aNumPerId[256];
+  U32                              aFirst[256];
+
+  memset(&Inst, 0, sizeof(Inst));
+  Inst.pReportBufferDesc    = _PlaceAtGuard(_abDesc, _DescLen);
+  Inst.ReportDescriptorSize = (U16)_DescLen;
+  Inst.IgnoreReportParseWarning = 1;
+  //
+  // Reference model: elements as reported by the parser in descriptor order, stable sorted by report ID.
+  //
+  Exp.paField   = _paExpected;
+  Exp.NumFields = 0;
+  USBH_HID__ParseReportDesc(&Inst, _cbRecordField, &Exp);
+  NumExpected = SEGGER_MIN(Exp.NumFields, 0xFFFFu);
+  if (Exp.NumFields > 0xFFFFu) {
+    _NumTruncated++;
+  }
+  memset(aNumPerId, 0, sizeof(aNumPerId));
+  for (i = 0; i < NumExpected; i++) {
+    aNumPerId[_paExpected[i].ReportId]++;
+  }
+  NumTotal = 0;
+  for (Id = 0; Id < 256u; Id++) {
+    aFirst[Id] = NumTotal;
+    NumTotal  += aNumPerId[Id];
+  }
+  for (i = 0; i < NumExpected; i++) {
+    _paSorted[aFirst[_paExpected[i].ReportId]++] = _paExpected[i];
+  }
+  //
+  // Compile.
+  //
+  Status = USBH_HID__CompileReportDesc(&Inst);
+  if (Status != USBH_STATUS_SUCCESS || Inst.pCompiledDesc == NULL) {
+    _Error("Compile failed", Index, Status, 0);
+    return;
+  }
+  pDesc = Inst.pCompiledDesc;
+  _NumFieldsTotal += pDesc->NumFields;
+  _MaxFields = SEGGER_MAX(_MaxFields, pDesc->NumFields);
+  if (pDesc->NumFields != NumExpected) {
+    _Error("NumFields", Index, pDesc->NumFields, NumExpected);
+  } else {
+    for (i = 0; i < NumExpected; i++) {
+      pField = &pDesc->paField[i];
+      if (pField->BitPos   != _paSorted[i].BitPos  ||
+          pField->NumBits  != _paSorted[i].NumBits ||
+          pField->ReportId != _paSorted[i].ReportId ||
+          pField->Flags    != _paSorted[i].Flags   ||
+          pField->Usage    != _paSorted[i].Usage) {
+        _Error("Field differs from model", Index, i, pField->BitPos);
+        break;
+      }
+      _CheckLayout(Index, pField);
+    }
+  }
+  //
+  // Every report ID reaches exactly its own fields.
+  //
+  NumTotal = 0;
+  for (Id = 0; Id < 256u; Id++) {
+    pField = USBH_HID__GetReportFields(&Inst, Id, &NumFields);
+    if (NumFields != aNumPerId[Id]) {
+      _Error("Fields per report ID", Index, Id, NumFields);
+      continue;
+    }
+    for (j = 0; j < NumFields; j++) {
+      if (pField[j].ReportId != Id) {
+        _Error("Report ID of field", Index, Id, pField[j].ReportId);
+        break;
+      }
+    }
+    NumTotal += NumFields;
+  }
+  if (NumTotal != pDesc->NumFields) {
+    _Error("Ranges do not cover the table", Index, NumTotal, pDesc->NumFields);
+  }
+  //
+  // Extraction and lookup of a sample of the fields.
+  //
+  for (i = 0; i < SEGGER_MIN(pDesc->NumFields, MAX_EXTRACT_PER_DESC); i++) {
+    pField = &pDesc->paField[i == 0u ? 0u : _GetRand() % pDesc->NumFields];
+    (void)_CheckExtract(pField);
+    if ((pField->Flags & HID_REPORT_FIELD_OUTPUT) == 0u) {
+      pFound = USBH_HID__FindReportField(&Inst, pField->ReportId, pField->Usage, pField->BitPos);
+      if (pFound == NULL || pFound->Usage != pField->Usage || pFound->BitPos != pField->BitPos) {
+        _Error("FindReportField", Index, pField->ReportId, pField->BitPos);
+      }
+    }
+  }
+  //
+  // Compiling again returns the same table.
+  //
+  Status = USBH_HID__CompileReportDesc(&Inst);
+  if (Status != USBH_STATUS_SUCCESS || Inst.pCompiledDesc != pDesc) {
+    _Error("Recompile", Index, Status, 0);
+  }
+  USBH_Free(Inst.pCompiledDesc);
+}
+
+/*********************************************************************
+*
+*       _TestExtractAll
+*
+*  Function description
+*    Checks the extractor for all sizes and bit positions within a byte
+*    pair, signed and unsigned, with a report ending at the field.
+*/
+static void _TestExtractAll(void) {
+  HID_REPORT_FIELD Field;
+  unsigned         BitPos;
+  unsigned         NumBits;
+  unsigned         Signed;
+  unsigned         n;
+  U32              NumFailed;
+
+  NumFailed = 0;
+  for (BitPos = 0; BitPos < 40u; BitPos++) {
+    for (NumBits = 1; NumBits <= 32u; NumBits++) {
+      for (Signed = 0; Signed < 2u; Signed++) {
+        USBH_HID__InitReportField(&Field, BitPos, NumBits, Signed);
+        for (n = 0; n < 64u; n++) {
+          NumFailed += (U32)_CheckExtract(&Field);
+        }
+      }
+    }
+  }
+  TEST_CHECK_EQ(NumFailed, 0u);
+  //
+  // Sizes the compiler does not support yield an empty field.
+  //
+  USBH_HID__InitReportField(&Field, 3, 0, 0);
+  TEST_CHECK_EQ(Field.NumBytes, 0u);
+  TEST_CHECK_EQ(USBH_HID__ExtractField(_abReport, &Field), 0u);
+  USBH_HID__InitReportField(&Field, 3, 33, 1);
+  TEST_CHECK_EQ(Field.NumBytes, 0u);
+  TEST_CHECK_EQ(USBH_HID__ExtractField(_abReport, &Field), 0u);
+}
+
+/*********************************************************************
+*
+*       _TestAllReportIds
+*
+*  Function description
+*    Fields without report ID in front of 255 reports with IDs 1..255.
+*    Not a valid descriptor, but all 256 IDs must be reachable.
+*/
+static void _TestAllReportIds(void) {
+  unsigned NumFields;
+  unsigned Id;
+
+  _DescLen = 0;
+  _AddItem(ITEM_REPORT_SIZE,  8, 1);
+  _AddItem(ITEM_REPORT_COUNT, 1, 1);
+  _AddItem(ITEM_INPUT,        2, 1);
+  for (Id = 1; Id < 256u; Id++) {
+    _AddItem(ITEM_REPORT_ID, Id, 1);
+    _AddItem(ITEM_INPUT,     2, 1);
+  }
+  _CheckDesc(0xFFFFu);
+  {
+    USBH_HID_INST Inst;
+
+    memset(&Inst, 0, sizeof(Inst));
+    Inst.pReportBufferDesc        = _PlaceAtGuard(_abDesc, _DescLen);
+    Inst.ReportDescriptorSize     = (U16)_DescLen;
+    Inst.IgnoreReportParseWarning = 1;
+    TEST_CHECK_EQ(USBH_HID__CompileReportDesc(&Inst), USBH_STATUS_SUCCESS);
+    TEST_CHECK_EQ(Inst.pCompiledDesc->NumRanges, 256u);
+    for (Id = 0; Id < 256u; Id++) {
+      (void)USBH_HID__GetReportFields(&Inst, Id, &NumFields);
+      TEST_CHECK_EQ(NumFields, 1u);
+    }
+    USBH_Free(Inst.pCompiledDesc);
+  }
+}
+
+/*********************************************************************
+*
+*       _TestTruncation
+*
+*  Function description
+*    Two reports with interleaved items and more elements than the
+*    table holds. The first 0xFFFF elements in descriptor order are
+*    kept, each report in descriptor order.
+*/
+static void _TestTruncation(void) {
+  unsigned i;
+
+  _DescLen = 0;
+  _AddItem(ITEM_REPORT_SIZE,  1,    1);
+  _AddItem(ITEM_REPORT_COUNT, 0xFF, 1);
+  for (i = 0; i < 300u; i++) {
+    _AddItem(ITEM_REPORT_ID, 1u + (i & 1u), 1);
+    _AddItem(ITEM_INPUT,     2,             1);
+  }
+  _CheckDesc(0xFFFEu);
+  TEST_CHECK_EQ(_NumTruncated, 1u);
+}
+
+/*********************************************************************
+*
+*       _RunBench
+*
+*  Function description
+*    Host time per field for the input report of the gamepad,
+*    compiled extractor versus USBH_HID__GetBits().
+*/
+static void _RunBench(void) {
+  USBH_HID_INST            Inst;
+  const HID_REPORT_FIELD * paField;
+  unsigned                 NumFields;
+  unsigned                 i;
+  U32                      n;
+  U32                      Sum0;
+  U32                      Sum1;
+  U64                      t0;
+  U64                      t1;
+
+  memset(&Inst, 0, sizeof(Inst));
+  memcpy(_abDesc, _abGamepad, sizeof(_abGamepad));
+  Inst.pReportBufferDesc    = _abDesc;
+  Inst.ReportDescriptorSize = sizeof(_abGamepad);
+  TEST_CHECK_EQ(USBH_HID__CompileReportDesc(&Inst), USBH_STATUS_SUCCESS);
+  paField = USBH_HID__GetReportFields(&Inst, 1, &NumFields);
+  TEST_CHECK_EQ(NumFields, 4u + 1u + 13u);       // Axes, hat switch, buttons. The constant padding is not compiled.
+  for (i = 0; i < 64u; i++) {
+    _abReport[i] = (U8)_GetRand();
+  }
+  memcpy(_abDesc, _abReport, 64u);                  // Both loops start with the same report.
+  Sum0 = 0;
+  t0   = _GetTime_ns();
+  for (n = 0; n < NUM_BENCH_REPORTS; n++) {
+    _abReport[n & 7u] = (U8)n;
+    for (i = 0; i < NumFields; i++) {
+      Sum0 += USBH_HID__ExtractField(_abReport, &paField[i]);
+    }
+  }
+  t0   = _GetTime_ns() - t0;
+  memcpy(_abReport, _abDesc, 64u);
+  Sum1 = 0;
+  t1   = _GetTime_ns();
+  for (n = 0; n < NUM_BENCH_REPORTS; n++) {
+    _abReport[n & 7u] = (U8)n;
+    for (i = 0; i < NumFields; i++) {
+      if ((paField[i].Flags & HID_REPORT_FIELD_SIGNED) != 0u) {
+        Sum1 += (U32)USBH_HID__GetBitsSigned(_abReport, paField[i].BitPos, paField[i].NumBits);
+      } else {
+        Sum1 += USBH_HID__GetBits(_abReport, paField[i].BitPos, paField[i].NumBits);
+      }
+    }
+  }
+  t1 = _GetTime_ns() - t1;
+  TEST_CHECK_EQ(Sum0, Sum1);            // All fields of the report are supported by USBH_HID__GetBits().
+  printf("Gamepad input report, %u fields: %.2f ns per field compiled, %.2f ns per field USBH_HID__GetBits()\n",
+         NumFields,
+         (double)t0 / ((double)NUM_BENCH_REPORTS * NumFields),
+         (double)t1 / ((double)NUM_BENCH_REPORTS * NumFields));
+  USBH_Free(Inst.pCompiledDesc);
+}
+
+/*********************************************************************
+*
+*       Public code, stack environment
+*
+*  The compiler only uses the memory allocation functions,
+*  the other functions referenced by USBH_HID.c must not be called.
+*
+**********************************************************************
+*/
+void   USBH_Free           (void * pMemBlock)   { free(pMemBlock); }
+void * USBH_TryMallocZeroed(U32 Size)           { return calloc(1, Size); }
+
+void                     USBH_CloseInterface           (USBH_INTERFACE_HANDLE hInterface)                                                                 { USBH_USE_PARA(hInterface); _NumUnexpected++; }
+USBH_STATUS              USBH_GetDescriptorPtr         (USBH_INTERFACE_HANDLE hInterface, U8 AlternateSetting, U8 Type, const U8 ** ppDesc)               { USBH_USE_PARA(hInterface); USBH_USE_PARA(AlternateSetting); USBH_USE_PARA(Type); USBH_USE_PARA(ppDesc); _NumUnexpected++; return USBH_STATUS_ERROR; }
+USBH_STATUS              USBH_GetEndpointDescriptor    (USBH_INTERFACE_HANDLE hInterface, U8 AlternateSetting, const USBH_EP_MASK * pMask, U8 * pBuffer, unsigned * pBufferSize) { USBH_USE_PARA(hInterface); USBH_USE_PARA(AlternateSetting); USBH_USE_PARA(pMask); USBH_USE_PARA(pBuffer); USBH_USE_PARA(pBufferSize); _NumUnexpected++; return USBH_STATUS_ERROR; }
+USBH_STATUS              USBH_GetInterfaceDescriptorPtr(USBH_INTERFACE_HANDLE hInterface, U8 AlternateSetting, const U8 ** ppDesc, unsigned * pDescLen)  { USBH_USE_PARA(hInterface); USBH_USE_PARA(AlternateSetting); USBH_USE_PARA(ppDesc); USBH_USE_PARA(pDescLen); _NumUnexpected++; return USBH_STATUS_ERROR; }
+USBH_STATUS              USBH_GetInterfaceInfo         (USBH_INTERFACE_ID InterfaceID, USBH_INTERFACE_INFO * pInterfaceInfo)                              { USBH_USE_PARA(InterfaceID); USBH_USE_PARA(pInterfaceInfo); _NumUnexpected++; return USBH_STATUS_ERROR; }
+USBH_STATUS              USBH_GetMaxTransferSize       (USBH_INTERFACE_HANDLE hInterface, U8 Endpoint, U32 * pMaxTransferSize)                            { USBH_USE_PARA(hInterface); USBH_USE_PARA(Endpoint); USBH_USE_PARA(pMaxTransferSize); _NumUnexpected++; return USBH_STATUS_ERROR; }
+void                   * USBH_INST_POOL_Alloc          (USBH_INST_POOL * pPool, U32 NumBytes)                                                             { USBH_USE_PARA(pPool); USBH_USE_PARA(NumBytes); _NumUnexpected++; return NULL; }
+int                      USBH_INST_POOL_Create         (USBH_INST_POOL * pPool, U32 NumBytes)                                                             { USBH_USE_PARA(pPool); USBH_USE_PARA(NumBytes); _NumUnexpected++; return 1; }
+void                     USBH_INST_POOL_Destroy        (USBH_INST_POOL * pPool)                                                                           { USBH_USE_PARA(pPool); _NumUnexpected++; }
+void                     USBH_INST_POOL_Free           (USBH_INST_POOL * pPool, void * p)                                                                 { USBH_USE_PARA(pPool); USBH_USE_PARA(p); _NumUnexpected++; }
+void                     USBH_InitTimer                (USBH_TIMER * pTimer, USBH_TIMER_FUNC * pfHandler, void * pContext)                                { USBH_USE_PARA(pTimer); USBH_USE_PARA(pfHandler); USBH_USE_PARA(pContext); _NumUnexpected++; }
+void                     USBH_StartTimer               (USBH_TIMER * pTimer, U32 ms)                                                                      { USBH_USE_PARA(pTimer); USBH_USE_PARA(ms); _NumUnexpected++; }
+void                     USBH_ReleaseTimer             (USBH_TIMER * pTimer)                                                                              { USBH_USE_PARA(pTimer); _NumUnexpected++; }
+USBH_STATUS              USBH_OpenInterface            (USBH_INTERFACE_ID InterfaceID, U8 Exclusive, USBH_INTERFACE_HANDLE * pInterfaceHandle)            { USBH_USE_PARA(InterfaceID); USBH_USE_PARA(Exclusive); USBH_USE_PARA(pInterfaceHandle); _NumUnexpected++; return USBH_STATUS_ERROR; }
+USBH_NOTIFICATION_HANDLE USBH_RegisterPnPNotification  (const USBH_PNP_NOTIFICATION * pPnPNotification)                                                   { USBH_USE_PARA(pPnPNotification); _NumUnexpected++; return NULL; }
+void                     USBH_UnregisterPnPNotification(USBH_NOTIFICATION_HANDLE hNotification)                                                           { USBH_USE_PARA(hNotification); _NumUnexpected++; }
+USBH_STATUS              USBH_SubmitUrb                (USBH_INTERFACE_HANDLE hInterface, USBH_URB * pUrb)                                                { USBH_USE_PARA(hInterface); USBH_USE_PARA(pUrb); _NumUnexpected++; return USBH_STATUS_ERROR; }
+USBH_STATUS              USBH__AddNotification         (USBH_NOTIFICATION_HOOK * pHook, USBH_NOTIFICATION_FUNC * pfNotification, void * pContext, USBH_NOTIFICATION_HOOK ** ppFirst, USBH_NOTIFICATION_HANDLE Handle) { USBH_USE_PARA(pHook); USBH_USE_PARA(pfNotification); USBH_USE_PARA(pContext); USBH_USE_PARA(ppFirst); USBH_USE_PARA(Handle); _NumUnexpected++; return USBH_STATUS_ERROR; }
+USBH_STATUS              USBH__RemoveNotification      (const USBH_NOTIFICATION_HOOK * pHook, USBH_NOTIFICATION_HOOK ** ppFirst)                          { USBH_USE_PARA(pHook); USBH_USE_PARA(ppFirst); _NumUnexpected++; return USBH_STATUS_ERROR; }
+
+/*********************************************************************
+*
+*       Public code, OS layer
+*
+**********************************************************************
+*/
+USBH_TIME           USBH_OS_GetTime32     (void)                                            { _NumUnexpected++; return 0; }
+void                USBH_OS_Lock          (unsigned Idx)                                    { USBH_USE_PARA(Idx); _NumUnexpected++; }
+void                USBH_OS_Unlock        (unsigned Idx)                                    { USBH_USE_PARA(Idx); _NumUnexpected++; }
+USBH_OS_EVENT_OBJ * USBH_OS_AllocEvent    (void)                                            { _NumUnexpected++; return NULL; }
+void                USBH_OS_FreeEvent     (USBH_OS_EVENT_OBJ * pEvent)                      { USBH_USE_PARA(pEvent); _NumUnexpected++; }
+void                USBH_OS_SetEvent      (USBH_OS_EVENT_OBJ * pEvent)                      { USBH_USE_PARA(pEvent); _NumUnexpected++; }
+void                USBH_OS_ResetEvent    (USBH_OS_EVENT_OBJ * pEvent)                      { USBH_USE_PARA(pEvent); _NumUnexpected++; }
+void                USBH_OS_WaitEvent     (USBH_OS_EVENT_OBJ * pEvent)                      { USBH_USE_PARA(pEvent); _NumUnexpected++; }
+int                 USBH_OS_WaitEventTimed(USBH_OS_EVENT_OBJ * pEvent, U32 milliSeconds)    { USBH_USE_PARA(pEvent); USBH_USE_PARA(milliSeconds); _NumUnexpected++; return 1; }
+
+/*********************************************************************
+*
+*       Public code, test
+*
+**********************************************************************
+*/
+int main(void) {
+  long     PageSize;
+  size_t   GuardOff;
+  size_t   MapSize;
+  U8     * pMem;
+  unsigned i;
+  GEN_KIND Kind;
+  U64      t0;
+
+  //
+  // Room for the largest report, followed by an inaccessible page.
+  //
+  PageSize = sysconf(_SC_PAGESIZE);
+  GuardOff = ((MAX_REPORT_BYTES + (size_t)PageSize - 1u) / (size_t)PageSize) * (size_t)PageSize;
+  MapSize  = GuardOff + (size_t)PageSize;
+  pMem = (U8 *)mmap(NULL, MapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  TEST_CHECK(pMem != (U8 *)MAP_FAILED);
+  if (pMem == (U8 *)MAP_FAILED) {
+    return TEST_Report("USBH_HID_FieldTest");
+  }
+  _pGuard = pMem + GuardOff;
+  TEST_CHECK_EQ(mprotect(_pGuard, (size_t)PageSize, PROT_NONE), 0);
+  _paExpected = (EXPECTED_FIELD *)malloc(MAX_ELEMENTS * sizeof(EXPECTED_FIELD));
+  _paSorted   = (EXPECTED_FIELD *)malloc(MAX_ELEMENTS * sizeof(EXPECTED_FIELD));
+  TEST_CHECK(_paExpected != NULL && _paSorted != NULL);
+  if (_paExpected == NULL || _paSorted == NULL) {
+    return TEST_Report("USBH_HID_FieldTest");
+  }
+  //
+  // Extractor.
+  //
+  _TestExtractAll();
+  //
+  // Real descriptors.
+  //
+  for (i = 0; i < SEGGER_COUNTOF(_apRealDesc); i++) {
+    _DescLen = _aRealDescLen[i];
+    memcpy(_abDesc, _apRealDesc[i], _DescLen);
+    _CheckDesc(i);
+  }
+  TEST_CHECK_EQ(_NumErrors, 0u);
+  _TestAllReportIds();
+  _TestTruncation();
+  TEST_CHECK_EQ(_NumErrors, 0u);
+  //
+  // Fuzzing.
+  //
+  t0 = _GetTime_ns();
+  for (i = 0; i < NUM_DESCS; i++) {
+    Kind = (GEN_KIND)(_GetRand() % (U32)GenNumKinds);
+    switch (Kind) {
+    case GenGrammar:
+      _GenGrammar();
+      break;
+    case GenMutate:
+      _GenMutate();
+      break;
+    default:
+      _GenRandom();
+      break;
+    }
+    _aNumDescs[Kind]++;
+    _CheckDesc(i);
+  }
+  t0 = _GetTime_ns() - t0;
+  TEST_CHECK_EQ(_NumErrors, 0u);
+  TEST_CHECK_EQ(_NumUnexpected, 0u);
+  printf("Fuzzing: %u descriptors (%lu grammar, %lu mutated, %lu random), %lu fields, max. %lu per descriptor, %lu truncated, %lu extractions, %.1f ms\n",
+         NUM_DESCS, (unsigned long)_aNumDescs[GenGrammar], (unsigned long)_aNumDescs[GenMutate], (unsigned long)_aNumDescs[GenRandom],
+         (unsigned long)_NumFieldsTotal, (unsigned long)_MaxFields, (unsigned long)_NumTruncated,
+         (unsigned long)_NumExtracted, (double)t0 / 1e6);
+  _RunBench();
+  free(_paExpected);
+  free(_paSorted);
+  (void)munmap(pMem, MapSize);
+  return TEST_Report("USBH_HID_FieldTest");
+}
+
+/*************************** End of file ****************************/
@@ -0,0 +1,366 @@
+/*********************************************************************
+*                                                                    *
+*       emUSB-Host * USB Host stack for embedded applications        *
+*                                                                    *
+**********************************************************************
+----------------------------------------------------------------------
+File        : USBH_InstPoolTest.c
+Purpose     : Host test of the per-instance buffer pools of the class
+              drivers (USBH_INST_POOL):
+              * buffers given back in any order leave an empty pool,
+                which is reused without falling back to the heap,
+              * attach / detach cycles of an MSD, a CDC and an FT232
+                device behind a hub on the virtual host controller,
+                detached and re-attached in changing order. After
+                each cycle no pool is left and the heap usage is
+                back at its start value.
+-------------------------- END-OF-HEADER -----------------------------
+*/
+
+/*********************************************************************
+*
+*       #include Section
+*
+**********************************************************************
+*/
+#include <stdio.h>
+#include <string.h>
+#include "USBH_Int.h"
+#include "USBH_MSD.h"
+#include "USBH_CDC.h"
+#include "USBH_FT232.h"
+#include "USBH_HW_Virtual.h"
+#include "USBH_OS_Sim.h"
+#include "test_check.h"
+
+/*********************************************************************
+*
+*       Defines, configurable
+*
+**********************************************************************
+*/
+#define POOL_SIZE               (512u * 1024u)
+#define NUM_CYCLES              12u
+#define NUM_BUFFERS             4u
+#define BUFFER_SIZE             64u
+#define BYTES_PER_SECTOR        512u
+#define MSD_NUM_SECTORS         64u
+#define ENUM_TIMEOUT            10000u      // Virtual ms.
+
+/*********************************************************************
+*
+*       Defines, fixed
+*
+**********************************************************************
+*/
+#define PORT_HUB                1u
+#define NUM_DEVICES             3u          // MSD, CDC, FT232 behind the hub.
+
+/*********************************************************************
+*
+*       Static data
+*
+**********************************************************************
+*/
+static U32      _aPool[POOL_SIZE / sizeof(U32)];
+static U8       _aDisk[MSD_NUM_SECTORS * BYTES_PER_SECTOR];
+static unsigned _NumClassDevices;
+static USBH_NOTIFICATION_HOOK _CDCHook;
+static USBH_NOTIFICATION_HOOK _FT232Hook;
+
+//
+// Orders in which the buffers of a pool are given back, index into the allocated buffers.
+//
+static const U8 _aaFreeOrder[][NUM_BUFFERS] = {
+  { 0, 1, 2, 3 },                           // Allocation order, as BULK releases its endpoints.
+  { 3, 2, 1, 0 },                           // Reverse order.
+  { 1, 3, 0, 2 },
+  { 2, 0, 3, 1 }
+};
+
+/*********************************************************************
+*
+*       Static code
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _DISK_Read
+*/
+static int _DISK_Read(void * pContext, U32 SectorIndex, void * pData, U32 NumSectors) {
+  (void)pContext;
+  memcpy(pData, &_aDisk[SectorIndex * BYTES_PER_SECTOR], NumSectors * BYTES_PER_SECTOR);
+  return 0;
+}
+
+/*********************************************************************
+*
+*       _DISK_Write
+*/
+static int _DISK_Write(void * pContext, U32 SectorIndex, const void * pData, U32 NumSectors) {
+  (void)pContext;
+  memcpy(&_aDisk[SectorIndex * BYTES_PER_SECTOR], pData, NumSectors * BYTES_PER_SECTOR);
+  return 0;
+}
+
+/*********************************************************************
+*
+*       _cbOnMSD
+*/
+static void _cbOnMSD(void * pContext, U8 DevIndex, USBH_MSD_EVENT Event) {
+  USBH_USE_PARA(pContext);
+  USBH_USE_PARA(DevIndex);
+  if (Event == USBH_MSD_EVENT_ADD) {
+    _NumClassDevices++;
+  } else if (Event == USBH_MSD_EVENT_REMOVE) {
+    _NumClassDevices--;
+  } else {
+    TEST_CHECK(Event != USBH_MSD_EVENT_ERROR);
+  }
+}
+
+/*********************************************************************
+*
+*       _cbOnSerial
+*/
+static void _cbOnSerial(void * pContext, U8 DevIndex, USBH_DEVICE_EVENT Event) {
+  USBH_USE_PARA(pContext);
+  USBH_USE_PARA(DevIndex);
+  if (Event == USBH_DEVICE_EVENT_ADD) {
+    _NumClassDevices++;
+  } else {
+    _NumClassDevices--;
+  }
+}
+
+/*********************************************************************
+*
+*       _IsNumClassDevices
+*/
+static int _IsNumClassDevices(void * pContext) {
+  USBH_INST_POOL_STAT Stat;
+  unsigned            NumDevices;
+
+  NumDevices = *(unsigned *)pContext;
+  USBH_GetInstPoolStat(&Stat);
+  //
+  // Removed devices are released after the REMOVE notification,
+  // wait until the devices (hub + NumDevices) are gone. With no devices
+  // left all pools must be released, the FT232 driver has two (FT232 and BULK).
+  //
+  return _NumClassDevices == NumDevices && USBH_GetNumDevicesConnected(0) == (int)NumDevices + 1 &&
+         (NumDevices != 0u || Stat.NumPools == 0u);
+}
+
+/*********************************************************************
+*
+*       _WaitNumClassDevices
+*/
+static void _WaitNumClassDevices(unsigned NumDevices) {
+  TEST_CHECK_EQ(SIM_WaitFor(_IsNumClassDevices, &NumDevices, ENUM_TIMEOUT), 0);
+}
+
+/*********************************************************************
+*
+*       _TestPool
+*
+*  Function description
+*    Allocates buffers from a pool and gives them back in different
+*    orders. The pool must be empty again afterwards in every case.
+*/
+static void _TestPool(void) {
+  USBH_INST_POOL      Pool;
+  USBH_INST_POOL_STAT StatStart;
+  USBH_INST_POOL_STAT Stat;
+  void              * ap[NUM_BUFFERS];
+  U32                 NumBytesUsed;
+  unsigned            Order;
+  unsigned            Cycle;
+  unsigned            i;
+
+  USBH_GetInstPoolStat(&StatStart);
+  NumBytesUsed = USBH_MEM_GetUsed(0);
+  memset(&Pool, 0, sizeof(Pool));
+  TEST_CHECK_EQ(USBH_INST_POOL_Create(&Pool, NUM_BUFFERS * USBH_INST_POOL_BLOCK_SIZE(BUFFER_SIZE)), 0);
+  if (Pool.pBase == NULL) {
+    return;
+  }
+  for (Cycle = 0; Cycle < 4u * SEGGER_COUNTOF(_aaFreeOrder); Cycle++) {
+    Order = Cycle % SEGGER_COUNTOF(_aaFreeOrder);
+    for (i = 0; i < NUM_BUFFERS; i++) {
+      ap[i] = USBH_INST_POOL_Alloc(&Pool, BUFFER_SIZE);
+      //
+      // A full pool must be carved in the same way in every cycle.
+      //
+      TEST_CHECK(ap[i] == Pool.pBase + i * USBH_INST_POOL_BLOCK_SIZE(BUFFER_SIZE));
+    }
+    TEST_CHECK_EQ(Pool.Used, Pool.Size);
+    for (i = 0; i < NUM_BUFFERS; i++) {
+      USBH_INST_POOL_Free(&Pool, ap[_aaFreeOrder[Order][i]]);
+    }
+    TEST_CHECK_EQ(Pool.Used, 0u);
+    TEST_CHECK_EQ(Pool.NumBuffers, 0u);
+  }
+  //
+  // The most recently allocated buffer is reused while others are still in use.
+  //
+  ap[0] = USBH_INST_POOL_Alloc(&Pool, BUFFER_SIZE);
+  ap[1] = USBH_INST_POOL_Alloc(&Pool, BUFFER_SIZE);
+  USBH_INST_POOL_Free(&Pool, ap[1]);
+  ap[2] = USBH_INST_POOL_Alloc(&Pool, BUFFER_SIZE);
+  TEST_CHECK(ap[2] == ap[1]);
+  USBH_INST_POOL_Free(&Pool, ap[0]);
+  USBH_INST_POOL_Free(&Pool, ap[2]);
+  TEST_CHECK_EQ(Pool.Used, 0u);
+  USBH_GetInstPoolStat(&Stat);
+  TEST_CHECK_EQ(Stat.NumFallbacks, StatStart.NumFallbacks);
+  TEST_CHECK_EQ(Stat.NumFailed,    StatStart.NumFailed);
+  TEST_CHECK_EQ(Stat.NumPools,     StatStart.NumPools + 1u);
+  USBH_INST_POOL_Destroy(&Pool);
+  TEST_CHECK(Pool.pBase == NULL && Pool.Size == 0u && Pool.NumBuffers == 0u);
+  USBH_GetInstPoolStat(&Stat);
+  TEST_CHECK_EQ(Stat.NumPools,         StatStart.NumPools);
+  TEST_CHECK_EQ(Stat.NumBytesReserved, StatStart.NumBytesReserved);
+  TEST_CHECK_EQ(USBH_MEM_GetUsed(0), NumBytesUsed);
+}
+
+/*********************************************************************
+*
+*       _TestAttachDetach
+*
+*  Function description
+*    Attaches and detaches an MSD, a CDC and an FT232 device behind a hub.
+*    Each cycle connects them in another order, removes one device and
+*    attaches it again while the others stay connected, then removes
+*    all devices in yet another order.
+*/
+static void _TestAttachDetach(void) {
+  USBH_VHC_MSD_STORAGE Storage;
+  USBH_INST_POOL_STAT  StatStart;
+  USBH_INST_POOL_STAT  Stat;
+  USBH_VHC_DEVICE    * pHub;
+  USBH_VHC_DEVICE    * apDev[NUM_DEVICES];
+  U32                  NumBytesUsed;
+  U32                  NumBytesReserved;
+  unsigned             Cycle;
+  unsigned             i;
+  unsigned             Port;
+
+  memset(&Storage, 0, sizeof(Storage));
+  Storage.pfRead         = _DISK_Read;
+  Storage.pfWrite        = _DISK_Write;
+  Storage.NumSectors     = MSD_NUM_SECTORS;
+  Storage.BytesPerSector = BYTES_PER_SECTOR;
+  pHub     = USBH_VHC_CreateHub(NUM_DEVICES);
+  apDev[0] = USBH_VHC_CreateMSD(&Storage);
+  apDev[1] = USBH_VHC_CreateCDCLoopback();
+  apDev[2] = USBH_VHC_CreateFT232();
+  TEST_CHECK(pHub != NULL && apDev[0] != NULL && apDev[1] != NULL && apDev[2] != NULL);
+  if (pHub == NULL || apDev[0] == NULL || apDev[1] == NULL || apDev[2] == NULL) {
+    return;
+  }
+  TEST_CHECK_EQ(USBH_VHC_Connect(PORT_HUB, pHub), USBH_STATUS_SUCCESS);
+  _WaitNumClassDevices(0);
+  USBH_GetInstPoolStat(&StatStart);
+  NumBytesUsed     = 0;
+  NumBytesReserved = 0;
+  for (Cycle = 0; Cycle < NUM_CYCLES; Cycle++) {
+    //
+    // Attach in rotating order, device i on hub port i + 1.
+    //
+    for (i = 0; i < NUM_DEVICES; i++) {
+      Port = (Cycle + i) % NUM_DEVICES;
+      TEST_CHECK_EQ(USBH_VHC_HUB_Connect(pHub, Port + 1u, apDev[Port]), USBH_STATUS_SUCCESS);
+    }
+    _WaitNumClassDevices(NUM_DEVICES);
+    USBH_GetInstPoolStat(&Stat);
+    if (Cycle == 0u) {
+      NumBytesReserved = Stat.NumBytesReserved;
+    }
+    TEST_CHECK_EQ(Stat.NumBytesReserved, NumBytesReserved);
+    //
+    // Detach and re-attach one device while the others stay connected.
+    //
+    Port = Cycle % NUM_DEVICES;
+    TEST_CHECK_EQ(USBH_VHC_HUB_Disconnect(pHub, Port + 1u), USBH_STATUS_SUCCESS);
+    _WaitNumClassDevices(NUM_DEVICES - 1u);
+    TEST_CHECK_EQ(USBH_VHC_HUB_Connect(pHub, Port + 1u, apDev[Port]), USBH_STATUS_SUCCESS);
+    _WaitNumClassDevices(NUM_DEVICES);
+    //
+    // Detach all, in reverse rotating order.
+    //
+    for (i = 0; i < NUM_DEVICES; i++) {
+      Port = (Cycle + NUM_DEVICES - 1u - i) % NUM_DEVICES;
+      TEST_CHECK_EQ(USBH_VHC_HUB_Disconnect(pHub, Port + 1u), USBH_STATUS_SUCCESS);
+    }
+    _WaitNumClassDevices(0);
+    //
+    // Descriptor cache entries are replaced on each enumeration, they are not part of the balance.
+    //
+    USBH_ClearEnumDescCache();
+    USBH_GetInstPoolStat(&Stat);
+    TEST_CHECK_EQ(Stat.NumPools,         StatStart.NumPools);
+    TEST_CHECK_EQ(Stat.NumBytesReserved, StatStart.NumBytesReserved);
+    TEST_CHECK_EQ(Stat.NumFallbacks,     StatStart.NumFallbacks);
+    TEST_CHECK_EQ(Stat.NumFailed,        StatStart.NumFailed);
+    //
+    // The first cycle allocates some objects that are kept by the stack,
+    // from then on every cycle must give back all memory it took.
+    //
+    if (Cycle == 0u) {
+      NumBytesUsed = USBH_MEM_GetUsed(0);
+    }
+    TEST_CHECK_EQ(USBH_MEM_GetUsed(0),   NumBytesUsed);
+  }
+  printf("%u attach / detach cycles: %u bytes reserved per cycle, peak %u bytes (%u%%) in a single pool, heap usage %u bytes\n",
+         NUM_CYCLES, (unsigned)NumBytesReserved, (unsigned)Stat.PeakUsed, (unsigned)Stat.PeakUsedPercent, (unsigned)USBH_MEM_GetUsed(0));
+  TEST_CHECK_EQ(USBH_VHC_Disconnect(PORT_HUB), USBH_STATUS_SUCCESS);
+  USBH_OS_Delay(200);
+  TEST_CHECK_EQ(USBH_GetNumDevicesConnected(0), 0u);
+  USBH_VHC_DeleteDevice(pHub);
+  for (i = 0; i < NUM_DEVICES; i++) {
+    USBH_VHC_DeleteDevice(apDev[i]);
+  }
+}
+
+/*********************************************************************
+*
+*       Public code
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       USBH_X_Config
+*/
+void USBH_X_Config(void) {
+  USBH_AssignMemory(_aPool, sizeof(_aPool));
+  USBH_ConfigSupportExternalHubs(1);
+  (void)USBH_VHC_Add(1);
+}
+
+/*********************************************************************
+*
+*       main
+*/
+int main(void) {
+  SIM_Init();
+  SIM_StartStack();
+  (void)USBH_MSD_Init(_cbOnMSD, NULL);
+  (void)USBH_CDC_Init();
+  (void)USBH_CDC_AddNotification(&_CDCHook, _cbOnSerial, NULL);
+  (void)USBH_FT232_Init();
+  (void)USBH_FT232_AddNotification(&_FT232Hook, _cbOnSerial, NULL);
+  _TestPool();
+  _TestAttachDetach();
+  USBH_FT232_Exit();
+  USBH_CDC_Exit();
+  USBH_MSD_Exit();
+  SIM_StopStack();
+  return TEST_Report("USBH_InstPoolTest");
+}
+
+/*************************** End of file ****************************/
@@ -0,0 +1,48 @@
+/*********************************************************************
+*                                                                    *
+*       emUSB-Host * USB Host stack for embedded applications        *
+*                                                                    *
+**********************************************************************
+----------------------------------------------------------------------
+File        : USBH_LogBinCheck.c
+Purpose     : Compile time checks of USBH_LOG() with binary logging,
+              which rejects arguments whose strings may change before
+              the message is rendered.
+              CHECK_CASE == 0: 'const char *' and string literals, compiles.
+              CHECK_CASE == 1: %s argument is a buffer ('char *'), must not compile.
+              CHECK_CASE == 2: The format is not a string literal, must not compile.
+-------------------------- END-OF-HEADER -----------------------------
+*/
+
+/*********************************************************************
+*
+*       #include Section
+*
+**********************************************************************
+*/
+#include "USBH_Int.h"
+
+/*********************************************************************
+*
+*       Public code
+*
+**********************************************************************
+*/
+void USBH_LogBinCheck(unsigned Port, const char * sState) {
+  char         ac[16];
+  const char * sFormat;
+
+  ac[0]   = '\0';
+  sFormat = "Port %u: %s";
+  USBH_LOG((USBH_MCAT_APPLICATION, "Port %u: %s", Port, sState));
+  USBH_LOG((USBH_MCAT_APPLICATION, "Port %u: %s", Port, "constant"));
+#if CHECK_CASE == 1
+  USBH_LOG((USBH_MCAT_APPLICATION, "Port %u: %s", Port, ac));
+#elif CHECK_CASE == 2
+  USBH_LOG((USBH_MCAT_APPLICATION, sFormat, Port, sState));
+#endif
+  USBH_USE_PARA(ac);
+  USBH_USE_PARA(sFormat);
+}
+
+/*************************** End of file ****************************/
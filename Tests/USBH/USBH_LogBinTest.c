@@ -0,0 +1,574 @@
+/*********************************************************************
+*                                                                    *
+*       emUSB-Host * USB Host stack for embedded applications        *
+*                                                                    *
+**********************************************************************
+----------------------------------------------------------------------
+File        : USBH_LogBinTest.c
+Purpose     : Host test of the binary log transport (USBH_LOG_BINARY).
+              Messages are logged through USBH_LOG() / USBH_WARN(), so
+              the compile time checks of the macros apply. The test
+              checks the raw records returned by USBH_LogBinRead(), the
+              messages rendered by USBH_LogBinProcess() against
+              SEGGER_snprintf(), the message filter, the overflow and
+              rate limit counters on a virtual millisecond clock, and
+              several writer threads against a concurrent reader: every
+              record is complete and the messages of each writer arrive
+              in order, each one either received or counted as dropped.
+              At the end the cost of a message is reported, with the
+              cycle counter of USBH_LogBinGetStat() (TSC on x86 hosts)
+              and the host time, next to the formatting path of
+              USBH_Logf().
+              Pointer arguments (%s, %p) are checked with all their bits,
+              on a 64-bit host they take two words of a record.
+-------------------------- END-OF-HEADER -----------------------------
+*/
+
+/*********************************************************************
+*
+*       #include Section
+*
+**********************************************************************
+*/
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "USBH_Int.h"
+#include "test_check.h"
+
+/*********************************************************************
+*
+*       Defines, configurable
+*
+**********************************************************************
+*/
+#define NUM_WRITERS             4u
+#define NUM_MSG_PER_WRITER      200000u
+#define NUM_BENCH_MSGS          200000u
+#define BENCH_BATCH             64u           // Messages between two reads of the ring buffer.
+#define MAX_OUTPUT              512u          // Rendered messages kept for checking.
+#define TIME_START              0xFFFFFC00u
+
+/*********************************************************************
+*
+*       Defines, non-configurable
+*
+**********************************************************************
+*/
+#define BUFFER_WORDS            (USBH_LOG_BIN_BUFFER_SIZE / 4u)
+#define FMT_WORDS               (sizeof(PTR_ADDR) / 4u)
+#define HEADER_WORDS            (3u + FMT_WORDS)
+#define MAGIC                   0x4C42u
+#define HEADER(NumArgs, Warn, Type)  ((((U32)HEADER_WORDS + (NumArgs)) << 24) | ((U32)(Warn) << 23) | ((U32)(Type) << 16) | MAGIC)
+
+/*********************************************************************
+*
+*       Types
+*
+**********************************************************************
+*/
+typedef struct {
+  pthread_t Thread;
+  U32       Id;
+} WRITER;
+
+/*********************************************************************
+*
+*       Static data
+*
+**********************************************************************
+*/
+static volatile USBH_TIME _Time = TIME_START;
+static char               _aacOutput[MAX_OUTPUT][USBH_LOG_BUFFER_SIZE + 16];
+static U8                 _aIsWarn[MAX_OUTPUT];
+static unsigned           _NumOutput;
+static unsigned           _NumOutputLost;
+static int                _DiscardOutput;
+static U32                _aRead[BUFFER_WORDS];
+static WRITER             _aWriter[NUM_WRITERS];
+static volatile int       _StartWriters;
+static U32                _NumWritersDone;
+
+/*********************************************************************
+*
+*       Static code
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _GetTime_ns
+*/
+static U64 _GetTime_ns(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (U64)ts.tv_sec * 1000000000u + (U64)ts.tv_nsec;
+}
+
+/*********************************************************************
+*
+*       _GetAddr
+*
+*  Function description
+*    Returns an address stored in a record, low word first.
+*/
+static PTR_ADDR _GetAddr(const U32 * pWords) {
+  PTR_ADDR Addr;
+  unsigned i;
+
+  Addr = 0;
+  for (i = FMT_WORDS; i > 0u; i--) {
+    Addr = ((Addr << 16) << 16) | pWords[i - 1u];
+  }
+  return Addr;
+}
+
+/*********************************************************************
+*
+*       _Output
+*/
+static void _Output(const char * s, U8 IsWarn) {
+  if (_DiscardOutput != 0) {
+    return;
+  }
+  if (_NumOutput >= MAX_OUTPUT) {
+    _NumOutputLost++;
+    return;
+  }
+  strncpy(_aacOutput[_NumOutput], s, sizeof(_aacOutput[0]) - 1u);
+  _aIsWarn[_NumOutput] = IsWarn;
+  _NumOutput++;
+}
+
+/*********************************************************************
+*
+*       _CheckOutput
+*
+*  Function description
+*    Compares a rendered message with the expected one.
+*/
+static void _CheckOutput(unsigned Idx, U8 IsWarn, const char * sExpected) {
+  if (Idx >= _NumOutput) {
+    TEST_CHECK(Idx < _NumOutput);
+    return;
+  }
+  TEST_CHECK_EQ(_aIsWarn[Idx], IsWarn);
+  if (strcmp(_aacOutput[Idx], sExpected) != 0) {
+    TEST_CHECK(strcmp(_aacOutput[Idx], sExpected) == 0);
+    printf("  rendered \"%s\"\n  expected \"%s\"\n", _aacOutput[Idx], sExpected);
+  }
+}
+
+/*********************************************************************
+*
+*       _Drain
+*
+*  Function description
+*    Reads and discards all pending records.
+*
+*  Return value
+*    Number of records read.
+*/
+static U32 _Drain(void) {
+  U32      NumRecords;
+  unsigned NumWords;
+  unsigned i;
+
+  NumRecords = 0;
+  for (;;) {
+    NumWords = USBH_LogBinRead(_aRead, BUFFER_WORDS);
+    if (NumWords == 0u) {
+      break;
+    }
+    for (i = 0; i < NumWords; i += _aRead[i] >> 24) {
+      NumRecords++;
+    }
+  }
+  return NumRecords;
+}
+
+/*********************************************************************
+*
+*       _TestRecords
+*
+*  Function description
+*    Checks the raw records, the rendering and the message filter.
+*/
+static void _TestRecords(void) {
+  USBH_LOG_BIN_STAT Stat;
+  char              ac[USBH_LOG_BUFFER_SIZE];
+  unsigned          NumWords;
+  unsigned          i;
+  U32             * p;
+  const char      * sState;
+  U8                Category;
+
+  USBH_LogBinGetStat(&Stat);
+  TEST_CHECK_EQ(Stat.NumRecords, 0u);
+  //
+  // Raw records.
+  //
+  USBH_LOG((USBH_MCAT_APPLICATION, "No arguments"));
+  _Time++;
+  USBH_WARN((USBH_MCAT_APPLICATION, "One argument: %d", -5));
+  USBH_LOG((USBH_MCAT_APPLICATION, "%u %u %u %u %u %u %u %u %u %u", 1, 2, 3, 4, 5, 6, 7, 8, 9, 0xFFFFFFFFu));
+  USBH_LOG((USBH_MCAT_HUB, "Filtered: %u", 1));            // Log messages of this category are off by default.
+  NumWords = USBH_LogBinRead(_aRead, BUFFER_WORDS);
+  TEST_CHECK_EQ(NumWords, 3u * HEADER_WORDS + 11u);
+  p = _aRead;
+  TEST_CHECK_EQ(p[0], HEADER(0u, 0, USBH_MCAT_APPLICATION));
+  TEST_CHECK_EQ(p[1], TIME_START);
+  TEST_CHECK_EQ(p[2], 0u);
+  TEST_CHECK(p[3] != 0u);
+  p += HEADER_WORDS;
+  TEST_CHECK_EQ(p[0], HEADER(1u, 1, USBH_MCAT_APPLICATION));
+  TEST_CHECK_EQ(p[1], TIME_START + 1u);
+  TEST_CHECK_EQ(p[HEADER_WORDS], (U32)-5);
+  p += HEADER_WORDS + 1u;
+  TEST_CHECK_EQ(p[0], HEADER(10u, 0, USBH_MCAT_APPLICATION));
+  for (i = 0; i < 9u; i++) {
+    TEST_CHECK_EQ(p[HEADER_WORDS + i], i + 1u);
+  }
+  TEST_CHECK_EQ(p[HEADER_WORDS + 9u], 0xFFFFFFFFu);
+  TEST_CHECK_EQ(USBH_LogBinRead(_aRead, BUFFER_WORDS), 0u);
+  //
+  // Pointers are stored with all their bits, between 32-bit arguments.
+  //
+  sState = "configured";
+  USBH_LOG((USBH_MCAT_APPLICATION, "%u %s %p %u", 7, sState, (const void *)&_Time, 8));
+  NumWords = USBH_LogBinRead(_aRead, BUFFER_WORDS);
+  TEST_CHECK_EQ(NumWords, HEADER_WORDS + 2u + 2u * FMT_WORDS);
+  p = _aRead;
+  TEST_CHECK_EQ(p[0] >> 24, NumWords);
+  TEST_CHECK_EQ(p[2], 0x6u);
+  TEST_CHECK_EQ(p[HEADER_WORDS], 7u);
+  TEST_CHECK(_GetAddr(&p[HEADER_WORDS + 1u]) == SEGGER_PTR2ADDR(sState));
+  TEST_CHECK(_GetAddr(&p[HEADER_WORDS + 1u + FMT_WORDS]) == SEGGER_PTR2ADDR(&_Time));
+  TEST_CHECK_EQ(p[HEADER_WORDS + 1u + 2u * FMT_WORDS], 8u);
+  //
+  // A record is only returned as a whole.
+  //
+  USBH_LOG((USBH_MCAT_APPLICATION, "%u %u", 1, 2));
+  TEST_CHECK_EQ(USBH_LogBinRead(_aRead, HEADER_WORDS + 1u), 0u);
+  TEST_CHECK_EQ(USBH_LogBinRead(_aRead, HEADER_WORDS + 2u), HEADER_WORDS + 2u);
+  //
+  // Rendering, compared with the formatter of the text path.
+  //
+  Category = USBH_MCAT_HUB;
+  USBH_ConfigMsgFilter(USBH_LOG_FILTER_ADD, 1, &Category);
+  _NumOutput = 0;
+  USBH_LOG((USBH_MCAT_APPLICATION, "No arguments"));
+  USBH_WARN((USBH_MCAT_APPLICATION, "One argument: %d", -5));
+  USBH_LOG((USBH_MCAT_HUB, "Port %u: status 0x%08X, %d ms, %c", 3, 0x00010103u, -20, 'x'));
+  USBH_LOG((USBH_MCAT_APPLICATION, "%u %u %u %u %u %u %u %u %u %u", 1, 2, 3, 4, 5, 6, 7, 8, 9, 0xFFFFFFFFu));
+  TEST_CHECK_EQ(USBH_LogBinProcess(3), 3u);
+  TEST_CHECK_EQ(USBH_LogBinProcess(0), 1u);
+  TEST_CHECK_EQ(USBH_LogBinProcess(0), 0u);
+  TEST_CHECK_EQ(_NumOutput, 4u);
+  _CheckOutput(0, 0, "APP: No arguments");
+  _CheckOutput(1, 1, "APP: One argument: -5");
+  (void)SEGGER_snprintf(ac, (int)sizeof(ac), "HUB: Port %u: status 0x%08X, %d ms, %c", 3, 0x00010103u, -20, 'x');
+  _CheckOutput(2, 0, ac);
+  _CheckOutput(3, 0, "APP: 1 2 3 4 5 6 7 8 9 4294967295");
+  //
+  // Pointer arguments, flags and literal percent signs.
+  //
+  _NumOutput = 0;
+  USBH_LOG((USBH_MCAT_APPLICATION, "Device %s, state %-12s|, class %.3s, %s", sState, "addressed", "hub-class", (const char *)NULL));
+  USBH_WARN((USBH_MCAT_APPLICATION, "%u%% at %p, %5u, 0x%02x", 50, (const void *)&_Time, 42, 0xAu));
+  USBH_LOG((USBH_MCAT_APPLICATION, "Missing: %u %s, trailing %"));
+  TEST_CHECK_EQ(USBH_LogBinProcess(0), 3u);
+  TEST_CHECK_EQ(_NumOutput, 3u);
+  _CheckOutput(0, 0, "APP: Device configured, state addressed   |, class hub, (null)");
+  (void)SEGGER_snprintf(ac, (int)sizeof(ac), "APP: %u%% at %p, %5u, 0x%02x", 50, (const void *)&_Time, 42, 0xAu);
+  _CheckOutput(1, 1, ac);
+  _CheckOutput(2, 0, "APP: Missing: 0 (?), trailing %");
+  USBH_ConfigMsgFilter(USBH_LOG_FILTER_CLR, 1, &Category);
+  USBH_LOG((USBH_MCAT_HUB, "Filtered: %u", 2));
+  TEST_CHECK_EQ(USBH_LogBinProcess(0), 0u);
+  USBH_LogBinGetStat(&Stat);
+  TEST_CHECK_EQ(Stat.NumRecords, 12u);
+  TEST_CHECK_EQ(Stat.NumDroppedOverflow, 0u);
+  TEST_CHECK_EQ(Stat.NumDroppedRateLimit, 0u);
+}
+
+/*********************************************************************
+*
+*       _TestLimits
+*
+*  Function description
+*    Checks the overflow of the ring buffer and the rate limit.
+*/
+static void _TestLimits(void) {
+  USBH_LOG_BIN_STAT Stat0;
+  USBH_LOG_BIN_STAT Stat;
+  char              ac[64];
+  U32               NumFit;
+  U32               i;
+
+  //
+  // Overflow: The buffer takes NumFit records of 2 arguments, the rest is counted.
+  //
+  NumFit = BUFFER_WORDS / (HEADER_WORDS + 2u);
+  USBH_LogBinGetStat(&Stat0);
+  for (i = 0; i < NumFit + 100u; i++) {
+    USBH_LOG((USBH_MCAT_APPLICATION, "Overflow %u of %u", i, NumFit));
+  }
+  USBH_LogBinGetStat(&Stat);
+  TEST_CHECK_EQ(Stat.NumRecords - Stat0.NumRecords, NumFit);
+  TEST_CHECK_EQ(Stat.NumDroppedOverflow - Stat0.NumDroppedOverflow, 100u);
+  _NumOutput = 0;
+  TEST_CHECK_EQ(USBH_LogBinProcess(0), NumFit);
+  TEST_CHECK_EQ(_NumOutput, NumFit + 1u);
+  (void)SEGGER_snprintf(ac, (int)sizeof(ac), "APP: Overflow %u of %u", NumFit - 1u, NumFit);
+  _CheckOutput(NumFit - 1u, 0, ac);
+  _CheckOutput(NumFit, 1, "LOG: 100 messages dropped");
+  //
+  // The space is free again.
+  //
+  for (i = 0; i < NumFit; i++) {
+    USBH_LOG((USBH_MCAT_APPLICATION, "Refill %u of %u", i, NumFit));
+  }
+  TEST_CHECK_EQ(_Drain(), NumFit);
+  //
+  // Rate limit of 5 messages per second, the window crosses the wrap-around of the clock.
+  //
+  USBH_ConfigMsgRateLimit(USBH_MCAT_APPLICATION, 5);
+  _Time = 0xFFFFFF00u;
+  USBH_LogBinGetStat(&Stat0);
+  for (i = 0; i < 20u; i++) {
+    USBH_LOG((USBH_MCAT_APPLICATION, "Rate %u", i));
+    _Time += 10u;
+  }
+  _Time = 0xFFFFFF00u + 999u;
+  USBH_LOG((USBH_MCAT_APPLICATION, "Rate %u", i));
+  _Time++;
+  for (i = 0; i < 20u; i++) {
+    USBH_LOG((USBH_MCAT_APPLICATION, "Rate %u", i));
+  }
+  USBH_WARN((USBH_MCAT_HUB, "Other categories are not limited"));
+  USBH_LogBinGetStat(&Stat);
+  TEST_CHECK_EQ(Stat.NumRecords - Stat0.NumRecords, 11u);
+  TEST_CHECK_EQ(Stat.NumDroppedRateLimit - Stat0.NumDroppedRateLimit, 31u);
+  _NumOutput = 0;
+  TEST_CHECK_EQ(USBH_LogBinProcess(0), 11u);
+  _CheckOutput(4, 0, "APP: Rate 4");
+  _CheckOutput(5, 0, "APP: Rate 0");
+  _CheckOutput(10, 1, "HUB: Other categories are not limited");
+  _CheckOutput(11, 1, "LOG: 31 messages dropped");
+  USBH_ConfigMsgRateLimit(USBH_MCAT_APPLICATION, 0);
+  for (i = 0; i < 20u; i++) {
+    USBH_LOG((USBH_MCAT_APPLICATION, "Unlimited %u", i));
+  }
+  TEST_CHECK_EQ(_Drain(), 20u);
+}
+
+/*********************************************************************
+*
+*       _WriterThread
+*/
+static void * _WriterThread(void * p) {
+  WRITER * pWriter;
+  U32      i;
+
+  pWriter = (WRITER *)p;
+  while (_StartWriters == 0) {
+    sched_yield();
+  }
+  for (i = 0; i < NUM_MSG_PER_WRITER; i++) {
+    USBH_LOG((USBH_MCAT_APPLICATION, "Writer %u message %u", pWriter->Id, i));
+    if ((i % 128u) == 0u) {
+      sched_yield();
+    }
+  }
+  (void)__atomic_fetch_add(&_NumWritersDone, 1u, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+/*********************************************************************
+*
+*       _TestConcurrent
+*
+*  Function description
+*    Several writers log into the ring buffer while it is read.
+*/
+static void _TestConcurrent(void) {
+  USBH_LOG_BIN_STAT Stat0;
+  USBH_LOG_BIN_STAT Stat;
+  U32               aNumReceived[NUM_WRITERS];
+  U32               aNext[NUM_WRITERS];
+  U32               NumReceived;
+  U32               NumBad;
+  U32               NumOutOfOrder;
+  U32               Id;
+  U32               Seq;
+  unsigned          NumWords;
+  unsigned          i;
+  int               IsDone;
+
+  memset(aNumReceived, 0, sizeof(aNumReceived));
+  memset(aNext, 0, sizeof(aNext));
+  NumBad        = 0;
+  NumOutOfOrder = 0;
+  _StartWriters = 0;
+  _NumWritersDone = 0;
+  USBH_LogBinGetStat(&Stat0);
+  for (i = 0; i < NUM_WRITERS; i++) {
+    _aWriter[i].Id = i;
+    (void)pthread_create(&_aWriter[i].Thread, NULL, _WriterThread, &_aWriter[i]);
+  }
+  _StartWriters = 1;
+  //
+  // Read until all writers are done and the buffer is empty.
+  //
+  do {
+    IsDone   = (__atomic_load_n(&_NumWritersDone, __ATOMIC_ACQUIRE) == NUM_WRITERS) ? 1 : 0;
+    NumWords = USBH_LogBinRead(_aRead, BUFFER_WORDS);
+    for (i = 0; i < NumWords; i += _aRead[i] >> 24) {
+      if (_aRead[i] != HEADER(2u, 0, USBH_MCAT_APPLICATION)) {
+        NumBad++;
+        break;
+      }
+      Id  = _aRead[i + HEADER_WORDS];
+      Seq = _aRead[i + HEADER_WORDS + 1u];
+      if (Id >= NUM_WRITERS || Seq >= NUM_MSG_PER_WRITER) {
+        NumBad++;
+        break;
+      }
+      if (Seq < aNext[Id]) {
+        NumOutOfOrder++;
+      }
+      aNext[Id] = Seq + 1u;
+      aNumReceived[Id]++;
+    }
+    if (NumWords == 0u) {
+      sched_yield();
+    }
+  } while (IsDone == 0 || NumWords != 0u);
+  for (i = 0; i < NUM_WRITERS; i++) {
+    (void)pthread_join(_aWriter[i].Thread, NULL);
+  }
+  USBH_LogBinGetStat(&Stat);
+  NumReceived = 0;
+  for (i = 0; i < NUM_WRITERS; i++) {
+    NumReceived += aNumReceived[i];
+    TEST_CHECK(aNumReceived[i] != 0u);
+  }
+  TEST_CHECK_EQ(NumBad, 0u);
+  TEST_CHECK_EQ(NumOutOfOrder, 0u);
+  TEST_CHECK_EQ(Stat.NumRecords - Stat0.NumRecords, NumReceived);
+  TEST_CHECK_EQ(NumReceived + (Stat.NumDroppedOverflow - Stat0.NumDroppedOverflow), NUM_WRITERS * NUM_MSG_PER_WRITER);
+  printf("%u writers, %u messages: %lu received, %lu dropped on overflow\n",
+         NUM_WRITERS, NUM_WRITERS * NUM_MSG_PER_WRITER, (unsigned long)NumReceived,
+         (unsigned long)(Stat.NumDroppedOverflow - Stat0.NumDroppedOverflow));
+  _DiscardOutput = 1;
+  (void)USBH_LogBinProcess(0);                               // Reports the drops.
+  _DiscardOutput = 0;
+}
+
+/*********************************************************************
+*
+*       _TestCost
+*
+*  Function description
+*    Reports the cost of a binary message and of a formatted one.
+*/
+static void _TestCost(void) {
+  USBH_LOG_BIN_STAT Stat0;
+  USBH_LOG_BIN_STAT Stat;
+  U64               t;
+  U64               tBin;
+  U64               tText;
+  U32               NumRecords;
+  U32               Cycles;
+  U32               i;
+  U32               j;
+
+  USBH_LogBinGetStat(&Stat0);
+  tBin = 0;
+  for (i = 0; i < NUM_BENCH_MSGS; i += BENCH_BATCH) {
+    t = _GetTime_ns();
+    for (j = 0; j < BENCH_BATCH; j++) {
+      USBH_LOG((USBH_MCAT_APPLICATION, "_ProcessPorts: Port %u status 0x%X = %u", j, i, i + j));
+    }
+    tBin += _GetTime_ns() - t;
+    (void)_Drain();
+  }
+  USBH_LogBinGetStat(&Stat);
+  NumRecords = Stat.NumRecords - Stat0.NumRecords;
+  TEST_CHECK_EQ(NumRecords, NUM_BENCH_MSGS);
+  TEST_CHECK_EQ(Stat.NumDroppedOverflow, Stat0.NumDroppedOverflow);
+  //
+  // Same message, formatted at the call site. The output function discards it.
+  //
+  _DiscardOutput = 1;
+  Cycles = 0;
+  t = _GetTime_ns();
+  for (i = 0; i < NUM_BENCH_MSGS; i += BENCH_BATCH) {
+#ifdef USBH_LOG_BIN_GET_CYCLES
+    U32 c;
+
+    c = USBH_LOG_BIN_GET_CYCLES();
+#endif
+    for (j = 0; j < BENCH_BATCH; j++) {
+      USBH_Logf(USBH_MCAT_APPLICATION, "_ProcessPorts: Port %u status 0x%X = %u", j, i, i + j);
+    }
+#ifdef USBH_LOG_BIN_GET_CYCLES
+    Cycles += USBH_LOG_BIN_GET_CYCLES() - c;
+#endif
+  }
+  tText = _GetTime_ns() - t;
+  _DiscardOutput = 0;
+#ifdef USBH_LOG_BIN_GET_CYCLES
+  TEST_CHECK(Stat.NumCyclesTotal != Stat0.NumCyclesTotal);
+  TEST_CHECK(Stat.NumCyclesMax != 0u);
+  printf("USBH_LogBin(): %.1f cycles per message (max. %lu), USBH_Logf(): %.1f cycles per message\n",
+         (double)(Stat.NumCyclesTotal - Stat0.NumCyclesTotal) / NumRecords, (unsigned long)Stat.NumCyclesMax,
+         (double)Cycles / NUM_BENCH_MSGS);
+#else
+  TEST_CHECK_EQ(Stat.NumCyclesTotal, 0u);
+  USBH_USE_PARA(Cycles);
+#endif
+  printf("USBH_LogBin(): %.1f ns per message, USBH_Logf(): %.1f ns per message\n",
+         (double)tBin / NumRecords, (double)tText / NUM_BENCH_MSGS);
+  TEST_CHECK(tBin < tText);
+}
+
+/*********************************************************************
+*
+*       Public code, stack environment
+*
+**********************************************************************
+*/
+void USBH_Log(const char * s) {
+  _Output(s, 0);
+}
+
+void USBH_Warn(const char * s) {
+  _Output(s, 1);
+}
+
+USBH_TIME USBH_OS_GetTime32(void) {
+  return _Time;
+}
+
+/*********************************************************************
+*
+*       Public code, test
+*
+**********************************************************************
+*/
+int main(void) {
+  _TestRecords();
+  _TestLimits();
+  _TestConcurrent();
+  _TestCost();
+  TEST_CHECK_EQ(_NumOutputLost, 0u);
+  return TEST_Report("USBH_LogBinTest");
+}
+
+/*************************** End of file ****************************/
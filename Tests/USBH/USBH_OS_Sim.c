@@ -0,0 +1,682 @@
+/*********************************************************************
+*                                                                    *
+*       emUSB-Host * USB Host stack for embedded applications        *
+*                                                                    *
+**********************************************************************
+----------------------------------------------------------------------
+File        : USBH_OS_Sim.c
+Purpose     : OS layer of the stack for host tests. The tasks of the
+              stack and the test application run as threads, but the
+              threads are scheduled like tasks of a single-core RTOS:
+              Exactly one task runs at a time, until it blocks. Then
+              the ready task with the highest priority runs. When all
+              tasks are blocked the virtual millisecond clock advances
+              to the earliest timeout. Timeouts of the stack (power
+              good times, debounce, transfer latency of the virtual
+              host controller) therefore take no host time and the
+              virtual times measured by a test are reproducible.
+-------------------------- END-OF-HEADER -----------------------------
+*/
+
+/*********************************************************************
+*
+*       #include Section
+*
+**********************************************************************
+*/
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "USBH_Int.h"
+#include "USBH_OS_Sim.h"
+
+/*********************************************************************
+*
+*       Defines, configurable
+*
+**********************************************************************
+*/
+#define MAX_TASKS               8u
+#define TIME_START              1000u
+
+/*********************************************************************
+*
+*       Defines, fixed
+*
+**********************************************************************
+*/
+#define TASK_STATE_UNUSED       0u
+#define TASK_STATE_READY        1u
+#define TASK_STATE_WAITING      2u
+#define TASK_STATE_DONE         3u
+
+#define GET_EVENT_OBJ_FROM_ENTRY(pListEntry)        STRUCT_BASE_POINTER(pListEntry, USBH_OS_EVENT_OBJ, ListEntry)
+
+/*********************************************************************
+*
+*       Types
+*
+**********************************************************************
+*/
+typedef struct {
+  U8 IsSet;                                 // Auto reset: Cleared by the task which consumes the event.
+} SIM_EVENT;
+
+typedef struct _SIM_TASK SIM_TASK;
+
+typedef struct {
+  SIM_TASK * pOwner;
+  unsigned   Cnt;                           // Mutexes are recursive as the ones of embOS.
+} SIM_MUTEX;
+
+struct _SIM_TASK {
+  pthread_t      Thread;
+  pthread_cond_t Cond;                      // Signaled when the task becomes the running task.
+  void        (* pfTask)(void);
+  const char   * sName;
+  unsigned       Prio;
+  U8             State;
+  U8             HasTimeout;
+  U8             IsTimedOut;
+  SIM_EVENT    * pWaitEvent;
+  SIM_MUTEX    * pWaitMutex;
+  USBH_TIME      Timeout;
+};
+
+struct _USBH_OS_EVENT_OBJ {
+  USBH_DLIST     ListEntry;
+  SIM_EVENT      Event;
+};
+
+/*********************************************************************
+*
+*       Static data
+*
+**********************************************************************
+*/
+static pthread_mutex_t  _Mutex = PTHREAD_MUTEX_INITIALIZER;      // Held by the running task.
+static SIM_TASK         _aTask[MAX_TASKS];
+static SIM_TASK       * _pCurrent;
+static USBH_TIME        _Time;
+static SIM_EVENT        _EventNet;
+static SIM_EVENT        _EventISR;
+static U32              _IsrMask;
+static SIM_MUTEX        _aMutex[USBH_MUTEX_COUNT];
+static USBH_DLIST       _UserEventList;
+
+/*********************************************************************
+*
+*       Static code
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _Wake
+*/
+static void _Wake(SIM_TASK * pTask, U8 IsTimedOut) {
+  pTask->State      = TASK_STATE_READY;
+  pTask->IsTimedOut = IsTimedOut;
+  pTask->HasTimeout = 0;
+  pTask->pWaitEvent = NULL;
+  pTask->pWaitMutex = NULL;
+}
+
+/*********************************************************************
+*
+*       _FindWaiter
+*
+*  Function description
+*    Returns the task with the highest priority which waits for
+*    the given event or mutex.
+*/
+static SIM_TASK * _FindWaiter(const SIM_EVENT * pEvent, const SIM_MUTEX * pMutex) {
+  SIM_TASK * pTask;
+  SIM_TASK * pBest;
+
+  pBest = NULL;
+  for (pTask = _aTask; pTask < &_aTask[MAX_TASKS]; pTask++) {
+    if (pTask->State != TASK_STATE_WAITING) {
+      continue;
+    }
+    if ((pEvent != NULL && pTask->pWaitEvent == pEvent) || (pMutex != NULL && pTask->pWaitMutex == pMutex)) {
+      if (pBest == NULL || pTask->Prio > pBest->Prio) {
+        pBest = pTask;
+      }
+    }
+  }
+  return pBest;
+}
+
+/*********************************************************************
+*
+*       _DumpTasks
+*/
+static void _DumpTasks(void) {
+  SIM_TASK * pTask;
+
+  for (pTask = _aTask; pTask < &_aTask[MAX_TASKS]; pTask++) {
+    if (pTask->State != TASK_STATE_UNUSED) {
+      fprintf(stderr, "  %-12s State %u, waits for %s\n", pTask->sName, pTask->State,
+              pTask->pWaitEvent != NULL ? "event" : (pTask->pWaitMutex != NULL ? "mutex" : "time"));
+    }
+  }
+}
+
+/*********************************************************************
+*
+*       _Schedule
+*
+*  Function description
+*    Is called by the running task after it changed its own state.
+*    Selects the ready task with the highest priority, advances the
+*    virtual time if no task is ready and passes the CPU to the
+*    selected task. Returns when the calling task runs again.
+*/
+static void _Schedule(void) {
+  SIM_TASK * pSelf;
+  SIM_TASK * pNext;
+  SIM_TASK * pTask;
+
+  pSelf = _pCurrent;
+  for (;;) {
+    pNext = NULL;
+    for (pTask = _aTask; pTask < &_aTask[MAX_TASKS]; pTask++) {
+      if (pTask->State == TASK_STATE_READY && (pNext == NULL || pTask->Prio > pNext->Prio)) {
+        pNext = pTask;
+      }
+    }
+    if (pNext != NULL) {
+      break;
+    }
+    //
+    // All tasks are blocked: Advance the time to the earliest timeout.
+    //
+    for (pTask = _aTask; pTask < &_aTask[MAX_TASKS]; pTask++) {
+      if (pTask->State == TASK_STATE_WAITING && pTask->HasTimeout != 0u) {
+        if (pNext == NULL || USBH_TimeDiff(pTask->Timeout, pNext->Timeout) < 0) {
+          pNext = pTask;
+        }
+      }
+    }
+    if (pNext == NULL) {
+      fprintf(stderr, "SIM: Deadlock, all tasks wait without timeout\n");
+      _DumpTasks();
+      abort();
+    }
+    if (USBH_TimeDiff(pNext->Timeout, _Time) > 0) {
+      _Time = pNext->Timeout;
+    }
+    for (pTask = _aTask; pTask < &_aTask[MAX_TASKS]; pTask++) {
+      if (pTask->State == TASK_STATE_WAITING && pTask->HasTimeout != 0u && USBH_TimeDiff(pTask->Timeout, _Time) <= 0) {
+        _Wake(pTask, 1);
+      }
+    }
+  }
+  _pCurrent = pNext;
+  if (pNext != pSelf) {
+    pthread_cond_signal(&pNext->Cond);
+    if (pSelf->State != TASK_STATE_DONE) {
+      while (_pCurrent != pSelf) {
+        pthread_cond_wait(&pSelf->Cond, &_Mutex);
+      }
+    }
+  }
+}
+
+/*********************************************************************
+*
+*       _Block
+*
+*  Function description
+*    Blocks the running task.
+*
+*  Return value
+*    == 0: Woken up by the event or mutex.
+*    == 1: Timeout.
+*/
+static int _Block(SIM_EVENT * pEvent, SIM_MUTEX * pMutex, int HasTimeout, U32 ms) {
+  SIM_TASK * pSelf;
+
+  pSelf             = _pCurrent;
+  pSelf->State      = TASK_STATE_WAITING;
+  pSelf->pWaitEvent = pEvent;
+  pSelf->pWaitMutex = pMutex;
+  pSelf->HasTimeout = (U8)HasTimeout;
+  pSelf->Timeout    = _Time + ms;
+  pSelf->IsTimedOut = 0;
+  _Schedule();
+  return pSelf->IsTimedOut;
+}
+
+/*********************************************************************
+*
+*       _EventWait
+*/
+static int _EventWait(SIM_EVENT * pEvent, int HasTimeout, U32 ms) {
+  if (pEvent->IsSet != 0u) {
+    pEvent->IsSet = 0;
+    return 0;
+  }
+  return _Block(pEvent, NULL, HasTimeout, ms);
+}
+
+/*********************************************************************
+*
+*       _EventSet
+*
+*  Function description
+*    Sets an auto reset event. A waiting task is made ready but
+*    does not preempt the running task.
+*/
+static void _EventSet(SIM_EVENT * pEvent) {
+  SIM_TASK * pTask;
+
+  pTask = _FindWaiter(pEvent, NULL);
+  if (pTask != NULL) {
+    _Wake(pTask, 0);
+  } else {
+    pEvent->IsSet = 1;
+  }
+}
+
+/*********************************************************************
+*
+*       _TaskEntry
+*/
+static void * _TaskEntry(void * p) {
+  SIM_TASK * pTask;
+
+  pTask = (SIM_TASK *)p;
+  pthread_mutex_lock(&_Mutex);
+  while (_pCurrent != pTask) {
+    pthread_cond_wait(&pTask->Cond, &_Mutex);
+  }
+  pTask->pfTask();
+  pTask->State = TASK_STATE_DONE;
+  _Schedule();
+  pthread_mutex_unlock(&_Mutex);
+  return NULL;
+}
+
+/*********************************************************************
+*
+*       Public code, test API
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       SIM_Init
+*
+*  Function description
+*    Makes the calling thread the application task of the simulation.
+*/
+void SIM_Init(void) {
+  SIM_TASK * pTask;
+
+  pTask        = &_aTask[0];
+  pTask->sName = "App";
+  pTask->Prio  = SIM_PRIO_APP;
+  pTask->State = TASK_STATE_READY;
+  pthread_cond_init(&pTask->Cond, NULL);
+  _pCurrent = pTask;
+  _Time     = TIME_START;
+  pthread_mutex_lock(&_Mutex);
+}
+
+/*********************************************************************
+*
+*       SIM_CreateTask
+*
+*  Function description
+*    Creates a task. It runs as soon as the running task blocks
+*    and no ready task has a higher priority.
+*/
+void SIM_CreateTask(void (*pfTask)(void), const char * sName, unsigned Prio) {
+  SIM_TASK * pTask;
+
+  for (pTask = _aTask; pTask < &_aTask[MAX_TASKS]; pTask++) {
+    if (pTask->State == TASK_STATE_UNUSED) {
+      break;
+    }
+  }
+  if (pTask == &_aTask[MAX_TASKS]) {
+    fprintf(stderr, "SIM: Too many tasks\n");
+    abort();
+  }
+  pTask->pfTask = pfTask;
+  pTask->sName  = sName;
+  pTask->Prio   = Prio;
+  pTask->State  = TASK_STATE_READY;
+  pthread_cond_init(&pTask->Cond, NULL);
+  if (pthread_create(&pTask->Thread, NULL, _TaskEntry, pTask) != 0) {
+    fprintf(stderr, "SIM: Could not create thread\n");
+    abort();
+  }
+}
+
+/*********************************************************************
+*
+*       SIM_StartStack
+*
+*  Function description
+*    Initializes the stack and starts its tasks as the samples do.
+*/
+void SIM_StartStack(void) {
+  USBH_Init();
+  SIM_CreateTask(USBH_Task,    "USBH_Task",    SIM_PRIO_TIMER_TASK);
+  SIM_CreateTask(USBH_ISRTask, "USBH_ISRTask", SIM_PRIO_ISR_TASK);
+}
+
+/*********************************************************************
+*
+*       SIM_StopStack
+*
+*  Function description
+*    De-initializes the stack and waits for its tasks to terminate.
+*    The stack can be started again afterwards.
+*/
+void SIM_StopStack(void) {
+  SIM_TASK * pTask;
+
+  USBH_Exit();
+  for (pTask = &_aTask[1]; pTask < &_aTask[MAX_TASKS]; pTask++) {
+    if (pTask->State == TASK_STATE_DONE) {
+      pthread_join(pTask->Thread, NULL);
+      pthread_cond_destroy(&pTask->Cond);
+      pTask->State = TASK_STATE_UNUSED;
+    }
+  }
+}
+
+/*********************************************************************
+*
+*       SIM_GetTime
+*
+*  Function description
+*    Returns the virtual time in ms.
+*/
+USBH_TIME SIM_GetTime(void) {
+  return _Time;
+}
+
+/*********************************************************************
+*
+*       SIM_GetHostTime_ns
+*
+*  Function description
+*    Returns the time of the host in ns, used to measure the CPU
+*    time spent in the stack.
+*/
+U64 SIM_GetHostTime_ns(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (U64)ts.tv_sec * 1000000000u + (U64)ts.tv_nsec;
+}
+
+/*********************************************************************
+*
+*       SIM_WaitFor
+*
+*  Function description
+*    Lets the stack run until a condition is met.
+*
+*  Return value
+*    == 0: Condition met.
+*    == 1: Timeout (virtual time in ms).
+*/
+int SIM_WaitFor(int (*pfCond)(void * pContext), void * pContext, U32 Timeout) {
+  USBH_TIME tEnd;
+
+  tEnd = _Time + Timeout;
+  while (pfCond(pContext) == 0) {
+    if (USBH_TimeDiff(_Time, tEnd) >= 0) {
+      return 1;
+    }
+    USBH_OS_Delay(1);
+  }
+  return 0;
+}
+
+/*********************************************************************
+*
+*       Public code, OS layer
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       USBH_OS_DisableInterrupt
+*
+*  Function description
+*    Tasks are never preempted and there are no interrupts.
+*/
+void USBH_OS_DisableInterrupt(void) {
+}
+
+/*********************************************************************
+*
+*       USBH_OS_EnableInterrupt
+*/
+void USBH_OS_EnableInterrupt(void) {
+}
+
+/*********************************************************************
+*
+*       USBH_OS_Init
+*/
+void USBH_OS_Init(void) {
+  USBH_MEMSET(&_EventNet, 0, sizeof(_EventNet));
+  USBH_MEMSET(&_EventISR, 0, sizeof(_EventISR));
+  USBH_MEMSET(_aMutex, 0, sizeof(_aMutex));
+  _IsrMask = 0;
+  USBH_DLIST_Init(&_UserEventList);
+}
+
+/*********************************************************************
+*
+*       USBH_OS_DeInit
+*/
+void USBH_OS_DeInit(void) {
+  USBH_DLIST        * pEntry;
+  USBH_OS_EVENT_OBJ * pEvent;
+
+  while (USBH_DLIST_IsEmpty(&_UserEventList) == 0) {
+    pEntry = USBH_DLIST_GetNext(&_UserEventList);
+    pEvent = GET_EVENT_OBJ_FROM_ENTRY(pEntry);
+    USBH_DLIST_RemoveEntry(pEntry);
+    USBH_FREE(pEvent);
+  }
+}
+
+/*********************************************************************
+*
+*       USBH_OS_Lock
+*/
+void USBH_OS_Lock(unsigned Idx) {
+  SIM_MUTEX * pMutex;
+
+  pMutex = &_aMutex[Idx];
+  if (pMutex->pOwner == NULL) {
+    pMutex->pOwner = _pCurrent;
+    pMutex->Cnt    = 1;
+  } else if (pMutex->pOwner == _pCurrent) {
+    pMutex->Cnt++;
+  } else {
+    (void)_Block(NULL, pMutex, 0, 0);         // Ownership is passed by USBH_OS_Unlock().
+  }
+}
+
+/*********************************************************************
+*
+*       USBH_OS_Unlock
+*/
+void USBH_OS_Unlock(unsigned Idx) {
+  SIM_MUTEX * pMutex;
+  SIM_TASK  * pTask;
+
+  pMutex = &_aMutex[Idx];
+  if (pMutex->pOwner != _pCurrent || pMutex->Cnt == 0u) {
+    fprintf(stderr, "SIM: Mutex %u unlocked by %s which does not own it\n", Idx, _pCurrent->sName);
+    abort();
+  }
+  if (--pMutex->Cnt != 0u) {
+    return;
+  }
+  pTask = _FindWaiter(NULL, pMutex);
+  pMutex->pOwner = pTask;
+  if (pTask != NULL) {
+    pMutex->Cnt = 1;
+    _Wake(pTask, 0);
+  }
+}
+
+/*********************************************************************
+*
+*       USBH_OS_GetLockStat
+*/
+int USBH_OS_GetLockStat(unsigned Idx, USBH_OS_LOCK_STAT * pStat) {
+  USBH_USE_PARA(Idx);
+  USBH_MEMSET(pStat, 0, sizeof(*pStat));
+  return 1;
+}
+
+/*********************************************************************
+*
+*       USBH_OS_ResetLockStat
+*/
+void USBH_OS_ResetLockStat(void) {
+}
+
+/*********************************************************************
+*
+*       USBH_OS_GetTime32
+*/
+USBH_TIME USBH_OS_GetTime32(void) {
+  return _Time;
+}
+
+/*********************************************************************
+*
+*       USBH_OS_Delay
+*
+*  Function description
+*    Blocks the running task. A delay of 0 lets all other ready tasks run.
+*/
+void USBH_OS_Delay(unsigned ms) {
+  (void)_Block(NULL, NULL, 1, ms);
+}
+
+/*********************************************************************
+*
+*       USBH_OS_WaitNetEvent
+*/
+void USBH_OS_WaitNetEvent(unsigned ms) {
+  (void)_EventWait(&_EventNet, 1, ms);
+}
+
+/*********************************************************************
+*
+*       USBH_OS_SignalNetEvent
+*/
+void USBH_OS_SignalNetEvent(void) {
+  _EventSet(&_EventNet);
+}
+
+/*********************************************************************
+*
+*       USBH_OS_WaitISR
+*/
+U32 USBH_OS_WaitISR(void) {
+  U32 r;
+
+  (void)_EventWait(&_EventISR, 0, 0);
+  r        = _IsrMask;
+  _IsrMask = 0;
+  return r;
+}
+
+/*********************************************************************
+*
+*       USBH_OS_SignalISREx
+*/
+void USBH_OS_SignalISREx(U32 DevIndex) {
+  _IsrMask |= 1uL << DevIndex;
+  _EventSet(&_EventISR);
+}
+
+/*********************************************************************
+*
+*       USBH_OS_AllocEvent
+*/
+USBH_OS_EVENT_OBJ * USBH_OS_AllocEvent(void) {
+  USBH_OS_EVENT_OBJ * p;
+
+  p = (USBH_OS_EVENT_OBJ *)USBH_TRY_MALLOC_ZEROED(sizeof(USBH_OS_EVENT_OBJ));
+  if (p != NULL) {
+    USBH_DLIST_Init(&p->ListEntry);
+    USBH_DLIST_InsertTail(&_UserEventList, &p->ListEntry);
+  }
+  return p;
+}
+
+/*********************************************************************
+*
+*       USBH_OS_FreeEvent
+*/
+void USBH_OS_FreeEvent(USBH_OS_EVENT_OBJ * pEvent) {
+  USBH_DLIST_RemoveEntry(&pEvent->ListEntry);
+  USBH_FREE(pEvent);
+}
+
+/*********************************************************************
+*
+*       USBH_OS_SetEvent
+*/
+void USBH_OS_SetEvent(USBH_OS_EVENT_OBJ * pEvent) {
+  _EventSet(&pEvent->Event);
+}
+
+/*********************************************************************
+*
+*       USBH_OS_ResetEvent
+*/
+void USBH_OS_ResetEvent(USBH_OS_EVENT_OBJ * pEvent) {
+  pEvent->Event.IsSet = 0;
+}
+
+/*********************************************************************
+*
+*       USBH_OS_WaitEvent
+*/
+void USBH_OS_WaitEvent(USBH_OS_EVENT_OBJ * pEvent) {
+  (void)_EventWait(&pEvent->Event, 0, 0);
+}
+
+/*********************************************************************
+*
+*       USBH_OS_WaitEventTimed
+*/
+int USBH_OS_WaitEventTimed(USBH_OS_EVENT_OBJ * pEvent, U32 MilliSeconds) {
+  return (_EventWait(&pEvent->Event, 1, MilliSeconds) != 0) ? USBH_OS_EVENT_TIMEOUT : USBH_OS_EVENT_SIGNALED;
+}
+
+/*********************************************************************
+*
+*       USBH_Panic
+*
+*  Function description
+*    Called by the stack on a fatal error when USBH_DEBUG > 0.
+*/
+void USBH_Panic(const char * sError) {
+  fprintf(stderr, "USBH_Panic: %s\n", sError);
+  abort();
+}
+
+/*************************** End of file ****************************/
@@ -0,0 +1,51 @@
+/*********************************************************************
+*                                                                    *
+*       emUSB-Host * USB Host stack for embedded applications        *
+*                                                                    *
+**********************************************************************
+----------------------------------------------------------------------
+File        : USBH_OS_Sim.h
+Purpose     : Simulated RTOS for the host tests of the complete stack.
+-------------------------- END-OF-HEADER -----------------------------
+*/
+
+#ifndef USBH_OS_SIM_H_
+#define USBH_OS_SIM_H_
+
+#include "USBH.h"
+
+#if defined(__cplusplus)
+  extern "C" {                 // Make sure we have C-declarations in C++ programs
+#endif
+
+/*********************************************************************
+*
+*       Defines
+*
+**********************************************************************
+*/
+#define SIM_PRIO_APP           1u     // Priority of the task calling SIM_Init().
+#define SIM_PRIO_TIMER_TASK    2u
+#define SIM_PRIO_ISR_TASK      3u
+
+/*********************************************************************
+*
+*       API functions
+*
+**********************************************************************
+*/
+void      SIM_Init      (void);
+void      SIM_CreateTask(void (*pfTask)(void), const char * sName, unsigned Prio);
+void      SIM_StartStack(void);
+void      SIM_StopStack (void);
+USBH_TIME SIM_GetTime   (void);
+U64       SIM_GetHostTime_ns(void);
+int       SIM_WaitFor   (int (*pfCond)(void * pContext), void * pContext, U32 Timeout);
+
+#if defined(__cplusplus)
+  }
+#endif
+
+#endif // USBH_OS_SIM_H_
+
+/*************************** End of file ****************************/
@@ -0,0 +1,492 @@
+/*********************************************************************
+*                                                                    *
+*       emUSB-Host * USB Host stack for embedded applications        *
+*                                                                    *
+**********************************************************************
+----------------------------------------------------------------------
+File        : USBH_TimerWheelTest.c
+Purpose     : Host test of the timing wheel of the USBH timer task.
+              USBH_Task() runs against a virtual millisecond clock:
+              USBH_OS_WaitNetEvent() advances the clock up to the
+              requested timeout or up to the next scripted operation,
+              whatever comes first. The operations start, restart,
+              cancel and release timers at random with timeouts up to
+              100 s and every expiration is checked against a model.
+              The clock starts shortly before the 32-bit wrap-around.
+              At the end the host time per timer is reported for a
+              growing number of active timers.
+-------------------------- END-OF-HEADER -----------------------------
+*/
+
+/*********************************************************************
+*
+*       #include Section
+*
+**********************************************************************
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "USBH_Int.h"
+#include "test_check.h"
+
+/*********************************************************************
+*
+*       Defines, configurable
+*
+**********************************************************************
+*/
+#define NUM_TIMERS              512u
+#define NUM_OPS                 200000u
+#define MAX_OP_INTERVAL_MS      40u           // Max. virtual time between two scripted operations.
+#define MAX_LAG_ZERO_MS         1u            // A timeout of 0 started after the current tick has been processed expires with the next tick.
+#define TIME_START              (0xFFFFFFFFuL - 300000uL)
+#define MAX_BENCH_TIMERS        16384u
+
+/*********************************************************************
+*
+*       Types
+*
+**********************************************************************
+*/
+typedef struct {
+  USBH_TIMER Timer;
+  U32        Expiration;              // Expected expiration time, valid if IsActive != 0.
+  U32        Timeout;
+  U8         IsActive;
+  U8         IsInitialized;
+  U32        NumRepeats;              // Number of restarts from within the handler.
+  U32        Period;
+  U32        NumExpired;
+} TEST_TIMER;
+
+typedef void WAIT_FUNC(unsigned ms);
+
+/*********************************************************************
+*
+*       Static data
+*
+**********************************************************************
+*/
+static USBH_TIME    _Time;
+static U32          _Rand = 0x12345678u;
+static unsigned     _aLockCnt[USBH_MUTEX_COUNT];
+static U32          _NumLockErrors;
+static U32          _NumSignals;
+static U32          _NumWakeups;
+static WAIT_FUNC  * _pfWait;
+//
+// Random operations.
+//
+static TEST_TIMER   _aTimer[NUM_TIMERS];
+static U32          _NumActive;
+static U32          _NumOps;
+static USBH_TIME    _NextOpTime;
+static U32          _NumEarly;
+static U32          _NumLate;
+static U32          _NumUnexpected;
+static U32          _NumExpired;
+static U32          _MaxLag;
+//
+// Benchmark.
+//
+static USBH_TIMER * _paBenchTimer;
+static U32          _NumBenchExpired;
+
+/*********************************************************************
+*
+*       Static code
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _GetTime_ns
+*/
+static U64 _GetTime_ns(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (U64)ts.tv_sec * 1000000000u + (U64)ts.tv_nsec;
+}
+
+/*********************************************************************
+*
+*       _GetRand
+*/
+static U32 _GetRand(void) {
+  _Rand = _Rand * 1103515245u + 12345u;
+  return _Rand >> 8;
+}
+
+/*********************************************************************
+*
+*       _GetRandTimeout
+*
+*  Function description
+*    Returns a timeout with a distribution similar to the one of the
+*    stack: mostly short timeouts, some in the range of seconds and
+*    a few beyond the range of the lower levels of the wheel.
+*/
+static U32 _GetRandTimeout(void) {
+  U32 r;
+
+  r = _GetRand() % 100u;
+  if (r < 60u) {
+    return _GetRand() % 100u;
+  }
+  if (r < 90u) {
+    return _GetRand() % 5000u;
+  }
+  return _GetRand() % 100001u;
+}
+
+/*********************************************************************
+*
+*       _Start
+*/
+static void _Start(TEST_TIMER * pTest, U32 ms) {
+  if (pTest->IsActive == 0u) {
+    _NumActive++;
+  }
+  pTest->IsActive   = 1;
+  pTest->Expiration = USBH_TimeAdd(_Time, ms);
+  pTest->Timeout    = ms;
+  USBH_StartTimer(&pTest->Timer, ms);
+}
+
+/*********************************************************************
+*
+*       _cbOnTimer
+*/
+static void _cbOnTimer(void * pContext) {
+  TEST_TIMER * pTest;
+  I32          Lag;
+
+  pTest = (TEST_TIMER *)pContext;
+  if (_aLockCnt[USBH_MUTEX_TIMER] != 0u) {
+    _NumLockErrors++;                         // Handlers must be called with the timer mutex unlocked.
+  }
+  if (pTest->IsActive == 0u) {
+    _NumUnexpected++;                         // Cancelled, released or already expired.
+    return;
+  }
+  //
+  // The virtual clock never overshoots, so timers have to expire exactly on time.
+  //
+  Lag = USBH_TimeDiff(_Time, pTest->Expiration);
+  if (Lag < 0) {
+    _NumEarly++;
+  } else if ((U32)Lag > ((pTest->Timeout == 0u) ? MAX_LAG_ZERO_MS : 0u)) {
+    _NumLate++;
+  }
+  if (Lag > 0 && (U32)Lag > _MaxLag) {
+    _MaxLag = (U32)Lag;
+  }
+  TEST_CHECK_EQ(USBH_IsTimerActive(&pTest->Timer), 0);
+  pTest->IsActive = 0;
+  pTest->NumExpired++;
+  _NumActive--;
+  _NumExpired++;
+  if (pTest->NumRepeats != 0u) {
+    pTest->NumRepeats--;
+    _Start(pTest, pTest->Period);             // Restart from within the handler.
+  }
+}
+
+/*********************************************************************
+*
+*       _DoRandomOp
+*/
+static void _DoRandomOp(void) {
+  TEST_TIMER * pTest;
+  U32          r;
+
+  pTest = &_aTimer[_GetRand() % NUM_TIMERS];
+  if (pTest->IsInitialized == 0u) {
+    USBH_InitTimer(&pTest->Timer, _cbOnTimer, pTest);
+    pTest->IsInitialized = 1;
+  }
+  r = _GetRand() % 100u;
+  if (r < 55u) {
+    //
+    // Start or restart.
+    //
+    pTest->NumRepeats = 0;
+    if ((_GetRand() % 8u) == 0u) {
+      pTest->NumRepeats = 1u + _GetRand() % 20u;
+      pTest->Period     = _GetRand() % 50u;
+    }
+    _Start(pTest, _GetRandTimeout());
+  } else if (r < 90u) {
+    USBH_CancelTimer(&pTest->Timer);
+    if (pTest->IsActive != 0u) {
+      _NumActive--;
+    }
+    pTest->IsActive = 0;
+  } else {
+    USBH_ReleaseTimer(&pTest->Timer);
+    if (pTest->IsActive != 0u) {
+      _NumActive--;
+    }
+    pTest->IsActive      = 0;
+    pTest->IsInitialized = 0;
+  }
+  TEST_CHECK_EQ(USBH_IsTimerActive(&pTest->Timer) != 0, pTest->IsActive != 0u);
+}
+
+/*********************************************************************
+*
+*       _WaitRandomOps
+*
+*  Function description
+*    Advances the virtual clock up to the timeout requested by the
+*    timer task or up to the next operation and performs it.
+*/
+static void _WaitRandomOps(unsigned ms) {
+  I32 TimeToOp;
+
+  if (_NumOps < NUM_OPS) {
+    TimeToOp = USBH_TimeDiff(_NextOpTime, _Time);
+    if (TimeToOp <= (I32)ms) {
+      _Time = _NextOpTime;
+      _DoRandomOp();
+      _NumOps++;
+      _NextOpTime = USBH_TimeAdd(_Time, _GetRand() % (MAX_OP_INTERVAL_MS + 1u));
+      return;
+    }
+  } else if (_NumActive == 0u) {
+    USBH_Global.IsRunning = 0;                // All operations done and all timers expired.
+    return;
+  }
+  _Time = USBH_TimeAdd(_Time, ms);
+}
+
+/*********************************************************************
+*
+*       _cbOnBenchTimer
+*/
+static void _cbOnBenchTimer(void * pContext) {
+  USBH_USE_PARA(pContext);
+  _NumBenchExpired++;
+}
+
+/*********************************************************************
+*
+*       _WaitBench
+*/
+static void _WaitBench(unsigned ms) {
+  if (_NumBenchExpired == _NumActive) {
+    USBH_Global.IsRunning = 0;
+    return;
+  }
+  _Time = USBH_TimeAdd(_Time, ms);
+}
+
+/*********************************************************************
+*
+*       _RunBench
+*
+*  Function description
+*    Starts the given number of timers with random timeouts up to
+*    100 s and lets all of them expire. Reports the host time per
+*    timer for starting, cancelling and expiring.
+*/
+static void _RunBench(U32 NumTimers) {
+  U64 t0;
+  U64 tStart;
+  U64 tCancel;
+  U64 tExpire;
+  U32 i;
+
+  for (i = 0; i < NumTimers; ++i) {
+    USBH_InitTimer(&_paBenchTimer[i], _cbOnBenchTimer, NULL);
+  }
+  //
+  // Start and cancel.
+  //
+  t0 = _GetTime_ns();
+  for (i = 0; i < NumTimers; ++i) {
+    USBH_StartTimer(&_paBenchTimer[i], _GetRandTimeout());
+  }
+  tStart = _GetTime_ns() - t0;
+  t0 = _GetTime_ns();
+  for (i = 0; i < NumTimers; ++i) {
+    USBH_CancelTimer(&_paBenchTimer[i]);
+  }
+  tCancel = _GetTime_ns() - t0;
+  //
+  // Start again and let all of them expire.
+  //
+  for (i = 0; i < NumTimers; ++i) {
+    USBH_StartTimer(&_paBenchTimer[i], _GetRandTimeout());
+  }
+  _NumBenchExpired      = 0;
+  _NumActive            = NumTimers;
+  _NumWakeups           = 0;
+  _pfWait               = _WaitBench;
+  USBH_Global.IsRunning = 1;
+  t0 = _GetTime_ns();
+  USBH_Task();
+  tExpire = _GetTime_ns() - t0;
+  TEST_CHECK_EQ(_NumBenchExpired, NumTimers);
+  for (i = 0; i < NumTimers; ++i) {
+    USBH_ReleaseTimer(&_paBenchTimer[i]);
+  }
+  printf("  %6lu timers: start %6.1f ns, cancel %6.1f ns, expire %6.1f ns per timer, %6lu wake-ups\n",
+         (unsigned long)NumTimers,
+         (double)tStart  / (double)NumTimers,
+         (double)tCancel / (double)NumTimers,
+         (double)tExpire / (double)NumTimers,
+         (unsigned long)_NumWakeups);
+}
+
+/*********************************************************************
+*
+*       Public code, stack environment
+*
+*  The timer test does not use host controllers, devices or memory
+*  allocation, the remaining functions referenced by USBH_Core.c
+*  do nothing.
+*
+**********************************************************************
+*/
+void   USBH_X_Config                           (void)                                    { }
+void   USBH_ClearEnumDescCache                 (void)                                    { }
+void   USBH_CleanupDeviceList                  (void)                                    { }
+void   USBH_LockDeviceList                     (USBH_HOST_CONTROLLER * pHost)            { USBH_USE_PARA(pHost); }
+void   USBH_UnlockDeviceList                   (USBH_HOST_CONTROLLER * pHost)            { USBH_USE_PARA(pHost); }
+void   USBH_PNP_NotifyWrapperCallbackRoutine   (void * pContext)                         { USBH_USE_PARA(pContext); }
+void   USBH_RemoveHostController               (USBH_HOST_CONTROLLER * pHostController)  { USBH_USE_PARA(pHostController); }
+void   USBH_StartHostController                (USBH_HOST_CONTROLLER * pHostController)  { USBH_USE_PARA(pHostController); }
+void   USBH_UnregisterAllEnumErrorNotifications(void)                                    { }
+void   USBH_Free                               (void * pMemBlock)                        { free(pMemBlock); }
+void * USBH_TryMallocZeroed                    (U32 Size)                                { return calloc(1, Size); }
+
+/*********************************************************************
+*
+*       Public code, OS layer
+*
+**********************************************************************
+*/
+void USBH_OS_Init(void) {
+  _Time = TIME_START;
+}
+
+void USBH_OS_DeInit(void) {
+}
+
+USBH_TIME USBH_OS_GetTime32(void) {
+  return _Time;
+}
+
+void USBH_OS_Delay(unsigned ms) {
+  _Time = USBH_TimeAdd(_Time, ms);
+}
+
+void USBH_OS_Lock(unsigned Idx) {
+  if (_aLockCnt[Idx] != 0u) {
+    _NumLockErrors++;                         // The stack never locks a mutex recursively.
+  }
+  _aLockCnt[Idx]++;
+}
+
+void USBH_OS_Unlock(unsigned Idx) {
+  if (_aLockCnt[Idx] == 0u) {
+    _NumLockErrors++;
+    return;
+  }
+  _aLockCnt[Idx]--;
+}
+
+void USBH_OS_WaitNetEvent(unsigned ms) {
+  if (_aLockCnt[USBH_MUTEX_TIMER] != 0u) {
+    _NumLockErrors++;
+  }
+  _NumWakeups++;
+  _pfWait(ms);
+}
+
+void USBH_OS_SignalNetEvent(void) {
+  _NumSignals++;
+}
+
+U32 USBH_OS_WaitISR(void) {
+  return 0;
+}
+
+void USBH_OS_SignalISREx(U32 DevIndex) {
+  USBH_USE_PARA(DevIndex);
+}
+
+void USBH_OS_WaitEvent(USBH_OS_EVENT_OBJ * pEvent) {
+  USBH_USE_PARA(pEvent);
+}
+
+int USBH_OS_WaitEventTimed(USBH_OS_EVENT_OBJ * pEvent, U32 milliSeconds) {
+  USBH_USE_PARA(pEvent);
+  USBH_USE_PARA(milliSeconds);
+  return 0;
+}
+
+/*********************************************************************
+*
+*       Public code, test
+*
+**********************************************************************
+*/
+int main(void) {
+  U32 NumTimers;
+  U32 NumExpiredTotal;
+  U32 i;
+  U64 t0;
+
+  USBH_Init();
+  TEST_CHECK_EQ(_Time, TIME_START);
+  //
+  // Random operations, checked against the model.
+  //
+  _pfWait     = _WaitRandomOps;
+  _NextOpTime = _Time;
+  t0 = _GetTime_ns();
+  USBH_Task();
+  t0 = _GetTime_ns() - t0;
+  TEST_CHECK_EQ(_NumOps, NUM_OPS);
+  TEST_CHECK_EQ(_NumActive, 0u);
+  TEST_CHECK_EQ(_NumEarly, 0u);
+  TEST_CHECK_EQ(_NumLate, 0u);
+  TEST_CHECK_EQ(_NumUnexpected, 0u);
+  TEST_CHECK_EQ(_NumLockErrors, 0u);
+  TEST_CHECK(USBH_TimeDiff(_Time, TIME_START) > 0);
+  TEST_CHECK(_Time < TIME_START);                       // The 32-bit clock has wrapped around.
+  NumExpiredTotal = 0;
+  for (i = 0; i < NUM_TIMERS; ++i) {
+    if (_aTimer[i].IsInitialized != 0u) {
+      TEST_CHECK_EQ(USBH_IsTimerActive(&_aTimer[i].Timer), 0);
+    }
+    NumExpiredTotal += _aTimer[i].NumExpired;
+  }
+  TEST_CHECK_EQ(NumExpiredTotal, _NumExpired);
+  TEST_CHECK(_NumExpired != 0u);
+  printf("Random operations: %lu ops, %lu expirations, %lu wake-ups, %lu signals, max. lag %lu ms, %.1f s virtual in %.1f ms\n",
+         (unsigned long)_NumOps, (unsigned long)_NumExpired, (unsigned long)_NumWakeups, (unsigned long)_NumSignals,
+         (unsigned long)_MaxLag, (double)(U32)(_Time - TIME_START) / 1000.0, (double)t0 / 1e6);
+  //
+  // Host time per timer for a growing number of active timers.
+  // With the timing wheel the cost per timer does not depend on the number of timers.
+  //
+  printf("Timer cost on the host:\n");
+  _paBenchTimer = (USBH_TIMER *)calloc(MAX_BENCH_TIMERS, sizeof(USBH_TIMER));
+  if (_paBenchTimer != NULL) {
+    for (NumTimers = 64u; NumTimers <= MAX_BENCH_TIMERS; NumTimers *= 4u) {
+      _RunBench(NumTimers);
+    }
+    free(_paBenchTimer);
+  }
+  TEST_CHECK_EQ(_NumLockErrors, 0u);
+  return TEST_Report("USBH_TimerWheelTest");
+}
+
+/*************************** End of file ****************************/
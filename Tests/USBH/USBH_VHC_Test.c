@@ -0,0 +1,845 @@
+/*********************************************************************
+*                                                                    *
+*       emUSB-Host * USB Host stack for embedded applications        *
+*                                                                    *
+**********************************************************************
+----------------------------------------------------------------------
+File        : USBH_VHC_Test.c
+Purpose     : Host test of the class drivers on the virtual host
+              controller. The complete stack runs on the simulated
+              RTOS of USBH_OS_Sim.c against the device models of
+              USBH_HW_VirtualDevices.c:
+              * MSD disk backed by a temporary file on the root hub,
+              * CDC loopback and FT232 loopback on the root hub,
+              * a hub with an MSD, a CDC and an FT232 device behind it.
+              Data is written and read back with transfer latencies
+              of 0, 1 and 2 ms and with injected transfer errors.
+              Reported are the enumeration times, the throughput on
+              the virtual clock and the host CPU time per MByte spent
+              in the stack.
+-------------------------- END-OF-HEADER -----------------------------
+*/
+
+/*********************************************************************
+*
+*       #include Section
+*
+**********************************************************************
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "USBH_Int.h"
+#include "USBH_MSD.h"
+#include "USBH_CDC.h"
+#include "USBH_FT232.h"
+#include "USBH_HW_Virtual.h"
+#include "USBH_OS_Sim.h"
+#include "test_check.h"
+
+/*********************************************************************
+*
+*       Defines, configurable
+*
+**********************************************************************
+*/
+#define POOL_SIZE               (2u * 1024u * 1024u)
+#define BYTES_PER_SECTOR        512u
+#define MSD_NUM_SECTORS         4096u       // 2 MByte disk.
+#define MSD_TEST_SECTORS        2048u       // 1 MByte written and read per run.
+#define MSD_SECTORS_PER_CMD     64u
+#define SERIAL_TEST_BYTES       (64u * 1024u)
+#define SERIAL_CHUNK_SIZE       1024u
+#define ENUM_TIMEOUT            10000u      // Virtual ms.
+#define MAX_DEVICES             4u
+
+/*********************************************************************
+*
+*       Defines, fixed
+*
+**********************************************************************
+*/
+#define PORT_MSD                1u
+#define PORT_HUB                2u
+#define PORT_CDC                3u
+#define PORT_FT232              4u
+
+#define EP_CONTROL              0x00u
+#define EP_BULK_IN              0x81u
+#define EP_BULK_OUT             0x02u
+
+/*********************************************************************
+*
+*       Types
+*
+**********************************************************************
+*/
+typedef struct {
+  FILE * pFile;
+} DISK;
+
+typedef struct {
+  U8     aIsPresent[MAX_DEVICES];
+  U32    NumAdded;
+  U32    NumRemoved;
+} DEV_LIST;
+
+typedef USBH_STATUS SERIAL_WRITE_FUNC(U32 hDevice, const U8 * pData, U32 NumBytes, U32 * pNumBytesWritten);
+typedef USBH_STATUS SERIAL_READ_FUNC (U32 hDevice,       U8 * pData, U32 NumBytes, U32 * pNumBytesRead);
+
+typedef struct {
+  const char         * sName;
+  SERIAL_WRITE_FUNC  * pfWrite;
+  SERIAL_READ_FUNC   * pfRead;
+  U32                  hDevice;
+} SERIAL;
+
+/*********************************************************************
+*
+*       Static data
+*
+**********************************************************************
+*/
+static U32      _aPool[POOL_SIZE / sizeof(U32)];
+static U8       _aWrite[MSD_TEST_SECTORS * BYTES_PER_SECTOR];
+static U8       _aRead[MSD_TEST_SECTORS * BYTES_PER_SECTOR];
+static DEV_LIST _MSD;
+static DEV_LIST _CDC;
+static DEV_LIST _FT232;
+static USBH_NOTIFICATION_HOOK _CDCHook;
+static USBH_NOTIFICATION_HOOK _FT232Hook;
+
+/*********************************************************************
+*
+*       Static code, disk image
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _DISK_Read
+*/
+static int _DISK_Read(void * pContext, U32 SectorIndex, void * pData, U32 NumSectors) {
+  DISK * pDisk;
+
+  pDisk = (DISK *)pContext;
+  if (fseek(pDisk->pFile, (long)SectorIndex * (long)BYTES_PER_SECTOR, SEEK_SET) != 0) {
+    return 1;
+  }
+  return (fread(pData, BYTES_PER_SECTOR, NumSectors, pDisk->pFile) == NumSectors) ? 0 : 1;
+}
+
+/*********************************************************************
+*
+*       _DISK_Write
+*/
+static int _DISK_Write(void * pContext, U32 SectorIndex, const void * pData, U32 NumSectors) {
+  DISK * pDisk;
+
+  pDisk = (DISK *)pContext;
+  if (fseek(pDisk->pFile, (long)SectorIndex * (long)BYTES_PER_SECTOR, SEEK_SET) != 0) {
+    return 1;
+  }
+  return (fwrite(pData, BYTES_PER_SECTOR, NumSectors, pDisk->pFile) == NumSectors) ? 0 : 1;
+}
+
+/*********************************************************************
+*
+*       _CreateMSD
+*
+*  Function description
+*    Creates a simulated mass storage device backed by a temporary file.
+*/
+static USBH_VHC_DEVICE * _CreateMSD(DISK * pDisk) {
+  USBH_VHC_MSD_STORAGE Storage;
+  static U8            _aZero[BYTES_PER_SECTOR];
+  U32                  i;
+
+  pDisk->pFile = tmpfile();
+  if (pDisk->pFile == NULL) {
+    return NULL;
+  }
+  for (i = 0; i < MSD_NUM_SECTORS; i++) {
+    (void)fwrite(_aZero, sizeof(_aZero), 1, pDisk->pFile);
+  }
+  memset(&Storage, 0, sizeof(Storage));
+  Storage.pfRead         = _DISK_Read;
+  Storage.pfWrite        = _DISK_Write;
+  Storage.pContext       = pDisk;
+  Storage.NumSectors     = MSD_NUM_SECTORS;
+  Storage.BytesPerSector = BYTES_PER_SECTOR;
+  return USBH_VHC_CreateMSD(&Storage);
+}
+
+/*********************************************************************
+*
+*       Static code, notifications
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _OnDevEvent
+*/
+static void _OnDevEvent(DEV_LIST * pList, U8 DevIndex, int IsAdded) {
+  if (DevIndex >= MAX_DEVICES) {
+    TEST_CHECK(DevIndex < MAX_DEVICES);
+    return;
+  }
+  pList->aIsPresent[DevIndex] = (U8)IsAdded;
+  if (IsAdded != 0) {
+    pList->NumAdded++;
+  } else {
+    pList->NumRemoved++;
+  }
+}
+
+static void _cbOnMSD(void * pContext, U8 DevIndex, USBH_MSD_EVENT Event) {
+  USBH_USE_PARA(pContext);
+  if (Event != USBH_MSD_EVENT_ERROR) {
+    _OnDevEvent(&_MSD, DevIndex, (Event == USBH_MSD_EVENT_ADD) ? 1 : 0);
+  }
+}
+
+static void _cbOnCDC(void * pContext, U8 DevIndex, USBH_DEVICE_EVENT Event) {
+  USBH_USE_PARA(pContext);
+  _OnDevEvent(&_CDC, DevIndex, (Event == USBH_DEVICE_EVENT_ADD) ? 1 : 0);
+}
+
+static void _cbOnFT232(void * pContext, U8 DevIndex, USBH_DEVICE_EVENT Event) {
+  USBH_USE_PARA(pContext);
+  _OnDevEvent(&_FT232, DevIndex, (Event == USBH_DEVICE_EVENT_ADD) ? 1 : 0);
+}
+
+/*********************************************************************
+*
+*       _GetNumPresent
+*/
+static unsigned _GetNumPresent(const DEV_LIST * pList) {
+  unsigned i;
+  unsigned n;
+
+  n = 0;
+  for (i = 0; i < MAX_DEVICES; i++) {
+    n += pList->aIsPresent[i];
+  }
+  return n;
+}
+
+/*********************************************************************
+*
+*       _GetDevIndex
+*
+*  Function description
+*    Returns the index of the n-th present device of a list.
+*/
+static int _GetDevIndex(const DEV_LIST * pList, unsigned n) {
+  unsigned i;
+
+  for (i = 0; i < MAX_DEVICES; i++) {
+    if (pList->aIsPresent[i] != 0u) {
+      if (n-- == 0u) {
+        return (int)i;
+      }
+    }
+  }
+  return -1;
+}
+
+/*********************************************************************
+*
+*       _IsNumAdded
+*/
+static int _IsNumAdded(void * pContext) {
+  const DEV_LIST * pList;
+
+  pList = (const DEV_LIST *)pContext;
+  return (pList->NumAdded != 0u) ? 1 : 0;
+}
+
+/*********************************************************************
+*
+*       _WaitAdded
+*
+*  Function description
+*    Connects a device and waits for the class driver to report it.
+*
+*  Return value
+*    Enumeration time in virtual ms, ENUM_TIMEOUT on timeout.
+*/
+static U32 _WaitAdded(DEV_LIST * pList, unsigned Port, USBH_VHC_DEVICE * pDev) {
+  USBH_TIME t;
+  int       r;
+
+  pList->NumAdded = 0;
+  t = SIM_GetTime();
+  TEST_CHECK_EQ(USBH_VHC_Connect(Port, pDev), USBH_STATUS_SUCCESS);
+  r = SIM_WaitFor(_IsNumAdded, pList, ENUM_TIMEOUT);
+  TEST_CHECK_EQ(r, 0);
+  return (r == 0) ? (U32)(SIM_GetTime() - t) : ENUM_TIMEOUT;
+}
+
+/*********************************************************************
+*
+*       _IsNoDeviceConnected
+*/
+static int _IsNoDeviceConnected(void * pContext) {
+  USBH_USE_PARA(pContext);
+  return (USBH_GetNumDevicesConnected(0) == 0) ? 1 : 0;
+}
+
+/*********************************************************************
+*
+*       _WaitRemoved
+*
+*  Function description
+*    Waits until the stack has released all devices after a disconnect.
+*    The device objects are deleted after the class drivers closed
+*    their interfaces, which may take longer than the REMOVE event.
+*
+*  Return value
+*    Time in virtual ms.
+*/
+static U32 _WaitRemoved(void) {
+  USBH_TIME t;
+
+  t = SIM_GetTime();
+  TEST_CHECK_EQ(SIM_WaitFor(_IsNoDeviceConnected, NULL, ENUM_TIMEOUT), 0);
+  return (U32)(SIM_GetTime() - t);
+}
+
+/*********************************************************************
+*
+*       Static code, mass storage
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _FillPattern
+*/
+static void _FillPattern(U8 * p, U32 NumBytes, U32 Seed) {
+  U32 i;
+
+  for (i = 0; i < NumBytes; i++) {
+    Seed = Seed * 1103515245u + 12345u;
+    p[i] = (U8)(Seed >> 16);
+  }
+}
+
+/*********************************************************************
+*
+*       _MSD_Transfer
+*
+*  Function description
+*    Writes or reads NumSectors in commands of MSD_SECTORS_PER_CMD.
+*    A failing command is repeated up to 3 times.
+*
+*  Return value
+*    Number of commands that had to be repeated.
+*/
+static U32 _MSD_Transfer(U8 Unit, U32 NumSectors, int IsWrite) {
+  USBH_STATUS Status;
+  U32         i;
+  U32         NumRetries;
+  unsigned    Try;
+
+  NumRetries = 0;
+  for (i = 0; i < NumSectors; i += MSD_SECTORS_PER_CMD) {
+    for (Try = 0; Try < 4u; Try++) {
+      if (IsWrite != 0) {
+        Status = USBH_MSD_WriteSectors(Unit, i, MSD_SECTORS_PER_CMD, &_aWrite[i * BYTES_PER_SECTOR]);
+      } else {
+        Status = USBH_MSD_ReadSectors(Unit, i, MSD_SECTORS_PER_CMD, &_aRead[i * BYTES_PER_SECTOR]);
+      }
+      if (Status == USBH_STATUS_SUCCESS) {
+        break;
+      }
+      NumRetries++;
+    }
+    TEST_CHECK_EQ(Status, USBH_STATUS_SUCCESS);
+  }
+  return NumRetries;
+}
+
+/*********************************************************************
+*
+*       _MSD_Run
+*
+*  Function description
+*    Writes a pattern to the unit, reads it back and reports the
+*    virtual time and the host time.
+*/
+static void _MSD_Run(const char * sName, U8 Unit, U32 NumSectors, U32 Latency, const USBH_VHC_ERROR_INJECTION * pErr) {
+  USBH_VHC_STAT Stat;
+  USBH_TIME     t0;
+  U32           tWrite;
+  U32           tRead;
+  U64           tHost;
+  U32           NumRetries;
+  U32           NumBytes;
+
+  NumBytes = NumSectors * BYTES_PER_SECTOR;
+  _FillPattern(_aWrite, NumBytes, Latency + Unit);
+  memset(_aRead, 0, NumBytes);
+  USBH_VHC_SetLatency(Latency);
+  USBH_VHC_ResetStat();
+  tHost = SIM_GetHostTime_ns();
+  t0    = SIM_GetTime();
+  NumRetries = _MSD_Transfer(Unit, NumSectors, 1);
+  tWrite = (U32)(SIM_GetTime() - t0);
+  USBH_VHC_SetErrorInjection(pErr);
+  t0     = SIM_GetTime();
+  NumRetries += _MSD_Transfer(Unit, NumSectors, 0);
+  tRead  = (U32)(SIM_GetTime() - t0);
+  USBH_VHC_SetErrorInjection(NULL);
+  tHost  = SIM_GetHostTime_ns() - tHost;
+  USBH_VHC_GetStat(&Stat);
+  TEST_CHECK(memcmp(_aWrite, _aRead, NumBytes) == 0);
+  TEST_CHECK_EQ(Stat.NumBytesIn  >= NumBytes, 1);
+  TEST_CHECK_EQ(Stat.NumBytesOut >= NumBytes, 1);
+  if (pErr != NULL) {
+    TEST_CHECK(Stat.NumErrorsInjected > 0u);
+    TEST_CHECK_EQ(NumRetries, Stat.NumErrorsInjected);    // Each failed CBW fails one command, which is repeated.
+  }
+  printf("%-26s latency %u ms: write %5u ms, read %5u ms (%6.0f KB/s), %5u transfers, %3u errors injected, host %6.1f ms/MB\n",
+         sName, (unsigned)Latency, (unsigned)tWrite, (unsigned)tRead,
+         (tRead != 0u) ? (double)NumBytes / (double)tRead * 1000.0 / 1024.0 : 0.0,
+         (unsigned)Stat.NumTransfers, (unsigned)Stat.NumErrorsInjected,
+         (double)tHost / 1e6 / (2.0 * (double)NumBytes / (1024.0 * 1024.0)));
+}
+
+/*********************************************************************
+*
+*       _GetMSDUnit
+*
+*  Function description
+*    Returns the first unit of the n-th mass storage device.
+*/
+static int _GetMSDUnit(unsigned n) {
+  U32 UnitMask;
+  int DevIndex;
+  int Unit;
+
+  DevIndex = _GetDevIndex(&_MSD, n);
+  if (DevIndex < 0 || USBH_MSD_GetUnits((U8)DevIndex, &UnitMask) != USBH_STATUS_SUCCESS || UnitMask == 0u) {
+    return -1;
+  }
+  for (Unit = 0; (UnitMask & 1u) == 0u; Unit++) {
+    UnitMask >>= 1;
+  }
+  return Unit;
+}
+
+/*********************************************************************
+*
+*       Static code, serial devices
+*
+**********************************************************************
+*/
+static USBH_STATUS _CDC_Write  (U32 h, const U8 * p, U32 n, U32 * pn) { return USBH_CDC_Write(h, p, n, pn);   }
+static USBH_STATUS _CDC_Read   (U32 h,       U8 * p, U32 n, U32 * pn) { return USBH_CDC_Read(h, p, n, pn);    }
+static USBH_STATUS _FT232_Write(U32 h, const U8 * p, U32 n, U32 * pn) { return USBH_FT232_Write(h, p, n, pn); }
+static USBH_STATUS _FT232_Read (U32 h,       U8 * p, U32 n, U32 * pn) { return USBH_FT232_Read(h, p, n, pn);  }
+
+/*********************************************************************
+*
+*       _SERIAL_Loopback
+*
+*  Function description
+*    Sends data in chunks to a loopback device and reads it back.
+*    Transfers which fail are continued where they stopped.
+*
+*  Return value
+*    Number of failed write and read calls.
+*/
+static U32 _SERIAL_Loopback(const SERIAL * pSerial, U32 NumBytes) {
+  USBH_STATUS Status;
+  U32         Pos;
+  U32         NumBytesChunk;
+  U32         NumBytesDone;
+  U32         n;
+  U32         NumErrors;
+  unsigned    Try;
+
+  NumErrors = 0;
+  for (Pos = 0; Pos < NumBytes; Pos += NumBytesChunk) {
+    NumBytesChunk = USBH_MIN(SERIAL_CHUNK_SIZE, NumBytes - Pos);
+    NumBytesDone  = 0;
+    for (Try = 0; Try < 8u && NumBytesDone < NumBytesChunk; Try++) {
+      n      = 0;
+      Status = pSerial->pfWrite(pSerial->hDevice, &_aWrite[Pos + NumBytesDone], NumBytesChunk - NumBytesDone, &n);
+      NumBytesDone += n;
+      if (Status != USBH_STATUS_SUCCESS) {
+        NumErrors++;
+      }
+    }
+    TEST_CHECK_EQ(NumBytesDone, NumBytesChunk);
+    NumBytesDone = 0;
+    for (Try = 0; Try < 8u && NumBytesDone < NumBytesChunk; Try++) {
+      n      = 0;
+      Status = pSerial->pfRead(pSerial->hDevice, &_aRead[Pos + NumBytesDone], NumBytesChunk - NumBytesDone, &n);
+      NumBytesDone += n;
+      if (Status != USBH_STATUS_SUCCESS) {
+        NumErrors++;
+      }
+    }
+    TEST_CHECK_EQ(NumBytesDone, NumBytesChunk);
+  }
+  return NumErrors;
+}
+
+/*********************************************************************
+*
+*       _SERIAL_Run
+*/
+static void _SERIAL_Run(const SERIAL * pSerial, U32 NumBytes, U32 Latency, const USBH_VHC_ERROR_INJECTION * pErr) {
+  USBH_VHC_STAT Stat;
+  USBH_TIME     t0;
+  U32           t;
+  U64           tHost;
+  U32           NumErrors;
+
+  _FillPattern(_aWrite, NumBytes, NumBytes + Latency);
+  memset(_aRead, 0, NumBytes);
+  USBH_VHC_SetLatency(Latency);
+  USBH_VHC_ResetStat();
+  USBH_VHC_SetErrorInjection(pErr);
+  tHost     = SIM_GetHostTime_ns();
+  t0        = SIM_GetTime();
+  NumErrors = _SERIAL_Loopback(pSerial, NumBytes);
+  t         = (U32)(SIM_GetTime() - t0);
+  tHost     = SIM_GetHostTime_ns() - tHost;
+  USBH_VHC_SetErrorInjection(NULL);
+  USBH_VHC_GetStat(&Stat);
+  TEST_CHECK(memcmp(_aWrite, _aRead, NumBytes) == 0);
+  if (pErr != NULL) {
+    TEST_CHECK(Stat.NumErrorsInjected > 0u);
+    TEST_CHECK(NumErrors > 0u);
+  } else {
+    TEST_CHECK_EQ(NumErrors, 0u);
+  }
+  printf("%-26s latency %u ms: loopback %5u ms (%6.0f KB/s), %5u transfers, %5u NAKs, %3u errors injected, %3u calls failed, host %6.1f ms/MB\n",
+         pSerial->sName, (unsigned)Latency, (unsigned)t,
+         (t != 0u) ? (double)NumBytes / (double)t * 1000.0 / 1024.0 : 0.0,
+         (unsigned)Stat.NumTransfers, (unsigned)Stat.NumNAKs, (unsigned)Stat.NumErrorsInjected, (unsigned)NumErrors,
+         (double)tHost / 1e6 / ((double)NumBytes / (1024.0 * 1024.0)));
+}
+
+/*********************************************************************
+*
+*       _OpenCDC
+*/
+static int _OpenCDC(SERIAL * pSerial, unsigned n, const char * sName) {
+  int DevIndex;
+
+  DevIndex = _GetDevIndex(&_CDC, n);
+  if (DevIndex < 0) {
+    return 1;
+  }
+  pSerial->sName   = sName;
+  pSerial->pfWrite = _CDC_Write;
+  pSerial->pfRead  = _CDC_Read;
+  pSerial->hDevice = USBH_CDC_Open((unsigned)DevIndex);
+  if (pSerial->hDevice == USBH_CDC_INVALID_HANDLE) {
+    return 1;
+  }
+  (void)USBH_CDC_SetTimeouts(pSerial->hDevice, 100, 100);
+  return 0;
+}
+
+/*********************************************************************
+*
+*       _OpenFT232
+*/
+static int _OpenFT232(SERIAL * pSerial, unsigned n, const char * sName) {
+  int DevIndex;
+
+  DevIndex = _GetDevIndex(&_FT232, n);
+  if (DevIndex < 0) {
+    return 1;
+  }
+  pSerial->sName   = sName;
+  pSerial->pfWrite = _FT232_Write;
+  pSerial->pfRead  = _FT232_Read;
+  pSerial->hDevice = USBH_FT232_Open((unsigned)DevIndex);
+  if (pSerial->hDevice == USBH_FT232_INVALID_HANDLE) {
+    return 1;
+  }
+  (void)USBH_FT232_SetTimeouts(pSerial->hDevice, 100, 100);
+  return 0;
+}
+
+/*********************************************************************
+*
+*       Static code, tests
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _TestMSD
+*/
+static void _TestMSD(void) {
+  USBH_VHC_ERROR_INJECTION Err;
+  USBH_VHC_DEVICE        * pDev;
+  DISK                     Disk;
+  U32                      t;
+  int                      Unit;
+
+  pDev = _CreateMSD(&Disk);
+  TEST_CHECK(pDev != NULL);
+  if (pDev == NULL) {
+    return;
+  }
+  t = _WaitAdded(&_MSD, PORT_MSD, pDev);
+  printf("MSD on root hub:           enumerated in %u ms\n", (unsigned)t);
+  Unit = _GetMSDUnit(0);
+  TEST_CHECK(Unit >= 0);
+  if (Unit >= 0) {
+    _MSD_Run("MSD", (U8)Unit, MSD_TEST_SECTORS, 0, NULL);
+    _MSD_Run("MSD", (U8)Unit, MSD_TEST_SECTORS / 4u, 1, NULL);
+    _MSD_Run("MSD", (U8)Unit, MSD_TEST_SECTORS / 4u, 2, NULL);
+    //
+    // Every 5th command block wrapper fails. The device does not see the
+    // failed CBW, so the Bulk-Only state stays in sync and repeating the
+    // command succeeds. Errors in the data phase would make the class
+    // driver reset the device instead.
+    //
+    memset(&Err, 0, sizeof(Err));
+    Err.Period          = 5;
+    Err.Status          = USBH_STATUS_CRC;
+    Err.DeviceAddress   = USBH_VHC_ANY_ADDRESS;
+    Err.EndpointAddress = EP_BULK_OUT;
+    _MSD_Run("MSD, CBW errors", (U8)Unit, MSD_TEST_SECTORS / 4u, 1, &Err);
+    //
+    // The data on the disk image matches.
+    //
+    TEST_CHECK_EQ(_DISK_Read(&Disk, 0, _aRead, MSD_TEST_SECTORS / 4u), 0);
+    TEST_CHECK(memcmp(_aWrite, _aRead, MSD_TEST_SECTORS / 4u * BYTES_PER_SECTOR) == 0);
+  }
+  USBH_VHC_SetLatency(0);
+  TEST_CHECK_EQ(USBH_VHC_Disconnect(PORT_MSD), USBH_STATUS_SUCCESS);
+  USBH_OS_Delay(100);
+  TEST_CHECK_EQ(_GetNumPresent(&_MSD), 0u);
+  printf("MSD on root hub:           released %u ms after REMOVE\n", (unsigned)_WaitRemoved());
+  USBH_VHC_DeleteDevice(pDev);
+  (void)fclose(Disk.pFile);
+}
+
+/*********************************************************************
+*
+*       _TestSerial
+*
+*  Function description
+*    Loopback through the CDC and the FT232 model. Injected errors on
+*    the bulk endpoints make single read and write calls fail. The
+*    device does not see the failed transfer, so the application
+*    continues where the call stopped and no data is lost.
+*/
+static void _TestSerial(void) {
+  USBH_VHC_ERROR_INJECTION Err;
+  USBH_VHC_STAT            Stat;
+  USBH_VHC_DEVICE        * pCDC;
+  USBH_VHC_DEVICE        * pFT232;
+  SERIAL                   CDC;
+  SERIAL                   FT232;
+  U32                      t;
+
+  pCDC   = USBH_VHC_CreateCDCLoopback();
+  pFT232 = USBH_VHC_CreateFT232();
+  TEST_CHECK(pCDC != NULL && pFT232 != NULL);
+  if (pCDC == NULL || pFT232 == NULL) {
+    return;
+  }
+  t = _WaitAdded(&_CDC, PORT_CDC, pCDC);
+  printf("CDC on root hub:           enumerated in %u ms\n", (unsigned)t);
+  t = _WaitAdded(&_FT232, PORT_FT232, pFT232);
+  printf("FT232 on root hub:         enumerated in %u ms\n", (unsigned)t);
+  TEST_CHECK_EQ(_OpenCDC(&CDC, 0, "CDC"), 0);
+  TEST_CHECK_EQ(_OpenFT232(&FT232, 0, "FT232"), 0);
+  memset(&Err, 0, sizeof(Err));
+  Err.Period        = 7;
+  Err.Status        = USBH_STATUS_CRC;
+  Err.DeviceAddress = USBH_VHC_ANY_ADDRESS;
+  if (CDC.hDevice != USBH_CDC_INVALID_HANDLE) {
+    _SERIAL_Run(&CDC, SERIAL_TEST_BYTES, 0, NULL);
+    _SERIAL_Run(&CDC, SERIAL_TEST_BYTES / 4u, 1, NULL);
+    Err.EndpointAddress = EP_BULK_IN;
+    CDC.sName = "CDC, IN errors";
+    _SERIAL_Run(&CDC, SERIAL_TEST_BYTES / 4u, 1, &Err);
+    Err.EndpointAddress = EP_BULK_OUT;
+    CDC.sName = "CDC, OUT errors";
+    _SERIAL_Run(&CDC, SERIAL_TEST_BYTES / 4u, 1, &Err);
+    (void)USBH_CDC_Close(CDC.hDevice);
+  }
+  if (FT232.hDevice != USBH_FT232_INVALID_HANDLE) {
+    _SERIAL_Run(&FT232, SERIAL_TEST_BYTES, 0, NULL);
+    _SERIAL_Run(&FT232, SERIAL_TEST_BYTES / 4u, 1, NULL);
+    Err.EndpointAddress = EP_BULK_IN;
+    FT232.sName = "FT232, IN errors";
+    _SERIAL_Run(&FT232, SERIAL_TEST_BYTES / 4u, 1, &Err);
+    Err.EndpointAddress = EP_BULK_OUT;
+    FT232.sName = "FT232, OUT errors";
+    _SERIAL_Run(&FT232, SERIAL_TEST_BYTES / 4u, 1, &Err);
+    (void)USBH_FT232_Close(FT232.hDevice);
+  }
+  USBH_VHC_SetLatency(0);
+  TEST_CHECK_EQ(USBH_VHC_Disconnect(PORT_FT232), USBH_STATUS_SUCCESS);
+  USBH_OS_Delay(100);
+  TEST_CHECK_EQ(_GetNumPresent(&_FT232), 0u);
+  //
+  // Every 4th control transfer fails while the FT232 enumerates again.
+  // The descriptor cache is cleared so that all requests are sent.
+  // Failing optional requests are skipped, other failures make the stack
+  // repeat the enumeration.
+  //
+  USBH_ClearEnumDescCache();
+  memset(&Err, 0, sizeof(Err));
+  Err.Period          = 4;
+  Err.Status          = USBH_STATUS_TIMEOUT;
+  Err.DeviceAddress   = USBH_VHC_ANY_ADDRESS;
+  Err.EndpointAddress = EP_CONTROL;
+  USBH_VHC_ResetStat();
+  USBH_VHC_SetErrorInjection(&Err);
+  t = _WaitAdded(&_FT232, PORT_FT232, pFT232);
+  USBH_VHC_SetErrorInjection(NULL);
+  USBH_VHC_GetStat(&Stat);
+  TEST_CHECK(Stat.NumErrorsInjected > 0u);
+  printf("FT232, control errors:     enumerated in %u ms, %u errors injected\n", (unsigned)t, (unsigned)Stat.NumErrorsInjected);
+  TEST_CHECK_EQ(_OpenFT232(&FT232, 0, "FT232 after control errors"), 0);
+  if (FT232.hDevice != USBH_FT232_INVALID_HANDLE) {
+    _SERIAL_Run(&FT232, SERIAL_TEST_BYTES / 4u, 0, NULL);
+    (void)USBH_FT232_Close(FT232.hDevice);
+  }
+  TEST_CHECK_EQ(USBH_VHC_Disconnect(PORT_FT232), USBH_STATUS_SUCCESS);
+  TEST_CHECK_EQ(USBH_VHC_Disconnect(PORT_CDC), USBH_STATUS_SUCCESS);
+  USBH_OS_Delay(100);
+  TEST_CHECK_EQ(_GetNumPresent(&_CDC), 0u);
+  TEST_CHECK_EQ(_GetNumPresent(&_FT232), 0u);
+  (void)_WaitRemoved();
+  USBH_VHC_DeleteDevice(pCDC);
+  USBH_VHC_DeleteDevice(pFT232);
+}
+
+/*********************************************************************
+*
+*       _IsHubPopulated
+*/
+static int _IsHubPopulated(void * pContext) {
+  USBH_USE_PARA(pContext);
+  return (_GetNumPresent(&_MSD) == 1u && _GetNumPresent(&_CDC) == 1u && _GetNumPresent(&_FT232) == 1u) ? 1 : 0;
+}
+
+/*********************************************************************
+*
+*       _TestHub
+*
+*  Function description
+*    An MSD, a CDC and an FT232 device behind a hub. All three are
+*    used, then the hub is removed with the devices still attached.
+*/
+static void _TestHub(void) {
+  USBH_VHC_DEVICE * pHub;
+  USBH_VHC_DEVICE * pMSD;
+  USBH_VHC_DEVICE * pCDC;
+  USBH_VHC_DEVICE * pFT232;
+  DISK              Disk;
+  SERIAL            CDC;
+  SERIAL            FT232;
+  USBH_TIME         t0;
+  int               r;
+  int               Unit;
+
+  pHub   = USBH_VHC_CreateHub(4);
+  pMSD   = _CreateMSD(&Disk);
+  pCDC   = USBH_VHC_CreateCDCLoopback();
+  pFT232 = USBH_VHC_CreateFT232();
+  TEST_CHECK(pHub != NULL && pMSD != NULL && pCDC != NULL && pFT232 != NULL);
+  if (pHub == NULL || pMSD == NULL || pCDC == NULL || pFT232 == NULL) {
+    return;
+  }
+  TEST_CHECK_EQ(USBH_VHC_HUB_Connect(pHub, 1, pMSD),   USBH_STATUS_SUCCESS);
+  TEST_CHECK_EQ(USBH_VHC_HUB_Connect(pHub, 2, pCDC),   USBH_STATUS_SUCCESS);
+  TEST_CHECK_EQ(USBH_VHC_HUB_Connect(pHub, 4, pFT232), USBH_STATUS_SUCCESS);
+  t0 = SIM_GetTime();
+  TEST_CHECK_EQ(USBH_VHC_Connect(PORT_HUB, pHub), USBH_STATUS_SUCCESS);
+  r = SIM_WaitFor(_IsHubPopulated, NULL, ENUM_TIMEOUT);
+  TEST_CHECK_EQ(r, 0);
+  printf("Hub with 3 devices:        enumerated in %u ms\n", (unsigned)(SIM_GetTime() - t0));
+  if (r == 0) {
+    Unit = _GetMSDUnit(0);
+    TEST_CHECK(Unit >= 0);
+    if (Unit >= 0) {
+      _MSD_Run("MSD behind hub", (U8)Unit, MSD_TEST_SECTORS / 4u, 1, NULL);
+    }
+    if (_OpenCDC(&CDC, 0, "CDC behind hub") == 0) {
+      _SERIAL_Run(&CDC, SERIAL_TEST_BYTES / 4u, 1, NULL);
+      (void)USBH_CDC_Close(CDC.hDevice);
+    }
+    if (_OpenFT232(&FT232, 0, "FT232 behind hub") == 0) {
+      _SERIAL_Run(&FT232, SERIAL_TEST_BYTES / 4u, 1, NULL);
+      (void)USBH_FT232_Close(FT232.hDevice);
+    }
+  }
+  USBH_VHC_SetLatency(0);
+  //
+  // Removing the hub removes all devices behind it.
+  //
+  TEST_CHECK_EQ(USBH_VHC_Disconnect(PORT_HUB), USBH_STATUS_SUCCESS);
+  USBH_OS_Delay(200);
+  TEST_CHECK_EQ(_GetNumPresent(&_MSD),   0u);
+  TEST_CHECK_EQ(_GetNumPresent(&_CDC),   0u);
+  TEST_CHECK_EQ(_GetNumPresent(&_FT232), 0u);
+  printf("Hub with 3 devices:        released %u ms after REMOVE\n", (unsigned)_WaitRemoved());
+  USBH_VHC_DeleteDevice(pHub);
+  USBH_VHC_DeleteDevice(pMSD);
+  USBH_VHC_DeleteDevice(pCDC);
+  USBH_VHC_DeleteDevice(pFT232);
+  (void)fclose(Disk.pFile);
+}
+
+/*********************************************************************
+*
+*       Public code
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       USBH_X_Config
+*/
+void USBH_X_Config(void) {
+  USBH_AssignMemory(_aPool, sizeof(_aPool));
+  USBH_ConfigSupportExternalHubs(1);
+  (void)USBH_VHC_Add(4);
+}
+
+/*********************************************************************
+*
+*       main
+*/
+int main(void) {
+  SIM_Init();
+  SIM_StartStack();
+  (void)USBH_MSD_Init(_cbOnMSD, NULL);
+  (void)USBH_CDC_Init();
+  (void)USBH_CDC_AddNotification(&_CDCHook, _cbOnCDC, NULL);
+  (void)USBH_FT232_Init();
+  (void)USBH_FT232_AddNotification(&_FT232Hook, _cbOnFT232, NULL);
+  _TestMSD();
+  _TestSerial();
+  _TestHub();
+  USBH_FT232_Exit();
+  USBH_CDC_Exit();
+  USBH_MSD_Exit();
+  SIM_StopStack();
+  return TEST_Report("USBH_VHC_Test");
+}
+
+/*************************** End of file ****************************/
@@ -0,0 +1,425 @@
+/*********************************************************************
+*                                                                    *
+*       emFile * File system for embedded applications               *
+*                                                                    *
+**********************************************************************
+----------------------------------------------------------------------
+File        : FS_CheckDiskBench.c
+Purpose     : Host benchmark of the disk checking on a FAT32 RAM disk.
+              The volume is populated with a directory tree and then
+              checked once via the blocking FS_CheckDisk() and once via
+              FS_CheckDiskStart() / FS_CheckDiskStep() with a fixed time
+              slice on the volume mounted read-only. The scan rate is
+              reported in clusters per second together with the number
+              of sectors read and the longest time a single step held
+              the file system. One directory with many subdirectories
+              shows whether the stepped checking scales linearly. The size of the image in MB can be passed as
+              first argument (default 128 MB).
+-------------------------- END-OF-HEADER -----------------------------
+*/
+
+/*********************************************************************
+*
+*       #include Section
+*
+**********************************************************************
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "FS.h"
+#include "test_check.h"
+
+/*********************************************************************
+*
+*       Defines, configurable
+*
+**********************************************************************
+*/
+#define DEFAULT_DISK_SIZE_MB      128u
+#define BYTES_PER_SECTOR          512u
+#define ALLOC_SIZE                0x20000u    // Memory pool of the file system.
+#define NUM_DIRS                  32u
+#define NUM_SUBDIRS               4u
+#define NUM_FILES_PER_DIR         16u
+#define TIME_SLICE_MS             5u          // Time slice passed to FS_CheckDiskStep().
+#define MAP_SIZE_SMALL            2048u       // Cluster map that requires several passes.
+#define NUM_WIDE_DIRS             512u        // Subdirectories in one directory.
+
+/*********************************************************************
+*
+*       Static data
+*
+**********************************************************************
+*/
+static U32    _aMemBlock[ALLOC_SIZE / 4u];
+static U32  * _pRAMDisk;
+static U32    _NumSectors;
+static U8     _aFileData[64 * 1024];
+static U32    _NumErrors;
+static U32    _NumSectorsRead;
+static FS_DEVICE_TYPE _Device;              // RAM disk driver that counts the sectors read.
+
+/*********************************************************************
+*
+*       Static code
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _GetTime_us
+*/
+static U64 _GetTime_us(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (U64)ts.tv_sec * 1000000u + (U64)ts.tv_nsec / 1000u;
+}
+
+/*********************************************************************
+*
+*       _cbOnError
+*/
+static int _cbOnError(int ErrCode, ...) {
+  printf("  Error: %s\n", FS_CheckDisk_ErrCode2Text(ErrCode));
+  _NumErrors++;
+  return FS_CHECKDISK_ACTION_DO_NOT_REPAIR;
+}
+
+/*********************************************************************
+*
+*       _Populate
+*
+*  Function description
+*    Creates a directory tree with files of different sizes so that
+*    about one third of the volume is in use.
+*/
+static int _Populate(U32 NumBytesToWrite) {
+  char        acPath[64];
+  unsigned    iDir;
+  unsigned    iSub;
+  unsigned    iFile;
+  U32         NumBytes;
+  U32         NumBytesPerFile;
+  FS_FILE   * pFile;
+  int         r;
+
+  NumBytesPerFile = NumBytesToWrite / (NUM_DIRS * NUM_SUBDIRS * NUM_FILES_PER_DIR);
+  for (iDir = 0; iDir < NUM_DIRS; ++iDir) {
+    sprintf(acPath, "D%02u", iDir);
+    r = FS_MkDir(acPath);
+    if (r != 0) {
+      return r;
+    }
+    for (iSub = 0; iSub < NUM_SUBDIRS; ++iSub) {
+      sprintf(acPath, "D%02u/S%u", iDir, iSub);
+      r = FS_MkDir(acPath);
+      if (r != 0) {
+        return r;
+      }
+      for (iFile = 0; iFile < NUM_FILES_PER_DIR; ++iFile) {
+        sprintf(acPath, "D%02u/S%u/F%02u.BIN", iDir, iSub, iFile);
+        pFile = FS_FOpen(acPath, "wb");
+        if (pFile == NULL) {
+          return -1;
+        }
+        NumBytes = NumBytesPerFile / (1u + (iFile & 3u));    // Mix of large and small files.
+        while (NumBytes != 0u) {
+          U32 NumBytesAtOnce;
+
+          NumBytesAtOnce = (NumBytes < sizeof(_aFileData)) ? NumBytes : (U32)sizeof(_aFileData);
+          if (FS_Write(pFile, _aFileData, NumBytesAtOnce) != NumBytesAtOnce) {
+            (void)FS_FClose(pFile);
+            return -1;
+          }
+          NumBytes -= NumBytesAtOnce;
+        }
+        r = FS_FClose(pFile);
+        if (r != 0) {
+          return r;
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+/*********************************************************************
+*
+*       _Read
+*
+*  Function description
+*    Read function of the RAM disk driver, counts the sectors.
+*/
+static int _Read(U8 Unit, U32 SectorIndex, void * pBuffer, U32 NumSectors) {
+  _NumSectorsRead += NumSectors;
+  return FS_RAMDISK_Driver.pfRead(Unit, SectorIndex, pBuffer, NumSectors);
+}
+
+/*********************************************************************
+*
+*       _PopulateWide
+*
+*  Function description
+*    Creates a directory with many subdirectories. The time the stepped
+*    checking spends to find the next subdirectory has to stay constant
+*    so that the checking of this directory scales linearly.
+*/
+static int _PopulateWide(void) {
+  char     acPath[32];
+  unsigned iDir;
+  int      r;
+
+  r = FS_MkDir("WIDE");
+  for (iDir = 0; (iDir < NUM_WIDE_DIRS) && (r == 0); ++iDir) {
+    sprintf(acPath, "WIDE/W%03u", iDir);
+    r = FS_MkDir(acPath);
+  }
+  return r;
+}
+
+/*********************************************************************
+*
+*       _RunBlocking
+*
+*  Return value
+*    Number of sectors read.
+*/
+static U32 _RunBlocking(void * pBuffer, U32 BufferSize, U32 NumClusters) {
+  U64 Time_us;
+  int r;
+
+  _NumErrors      = 0;
+  _NumSectorsRead = 0;
+  Time_us = _GetTime_us();
+  r = FS_CheckDisk("", pBuffer, BufferSize, FS_CHECKDISK_MAX_DIR_DEPTH, _cbOnError);
+  Time_us = _GetTime_us() - Time_us;
+  TEST_CHECK_EQ(r, FS_CHECKDISK_RETVAL_OK);
+  TEST_CHECK_EQ(_NumErrors, 0u);
+  printf("  FS_CheckDisk     map %6lu bytes: %8.1f ms blocking, %10.0f clusters/s, %lu sectors read\n",
+         (unsigned long)BufferSize, (double)Time_us / 1000.0, ((double)NumClusters * 1e6) / (double)(Time_us + 1u),
+         (unsigned long)_NumSectorsRead);
+  return _NumSectorsRead;
+}
+
+/*********************************************************************
+*
+*       _RunStep
+*
+*  Function description
+*    Checks the volume via FS_CheckDiskStep(). The directory cursor
+*    lets each step continue where the previous one stopped, so the
+*    number of sectors read has to stay in the same order as for
+*    FS_CheckDisk() (NumSectorsBlocking). The remaining overhead comes
+*    from the lookup of each directory by its path in FS_CheckDir().
+*/
+static void _RunStep(void * pBuffer, U32 BufferSize, U32 NumClusters, U32 NumSectorsBlocking) {
+  FS_CHECKDISK_STEP_DATA StepData;
+  FS_CHECKDISK_PROGRESS  Progress;
+  U64                    Time_us;
+  U64                    TimeStep_us;
+  U64                    TimeStepMax_us;
+  U32                    NumSteps;
+  U32                    NumEstimates;
+  int                    r;
+
+  _NumErrors     = 0;
+  NumSteps       = 0;
+  NumEstimates   = 0;
+  TimeStepMax_us = 0;
+  FS_Unmount("");
+  r = FS_MountEx("", FS_MOUNT_RO);
+  TEST_CHECK_EQ(r, FS_MOUNT_RO);
+  _NumSectorsRead = 0;
+  r = FS_CheckDiskStart(&StepData, "", pBuffer, BufferSize, FS_CHECKDISK_MAX_DIR_DEPTH, _cbOnError);
+  TEST_CHECK_EQ(r, 0);
+  Time_us = _GetTime_us();
+  do {
+    TimeStep_us = _GetTime_us();
+    r = FS_CheckDiskStep(&StepData, TIME_SLICE_MS);
+    TimeStep_us = _GetTime_us() - TimeStep_us;
+    if (TimeStep_us > TimeStepMax_us) {
+      TimeStepMax_us = TimeStep_us;
+    }
+    NumSteps++;
+    FS_CheckDiskGetProgress(&StepData, &Progress);
+    if (Progress.TimeRemaining != 0xFFFFFFFFuL) {
+      NumEstimates++;
+    }
+  } while (r == FS_CHECKDISK_RETVAL_CONTINUE);
+  Time_us = _GetTime_us() - Time_us;
+  FS_Unmount("");
+  (void)FS_MountEx("", FS_MOUNT_RW);
+  TEST_CHECK_EQ(r, FS_CHECKDISK_RETVAL_OK);
+  TEST_CHECK_EQ(_NumErrors, 0u);
+  TEST_CHECK_EQ(Progress.Phase, FS_CHECKDISK_PHASE_DONE);
+  TEST_CHECK_EQ(Progress.Percent, 100u);
+  TEST_CHECK_EQ(Progress.NumClustersTotal, NumClusters);
+  TEST_CHECK_EQ(Progress.NumRestarts, 0u);
+  TEST_CHECK(_NumSectorsRead <= (5u * NumSectorsBlocking));
+  TEST_CHECK(Progress.NumPasses >= 1u);
+  if (Progress.NumPasses > 1u) {
+    TEST_CHECK(NumEstimates != 0u);                     // An ETA is available after the first pass.
+  }
+  printf("  FS_CheckDiskStep map %6lu bytes: %8.1f ms total, %10.0f clusters/s, %lu sectors read, %u pass(es), %lu steps, longest step %.2f ms\n",
+         (unsigned long)BufferSize, (double)Time_us / 1000.0, ((double)NumClusters * 1e6) / (double)(Time_us + 1u),
+         (unsigned long)_NumSectorsRead, (unsigned)Progress.NumPasses, (unsigned long)NumSteps, (double)TimeStepMax_us / 1000.0);
+}
+
+/*********************************************************************
+*
+*       _TestReadOnly
+*
+*  Function description
+*    Verifies that the stepped checking runs only on a volume
+*    mounted read-only so that the volume cannot be modified
+*    between two steps.
+*/
+static void _TestReadOnly(void * pBuffer, U32 BufferSize) {
+  FS_CHECKDISK_STEP_DATA StepData;
+  int                    r;
+
+  r = FS_CheckDiskStart(&StepData, "", pBuffer, BufferSize, FS_CHECKDISK_MAX_DIR_DEPTH, _cbOnError);
+  TEST_CHECK_EQ(r, FS_ERRCODE_INVALID_USAGE);
+  FS_Unmount("");
+  (void)FS_MountEx("", FS_MOUNT_RO);
+  r = FS_CheckDiskStart(&StepData, "", pBuffer, BufferSize, FS_CHECKDISK_MAX_DIR_DEPTH, _cbOnError);
+  TEST_CHECK_EQ(r, 0);
+  r = FS_CheckDiskStep(&StepData, 0);
+  TEST_CHECK_EQ(r, FS_CHECKDISK_RETVAL_CONTINUE);
+  FS_Unmount("");
+  (void)FS_MountEx("", FS_MOUNT_RW);
+  r = FS_CheckDiskStep(&StepData, 0);
+  TEST_CHECK_EQ(r, FS_ERRCODE_INVALID_USAGE);
+  r = FS_CheckDiskStep(&StepData, 0);
+  TEST_CHECK_EQ(r, FS_ERRCODE_INVALID_USAGE);     // Not reported as complete.
+}
+
+/*********************************************************************
+*
+*       Public code, file system configuration
+*
+**********************************************************************
+*/
+void FS_X_AddDevices(void) {
+  FS_AssignMemory(&_aMemBlock[0], sizeof(_aMemBlock));
+  _Device        = FS_RAMDISK_Driver;
+  _Device.pfRead = _Read;
+  FS_AddDevice(&_Device);
+  FS_RAMDISK_Configure(0, _pRAMDisk, BYTES_PER_SECTOR, _NumSectors);
+}
+
+U32 FS_X_GetTimeDate(void) {
+  return 0x00210000uL;              // 1 Jan 1980
+}
+
+void FS_X_Panic(int ErrorCode) {
+  printf("FS_X_Panic: %d\n", ErrorCode);
+  exit(1);
+}
+
+/*********************************************************************
+*
+*       Public code, OS layer
+*
+**********************************************************************
+*/
+void FS_X_OS_Lock(unsigned LockIndex) {
+  FS_USE_PARA(LockIndex);
+}
+
+void FS_X_OS_Unlock(unsigned LockIndex) {
+  FS_USE_PARA(LockIndex);
+}
+
+void FS_X_OS_Init(unsigned NumLocks) {
+  FS_USE_PARA(NumLocks);
+}
+
+void FS_X_OS_DeInit(void) {
+}
+
+U32 FS_X_OS_GetTime(void) {
+  return (U32)(_GetTime_us() / 1000u);
+}
+
+int FS_X_OS_Wait(int TimeOut) {
+  FS_USE_PARA(TimeOut);
+  return 0;
+}
+
+void FS_X_OS_Signal(void) {
+}
+
+void FS_X_OS_Delay(int ms) {
+  FS_USE_PARA(ms);
+}
+
+/*********************************************************************
+*
+*       Public code, benchmark
+*
+**********************************************************************
+*/
+int main(int argc, char * argv[]) {
+  FS_FORMAT_INFO FormatInfo;
+  FS_DISK_INFO   DiskInfo;
+  U32            DiskSize_MB;
+  U32            NumClusters;
+  U32            MapSize;
+  U32            NumSectors;
+  void         * pMap;
+  int            r;
+  unsigned       i;
+
+  DiskSize_MB = DEFAULT_DISK_SIZE_MB;
+  if (argc > 1) {
+    DiskSize_MB = (U32)strtoul(argv[1], NULL, 0);
+  }
+  _NumSectors = (DiskSize_MB * 1024u * 1024u) / BYTES_PER_SECTOR;
+  _pRAMDisk   = (U32 *)calloc(_NumSectors, BYTES_PER_SECTOR);
+  if (_pRAMDisk == NULL) {
+    printf("Could not allocate %lu MB\n", (unsigned long)DiskSize_MB);
+    return 1;
+  }
+  for (i = 0; i < sizeof(_aFileData); ++i) {
+    _aFileData[i] = (U8)i;
+  }
+  FS_Init();
+  memset(&FormatInfo, 0, sizeof(FormatInfo));
+  FormatInfo.SectorsPerCluster = 1;                     // Many clusters: FAT32 already at 33 MB.
+  r = FS_Format("", &FormatInfo);
+  TEST_CHECK_EQ(r, 0);
+  r = FS_GetVolumeInfo("", &DiskInfo);
+  TEST_CHECK_EQ(r, 0);
+  TEST_CHECK_EQ(DiskInfo.FSType, FS_TYPE_FAT32);
+  NumClusters = DiskInfo.NumTotalClusters;
+  r = _Populate((DiskSize_MB * 1024u * 1024u) / 3u);
+  TEST_CHECK_EQ(r, 0);
+  r = _PopulateWide();
+  TEST_CHECK_EQ(r, 0);
+  FS_Sync("");
+  printf("FAT32 image: %lu MB, %lu clusters of %u bytes, %u directories\n",
+         (unsigned long)DiskSize_MB, (unsigned long)NumClusters, (unsigned)BYTES_PER_SECTOR,
+         (unsigned)(NUM_DIRS * (NUM_SUBDIRS + 1u) + NUM_WIDE_DIRS + 1u));
+  //
+  // Cluster map large enough for one pass and a small one that requires several passes.
+  //
+  MapSize = (NumClusters + 7u) / 8u;
+  pMap    = malloc(MapSize);
+  if (pMap != NULL) {
+    _TestReadOnly(pMap, MapSize);
+    NumSectors = _RunBlocking(pMap, MapSize, NumClusters);
+    _RunStep(pMap, MapSize, NumClusters, NumSectors);
+    NumSectors = _RunBlocking(pMap, MAP_SIZE_SMALL, NumClusters);
+    _RunStep(pMap, MAP_SIZE_SMALL, NumClusters, NumSectors);
+    free(pMap);
+  }
+  free(_pRAMDisk);
+  return TEST_Report("FS_CheckDiskBench");
+}
+
+/*************************** End of file ****************************/
@@ -0,0 +1,1292 @@
+/*********************************************************************
+*                                                                    *
+*       emFile * File system for embedded applications               *
+*                                                                    *
+**********************************************************************
+----------------------------------------------------------------------
+File        : FS_MMC_CM_CmdQTest.c
+Purpose     : Host test of the command queue support of the Card Mode
+              MMC/SD driver. The driver runs against a model of an
+              eMMC device that implements the identification sequence,
+              the regular data transfer commands and the command queue
+              (CMD44 to CMD48, CMD13 with SQS). Tasks become ready in a
+              configurable order and faults can be injected to exercise
+              the discard, retry and non-queued fallback paths.
+              The model keeps a microsecond clock and signals busy while
+              it programs written data, which is used to compare the
+              streaming write mode with the regular write commands.
+-------------------------- END-OF-HEADER -----------------------------
+*/
+
+/*********************************************************************
+*
+*       #include Section
+*
+**********************************************************************
+*/
+#include <stdlib.h>
+#include <string.h>
+#include "FS_Int.h"
+#include "test_check.h"
+
+/*********************************************************************
+*
+*       Defines, configurable
+*
+**********************************************************************
+*/
+#define NUM_SECTORS               4096u   // Capacity of the modeled eMMC device.
+#define MAX_BURST                 16u     // Maximum number of sectors per data transfer reported by the HW layer.
+#define MAX_TASKS                 32u     // Number of tasks an eMMC device can hold at most.
+#define CMD_TIME_US               4u      // Time it takes to send a command and receive the response.
+#define BLOCK_TIME_US             20u     // Time it takes to transfer one block of data.
+#define PROG_TIME_US              600u    // Time the card signals busy after it received the data of a write command.
+#define APP_TIME_US               400u    // Time the application needs to produce the data of a write request.
+#define ACCESS_TIME_US            100u    // Time the device needs to fetch the data of a read from the flash array.
+#define NUM_STREAM_REQS           16u     // Number of write requests of the streaming test.
+#define SECTORS_PER_REQ           8u      // Number of sectors written by one request of the streaming test.
+#define NUM_LARGE_READS           8u      // Number of read requests transferred via the command queue.
+#define SECTORS_PER_LARGE_READ    64u     // Number of sectors read by a request that is split in tasks.
+#define NUM_SMALL_READS           32u     // Number of read requests below FS_MMC_CMDQ_MIN_SECTORS.
+
+/*********************************************************************
+*
+*       Defines, fixed
+*
+**********************************************************************
+*/
+#define BYTES_PER_SECTOR          512u
+#define NUM_CMDS                  64u
+#define CARD_RCA                  1u
+
+/*********************************************************************
+*
+*       Card states
+*/
+#define STATE_IDLE                0u
+#define STATE_READY               1u
+#define STATE_IDENT               2u
+#define STATE_STBY                3u
+#define STATE_TRAN                4u
+#define STATE_DATA                5u
+#define STATE_RCV                 6u
+#define STATE_PRG                 7u
+
+/*********************************************************************
+*
+*       Card status bits
+*/
+#define STATUS_ILLEGAL_COMMAND    (1uL << 22)
+#define STATUS_ERROR              (1uL << 19)
+#define STATUS_READY_FOR_DATA     (1uL << 8)
+#define STATUS_STATE_SHIFT        9
+
+/*********************************************************************
+*
+*       EXT_CSD offsets
+*/
+#define EXT_CSD_CMDQ_MODE_EN      15
+#define EXT_CSD_ERASED_MEM_CONT   181
+#define EXT_CSD_REV               192
+#define EXT_CSD_CARD_TYPE         196
+#define EXT_CSD_SEC_COUNT         212
+#define EXT_CSD_CMDQ_DEPTH        307
+#define EXT_CSD_CMDQ_SUPPORT      308
+
+/*********************************************************************
+*
+*       Local data types
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       CARD_TASK
+*/
+typedef struct {
+  U32 SectorIndex;
+  U32 ReadyAt;                    // Value of NumPolls at which the task is reported as ready.
+  U32 ReadyTimeUs;                // Time at which the device has fetched the data of a read task.
+  U16 NumSectors;
+  U8  IsRead;
+  U8  IsQueued;
+} CARD_TASK;
+
+/*********************************************************************
+*
+*       CARD
+*/
+typedef struct {
+  //
+  // Configuration of the model.
+  //
+  unsigned  CmdQDepth;            // Number of tasks the device can hold, 0 means that the command queue is not supported.
+  unsigned  ReadyDelay;           // Number of QSR reads after which a queued task becomes ready.
+  int       IsReadyReversed;      // Tasks with a higher id become ready first.
+  int       IsNeverReady;         // No task becomes ready.
+  unsigned  NumExecErrors;        // Number of CMD46 / CMD47 data transfers that fail with a CRC error.
+  unsigned  NumStreamErrors;      // Number of streaming data transfers that fail with a CRC error.
+  U32       ProgTimeUs;           // Time the card is busy after a write operation.
+  U32       AccessTimeUs;         // Time the device needs to fetch the data of a read command or task.
+  int       IsExtCSDMissing;      // Legacy MMC card without EXT_CSD. The driver uses open-ended transfers.
+  //
+  // Card state.
+  //
+  unsigned  State;
+  unsigned  Rca;
+  int       IsCmdQEnabled;
+  U32       NumPolls;
+  U32       BlockCount;           // Set via SET_BLOCK_COUNT (CMD23), 0 means open-ended.
+  U32       Params;               // Argument of the last QUEUED_TASK_PARAMS (CMD44).
+  int       IsParamsValid;
+  U32       DataSector;
+  U32       DataBlocksLeft;       // 0 means open-ended.
+  int       IsDataExtCSD;
+  int       IsDataError;
+  U32       TimeUs;               // Current time in microseconds.
+  U32       BusyUntil;            // Time at which the card releases the busy signal.
+  U32       FetchUntil;           // Time at which the device has fetched the data of all the queued read tasks.
+  CARD_TASK aTask[MAX_TASKS];
+  //
+  // Response of the last command.
+  //
+  unsigned  RespType;
+  U32       RespStatus;
+  //
+  // Statistics.
+  //
+  U32       aCmdCnt[NUM_CMDS];
+  U32       NumTasksQueued;
+  U32       NumTasksQueuedMax;
+  U32       NumIllegal;
+  U32       NumOutOfOrder;        // Number of tasks executed while a task with a lower id was still queued.
+  U32       NumBusyWaits;         // Number of times the HW layer waited for the busy signal before a command.
+  //
+  // Storage.
+  //
+  U8        aExtCSD[512];
+  U8        aData[NUM_SECTORS * BYTES_PER_SECTOR];
+} CARD;
+
+/*********************************************************************
+*
+*       Static data
+*
+**********************************************************************
+*/
+static CARD _Card;
+static U8   _aSectorBuffer[BYTES_PER_SECTOR];
+static U8   _aWrite[128 * BYTES_PER_SECTOR];
+static U8   _aRead[128 * BYTES_PER_SECTOR];
+
+/*********************************************************************
+*
+*       Public data
+*
+**********************************************************************
+*/
+FS_GLOBAL FS_Global;
+
+/*********************************************************************
+*
+*       Stubs of the file system core
+*
+**********************************************************************
+*/
+void * FS_AllocZeroed(I32 NumBytes) {
+  return calloc(1, (size_t)NumBytes);
+}
+
+void * FS_GetFreeMem(I32 * pNumBytes) {
+  *pNumBytes = 0;
+  return NULL;
+}
+
+U8 * FS__AllocSectorBuffer(void) {
+  return _aSectorBuffer;
+}
+
+void FS__FreeSectorBuffer(const void * pBuffer) {
+  FS_USE_PARA(pBuffer);
+}
+
+U32 FS_LoadU32BE(const U8 * pBuffer) {
+  return ((U32)pBuffer[0] << 24) | ((U32)pBuffer[1] << 16) | ((U32)pBuffer[2] << 8) | (U32)pBuffer[3];
+}
+
+U32 FS_LoadU32LE(const U8 * pBuffer) {
+  return ((U32)pBuffer[3] << 24) | ((U32)pBuffer[2] << 16) | ((U32)pBuffer[1] << 8) | (U32)pBuffer[0];
+}
+
+U32 FS_X_OS_GetTime(void) {
+  return _Card.TimeUs / 1000u;
+}
+
+/*********************************************************************
+*
+*       TEST_MMC_GetTimestamp
+*
+*  Function description
+*    Time base of the command latency counters, see FS_MMC_Timestamp.h.
+*/
+U32 TEST_MMC_GetTimestamp(void) {
+  return _Card.TimeUs;
+}
+
+/*********************************************************************
+*
+*       Static code, card model
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _SetCSDBits
+*
+*  Function description
+*    Stores a value to a bit field of a CSD register in response format.
+*/
+static void _SetCSDBits(U8 * pCSD, unsigned FirstBit, unsigned NumBits, U32 Value) {
+  unsigned i;
+  unsigned Bit;
+
+  for (i = 0; i < NumBits; ++i) {
+    if ((Value & (1uL << i)) != 0u) {
+      Bit = FirstBit + i;
+      pCSD[15u - (Bit >> 3)] |= (U8)(1u << (Bit & 7u));
+    }
+  }
+}
+
+/*********************************************************************
+*
+*       _CardReset
+*
+*  Function description
+*    Powers up the modeled device with the specified queue depth.
+*    The type of device (with or without EXT_CSD) is kept.
+*/
+static void _CardReset(unsigned CmdQDepth) {
+  int IsExtCSDMissing;
+
+  IsExtCSDMissing = _Card.IsExtCSDMissing;
+  memset(&_Card, 0, sizeof(_Card) - sizeof(_Card.aData));
+  _Card.CmdQDepth       = CmdQDepth;
+  _Card.IsExtCSDMissing = IsExtCSDMissing;
+  _Card.aExtCSD[EXT_CSD_REV]             = 8;
+  _Card.aExtCSD[EXT_CSD_CARD_TYPE]       = 0x03;
+  _Card.aExtCSD[EXT_CSD_ERASED_MEM_CONT] = 0;
+  _Card.aExtCSD[EXT_CSD_SEC_COUNT + 0]   = (U8)NUM_SECTORS;
+  _Card.aExtCSD[EXT_CSD_SEC_COUNT + 1]   = (U8)(NUM_SECTORS >> 8);
+  _Card.aExtCSD[EXT_CSD_SEC_COUNT + 2]   = (U8)(NUM_SECTORS >> 16);
+  _Card.aExtCSD[EXT_CSD_SEC_COUNT + 3]   = (U8)(NUM_SECTORS >> 24);
+  if (CmdQDepth != 0u) {
+    _Card.aExtCSD[EXT_CSD_CMDQ_SUPPORT]  = 1;
+    _Card.aExtCSD[EXT_CSD_CMDQ_DEPTH]    = (U8)(CmdQDepth - 1u);
+  }
+}
+
+/*********************************************************************
+*
+*       _CardQSR
+*
+*  Function description
+*    Returns the contents of the Queue Status Register.
+*/
+static U32 _CardQSR(void) {
+  U32         QSR;
+  unsigned    TaskId;
+  CARD_TASK * pTask;
+
+  QSR = 0;
+  if (_Card.IsNeverReady == 0) {
+    for (TaskId = 0; TaskId < MAX_TASKS; ++TaskId) {
+      pTask = &_Card.aTask[TaskId];
+      if ((pTask->IsQueued != 0u) && (_Card.NumPolls >= pTask->ReadyAt) && (_Card.TimeUs >= pTask->ReadyTimeUs)) {
+        QSR |= 1uL << TaskId;
+      }
+    }
+  }
+  return QSR;
+}
+
+/*********************************************************************
+*
+*       _CardStartData
+*
+*  Function description
+*    Moves the card to the data transfer state.
+*/
+static void _CardStartData(U32 SectorIndex, U32 NumBlocks, int IsRead) {
+  _Card.DataSector     = SectorIndex;
+  _Card.DataBlocksLeft = NumBlocks;
+  _Card.State          = (IsRead != 0) ? STATE_DATA : STATE_RCV;
+}
+
+/*********************************************************************
+*
+*       _CardIsBusy
+*/
+static int _CardIsBusy(void) {
+  return (_Card.TimeUs < _Card.BusyUntil) ? 1 : 0;
+}
+
+/*********************************************************************
+*
+*       _CardStartProg
+*
+*  Function description
+*    Starts programming the received data. The card signals busy
+*    for ProgTimeUs microseconds.
+*/
+static void _CardStartProg(void) {
+  _Card.State     = STATE_TRAN;
+  _Card.BusyUntil = _Card.TimeUs + _Card.ProgTimeUs;
+}
+
+/*********************************************************************
+*
+*       _CardWaitBusy
+*
+*  Function description
+*    Models a host controller that waits for the card to release DAT0.
+*/
+static void _CardWaitBusy(void) {
+  if (_CardIsBusy() != 0) {
+    _Card.NumBusyWaits++;
+    _Card.TimeUs = _Card.BusyUntil;
+  }
+}
+
+/*********************************************************************
+*
+*       _CardExecTask
+*
+*  Function description
+*    Handles EXECUTE_READ_TASK (CMD46) and EXECUTE_WRITE_TASK (CMD47).
+*/
+static U32 _CardExecTask(U32 Arg, int IsRead) {
+  unsigned    TaskId;
+  unsigned    i;
+  CARD_TASK * pTask;
+
+  TaskId = (Arg >> 16) & 0x1Fu;
+  pTask  = &_Card.aTask[TaskId];
+  if ((_Card.IsCmdQEnabled == 0) || (pTask->IsQueued == 0u) || ((int)pTask->IsRead != IsRead)) {
+    return STATUS_ILLEGAL_COMMAND;
+  }
+  if ((_CardQSR() & (1uL << TaskId)) == 0u) {
+    return STATUS_ILLEGAL_COMMAND;            // The task is not ready for execution.
+  }
+  for (i = 0; i < TaskId; ++i) {
+    if (_Card.aTask[i].IsQueued != 0u) {
+      _Card.NumOutOfOrder++;
+      break;
+    }
+  }
+  pTask->IsQueued = 0;                        // The task is removed from the queue when the command is accepted.
+  _Card.NumTasksQueued--;
+  if (_Card.NumExecErrors != 0u) {
+    _Card.NumExecErrors--;
+    _Card.IsDataError = 1;
+  }
+  _CardStartData(pTask->SectorIndex, pTask->NumSectors, IsRead);
+  return 0;
+}
+
+/*********************************************************************
+*
+*       _CardExecCmd
+*
+*  Function description
+*    Executes a command and returns the error bits of the card status.
+*/
+static U32 _CardExecCmd(unsigned Cmd, U32 Arg) {
+  U32         Errors;
+  U32         NumBlocks;
+  unsigned    TaskId;
+  unsigned    Index;
+  unsigned    Value;
+  CARD_TASK * pTask;
+
+  Errors = 0;
+  //
+  // Only a few commands are accepted while the command queue is enabled.
+  //
+  if (_Card.IsCmdQEnabled != 0) {
+    switch (Cmd) {
+    case 8:
+    case 17:
+    case 18:
+    case 23:
+    case 24:
+    case 25:
+      return STATUS_ILLEGAL_COMMAND;
+    default:
+      break;
+    }
+  }
+  switch (Cmd) {
+  case 0:
+    _CardReset(_Card.CmdQDepth);
+    break;
+  case 1:
+    _Card.State = STATE_READY;
+    break;
+  case 2:
+    _Card.State = STATE_IDENT;
+    break;
+  case 3:
+    _Card.Rca   = Arg >> 16;
+    _Card.State = STATE_STBY;
+    break;
+  case 7:
+    _Card.State = ((Arg >> 16) == _Card.Rca) ? STATE_TRAN : STATE_STBY;
+    break;
+  case 8:
+    if (_Card.IsExtCSDMissing != 0) {
+      Errors = STATUS_ILLEGAL_COMMAND;
+      break;
+    }
+    _Card.IsDataExtCSD = 1;
+    _CardStartData(0, 1, 1);
+    break;
+  case 6:
+    Index = (Arg >> 16) & 0xFFu;
+    Value = (Arg >> 8)  & 0xFFu;
+    if (((Arg >> 24) & 3u) != 3u) {
+      Errors = STATUS_ILLEGAL_COMMAND;        // Only "write byte" is modeled.
+      break;
+    }
+    if (Index == EXT_CSD_CMDQ_MODE_EN) {
+      if ((_Card.CmdQDepth == 0u) || ((Value == 0u) && (_Card.NumTasksQueued != 0u))) {
+        Errors = STATUS_ERROR;                // Not supported or the queue is not empty.
+        break;
+      }
+      _Card.IsCmdQEnabled = (int)Value;
+    }
+    _Card.aExtCSD[Index] = (U8)Value;
+    break;
+  case 12:
+    if (_Card.State == STATE_RCV) {
+      _CardStartProg();
+    }
+    _Card.State          = STATE_TRAN;
+    _Card.DataBlocksLeft = 0;
+    break;
+  case 16:
+    break;
+  case 23:
+    _Card.BlockCount = Arg & 0xFFFFu;
+    break;
+  case 17:
+  case 24:
+    if (Cmd == 17u) {
+      _Card.TimeUs += _Card.AccessTimeUs;
+    }
+    _CardStartData(Arg, 1, Cmd == 17u);
+    break;
+  case 18:
+  case 25:
+    if (Cmd == 18u) {
+      _Card.TimeUs += _Card.AccessTimeUs;
+    }
+    NumBlocks         = _Card.BlockCount;
+    _Card.BlockCount  = 0;
+    _CardStartData(Arg, NumBlocks, Cmd == 18u);
+    break;
+  case 44:
+    TaskId = (Arg >> 16) & 0x1Fu;
+    if (   (_Card.IsCmdQEnabled == 0)
+        || (TaskId >= _Card.CmdQDepth)
+        || (_Card.aTask[TaskId].IsQueued != 0u)
+        || ((Arg & 0xFFFFu) == 0u)) {
+      Errors = STATUS_ILLEGAL_COMMAND;
+      break;
+    }
+    _Card.Params        = Arg;
+    _Card.IsParamsValid = 1;
+    break;
+  case 45:
+    if ((_Card.IsCmdQEnabled == 0) || (_Card.IsParamsValid == 0)) {
+      Errors = STATUS_ILLEGAL_COMMAND;
+      break;
+    }
+    TaskId = (_Card.Params >> 16) & 0x1Fu;
+    pTask  = &_Card.aTask[TaskId];
+    pTask->SectorIndex = Arg;
+    pTask->NumSectors  = (U16)(_Card.Params & 0xFFFFu);
+    pTask->IsRead      = (U8)((_Card.Params >> 30) & 1u);
+    pTask->IsQueued    = 1;
+    pTask->ReadyAt     = _Card.NumPolls + _Card.ReadyDelay;
+    if (_Card.IsReadyReversed != 0) {
+      pTask->ReadyAt  += _Card.CmdQDepth - TaskId;
+    }
+    if (pTask->IsRead != 0u) {
+      //
+      // The device fetches the data of the queued read tasks one after the other
+      // in the background while the host transfers the data of other tasks.
+      //
+      _Card.FetchUntil   = SEGGER_MAX(_Card.FetchUntil, _Card.TimeUs) + _Card.AccessTimeUs;
+      pTask->ReadyTimeUs = _Card.FetchUntil;
+    }
+    _Card.IsParamsValid = 0;
+    _Card.NumTasksQueued++;
+    if (_Card.NumTasksQueued > _Card.NumTasksQueuedMax) {
+      _Card.NumTasksQueuedMax = _Card.NumTasksQueued;
+    }
+    break;
+  case 46:
+  case 47:
+    Errors = _CardExecTask(Arg, Cmd == 46u);
+    break;
+  case 48:
+    if ((_Card.IsCmdQEnabled == 0) || ((Arg & 0xFu) != 1u)) {
+      Errors = STATUS_ILLEGAL_COMMAND;
+      break;
+    }
+    memset(_Card.aTask, 0, sizeof(_Card.aTask));
+    _Card.NumTasksQueued = 0;
+    _Card.IsParamsValid  = 0;
+    break;
+  default:
+    break;
+  }
+  return Errors;
+}
+
+/*********************************************************************
+*
+*       _CardTransfer
+*
+*  Function description
+*    Exchanges sector data with the card.
+*/
+static int _CardTransfer(U8 * pData, const U8 * pDataConst, unsigned BlockSize, unsigned NumBlocks) {
+  U32 Off;
+  int r;
+
+  r = FS_MMC_CARD_NO_ERROR;
+  if (_Card.IsDataExtCSD != 0) {
+    memcpy(pData, _Card.aExtCSD, sizeof(_Card.aExtCSD));
+    _Card.IsDataExtCSD = 0;
+    _Card.State        = STATE_TRAN;
+    return r;
+  }
+  if ((_Card.DataBlocksLeft != 0u) && (NumBlocks > _Card.DataBlocksLeft)) {
+    return (pData != NULL) ? FS_MMC_CARD_READ_GENERIC_ERROR : FS_MMC_CARD_WRITE_GENERIC_ERROR;
+  }
+  if ((_Card.DataSector + NumBlocks) > NUM_SECTORS) {
+    return (pData != NULL) ? FS_MMC_CARD_READ_GENERIC_ERROR : FS_MMC_CARD_WRITE_GENERIC_ERROR;
+  }
+  _Card.TimeUs += BLOCK_TIME_US * NumBlocks;
+  if (_Card.IsDataError != 0) {
+    _Card.IsDataError    = 0;
+    _Card.State          = STATE_TRAN;
+    _Card.DataBlocksLeft = 0;
+    return (pData != NULL) ? FS_MMC_CARD_READ_CRC_ERROR : FS_MMC_CARD_WRITE_CRC_ERROR;
+  }
+  Off = _Card.DataSector * BYTES_PER_SECTOR;
+  if (pData != NULL) {
+    memcpy(pData, &_Card.aData[Off], BlockSize * NumBlocks);
+  } else {
+    memcpy(&_Card.aData[Off], pDataConst, BlockSize * NumBlocks);
+  }
+  _Card.DataSector += NumBlocks;
+  if (_Card.DataBlocksLeft != 0u) {
+    _Card.DataBlocksLeft -= NumBlocks;
+    if (_Card.DataBlocksLeft == 0u) {
+      _Card.State = STATE_TRAN;                 // Close-ended transfer finished.
+      if (pData == NULL) {
+        _CardStartProg();
+      }
+    }
+  }
+  return r;
+}
+
+/*********************************************************************
+*
+*       Static code, hardware layer
+*
+**********************************************************************
+*/
+static void _HW_InitHW(U8 Unit) {
+  FS_USE_PARA(Unit);
+}
+
+static void _HW_Delay(int ms) {
+  FS_USE_PARA(ms);
+}
+
+static int _HW_IsPresent(U8 Unit) {
+  FS_USE_PARA(Unit);
+  return FS_MEDIA_IS_PRESENT;
+}
+
+static int _HW_IsWriteProtected(U8 Unit) {
+  FS_USE_PARA(Unit);
+  return 0;
+}
+
+static U16 _HW_SetMaxSpeed(U8 Unit, U16 MaxFreq) {
+  FS_USE_PARA(Unit);
+  return MaxFreq;
+}
+
+static void _HW_SetResponseTimeOut(U8 Unit, U32 Value) {
+  FS_USE_PARA(Unit);
+  FS_USE_PARA(Value);
+}
+
+static void _HW_SetReadDataTimeOut(U8 Unit, U32 Value) {
+  FS_USE_PARA(Unit);
+  FS_USE_PARA(Value);
+}
+
+static void _HW_SendCmd(U8 Unit, unsigned Cmd, unsigned CmdFlags, unsigned ResponseType, U32 Arg) {
+  U32      Errors;
+  unsigned State;
+
+  FS_USE_PARA(Unit);
+  _Card.aCmdCnt[Cmd & (NUM_CMDS - 1u)]++;
+  _Card.TimeUs  += CMD_TIME_US;
+  _Card.RespType = ResponseType;
+  State  = _Card.State;
+  if ((State == STATE_TRAN) && (_CardIsBusy() != 0)) {
+    State = STATE_PRG;
+  }
+  if ((Cmd == 13u) && ((Arg & (1uL << 15)) != 0u)) {
+    _Card.NumPolls++;
+    _Card.RespStatus = _CardQSR();
+    return;
+  }
+  Errors = 0;
+  if (Cmd != 13u) {
+    if ((State == STATE_PRG) && (Cmd != 12u)) {
+      Errors = STATUS_ILLEGAL_COMMAND;        // Only status and stop commands are accepted while programming.
+    } else {
+      Errors = _CardExecCmd(Cmd, Arg);
+    }
+  }
+  if (Errors != 0u) {
+    _Card.NumIllegal++;
+  }
+  _Card.RespStatus = Errors | ((U32)State << STATUS_STATE_SHIFT);
+  if (((_Card.State == STATE_TRAN) && (State != STATE_PRG)) || (_Card.State == STATE_STBY)) {
+    _Card.RespStatus |= STATUS_READY_FOR_DATA;
+  }
+  if ((CmdFlags & FS_MMC_CMD_FLAG_SETBUSY) != 0u) {
+    _CardWaitBusy();                          // The host waits for the end of busy after an R1b response.
+  }
+}
+
+static int _HW_GetResponse(U8 Unit, void * pData, U32 NumBytes) {
+  U8 * p;
+
+  FS_USE_PARA(Unit);
+  p = SEGGER_PTR2PTR(U8, pData);
+  memset(p, 0, NumBytes);
+  switch (_Card.RespType) {
+  case FS_MMC_RESPONSE_FORMAT_R2:
+    //
+    // CSD of an MMC V4 device. The same buffer is used for the CID.
+    //
+    _SetCSDBits(p + 1, 126, 2, 3);            // CSD_STRUCTURE
+    _SetCSDBits(p + 1, 122, 4, 4);            // SPEC_VERS
+    _SetCSDBits(p + 1,  96, 8, 0x32);         // TRAN_SPEED, 26 MHz
+    _SetCSDBits(p + 1,  80, 4, 9);            // READ_BL_LEN
+    _SetCSDBits(p + 1,  62, 12, 0xFFF);       // C_SIZE
+    _SetCSDBits(p + 1,  47, 3, 7);            // C_SIZE_MULT
+    break;
+  case FS_MMC_RESPONSE_FORMAT_R3:
+    p[1] = 0xC0;                              // Power up finished, high capacity.
+    p[2] = 0xFF;
+    p[3] = 0x80;
+    break;
+  default:
+    p[1] = (U8)(_Card.RespStatus >> 24);
+    p[2] = (U8)(_Card.RespStatus >> 16);
+    p[3] = (U8)(_Card.RespStatus >> 8);
+    p[4] = (U8)_Card.RespStatus;
+    break;
+  }
+  return FS_MMC_CARD_NO_ERROR;
+}
+
+static int _HW_ReadData(U8 Unit, void * pData, unsigned BlockSize, unsigned NumBlocks) {
+  FS_USE_PARA(Unit);
+  return _CardTransfer(SEGGER_PTR2PTR(U8, pData), NULL, BlockSize, NumBlocks);
+}
+
+static int _HW_WriteData(U8 Unit, const void * pData, unsigned BlockSize, unsigned NumBlocks) {
+  FS_USE_PARA(Unit);
+  return _CardTransfer(NULL, SEGGER_CONSTPTR2PTR(const U8, pData), BlockSize, NumBlocks);
+}
+
+static void _HW_SetDataPointer(U8 Unit, const void * pData) {
+  FS_USE_PARA(Unit);
+  FS_USE_PARA(pData);
+}
+
+static void _HW_SetHWBlockLen(U8 Unit, U16 BlockSize) {
+  FS_USE_PARA(Unit);
+  FS_USE_PARA(BlockSize);
+}
+
+static void _HW_SetHWNumBlocks(U8 Unit, U16 NumBlocks) {
+  FS_USE_PARA(Unit);
+  FS_USE_PARA(NumBlocks);
+}
+
+static int _HW_ContinueWrite(U8 Unit, unsigned CmdFlags, U32 Arg, const void * pData, unsigned BlockSize, unsigned NumBlocks) {
+  _CardWaitBusy();
+  _HW_SendCmd(Unit, 25, CmdFlags, FS_MMC_RESPONSE_FORMAT_R1, Arg);
+  if ((_Card.RespStatus & STATUS_ILLEGAL_COMMAND) != 0u) {
+    return FS_MMC_CARD_WRITE_GENERIC_ERROR;
+  }
+  if (_Card.NumStreamErrors != 0u) {
+    _Card.NumStreamErrors--;
+    _Card.IsDataError = 1;
+  }
+  return _HW_WriteData(Unit, pData, BlockSize, NumBlocks);
+}
+
+static U16 _HW_GetMaxReadBurst(U8 Unit) {
+  FS_USE_PARA(Unit);
+  return (U16)MAX_BURST;
+}
+
+static U16 _HW_GetMaxWriteBurst(U8 Unit) {
+  FS_USE_PARA(Unit);
+  return (U16)MAX_BURST;
+}
+
+static const FS_MMC_HW_TYPE_CM _HW_CardModel = {
+  _HW_InitHW,
+  _HW_Delay,
+  _HW_IsPresent,
+  _HW_IsWriteProtected,
+  _HW_SetMaxSpeed,
+  _HW_SetResponseTimeOut,
+  _HW_SetReadDataTimeOut,
+  _HW_SendCmd,
+  _HW_GetResponse,
+  _HW_ReadData,
+  _HW_WriteData,
+  _HW_SetDataPointer,
+  _HW_SetHWBlockLen,
+  _HW_SetHWNumBlocks,
+  _HW_GetMaxReadBurst,
+  _HW_GetMaxWriteBurst,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  _HW_ContinueWrite
+};
+
+/*********************************************************************
+*
+*       Static code, test
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _FillPattern
+*/
+static void _FillPattern(U8 * pData, U32 NumBytes, U32 Seed) {
+  U32 i;
+
+  for (i = 0; i < NumBytes; ++i) {
+    pData[i] = (U8)((i * 7u) ^ (Seed * 13u) ^ (i >> 9));
+  }
+}
+
+/*********************************************************************
+*
+*       _Mount
+*
+*  Function description
+*    Initializes the driver against a freshly powered up card model.
+*/
+static int _Mount(U8 Unit, unsigned CmdQDepth, U8 IsCmdQAllowed) {
+  int r;
+
+  (void)FS_MMC_CM_Driver.pfIoCtl(Unit, FS_CMD_UNMOUNT_FORCED, 0, NULL);
+  _CardReset(CmdQDepth);
+  FS_MMC_CM_AllowCommandQueue(Unit, IsCmdQAllowed);
+  r = FS_MMC_CM_Driver.pfInitMedium(Unit);
+  FS_MMC_CM_ResetStatCounters(Unit);
+  memset(_Card.aCmdCnt, 0, sizeof(_Card.aCmdCnt));
+  return r;
+}
+
+/*********************************************************************
+*
+*       _TestQueueDepth
+*
+*  Function description
+*    Checks that the driver keeps the queue of the device filled up to
+*    the reported depth and that tasks executed out of order deliver
+*    the correct data.
+*/
+static void _TestQueueDepth(U8 Unit) {
+  FS_MMC_STAT_COUNTERS Stat;
+  int                  r;
+
+  r = _Mount(Unit, 4, 1);
+  TEST_CHECK_EQ(r, 0);
+  _FillPattern(_aWrite, sizeof(_aWrite), 1);
+  r = FS_MMC_CM_Driver.pfWrite(Unit, 100, _aWrite, 128, 0);
+  TEST_CHECK_EQ(r, 0);
+  FS_MMC_CM_GetStatCounters(Unit, &Stat);
+  TEST_CHECK_EQ(Stat.CmdQTaskCnt, 128u / MAX_BURST);
+  TEST_CHECK_EQ(Stat.CmdQDepthMax, 4u);
+  TEST_CHECK_EQ(Stat.CmdQDiscardCnt, 0u);
+  TEST_CHECK_EQ(_Card.NumTasksQueuedMax, 4u);
+  TEST_CHECK_EQ(_Card.aCmdCnt[47], 128u / MAX_BURST);
+  TEST_CHECK_EQ(_Card.aCmdCnt[25] + _Card.aCmdCnt[24], 0u);
+  TEST_CHECK(memcmp(&_Card.aData[100 * BYTES_PER_SECTOR], _aWrite, sizeof(_aWrite)) == 0);
+  //
+  // Read back with the tasks becoming ready in reverse order.
+  //
+  _Card.IsReadyReversed = 1;
+  _Card.ReadyDelay      = 2;
+  memset(_aRead, 0, sizeof(_aRead));
+  r = FS_MMC_CM_Driver.pfRead(Unit, 100, _aRead, 128);
+  TEST_CHECK_EQ(r, 0);
+  TEST_CHECK(memcmp(_aRead, _aWrite, sizeof(_aRead)) == 0);
+  TEST_CHECK_EQ(_Card.aCmdCnt[46], 128u / MAX_BURST);
+  TEST_CHECK_EQ(_Card.aCmdCnt[18] + _Card.aCmdCnt[17], 0u);
+  TEST_CHECK(_Card.NumOutOfOrder != 0u);
+  TEST_CHECK_EQ(_Card.NumIllegal, 0u);
+  //
+  // A request shorter than the queue depth queues only the tasks it needs.
+  //
+  FS_MMC_CM_ResetStatCounters(Unit);
+  r = FS_MMC_CM_Driver.pfRead(Unit, 0, _aRead, 2 * MAX_BURST);
+  TEST_CHECK_EQ(r, 0);
+  FS_MMC_CM_GetStatCounters(Unit, &Stat);
+  TEST_CHECK_EQ(Stat.CmdQDepthMax, 2u);
+}
+
+/*********************************************************************
+*
+*       _TestReadRetry
+*
+*  Function description
+*    A data error of a queued read discards the queue and the driver
+*    repeats the read with regular commands after disabling the queue.
+*/
+static void _TestReadRetry(U8 Unit) {
+  FS_MMC_STAT_COUNTERS Stat;
+  int                  r;
+  U32                  NumCmdQTasks;
+
+  r = _Mount(Unit, 4, 1);
+  TEST_CHECK_EQ(r, 0);
+  _FillPattern(&_Card.aData[200 * BYTES_PER_SECTOR], 128 * BYTES_PER_SECTOR, 2);
+  _Card.NumExecErrors = 1;
+  memset(_aRead, 0, sizeof(_aRead));
+  r = FS_MMC_CM_Driver.pfRead(Unit, 200, _aRead, 128);
+  TEST_CHECK_EQ(r, 0);
+  TEST_CHECK(memcmp(_aRead, &_Card.aData[200 * BYTES_PER_SECTOR], sizeof(_aRead)) == 0);
+  FS_MMC_CM_GetStatCounters(Unit, &Stat);
+  TEST_CHECK_EQ(Stat.CmdQDiscardCnt, 1u);
+  TEST_CHECK_EQ(Stat.ReadErrorCnt, 1u);
+  TEST_CHECK_EQ(_Card.aCmdCnt[48], 1u);
+  TEST_CHECK_EQ(_Card.aCmdCnt[17], 128u);          // Fallback to single sector reads.
+  TEST_CHECK_EQ(_Card.IsCmdQEnabled, 0);
+  TEST_CHECK_EQ(_Card.NumIllegal, 0u);
+  //
+  // The next request uses the command queue again.
+  //
+  NumCmdQTasks = _Card.aCmdCnt[44];
+  r = FS_MMC_CM_Driver.pfRead(Unit, 200, _aRead, 32);
+  TEST_CHECK_EQ(r, 0);
+  TEST_CHECK_EQ(_Card.aCmdCnt[44] - NumCmdQTasks, 2u);
+  TEST_CHECK_EQ(_Card.IsCmdQEnabled, 1);
+}
+
+/*********************************************************************
+*
+*       _TestWriteRetry
+*
+*  Function description
+*    A data error of a queued write discards the queue and the driver
+*    writes the data again with regular commands.
+*/
+static void _TestWriteRetry(U8 Unit) {
+  FS_MMC_STAT_COUNTERS Stat;
+  int                  r;
+
+  r = _Mount(Unit, 8, 1);
+  TEST_CHECK_EQ(r, 0);
+  _FillPattern(_aWrite, sizeof(_aWrite), 3);
+  _Card.ReadyDelay    = 1;
+  _Card.NumExecErrors = 1;
+  r = FS_MMC_CM_Driver.pfWrite(Unit, 1000, _aWrite, 128, 0);
+  TEST_CHECK_EQ(r, 0);
+  TEST_CHECK(memcmp(&_Card.aData[1000 * BYTES_PER_SECTOR], _aWrite, sizeof(_aWrite)) == 0);
+  FS_MMC_CM_GetStatCounters(Unit, &Stat);
+  TEST_CHECK_EQ(Stat.CmdQDepthMax, 8u);
+  TEST_CHECK_EQ(Stat.CmdQDiscardCnt, 1u);
+  TEST_CHECK_EQ(Stat.WriteErrorCnt, 1u);
+  TEST_CHECK_EQ(_Card.aCmdCnt[48], 1u);
+  TEST_CHECK_EQ(_Card.aCmdCnt[24], 128u);          // Fallback to single sector writes.
+  TEST_CHECK_EQ(_Card.NumIllegal, 0u);
+}
+
+/*********************************************************************
+*
+*       _TestTimeout
+*
+*  Function description
+*    A device that never reports a task as ready makes the driver give
+*    up after FS_MMC_WAIT_READY_TIMEOUT queue status reads.
+*/
+static void _TestTimeout(U8 Unit) {
+  FS_MMC_STAT_COUNTERS Stat;
+  int                  r;
+
+  r = _Mount(Unit, 4, 1);
+  TEST_CHECK_EQ(r, 0);
+  _FillPattern(&_Card.aData[300 * BYTES_PER_SECTOR], 64 * BYTES_PER_SECTOR, 4);
+  _Card.IsNeverReady = 1;
+  r = FS_MMC_CM_Driver.pfRead(Unit, 300, _aRead, 64);
+  TEST_CHECK_EQ(r, 0);
+  TEST_CHECK(memcmp(_aRead, &_Card.aData[300 * BYTES_PER_SECTOR], 64 * BYTES_PER_SECTOR) == 0);
+  FS_MMC_CM_GetStatCounters(Unit, &Stat);
+  TEST_CHECK_EQ(Stat.CmdQStatusCnt, FS_MMC_WAIT_READY_TIMEOUT + 1u);
+  TEST_CHECK_EQ(Stat.CmdQDiscardCnt, 1u);
+  TEST_CHECK_EQ(_Card.aCmdCnt[46], 0u);
+  TEST_CHECK_EQ(_Card.aCmdCnt[17], 64u);
+}
+
+/*********************************************************************
+*
+*       _TestNotQueued
+*
+*  Function description
+*    The regular commands are used when the command queue is not
+*    allowed or not supported by the device.
+*/
+static void _TestNotQueued(U8 Unit) {
+  int r;
+
+  r = _Mount(Unit, 4, 0);
+  TEST_CHECK_EQ(r, 0);
+  r = FS_MMC_CM_Driver.pfRead(Unit, 0, _aRead, 64);
+  TEST_CHECK_EQ(r, 0);
+  TEST_CHECK_EQ(_Card.aCmdCnt[44], 0u);
+  TEST_CHECK_EQ(_Card.aCmdCnt[18], 64u / MAX_BURST);
+  r = _Mount(Unit, 0, 1);
+  TEST_CHECK_EQ(r, 0);
+  _FillPattern(_aWrite, sizeof(_aWrite), 5);
+  r = FS_MMC_CM_Driver.pfWrite(Unit, 0, _aWrite, 64, 0);
+  TEST_CHECK_EQ(r, 0);
+  TEST_CHECK_EQ(_Card.aCmdCnt[44], 0u);
+  TEST_CHECK_EQ(_Card.aCmdCnt[6], 0u);
+  TEST_CHECK_EQ(_Card.aCmdCnt[25], 64u / MAX_BURST);
+  TEST_CHECK(memcmp(_Card.aData, _aWrite, 64 * BYTES_PER_SECTOR) == 0);
+  TEST_CHECK_EQ(_Card.NumIllegal, 0u);
+}
+
+/*********************************************************************
+*
+*       _ReadRequests
+*
+*  Function description
+*    Reads NumReqs contiguous requests of NumSectors sectors from
+*    a device that needs ACCESS_TIME_US to fetch the data of a read.
+*
+*  Return value
+*    Elapsed time in microseconds.
+*/
+static U32 _ReadRequests(U8 Unit, U32 SectorIndex, unsigned NumReqs, U32 NumSectors) {
+  U32      TimeStart;
+  unsigned i;
+  int      r;
+
+  _Card.AccessTimeUs = ACCESS_TIME_US;
+  TimeStart = _Card.TimeUs;
+  for (i = 0; i < NumReqs; ++i) {
+    r = FS_MMC_CM_Driver.pfRead(Unit, SectorIndex + i * NumSectors, _aRead, NumSectors);
+    TEST_CHECK_EQ(r, 0);
+    TEST_CHECK(memcmp(_aRead, &_Card.aData[(SectorIndex + i * NumSectors) * BYTES_PER_SECTOR], NumSectors * BYTES_PER_SECTOR) == 0);
+  }
+  _Card.AccessTimeUs = 0;
+  return _Card.TimeUs - TimeStart;
+}
+
+/*********************************************************************
+*
+*       _TestCmdQThreshold
+*
+*  Function description
+*    Requests that fit in one task or are shorter than
+*    FS_MMC_CMDQ_MIN_SECTORS are transferred via the regular commands.
+*    Larger requests gain from the device fetching the data of the next
+*    task while the data of the current one is transferred.
+*/
+static void _TestCmdQThreshold(U8 Unit) {
+  FS_MMC_STAT_COUNTERS Stat;
+  int                  r;
+  U32                  TimeRegular;
+  U32                  TimeQueued;
+  U32                  NumCmdsRegular;
+
+  _FillPattern(_Card.aData, NUM_SECTORS * BYTES_PER_SECTOR, 7);
+  //
+  // Small requests do not enable the command queue.
+  //
+  r = _Mount(Unit, 4, 1);
+  TEST_CHECK_EQ(r, 0);
+  TimeQueued = _ReadRequests(Unit, 0, NUM_SMALL_READS, SECTORS_PER_REQ);
+  FS_MMC_CM_GetStatCounters(Unit, &Stat);
+  TEST_CHECK_EQ(Stat.CmdQTaskCnt, 0u);
+  TEST_CHECK_EQ(_Card.aCmdCnt[6], 0u);
+  TEST_CHECK_EQ(_Card.aCmdCnt[18], NUM_SMALL_READS);
+  TEST_CHECK_EQ(_Card.IsCmdQEnabled, 0);
+  r = FS_MMC_CM_Driver.pfRead(Unit, 0, _aRead, MAX_BURST);
+  TEST_CHECK_EQ(r, 0);
+  r = FS_MMC_CM_Driver.pfRead(Unit, 0, _aRead, FS_MMC_CMDQ_MIN_SECTORS - 1u);
+  TEST_CHECK_EQ(r, 0);
+  TEST_CHECK_EQ(_Card.aCmdCnt[44], 0u);
+  r = _Mount(Unit, 4, 0);
+  TEST_CHECK_EQ(r, 0);
+  TimeRegular = _ReadRequests(Unit, 0, NUM_SMALL_READS, SECTORS_PER_REQ);
+  TEST_CHECK_EQ(TimeQueued, TimeRegular);
+  printf("%2u x %2u sectors, regular: %5lu us, queue allowed: %5lu us\n",
+         NUM_SMALL_READS, SECTORS_PER_REQ, (unsigned long)TimeRegular, (unsigned long)TimeQueued);
+  //
+  // Large requests are split in tasks that are queued.
+  //
+  TimeRegular = _ReadRequests(Unit, 0, NUM_LARGE_READS, SECTORS_PER_LARGE_READ);
+  FS_MMC_CM_GetStatCounters(Unit, &Stat);
+  NumCmdsRegular = Stat.CmdExecCnt;
+  r = _Mount(Unit, 4, 1);
+  TEST_CHECK_EQ(r, 0);
+  TimeQueued = _ReadRequests(Unit, 0, NUM_LARGE_READS, SECTORS_PER_LARGE_READ);
+  FS_MMC_CM_GetStatCounters(Unit, &Stat);
+  TEST_CHECK_EQ(Stat.CmdQTaskCnt, NUM_LARGE_READS * (SECTORS_PER_LARGE_READ / MAX_BURST));
+  TEST_CHECK_EQ(Stat.CmdQDepthMax, 4u);
+  TEST_CHECK_EQ(_Card.aCmdCnt[18], 0u);
+  TEST_CHECK(TimeQueued < TimeRegular);
+  printf("%2u x %2u sectors, regular: %5lu us (%3lu commands), queued: %5lu us (%3lu commands, %lu QSR reads)\n",
+         NUM_LARGE_READS, SECTORS_PER_LARGE_READ, (unsigned long)TimeRegular, (unsigned long)NumCmdsRegular,
+         (unsigned long)TimeQueued, (unsigned long)Stat.CmdExecCnt, (unsigned long)Stat.CmdQStatusCnt);
+  //
+  // A small request disables the command queue of the device.
+  //
+  TEST_CHECK_EQ(_Card.IsCmdQEnabled, 1);
+  (void)_ReadRequests(Unit, 0, 1, SECTORS_PER_REQ);
+  TEST_CHECK_EQ(_Card.IsCmdQEnabled, 0);
+  TEST_CHECK_EQ(_Card.aCmdCnt[18], 1u);
+  TEST_CHECK_EQ(_Card.NumIllegal, 0u);
+  //
+  // A device that can queue only one task does not use the command queue.
+  //
+  r = _Mount(Unit, 1, 1);
+  TEST_CHECK_EQ(r, 0);
+  (void)_ReadRequests(Unit, 0, 1, SECTORS_PER_LARGE_READ);
+  TEST_CHECK_EQ(_Card.aCmdCnt[44], 0u);
+  TEST_CHECK_EQ(_Card.aCmdCnt[18], SECTORS_PER_LARGE_READ / MAX_BURST);
+}
+
+/*********************************************************************
+*
+*       _WriteSequential
+*
+*  Function description
+*    Writes NUM_STREAM_REQS contiguous requests of SECTORS_PER_REQ
+*    sectors. The application spends APP_TIME_US before each request
+*    to produce the data.
+*
+*  Return value
+*    Elapsed time in microseconds.
+*/
+static U32 _WriteSequential(U8 Unit, U32 SectorIndex) {
+  U32      TimeStart;
+  unsigned i;
+  int      r;
+
+  TimeStart = _Card.TimeUs;
+  for (i = 0; i < NUM_STREAM_REQS; ++i) {
+    _Card.TimeUs += APP_TIME_US;
+    r = FS_MMC_CM_Driver.pfWrite(Unit, SectorIndex + i * SECTORS_PER_REQ, &_aWrite[i * SECTORS_PER_REQ * BYTES_PER_SECTOR], SECTORS_PER_REQ, 0);
+    TEST_CHECK_EQ(r, 0);
+  }
+  return _Card.TimeUs - TimeStart;
+}
+
+/*********************************************************************
+*
+*       _CompareStreaming
+*
+*  Function description
+*    Writes the same sequential data with the regular write commands
+*    and in streaming write mode to a device that stays busy for
+*    PROG_TIME_US after each write. Leaves the streaming write mode
+*    enabled and the stream open.
+*
+*  Parameters
+*    Unit           Index of the driver instance.
+*    sDevice        Name of the device type printed with the results.
+*    pTimeRegular   [OUT] Elapsed time using the regular write commands.
+*    pTimeStream    [OUT] Elapsed time in streaming write mode.
+*/
+static void _CompareStreaming(U8 Unit, const char * sDevice, U32 * pTimeRegular, U32 * pTimeStream) {
+  FS_MMC_STAT_COUNTERS Stat;
+  int                  r;
+  U32                  NumCmdsRegular;
+  U32                  NumStatusRegular;
+  U32                  NumIllegal;
+
+  NumIllegal = (_Card.IsExtCSDMissing != 0) ? 1u : 0u;       // The device refuses SEND_EXT_CSD (CMD8) at mount.
+  //
+  // Regular write commands.
+  //
+  FS_MMC_CM_AllowStreamingWrite(Unit, 0);
+  r = _Mount(Unit, 0, 0);
+  TEST_CHECK_EQ(r, 0);
+  _Card.ProgTimeUs = PROG_TIME_US;
+  *pTimeRegular = _WriteSequential(Unit, 2048);
+  FS_MMC_CM_GetStatCounters(Unit, &Stat);
+  NumCmdsRegular   = Stat.CmdExecCnt;
+  NumStatusRegular = _Card.aCmdCnt[13];
+  TEST_CHECK(Stat.WriteCmdTimeMax != 0u);
+  TEST_CHECK(Stat.WriteCmdTimeMax < 1000u);         // Sub-millisecond latencies are visible.
+  TEST_CHECK_EQ(_Card.NumIllegal, NumIllegal);
+  printf("%s, regular:   %5lu us, %3lu commands (%3lu CMD13), write command max. %lu us, avg. %lu us\n",
+         sDevice, (unsigned long)*pTimeRegular, (unsigned long)NumCmdsRegular, (unsigned long)NumStatusRegular,
+         (unsigned long)Stat.WriteCmdTimeMax, (unsigned long)(Stat.WriteCmdTime / Stat.WriteCmdCnt));
+  TEST_CHECK(memcmp(&_Card.aData[2048 * BYTES_PER_SECTOR], _aWrite, NUM_STREAM_REQS * SECTORS_PER_REQ * BYTES_PER_SECTOR) == 0);
+  //
+  // Streaming write mode.
+  //
+  FS_MMC_CM_AllowStreamingWrite(Unit, 1);
+  r = _Mount(Unit, 0, 0);
+  TEST_CHECK_EQ(r, 0);
+  _Card.ProgTimeUs = PROG_TIME_US;
+  *pTimeStream = _WriteSequential(Unit, 2048);
+  FS_MMC_CM_GetStatCounters(Unit, &Stat);
+  TEST_CHECK_EQ(Stat.StreamOpenCnt, 1u);
+  TEST_CHECK_EQ(Stat.StreamCloseCnt, 0u);
+  TEST_CHECK_EQ(Stat.StreamSectorCnt, (NUM_STREAM_REQS - 1u) * SECTORS_PER_REQ);
+  TEST_CHECK_EQ(Stat.WaitReadyCnt, 0u);
+  TEST_CHECK_EQ(_Card.aCmdCnt[25], NUM_STREAM_REQS);
+  TEST_CHECK_EQ(_Card.aCmdCnt[12], NUM_STREAM_REQS);
+  TEST_CHECK_EQ(_Card.aCmdCnt[23], 0u);
+  TEST_CHECK(_Card.aCmdCnt[13] < NumStatusRegular);
+  TEST_CHECK(Stat.CmdExecCnt < NumCmdsRegular);
+  TEST_CHECK(Stat.WriteCmdTimeMax < 1000u);
+  TEST_CHECK_EQ(_Card.NumIllegal, NumIllegal);
+  printf("%s, streaming: %5lu us, %3lu commands (%3lu CMD13), write command max. %lu us, avg. %lu us, %lu busy waits in the HW layer\n",
+         sDevice, (unsigned long)*pTimeStream, (unsigned long)Stat.CmdExecCnt, (unsigned long)_Card.aCmdCnt[13],
+         (unsigned long)Stat.WriteCmdTimeMax, (unsigned long)(Stat.WriteCmdTime / Stat.WriteCmdCnt),
+         (unsigned long)_Card.NumBusyWaits);
+  TEST_CHECK(memcmp(&_Card.aData[2048 * BYTES_PER_SECTOR], _aWrite, NUM_STREAM_REQS * SECTORS_PER_REQ * BYTES_PER_SECTOR) == 0);
+}
+
+/*********************************************************************
+*
+*       _TestStreaming
+*
+*  Function description
+*    Checks the streaming write mode against the regular write commands.
+*    The gain is largest on devices that need STOP_TRANSMISSION (CMD12)
+*    because the regular path waits for the end of busy after it.
+*    Devices with close-ended transfers save the SEND_STATUS (CMD13) polls.
+*/
+static void _TestStreaming(U8 Unit) {
+  FS_MMC_STAT_COUNTERS Stat;
+  int                  r;
+  U32                  TimeRegular;
+  U32                  TimeStream;
+  unsigned             i;
+
+  _FillPattern(_aWrite, sizeof(_aWrite), 6);
+  _Card.IsExtCSDMissing = 1;
+  _CompareStreaming(Unit, "MMC (open-ended)", &TimeRegular, &TimeStream);
+  TEST_CHECK(TimeStream < (TimeRegular * 3u) / 4u);
+  _Card.IsExtCSDMissing = 0;
+  _CompareStreaming(Unit, "eMMC (CMD23)    ", &TimeRegular, &TimeStream);
+  TEST_CHECK(TimeStream <= TimeRegular);
+  //
+  // A read closes the stream. It has to wait for the card to finish programming.
+  //
+  r = FS_MMC_CM_Driver.pfRead(Unit, 2048, _aRead, SECTORS_PER_REQ);
+  TEST_CHECK_EQ(r, 0);
+  TEST_CHECK(memcmp(_aRead, _aWrite, SECTORS_PER_REQ * BYTES_PER_SECTOR) == 0);
+  FS_MMC_CM_GetStatCounters(Unit, &Stat);
+  TEST_CHECK_EQ(Stat.StreamCloseCnt, 1u);
+  TEST_CHECK_EQ(_Card.NumIllegal, 0u);
+  //
+  // A write that does not follow the last written sector opens a new stream.
+  // FS_CMD_SYNC closes it and returns when the card is ready.
+  //
+  r = FS_MMC_CM_Driver.pfWrite(Unit, 3000, _aWrite, SECTORS_PER_REQ, 0);
+  TEST_CHECK_EQ(r, 0);
+  r = FS_MMC_CM_Driver.pfWrite(Unit, 3100, _aWrite, SECTORS_PER_REQ, 0);
+  TEST_CHECK_EQ(r, 0);
+  r = FS_MMC_CM_Driver.pfIoCtl(Unit, FS_CMD_SYNC, 0, NULL);
+  TEST_CHECK_EQ(r, 0);
+  TEST_CHECK_EQ(_CardIsBusy(), 0);
+  FS_MMC_CM_GetStatCounters(Unit, &Stat);
+  TEST_CHECK_EQ(Stat.StreamOpenCnt, 3u);
+  TEST_CHECK_EQ(Stat.StreamCloseCnt, 3u);
+  TEST_CHECK_EQ(_Card.NumIllegal, 0u);
+  //
+  // A data error of a streaming transfer is repeated with single sector writes.
+  //
+  for (i = 0; i < 2u; ++i) {
+    _Card.NumStreamErrors = i;
+    r = FS_MMC_CM_Driver.pfWrite(Unit, 3200 + i * 100u, &_aWrite[BYTES_PER_SECTOR], SECTORS_PER_REQ, 0);
+    TEST_CHECK_EQ(r, 0);
+  }
+  r = FS_MMC_CM_Driver.pfIoCtl(Unit, FS_CMD_SYNC, 0, NULL);
+  TEST_CHECK_EQ(r, 0);
+  TEST_CHECK(memcmp(&_Card.aData[3300 * BYTES_PER_SECTOR], &_aWrite[BYTES_PER_SECTOR], SECTORS_PER_REQ * BYTES_PER_SECTOR) == 0);
+  FS_MMC_CM_GetStatCounters(Unit, &Stat);
+  TEST_CHECK_EQ(Stat.WriteErrorCnt, 1u);
+  TEST_CHECK_EQ(_Card.NumIllegal, 0u);
+  FS_MMC_CM_AllowStreamingWrite(Unit, 0);
+}
+
+/*********************************************************************
+*
+*       Public code
+*
+**********************************************************************
+*/
+int main(void) {
+  int Unit;
+
+  FS_Global.MaxSectorSize = BYTES_PER_SECTOR;
+  Unit = FS_MMC_CM_Driver.pfAddDevice();
+  TEST_CHECK(Unit >= 0);
+  if (Unit >= 0) {
+    FS_MMC_CM_SetHWType((U8)Unit, &_HW_CardModel);
+    _TestQueueDepth((U8)Unit);
+    _TestReadRetry((U8)Unit);
+    _TestWriteRetry((U8)Unit);
+    _TestTimeout((U8)Unit);
+    _TestNotQueued((U8)Unit);
+    _TestCmdQThreshold((U8)Unit);
+    _TestStreaming((U8)Unit);
+  }
+  return TEST_Report("FS_MMC_CM_CmdQTest");
+}
+
+/*************************** End of file ****************************/
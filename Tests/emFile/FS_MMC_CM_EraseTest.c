@@ -0,0 +1,824 @@
+/*********************************************************************
+*                                                                    *
+*       emFile * File system for embedded applications               *
+*                                                                    *
+**********************************************************************
+----------------------------------------------------------------------
+File        : FS_MMC_CM_EraseTest.c
+Purpose     : Host test of the free sector handling of the Card Mode
+              MMC/SD driver for SD cards. The driver runs against a model
+              of a standard capacity SD card that implements the
+              identification sequence, the data transfer commands and
+              the erase commands (CMD32, CMD33, CMD38). Like a real card,
+              a model without ERASE_BLK_EN erases the complete erase
+              sectors that contain the requested range. The model stays
+              busy for ERASE_TIME_US after an erase command.
+-------------------------- END-OF-HEADER -----------------------------
+*/
+
+/*********************************************************************
+*
+*       #include Section
+*
+**********************************************************************
+*/
+#include <stdlib.h>
+#include <string.h>
+#include "FS_Int.h"
+#include "test_check.h"
+
+/*********************************************************************
+*
+*       Defines, configurable
+*
+**********************************************************************
+*/
+#define NUM_SECTORS               4096u   // Capacity of the modeled SD card.
+#define MAX_BURST                 16u     // Maximum number of sectors per data transfer reported by the HW layer.
+#define ERASE_SECTOR_SIZE         32u     // Number of write blocks the card erases at once when ERASE_BLK_EN is 0.
+#define CMD_TIME_US               4u      // Time it takes to send a command and receive the response.
+#define ERASE_TIME_US             20000u  // Time the card signals busy after an erase command.
+
+/*********************************************************************
+*
+*       Defines, fixed
+*
+**********************************************************************
+*/
+#define BYTES_PER_SECTOR          512u
+#define NUM_CMDS                  64u
+#define CARD_RCA                  0x1234u
+
+/*********************************************************************
+*
+*       Card states
+*/
+#define STATE_IDLE                0u
+#define STATE_READY               1u
+#define STATE_IDENT               2u
+#define STATE_STBY                3u
+#define STATE_TRAN                4u
+#define STATE_DATA                5u
+#define STATE_RCV                 6u
+#define STATE_PRG                 7u
+
+/*********************************************************************
+*
+*       Card status bits
+*/
+#define STATUS_ILLEGAL_COMMAND    (1uL << 22)
+#define STATUS_READY_FOR_DATA     (1uL << 8)
+#define STATUS_APP_CMD            (1uL << 5)
+#define STATUS_STATE_SHIFT        9
+
+/*********************************************************************
+*
+*       Types of data read from the card
+*/
+#define DATA_TYPE_SECTOR          0
+#define DATA_TYPE_SCR             1
+
+/*********************************************************************
+*
+*       Local data types
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       CARD
+*/
+typedef struct {
+  //
+  // Configuration of the model.
+  //
+  int       IsEraseBlkEn;         // Value of ERASE_BLK_EN in the CSD register.
+  int       IsErasedValueOne;     // Value of DATA_STAT_AFTER_ERASE in the SCR register.
+  //
+  // Card state.
+  //
+  unsigned  State;
+  int       IsAppCmd;
+  int       DataType;
+  U32       DataSector;
+  U32       EraseStart;
+  U32       EraseEnd;
+  U32       TimeUs;               // Current time in microseconds.
+  U32       BusyUntil;            // Time at which the card releases the busy signal.
+  //
+  // Response of the last command.
+  //
+  U8        aResp[6];
+  unsigned  RespCmd;
+  unsigned  RespType;
+  //
+  // Statistics.
+  //
+  U32       aCmdCnt[NUM_CMDS];
+  U32       NumIllegal;
+  U32       NumErases;
+  U32       FirstSectorErased;
+  U32       LastSectorErased;
+  //
+  // Storage.
+  //
+  U8        aData[NUM_SECTORS * BYTES_PER_SECTOR];
+} CARD;
+
+/*********************************************************************
+*
+*       Static data
+*
+**********************************************************************
+*/
+static CARD _Card;
+static U8   _aSectorBuffer[BYTES_PER_SECTOR];
+static U8   _aPattern[NUM_SECTORS * BYTES_PER_SECTOR];
+static U8   _aRead[64 * BYTES_PER_SECTOR];
+
+/*********************************************************************
+*
+*       Public data
+*
+**********************************************************************
+*/
+FS_GLOBAL FS_Global;
+
+/*********************************************************************
+*
+*       Stubs of the file system core
+*
+**********************************************************************
+*/
+void * FS_AllocZeroed(I32 NumBytes) {
+  return calloc(1, (size_t)NumBytes);
+}
+
+void * FS_GetFreeMem(I32 * pNumBytes) {
+  *pNumBytes = 0;
+  return NULL;
+}
+
+U8 * FS__AllocSectorBuffer(void) {
+  return _aSectorBuffer;
+}
+
+void FS__FreeSectorBuffer(const void * pBuffer) {
+  FS_USE_PARA(pBuffer);
+}
+
+U32 FS_LoadU32BE(const U8 * pBuffer) {
+  return ((U32)pBuffer[0] << 24) | ((U32)pBuffer[1] << 16) | ((U32)pBuffer[2] << 8) | (U32)pBuffer[3];
+}
+
+U32 FS_LoadU32LE(const U8 * pBuffer) {
+  return ((U32)pBuffer[3] << 24) | ((U32)pBuffer[2] << 16) | ((U32)pBuffer[1] << 8) | (U32)pBuffer[0];
+}
+
+U32 FS_X_OS_GetTime(void) {
+  return _Card.TimeUs / 1000u;
+}
+
+/*********************************************************************
+*
+*       Static code, card model
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _SetRegBits
+*
+*  Function description
+*    Stores a value to a bit field of a 128-bit register in response format.
+*/
+static void _SetRegBits(U8 * pReg, unsigned FirstBit, unsigned NumBits, U32 Value) {
+  unsigned i;
+  unsigned Bit;
+
+  for (i = 0; i < NumBits; ++i) {
+    if ((Value & (1uL << i)) != 0u) {
+      Bit = FirstBit + i;
+      pReg[15u - (Bit >> 3)] |= (U8)(1u << (Bit & 7u));
+    }
+  }
+}
+
+/*********************************************************************
+*
+*       _CardReset
+*
+*  Function description
+*    Powers up the modeled SD card. The configuration and the data are kept.
+*/
+static void _CardReset(void) {
+  _Card.State     = STATE_IDLE;
+  _Card.IsAppCmd  = 0;
+  _Card.BusyUntil = 0;
+}
+
+/*********************************************************************
+*
+*       _CardIsBusy
+*/
+static int _CardIsBusy(void) {
+  return (_Card.TimeUs < _Card.BusyUntil) ? 1 : 0;
+}
+
+/*********************************************************************
+*
+*       _CardErase
+*
+*  Function description
+*    Handles ERASE (CMD38). A card without ERASE_BLK_EN erases
+*    the complete erase sectors that contain the first and the last
+*    write block of the range.
+*/
+static void _CardErase(void) {
+  U32 First;
+  U32 Last;
+
+  First = _Card.EraseStart;
+  Last  = _Card.EraseEnd;
+  if (_Card.IsEraseBlkEn == 0) {
+    First = (First / ERASE_SECTOR_SIZE) * ERASE_SECTOR_SIZE;
+    Last  = (Last  / ERASE_SECTOR_SIZE) * ERASE_SECTOR_SIZE + ERASE_SECTOR_SIZE - 1u;
+  }
+  memset(&_Card.aData[First * BYTES_PER_SECTOR], (_Card.IsErasedValueOne != 0) ? 0xFF : 0x00, (Last - First + 1u) * BYTES_PER_SECTOR);
+  _Card.NumErases++;
+  _Card.FirstSectorErased = First;
+  _Card.LastSectorErased  = Last;
+  _Card.BusyUntil         = _Card.TimeUs + ERASE_TIME_US;
+}
+
+/*********************************************************************
+*
+*       _CardExecCmd
+*
+*  Function description
+*    Executes a command and returns the error bits of the card status.
+*/
+static U32 _CardExecCmd(unsigned Cmd, U32 Arg) {
+  U32 Errors;
+  int IsAppCmd;
+
+  Errors         = 0;
+  IsAppCmd       = _Card.IsAppCmd;
+  _Card.IsAppCmd = 0;
+  if (IsAppCmd != 0) {
+    switch (Cmd) {
+    case 6:                                   // SET_BUS_WIDTH
+    case 23:                                  // SET_WR_BLK_ERASE_COUNT
+    case 42:                                  // SET_CLR_CARD_DETECT
+      break;
+    case 41:                                  // SD_SEND_OP_COND
+      _Card.State = STATE_READY;
+      break;
+    case 51:                                  // SEND_SCR
+      _Card.DataType = DATA_TYPE_SCR;
+      _Card.State    = STATE_DATA;
+      break;
+    default:
+      Errors = STATUS_ILLEGAL_COMMAND;
+      break;
+    }
+    return Errors;
+  }
+  switch (Cmd) {
+  case 0:
+    _CardReset();
+    break;
+  case 2:
+    _Card.State = STATE_IDENT;
+    break;
+  case 3:
+    _Card.State = STATE_STBY;
+    break;
+  case 7:
+    _Card.State = ((Arg >> 16) == CARD_RCA) ? STATE_TRAN : STATE_STBY;
+    break;
+  case 8:
+  case 9:
+  case 13:
+  case 16:
+    break;
+  case 12:
+    _Card.State = STATE_TRAN;
+    break;
+  case 17:
+  case 18:
+  case 24:
+  case 25:
+    _Card.DataType   = DATA_TYPE_SECTOR;
+    _Card.DataSector = Arg / BYTES_PER_SECTOR;          // Standard capacity cards are byte addressed.
+    _Card.State      = ((Cmd == 17u) || (Cmd == 18u)) ? STATE_DATA : STATE_RCV;
+    break;
+  case 32:
+    _Card.EraseStart = Arg / BYTES_PER_SECTOR;
+    break;
+  case 33:
+    _Card.EraseEnd   = Arg / BYTES_PER_SECTOR;
+    break;
+  case 38:
+    if ((_Card.EraseEnd < _Card.EraseStart) || (_Card.EraseEnd >= NUM_SECTORS)) {
+      Errors = STATUS_ILLEGAL_COMMAND;
+      break;
+    }
+    _CardErase();
+    break;
+  case 55:
+    _Card.IsAppCmd = 1;
+    break;
+  default:
+    Errors = STATUS_ILLEGAL_COMMAND;
+    break;
+  }
+  return Errors;
+}
+
+/*********************************************************************
+*
+*       _CardTransfer
+*
+*  Function description
+*    Exchanges data with the card.
+*/
+static int _CardTransfer(U8 * pData, const U8 * pDataConst, unsigned BlockSize, unsigned NumBlocks) {
+  U32 Off;
+
+  if (_Card.DataType == DATA_TYPE_SCR) {
+    memset(pData, 0, BlockSize);
+    pData[0] = 0x02;                                    // SCR_STRUCTURE 0, SD_SPEC 2 (version 2.00)
+    pData[1] = 0x01;                                    // SD_BUS_WIDTHS 1 bit
+    if (_Card.IsErasedValueOne != 0) {
+      pData[1] |= 0x80u;                                // DATA_STAT_AFTER_ERASE
+    }
+    _Card.DataType = DATA_TYPE_SECTOR;
+    _Card.State    = STATE_TRAN;
+    return FS_MMC_CARD_NO_ERROR;
+  }
+  if ((_Card.DataSector + NumBlocks) > NUM_SECTORS) {
+    return (pData != NULL) ? FS_MMC_CARD_READ_GENERIC_ERROR : FS_MMC_CARD_WRITE_GENERIC_ERROR;
+  }
+  Off = _Card.DataSector * BYTES_PER_SECTOR;
+  if (pData != NULL) {
+    memcpy(pData, &_Card.aData[Off], BlockSize * NumBlocks);
+  } else {
+    memcpy(&_Card.aData[Off], pDataConst, BlockSize * NumBlocks);
+  }
+  _Card.DataSector += NumBlocks;
+  return FS_MMC_CARD_NO_ERROR;
+}
+
+/*********************************************************************
+*
+*       Static code, hardware layer
+*
+**********************************************************************
+*/
+static void _HW_InitHW(U8 Unit) {
+  FS_USE_PARA(Unit);
+}
+
+static void _HW_Delay(int ms) {
+  FS_USE_PARA(ms);
+}
+
+static int _HW_IsPresent(U8 Unit) {
+  FS_USE_PARA(Unit);
+  return FS_MEDIA_IS_PRESENT;
+}
+
+static int _HW_IsWriteProtected(U8 Unit) {
+  FS_USE_PARA(Unit);
+  return 0;
+}
+
+static U16 _HW_SetMaxSpeed(U8 Unit, U16 MaxFreq) {
+  FS_USE_PARA(Unit);
+  return MaxFreq;
+}
+
+static void _HW_SetResponseTimeOut(U8 Unit, U32 Value) {
+  FS_USE_PARA(Unit);
+  FS_USE_PARA(Value);
+}
+
+static void _HW_SetReadDataTimeOut(U8 Unit, U32 Value) {
+  FS_USE_PARA(Unit);
+  FS_USE_PARA(Value);
+}
+
+static void _HW_SendCmd(U8 Unit, unsigned Cmd, unsigned CmdFlags, unsigned ResponseType, U32 Arg) {
+  U32      Errors;
+  U32      Status;
+  unsigned State;
+
+  FS_USE_PARA(Unit);
+  _Card.aCmdCnt[Cmd & (NUM_CMDS - 1u)]++;
+  _Card.TimeUs  += CMD_TIME_US;
+  _Card.RespCmd  = Cmd;
+  _Card.RespType = ResponseType;
+  State = _Card.State;
+  if ((State == STATE_TRAN) && (_CardIsBusy() != 0)) {
+    State = STATE_PRG;
+  }
+  if ((State == STATE_PRG) && (Cmd != 13u) && (Cmd != 12u)) {
+    Errors = STATUS_ILLEGAL_COMMAND;          // Only status and stop commands are accepted while erasing.
+  } else {
+    Errors = _CardExecCmd(Cmd, Arg);
+  }
+  if (Errors != 0u) {
+    _Card.NumIllegal++;
+  }
+  memset(_Card.aResp, 0, sizeof(_Card.aResp));
+  _Card.aResp[0] = (U8)Cmd;
+  switch (Cmd) {
+  case 3:
+    _Card.aResp[1] = (U8)(CARD_RCA >> 8);
+    _Card.aResp[2] = (U8)CARD_RCA;
+    break;
+  case 8:
+    _Card.aResp[3] = (U8)((Arg >> 8) & 0xFu);   // Voltage accepted.
+    _Card.aResp[4] = (U8)Arg;                   // Check pattern.
+    break;
+  default:
+    Status = Errors | ((U32)State << STATUS_STATE_SHIFT);
+    if ((State == STATE_TRAN) || (State == STATE_STBY)) {
+      Status |= STATUS_READY_FOR_DATA;
+    }
+    if (_Card.IsAppCmd != 0) {
+      Status |= STATUS_APP_CMD;
+    }
+    _Card.aResp[1] = (U8)(Status >> 24);
+    _Card.aResp[2] = (U8)(Status >> 16);
+    _Card.aResp[3] = (U8)(Status >> 8);
+    _Card.aResp[4] = (U8)Status;
+    break;
+  }
+  if ((CmdFlags & FS_MMC_CMD_FLAG_SETBUSY) != 0u) {
+    if (_CardIsBusy() != 0) {
+      _Card.TimeUs = _Card.BusyUntil;         // The host waits for the end of busy after an R1b response.
+    }
+  }
+}
+
+static int _HW_GetResponse(U8 Unit, void * pData, U32 NumBytes) {
+  U8 * p;
+
+  FS_USE_PARA(Unit);
+  p = SEGGER_PTR2PTR(U8, pData);
+  memset(p, 0, NumBytes);
+  switch (_Card.RespType) {
+  case FS_MMC_RESPONSE_FORMAT_R2:
+    if (_Card.RespCmd == 9u) {
+      //
+      // CSD version 1.0 of a standard capacity SD card.
+      //
+      _SetRegBits(p + 1,  96, 8, 0x32);                     // TRAN_SPEED, 25 MHz
+      _SetRegBits(p + 1,  84, 12, 0x1B5);                   // CCC, no class 10 (switch function)
+      _SetRegBits(p + 1,  80, 4, 9);                        // READ_BL_LEN
+      _SetRegBits(p + 1,  62, 12, (NUM_SECTORS >> 9) - 1u); // C_SIZE
+      _SetRegBits(p + 1,  47, 3, 7);                        // C_SIZE_MULT
+      _SetRegBits(p + 1,  46, 1, (U32)_Card.IsEraseBlkEn);  // ERASE_BLK_EN
+      _SetRegBits(p + 1,  39, 7, ERASE_SECTOR_SIZE - 1u);   // SECTOR_SIZE
+      _SetRegBits(p + 1,  22, 4, 9);                        // WRITE_BL_LEN
+    }
+    break;
+  case FS_MMC_RESPONSE_FORMAT_R3:
+    p[1] = 0x80;                              // Power up finished, standard capacity.
+    p[2] = 0xFF;
+    p[3] = 0x80;
+    break;
+  default:
+    memcpy(p, _Card.aResp, SEGGER_MIN(NumBytes, sizeof(_Card.aResp)));
+    break;
+  }
+  return FS_MMC_CARD_NO_ERROR;
+}
+
+static int _HW_ReadData(U8 Unit, void * pData, unsigned BlockSize, unsigned NumBlocks) {
+  FS_USE_PARA(Unit);
+  return _CardTransfer(SEGGER_PTR2PTR(U8, pData), NULL, BlockSize, NumBlocks);
+}
+
+static int _HW_WriteData(U8 Unit, const void * pData, unsigned BlockSize, unsigned NumBlocks) {
+  FS_USE_PARA(Unit);
+  return _CardTransfer(NULL, SEGGER_CONSTPTR2PTR(const U8, pData), BlockSize, NumBlocks);
+}
+
+static void _HW_SetDataPointer(U8 Unit, const void * pData) {
+  FS_USE_PARA(Unit);
+  FS_USE_PARA(pData);
+}
+
+static void _HW_SetHWBlockLen(U8 Unit, U16 BlockSize) {
+  FS_USE_PARA(Unit);
+  FS_USE_PARA(BlockSize);
+}
+
+static void _HW_SetHWNumBlocks(U8 Unit, U16 NumBlocks) {
+  FS_USE_PARA(Unit);
+  FS_USE_PARA(NumBlocks);
+}
+
+static U16 _HW_GetMaxReadBurst(U8 Unit) {
+  FS_USE_PARA(Unit);
+  return (U16)MAX_BURST;
+}
+
+static U16 _HW_GetMaxWriteBurst(U8 Unit) {
+  FS_USE_PARA(Unit);
+  return (U16)MAX_BURST;
+}
+
+static const FS_MMC_HW_TYPE_CM _HW_CardModel = {
+  _HW_InitHW,
+  _HW_Delay,
+  _HW_IsPresent,
+  _HW_IsWriteProtected,
+  _HW_SetMaxSpeed,
+  _HW_SetResponseTimeOut,
+  _HW_SetReadDataTimeOut,
+  _HW_SendCmd,
+  _HW_GetResponse,
+  _HW_ReadData,
+  _HW_WriteData,
+  _HW_SetDataPointer,
+  _HW_SetHWBlockLen,
+  _HW_SetHWNumBlocks,
+  _HW_GetMaxReadBurst,
+  _HW_GetMaxWriteBurst,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL
+};
+
+/*********************************************************************
+*
+*       Static code, test
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _Mount
+*
+*  Function description
+*    Initializes the driver against a freshly powered up SD card
+*    filled with a known pattern.
+*/
+static int _Mount(U8 Unit, int IsEraseBlkEn, int IsErasedValueOne) {
+  int r;
+  U32 i;
+
+  (void)FS_MMC_CM_Driver.pfIoCtl(Unit, FS_CMD_UNMOUNT_FORCED, 0, NULL);
+  for (i = 0; i < sizeof(_aPattern); ++i) {
+    _aPattern[i] = (U8)((i * 7u) ^ (i >> 9) ^ 0x5Au);
+  }
+  memcpy(_Card.aData, _aPattern, sizeof(_Card.aData));
+  _Card.IsEraseBlkEn     = IsEraseBlkEn;
+  _Card.IsErasedValueOne = IsErasedValueOne;
+  _CardReset();
+  r = FS_MMC_CM_Driver.pfInitMedium(Unit);
+  FS_MMC_CM_ResetStatCounters(Unit);
+  memset(_Card.aCmdCnt, 0, sizeof(_Card.aCmdCnt));
+  _Card.NumIllegal = 0;
+  _Card.NumErases  = 0;
+  return r;
+}
+
+/*********************************************************************
+*
+*       _FreeSectors
+*
+*  Function description
+*    Reports sectors as free the way the file system does it.
+*/
+static int _FreeSectors(U8 Unit, U32 SectorIndex, U32 NumSectors) {
+  return FS_MMC_CM_Driver.pfIoCtl(Unit, FS_CMD_FREE_SECTORS, (I32)SectorIndex, &NumSectors);
+}
+
+/*********************************************************************
+*
+*       _IsErased
+*
+*  Function description
+*    Checks that a range of sectors is erased on the card.
+*/
+static int _IsErased(U32 SectorIndex, U32 NumSectors, U8 Value) {
+  U32 i;
+
+  for (i = SectorIndex * BYTES_PER_SECTOR; i < (SectorIndex + NumSectors) * BYTES_PER_SECTOR; ++i) {
+    if (_Card.aData[i] != Value) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/*********************************************************************
+*
+*       _IsUnchanged
+*
+*  Function description
+*    Checks that a range of sectors keeps the data written at mount.
+*/
+static int _IsUnchanged(U32 SectorIndex, U32 NumSectors) {
+  U32 Off;
+
+  Off = SectorIndex * BYTES_PER_SECTOR;
+  return (memcmp(&_Card.aData[Off], &_aPattern[Off], NumSectors * BYTES_PER_SECTOR) == 0) ? 1 : 0;
+}
+
+/*********************************************************************
+*
+*       _TestUnalignedFree
+*
+*  Function description
+*    A card without ERASE_BLK_EN erases only the erase sectors that are
+*    completely freed. The sectors at the boundaries keep their data.
+*/
+static void _TestUnalignedFree(U8 Unit) {
+  int r;
+
+  r = _Mount(Unit, 0, 0);
+  TEST_CHECK_EQ(r, 0);
+  //
+  // Sectors 10 to 109 are freed. Only the erase sectors 32 to 63 and 64 to 95 are erased.
+  //
+  r = _FreeSectors(Unit, 10, 100);
+  TEST_CHECK_EQ(r, 0);
+  TEST_CHECK_EQ(_Card.NumErases, 1u);
+  TEST_CHECK_EQ(_Card.FirstSectorErased, 32u);
+  TEST_CHECK_EQ(_Card.LastSectorErased, 95u);
+  TEST_CHECK(_IsUnchanged(0, 32) != 0);
+  TEST_CHECK(_IsErased(32, 64, 0x00) != 0);
+  TEST_CHECK(_IsUnchanged(96, NUM_SECTORS - 96u) != 0);
+  //
+  // A range that does not contain a complete erase sector is not erased.
+  //
+  r = _FreeSectors(Unit, 100, ERASE_SECTOR_SIZE);
+  TEST_CHECK_EQ(r, 0);
+  r = _FreeSectors(Unit, 130, 20);
+  TEST_CHECK_EQ(r, 0);
+  TEST_CHECK_EQ(_Card.NumErases, 1u);
+  TEST_CHECK_EQ(_Card.aCmdCnt[38], 1u);
+  TEST_CHECK(_IsUnchanged(96, NUM_SECTORS - 96u) != 0);
+  //
+  // Aligned range.
+  //
+  r = _FreeSectors(Unit, 3 * ERASE_SECTOR_SIZE, 2 * ERASE_SECTOR_SIZE);
+  TEST_CHECK_EQ(r, 0);
+  TEST_CHECK_EQ(_Card.FirstSectorErased, 3 * ERASE_SECTOR_SIZE);
+  TEST_CHECK_EQ(_Card.LastSectorErased, 5 * ERASE_SECTOR_SIZE - 1u);
+  TEST_CHECK(_IsUnchanged(5 * ERASE_SECTOR_SIZE, NUM_SECTORS - 5 * ERASE_SECTOR_SIZE) != 0);
+  //
+  // The erased sectors are not guaranteed to read as 0 because the boundaries are not erased.
+  //
+  r = FS_MMC_CM_Driver.pfIoCtl(Unit, FS_CMD_REQUIRES_ZERO_FILL, 0, NULL);
+  TEST_CHECK_EQ(r, 1);
+  //
+  // The erase function of the API trims the range in the same way.
+  //
+  r = FS_MMC_CM_Erase(Unit, 200, 70);
+  TEST_CHECK_EQ(r, 0);
+  TEST_CHECK_EQ(_Card.FirstSectorErased, 224u);
+  TEST_CHECK_EQ(_Card.LastSectorErased, 224u + ERASE_SECTOR_SIZE - 1u);
+  TEST_CHECK(_IsUnchanged(5 * ERASE_SECTOR_SIZE, 224u - 5 * ERASE_SECTOR_SIZE) != 0);
+  TEST_CHECK(_IsUnchanged(224u + ERASE_SECTOR_SIZE, NUM_SECTORS - 224u - ERASE_SECTOR_SIZE) != 0);
+  TEST_CHECK_EQ(_Card.NumIllegal, 0u);
+}
+
+/*********************************************************************
+*
+*       _TestEraseBlkEn
+*
+*  Function description
+*    A card with ERASE_BLK_EN erases exactly the freed sectors.
+*    The zero fill of format can be skipped only when the card
+*    also reports that erased data reads as 0.
+*/
+static void _TestEraseBlkEn(U8 Unit) {
+  int r;
+
+  r = _Mount(Unit, 1, 0);
+  TEST_CHECK_EQ(r, 0);
+  r = _FreeSectors(Unit, 10, 100);
+  TEST_CHECK_EQ(r, 0);
+  TEST_CHECK_EQ(_Card.FirstSectorErased, 10u);
+  TEST_CHECK_EQ(_Card.LastSectorErased, 109u);
+  TEST_CHECK(_IsUnchanged(0, 10) != 0);
+  TEST_CHECK(_IsErased(10, 100, 0x00) != 0);
+  TEST_CHECK(_IsUnchanged(110, NUM_SECTORS - 110u) != 0);
+  r = FS_MMC_CM_Driver.pfIoCtl(Unit, FS_CMD_REQUIRES_ZERO_FILL, 0, NULL);
+  TEST_CHECK_EQ(r, 0);
+  r = _Mount(Unit, 1, 1);
+  TEST_CHECK_EQ(r, 0);
+  r = _FreeSectors(Unit, 10, 100);
+  TEST_CHECK_EQ(r, 0);
+  TEST_CHECK(_IsErased(10, 100, 0xFF) != 0);
+  r = FS_MMC_CM_Driver.pfIoCtl(Unit, FS_CMD_REQUIRES_ZERO_FILL, 0, NULL);
+  TEST_CHECK_EQ(r, 1);
+  TEST_CHECK_EQ(_Card.NumIllegal, 0u);
+}
+
+/*********************************************************************
+*
+*       _TestAsyncErase
+*
+*  Function description
+*    Freeing sectors returns while the SD card is still erasing.
+*    The next access waits for the erase operation to finish.
+*/
+static void _TestAsyncErase(U8 Unit) {
+  FS_MMC_STAT_COUNTERS Stat;
+  int                  r;
+  U32                  TimeStart;
+  U32                  TimeFree;
+  U32                  TimeRead;
+  U32                  NumStatusCmds;
+
+  r = _Mount(Unit, 1, 0);
+  TEST_CHECK_EQ(r, 0);
+  TimeStart = _Card.TimeUs;
+  r = _FreeSectors(Unit, 1000, 500);
+  TEST_CHECK_EQ(r, 0);
+  TimeFree = _Card.TimeUs - TimeStart;
+  TEST_CHECK(TimeFree < ERASE_TIME_US);
+  TEST_CHECK(_CardIsBusy() != 0);
+  NumStatusCmds = _Card.aCmdCnt[13];
+  //
+  // A read waits for the erase operation to finish.
+  //
+  TimeStart = _Card.TimeUs;
+  r = FS_MMC_CM_Driver.pfRead(Unit, 1000, _aRead, 64);
+  TEST_CHECK_EQ(r, 0);
+  TimeRead = _Card.TimeUs - TimeStart;
+  TEST_CHECK(TimeRead >= (ERASE_TIME_US - TimeFree));
+  TEST_CHECK(_Card.aCmdCnt[13] > NumStatusCmds);
+  TEST_CHECK(_IsErased(1000, 500, 0x00) != 0);
+  TEST_CHECK(memcmp(_aRead, &_Card.aData[1000 * BYTES_PER_SECTOR], sizeof(_aRead)) == 0);
+  TEST_CHECK_EQ(_Card.NumIllegal, 0u);
+  printf("Free of 500 sectors: %lu us, following read of 64 sectors: %lu us (erase takes %u us)\n",
+         (unsigned long)TimeFree, (unsigned long)TimeRead, ERASE_TIME_US);
+  //
+  // Consecutive free requests and a write wait for the previous erase operation.
+  //
+  r = _FreeSectors(Unit, 2000, 100);
+  TEST_CHECK_EQ(r, 0);
+  r = _FreeSectors(Unit, 2200, 100);
+  TEST_CHECK_EQ(r, 0);
+  r = FS_MMC_CM_Driver.pfWrite(Unit, 2050, _aPattern, 16, 0);
+  TEST_CHECK_EQ(r, 0);
+  TEST_CHECK(_IsErased(2000, 50, 0x00) != 0);
+  TEST_CHECK(memcmp(&_Card.aData[2050 * BYTES_PER_SECTOR], _aPattern, 16 * BYTES_PER_SECTOR) == 0);
+  TEST_CHECK(_IsErased(2066, 34, 0x00) != 0);
+  TEST_CHECK(_IsErased(2200, 100, 0x00) != 0);
+  TEST_CHECK_EQ(_Card.NumErases, 3u);
+  TEST_CHECK_EQ(_Card.NumIllegal, 0u);
+  FS_MMC_CM_GetStatCounters(Unit, &Stat);
+  TEST_CHECK_EQ(Stat.TrimCnt, 3u);
+  TEST_CHECK_EQ(Stat.TrimSectorCnt, 700u);
+  //
+  // Unmount waits for the erase operation to finish.
+  //
+  r = _FreeSectors(Unit, 3000, 100);
+  TEST_CHECK_EQ(r, 0);
+  (void)FS_MMC_CM_Driver.pfIoCtl(Unit, FS_CMD_UNMOUNT, 0, NULL);
+  TEST_CHECK(_CardIsBusy() == 0);
+  TEST_CHECK_EQ(_Card.NumIllegal, 0u);
+}
+
+/*********************************************************************
+*
+*       Public code
+*
+**********************************************************************
+*/
+int main(void) {
+  int Unit;
+
+  FS_Global.MaxSectorSize = BYTES_PER_SECTOR;
+  Unit = FS_MMC_CM_Driver.pfAddDevice();
+  TEST_CHECK(Unit >= 0);
+  if (Unit >= 0) {
+    FS_MMC_CM_SetHWType((U8)Unit, &_HW_CardModel);
+    _TestUnalignedFree((U8)Unit);
+    _TestEraseBlkEn((U8)Unit);
+    _TestAsyncErase((U8)Unit);
+  }
+  return TEST_Report("FS_MMC_CM_EraseTest");
+}
+
+/*************************** End of file ****************************/
@@ -0,0 +1,1050 @@
+/*********************************************************************
+*                                                                    *
+*       emFile * File system for embedded applications               *
+*                                                                    *
+**********************************************************************
+----------------------------------------------------------------------
+File        : FS_NOR_HW_SPI_Bench.c
+Purpose     : Host test of the SPI HW layer of the serial NOR driver
+              (FS_NOR_HW_SPI_STM32H735_Morpheus.c) against a simulated
+              SPI4 peripheral and a simulated serial NOR flash device.
+              The simulated peripheral shifts a pseudo-random number of
+              bytes on each register access. This emulates a CPU that is
+              sometimes faster and sometimes slower than the bus, for
+              example when it is interrupted, so that a receive overrun
+              caused by sending too many bytes in advance is detected.
+              The test checks the data integrity for all buffer
+              alignments, the cache maintenance, the DMA and FIFO timeout
+              handling and reports the number of register accesses and
+              HAL calls of a sector read. An estimated throughput is
+              calculated from these counters for the HW layer and for
+              the former implementation that called HAL_SPI_Receive() /
+              HAL_SPI_Transmit() once per byte.
+              The memory regions used as data buffers are mapped at the
+              addresses of the STM32H7 AXI SRAM and DTCM so that the
+              HW layer selects the same transfer path as on the target.
+-------------------------- END-OF-HEADER -----------------------------
+*/
+
+/*********************************************************************
+*
+*       #include Section
+*
+**********************************************************************
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "FS.h"
+#include "FS_OS.h"
+#include "FS_NOR_HW_SPI_STM32H735_Morpheus.h"
+#include "main.h"
+#include "test_check.h"
+
+/*********************************************************************
+*
+*       Defines, configurable
+*
+**********************************************************************
+*/
+#define NOR_SIZE                  0x10000u
+#define SECTOR_SIZE               4096u
+#define REGION_SIZE               0x10000u
+#define AXI_SRAM_ADDR             0x24000000uL    // Accessible by DMA.
+#define DTCM_ADDR                 0x20000000uL    // Not accessible by DMA.
+#define FIFO_SIZE                 8u              // SPI4 FIFO in bytes.
+
+//
+// Cost model used for the estimation of the throughput. The values
+// are typical for an STM32H7 running at 550 MHz with the SPI clock at
+// 100 MHz. They can be replaced by values measured on the target.
+//
+#define T_SPI_BYTE_PS             80000uL         // Time to shift one byte at 100 MHz in picoseconds.
+#define T_REG_ACCESS_PS           10000uL         // One access to an APB2 peripheral register.
+#define T_HAL_CALL_PS             1500000uL       // One blocking HAL_SPI_Receive() / HAL_SPI_Transmit() call of one byte.
+#define T_DMA_SETUP_PS            3000000uL       // Start of a DMA transfer, completion interrupt and task switch.
+
+/*********************************************************************
+*
+*       Defines, non-configurable
+*
+**********************************************************************
+*/
+#define CR1_SPE                   (1uL << 0)
+#define CR1_CSTART                (1uL << 9)
+#define CR2_TSIZE_MASK            0xFFFFuL
+#define CFG1_FTHLV_BIT            5
+#define CFG1_FTHLV_MASK           0xFuL
+#define CFG1_RESET                0x00070007uL    // DSIZE = 8 bits, FTHLV = 1 frame.
+#define SR_RXP                    (1uL << 0)
+#define SR_TXP                    (1uL << 1)
+#define SR_EOT                    (1uL << 3)
+#define SR_RXPLVL_BIT             13
+#define IFCR_EOTC                 (1uL << 3)
+
+#define NOR_CMD_READ              0x03u
+#define NOR_CMD_PROGRAM           0x02u
+#define NOR_CMD_READ_ID           0x9Fu
+
+/*********************************************************************
+*
+*       Local data types
+*
+**********************************************************************
+*/
+typedef struct {
+  U8       aData[2u * FIFO_SIZE];           // The second half stores the bytes that would be lost so that the HW layer does not wait forever.
+  unsigned RdPos;
+  unsigned NumBytes;
+} FIFO;
+
+typedef struct {
+  //
+  // Registers as seen by the HW layer.
+  //
+  volatile U32 CR1;
+  volatile U32 CR2;
+  volatile U32 CFG1;
+  volatile U32 SR;
+  volatile U32 IFCR;
+  volatile U32 TXDR;
+  volatile U32 RXDR;
+  volatile U8  TXDR8;
+  volatile U8  RXDR8;
+  //
+  // Internal state.
+  //
+  int      LastRegOff;              // Register written by the previous access, -1 if none.
+  int      LastIs8Bit;
+  int      IsActive;
+  int      IsEOT;
+  int      IsStalled;               // Set to stop the clock (error injection).
+  U32      TSize;
+  U32      NumBytesPushed;
+  U32      NumBytesShifted;
+  U32      Seed;                    // State of the generator of the number of bytes shifted per access.
+  FIFO     TxFifo;
+  FIFO     RxFifo;
+  //
+  // Error and throughput counters.
+  //
+  U32      NumRegAccesses;
+  U32      NumHALCalls;
+  U32      NumDMATransfers;
+  U32      NumBytesWire;
+  U32      NumOverruns;
+  U32      NumUnderruns;
+  U32      NumTxOverflows;
+  U32      NumProtocolErrors;
+  U32      NumAborts;
+  U32      NumMisalignedInvalidates;
+} SPI_MOCK;
+
+typedef struct {
+  U8       aMem[NOR_SIZE];
+  int      IsSelected;
+  unsigned NumBytes;                // Number of bytes received since CS has been activated.
+  U8       Cmd;
+  U32      Addr;
+} NOR_MOCK;
+
+typedef struct {
+  U32 NumRegAccesses;
+  U32 NumHALCalls;
+  U32 NumDMATransfers;
+  U32 NumBytesWire;
+} COST;
+
+/*********************************************************************
+*
+*       Static data
+*
+**********************************************************************
+*/
+static SPI_MOCK   _Spi;
+static NOR_MOCK   _Nor;
+static int        _IsDMADone;
+static unsigned   _NumDMATimeouts;          // Number of DMA transfers that do not complete (error injection).
+static U8       * _pAXI;
+static U8       * _pDTCM;
+
+/*********************************************************************
+*
+*       Global data
+*
+**********************************************************************
+*/
+SPI_HandleTypeDef hspi4;
+
+/*********************************************************************
+*
+*       Static code, NOR device simulation
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _NOR_Exchange
+*
+*  Function description
+*    Exchanges one byte with the simulated serial NOR flash.
+*/
+static U8 _NOR_Exchange(U8 DataOut) {
+  U8       DataIn;
+  unsigned i;
+
+  DataIn = 0xFF;
+  if (_Nor.IsSelected == 0) {
+    _Spi.NumProtocolErrors++;             // Clock generated while CS is inactive.
+    return DataIn;
+  }
+  i = _Nor.NumBytes++;
+  if (i == 0u) {
+    _Nor.Cmd  = DataOut;
+    _Nor.Addr = 0;
+    return DataIn;
+  }
+  switch (_Nor.Cmd) {
+  case NOR_CMD_READ_ID:
+    if (i <= 3u) {
+      static const U8 _abId[3] = {0xEF, 0x40, 0x16};
+
+      DataIn = _abId[i - 1u];
+    }
+    break;
+  case NOR_CMD_READ:
+  case NOR_CMD_PROGRAM:
+    if (i <= 3u) {
+      _Nor.Addr = (_Nor.Addr << 8) | DataOut;
+    } else {
+      if (_Nor.Cmd == NOR_CMD_READ) {
+        DataIn = _Nor.aMem[_Nor.Addr % NOR_SIZE];
+      } else {
+        _Nor.aMem[_Nor.Addr % NOR_SIZE] &= DataOut;
+      }
+      _Nor.Addr++;
+    }
+    break;
+  default:
+    break;
+  }
+  return DataIn;
+}
+
+/*********************************************************************
+*
+*       Static code, SPI peripheral simulation
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _FifoPush
+*/
+static int _FifoPush(FIFO * pFifo, U8 Data) {
+  if (pFifo->NumBytes == SEGGER_COUNTOF(pFifo->aData)) {
+    return 1;                             // Error, data lost.
+  }
+  pFifo->aData[(pFifo->RdPos + pFifo->NumBytes) % SEGGER_COUNTOF(pFifo->aData)] = Data;
+  pFifo->NumBytes++;
+  if (pFifo->NumBytes > FIFO_SIZE) {
+    return 1;                             // Error, FIFO overflow.
+  }
+  return 0;
+}
+
+/*********************************************************************
+*
+*       _FifoPop
+*/
+static U8 _FifoPop(FIFO * pFifo) {
+  U8 Data;
+
+  Data = pFifo->aData[pFifo->RdPos];
+  pFifo->RdPos = (pFifo->RdPos + 1u) % SEGGER_COUNTOF(pFifo->aData);
+  pFifo->NumBytes--;
+  return Data;
+}
+
+/*********************************************************************
+*
+*       _GetPacketSize
+*/
+static unsigned _GetPacketSize(void) {
+  return ((_Spi.CFG1 >> CFG1_FTHLV_BIT) & CFG1_FTHLV_MASK) + 1u;
+}
+
+/*********************************************************************
+*
+*       _PushTx
+*/
+static void _PushTx(U32 Data, unsigned NumBytes) {
+  if ((_Spi.IsActive == 0) || ((_Spi.NumBytesPushed + NumBytes) > _Spi.TSize)) {
+    _Spi.NumProtocolErrors++;             // Data written outside of a transfer or beyond TSIZE.
+    return;
+  }
+  do {
+    if (_FifoPush(&_Spi.TxFifo, (U8)Data) != 0) {
+      _Spi.NumTxOverflows++;
+    }
+    Data >>= 8;
+    _Spi.NumBytesPushed++;
+  } while (--NumBytes != 0u);
+}
+
+/*********************************************************************
+*
+*       _CommitWrite
+*
+*  Function description
+*    Processes the value written by the previous register access.
+*    The access functions return a pointer to the register so the
+*    written value becomes visible only at the next access.
+*/
+static void _CommitWrite(void) {
+  switch (_Spi.LastRegOff) {
+  case MOCK_SPI_REG_CR1:
+    if ((_Spi.CR1 & CR1_SPE) == 0u) {
+      if (_Spi.IsActive != 0) {
+        if ((_Spi.NumBytesShifted != _Spi.TSize) || (_Spi.RxFifo.NumBytes != 0u)) {
+          _Spi.NumProtocolErrors++;       // Peripheral disabled with data still in progress.
+        }
+        _Spi.IsActive = 0;
+      }
+      _Spi.CR1 &= ~CR1_CSTART;
+      _Spi.TxFifo.NumBytes = 0;
+      _Spi.RxFifo.NumBytes = 0;
+    } else if (((_Spi.CR1 & CR1_CSTART) != 0u) && (_Spi.IsActive == 0)) {
+      _Spi.IsActive        = 1;
+      _Spi.IsEOT           = 0;
+      _Spi.TSize           = _Spi.CR2 & CR2_TSIZE_MASK;
+      _Spi.NumBytesPushed  = 0;
+      _Spi.NumBytesShifted = 0;
+    }
+    break;
+  case MOCK_SPI_REG_CFG1:
+    if ((_Spi.CR1 & CR1_SPE) != 0u) {
+      _Spi.NumProtocolErrors++;           // CFG1 is write protected while the peripheral is enabled.
+    }
+    break;
+  case MOCK_SPI_REG_IFCR:
+    if ((_Spi.IFCR & IFCR_EOTC) != 0u) {
+      _Spi.IsEOT = 0;
+    }
+    _Spi.IFCR = 0;
+    break;
+  case MOCK_SPI_REG_TXDR:
+    if (_Spi.LastIs8Bit != 0) {
+      _PushTx(_Spi.TXDR8, 1);
+    } else {
+      _PushTx(_Spi.TXDR, 4);
+    }
+    break;
+  default:
+    break;
+  }
+  _Spi.LastRegOff = -1;
+}
+
+/*********************************************************************
+*
+*       _Shift
+*
+*  Function description
+*    Moves bytes from the transmit FIFO over the bus. A byte received
+*    while the receive FIFO is full is lost.
+*
+*  Parameters
+*    MaxNumBytes    Maximum number of bytes to be shifted.
+*/
+static void _Shift(unsigned MaxNumBytes) {
+  U8 Data;
+
+  if ((_Spi.IsActive == 0) || (_Spi.IsStalled != 0)) {
+    return;
+  }
+  while ((_Spi.TxFifo.NumBytes != 0u) && (MaxNumBytes-- != 0u)) {
+    Data = _NOR_Exchange(_FifoPop(&_Spi.TxFifo));
+    _Spi.NumBytesWire++;
+    if (_FifoPush(&_Spi.RxFifo, Data) != 0) {
+      _Spi.NumOverruns++;
+    }
+    _Spi.NumBytesShifted++;
+    if (_Spi.NumBytesShifted == _Spi.TSize) {
+      _Spi.IsEOT = 1;
+    }
+  }
+}
+
+/*********************************************************************
+*
+*       _Access
+*/
+static void _Access(unsigned RegOff, int Is8Bit) {
+  unsigned PacketSize;
+  unsigned NumBytes;
+  U32      Data;
+  U32      Status;
+
+  _CommitWrite();
+  _Spi.NumRegAccesses++;
+  //
+  // Shift between 0 and FIFO_SIZE bytes with equal probability.
+  //
+  _Spi.Seed = _Spi.Seed * 1103515245uL + 12345uL;
+  _Shift((_Spi.Seed >> 16) % (FIFO_SIZE + 1u));
+  PacketSize = _GetPacketSize();
+  switch (RegOff) {
+  case MOCK_SPI_REG_SR:
+    Status = 0;
+    if ((_Spi.IsActive != 0) && ((_Spi.TxFifo.NumBytes + PacketSize) <= FIFO_SIZE)) {
+      Status |= SR_TXP;
+    }
+    if (_Spi.RxFifo.NumBytes >= PacketSize) {
+      Status |= SR_RXP;
+    } else {
+      Status |= (U32)_Spi.RxFifo.NumBytes << SR_RXPLVL_BIT;
+    }
+    if (_Spi.IsEOT != 0) {
+      Status |= SR_EOT;
+    }
+    _Spi.SR = Status;
+    break;
+  case MOCK_SPI_REG_RXDR:
+    NumBytes = (Is8Bit != 0) ? 1u : 4u;
+    if (_Spi.RxFifo.NumBytes < NumBytes) {
+      _Spi.NumUnderruns++;
+      _Spi.RXDR  = 0;
+      _Spi.RXDR8 = 0;
+      break;
+    }
+    Data = 0;
+    for (unsigned i = 0; i < NumBytes; ++i) {
+      Data |= (U32)_FifoPop(&_Spi.RxFifo) << (8u * i);
+    }
+    _Spi.RXDR  = Data;
+    _Spi.RXDR8 = (U8)Data;
+    break;
+  default:
+    _Spi.LastRegOff = (int)RegOff;        // Possibly written. Processed at the next access.
+    _Spi.LastIs8Bit = Is8Bit;
+    break;
+  }
+}
+
+/*********************************************************************
+*
+*       _SyncSPI
+*
+*  Function description
+*    Processes the last register access of the HW layer.
+*/
+static void _SyncSPI(void) {
+  _CommitWrite();
+  _Shift(FIFO_SIZE);
+}
+
+/*********************************************************************
+*
+*       _IsInRegion
+*/
+static int _IsInRegion(const void * p, U32 NumBytes, const U8 * pRegion) {
+  const U8 * pData;
+
+  pData = (const U8 *)p;
+  return (pData < (pRegion + REGION_SIZE)) && ((pData + NumBytes) > pRegion);
+}
+
+/*********************************************************************
+*
+*       Static code, test helpers
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _MapRegion
+*
+*  Function description
+*    Maps host memory at the address of an STM32H7 RAM region.
+*/
+static U8 * _MapRegion(unsigned long Addr) {
+  void * p;
+
+  p = mmap((void *)Addr, REGION_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED) {
+    return NULL;
+  }
+  if ((unsigned long)p != Addr) {
+    (void)munmap(p, REGION_SIZE);
+    return NULL;
+  }
+  return (U8 *)p;
+}
+
+/*********************************************************************
+*
+*       _GetCost
+*/
+static void _GetCost(COST * pCost) {
+  pCost->NumRegAccesses  = _Spi.NumRegAccesses;
+  pCost->NumHALCalls     = _Spi.NumHALCalls;
+  pCost->NumDMATransfers = _Spi.NumDMATransfers;
+  pCost->NumBytesWire    = _Spi.NumBytesWire;
+}
+
+/*********************************************************************
+*
+*       _CalcCost
+*
+*  Function description
+*    Returns the difference between the current and the start counters.
+*/
+static void _CalcCost(const COST * pStart, COST * pCost) {
+  _GetCost(pCost);
+  pCost->NumRegAccesses  -= pStart->NumRegAccesses;
+  pCost->NumHALCalls     -= pStart->NumHALCalls;
+  pCost->NumDMATransfers -= pStart->NumDMATransfers;
+  pCost->NumBytesWire    -= pStart->NumBytesWire;
+}
+
+/*********************************************************************
+*
+*       _CalcThroughput
+*
+*  Function description
+*    Estimates the throughput in KB/s using the cost model.
+*
+*  Additional information
+*    The FIFO and DMA transfers overlap the CPU work with the shifting
+*    on the bus so the time is given by the slower of the two. The
+*    blocking HAL calls transfer one byte at a time and do not overlap.
+*/
+static U32 _CalcThroughput(const COST * pCost, U32 NumBytes, int IsOverlapped) {
+  U64 TimeCPU_ps;
+  U64 TimeWire_ps;
+  U64 Time_ps;
+
+  TimeCPU_ps  = (U64)pCost->NumRegAccesses  * T_REG_ACCESS_PS
+              + (U64)pCost->NumHALCalls     * T_HAL_CALL_PS
+              + (U64)pCost->NumDMATransfers * T_DMA_SETUP_PS;
+  TimeWire_ps = (U64)pCost->NumBytesWire    * T_SPI_BYTE_PS;
+  if (IsOverlapped != 0) {
+    Time_ps = (TimeCPU_ps > TimeWire_ps) ? TimeCPU_ps : TimeWire_ps;
+  } else {
+    Time_ps = TimeCPU_ps + TimeWire_ps;
+  }
+  return (U32)(((U64)NumBytes * 1000000000000uLL) / (Time_ps * 1024u));
+}
+
+/*********************************************************************
+*
+*       _ReadNOR
+*
+*  Function description
+*    Reads data from the NOR flash via the HW layer in the same way
+*    as the physical layer: command and address in one write request
+*    followed by one read request for the data.
+*/
+static void _ReadNOR(U32 Addr, U8 * pData, U32 NumBytes) {
+  U8 abCmd[4];
+
+  abCmd[0] = NOR_CMD_READ;
+  abCmd[1] = (U8)(Addr >> 16);
+  abCmd[2] = (U8)(Addr >> 8);
+  abCmd[3] = (U8)Addr;
+  FS_NOR_HW_SPI_STM32H735_Morpheus.pfEnableCS(0);
+  FS_NOR_HW_SPI_STM32H735_Morpheus.pfWrite(0, abCmd, sizeof(abCmd));
+  FS_NOR_HW_SPI_STM32H735_Morpheus.pfRead(0, pData, (int)NumBytes);
+  FS_NOR_HW_SPI_STM32H735_Morpheus.pfDisableCS(0);
+  _SyncSPI();
+}
+
+/*********************************************************************
+*
+*       _ProgramNOR
+*/
+static void _ProgramNOR(U32 Addr, const U8 * pData, U32 NumBytes) {
+  U8 abCmd[4];
+
+  abCmd[0] = NOR_CMD_PROGRAM;
+  abCmd[1] = (U8)(Addr >> 16);
+  abCmd[2] = (U8)(Addr >> 8);
+  abCmd[3] = (U8)Addr;
+  FS_NOR_HW_SPI_STM32H735_Morpheus.pfEnableCS(0);
+  FS_NOR_HW_SPI_STM32H735_Morpheus.pfWrite(0, abCmd, sizeof(abCmd));
+  FS_NOR_HW_SPI_STM32H735_Morpheus.pfWrite(0, pData, (int)NumBytes);
+  FS_NOR_HW_SPI_STM32H735_Morpheus.pfDisableCS(0);
+  _SyncSPI();
+}
+
+/*********************************************************************
+*
+*       _ReadNORLegacy
+*
+*  Function description
+*    Reads data in the same way as the former implementation of the
+*    HW layer that called the blocking HAL function once per byte.
+*/
+static void _ReadNORLegacy(U32 Addr, U8 * pData, U32 NumBytes) {
+  U8 abCmd[4];
+  U32 i;
+
+  abCmd[0] = NOR_CMD_READ;
+  abCmd[1] = (U8)(Addr >> 16);
+  abCmd[2] = (U8)(Addr >> 8);
+  abCmd[3] = (U8)Addr;
+  FS_NOR_HW_SPI_STM32H735_Morpheus.pfEnableCS(0);
+  for (i = 0; i < sizeof(abCmd); ++i) {
+    (void)HAL_SPI_Transmit(&hspi4, &abCmd[i], 1, 1000);
+  }
+  for (i = 0; i < NumBytes; ++i) {
+    (void)HAL_SPI_Receive(&hspi4, &pData[i], 1, 1000);
+  }
+  FS_NOR_HW_SPI_STM32H735_Morpheus.pfDisableCS(0);
+}
+
+/*********************************************************************
+*
+*       _CheckSPIErrors
+*/
+static void _CheckSPIErrors(void) {
+  TEST_CHECK_EQ(_Spi.NumOverruns,       0u);
+  TEST_CHECK_EQ(_Spi.NumUnderruns,      0u);
+  TEST_CHECK_EQ(_Spi.NumTxOverflows,    0u);
+  TEST_CHECK_EQ(_Spi.NumProtocolErrors, 0u);
+  TEST_CHECK_EQ(_Spi.IsActive,          0);
+  TEST_CHECK_EQ(_Spi.CFG1,              CFG1_RESET);     // Configuration restored after each transfer.
+}
+
+/*********************************************************************
+*
+*       _TestReadAlignment
+*
+*  Function description
+*    Reads all combinations of buffer offset and length around the
+*    DMA threshold and cache line size from the region at pRegion.
+*/
+static void _TestReadAlignment(U8 * pRegion, const char * sName) {
+  unsigned Off;
+  unsigned NumBytes;
+  U32      Addr;
+  unsigned NumErrors;
+  static const unsigned _aNumBytes[] = {1, 3, 4, 5, 7, 8, 9, 31, 63, 64, 65, 95, 96, 127, 200, 256, 513, 4096};
+
+  NumErrors = 0;
+  for (Off = 0; Off < 32u; ++Off) {
+    for (unsigned i = 0; i < SEGGER_COUNTOF(_aNumBytes); ++i) {
+      NumBytes = _aNumBytes[i];
+      Addr     = (Off * 97u + NumBytes) % (NOR_SIZE - NumBytes);
+      memset(pRegion, 0xA5, Off + NumBytes + 64u);
+      _ReadNOR(Addr, pRegion + Off, NumBytes);
+      if (memcmp(pRegion + Off, &_Nor.aMem[Addr], NumBytes) != 0) {
+        NumErrors++;
+      }
+      if ((Off != 0u) && (pRegion[Off - 1u] != 0xA5u)) {
+        NumErrors++;                      // Data written in front of the buffer.
+      }
+      if (pRegion[Off + NumBytes] != 0xA5u) {
+        NumErrors++;                      // Data written behind the buffer.
+      }
+    }
+  }
+  TEST_CHECK_EQ(NumErrors, 0u);
+  _CheckSPIErrors();
+  TEST_CHECK_EQ(_Spi.NumMisalignedInvalidates, 0u);
+  printf("  Read alignment (%s): %u combinations checked\n", sName, (unsigned)(32u * SEGGER_COUNTOF(_aNumBytes)));
+}
+
+/*********************************************************************
+*
+*       _TestProgram
+*/
+static void _TestProgram(U8 * pRegion) {
+  static const unsigned _aNumBytes[] = {1, 5, 63, 64, 100, 256};
+  unsigned NumErrors;
+  unsigned NumBytes;
+  U32      Addr;
+
+  NumErrors = 0;
+  Addr      = 0;
+  memset(_Nor.aMem, 0xFF, sizeof(_Nor.aMem));
+  for (unsigned i = 0; i < SEGGER_COUNTOF(_aNumBytes); ++i) {
+    NumBytes = _aNumBytes[i];
+    for (unsigned j = 0; j < NumBytes; ++j) {
+      pRegion[3u + j] = (U8)(j * 7u + i);
+    }
+    _ProgramNOR(Addr, pRegion + 3, NumBytes);
+    if (memcmp(&_Nor.aMem[Addr], pRegion + 3, NumBytes) != 0) {
+      NumErrors++;
+    }
+    Addr += NumBytes;
+  }
+  TEST_CHECK_EQ(NumErrors, 0u);
+  _CheckSPIErrors();
+}
+
+/*********************************************************************
+*
+*       _TestReadId
+*/
+static void _TestReadId(void) {
+  U8 abCmd[1];
+  U8 abId[3];
+
+  abCmd[0] = NOR_CMD_READ_ID;
+  FS_NOR_HW_SPI_STM32H735_Morpheus.pfEnableCS(0);
+  FS_NOR_HW_SPI_STM32H735_Morpheus.pfWrite(0, abCmd, sizeof(abCmd));
+  FS_NOR_HW_SPI_STM32H735_Morpheus.pfRead(0, abId, sizeof(abId));
+  FS_NOR_HW_SPI_STM32H735_Morpheus.pfDisableCS(0);
+  _SyncSPI();
+  TEST_CHECK_EQ(abId[0], 0xEFu);
+  TEST_CHECK_EQ(abId[1], 0x40u);
+  TEST_CHECK_EQ(abId[2], 0x16u);
+  _CheckSPIErrors();
+}
+
+#if FS_NOR_HW_USE_DMA
+
+/*********************************************************************
+*
+*       _TestDMATimeout
+*
+*  Function description
+*    Verifies that a DMA transfer that does not complete is aborted
+*    and that the error is reported to the physical layer.
+*/
+static void _TestDMATimeout(void) {
+  FS_NOR_HW_SPI_STM32H735_STAT_COUNTERS Stat;
+  U32                                   NumAborts;
+  int                                   r;
+
+  NumAborts = _Spi.NumAborts;
+  FS_NOR_HW_SPI_STM32H735_Morpheus_ResetStatCounters();
+  _NumDMATimeouts = 1;
+  _ReadNOR(0, _pAXI, 256);
+  FS_NOR_HW_SPI_STM32H735_Morpheus_GetStatCounters(&Stat);
+  TEST_CHECK_EQ(Stat.DMATimeoutCnt, 1u);
+  TEST_CHECK_EQ(_Spi.NumAborts - NumAborts, 1u);
+  TEST_CHECK_EQ(_NumDMATimeouts, 0u);
+  //
+  // The extended functions called by the SFDP physical layer
+  // return the error, also for the bounce buffer.
+  //
+  _NumDMATimeouts = 1;
+  FS_NOR_HW_SPI_STM32H735_Morpheus.pfEnableCS(0);
+  r = FS_NOR_HW_SPI_STM32H735_Morpheus.pfReadEx(0, _pAXI, 256, 1);
+  FS_NOR_HW_SPI_STM32H735_Morpheus.pfDisableCS(0);
+  TEST_CHECK(r != 0);
+  _NumDMATimeouts = 1;
+  FS_NOR_HW_SPI_STM32H735_Morpheus.pfEnableCS(0);
+  r = FS_NOR_HW_SPI_STM32H735_Morpheus.pfWriteEx(0, _pDTCM, 256, 1);
+  FS_NOR_HW_SPI_STM32H735_Morpheus.pfDisableCS(0);
+  TEST_CHECK(r != 0);
+  TEST_CHECK_EQ(_NumDMATimeouts, 0u);
+  TEST_CHECK_EQ(_Spi.NumAborts - NumAborts, 3u);
+  //
+  // The next transfer has to work again.
+  //
+  _ReadNOR(0x100, _pAXI, 256);
+  TEST_CHECK(memcmp(_pAXI, &_Nor.aMem[0x100], 256) == 0);
+  _CheckSPIErrors();
+}
+
+#endif // FS_NOR_HW_USE_DMA
+
+/*********************************************************************
+*
+*       _TestPIOTimeout
+*
+*  Function description
+*    Verifies that a FIFO transfer on a peripheral that stops shifting
+*    is aborted, that the peripheral is left disabled with the original
+*    configuration and that the error is reported to the physical layer.
+*/
+static void _TestPIOTimeout(void) {
+  FS_NOR_HW_SPI_STM32H735_STAT_COUNTERS Stat;
+  U32                                   NumProtocolErrors;
+  U8                                    abCmd[4];
+  int                                   r;
+
+  FS_NOR_HW_SPI_STM32H735_Morpheus_ResetStatCounters();
+  NumProtocolErrors = _Spi.NumProtocolErrors;
+  FS_MEMSET(abCmd, 0, sizeof(abCmd));
+  abCmd[0] = NOR_CMD_READ;
+  FS_NOR_HW_SPI_STM32H735_Morpheus.pfEnableCS(0);
+  _Spi.IsStalled = 1;
+  r = FS_NOR_HW_SPI_STM32H735_Morpheus.pfWriteEx(0, abCmd, sizeof(abCmd), 1);
+  TEST_CHECK(r != 0);
+  r = FS_NOR_HW_SPI_STM32H735_Morpheus.pfReadEx(0, _pAXI, 16, 1);
+  TEST_CHECK(r != 0);
+  _Spi.IsStalled = 0;
+  FS_NOR_HW_SPI_STM32H735_Morpheus.pfDisableCS(0);
+  _SyncSPI();
+  FS_NOR_HW_SPI_STM32H735_Morpheus_GetStatCounters(&Stat);
+  TEST_CHECK_EQ(Stat.PIOTimeoutCnt, 2u);
+  TEST_CHECK_EQ(Stat.NumBytesPIO, 0u);
+  TEST_CHECK_EQ(_Spi.NumProtocolErrors - NumProtocolErrors, 2u);    // Each transfer disabled with data in progress.
+  _Spi.NumProtocolErrors = NumProtocolErrors;
+  TEST_CHECK_EQ(FS_NOR_HW_SPI_STM32H735_Morpheus.pfReadEx(0, _pAXI, 16, 2), 1);   // Single data line only.
+  //
+  // The next transfer has to work again.
+  //
+  _ReadNOR(0x200, _pAXI, 16);
+  TEST_CHECK(memcmp(_pAXI, &_Nor.aMem[0x200], 16) == 0);
+  _CheckSPIErrors();
+}
+
+/*********************************************************************
+*
+*       _BenchSectorRead
+*
+*  Function description
+*    Reports the cost of reading one sector for the former per-byte
+*    HAL implementation and for the HW layer with the buffer in
+*    AXI SRAM and in DTCM.
+*/
+static void _BenchSectorRead(void) {
+  FS_NOR_HW_SPI_STM32H735_STAT_COUNTERS Stat;
+  COST                                  Start;
+  COST                                  CostLegacy;
+  COST                                  CostAXI;
+  COST                                  CostDTCM;
+  U32                                   KBsLegacy;
+  U32                                   KBsAXI;
+  U32                                   KBsDTCM;
+
+  _GetCost(&Start);
+  _ReadNORLegacy(0, _pAXI, SECTOR_SIZE);
+  _CalcCost(&Start, &CostLegacy);
+  TEST_CHECK(memcmp(_pAXI, _Nor.aMem, SECTOR_SIZE) == 0);
+  FS_NOR_HW_SPI_STM32H735_Morpheus_ResetStatCounters();
+  _GetCost(&Start);
+  _ReadNOR(0, _pAXI, SECTOR_SIZE);
+  _CalcCost(&Start, &CostAXI);
+  FS_NOR_HW_SPI_STM32H735_Morpheus_GetStatCounters(&Stat);
+  TEST_CHECK(memcmp(_pAXI, _Nor.aMem, SECTOR_SIZE) == 0);
+#if FS_NOR_HW_USE_DMA
+  TEST_CHECK_EQ(Stat.NumBytesDMA, SECTOR_SIZE);
+  TEST_CHECK_EQ(Stat.NumBytesPIO, 4u);                  // Command and address.
+#else
+  TEST_CHECK_EQ(Stat.NumBytesPIO, SECTOR_SIZE + 4u);
+#endif // FS_NOR_HW_USE_DMA
+  FS_NOR_HW_SPI_STM32H735_Morpheus_ResetStatCounters();
+  _GetCost(&Start);
+  _ReadNOR(0, _pDTCM, SECTOR_SIZE);
+  _CalcCost(&Start, &CostDTCM);
+  FS_NOR_HW_SPI_STM32H735_Morpheus_GetStatCounters(&Stat);
+  TEST_CHECK(memcmp(_pDTCM, _Nor.aMem, SECTOR_SIZE) == 0);
+#if FS_NOR_HW_USE_DMA
+  TEST_CHECK_EQ(Stat.NumBytesBounce, SECTOR_SIZE);      // TCM is not accessible by DMA.
+#endif // FS_NOR_HW_USE_DMA
+  _CheckSPIErrors();
+  KBsLegacy = _CalcThroughput(&CostLegacy, SECTOR_SIZE, 0);
+  KBsAXI    = _CalcThroughput(&CostAXI,    SECTOR_SIZE, 1);
+  KBsDTCM   = _CalcThroughput(&CostDTCM,   SECTOR_SIZE, 1);
+  printf("  Sector read of %u bytes     reg. accesses  HAL calls  DMA transfers  est. KB/s\n", SECTOR_SIZE);
+  printf("    per-byte HAL (former)     %8lu      %8lu   %8lu      %8lu\n",
+         (unsigned long)CostLegacy.NumRegAccesses, (unsigned long)CostLegacy.NumHALCalls, (unsigned long)CostLegacy.NumDMATransfers, (unsigned long)KBsLegacy);
+  printf("    HW layer, AXI SRAM        %8lu      %8lu   %8lu      %8lu\n",
+         (unsigned long)CostAXI.NumRegAccesses, (unsigned long)CostAXI.NumHALCalls, (unsigned long)CostAXI.NumDMATransfers, (unsigned long)KBsAXI);
+  printf("    HW layer, DTCM            %8lu      %8lu   %8lu      %8lu\n",
+         (unsigned long)CostDTCM.NumRegAccesses, (unsigned long)CostDTCM.NumHALCalls, (unsigned long)CostDTCM.NumDMATransfers, (unsigned long)KBsDTCM);
+  printf("    Bus limit at 100 MHz                                              %8lu\n",
+         (unsigned long)((1000000000000uLL / T_SPI_BYTE_PS) / 1024u));
+  TEST_CHECK(CostAXI.NumRegAccesses <= (SECTOR_SIZE + 64u));      // At most one register access per byte.
+  TEST_CHECK(KBsAXI  >= (4u * KBsLegacy));
+  TEST_CHECK(KBsDTCM >= (4u * KBsLegacy));
+}
+
+/*********************************************************************
+*
+*       Public code, simulated HAL
+*
+**********************************************************************
+*/
+volatile uint32_t * MOCK_SPI_Access32(unsigned RegOff) {
+  _Access(RegOff, 0);
+  switch (RegOff) {
+  case MOCK_SPI_REG_CR1:  return &_Spi.CR1;
+  case MOCK_SPI_REG_CR2:  return &_Spi.CR2;
+  case MOCK_SPI_REG_CFG1: return &_Spi.CFG1;
+  case MOCK_SPI_REG_SR:   return &_Spi.SR;
+  case MOCK_SPI_REG_IFCR: return &_Spi.IFCR;
+  case MOCK_SPI_REG_TXDR: return &_Spi.TXDR;
+  default:                return &_Spi.RXDR;
+  }
+}
+
+volatile uint8_t * MOCK_SPI_Access8(unsigned RegOff) {
+  _Access(RegOff, 1);
+  if (RegOff == MOCK_SPI_REG_TXDR) {
+    return &_Spi.TXDR8;
+  }
+  return &_Spi.RXDR8;
+}
+
+void MX_SPI4_Init(void) {
+  _Spi.CFG1       = CFG1_RESET;
+  _Spi.LastRegOff = -1;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef * GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState) {
+  FS_USE_PARA(GPIOx);
+  FS_USE_PARA(GPIO_Pin);
+  _SyncSPI();
+  if (PinState == GPIO_PIN_RESET) {
+    _Nor.IsSelected = 1;
+    _Nor.NumBytes   = 0;
+  } else {
+    if (_Spi.IsActive != 0) {
+      _Spi.NumProtocolErrors++;           // CS deactivated during a transfer.
+    }
+    _Nor.IsSelected = 0;
+  }
+}
+
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef * hspi, uint8_t * pData, uint16_t Size, uint32_t Timeout) {
+  FS_USE_PARA(hspi);
+  FS_USE_PARA(Timeout);
+  _Spi.NumHALCalls++;
+  while (Size-- != 0u) {
+    *pData++ = _NOR_Exchange(0xFF);
+    _Spi.NumBytesWire++;
+  }
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef * hspi, uint8_t * pData, uint16_t Size, uint32_t Timeout) {
+  FS_USE_PARA(hspi);
+  FS_USE_PARA(Timeout);
+  _Spi.NumHALCalls++;
+  while (Size-- != 0u) {
+    (void)_NOR_Exchange(*pData++);
+    _Spi.NumBytesWire++;
+  }
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Receive_DMA(SPI_HandleTypeDef * hspi, uint8_t * pData, uint16_t Size) {
+  FS_USE_PARA(hspi);
+  _SyncSPI();
+  _Spi.NumHALCalls++;
+  _Spi.NumDMATransfers++;
+  if (_NumDMATimeouts != 0u) {
+    _NumDMATimeouts--;
+    return HAL_OK;                        // Transfer never completes.
+  }
+  while (Size-- != 0u) {
+    *pData++ = _NOR_Exchange(0xFF);
+    _Spi.NumBytesWire++;
+  }
+  _IsDMADone = 1;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit_DMA(SPI_HandleTypeDef * hspi, const uint8_t * pData, uint16_t Size) {
+  FS_USE_PARA(hspi);
+  _SyncSPI();
+  _Spi.NumHALCalls++;
+  _Spi.NumDMATransfers++;
+  if (_NumDMATimeouts != 0u) {
+    _NumDMATimeouts--;
+    return HAL_OK;                        // Transfer never completes.
+  }
+  while (Size-- != 0u) {
+    (void)_NOR_Exchange(*pData++);
+    _Spi.NumBytesWire++;
+  }
+  _IsDMADone = 1;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Abort(SPI_HandleTypeDef * hspi) {
+  FS_USE_PARA(hspi);
+  _Spi.NumAborts++;
+  return HAL_OK;
+}
+
+void SCB_InvalidateDCache_by_Addr(uint32_t * addr, int32_t dsize) {
+  U32 Addr;
+
+  //
+  // An invalidation of a partial cache line would discard data of
+  // neighboring variables. Only the buffers of the application are
+  // checked. The bounce buffer of the HW layer is not shared.
+  //
+  Addr = (U32)SEGGER_PTR2ADDR(addr);
+  if (_IsInRegion(addr, (U32)dsize, _pAXI) || _IsInRegion(addr, (U32)dsize, _pDTCM)) {
+    if (((Addr & 31u) != 0u) || (((U32)dsize & 31u) != 0u)) {
+      _Spi.NumMisalignedInvalidates++;
+    }
+  }
+}
+
+void SCB_CleanDCache_by_Addr(uint32_t * addr, int32_t dsize) {
+  FS_USE_PARA(addr);
+  FS_USE_PARA(dsize);
+}
+
+/*********************************************************************
+*
+*       Public code, OS layer
+*
+**********************************************************************
+*/
+int FS_X_OS_Wait(int TimeOut) {
+  FS_USE_PARA(TimeOut);
+  if (_IsDMADone != 0) {
+    _IsDMADone = 0;
+    return 0;
+  }
+  return 1;                               // Timeout.
+}
+
+void FS_X_OS_Signal(void) {
+  _IsDMADone = 1;
+}
+
+void FS_X_OS_Delay(int ms) {
+  FS_USE_PARA(ms);
+}
+
+/*********************************************************************
+*
+*       Public code, test
+*
+**********************************************************************
+*/
+int main(void) {
+  unsigned i;
+
+  _pAXI  = _MapRegion(AXI_SRAM_ADDR);
+  _pDTCM = _MapRegion(DTCM_ADDR);
+  if ((_pAXI == NULL) || (_pDTCM == NULL)) {
+    printf("Could not map the RAM regions at the target addresses.\n");
+    return 1;
+  }
+  for (i = 0; i < NOR_SIZE; ++i) {
+    _Nor.aMem[i] = (U8)((i * 131u) ^ (i >> 8));
+  }
+  printf("NOR SPI HW layer, %s\n", FS_NOR_HW_USE_DMA ? "FIFO and DMA" : "FIFO only");
+  (void)FS_NOR_HW_SPI_STM32H735_Morpheus.pfInit(0);
+  _TestReadId();
+  _TestReadAlignment(_pAXI,  "AXI SRAM");
+  _TestReadAlignment(_pDTCM, "DTCM");
+  _BenchSectorRead();
+#if FS_NOR_HW_USE_DMA
+  _TestDMATimeout();
+#endif // FS_NOR_HW_USE_DMA
+  _TestPIOTimeout();
+  _TestProgram(_pAXI);
+  _TestProgram(_pDTCM);
+  return TEST_Report("FS_NOR_HW_SPI_Bench");
+}
+
+/*************************** End of file ****************************/
@@ -0,0 +1,1091 @@
+/*********************************************************************
+*                                                                    *
+*       emFile * File system for embedded applications               *
+*                                                                    *
+**********************************************************************
+----------------------------------------------------------------------
+File        : FS_NOR_MapReadTest.c
+Purpose     : Host test of the memory-mapped read path of the NOR
+              drivers (FS_NOR_PHY_TYPE_MAP_READ). The SPIFI physical
+              layer runs on a simulated quad SPI controller with a
+              serial NOR flash device. The memory-mapped window of the
+              controller is host memory mapped at the QSPI address of
+              the STM32H7. The window is refreshed from the memory
+              array only when the physical layer switches to memory
+              mode, as a cached window invalidated by the HW layer,
+              and it is not accessible in command mode, so that any
+              read of stale data or any read while a program or erase
+              operation is in progress is detected.
+              The test performs:
+                1. Random program and erase operations on the physical
+                   layer, each followed by reads via the window and via
+                   the read function, compared with a reference image.
+                2. A check that a window access in command mode is
+                   caught by the simulation.
+                3. The same file system workload on two volumes, one
+                   read via the window and one via read commands. Both
+                   have to issue the same program and erase operations
+                   and end with identical flash contents. The number of
+                   read commands and bus bytes of both is reported.
+              The driver under test is the block map NOR driver or,
+              with USE_NOR_BM=0, the sector map NOR driver.
+-------------------------- END-OF-HEADER -----------------------------
+*/
+
+/*********************************************************************
+*
+*       #include Section
+*
+**********************************************************************
+*/
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "FS.h"
+#include "test_check.h"
+
+/*********************************************************************
+*
+*       Defines, configurable
+*
+**********************************************************************
+*/
+#ifndef   USE_NOR_BM
+  #define USE_NOR_BM              1           // 1: block map NOR driver, 0: sector map NOR driver.
+#endif
+#define NOR_SIZE                  0x100000u   // 16 physical sectors of 64 KB (device id 0x14).
+#define WINDOW_ADDR               0x90000000uL  // QSPI memory-mapped region of the STM32H7.
+#define WINDOW_STRIDE             0x00400000uL  // Distance between the windows of two units.
+#define NUM_UNITS                 4u
+#define UNIT_PHY_MAP              2u          // Physical layer test with memory mode.
+#define UNIT_PHY_CMD              3u          // Physical layer test without memory mode.
+#define ALLOC_SIZE                0x40000u    // Memory pool of the file system.
+#define NUM_PHY_OPS               4000u
+#define NUM_FS_OPS                1500u
+#define NUM_FILES                 8u
+#define MAX_FILE_SIZE             12288u
+#define REMOUNT_PERIOD            64u         // Number of file system operations between two remounts.
+#define NUM_BUSY_POLLS_PROGRAM    2u          // Status reads until a page program completes.
+#define NUM_BUSY_POLLS_ERASE      5u          // Status reads until a sector erase completes.
+
+/*********************************************************************
+*
+*       Defines, non-configurable
+*
+**********************************************************************
+*/
+#define BYTES_PER_PAGE            256u
+#define BYTES_PER_SECTOR          0x10000u
+#define NOR_CMD_WRSR              0x01u
+#define NOR_CMD_PP                0x02u
+#define NOR_CMD_WRDI              0x04u
+#define NOR_CMD_RDSR              0x05u
+#define NOR_CMD_WREN              0x06u
+#define NOR_CMD_FAST_READ         0x0Bu
+#define NOR_CMD_READ_SFDP         0x5Au
+#define NOR_CMD_RDID              0x9Fu
+#define NOR_CMD_SE                0xD8u
+#define STATUS_BUSY               (1u << 0)
+#define STATUS_WEL                (1u << 1)
+
+/*********************************************************************
+*
+*       Local data types
+*
+**********************************************************************
+*/
+typedef struct {
+  U8       aMem[NOR_SIZE];          // Memory array of the serial NOR flash device.
+  U8     * pWindow;                 // Memory-mapped window as seen by the CPU.
+  int      IsMemMode;
+  U8       Status;
+  unsigned NumBusyPolls;            // Number of status reads until the current operation completes.
+  U32      DirtyOffStart;           // Range of the memory array modified since the last refresh of the window.
+  U32      DirtyOffEnd;
+  //
+  // Counters.
+  //
+  U32      NumReadCmds;
+  U32      NumBytesBus;             // Bytes transferred by the read commands including command, address and dummy bytes.
+  U32      NumPrograms;
+  U32      NumErases;
+  U32      NumMemModeSwitches;
+  U32      NumErrors;               // Protocol violations.
+} NOR_MOCK;
+
+typedef struct {
+  U32 NumReadOff;
+  U32 NumBytesReadOff;
+  U32 NumMapRead;
+  U32 NumBytesMapRead;
+  U32 NumMapReadFailed;
+} PHY_STAT;
+
+typedef struct {
+  U8  aData[MAX_FILE_SIZE];
+  U32 NumBytes;
+  int IsPresent;
+} FILE_SHADOW;
+
+/*********************************************************************
+*
+*       Static data
+*
+**********************************************************************
+*/
+static U32              _aMemBlock[ALLOC_SIZE / 4u];
+static NOR_MOCK         _aNor[NUM_UNITS];
+static PHY_STAT         _aPhyStat[NUM_UNITS];
+static FS_NOR_PHY_TYPE  _PhyType;                   // SPIFI physical layer with counting read functions.
+static FILE_SHADOW      _aFile[NUM_FILES];
+static U8               _aRef[NOR_SIZE];
+static U8               _aBuffer[MAX_FILE_SIZE];
+static U32              _Seed = 0x2545F491uL;
+
+/*********************************************************************
+*
+*       Static code, NOR device simulation
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _Rand
+*/
+static U32 _Rand(void) {
+  _Seed ^= _Seed << 13;
+  _Seed ^= _Seed >> 17;
+  _Seed ^= _Seed << 5;
+  return _Seed;
+}
+
+/*********************************************************************
+*
+*       _MarkDirty
+*/
+static void _MarkDirty(NOR_MOCK * pNor, U32 Off, U32 NumBytes) {
+  if (pNor->DirtyOffStart == pNor->DirtyOffEnd) {
+    pNor->DirtyOffStart = Off;
+    pNor->DirtyOffEnd   = Off + NumBytes;
+  } else {
+    pNor->DirtyOffStart = SEGGER_MIN(pNor->DirtyOffStart, Off);
+    pNor->DirtyOffEnd   = SEGGER_MAX(pNor->DirtyOffEnd, Off + NumBytes);
+  }
+}
+
+/*********************************************************************
+*
+*       _GetAddr
+*/
+static U32 _GetAddr(const U8 * pPara, unsigned NumBytesAddr) {
+  U32 Addr;
+
+  Addr = 0;
+  while (NumBytesAddr-- != 0u) {
+    Addr = (Addr << 8) | *pPara++;
+  }
+  return Addr % NOR_SIZE;
+}
+
+/*********************************************************************
+*
+*       _CheckCmdMode
+*
+*  Function description
+*    Commands can be sent only in command mode and, except for
+*    the status request, only when no operation is in progress.
+*/
+static void _CheckCmdMode(NOR_MOCK * pNor, U8 Cmd) {
+  if (pNor->IsMemMode != 0) {
+    printf("  NOR: command 0x%02X sent in memory mode\n", Cmd);
+    pNor->NumErrors++;
+  }
+  if (((pNor->Status & STATUS_BUSY) != 0u) && (Cmd != NOR_CMD_RDSR)) {
+    printf("  NOR: command 0x%02X sent while busy\n", Cmd);
+    pNor->NumErrors++;
+  }
+}
+
+/*********************************************************************
+*
+*       _StartOperation
+*/
+static int _StartOperation(NOR_MOCK * pNor, U8 Cmd, unsigned NumBusyPolls) {
+  if ((pNor->Status & STATUS_WEL) == 0u) {
+    printf("  NOR: command 0x%02X sent without write enable\n", Cmd);
+    pNor->NumErrors++;
+    return 1;                             // The device ignores the command.
+  }
+  pNor->Status       |= STATUS_BUSY;
+  pNor->NumBusyPolls  = NumBusyPolls;
+  return 0;
+}
+
+/*********************************************************************
+*
+*       Static code, HW layer simulation
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _HW_Init
+*/
+static int _HW_Init(U8 Unit) {
+  FS_USE_PARA(Unit);
+  return 50000000;                        // 50 MHz SPI clock.
+}
+
+/*********************************************************************
+*
+*       _HW_SetCmdMode
+*
+*  Function description
+*    Disables the memory mode. The window is not accessible afterwards.
+*/
+static void _HW_SetCmdMode(U8 Unit) {
+  NOR_MOCK * pNor;
+
+  pNor = &_aNor[Unit];
+  if (pNor->IsMemMode != 0) {
+    (void)mprotect(pNor->pWindow, NOR_SIZE, PROT_NONE);
+    pNor->IsMemMode = 0;
+  }
+}
+
+/*********************************************************************
+*
+*       _HW_SetMemMode
+*
+*  Function description
+*    Enables the memory mode. The window is refreshed from the memory
+*    array, the same as the invalidation of a cached window.
+*/
+static void _HW_SetMemMode(U8 Unit, U8 ReadCmd, unsigned NumBytesAddr, unsigned NumBytesDummy, U16 BusWidth) {
+  NOR_MOCK * pNor;
+
+  FS_USE_PARA(BusWidth);
+  pNor = &_aNor[Unit];
+  if ((ReadCmd != NOR_CMD_FAST_READ) || (NumBytesAddr != 3u) || (NumBytesDummy != 1u)) {
+    printf("  NOR: memory mode with command 0x%02X, %u address, %u dummy bytes\n", ReadCmd, NumBytesAddr, NumBytesDummy);
+    pNor->NumErrors++;
+  }
+  if ((pNor->Status & STATUS_BUSY) != 0u) {
+    printf("  NOR: memory mode entered while busy\n");
+    pNor->NumErrors++;
+  }
+  if (pNor->IsMemMode == 0) {
+    (void)mprotect(pNor->pWindow, NOR_SIZE, PROT_READ | PROT_WRITE);
+    if (pNor->DirtyOffStart != pNor->DirtyOffEnd) {
+      memcpy(pNor->pWindow + pNor->DirtyOffStart, &pNor->aMem[pNor->DirtyOffStart], pNor->DirtyOffEnd - pNor->DirtyOffStart);
+      pNor->DirtyOffStart = 0;
+      pNor->DirtyOffEnd   = 0;
+    }
+    (void)mprotect(pNor->pWindow, NOR_SIZE, PROT_READ);
+    pNor->IsMemMode = 1;
+    pNor->NumMemModeSwitches++;
+  }
+}
+
+/*********************************************************************
+*
+*       _HW_ExecCmd
+*/
+static void _HW_ExecCmd(U8 Unit, U8 Cmd, U8 BusWidth) {
+  NOR_MOCK * pNor;
+
+  FS_USE_PARA(BusWidth);
+  pNor = &_aNor[Unit];
+  _CheckCmdMode(pNor, Cmd);
+  switch (Cmd) {
+  case NOR_CMD_WREN:
+    pNor->Status |= STATUS_WEL;
+    break;
+  case NOR_CMD_WRDI:
+    pNor->Status &= (U8)~STATUS_WEL;
+    break;
+  default:
+    break;
+  }
+}
+
+/*********************************************************************
+*
+*       _HW_ReadData
+*/
+static void _HW_ReadData(U8 Unit, U8 Cmd, const U8 * pPara, unsigned NumBytesPara, unsigned NumBytesAddr, U8 * pData, unsigned NumBytesData, U16 BusWidth) {
+  NOR_MOCK * pNor;
+  U32        Addr;
+  unsigned   i;
+  static const U8 _abId[3] = {0xEF, 0x40, 0x14};    // Not an SFDP device, identified by the density.
+
+  FS_USE_PARA(BusWidth);
+  pNor = &_aNor[Unit];
+  _CheckCmdMode(pNor, Cmd);
+  memset(pData, 0xFF, NumBytesData);
+  switch (Cmd) {
+  case NOR_CMD_RDID:
+    memcpy(pData, _abId, SEGGER_MIN(NumBytesData, sizeof(_abId)));
+    break;
+  case NOR_CMD_RDSR:
+    for (i = 0; i < NumBytesData; ++i) {
+      pData[i] = pNor->Status;
+      if (pNor->NumBusyPolls != 0u) {
+        if (--pNor->NumBusyPolls == 0u) {
+          pNor->Status &= (U8)~(STATUS_BUSY | STATUS_WEL);
+        }
+      }
+    }
+    break;
+  case NOR_CMD_FAST_READ:
+    if ((NumBytesAddr != 3u) || (NumBytesPara != 4u)) {
+      pNor->NumErrors++;
+    }
+    Addr = _GetAddr(pPara, NumBytesAddr);
+    for (i = 0; i < NumBytesData; ++i) {
+      pData[i] = pNor->aMem[(Addr + i) % NOR_SIZE];
+    }
+    pNor->NumReadCmds++;
+    pNor->NumBytesBus += 1u + NumBytesPara + NumBytesData;
+    break;
+  default:                                // NOR_CMD_READ_SFDP and others are not supported.
+    break;
+  }
+}
+
+/*********************************************************************
+*
+*       _HW_WriteData
+*
+*  Function description
+*    Executes a program, erase or status write command. The device
+*    sees only the bytes on the bus: the address is taken from the
+*    first bytes after the command, whether the physical layer passes
+*    them as parameters or as data.
+*/
+static void _HW_WriteData(U8 Unit, U8 Cmd, const U8 * pPara, unsigned NumBytesPara, unsigned NumBytesAddr, const U8 * pData, unsigned NumBytesData, U16 BusWidth) {
+  NOR_MOCK * pNor;
+  U8         abBus[4 + BYTES_PER_PAGE + 1];
+  unsigned   NumBytes;
+  U32        Addr;
+  unsigned   i;
+
+  FS_USE_PARA(NumBytesAddr);
+  FS_USE_PARA(BusWidth);
+  pNor = &_aNor[Unit];
+  _CheckCmdMode(pNor, Cmd);
+  NumBytes = NumBytesPara + NumBytesData;
+  if (NumBytes > sizeof(abBus)) {
+    printf("  NOR: command 0x%02X with %u bytes\n", Cmd, NumBytes);
+    pNor->NumErrors++;
+    return;
+  }
+  if (NumBytesPara != 0u) {
+    memcpy(abBus, pPara, NumBytesPara);
+  }
+  if (NumBytesData != 0u) {
+    memcpy(&abBus[NumBytesPara], pData, NumBytesData);
+  }
+  switch (Cmd) {
+  case NOR_CMD_PP:
+    if (NumBytes < 3u) {
+      pNor->NumErrors++;
+      break;
+    }
+    if (_StartOperation(pNor, Cmd, NUM_BUSY_POLLS_PROGRAM) == 0) {
+      Addr      = _GetAddr(abBus, 3);
+      NumBytes -= 3u;
+      if (((Addr % BYTES_PER_PAGE) + NumBytes) > BYTES_PER_PAGE) {
+        printf("  NOR: program of %u bytes at 0x%06lX crosses a page boundary\n", NumBytes, (unsigned long)Addr);
+        pNor->NumErrors++;
+        NumBytes = BYTES_PER_PAGE - (Addr % BYTES_PER_PAGE);
+      }
+      for (i = 0; i < NumBytes; ++i) {
+        pNor->aMem[Addr + i] &= abBus[3u + i];  // Programming can only clear bits.
+      }
+      _MarkDirty(pNor, Addr, NumBytes);
+      pNor->NumPrograms++;
+    }
+    break;
+  case NOR_CMD_SE:
+    if (NumBytes != 3u) {
+      pNor->NumErrors++;
+      break;
+    }
+    if (_StartOperation(pNor, Cmd, NUM_BUSY_POLLS_ERASE) == 0) {
+      Addr = _GetAddr(abBus, 3) & ~(BYTES_PER_SECTOR - 1u);
+      memset(&pNor->aMem[Addr], 0xFF, BYTES_PER_SECTOR);
+      _MarkDirty(pNor, Addr, BYTES_PER_SECTOR);
+      pNor->NumErases++;
+    }
+    break;
+  case NOR_CMD_WRSR:
+    if (_StartOperation(pNor, Cmd, 1) == 0) {
+      if (NumBytes != 0u) {
+        pNor->Status = (U8)((pNor->Status & (STATUS_BUSY | STATUS_WEL)) | (abBus[0] & 0xFCu));
+      }
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+/*********************************************************************
+*
+*       _HW_Delay
+*/
+static int _HW_Delay(U8 Unit, U32 ms) {
+  FS_USE_PARA(Unit);
+  FS_USE_PARA(ms);
+  return 0;
+}
+
+/*********************************************************************
+*
+*       _HWTypeMap
+*
+*  Description
+*    Controller with memory mode.
+*/
+static const FS_NOR_HW_TYPE_SPIFI _HWTypeMap = {
+  _HW_Init,
+  _HW_SetCmdMode,
+  _HW_SetMemMode,
+  _HW_ExecCmd,
+  _HW_ReadData,
+  _HW_WriteData,
+  NULL,
+  _HW_Delay,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL
+};
+
+/*********************************************************************
+*
+*       _HWTypeCmd
+*
+*  Description
+*    Controller without memory mode, all the data is read via commands.
+*/
+static const FS_NOR_HW_TYPE_SPIFI _HWTypeCmd = {
+  _HW_Init,
+  _HW_SetCmdMode,
+  NULL,
+  _HW_ExecCmd,
+  _HW_ReadData,
+  _HW_WriteData,
+  NULL,
+  _HW_Delay,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL
+};
+
+/*********************************************************************
+*
+*       Static code, physical layer wrappers
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _PHY_ReadOff
+*/
+static int _PHY_ReadOff(U8 Unit, void * pData, U32 Off, U32 NumBytes) {
+  _aPhyStat[Unit].NumReadOff++;
+  _aPhyStat[Unit].NumBytesReadOff += NumBytes;
+  return FS_NOR_PHY_SPIFI.pfReadOff(Unit, pData, Off, NumBytes);
+}
+
+/*********************************************************************
+*
+*       _PHY_MapRead
+*/
+static const void * _PHY_MapRead(U8 Unit, U32 Off, U32 NumBytes) {
+  const void * p;
+
+  p = FS_NOR_PHY_SPIFI.pfMapRead(Unit, Off, NumBytes);
+  if (p != NULL) {
+    _aPhyStat[Unit].NumMapRead++;
+    _aPhyStat[Unit].NumBytesMapRead += NumBytes;
+  } else {
+    _aPhyStat[Unit].NumMapReadFailed++;
+  }
+  return p;
+}
+
+/*********************************************************************
+*
+*       _OnFault
+*
+*  Function description
+*    Reports an access to a window that is not in memory mode
+*    or outside of the mapped flash.
+*/
+static void _OnFault(int Signal, siginfo_t * pInfo, void * pContext) {
+  static const char _acWindow[] = "Memory-mapped window accessed in command mode or out of range\n";
+  static const char _acOther[]  = "Segmentation fault\n";
+  unsigned long     Addr;
+
+  FS_USE_PARA(Signal);
+  FS_USE_PARA(pContext);
+  Addr = (unsigned long)pInfo->si_addr;
+  if ((Addr >= WINDOW_ADDR) && (Addr < (WINDOW_ADDR + NUM_UNITS * WINDOW_STRIDE))) {
+    (void)write(STDOUT_FILENO, _acWindow, sizeof(_acWindow) - 1u);
+  } else {
+    (void)write(STDOUT_FILENO, _acOther, sizeof(_acOther) - 1u);
+  }
+  _exit(2);
+}
+
+/*********************************************************************
+*
+*       _InitNor
+*/
+static int _InitNor(unsigned Unit) {
+  NOR_MOCK      * pNor;
+  void          * p;
+  U32             i;
+  unsigned long   Addr;
+
+  pNor = &_aNor[Unit];
+  Addr = WINDOW_ADDR + Unit * WINDOW_STRIDE;
+  p    = mmap((void *)Addr, NOR_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED) {
+    return 1;
+  }
+  if ((unsigned long)p != Addr) {
+    (void)munmap(p, NOR_SIZE);
+    return 1;
+  }
+  for (i = 0; i < NOR_SIZE; ++i) {
+    pNor->aMem[i] = (U8)(_Rand() >> 24);  // Not erased.
+  }
+  pNor->pWindow = (U8 *)p;
+  memcpy(pNor->pWindow, pNor->aMem, NOR_SIZE);
+  (void)mprotect(pNor->pWindow, NOR_SIZE, PROT_NONE);
+  return 0;
+}
+
+/*********************************************************************
+*
+*       _GetWindowAddr
+*/
+static U32 _GetWindowAddr(unsigned Unit) {
+  return (U32)(WINDOW_ADDR + Unit * WINDOW_STRIDE);
+}
+
+/*********************************************************************
+*
+*       Static code, physical layer test
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _CheckRange
+*
+*  Function description
+*    Reads a range via the window and via the read function
+*    and compares it with the reference image.
+*/
+static unsigned _CheckRange(unsigned Unit, int IsMapped, U32 Off, U32 NumBytes) {
+  const U8 * p;
+  unsigned   NumErrors;
+  int        r;
+
+  NumErrors = 0;
+  p = (const U8 *)_PhyType.pfMapRead((U8)Unit, Off, NumBytes);
+  if (IsMapped != 0) {
+    if ((p == NULL) || (memcmp(p, &_aRef[Off], NumBytes) != 0)) {
+      NumErrors++;
+    }
+  } else {
+    if (p != NULL) {
+      NumErrors++;
+    }
+  }
+  memset(_aBuffer, 0x5A, NumBytes);
+  r = _PhyType.pfReadOff((U8)Unit, _aBuffer, Off, NumBytes);
+  if ((r != 0) || (memcmp(_aBuffer, &_aRef[Off], NumBytes) != 0)) {
+    NumErrors++;
+  }
+  return NumErrors;
+}
+
+/*********************************************************************
+*
+*       _TestPhy
+*
+*  Function description
+*    Checks the data seen via the window and via the read function
+*    after random program and erase operations.
+*/
+static void _TestPhy(unsigned Unit, int IsMapped) {
+  NOR_MOCK * pNor;
+  unsigned   NumErrors;
+  unsigned   iOp;
+  U32        Off;
+  U32        NumBytes;
+  U32        OffCheck;
+  U32        NumBytesCheck;
+  U32        SectorOff;
+  U32        SectorSize;
+  unsigned   SectorIndex;
+  unsigned   NumSectors;
+  unsigned   i;
+  int        r;
+
+  pNor = &_aNor[Unit];
+  _PhyType.pfOnSelectPhy((U8)Unit);
+  FS_NOR_SPIFI_SetHWType((U8)Unit, (IsMapped != 0) ? &_HWTypeMap : &_HWTypeCmd);
+  _PhyType.pfConfigure((U8)Unit, _GetWindowAddr(Unit), _GetWindowAddr(Unit), NOR_SIZE);
+  r = _PhyType.pfInit((U8)Unit);
+  TEST_CHECK_EQ(r, 0);
+  NumSectors = (unsigned)_PhyType.pfGetNumSectors((U8)Unit);
+  TEST_CHECK_EQ(NumSectors, NOR_SIZE / BYTES_PER_SECTOR);
+  TEST_CHECK_EQ(pNor->IsMemMode, IsMapped);
+  memcpy(_aRef, pNor->aMem, NOR_SIZE);
+  NumErrors = 0;
+  for (iOp = 0; iOp < NUM_PHY_OPS; ++iOp) {
+    if ((_Rand() % 16u) == 0u) {
+      SectorIndex = _Rand() % NumSectors;
+      SectorOff   = 0;
+      SectorSize  = 0;
+      _PhyType.pfGetSectorInfo((U8)Unit, SectorIndex, &SectorOff, &SectorSize);
+      r = _PhyType.pfEraseSector((U8)Unit, SectorIndex);
+      if (r != 0) {
+        NumErrors++;
+      }
+      memset(&_aRef[SectorOff], 0xFF, SectorSize);
+      Off      = SectorOff;
+      NumBytes = SectorSize;
+    } else {
+      Off      = _Rand() % NOR_SIZE;
+      NumBytes = 1u + _Rand() % 700u;
+      NumBytes = SEGGER_MIN(NumBytes, NOR_SIZE - Off);
+      for (i = 0; i < NumBytes; ++i) {
+        _aBuffer[i] = (U8)(_Rand() >> 24);
+        _aRef[Off + i] &= _aBuffer[i];
+      }
+      r = _PhyType.pfWriteOff((U8)Unit, Off, _aBuffer, NumBytes);
+      if (r != 0) {
+        NumErrors++;
+      }
+    }
+    TEST_CHECK_EQ(pNor->IsMemMode, IsMapped);
+    //
+    // Read the modified range with some bytes around it and a random range.
+    //
+    OffCheck      = (Off > 64u) ? (Off - 64u) : 0u;
+    NumBytesCheck = SEGGER_MIN(NumBytes + 128u, NOR_SIZE - OffCheck);
+    NumBytesCheck = SEGGER_MIN(NumBytesCheck, (U32)sizeof(_aBuffer));
+    NumErrors += _CheckRange(Unit, IsMapped, OffCheck, NumBytesCheck);
+    OffCheck      = _Rand() % NOR_SIZE;
+    NumBytesCheck = 1u + _Rand() % (U32)sizeof(_aBuffer);
+    NumBytesCheck = SEGGER_MIN(NumBytesCheck, NOR_SIZE - OffCheck);
+    NumErrors += _CheckRange(Unit, IsMapped, OffCheck, NumBytesCheck);
+  }
+  TEST_CHECK_EQ(NumErrors, 0u);
+  TEST_CHECK_EQ(memcmp(pNor->aMem, _aRef, NOR_SIZE), 0);
+  //
+  // The whole device can be mapped, but not more.
+  //
+  if (IsMapped != 0) {
+    TEST_CHECK(_PhyType.pfMapRead((U8)Unit, 0, NOR_SIZE) == (const void *)pNor->pWindow);
+    TEST_CHECK_EQ(memcmp(pNor->pWindow, _aRef, NOR_SIZE), 0);
+  }
+  TEST_CHECK(_PhyType.pfMapRead((U8)Unit, 0, NOR_SIZE + 1u)   == NULL);
+  TEST_CHECK(_PhyType.pfMapRead((U8)Unit, NOR_SIZE - 4u, 8u) == NULL);
+  TEST_CHECK(_PhyType.pfMapRead((U8)Unit, NOR_SIZE, 0u)      == NULL);
+  TEST_CHECK_EQ(pNor->NumErrors, 0u);
+  if (IsMapped != 0) {
+    TEST_CHECK_EQ(pNor->NumReadCmds, 0u);
+  } else {
+    TEST_CHECK(pNor->NumReadCmds != 0u);
+    TEST_CHECK_EQ(pNor->NumMemModeSwitches, 0u);
+  }
+  printf("  PHY %s: %u operations, %lu programs, %lu erases, %lu memory mode switches, %lu read commands\n",
+         (IsMapped != 0) ? "memory mode " : "command mode", NUM_PHY_OPS,
+         (unsigned long)pNor->NumPrograms, (unsigned long)pNor->NumErases,
+         (unsigned long)pNor->NumMemModeSwitches, (unsigned long)pNor->NumReadCmds);
+}
+
+/*********************************************************************
+*
+*       _TestTrap
+*
+*  Function description
+*    Checks that the simulation catches a read of the window in
+*    command mode, which would return stale data or status bytes
+*    on the target.
+*/
+static void _TestTrap(unsigned Unit) {
+  NOR_MOCK * pNor;
+  pid_t      Pid;
+  int        Status;
+
+  pNor = &_aNor[Unit];
+  fflush(stdout);
+  Pid = fork();
+  if (Pid == 0) {
+    _HW_SetCmdMode((U8)Unit);
+    Status = *(volatile U8 *)pNor->pWindow;
+    _exit(Status == -1);                  // Not reached.
+  }
+  TEST_CHECK(Pid > 0);
+  Status = 0;
+  (void)waitpid(Pid, &Status, 0);
+  TEST_CHECK(WIFEXITED(Status));
+  TEST_CHECK_EQ(WEXITSTATUS(Status), 2);
+  TEST_CHECK_EQ(pNor->IsMemMode, 1);      // The parent is not affected.
+}
+
+/*********************************************************************
+*
+*       Static code, file system test
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _GetFileName
+*/
+static void _GetFileName(char * sPath, const char * sVolume, unsigned iFile) {
+  sprintf(sPath, "%s/F%02u.BIN", sVolume, iFile);
+}
+
+/*********************************************************************
+*
+*       _VerifyFile
+*/
+static unsigned _VerifyFile(const char * sVolume, unsigned iFile) {
+  char          acPath[32];
+  FS_FILE     * pFile;
+  FILE_SHADOW * pShadow;
+  U32           NumBytes;
+  unsigned      NumErrors;
+
+  NumErrors = 0;
+  pShadow   = &_aFile[iFile];
+  _GetFileName(acPath, sVolume, iFile);
+  pFile = FS_FOpen(acPath, "rb");
+  if (pShadow->IsPresent == 0) {
+    if (pFile != NULL) {
+      (void)FS_FClose(pFile);
+      NumErrors++;                        // Deleted file still present.
+    }
+    return NumErrors;
+  }
+  if (pFile == NULL) {
+    return 1;
+  }
+  if (FS_GetFileSize(pFile) != pShadow->NumBytes) {
+    NumErrors++;
+  }
+  NumBytes = FS_Read(pFile, _aBuffer, sizeof(_aBuffer));
+  if ((NumBytes != pShadow->NumBytes) || (memcmp(_aBuffer, pShadow->aData, NumBytes) != 0)) {
+    NumErrors++;
+  }
+  (void)FS_FClose(pFile);
+  return NumErrors;
+}
+
+/*********************************************************************
+*
+*       _RunWorkload
+*
+*  Function description
+*    Creates, overwrites, extends, deletes and verifies files.
+*    The volume is unmounted periodically so that the driver
+*    reads its management information from the flash again.
+*/
+static unsigned _RunWorkload(const char * sVolume, U32 Seed) {
+  char          acPath[32];
+  FS_FILE     * pFile;
+  FILE_SHADOW * pShadow;
+  unsigned      NumErrors;
+  unsigned      iOp;
+  unsigned      iFile;
+  U32           Off;
+  U32           NumBytes;
+  U32           i;
+  int           r;
+
+  _Seed     = Seed;
+  NumErrors = 0;
+  memset(_aFile, 0, sizeof(_aFile));
+  r = FS_FormatLow(sVolume);
+  if (r != 0) {
+    return 1;
+  }
+  r = FS_Format(sVolume, NULL);
+  if (r != 0) {
+    return 1;
+  }
+  for (iOp = 0; iOp < NUM_FS_OPS; ++iOp) {
+    iFile   = _Rand() % NUM_FILES;
+    pShadow = &_aFile[iFile];
+    _GetFileName(acPath, sVolume, iFile);
+    switch (_Rand() % 8u) {
+    case 0:
+    case 1:
+    case 2:
+      //
+      // Create or replace a file.
+      //
+      NumBytes = _Rand() % (MAX_FILE_SIZE + 1u);
+      for (i = 0; i < NumBytes; ++i) {
+        pShadow->aData[i] = (U8)(_Rand() >> 24);
+      }
+      pShadow->NumBytes  = NumBytes;
+      pShadow->IsPresent = 1;
+      pFile = FS_FOpen(acPath, "wb");
+      if ((pFile == NULL) || (FS_Write(pFile, pShadow->aData, NumBytes) != NumBytes)) {
+        NumErrors++;
+      }
+      if (pFile != NULL) {
+        (void)FS_FClose(pFile);
+      }
+      break;
+    case 3:
+    case 4:
+      //
+      // Overwrite a part of a file, possibly extending it.
+      //
+      if (pShadow->IsPresent != 0) {
+        Off      = _Rand() % (pShadow->NumBytes + 1u);
+        NumBytes = _Rand() % (MAX_FILE_SIZE - Off + 1u);
+        NumBytes = SEGGER_MIN(NumBytes, 2048u);
+        for (i = 0; i < NumBytes; ++i) {
+          pShadow->aData[Off + i] = (U8)(_Rand() >> 24);
+        }
+        pShadow->NumBytes = SEGGER_MAX(pShadow->NumBytes, Off + NumBytes);
+        pFile = FS_FOpen(acPath, "r+b");
+        if (pFile == NULL) {
+          NumErrors++;
+          break;
+        }
+        if ((FS_FSeek(pFile, (I32)Off, FS_SEEK_SET) != 0) || (FS_Write(pFile, &pShadow->aData[Off], NumBytes) != NumBytes)) {
+          NumErrors++;
+        }
+        (void)FS_FClose(pFile);
+      }
+      break;
+    case 5:
+      //
+      // Delete a file.
+      //
+      if (pShadow->IsPresent != 0) {
+        if (FS_Remove(acPath) != 0) {
+          NumErrors++;
+        }
+        pShadow->IsPresent = 0;
+      }
+      break;
+    default:
+      NumErrors += _VerifyFile(sVolume, iFile);
+      break;
+    }
+    if (((iOp + 1u) % REMOUNT_PERIOD) == 0u) {
+      FS_Unmount(sVolume);
+      for (iFile = 0; iFile < NUM_FILES; ++iFile) {
+        NumErrors += _VerifyFile(sVolume, iFile);
+      }
+    }
+  }
+  FS_Unmount(sVolume);
+  for (iFile = 0; iFile < NUM_FILES; ++iFile) {
+    NumErrors += _VerifyFile(sVolume, iFile);
+  }
+  FS_Unmount(sVolume);
+  return NumErrors;
+}
+
+/*********************************************************************
+*
+*       _PrintFSStat
+*/
+static void _PrintFSStat(unsigned Unit) {
+  const NOR_MOCK * pNor;
+  const PHY_STAT * pStat;
+
+  pNor  = &_aNor[Unit];
+  pStat = &_aPhyStat[Unit];
+  printf("  nor:%u: %s: %7lu mapped reads %9lu bytes, %7lu read calls %9lu bytes, %7lu read commands %9lu bus bytes\n",
+         Unit, (Unit == 0u) ? "window" : "command",
+         (unsigned long)pStat->NumMapRead, (unsigned long)pStat->NumBytesMapRead,
+         (unsigned long)pStat->NumReadOff, (unsigned long)pStat->NumBytesReadOff,
+         (unsigned long)pNor->NumReadCmds, (unsigned long)pNor->NumBytesBus);
+  printf("          %lu programs, %lu erases, %lu memory mode switches\n",
+         (unsigned long)pNor->NumPrograms, (unsigned long)pNor->NumErases, (unsigned long)pNor->NumMemModeSwitches);
+}
+
+/*********************************************************************
+*
+*       _TestFileSystem
+*
+*  Function description
+*    Runs the same workload on a volume read via the window and on
+*    a volume read via commands. The driver takes the same decisions
+*    on both only if it reads the same data from both.
+*/
+static void _TestFileSystem(void) {
+  unsigned NumErrors;
+
+  //
+  // Both volumes start with the same flash contents, the driver
+  // does not necessarily erase all the physical sectors.
+  //
+  memcpy(_aNor[1].aMem, _aNor[0].aMem, NOR_SIZE);
+  memset(_aPhyStat, 0, sizeof(_aPhyStat));
+  NumErrors = _RunWorkload("nor:0:", 0x9E3779B9uL);
+  TEST_CHECK_EQ(NumErrors, 0u);
+  NumErrors = _RunWorkload("nor:1:", 0x9E3779B9uL);
+  TEST_CHECK_EQ(NumErrors, 0u);
+  _PrintFSStat(0);
+  _PrintFSStat(1);
+  TEST_CHECK_EQ(_aNor[0].NumErrors, 0u);
+  TEST_CHECK_EQ(_aNor[1].NumErrors, 0u);
+  //
+  // Volume 0 reads everything via the window, volume 1 via commands.
+  //
+  TEST_CHECK(_aPhyStat[0].NumMapRead != 0u);
+  TEST_CHECK_EQ(_aPhyStat[0].NumReadOff, 0u);
+  TEST_CHECK_EQ(_aPhyStat[0].NumMapReadFailed, 0u);
+  TEST_CHECK_EQ(_aNor[0].NumReadCmds, 0u);
+  TEST_CHECK_EQ(_aPhyStat[1].NumMapRead, 0u);
+  TEST_CHECK(_aPhyStat[1].NumReadOff != 0u);
+  TEST_CHECK_EQ(_aNor[1].NumMemModeSwitches, 0u);
+  //
+  // Same operations, same result.
+  //
+  TEST_CHECK_EQ(_aNor[0].NumPrograms, _aNor[1].NumPrograms);
+  TEST_CHECK_EQ(_aNor[0].NumErases, _aNor[1].NumErases);
+  TEST_CHECK_EQ(memcmp(_aNor[0].aMem, _aNor[1].aMem, NOR_SIZE), 0);
+}
+
+/*********************************************************************
+*
+*       Public code, file system configuration
+*
+**********************************************************************
+*/
+void FS_X_AddDevices(void) {
+  U8 Unit;
+
+  FS_AssignMemory(&_aMemBlock[0], sizeof(_aMemBlock));
+  for (Unit = 0; Unit < 2u; ++Unit) {
+#if USE_NOR_BM
+    FS_AddDevice(&FS_NOR_BM_Driver);
+    FS_NOR_BM_SetPhyType(Unit, &_PhyType);
+    FS_NOR_SPIFI_SetHWType(Unit, (Unit == 0u) ? &_HWTypeMap : &_HWTypeCmd);
+    FS_NOR_BM_Configure(Unit, _GetWindowAddr(Unit), _GetWindowAddr(Unit), NOR_SIZE);
+#else
+    FS_AddDevice(&FS_NOR_Driver);
+    FS_NOR_SetPhyType(Unit, &_PhyType);
+    FS_NOR_SPIFI_SetHWType(Unit, (Unit == 0u) ? &_HWTypeMap : &_HWTypeCmd);
+    FS_NOR_Configure(Unit, _GetWindowAddr(Unit), _GetWindowAddr(Unit), NOR_SIZE);
+    FS_NOR_SetSectorSize(Unit, 512);
+#endif
+  }
+}
+
+U32 FS_X_GetTimeDate(void) {
+  return 0x00210000uL;              // 1 Jan 1980
+}
+
+void FS_X_Panic(int ErrorCode) {
+  printf("FS_X_Panic: %d\n", ErrorCode);
+  exit(1);
+}
+
+/*********************************************************************
+*
+*       Public code, OS layer
+*
+**********************************************************************
+*/
+void FS_X_OS_Lock(unsigned LockIndex) {
+  FS_USE_PARA(LockIndex);
+}
+
+void FS_X_OS_Unlock(unsigned LockIndex) {
+  FS_USE_PARA(LockIndex);
+}
+
+void FS_X_OS_Init(unsigned NumLocks) {
+  FS_USE_PARA(NumLocks);
+}
+
+void FS_X_OS_DeInit(void) {
+}
+
+U32 FS_X_OS_GetTime(void) {
+  return 0;
+}
+
+int FS_X_OS_Wait(int TimeOut) {
+  FS_USE_PARA(TimeOut);
+  return 0;
+}
+
+void FS_X_OS_Signal(void) {
+}
+
+void FS_X_OS_Delay(int ms) {
+  FS_USE_PARA(ms);
+}
+
+/*********************************************************************
+*
+*       Public code, test
+*
+**********************************************************************
+*/
+int main(void) {
+  struct sigaction Action;
+  unsigned         Unit;
+
+  for (Unit = 0; Unit < NUM_UNITS; ++Unit) {
+    if (_InitNor(Unit) != 0) {
+      printf("Could not map the window at 0x%08lX.\n", (unsigned long)_GetWindowAddr(Unit));
+      return 1;
+    }
+  }
+  memset(&Action, 0, sizeof(Action));
+  Action.sa_sigaction = _OnFault;
+  Action.sa_flags     = SA_SIGINFO;
+  (void)sigaction(SIGSEGV, &Action, NULL);
+  _PhyType           = FS_NOR_PHY_SPIFI;
+  _PhyType.pfReadOff = _PHY_ReadOff;
+  _PhyType.pfMapRead = _PHY_MapRead;
+  printf("NOR memory-mapped reads, %s driver\n", USE_NOR_BM ? "block map" : "sector map");
+  FS_Init();
+  _TestPhy(UNIT_PHY_MAP, 1);
+  _TestPhy(UNIT_PHY_CMD, 0);
+  _TestTrap(UNIT_PHY_MAP);
+  _TestFileSystem();
+  return TEST_Report(USE_NOR_BM ? "FS_NOR_MapReadTest" : "FS_NOR_MapReadTest_SM");
+}
+
+/*************************** End of file ****************************/
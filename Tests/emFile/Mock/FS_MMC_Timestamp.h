@@ -0,0 +1,39 @@
+/*********************************************************************
+*                                                                    *
+*       emFile * File system for embedded applications               *
+*                                                                    *
+**********************************************************************
+----------------------------------------------------------------------
+File        : FS_MMC_Timestamp.h
+Purpose     : Host replacement of the DWT cycle counter used as time
+              base of the MMC/SD command latency counters. The file is
+              force-included so that FS_MMC_GET_TIMESTAMP() can refer
+              to the microsecond clock of the card model.
+-------------------------- END-OF-HEADER -----------------------------
+*/
+
+#ifndef FS_MMC_TIMESTAMP_H    // Avoid recursive and multiple inclusion
+#define FS_MMC_TIMESTAMP_H
+
+#include "Global.h"
+
+/*********************************************************************
+*
+*       Defines
+*
+**********************************************************************
+*/
+#define FS_MMC_GET_TIMESTAMP()            TEST_MMC_GetTimestamp()
+#define FS_MMC_TIMESTAMP_TICKS_PER_US     1uL
+
+/*********************************************************************
+*
+*       API functions
+*
+**********************************************************************
+*/
+U32 TEST_MMC_GetTimestamp(void);
+
+#endif                        // Avoid recursive and multiple inclusion
+
+/*************************** End of file ****************************/
@@ -0,0 +1,28 @@
+/*********************************************************************
+*                                                                    *
+*       emFile * File system for embedded applications               *
+*                                                                    *
+**********************************************************************
+----------------------------------------------------------------------
+File        : RTOS.h
+Purpose     : Host replacement of the embOS interrupt API used by the
+              HW layers. The test runs without interrupts so the
+              functions do nothing.
+-------------------------- END-OF-HEADER -----------------------------
+*/
+
+#ifndef RTOS_H                // Avoid recursive and multiple inclusion
+#define RTOS_H
+
+/*********************************************************************
+*
+*       Defines
+*
+**********************************************************************
+*/
+#define OS_EnterNestableInterrupt()
+#define OS_LeaveNestableInterrupt()
+
+#endif                        // Avoid recursive and multiple inclusion
+
+/*************************** End of file ****************************/
@@ -0,0 +1,119 @@
+/*********************************************************************
+*                                                                    *
+*       emFile * File system for embedded applications               *
+*                                                                    *
+**********************************************************************
+----------------------------------------------------------------------
+File        : main.h
+Purpose     : Host replacement of the CubeMX main.h for the NOR SPI
+              HW layer. The SPI4 registers are mapped to a simulated
+              peripheral and the HAL functions used by the HW layer
+              are implemented by the test. Every register access is
+              routed through MOCK_SPI_Access32() / MOCK_SPI_Access8()
+              so that the simulation can count the accesses and react
+              to them like the real peripheral.
+-------------------------- END-OF-HEADER -----------------------------
+*/
+
+#ifndef MAIN_H                // Avoid recursive and multiple inclusion
+#define MAIN_H
+
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {                  // Make sure we have C-declarations in C++ programs
+#endif
+
+/*********************************************************************
+*
+*       Defines
+*
+**********************************************************************
+*/
+#define __ALIGNED(x)                    __attribute__((aligned(x)))
+
+#define GPIO_PIN_RESET                  0
+#define GPIO_PIN_SET                    1
+#define MAIN_NVM_CS_n_GPIO_Port         ((GPIO_TypeDef *)0)
+#define MAIN_NVM_CS_n_Pin               (1u << 11)
+
+#define MOCK_SPI_REG_CR1                0x00u
+#define MOCK_SPI_REG_CR2                0x04u
+#define MOCK_SPI_REG_CFG1               0x08u
+#define MOCK_SPI_REG_SR                 0x14u
+#define MOCK_SPI_REG_IFCR               0x18u
+#define MOCK_SPI_REG_TXDR               0x20u
+#define MOCK_SPI_REG_RXDR               0x30u
+
+/*********************************************************************
+*
+*       SPI registers, simulated
+*/
+#define SPI_BASE_ADDR                   0u
+#define SPI_CR1                         (*MOCK_SPI_Access32(MOCK_SPI_REG_CR1))
+#define SPI_CR2                         (*MOCK_SPI_Access32(MOCK_SPI_REG_CR2))
+#define SPI_CFG1                        (*MOCK_SPI_Access32(MOCK_SPI_REG_CFG1))
+#define SPI_SR                          (*MOCK_SPI_Access32(MOCK_SPI_REG_SR))
+#define SPI_IFCR                        (*MOCK_SPI_Access32(MOCK_SPI_REG_IFCR))
+#define SPI_TXDR                        (*MOCK_SPI_Access32(MOCK_SPI_REG_TXDR))
+#define SPI_TXDR_8                      (*MOCK_SPI_Access8(MOCK_SPI_REG_TXDR))
+#define SPI_RXDR                        (*MOCK_SPI_Access32(MOCK_SPI_REG_RXDR))
+#define SPI_RXDR_8                      (*MOCK_SPI_Access8(MOCK_SPI_REG_RXDR))
+
+/*********************************************************************
+*
+*       Types
+*
+**********************************************************************
+*/
+typedef enum {
+  HAL_OK      = 0x00,
+  HAL_ERROR   = 0x01,
+  HAL_BUSY    = 0x02,
+  HAL_TIMEOUT = 0x03
+} HAL_StatusTypeDef;
+
+typedef int GPIO_PinState;
+
+typedef struct {
+  uint32_t Dummy;
+} GPIO_TypeDef;
+
+typedef struct {
+  uint32_t Instance;
+} SPI_HandleTypeDef;
+
+/*********************************************************************
+*
+*       Global data
+*
+**********************************************************************
+*/
+extern SPI_HandleTypeDef hspi4;
+
+/*********************************************************************
+*
+*       API functions
+*
+**********************************************************************
+*/
+volatile uint32_t * MOCK_SPI_Access32(unsigned RegOff);
+volatile uint8_t  * MOCK_SPI_Access8 (unsigned RegOff);
+
+void              MX_SPI4_Init                (void);
+void              HAL_GPIO_WritePin           (GPIO_TypeDef * GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+HAL_StatusTypeDef HAL_SPI_Receive             (SPI_HandleTypeDef * hspi, uint8_t * pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_Transmit            (SPI_HandleTypeDef * hspi, uint8_t * pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_Receive_DMA         (SPI_HandleTypeDef * hspi, uint8_t * pData, uint16_t Size);
+HAL_StatusTypeDef HAL_SPI_Transmit_DMA        (SPI_HandleTypeDef * hspi, const uint8_t * pData, uint16_t Size);
+HAL_StatusTypeDef HAL_SPI_Abort               (SPI_HandleTypeDef * hspi);
+void              SCB_InvalidateDCache_by_Addr(uint32_t * addr, int32_t dsize);
+void              SCB_CleanDCache_by_Addr     (uint32_t * addr, int32_t dsize);
+
+#if defined(__cplusplus)
+}                             // Make sure we have C-declarations in C++ programs
+#endif
+
+#endif                        // Avoid recursive and multiple inclusion
+
+/*************************** End of file ****************************/
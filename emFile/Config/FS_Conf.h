@@ -52,6 +52,15 @@ Purpose : Simple configuration for file system
                                   // The application has to provide an OS layer. Sample OS layers are provided in the
                                   // "Sample\FS\OS" folder of the emFile shipment.
 
+#ifdef CORE_CM7
+  //
+  // Time base of the command latency counters of the MMC/SD driver (FS_MMC_ENABLE_STATS).
+  // The DWT cycle counter is started by PROF_Init(). The CPU runs from HSI at 64 MHz, see SystemClock_Config().
+  //
+  #define FS_MMC_GET_TIMESTAMP()            (*(volatile U32 *)0xE0001004uL)    // DWT_CYCCNT
+  #define FS_MMC_TIMESTAMP_TICKS_PER_US     64uL
+#endif
+
 #endif                // Avoid multiple inclusion
 
 /*************************** End of file ****************************/
@@ -292,6 +292,7 @@ Literature:
 #define WAIT_TIMEOUT_CYCLES           (WAIT_TIMEOUT * FS_MMC_HW_CM_CYCLES_PER_1MS)
 #define SDMMC_PRIO                    15
 #define D1CCIPR_SDMMCSEL_BIT          16
+#define CMD_WRITE_MULTIPLE_BLOCK      25        // Command index of WRITE_MULTIPLE_BLOCK, sent by _HW_ContinueWrite().
 
 /*********************************************************************
 *
@@ -1533,6 +1534,69 @@ static int _HW_WriteData(U8 Unit, const void * pBuffer, unsigned NumBytes, unsig
   return r;
 }
 
+/*********************************************************************
+*
+*       _HW_ContinueWrite
+*
+*  Function description
+*    Sends a WRITE_MULTIPLE_BLOCK command and the data to a card
+*    that may still be programming the data of the previous write.
+*
+*  Parameters
+*    Unit       Index of the SD / MMC host controller (0-based).
+*    CmdFlags   Additional information about the command to execute.
+*    Arg        Command parameter (address of the first block).
+*    pBuffer    [IN] Data to be sent.
+*    NumBytes   Number of bytes in a data block.
+*    NumBlocks  Number of data blocks to be sent.
+*
+*  Return values
+*    FS_MMC_CARD_NO_ERROR             Success
+*    FS_MMC_CARD_RESPONSE_TIMEOUT     No response received
+*    FS_MMC_CARD_RESPONSE_CRC_ERROR   CRC error in response
+*    FS_MMC_CARD_WRITE_CRC_ERROR      CRC error reported by card
+*    FS_MMC_CARD_WRITE_GENERIC_ERROR  Any other error
+*
+*  Additional information
+*    _HW_SendCmd() waits via _WaitForInactive() for the card to release
+*    the busy signal on DAT0 and then sends CMD25 with the CMDTRANS bit
+*    set so that the data path state machine is started by the command.
+*    The DTEN bit of the data control register must not be used for
+*    this purpose because SD cards and MMC devices accept data only
+*    after a data transfer command.
+*
+*    NumBlocks has to fit into the 16-bit block counter and the total
+*    number of bytes into the data length register. Larger requests
+*    are rejected without sending the command.
+*/
+static int _HW_ContinueWrite(U8 Unit, unsigned CmdFlags, U32 Arg, const void * pBuffer, unsigned NumBytes, unsigned NumBlocks) {
+  int r;
+
+  if ((NumBlocks == 0u) || (NumBlocks > 0xFFFFu) || (NumBytes > 0xFFFFu)) {
+    return FS_MMC_CARD_WRITE_GENERIC_ERROR;         // Error, the block count or size cannot be represented.
+  }
+  if (((U32)NumBytes * NumBlocks) > DLENR_DATALENGTH_MASK) {
+    return FS_MMC_CARD_WRITE_GENERIC_ERROR;         // Error, the data length register is too small.
+  }
+  _pBuffer   = (void *)pBuffer;     // cast const away as this buffer is used also for storing the data from card
+  _BlockSize = (U16)NumBytes;
+  _NumBlocks = (U16)NumBlocks;
+  CmdFlags  |= 0
+            | FS_MMC_CMD_FLAG_DATATRANSFER
+            | FS_MMC_CMD_FLAG_WRITETRANSFER
+            ;
+  CmdFlags  &= ~(unsigned)(FS_MMC_CMD_FLAG_SETBUSY | FS_MMC_CMD_FLAG_WRITE_BURST_FILL);
+  _HW_SendCmd(Unit, CMD_WRITE_MULTIPLE_BLOCK, CmdFlags, FS_MMC_RESPONSE_FORMAT_R1, Arg);
+  r = _WaitEndOfResponse();
+  if (r == 0) {
+    r = _WriteData();
+  }
+  if (r) {
+    _Reset();
+  }
+  return r;
+}
+
 /*********************************************************************
 *
 *       _HW_SetDataPointer
@@ -1671,7 +1735,8 @@ const FS_MMC_HW_TYPE_CM FS_MMC_HW_CM_STM32H735_Morpheus = {
   NULL,
   NULL,
   NULL,
-  NULL
+  NULL,
+  _HW_ContinueWrite
 };
 
 /*************************** End of file ****************************/
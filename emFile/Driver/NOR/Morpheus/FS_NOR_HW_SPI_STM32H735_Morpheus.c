@@ -29,6 +29,7 @@ Purpose : Low-level flash driver for STM32H7 SPI interface.
 */
 #include "FS.h"
 #include "FS_OS.h"
+#include "FS_NOR_HW_SPI_STM32H735_Morpheus.h"
 #include "main.h"
 #include "RTOS.h"
 
@@ -50,6 +51,26 @@ Purpose : Low-level flash driver for STM32H7 SPI interface.
   #define FS_NOR_HW_NOR_CLK_HZ          FS_NOR_HW_PER_CLK_HZ        // Frequency of the clock supplied to NOR flash device
 #endif
 
+#ifndef   FS_NOR_HW_DMA_MIN_NUM_BYTES
+  #define FS_NOR_HW_DMA_MIN_NUM_BYTES   64                          // Transfers shorter than this are performed via the SPI FIFO (command, address and dummy bytes).
+#endif
+
+#ifndef   FS_NOR_HW_BOUNCE_BUFFER_SIZE
+  #define FS_NOR_HW_BOUNCE_BUFFER_SIZE  512                         // Size of the buffer used for DMA transfers to or from memory not accessible by DMA. Multiple of the cache line size.
+#endif
+
+#ifndef   FS_NOR_HW_FIFO_SIZE
+  #define FS_NOR_HW_FIFO_SIZE           8                           // Number of bytes in the FIFO of the SPI peripheral (SPI4 has 8 bytes).
+#endif
+
+#ifndef   FS_NOR_HW_CYCLES_PER_1MS
+  #define FS_NOR_HW_CYCLES_PER_1MS      400000                      // Number of status register reads that take about 1 ms.
+#endif
+
+#ifndef   FS_NOR_HW_ENABLE_STATS
+  #define FS_NOR_HW_ENABLE_STATS        0                           // Enables/disables the statistical counters.
+#endif
+
 /*********************************************************************
 *
 *       #include section, conditional
@@ -64,11 +85,87 @@ Purpose : Low-level flash driver for STM32H7 SPI interface.
 **********************************************************************
 */
 
+/*********************************************************************
+*
+*       SPI registers
+*
+*  The definitions can be replaced by main.h in order to run
+*  the HW layer against a simulated SPI peripheral on a PC.
+*
+*  SPI4 is used only by this HW layer and the file system lock makes
+*  sure that only one transfer is in progress at a time. CubeMX
+*  configures the peripheral via MX_SPI4_Init() and the HAL handle
+*  hspi4. A DMA transfer is started and completed via the HAL, which
+*  owns the peripheral from HAL_SPI_Receive_DMA() / HAL_SPI_Transmit_DMA()
+*  until the completion callback or HAL_SPI_Abort() sets hspi4 back
+*  to the ready state. FIFO transfers access the registers directly
+*  and are started only while hspi4 is ready. They leave the peripheral
+*  in the state the HAL expects: disabled, with the CFG1 value of
+*  MX_SPI4_Init() and the EOT and TXTF flags cleared. This is true
+*  also after a timeout. No other code may access SPI4 or hspi4.
+*/
+#ifndef   SPI_BASE_ADDR
+  #define SPI_BASE_ADDR                 0x40013400uL                // SPI4
+  #define SPI_CR1                       (*(volatile U32 *)(SPI_BASE_ADDR + 0x00))
+  #define SPI_CR2                       (*(volatile U32 *)(SPI_BASE_ADDR + 0x04))
+  #define SPI_CFG1                      (*(volatile U32 *)(SPI_BASE_ADDR + 0x08))
+  #define SPI_SR                        (*(volatile U32 *)(SPI_BASE_ADDR + 0x14))
+  #define SPI_IFCR                      (*(volatile U32 *)(SPI_BASE_ADDR + 0x18))
+  #define SPI_TXDR                      (*(volatile U32 *)(SPI_BASE_ADDR + 0x20))
+  #define SPI_TXDR_8                    (*(volatile U8  *)(SPI_BASE_ADDR + 0x20))
+  #define SPI_RXDR                      (*(volatile U32 *)(SPI_BASE_ADDR + 0x30))
+  #define SPI_RXDR_8                    (*(volatile U8  *)(SPI_BASE_ADDR + 0x30))
+#endif
+
+/*********************************************************************
+*
+*       SPI register bits
+*/
+#define CR1_SPE_BIT                     0
+#define CR1_CSTART_BIT                  9
+#define CR2_TSIZE_MASK                  0xFFFFuL
+#define CFG1_FTHLV_BIT                  5
+#define CFG1_FTHLV_MASK                 0xFuL
+#define SR_RXP_BIT                      0
+#define SR_TXP_BIT                      1
+#define SR_EOT_BIT                      3
+#define SR_RXPLVL_BIT                   13
+#define SR_RXPLVL_MASK                  0x3uL
+#define IFCR_EOTC_BIT                   3
+#define IFCR_TXTFC_BIT                  4
+
 /*********************************************************************
 *
 *       Misc. defines
 */
 #define WAIT_TIMEOUT_MS                 1000                        // how much time to wait before timing out
+#define WAIT_TIMEOUT_LOOPS              (WAIT_TIMEOUT_MS * FS_NOR_HW_CYCLES_PER_1MS)  // Number of status register reads without progress before a FIFO transfer is aborted.
+#define CACHE_LINE_SIZE                 32u                         // Size of a data cache line of Cortex-M7 in bytes.
+#define PACKET_SIZE                     4u                          // Number of bytes transferred via one access to the data registers.
+#define MAX_NUM_BYTES_PIO               0xFFFCu                     // Maximum number of bytes in one transfer via FIFO (TSIZE limit rounded down to PACKET_SIZE).
+#define MAX_NUM_BYTES_DMA               0xFFE0u                     // Maximum number of bytes in one transfer via DMA (TSIZE limit rounded down to CACHE_LINE_SIZE).
+#define DTCM_START_ADDR                 0x20000000uL                // DTCM is not accessible by the DMA controller.
+#define DTCM_END_ADDR                   0x20020000uL
+#define ITCM_END_ADDR                   0x00010000uL                // ITCM is not accessible by the DMA controller.
+#define FILL_BYTE                       0xFFu                       // Value sent while receiving data.
+
+/*********************************************************************
+*
+*       Configuration checks
+*/
+#if ((FS_NOR_HW_BOUNCE_BUFFER_SIZE % 32) != 0) || (FS_NOR_HW_BOUNCE_BUFFER_SIZE == 0)
+  #error FS_NOR_HW_BOUNCE_BUFFER_SIZE has to be a non-zero multiple of the cache line size.
+#endif
+
+/*********************************************************************
+*
+*       IF_STATS
+*/
+#if FS_NOR_HW_ENABLE_STATS
+  #define IF_STATS(Exp)                 Exp
+#else
+  #define IF_STATS(Exp)
+#endif
 
 /*********************************************************************
 *
@@ -78,6 +175,12 @@ Purpose : Low-level flash driver for STM32H7 SPI interface.
 */
 static U8   _IsInited = 0;
 static U32  _Freq_Hz  = 0;
+#if FS_NOR_HW_USE_DMA
+static __ALIGNED(32) U32 _aBounceBuffer[FS_NOR_HW_BOUNCE_BUFFER_SIZE / 4];      // Aligned to cache line. Has to be located in a RAM accessible by DMA.
+#endif
+#if FS_NOR_HW_ENABLE_STATS
+  static FS_NOR_HW_SPI_STM32H735_STAT_COUNTERS _StatCounters;
+#endif
 
 /*********************************************************************
 *
@@ -86,6 +189,387 @@ static U32  _Freq_Hz  = 0;
 **********************************************************************
 */
 
+/*********************************************************************
+*
+*       _TransferPIO
+*
+*  Function description
+*    Exchanges data with the NOR flash device via the SPI FIFO.
+*
+*  Parameters
+*    pDataWr    Data to be sent. If NULL, FILL_BYTE is sent.
+*    pDataRd    Received data. If NULL, the received data is discarded.
+*    NumBytes   Number of bytes to be transferred (at most MAX_NUM_BYTES_PIO).
+*
+*  Return value
+*    ==0    OK, data transferred.
+*    !=0    Timeout occurred. The transfer has been aborted.
+*
+*  Additional information
+*    The FIFO threshold is set to PACKET_SIZE during the transfer so that
+*    four bytes can be written to or read from the data registers with one
+*    32-bit access. This reduces the number of register accesses to one
+*    fourth compared to transfers byte by byte. The number of bytes sent
+*    in advance is limited to the FIFO size so that the receive FIFO
+*    cannot overflow even if the transfer is interrupted. In master mode
+*    the SPI peripheral generates the clock signal itself so the transfer
+*    stops only if the peripheral is reconfigured or faulty. The timeout
+*    is restarted each time data is moved so that it does not depend
+*    on the number of bytes.
+*/
+static int _TransferPIO(const U8 * pDataWr, U8 * pDataRd, U32 NumBytes) {
+  U32 NumBytesWr;
+  U32 NumBytesRd;
+  U32 Status;
+  U32 Data32;
+  U32 Cfg;
+  U32 TimeOut;
+  U8  Data8;
+  int r;
+
+  r          = 0;
+  TimeOut    = WAIT_TIMEOUT_LOOPS;
+  NumBytesWr = NumBytes;
+  NumBytesRd = NumBytes;
+  //
+  // Set the FIFO threshold to 4 bytes. The configuration register
+  // can be modified only when the SPI peripheral is disabled.
+  //
+  Cfg       = SPI_CFG1;
+  SPI_CR1  &= ~(1uL << CR1_SPE_BIT);
+  SPI_CFG1  = (Cfg & ~(CFG1_FTHLV_MASK << CFG1_FTHLV_BIT)) | ((PACKET_SIZE - 1u) << CFG1_FTHLV_BIT);
+  SPI_CR2   = (SPI_CR2 & ~CR2_TSIZE_MASK) | NumBytes;
+  SPI_CR1  |= 1uL << CR1_SPE_BIT;
+  SPI_CR1  |= 1uL << CR1_CSTART_BIT;
+  while (NumBytesRd != 0u) {
+    Status = SPI_SR;
+    //
+    // Fill the transmit FIFO.
+    //
+    if ((NumBytesWr != 0u) && ((NumBytesRd - NumBytesWr) <= (FS_NOR_HW_FIFO_SIZE - PACKET_SIZE))) {
+      if ((Status & (1uL << SR_TXP_BIT)) != 0u) {
+        if (NumBytesWr >= PACKET_SIZE) {
+          if (pDataWr != NULL) {
+            Data32   = (U32)pDataWr[0]
+                     | ((U32)pDataWr[1] << 8)
+                     | ((U32)pDataWr[2] << 16)
+                     | ((U32)pDataWr[3] << 24);           // The least significant byte is sent first.
+            pDataWr += PACKET_SIZE;
+          } else {
+            Data32   = 0xFFFFFFFFuL;
+          }
+          SPI_TXDR    = Data32;
+          NumBytesWr -= PACKET_SIZE;
+          TimeOut     = WAIT_TIMEOUT_LOOPS;
+        } else {
+          do {
+            Data8 = FILL_BYTE;
+            if (pDataWr != NULL) {
+              Data8 = *pDataWr++;
+            }
+            SPI_TXDR_8 = Data8;
+          } while (--NumBytesWr != 0u);
+          TimeOut = WAIT_TIMEOUT_LOOPS;
+        }
+      }
+    }
+    //
+    // Empty the receive FIFO. RXP is set only when a complete
+    // packet is available. The last bytes of the transfer
+    // are read one by one as indicated by RXPLVL.
+    //
+    if (NumBytesRd >= PACKET_SIZE) {
+      if ((Status & (1uL << SR_RXP_BIT)) != 0u) {
+        Data32 = SPI_RXDR;
+        if (pDataRd != NULL) {
+          *pDataRd++ = (U8)Data32;
+          *pDataRd++ = (U8)(Data32 >> 8);
+          *pDataRd++ = (U8)(Data32 >> 16);
+          *pDataRd++ = (U8)(Data32 >> 24);
+        }
+        NumBytesRd -= PACKET_SIZE;
+        TimeOut     = WAIT_TIMEOUT_LOOPS;
+      }
+    } else {
+      if (((Status >> SR_RXPLVL_BIT) & SR_RXPLVL_MASK) != 0u) {
+        Data8 = SPI_RXDR_8;
+        if (pDataRd != NULL) {
+          *pDataRd++ = Data8;
+        }
+        NumBytesRd--;
+        TimeOut = WAIT_TIMEOUT_LOOPS;
+      }
+    }
+    if (--TimeOut == 0u) {
+      r = 1;                          // Error, the peripheral does not shift any data.
+      break;
+    }
+  }
+  //
+  // Wait for the end of transfer.
+  //
+  if (r == 0) {
+    TimeOut = WAIT_TIMEOUT_LOOPS;
+    while ((SPI_SR & (1uL << SR_EOT_BIT)) == 0u) {
+      if (--TimeOut == 0u) {
+        r = 1;                        // Error, the end of transfer is not signaled.
+        break;
+      }
+    }
+  }
+  //
+  // Restore the configuration. Disabling the peripheral also
+  // aborts the transfer and flushes the FIFOs after a timeout.
+  //
+  SPI_IFCR  = (1uL << IFCR_EOTC_BIT) | (1uL << IFCR_TXTFC_BIT);
+  SPI_CR1  &= ~(1uL << CR1_SPE_BIT);
+  SPI_CFG1  = Cfg;
+  if (r != 0) {
+    IF_STATS(_StatCounters.PIOTimeoutCnt++);
+  } else {
+    IF_STATS(_StatCounters.NumBytesPIO += NumBytes);
+  }
+  return r;
+}
+
+/*********************************************************************
+*
+*       _ReadPIO
+*
+*  Return value
+*    ==0    OK, data received.
+*    !=0    An error occurred.
+*/
+static int _ReadPIO(U8 * pData, U32 NumBytes) {
+  U32 NumBytesAtOnce;
+  int r;
+
+  r = 0;
+  while (NumBytes != 0u) {
+    NumBytesAtOnce = SEGGER_MIN(NumBytes, MAX_NUM_BYTES_PIO);
+    r = _TransferPIO(NULL, pData, NumBytesAtOnce);
+    if (r != 0) {
+      break;
+    }
+    pData    += NumBytesAtOnce;
+    NumBytes -= NumBytesAtOnce;
+  }
+  return r;
+}
+
+/*********************************************************************
+*
+*       _WritePIO
+*
+*  Return value
+*    ==0    OK, data sent.
+*    !=0    An error occurred.
+*/
+static int _WritePIO(const U8 * pData, U32 NumBytes) {
+  U32 NumBytesAtOnce;
+  int r;
+
+  r = 0;
+  while (NumBytes != 0u) {
+    NumBytesAtOnce = SEGGER_MIN(NumBytes, MAX_NUM_BYTES_PIO);
+    r = _TransferPIO(pData, NULL, NumBytesAtOnce);
+    if (r != 0) {
+      break;
+    }
+    pData    += NumBytesAtOnce;
+    NumBytes -= NumBytesAtOnce;
+  }
+  return r;
+}
+
+#if FS_NOR_HW_USE_DMA
+
+/*********************************************************************
+*
+*       _IsDMACapable
+*
+*  Function description
+*    Checks if the DMA controller is able to access a memory region.
+*
+*  Return value
+*    !=0    The memory region can be accessed via DMA.
+*    ==0    The memory region is located in TCM.
+*/
+static int _IsDMACapable(const void * pData, U32 NumBytes) {
+  U32 AddrStart;
+  U32 AddrEnd;
+
+  AddrStart = SEGGER_PTR2ADDR(pData);
+  AddrEnd   = AddrStart + NumBytes;
+  if (AddrStart < ITCM_END_ADDR) {
+    return 0;
+  }
+  if ((AddrEnd > DTCM_START_ADDR) && (AddrStart < DTCM_END_ADDR)) {
+    return 0;
+  }
+  return 1;
+}
+
+/*********************************************************************
+*
+*       _WaitForDMA
+*
+*  Function description
+*    Waits for the completion of a DMA transfer.
+*
+*  Return value
+*    ==0    OK, transfer completed.
+*    !=0    Timeout occurred. The transfer has been aborted.
+*/
+static int _WaitForDMA(void) {
+  int r;
+
+  r = FS_X_OS_Wait(WAIT_TIMEOUT_MS);
+  if (r != 0) {
+    (void)HAL_SPI_Abort(&hspi4);
+    IF_STATS(_StatCounters.DMATimeoutCnt++);
+  }
+  return r;
+}
+
+/*********************************************************************
+*
+*       _ReadDMA
+*
+*  Function description
+*    Reads data via DMA directly to the specified buffer.
+*
+*  Return value
+*    ==0    OK, data received.
+*    !=0    Timeout occurred. The transfer has been aborted.
+*
+*  Additional information
+*    pData has to be aligned to and NumBytes has to be a multiple of
+*    the cache line size so that the cache invalidation does not discard
+*    data of neighboring variables. The bounce buffer is an exception
+*    because it is not shared with other variables.
+*/
+static int _ReadDMA(U8 * pData, U32 NumBytes) {
+  U32 NumBytesAtOnce;
+  int r;
+
+  r = 0;
+  while (NumBytes != 0u) {
+    NumBytesAtOnce = SEGGER_MIN(NumBytes, MAX_NUM_BYTES_DMA);
+    SCB_InvalidateDCache_by_Addr(SEGGER_PTR2PTR(uint32_t, pData), (int32_t)NumBytesAtOnce);
+    (void)HAL_SPI_Receive_DMA(&hspi4, pData, (U16)NumBytesAtOnce);
+    r = _WaitForDMA();
+    if (r != 0) {
+      break;
+    }
+    //
+    // Discard the lines speculatively loaded to cache during the transfer.
+    //
+    SCB_InvalidateDCache_by_Addr(SEGGER_PTR2PTR(uint32_t, pData), (int32_t)NumBytesAtOnce);
+    IF_STATS(_StatCounters.NumBytesDMA += NumBytesAtOnce);
+    pData    += NumBytesAtOnce;
+    NumBytes -= NumBytesAtOnce;
+  }
+  return r;
+}
+
+/*********************************************************************
+*
+*       _WriteDMA
+*
+*  Function description
+*    Writes data via DMA directly from the specified buffer.
+*
+*  Return value
+*    ==0    OK, data sent.
+*    !=0    Timeout occurred. The transfer has been aborted.
+*/
+static int _WriteDMA(const U8 * pData, U32 NumBytes) {
+  U32 NumBytesAtOnce;
+  int r;
+
+  r = 0;
+  while (NumBytes != 0u) {
+    NumBytesAtOnce = SEGGER_MIN(NumBytes, MAX_NUM_BYTES_DMA);
+    SCB_CleanDCache_by_Addr(SEGGER_PTR2PTR(uint32_t, pData), (int32_t)NumBytesAtOnce);
+    (void)HAL_SPI_Transmit_DMA(&hspi4, pData, (U16)NumBytesAtOnce);
+    r = _WaitForDMA();
+    if (r != 0) {
+      break;
+    }
+    IF_STATS(_StatCounters.NumBytesDMA += NumBytesAtOnce);
+    pData    += NumBytesAtOnce;
+    NumBytes -= NumBytesAtOnce;
+  }
+  return r;
+}
+
+/*********************************************************************
+*
+*       _ReadBounce
+*
+*  Function description
+*    Reads data via DMA using the bounce buffer.
+*
+*  Return value
+*    ==0    OK, data received.
+*    !=0    An error occurred.
+*/
+static int _ReadBounce(U8 * pData, U32 NumBytes) {
+  U32 NumBytesAtOnce;
+  U8 * pBuffer;
+  int r;
+
+  r       = 0;
+  pBuffer = SEGGER_PTR2PTR(U8, _aBounceBuffer);
+  while (NumBytes != 0u) {
+    NumBytesAtOnce = SEGGER_MIN(NumBytes, sizeof(_aBounceBuffer));
+    r = _ReadDMA(pBuffer, NumBytesAtOnce);     // The bounce buffer is aligned and its size is a multiple of the cache line.
+    if (r != 0) {
+      break;
+    }
+    FS_MEMCPY(pData, pBuffer, NumBytesAtOnce);
+    IF_STATS(_StatCounters.NumBytesBounce += NumBytesAtOnce);
+    pData    += NumBytesAtOnce;
+    NumBytes -= NumBytesAtOnce;
+  }
+  return r;
+}
+
+/*********************************************************************
+*
+*       _WriteBounce
+*
+*  Function description
+*    Writes data via DMA using the bounce buffer.
+*
+*  Return value
+*    ==0    OK, data sent.
+*    !=0    An error occurred.
+*/
+static int _WriteBounce(const U8 * pData, U32 NumBytes) {
+  U32 NumBytesAtOnce;
+  U8 * pBuffer;
+  int r;
+
+  r       = 0;
+  pBuffer = SEGGER_PTR2PTR(U8, _aBounceBuffer);
+  while (NumBytes != 0u) {
+    NumBytesAtOnce = SEGGER_MIN(NumBytes, sizeof(_aBounceBuffer));
+    FS_MEMCPY(pBuffer, pData, NumBytesAtOnce);
+    r = _WriteDMA(pBuffer, NumBytesAtOnce);
+    if (r != 0) {
+      break;
+    }
+    IF_STATS(_StatCounters.NumBytesBounce += NumBytesAtOnce);
+    pData    += NumBytesAtOnce;
+    NumBytes -= NumBytesAtOnce;
+  }
+  return r;
+}
+
+#endif // FS_NOR_HW_USE_DMA
+
 /*********************************************************************
 *
 *       _HW_Init
@@ -143,7 +627,7 @@ static void _HW_DisableCS(U8 Unit) {
 
 /*********************************************************************
 *
-*       _HW_Read
+*       _HW_ReadEx
 *
 *  Function description
 *    Reads a specified number of bytes from NOR flash to buffer.
@@ -152,23 +636,65 @@ static void _HW_DisableCS(U8 Unit) {
 *    Unit       Device index
 *    pData      Pointer to a data buffer
 *    NumBytes   Number of bytes to be read
+*    BusWidth   Number of data lines. Only 1 is supported.
+*
+*  Return value
+*    ==0    OK, data read.
+*    !=0    An error occurred. The contents of pData is undefined.
+*
+*  Additional information
+*    Short transfers such as status register reads are performed
+*    via the FIFO. Long transfers are split so that the part of the
+*    buffer that is aligned to cache lines is read directly via DMA
+*    and the unaligned head and tail are read via the FIFO. Buffers
+*    located in TCM are read via DMA to the bounce buffer.
 */
-static void _HW_Read(U8 Unit, U8 * pData, int NumBytes) {
+static int _HW_ReadEx(U8 Unit, U8 * pData, U32 NumBytes, U8 BusWidth) {
+  int r;
+#if FS_NOR_HW_USE_DMA
+  U32 NumBytesHead;
+  U32 NumBytesBody;
+  U32 NumBytesTail;
+#endif // FS_NOR_HW_USE_DMA
+
   FS_USE_PARA(Unit);
+  if (BusWidth != 1u) {
+    return 1;                   // Error, SPI4 has only one data line in each direction.
+  }
+  IF_STATS(_StatCounters.ReadCnt++);
 #if FS_NOR_HW_USE_DMA
-  HAL_SPI_Receive_DMA(&hspi4, pData, NumBytes);
-  FS_X_OS_Wait(WAIT_TIMEOUT_MS);
+  if (NumBytes < FS_NOR_HW_DMA_MIN_NUM_BYTES) {
+    r = _ReadPIO(pData, NumBytes);
+  } else {
+    if (_IsDMACapable(pData, NumBytes) == 0) {
+      r = _ReadBounce(pData, NumBytes);
+    } else {
+      r            = 0;
+      NumBytesHead = (CACHE_LINE_SIZE - (SEGGER_PTR2ADDR(pData) & (CACHE_LINE_SIZE - 1u))) & (CACHE_LINE_SIZE - 1u);
+      NumBytesBody = (NumBytes - NumBytesHead) & ~(CACHE_LINE_SIZE - 1u);
+      NumBytesTail = NumBytes - NumBytesHead - NumBytesBody;
+      if (NumBytesHead != 0u) {
+        r = _ReadPIO(pData, NumBytesHead);
+        pData += NumBytesHead;
+      }
+      if ((r == 0) && (NumBytesBody != 0u)) {
+        r = _ReadDMA(pData, NumBytesBody);
+        pData += NumBytesBody;
+      }
+      if ((r == 0) && (NumBytesTail != 0u)) {
+        r = _ReadPIO(pData, NumBytesTail);
+      }
+    }
+  }
 #else
-  do {
-    HAL_SPI_Receive(&hspi4, pData, 1, WAIT_TIMEOUT_MS);
-    *pData++;
-  } while (--NumBytes);
-#endif
+  r = _ReadPIO(pData, NumBytes);
+#endif // FS_NOR_HW_USE_DMA
+  return r;
 }
 
 /*********************************************************************
 *
-*       _HW_Write
+*       _HW_WriteEx
 *
 *  Function description
 *    Writes a specified number of bytes from data buffer to NOR flash.
@@ -177,18 +703,70 @@ static void _HW_Read(U8 Unit, U8 * pData, int NumBytes) {
 *    Unit       Device index
 *    pData      Pointer to a data buffer
 *    NumBytes   Number of bytes to be written
+*    BusWidth   Number of data lines. Only 1 is supported.
+*
+*  Return value
+*    ==0    OK, data written.
+*    !=0    An error occurred.
+*
+*  Additional information
+*    Short transfers such as command and address bytes are performed
+*    via the FIFO. Long transfers are performed via DMA. Cleaning the
+*    cache does not require an alignment so the data is sent directly
+*    from the specified buffer unless it is located in TCM.
 */
-static void _HW_Write(U8 Unit, const U8 * pData, int NumBytes) {  
+static int _HW_WriteEx(U8 Unit, const U8 * pData, U32 NumBytes, U8 BusWidth) {
+  int r;
+
   FS_USE_PARA(Unit);
+  if (BusWidth != 1u) {
+    return 1;                   // Error, SPI4 has only one data line in each direction.
+  }
+  IF_STATS(_StatCounters.WriteCnt++);
 #if FS_NOR_HW_USE_DMA
-  HAL_SPI_Transmit_DMA(&hspi4, pData, NumBytes);
-  FS_X_OS_Wait(WAIT_TIMEOUT_MS);
+  if (NumBytes < FS_NOR_HW_DMA_MIN_NUM_BYTES) {
+    r = _WritePIO(pData, NumBytes);
+  } else {
+    if (_IsDMACapable(pData, NumBytes) == 0) {
+      r = _WriteBounce(pData, NumBytes);
+    } else {
+      r = _WriteDMA(pData, NumBytes);
+    }
+  }
 #else
-  do {
-    HAL_SPI_Transmit(&hspi4, pData, 1, WAIT_TIMEOUT_MS);
-    *pData++;
-  } while (--NumBytes);
-#endif
+  r = _WritePIO(pData, NumBytes);
+#endif // FS_NOR_HW_USE_DMA
+  return r;
+}
+
+/*********************************************************************
+*
+*       _HW_Read
+*
+*  Function description
+*    Reads a specified number of bytes from NOR flash to buffer.
+*
+*  Additional information
+*    Provided for the physical layers that do not call _HW_ReadEx().
+*    These cannot be informed about an error. The SFDP physical layer
+*    calls _HW_ReadEx() and passes the error up to the driver.
+*/
+static void _HW_Read(U8 Unit, U8 * pData, int NumBytes) {
+  (void)_HW_ReadEx(Unit, pData, (U32)NumBytes, 1);
+}
+
+/*********************************************************************
+*
+*       _HW_Write
+*
+*  Function description
+*    Writes a specified number of bytes from data buffer to NOR flash.
+*
+*  Additional information
+*    Provided for the physical layers that do not call _HW_WriteEx().
+*/
+static void _HW_Write(U8 Unit, const U8 * pData, int NumBytes) {
+  (void)_HW_WriteEx(Unit, pData, (U32)NumBytes, 1);
 }
 
 /*********************************************************************
@@ -256,15 +834,41 @@ void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi) {
 }
 
 
+#if FS_NOR_HW_ENABLE_STATS
+
 /*********************************************************************
 *
-*       HAL_SPI_RxCpltCallback
+*       FS_NOR_HW_SPI_STM32H735_Morpheus_GetStatCounters
+*
+*  Function description
+*    Returns the values of the statistical counters.
+*
+*  Parameters
+*    pStat    [OUT] Values of the statistical counters.
+*
+*  Additional information
+*    The counters can be used together with the time measured by the
+*    application to calculate the throughput of the SPI interface and
+*    to check how much of the data is transferred via DMA.
 */
+void FS_NOR_HW_SPI_STM32H735_Morpheus_GetStatCounters(FS_NOR_HW_SPI_STM32H735_STAT_COUNTERS * pStat) {
+  if (pStat != NULL) {
+    *pStat = _StatCounters;
+  }
+}
 
 /*********************************************************************
 *
-*       HAL_SPI_TxCpltCallback
+*       FS_NOR_HW_SPI_STM32H735_Morpheus_ResetStatCounters
+*
+*  Function description
+*    Sets all the statistical counters to 0.
 */
+void FS_NOR_HW_SPI_STM32H735_Morpheus_ResetStatCounters(void) {
+  FS_MEMSET(&_StatCounters, 0, sizeof(_StatCounters));
+}
+
+#endif // FS_NOR_HW_ENABLE_STATS
 
 /*********************************************************************
 *
@@ -285,8 +889,8 @@ const FS_NOR_HW_TYPE_SPI FS_NOR_HW_SPI_STM32H735_Morpheus = {
   _HW_Delay,
   NULL,
   NULL,
-  NULL,
-  NULL
+  _HW_ReadEx,
+  _HW_WriteEx
 };
 
 /*************************** End of file ****************************/
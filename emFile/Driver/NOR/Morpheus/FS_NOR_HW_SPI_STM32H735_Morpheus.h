@@ -26,6 +26,23 @@ Purpose : Low-level flash driver for STM32H7 SPI interface.
 
 #include "FS.h"
 
+/*********************************************************************
+*
+*       FS_NOR_HW_SPI_STM32H735_STAT_COUNTERS
+*
+*  Description
+*    Statistical counters of the SPI hardware layer.
+*/
+typedef struct {
+  U32 ReadCnt;            // Number of read requests.
+  U32 WriteCnt;           // Number of write requests.
+  U32 NumBytesPIO;        // Number of bytes transferred via the SPI FIFO.
+  U32 NumBytesDMA;        // Number of bytes transferred via DMA.
+  U32 NumBytesBounce;     // Number of bytes copied via the bounce buffer.
+  U32 DMATimeoutCnt;      // Number of DMA transfers aborted because of a timeout.
+  U32 PIOTimeoutCnt;      // Number of FIFO transfers aborted because of a timeout.
+} FS_NOR_HW_SPI_STM32H735_STAT_COUNTERS;
+
 /*********************************************************************
 *
 *       Public data
@@ -34,6 +51,18 @@ Purpose : Low-level flash driver for STM32H7 SPI interface.
 */
 extern const FS_NOR_HW_TYPE_SPI FS_NOR_HW_SPI_STM32H735_Morpheus;
 
+/*********************************************************************
+*
+*       API functions
+*
+*  Additional information
+*    Available only if FS_NOR_HW_ENABLE_STATS is set to 1.
+*
+**********************************************************************
+*/
+void FS_NOR_HW_SPI_STM32H735_Morpheus_GetStatCounters  (FS_NOR_HW_SPI_STM32H735_STAT_COUNTERS * pStat);
+void FS_NOR_HW_SPI_STM32H735_Morpheus_ResetStatCounters(void);
+
 #endif  // FS_NOR_HW_SPI_STM32H735_MORPHEUS_H
 
 /*************************** End of file ****************************/
@@ -253,6 +253,8 @@ extern "C" {     // Make sure we have C-declarations in C++ programs
 *    +--------------------------------+--------------------------------------------------------------------------------------------------------+
 *    | FS_CMD_SYNC_SECTORS            | ==0 - OK, operation succeeded, < 0 - An error occurred.                                                |
 *    +--------------------------------+--------------------------------------------------------------------------------------------------------+
+*    | FS_CMD_REQUIRES_ZERO_FILL      | ==1 - fill with 0 required, ==0 - freed sectors read back as 0, < 0 - An error occurred.               |
+*    +--------------------------------+--------------------------------------------------------------------------------------------------------+
 */
 #define FS_CMD_REQUIRES_FORMAT                        1003            // Checks if the storage device is low-level formatted.
 #define FS_CMD_GET_DEVINFO                            1004            // Returns information about the storage device.
@@ -271,6 +273,7 @@ extern "C" {     // Make sure we have C-declarations in C++ programs
 #define FS_CMD_GET_CLEAN_CNT                          1017            // Returns the number of operations required to completely clean the storage device.
 #define FS_CMD_SET_READ_ERROR_CALLBACK                1018            // Registers a handler for sector read errors.
 #define FS_CMD_SYNC_SECTORS                           1019            // Informs the driver about the sectors that must be synchronized.
+#define FS_CMD_REQUIRES_ZERO_FILL                     1020            // Checks if logical sectors freed via FS_CMD_FREE_SECTORS have to be filled with 0.
 
 /*********************************************************************
 *
@@ -377,6 +380,20 @@ extern "C" {     // Make sure we have C-declarations in C++ programs
 #define FS_CHECKDISK_RETVAL_CONTINUE                  4         // FS_CheckAT() returns this value to indicate that the allocation table has not been entirely checked.
 #define FS_CHECKDISK_RETVAL_SKIP                      5         // FS_CheckDir() returns this value to indicate that the directory entry does not have to be checked.
 
+/*********************************************************************
+*
+*       Disk checking phases
+*
+*  Description
+*    Processing steps of an incremental disk checking operation.
+*
+*  Additional information
+*    These values are returned via the Phase member of FS_CHECKDISK_PROGRESS.
+*/
+#define FS_CHECKDISK_PHASE_DIR                        0         // The directory tree is checked and the cluster map is filled.
+#define FS_CHECKDISK_PHASE_AT                         1         // The allocation table is compared against the cluster map.
+#define FS_CHECKDISK_PHASE_DONE                       2         // The entire volume has been checked.
+
 /*********************************************************************
 *
 *       Disk checking action codes
@@ -1281,6 +1298,73 @@ typedef struct {
   FS_CLUSTER_MAP                   ClusterMap;    // Information about the cluster usage.
 } FS_CHECK_DATA;
 
+/*********************************************************************
+*
+*       FS_CHECKDISK_STEP_DATA
+*
+*  Description
+*    Context for the incremental disk checking operation.
+*
+*  Additional information
+*    All the information in this structure is internal and it should
+*    not be accessed or modified in any way by the application.
+*    The progress of the operation can be queried via
+*    FS_CheckDiskGetProgress().
+*/
+typedef struct {
+  FS_CHECK_DATA                    CheckData;                             // Internal. Do not use. Context of the non-blocking checking operation.
+  const char                     * sVolumeName;                           // Internal. Do not use. Name of the volume to be checked.
+  void                           * pBuffer;                               // Internal. Do not use. Storage for the cluster map.
+  U32                              BufferSize;                            // Internal. Do not use. Number of bytes in pBuffer.
+  FS_CHECKDISK_ON_ERROR_CALLBACK * pfOnError;                             // Internal. Do not use. Callback function to be invoked on error.
+  int                              MaxRecursionLevel;                     // Internal. Do not use. Deepest directory level to be checked.
+  int                              DirLevel;                              // Internal. Do not use. Nesting level of the directory stored in acPath.
+  U8                               Phase;                                 // Internal. Do not use. Current processing step (FS_CHECKDISK_PHASE_...)
+  U8                               IsDirChecked;                          // Internal. Do not use. Set to 1 if the directory stored in acPath has been checked.
+  U16                              NumPasses;                             // Internal. Do not use. Number of passes required to check all the clusters.
+  U16                              PassIndex;                             // Internal. Do not use. Index of the current pass.
+  U32                              ClusterOff;                            // Internal. Do not use. Index of the next cluster in the cluster map to be checked against the allocation table.
+  U32                              NumClustersTotal;                      // Internal. Do not use. Total number of clusters on the volume.
+  U32                              NumClustersChecked;                    // Internal. Do not use. Number of clusters checked against the allocation table.
+  U32                              NumDirsChecked;                        // Internal. Do not use. Number of directories checked in the current pass.
+  U32                              NumRestarts;                           // Internal. Do not use. Number of times the operation has been restarted.
+  U32                              TimeElapsed;                           // Internal. Do not use. Processing time in milliseconds.
+  U32                              TimeDirPass;                           // Internal. Do not use. Processing time of a complete directory pass in milliseconds (0 if not known yet).
+  U32                              TimeDirCurrent;                        // Internal. Do not use. Processing time of the current directory pass in milliseconds.
+  U32                              TimeAT;                                // Internal. Do not use. Processing time of the allocation table checking in milliseconds.
+  FS_DIR_POS                       aDirPos[FS_CHECKDISK_MAX_DIR_DEPTH];   // Internal. Do not use. Position of the next directory entry to be searched for a subdirectory on each directory level.
+  char                             acPath[FS_MAX_PATH];                   // Internal. Do not use. Path to the directory being checked.
+} FS_CHECKDISK_STEP_DATA;
+
+/*********************************************************************
+*
+*       FS_CHECKDISK_PROGRESS
+*
+*  Description
+*    Progress of an incremental disk checking operation.
+*
+*  Additional information
+*    TimeRemaining is set to 0xFFFFFFFF as long as the estimation is
+*    not possible. This is the case until the directory tree has been
+*    checked entirely at least once. The estimation is based on the
+*    processing time measured via FS_X_OS_GetTime() and it does not
+*    include the time the application spends between the calls to
+*    FS_CheckDiskStep().
+*/
+typedef struct {
+  U8  Phase;                        // Current processing step (FS_CHECKDISK_PHASE_...)
+  U8  Percent;                      // Estimated completion in percent.
+  U16 NumPasses;                    // Number of passes required to check all the clusters. Depends on the size of the cluster map.
+  U16 PassIndex;                    // Index of the current pass (0-based).
+  U32 NumClustersTotal;             // Total number of clusters on the volume.
+  U32 NumClustersChecked;           // Number of clusters checked against the allocation table.
+  U32 NumDirsChecked;               // Number of directories checked in the current pass.
+  U32 NumRestarts;                  // Number of times the operation has been restarted because the volume has been modified.
+  U32 TimeElapsed;                  // Processing time in milliseconds.
+  U32 TimeRemaining;                // Estimated processing time in milliseconds until completion.
+  U32 ClustersPerSecond;            // Number of clusters checked per second of processing time.
+} FS_CHECKDISK_PROGRESS;
+
 /*********************************************************************
 *
 *       FS_BIGFAT_INFO
@@ -1742,6 +1826,9 @@ int          FS_CheckAT               (FS_CHECK_DATA * pCheckData);
 const char * FS_CheckDisk_ErrCode2Text(int ErrCode);
 int          FS_CheckDir              (FS_CHECK_DATA * pCheckData, const char * sPath);
 int          FS_CheckDisk             (const char * sVolumeName, void * pBuffer, U32 BufferSize, int MaxRecursionLevel, FS_CHECKDISK_ON_ERROR_CALLBACK * pfOnError);
+void         FS_CheckDiskGetProgress  (const FS_CHECKDISK_STEP_DATA * pStepData, FS_CHECKDISK_PROGRESS * pProgress);
+int          FS_CheckDiskStart        (FS_CHECKDISK_STEP_DATA * pStepData, const char * sVolumeName, void * pBuffer, U32 BufferSize, int MaxRecursionLevel, FS_CHECKDISK_ON_ERROR_CALLBACK * pfOnError);
+int          FS_CheckDiskStep         (FS_CHECKDISK_STEP_DATA * pStepData, U32 TimeSlice);
 void         FS_FAT_AbortCheckDisk    (void);
 int          FS_InitCheck             (FS_CHECK_DATA * pCheckData, const char * sVolumeName, void * pBuffer, U32 BufferSize, FS_CHECKDISK_ON_ERROR_CALLBACK * pfOnError);
 
@@ -2606,6 +2693,41 @@ typedef int FS_NOR_PHY_TYPE_IS_SECTOR_BLANK(U8 Unit, unsigned int SectorIndex);
 */
 typedef int FS_NOR_PHY_TYPE_INIT(U8 Unit);
 
+/*********************************************************************
+*
+*       FS_NOR_PHY_TYPE_MAP_READ
+*
+*  Function description
+*    Returns a pointer to the contents of the NOR flash device in system memory.
+*
+*  Parameters
+*    Unit       Index of the physical layer instance (0-based)
+*    Off        Byte offset of the first byte to be accessed.
+*    NumBytes   Number of bytes to be accessed.
+*
+*  Return value
+*    !=NULL   Address of the byte at Off in system memory.
+*    ==NULL   The data cannot be accessed via system memory.
+*
+*  Additional information
+*    This function is a member of the NOR physical layer API.
+*    The implementation of this function is optional. A NOR physical
+*    layer that is able to access the NOR flash device via system memory
+*    (for example via the memory-mapped mode of a quad SPI controller)
+*    can implement this function to let the NOR driver access the data
+*    without copying it and without sending a read command for each
+*    access. The NOR driver uses FS_NOR_PHY_TYPE_READ_OFF if
+*    FS_NOR_PHY_TYPE_MAP_READ is not implemented or returns NULL.
+*
+*    The returned pointer is valid only until the next call to
+*    FS_NOR_PHY_TYPE_WRITE_OFF or FS_NOR_PHY_TYPE_ERASE_SECTOR. The physical
+*    layer has to make sure that the data accessed via the returned pointer
+*    reflects the last write or erase operation. If the memory region
+*    is cached then the hardware layer has to invalidate the data cache
+*    when it switches back to memory-mapped mode.
+*/
+typedef const void * FS_NOR_PHY_TYPE_MAP_READ(U8 Unit, U32 Off, U32 NumBytes);
+
 /*********************************************************************
 *
 *       FS_NOR_PHY_TYPE
@@ -2624,6 +2746,7 @@ typedef struct {
   FS_NOR_PHY_TYPE_DE_INIT         * pfDeInit;           // Frees the resources allocated by the NOR physical layer instance.
   FS_NOR_PHY_TYPE_IS_SECTOR_BLANK * pfIsSectorBlank;    // Verifies if a NOR physical sector is blank.
   FS_NOR_PHY_TYPE_INIT            * pfInit;             // Initializes the instance of the NOR physical layer.
+  FS_NOR_PHY_TYPE_MAP_READ        * pfMapRead;          // Returns a pointer to the NOR flash contents in system memory.
 } FS_NOR_PHY_TYPE;
 
 /*********************************************************************
@@ -4225,6 +4348,25 @@ typedef struct {
   U32 ReadSectorCnt;      // Number of logical sectors written.
   U32 ReadErrorCnt;       // Number of read errors.
   U32 CmdExecCnt;         // Number of commands executed.
+  U32 ReadCmdCnt;         // Number of read commands (CMD17 and CMD18) executed.
+  U32 ReadCmdTime;        // Total time in microseconds spent executing read commands including the data transfer.
+  U32 ReadCmdTimeMax;     // Maximum time in microseconds it took to execute a read command including the data transfer.
+  U32 WriteCmdCnt;        // Number of write commands (CMD24 and CMD25) executed.
+  U32 WriteCmdTime;       // Total time in microseconds spent executing write commands including the data transfer.
+  U32 WriteCmdTimeMax;    // Maximum time in microseconds it took to execute a write command including the data transfer.
+  U32 StopCmdCnt;         // Number of STOP_TRANSMISSION (CMD12) commands executed.
+  U32 StopCmdTime;        // Total time in microseconds spent executing STOP_TRANSMISSION (CMD12) commands.
+  U32 StopCmdTimeMax;     // Maximum time in microseconds it took to execute a STOP_TRANSMISSION (CMD12) command.
+  U32 WaitReadyCnt;       // Number of times the card status was polled while waiting for the card to become ready.
+  U32 StreamOpenCnt;      // Number of streaming write operations started.
+  U32 StreamCloseCnt;     // Number of streaming write operations closed by the driver.
+  U32 StreamSectorCnt;    // Number of logical sectors written without waiting for the card to become ready.
+  U32 CmdQTaskCnt;        // Number of tasks queued via the eMMC command queue.
+  U32 CmdQDepthMax;       // Maximum number of tasks queued at the same time.
+  U32 CmdQStatusCnt;      // Number of times the Queue Status Register was read.
+  U32 CmdQDiscardCnt;     // Number of times the queued tasks were discarded because of an error.
+  U32 TrimCnt;            // Number of trim operations executed (erase operations on SD cards).
+  U32 TrimSectorCnt;      // Number of logical sectors reported as free via trim operations.
 } FS_MMC_STAT_COUNTERS;
 
 /*********************************************************************
@@ -5461,6 +5603,50 @@ typedef int FS_MMC_HW_TYPE_CM_START_TUNING(U8 Unit, unsigned TuningIndex);
 */
 typedef U16 FS_MMC_HW_TYPE_CM_GET_MAX_TUNINGS(U8 Unit);
 
+/*********************************************************************
+*
+*       FS_MMC_HW_TYPE_CM_CONTINUE_WRITE
+*
+*  Function description
+*    Sends a WRITE_MULTIPLE_BLOCK (CMD25) command and the data without
+*    waiting for the card to finish programming the previous data.
+*
+*  Parameters
+*    Unit         Index of the hardware layer instance (0-based)
+*    CmdFlags     Additional information about the command to be executed (FS_MMC_CMD_FLAG_...).
+*    Arg          Argument of the command (block or byte address of the first block).
+*    pBuffer      [IN] Data to be written to card.
+*    NumBytes     Number of bytes in a block to be written.
+*    NumBlocks    Number of blocks to be written.
+*
+*  Return value
+*    ==0     OK, command sent and data transferred successfully.
+*    !=0     An error occurred.
+*
+*  Additional information
+*    This function is a member of the Card Mode MMC/SD hardware layer.
+*    The implementation of this function is optional. It is required
+*    only if the application enables the streaming write mode via
+*    FS_MMC_CM_AllowStreamingWrite().
+*
+*    FS_MMC_HW_TYPE_CM_CONTINUE_WRITE is called by the Card Mode MMC/SD driver
+*    to write data that follows the data of the previous write operation.
+*    The card may still signal busy on the DAT0 line when the function
+*    is called. The hardware layer has to wait for the card to release
+*    the busy signal, send CMD25 with Arg as data transfer command
+*    and return after all the data blocks have been sent. The data path
+*    has to be started by the command because SD cards and MMC devices
+*    do not accept data that is not preceded by a command. CmdFlags
+*    contains the bus width and the data transfer flags and has the
+*    same meaning as for FS_MMC_HW_TYPE_CM_SEND_CMD. The driver ends
+*    the transfer via STOP_TRANSMISSION (CMD12) without waiting for
+*    the card to become ready. Card errors are reported in the response
+*    to CMD12.
+*
+*    Refer to \ref{Card mode error codes} for possible return values.
+*/
+typedef int FS_MMC_HW_TYPE_CM_CONTINUE_WRITE(U8 Unit, unsigned CmdFlags, U32 Arg, const void * pBuffer, unsigned NumBytes, unsigned NumBlocks);
+
 /*********************************************************************
 *
 *       FS_MMC_HW_TYPE_CM
@@ -5494,6 +5680,7 @@ typedef struct {
   FS_MMC_HW_TYPE_CM_DISABLE_TUNING             * pfDisableTuning;           // Disables the tuning procedure.
   FS_MMC_HW_TYPE_CM_START_TUNING               * pfStartTuning;             // Indicates the beginning of a tuning sequence.
   FS_MMC_HW_TYPE_CM_GET_MAX_TUNINGS            * pfGetMaxTunings;           // Returns the maximum number of tuning sequences.
+  FS_MMC_HW_TYPE_CM_CONTINUE_WRITE             * pfContinueWrite;           // Sends a write command and the data without waiting for the card to become ready.
 } FS_MMC_HW_TYPE_CM;
 
 /*********************************************************************
@@ -5529,6 +5716,12 @@ void FS_MMC_CM_AllowCacheActivation (U8 Unit, U8 OnOff);
 #endif // FS_MMC_SUPPORT_MMC
 void FS_MMC_CM_AllowHighSpeedMode   (U8 Unit, U8 OnOff);
 void FS_MMC_CM_AllowReliableWrite   (U8 Unit, U8 OnOff);
+#if FS_MMC_SUPPORT_STREAMING
+void FS_MMC_CM_AllowStreamingWrite  (U8 Unit, U8 OnOff);
+#endif // FS_MMC_SUPPORT_STREAMING
+#if FS_MMC_SUPPORT_CMDQ
+void FS_MMC_CM_AllowCommandQueue    (U8 Unit, U8 OnOff);
+#endif // FS_MMC_SUPPORT_CMDQ
 #if (FS_MMC_SUPPORT_UHS != 0) && (FS_MMC_SUPPORT_SD != 0)
 void FS_MMC_CM_AllowAccessModeDDR50 (U8 Unit, U8 OnOff);
 #endif // FS_MMC_SUPPORT_UHS != 0 && FS_MMC_SUPPORT_SD != 0
@@ -163,6 +163,14 @@ Purpose : File system configuration defaults
   #define FS_MAX_PATH                             260   // Maximum number of characters in a path to a file including the 0-terminator.
 #endif
 
+#ifndef   FS_CHECKDISK_MAX_DIR_DEPTH
+  #define FS_CHECKDISK_MAX_DIR_DEPTH              16    // Maximum number of directory levels FS_CheckDiskStep() is able to descend.
+#endif
+
+#ifndef   FS_CHECKDISK_NUM_CLUSTERS_AT_ONCE
+  #define FS_CHECKDISK_NUM_CLUSTERS_AT_ONCE       4096  // Number of clusters FS_CheckDiskStep() checks against the allocation table in one locked operation. Has to be a multiple of 8.
+#endif
+
 #ifndef   FS_SUPPORT_FAT
   #define FS_SUPPORT_FAT                          1     // Support the FAT file system if enabled
 #endif
@@ -533,6 +541,18 @@ Purpose : File system configuration defaults
   #endif
 #endif
 
+#ifndef   FS_FAT_FREE_SECTOR_NUM_RANGES
+  #define FS_FAT_FREE_SECTOR_NUM_RANGES           0     // Number of ranges of freed clusters collected before the storage layer is informed. 0 means that the storage layer is informed immediately.
+#endif
+
+#ifndef   FS_FAT_FREE_SECTOR_THRESHOLD
+  #define FS_FAT_FREE_SECTOR_THRESHOLD            0     // Number of collected free sectors that causes the storage layer to be informed. 0 means only when all ranges are in use or when the volume is synchronized.
+#endif
+
+#ifndef   FS_FAT_SUPPORT_FREE_SECTOR_BATCH
+  #define FS_FAT_SUPPORT_FREE_SECTOR_BATCH        ((FS_SUPPORT_FREE_SECTOR != 0) && (FS_FAT_FREE_SECTOR_NUM_RANGES > 0))
+#endif
+
 #ifndef   FS_FAT_LFN_MAX_SHORT_NAME
   #define FS_FAT_LFN_MAX_SHORT_NAME               1000  // Limit for the index of a short file name. The maximum index value of a short file name is FS_FAT_LFN_MAX_SHORT_NAME + FS_FAT_LFN_BIT_ARRAY_SIZE - 1.
 #endif
@@ -1323,6 +1343,14 @@ Purpose : File system configuration defaults
   #define FS_MMC_ENABLE_STATS                     (FS_DEBUG_LEVEL >= FS_DEBUG_LEVEL_CHECK_ALL)  // Enables / disables the statistical counters.
 #endif
 
+#ifndef   FS_MMC_GET_TIMESTAMP
+  #define FS_MMC_GET_TIMESTAMP()                  (FS_X_OS_GetTime() * 1000uL)  // Returns the value of a free-running 32-bit counter used for measuring the command latencies.
+#endif
+
+#ifndef   FS_MMC_TIMESTAMP_TICKS_PER_US
+  #define FS_MMC_TIMESTAMP_TICKS_PER_US           1uL     // Number of FS_MMC_GET_TIMESTAMP() ticks in one microsecond.
+#endif
+
 #ifndef   FS_MMC_NUM_RETRIES
   #define FS_MMC_NUM_RETRIES                      5       // Number of times to repeat a read or write operation in case of an error
 #endif
@@ -1344,7 +1372,27 @@ Purpose : File system configuration defaults
 #endif
 
 #ifndef   FS_MMC_SUPPORT_TRIM
-  #define FS_MMC_SUPPORT_TRIM                     0       // Enables/disables the support for the TRIM operation.
+  #define FS_MMC_SUPPORT_TRIM                     0       // Enables/disables the support for the TRIM operation (erase on SD cards).
+#endif
+
+#ifndef   FS_MMC_SUPPORT_STREAMING
+  #define FS_MMC_SUPPORT_STREAMING                0       // Enables/disables the support for write operations that remain open across consecutive write requests.
+#endif
+
+#ifndef   FS_MMC_STREAM_TIMEOUT
+  #define FS_MMC_STREAM_TIMEOUT                   100     // Number of milliseconds after which an idle streaming write operation is stopped. Evaluated lazily on the next access, FS_Sync() closes the stream at once.
+#endif
+
+#ifndef   FS_MMC_SUPPORT_CMDQ
+  #define FS_MMC_SUPPORT_CMDQ                     0       // Enables/disables the support for the command queue of eMMC devices.
+#endif
+
+#ifndef   FS_MMC_CMDQ_MAX_DEPTH
+  #define FS_MMC_CMDQ_MAX_DEPTH                   32      // Maximum number of tasks queued in an eMMC device at the same time (1-32).
+#endif
+
+#ifndef   FS_MMC_CMDQ_MIN_SECTORS
+  #define FS_MMC_CMDQ_MIN_SECTORS                 32      // Minimum number of sectors a request must contain to be transferred via the command queue.
 #endif
 
 
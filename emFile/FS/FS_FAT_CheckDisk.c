@@ -1564,6 +1564,17 @@ static int _CheckAT(FS_VOLUME * pVolume, U32 DirStart, const FS_CLUSTER_MAP * pC
   // Check the all the entries in the allocation table one by one.
   //
   for (i = 0; i < pClusterMap->NumClusters; i++) {
+    //
+    // Skip over the groups of 8 clusters that are all in use without
+    // reading the allocation table. On a well filled volume this avoids
+    // testing each bit of the cluster map separately.
+    //
+    while (((i & 7) == 0) && ((i + 8) <= pClusterMap->NumClusters) && (pClusterMap->pData[(U32)i >> 3] == 0xFFu)) {
+      i += 8;
+    }
+    if (i >= pClusterMap->NumClusters) {
+      break;
+    }
     if (_IsClusterFree(pClusterMap, (U32)i) != 0) {
       FATEntry = FS_FAT_ReadFATEntry(pVolume, pSB, (U32)i + pClusterMap->FirstClusterId);
       if (FATEntry != 0u) {
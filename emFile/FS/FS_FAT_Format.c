@@ -356,6 +356,7 @@ int FS_FAT_FormatVolume(FS_VOLUME * pVolume, const FS_DEV_INFO * pDevInfo, const
   U32            NumSectors;
   unsigned       SectorsPerCluster;
   U32            NumSectorsCalc;
+  int            IsZeroFillRequired;
 
   pPart                 = &pVolume->Partition;
   pDevice               = &pPart->Device;
@@ -371,6 +372,7 @@ int FS_FAT_FormatVolume(FS_VOLUME * pVolume, const FS_DEV_INFO * pDevInfo, const
   NumHeads              = pDevInfo->NumHeads;
   SectorsPerTrack       = pDevInfo->SectorsPerTrack;
   NumRootDirEntriesProp = NumRootDirEntries;
+  IsZeroFillRequired    = 1;
 #if FS_DEBUG_LEVEL >= FS_DEBUG_LEVEL_CHECK_PARA
   NumRootDirEntriesProp &= 0xFFF0u;           // Make sure it is a multiple of 16.
 #endif
@@ -488,14 +490,41 @@ int FS_FAT_FormatVolume(FS_VOLUME * pVolume, const FS_DEV_INFO * pDevInfo, const
     r = FS_ERRCODE_WRITE_FAILURE;       // Error, could not invalidate BPB.
     goto Done;
   }
+#if FS_SUPPORT_FREE_SECTOR
+  //
+  // Inform the driver layer that the previous contents of the allocation tables, root directory
+  // and data area is no longer required. The driver can erase the storage blocks that store
+  // this data instead of relocating it when the allocation tables and the root directory
+  // are filled with 0s below. The sectors are reported in one request so that a driver
+  // such as MMC_CM can handle them with a single erase or trim operation.
+  // If the freed sectors read back as 0, the allocation tables and the root directory
+  // do not have to be filled with 0s at all. This is not the case with an active journal
+  // because the journal defers the request until the next transaction is committed.
+  //
+  if (pVolume->FreeSector != 0u) {
+    r = FS_LB_FreeSectorsPart(pPart, NumSectorsReserved, NumSectors - NumSectorsReserved);
+    if (r == 0) {
+#if FS_SUPPORT_JOURNAL
+      if (pDevice->Data.JournalData.IsActive == 0u)
+#endif // FS_SUPPORT_JOURNAL
+      {
+        if (FS_LB_Ioctl(pDevice, FS_CMD_REQUIRES_ZERO_FILL, 0, NULL) == 0) {
+          IsZeroFillRequired = 0;
+        }
+      }
+    }
+  }
+#endif // FS_SUPPORT_FREE_SECTOR
   //
   // Initialize FAT 1 & 2. Start by filling all FAT sectors except the first one with 0.
   //
   FS_MEMSET(pBuffer, 0x00, BytesPerSector);
-  r = FS_LB_WriteMultiplePart(pPart, NumSectorsReserved, FAT_NUM_ALLOC_TABLES * NumSectorsAT, pBuffer, FS_SECTOR_TYPE_MAN, 1);
-  if (r != 0) {
-    r = FS_ERRCODE_WRITE_FAILURE;       // Error, could not initialize allocation table.
-    goto Done;
+  if (IsZeroFillRequired != 0) {
+    r = FS_LB_WriteMultiplePart(pPart, NumSectorsReserved, FAT_NUM_ALLOC_TABLES * NumSectorsAT, pBuffer, FS_SECTOR_TYPE_MAN, 1);
+    if (r != 0) {
+      r = FS_ERRCODE_WRITE_FAILURE;     // Error, could not initialize allocation table.
+      goto Done;
+    }
   }
   //
   // Initialize the first FAT sector.
@@ -523,29 +552,31 @@ int FS_FAT_FormatVolume(FS_VOLUME * pVolume, const FS_DEV_INFO * pDevInfo, const
   // Initialize root directory area.
   //
   FS_MEMSET(pBuffer, 0x00, BytesPerSector);
-  if (NumRootDirEntries != 0u) {
-    //
-    // FAT12/FAT16
-    //
-    r = FS_LB_WriteMultiplePart(pPart, NumSectorsReserved + FAT_NUM_ALLOC_TABLES * NumSectorsAT, NumSectorsRootDir, pBuffer, FS_SECTOR_TYPE_DIR, 1);
-    if (r != 0) {
-      r = FS_ERRCODE_WRITE_FAILURE;     // Error, could not initialize root directory.
-      goto Done;
+  if (IsZeroFillRequired != 0) {        // The root directory reads back as 0 if it was freed above.
+    if (NumRootDirEntries != 0u) {
+      //
+      // FAT12/FAT16
+      //
+      r = FS_LB_WriteMultiplePart(pPart, NumSectorsReserved + FAT_NUM_ALLOC_TABLES * NumSectorsAT, NumSectorsRootDir, pBuffer, FS_SECTOR_TYPE_DIR, 1);
+      if (r != 0) {
+        r = FS_ERRCODE_WRITE_FAILURE;   // Error, could not initialize root directory.
+        goto Done;
+      }
     }
-  }
 #if (FS_FAT_SUPPORT_FAT32)
-  else {
-    //
-    // FAT32
-    //
-    NumSectorsRootDir = SectorsPerCluster;
-    r = FS_LB_WriteMultiplePart(pPart, NumSectorsReserved + FAT_NUM_ALLOC_TABLES * NumSectorsAT, NumSectorsRootDir, pBuffer, FS_SECTOR_TYPE_DIR, 1);
-    if (r != 0) {
-      r = FS_ERRCODE_WRITE_FAILURE;     // Error, could not initialize root directory.
-      goto Done;
+    else {
+      //
+      // FAT32
+      //
+      NumSectorsRootDir = SectorsPerCluster;
+      r = FS_LB_WriteMultiplePart(pPart, NumSectorsReserved + FAT_NUM_ALLOC_TABLES * NumSectorsAT, NumSectorsRootDir, pBuffer, FS_SECTOR_TYPE_DIR, 1);
+      if (r != 0) {
+        r = FS_ERRCODE_WRITE_FAILURE;   // Error, could not initialize root directory.
+        goto Done;
+      }
     }
-  }
 #endif // FS_FAT_SUPPORT_FAT32
+  }
 #if FS_FAT_SUPPORT_FAT32
   if (FATType == FS_FAT_TYPE_FAT32) {
     //
@@ -653,19 +684,6 @@ int FS_FAT_FormatVolume(FS_VOLUME * pVolume, const FS_DEV_INFO * pDevInfo, const
       r = _UpdatePartTable(pVolume, NumSectors, FATType, pBuffer);
     }
   }
-  //
-  // Inform the driver layer about the unused sectors.
-  //
-#if FS_SUPPORT_FREE_SECTOR
-  if (pVolume->FreeSector != 0u) {
-    U32 FirstDataSector;
-    U32 FirstSectorAfterAT;
-
-    FirstSectorAfterAT = NumSectorsReserved + FAT_NUM_ALLOC_TABLES * NumSectorsAT;
-    FirstDataSector    = FirstSectorAfterAT + NumSectorsRootDir;                       // Add number of sectors in the root directory.
-    (void)FS_LB_FreeSectorsPart(pPart, FirstDataSector, NumSectors - FirstDataSector);
-  }
-#endif // FS_SUPPORT_FREE_SECTOR
 Done:
   FS__FreeSectorBuffer(pBuffer);
   return r;
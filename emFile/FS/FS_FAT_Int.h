@@ -270,6 +270,9 @@ int             FS_FAT_MakeShortName           (FS_83NAME * pOutName, const char
 #if FS_FAT_SUPPORT_FREE_CLUSTER_CACHE
   int           FS_FAT_SyncAT                  (FS_VOLUME * pVolume,  FS_SB * pSB);
 #endif // FS_FAT_SUPPORT_FREE_CLUSTER_CACHE
+#if FS_FAT_SUPPORT_FREE_SECTOR_BATCH
+  int           FS_FAT_SyncFreeSectors         (FS_VOLUME * pVolume);
+#endif // FS_FAT_SUPPORT_FREE_SECTOR_BATCH
 int             FS_FAT_IsValidShortNameChar    (U8 c);
 void            FS_FAT_LoadShortName           (char * sName, unsigned MaxNumBytes, const U8 * pShortName);
 void            FS_FAT_CopyDirEntryInfo        (const FS_FAT_DENTRY * pDirEntry, FS_DIRENTRY_INFO * pDirEntryInfo);
@@ -145,6 +145,212 @@ static void _SetFATSector(FS_SB * pSB, U32 SectorIndex, FS_FAT_INFO * pFATInfo)
 #endif
 }
 
+#if FS_SUPPORT_FREE_SECTOR
+
+/*********************************************************************
+*
+*       _FreeClusters
+*
+*  Function description
+*    Informs the device driver about sectors that were assigned to
+*    clusters and that are no longer in use.
+*/
+static int _FreeClusters(FS_VOLUME * pVolume, U32 FirstCluster, U32 NumClusters) {
+  FS_FAT_INFO  * pFATInfo;
+  U32            SectorIndex;
+  U32            NumSectors;
+  FS_PARTITION * pPart;
+  unsigned       ldSectorsPerCluster;
+  int            r;
+
+  pPart = &pVolume->Partition;
+  pFATInfo = &pVolume->FSInfo.FATInfo;
+  ldSectorsPerCluster = _ld(pFATInfo->SectorsPerCluster);
+  SectorIndex         = FS_FAT_ClusterId2SectorNo(pFATInfo, FirstCluster);
+  NumSectors          = NumClusters << ldSectorsPerCluster;
+  r = FS_LB_FreeSectorsPart(pPart, SectorIndex, NumSectors);
+  return r;
+}
+
+
+#if FS_FAT_SUPPORT_FREE_SECTOR_BATCH
+
+/*********************************************************************
+*
+*       _FlushFreeSectorBatch
+*
+*  Function description
+*    Reports all the collected ranges of freed clusters to the storage layer.
+*
+*  Return value
+*    ==0    OK, all ranges reported.
+*    !=0    An error occurred.
+*/
+static int _FlushFreeSectorBatch(FS_VOLUME * pVolume) {
+  FS_FREE_SECTOR_BATCH  * pBatch;
+  FS_FREE_CLUSTER_RANGE * pRange;
+  unsigned                iRange;
+  unsigned                NumRanges;
+  int                     r;
+  int                     Result;
+
+  r         = 0;          // Set to indicate success.
+  pBatch    = &pVolume->FSInfo.FATInfo.FreeSectorBatch;
+  NumRanges = pBatch->NumRanges;
+  pRange    = pBatch->aRange;
+  for (iRange = 0; iRange < NumRanges; ++iRange) {
+    Result = _FreeClusters(pVolume, pRange->FirstCluster, pRange->NumClusters);
+    if (Result != 0) {
+      r = Result;
+    }
+    ++pRange;
+  }
+  pBatch->NumRanges   = 0;
+  pBatch->NumClusters = 0;
+  return r;
+}
+
+/*********************************************************************
+*
+*       _FlushFreeSectorBatchIfOverlap
+*
+*  Function description
+*    Reports the collected ranges of freed clusters to the storage layer
+*    if any of them overlaps the specified range of clusters.
+*
+*  Parameters
+*    pVolume        Volume instance.
+*    FirstCluster   Id of the first cluster that is about to be allocated.
+*    NumClusters    Number of clusters that are about to be allocated.
+*
+*  Additional information
+*    This function has to be called before a freed cluster is allocated again.
+*    Otherwise, the storage layer would discard the new data of the cluster
+*    when the batch is reported at a later time.
+*/
+static void _FlushFreeSectorBatchIfOverlap(FS_VOLUME * pVolume, U32 FirstCluster, U32 NumClusters) {
+  FS_FREE_SECTOR_BATCH  * pBatch;
+  FS_FREE_CLUSTER_RANGE * pRange;
+  unsigned                iRange;
+  unsigned                NumRanges;
+
+  pBatch    = &pVolume->FSInfo.FATInfo.FreeSectorBatch;
+  NumRanges = pBatch->NumRanges;
+  pRange    = pBatch->aRange;
+  for (iRange = 0; iRange < NumRanges; ++iRange) {
+    if (   (FirstCluster < (pRange->FirstCluster + pRange->NumClusters))
+        && (pRange->FirstCluster < (FirstCluster + NumClusters))) {
+      (void)_FlushFreeSectorBatch(pVolume);
+      break;
+    }
+    ++pRange;
+  }
+}
+
+/*********************************************************************
+*
+*       _AddToFreeSectorBatch
+*
+*  Function description
+*    Records a range of freed clusters.
+*
+*  Return value
+*    ==0    OK, range recorded or reported.
+*    !=0    An error occurred.
+*
+*  Additional information
+*    The range is merged with an already recorded range if they are
+*    adjacent. The recorded ranges are reported to the storage layer
+*    when all the ranges are in use, when the total number of sectors
+*    reaches FS_FAT_FREE_SECTOR_THRESHOLD or when the volume is
+*    synchronized or unmounted. Deferring and merging the ranges
+*    reduces the number of FS_CMD_FREE_SECTORS requests and keeps
+*    the latency of delete operations low.
+*/
+static int _AddToFreeSectorBatch(FS_VOLUME * pVolume, U32 FirstCluster, U32 NumClusters) {
+  FS_FREE_SECTOR_BATCH  * pBatch;
+  FS_FREE_CLUSTER_RANGE * pRange;
+  unsigned                iRange;
+  unsigned                NumRanges;
+  int                     r;
+
+  r         = 0;          // Set to indicate success.
+  pBatch    = &pVolume->FSInfo.FATInfo.FreeSectorBatch;
+  NumRanges = pBatch->NumRanges;
+  pRange    = pBatch->aRange;
+  for (iRange = 0; iRange < NumRanges; ++iRange) {
+    if ((pRange->FirstCluster + pRange->NumClusters) == FirstCluster) {
+      pRange->NumClusters += NumClusters;         // Append to the end of the range.
+      break;
+    }
+    if ((FirstCluster + NumClusters) == pRange->FirstCluster) {
+      pRange->FirstCluster  = FirstCluster;       // Prepend to the beginning of the range.
+      pRange->NumClusters  += NumClusters;
+      break;
+    }
+    ++pRange;
+  }
+  if (iRange == NumRanges) {
+    if (NumRanges == (unsigned)FS_FAT_FREE_SECTOR_NUM_RANGES) {
+      r = _FlushFreeSectorBatch(pVolume);
+    }
+    pRange = &pBatch->aRange[pBatch->NumRanges];
+    pRange->FirstCluster = FirstCluster;
+    pRange->NumClusters  = NumClusters;
+    pBatch->NumRanges++;
+  }
+  pBatch->NumClusters += NumClusters;
+#if (FS_FAT_FREE_SECTOR_THRESHOLD > 0)
+  if ((pBatch->NumClusters * pVolume->FSInfo.FATInfo.SectorsPerCluster) >= (U32)FS_FAT_FREE_SECTOR_THRESHOLD) {
+    int Result;
+
+    Result = _FlushFreeSectorBatch(pVolume);
+    if (Result != 0) {
+      r = Result;
+    }
+  }
+#endif // FS_FAT_FREE_SECTOR_THRESHOLD > 0
+  return r;
+}
+
+#endif // FS_FAT_SUPPORT_FREE_SECTOR_BATCH
+
+/*********************************************************************
+*
+*       _DiscardClusters
+*
+*  Function description
+*    Informs the storage layer about freed clusters either immediately
+*    or via the batch of freed clusters.
+*
+*  Return value
+*    ==0    OK, clusters reported or recorded.
+*    !=0    An error occurred.
+*/
+static int _DiscardClusters(FS_VOLUME * pVolume, U32 FirstCluster, U32 NumClusters) {
+  int r;
+
+#if FS_FAT_SUPPORT_FREE_SECTOR_BATCH
+#if FS_SUPPORT_JOURNAL
+  //
+  // The journal keeps track of the freed sectors by itself
+  // and reports them to the storage layer at the end of the transaction.
+  //
+  if (FS__JOURNAL_IsPresent(&pVolume->Partition.Device) != 0) {
+    r = _FreeClusters(pVolume, FirstCluster, NumClusters);
+  } else
+#endif // FS_SUPPORT_JOURNAL
+  {
+    r = _AddToFreeSectorBatch(pVolume, FirstCluster, NumClusters);
+  }
+#else
+  r = _FreeClusters(pVolume, FirstCluster, NumClusters);
+#endif // FS_FAT_SUPPORT_FREE_SECTOR_BATCH
+  return r;
+}
+
+#endif // FS_SUPPORT_FREE_SECTOR
+
 /*********************************************************************
 *
 *       _WriteFATEntry
@@ -228,13 +434,7 @@ static int _WriteFATEntry(FS_VOLUME * pVolume, FS_SB * pSB, U32 ClusterId, U32 V
   //
   if (pVolume->FreeSector != 0u) {
     if (Value == 0u) {
-      U32            Sector;
-      FS_PARTITION * pPart;
-
-      pPart      = &pVolume->Partition;
-      Sector     = FS_FAT_ClusterId2SectorNo(pFATInfo, ClusterId);
-      NumSectors = pFATInfo->SectorsPerCluster;
-      (void)FS_LB_FreeSectorsPart(pPart, Sector, NumSectors);
+      (void)_DiscardClusters(pVolume, ClusterId, 1);
     }
   }
 #endif // FS_SUPPORT_FREE_SECTOR
@@ -417,8 +617,10 @@ static int _SFN_ReadDirEntryInfo(FS_DIR_OBJ * pDir, FS_DIRENTRY_INFO * pDirEntry
     FS_FAT_IncDirPos(&pDir->DirPos);
     if (pDirEntry == NULL) {
       r = FS__SB_GetError(pSB);
-      if (r == 0) {
+      if (r != 0) {
         r = FS_ERRCODE_READ_FAILURE;
+      } else {
+        r = 1;                              // OK, end of directory reached. The last cluster of the directory is full.
       }
       break;
     }
@@ -1268,35 +1470,6 @@ static U32 _FreeClusterChainFromFreeClusterCache(FS_VOLUME * pVolume, U32 Cluste
 
 #endif // FS_FAT_SUPPORT_FREE_CLUSTER_CACHE
 
-#if FS_SUPPORT_FREE_SECTOR
-
-/*********************************************************************
-*
-*       _FreeClusters
-*
-*  Function description
-*    Informs the device driver about sectors that were assigned to
-*    clusters and that are no longer in use.
-*/
-static int _FreeClusters(FS_VOLUME * pVolume, U32 FirstCluster, U32 NumClusters) {
-  FS_FAT_INFO  * pFATInfo;
-  U32            SectorIndex;
-  U32            NumSectors;
-  FS_PARTITION * pPart;
-  unsigned       ldSectorsPerCluster;
-  int            r;
-
-  pPart = &pVolume->Partition;
-  pFATInfo = &pVolume->FSInfo.FATInfo;
-  ldSectorsPerCluster = _ld(pFATInfo->SectorsPerCluster);
-  SectorIndex         = FS_FAT_ClusterId2SectorNo(pFATInfo, FirstCluster);
-  NumSectors          = NumClusters << ldSectorsPerCluster;
-  r = FS_LB_FreeSectorsPart(pPart, SectorIndex, NumSectors);
-  return r;
-}
-
-#endif // FS_SUPPORT_FREE_SECTOR
-
 #if FS_FAT_OPTIMIZE_LINEAR_ACCESS
 
 /*********************************************************************
@@ -1744,6 +1917,19 @@ U32 FS_FAT_FindFreeCluster(FS_VOLUME * pVolume, FS_SB * pSB, U32 FirstCluster, F
   ClusterId = 0;              // Error, no free cluster
 Done:
   FS_DISABLE_READ_AHEAD(pVolume);
+#if FS_FAT_SUPPORT_FREE_SECTOR_BATCH
+  if ((ClusterId != 0u) && (pFATInfo->FreeSectorBatch.NumRanges != 0u)) {
+    U32 NumClusters;
+
+    NumClusters = 1;
+#if FS_FAT_SUPPORT_FREE_CLUSTER_CACHE
+    if (pFATInfo->FreeClusterCache.StartCluster == ClusterId) {
+      NumClusters = pFATInfo->FreeClusterCache.NumClustersTotal;      // All the clusters in the free cluster cache are going to be allocated.
+    }
+#endif // FS_FAT_SUPPORT_FREE_CLUSTER_CACHE
+    _FlushFreeSectorBatchIfOverlap(pVolume, ClusterId, NumClusters);
+  }
+#endif // FS_FAT_SUPPORT_FREE_SECTOR_BATCH
   return ClusterId;
 }
 
@@ -2137,7 +2323,7 @@ int FS_FAT_FreeClusterChain(FS_VOLUME * pVolume, FS_SB * pSB, U32 ClusterId, U32
         // Free sectors if the clusters are not continuous.
         //
         if (NextCluster != (FirstFreeCluster + NumFreeClusters)) {
-          Result = _FreeClusters(pVolume, FirstFreeCluster, NumFreeClusters);
+          Result = _DiscardClusters(pVolume, FirstFreeCluster, NumFreeClusters);
           if (Result != 0) {
             r = FS_ERRCODE_WRITE_FAILURE;
           }
@@ -2201,7 +2387,7 @@ int FS_FAT_FreeClusterChain(FS_VOLUME * pVolume, FS_SB * pSB, U32 ClusterId, U32
         // Free sectors if the clusters are not continuous.
         //
         if (NextCluster != (FirstFreeCluster + NumFreeClusters)) {
-          Result = _FreeClusters(pVolume, FirstFreeCluster, NumFreeClusters);
+          Result = _DiscardClusters(pVolume, FirstFreeCluster, NumFreeClusters);
           if (Result != 0) {
             r = FS_ERRCODE_WRITE_FAILURE;
           }
@@ -2720,6 +2906,37 @@ int FS_FAT_SyncAT(FS_VOLUME * pVolume, FS_SB * pSB) {
 
 #endif // FS_FAT_SUPPORT_FREE_CLUSTER_CACHE
 
+#if FS_FAT_SUPPORT_FREE_SECTOR_BATCH
+
+/*********************************************************************
+*
+*       FS_FAT_SyncFreeSectors
+*
+*  Function description
+*    Reports the freed clusters collected in the batch to the storage layer.
+*
+*  Parameters
+*    pVolume    Pointer to the volume.
+*
+*  Return value
+*    ==0      OK, all freed clusters reported.
+*    !=0      Error code indicating the failure reason.
+*/
+int FS_FAT_SyncFreeSectors(FS_VOLUME * pVolume) {
+  int r;
+
+  r = 0;
+  if (pVolume->FSInfo.FATInfo.FreeSectorBatch.NumRanges != 0u) {
+    r = _FlushFreeSectorBatch(pVolume);
+    if (r != 0) {
+      r = FS_ERRCODE_WRITE_FAILURE;
+    }
+  }
+  return r;
+}
+
+#endif // FS_FAT_SUPPORT_FREE_SECTOR_BATCH
+
 /*********************************************************************
 *
 *       FS_FAT_FreeSectors
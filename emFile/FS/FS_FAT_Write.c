@@ -978,6 +978,9 @@ int FS_FAT_CloseFile(FS_FILE * pFile) {
 *    pVolume      Pointer to a mounted volume.
 */
 void FS_FAT_Clean(FS_VOLUME * pVolume) {
+#if FS_FAT_SUPPORT_FREE_SECTOR_BATCH
+  (void)FS_FAT_SyncFreeSectors(pVolume);
+#endif // FS_FAT_SUPPORT_FREE_SECTOR_BATCH
   _UpdateFSInfoSectorIfRequired(pVolume);
   FS_FAT_UpdateDirtyFlagIfRequired(pVolume, 0);
 }
@@ -344,6 +344,33 @@ typedef struct {
   FS_FILE *    pFile;             // Opened file that is using the cache.
 } FS_FREE_CLUSTER_CACHE;
 
+#if FS_FAT_SUPPORT_FREE_SECTOR_BATCH
+
+/*********************************************************************
+*
+*       FS_FREE_CLUSTER_RANGE
+*/
+typedef struct {
+  U32 FirstCluster;       // Id of the first cluster in the range.
+  U32 NumClusters;        // Number of consecutive clusters in the range.
+} FS_FREE_CLUSTER_RANGE;
+
+/*********************************************************************
+*
+*       FS_FREE_SECTOR_BATCH
+*
+*  Additional information
+*    Ranges of freed clusters that were not reported yet
+*    to the storage layer via FS_CMD_FREE_SECTORS.
+*/
+typedef struct {
+  FS_FREE_CLUSTER_RANGE aRange[FS_FAT_FREE_SECTOR_NUM_RANGES];
+  U32                   NumClusters;  // Total number of clusters in all the ranges.
+  U16                   NumRanges;    // Number of ranges in use.
+} FS_FREE_SECTOR_BATCH;
+
+#endif // FS_FAT_SUPPORT_FREE_SECTOR_BATCH
+
 /*********************************************************************
 *
 *       FAT_FSINFO_SECTOR
@@ -393,6 +420,9 @@ typedef struct {
 #if FS_FAT_SUPPORT_FREE_CLUSTER_CACHE
   FS_FREE_CLUSTER_CACHE FreeClusterCache;               // Cache for the ids of consecutive free clusters. Used with file write operation mode set to fast.
 #endif // FS_FAT_SUPPORT_FREE_CLUSTER_CACHE
+#if FS_FAT_SUPPORT_FREE_SECTOR_BATCH
+  FS_FREE_SECTOR_BATCH  FreeSectorBatch;                // Freed clusters not yet reported to the storage layer.
+#endif // FS_FAT_SUPPORT_FREE_SECTOR_BATCH
   U32                   WriteCntAT;                     // Counts the number of times the file system has modified the allocation table.
 } FS_FAT_INFO;
 
@@ -111,6 +111,14 @@ Literature  :
 #if (FS_MMC_SUPPORT_MMC == 0) && (FS_MMC_SUPPORT_SD == 0)
   #error FS_MMC_SUPPORT_MMC or FS_MMC_SUPPORT_SD has to be set to 1
 #endif
+#if (FS_MMC_SUPPORT_CMDQ != 0) && (FS_MMC_SUPPORT_MMC == 0)
+  #error FS_MMC_SUPPORT_CMDQ requires FS_MMC_SUPPORT_MMC to be set to 1
+#endif
+#if FS_MMC_SUPPORT_CMDQ
+#if (FS_MMC_CMDQ_MAX_DEPTH < 1) || (FS_MMC_CMDQ_MAX_DEPTH > 32)
+  #error FS_MMC_CMDQ_MAX_DEPTH has to be set to a value between 1 and 32
+#endif
+#endif // FS_MMC_SUPPORT_CMDQ
 
 /*********************************************************************
 *
@@ -153,6 +161,9 @@ Literature  :
   #define CMD_SEND_RELATIVE_ADDR          3u
   #define CMD_SWITCH_FUNC                 6u
   #define CMD_SEND_IF_COND                8u
+  #define CMD_ERASE_WR_BLK_START          32u
+  #define CMD_ERASE_WR_BLK_END            33u
+  #define CMD_ERASE_SD                    38u
 #if FS_MMC_SUPPORT_UHS
   #define CMD_VOLTAGE_SWITCH              11u
 #endif // FS_MMC_SUPPORT_UHS
@@ -171,6 +182,13 @@ Literature  :
   #define CMD_ERASE_GROUP_START           35u
   #define CMD_ERASE_GROUP_END             36u
   #define CMD_ERASE_MMC                   38u
+#if FS_MMC_SUPPORT_CMDQ
+  #define CMD_QUEUED_TASK_PARAMS          44u
+  #define CMD_QUEUED_TASK_ADDRESS         45u
+  #define CMD_EXECUTE_READ_TASK           46u
+  #define CMD_EXECUTE_WRITE_TASK          47u
+  #define CMD_CMDQ_TASK_MGMT              48u
+#endif // FS_MMC_SUPPORT_CMDQ
 #endif // FS_MMC_SUPPORT_MMC
 
 /*********************************************************************
@@ -226,6 +244,13 @@ Literature  :
 #if FS_MMC_SUPPORT_POWER_SAVE
   #define ARG_SLEEP_AWAKE_SHIFT           15u
 #endif // FS_MMC_SUPPORT_POWER_SAVE
+#if FS_MMC_SUPPORT_CMDQ
+  #define ARG_SEND_QSR_SHIFT              15u   // SEND_STATUS (CMD13) returns the Queue Status Register instead of the card status.
+  #define ARG_TASK_DATA_DIR_SHIFT         30u   // 1 means read, 0 means write.
+  #define ARG_TASK_ID_SHIFT               16u
+  #define ARG_TASK_NUM_BLOCKS_MASK        0xFFFFu
+  #define ARG_TM_OP_DISCARD_QUEUE         1u
+#endif // FS_MMC_SUPPORT_CMDQ
 #endif // FS_MMC_SUPPORT_MMC
 
 /*********************************************************************
@@ -369,6 +394,9 @@ Literature  :
 *       Extended CSD register
 */
 #if FS_MMC_SUPPORT_MMC
+#if FS_MMC_SUPPORT_CMDQ
+  #define OFF_EXT_CSD_CMDQ_MODE_EN        15
+#endif // FS_MMC_SUPPORT_CMDQ
   #define OFF_EXT_CSD_CACHE_CTRL          33
   #define OFF_EXT_CSD_BUS_WIDTH           183
 #if FS_MMC_SUPPORT_UHS
@@ -379,6 +407,11 @@ Literature  :
   #define OFF_EXT_CSD_DRIVER_STRENGTH     197
 #endif
   #define OFF_EXT_CSD_CACHE_SIZE          249
+#if FS_MMC_SUPPORT_CMDQ
+  #define OFF_EXT_CSD_CMDQ_DEPTH          307
+  #define OFF_EXT_CSD_CMDQ_SUPPORT        308
+  #define EXT_CSD_CMDQ_DEPTH_MASK         0x1Fu
+#endif // FS_MMC_SUPPORT_CMDQ
   #define EXT_CSD_BUS_WIDTH_1BIT          0
   #define EXT_CSD_BUS_WIDTH_4BIT          1
   #define EXT_CSD_BUS_WIDTH_8BIT          2
@@ -395,6 +428,7 @@ Literature  :
 #endif
 #endif // FS_MMC_SUPPORT_MMC
 #define OFF_EXT_WR_REL_PARAM              166
+#define OFF_EXT_CSD_ERASED_MEM_CONT       181
 #define OFF_EXT_CSD_CARD_TYPE             196
 #define OFF_EXT_CSD_SEC_COUNT             212
 #define EXT_CSD_CARD_TYPE_26MHZ_SHIFT     0
@@ -452,6 +486,9 @@ Literature  :
 #endif // FS_MMC_SUPPORT_MMC
 #if FS_MMC_SUPPORT_SD
   #define CSD_CCC_CLASSES(pCSD)           _GetFromCSD(pCSD,  84, 95)
+  #define CSD_ERASE_BLK_EN(pCSD)          _GetFromCSD(pCSD, 46, 46)
+  #define CSD_SECTOR_SIZE(pCSD)           _GetFromCSD(pCSD, 39, 45)
+  #define CSD_WRITE_BL_LEN(pCSD)          _GetFromCSD(pCSD, 22, 25)
 #endif // FS_MMC_SUPPORT_SD
 #define CSD_WRITE_PROTECT(pCSD)           _GetFromCSD(pCSD, 12, 13)
 #define CSD_C_SIZE_MULT(pCSD)             _GetFromCSD(pCSD, 47, 49)
@@ -468,6 +505,7 @@ Literature  :
   #define BUS_WIDTH_4BIT_SHIFT            2
   #define SCR_SD_SPEC(pSCR)               (U8)_GetBits(SEGGER_CONSTPTR2PTR(const U8, pSCR), 56, 59, NUM_BYTES_SCR)
   #define SCR_SD_BUS_WIDTHS(pSCR)         (U8)_GetBits(SEGGER_CONSTPTR2PTR(const U8, pSCR), 48, 51, NUM_BYTES_SCR)
+  #define SCR_DATA_STAT_AFTER_ERASE(pSCR) (U8)_GetBits(SEGGER_CONSTPTR2PTR(const U8, pSCR), 55, 55, NUM_BYTES_SCR)
 #endif // #if FS_MMC_SUPPORT_MMC
 #define SCR_SD_CMD23_SUPPORT(pSCR)        (U8)_GetBits(SEGGER_CONSTPTR2PTR(const U8, pSCR), 33, 33, NUM_BYTES_SCR)
 
@@ -502,6 +540,18 @@ Literature  :
   #define IF_STATS(Exp)
 #endif
 
+/*********************************************************************
+*
+*       Command latency measurement
+*/
+#if FS_MMC_ENABLE_STATS
+  #define CMD_TIME_START(TimeStart)                         (TimeStart) = FS_MMC_GET_TIMESTAMP()
+  #define CMD_TIME_END(pInst, TimeStart, Cnt, Time, TimeMax) _UpdateCmdTime(&(pInst)->StatCounters.Cnt, &(pInst)->StatCounters.Time, &(pInst)->StatCounters.TimeMax, TimeStart)
+#else
+  #define CMD_TIME_START(TimeStart)
+  #define CMD_TIME_END(pInst, TimeStart, Cnt, Time, TimeMax)
+#endif
+
 /*********************************************************************
 *
 *       Local types
@@ -568,6 +618,20 @@ typedef struct {
   void * pBuffer;
 } DATA_INFO;
 
+#if FS_MMC_SUPPORT_CMDQ
+
+/*********************************************************************
+*
+*       CMDQ_TASK
+*/
+typedef struct {
+  U8  * pData;          // Sector data transferred by the task.
+  U32   SectorIndex;    // Index of the first sector transferred by the task.
+  U16   NumSectors;     // Number of sectors transferred by the task. 0 means that the task id is not in use.
+} CMDQ_TASK;
+
+#endif // FS_MMC_SUPPORT_CMDQ
+
 /*********************************************************************
 *
 *       MMC_CM_INST
@@ -603,6 +667,23 @@ typedef struct {
   U8                        IsReliableWriteActive;          // Set to 1 if a fail-safe operation is used to write the data to an MMC device.
   U8                        IsBufferedWriteAllowed;         // Set to 1 if data can be send to storage device while a write operation is still in progress.
   U8                        IsCloseEndedRWSupported;        // Set to 1 if a data transfer does not have to be stopped using CMD12
+  U8                        IsErasedValueZero;              // Set to 1 if erased or trimmed logical sectors read back as 0.
+#if FS_MMC_SUPPORT_SD
+  U8                        IsErasePending;                 // Set to 1 if the SD card may still be erasing the sectors of a free sector request.
+  U16                       NumSectorsErase;                // Number of logical sectors in the smallest unit the SD card is able to erase.
+#endif // FS_MMC_SUPPORT_SD
+#if FS_MMC_SUPPORT_STREAMING
+  U8                        IsStreamingAllowed;             // Set to 1 if a multiple block write operation can remain open across consecutive write requests.
+  U8                        IsStreamOpen;                   // Set to 1 if the card may still be programming the data of a streaming write operation.
+  U32                       StreamSectorIndex;              // Index of the sector the open streaming write operation expects next.
+  U32                       StreamTimeLastWrite;            // Time in milliseconds at which data was written the last time to the open streaming write operation.
+#endif // FS_MMC_SUPPORT_STREAMING
+#if FS_MMC_SUPPORT_CMDQ
+  U8                        IsCmdQAllowed;                  // Set to 1 if the data can be transferred via the command queue of an eMMC device.
+  U8                        IsCmdQActive;                   // Set to 1 if the command queue mode is enabled in the eMMC device.
+  U8                        CmdQDepth;                      // Number of tasks the eMMC device is able to queue. 0 means that the command queue is not supported.
+  CMDQ_TASK                 aCmdQTask[FS_MMC_CMDQ_MAX_DEPTH]; // Tasks queued in the eMMC device indexed by task id.
+#endif // FS_MMC_SUPPORT_CMDQ
 #if FS_MMC_SUPPORT_MMC
   U8                        IsCacheActivationAllowed;       // Set to 1 if the data cache of an eMMC device can be enabled.
   U8                        IsCacheEnabled;                 // Set to 1 if the data cache of the eMMC device was enabled by the driver.
@@ -850,6 +931,43 @@ static U32 _CalcReadDataTimeOut(U32 TimeOut, U32 ClockFreq) {
   return NumClockCycles;
 }
 
+#if FS_MMC_ENABLE_STATS
+
+/*********************************************************************
+*
+*       _UpdateCmdTime
+*
+*  Function description
+*    Updates the latency counters of a command.
+*
+*  Parameters
+*    pCnt         [IN]  Number of commands executed.
+*                 [OUT] Number of commands executed including this one.
+*    pTime        [IN]  Total execution time in us.
+*                 [OUT] Total execution time in us including this command.
+*    pTimeMax     [IN]  Maximum execution time in us.
+*                 [OUT] Maximum execution time in us including this command.
+*    TimeStart    Value of FS_MMC_GET_TIMESTAMP() at which the execution of the command started.
+*
+*  Additional information
+*    The time stamp is a free-running 32-bit counter. The difference
+*    is computed before the conversion to microseconds so that
+*    the result is correct also when the counter wraps around.
+*/
+static void _UpdateCmdTime(U32 * pCnt, U32 * pTime, U32 * pTimeMax, U32 TimeStart) {
+  U32 TimeExec;
+
+  TimeExec  = (U32)FS_MMC_GET_TIMESTAMP() - TimeStart;
+  TimeExec /= (U32)FS_MMC_TIMESTAMP_TICKS_PER_US;
+  ++(*pCnt);
+  *pTime += TimeExec;
+  if (TimeExec > *pTimeMax) {
+    *pTimeMax = TimeExec;
+  }
+}
+
+#endif // FS_MMC_ENABLE_STATS
+
 /*********************************************************************
 *
 *       _GetFreeMem
@@ -1121,6 +1239,41 @@ static int _WriteData(const MMC_CM_INST * pInst, const DATA_INFO * pDataInfo) {
   return r;
 }
 
+#if FS_MMC_SUPPORT_STREAMING
+
+/*********************************************************************
+*
+*       _ContinueWrite
+*/
+static int _ContinueWrite(MMC_CM_INST * pInst, U32 SectorIndex, const void * pData, U32 NumBlocks) {    //lint -efunc(818, _ContinueWrite) Pointer parameter 'pInst' could be declared as pointing to const [MISRA 2012 Rule 8.13, advisory]. Rationale: Not possible because we have to be able to update the statistical counters in debug builds.
+  int      r;
+  U8       Unit;
+  U32      Arg;
+  unsigned CmdFlags;
+
+  Unit = pInst->Unit;
+  Arg  = SectorIndex;
+  if (pInst->IsHighCapacity == 0u) {
+    Arg <<= BYTES_PER_SECTOR_SHIFT;     // Use the byte address for standard capacity cards (<= 2GB).
+  }
+  CmdFlags = 0u
+           | FS_MMC_CMD_FLAG_DATATRANSFER
+           | FS_MMC_CMD_FLAG_WRITETRANSFER
+           ;
+  if (pInst->BusWidth == 4u) {
+    CmdFlags |= FS_MMC_CMD_FLAG_USE_SD4MODE;
+  } else {
+    if (pInst->BusWidth == 8u) {
+      CmdFlags |= FS_MMC_CMD_FLAG_USE_MMC8MODE;
+    }
+  }
+  r = pInst->pHWType->pfContinueWrite(Unit, CmdFlags, Arg, pData, BYTES_PER_SECTOR, NumBlocks);
+  IF_STATS(pInst->StatCounters.CmdExecCnt++);
+  return r;
+}
+
+#endif // FS_MMC_SUPPORT_STREAMING
+
 /*********************************************************************
 *
 *       _SetDataPointer
@@ -2621,6 +2774,9 @@ static int _ExecStopTransmission(MMC_CM_INST * pInst, CARD_STATUS * pCardStatus)
   CMD_INFO CmdInfo;
   unsigned Flags;
   unsigned NextStateMask;
+#if FS_MMC_ENABLE_STATS
+  U32      TimeStart;
+#endif // FS_MMC_ENABLE_STATS
 
   FS_MEMSET(&CmdInfo, 0, sizeof(CmdInfo));
   Flags         = 0u
@@ -2634,7 +2790,9 @@ static int _ExecStopTransmission(MMC_CM_INST * pInst, CARD_STATUS * pCardStatus)
   CmdInfo.Index         = CMD_STOP_TRANSMISSION;
   CmdInfo.Flags         = (U16)Flags;
   CmdInfo.NextStateMask = (U16)NextStateMask;
+  CMD_TIME_START(TimeStart);
   r = _ExecCmdR1WithStateTransition(pInst, &CmdInfo, pCardStatus);
+  CMD_TIME_END(pInst, TimeStart, StopCmdCnt, StopCmdTime, StopCmdTimeMax);
   FS_DEBUG_LOG((FS_MTYPE_DRIVER, "MMC_CM: STOP_TRANSMISSION Res: %d\n", r));
   return r;
 }
@@ -2712,6 +2870,9 @@ static int _ExecReadSingleBlock(MMC_CM_INST * pInst, U32 SectorIndex, U32 * pDat
   U32       Arg;
   CMD_INFO  CmdInfo;
   DATA_INFO DataInfo;
+#if FS_MMC_ENABLE_STATS
+  U32       TimeStart;
+#endif // FS_MMC_ENABLE_STATS
 
   FS_MEMSET(&CmdInfo, 0, sizeof(CmdInfo));
   FS_MEMSET(&DataInfo, 0, sizeof(DataInfo));
@@ -2724,7 +2885,9 @@ static int _ExecReadSingleBlock(MMC_CM_INST * pInst, U32 SectorIndex, U32 * pDat
   DataInfo.BytesPerBlock = (U16)BYTES_PER_SECTOR;
   DataInfo.NumBlocks     = 1;
   DataInfo.pBuffer       = pData;
+  CMD_TIME_START(TimeStart);
   r = _ExecCmdR1WithDataRead(pInst, &CmdInfo, &DataInfo, pCardStatus, 0);   // Retries have to be done in the caller function.
+  CMD_TIME_END(pInst, TimeStart, ReadCmdCnt, ReadCmdTime, ReadCmdTimeMax);
   FS_DEBUG_LOG((FS_MTYPE_DRIVER, "MMC_CM: READ_SINGLE_BLOCK SectorIndex: %lu, Res: %d\n", SectorIndex, r));
   return r;
 }
@@ -2748,6 +2911,9 @@ static int _ExecReadMultipleBlocks(MMC_CM_INST * pInst, U32 SectorIndex, U32 * p
   U32       Arg;
   CMD_INFO  CmdInfo;
   DATA_INFO DataInfo;
+#if FS_MMC_ENABLE_STATS
+  U32       TimeStart;
+#endif // FS_MMC_ENABLE_STATS
 
   FS_MEMSET(&CmdInfo, 0, sizeof(CmdInfo));
   FS_MEMSET(&DataInfo, 0, sizeof(DataInfo));
@@ -2760,7 +2926,9 @@ static int _ExecReadMultipleBlocks(MMC_CM_INST * pInst, U32 SectorIndex, U32 * p
   DataInfo.BytesPerBlock = (U16)BYTES_PER_SECTOR;
   DataInfo.NumBlocks     = NumSectors;
   DataInfo.pBuffer       = pData;
+  CMD_TIME_START(TimeStart);
   r = _ExecCmdR1WithDataRead(pInst, &CmdInfo, &DataInfo, pCardStatus, 0);    // Retries have to be done in the caller function.
+  CMD_TIME_END(pInst, TimeStart, ReadCmdCnt, ReadCmdTime, ReadCmdTimeMax);
   FS_DEBUG_LOG((FS_MTYPE_DRIVER, "MMC_CM: READ_MULTIPLE_BLOCKS SectorIndex: %lu, NumSectors: %u, Res: %d\n", SectorIndex, NumSectors, r));
   return r;
 }
@@ -2887,6 +3055,9 @@ static int _ExecWriteBlock(MMC_CM_INST * pInst, U32 SectorIndex, const U32 * pDa
   U32       Arg;
   CMD_INFO  CmdInfo;
   DATA_INFO DataInfo;
+#if FS_MMC_ENABLE_STATS
+  U32       TimeStart;
+#endif // FS_MMC_ENABLE_STATS
 
   FS_MEMSET(&CmdInfo, 0, sizeof(CmdInfo));
   FS_MEMSET(&DataInfo, 0, sizeof(DataInfo));
@@ -2899,7 +3070,9 @@ static int _ExecWriteBlock(MMC_CM_INST * pInst, U32 SectorIndex, const U32 * pDa
   DataInfo.BytesPerBlock = (U16)BYTES_PER_SECTOR;
   DataInfo.NumBlocks     = 1;
   DataInfo.pBuffer       = SEGGER_PTR2PTR(void, pData);                       //lint !e9005 attempt to cast away const/volatile from a pointer or reference [MISRA 2012 Rule 11.8, required]. Rationale: the pBuffer structure member is used for read as well as write operations.
+  CMD_TIME_START(TimeStart);
   r = _ExecCmdR1WithDataWrite(pInst, &CmdInfo, &DataInfo, pCardStatus, 0);    // Retries have to be done in the caller.
+  CMD_TIME_END(pInst, TimeStart, WriteCmdCnt, WriteCmdTime, WriteCmdTimeMax);
   FS_DEBUG_LOG((FS_MTYPE_DRIVER, "MMC_CM: WRITE_BLOCK SectorIndex: %lu, Res: %d\n", SectorIndex, r));
   return r;
 }
@@ -2924,6 +3097,9 @@ static int _ExecWriteMultipleBlocks(MMC_CM_INST * pInst, U32 SectorIndex, const
   U32       Arg;
   CMD_INFO  CmdInfo;
   DATA_INFO DataInfo;
+#if FS_MMC_ENABLE_STATS
+  U32       TimeStart;
+#endif // FS_MMC_ENABLE_STATS
   U16       CmdFlags;
 
   FS_MEMSET(&CmdInfo, 0, sizeof(CmdInfo));
@@ -2949,7 +3125,9 @@ static int _ExecWriteMultipleBlocks(MMC_CM_INST * pInst, U32 SectorIndex, const
   DataInfo.BytesPerBlock = (U16)BYTES_PER_SECTOR;
   DataInfo.NumBlocks     = NumSectors;
   DataInfo.pBuffer       = SEGGER_PTR2PTR(void, pData);                       //lint !e9005 attempt to cast away const/volatile from a pointer or reference [MISRA 2012 Rule 11.8, required]. Rationale: the pBuffer structure member is used for read as well as write operations.
+  CMD_TIME_START(TimeStart);
   r = _ExecCmdR1WithDataWrite(pInst, &CmdInfo, &DataInfo, pCardStatus, 0);    // Retries have to be done in the caller.
+  CMD_TIME_END(pInst, TimeStart, WriteCmdCnt, WriteCmdTime, WriteCmdTimeMax);
   FS_DEBUG_LOG((FS_MTYPE_DRIVER, "MMC_CM: WRITE_MULTIPLE_BLOCKS SectorIndex: %lu, NumSectors: %u, Res: %d\n", SectorIndex, NumSectors, r));
   return r;
 }
@@ -3056,6 +3234,105 @@ static int _ExecEraseMMC(MMC_CM_INST * pInst, int IsSecure, int ForceGarbageColl
 
 #endif  // FS_MMC_SUPPORT_MMC
 
+#if FS_MMC_SUPPORT_SD
+
+/*********************************************************************
+*
+*      _ExecEraseWrBlkStart
+*
+*  Function description
+*    Executes the ERASE_WR_BLK_START (CMD32) command.
+*
+*  Return value
+*    ==0    OK, command executed successfully.
+*    > 0    Error, host controller reports a failure.
+*    < 0    Error, card reports a failure.
+*/
+static int _ExecEraseWrBlkStart(MMC_CM_INST * pInst, U32 SectorIndex, CARD_STATUS * pCardStatus) {
+  int      r;
+  U32      Arg;
+  CMD_INFO CmdInfo;
+
+  FS_MEMSET(&CmdInfo, 0, sizeof(CmdInfo));
+  Arg = SectorIndex;
+  if (pInst->IsHighCapacity == 0u) {
+    Arg <<= BYTES_PER_SECTOR_SHIFT;
+  }
+  CmdInfo.Index = CMD_ERASE_WR_BLK_START;
+  CmdInfo.Arg   = Arg;
+  r = _ExecCmdR1(pInst, &CmdInfo, pCardStatus, NUM_RETRIES_CMD);
+  FS_DEBUG_LOG((FS_MTYPE_DRIVER, "MMC_CM: ERASE_WR_BLK_START SectorIndex: %lu, Res: %d\n", SectorIndex, r));
+  return r;
+}
+
+/*********************************************************************
+*
+*      _ExecEraseWrBlkEnd
+*
+*  Function description
+*    Executes the ERASE_WR_BLK_END (CMD33) command.
+*
+*  Return value
+*    ==0    OK, command executed successfully.
+*    > 0    Error, host controller reports a failure.
+*    < 0    Error, card reports a failure.
+*/
+static int _ExecEraseWrBlkEnd(MMC_CM_INST * pInst, U32 SectorIndex, CARD_STATUS * pCardStatus) {
+  int      r;
+  U32      Arg;
+  CMD_INFO CmdInfo;
+
+  FS_MEMSET(&CmdInfo, 0, sizeof(CmdInfo));
+  Arg = SectorIndex;
+  if (pInst->IsHighCapacity == 0u) {
+    Arg <<= BYTES_PER_SECTOR_SHIFT;
+  }
+  CmdInfo.Index = CMD_ERASE_WR_BLK_END;
+  CmdInfo.Arg   = Arg;
+  r = _ExecCmdR1(pInst, &CmdInfo, pCardStatus, NUM_RETRIES_CMD);
+  FS_DEBUG_LOG((FS_MTYPE_DRIVER, "MMC_CM: ERASE_WR_BLK_END SectorIndex: %lu, Res: %d\n", SectorIndex, r));
+  return r;
+}
+
+/*********************************************************************
+*
+*      _ExecEraseSD
+*
+*  Function description
+*    Executes the ERASE (CMD38) command for SD cards.
+*
+*  Return value
+*    ==0    OK, command executed successfully.
+*    > 0    Error, host controller reports a failure.
+*    < 0    Error, card reports a failure.
+*
+*  Additional information
+*    The argument is set to 0 which requests an erase operation.
+*    The other values (discard and FULE) are optional and are
+*    not used.
+*
+*    With IsBusyWait set to 0 the HW layer returns as soon as
+*    the response is received. The SD card stays in the Programming
+*    state until the erase operation is finished.
+*/
+static int _ExecEraseSD(MMC_CM_INST * pInst, int IsBusyWait, CARD_STATUS * pCardStatus) {
+  int      r;
+  CMD_INFO CmdInfo;
+
+  FS_MEMSET(pCardStatus, 0, sizeof(*pCardStatus));
+  FS_MEMSET(&CmdInfo, 0, sizeof(CmdInfo));
+  CmdInfo.Index = CMD_ERASE_SD;
+  if (IsBusyWait != 0) {
+    CmdInfo.Flags = (U16)FS_MMC_CMD_FLAG_SETBUSY;
+  }
+  CmdInfo.Arg   = 0;
+  r = _ExecCmdR1(pInst, &CmdInfo, pCardStatus, NUM_RETRIES_CMD);
+  FS_DEBUG_LOG((FS_MTYPE_DRIVER, "MMC_CM: ERASE Res: %d\n", r));
+  return r;
+}
+
+#endif  // FS_MMC_SUPPORT_SD
+
 /*********************************************************************
 *
 *      _ExecLockUnlock
@@ -3942,6 +4219,7 @@ static int _WaitForCardReady(MMC_CM_INST * pInst, CARD_STATUS * pCardStatus) {
       r = 0;
       break;                      // OK, the card is ready.
     }
+    IF_STATS(pInst->StatCounters.WaitReadyCnt++);
     if (TimeOut == 0u) {
       FS_DEBUG_ERROROUT((FS_MTYPE_DRIVER, "MMC_CM: _WaitForCardReady: Timeout expired."));
       r = 1;
@@ -4138,107 +4416,580 @@ static int _WaitForCardState(MMC_CM_INST * pInst, CARD_STATUS * pCardStatus, uns
   return r;
 }
 
+#if FS_MMC_SUPPORT_CMDQ
+
 /*********************************************************************
 *
-*       _SelectCard
+*       _ExecQueuedTaskParams
 *
 *  Function description
-*    Requests the card to move to Transfer state.
+*    Executes the QUEUED_TASK_PARAMS (CMD44) command.
+*
+*  Parameters
+*    pInst          Driver instance.
+*    TaskId         Id of the task to be queued.
+*    IsRead         Direction of the data transfer (1 - read, 0 - write).
+*    NumSectors     Number of sectors to be transferred by the task.
+*    pCardStatus    [OUT] Contents of the status register.
+*
+*  Return value
+*    ==0    OK, parameters of the task accepted by the card.
+*    !=0    An error has occurred.
+*
+*  Additional information
+*    This command is the first part of the task queuing. It is
+*    followed by QUEUED_TASK_ADDRESS (CMD45) that specifies the
+*    index of the first sector to be transferred.
 */
-static int _SelectCard(MMC_CM_INST * pInst, CARD_STATUS * pCardStatus) {
+static int _ExecQueuedTaskParams(MMC_CM_INST * pInst, unsigned TaskId, int IsRead, U32 NumSectors, CARD_STATUS * pCardStatus) {
   int      r;
-  unsigned rca;
-  unsigned TimeOut;
+  U32      Arg;
+  CMD_INFO CmdInfo;
 
-  rca = pInst->Rca;
-  //
-  // Try to select the card.
-  //
-  TimeOut = FS_MMC_SELECT_CARD_TIMEOUT;
-  for (;;) {
-    //
-    // Quit the waiting loop if the card has been removed.
-    //
-    r = _IsPresent(pInst);
-    if (r == 0) {
-      FS_DEBUG_WARN((FS_MTYPE_DRIVER, "MMC_CM: _SelectCard: Card has been removed."));
-      r = 1;
-      pInst->HasError = 1;
-      break;          // Error, card has been removed.
-    }
-    r = _ExecSelectCard(pInst, rca, pCardStatus);
-    if (r == 0) {
-      break;          // OK, the card selected.
-    }
-    if (TimeOut == 0u) {
-      FS_DEBUG_ERROROUT((FS_MTYPE_DRIVER, "MMC_CM: _SelectCard: Timeout expired."));
-      break;          // Error, could not select card.
+  FS_MEMSET(&CmdInfo, 0, sizeof(CmdInfo));
+  Arg = 0u
+      | ((U32)TaskId << ARG_TASK_ID_SHIFT)
+      | (NumSectors & ARG_TASK_NUM_BLOCKS_MASK)
+      ;
+  if (IsRead != 0) {
+    Arg |= 1uL << ARG_TASK_DATA_DIR_SHIFT;
+  } else {
+    if (pInst->IsReliableWriteActive != 0u) {
+      Arg |= 1uL << ARG_RELIABLE_WRITE_SHIFT;
     }
-    --TimeOut;
   }
+  CmdInfo.Index = CMD_QUEUED_TASK_PARAMS;
+  CmdInfo.Arg   = Arg;
+  r = _ExecCmdR1(pInst, &CmdInfo, pCardStatus, NUM_RETRIES_CMD);
+  FS_DEBUG_LOG((FS_MTYPE_DRIVER, "MMC_CM: QUEUED_TASK_PARAMS TaskId: %u, IsRead: %d, NumSectors: %lu, Res: %d\n", TaskId, IsRead, NumSectors, r));
   return r;
 }
 
 /*********************************************************************
 *
-*       _SelectCardIfRequired
+*       _ExecQueuedTaskAddress
 *
 *  Function description
-*    Checks the card status and requests the card to move to Transfer state
-*    if the card is in a different state.
+*    Executes the QUEUED_TASK_ADDRESS (CMD45) command.
+*
+*  Parameters
+*    pInst          Driver instance.
+*    SectorIndex    Index of the first sector to be transferred by the task.
+*    pCardStatus    [OUT] Contents of the status register.
 *
 *  Return value
-*    ==0        OK, card is in Transfer state.
-*    !=0        An error occurred.
+*    ==0    OK, the task is queued.
+*    !=0    An error has occurred.
 */
-static int _SelectCardIfRequired(MMC_CM_INST * pInst, CARD_STATUS * pCardStatus) {
+static int _ExecQueuedTaskAddress(MMC_CM_INST * pInst, U32 SectorIndex, CARD_STATUS * pCardStatus) {
   int      r;
-  unsigned CurrentState;
+  U32      Arg;
+  CMD_INFO CmdInfo;
 
-  r = _ExecSendStatus(pInst, pCardStatus);
-  if (r != 0) {
-    FS_DEBUG_ERROROUT((FS_MTYPE_DRIVER, "MMC_CM: _SelectCardIfRequired: Could not get card status."));
-    return r;
-  }
-  CurrentState = _GetCardCurrentState(pCardStatus);
-  if ((CurrentState == CARD_STATE_TRAN) ||
-      (CurrentState == CARD_STATE_RCV)  ||
-      (CurrentState == CARD_STATE_PRG)) {
-    return 0;             // Card already in Transfer state. Nothing to do.
+  FS_MEMSET(&CmdInfo, 0, sizeof(CmdInfo));
+  Arg = SectorIndex;
+  if (pInst->IsHighCapacity == 0u) {
+    Arg <<= BYTES_PER_SECTOR_SHIFT;     // Use the byte address for standard capacity cards (<= 2GB).
   }
-  r = _SelectCard(pInst, pCardStatus);
+  CmdInfo.Index = CMD_QUEUED_TASK_ADDRESS;
+  CmdInfo.Arg   = Arg;
+  r = _ExecCmdR1(pInst, &CmdInfo, pCardStatus, NUM_RETRIES_CMD);
+  FS_DEBUG_LOG((FS_MTYPE_DRIVER, "MMC_CM: QUEUED_TASK_ADDRESS SectorIndex: %lu, Res: %d\n", SectorIndex, r));
   return r;
 }
 
 /*********************************************************************
 *
-*       _SelectCardWithBusyWait
+*       _ExecSendQueueStatus
 *
 *  Function description
-*    Requests the card to move to Transfer state and waits for
-*    the card to become ready for data transfer.
-*/
-static int _SelectCardWithBusyWait(MMC_CM_INST * pInst, CARD_STATUS * pCardStatus) {
-  int      r;
+*    Reads the Queue Status Register (QSR) of the eMMC device.
+*
+*  Parameters
+*    pInst          Driver instance.
+*    pQSR           [OUT] Contents of the Queue Status Register.
+*                   Bit n is set to 1 if the task with the id n
+*                   is ready for execution.
+*
+*  Return value
+*    ==0    OK, queue status read.
+*    !=0    An error has occurred.
+*
+*  Additional information
+*    The SEND_STATUS (CMD13) command returns the contents of QSR
+*    instead of the card status when the SQS bit of the argument
+*    is set to 1. The response cannot be checked via _ExecCmdR1()
+*    because the bits of QSR have a different meaning than the bits
+*    of the card status.
+*/
+static int _ExecSendQueueStatus(MMC_CM_INST * pInst, U32 * pQSR) {
+  int         r;
+  int         NumRetries;
+  CMD_INFO    CmdInfo;
+  CARD_STATUS CardStatus;
 
-  r = _SelectCardIfRequired(pInst, pCardStatus);
-  if (r == 0) {
-    //
-    // OK, the card is selected. Wait for the card to become ready.
-    //
-    r = _WaitForCardReady(pInst, pCardStatus);
+  FS_MEMSET(&CmdInfo, 0, sizeof(CmdInfo));
+  CmdInfo.Index = CMD_SEND_STATUS;
+  CmdInfo.Arg   = ((U32)pInst->Rca << ARG_RCA_SHIFT) | (1uL << ARG_SEND_QSR_SHIFT);
+  NumRetries    = NUM_RETRIES_CMD;
+  for (;;) {
+    FS_MEMSET(&CardStatus, 0, sizeof(CardStatus));
+    _SendCmd(pInst, &CmdInfo, FS_MMC_RESPONSE_FORMAT_R1);
+    r = _GetResponse(pInst, &CardStatus, sizeof(CardStatus));
+    IF_STATS(pInst->StatCounters.CmdQStatusCnt++);
+    if (r == 0) {
+      *pQSR = FS_LoadU32BE(&CardStatus.aStatus[1]);
+      break;                // OK, queue status read.
+    }
+    if (_IsPresent(pInst) == 0) {
+      FS_DEBUG_WARN((FS_MTYPE_DRIVER, "MMC_CM: _ExecSendQueueStatus: The card has been removed."));
+      break;                // Error, the card has been removed.
+    }
+    if (NumRetries == 0) {
+      break;                // Error, could not read the queue status.
+    }
+    --NumRetries;
   }
+  FS_DEBUG_LOG((FS_MTYPE_DRIVER, "MMC_CM: SEND_STATUS QSR: 0x%08lx, Res: %d\n", (r == 0) ? *pQSR : 0uL, r));
   return r;
 }
 
 /*********************************************************************
 *
-*       _DeSelectCard
+*       _ExecExecuteTask
 *
 *  Function description
-*    Requests the card to move to Stand-by State.
+*    Transfers the data of a queued task via EXECUTE_READ_TASK (CMD46)
+*    or EXECUTE_WRITE_TASK (CMD47).
 *
-*  Return value
+*  Parameters
+*    pInst          Driver instance.
+*    TaskId         Id of the task to be executed.
+*    IsRead         Direction of the data transfer (1 - read, 0 - write).
+*    pTask          [IN] Parameters of the task.
+*    pCardStatus    [OUT] Contents of the status register.
+*
+*  Return value
+*    ==0    OK, data transferred.
+*    !=0    An error has occurred.
+*
+*  Additional information
+*    The task is removed from the queue of the card after the
+*    command is accepted. For this reason the command is not
+*    retried in case of an error.
+*/
+static int _ExecExecuteTask(MMC_CM_INST * pInst, unsigned TaskId, int IsRead, const CMDQ_TASK * pTask, CARD_STATUS * pCardStatus) {
+  int       r;
+  CMD_INFO  CmdInfo;
+  DATA_INFO DataInfo;
+#if FS_MMC_ENABLE_STATS
+  U32       TimeStart;
+#endif // FS_MMC_ENABLE_STATS
+
+  FS_MEMSET(&CmdInfo, 0, sizeof(CmdInfo));
+  FS_MEMSET(&DataInfo, 0, sizeof(DataInfo));
+  CmdInfo.Arg            = (U32)TaskId << ARG_TASK_ID_SHIFT;
+  DataInfo.BytesPerBlock = (U16)BYTES_PER_SECTOR;
+  DataInfo.NumBlocks     = pTask->NumSectors;
+  DataInfo.pBuffer       = pTask->pData;
+  CMD_TIME_START(TimeStart);
+  if (IsRead != 0) {
+    CmdInfo.Index = CMD_EXECUTE_READ_TASK;
+    r = _ExecCmdR1WithDataRead(pInst, &CmdInfo, &DataInfo, pCardStatus, 0);
+    CMD_TIME_END(pInst, TimeStart, ReadCmdCnt, ReadCmdTime, ReadCmdTimeMax);
+  } else {
+    CmdInfo.Index = CMD_EXECUTE_WRITE_TASK;
+    r = _ExecCmdR1WithDataWrite(pInst, &CmdInfo, &DataInfo, pCardStatus, 0);
+    CMD_TIME_END(pInst, TimeStart, WriteCmdCnt, WriteCmdTime, WriteCmdTimeMax);
+  }
+  FS_DEBUG_LOG((FS_MTYPE_DRIVER, "MMC_CM: EXECUTE_%s_TASK TaskId: %u, SectorIndex: %lu, NumSectors: %u, Res: %d\n", (IsRead != 0) ? "READ" : "WRITE",
+                                                                                                                  TaskId,
+                                                                                                                  pTask->SectorIndex,
+                                                                                                                  (unsigned)pTask->NumSectors,
+                                                                                                                  r));
+  return r;
+}
+
+/*********************************************************************
+*
+*       _ExecDiscardQueue
+*
+*  Function description
+*    Removes all the tasks from the queue of the eMMC device.
+*
+*  Parameters
+*    pInst          Driver instance.
+*    pCardStatus    [OUT] Contents of the status register.
+*
+*  Return value
+*    ==0    OK, queue is empty.
+*    !=0    An error has occurred.
+*/
+static int _ExecDiscardQueue(MMC_CM_INST * pInst, CARD_STATUS * pCardStatus) {
+  int      r;
+  CMD_INFO CmdInfo;
+
+  FS_MEMSET(&CmdInfo, 0, sizeof(CmdInfo));
+  CmdInfo.Index = CMD_CMDQ_TASK_MGMT;
+  CmdInfo.Flags = (U16)FS_MMC_CMD_FLAG_SETBUSY;
+  CmdInfo.Arg   = ARG_TM_OP_DISCARD_QUEUE;
+  r = _ExecCmdR1(pInst, &CmdInfo, pCardStatus, NUM_RETRIES_CMD);
+  IF_STATS(pInst->StatCounters.CmdQDiscardCnt++);
+  FS_DEBUG_LOG((FS_MTYPE_DRIVER, "MMC_CM: CMDQ_TASK_MGMT DISCARD_QUEUE Res: %d\n", r));
+  return r;
+}
+
+/*********************************************************************
+*
+*       _DisableCmdQIfRequired
+*
+*  Function description
+*    Disables the command queue mode of the eMMC device if active.
+*
+*  Parameters
+*    pInst          Driver instance.
+*    pCardStatus    [OUT] Contents of the status register.
+*
+*  Return value
+*    ==0    OK, the eMMC device accepts non-queued commands.
+*    !=0    An error has occurred.
+*
+*  Additional information
+*    Most of the commands that are not related to the command queue
+*    are rejected by the eMMC device while the command queue mode
+*    is enabled. This function has to be called before any of these
+*    commands is sent. The driver enables the command queue mode
+*    again on the next read or write request.
+*/
+static int _DisableCmdQIfRequired(MMC_CM_INST * pInst, CARD_STATUS * pCardStatus) {
+  int r;
+
+  r = 0;                            // Set to indicate success.
+  if (pInst->IsCmdQActive != 0u) {
+    r = _WaitForCardReady(pInst, pCardStatus);
+    if (r == 0) {
+      r = _WriteExtCSDByte(pInst, OFF_EXT_CSD_CMDQ_MODE_EN, 0, pCardStatus);      // 0 means that the command queue has to be disabled.
+      if (r == 0) {
+        pInst->IsCmdQActive = 0;
+      }
+    }
+    if (r != 0) {
+      FS_DEBUG_ERROROUT((FS_MTYPE_DRIVER, "MMC_CM: _DisableCmdQIfRequired: Could not disable command queue."));
+    }
+  }
+  return r;
+}
+
+/*********************************************************************
+*
+*       _IsCmdQEnabled
+*
+*  Function description
+*    Checks if the data of a request can be transferred via the command queue.
+*
+*  Parameters
+*    pInst          Driver instance.
+*    NumSectors     Number of sectors in the request.
+*    MaxBurst       Maximum number of sectors transferred by one task.
+*
+*  Return value
+*    !=0    Use the command queue.
+*    ==0    Use the regular read and write commands.
+*
+*  Additional information
+*    The command queue pays off only when the eMMC device can prepare
+*    the data of one task while the data of another task is transferred.
+*    A request that fits in one task, or that is shorter than
+*    FS_MMC_CMDQ_MIN_SECTORS, is transferred faster via
+*    READ_SINGLE_BLOCK / READ_MULTIPLE_BLOCK (CMD17 / CMD18) and
+*    WRITE_BLOCK / WRITE_MULTIPLE_BLOCK (CMD24 / CMD25) because it saves
+*    the QUEUED_TASK_PARAMS (CMD44), QUEUED_TASK_ADDRESS (CMD45) and
+*    the polling of the Queue Status Register.
+*/
+static int _IsCmdQEnabled(const MMC_CM_INST * pInst, U32 NumSectors, unsigned MaxBurst) {
+  int r;
+
+  r = 0;
+  if (pInst->IsCmdQAllowed != 0u) {
+    if (pInst->CmdQDepth > 1u) {
+      if ((NumSectors > MaxBurst) && (NumSectors >= (U32)FS_MMC_CMDQ_MIN_SECTORS)) {
+        r = 1;
+      }
+#if FS_MMC_SUPPORT_POWER_SAVE
+      //
+      // The eMMC device cannot be put to sleep while the command queue is enabled.
+      //
+      if (pInst->IsPowerSaveModeAllowed != 0u) {
+        r = 0;
+      }
+#endif // FS_MMC_SUPPORT_POWER_SAVE
+    }
+  }
+  return r;
+}
+
+#endif // FS_MMC_SUPPORT_CMDQ
+
+#if FS_MMC_SUPPORT_STREAMING
+
+/*********************************************************************
+*
+*       _CloseStreamIfRequired
+*
+*  Function description
+*    Waits for the card to finish a streaming write operation.
+*
+*  Parameters
+*    pInst          Driver instance.
+*    pCardStatus    [OUT] Contents of status register.
+*
+*  Return value
+*    ==0    OK, the card is ready and reports no errors.
+*    !=0    An error has occurred.
+*
+*  Additional information
+*    Each data transfer of a streaming write operation is ended via
+*    STOP_TRANSMISSION (CMD12) without waiting for the card to become
+*    ready. The card can still be programming the data when the next
+*    command has to be sent. This function has to be called before
+*    any command other than a WRITE_MULTIPLE_BLOCK (CMD25) that
+*    continues the streaming write operation is sent to the card.
+*    Errors that occurred while the card was programming the data
+*    are reported here.
+*/
+static int _CloseStreamIfRequired(MMC_CM_INST * pInst, CARD_STATUS * pCardStatus) {
+  int r;
+
+  r = 0;                            // Set to indicate success.
+  if (pInst->IsStreamOpen != 0u) {
+    pInst->IsStreamOpen = 0;
+    r = _ExecSendStatus(pInst, pCardStatus);
+    if (r <= 0) {
+      r = _WaitForCardReady(pInst, pCardStatus);
+    }
+    if (r != 0) {
+      FS_DEBUG_ERROROUT((FS_MTYPE_DRIVER, "MMC_CM: _CloseStreamIfRequired: Write operation failed before sector index %lu.", pInst->StreamSectorIndex));
+    }
+    IF_STATS(pInst->StatCounters.StreamCloseCnt++);
+  }
+  return r;
+}
+
+/*********************************************************************
+*
+*       _IsStreamExpired
+*
+*  Function description
+*    Checks if the open streaming write operation has been idle for too long.
+*
+*  Return value
+*    !=0    The streaming write operation has to be stopped.
+*    ==0    The streaming write operation can be continued.
+*/
+static int _IsStreamExpired(const MMC_CM_INST * pInst) {
+  U32 TimeIdle;
+  int r;
+
+  r        = 0;
+  TimeIdle = FS_X_OS_GetTime() - pInst->StreamTimeLastWrite;
+  if (TimeIdle > (U32)FS_MMC_STREAM_TIMEOUT) {
+    r = 1;
+  }
+  return r;
+}
+
+/*********************************************************************
+*
+*       _IsStreamingEnabled
+*
+*  Function description
+*    Checks if the write data can be sent using a streaming write operation.
+*
+*  Return value
+*    !=0    Streaming write operations are permitted.
+*    ==0    Each write request has to be performed using a separate command.
+*/
+static int _IsStreamingEnabled(const MMC_CM_INST * pInst) {
+  int r;
+
+  r = 0;
+  if (pInst->IsStreamingAllowed != 0u) {
+    if (pInst->pHWType->pfContinueWrite != NULL) {
+      //
+      // The card is not allowed to buffer the written data if the buffered write is disabled.
+      // The device cannot be put to sleep while it is programming data.
+      // A reliable write has to be announced via SET_BLOCK_COUNT (CMD23) before each
+      // write command. The streaming write operation does not send this command.
+      //
+      if ((pInst->IsBufferedWriteAllowed != 0u) && (pInst->IsReliableWriteActive == 0u)) {
+        r = 1;
+#if FS_MMC_SUPPORT_POWER_SAVE
+        if (pInst->IsPowerSaveModeAllowed != 0u) {
+          r = 0;
+        }
+#endif // FS_MMC_SUPPORT_POWER_SAVE
+      }
+    }
+  }
+  return r;
+}
+
+#endif // FS_MMC_SUPPORT_STREAMING
+
+/*********************************************************************
+*
+*       _SelectCard
+*
+*  Function description
+*    Requests the card to move to Transfer state.
+*/
+static int _SelectCard(MMC_CM_INST * pInst, CARD_STATUS * pCardStatus) {
+  int      r;
+  unsigned rca;
+  unsigned TimeOut;
+
+  rca = pInst->Rca;
+  //
+  // Try to select the card.
+  //
+  TimeOut = FS_MMC_SELECT_CARD_TIMEOUT;
+  for (;;) {
+    //
+    // Quit the waiting loop if the card has been removed.
+    //
+    r = _IsPresent(pInst);
+    if (r == 0) {
+      FS_DEBUG_WARN((FS_MTYPE_DRIVER, "MMC_CM: _SelectCard: Card has been removed."));
+      r = 1;
+      pInst->HasError = 1;
+      break;          // Error, card has been removed.
+    }
+    r = _ExecSelectCard(pInst, rca, pCardStatus);
+    if (r == 0) {
+      break;          // OK, the card selected.
+    }
+    if (TimeOut == 0u) {
+      FS_DEBUG_ERROROUT((FS_MTYPE_DRIVER, "MMC_CM: _SelectCard: Timeout expired."));
+      break;          // Error, could not select card.
+    }
+    --TimeOut;
+  }
+  return r;
+}
+
+#if FS_MMC_SUPPORT_SD
+
+/*********************************************************************
+*
+*       _WaitForEraseIfRequired
+*
+*  Function description
+*    Waits for the SD card to finish an erase operation started
+*    by a free sector request.
+*
+*  Parameters
+*    pInst          Driver instance.
+*    pCardStatus    [OUT] Card status.
+*
+*  Return value
+*    ==0    OK, no erase operation in progress.
+*    !=0    An error occurred.
+*/
+static int _WaitForEraseIfRequired(MMC_CM_INST * pInst, CARD_STATUS * pCardStatus) {
+  int r;
+
+  r = 0;
+  if (pInst->IsErasePending != 0u) {
+    pInst->IsErasePending = 0;
+    FS_MEMSET(pCardStatus, 0, sizeof(*pCardStatus));
+    r = _WaitForCardState(pInst, pCardStatus, CARD_STATE_TRAN);
+    if (r != 0) {
+      FS_DEBUG_ERROROUT((FS_MTYPE_DRIVER, "MMC_CM: _WaitForEraseIfRequired: Erase operation failed."));
+    }
+  }
+  return r;
+}
+
+#endif // FS_MMC_SUPPORT_SD
+
+/*********************************************************************
+*
+*       _SelectCardIfRequired
+*
+*  Function description
+*    Checks the card status and requests the card to move to Transfer state
+*    if the card is in a different state.
+*
+*  Return value
+*    ==0        OK, card is in Transfer state.
+*    !=0        An error occurred.
+*/
+static int _SelectCardIfRequired(MMC_CM_INST * pInst, CARD_STATUS * pCardStatus) {
+  int      r;
+  unsigned CurrentState;
+
+#if FS_MMC_SUPPORT_STREAMING
+  r = _CloseStreamIfRequired(pInst, pCardStatus);
+  if (r != 0) {
+    return r;
+  }
+#endif // FS_MMC_SUPPORT_STREAMING
+#if FS_MMC_SUPPORT_CMDQ
+  r = _DisableCmdQIfRequired(pInst, pCardStatus);
+  if (r != 0) {
+    return r;
+  }
+#endif // FS_MMC_SUPPORT_CMDQ
+#if FS_MMC_SUPPORT_SD
+  r = _WaitForEraseIfRequired(pInst, pCardStatus);
+  if (r != 0) {
+    return r;
+  }
+#endif // FS_MMC_SUPPORT_SD
+  r = _ExecSendStatus(pInst, pCardStatus);
+  if (r != 0) {
+    FS_DEBUG_ERROROUT((FS_MTYPE_DRIVER, "MMC_CM: _SelectCardIfRequired: Could not get card status."));
+    return r;
+  }
+  CurrentState = _GetCardCurrentState(pCardStatus);
+  if ((CurrentState == CARD_STATE_TRAN) ||
+      (CurrentState == CARD_STATE_RCV)  ||
+      (CurrentState == CARD_STATE_PRG)) {
+    return 0;             // Card already in Transfer state. Nothing to do.
+  }
+  r = _SelectCard(pInst, pCardStatus);
+  return r;
+}
+
+/*********************************************************************
+*
+*       _SelectCardWithBusyWait
+*
+*  Function description
+*    Requests the card to move to Transfer state and waits for
+*    the card to become ready for data transfer.
+*/
+static int _SelectCardWithBusyWait(MMC_CM_INST * pInst, CARD_STATUS * pCardStatus) {
+  int      r;
+
+  r = _SelectCardIfRequired(pInst, pCardStatus);
+  if (r == 0) {
+    //
+    // OK, the card is selected. Wait for the card to become ready.
+    //
+    r = _WaitForCardReady(pInst, pCardStatus);
+  }
+  return r;
+}
+
+/*********************************************************************
+*
+*       _DeSelectCard
+*
+*  Function description
+*    Requests the card to move to Stand-by State.
+*
+*  Return value
 *    ==0        OK, card is in Stand-by State
 *    !=0        An error occurred
 */
@@ -5043,15 +5794,102 @@ static int _EraseMMC(MMC_CM_INST * pInst, U32 StartSector, U32 NumSectors, int M
 
 #endif  // FS_MMC_SUPPORT_MMC
 
+#if FS_MMC_SUPPORT_SD
+
+/*********************************************************************
+*
+*      _EraseSD
+*
+*  Function description
+*    Erases the contents of the specified sectors on an SD card.
+*
+*  Parameters
+*    pInst          Driver instance.
+*    StartSector    Index of the first sector to be erased.
+*    NumSectors     Number of sectors to be erased.
+*    IsBusyWait     Specifies if the function has to wait for the erase operation to finish.
+*    pCardStatus    [OUT] Card status.
+*
+*  Return value
+*    ==0      OK, sectors erased or nothing to erase.
+*    !=0      An error occurred.
+*
+*  Additional information
+*    SD cards with ERASE_BLK_EN set to 1 in the CSD register erase
+*    in units of write blocks. All the other SD cards erase whole
+*    erase sectors (SECTOR_SIZE in the CSD register) including
+*    the sectors outside of the requested range. The range is trimmed
+*    inward to whole erase sectors for these cards so that the data
+*    of the neighboring sectors is preserved. Nothing is erased
+*    if the range does not contain a complete erase sector.
+*
+*    With IsBusyWait set to 0, the function returns after the erase
+*    operation is started. _SelectCardIfRequired() waits for the
+*    erase operation to finish before the next data transfer.
+*/
+static int _EraseSD(MMC_CM_INST * pInst, U32 StartSector, U32 NumSectors, int IsBusyWait, CARD_STATUS * pCardStatus) {
+  U32 StartAddr;
+  U32 EndAddr;
+  U32 NumSectorsErase;
+  int r;
+
+  //
+  // Determine the range of sectors to be erased.
+  //
+  StartAddr       = StartSector;
+  EndAddr         = StartSector + NumSectors;                           // Index of the first sector after the range.
+  NumSectorsErase = pInst->NumSectorsErase;
+  if (NumSectorsErase > 1u) {
+    StartAddr = ((StartAddr + NumSectorsErase - 1u) / NumSectorsErase) * NumSectorsErase;
+    EndAddr   = (EndAddr / NumSectorsErase) * NumSectorsErase;
+    if (EndAddr <= StartAddr) {
+      return 0;       // OK, the range does not contain a complete erase sector.
+    }
+  }
+  --EndAddr;
+  //
+  // Set the start address of the block to be erased.
+  //
+  r = _ExecEraseWrBlkStart(pInst, StartAddr, pCardStatus);
+  if (r != 0) {
+    return 1;         // Error, invalid response or card reports error.
+  }
+  //
+  // Set the end address of the block to be erased.
+  //
+  r = _ExecEraseWrBlkEnd(pInst, EndAddr, pCardStatus);
+  if (r != 0) {
+    return 1;         // Error, invalid response or card reports error.
+  }
+  //
+  // Start the erase operation.
+  //
+  r = _ExecEraseSD(pInst, IsBusyWait, pCardStatus);
+  if (r != 0) {
+    return 1;         // Error, invalid response or card reports error.
+  }
+  if (IsBusyWait == 0) {
+    pInst->IsErasePending = 1;
+    return 0;         // OK, erase operation started.
+  }
+  //
+  // Wait for the erase operation to finish. The HW layer should block while the D0 data line is 0.
+  //
+  r = _ExecSendStatus(pInst, pCardStatus);
+  if (r != 0) {
+    return 1;         // Error, invalid response or card reports error.
+  }
+  return 0;           // OK, sectors erased.
+}
+
+#endif  // FS_MMC_SUPPORT_SD
+
 /*********************************************************************
 *
 *      _Erase
 *
 *  Function description
 *    Erases sector contents.
-*
-*  Notes
-*     (1) SD cards are not supported yet.
 */
 static int _Erase(MMC_CM_INST * pInst, U32 StartSector, U32 NumSectors, CARD_STATUS * pCardStatus) {      //lint -efunc(818, _Erase) Pointer parameter 'pInst' could be declared as pointing to const. Rationale: the driver instance has to be writtable when the support for MMC devices is enabled.
   int r;
@@ -5061,11 +5899,7 @@ static int _Erase(MMC_CM_INST * pInst, U32 StartSector, U32 NumSectors, CARD_STA
   switch (CardType) {
 #if FS_MMC_SUPPORT_SD
   case FS_MMC_CARD_TYPE_SD:
-    FS_USE_PARA(StartSector);
-    FS_USE_PARA(NumSectors);
-    FS_USE_PARA(pCardStatus);
-    FS_DEBUG_ERROROUT((FS_MTYPE_DRIVER, "MMC_CM: _Erase: Operation not supported for SD cards."));
-    r = 1;        // Error, this operation not supported for SD cards, yet.
+    r = _EraseSD(pInst, StartSector, NumSectors, 1, pCardStatus);        // 1 means wait for the erase operation to finish.
     break;
 #endif  // FS_MMC_SUPPORT_SD
 #if FS_MMC_SUPPORT_MMC
@@ -5182,8 +6016,13 @@ static int _ApplyPara(MMC_CM_INST * pInst, const CSD_RESPONSE * pCSD, const U8 *
   U16      TimeValue;
   int      IsReliableWriteActive;
   int      IsCloseEndedRWSupported;
+  int      IsErasedValueZero;
   unsigned ClkFlags;
   unsigned AccessMode;
+#if FS_MMC_SUPPORT_SD
+  U32      NumSectorsErase;
+  unsigned ldBytesPerBlock;
+#endif // FS_MMC_SUPPORT_SD
 
   CardType         = (int)pInst->CardType;
   IsHighCapacity   = (int)pInst->IsHighCapacity;
@@ -5345,12 +6184,49 @@ static int _ApplyPara(MMC_CM_INST * pInst, const CSD_RESPONSE * pCSD, const U8 *
     }
   }
   //
+  // Check the value the storage device returns when reading erased or trimmed sectors.
+  // It is stored in the SCR register of SD cards and in the EXT_CSD register of MMC devices.
+  // The value is treated as unknown if the register is not available.
+  //
+  IsErasedValueZero = 0;
+  if (CardType == FS_MMC_CARD_TYPE_SD) {
+#if FS_MMC_SUPPORT_SD
+    //
+    // SD cards that cannot erase single write blocks erase in units of SECTOR_SIZE write blocks.
+    // The driver erases only the complete units of a free sector request. The sectors at the
+    // boundaries of the request keep their contents which means that the free sectors
+    // are not guaranteed to read back as 0.
+    //
+    NumSectorsErase = 1;
+    if (CSD_ERASE_BLK_EN(pCSD) == 0u) {
+      NumSectorsErase = CSD_SECTOR_SIZE(pCSD) + 1u;                     // In units of write blocks.
+      ldBytesPerBlock = (unsigned)CSD_WRITE_BL_LEN(pCSD);
+      if (ldBytesPerBlock > BYTES_PER_SECTOR_SHIFT) {
+        NumSectorsErase <<= ldBytesPerBlock - BYTES_PER_SECTOR_SHIFT;
+      }
+    }
+    pInst->NumSectorsErase = (U16)NumSectorsErase;
+    if ((pSCR != NULL) && (NumSectorsErase == 1u)) {
+      if (SCR_DATA_STAT_AFTER_ERASE(pSCR) == 0u) {
+        IsErasedValueZero = 1;
+      }
+    }
+#endif // FS_MMC_SUPPORT_SD
+  } else {
+    if (pExtCSD != NULL) {
+      if (pExtCSD[OFF_EXT_CSD_ERASED_MEM_CONT] == 0u) {
+        IsErasedValueZero = 1;
+      }
+    }
+  }
+  //
   // Store calculated values to driver instance.
   //
   pInst->IsWriteProtected        = (U8)IsWriteProtected;
   pInst->NumSectors              = NumSectors;
   pInst->IsReliableWriteActive   = (U8)IsReliableWriteActive;
   pInst->IsCloseEndedRWSupported = (U8)IsCloseEndedRWSupported;
+  pInst->IsErasedValueZero       = (U8)IsErasedValueZero;
   return r;
 }
 
@@ -5650,24 +6526,63 @@ static int _DisableCacheIfRequired(MMC_CM_INST * pInst, CARD_STATUS * pCardStatu
   int CardType;
   int IsCacheActivationAllowed;
 
-  r                        = 0;                      // Set to indicate success.
-  IsCacheActivationAllowed = (int)pInst->IsCacheActivationAllowed;
-  IsCacheEnabled           = (int)pInst->IsCacheEnabled;
-  if (IsCacheActivationAllowed != 0) {
-    if (IsCacheEnabled != 0) {
-      CardType = (int)pInst->CardType;
-      if (CardType == FS_MMC_CARD_TYPE_MMC) {
-        r = _WriteExtCSDByte(pInst, OFF_EXT_CSD_CACHE_CTRL, 0, pCardStatus);      // 0 means that the cache has to be disabled.
-        if (r == 0) {
-          IsCacheEnabled = 0;
-        }
+  r                        = 0;                      // Set to indicate success.
+  IsCacheActivationAllowed = (int)pInst->IsCacheActivationAllowed;
+  IsCacheEnabled           = (int)pInst->IsCacheEnabled;
+  if (IsCacheActivationAllowed != 0) {
+    if (IsCacheEnabled != 0) {
+      CardType = (int)pInst->CardType;
+      if (CardType == FS_MMC_CARD_TYPE_MMC) {
+        r = _WriteExtCSDByte(pInst, OFF_EXT_CSD_CACHE_CTRL, 0, pCardStatus);      // 0 means that the cache has to be disabled.
+        if (r == 0) {
+          IsCacheEnabled = 0;
+        }
+      }
+    }
+  }
+  pInst->IsCacheEnabled = (U8)IsCacheEnabled;
+  return r;
+}
+
+#if FS_MMC_SUPPORT_CMDQ
+
+/*********************************************************************
+*
+*       _ApplyCmdQSupport
+*
+*  Function description
+*    Determines if the eMMC device supports the command queue.
+*
+*  Parameters
+*    pInst        Driver instance.
+*    pExtCSD      [IN] Contents of the extended CSD register.
+*
+*  Additional information
+*    The number of tasks used by the driver is limited to
+*    FS_MMC_CMDQ_MAX_DEPTH. The command queue is not enabled here.
+*    This is done on the first read or write request.
+*/
+static void _ApplyCmdQSupport(MMC_CM_INST * pInst, const U8 * pExtCSD) {
+  unsigned Depth;
+  int      CardType;
+
+  Depth    = 0;
+  CardType = (int)pInst->CardType;
+  if (CardType == FS_MMC_CARD_TYPE_MMC) {
+    if (pExtCSD != NULL) {
+      if ((*(pExtCSD + OFF_EXT_CSD_CMDQ_SUPPORT) & 1u) != 0u) {
+        Depth  = *(pExtCSD + OFF_EXT_CSD_CMDQ_DEPTH) & EXT_CSD_CMDQ_DEPTH_MASK;
+        Depth += 1u;                  // The register stores the number of tasks minus 1.
+        Depth  = SEGGER_MIN(Depth, (unsigned)FS_MMC_CMDQ_MAX_DEPTH);
       }
     }
   }
-  pInst->IsCacheEnabled = (U8)IsCacheEnabled;
-  return r;
+  FS_DEBUG_LOG((FS_MTYPE_DRIVER, "MMC_CM: CMDQ Depth: %u\n", Depth));
+  pInst->CmdQDepth = (U8)Depth;
 }
 
+#endif // FS_MMC_SUPPORT_CMDQ
+
 #endif // FS_MMC_SUPPORT_MMC
 
 #if FS_MMC_SUPPORT_SD
@@ -6935,6 +7850,10 @@ static int _Init(MMC_CM_INST * pInst) {
 #endif // FS_MMC_SUPPORT_MMC
   IsVoltageSwitchError    = 0;
 #endif // FS_MMC_SUPPORT_UHS
+#if FS_MMC_SUPPORT_CMDQ
+  pInst->IsCmdQActive = 0;          // The command queue mode is disabled when the eMMC device is reset.
+  pInst->CmdQDepth    = 0;
+#endif // FS_MMC_SUPPORT_CMDQ
   for (;;) {
     FREE_BUFFER(&pExtCSD);          // Make sure that the read buffer is free for the following operations.
     if (NumRetries-- == 0) {
@@ -6955,6 +7874,9 @@ static int _Init(MMC_CM_INST * pInst) {
     pInst->MaxWriteBurstFill   = _GetMaxWriteBurstFill(pInst);
     pInst->MaxReadBurst        = _GetMaxReadBurst(pInst);
     pInst->IsHighCapacity      = 0;
+#if FS_MMC_SUPPORT_SD
+    pInst->IsErasePending      = 0;
+#endif // FS_MMC_SUPPORT_SD
     _InitHWIfRequired(pInst);
     IsPresent = _IsPresent(pInst);
     if (IsPresent == 0) {
@@ -7286,6 +8208,9 @@ static int _Init(MMC_CM_INST * pInst) {
     // Enable the cache of MMC devices to improve performance.
     //
     r = _EnableCacheIfRequired(pInst, (U8 *)pExtCSD, &CardStatus);
+#if FS_MMC_SUPPORT_CMDQ
+    _ApplyCmdQSupport(pInst, (U8 *)pExtCSD);
+#endif // FS_MMC_SUPPORT_CMDQ
     FREE_BUFFER(&pExtCSD);              // After this point, the information stored in the EXT_CSD register is not required anymore.
     if (r != 0) {
       r = 1;
@@ -7462,6 +8387,184 @@ static int _PrepareReadMultiple(MMC_CM_INST * pInst, U32 NumSectors, int * pIsRe
   return r;
 }
 
+#if FS_MMC_SUPPORT_CMDQ
+
+/*********************************************************************
+*
+*       _EnableCmdQIfRequired
+*
+*  Function description
+*    Enables the command queue mode of the eMMC device if not active.
+*
+*  Parameters
+*    pInst          Driver instance.
+*    pCardStatus    [OUT] Contents of the status register.
+*
+*  Return value
+*    ==0    OK, the eMMC device accepts queued tasks.
+*    !=0    An error has occurred.
+*/
+static int _EnableCmdQIfRequired(MMC_CM_INST * pInst, CARD_STATUS * pCardStatus) {
+  int r;
+
+  r = 0;                            // Set to indicate success.
+  if (pInst->IsCmdQActive == 0u) {
+    r = _SelectCardWithBusyWait(pInst, pCardStatus);
+    if (r == 0) {
+      r = _WriteExtCSDByte(pInst, OFF_EXT_CSD_CMDQ_MODE_EN, 1, pCardStatus);      // 1 means that the command queue has to be enabled.
+      if (r == 0) {
+        r = _WaitForCardReady(pInst, pCardStatus);
+        if (r == 0) {
+          pInst->IsCmdQActive = 1;
+        }
+      }
+    }
+    if (r != 0) {
+      FS_DEBUG_ERROROUT((FS_MTYPE_DRIVER, "MMC_CM: _EnableCmdQIfRequired: Could not enable command queue."));
+    }
+  }
+  return r;
+}
+
+/*********************************************************************
+*
+*       _TransferSectorsQueued
+*
+*  Function description
+*    Transfers sector data via the command queue of the eMMC device.
+*
+*  Parameters
+*    pInst          Driver instance.
+*    SectorIndex    Index of the first sector to be transferred.
+*    pData          [IN/OUT] Sector data.
+*    NumSectors     Number of sectors to be transferred.
+*    IsRead         Direction of the data transfer (1 - read, 0 - write).
+*    MaxBurst       Maximum number of sectors transferred by one task.
+*
+*  Return value
+*    ==0    OK, sector data transferred.
+*    !=0    An error has occurred.
+*
+*  Additional information
+*    The request is split in tasks of at most MaxBurst sectors.
+*    The function queues as many tasks as the eMMC device can hold
+*    via QUEUED_TASK_PARAMS (CMD44) and QUEUED_TASK_ADDRESS (CMD45)
+*    and then polls the Queue Status Register until the device reports
+*    a task as ready for execution. The device is free to process the
+*    queued tasks in any order. This gives it the possibility
+*    to prepare the data of the next task while the data of the
+*    current task is transferred. A new task is queued each time
+*    a task has been executed.
+*
+*    All the queued tasks are discarded in case of an error.
+*    The caller repeats the operation using the regular commands.
+*/
+static int _TransferSectorsQueued(MMC_CM_INST * pInst, U32 SectorIndex, void * pData, U32 NumSectors, int IsRead, unsigned MaxBurst) {
+  int           r;
+  CARD_STATUS   CardStatus;
+  U8          * pData8;
+  U32           NumSectorsAtOnce;
+  U32           QSR;
+  U32           TimeOut;
+  unsigned      Depth;
+  unsigned      TaskId;
+  unsigned      NumTasksQueued;
+  CMDQ_TASK   * pTask;
+
+  FS_MEMSET(&CardStatus, 0, sizeof(CardStatus));
+  FS_MEMSET(pInst->aCmdQTask, 0, sizeof(pInst->aCmdQTask));
+  pData8         = SEGGER_PTR2PTR(U8, pData);
+  Depth          = pInst->CmdQDepth;
+  NumTasksQueued = 0;
+  TimeOut        = FS_MMC_WAIT_READY_TIMEOUT;
+  MaxBurst       = SEGGER_MIN(MaxBurst, ARG_TASK_NUM_BLOCKS_MASK);
+  r = _EnableCmdQIfRequired(pInst, &CardStatus);
+  if (r == 0) {
+    for (;;) {
+      //
+      // Fill the queue of the eMMC device.
+      //
+      TaskId = 0;
+      while ((NumSectors != 0u) && (NumTasksQueued < Depth)) {
+        while (pInst->aCmdQTask[TaskId].NumSectors != 0u) {
+          ++TaskId;                   // Look for a task id that is not in use.
+        }
+        NumSectorsAtOnce = SEGGER_MIN(NumSectors, MaxBurst);
+        r = _ExecQueuedTaskParams(pInst, TaskId, IsRead, NumSectorsAtOnce, &CardStatus);
+        if (r == 0) {
+          r = _ExecQueuedTaskAddress(pInst, SectorIndex, &CardStatus);
+        }
+        if (r != 0) {
+          break;                      // Error, could not queue task.
+        }
+        pTask = &pInst->aCmdQTask[TaskId];
+        pTask->pData       = pData8;
+        pTask->SectorIndex = SectorIndex;
+        pTask->NumSectors  = (U16)NumSectorsAtOnce;
+        ++NumTasksQueued;
+        NumSectors  -= NumSectorsAtOnce;
+        SectorIndex += NumSectorsAtOnce;
+        pData8      += NumSectorsAtOnce << BYTES_PER_SECTOR_SHIFT;
+        IF_STATS(pInst->StatCounters.CmdQTaskCnt++);
+        IF_STATS(pInst->StatCounters.CmdQDepthMax = SEGGER_MAX(pInst->StatCounters.CmdQDepthMax, NumTasksQueued));
+      }
+      if ((r != 0) || (NumTasksQueued == 0u)) {
+        break;                        // Error or all the tasks executed.
+      }
+      //
+      // Wait for the eMMC device to report a task as ready for execution.
+      //
+      r = _ExecSendQueueStatus(pInst, &QSR);
+      if (r != 0) {
+        break;                        // Error, could not read the queue status.
+      }
+      for (TaskId = 0; TaskId < Depth; ++TaskId) {
+        if (((QSR & (1uL << TaskId)) != 0u) && (pInst->aCmdQTask[TaskId].NumSectors != 0u)) {
+          break;
+        }
+      }
+      if (TaskId == Depth) {
+        if (TimeOut == 0u) {
+          FS_DEBUG_ERROROUT((FS_MTYPE_DRIVER, "MMC_CM: _TransferSectorsQueued: Timeout expired."));
+          r = 1;
+          break;                      // Error, no task became ready.
+        }
+        --TimeOut;
+        continue;
+      }
+      TimeOut = FS_MMC_WAIT_READY_TIMEOUT;
+      //
+      // Transfer the data of the task that is ready for execution.
+      //
+      r = _WaitForCardReady(pInst, &CardStatus);
+      if (r != 0) {
+        break;                        // Error, card reports busy.
+      }
+      pTask = &pInst->aCmdQTask[TaskId];
+      r = _ExecExecuteTask(pInst, TaskId, IsRead, pTask, &CardStatus);
+      if (r != 0) {
+        FS_DEBUG_ERROROUT((FS_MTYPE_DRIVER, "MMC_CM: _TransferSectorsQueued: Could not transfer %u sector(s) at sector index %lu.", (unsigned)pTask->NumSectors, pTask->SectorIndex));
+        break;                        // Error, could not transfer data.
+      }
+      pTask->NumSectors = 0;
+      --NumTasksQueued;
+      if (IsRead == 0) {
+        //
+        // Make sure that the ready status is read again from the eMMC device before the next data transfer.
+        //
+        FS_MEMSET(&CardStatus, 0, sizeof(CardStatus));
+      }
+    }
+    if ((r != 0) && (NumTasksQueued != 0u)) {
+      (void)_ExecDiscardQueue(pInst, &CardStatus);
+      FS_MEMSET(pInst->aCmdQTask, 0, sizeof(pInst->aCmdQTask));
+    }
+  }
+  return r;
+}
+
+#endif // FS_MMC_SUPPORT_CMDQ
+
 /*********************************************************************
 *
 *       _ReadSectors
@@ -7552,15 +8655,29 @@ static int _ReadSectorsWithRetry(MMC_CM_INST * pInst, U32 SectorIndex, U8 * pBuf
   int      r;
   int      NumRetries;
   unsigned MaxReadBurst;
+#if FS_MMC_SUPPORT_CMDQ
+  int      IsCmdQUsed;
+#endif // FS_MMC_SUPPORT_CMDQ
 
   r            = 1;             // Set to indicate an error.
   MaxReadBurst = pInst->MaxReadBurst;
   NumRetries   = FS_MMC_NUM_RETRIES;
+#if FS_MMC_SUPPORT_CMDQ
+  IsCmdQUsed   = _IsCmdQEnabled(pInst, NumSectors, MaxReadBurst);
+#endif // FS_MMC_SUPPORT_CMDQ
   for (;;) {
     if (pInst->HasError != 0u) {
       break;
     }
+#if FS_MMC_SUPPORT_CMDQ
+    if (IsCmdQUsed != 0) {
+      r = _TransferSectorsQueued(pInst, SectorIndex, pBuffer, NumSectors, 1, MaxReadBurst);
+    } else {
+      r = _ReadSectors(pInst, SectorIndex, pBuffer, NumSectors, MaxReadBurst);
+    }
+#else
     r = _ReadSectors(pInst, SectorIndex, pBuffer, NumSectors, MaxReadBurst);
+#endif // FS_MMC_SUPPORT_CMDQ
     if (r == 0) {
       IF_STATS(pInst->StatCounters.ReadSectorCnt += NumSectors);
       break;                    // OK, data read
@@ -7569,6 +8686,12 @@ static int _ReadSectorsWithRetry(MMC_CM_INST * pInst, U32 SectorIndex, U8 * pBuf
       break;                    // An error occurred and maximum number of retries has been reached.
     }
     --NumRetries;
+#if FS_MMC_SUPPORT_CMDQ
+    if (IsCmdQUsed != 0) {
+      FS_DEBUG_WARN((FS_MTYPE_DRIVER, "MMC_CM: _ReadSectorsWithRetry: Falling back to non-queued read mode."));
+      IsCmdQUsed = 0;           // Fall back to regular read commands.
+    }
+#endif // FS_MMC_SUPPORT_CMDQ
     if (MaxReadBurst != 1u) {
       FS_DEBUG_WARN((FS_MTYPE_DRIVER, "MMC_CM: _ReadSectorsWithRetry: Falling back to single sector read mode."));
       MaxReadBurst = 1;         // Fall back to single sector read.
@@ -7694,6 +8817,170 @@ static int _WriteSectors(MMC_CM_INST * pInst, U32 SectorIndex, const void * pDat
   return r;
 }
 
+#if FS_MMC_SUPPORT_STREAMING
+
+/*********************************************************************
+*
+*       _StopStreamTransfer
+*
+*  Function description
+*    Ends the data transfer of a streaming write operation without
+*    waiting for the card to finish programming.
+*
+*  Parameters
+*    pInst          Driver instance.
+*    pCardStatus    [OUT] Contents of status register.
+*
+*  Return value
+*    ==0    OK, command executed successfully.
+*    !=0    An error has occurred.
+*
+*  Additional information
+*    Same as _ExecStopTransmission() except that FS_MMC_CMD_FLAG_SETBUSY
+*    is not set. The card signals busy on DAT0 until the data is
+*    programmed. The hardware layer waits for the busy signal to be
+*    released before it sends the next WRITE_MULTIPLE_BLOCK (CMD25)
+*    via pfContinueWrite. All other commands are preceded by a call
+*    to _CloseStreamIfRequired().
+*/
+static int _StopStreamTransfer(MMC_CM_INST * pInst, CARD_STATUS * pCardStatus) {
+  int      r;
+  CMD_INFO CmdInfo;
+  unsigned NextStateMask;
+#if FS_MMC_ENABLE_STATS
+  U32      TimeStart;
+#endif // FS_MMC_ENABLE_STATS
+
+  FS_MEMSET(&CmdInfo, 0, sizeof(CmdInfo));
+  NextStateMask = 0u
+                | (1u << CARD_STATE_TRAN)
+                | (1u << CARD_STATE_PRG)
+                ;
+  CmdInfo.Index         = CMD_STOP_TRANSMISSION;
+  CmdInfo.Flags         = (U16)FS_MMC_CMD_FLAG_STOP_TRANS;
+  CmdInfo.NextStateMask = (U16)NextStateMask;
+  CMD_TIME_START(TimeStart);
+  r = _ExecCmdR1WithStateTransition(pInst, &CmdInfo, pCardStatus);
+  CMD_TIME_END(pInst, TimeStart, StopCmdCnt, StopCmdTime, StopCmdTimeMax);
+  FS_DEBUG_LOG((FS_MTYPE_DRIVER, "MMC_CM: STOP_TRANSMISSION (stream) Res: %d\n", r));
+  return r;
+}
+
+/*********************************************************************
+*
+*       _WriteSectorsStream
+*
+*  Function description
+*    Writes the specified number of sectors to SD/MMC card without
+*    waiting for the card to finish programming the data.
+*
+*  Parameters
+*    pInst          Driver instance.
+*    SectorIndex    Index of the first sector to be written.
+*    pData          [IN] Sector data.
+*    NumSectors     Number of sectors to be written.
+*    MaxWriteBurst  Maximum number of sectors to be sent at once.
+*
+*  Return value
+*    ==0    OK, sector data sent to card.
+*    !=0    An error has occurred.
+*
+*  Additional information
+*    Each burst is sent via a WRITE_MULTIPLE_BLOCK (CMD25) command
+*    followed by a STOP_TRANSMISSION (CMD12) that does not wait for
+*    the card to become ready. The command and the data are sent
+*    via the pfContinueWrite function of the hardware layer which
+*    waits for the card to release the busy signal on DAT0 before
+*    it sends the command. Only the first write request of a stream
+*    pays for the SEND_STATUS (CMD13) commands that check if the card
+*    is in Transfer state and ready. The following contiguous write
+*    requests do not send any command other than CMD25 and CMD12,
+*    and the CPU does not wait for the card to program the last
+*    burst before the function returns.
+*
+*    The stream is closed via _CloseStreamIfRequired() when the
+*    sector index of a write request does not follow the last written
+*    sector, when the stream has been idle for more than
+*    FS_MMC_STREAM_TIMEOUT milliseconds, when the file system requests
+*    a synchronization via FS_CMD_SYNC or when any other command has
+*    to be sent to card. Closing waits for the card to become ready
+*    and reports errors that occurred while the card was programming.
+*
+*    The time-out is lazy: it is evaluated only on the next write
+*    request. Nothing closes an idle stream by itself, so errors
+*    that occur while programming the last burst are reported on
+*    the next access, FS_CMD_SYNC or an unmount.
+*
+*    Streaming is not used while reliable write is active, because
+*    a reliable write has to be announced via CMD23.
+*/
+static int _WriteSectorsStream(MMC_CM_INST * pInst, U32 SectorIndex, const void * pData, U32 NumSectors, unsigned MaxWriteBurst) {
+  int           r;
+  CARD_STATUS   CardStatus;
+  const U8    * pData8;
+  U32           NumSectorsAtOnce;
+#if FS_MMC_ENABLE_STATS
+  U32           TimeStart;
+#endif // FS_MMC_ENABLE_STATS
+
+  FS_MEMSET(&CardStatus, 0, sizeof(CardStatus));
+  pData8 = SEGGER_CONSTPTR2PTR(const U8, pData);
+  r      = 0;                     // Set to indicate success.
+  //
+  // Close the stream if the data does not follow the last written sector
+  // or if the card waited too long for data.
+  //
+  if (pInst->IsStreamOpen != 0u) {
+    if ((SectorIndex != pInst->StreamSectorIndex) || (_IsStreamExpired(pInst) != 0)) {
+      r = _CloseStreamIfRequired(pInst, &CardStatus);
+    }
+  }
+  if (r == 0) {
+    if (pInst->IsStreamOpen == 0u) {
+      //
+      // Start a new stream. The card has to be in Transfer state and ready to accept data.
+      //
+      r = _SelectCardWithBusyWait(pInst, &CardStatus);
+      IF_STATS(pInst->StatCounters.StreamOpenCnt++);
+    } else {
+      IF_STATS(pInst->StatCounters.StreamSectorCnt += NumSectors);
+    }
+  }
+  if (r == 0) {
+    //
+    // Stay in this loop until all the sector data is written or an error occurs.
+    //
+    do {
+      NumSectorsAtOnce = SEGGER_MIN(NumSectors, MaxWriteBurst);
+      pInst->IsStreamOpen = 1;      // The card can be busy from now on.
+      CMD_TIME_START(TimeStart);
+      r = _ContinueWrite(pInst, SectorIndex, pData8, NumSectorsAtOnce);
+      CMD_TIME_END(pInst, TimeStart, WriteCmdCnt, WriteCmdTime, WriteCmdTimeMax);
+      FS_DEBUG_LOG((FS_MTYPE_DRIVER, "MMC_CM: WRITE_MULTIPLE_BLOCKS (stream) SectorIndex: %lu, NumSectors: %lu, Res: %d\n", SectorIndex, NumSectorsAtOnce, r));
+      if (r == 0) {
+        r = _StopStreamTransfer(pInst, &CardStatus);
+      } else {
+        (void)_StopStreamTransfer(pInst, &CardStatus);
+      }
+      if (r != 0) {
+        (void)_CloseStreamIfRequired(pInst, &CardStatus);
+        break;                    // Error, could not write data.
+      }
+      NumSectors               -= NumSectorsAtOnce;
+      SectorIndex              += NumSectorsAtOnce;
+      pData8                   += NumSectorsAtOnce << BYTES_PER_SECTOR_SHIFT;
+      pInst->StreamSectorIndex  = SectorIndex;
+    } while (NumSectors != 0u);
+  }
+  pInst->StreamTimeLastWrite = FS_X_OS_GetTime();
+  if (r != 0) {
+    FS_DEBUG_ERROROUT((FS_MTYPE_DRIVER, "MMC_CM: _WriteSectorsStream: Could not write %lu sector(s) to sector index %lu.", NumSectors, SectorIndex));
+  }
+  return r;
+}
+
+#endif // FS_MMC_SUPPORT_STREAMING
+
 /*********************************************************************
 *
 *       _UnmountForced
@@ -7707,6 +8994,15 @@ static int _WriteSectors(MMC_CM_INST * pInst, U32 SectorIndex, const void * pDat
 static void _UnmountForced(MMC_CM_INST * pInst) {
   pInst->IsInited   = 0;
   pInst->IsHWInited = 0;
+#if FS_MMC_SUPPORT_STREAMING
+  pInst->IsStreamOpen = 0;
+#endif // FS_MMC_SUPPORT_STREAMING
+#if FS_MMC_SUPPORT_CMDQ
+  pInst->IsCmdQActive = 0;
+#endif // FS_MMC_SUPPORT_CMDQ
+#if FS_MMC_SUPPORT_SD
+  pInst->IsErasePending = 0;
+#endif // FS_MMC_SUPPORT_SD
 }
 
 /*********************************************************************
@@ -7730,6 +9026,12 @@ static void _Unmount(MMC_CM_INST * pInst) {
 
   if (pInst->IsInited != 0u) {
     FS_MEMSET(&CardStatus, 0, sizeof(CardStatus));
+#if FS_MMC_SUPPORT_STREAMING
+    (void)_CloseStreamIfRequired(pInst, &CardStatus);
+#endif // FS_MMC_SUPPORT_STREAMING
+#if FS_MMC_SUPPORT_CMDQ
+    (void)_DisableCmdQIfRequired(pInst, &CardStatus);
+#endif // FS_MMC_SUPPORT_CMDQ
 #if (FS_MMC_SUPPORT_SD != 0) && (FS_MMC_DISABLE_DAT3_PULLUP != 0)
     (void)_EnableDAT3PullUpIfRequired(pInst, &CardStatus);
 #endif // (FS_MMC_SUPPORT_SD != 0) && (FS_MMC_DISABLE_DAT3_PULLUP != 0)
@@ -7936,11 +9238,31 @@ static int _MMC_IoCtl(U8 Unit, I32 Cmd, I32 Aux, void * pBuffer) {
         U32         NumSectors;
         CARD_STATUS CardStatus;
 
-        StartSector = (U32)Aux;
+        StartSector = (U32)Aux + pInst->StartSector;
         NumSectors  = *SEGGER_PTR2PTR(U32, pBuffer);
-        r = _SelectCardWithBusyWait(pInst, &CardStatus);
-        if (r == 0) {
-          r = _Trim(pInst, StartSector, NumSectors, &CardStatus);
+        r = 0;
+        if (NumSectors != 0u) {
+          FS_MEMSET(&CardStatus, 0, sizeof(CardStatus));
+          r = _SelectCardWithBusyWait(pInst, &CardStatus);
+          if (r == 0) {
+#if FS_MMC_SUPPORT_SD
+            //
+            // SD cards do not support the trim operation. The sectors
+            // are erased instead which lets the card reclaim the storage
+            // as well. The driver does not wait for the erase operation
+            // to finish here so that deleting a file is not delayed
+            // by it. The next access to the SD card waits for it.
+            //
+            if (pInst->CardType == FS_MMC_CARD_TYPE_SD) {
+              r = _EraseSD(pInst, StartSector, NumSectors, 0, &CardStatus);     // 0 means do not wait for the erase operation to finish.
+            } else
+#endif // FS_MMC_SUPPORT_SD
+            {
+              r = _Trim(pInst, StartSector, NumSectors, &CardStatus);
+            }
+          }
+          IF_STATS(pInst->StatCounters.TrimCnt++);
+          IF_STATS(pInst->StatCounters.TrimSectorCnt += NumSectors);
         }
       }
 #else
@@ -7951,6 +9273,24 @@ static int _MMC_IoCtl(U8 Unit, I32 Cmd, I32 Aux, void * pBuffer) {
       r = 0;
 #endif  // FS_MMC_SUPPORT_TRIM
       break;
+    case FS_CMD_REQUIRES_ZERO_FILL:
+      r = 1;                      // Freed sectors keep their contents.
+#if FS_MMC_SUPPORT_TRIM
+      if (pInst->IsErasedValueZero != 0u) {
+        r = 0;                    // Freed sectors are erased or trimmed and read back as 0.
+      }
+#endif  // FS_MMC_SUPPORT_TRIM
+      break;
+#if FS_MMC_SUPPORT_STREAMING
+    case FS_CMD_SYNC:
+      {
+        CARD_STATUS CardStatus;
+
+        FS_MEMSET(&CardStatus, 0, sizeof(CardStatus));
+        r = _CloseStreamIfRequired(pInst, &CardStatus);
+      }
+      break;
+#endif // FS_MMC_SUPPORT_STREAMING
 #if FS_SUPPORT_DEINIT
     case FS_CMD_DEINIT:
       FS_FREE(pInst);
@@ -7995,6 +9335,9 @@ static int _MMC_Write(U8 Unit, U32 SectorIndex, const void * pData, U32 NumSecto
   unsigned      MaxWriteBurstRepeat;
   unsigned      MaxWriteBurstFill;
   U8            BurstType;
+#if FS_MMC_SUPPORT_CMDQ
+  int           IsCmdQUsed;
+#endif // FS_MMC_SUPPORT_CMDQ
 
   r     = 1;                // Set to indicate error.
   pInst = _GetInst(Unit);
@@ -8030,6 +9373,12 @@ static int _MMC_Write(U8 Unit, U32 SectorIndex, const void * pData, U32 NumSecto
     }
     NumRetries   = FS_MMC_NUM_RETRIES;
     SectorIndex += pInst->StartSector;
+#if FS_MMC_SUPPORT_CMDQ
+    IsCmdQUsed = 0;
+    if (BurstType == BURST_TYPE_NORMAL) {
+      IsCmdQUsed = _IsCmdQEnabled(pInst, NumSectors, MaxWriteBurst);
+    }
+#endif // FS_MMC_SUPPORT_CMDQ
     for (;;) {
       if (pInst->IsWriteProtected != 0u) {
         FS_DEBUG_WARN((FS_MTYPE_DRIVER, "MMC_CM: _MMC_Write: Card is write protected."));
@@ -8038,7 +9387,20 @@ static int _MMC_Write(U8 Unit, U32 SectorIndex, const void * pData, U32 NumSecto
       if (pInst->HasError != 0u) {
         break;                    // Error, the card has to be remounted.
       }
+#if FS_MMC_SUPPORT_CMDQ
+      if (IsCmdQUsed != 0) {
+        r = _TransferSectorsQueued(pInst, SectorIndex, SEGGER_PTR2PTR(void, pData), NumSectors, 0, MaxWriteBurst);    //lint !e9005 attempt to cast away const/volatile from a pointer or reference [MISRA 2012 Rule 11.8, required]. Rationale: the data is only read from the buffer.
+      } else
+#endif // FS_MMC_SUPPORT_CMDQ
+#if FS_MMC_SUPPORT_STREAMING
+      if ((BurstType == BURST_TYPE_NORMAL) && (MaxWriteBurst > 1u) && (_IsStreamingEnabled(pInst) != 0)) {
+        r = _WriteSectorsStream(pInst, SectorIndex, pData, NumSectors, MaxWriteBurst);
+      } else {
+        r = _WriteSectors(pInst, SectorIndex, pData, NumSectors, BurstType, MaxWriteBurst);
+      }
+#else
       r = _WriteSectors(pInst, SectorIndex, pData, NumSectors, BurstType, MaxWriteBurst);
+#endif // FS_MMC_SUPPORT_STREAMING
       if (r == 0) {
         IF_STATS(pInst->StatCounters.WriteSectorCnt += NumSectors);
         break;                    // OK, data written.
@@ -8047,6 +9409,12 @@ static int _MMC_Write(U8 Unit, U32 SectorIndex, const void * pData, U32 NumSecto
         break;                    // Error, maximum number of retries has been reached.
       }
       --NumRetries;
+#if FS_MMC_SUPPORT_CMDQ
+      if (IsCmdQUsed != 0) {
+        FS_DEBUG_WARN((FS_MTYPE_DRIVER, "MMC_CM: _MMC_Write: Falling back to non-queued write mode."));
+        IsCmdQUsed = 0;           // Fall back to regular write commands.
+      }
+#endif // FS_MMC_SUPPORT_CMDQ
       if (MaxWriteBurst != 1u) {
         FS_DEBUG_WARN((FS_MTYPE_DRIVER, "MMC_CM: _MMC_Write: Falling back to single sector write mode."));
         MaxWriteBurst = 1;        // Fall back to single sector write.
@@ -8549,9 +9917,12 @@ int FS_MMC_CM_UnlockCardForced(U8 Unit) {
 *    contents of the specified logical sectors to a predefined value.
 *    The erase operation sets all the bits in the specified logical
 *    sectors either to 1 or to 0. The actual value is implementation
-*    defined in the EXT_CSD register.
+*    defined in the EXT_CSD register of MMC devices and in the SCR
+*    register of SD cards.
 *
-*    The erase operation is supported only for MMC devices.
+*    SD cards that report ERASE_BLK_EN as 0 in the CSD register can
+*    only erase complete erase sectors. For these cards only the erase
+*    sectors that are completely contained in the specified range are erased.
 */
 int FS_MMC_CM_Erase(U8 Unit, U32 StartSector, U32 NumSectors) {
   int           r;
@@ -8932,6 +10303,119 @@ void FS_MMC_CM_AllowBufferedWrite(U8 Unit, U8 OnOff) {
   }
 }
 
+#if FS_MMC_SUPPORT_STREAMING
+
+/*********************************************************************
+*
+*       FS_MMC_CM_AllowStreamingWrite
+*
+*  Function description
+*    Enables / disables the streaming write mode.
+*
+*  Parameters
+*    Unit       Index of the driver instance (0-based).
+*    OnOff      Specifies if the streaming write mode should be enabled or not.
+*               * 0   Each write request uses a separate write command (default).
+*               * 1   Contiguous write requests share the same write command.
+*
+*  Additional information
+*    This function is optional. It is available only when the file system
+*    is compiled with FS_MMC_SUPPORT_STREAMING set to 1.
+*
+*    In streaming write mode the driver does not wait for the card
+*    to finish programming the data of a write request. If the next write
+*    request starts at the sector that follows the last written sector,
+*    the data is sent via WRITE_MULTIPLE_BLOCK (CMD25) as soon as the card
+*    releases the busy signal, without polling the card status. This reduces
+*    the time required to write large amounts of sequential data such as
+*    log files. The stream is closed when a write request is not contiguous,
+*    when the stream has been idle for more than FS_MMC_STREAM_TIMEOUT
+*    milliseconds, when any other type of access to the storage device
+*    is performed or when the application synchronizes the volume via
+*    for example FS_Sync() or FS_STORAGE_Sync(). Closing the stream waits
+*    for the card to become ready and reports programming errors. The time-out
+*    is evaluated lazily on the next access to the storage device.
+*    An application that has to know that the data was written without
+*    error should call FS_Sync() or FS_STORAGE_Sync().
+*
+*    Streaming is not used while reliable write is active
+*    (FS_MMC_CM_AllowReliableWrite()) because a reliable write has to
+*    be announced to the card before each write command.
+*
+*    The streaming write mode requires a hardware layer that implements
+*    the optional pfContinueWrite function. The mode is not used when
+*    the buffered write is disabled via FS_MMC_CM_AllowBufferedWrite()
+*    or when the power saving mode is enabled.
+*
+*    An application is permitted to call this function only
+*    at the file system initialization in FS_X_AddDevices().
+*/
+void FS_MMC_CM_AllowStreamingWrite(U8 Unit, U8 OnOff) {
+  MMC_CM_INST * pInst;
+
+  pInst = _AllocInstIfRequired(Unit);
+  if (pInst != NULL) {
+    pInst->IsStreamingAllowed = OnOff;
+  }
+}
+
+#endif // FS_MMC_SUPPORT_STREAMING
+
+#if FS_MMC_SUPPORT_CMDQ
+
+/*********************************************************************
+*
+*       FS_MMC_CM_AllowCommandQueue
+*
+*  Function description
+*    Enables / disables the usage of the eMMC command queue.
+*
+*  Parameters
+*    Unit       Index of the driver instance (0-based).
+*    OnOff      Specifies if the command queue should be used or not.
+*               * 0   The data is transferred using regular read and write commands (default).
+*               * 1   The data is transferred via queued tasks if supported by the eMMC device.
+*
+*  Additional information
+*    This function is optional. It is available only when the file system
+*    is compiled with FS_MMC_SUPPORT_CMDQ set to 1.
+*
+*    eMMC devices compliant to version 5.1 or newer of the specification
+*    can optionally queue up to 32 read or write tasks. The device decides
+*    the order in which the queued tasks are executed which increases
+*    the performance of read and write requests that span more than
+*    one task. The number of sectors transferred by a task is limited
+*    by the maximum burst size reported by the hardware layer.
+*    The driver uses at most FS_MMC_CMDQ_MAX_DEPTH tasks.
+*
+*    The command queue is used only for requests that are split in
+*    more than one task and that contain at least FS_MMC_CMDQ_MIN_SECTORS
+*    sectors. Smaller requests are transferred via the regular read and
+*    write commands which have a lower overhead when no other task can
+*    be prepared by the eMMC device in the meantime.
+*    The command queue is used only with eMMC devices that report
+*    the support for it and can queue at least two tasks. For all other storage devices the data is
+*    transferred using regular read and write commands. In addition,
+*    the command queue is not used when the power saving mode is enabled.
+*    The driver falls back to regular commands in case of a transfer
+*    error. The command queue mode of the eMMC device is disabled
+*    temporarily each time another command such as TRIM or a cache
+*    flush has to be executed.
+*
+*    An application is permitted to call this function only
+*    at the file system initialization in FS_X_AddDevices().
+*/
+void FS_MMC_CM_AllowCommandQueue(U8 Unit, U8 OnOff) {
+  MMC_CM_INST * pInst;
+
+  pInst = _AllocInstIfRequired(Unit);
+  if (pInst != NULL) {
+    pInst->IsCmdQAllowed = OnOff;
+  }
+}
+
+#endif // FS_MMC_SUPPORT_CMDQ
+
 /*********************************************************************
 *
 *       FS_MMC_CM_SetSectorRange
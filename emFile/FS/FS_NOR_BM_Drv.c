@@ -2442,6 +2442,48 @@ static void _GetPhySectorInfo(const NOR_BM_INST * pInst, unsigned PhySectorIndex
    pInst->pPhyType->pfGetSectorInfo(pInst->Unit, PhySectorIndex, pOff, pNumBytes);
 }
 
+/*********************************************************************
+*
+*       _MapRead
+*
+*  Function description
+*    Returns a pointer to the data stored on the NOR flash in system memory.
+*
+*  Parameters
+*    pInst      Driver instance.
+*    Off        Byte offset of the first byte to be accessed.
+*    NumBytes   Number of bytes to be accessed.
+*
+*  Return value
+*    !=NULL   Data can be accessed directly via the returned pointer.
+*    ==NULL   Data has to be read via _ReadOff().
+*
+*  Additional information
+*    The returned pointer is valid only until the next write or erase
+*    operation. The test hooks are not able to intercept the accesses
+*    via the returned pointer. Therefore, the mapping is not used when
+*    the support for testing is enabled.
+*/
+static const void * _MapRead(NOR_BM_INST * pInst, U32 Off, U32 NumBytes) {
+  const void * p;
+
+  p = NULL;
+#if (FS_SUPPORT_TEST == 0)
+  if (pInst->pPhyType->pfMapRead != NULL) {
+    p = pInst->pPhyType->pfMapRead(pInst->Unit, Off, NumBytes);
+    if (p != NULL) {
+      IF_STATS(pInst->StatCounters.ReadCnt++);
+      IF_STATS(pInst->StatCounters.ReadByteCnt += NumBytes);
+    }
+  }
+#else
+  FS_USE_PARA(pInst);
+  FS_USE_PARA(Off);
+  FS_USE_PARA(NumBytes);
+#endif // FS_SUPPORT_TEST == 0
+  return p;
+}
+
 /*********************************************************************
 *
 *       _ReadOff
@@ -2452,11 +2494,24 @@ static void _GetPhySectorInfo(const NOR_BM_INST * pInst, unsigned PhySectorIndex
 *  Return value
 *    ==0                  OK, data read successfully.
 *    ==RESULT_READ_ERROR  Error while reading from NOR flash.
+*
+*  Additional information
+*    The data is copied from system memory without involving the
+*    physical layer if the NOR flash is memory-mapped.
 */
 static int _ReadOff(NOR_BM_INST * pInst, void * pData, U32 Off, U32 NumBytes) {
-  int r;
-  U8  Unit;
+  int          r;
+  U8           Unit;
+  const void * pMapped;
 
+  //
+  // Copy the data from system memory if the NOR flash is memory-mapped.
+  //
+  pMapped = _MapRead(pInst, Off, NumBytes);
+  if (pMapped != NULL) {
+    FS_MEMCPY(pData, pMapped, NumBytes);
+    return 0;
+  }
   Unit = pInst->Unit;
   CALL_TEST_HOOK_DATA_READ_BEGIN(Unit, pData, &Off, &NumBytes);
   r = pInst->pPhyType->pfReadOff(Unit, pData, Off, NumBytes);
@@ -6248,16 +6303,29 @@ static int _CopyLogSectorDataWithCRCAndECC(NOR_BM_INST * pInst, unsigned psiSrc,
 *    ==0    Sector is not blank
 */
 static int _IsBlankLogSector(NOR_BM_INST * pInst, unsigned PhySectorIndex, unsigned srsi) {
-  U32        aBuffer[FS_NOR_DATA_BUFFER_SIZE / 4];
-  U32        Off;
-  unsigned   NumBytes;
-  unsigned   NumBytesAtOnce;
-  unsigned   NumItems;
-  U32      * p;
-  int        r;
+  U32         aBuffer[FS_NOR_DATA_BUFFER_SIZE / 4];
+  U32         Off;
+  unsigned    NumBytes;
+  unsigned    NumBytesAtOnce;
+  unsigned    NumItems;
+  const U32 * p;
+  int         r;
 
   NumBytes = 1uL << pInst->ldBytesPerSector;
   Off      = _GetLogSectorDataOff(pInst, PhySectorIndex,  srsi);
+  //
+  // Check the data directly in system memory if the NOR flash is memory-mapped.
+  //
+  p = SEGGER_CONSTPTR2PTR(const U32, _MapRead(pInst, Off, NumBytes));
+  if (p != NULL) {
+    NumItems = NumBytes >> 2;
+    do {
+      if (*p++ != 0xFFFFFFFFuL) {
+        return 0;
+      }
+    } while (--NumItems != 0u);
+    return 1;
+  }
   do {
     NumBytesAtOnce = SEGGER_MIN(NumBytes, sizeof(aBuffer));
     r = _ReadOff(pInst, aBuffer, Off, NumBytesAtOnce);
@@ -8150,19 +8218,32 @@ static NOR_BM_WORK_BLOCK * _AllocWorkBlockDesc(NOR_BM_INST * pInst, unsigned lbi
 *    Off and NumBytes have to be aligned to 4 bytes.
 */
 static int _IsDataBlank(NOR_BM_INST * pInst, U32 Off, U32 NumBytes) {
-  U32        aBuffer[FS_NOR_DATA_BUFFER_SIZE / 4];
-  unsigned   NumBytesAtOnce;
-  unsigned   NumItems;
-  U32      * p;
-  U32        SizeOfBuffer;
-  U32      * pBuffer;
-  I32        NumBytesFree;
-  int        r;
-  int        Result;
+  U32         aBuffer[FS_NOR_DATA_BUFFER_SIZE / 4];
+  unsigned    NumBytesAtOnce;
+  unsigned    NumItems;
+  const U32 * p;
+  U32         SizeOfBuffer;
+  U32       * pBuffer;
+  I32         NumBytesFree;
+  int         r;
+  int         Result;
 
   FS_DEBUG_ASSERT(FS_MTYPE_DRIVER, (Off & 3u) == 0u);
   FS_DEBUG_ASSERT(FS_MTYPE_DRIVER, (NumBytes & 3u) == 0u);
   //
+  // Check the data directly in system memory if the NOR flash is memory-mapped.
+  //
+  p = SEGGER_CONSTPTR2PTR(const U32, _MapRead(pInst, Off, NumBytes));
+  if (p != NULL) {
+    NumItems = NumBytes >> 2;
+    do {
+      if (*p++ != 0xFFFFFFFFuL) {
+        return 0;   // Phy. sector is not blank.
+      }
+    } while (--NumItems != 0u);
+    return 1;
+  }
+  //
   // If possible, use a larger buffer for the read operation to increase performance.
   //
   pBuffer      = _UseFreeMem(&NumBytesFree);
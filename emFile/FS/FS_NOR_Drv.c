@@ -1099,6 +1099,47 @@ static void _SetError(NOR_INST * pInst) {
   pInst->Status.HasError = 1;
 }
 
+/*********************************************************************
+*
+*       _MapRead
+*
+*  Function description
+*    Returns a pointer to the data stored on the NOR flash in system memory.
+*
+*  Parameters
+*    pInst      Driver instance.
+*    Off        Byte offset of the first byte to be accessed.
+*    NumBytes   Number of bytes to be accessed.
+*
+*  Return value
+*    !=NULL   Data can be accessed directly via the returned pointer.
+*    ==NULL   Data has to be read via _ReadOff().
+*
+*  Additional information
+*    The returned pointer is valid only until the next write or erase
+*    operation. The mapping is not used when the support for testing
+*    is enabled so that the test hooks see all the read accesses.
+*/
+static const void * _MapRead(NOR_INST * pInst, U32 Off, U32 NumBytes) {
+  const void * p;
+
+  p = NULL;
+#if (FS_SUPPORT_TEST == 0)
+  if (pInst->pPhyType->pfMapRead != NULL) {
+    p = pInst->pPhyType->pfMapRead(pInst->Unit, Off, NumBytes);
+    if (p != NULL) {
+      IF_STATS(pInst->StatCounters.ReadCnt++);
+      IF_STATS(pInst->StatCounters.ReadByteCnt += NumBytes);
+    }
+  }
+#else
+  FS_USE_PARA(pInst);
+  FS_USE_PARA(Off);
+  FS_USE_PARA(NumBytes);
+#endif // FS_SUPPORT_TEST == 0
+  return p;
+}
+
 /*********************************************************************
 *
 *       _ReadOff
@@ -1115,10 +1156,15 @@ static void _SetError(NOR_INST * pInst) {
 *  Return value
 *    ==0      OK, data read successfully.
 *    !=0      An error occurred.
+*
+*  Additional information
+*    The data is copied from system memory without involving the
+*    physical layer if the NOR flash is memory-mapped.
 */
 static int _ReadOff(NOR_INST * pInst, U32 Off, void * pData, U32 NumBytes) {
-  int r;
-  U8  Unit;
+  int          r;
+  U8           Unit;
+  const void * pMapped;
 
 #if (FS_DEBUG_LEVEL >= FS_DEBUG_LEVEL_CHECK_PARA)
   if ((Off < _FlashStart) || (Off > _FlashEnd) || ((Off + NumBytes) > _FlashEnd)) {
@@ -1126,6 +1172,14 @@ static int _ReadOff(NOR_INST * pInst, U32 Off, void * pData, U32 NumBytes) {
     return 1;
   }
 #endif // FS_DEBUG_LEVEL >= FS_DEBUG_LEVEL_CHECK_PARA
+  //
+  // Copy the data from system memory if the NOR flash is memory-mapped.
+  //
+  pMapped = _MapRead(pInst, Off, NumBytes);
+  if (pMapped != NULL) {
+    FS_MEMCPY(pData, pMapped, NumBytes);
+    return 0;
+  }
   Unit = pInst->Unit;
   CALL_TEST_HOOK_DATA_READ_BEGIN(Unit, pData, &Off, &NumBytes);
   r = pInst->pPhyType->pfReadOff(Unit, pData, Off, NumBytes);
@@ -2538,15 +2592,29 @@ static int _IsValidEraseSignature(const NOR_PSH * pPSH) {
 *    Checks if all the bytes in a physical sector are set to 0xFF.
 */
 static int _IsPhySectorBlank(NOR_INST * pInst, U32 PhySectorIndex) {
-  U32 SectorOff;
-  U32 SectorSize;
-  int r;
-  U32 aBuffer[8];       // Note: the size of the buffer must be a power of 2 since the size of a physical sector is always a power of 2.
+  U32         SectorOff;
+  U32         SectorSize;
+  int         r;
+  U32         aBuffer[8];       // Note: the size of the buffer must be a power of 2 since the size of a physical sector is always a power of 2.
+  const U32 * p;
 
   SectorOff  = 0;
   SectorSize = 0;
   _GetSectorInfo(pInst, PhySectorIndex, &SectorOff, &SectorSize);
   if (SectorSize != 0u) {
+    //
+    // Check the data directly in system memory if the NOR flash is memory-mapped.
+    //
+    p = SEGGER_CONSTPTR2PTR(const U32, _MapRead(pInst, SectorOff, SectorSize));
+    if (p != NULL) {
+      SectorSize >>= 2;
+      do {
+        if (*p++ != 0xFFFFFFFFuL) {
+          return 0;     // The physical sector is not blank.
+        }
+      } while (--SectorSize != 0u);
+      return 1;         // The physical sector is blank
+    }
     do {
       r = _ReadOff(pInst, SectorOff, aBuffer, sizeof(aBuffer));
       if (r != 0) {
@@ -3231,16 +3299,29 @@ static int _CheckInfoSector(NOR_INST * pInst, U32 Off) {
 *    ==0    Sector is not blank.
 */
 static int _IsLogSectorBlank(NOR_INST * pInst, U32 Off) {
-  U32        acBuffer[32];
-  unsigned   NumBytes;
-  unsigned   NumBytesAtOnce;
-  unsigned   NumItems;
-  U32      * p;
-  unsigned   SizeOfLSH;
-  int        r;
+  U32         acBuffer[32];
+  unsigned    NumBytes;
+  unsigned    NumBytesAtOnce;
+  unsigned    NumItems;
+  const U32 * p;
+  unsigned    SizeOfLSH;
+  int         r;
 
   SizeOfLSH = _SizeOfLSH(pInst);
   NumBytes = pInst->SectorSize + SizeOfLSH;
+  //
+  // Check the data directly in system memory if the NOR flash is memory-mapped.
+  //
+  p = SEGGER_CONSTPTR2PTR(const U32, _MapRead(pInst, Off, NumBytes));
+  if (p != NULL) {
+    NumItems = NumBytes >> 2;
+    do {
+      if (*p++ != 0xFFFFFFFFuL) {
+        return 0;
+      }
+    } while (--NumItems != 0u);
+    return 1;
+  }
   do {
     NumBytesAtOnce = SEGGER_MIN(NumBytes, sizeof(acBuffer));
     r = _ReadOff(pInst, Off, acBuffer, NumBytesAtOnce);
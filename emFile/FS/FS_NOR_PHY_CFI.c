@@ -1102,6 +1102,7 @@ const FS_NOR_PHY_TYPE FS_NOR_PHY_CFI_1x16 = {
   _PHY_OnSelectPhy1x16,
   _PHY_DeInit,
   NULL,
+  NULL,
   NULL
 };
 
@@ -1119,6 +1120,7 @@ const FS_NOR_PHY_TYPE FS_NOR_PHY_CFI_2x16 = {
   _PHY_OnSelectPhy2x16,
   _PHY_DeInit,
   NULL,
+  NULL,
   NULL
 };
 
@@ -323,6 +323,7 @@ const FS_NOR_PHY_TYPE FS_NOR_PHY_DSPI = {
   _PHY_OnSelectPhy,
   _PHY_DeInit,
   NULL,
+  NULL,
   NULL
 };
 
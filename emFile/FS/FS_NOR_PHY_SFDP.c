@@ -1580,7 +1580,8 @@ const FS_NOR_PHY_TYPE FS_NOR_PHY_SFDP = {
   _PHY_OnSelectPhy,
   _PHY_DeInit,
   NULL,
-  _PHY_Init
+  _PHY_Init,
+  NULL
 };
 
 /*********************************************************************
@@ -1969,6 +1969,49 @@ static int _PHY_ReadOff(U8 Unit, void * pData, U32 Off, U32 NumBytes) {
   return r;
 }
 
+/*********************************************************************
+*
+*       _PHY_MapRead
+*
+*  Function description
+*    Returns a pointer to the memory array of the NOR flash device in system memory.
+*
+*  Parameters
+*    Unit           Index of the physical layer.
+*    Off            Byte offset of the first byte to be accessed.
+*    NumBytes       Number of bytes to be accessed.
+*
+*  Return value
+*    !=NULL   Address of the byte at Off in system memory.
+*    ==NULL   The HW layer does not support the memory-mapped mode.
+*
+*  Additional information
+*    The NOR flash device is left in memory-mapped mode after
+*    each write and erase operation so that no mode switch is
+*    required here.
+*/
+static const void * _PHY_MapRead(U8 Unit, U32 Off, U32 NumBytes) {
+  U32              Addr;
+  int              r;
+  NOR_SPIFI_INST * pInst;
+  const void     * p;
+
+  p     = NULL;           // Set to indicate that mapping is not possible.
+  pInst = _GetInst(Unit);
+  if (pInst != NULL) {
+    r = _InitIfRequired(pInst);
+    if (r == 0) {
+      if (_IsMappingSupported(pInst) != 0) {
+        if ((Off < pInst->NumBytes) && (NumBytes <= (pInst->NumBytes - Off))) {
+          Addr = pInst->BaseAddr + pInst->StartAddrUsed + Off;
+          p    = SEGGER_ADDR2PTR(const void, Addr);
+        }
+      }
+    }
+  }
+  return p;
+}
+
 /*********************************************************************
 *
 *       _PHY_EraseSector
@@ -2219,7 +2262,8 @@ const FS_NOR_PHY_TYPE FS_NOR_PHY_SPIFI = {
   _PHY_OnSelectPhy,
   _PHY_DeInit,
   NULL,
-  _PHY_Init
+  _PHY_Init,
+  _PHY_MapRead
 };
 
 /*********************************************************************
@@ -1193,6 +1193,7 @@ const FS_NOR_PHY_TYPE FS_NOR_PHY_ST_M25 = {       // ST M25P compliant Serial NO
   _PHY_OnSelectPhy,
   _PHY_DeInit,
   NULL,
+  NULL,
   NULL
 };
 
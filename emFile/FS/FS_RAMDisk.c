@@ -292,6 +292,8 @@ static int _RAM_IoCtl(U8 Unit, I32 Cmd, I32 Aux, void * pBuffer) {
     _NumUnits--;
     break;
 #endif
+  case FS_CMD_REQUIRES_ZERO_FILL:
+    return 1;               // Freed sectors keep their contents.
   default:
     //
     // Command not supported.
@@ -52,6 +52,25 @@ Purpose     : API functions for handling volumes.
 */
 #include "FS_Int.h"
 
+/*********************************************************************
+*
+*       Configuration checks
+*
+**********************************************************************
+*/
+#if ((FS_CHECKDISK_NUM_CLUSTERS_AT_ONCE & 7) != 0) || (FS_CHECKDISK_NUM_CLUSTERS_AT_ONCE == 0)
+  #error FS_CHECKDISK_NUM_CLUSTERS_AT_ONCE has to be a non-zero multiple of 8.
+#endif
+
+/*********************************************************************
+*
+*       Defines, non-configurable
+*
+**********************************************************************
+*/
+#define DIR_POS_START           0xFFFFFFFFuL    // DirEntryIndex of a directory cursor that has not been positioned yet.
+#define DIR_POS_END             0xFFFFFFFEuL    // DirEntryIndex of a directory cursor that does not have to be searched any further.
+
 /*********************************************************************
 *
 *       Static code
@@ -245,6 +264,493 @@ static int _ResumeJournal(FS_VOLUME * pVolume) {
   return r;
 }
 
+/*********************************************************************
+*
+*       _CheckATRange
+*
+*  Function description
+*    Verifies the consistency of a range of allocation table entries.
+*
+*  Parameters
+*    pCheckData     [IN] Checking context.
+*    pClusterMap    [IN] Usage information of the clusters to be checked.
+*    pATInfo        [OUT] Information about the allocation table.
+*
+*  Return value
+*    ==FS_CHECKDISK_RETVAL_OK       No errors found.
+*    ==FS_CHECKDISK_RETVAL_RETRY    An error has been found and corrected or
+*                                   the allocation table has been modified.
+*    ==FS_CHECKDISK_RETVAL_ABORT    The application requested the abort.
+*    < 0                            Error code indicating the failure reason.
+*
+*  Additional information
+*    pClusterMap can describe the entire range of clusters stored
+*    in the checking context or only a part of it.
+*/
+static int _CheckATRange(FS_CHECK_DATA * pCheckData, const FS_CLUSTER_MAP * pClusterMap, FS_AT_INFO * pATInfo) {
+  int                              r;
+  FS_VOLUME                      * pVolume;
+  FS_CHECKDISK_ON_ERROR_CALLBACK * pfOnError;
+  int                              Result;
+
+  r = FS_ERRCODE_VOLUME_NOT_FOUND;
+  pVolume = pCheckData->pVolume;
+  FS_LOCK();
+  if (pVolume != NULL) {
+    //
+    // Make sure that the cached data is written to storage.
+    //
+    r = _MountSyncIfRequired(pVolume);
+    if (r == 0) {
+      FS_LOCK_DRIVER(&pVolume->Partition.Device);
+      //
+      // Make sure that no other task unmounted the volume.
+      //
+      if (pVolume->MountType != 0u) {
+        //
+        // Get information about the allocation table.
+        //
+        r = FS_GET_AT_INFO(pVolume, pATInfo);
+        if (r == 0) {
+          //
+          // Make sure that the journal is disabled during the checking.
+          //
+          r = _SuspendJournal(pVolume);
+          if (r == 0) {
+            //
+            // Restart the checking if the allocation table has
+            // been modified since the start of the operation
+            // that is last call to FS_InitCheck().
+            //
+            r = FS_CHECKDISK_RETVAL_RETRY;
+            if (pATInfo->WriteCnt == pCheckData->WriteCntAT) {
+              pfOnError = pCheckData->pfOnError;
+              r = FS_CHECK_AT(pVolume, pClusterMap, pfOnError);
+              if (r == 0) {
+                Result = FS_GET_AT_INFO(pVolume, pATInfo);
+                if (Result == 0) {
+                  //
+                  // Update the number of write operations performed
+                  // to the allocation table for the case the checking
+                  // operation modified the allocation table.
+                  //
+                  pCheckData->WriteCntAT = pATInfo->WriteCnt;
+                }
+              }
+            }
+            (void)_ResumeJournal(pVolume);
+          } else {
+            if (r == FS_ERRCODE_INVALID_USAGE) {
+              //
+              // Retry the disk checking operation if a journal transaction is active.
+              //
+              r = FS_CHECKDISK_RETVAL_RETRY;
+            }
+          }
+        }
+      } else {
+        FS_DEBUG_ERROROUT((FS_MTYPE_API, "FS_CheckAT: Volume has been unmounted by another task."));
+        r = FS_ERRCODE_VOLUME_NOT_MOUNTED;
+      }
+      FS_UNLOCK_DRIVER(&pVolume->Partition.Device);
+    }
+  }
+  FS_UNLOCK();
+  return r;
+}
+
+/*********************************************************************
+*
+*       _InitDirPos
+*
+*  Function description
+*    Initializes a directory cursor of the incremental disk checking.
+*
+*  Parameters
+*    pDirPos          [OUT] Directory cursor.
+*    FirstClusterId   Id of the first cluster assigned to the directory.
+*    DirEntryIndex    Index of the first directory entry to be read,
+*                     DIR_POS_START or DIR_POS_END.
+*/
+static void _InitDirPos(FS_DIR_POS * pDirPos, U32 FirstClusterId, U32 DirEntryIndex) {
+  FS_MEMSET(pDirPos, 0, sizeof(FS_DIR_POS));
+  pDirPos->FirstClusterId = FirstClusterId;
+  pDirPos->ClusterId      = FirstClusterId;
+  pDirPos->DirEntryIndex  = DirEntryIndex;
+}
+
+/*********************************************************************
+*
+*       _FindSubDir
+*
+*  Function description
+*    Searches for the next subdirectory in a directory.
+*
+*  Parameters
+*    pVolume          Volume on which the directory is located.
+*    sDirPath         Path to the directory (without volume name).
+*    pDirPos          [IN] Position of the first directory entry to be read.
+*                     [OUT] Position after the subdirectory found.
+*    sDirName         [OUT] Name of the subdirectory.
+*    SizeOfName       Number of bytes in sDirName.
+*    pFirstClusterId  [OUT] Id of the first cluster assigned to the subdirectory.
+*
+*  Return value
+*    ==0      OK, subdirectory found.
+*    ==1      No more subdirectories in the directory.
+*    < 0      Error code indicating the failure reason.
+*
+*  Additional information
+*    The search continues at the position stored in the directory
+*    cursor so that each directory entry is read only once during
+*    a pass through the directory tree. sDirPath is used only to
+*    open the root directory. The cursor of a subdirectory is built
+*    from its first cluster. No file system resources remain allocated
+*    between two steps of the incremental disk checking operation.
+*    The cursor stays valid because the volume is mounted read-only.
+*/
+static int _FindSubDir(FS_VOLUME * pVolume, const char * sDirPath, FS_DIR_POS * pDirPos, char * sDirName, int SizeOfName, U32 * pFirstClusterId) {
+  int              r;
+  FS_DIR_OBJ       DirObj;
+  FS_DIRENTRY_INFO DirEntryInfo;
+  int              IsDotEntry;
+
+  FS_MEMSET(&DirObj, 0, sizeof(DirObj));
+  FS_MEMSET(&DirEntryInfo, 0, sizeof(DirEntryInfo));
+  DirObj.pVolume              = pVolume;
+  DirEntryInfo.sFileName      = sDirName;
+  DirEntryInfo.SizeofFileName = SizeOfName;
+  r = FS_ERRCODE_VOLUME_NOT_MOUNTED;
+  FS_LOCK();
+  FS_LOCK_DRIVER(&pVolume->Partition.Device);
+  if (pVolume->MountType != 0u) {
+    if (pDirPos->DirEntryIndex == DIR_POS_START) {
+      r = FS_OPENDIR(sDirPath, &DirObj);
+    } else {
+      DirObj.DirPos = *pDirPos;
+      r = 0;
+    }
+    if (r == 0) {
+      for (;;) {
+        r = FS_READDIR(&DirObj, &DirEntryInfo);
+        if (r != 0) {
+          break;                          // End of directory reached or error.
+        }
+        if ((DirEntryInfo.Attributes & FS_ATTR_DIRECTORY) != 0u) {
+          IsDotEntry = 0;
+          if (*sDirName == '.') {
+            if ((sDirName[1] == '\0') || ((sDirName[1] == '.') && (sDirName[2] == '\0'))) {
+              IsDotEntry = 1;
+            }
+          }
+          if (IsDotEntry == 0) {
+            *pFirstClusterId = DirEntryInfo.FirstClusterId;
+            break;                        // OK, subdirectory found.
+          }
+        }
+      }
+      *pDirPos = DirObj.DirPos;
+    }
+  } else {
+    FS_DEBUG_ERROROUT((FS_MTYPE_API, "FS_CheckDiskStep: Volume has been unmounted by another task."));
+  }
+  FS_UNLOCK_DRIVER(&pVolume->Partition.Device);
+  FS_UNLOCK();
+  return r;
+}
+
+/*********************************************************************
+*
+*       _IsMountedReadOnly
+*
+*  Function description
+*    Checks if the volume is mounted read-only.
+*
+*  Return value
+*    !=0    The volume is mounted read-only.
+*    ==0    The volume is not mounted or it can be written.
+*/
+static int _IsMountedReadOnly(FS_VOLUME * pVolume) {
+  int r;
+
+  FS_LOCK();
+  FS_LOCK_DRIVER(&pVolume->Partition.Device);
+  r = 0;
+  if (pVolume->MountType == FS_MOUNT_RO) {
+    r = 1;
+  }
+  FS_UNLOCK_DRIVER(&pVolume->Partition.Device);
+  FS_UNLOCK();
+  return r;
+}
+
+/*********************************************************************
+*
+*       _RestartCheckStep
+*
+*  Function description
+*    Starts the incremental disk checking operation from the beginning.
+*
+*  Parameters
+*    pStepData    Checking context.
+*
+*  Return value
+*    ==0      OK, operation restarted.
+*    < 0      Error code indicating the failure reason.
+*
+*  Additional information
+*    The checking has to start over if the allocation table has been
+*    modified because the information stored in the cluster map is
+*    no longer valid. This cannot happen as long as the volume stays
+*    mounted read-only, which is verified here. The total processing
+*    time and the duration of a directory pass are preserved so that
+*    the estimation of the remaining time remains possible.
+*/
+static int _RestartCheckStep(FS_CHECKDISK_STEP_DATA * pStepData) {
+  int         r;
+  U32         NumClustersAtOnce;
+  U32         NumPasses;
+  FS_VOLUME * pVolume;
+  FS_AT_INFO  atInfo;
+
+  r = FS_InitCheck(&pStepData->CheckData, pStepData->sVolumeName, pStepData->pBuffer, pStepData->BufferSize, pStepData->pfOnError);
+  if (r == 0) {
+    NumClustersAtOnce = (U32)pStepData->CheckData.ClusterMap.NumClusters;
+    FS_MEMSET(&atInfo, 0, sizeof(atInfo));
+    pVolume = pStepData->CheckData.pVolume;
+    if (_IsMountedReadOnly(pVolume) == 0) {
+      FS_DEBUG_ERROROUT((FS_MTYPE_API, "FS_CheckDiskStart: Volume has to be mounted read-only."));
+      return FS_ERRCODE_INVALID_USAGE;          // Error, the volume can be modified during the checking.
+    }
+    FS_LOCK();
+    FS_LOCK_DRIVER(&pVolume->Partition.Device);
+    r = FS_GET_AT_INFO(pVolume, &atInfo);
+    FS_UNLOCK_DRIVER(&pVolume->Partition.Device);
+    FS_UNLOCK();
+    if (r != 0) {
+      return r;                                 // Error, could not get information about the allocation table.
+    }
+    if (NumClustersAtOnce == 0u) {
+      r = FS_ERRCODE_BUFFER_TOO_SMALL;          // Error, buffer not large enough.
+    } else {
+      pStepData->NumClustersTotal   = atInfo.NumClusters;
+      NumPasses                     = (atInfo.NumClusters + NumClustersAtOnce - 1u) / NumClustersAtOnce;
+      pStepData->NumPasses          = (U16)NumPasses;
+      pStepData->PassIndex          = 0;
+      pStepData->Phase              = FS_CHECKDISK_PHASE_DIR;
+      pStepData->DirLevel           = 0;
+      pStepData->IsDirChecked       = 0;
+      pStepData->ClusterOff         = 0;
+      pStepData->NumClustersChecked = 0;
+      pStepData->NumDirsChecked     = 0;
+      pStepData->TimeDirCurrent     = 0;
+      pStepData->TimeAT             = 0;
+      pStepData->acPath[0]          = '\0';   // Start with the root directory.
+      _InitDirPos(&pStepData->aDirPos[0], 0, DIR_POS_START);
+    }
+  }
+  return r;
+}
+
+/*********************************************************************
+*
+*       _CheckDirStep
+*
+*  Function description
+*    Performs one step of the directory checking phase.
+*
+*  Parameters
+*    pStepData    Checking context.
+*
+*  Return value
+*    ==FS_CHECKDISK_RETVAL_CONTINUE     OK, more processing required.
+*    ==FS_CHECKDISK_RETVAL_RETRY        The operation has to be restarted.
+*    ==FS_CHECKDISK_RETVAL_ABORT        The application requested the abort.
+*    ==FS_CHECKDISK_RETVAL_MAX_RECURSE  Maximum directory depth reached.
+*    < 0                                Error code indicating the failure reason.
+*
+*  Additional information
+*    The directory tree is walked in depth-first order. The cursor
+*    consists of the path to the current directory and of the position
+*    in the directory where the search for the next subdirectory
+*    continues on each directory level. One step either checks one
+*    directory or moves the cursor to the next directory to be checked.
+*/
+static int _CheckDirStep(FS_CHECKDISK_STEP_DATA * pStepData) {
+  int      r;
+  unsigned Len;
+  int      DirLevel;
+  char   * sDirName;
+  int      SizeOfName;
+  char   * s;
+  U32      FirstClusterId;
+
+  DirLevel = pStepData->DirLevel;
+  if (pStepData->IsDirChecked == 0u) {
+    //
+    // Check the directory entries and add the clusters
+    // of the files and subdirectories to the cluster map.
+    //
+    r = FS_CheckDir(&pStepData->CheckData, pStepData->acPath);
+    if (r == FS_CHECKDISK_RETVAL_OK) {
+      pStepData->IsDirChecked = 1;
+      pStepData->NumDirsChecked++;
+      return FS_CHECKDISK_RETVAL_CONTINUE;
+    }
+    if (r != FS_CHECKDISK_RETVAL_SKIP) {
+      return r;
+    }
+    //
+    // The directory entry is not valid. Do not descend into it.
+    //
+    pStepData->aDirPos[DirLevel].DirEntryIndex = DIR_POS_END;
+    pStepData->IsDirChecked                    = 1;
+  }
+  //
+  // Descend into the next subdirectory of the current directory.
+  // The path of a subdirectory always ends with a directory delimiter
+  // because FS_CheckDir() opens the last directory that is followed
+  // by a delimiter. Without it the parent directory would be checked.
+  //
+  Len = (unsigned)FS_STRLEN(pStepData->acPath);
+  r              = 1;                       // Set to indicate that no subdirectory is present.
+  FirstClusterId = 0;
+  if (pStepData->aDirPos[DirLevel].DirEntryIndex != DIR_POS_END) {
+    sDirName   = &pStepData->acPath[Len];
+    SizeOfName = (int)sizeof(pStepData->acPath) - ((int)Len + 1);     // Reserve one byte for the directory delimiter.
+    if (SizeOfName < 13) {                  // We need space at least for a short file name.
+      return FS_ERRCODE_PATH_TOO_LONG;
+    }
+    r = _FindSubDir(pStepData->CheckData.pVolume, pStepData->acPath, &pStepData->aDirPos[DirLevel], sDirName, SizeOfName, &FirstClusterId);
+    if (r < 0) {
+      pStepData->acPath[Len] = '\0';
+      return r;                             // Error, could not read directory.
+    }
+  }
+  if (r == 0) {
+    if ((DirLevel >= pStepData->MaxRecursionLevel) || ((DirLevel + 1) >= FS_CHECKDISK_MAX_DIR_DEPTH)) {
+      pStepData->acPath[Len] = '\0';
+      return FS_CHECKDISK_RETVAL_MAX_RECURSE;
+    }
+    Len += (unsigned)FS_STRLEN(sDirName);
+    pStepData->acPath[Len]            = FS_DIRECTORY_DELIMITER;
+    pStepData->acPath[Len + 1u]       = '\0';
+    ++DirLevel;
+    pStepData->DirLevel               = DirLevel;
+    pStepData->IsDirChecked           = 0;
+    _InitDirPos(&pStepData->aDirPos[DirLevel], FirstClusterId, 0);
+    return FS_CHECKDISK_RETVAL_CONTINUE;
+  }
+  pStepData->acPath[Len] = '\0';
+  if (DirLevel == 0) {
+    //
+    // All the directories have been checked. Continue with the allocation table.
+    //
+    pStepData->Phase      = FS_CHECKDISK_PHASE_AT;
+    pStepData->ClusterOff = 0;
+    if (pStepData->TimeDirPass == 0u) {
+      pStepData->TimeDirPass = SEGGER_MAX(pStepData->TimeDirCurrent, 1u);
+    }
+    return FS_CHECKDISK_RETVAL_CONTINUE;
+  }
+  //
+  // Return to the parent directory by removing the last
+  // directory name together with its delimiter.
+  //
+  s = pStepData->acPath + Len - 1u;
+  while (s != pStepData->acPath) {
+    if (*(s - 1) == FS_DIRECTORY_DELIMITER) {
+      break;
+    }
+    --s;
+  }
+  *s = '\0';
+  pStepData->DirLevel = DirLevel - 1;
+  return FS_CHECKDISK_RETVAL_CONTINUE;
+}
+
+/*********************************************************************
+*
+*       _CheckATStep
+*
+*  Function description
+*    Performs one step of the allocation table checking phase.
+*
+*  Parameters
+*    pStepData    Checking context.
+*
+*  Return value
+*    ==FS_CHECKDISK_RETVAL_OK           OK, the entire volume has been checked.
+*    ==FS_CHECKDISK_RETVAL_CONTINUE     OK, more processing required.
+*    ==FS_CHECKDISK_RETVAL_RETRY        The operation has to be restarted.
+*    ==FS_CHECKDISK_RETVAL_ABORT        The application requested the abort.
+*    < 0                                Error code indicating the failure reason.
+*
+*  Additional information
+*    One step checks at most FS_CHECKDISK_NUM_CLUSTERS_AT_ONCE clusters
+*    so that the file system is locked only for a short period of time.
+*    When the end of the cluster map is reached, the next range of
+*    clusters is selected and the directory tree is checked again.
+*/
+static int _CheckATStep(FS_CHECKDISK_STEP_DATA * pStepData) {
+  int              r;
+  FS_CLUSTER_MAP   ClusterMap;
+  FS_CLUSTER_MAP * pClusterMap;
+  FS_AT_INFO       atInfo;
+  U32              NumClustersInMap;
+  U32              NumClusters;
+  U32              ClusterOff;
+  U32              FirstClusterId;
+
+  pClusterMap      = &pStepData->CheckData.ClusterMap;
+  NumClustersInMap = (U32)pClusterMap->NumClusters;
+  ClusterOff       = pStepData->ClusterOff;
+  NumClusters      = SEGGER_MIN(NumClustersInMap - ClusterOff, (U32)FS_CHECKDISK_NUM_CLUSTERS_AT_ONCE);
+  //
+  // Build a cluster map that describes only a part of the clusters.
+  // ClusterOff is always a multiple of 8 so that the usage information
+  // starts on a byte boundary.
+  //
+  ClusterMap.pData          = pClusterMap->pData + (ClusterOff >> 3);
+  ClusterMap.FirstClusterId = pClusterMap->FirstClusterId + ClusterOff;
+  ClusterMap.NumClusters    = (I32)NumClusters;
+  FS_MEMSET(&atInfo, 0, sizeof(atInfo));
+  r = _CheckATRange(&pStepData->CheckData, &ClusterMap, &atInfo);
+  if (r != FS_CHECKDISK_RETVAL_OK) {
+    return r;
+  }
+  ClusterOff                    += NumClusters;
+  pStepData->ClusterOff          = ClusterOff;
+  pStepData->NumClustersChecked += NumClusters;
+  if (ClusterOff < NumClustersInMap) {
+    return FS_CHECKDISK_RETVAL_CONTINUE;
+  }
+  //
+  // Select the next range of clusters if the cluster map
+  // is too small to store the usage information of all clusters.
+  //
+  FirstClusterId = pClusterMap->FirstClusterId + NumClustersInMap;
+  if (FirstClusterId >= (atInfo.FirstClusterId + atInfo.NumClusters)) {
+    pStepData->Phase = FS_CHECKDISK_PHASE_DONE;
+    return FS_CHECKDISK_RETVAL_OK;
+  }
+  NumClusters = (atInfo.FirstClusterId + atInfo.NumClusters) - FirstClusterId;
+  NumClusters = SEGGER_MIN(NumClusters, NumClustersInMap);
+  pClusterMap->FirstClusterId = FirstClusterId;
+  pClusterMap->NumClusters    = (I32)NumClusters;
+  FS_MEMSET(pClusterMap->pData, 0, (NumClusters + 7u) >> 3);
+  pStepData->PassIndex++;
+  pStepData->Phase          = FS_CHECKDISK_PHASE_DIR;
+  pStepData->DirLevel       = 0;
+  pStepData->IsDirChecked   = 0;
+  pStepData->ClusterOff     = 0;
+  pStepData->NumDirsChecked = 0;
+  pStepData->TimeDirCurrent = 0;
+  pStepData->acPath[0]      = '\0';
+  _InitDirPos(&pStepData->aDirPos[0], 0, DIR_POS_START);
+  return FS_CHECKDISK_RETVAL_CONTINUE;
+}
+
 #if FS_SUPPORT_JOURNAL
 
 /*********************************************************************
@@ -2026,17 +2532,14 @@ int FS_CheckDir(FS_CHECK_DATA * pCheckData, const char * sPath) {
 *    pCheckData has to be initialized via a call to FS_InitCheck().
 */
 int FS_CheckAT(FS_CHECK_DATA * pCheckData) {
-  int                              r;
-  FS_VOLUME                      * pVolume;
-  FS_AT_INFO                       atInfo;
-  FS_CLUSTER_MAP                 * pClusterMap;
-  FS_CHECKDISK_ON_ERROR_CALLBACK * pfOnError;
-  U32                              NumClustersToCheck;
-  U32                              NumClustersChecked;
-  U32                              LastClusterIdChecked;
-  U32                              LastClusterId;
-  U32                              NumBytes;
-  int                              Result;
+  int              r;
+  FS_AT_INFO       atInfo;
+  FS_CLUSTER_MAP * pClusterMap;
+  U32              NumClustersToCheck;
+  U32              NumClustersChecked;
+  U32              LastClusterIdChecked;
+  U32              LastClusterId;
+  U32              NumBytes;
 
   //
   // Validate parameters.
@@ -2045,90 +2548,281 @@ int FS_CheckAT(FS_CHECK_DATA * pCheckData) {
     FS_DEBUG_ERROROUT((FS_MTYPE_API, "FS_CheckAT: Invalid parameter."));
     return FS_ERRCODE_INVALID_PARA;
   }
-  r = FS_ERRCODE_VOLUME_NOT_FOUND;
-  pVolume = pCheckData->pVolume;
-  FS_LOCK();
-  if (pVolume != NULL) {
+  pClusterMap = &pCheckData->ClusterMap;
+  FS_MEMSET(&atInfo, 0, sizeof(atInfo));
+  r = _CheckATRange(pCheckData, pClusterMap, &atInfo);
+  if (r == 0) {
     //
-    // Make sure that the cached data is written to storage.
+    // Check if the entire allocation table has been checked.
+    // If not, request a new check for the next range of clusters.
     //
-    r = _MountSyncIfRequired(pVolume);
-    if (r == 0) {
-      FS_LOCK_DRIVER(&pVolume->Partition.Device);
+    NumClustersChecked   = (U32)pClusterMap->NumClusters;
+    LastClusterIdChecked = (pClusterMap->FirstClusterId + NumClustersChecked) - 1u;
+    LastClusterId        = (atInfo.FirstClusterId + atInfo.NumClusters) - 1u;
+    if (LastClusterIdChecked < LastClusterId) {
+      NumClustersToCheck = LastClusterId - LastClusterIdChecked;
+      NumClustersToCheck = SEGGER_MIN(NumClustersToCheck, NumClustersChecked);
+      pClusterMap->NumClusters    = (I32)NumClustersToCheck;
+      pClusterMap->FirstClusterId = LastClusterIdChecked + 1u;
+      NumBytes = (NumClustersToCheck + 8u - 1u) >> 3;       // The status of 8 clusters is stored in a byte.
+      FS_MEMSET(pClusterMap->pData, 0, NumBytes);
+      r = FS_CHECKDISK_RETVAL_CONTINUE;
+    }
+  }
+  return r;
+}
+
+/*********************************************************************
+*
+*       FS_CheckDiskStart
+*
+*  Function description
+*    Initializes an incremental disk checking operation.
+*
+*  Parameters
+*    pStepData          [OUT] Checking context. It cannot be NULL.
+*    sVolumeName        Name of the volume on which the checking is performed.
+*                       It cannot be NULL.
+*    pBuffer            [IN] Working buffer. It cannot be NULL.
+*    BufferSize         Number of bytes in pBuffer.
+*    MaxRecursionLevel  Maximum directory depth to be checked.
+*    pfOnError          Callback function to be invoked in case of a file
+*                       system damage. It cannot be NULL.
+*
+*  Return value
+*    ==FS_CHECKDISK_RETVAL_OK     OK, disk checking has been initialized.
+*    ==FS_ERRCODE_INVALID_USAGE   The volume is not mounted read-only.
+*    < 0                          Error code indicating the failure reason.
+*
+*  Additional information
+*    The volume has to be mounted read-only via FS_MountEx() with
+*    FS_MOUNT_RO before FS_CheckDiskStart() is called and it has to
+*    remain mounted read-only until the checking is complete. This
+*    guarantees that the allocation table and the directories are
+*    not modified between two steps so that neither the cluster map
+*    nor the directory cursors become invalid. Other tasks can still
+*    read from the volume. Errors are reported via pfOnError but they
+*    cannot be repaired. pfOnError has to return
+*    FS_CHECKDISK_ACTION_DO_NOT_REPAIR or FS_CHECKDISK_ACTION_ABORT.
+*    The errors can be repaired by a call to FS_CheckDisk() after the
+*    volume has been mounted read / write.
+*
+*    FS_CheckDiskStart() has to be called in combination with
+*    FS_CheckDiskStep() to check the consistency of the file system.
+*    The parameters have the same meaning as the corresponding
+*    parameters of FS_CheckDisk(). pBuffer is used as cluster map
+*    that stores one bit per cluster. If pBuffer is too small to store
+*    the usage information of all the clusters, the checking is
+*    performed in several passes, each pass checking the directory
+*    tree again for the next range of clusters.
+*
+*    MaxRecursionLevel is limited to FS_CHECKDISK_MAX_DIR_DEPTH - 1.
+*/
+int FS_CheckDiskStart(FS_CHECKDISK_STEP_DATA * pStepData, const char * sVolumeName, void * pBuffer, U32 BufferSize, int MaxRecursionLevel, FS_CHECKDISK_ON_ERROR_CALLBACK * pfOnError) {
+  int r;
+
+  //
+  // Validate parameters.
+  //
+  if ((pStepData == NULL) || (sVolumeName == NULL) || (pBuffer == NULL) || (pfOnError == NULL)) {
+    FS_DEBUG_ERROROUT((FS_MTYPE_API, "FS_CheckDiskStart: Invalid parameter(s)."));
+    return FS_ERRCODE_INVALID_PARA;
+  }
+  FS_MEMSET(pStepData, 0, sizeof(FS_CHECKDISK_STEP_DATA));
+  pStepData->sVolumeName       = sVolumeName;
+  pStepData->pBuffer           = pBuffer;
+  pStepData->BufferSize        = BufferSize;
+  pStepData->pfOnError         = pfOnError;
+  pStepData->MaxRecursionLevel = MaxRecursionLevel;
+  r = _RestartCheckStep(pStepData);
+  if (r != 0) {
+    pStepData->Phase = FS_CHECKDISK_PHASE_DONE;       // Prevent FS_CheckDiskStep() from accessing the volume.
+  }
+  return r;
+}
+
+/*********************************************************************
+*
+*       FS_CheckDiskStep
+*
+*  Function description
+*    Performs the incremental disk checking for a limited period of time.
+*
+*  Parameters
+*    pStepData    [IN] Checking context. It cannot be NULL.
+*    TimeSlice    Maximum processing time in milliseconds.
+*
+*  Return value
+*    ==FS_CHECKDISK_RETVAL_OK           The entire volume has been checked.
+*    ==FS_CHECKDISK_RETVAL_CONTINUE     The time slice expired. FS_CheckDiskStep()
+*                                       has to be called again to continue the checking.
+*    ==FS_CHECKDISK_RETVAL_ABORT        The application requested the abort of disk checking operation
+*                                       through the callback returning FS_CHECKDISK_ACTION_ABORT.
+*    ==FS_CHECKDISK_RETVAL_MAX_RECURSE  Maximum recursion level reached. The disk checking
+*                                       operation has been aborted.
+*    < 0                                Error code indicating the failure reason.
+*
+*  Additional information
+*    pStepData has to be initialized via a call to FS_CheckDiskStart().
+*    FS_CheckDiskStep() performs the same checks as FS_CheckDisk() but
+*    it returns as soon as the processing time exceeds TimeSlice. The
+*    position in the directory tree and in the allocation table is stored
+*    in pStepData so that the next call continues where the previous one
+*    stopped. The file system is locked only for the duration of checking
+*    one directory or FS_CHECKDISK_NUM_CLUSTERS_AT_ONCE allocation table
+*    entries. Therefore, a low priority task can call FS_CheckDiskStep()
+*    periodically while other tasks access the volume. With TimeSlice set
+*    to 0 only one of these operations is performed.
+*
+*    FS_CheckDiskStep() returns FS_ERRCODE_INVALID_USAGE without
+*    accessing the volume as long as the volume is not mounted read-only.
+*    The checking has to be started again via FS_CheckDiskStart() if
+*    the volume has been mounted read / write in the meantime.
+*/
+int FS_CheckDiskStep(FS_CHECKDISK_STEP_DATA * pStepData, U32 TimeSlice) {
+  int      r;
+  unsigned Phase;
+  U32      TimeStart;
+  U32      TimeNow;
+  U32      TimeStep;
+
+  //
+  // Validate parameters.
+  //
+  if (pStepData == NULL) {
+    FS_DEBUG_ERROROUT((FS_MTYPE_API, "FS_CheckDiskStep: Invalid parameter."));
+    return FS_ERRCODE_INVALID_PARA;
+  }
+  r = FS_CHECKDISK_RETVAL_OK;
+  if (pStepData->Phase != FS_CHECKDISK_PHASE_DONE) {
+    if (_IsMountedReadOnly(pStepData->CheckData.pVolume) == 0) {
+      FS_DEBUG_ERROROUT((FS_MTYPE_API, "FS_CheckDiskStep: Volume is no longer mounted read-only."));
+      return FS_ERRCODE_INVALID_USAGE;
+    }
+    TimeStart = FS_X_OS_GetTime();
+    TimeNow   = TimeStart;
+    for (;;) {
+      TimeStep = TimeNow;
+      Phase    = pStepData->Phase;
+      if (Phase == FS_CHECKDISK_PHASE_DIR) {
+        r = _CheckDirStep(pStepData);
+      } else {
+        r = _CheckATStep(pStepData);
+      }
       //
-      // Make sure that no other task unmounted the volume.
+      // Update the time statistics.
       //
-      if (pVolume->MountType != 0u) {
+      TimeNow   = FS_X_OS_GetTime();
+      TimeStep  = TimeNow - TimeStep;
+      pStepData->TimeElapsed += TimeStep;
+      if (Phase == FS_CHECKDISK_PHASE_DIR) {
+        pStepData->TimeDirCurrent += TimeStep;
+      } else {
+        pStepData->TimeAT         += TimeStep;
+      }
+      if (r == FS_CHECKDISK_RETVAL_RETRY) {
         //
-        // Get information about the allocation table.
+        // The information in the cluster map is no longer valid. Start over.
         //
-        FS_MEMSET(&atInfo, 0, sizeof(atInfo));
-        r = FS_GET_AT_INFO(pVolume, &atInfo);
-        if (r == 0) {
-          //
-          // Make sure that the journal is disabled during the checking.
-          //
-          r = _SuspendJournal(pVolume);
-          if (r == 0) {
-            //
-            // Restart the checking if the allocation table has
-            // been modified since the start of the operation
-            // that is last call to FS_InitCheck().
-            //
-            r = FS_CHECKDISK_RETVAL_RETRY;
-            if (atInfo.WriteCnt == pCheckData->WriteCntAT) {
-              pClusterMap = &pCheckData->ClusterMap;
-              pfOnError   = pCheckData->pfOnError;
-              r = FS_CHECK_AT(pVolume, pClusterMap, pfOnError);
-              if (r == 0) {
-                //
-                // Check if the entire allocation table has been checked.
-                // If not, request a new check for the next range of clusters.
-                //
-                NumClustersChecked   = (U32)pClusterMap->NumClusters;
-                LastClusterIdChecked = (pClusterMap->FirstClusterId + NumClustersChecked) - 1u;
-                LastClusterId        = (atInfo.FirstClusterId + atInfo.NumClusters) - 1u;
-                if (LastClusterIdChecked < LastClusterId) {
-                  NumClustersToCheck = LastClusterId - LastClusterIdChecked;
-                  NumClustersToCheck = SEGGER_MIN(NumClustersToCheck, NumClustersChecked);
-                  pClusterMap->NumClusters    = (I32)NumClustersToCheck;
-                  pClusterMap->FirstClusterId = LastClusterIdChecked + 1u;
-                  NumBytes = (NumClustersToCheck + 8u - 1u) >> 3;       // The status of 8 clusters is stored in a byte.
-                  FS_MEMSET(pClusterMap->pData, 0, NumBytes);
-                  r = FS_CHECKDISK_RETVAL_CONTINUE;
-                }
-                Result = FS_GET_AT_INFO(pVolume, &atInfo);
-                if (Result == 0) {
-                  //
-                  // Update the number of write operations performed
-                  // to the allocation table for the case the checking
-                  // operation modified the allocation table.
-                  //
-                  pCheckData->WriteCntAT = atInfo.WriteCnt;
-                }
-              }
-            }
-            (void)_ResumeJournal(pVolume);
-          } else {
-            if (r == FS_ERRCODE_INVALID_USAGE) {
-              //
-              // Retry the disk checking operation if a journal transaction is active.
-              //
-              r = FS_CHECKDISK_RETVAL_RETRY;
-            }
-          }
+        pStepData->NumRestarts++;
+        r = _RestartCheckStep(pStepData);
+        if (r != 0) {
+          break;                                      // Error, could not restart the operation.
         }
-      } else {
-        FS_DEBUG_ERROROUT((FS_MTYPE_API, "FS_CheckAT: Volume has been unmounted by another task."));
-        r = FS_ERRCODE_VOLUME_NOT_MOUNTED;
+        r = FS_CHECKDISK_RETVAL_CONTINUE;
+      }
+      if (r != FS_CHECKDISK_RETVAL_CONTINUE) {
+        break;                                        // Done or error.
+      }
+      if ((TimeNow - TimeStart) >= TimeSlice) {
+        break;                                        // Time slice expired.
       }
-      FS_UNLOCK_DRIVER(&pVolume->Partition.Device);
     }
   }
-  FS_UNLOCK();
   return r;
 }
 
+/*********************************************************************
+*
+*       FS_CheckDiskGetProgress
+*
+*  Function description
+*    Returns the progress of an incremental disk checking operation.
+*
+*  Parameters
+*    pStepData    [IN] Checking context. It cannot be NULL.
+*    pProgress    [OUT] Progress information. It cannot be NULL.
+*
+*  Additional information
+*    The estimation of the remaining time assumes that each pass
+*    through the directory tree takes as long as the first one and
+*    that the allocation table is checked at the rate measured so far.
+*    ClustersPerSecond can be used to compare the checking performance
+*    of different storage devices and volume configurations.
+*/
+void FS_CheckDiskGetProgress(const FS_CHECKDISK_STEP_DATA * pStepData, FS_CHECKDISK_PROGRESS * pProgress) {
+  U32 TimeRemaining;
+  U32 TimeDirRemaining;
+  U32 NumPassesRemaining;
+  U32 NumClustersRemaining;
+  U32 Percent;
+
+  if ((pStepData == NULL) || (pProgress == NULL)) {
+    FS_DEBUG_ERROROUT((FS_MTYPE_API, "FS_CheckDiskGetProgress: Invalid parameter(s)."));
+    return;
+  }
+  FS_MEMSET(pProgress, 0, sizeof(FS_CHECKDISK_PROGRESS));
+  pProgress->Phase              = pStepData->Phase;
+  pProgress->NumPasses          = pStepData->NumPasses;
+  pProgress->PassIndex          = pStepData->PassIndex;
+  pProgress->NumClustersTotal   = pStepData->NumClustersTotal;
+  pProgress->NumClustersChecked = pStepData->NumClustersChecked;
+  pProgress->NumDirsChecked     = pStepData->NumDirsChecked;
+  pProgress->NumRestarts        = pStepData->NumRestarts;
+  pProgress->TimeElapsed        = pStepData->TimeElapsed;
+  if (pStepData->TimeAT != 0u) {
+    pProgress->ClustersPerSecond = (U32)(((U64)pStepData->NumClustersChecked * 1000u) / pStepData->TimeAT);
+  }
+  if (pStepData->Phase == FS_CHECKDISK_PHASE_DONE) {
+    pProgress->Percent = 100;
+    return;
+  }
+  //
+  // Estimate the remaining processing time. This is possible only
+  // after the entire directory tree and a part of the allocation
+  // table have been checked.
+  //
+  TimeRemaining = 0xFFFFFFFFuL;
+  if ((pStepData->TimeDirPass != 0u) && (pStepData->NumClustersChecked != 0u)) {
+    NumPassesRemaining   = (U32)pStepData->NumPasses - (U32)pStepData->PassIndex - 1u;
+    TimeDirRemaining     = NumPassesRemaining * pStepData->TimeDirPass;
+    if (pStepData->Phase == FS_CHECKDISK_PHASE_DIR) {
+      if (pStepData->TimeDirPass > pStepData->TimeDirCurrent) {
+        TimeDirRemaining += pStepData->TimeDirPass - pStepData->TimeDirCurrent;
+      }
+    }
+    NumClustersRemaining = pStepData->NumClustersTotal - pStepData->NumClustersChecked;
+    TimeRemaining        = (U32)(((U64)NumClustersRemaining * pStepData->TimeAT) / pStepData->NumClustersChecked);
+    TimeRemaining       += TimeDirRemaining;
+  }
+  pProgress->TimeRemaining = TimeRemaining;
+  //
+  // Calculate the progress in percent.
+  //
+  if (TimeRemaining != 0xFFFFFFFFuL) {
+    Percent = 0;
+    if ((pStepData->TimeElapsed + TimeRemaining) != 0u) {
+      Percent = (U32)(((U64)pStepData->TimeElapsed * 100u) / ((U64)pStepData->TimeElapsed + TimeRemaining));
+    }
+  } else {
+    Percent = 0;
+    if (pStepData->NumClustersTotal != 0u) {
+      Percent = (U32)(((U64)pStepData->NumClustersChecked * 100u) / pStepData->NumClustersTotal);
+    }
+  }
+  pProgress->Percent = (U8)SEGGER_MIN(Percent, 99u);
+}
+
 #if FS_SUPPORT_VOLUME_ALIAS
 
 /*********************************************************************